@@ -126,6 +126,15 @@
 #define RIPPLE_DUMP_LEAKS_ON_EXIT 1
 #endif
 
+/** Config: RIPPLE_COUNT_ALLOCATIONS
+    Replaces the global operator new with one that counts allocations, so
+    the ProtocolTiming suite can report allocations per operation. Every
+    allocation then pays for an atomic increment, so this is normally off.
+*/
+#ifndef RIPPLE_COUNT_ALLOCATIONS
+#define RIPPLE_COUNT_ALLOCATIONS 0
+#endif
+
 //------------------------------------------------------------------------------
 
 // These control whether or not certain functionality gets
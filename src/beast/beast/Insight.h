@@ -32,6 +32,7 @@
 #include <beast/insight/HookImpl.h>
 #include <beast/insight/Collector.h>
 #include <beast/insight/NullCollector.h>
+#include <beast/insight/ScrapeCollector.h>
 #include <beast/insight/StatsDCollector.h>
 
 #endif
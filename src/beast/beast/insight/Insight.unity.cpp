@@ -31,4 +31,6 @@
 #include <beast/insight/impl/Hook.cpp>
 #include <beast/insight/impl/Metric.cpp>
 #include <beast/insight/impl/NullCollector.cpp>
+#include <beast/insight/impl/ScrapeCollector.cpp>
 #include <beast/insight/impl/StatsDCollector.cpp>
+#include <beast/insight/tests/ScrapeCollector.test.cpp>
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of Beast: https://github.com/vinniefalco/Beast
+    Copyright 2013, Vinnie Falco <vinnie.falco@gmail.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef BEAST_INSIGHT_SCRAPECOLLECTOR_H_INCLUDED
+#define BEAST_INSIGHT_SCRAPECOLLECTOR_H_INCLUDED
+
+#include <beast/insight/Collector.h>
+
+#include <string>
+
+namespace beast {
+namespace insight {
+
+/** A Collector that holds its metrics in memory to be pulled over HTTP.
+
+    Each metric is also passed on to another collector, so metrics can
+    go to a StatsD server and be pulled at the same time. Updating a
+    metric only changes atomics, and writing the metrics out reads them
+    without stopping their writers. Events are counted in a histogram of
+    milliseconds. Hooks are called on a thread of the collector once a
+    second, as they are by the StatsD collector.
+
+    The metrics are written in the Prometheus text exposition format:
+        https://prometheus.io/docs/instrumenting/exposition_formats/
+*/
+class ScrapeCollector : public Collector
+{
+public:
+    /** The upper bounds of the histogram buckets of events, in ms.
+        A last bucket holds everything larger.
+    */
+    static std::size_t const bucketCount = 14;
+    static std::uint64_t const bucketBounds[bucketCount];
+
+    /** Create a scrape collector.
+        @param next The collector each metric is also passed on to.
+        @param prefix A string pre-pended before each metric name.
+    */
+    static
+    std::shared_ptr <ScrapeCollector>
+    New (Collector::ptr const& next, std::string const& prefix);
+
+    /** The media type of the text written by render. */
+    static char const* const contentType;
+
+    /** Returns every metric in the text exposition format.
+        Metrics which share a name are added together.
+    */
+    virtual
+    std::string
+    render () const = 0;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,508 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of Beast: https://github.com/vinniefalco/Beast
+    Copyright 2013, Vinnie Falco <vinnie.falco@gmail.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <beast/insight/ScrapeCollector.h>
+#include <beast/intrusive/List.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace beast {
+namespace insight {
+
+std::uint64_t const ScrapeCollector::bucketBounds[bucketCount] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000 };
+
+char const* const ScrapeCollector::contentType =
+    "text/plain; version=0.0.4";
+
+namespace detail {
+
+class ScrapeCollectorImp;
+
+//------------------------------------------------------------------------------
+
+// The values of a metric, or of all the metrics sharing its name
+struct ScrapeSample
+{
+    char const* type = nullptr;
+    std::int64_t value = 0;
+    std::array <std::uint64_t, ScrapeCollector::bucketCount + 1> buckets {};
+    std::uint64_t sum = 0;
+};
+
+class ScrapeMetricBase : public List <ScrapeMetricBase>::Node
+{
+public:
+    explicit ScrapeMetricBase (std::string const& name)
+        : name_ (name)
+    {
+    }
+
+    std::string const& name () const
+    {
+        return name_;
+    }
+
+    virtual void add_to (ScrapeSample& sample) const = 0;
+
+private:
+    std::string name_;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeHookImpl
+    : public HookImpl
+    , public List <ScrapeHookImpl>::Node
+{
+public:
+    ScrapeHookImpl (HandlerType const& handler,
+        std::shared_ptr <ScrapeCollectorImp> const& impl);
+
+    ~ScrapeHookImpl ();
+
+    void do_process ()
+    {
+        m_handler ();
+    }
+
+private:
+    ScrapeHookImpl& operator= (ScrapeHookImpl const&);
+
+    std::shared_ptr <ScrapeCollectorImp> m_impl;
+    HandlerType m_handler;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeCounterImpl
+    : public CounterImpl
+    , public ScrapeMetricBase
+{
+public:
+    ScrapeCounterImpl (std::string const& name,
+        std::shared_ptr <ScrapeCollectorImp> const& impl);
+
+    ~ScrapeCounterImpl ();
+
+    void increment (CounterImpl::value_type amount) override
+    {
+        m_value.fetch_add (amount, std::memory_order_relaxed);
+        m_next.increment (amount);
+    }
+
+    void add_to (ScrapeSample& sample) const override
+    {
+        sample.type = "counter";
+        sample.value += m_value.load (std::memory_order_relaxed);
+    }
+
+private:
+    ScrapeCounterImpl& operator= (ScrapeCounterImpl const&);
+
+    std::shared_ptr <ScrapeCollectorImp> m_impl;
+    std::atomic <CounterImpl::value_type> m_value {0};
+    Counter m_next;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeEventImpl
+    : public EventImpl
+    , public ScrapeMetricBase
+{
+public:
+    ScrapeEventImpl (std::string const& name,
+        std::shared_ptr <ScrapeCollectorImp> const& impl);
+
+    ~ScrapeEventImpl ();
+
+    void notify (EventImpl::value_type const& value) override
+    {
+        auto const ms = static_cast <std::uint64_t> (
+            std::max <EventImpl::value_type::rep> (value.count (), 0));
+        auto const bucket = std::lower_bound (
+            std::begin (ScrapeCollector::bucketBounds),
+                std::end (ScrapeCollector::bucketBounds), ms) -
+                    std::begin (ScrapeCollector::bucketBounds);
+        m_buckets[bucket].fetch_add (1, std::memory_order_relaxed);
+        m_sum.fetch_add (ms, std::memory_order_relaxed);
+        m_next.notify (value);
+    }
+
+    void add_to (ScrapeSample& sample) const override
+    {
+        sample.type = "histogram";
+        for (std::size_t i = 0; i < m_buckets.size (); ++i)
+            sample.buckets[i] += m_buckets[i].load (std::memory_order_relaxed);
+        sample.sum += m_sum.load (std::memory_order_relaxed);
+    }
+
+private:
+    ScrapeEventImpl& operator= (ScrapeEventImpl const&);
+
+    std::shared_ptr <ScrapeCollectorImp> m_impl;
+    std::array <std::atomic <std::uint64_t>,
+        ScrapeCollector::bucketCount + 1> m_buckets {};
+    std::atomic <std::uint64_t> m_sum {0};
+    Event m_next;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeGaugeImpl
+    : public GaugeImpl
+    , public ScrapeMetricBase
+{
+public:
+    ScrapeGaugeImpl (std::string const& name,
+        std::shared_ptr <ScrapeCollectorImp> const& impl);
+
+    ~ScrapeGaugeImpl ();
+
+    void set (GaugeImpl::value_type value) override
+    {
+        m_value.store (value, std::memory_order_relaxed);
+        m_next.set (value);
+    }
+
+    void increment (GaugeImpl::difference_type amount) override
+    {
+        m_value.fetch_add (amount, std::memory_order_relaxed);
+        m_next.increment (amount);
+    }
+
+    void add_to (ScrapeSample& sample) const override
+    {
+        sample.type = "gauge";
+        sample.value += m_value.load (std::memory_order_relaxed);
+    }
+
+private:
+    ScrapeGaugeImpl& operator= (ScrapeGaugeImpl const&);
+
+    std::shared_ptr <ScrapeCollectorImp> m_impl;
+    std::atomic <GaugeImpl::value_type> m_value {0};
+    Gauge m_next;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeMeterImpl
+    : public MeterImpl
+    , public ScrapeMetricBase
+{
+public:
+    ScrapeMeterImpl (std::string const& name,
+        std::shared_ptr <ScrapeCollectorImp> const& impl);
+
+    ~ScrapeMeterImpl ();
+
+    void increment (MeterImpl::value_type amount) override
+    {
+        m_value.fetch_add (amount, std::memory_order_relaxed);
+        m_next.increment (amount);
+    }
+
+    void add_to (ScrapeSample& sample) const override
+    {
+        sample.type = "counter";
+        sample.value += m_value.load (std::memory_order_relaxed);
+    }
+
+private:
+    ScrapeMeterImpl& operator= (ScrapeMeterImpl const&);
+
+    std::shared_ptr <ScrapeCollectorImp> m_impl;
+    std::atomic <MeterImpl::value_type> m_value {0};
+    Meter m_next;
+};
+
+//------------------------------------------------------------------------------
+
+class ScrapeCollectorImp
+    : public ScrapeCollector
+    , public std::enable_shared_from_this <ScrapeCollectorImp>
+{
+private:
+    Collector::ptr m_next;
+    std::string m_prefix;
+
+    std::mutex mutable metricsLock_;
+    List <ScrapeMetricBase> metrics_;
+
+    // Held while the hooks are called, so none goes away during its call
+    std::recursive_mutex hooksLock_;
+    List <ScrapeHookImpl> hooks_;
+
+    std::mutex stopLock_;
+    std::condition_variable stopCond_;
+    bool stop_ = false;
+
+    // Must come last for order of init
+    std::thread m_thread;
+
+    // Returns a name with the characters a metric name may not hold
+    // replaced by underscores.
+    std::string sanitize (std::string const& name) const
+    {
+        std::string result;
+        result.reserve (m_prefix.size () + 1 + name.size ());
+        if (! m_prefix.empty ())
+        {
+            result = m_prefix;
+            result += '_';
+        }
+        result += name;
+        for (auto& c : result)
+        {
+            if (! std::isalnum (static_cast <unsigned char> (c)) &&
+                    c != '_' && c != ':')
+                c = '_';
+        }
+        if (result.empty () ||
+                std::isdigit (static_cast <unsigned char> (result[0])))
+            result.insert (0, 1, '_');
+        return result;
+    }
+
+public:
+    ScrapeCollectorImp (Collector::ptr const& next, std::string const& prefix)
+        : m_next (next)
+        , m_prefix (prefix)
+        , m_thread (&ScrapeCollectorImp::run, this)
+    {
+    }
+
+    ~ScrapeCollectorImp ()
+    {
+        {
+            std::lock_guard <std::mutex> lock (stopLock_);
+            stop_ = true;
+        }
+        stopCond_.notify_one ();
+        m_thread.join ();
+    }
+
+    Hook make_hook (HookImpl::HandlerType const& handler) override
+    {
+        return Hook (std::make_shared <detail::ScrapeHookImpl> (
+            handler, shared_from_this ()));
+    }
+
+    Counter make_counter (std::string const& name) override
+    {
+        return Counter (std::make_shared <detail::ScrapeCounterImpl> (
+            name, shared_from_this ()));
+    }
+
+    Event make_event (std::string const& name) override
+    {
+        return Event (std::make_shared <detail::ScrapeEventImpl> (
+            name, shared_from_this ()));
+    }
+
+    Gauge make_gauge (std::string const& name) override
+    {
+        return Gauge (std::make_shared <detail::ScrapeGaugeImpl> (
+            name, shared_from_this ()));
+    }
+
+    Meter make_meter (std::string const& name) override
+    {
+        return Meter (std::make_shared <detail::ScrapeMeterImpl> (
+            name, shared_from_this ()));
+    }
+
+    std::string render () const override
+    {
+        std::map <std::string, ScrapeSample> samples;
+        {
+            std::lock_guard <std::mutex> lock (metricsLock_);
+            for (auto const& m : metrics_)
+                m.add_to (samples[m.name ()]);
+        }
+
+        std::ostringstream ss;
+        for (auto const& entry : samples)
+        {
+            auto const name = sanitize (entry.first);
+            auto const& sample = entry.second;
+            ss << "# TYPE " << name << " " << sample.type << "\n";
+            if (sample.type != std::string ("histogram"))
+            {
+                ss << name << " " << sample.value << "\n";
+                continue;
+            }
+
+            std::uint64_t count = 0;
+            for (std::size_t i = 0; i < bucketCount; ++i)
+            {
+                count += sample.buckets[i];
+                ss << name << "_bucket{le=\"" << bucketBounds[i] << "\"} " <<
+                    count << "\n";
+            }
+            count += sample.buckets[bucketCount];
+            ss << name << "_bucket{le=\"+Inf\"} " << count << "\n";
+            ss << name << "_sum " << sample.sum << "\n";
+            ss << name << "_count " << count << "\n";
+        }
+        return ss.str ();
+    }
+
+    //--------------------------------------------------------------------------
+
+    Collector& next ()
+    {
+        return *m_next;
+    }
+
+    void add (ScrapeMetricBase& metric)
+    {
+        std::lock_guard <std::mutex> lock (metricsLock_);
+        metrics_.push_back (metric);
+    }
+
+    void remove (ScrapeMetricBase& metric)
+    {
+        std::lock_guard <std::mutex> lock (metricsLock_);
+        metrics_.erase (metrics_.iterator_to (metric));
+    }
+
+    void add (ScrapeHookImpl& hook)
+    {
+        std::lock_guard <std::recursive_mutex> lock (hooksLock_);
+        hooks_.push_back (hook);
+    }
+
+    void remove (ScrapeHookImpl& hook)
+    {
+        std::lock_guard <std::recursive_mutex> lock (hooksLock_);
+        hooks_.erase (hooks_.iterator_to (hook));
+    }
+
+    void run ()
+    {
+        std::unique_lock <std::mutex> lock (stopLock_);
+        while (! stopCond_.wait_for (lock, std::chrono::seconds (1),
+            [this] { return stop_; }))
+        {
+            lock.unlock ();
+            {
+                std::lock_guard <std::recursive_mutex> _ (hooksLock_);
+                for (auto& hook : hooks_)
+                    hook.do_process ();
+            }
+            lock.lock ();
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+ScrapeHookImpl::ScrapeHookImpl (HandlerType const& handler,
+    std::shared_ptr <ScrapeCollectorImp> const& impl)
+    : m_impl (impl)
+    , m_handler (handler)
+{
+    m_impl->add (*this);
+}
+
+ScrapeHookImpl::~ScrapeHookImpl ()
+{
+    m_impl->remove (*this);
+}
+
+ScrapeCounterImpl::ScrapeCounterImpl (std::string const& name,
+    std::shared_ptr <ScrapeCollectorImp> const& impl)
+    : ScrapeMetricBase (name)
+    , m_impl (impl)
+    , m_next (impl->next ().make_counter (name))
+{
+    m_impl->add (*this);
+}
+
+ScrapeCounterImpl::~ScrapeCounterImpl ()
+{
+    m_impl->remove (*this);
+}
+
+ScrapeEventImpl::ScrapeEventImpl (std::string const& name,
+    std::shared_ptr <ScrapeCollectorImp> const& impl)
+    : ScrapeMetricBase (name)
+    , m_impl (impl)
+    , m_next (impl->next ().make_event (name))
+{
+    m_impl->add (*this);
+}
+
+ScrapeEventImpl::~ScrapeEventImpl ()
+{
+    m_impl->remove (*this);
+}
+
+ScrapeGaugeImpl::ScrapeGaugeImpl (std::string const& name,
+    std::shared_ptr <ScrapeCollectorImp> const& impl)
+    : ScrapeMetricBase (name)
+    , m_impl (impl)
+    , m_next (impl->next ().make_gauge (name))
+{
+    m_impl->add (*this);
+}
+
+ScrapeGaugeImpl::~ScrapeGaugeImpl ()
+{
+    m_impl->remove (*this);
+}
+
+ScrapeMeterImpl::ScrapeMeterImpl (std::string const& name,
+    std::shared_ptr <ScrapeCollectorImp> const& impl)
+    : ScrapeMetricBase (name)
+    , m_impl (impl)
+    , m_next (impl->next ().make_meter (name))
+{
+    m_impl->add (*this);
+}
+
+ScrapeMeterImpl::~ScrapeMeterImpl ()
+{
+    m_impl->remove (*this);
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr <ScrapeCollector> ScrapeCollector::New (
+    Collector::ptr const& next, std::string const& prefix)
+{
+    return std::make_shared <detail::ScrapeCollectorImp> (next, prefix);
+}
+
+}
+}
@@ -0,0 +1,120 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of Beast: https://github.com/vinniefalco/Beast
+    Copyright 2013, Vinnie Falco <vinnie.falco@gmail.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <beast/insight/ScrapeCollector.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/unit_test/suite.h>
+
+namespace beast {
+namespace insight {
+
+class ScrapeCollector_test : public unit_test::suite
+{
+public:
+    static
+    bool
+    contains (std::string const& text, std::string const& line)
+    {
+        return text.find (line + "\n") != std::string::npos;
+    }
+
+    void
+    testMetrics ()
+    {
+        auto const collector =
+            ScrapeCollector::New (NullCollector::New (), "radard");
+
+        auto counter = collector->make_counter ("rpc", "requests");
+        counter.increment (3);
+        ++counter;
+
+        auto gauge = collector->make_gauge ("jobq.job_count");
+        gauge.set (10);
+        gauge.increment (-2);
+
+        auto meter = collector->make_meter ("peer.2bytes");
+        meter.increment (100);
+
+        auto const text = collector->render ();
+        expect (contains (text, "# TYPE radard_rpc_requests counter"));
+        expect (contains (text, "radard_rpc_requests 4"), text);
+        expect (contains (text, "# TYPE radard_jobq_job_count gauge"));
+        expect (contains (text, "radard_jobq_job_count 8"), text);
+        expect (contains (text, "radard_peer_2bytes 100"), text);
+    }
+
+    void
+    testHistogram ()
+    {
+        auto const collector =
+            ScrapeCollector::New (NullCollector::New (), "");
+
+        auto event = collector->make_event ("time");
+        event.notify (std::chrono::milliseconds (0));
+        event.notify (std::chrono::milliseconds (1));
+        event.notify (std::chrono::milliseconds (7));
+        event.notify (std::chrono::seconds (60));
+
+        auto const text = collector->render ();
+        expect (contains (text, "# TYPE time histogram"));
+        expect (contains (text, "time_bucket{le=\"1\"} 2"), text);
+        expect (contains (text, "time_bucket{le=\"5\"} 2"), text);
+        expect (contains (text, "time_bucket{le=\"10\"} 3"), text);
+        expect (contains (text, "time_bucket{le=\"30000\"} 3"), text);
+        expect (contains (text, "time_bucket{le=\"+Inf\"} 4"), text);
+        expect (contains (text, "time_sum 60008"), text);
+        expect (contains (text, "time_count 4"), text);
+    }
+
+    void
+    testSharedNames ()
+    {
+        auto const collector =
+            ScrapeCollector::New (NullCollector::New (), "");
+
+        {
+            auto a = collector->make_counter ("calls");
+            auto b = collector->make_counter ("calls");
+            a.increment (2);
+            b.increment (5);
+
+            auto const text = collector->render ();
+            expect (contains (text, "calls 7"), text);
+            expect (text.find ("# TYPE calls") ==
+                text.rfind ("# TYPE calls"), text);
+        }
+
+        // Metrics are gone once nothing holds them
+        expect (collector->render ().empty ());
+    }
+
+    void
+    run ()
+    {
+        testMetrics ();
+        testHistogram ();
+        testSharedNames ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ScrapeCollector,insight,beast);
+
+}
+}
@@ -20,6 +20,7 @@
 #include <BeastConfig.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
 #include <ripple/basics/chrono.h>
 
 namespace ripple {
@@ -36,6 +37,27 @@ AcceptedLedger::AcceptedLedger (
     }
 }
 
+AcceptedLedger::AcceptedLedger (
+    std::shared_ptr<Ledger const> const& ledger,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    AccountIDCache const& accountCache, Logs& logs)
+    : mLedger (ledger)
+{
+    for (auto const& txn : txs)
+    {
+        auto const& item = ledger->txMap().peekItem (
+            txn->getTransactionID ());
+        if (! item)
+            LogicError ("AcceptedLedger: transaction not in ledger");
+
+        // Skip the transaction, we already have it
+        SerialIter sit (item->slice ());
+        sit.skip (sit.getVLDataLength ());
+        insert (std::make_shared<AcceptedLedgerTx>(
+            ledger, txn, sit.getVL (), accountCache, logs));
+    }
+}
+
 void AcceptedLedger::insert (AcceptedLedgerTx::ref at)
 {
     assert (mMap.find (at->getIndex ()) == mMap.end ());
@@ -22,6 +22,7 @@
 
 #include <ripple/app/ledger/AcceptedLedgerTx.h>
 #include <ripple/protocol/AccountID.h>
+#include <vector>
 
 namespace ripple {
 
@@ -72,6 +73,14 @@ public:
         std::shared_ptr<ReadView const> const& ledger,
         AccountIDCache const& accountCache, Logs& logs);
 
+    /** Build from the transactions applied to a ledger built locally.
+        Only their metadata is read back from the ledger.
+    */
+    AcceptedLedger (
+        std::shared_ptr<Ledger const> const& ledger,
+        std::vector<std::shared_ptr<STTx const>> const& txs,
+        AccountIDCache const& accountCache, Logs& logs);
+
 private:
     void insert (AcceptedLedgerTx::ref);
 
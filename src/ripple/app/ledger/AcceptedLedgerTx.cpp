@@ -51,6 +51,27 @@ AcceptedLedgerTx::AcceptedLedgerTx (
     mRawMeta = std::move (s.modData());
 }
 
+AcceptedLedgerTx::AcceptedLedgerTx (
+    std::shared_ptr<ReadView const> const& ledger,
+    std::shared_ptr<STTx const> const& txn,
+    Blob rawMeta,
+    AccountIDCache const& accountCache,
+    Logs& logs)
+    : mLedger (ledger)
+    , mTxn (txn)
+    , mRawMeta (std::move (rawMeta))
+    , accountCache_ (accountCache)
+    , logs_ (logs)
+{
+    assert (! ledger->info().open);
+
+    SerialIter sit (makeSlice (mRawMeta));
+    mMeta = std::make_shared<TxMeta> (txn->getTransactionID(),
+        ledger->seq(), STObject (sit, sfMetadata), logs.journal ("View"));
+    mAffected = mMeta->getAffectedAccounts ();
+    mResult = mMeta->getResultTER ();
+}
+
 AcceptedLedgerTx::AcceptedLedgerTx (
     std::shared_ptr<ReadView const> const& ledger,
     std::shared_ptr<STTx const> const& txn,
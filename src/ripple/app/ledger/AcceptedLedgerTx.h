@@ -60,6 +60,13 @@ public:
         std::shared_ptr<STObject const> const&,
         AccountIDCache const&,
         Logs&);
+    /** Build from a transaction and the metadata it was applied with. */
+    AcceptedLedgerTx (
+        std::shared_ptr<ReadView const> const& ledger,
+        std::shared_ptr<STTx const> const&,
+        Blob rawMeta,
+        AccountIDCache const&,
+        Logs&);
     AcceptedLedgerTx (
         std::shared_ptr<ReadView const> const&,
         std::shared_ptr<STTx const> const&,
@@ -108,6 +115,10 @@ public:
         return mMeta ? mMeta->getIndex () : 0;
     }
     std::string getEscMeta () const;
+    Blob const& getRawMeta () const
+    {
+        return mRawMeta;
+    }
     Json::Value getJson ()
     {
         if (mJson == Json::nullValue)
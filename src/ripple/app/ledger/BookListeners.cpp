@@ -20,7 +20,6 @@
 #include <BeastConfig.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/misc/NetworkOPs.h>
-#include <ripple/json/to_string.h>
 
 namespace ripple {
 
@@ -36,10 +35,9 @@ void BookListeners::removeSubscriber (std::uint64_t seq)
     mListeners.erase (seq);
 }
 
-void BookListeners::publish (Json::Value const& jvObj)
+void BookListeners::publish (
+    Json::Value const& jvObj, SharedMessage const& message)
 {
-    std::string sObj = to_string (jvObj);
-
     std::lock_guard <std::recursive_mutex> sl (mLock);
     auto it = mListeners.cbegin ();
 
@@ -49,7 +47,7 @@ void BookListeners::publish (Json::Value const& jvObj)
 
         if (p)
         {
-            p->send (jvObj, sObj, true);
+            p->send (jvObj, message, true);
             ++it;
         }
         else
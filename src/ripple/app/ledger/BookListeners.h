@@ -36,7 +36,12 @@ public:
 
     void addSubscriber (InfoSub::ref sub);
     void removeSubscriber (std::uint64_t sub);
-    void publish (Json::Value const& jvObj);
+
+    /** Send a message to every listener.
+
+        @param message The message already serialized, shared by all of them.
+    */
+    void publish (Json::Value const& jvObj, SharedMessage const& message);
 
 private:
     std::recursive_mutex mLock;
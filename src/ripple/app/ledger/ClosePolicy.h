@@ -0,0 +1,109 @@
+#ifndef RIPPLE_APP_LEDGER_CLOSEPOLICY_H_INCLUDED
+#define RIPPLE_APP_LEDGER_CLOSEPOLICY_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/json/json_value.h>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace ripple {
+
+/** Adapts when the open ledger closes to how long it will take to apply.
+
+    The time it takes to apply a transaction to the last closed ledger is
+    measured at every close. From it, the time the open ledger will take is
+    projected: a ledger that would take longer than the target closes as
+    soon as the minimum open time allows, instead of waiting for half of
+    the previous round. With little in the open ledger and nothing
+    queued, a ledger can be made to stay open a while longer, so that
+    bursts are not split over many small ledgers.
+
+    Closing is still decided by each server on its own time, so the
+    policy never holds back a ledger that most of the network closed.
+*/
+class ClosePolicy
+{
+public:
+    struct Setup
+    {
+        // The longest we want applying a ledger to take, 0 to not adapt
+        std::chrono::milliseconds targetApply {1500};
+
+        // Ledgers with fewer transactions than this stay open longer
+        std::size_t smallLedger = 0;
+
+        // How long a small ledger stays open at least
+        std::chrono::milliseconds linger {0};
+    };
+
+    enum class Decision
+    {
+        normal,         // close on the usual timing
+        early,          // close as soon as the minimum open time allows
+        linger          // stay open until the linger time
+    };
+
+    explicit
+    ClosePolicy (Setup const& setup);
+
+    ClosePolicy (ClosePolicy const&) = delete;
+    ClosePolicy& operator= (ClosePolicy const&) = delete;
+
+    Setup const&
+    setup () const
+    {
+        return setup_;
+    }
+
+    /** Records the time the consensus transactions took to apply. */
+    void
+    onApplied (std::size_t txCount, std::chrono::nanoseconds elapsed);
+
+    /** The time transactions are expected to take to apply. */
+    std::chrono::milliseconds
+    projectApply (std::size_t txCount) const;
+
+    /** Decides how the open ledger should close.
+
+        @param openTxCount The transactions in the open ledger.
+        @param queued The transactions waiting in the transaction queue.
+    */
+    Decision
+    decide (std::size_t openTxCount, std::size_t queued);
+
+    static char const*
+    getName (Decision decision);
+
+    Json::Value
+    getJson () const;
+
+private:
+    std::chrono::milliseconds
+    projectApply (std::size_t txCount, std::lock_guard<std::mutex> const&) const;
+
+    Setup const setup_;
+
+    std::mutex mutable mutex_;
+
+    // Average time to apply one transaction, in nanoseconds
+    double perTx_ = 0;
+
+    // The last ledger applied
+    std::size_t lastTxCount_ = 0;
+    std::chrono::nanoseconds lastApply_ {0};
+
+    // The last decision, and what it was made from
+    Decision decision_ = Decision::normal;
+    std::size_t openTxCount_ = 0;
+    std::size_t queued_ = 0;
+    std::chrono::milliseconds projected_ {0};
+};
+
+/** Reads the [ledger_close] section. */
+ClosePolicy::Setup
+setup_ClosePolicy (Section const& section);
+
+} // ripple
+
+#endif
@@ -89,6 +89,10 @@ public:
     {
         return mSeq;
     }
+    fcReason getReason () const
+    {
+        return mReason;
+    }
 
     // VFALCO TODO Make this the Listener / Observer pattern
     bool addOnComplete (std::function<void (InboundLedger::pointer)>);
@@ -125,8 +129,9 @@ private:
     void newPeer (Peer::ptr const& peer)
     {
         // For historical nodes, do not trigger too soon
-        // since a fetch pack is probably coming
-        if (mReason != fcHISTORY)
+        // since a fetch pack is probably coming, unless
+        // many of them are being acquired at once
+        if (mReason != fcHISTORY || app_.config().LEDGER_FETCH_BULK > 0)
             trigger (peer, TriggerReason::trAdded);
     }
 
@@ -136,18 +141,18 @@ private:
 
     bool takeHeader (std::string const& data);
     bool takeTxNode (const std::vector<SHAMapNodeID>& IDs,
-                     const std::vector<Blob>& data,
+                     const std::vector<Slice>& data,
                      SHAMapAddNode&);
-    bool takeTxRootNode (Blob const& data, SHAMapAddNode&);
+    bool takeTxRootNode (Slice const& data, SHAMapAddNode&);
 
     // VFALCO TODO Rename to receiveAccountStateNode
     //             Don't use acronyms, but if we are going to use them at least
     //             capitalize them correctly.
     //
     bool takeAsNode (const std::vector<SHAMapNodeID>& IDs,
-                     const std::vector<Blob>& data,
+                     const std::vector<Slice>& data,
                      SHAMapAddNode&);
-    bool takeAsRootNode (Blob const& data, SHAMapAddNode&);
+    bool takeAsRootNode (Slice const& data, SHAMapAddNode&);
 
 private:
     Ledger::pointer    mLedger;
@@ -62,6 +62,19 @@ public:
 
     virtual int getFetchCount (int& timeoutCount) = 0;
 
+    /** Returns the number of past ledgers still being acquired. */
+    virtual std::size_t getHistoryCount () = 0;
+
+    /** Returns true if a ledger other than a past one is being acquired. */
+    virtual bool isAcquiringTip () = 0;
+
+    /** Drop the nodes another past ledger asked for recently.
+        The nodes that are left are claimed for this ledger.
+    */
+    virtual void filterHistoryNodes (LedgerHash const& ledgerHash,
+        std::vector<SHAMapNodeID>& nodeIDs,
+        std::vector<uint256>& nodeHashes) = 0;
+
     virtual void logFailure (uint256 const& h, std::uint32_t seq) = 0;
 
     virtual bool isFailure (uint256 const& h) = 0;
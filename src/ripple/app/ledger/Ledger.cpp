@@ -21,15 +21,19 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/impl/LedgerSaver.h>
 #include <ripple/app/ledger/LedgerTiming.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TxTrace.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
@@ -47,12 +51,16 @@
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/TxFormats.h>
 #include <ripple/protocol/types.h>
 #include <beast/module/core/text/LexicalCast.h>
 #include <beast/unit_test/suite.h>
 #include <boost/optional.hpp>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -104,11 +112,18 @@ public:
     sles_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         SerialIter sit(item.slice());
         return std::make_shared<SLE const>(
             sit, item.key());
     }
+
+    void
+    prefetch (std::size_t count) const override
+    {
+        static_cast<Ledger const*>(view_)->
+            stateMap().prefetchAfter (iter_, count);
+    }
 };
 
 //------------------------------------------------------------------------------
@@ -160,7 +175,7 @@ public:
     txs_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         if (metadata_)
             return deserializeTxPlusMeta(item);
         return { deserializeTx(item), nullptr };
@@ -423,8 +438,8 @@ void Ledger::setAccepted (
 
 bool Ledger::addSLE (SLE const& sle)
 {
-    SHAMapItem item (sle.getIndex(), sle.getSerializer());
-    return stateMap_->addItem(item, false, false);
+    return stateMap_->addGiveItem(
+        make_shamapitem(sle.getIndex(), sle.getSerializer()), false, false);
 }
 
 //------------------------------------------------------------------------------
@@ -535,11 +550,19 @@ Ledger::read (Keylet const& k) const
         return nullptr;
     // VFALCO TODO Eliminate "immutable" runtime property
     sle->setImmutable();
+    // Views that copy it to make changes share the fields
+    sle->share();
     // need move otherwise makes a copy
     // because return type is different
     return std::move(sle);
 }
 
+void
+Ledger::prefetch (std::vector<key_type> const& keys) const
+{
+    stateMap_->prefetch(keys);
+}
+
 //------------------------------------------------------------------------------
 
 auto
@@ -638,8 +661,7 @@ Ledger::rawInsert(std::shared_ptr<SLE> const& sle)
 {
     Serializer ss;
     sle->add(ss);
-    auto item = std::make_shared<
-        SHAMapItem const>(sle->key(),
+    auto item = make_shamapitem (sle->key(),
             std::move(ss));
     // VFALCO NOTE addGiveItem should take ownership
     if (! stateMap_->addGiveItem(
@@ -652,8 +674,7 @@ Ledger::rawReplace(std::shared_ptr<SLE> const& sle)
 {
     Serializer ss;
     sle->add(ss);
-    auto item = std::make_shared<
-        SHAMapItem const>(sle->key(),
+    auto item = make_shamapitem (sle->key(),
             std::move(ss));
     // VFALCO NOTE updateGiveItem should take ownership
     if (! stateMap_->updateGiveItem(
@@ -676,8 +697,7 @@ Ledger::rawTxInsert (uint256 const& key,
             metaData->getDataLength () + 16);
         s.addVL (txn->peekData ());
         s.addVL (metaData->peekData ());
-        auto item = std::make_shared<
-            SHAMapItem const> (key, std::move(s));
+        auto item = make_shamapitem (key, std::move(s));
         if (! txMap().addGiveItem
                 (std::move(item), true, true))
             LogicError("duplicate_tx: " + to_string(key));
@@ -685,8 +705,7 @@ Ledger::rawTxInsert (uint256 const& key,
     else
     {
         // low-level - just add to table
-        auto item = std::make_shared<
-            SHAMapItem const>(key, txn->peekData());
+        auto item = make_shamapitem (key, txn->peekData());
         if (! txMap().addGiveItem(
                 std::move(item), true, false))
             LogicError("duplicate_tx: " + to_string(key));
@@ -793,8 +812,59 @@ void Ledger::visitStateItems (std::function<void (SLE::ref)> callback) const
     }
 }
 
+// The type of a serialized ledger entry. sfLedgerEntryType sorts first,
+// so it is read without deserializing the rest.
+static LedgerEntryType entryType (SHAMapItem const& item)
+{
+    auto const data = static_cast<std::uint8_t const*> (item.data ());
+    if (item.size () < 3 || data[0] != 0x11)
+    {
+        // Unexpected layout, let the parser decide
+        return SLE (SerialIter (item.slice ()), item.key ()).getType ();
+    }
+    return static_cast<LedgerEntryType> ((data[1] << 8) | data[2]);
+}
+
+std::size_t Ledger::visitStateItems (LedgerEntryType type, int depth,
+    std::size_t threads, SHAMap::PartitionVisitor const& visitor) const
+{
+    try
+    {
+        if (type == ltANY)
+            return stateMap_->visitPartitions (depth, threads, visitor);
+
+        return stateMap_->visitPartitions (depth, threads,
+            [&](std::size_t partition, SHAMapItem const& item)
+            {
+                if (entryType (item) == type)
+                    visitor (partition, item);
+            });
+    }
+    catch (SHAMapMissingNode&)
+    {
+        stateMap_->family().missing_node (info_.hash);
+        Throw();
+    }
+    return 0;
+}
+
 bool Ledger::walkLedger (beast::Journal j) const
 {
+    return walkLedger (j, 0, nullptr);
+}
+
+bool Ledger::walkLedger (beast::Journal j, int window,
+    std::function<bool ()> const& stopping) const
+{
+    auto const walk = [&](SHAMap const& map,
+        std::vector <SHAMapMissingNode>& missingNodes)
+    {
+        if (window > 0)
+            map.walkMap (missingNodes, 32, window, stopping);
+        else
+            map.walkMap (missingNodes, 32);
+    };
+
     std::vector <SHAMapMissingNode> missingNodes1;
     std::vector <SHAMapMissingNode> missingNodes2;
 
@@ -806,7 +876,7 @@ bool Ledger::walkLedger (beast::Journal j) const
     }
     else
     {
-        stateMap_->walkMap (missingNodes1, 32);
+        walk (*stateMap_, missingNodes1);
     }
 
     if (ShouldLog (lsINFO, Ledger) && !missingNodes1.empty ())
@@ -825,7 +895,7 @@ bool Ledger::walkLedger (beast::Journal j) const
     }
     else
     {
-        txMap_->walkMap (missingNodes2, 32);
+        walk (*txMap_, missingNodes2);
     }
 
     if (ShouldLog (lsINFO, Ledger) && !missingNodes2.empty ())
@@ -836,6 +906,9 @@ bool Ledger::walkLedger (beast::Journal j) const
             << "First: " << missingNodes2[0];
     }
 
+    if (stopping && stopping ())
+        return false;
+
     return missingNodes1.empty () && missingNodes2.empty ();
 }
 
@@ -930,198 +1003,359 @@ void Ledger::updateSkipList ()
         rawReplace(sle);
 }
 
-static bool saveValidatedLedger (
-    Application& app, std::shared_ptr<Ledger> const& ledger, bool current)
+// The rows of ledgers in the transaction database, column by column
+struct TxnRows
 {
-    auto j = app.journal ("Ledger");
+    std::vector<std::uint32_t> seqs;
+    std::vector<std::string> txIDs, txBinIDs;
+    std::vector<std::string> actTxIDs, actAccounts, actTypes;
+    std::vector<std::uint32_t> actSeqs, actTxnSeqs;
+    std::vector<std::string> binTxIDs, binAccounts, binTypes;
+    std::vector<std::uint32_t> binSeqs, binTxnSeqs;
+    std::vector<std::string> txTypes, txAccounts, txStatus, txRaw, txMeta;
+    std::vector<std::uint32_t> txFromSeqs, txSeqs, txCloseTimes;
+};
 
-     if (! app.pendingSaves().startWork (ledger->info().seq))
-     {
-         // The save was completed synchronously
-         JLOG (j.debug) << "Save aborted";
-         return true;
-     }
+static void addTxnRows (Application& app, ReadView const& ledger,
+    AcceptedLedger const& aLedger, AccountTxMigrator::Schema schema,
+    TxnRows& rows, beast::Journal j)
+{
+    bool const legacy = schema != AccountTxMigrator::Schema::binary;
+    bool const binary = schema != AccountTxMigrator::Schema::legacy;
 
-    // TODO(tom): Fix this hard-coded SQL!
-    JLOG (j.trace)
-        << "saveValidatedLedger "
-        << (current ? "" : "fromAcquire ") << ledger->info().seq;
-    static boost::format deleteLedger (
-        "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans1 (
-        "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans2 (
-        "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-    static boost::format deleteAcctTrans (
-        "DELETE FROM AccountTransactions WHERE TransID = '%s';");
-    static boost::format transExists (
-        "SELECT Status FROM Transactions WHERE TransID = '%s';");
-    static boost::format updateTx (
-        "UPDATE Transactions SET LedgerSeq = %u, Status = '%c', TxnMeta = %s "
-        "WHERE TransID = '%s';");
-    static boost::format addLedger (
-        "INSERT OR REPLACE INTO Ledgers "
-        "(LedgerHash,LedgerSeq,PrevHash,TotalCoins,TotalCoinsVBC,ClosingTime,PrevClosingTime,"
-        "CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash) VALUES "
-        "('%s','%u','%s','%s','%s','%u','%u','%d','%u','%s','%s');");
-
-    auto seq = ledger->info().seq;
-
-    if (! ledger->info().accountHash.isNonZero ())
-    {
-        JLOG (j.fatal) << "AH is zero: "
-                                   << getJson (*ledger);
-        assert (false);
-    }
+    auto const seq = ledger.info().seq;
+    rows.seqs.push_back (seq);
 
-    if (ledger->info().accountHash != ledger->stateMap().getHash ().as_uint256())
+    for (auto const& vt : aLedger.getMap ())
     {
-        JLOG (j.fatal) << "sAL: " << ledger->info().accountHash
-                                   << " != " << ledger->stateMap().getHash ();
-        JLOG (j.fatal) << "saveAcceptedLedger: seq="
-                                   << seq << ", current=" << current;
-        assert (false);
-    }
+        // do not save dividend tx in db
+        if (vt.second->getTxnType () == ttDIVIDEND)
+            continue;
 
-    assert (ledger->info().txHash == ledger->txMap().getHash ().as_uint256());
+        uint256 transactionID = vt.second->getTransactionID ();
 
-    // Save the ledger header in the hashed object store
-    {
-        Serializer s (128);
-        s.add32 (HashPrefix::ledgerMaster);
-        ledger->addRaw (s);
-        app.getNodeStore ().store (
-            hotLEDGER, std::move (s.modData ()), ledger->info().hash);
-    }
+        app.getMasterTransaction ().inLedger (
+            transactionID, seq);
 
+        std::string const txnId (to_string (transactionID));
+        std::string const txnBinId (reinterpret_cast<char const*> (
+            transactionID.data ()), transactionID.size ());
+        std::uint32_t const txnSeq = vt.second->getTxnSeq ();
+        rows.txIDs.push_back (txnId);
+        if (binary)
+            rows.txBinIDs.push_back (txnBinId);
 
-    AcceptedLedger::pointer aLedger;
-    try
-    {
-        if (app.getTxnDB().getType()!=DatabaseCon::Type::None)
-        {
-        aLedger = app.getAcceptedLedgerCache().fetch (ledger->info().hash);
-        if (! aLedger)
+        auto const format = TxFormats::getInstance().findByType (
+            vt.second->getTxnType ());
+        assert (format != nullptr);
+        std::string const& txnType = format->getName ();
+
+        auto const& accts = vt.second->getAffected ();
+
+        if (accts.empty ())
+            JLOG (j.warning)
+                << "Transaction in ledger " << seq
+                << " affects no accounts";
+
+        for (auto const& account : accts)
         {
-            aLedger = std::make_shared<AcceptedLedger>(ledger, app.accountIDCache(), app.logs());
-            app.getAcceptedLedgerCache().canonicalize(ledger->info().hash, aLedger);
-        }
+            if (legacy)
+            {
+                rows.actTxIDs.push_back (txnId);
+                rows.actAccounts.push_back (app.accountIDCache().toBase58(account));
+                rows.actSeqs.push_back (seq);
+                rows.actTxnSeqs.push_back (txnSeq);
+                rows.actTypes.push_back (txnType);
+            }
+            if (binary)
+            {
+                rows.binTxIDs.push_back (txnBinId);
+                rows.binAccounts.emplace_back (reinterpret_cast<char const*> (
+                    account.data ()), account.size ());
+                rows.binSeqs.push_back (seq);
+                rows.binTxnSeqs.push_back (txnSeq);
+                rows.binTypes.push_back (txnType);
+            }
         }
+
+        auto const& txn = *vt.second->getTxn ();
+        Serializer rawTxn;
+        txn.add (rawTxn);
+        auto const& rawMeta = vt.second->getRawMeta ();
+
+        rows.txTypes.push_back (txnType);
+        rows.txAccounts.push_back (toBase58 (txn.getAccountID (sfAccount)));
+        rows.txFromSeqs.push_back (txn.getSequence ());
+        rows.txSeqs.push_back (seq);
+        rows.txStatus.emplace_back (1, TXN_SQL_VALIDATED);
+        rows.txCloseTimes.push_back (ledger.info ().closeTime);
+        rows.txRaw.emplace_back (rawTxn.begin (), rawTxn.end ());
+        rows.txMeta.emplace_back (rawMeta.begin (), rawMeta.end ());
     }
-    catch (std::exception const&)
-    {
-        JLOG (j.warning) << "An accepted ledger was missing nodes";
-        app.getLedgerMaster().failedSave(seq, ledger->info().hash);
-        // Clients can now trust the database for information about this
-        // ledger sequence.
-        app.pendingSaves().finishWork(seq);
-        return false;
-    }
+}
+
+// SQLite has at most 999 parameters in a statement
+static std::size_t const maxRows = 100;
+
+static void insertAccountRows (soci::session& db, TxnRows& rows)
+{
+    bulkExecute (db, maxRows,
+        "INSERT INTO AccountTransactions "
+        "(TransID, Account, LedgerSeq, TxnSeq, TransType) VALUES ",
+        "(?, ?, ?, ?, ?)", ", ", ";",
+        rows.actTxIDs, rows.actAccounts, rows.actSeqs, rows.actTxnSeqs,
+        rows.actTypes);
+    bulkExecute (db, maxRows,
+        "INSERT INTO AccountTxs "
+        "(Account, LedgerSeq, TxnSeq, TransID, TransType) VALUES ",
+        "(?, ?, ?, ?, ?)", ", ", ";",
+        rows.binAccounts, rows.binSeqs, rows.binTxnSeqs, rows.binTxIDs,
+        rows.binTypes);
+}
 
+static void insertTransactionRows (
+    soci::session& db, DatabaseCon::Type type, TxnRows& rows)
+{
+    // SQLite would store the bound strings as text
+    bulkExecute (db, maxRows,
+        STTx::getMetaSQLInsertReplaceHeader (type),
+        type == DatabaseCon::Type::MySQL ? "(?, ?, ?, ?, ?, ?, ?, ?, ?)" :
+            "(?, ?, ?, ?, ?, ?, ?, CAST(? AS BLOB), CAST(? AS BLOB))",
+        ", ", ";",
+        rows.txIDs, rows.txTypes, rows.txAccounts, rows.txFromSeqs,
+        rows.txSeqs, rows.txStatus, rows.txCloseTimes, rows.txRaw,
+        rows.txMeta);
+}
+
+void insertAcceptedLedgers (Application& app, soci::session& session,
+    std::vector<std::shared_ptr<AcceptedLedger>> const& ledgers)
+{
+    auto const j = app.journal ("Ledger");
+    auto const schema = app.getAccountTxMigrator ().getSchema ();
+
+    TxnRows rows;
+    for (auto const& aLedger : ledgers)
     {
-        auto db = app.getLedgerDB ().checkoutDb();
-        *db << boost::str (deleteLedger % seq);
+        auto const& ledger = aLedger->getLedger ();
+        addTxnRows (app, *ledger, *aLedger, schema, rows, j);
     }
 
-    try
+    insertAccountRows (session, rows);
+    insertTransactionRows (session, app.getTxnDB ().getType (), rows);
+}
+
+bool saveValidatedLedgers (
+    Application& app, std::vector<LedgerSave> const& saves)
+{
+    auto j = app.journal ("Ledger");
+
+    bool const hasTxnDB =
+        app.getTxnDB ().getType () != DatabaseCon::Type::None;
+    auto const schema = app.getAccountTxMigrator ().getSchema ();
+    bool result = true;
+
+    PendingSaves::Times times;
+    auto const started = std::chrono::steady_clock::now ();
+    auto phase = started;
+    auto const lap = [&phase]()
     {
-    if (app.getTxnDB ().getType () != DatabaseCon::Type::None)
+        auto const now = std::chrono::steady_clock::now ();
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::microseconds> (now - phase);
+        phase = now;
+        return elapsed;
+    };
+
+    // The ledgers whose saves were started here
+    std::vector<std::shared_ptr<Ledger>> ledgers;
+    TxnRows rows;
+
+    // The traced transactions, marked saved once committed
+    auto& trace = app.getTxTrace ();
+    std::vector<uint256> traced;
+
+    for (auto const& save : saves)
     {
-        auto db = app.getTxnDB ().checkoutDb ();
+        auto const& ledger = save.ledger;
+        bool const current = save.current;
 
-        // @TODO: need to check if batch improvement needed.
-        //db->batchStart();
-        soci::transaction tr(*db);
+        if (! app.pendingSaves().startWork (ledger->info().seq))
+        {
+            // The save was completed synchronously
+            JLOG (j.debug) << "Save aborted";
+            continue;
+        }
 
-        *db << boost::str (deleteTrans1 % seq);
-        *db << boost::str (deleteTrans2 % seq);
+        JLOG (j.trace)
+            << "saveValidatedLedger "
+            << (current ? "" : "fromAcquire ") << ledger->info().seq;
 
-        std::string const ledgerSeq (std::to_string (seq));
+        auto seq = ledger->info().seq;
 
-        for (auto const& vt : aLedger->getMap ())
+        if (! ledger->info().accountHash.isNonZero ())
         {
-            // do not save dividend tx in db
-            if (vt.second->getTxnType () == ttDIVIDEND)
-                continue;
+            JLOG (j.fatal) << "AH is zero: "
+                                       << getJson (*ledger);
+            assert (false);
+        }
 
-            uint256 transactionID = vt.second->getTransactionID ();
+        if (ledger->info().accountHash != ledger->stateMap().getHash ().as_uint256())
+        {
+            JLOG (j.fatal) << "sAL: " << ledger->info().accountHash
+                                       << " != " << ledger->stateMap().getHash ();
+            JLOG (j.fatal) << "saveAcceptedLedger: seq="
+                                       << seq << ", current=" << current;
+            assert (false);
+        }
 
-            app.getMasterTransaction ().inLedger (
-                transactionID, seq);
+        assert (ledger->info().txHash == ledger->txMap().getHash ().as_uint256());
 
-            std::string const txnId (to_string (transactionID));
-            std::string const txnSeq (std::to_string (vt.second->getTxnSeq ()));
+        // Save the ledger header in the hashed object store
+        {
+            Serializer s (128);
+            s.add32 (HashPrefix::ledgerMaster);
+            ledger->addRaw (s);
+            app.getNodeStore ().store (
+                hotLEDGER, std::move (s.modData ()), ledger->info().hash);
+        }
 
-            *db << boost::str (deleteAcctTrans % transactionID);
+        AcceptedLedger::pointer aLedger;
+        try
+        {
+            if (hasTxnDB)
+            {
+            aLedger = app.getAcceptedLedgerCache().fetch (ledger->info().hash);
+            if (! aLedger)
+            {
+                aLedger = std::make_shared<AcceptedLedger>(ledger, app.accountIDCache(), app.logs());
+                app.getAcceptedLedgerCache().canonicalize(ledger->info().hash, aLedger);
+            }
+            }
+        }
+        catch (std::exception const&)
+        {
+            JLOG (j.warning) << "An accepted ledger was missing nodes";
+            app.getLedgerMaster().failedSave(seq, ledger->info().hash);
+            // Clients can now trust the database for information about this
+            // ledger sequence.
+            app.pendingSaves().finishWork(seq);
+            result = false;
+            continue;
+        }
 
-            auto const& accts = vt.second->getAffected ();
+        {
+            auto db = app.getLedgerDB ().checkoutDb();
+            *db << "DELETE FROM Ledgers WHERE LedgerSeq = :seq;",
+                soci::use (seq);
+        }
 
-            if (!accts.empty ())
+        if (hasTxnDB)
+        {
+            addTxnRows (app, *ledger, *aLedger, schema, rows, j);
+            if (trace.enabled ())
             {
-                std::string sql (
-                    "INSERT INTO AccountTransactions "
-                    "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
-
-                // Try to make an educated guess on how much space we'll need
-                // for our arguments. In argument order we have:
-                // 64 + 34 + 10 + 10 = 118 + 10 extra = 128 bytes
-                sql.reserve (sql.length () + (accts.size () * 128));
-
-                bool first = true;
-                for (auto const& account : accts)
-                {
-                    if (!first)
-                        sql += ", ('";
-                    else
-                    {
-                        sql += "('";
-                        first = false;
-                    }
-
-                    sql += txnId;
-                    sql += "','";
-                    sql += app.accountIDCache().toBase58(account);
-                    sql += "',";
-                    sql += ledgerSeq;
-                    sql += ",";
-                    sql += txnSeq;
-                    sql += ")";
-                }
-                sql += ";";
-                if (ShouldLog (lsTRACE, Ledger))
-                {
-                    JLOG (j.trace) << "ActTx: " << sql;
-                }
-                *db << sql;
+                for (auto const& vt : aLedger->getMap ())
+                    if (trace.sampled (vt.second->getTransactionID ()))
+                        traced.push_back (vt.second->getTransactionID ());
             }
-            else
-                JLOG (j.warning)
-                    << "Transaction in ledger " << seq
-                    << " affects no accounts";
-
-            *db <<
-               (STTx::getMetaSQLInsertReplaceHeader (app.getTxnDB ().getType ()) +
-                vt.second->getTxn ()->getMetaSQL (
-                    seq, vt.second->getEscMeta (), ledger->info ().closeTime) + ";");
         }
+        ledgers.push_back (ledger);
+    }
+    times.accepted = lap ();
+
+    if (ledgers.empty ())
+        return result;
+    times.saves = ledgers.size ();
+
+    try
+    {
+    if (hasTxnDB)
+    {
+        auto db = app.getTxnDB ().checkoutDb ();
+        times.accepted += lap ();
+
+        // Every ledger of the batch is written in one transaction
+        soci::transaction tr(*db);
+
+        bulkExecute (*db, maxRows,
+            "DELETE FROM Transactions WHERE LedgerSeq IN (", "?", ",", ");",
+            rows.seqs);
+        if (schema != AccountTxMigrator::Schema::binary)
+        {
+            bulkExecute (*db, maxRows,
+                "DELETE FROM AccountTransactions WHERE LedgerSeq IN (", "?", ",", ");",
+                rows.seqs);
+            bulkExecute (*db, maxRows,
+                "DELETE FROM AccountTransactions WHERE TransID IN (", "?", ",", ");",
+                rows.txIDs);
+        }
+        if (schema != AccountTxMigrator::Schema::legacy)
+        {
+            bulkExecute (*db, maxRows,
+                "DELETE FROM AccountTxs WHERE LedgerSeq IN (", "?", ",", ");",
+                rows.seqs);
+            bulkExecute (*db, maxRows,
+                "DELETE FROM AccountTxs WHERE TransID IN (", "?", ",", ");",
+                rows.txBinIDs);
+        }
+        times.deletes = lap ();
+
+        insertAccountRows (*db, rows);
+        times.accounts = lap ();
+
+        insertTransactionRows (*db, app.getTxnDB ().getType (), rows);
+        times.transactions = lap ();
 
         tr.commit ();
-        //db->batchCommit();
+        times.commit = lap ();
+
+        for (auto const& id : traced)
+            trace.mark (id, TxTrace::Phase::saved);
     }
 
 
+    for (auto const& ledger : ledgers)
     {
         auto db (app.getLedgerDB ().checkoutDb ());
 
-        // TODO(tom): ARG!
-        *db << boost::str (
-            addLedger %
-            to_string (ledger->info().hash) % seq % to_string (ledger->info().parentHash) %
-            to_string (ledger->info().drops) % to_string (ledger->info().dropsVBC) % ledger->info().closeTime %
-            ledger->info().parentCloseTime % ledger->info().closeTimeResolution %
-            ledger->info().closeFlags % to_string (ledger->info().accountHash) %
-            to_string (ledger->info().txHash));
+        auto const& info = ledger->info ();
+        // soci reads bound values when the statement runs
+        std::string const hash (to_string (info.hash));
+        std::string const parentHash (to_string (info.parentHash));
+        std::string const drops (to_string (info.drops));
+        std::string const dropsVBC (to_string (info.dropsVBC));
+        std::string const accountHash (to_string (info.accountHash));
+        std::string const txHash (to_string (info.txHash));
+        *db <<
+            "INSERT OR REPLACE INTO Ledgers "
+            "(LedgerHash,LedgerSeq,PrevHash,TotalCoins,TotalCoinsVBC,"
+            "ClosingTime,PrevClosingTime,CloseTimeRes,CloseFlags,"
+            "AccountSetHash,TransSetHash) VALUES "
+            "(:hash,:seq,:prev,:coins,:coinsVBC,:close,:prevClose,"
+            ":resolution,:flags,:accountHash,:txHash);",
+            soci::use (hash),
+            soci::use (info.seq),
+            soci::use (parentHash),
+            soci::use (drops),
+            soci::use (dropsVBC),
+            soci::use (info.closeTime),
+            soci::use (info.parentCloseTime),
+            soci::use (info.closeTimeResolution),
+            soci::use (info.closeFlags),
+            soci::use (accountHash),
+            soci::use (txHash);
     }
+    times.ledger = lap ();
+
+    app.pendingSaves().addTimes (times);
+    JLOG (j.debug) << "Saved " << ledgers.size () << " ledgers to " <<
+        ledgers.back ()->info ().seq <<
+        " accepted " << times.accepted.count () <<
+        "us, deletes " << times.deletes.count () <<
+        "us, accounts " << times.accounts.count () <<
+        "us, transactions " << times.transactions.count () <<
+        "us, commit " << times.commit.count () <<
+        "us, ledger " << times.ledger.count () << "us";
     }
     catch (std::exception const& e)
     {
@@ -1133,7 +1367,7 @@ static bool saveValidatedLedger (
             try
             {
                 //std::this_thread::sleep_for (std::chrono::seconds (3));
-                app.getTxnDB ().getSession ().reconnect ();
+                app.getTxnDB ().reconnect ();
                 app.getTxnDB ().finishReconnection ();
                 JLOG (j.warning) << "Mysql reconncetion success";
             }
@@ -1145,10 +1379,18 @@ static bool saveValidatedLedger (
         }
     }
 
+    // The ledgers of the batch share its time
+    auto const share = (std::chrono::steady_clock::now () - started) /
+        ledgers.size ();
+    for (auto const& ledger : ledgers)
+        app.getLedgerCloseTimings ().add (ledger->info().seq,
+            LedgerCloseTimings::Phase::save, share);
+
     // Clients can now trust the database for
-    // information about this ledger sequence.
-    app.pendingSaves().finishWork(seq);
-    return true;
+    // information about these ledger sequences.
+    for (auto const& ledger : ledgers)
+        app.pendingSaves().finishWork(ledger->info().seq);
+    return result;
 }
 
 /** Save, or arrange to save, a fully-validated ledger
@@ -1185,22 +1427,9 @@ bool pendSaveValidated (Application& app,
     }
 
     if (isSynchronous)
-        return saveValidatedLedger(app, ledger, isCurrent);
+        return saveValidatedLedgers(app, {{ledger, isCurrent}});
 
-    auto job = [ledger, &app, isCurrent] (Job&) {
-        saveValidatedLedger(app, ledger, isCurrent);
-    };
-
-    if (isCurrent)
-    {
-        app.getJobQueue().addJob(
-            jtPUBLEDGER, "Ledger::pendSave", job);
-    }
-    else
-    {
-        app.getJobQueue ().addJob(
-            jtPUBOLDLEDGER, "Ledger::pendOldSave", job);
-    }
+    app.getLedgerMaster().getLedgerSaver().save(ledger, isCurrent);
 
     return true;
 }
@@ -32,10 +32,17 @@
 #include <ripple/shamap/SHAMap.h>
 #include <beast/utility/Journal.h>
 #include <boost/optional.hpp>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+namespace soci {
+class session;
+}
 
 namespace ripple {
 
+class AcceptedLedger;
 class Application;
 class Job;
 class TransactionMaster;
@@ -164,6 +171,9 @@ public:
     std::shared_ptr<SLE const>
     read (Keylet const& k) const override;
 
+    void
+    prefetch (std::vector<key_type> const& keys) const override;
+
     std::unique_ptr<sles_type::iter_base>
     slesBegin() const override;
 
@@ -340,6 +350,16 @@ public:
 
     void visitStateItems (std::function<void (SLE::ref)>) const;
 
+    /** Visit the state entries of one type on several threads.
+        The state map is split into partitions `depth` levels below its
+        root, as by SHAMap::visitPartitions. Entries of other types are
+        skipped before they are deserialized, ltANY visits them all.
+        @return The number of partitions, by which the caller merges the
+                results it keeps for each.
+    */
+    std::size_t visitStateItems (LedgerEntryType type, int depth,
+        std::size_t threads, SHAMap::PartitionVisitor const& visitor) const;
+
 
     std::vector<uint256> getNeededTransactionHashes (
         int max, SHAMapSyncFilter* filter) const;
@@ -349,6 +369,13 @@ public:
 
     bool walkLedger (beast::Journal j) const;
 
+    /** Check every node of the ledger is in the node store, keeping up to
+        window reads outstanding, without keeping the nodes in memory.
+        Returns false early when stopping returns true.
+    */
+    bool walkLedger (beast::Journal j, int window,
+        std::function<bool ()> const& stopping) const;
+
     bool assertSane (beast::Journal ledgerJ);
 
 private:
@@ -391,6 +418,36 @@ using CachedLedger = CachedView<Ledger>;
 //
 //------------------------------------------------------------------------------
 
+struct LedgerSave
+{
+    std::shared_ptr<Ledger> ledger;
+    bool current;
+};
+
+/** Save validated ledgers to the SQL databases.
+
+    The transactions of all the ledgers are written in one SQL
+    transaction.
+
+    @return 'false' if a ledger was missing nodes
+*/
+bool
+saveValidatedLedgers (
+    Application& app,
+    std::vector<LedgerSave> const& saves);
+
+/** Insert the transactions of accepted ledgers into the transaction
+    database, in the caller's SQL transaction.
+
+    Unlike saveValidatedLedgers, rows already stored for these ledgers
+    are not deleted first, and the ledger headers are not saved.
+*/
+void
+insertAcceptedLedgers (
+    Application& app,
+    soci::session& session,
+    std::vector<std::shared_ptr<AcceptedLedger>> const& ledgers);
+
 extern
 bool
 pendSaveValidated(
@@ -0,0 +1,121 @@
+#ifndef RIPPLE_APP_LEDGER_LEDGERCLOSETIMINGS_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERCLOSETIMINGS_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/Protocol.h>
+#include <ripple/protocol/TxFormats.h>
+#include <beast/insight/Collector.h>
+#include <beast/insight/Event.h>
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace ripple {
+
+/** Where the time went while closing the last few ledgers.
+
+    For each ledger this keeps the time spent in every phase of building,
+    storing, saving and publishing it, and the time spent applying each
+    type of transaction to it. Every phase is also reported to the insight
+    collector as an event.
+*/
+class LedgerCloseTimings
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    enum class Phase
+    {
+        apply,          // applying the consensus transactions
+        write,          // writing the applied view into the ledger
+        flush,          // hashing and flushing the dirty map nodes
+        accept,         // hashing the accepted ledger
+        storeBatch,     // writing node batches to the node store
+        save,           // saving the validated ledger to SQL
+        publish         // publishing the validated ledger
+    };
+
+    static std::size_t const phaseCount = 7;
+
+    /** Adds the time from construction to destruction to a phase. */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (LedgerCloseTimings& timings,
+                LedgerIndex seq, Phase phase)
+            : timings_ (timings)
+            , seq_ (seq)
+            , phase_ (phase)
+            , start_ (clock_type::now ())
+        {
+        }
+
+        ScopedTimer (ScopedTimer const&) = delete;
+        ScopedTimer& operator= (ScopedTimer const&) = delete;
+
+        ~ScopedTimer ()
+        {
+            timings_.add (seq_, phase_, clock_type::now () - start_);
+        }
+
+    private:
+        LedgerCloseTimings& timings_;
+        LedgerIndex seq_;
+        Phase phase_;
+        clock_type::time_point start_;
+    };
+
+    LedgerCloseTimings (std::size_t size,
+        beast::insight::Collector::ptr const& collector);
+
+    LedgerCloseTimings (LedgerCloseTimings const&) = delete;
+    LedgerCloseTimings& operator= (LedgerCloseTimings const&) = delete;
+
+    /** Add time spent on a ledger in one phase. */
+    void add (LedgerIndex seq, Phase phase, std::chrono::nanoseconds elapsed);
+
+    /** Add time spent applying one transaction to a ledger. */
+    void addTx (LedgerIndex seq, TxType type, std::chrono::nanoseconds elapsed);
+
+    /** Add time spent writing a batch to the node store.
+        Batches are not written for one ledger, so the time is added to
+        the newest ledger.
+    */
+    void addStoreBatch (std::chrono::nanoseconds elapsed);
+
+    /** Record the hash a ledger was given once it was accepted. */
+    void setHash (LedgerIndex seq, uint256 const& hash);
+
+    /** The timings of the newest ledgers, newest first. */
+    Json::Value getJson (std::size_t limit) const;
+
+    static char const* getName (Phase phase);
+
+private:
+    struct TxTimes
+    {
+        std::uint64_t count = 0;
+        std::chrono::nanoseconds elapsed {0};
+    };
+
+    struct Record
+    {
+        uint256 hash;
+        std::array<std::chrono::nanoseconds, phaseCount> phases {};
+        std::map<TxType, TxTimes> txs;
+    };
+
+    // Returns nullptr if the ledger is older than every one kept
+    Record* find (LedgerIndex seq);
+
+    std::size_t const size_;
+    std::mutex mutable mutex_;
+    std::map<LedgerIndex, Record> records_;
+    std::array<beast::insight::Event, phaseCount> events_;
+};
+
+} // ripple
+
+#endif
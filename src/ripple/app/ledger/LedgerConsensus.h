@@ -77,6 +77,8 @@ public:
                                 ledger).
   @param retriableTransactions collect failed transactions in this set
   @param openLgr               true if applyLedger is open, else false.
+  @param applied               if set, collects the transactions applied,
+                               in the order they were applied
 */
 void applyTransactions (
     Application& app,
@@ -84,7 +86,8 @@ void applyTransactions (
     OpenView& view,
     Ledger::ref checkLedger,
     CanonicalTXSet& retriableTransactions,
-    ApplyFlags flags);
+    ApplyFlags flags,
+    std::vector<std::shared_ptr<STTx const>>* applied = nullptr);
 
 /** Apply a single transaction to a ledger
   @param view                   The open view to apply to
@@ -36,6 +36,10 @@ namespace ripple {
 #define CACHED_LEDGER_AGE 120
 #endif
 
+#ifndef RECENT_LEDGER_NUM
+#define RECENT_LEDGER_NUM 64
+#endif
+
 // FIXME: Need to clean up ledgers by index at some point
 
 LedgerHistory::LedgerHistory (
@@ -48,6 +52,7 @@ LedgerHistory::LedgerHistory (
         stopwatch(), app_.journal("TaggedCache"))
     , m_consensus_validated ("ConsensusValidated", 64, 300,
         stopwatch(), app_.journal("TaggedCache"))
+    , recent_ (RECENT_LEDGER_NUM)
     , j_ (app.journal ("LedgerHistory"))
 {
 }
@@ -62,7 +67,10 @@ bool LedgerHistory::addLedger (Ledger::pointer ledger, bool validated)
     const bool alreadyHad = m_ledgers_by_hash.canonicalize (
         ledger->getHash(), ledger, true);
     if (validated)
+    {
         mLedgersByIndex[ledger->info().seq] = ledger->getHash();
+        recent_.insert (ledger);
+    }
 
     return alreadyHad;
 }
@@ -80,6 +88,9 @@ LedgerHash LedgerHistory::getLedgerHash (LedgerIndex index)
 
 Ledger::pointer LedgerHistory::getLedgerBySeq (LedgerIndex index)
 {
+    if (auto ret = recent_.get (index))
+        return ret;
+
     {
         LedgersByHash::ScopedLockType sl (m_ledgers_by_hash.peekMutex ());
         auto it = mLedgersByIndex.find (index);
@@ -376,7 +387,7 @@ void LedgerHistory::handleMismatch (
         }
         else
         {
-            if ((*b)->peekData() != (*v)->peekData())
+            if ((*b)->slice() != (*v)->slice())
             {
                 // Same transaction with different metadata
                 log_metadata_difference(builtLedger, validLedger, (*b)->key(), j_);
@@ -433,6 +444,8 @@ void LedgerHistory::validatedLedger (Ledger::ref ledger)
     }
 
     entry->validated.emplace (hash);
+    if (ledger->isImmutable ())
+        recent_.insert (ledger);
 }
 
 /** Ensure m_ledgers_by_hash doesn't have the wrong hash for a particular index
@@ -446,6 +459,7 @@ bool LedgerHistory::fixIndex (
     if ((it != mLedgersByIndex.end ()) && (it->second != ledgerHash) )
     {
         it->second = ledgerHash;
+        recent_.erase (ledgerIndex, ledgerHash);
         return false;
     }
     return true;
@@ -459,6 +473,7 @@ void LedgerHistory::tune (int size, int age)
 
 void LedgerHistory::clearLedgerCachePrior (LedgerIndex seq)
 {
+    recent_.clearPrior (seq);
     for (LedgerHash it: m_ledgers_by_hash.getKeys())
     {
         if (getLedgerByHash (it)->info().seq < seq)
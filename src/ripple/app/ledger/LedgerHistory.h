@@ -21,6 +21,7 @@
 #define RIPPLE_APP_LEDGER_LEDGERHISTORY_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/RecentLedgers.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <beast/insight/Collector.h>
@@ -50,11 +51,38 @@ public:
         return m_ledgers_by_hash.getHitRate ();
     }
 
+    /** Get the ledgers_by_hash cache hits, then its misses */
+    std::pair <std::uint64_t, std::uint64_t> getCacheHitsAndMisses () const
+    {
+        return m_ledgers_by_hash.getHitsAndMisses ();
+    }
+
+    /** Get the number of ledgers cached by hash */
+    int getCacheSize () const
+    {
+        return m_ledgers_by_hash.getCacheSize ();
+    }
+
+    /** Set the number of ledgers kept by hash, keeping their age */
+    void setCacheSize (int size)
+    {
+        m_ledgers_by_hash.setTargetSize (size);
+    }
+
     /** Get a ledger given its squence number
         @param ledgerIndex The sequence number of the desired ledger
     */
     Ledger::pointer getLedgerBySeq (LedgerIndex ledgerIndex);
 
+    /** Get one of the most recent validated ledgers without locking
+        @param ledgerIndex The sequence number of the desired ledger
+        @return The ledger, or nullptr if it is not one of them
+    */
+    Ledger::pointer getRecentLedger (LedgerIndex ledgerIndex) const
+    {
+        return recent_.get (ledgerIndex);
+    }
+
     /** Get a ledger's hash given its sequence number
         @param ledgerIndex The sequence number of the desired ledger
         @return The hash of the specified ledger
@@ -132,6 +160,9 @@ private:
     // Maps ledger indexes to the corresponding hash.
     std::map <LedgerIndex, LedgerHash> mLedgersByIndex; // validated ledgers
 
+    // The last validated ledgers, for lookups by sequence
+    RecentLedgers recent_;
+
     beast::Journal j_;
 };
 
@@ -20,13 +20,13 @@
 #ifndef RIPPLE_APP_LEDGER_LEDGERHOLDER_H_INCLUDED
 #define RIPPLE_APP_LEDGER_LEDGERHOLDER_H_INCLUDED
 
-#include <mutex>
+#include <memory>
 
 namespace ripple {
 
-// Can std::atomic<std::shared_ptr>> make this lock free?
-
 /** Hold a ledger in a thread-safe way.
+    The ledger is swapped with atomic shared_ptr operations, so readers
+    never wait on a writer.
 */
 class LedgerHolder
 {
@@ -38,17 +38,13 @@ public:
         if (ledger && !ledger->isImmutable ())
            ledger = std::make_shared <Ledger> (*ledger, false);
 
-        {
-            std::lock_guard <std::mutex> sl (m_lock);
-            m_heldLedger = ledger;
-        }
+        std::atomic_store (&m_heldLedger, ledger);
     }
 
     // Return the (immutable) held ledger
     Ledger::pointer get ()
     {
-        std::lock_guard <std::mutex> sl (m_lock);
-        return m_heldLedger;
+        return std::atomic_load (&m_heldLedger);
     }
 
     // Return a mutable snapshot of the held ledger
@@ -60,12 +56,10 @@ public:
 
     bool empty ()
     {
-        std::lock_guard <std::mutex> sl (m_lock);
-        return m_heldLedger == nullptr;
+        return get () == nullptr;
     }
 
 private:
-    std::mutex m_lock;
     Ledger::pointer m_heldLedger;
 };
 
@@ -37,6 +37,7 @@
 
 namespace ripple {
 
+class LedgerSaver;
 class Peer;
 class Transaction;
 
@@ -156,6 +157,9 @@ public:
     virtual void tune (int size, int age) = 0;
     virtual void sweep () = 0;
     virtual float getCacheHitRate () = 0;
+    virtual std::pair <std::uint64_t, std::uint64_t> getCacheHitsAndMisses () = 0;
+    virtual int getCacheSize () = 0;
+    virtual void setCacheSize (int size) = 0;
 
     virtual void checkAccept (Ledger::ref ledger) = 0;
     virtual void checkAccept (uint256 const& hash, std::uint32_t seq) = 0;
@@ -173,6 +177,8 @@ public:
         LedgerIndex ledgerIndex, LedgerHash const& ledgerHash) = 0;
     virtual void doLedgerCleaner(Json::Value const& parameters) = 0;
 
+    virtual LedgerSaver& getLedgerSaver () = 0;
+
     virtual beast::PropertyStream::Source& getPropertySource () = 0;
 
     virtual void clearPriorLedgers (LedgerIndex seq) = 0;
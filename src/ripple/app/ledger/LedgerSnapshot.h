@@ -0,0 +1,242 @@
+#ifndef RIPPLE_APP_LEDGER_LEDGERSNAPSHOT_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERSNAPSHOT_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/shamap/SHAMap.h>
+#include <beast/utility/Journal.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+class Ledger;
+
+/** The state map of a closed ledger as a flat, memory-mapped file.
+
+    The leaves are stored in key order, each as its key, its size and its
+    data. Every indexInterval-th key is also kept with its offset in an
+    index at the end of the file, so a lookup searches the index and then
+    reads at most indexInterval leaves. Reads go to the pages of the
+    mapping, never to the tree node cache or the node store.
+*/
+class LedgerSnapshot
+{
+public:
+    /** Leaves between the keys of the index. */
+    static std::size_t const indexInterval = 64;
+
+    /** Write the state map of a ledger to a file.
+
+        The file is written under a temporary name and renamed, so an
+        existing snapshot is only replaced by a complete one.
+        Throws on I/O errors and on missing nodes.
+    */
+    static
+    void
+    write (boost::filesystem::path const& path,
+        LedgerInfo const& info, SHAMap const& stateMap);
+
+    /** Map an existing snapshot. Throws if it is not a valid snapshot. */
+    explicit
+    LedgerSnapshot (boost::filesystem::path const& path);
+
+    LedgerSnapshot (LedgerSnapshot const&) = delete;
+    LedgerSnapshot& operator= (LedgerSnapshot const&) = delete;
+
+    LedgerIndex
+    seq () const
+    {
+        return seq_;
+    }
+
+    uint256 const&
+    hash () const
+    {
+        return hash_;
+    }
+
+    uint256 const&
+    accountHash () const
+    {
+        return accountHash_;
+    }
+
+    /** Number of state items. */
+    std::uint64_t
+    size () const
+    {
+        return count_;
+    }
+
+    /** The offset of a leaf, end() past the last one. */
+    using position = std::uint64_t;
+
+    position
+    begin () const
+    {
+        return leavesBegin_;
+    }
+
+    position
+    end () const
+    {
+        return leavesEnd_;
+    }
+
+    /** The first leaf with a key not less than key. */
+    position
+    lower_bound (uint256 const& key) const;
+
+    /** The first leaf with a key greater than key. */
+    position
+    upper_bound (uint256 const& key) const;
+
+    position
+    next (position pos) const;
+
+    uint256
+    key (position pos) const;
+
+    Slice
+    data (position pos) const;
+
+    /** The data of the item with key, empty if there is none. */
+    boost::optional<Slice>
+    find (uint256 const& key) const;
+
+private:
+    /** Throws if the leaf at pos does not fit in the file. */
+    std::uint32_t
+    leafSize (position pos) const;
+
+    std::uint8_t const*
+    at (position pos) const
+    {
+        return static_cast<std::uint8_t const*> (
+            region_.get_address ()) + pos;
+    }
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+
+    LedgerIndex seq_ = 0;
+    uint256 hash_;
+    uint256 accountHash_;
+    std::uint64_t count_ = 0;
+    position leavesBegin_ = 0;
+    position leavesEnd_ = 0;
+    std::uint64_t indexCount_ = 0;
+};
+
+//------------------------------------------------------------------------------
+
+/** A closed ledger whose state items are read from its snapshot.
+
+    The header, fees, rules and transactions come from the ledger itself.
+*/
+class SnapshotView
+    : public ReadView
+{
+public:
+    SnapshotView (std::shared_ptr<ReadView const> const& base,
+        std::shared_ptr<LedgerSnapshot const> const& snapshot);
+
+    LedgerInfo const&
+    info () const override;
+
+    Fees const&
+    fees () const override;
+
+    Rules const&
+    rules () const override;
+
+    bool
+    exists (Keylet const& k) const override;
+
+    boost::optional<key_type>
+    succ (key_type const& key, boost::optional<
+        key_type> const& last = boost::none) const override;
+
+    std::shared_ptr<SLE const>
+    read (Keylet const& k) const override;
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin () const override;
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd () const override;
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound (key_type const& key) const override;
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin () const override;
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd () const override;
+
+    bool
+    txExists (key_type const& key) const override;
+
+    tx_type
+    txRead (key_type const& key) const override;
+
+private:
+    class sles_iter_impl;
+
+    std::shared_ptr<ReadView const> base_;
+    std::shared_ptr<LedgerSnapshot const> snapshot_;
+};
+
+//------------------------------------------------------------------------------
+
+/** The ledger snapshots kept in the directory named by [ledger_snapshots].
+
+    Snapshots are written on request and opened the first time a view of
+    their ledger is asked for.
+*/
+class LedgerSnapshots
+{
+public:
+    LedgerSnapshots (Section const& section, beast::Journal journal);
+
+    /** Returns true if a directory for snapshots is configured. */
+    bool
+    enabled () const
+    {
+        return !path_.empty ();
+    }
+
+    /** Write the snapshot of a closed ledger. Throws on failure. */
+    void
+    add (Ledger const& ledger);
+
+    /** A view of a closed ledger reading state from its snapshot.
+        @return nullptr if the ledger has no snapshot.
+    */
+    std::shared_ptr<ReadView const>
+    view (std::shared_ptr<ReadView const> const& ledger);
+
+private:
+    boost::filesystem::path
+    file (LedgerIndex seq) const;
+
+    boost::filesystem::path path_;
+    beast::Journal journal_;
+
+    std::mutex mutex_;
+    std::map<LedgerIndex, std::shared_ptr<LedgerSnapshot const>> snapshots_;
+};
+
+}
+
+#endif
@@ -38,8 +38,9 @@ public:
     // Add a new local transaction
     virtual void push_back (LedgerIndex index, std::shared_ptr<STTx const> const& txn) = 0;
 
-    // Return the set of local transactions to a new open ledger
-    virtual CanonicalTXSet getTxSet () = 0;
+    // Return the set of local transactions to a new open ledger.
+    // The set is shared until the local transactions change.
+    virtual std::shared_ptr<CanonicalTXSet const> getTxSet () = 0;
 
     // Remove obsolete transactions based on a new fully-valid ledger
     virtual void sweep (Ledger::ref validLedger) = 0;
@@ -24,12 +24,14 @@
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/ledger/OpenView.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/core/Config.h>
 #include <beast/utility/Journal.h>
 #include <cassert>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
@@ -198,6 +200,30 @@ private:
         std::shared_ptr< STTx const> const& tx,
             bool retry, ApplyFlags flags,
                 beast::Journal j);
+
+    // Threads for apply_parallel, zero to apply serially
+    static
+    int
+    parallelThreads (Application& app,
+        ReadView const& view);
+
+    /*  Apply the transactions in order, with the same
+        results as one apply_one after the other.
+
+        A window of transactions at a time is applied on
+        several threads, each against the view as it was
+        before the window and recording what it read. Then
+        in order, the changes of those that read nothing
+        an earlier one changed are committed and the others
+        are applied again.
+    */
+    static
+    void
+    apply_parallel (Application& app, OpenView& view,
+        ReadView const& check, std::vector<std::shared_ptr<
+            STTx const>> const& txs, OrderedTxs& retries,
+                ApplyFlags flags, int threads,
+                    beast::Journal j);
 };
 
 //------------------------------------------------------------------------------
@@ -209,6 +235,7 @@ OpenLedger::apply (Application& app, OpenView& view,
         OrderedTxs& retries, ApplyFlags flags,
             beast::Journal j)
 {
+    std::vector<std::shared_ptr<STTx const>> candidates;
     for (auto iter = txs.begin();
         iter != txs.end(); ++iter)
     {
@@ -216,14 +243,7 @@ OpenLedger::apply (Application& app, OpenView& view,
         {
             // Dereferencing the iterator can
             // throw since it may be transformed.
-            auto const tx = *iter;
-            if (check.txExists(tx->getTransactionID()) ||
-                view.txExists (tx->getTransactionID ()))
-                continue;
-            auto const result = apply_one(app, view,
-                tx, true, flags, j);
-            if (result == Result::retry)
-                retries.insert(tx);
+            candidates.push_back (*iter);
         }
         catch(std::exception const&)
         {
@@ -231,6 +251,36 @@ OpenLedger::apply (Application& app, OpenView& view,
                 "Caught exception";
         }
     }
+    if (auto const threads = parallelThreads (app, view))
+    {
+        apply_parallel (app, view, check, candidates,
+            retries, flags, threads, j);
+    }
+    else
+    {
+        TxPrefetch prefetch (view);
+        for (auto iter = candidates.begin();
+            iter != candidates.end(); ++iter)
+        {
+            prefetch (iter, candidates.end());
+            try
+            {
+                auto const& tx = *iter;
+                if (check.txExists(tx->getTransactionID()) ||
+                    view.txExists (tx->getTransactionID ()))
+                    continue;
+                auto const result = apply_one(app, view,
+                    tx, true, flags, j);
+                if (result == Result::retry)
+                    retries.insert(tx);
+            }
+            catch(std::exception const&)
+            {
+                JLOG(j.error) <<
+                    "Caught exception";
+            }
+        }
+    }
     bool retry = true;
     for (int pass = 0;
         pass < LEDGER_TOTAL_PASSES;
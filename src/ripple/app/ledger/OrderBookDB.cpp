@@ -25,15 +25,51 @@
 #include <ripple/basics/Log.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/json/to_string.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/JsonFields.h>
+#include <boost/optional.hpp>
+#include <algorithm>
 
 namespace ripple {
 
+namespace {
+
+// Fields equal to zero are left out of the metadata of a created entry
+uint160
+bookDirField (STObject const& dir, SField const& field)
+{
+    if (! dir.isFieldPresent (field))
+        return uint160 ();
+    return dir.getFieldH160 (field);
+}
+
+// The book of a directory, if it is the first page of one of its qualities
+boost::optional<Book>
+qualityRootBook (STObject const& dir, uint256 const& index)
+{
+    if (! dir.isFieldPresent (sfExchangeRate) ||
+            ! dir.isFieldPresent (sfRootIndex) ||
+            dir.getFieldH256 (sfRootIndex) != index)
+        return boost::none;
+
+    Book book;
+    book.in.currency.copyFrom (bookDirField (dir, sfTakerPaysCurrency));
+    book.in.account.copyFrom (bookDirField (dir, sfTakerPaysIssuer));
+    book.out.account.copyFrom (bookDirField (dir, sfTakerGetsIssuer));
+    book.out.currency.copyFrom (bookDirField (dir, sfTakerGetsCurrency));
+    return book;
+}
+
+}
+
 OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , app_ (app)
+    , mBooks (std::make_shared<Books const> ())
+    , mUpdating (false)
     , mSeq (0)
+    , mBuiltSeq (0)
     , j_ (app.journal ("OrderBookDB"))
 {
 }
@@ -42,37 +78,47 @@ void OrderBookDB::invalidate ()
 {
     std::lock_guard <std::recursive_mutex> sl (mLock);
     mSeq = 0;
+    mBuiltSeq = 0;
 }
 
 void OrderBookDB::setup(
     std::shared_ptr<ReadView const> const& ledger)
 {
+    if (app_.config().PATH_SEARCH_MAX == 0)
     {
-        std::lock_guard <std::recursive_mutex> sl (mLock);
-        auto seq = ledger->info().seq;
-
-        // Do a full update every 256 ledgers
-        if (mSeq != 0)
-        {
-            if (seq == mSeq)
-                return;
-            if ((seq > mSeq) && ((seq - mSeq) < 256))
-                return;
-            if ((seq < mSeq) && ((mSeq - seq) < 16))
-                return;
-        }
-
-        JLOG (j_.debug)
-            << "Advancing from " << mSeq << " to " << seq;
-
-        mSeq = seq;
+        // nothing to do
+        return;
     }
 
-    if (app_.config().PATH_SEARCH_MAX == 0)
+    std::lock_guard <std::recursive_mutex> sl (mLock);
+    auto seq = ledger->info().seq;
+
+    // The books follow the metadata of every published ledger, so
+    // they are rebuilt only if there are none or ledgers were skipped
+    if (mSeq != 0)
     {
-        // nothing to do
+        if ((seq <= mSeq + 1) && ((seq + 16) > mSeq))
+            return;
     }
-    else if (app_.config().RUN_STANDALONE)
+
+    JLOG (j_.debug)
+        << "Advancing from " << mSeq << " to " << seq;
+
+    mSeq = seq;
+    if (mUpdating)
+        mNext = ledger;
+    else
+        startUpdate (ledger);
+}
+
+// Caller must hold the lock
+void OrderBookDB::startUpdate(
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    mUpdating = true;
+    mPending.clear ();
+
+    if (app_.config().RUN_STANDALONE)
         update(ledger);
     else
         app_.getJobQueue().addJob(
@@ -83,16 +129,16 @@ void OrderBookDB::setup(
 void OrderBookDB::update(
     std::shared_ptr<ReadView const> const& ledger)
 {
-    hash_set< uint256 > seen;
-    OrderBookDB::IssueToOrderBook destMap;
-    OrderBookDB::IssueToOrderBook sourceMap;
-    hash_set< Issue > XRPBooks;
+    hash_map <uint256, std::size_t> qualities;
+    auto next = std::make_shared<Books> ();
 
     JLOG (j_.debug) << "OrderBookDB::update>";
 
     if (app_.config().PATH_SEARCH_MAX == 0)
     {
         // pathfinding has been disabled
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+        mUpdating = false;
         return;
     }
 
@@ -103,28 +149,14 @@ void OrderBookDB::update(
     {
         for(auto& sle : ledger->sles)
         {
-            if (sle->getType () == ltDIR_NODE &&
-                sle->isFieldPresent (sfExchangeRate) &&
-                sle->getFieldH256 (sfRootIndex) == sle->getIndex())
+            if (sle->getType () != ltDIR_NODE)
+                continue;
+
+            if (auto const book = qualityRootBook (*sle, sle->getIndex()))
             {
-                Book book;
-                book.in.currency.copyFrom(sle->getFieldH160(
-                    sfTakerPaysCurrency));
-                book.in.account.copyFrom(sle->getFieldH160 (
-                    sfTakerPaysIssuer));
-                book.out.account.copyFrom(sle->getFieldH160(
-                    sfTakerGetsIssuer));
-                book.out.currency.copyFrom (sle->getFieldH160(
-                    sfTakerGetsCurrency));
-
-                uint256 index = getBookBase (book);
-                if (seen.insert (index).second)
+                if (++qualities[getBookBase (*book)] == 1)
                 {
-                    auto orderBook = std::make_shared<OrderBook> (index, book);
-                    sourceMap[book.in].push_back (orderBook);
-                    destMap[book.out].push_back (orderBook);
-                    if (isXRP(book.out))
-                        XRPBooks.insert(book.in);
+                    addBook (*next, *book);
                     ++books;
                 }
             }
@@ -136,6 +168,10 @@ void OrderBookDB::update(
             << "OrderBookDB::update encountered a missing node";
         std::lock_guard <std::recursive_mutex> sl (mLock);
         mSeq = 0;
+        mBuiltSeq = 0;
+        mUpdating = false;
+        mPending.clear ();
+        mNext.reset ();
         return;
     }
 
@@ -144,66 +180,157 @@ void OrderBookDB::update(
     {
         std::lock_guard <std::recursive_mutex> sl (mLock);
 
-        mXRPBooks.swap(XRPBooks);
-        mSourceMap.swap(sourceMap);
-        mDestMap.swap(destMap);
+        mQualities.swap (qualities);
+        std::atomic_store (&mBooks,
+            std::shared_ptr<Books const> (std::move (next)));
+        mBuiltSeq = ledger->info().seq;
+        mUpdating = false;
+
+        // Catch up with the ledgers published while this ran
+        auto const pending = std::move (mPending);
+        mPending.clear ();
+        applyChanges (pending);
+
+        if (mNext)
+        {
+            auto const later = std::move (mNext);
+            mNext.reset ();
+            startUpdate (later);
+        }
     }
     app_.getLedgerMaster().newOrderBookDB();
 }
 
-void OrderBookDB::addOrderBook(Book const& book)
+std::shared_ptr<OrderBookDB::Books const> OrderBookDB::books () const
 {
-    bool toXRP = isXRP (book.out);
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    return std::atomic_load (&mBooks);
+}
 
-    if (toXRP)
+// Caller must hold the lock
+void OrderBookDB::applyChanges (std::vector<BookChange> const& changes)
+{
+    std::shared_ptr<Books> next;
+    for (auto const& change : changes)
     {
-        // We don't want to search through all the to-XRP or from-XRP order
-        // books!
-        for (auto ob: mSourceMap[book.in])
+        // The books were built from a ledger which has these
+        if (change.seq <= mBuiltSeq)
+            continue;
+
+        mSeq = std::max (mSeq, change.seq);
+        auto const index = getBookBase (change.book);
+        if (change.delta > 0)
         {
-            if (isXRP (ob->getCurrencyOut ())) // also to XRP
-                return;
+            if (++mQualities[index] != 1)
+                continue;
+            if (! next)
+                next = std::make_shared<Books> (*books ());
+            addBook (*next, change.book);
+        }
+        else
+        {
+            auto const iter = mQualities.find (index);
+            if (iter == mQualities.end () || --iter->second != 0)
+                continue;
+            mQualities.erase (iter);
+            if (! next)
+                next = std::make_shared<Books> (*books ());
+            removeBook (*next, change.book);
         }
     }
-    else
+
+    if (next)
+        std::atomic_store (&mBooks,
+            std::shared_ptr<Books const> (std::move (next)));
+}
+
+void OrderBookDB::addOrderBook(Book const& book)
+{
+    auto const index = getBookBase (book);
+    auto const known = [&index](Books const& books, Issue const& issue)
     {
-        for (auto ob: mDestMap[book.out])
-        {
-            if (ob->getCurrencyIn() == book.in.currency &&
-                ob->getIssuerIn() == book.in.account)
+        auto const iter = books.sourceMap.find (issue);
+        if (iter == books.sourceMap.end ())
+            return false;
+        return std::any_of (iter->second.begin (), iter->second.end (),
+            [&index](OrderBook::pointer const& ob)
             {
-                return;
-            }
-        }
+                return ob->getBookBase () == index;
+            });
+    };
+
+    if (known (*books (), book.in))
+        return;
+
+    std::lock_guard <std::recursive_mutex> sl (mLock);
+    auto const current = books ();
+    if (known (*current, book.in))
+        return;
+    auto next = std::make_shared<Books> (*current);
+    addBook (*next, book);
+    std::atomic_store (&mBooks,
+        std::shared_ptr<Books const> (std::move (next)));
+}
+
+// A book may already be there if addOrderBook saw it first
+void OrderBookDB::addBook (Books& books, Book const& book)
+{
+    auto const index = getBookBase (book);
+    auto& source = books.sourceMap[book.in];
+    for (auto const& ob : source)
+    {
+        if (ob->getBookBase () == index)
+            return;
     }
-    uint256 index = getBookBase(book);
+
     auto orderBook = std::make_shared<OrderBook> (index, book);
 
-    mSourceMap[book.in].push_back (orderBook);
-    mDestMap[book.out].push_back (orderBook);
-    if (toXRP)
-        mXRPBooks.insert(book.in);
+    source.push_back (orderBook);
+    books.destMap[book.out].push_back (orderBook);
+    if (isXRP (book.out))
+        books.xrpBooks.insert (book.in);
+}
+
+void OrderBookDB::removeBook (Books& books, Book const& book)
+{
+    auto const index = getBookBase (book);
+    auto const drop = [&index](IssueToOrderBook& map, Issue const& issue)
+    {
+        auto const iter = map.find (issue);
+        if (iter == map.end ())
+            return;
+        auto& list = iter->second;
+        list.erase (std::remove_if (list.begin (), list.end (),
+            [&index](OrderBook::pointer const& ob)
+            {
+                return ob->getBookBase () == index;
+            }), list.end ());
+        if (list.empty ())
+            map.erase (iter);
+    };
+
+    drop (books.sourceMap, book.in);
+    drop (books.destMap, book.out);
+    if (isXRP (book.out))
+        books.xrpBooks.erase (book.in);
 }
 
 // return list of all orderbooks that want this issuerID and currencyID
 OrderBook::List OrderBookDB::getBooksByTakerPays (Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto it = mSourceMap.find (issue);
-    return it == mSourceMap.end () ? OrderBook::List() : it->second;
+    auto const current = books ();
+    auto it = current->sourceMap.find (issue);
+    return it == current->sourceMap.end () ? OrderBook::List() : it->second;
 }
 
 int OrderBookDB::getBookSize(Issue const& issue) {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    auto it = mSourceMap.find (issue);
-    return it == mSourceMap.end () ? 0 : it->second.size();
+    auto const current = books ();
+    auto it = current->sourceMap.find (issue);
+    return it == current->sourceMap.end () ? 0 : it->second.size();
 }
 
 bool OrderBookDB::isBookToXRP(Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
-    return mXRPBooks.count(issue) > 0;
+    return books ()->xrpBooks.count(issue) > 0;
 }
 
 BookListeners::pointer OrderBookDB::makeBookListeners (Book const& book)
@@ -240,10 +367,67 @@ void OrderBookDB::processTxn (
     std::shared_ptr<ReadView const> const& ledger,
         const AcceptedLedgerTx& alTx)
 {
+    // Every result changes the ledger, so the books are tracked from
+    // the directories of all of them
+    if (app_.config().PATH_SEARCH_MAX != 0)
+    {
+        auto const seq = ledger->info().seq;
+        std::vector<BookChange> changes;
+        for (auto& node : alTx.getMeta ()->getNodes ())
+        {
+            try
+            {
+                if (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE)
+                    continue;
+
+                SField const* field = nullptr;
+                int delta = 0;
+                if (node.getFName () == sfCreatedNode)
+                {
+                    field = &sfNewFields;
+                    delta = 1;
+                }
+                else if (node.getFName () == sfDeletedNode)
+                {
+                    field = &sfFinalFields;
+                    delta = -1;
+                }
+                else
+                {
+                    continue;
+                }
+
+                auto data = dynamic_cast<const STObject*> (
+                    node.peekAtPField (*field));
+                if (! data)
+                    continue;
+
+                if (auto const book = qualityRootBook (
+                        *data, node.getFieldH256 (sfLedgerIndex)))
+                    changes.push_back ({seq, *book, delta});
+            }
+            catch (std::exception const&)
+            {
+                JLOG (j_.info)
+                    << "Directory fields not found in OrderBookDB::processTxn";
+            }
+        }
+
+        if (! changes.empty ())
+        {
+            std::lock_guard <std::recursive_mutex> sl (mLock);
+            if (mUpdating)
+                mPending.insert (mPending.end (),
+                    changes.begin (), changes.end ());
+            else if (mBuiltSeq != 0)
+                applyChanges (changes);
+        }
+    }
+
     std::lock_guard <std::recursive_mutex> sl (mLock);
     
     Json::Value jvObj;
-    bool bJvObjInitialized = false;
+    std::unique_ptr<SharedMessage> message;
 
     if (alTx.getResult () == tesSUCCESS)
     {
@@ -299,13 +483,13 @@ void OrderBookDB::processTxn (
         
         for (auto& listeners: listenersSet)
         {
-            if (!bJvObjInitialized)
+            if (!message)
             {
                 jvObj = NetworkOPs_transJson (*alTx.getTxn (), alTx.getResult (), true, ledger, app_);
                 jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
-                bJvObjInitialized = true;
+                message = std::make_unique<SharedMessage> (jvObj);
             }
-            listeners->publish (jvObj);
+            listeners->publish (jvObj, *message);
         }
     }
 }
@@ -25,6 +25,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/OrderBook.h>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
@@ -34,10 +35,19 @@ class OrderBookDB
 public:
     OrderBookDB (Application& app, Stoppable& parent);
 
+    /** Rebuild the books from a ledger if they are not current.
+
+        The books are kept up to date from the metadata of each published
+        ledger, so they are only rebuilt when none were built yet or when
+        ledgers were skipped.
+    */
     void setup (std::shared_ptr<ReadView const> const& ledger);
     void update (std::shared_ptr<ReadView const> const& ledger);
     void invalidate ();
 
+    /** Note a book as soon as a view first puts an offer in it.
+        The book is kept, and later removed, by the validated ledgers.
+    */
     void addOrderBook(Book const&);
 
     /** @return a list of all orderbooks that want this issuerID and currencyID.
@@ -53,7 +63,8 @@ public:
     BookListeners::pointer getBookListeners (Book const&);
     BookListeners::pointer makeBookListeners (Book const&);
 
-    // see if this txn effects any orderbook
+    // see if this txn effects any orderbook, and track the books
+    // it creates or removes
     void processTxn (
         std::shared_ptr<ReadView const> const& ledger,
         const AcceptedLedgerTx& alTx);
@@ -61,18 +72,48 @@ public:
     using IssueToOrderBook = hash_map <Issue, OrderBook::List>;
 
 private:
-    void rawAddBook(Book const&);
+    // The books, replaced as a whole so they can be read without a lock
+    struct Books
+    {
+        // by ci/ii
+        IssueToOrderBook sourceMap;
+
+        // by co/io
+        IssueToOrderBook destMap;
+
+        // does an order book to XRP exist
+        hash_set <Issue> xrpBooks;
+    };
+
+    // A book gained (+1) or lost (-1) a quality directory
+    struct BookChange
+    {
+        LedgerIndex seq;
+        Book book;
+        int delta;
+    };
+
+    std::shared_ptr<Books const> books () const;
+
+    void startUpdate (std::shared_ptr<ReadView const> const& ledger);
+
+    void applyChanges (std::vector<BookChange> const& changes);
+
+    static void addBook (Books& books, Book const& book);
+    static void removeBook (Books& books, Book const& book);
 
     Application& app_;
 
-    // by ci/ii
-    IssueToOrderBook mSourceMap;
+    std::shared_ptr<Books const> mBooks;
 
-    // by co/io
-    IssueToOrderBook mDestMap;
+    // The number of quality directories of each book
+    hash_map <uint256, std::size_t> mQualities;
 
-    // does an order book to XRP exist
-    hash_set <Issue> mXRPBooks;
+    // Changes seen while the books are being rebuilt, and the ledger
+    // to rebuild them from next if ledgers were skipped meanwhile
+    std::vector<BookChange> mPending;
+    std::shared_ptr<ReadView const> mNext;
+    bool mUpdating;
 
     std::recursive_mutex mLock;
 
@@ -80,7 +121,9 @@ private:
 
     BookToListenersMap mListeners;
 
+    // The newest ledger the books reflect, and the one they were built from
     std::uint32_t mSeq;
+    std::uint32_t mBuiltSeq;
 
     beast::Journal j_;
 };
@@ -21,6 +21,8 @@
 #define RIPPLE_APP_PENDINGSAVES_H_INCLUDED
 
 #include <ripple/protocol/Protocol.h>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <condition_variable>
@@ -35,10 +37,24 @@ namespace ripple {
 */
 class PendingSaves
 {
+public:
+    /** Time spent in each phase of saving ledgers to SQL. */
+    struct Times
+    {
+        std::uint64_t saves = 0;
+        std::chrono::microseconds accepted {0};
+        std::chrono::microseconds deletes {0};
+        std::chrono::microseconds accounts {0};
+        std::chrono::microseconds transactions {0};
+        std::chrono::microseconds commit {0};
+        std::chrono::microseconds ledger {0};
+    };
+
 private:
     std::mutex mutable mutex_;
     std::map <LedgerIndex, bool> map_;
     std::condition_variable await_;
+    Times times_;
 
 public:
 
@@ -142,6 +158,29 @@ public:
         return map_;
     }
 
+    /** Add the times of a save to the totals. */
+    void
+    addTimes (Times const& times)
+    {
+        std::lock_guard <std::mutex> lock(mutex_);
+
+        times_.saves += times.saves;
+        times_.accepted += times.accepted;
+        times_.deletes += times.deletes;
+        times_.accounts += times.accounts;
+        times_.transactions += times.transactions;
+        times_.commit += times.commit;
+        times_.ledger += times.ledger;
+    }
+
+    Times
+    getTimes () const
+    {
+        std::lock_guard <std::mutex> lock(mutex_);
+
+        return times_;
+    }
+
 };
 
 }
@@ -0,0 +1,93 @@
+#ifndef RIPPLE_APP_LEDGER_RECENTLEDGERS_H_INCLUDED
+#define RIPPLE_APP_LEDGER_RECENTLEDGERS_H_INCLUDED
+
+#include <ripple/app/ledger/Ledger.h>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+/** The most recent validated ledgers, indexed by sequence.
+
+    Lookups take no lock that writers hold. Each slot of the ring holds a
+    ledger that writers replace with an atomic store and readers copy with
+    an atomic load, so a reader sees either the old ledger or the new one.
+    A ledger stays held until one whose sequence is a multiple of the
+    ring size later replaces it, or until it is erased.
+*/
+class RecentLedgers
+{
+public:
+    explicit
+    RecentLedgers (std::size_t size)
+        : slots_ (size)
+    {
+    }
+
+    RecentLedgers (RecentLedgers const&) = delete;
+    RecentLedgers& operator= (RecentLedgers const&) = delete;
+
+    /** Publish a validated ledger.
+        A newer ledger already in its slot is kept.
+    */
+    void insert (Ledger::pointer const& ledger)
+    {
+        auto const seq = ledger->info().seq;
+        auto& s = slot (seq);
+        auto held = std::atomic_load (&s);
+        while (! held || held->info().seq <= seq)
+        {
+            if (held == ledger ||
+                    std::atomic_compare_exchange_weak (&s, &held, ledger))
+                break;
+        }
+    }
+
+    /** Return the ledger with this sequence, if it is still held. */
+    Ledger::pointer get (LedgerIndex seq) const
+    {
+        auto ledger = std::atomic_load (&slot (seq));
+        if (ledger && ledger->info().seq == seq)
+            return ledger;
+        return {};
+    }
+
+    /** Drop the ledger with this sequence unless it has this hash. */
+    void erase (LedgerIndex seq, uint256 const& keep)
+    {
+        auto& s = slot (seq);
+        auto ledger = std::atomic_load (&s);
+        if (ledger && ledger->info().seq == seq && ledger->getHash () != keep)
+            std::atomic_compare_exchange_strong (
+                &s, &ledger, Ledger::pointer ());
+    }
+
+    /** Drop the ledgers before this sequence. */
+    void clearPrior (LedgerIndex seq)
+    {
+        for (auto& s : slots_)
+        {
+            auto ledger = std::atomic_load (&s);
+            if (ledger && ledger->info().seq < seq)
+                std::atomic_compare_exchange_strong (
+                &s, &ledger, Ledger::pointer ());
+        }
+    }
+
+private:
+    Ledger::pointer& slot (LedgerIndex seq)
+    {
+        return slots_[seq % slots_.size ()];
+    }
+
+    Ledger::pointer const& slot (LedgerIndex seq) const
+    {
+        return slots_[seq % slots_.size ()];
+    }
+
+    std::vector<Ledger::pointer> slots_;
+};
+
+} // ripple
+
+#endif
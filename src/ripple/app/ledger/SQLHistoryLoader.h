@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_APP_LEDGER_SQLHISTORYLOADER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_SQLHISTORYLOADER_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <cstdint>
+
+namespace ripple {
+
+/** Write the transactions of a range of ledgers to the transaction
+    database, to stand up a new SQL history mirror.
+
+    This runs instead of the server. The ledgers are read from the node
+    store on worker threads, newest first, and written in large SQL
+    transactions. Secondary indexes are dropped for the load and built
+    once it completes.
+
+    Each SQL transaction records the lowest ledger written, so a load
+    that is interrupted resumes where it stopped when it is started
+    again with the same last ledger.
+
+    @return The exit code of the process.
+*/
+int
+loadSQLHistory (Application& app, std::uint32_t first, std::uint32_t last);
+
+} // ripple
+
+#endif
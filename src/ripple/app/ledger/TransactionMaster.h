@@ -22,6 +22,10 @@
 
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <mutex>
 
 namespace ripple {
 
@@ -53,12 +57,19 @@ public:
 
     void sweep (void);
 
-    TaggedCache <uint256, Transaction>&
+    ShardedTaggedCache <uint256, Transaction>&
     getCache();
 
 private:
+    bool missed (uint256 const& hash);
+
     Application& mApp;
-    TaggedCache <uint256, Transaction> mCache;
+    ShardedTaggedCache <uint256, Transaction> mCache;
+
+    // Transactions recently looked for on disk and not found. Clients
+    // poll for transactions they submitted until these are validated.
+    std::mutex mMissLock;
+    hardened_hash_map <uint256, Stopwatch::time_point> mMisses;
 };
 
 } // ripple
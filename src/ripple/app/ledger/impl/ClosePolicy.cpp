@@ -0,0 +1,123 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/ClosePolicy.h>
+#include <ripple/basics/contract.h>
+#include <stdexcept>
+
+namespace ripple {
+
+ClosePolicy::ClosePolicy (Setup const& setup)
+    : setup_ (setup)
+{
+}
+
+void
+ClosePolicy::onApplied (std::size_t txCount, std::chrono::nanoseconds elapsed)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    lastTxCount_ = txCount;
+    lastApply_ = elapsed;
+
+    // Empty ledgers say nothing of what a transaction costs
+    if (txCount == 0)
+        return;
+
+    auto const sample = static_cast<double> (elapsed.count ()) / txCount;
+    if (perTx_ == 0)
+        perTx_ = sample;
+    else
+        perTx_ = (3 * perTx_ + sample) / 4;
+}
+
+std::chrono::milliseconds
+ClosePolicy::projectApply (std::size_t txCount,
+    std::lock_guard<std::mutex> const&) const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds> (
+        std::chrono::nanoseconds (
+            static_cast<std::chrono::nanoseconds::rep> (perTx_ * txCount)));
+}
+
+std::chrono::milliseconds
+ClosePolicy::projectApply (std::size_t txCount) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return projectApply (txCount, lock);
+}
+
+ClosePolicy::Decision
+ClosePolicy::decide (std::size_t openTxCount, std::size_t queued)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    openTxCount_ = openTxCount;
+    queued_ = queued;
+    projected_ = projectApply (openTxCount, lock);
+
+    if (setup_.targetApply.count () > 0 && projected_ >= setup_.targetApply)
+        decision_ = Decision::early;
+    else if (openTxCount < setup_.smallLedger && queued == 0 &&
+            setup_.linger.count () > 0)
+        decision_ = Decision::linger;
+    else
+        decision_ = Decision::normal;
+    return decision_;
+}
+
+char const*
+ClosePolicy::getName (Decision decision)
+{
+    switch (decision)
+    {
+    case Decision::normal:  return "normal";
+    case Decision::early:   return "early";
+    case Decision::linger:  return "linger";
+    }
+    return "unknown";
+}
+
+Json::Value
+ClosePolicy::getJson () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    Json::Value ret (Json::objectValue);
+    ret["decision"] = getName (decision_);
+    ret["open_transactions"] = static_cast<Json::UInt> (openTxCount_);
+    ret["queued_transactions"] = static_cast<Json::UInt> (queued_);
+    ret["projected_apply_ms"] = static_cast<Json::UInt> (projected_.count ());
+    ret["target_apply_ms"] =
+        static_cast<Json::UInt> (setup_.targetApply.count ());
+    ret["last_apply_ms"] = static_cast<Json::UInt> (
+        std::chrono::duration_cast<std::chrono::milliseconds> (
+            lastApply_).count ());
+    ret["last_transactions"] = static_cast<Json::UInt> (lastTxCount_);
+    ret["transaction_us"] = perTx_ / 1000;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+
+static
+int
+getCount (Section const& section, std::string const& name, int value)
+{
+    if (section.exists (name) && ! set (value, name, section))
+        value = -1;
+    if (value < 0)
+        Throw<std::runtime_error> ("Invalid [ledger_close] " + name);
+    return value;
+}
+
+ClosePolicy::Setup
+setup_ClosePolicy (Section const& section)
+{
+    using namespace std::chrono;
+    ClosePolicy::Setup setup;
+    setup.targetApply = milliseconds (getCount (section,
+        "target_apply_ms", static_cast<int> (setup.targetApply.count ())));
+    setup.smallLedger = getCount (section,
+        "small_ledger", static_cast<int> (setup.smallLedger));
+    setup.linger = milliseconds (getCount (section,
+        "linger_ms", static_cast<int> (setup.linger.count ())));
+    return setup;
+}
+
+} // ripple
@@ -26,6 +26,7 @@ namespace ripple {
 
 ConsensusImp::ConsensusImp (
         FeeVote::Setup const& voteSetup,
+        ClosePolicy::Setup const& closeSetup,
         Logs& logs)
     : journal_ (logs.journal("Consensus"))
     , feeVote_ (make_FeeVote (voteSetup,
@@ -36,6 +37,7 @@ ConsensusImp::ConsensusImp (
     , lastCloseConvergeTook_ (1000 * LEDGER_IDLE_INTERVAL)
     , lastValidationTimestamp_ (0)
     , lastCloseTime_ (0)
+    , closePolicy_ (closeSetup)
 {
 }
 
@@ -171,6 +173,12 @@ ConsensusImp::peekStoredProposals ()
     return storedProposals_;
 }
 
+ClosePolicy&
+ConsensusImp::getClosePolicy ()
+{
+    return closePolicy_;
+}
+
 //==============================================================================
 
 std::unique_ptr<Consensus>
@@ -178,6 +186,7 @@ make_Consensus (Config const& config, Logs& logs)
 {
     return std::make_unique<ConsensusImp> (
         setup_FeeVote (config.section ("voting")),
+        setup_ClosePolicy (config.section ("ledger_close")),
         logs);
 }
 
@@ -21,6 +21,7 @@
 #define RIPPLE_APP_LEDGER_IMPL_CONSENSUSIMP_H_INCLUDED
 
 #include <BeastConfig.h>
+#include <ripple/app/ledger/ClosePolicy.h>
 #include <ripple/app/ledger/Consensus.h>
 #include <ripple/app/ledger/LedgerConsensus.h>
 #include <ripple/app/misc/FeeVote.h>
@@ -36,7 +37,8 @@ class ConsensusImp
     : public Consensus
 {
 public:
-    ConsensusImp (FeeVote::Setup const& voteSetup, Logs& logs);
+    ConsensusImp (FeeVote::Setup const& voteSetup,
+        ClosePolicy::Setup const& closeSetup, Logs& logs);
 
     ~ConsensusImp () = default;
 
@@ -96,6 +98,9 @@ public:
     Consensus::Proposals&
     peekStoredProposals ();
 
+    ClosePolicy&
+    getClosePolicy ();
+
 private:
     beast::Journal journal_;
     std::unique_ptr <FeeVote> feeVote_;
@@ -126,6 +131,9 @@ private:
     std::map<uint256, std::pair<int, std::shared_ptr<SHAMap>>> recentPositions_;
 
     Consensus::Proposals storedProposals_;
+
+    // When to close, from the time recent ledgers took to apply
+    ClosePolicy closePolicy_;
 };
 
 }
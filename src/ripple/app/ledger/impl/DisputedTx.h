@@ -39,9 +39,8 @@ namespace ripple {
 class DisputedTx
 {
 public:
-    // VFALCO `Blob` is a poor choice of parameter
     DisputedTx (uint256 const& txID,
-            Blob const& tx, bool ourVote, beast::Journal j)
+            Slice const& tx, bool ourVote, beast::Journal j)
         : mTransactionID (txID)
         , mYays (0)
         , mNays (0)
@@ -0,0 +1,399 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/impl/FetchPackStreamer.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/LoadFeeTrack.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/Serializer.h>
+#include <beast/threads/Thread.h>
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+// Objects and bytes in one message
+std::size_t const messageObjects = 512;
+std::size_t const messageBytes = 256 * 1024;
+
+// Older ledgers are not added once a pack has this many objects
+std::size_t const packObjects = 512;
+
+// Nodes sent from the maps of one ledger
+int const stateNodes = 16384;
+int const txNodes = 512;
+
+// Fetch packs on the way at the same time
+std::size_t const maxStreams = 8;
+
+// What one peer is sent
+std::size_t const peerBytesPerSecond = 1024 * 1024;
+
+// How long to wait while the server is loaded
+std::chrono::milliseconds const loadedPause (250);
+
+// Fetch packs not sent by then are given up
+std::chrono::seconds const streamLimit (30);
+
+}
+
+class FetchPackStreamerImp : public FetchPackStreamer
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Stream
+    {
+        enum class Stage
+        {
+            header,
+            state,
+            txs
+        };
+
+        std::weak_ptr<Peer> peer;
+        Peer::id_t id;
+        boost::optional<std::uint32_t> seq;
+        std::string ledgerHash;
+
+        Ledger::pointer have;
+        Ledger::pointer want;
+        Stage stage = Stage::header;
+        SHAMap::DifferenceCursor cursor;
+        int left = 0;
+
+        std::size_t objects = 0;
+        clock_type::time_point started;
+        clock_type::time_point due;
+    };
+
+    Application& app_;
+    LedgerMaster& ledgerMaster_;
+    beast::Journal j_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    boost::optional<Peer::id_t> sending_;
+    bool shouldExit_ = false;
+
+    std::thread thread_;
+
+public:
+    FetchPackStreamerImp (
+        Application& app,
+        LedgerMaster& ledgerMaster,
+        Stoppable& stoppable,
+        beast::Journal journal)
+        : FetchPackStreamer (stoppable)
+        , app_ (app)
+        , ledgerMaster_ (ledgerMaster)
+        , j_ (journal)
+    {
+    }
+
+    ~FetchPackStreamerImp () override
+    {
+        if (thread_.joinable())
+            LogicError ("FetchPackStreamerImp::onStop not called.");
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Stoppable
+    //
+    //--------------------------------------------------------------------------
+
+    void onPrepare () override
+    {
+    }
+
+    void onStart () override
+    {
+        thread_ = std::thread {&FetchPackStreamerImp::run, this};
+    }
+
+    // The fetch packs still on the way are dropped
+    void onStop () override
+    {
+        JLOG (j_.info) << "Stopping";
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            shouldExit_ = true;
+            wakeup_.notify_one();
+        }
+        thread_.join();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // FetchPackStreamer
+    //
+    //--------------------------------------------------------------------------
+
+    bool add (std::weak_ptr<Peer> const& wPeer,
+        protocol::TMGetObjectByHash const& request,
+            Ledger::pointer const& have, Ledger::pointer const& want) override
+    {
+        auto const peer = wPeer.lock ();
+        if (! peer)
+            return false;
+
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (shouldExit_ || streams_.size () >= maxStreams)
+            return false;
+
+        if (sending_ == peer->id () ||
+            std::any_of (streams_.begin (), streams_.end (),
+                [&peer] (std::unique_ptr<Stream> const& s)
+                {
+                    return s->id == peer->id ();
+                }))
+            return false;
+
+        auto stream = std::make_unique<Stream> ();
+        stream->peer = wPeer;
+        stream->id = peer->id ();
+        if (request.has_seq ())
+            stream->seq = request.seq ();
+        stream->ledgerHash = request.ledgerhash ();
+        stream->have = have;
+        stream->want = want;
+        stream->started = clock_type::now ();
+        stream->due = stream->started;
+        streams_.push_back (std::move (stream));
+        wakeup_.notify_one();
+        return true;
+    }
+
+    std::size_t size () const override
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return streams_.size () + (sending_ ? 1 : 0);
+    }
+
+private:
+    void run ()
+    {
+        beast::Thread::setCurrentThreadName ("FetchPacks");
+        JLOG (j_.debug) << "Started";
+
+        std::unique_lock<std::mutex> lock (mutex_);
+        while (true)
+        {
+            wakeup_.wait (lock, [this]()
+                {
+                    return shouldExit_ || ! streams_.empty ();
+                });
+            if (shouldExit_)
+                break;
+
+            if (app_.getFeeTrack ().isLoadedLocal ())
+            {
+                wakeup_.wait_for (lock, loadedPause);
+                continue;
+            }
+
+            // The peer that has waited longest for its rate goes next
+            auto const iter = std::min_element (
+                streams_.begin (), streams_.end (),
+                [] (std::unique_ptr<Stream> const& a,
+                    std::unique_ptr<Stream> const& b)
+                {
+                    return a->due < b->due;
+                });
+            auto const now = clock_type::now ();
+            if ((*iter)->due > now)
+            {
+                wakeup_.wait_until (lock, (*iter)->due);
+                continue;
+            }
+
+            auto stream = std::move (*iter);
+            streams_.erase (iter);
+            sending_ = stream->id;
+            lock.unlock ();
+
+            bool more = false;
+            if (now - stream->started > streamLimit)
+            {
+                JLOG (j_.info) << "Fetch pack given up after " <<
+                    stream->objects << " nodes";
+            }
+            else
+            {
+                try
+                {
+                    more = sendNext (*stream, now);
+                }
+                catch (std::exception const& e)
+                {
+                    JLOG (j_.warning) <<
+                        "Exception building fetch pack: " << e.what ();
+                }
+            }
+
+            lock.lock ();
+            sending_ = boost::none;
+            if (more)
+                streams_.push_back (std::move (stream));
+        }
+        streams_.clear ();
+        lock.unlock ();
+
+        stopped();
+    }
+
+    // Send the next message of a fetch pack.
+    // Returns false once the pack is complete.
+    bool sendNext (Stream& s, clock_type::time_point now)
+    {
+        auto const peer = s.peer.lock ();
+        if (! peer)
+            return false;
+
+        protocol::TMGetObjectByHash reply;
+        reply.set_query (false);
+        if (s.seq)
+            reply.set_seq (*s.seq);
+        reply.set_ledgerhash (s.ledgerHash);
+        reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
+
+        std::size_t bytes = 0;
+        auto const full = [&] ()
+        {
+            return static_cast<std::size_t> (
+                reply.objects ().size ()) >= messageObjects ||
+                bytes >= messageBytes;
+        };
+        auto const append = [&] (uint256 const& hash, Slice const& data)
+        {
+            protocol::TMIndexedObject& newObj = *reply.add_objects ();
+            newObj.set_ledgerseq (s.want->info().seq);
+            newObj.set_hash (hash.begin (), 256 / 8);
+            newObj.set_data (data.data (), data.size ());
+            bytes += hash.size () + data.size ();
+            ++s.objects;
+        };
+
+        // Returns true when the walk over the map is done
+        auto const walk = [&] (SHAMap* have, SHAMap const& map)
+        {
+            map.visitDifferences (have, s.cursor,
+                [&] (SHAMapAbstractNode& node)
+                {
+                    append (node.getNodeHash ().as_uint256 (),
+                        map.serialize (node, snfPREFIX)->slice ());
+                    return --s.left > 0 && ! full ();
+                });
+            return s.left <= 0 || s.cursor.done ();
+        };
+
+        // Building a fetch pack:
+        //  1. Add the header for the requested ledger.
+        //  2. Add the nodes for the AccountStateMap of that ledger.
+        //  3. If there are transactions, add the nodes for the
+        //     transactions of the ledger.
+        //  4. If the FetchPack now contains greater than or equal to
+        //     packObjects entries then stop.
+        //  5. Otherwise, loop back and repeat the same process adding
+        //     the previous ledger to the FetchPack.
+        bool more = true;
+        while (more && ! full ())
+        {
+            switch (s.stage)
+            {
+            case Stream::Stage::header:
+            {
+                Serializer data (256);
+                data.add32 (HashPrefix::ledgerMaster);
+                s.want->addRaw (data);
+                append (s.want->getHash (), makeSlice (data.peekData ()));
+                s.stage = Stream::Stage::state;
+                s.cursor = SHAMap::DifferenceCursor ();
+                s.left = stateNodes;
+                break;
+            }
+
+            case Stream::Stage::state:
+                if (walk (&s.have->stateMap (), s.want->stateMap ()))
+                {
+                    if (s.want->info().txHash.isNonZero ())
+                    {
+                        s.stage = Stream::Stage::txs;
+                        s.cursor = SHAMap::DifferenceCursor ();
+                        s.left = txNodes;
+                    }
+                    else
+                    {
+                        more = nextLedger (s);
+                    }
+                }
+                break;
+
+            case Stream::Stage::txs:
+                if (walk (nullptr, s.want->txMap ()))
+                    more = nextLedger (s);
+                break;
+            }
+        }
+
+        if (reply.objects ().size () > 0)
+        {
+            peer->send (std::make_shared<Message> (
+                reply, protocol::mtGET_OBJECTS));
+            s.due = now + std::chrono::microseconds (
+                bytes * 1000000 / peerBytesPerSecond);
+        }
+
+        if (! more)
+        {
+            JLOG (j_.info) << "Sent fetch pack with " << s.objects << " nodes";
+        }
+        return more;
+    }
+
+    // Move on to the ledger before the one just sent.
+    // Returns false if the pack is complete.
+    bool nextLedger (Stream& s)
+    {
+        if (s.objects >= packObjects)
+            return false;
+
+        s.have = std::move (s.want);
+        s.want = ledgerMaster_.getLedgerByHash (s.have->info().parentHash);
+        if (! s.want)
+            return false;
+
+        s.stage = Stream::Stage::header;
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+FetchPackStreamer::FetchPackStreamer (Stoppable& parent)
+    : Stoppable ("FetchPackStreamer", parent)
+{
+}
+
+FetchPackStreamer::~FetchPackStreamer ()
+{
+}
+
+std::unique_ptr<FetchPackStreamer>
+make_FetchPackStreamer (Application& app, LedgerMaster& ledgerMaster,
+    beast::Stoppable& parent, beast::Journal journal)
+{
+    return std::make_unique<FetchPackStreamerImp>(
+        app, ledgerMaster, parent, journal);
+}
+
+} // ripple
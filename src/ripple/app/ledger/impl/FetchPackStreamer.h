@@ -0,0 +1,58 @@
+#ifndef RIPPLE_APP_LEDGER_FETCHPACKSTREAMER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_FETCHPACKSTREAMER_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/overlay/Peer.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/utility/Journal.h>
+#include <memory>
+
+#include "ripple.pb.h"
+
+namespace ripple {
+
+class LedgerMaster;
+
+/** Sends fetch packs to peers on a thread of its own.
+
+    A fetch pack goes out as a series of messages of bounded size, each
+    built from where the walk over the differences between two ledgers
+    stopped for the previous one. Only one message at a time is held in
+    memory. Sending pauses while the server is loaded, and each peer is
+    held to a rate in bytes per second.
+*/
+class FetchPackStreamer
+    : public beast::Stoppable
+{
+protected:
+    explicit FetchPackStreamer (Stoppable& parent);
+
+public:
+    /** Destroy the object. */
+    virtual ~FetchPackStreamer () = 0;
+
+    /** Stream the nodes a peer holding have needs to build want and the
+        ledgers before it.
+
+        @return false if the peer already has a fetch pack on the way
+                or too many are.
+
+        Thread safety:
+            Safe to call from any thread at any time.
+    */
+    virtual bool add (std::weak_ptr<Peer> const& peer,
+        protocol::TMGetObjectByHash const& request,
+            Ledger::pointer const& have, Ledger::pointer const& want) = 0;
+
+    /** Number of fetch packs being streamed. */
+    virtual std::size_t size () const = 0;
+};
+
+std::unique_ptr<FetchPackStreamer>
+make_FetchPackStreamer (Application& app, LedgerMaster& ledgerMaster,
+    beast::Stoppable& parent, beast::Journal journal);
+
+} // ripple
+
+#endif
@@ -708,8 +708,13 @@ void InboundLedger::filterNodes (std::vector<SHAMapNodeID>& nodeIDs,
     // ask for new nodes in preference to ones we've already asked for
     assert (nodeIDs.size () == nodeHashes.size ());
 
-    int const max = (reason == TriggerReason::trReply) ?
-        reqNodesReply : reqNodes;
+    bool const bulk = (mReason == fcHISTORY) &&
+        (app_.config().LEDGER_FETCH_BULK > 0);
+
+    // While a newer ledger is acquired, past ledgers ask for less
+    int const max = (reason == TriggerReason::trReply &&
+        ! (bulk && app_.getInboundLedgers ().isAcquiringTip ())) ?
+            reqNodesReply : reqNodes;
     bool const aggressive =
         (reason == TriggerReason::trTimeout);
 
@@ -774,6 +779,12 @@ void InboundLedger::filterNodes (std::vector<SHAMapNodeID>& nodeIDs,
         nodeHashes.resize (max);
     }
 
+    // Leave the nodes that adjacent past ledgers share to whichever
+    // asked for them first, they are stored when they arrive
+    if (bulk && ! aggressive)
+        app_.getInboundLedgers ().filterHistoryNodes (
+            mHash, nodeIDs, nodeHashes);
+
     for (auto const& nodeHash : nodeHashes)
     {
         mRecentNodes.insert (nodeHash);
@@ -829,7 +840,7 @@ bool InboundLedger::takeHeader (std::string const& data)
     Call with a lock
 */
 bool InboundLedger::takeTxNode (const std::vector<SHAMapNodeID>& nodeIDs,
-    const std::vector< Blob >& data, SHAMapAddNode& san)
+    const std::vector< Slice >& data, SHAMapAddNode& san)
 {
     if (!mHaveHeader)
     {
@@ -888,7 +899,7 @@ bool InboundLedger::takeTxNode (const std::vector<SHAMapNodeID>& nodeIDs,
     Call with a lock
 */
 bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
-    const std::vector< Blob >& data, SHAMapAddNode& san)
+    const std::vector< Slice >& data, SHAMapAddNode& san)
 {
     if (m_journal.trace) m_journal.trace <<
         "got ASdata (" << nodeIDs.size () << ") acquiring ledger " << mHash;
@@ -961,7 +972,7 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
 /** Process AS root node received from a peer
     Call with a lock
 */
-bool InboundLedger::takeAsRootNode (Blob const& data, SHAMapAddNode& san)
+bool InboundLedger::takeAsRootNode (Slice const& data, SHAMapAddNode& san)
 {
     if (mFailed || mHaveState)
     {
@@ -984,7 +995,7 @@ bool InboundLedger::takeAsRootNode (Blob const& data, SHAMapAddNode& san)
 /** Process AS root node received from a peer
     Call with a lock
 */
-bool InboundLedger::takeTxRootNode (Blob const& data, SHAMapAddNode& san)
+bool InboundLedger::takeTxRootNode (Slice const& data, SHAMapAddNode& san)
 {
     if (mFailed || mHaveTransactions)
     {
@@ -1101,14 +1112,14 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
 
 
         if (!mHaveState && (packet.nodes ().size () > 1) &&
-            !takeAsRootNode (strCopy (packet.nodes (1).nodedata ()), san))
+            !takeAsRootNode (makeSlice (packet.nodes (1).nodedata ()), san))
         {
             if (m_journal.warning) m_journal.warning <<
                 "Included AS root invalid";
         }
 
         if (!mHaveTransactions && (packet.nodes ().size () > 2) &&
-            !takeTxRootNode (strCopy (packet.nodes (2).nodedata ()), san))
+            !takeTxRootNode (makeSlice (packet.nodes (2).nodedata ()), san))
         {
             if (m_journal.warning) m_journal.warning <<
                 "Included TX root invalid";
@@ -1134,7 +1145,8 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
 
         std::vector<SHAMapNodeID> nodeIDs;
         nodeIDs.reserve(packet.nodes().size());
-        std::vector< Blob > nodeData;
+        // The node data is used in place, the packet outlives it
+        std::vector< Slice > nodeData;
         nodeData.reserve(packet.nodes().size());
 
         for (int i = 0; i < packet.nodes ().size (); ++i)
@@ -1151,8 +1163,7 @@ int InboundLedger::processData (std::shared_ptr<Peer> peer,
 
             nodeIDs.push_back (SHAMapNodeID (node.nodeid ().data (),
                 node.nodeid ().size ()));
-            nodeData.push_back (Blob (node.nodedata ().begin (),
-                node.nodedata ().end ()));
+            nodeData.push_back (makeSlice (node.nodedata ()));
         }
 
         SHAMapAddNode san;
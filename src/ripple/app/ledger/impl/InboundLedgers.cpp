@@ -28,6 +28,7 @@
 #include <ripple/protocol/JsonFields.h>
 #include <beast/module/core/text/LexicalCast.h>
 #include <beast/container/aged_map.h>
+#include <algorithm>
 #include <memory>
 #include <mutex>
 
@@ -48,6 +49,8 @@ public:
     using u256_acq_pair = std::pair<uint256, InboundLedger::pointer>;
     // How long before we try again to acquire the same ledger
     static const std::chrono::minutes kReacquireInterval;
+    // How long a node one past ledger asked for is left to it
+    static const std::chrono::milliseconds kNodeClaimInterval;
 
     InboundLedgersImp (Application& app, clock_type& clock, Stoppable& parent,
                        beast::insight::Collector::ptr const& collector)
@@ -57,6 +60,7 @@ public:
         , j_ (app.journal ("InboundLedger"))
         , m_clock (clock)
         , mRecentFailures (clock)
+        , mHistoryNodes (clock)
         , mCounter(collector->make_counter("ledger_fetches"))
     {
     }
@@ -213,6 +217,60 @@ public:
         return ret;
     }
 
+    std::size_t getHistoryCount ()
+    {
+        ScopedLockType sl (mLock);
+
+        return std::count_if (mLedgers.begin (), mLedgers.end (),
+            [](MapType::value_type const& it)
+            {
+                return it.second->getReason () == InboundLedger::fcHISTORY &&
+                    ! it.second->isDone ();
+            });
+    }
+
+    bool isAcquiringTip ()
+    {
+        ScopedLockType sl (mLock);
+
+        return std::any_of (mLedgers.begin (), mLedgers.end (),
+            [](MapType::value_type const& it)
+            {
+                return it.second->getReason () != InboundLedger::fcHISTORY &&
+                    ! it.second->isDone ();
+            });
+    }
+
+    void filterHistoryNodes (LedgerHash const& ledgerHash,
+        std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>& nodeHashes)
+    {
+        assert (nodeIDs.size () == nodeHashes.size ());
+
+        std::lock_guard <std::mutex> sl (mNodesLock);
+        beast::expire (mHistoryNodes, kNodeClaimInterval);
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < nodeHashes.size (); ++i)
+        {
+            auto const result = mHistoryNodes.emplace (
+                nodeHashes[i], ledgerHash);
+            if (! result.second)
+            {
+                if (result.first->second != ledgerHash)
+                    continue;
+                mHistoryNodes.touch (result.first);
+            }
+            if (kept != i)
+            {
+                nodeIDs[kept] = nodeIDs[i];
+                nodeHashes[kept] = nodeHashes[i];
+            }
+            ++kept;
+        }
+        nodeIDs.resize (kept);
+        nodeHashes.resize (kept);
+    }
+
     void logFailure (uint256 const& h, std::uint32_t seq)
     {
         ScopedLockType sl (mLock);
@@ -256,7 +314,7 @@ public:
                     return;
 
                 auto newNode = SHAMapAbstractNode::make(
-                    Blob (node.nodedata().begin(), node.nodedata().end()),
+                    makeSlice (node.nodedata()),
                     0, snfWIRE, SHAMapHash{uZero}, false, app_.journal ("SHAMapNodeID"));
 
                 if (!newNode)
@@ -408,6 +466,10 @@ public:
 
         mLedgers.clear();
         mRecentFailures.clear();
+        {
+            std::lock_guard <std::mutex> sl (mNodesLock);
+            mHistoryNodes.clear();
+        }
 
         stopped();
     }
@@ -423,6 +485,10 @@ private:
 
     beast::aged_map <uint256, std::uint32_t> mRecentFailures;
 
+    // The nodes past ledgers asked for, and the ledger that asked
+    std::mutex mNodesLock;
+    beast::aged_map <uint256, LedgerHash> mHistoryNodes;
+
     beast::insight::Counter mCounter;
 };
 
@@ -431,6 +497,9 @@ private:
 decltype(InboundLedgersImp::kReacquireInterval)
 InboundLedgersImp::kReacquireInterval{5};
 
+decltype(InboundLedgersImp::kNodeClaimInterval)
+InboundLedgersImp::kNodeClaimInterval{2500};
+
 InboundLedgers::~InboundLedgers()
 {
 }
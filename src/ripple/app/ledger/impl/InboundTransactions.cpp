@@ -161,7 +161,7 @@ public:
         }
 
         std::list<SHAMapNodeID> nodeIDs;
-        std::list< Blob > nodeData;
+        std::list< Slice > nodeData;
         for (auto const &node : packet.nodes())
         {
             if (!node.has_nodeid () || !node.has_nodedata () || (
@@ -173,8 +173,7 @@ public:
 
             nodeIDs.emplace_back (node.nodeid ().data (),
                                static_cast<int>(node.nodeid ().size ()));
-            nodeData.emplace_back (node.nodedata ().begin (),
-                node.nodedata ().end ());
+            nodeData.push_back (makeSlice (node.nodedata ()));
         }
 
         if (! ta->takeNodes (nodeIDs, nodeData, peer).isUseful ())
@@ -21,9 +21,17 @@
 #include <ripple/app/ledger/impl/LedgerCleaner.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/core/Config.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/core/LoadFeeTrack.h>
 #include <ripple/protocol/JsonFields.h>
 #include <beast/threads/Thread.h>
+#include <boost/optional.hpp>
+#include <condition_variable>
+#include <set>
+#include <thread>
+#include <vector>
 
 namespace ripple {
 
@@ -39,8 +47,18 @@ Cleans up the ledger. Specifically, resolves these issues:
 
 2. Upon request, checks for missing nodes in a ledger and triggers a fetch.
 
+Ledgers are checked newest first on [ledger_cleaner_threads] threads. The
+progress is saved in the wallet database so a clean resumes after a restart.
+
 */
 
+namespace {
+
+// Ledgers checked between saves of the progress
+LedgerIndex const saveInterval = 256;
+
+}
+
 class LedgerCleanerImp : public LedgerCleaner
 {
     Application& app_;
@@ -49,22 +67,26 @@ class LedgerCleanerImp : public LedgerCleaner
 
     mutable std::condition_variable wakeup_;
 
-    std::thread thread_;
+    std::vector<std::thread> threads_;
 
-    enum class State : char {
-        readyToClean = 0,
-        startCleaning,
-        cleaning
-    };
-    State state_ = State::readyToClean;
     bool shouldExit_ = false;
 
     // The lowest ledger in the range we're checking.
     LedgerIndex  minRange_ = 0;
 
-    // The highest ledger in the range we're checking
+    // The highest ledger in the range we're checking.
+    // Every ledger above it in the range has been checked.
     LedgerIndex  maxRange_ = 0;
 
+    // The next ledger to hand to a thread
+    LedgerIndex  next_ = 0;
+
+    // The ledgers the threads are checking
+    std::set<LedgerIndex> active_;
+
+    // The highest ledger when the progress was last saved
+    LedgerIndex  saved_ = 0;
+
     // Check all state/transaction nodes
     bool checkNodes_ = false;
 
@@ -74,6 +96,9 @@ class LedgerCleanerImp : public LedgerCleaner
     // Number of errors encountered since last success
     int failures_ = 0;
 
+    // Keeps the saves of the progress in order
+    std::mutex saveMutex_;
+
     //--------------------------------------------------------------------------
 public:
     LedgerCleanerImp (
@@ -88,7 +113,7 @@ public:
 
     ~LedgerCleanerImp () override
     {
-        if (thread_.joinable())
+        if (! threads_.empty())
             LogicError ("LedgerCleanerImp::onStop not called.");
     }
 
@@ -104,7 +129,10 @@ public:
 
     void onStart () override
     {
-        thread_ = std::thread {&LedgerCleanerImp::run, this};
+        load();
+
+        for (int i = 0; i < app_.config().LEDGER_CLEANER_THREADS; ++i)
+            threads_.emplace_back (&LedgerCleanerImp::run, this);
     }
 
     void onStop () override
@@ -113,9 +141,13 @@ public:
         {
             std::lock_guard<std::mutex> lock (mutex_);
             shouldExit_ = true;
-            wakeup_.notify_one();
+            wakeup_.notify_all();
         }
-        thread_.join();
+        for (auto& thread : threads_)
+            thread.join();
+        threads_.clear();
+
+        stopped();
     }
 
     //--------------------------------------------------------------------------
@@ -137,6 +169,7 @@ public:
             map["max_ledger"] = maxRange_;
             map["check_nodes"] = checkNodes_ ? "true" : "false";
             map["fix_txns"] = fixTxns_ ? "true" : "false";
+            map["checking"] = active_.size();
             if (failures_ > 0)
                 map["fail_counts"] = failures_;
         }
@@ -220,12 +253,17 @@ public:
             if (params.isMember(jss::stop) && params[jss::stop].asBool())
                 minRange_ = maxRange_ = 0;
 
-            if (state_ == State::readyToClean)
+            if ((minRange_ > maxRange_) ||
+                (maxRange_ == 0) || (minRange_ == 0))
             {
-                state_ = State::startCleaning;
-                wakeup_.notify_one();
+                minRange_ = maxRange_ = 0;
             }
+
+            next_ = maxRange_;
+            wakeup_.notify_all();
         }
+
+        save();
     }
 
     //--------------------------------------------------------------------------
@@ -234,9 +272,81 @@ public:
     //
     //--------------------------------------------------------------------------
 private:
-    void init ()
+    // Resume the clean that was under way when the server stopped
+    void load ()
     {
-        JLOG (j_.debug) << "Initializing";
+        boost::optional<std::uint32_t> minO, maxO;
+        boost::optional<int> nodesO, txnsO;
+
+        try
+        {
+            auto db = app_.getWalletDB ().checkoutDb ();
+
+            *db << "SELECT MinLedger, MaxLedger, CheckNodes, FixTxns "
+                   "FROM CleanerState WHERE Magic=1;",
+                soci::into (minO), soci::into (maxO),
+                soci::into (nodesO), soci::into (txnsO);
+
+            if (! db->got_data ())
+                return;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.warning) << "Unable to load progress: " << e.what ();
+            return;
+        }
+
+        if (! minO || ! maxO || (*minO == 0) || (*minO > *maxO))
+            return;
+
+        std::lock_guard<std::mutex> lock (mutex_);
+        minRange_ = *minO;
+        maxRange_ = next_ = saved_ = *maxO;
+        checkNodes_ = nodesO.value_or (0) != 0;
+        fixTxns_ = txnsO.value_or (0) != 0;
+
+        JLOG (j_.info) << "Resuming at ledger " << maxRange_ <<
+            " down to " << minRange_;
+    }
+
+    // Save the progress of the clean
+    void save ()
+    {
+        std::lock_guard<std::mutex> sl (saveMutex_);
+
+        LedgerIndex minRange;
+        LedgerIndex maxRange;
+        int checkNodes;
+        int fixTxns;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            minRange = minRange_;
+            maxRange = saved_ = maxRange_;
+            checkNodes = checkNodes_ ? 1 : 0;
+            fixTxns = fixTxns_ ? 1 : 0;
+        }
+
+        try
+        {
+            auto db = app_.getWalletDB ().checkoutDb ();
+
+            *db << "REPLACE INTO CleanerState "
+                   "(Magic,MinLedger,MaxLedger,CheckNodes,FixTxns) "
+                   "VALUES (1,:min,:max,:nodes,:txns);",
+                soci::use (minRange), soci::use (maxRange),
+                soci::use (checkNodes), soci::use (fixTxns);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.warning) << "Unable to save progress: " << e.what ();
+        }
+    }
+
+    // Call with the lock held
+    bool canClaim () const
+    {
+        return (maxRange_ != 0) &&
+            (next_ >= minRange_) && (next_ <= maxRange_);
     }
 
     void run ()
@@ -244,27 +354,57 @@ private:
         beast::Thread::setCurrentThreadName ("LedgerCleaner");
         JLOG (j_.debug) << "Started";
 
-        init();
+        // A known good ledger to find the hashes of older ones with
+        Ledger::pointer goodLedger;
 
+        std::unique_lock<std::mutex> lock (mutex_);
         while (true)
         {
+            wakeup_.wait(lock, [this]()
+                {
+                    return shouldExit_ || canClaim ();
+                });
+            if (shouldExit_)
+                break;
+
+            LedgerIndex const ledgerIndex = next_--;
+            bool const doNodes = checkNodes_;
+            bool const doTxns = fixTxns_;
+            active_.insert (ledgerIndex);
+            lock.unlock ();
+
+            bool const cleaned = doLedgerCleaner (
+                ledgerIndex, goodLedger, doNodes, doTxns);
+
+            lock.lock ();
+            active_.erase (ledgerIndex);
+            if (! cleaned || shouldExit_)
+                continue;
+
+            // Every ledger above the ones still claimed is done
+            auto const top = active_.empty () ?
+                next_ : std::max (next_, *active_.rbegin ());
+            maxRange_ = std::min (maxRange_, top);
+
+            bool doSave = false;
+            if (maxRange_ < minRange_)
             {
-                std::unique_lock<std::mutex> lock (mutex_);
-                wakeup_.wait(lock, [this]()
-                    {
-                        return (
-                            shouldExit_ ||
-                            state_ == State::startCleaning);
-                    });
-                if (shouldExit_)
-                    break;
-
-                state_ = State::cleaning;
+                JLOG (j_.info) << "Done cleaning down to " << minRange_;
+                minRange_ = maxRange_ = next_ = 0;
+                doSave = true;
+            }
+            else if (maxRange_ + saveInterval <= saved_)
+            {
+                doSave = true;
             }
-            doLedgerCleaner();
-        }
 
-        stopped();
+            if (doSave)
+            {
+                lock.unlock ();
+                save ();
+                lock.lock ();
+            }
+        }
     }
 
     // VFALCO TODO This should return boost::optional<uint256>
@@ -401,47 +541,43 @@ private:
         return ledgerHash;
     }
 
-    /** Run the ledger cleaner. */
-    void doLedgerCleaner()
+    // Wait while the server is loaded, then pause for longer the higher
+    // the local fee is. Returns false if the cleaner is stopping.
+    bool throttle ()
     {
-        auto shouldExit = [this]()
+        auto& feeTrack = app_.getFeeTrack();
+        auto const stopping = [this]()
         {
-            std::lock_guard<std::mutex> lock(mutex_);
             return shouldExit_;
         };
 
-        Ledger::pointer goodLedger;
-
-        while (! shouldExit())
+        std::unique_lock<std::mutex> lock (mutex_);
+        while (feeTrack.isLoadedLocal() || app_.getJobQueue().isOverloaded())
         {
-            LedgerIndex ledgerIndex;
-            LedgerHash ledgerHash;
-            bool doNodes;
-            bool doTxns;
-
-            while (app_.getFeeTrack().isLoadedLocal())
-            {
-                JLOG (j_.debug) << "Waiting for load to subside";
-                std::this_thread::sleep_for(std::chrono::seconds(5));
-                if (shouldExit())
-                    return;
-            }
+            JLOG (j_.debug) << "Waiting for load to subside";
+            if (wakeup_.wait_for (lock, std::chrono::seconds(5), stopping))
+                return false;
+        }
 
-            {
-                std::lock_guard<std::mutex> lock (mutex_);
-                if ((minRange_ > maxRange_) ||
-                    (maxRange_ == 0) || (minRange_ == 0))
-                {
-                    minRange_ = maxRange_ = 0;
-                    state_ = State::readyToClean;
-                    return;
-                }
-                ledgerIndex = maxRange_;
-                doNodes = checkNodes_;
-                doTxns = fixTxns_;
-            }
+        // Reduce I/O pressure and wait for acquiring to catch up to us
+        auto const pause = std::chrono::milliseconds(100) *
+            feeTrack.getLoadFactor() / feeTrack.getLoadBase();
+        return ! wakeup_.wait_for (lock, pause, stopping);
+    }
 
-            ledgerHash = getHash(ledgerIndex, goodLedger);
+    /** Check a single ledger, retrying until it is clean.
+        @return `true` if the ledger was cleaned, `false` if the cleaner is
+                stopping or the ledger is no longer in the range.
+    */
+    bool doLedgerCleaner(
+        LedgerIndex ledgerIndex,
+        Ledger::pointer& goodLedger,
+        bool doNodes,
+        bool doTxns)
+    {
+        while (throttle())
+        {
+            LedgerHash const ledgerHash = getHash(ledgerIndex, goodLedger);
 
             bool fail = false;
             if (ledgerHash.isZero())
@@ -456,30 +592,21 @@ private:
                 fail = true;
             }
 
-            if (fail)
-            {
-                {
-                    std::lock_guard<std::mutex> lock (mutex_);
-                    ++failures_;
-                }
-                // Wait for acquiring to catch up to us
-                std::this_thread::sleep_for(std::chrono::seconds(2));
-            }
-            else
-            {
-                {
-                    std::lock_guard<std::mutex> lock (mutex_);
-                    if (ledgerIndex == minRange_)
-                        ++minRange_;
-                    if (ledgerIndex == maxRange_)
-                        --maxRange_;
-                    failures_ = 0;
-                }
-                // Reduce I/O pressure and wait for acquiring to catch up to us
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
+            if (! fail)
+                return true;
+
+            std::unique_lock<std::mutex> lock (mutex_);
+            ++failures_;
+
+            // Wait for acquiring to catch up to us
+            if (wakeup_.wait_for (lock, std::chrono::seconds(2),
+                    [this]() { return shouldExit_; }))
+                return false;
 
+            if ((ledgerIndex < minRange_) || (ledgerIndex > maxRange_))
+                return false;
         }
+        return false;
     }
 };
 
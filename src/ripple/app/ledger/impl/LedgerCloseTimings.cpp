@@ -0,0 +1,128 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
+#include <ripple/protocol/JsonFields.h>
+#include <algorithm>
+
+namespace ripple {
+
+LedgerCloseTimings::LedgerCloseTimings (std::size_t size,
+        beast::insight::Collector::ptr const& collector)
+    : size_ (std::max<std::size_t> (size, 1))
+{
+    for (std::size_t i = 0; i < phaseCount; ++i)
+        events_[i] = collector->make_event (
+            getName (static_cast<Phase> (i)));
+}
+
+char const*
+LedgerCloseTimings::getName (Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::apply:      return "apply";
+    case Phase::write:      return "write";
+    case Phase::flush:      return "flush";
+    case Phase::accept:     return "accept";
+    case Phase::storeBatch: return "store_batch";
+    case Phase::save:       return "save";
+    case Phase::publish:    return "publish";
+    }
+    return "unknown";
+}
+
+LedgerCloseTimings::Record*
+LedgerCloseTimings::find (LedgerIndex seq)
+{
+    auto iter = records_.find (seq);
+    if (iter != records_.end ())
+        return &iter->second;
+
+    if (records_.size () >= size_ && seq < records_.begin ()->first)
+        return nullptr;
+
+    iter = records_.emplace (seq, Record ()).first;
+    while (records_.size () > size_)
+        records_.erase (records_.begin ());
+    return &iter->second;
+}
+
+void
+LedgerCloseTimings::add (LedgerIndex seq, Phase phase,
+    std::chrono::nanoseconds elapsed)
+{
+    auto const i = static_cast<std::size_t> (phase);
+    events_[i].notify (elapsed);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (auto record = find (seq))
+        record->phases[i] += elapsed;
+}
+
+void
+LedgerCloseTimings::addTx (LedgerIndex seq, TxType type,
+    std::chrono::nanoseconds elapsed)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (auto record = find (seq))
+    {
+        auto& times = record->txs[type];
+        ++times.count;
+        times.elapsed += elapsed;
+    }
+}
+
+void
+LedgerCloseTimings::addStoreBatch (std::chrono::nanoseconds elapsed)
+{
+    auto const i = static_cast<std::size_t> (Phase::storeBatch);
+    events_[i].notify (elapsed);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (! records_.empty ())
+        records_.rbegin ()->second.phases[i] += elapsed;
+}
+
+void
+LedgerCloseTimings::setHash (LedgerIndex seq, uint256 const& hash)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (auto record = find (seq))
+        record->hash = hash;
+}
+
+Json::Value
+LedgerCloseTimings::getJson (std::size_t limit) const
+{
+    auto const& formats = TxFormats::getInstance ();
+
+    Json::Value ret (Json::arrayValue);
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (auto iter = records_.rbegin ();
+        iter != records_.rend () && ret.size () < limit; ++iter)
+    {
+        auto const& record = iter->second;
+        Json::Value& entry = ret.append (Json::objectValue);
+        entry[jss::ledger_index] = iter->first;
+        if (record.hash.isNonZero ())
+            entry[jss::ledger_hash] = to_string (record.hash);
+
+        // Nanoseconds, as strings since they may not fit a Json int
+        Json::Value& phases = (entry[jss::phases] = Json::objectValue);
+        for (std::size_t i = 0; i < phaseCount; ++i)
+            phases[getName (static_cast<Phase> (i))] =
+                std::to_string (record.phases[i].count ());
+
+        Json::Value& txs = (entry[jss::transactions] = Json::objectValue);
+        for (auto const& tx : record.txs)
+        {
+            auto const item = formats.findByType (tx.first);
+            Json::Value& times = (txs[item ? item->getName () :
+                std::to_string (tx.first)] = Json::objectValue);
+            times[jss::count] = static_cast<Json::UInt> (tx.second.count);
+            times[jss::elapsed] = std::to_string (tx.second.elapsed.count ());
+        }
+    }
+    return ret;
+}
+
+} // ripple
@@ -18,7 +18,10 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/ClosePolicy.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerTiming.h>
 #include <ripple/app/ledger/LedgerToJson.h>
@@ -30,11 +33,15 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/app/misc/DeadOffers.h>
+#include <ripple/app/misc/FeeShareSettlement.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/TxQ.h>
+#include <ripple/app/misc/TxTrace.h>
 #include <ripple/app/misc/Validations.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/basics/Log.h>
@@ -43,6 +50,7 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/LoadFeeTrack.h>
 #include <ripple/core/TimeKeeper.h>
+#include <ripple/ledger/View.h>
 #include <ripple/json/to_string.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
@@ -50,6 +58,7 @@
 #include <ripple/protocol/Feature.h>
 #include <beast/module/core/text/LexicalCast.h>
 #include <beast/utility/make_lock.h>
+#include <algorithm>
 #include <type_traits>
 
 namespace ripple {
@@ -70,6 +79,9 @@ namespace ripple {
                            (possibly rounded) close time
     @param openMSeconds time, in milliseconds, waiting to close this ledger
     @param idleInterval the network's desired idle interval
+    @param policy how the close policy wants this ledger closed
+    @param lingerMSeconds how long, in milliseconds, a ledger the policy
+                          lingers on stays open
 */
 bool shouldCloseLedger (
     bool anyTransactions,
@@ -80,6 +92,8 @@ bool shouldCloseLedger (
     int currentMSeconds, // Time since last ledger's close time
     int openMSeconds,    // Time waiting to close this ledger
     int idleInterval,
+    ClosePolicy::Decision policy,
+    int lingerMSeconds,
     beast::Journal j)
 {
     if ((previousMSeconds < -1000) || (previousMSeconds > 600000) ||
@@ -115,6 +129,23 @@ bool shouldCloseLedger (
         return false;
     }
 
+    // A ledger that would take too long to apply closes now
+    if (policy == ClosePolicy::Decision::early)
+    {
+        JLOG (j.debug) <<
+            "Closing early to bound apply time";
+        return true;
+    }
+
+    // A small ledger stays open a while so a burst is not split up
+    if (policy == ClosePolicy::Decision::linger &&
+        openMSeconds < lingerMSeconds)
+    {
+        JLOG (j.debug) <<
+            "Lingering on a small ledger";
+        return false;
+    }
+
     // Don't let this ledger close more than twice as fast as the previous
     // ledger reached consensus so that slower validators can slow down
     // the network
@@ -360,6 +391,7 @@ Json::Value LedgerConsensusImp::getJson (bool full)
         ret["have_time_consensus"] = mHaveCloseTimeConsensus;
         ret["previous_proposers"] = mPreviousProposers;
         ret["previous_mseconds"] = mPreviousMSeconds;
+        ret["close_policy"] = consensus_.getClosePolicy ().getJson ();
 
         if (!mPeerPositions.empty ())
         {
@@ -770,11 +802,22 @@ void LedgerConsensusImp::statePreClose ()
     auto const idleInterval = std::max (LEDGER_IDLE_INTERVAL,
         2 * mPreviousLedger->info().closeTimeResolution);
 
+    auto& policy = consensus_.getClosePolicy ();
+    auto decision = ClosePolicy::Decision::normal;
+    if (anyTransactions)
+    {
+        auto const metrics = app_.getTxQ ().getMetrics (
+            *app_.openLedger ().current ());
+        decision = policy.decide (metrics.txInLedger, metrics.txCount);
+    }
+
     // Decide if we should close the ledger
     if (shouldCloseLedger (anyTransactions
         , mPreviousProposers, proposersClosed, proposersValidated
         , mPreviousMSeconds, sinceClose, mCurrentMSeconds
-        , idleInterval, app_.journal ("LedgerTiming")))
+        , idleInterval, decision
+        , static_cast<int> (policy.setup ().linger.count ())
+        , app_.journal ("LedgerTiming")))
     {
         closeLedger ();
     }
@@ -1036,25 +1079,56 @@ void LedgerConsensusImp::accept (std::shared_ptr<SHAMap> set)
         << "Applying consensus set transactions to the"
         << " last closed ledger";
 
+    // The transactions applied, kept to build the accepted ledger
+    // from without reading them back out of the ledger
+    std::vector<std::shared_ptr<STTx const>> applied;
+    bool haveApplied;
+    auto& timings = app_.getLedgerCloseTimings ();
+    auto const seq = newLCL->info().seq;
     {
         OpenView accum(&*newLCL);
         assert(accum.closed());
+        auto const applyStart = LedgerCloseTimings::clock_type::now ();
         if (replay)
         {
             // Special case, we are replaying a ledger close
             for (auto& tx : replay->txns_)
-                applyTransaction (app_, accum, tx.second, false, tapNO_CHECK_SIGN, j_);
+            {
+                if (applyTransaction (app_, accum, tx.second, false,
+                        tapNO_CHECK_SIGN, j_) ==
+                    LedgerConsensusImp::resultSuccess)
+                {
+                    applied.push_back (tx.second);
+                }
+            }
         }
         else
         {
             // Normal case, we are not replaying a ledger close
             applyTransactions (app_, set.get(), accum,
-                newLCL, retriableTxs, tapNONE);
+                newLCL, retriableTxs, tapNONE, &applied);
+        }
+        auto const applyTook =
+            LedgerCloseTimings::clock_type::now () - applyStart;
+        timings.add (seq, LedgerCloseTimings::Phase::apply, applyTook);
+        if (! replay)
+            consensus_.getClosePolicy ().onApplied (
+                applied.size (), applyTook);
+
+        auto& trace = app_.getTxTrace ();
+        if (trace.enabled ())
+        {
+            for (auto const& tx : applied)
+                trace.mark (tx->getTransactionID (), TxTrace::Phase::closed);
         }
+
         // Update fee computations.
         app_.getTxQ().processValidatedLedger(app_, accum,
             mCurrentMSeconds > 5000);
 
+        haveApplied = (accum.txCount () == applied.size ());
+        LedgerCloseTimings::ScopedTimer timer (
+            timings, seq, LedgerCloseTimings::Phase::write);
         accum.apply(*newLCL);
     }
 
@@ -1062,9 +1136,11 @@ void LedgerConsensusImp::accept (std::shared_ptr<SHAMap> set)
     // made it into the consensus set but failed during application
     // to the ledger.
 
-    newLCL->updateSkipList ();
-
     {
+        LedgerCloseTimings::ScopedTimer timer (
+            timings, seq, LedgerCloseTimings::Phase::flush);
+        newLCL->updateSkipList ();
+
         int asf = newLCL->stateMap().flushDirty (
             hotACCOUNT_NODE, newLCL->info().seq);
         int tmf = newLCL->txMap().flushDirty (
@@ -1075,7 +1151,30 @@ void LedgerConsensusImp::accept (std::shared_ptr<SHAMap> set)
     }
 
     // Accept ledger
-    newLCL->setAccepted (closeTime, mCloseResolution, closeTimeCorrect, app_.config());
+    {
+        LedgerCloseTimings::ScopedTimer timer (
+            timings, seq, LedgerCloseTimings::Phase::accept);
+        newLCL->setAccepted (closeTime, mCloseResolution,
+            closeTimeCorrect, app_.config());
+    }
+    timings.setHash (seq, newLCL->getHash ());
+
+    // Publishing and saving the ledger find it ready
+    if (haveApplied)
+    {
+        try
+        {
+            auto accepted = std::make_shared<AcceptedLedger> (
+                newLCL, applied, app_.accountIDCache (), app_.logs ());
+            app_.getAcceptedLedgerCache ().canonicalize (
+                newLCL->getHash (), accepted);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.warning) <<
+                "Unable to build accepted ledger: " << e.what ();
+        }
+    }
 
     // And stash the ledger in the ledger master
     if (ledgerMaster_.storeLedger (newLCL))
@@ -1199,7 +1298,7 @@ void LedgerConsensusImp::accept (std::shared_ptr<SHAMap> set)
         else
             rules.emplace();
         app_.openLedger().accept(app_, *rules,
-            newLCL, localTx, anyDisputes, retriableTxs, tapNONE,
+            newLCL, *localTx, anyDisputes, retriableTxs, tapNONE,
                 "consensus",
                     [&](OpenView& view, beast::Journal j)
                     {
@@ -1258,12 +1357,26 @@ void LedgerConsensusImp::createDisputes (
 
     JLOG (j_.debug) << "createDisputes "
         << m1->getHash() << " to " << m2->getHash();
-    SHAMap::Delta differences;
-    m1->compare (*m2, differences, 16384);
+
+    // Sets are compared once. Which one is first does not matter, since
+    // a disputed transaction is taken from whichever set has it.
+    auto const h1 = m1->getHash().as_uint256();
+    auto const h2 = m2->getHash().as_uint256();
+    auto& cached = mDifferences[std::minmax (h1, h2)];
+    if (! cached)
+    {
+        auto delta = std::make_shared<SHAMap::Delta> ();
+        m1->compare (*m2, *delta, 16384);
+        cached = std::move (delta);
+    }
+    else
+    {
+        JLOG (j_.debug) << "Differences already known";
+    }
 
     int dc = 0;
     // for each difference between the transactions
-    for (auto& pos : differences)
+    for (auto const& pos : *cached)
     {
         ++dc;
         // create disputed transactions (from the ledger that has them)
@@ -1272,14 +1385,14 @@ void LedgerConsensusImp::createDisputes (
             // transaction is only in first map
             assert (!pos.second.second);
             addDisputedTransaction (pos.first
-                , pos.second.first->peekData ());
+                , pos.second.first->slice ());
         }
         else if (pos.second.second)
         {
             // transaction is only in second map
             assert (!pos.second.first);
             addDisputedTransaction (pos.first
-                , pos.second.second->peekData ());
+                , pos.second.second->slice ());
         }
         else // No other disagreement over a transaction should be possible
             assert (false);
@@ -1289,7 +1402,7 @@ void LedgerConsensusImp::createDisputes (
 
 void LedgerConsensusImp::addDisputedTransaction (
     uint256 const& txID,
-    Blob const& tx)
+    Slice const& tx)
 {
     if (mDisputes.find (txID) != mDisputes.end ())
         return;
@@ -1328,7 +1441,7 @@ void LedgerConsensusImp::addDisputedTransaction (
     if (app_.getHashRouter ().setFlags (txID, SF_RELAYED))
     {
         protocol::TMTransaction msg;
-        msg.set_rawtransaction (& (tx.front ()), tx.size ());
+        msg.set_rawtransaction (tx.data (), tx.size ());
         msg.set_status (protocol::tsNEW);
         msg.set_receivetimestamp (
             app_.timeKeeper().now().time_since_epoch().count());
@@ -1445,8 +1558,8 @@ void LedgerConsensusImp::takeInitialPosition (
     {
         Serializer s (2048);
         tx.first->add(s);
-        initialSet->addItem (
-            SHAMapItem (tx.first->getTransactionID(), std::move (s)), true, false);
+        initialSet->addGiveItem (
+            make_shamapitem (tx.first->getTransactionID(), s), true, false);
     }
 
     if ((app_.config().RUN_STANDALONE || (mProposing && mHaveCorrectLCL))
@@ -1460,6 +1573,31 @@ void LedgerConsensusImp::takeInitialPosition (
             mPreviousLedger, parentSet, initialSet);
     }
 
+    if ((app_.config().RUN_STANDALONE || (mProposing && mHaveCorrectLCL))
+            && mPreviousLedger->rules().enabled (
+                featureOfferPurge, app_.config().features))
+    {
+        DeadOffers::addToPosition (*mPreviousLedger, initialSet,
+            app_.journal ("DeadOffers"));
+    }
+
+    if ((app_.config().RUN_STANDALONE || (mProposing && mHaveCorrectLCL))
+            && mPreviousLedger->rules().enabled (
+                featureFeeShareAccrual, app_.config().features))
+    {
+        auto const j = app_.journal ("FeeShareSettlement");
+        FeeShareSettlement::addToPosition (*mPreviousLedger,
+            [&](std::uint32_t seq) -> std::shared_ptr<ReadView const>
+            {
+                // Only ledgers of the chain we are building on
+                auto const hash = hashOfSeq (*mPreviousLedger, seq, j);
+                if (! hash)
+                    return nullptr;
+                return ledgerMaster_.getLedgerByHash (*hash);
+            },
+            initialSet, j);
+    }
+
     // Set should be immutable snapshot
     initialSet = initialSet->snapShot (false);
 
@@ -1587,7 +1725,7 @@ void LedgerConsensusImp::updateOurPositions ()
 
             if (it.second->getOurVote ()) // now a yes
             {
-                ourPosition->addItem (SHAMapItem (it.first
+                ourPosition->addGiveItem (make_shamapitem (it.first
                     , it.second->peekTransaction ()), true, false);
                 //              addedTx.push_back(it.first);
             }
@@ -1841,8 +1979,13 @@ applyTransaction (Application& app, OpenView& view,
 
     try
     {
+        auto const start = LedgerCloseTimings::clock_type::now ();
         auto const result = apply(app,
             view, *txn, flags, j);
+        if (view.closed ())
+            app.getLedgerCloseTimings ().addTx (view.info ().seq,
+                txn->getTxnType (),
+                    LedgerCloseTimings::clock_type::now () - start);
         if (result.second)
         {
             JLOG (j.debug)
@@ -1876,12 +2019,14 @@ void applyTransactions (
     OpenView& view,
     Ledger::ref checkLedger,
     CanonicalTXSet& retriableTxs,
-    ApplyFlags flags)
+    ApplyFlags flags,
+    std::vector<std::shared_ptr<STTx const>>* applied)
 {
 
     auto j = app.journal ("LedgerConsensus");
     if (set)
     {
+        std::vector<Slice> candidates;
         for (auto const& item : *set)
         {
             if (checkLedger->txExists (item.key()))
@@ -1890,21 +2035,20 @@ void applyTransactions (
             // The transaction isn't in the check ledger, try to apply it
             JLOG (j.debug) <<
                 "Processing candidate transaction: " << item.key();
-            std::shared_ptr<STTx const> txn;
-            try
-            {
-                txn = std::make_shared<STTx const>(SerialIter{item.slice()});
-            }
-            catch (std::exception const&)
-            {
-                JLOG (j.warning) << "  Throws";
-            }
+            candidates.push_back (item.slice());
+        }
 
+        for (auto const& txn : makeTransactions (candidates))
+        {
             if (txn)
             {
                 // All transactions execute in canonical order
                 retriableTxs.insert (txn);
             }
+            else
+            {
+                JLOG (j.warning) << "  Throws";
+            }
         }
     }
 
@@ -1917,16 +2061,23 @@ void applyTransactions (
             << (certainRetry ? " retriable" : " final");
         int changes = 0;
 
+        // The first pass reads what later ones find in memory
+        TxPrefetch prefetch (view);
+
         auto it = retriableTxs.begin ();
 
         while (it != retriableTxs.end ())
         {
+            if (pass == 0)
+                prefetch (it, retriableTxs.end ());
             try
             {
                 switch (applyTransaction (app, view,
                     it->second, certainRetry, flags, j))
                 {
                 case LedgerConsensusImp::resultSuccess:
+                    if (applied)
+                        applied->push_back (it->second);
                     it = retriableTxs.erase (it);
                     ++changes;
                     break;
@@ -217,7 +217,7 @@ private:
       @param txID The ID of the disputed transaction
       @param tx   The data of the disputed transaction
     */
-    void addDisputedTransaction (uint256 const& txID, Blob const& tx);
+    void addDisputedTransaction (uint256 const& txID, Slice const& tx);
 
     /**
       Adjust the votes on all disputed transactions based
@@ -338,6 +338,11 @@ private:
     hash_map<uint256, std::shared_ptr <DisputedTx>> mDisputes;
     hash_set<uint256> mCompares;
 
+    // Differences between pairs of transaction sets already compared,
+    // indexed by the lower and then the higher of the two hashes
+    std::map<std::pair<uint256, uint256>,
+        std::shared_ptr<SHAMap::Delta const>> mDifferences;
+
     // Close time estimates, keep ordered for predictable traverse
     std::map<std::uint32_t, int> mCloseTimes;
 
@@ -20,11 +20,15 @@
 #include <BeastConfig.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
 #include <ripple/app/ledger/LedgerHistory.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/ledger/impl/FetchPackStreamer.h>
 #include <ripple/app/ledger/impl/LedgerCleaner.h>
+#include <ripple/app/ledger/impl/LedgerReplayer.h>
+#include <ripple/app/ledger/impl/LedgerSaver.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/AmendmentTable.h>
@@ -64,6 +68,12 @@ namespace ripple {
 // Don't acquire history if ledger is too old
 #define MAX_LEDGER_AGE_ACQUIRE  60
 
+// Don't acquire history if write load is too high
+#define MAX_WRITE_LOAD_ACQUIRE  8192
+
+// Don't acquire history if this many ledgers wait to be saved to SQL
+#define MAX_SAVE_QUEUE_ACQUIRE  10
+
 class LedgerMasterImp
     : public LedgerMaster
 {
@@ -104,7 +114,13 @@ public:
     std::recursive_mutex mCompleteLock;
     RangeSet mCompleteLedgers;
 
+    // A rendered copy of mCompleteLedgers for readers, who do not wait
+    // on mCompleteLock. It is replaced whenever the set changes.
+    std::shared_ptr<RangeSet const> mCompleteSnapshot;
+
     std::unique_ptr <LedgerCleaner> mLedgerCleaner;
+    std::unique_ptr <LedgerSaver> mLedgerSaver;
+    std::unique_ptr <FetchPackStreamer> mFetchPackStreamer;
 
     int mMinValidations;    // The minimum validations to publish a ledger.
     bool mStrictValCount;   // Don't raise the minimum
@@ -138,6 +154,12 @@ public:
 
     int const ledger_fetch_size_;
 
+    // How many past ledgers to acquire at once, 0 for a few at a time
+    int const ledger_fetch_bulk_;
+
+    // How many missing ledgers to rebuild from stored transactions
+    int const ledger_replay_;
+
     TaggedCache<uint256, Blob> fetch_packs_;
 
     std::uint32_t fetch_seq_;
@@ -155,6 +177,10 @@ public:
         , mHeldTransactions (uint256 ())
         , mLedgerCleaner (make_LedgerCleaner (
             app, *this, app_.journal("LedgerCleaner")))
+        , mLedgerSaver (make_LedgerSaver (
+            app, *this, app_.journal("LedgerSaver")))
+        , mFetchPackStreamer (make_FetchPackStreamer (
+            app, *this, *this, app_.journal("FetchPackStreamer")))
         , mMinValidations (0)
         , mStrictValCount (false)
         , mLastValidateSeq (0)
@@ -173,16 +199,35 @@ public:
             app_.config().FETCH_DEPTH))
         , ledger_history_ (app_.config().LEDGER_HISTORY)
         , ledger_fetch_size_ (app_.config().getSize (siLedgerFetch))
+        , ledger_fetch_bulk_ (app_.config().LEDGER_FETCH_BULK)
+        , ledger_replay_ (app_.config().LEDGER_REPLAY)
         , fetch_packs_ ("FetchPack", 65536, 45, stopwatch,
             app_.journal("TaggedCache"))
         , fetch_seq_ (0)
     {
+        publishCompleteLedgers ();
     }
 
     ~LedgerMasterImp ()
     {
     }
 
+    // Replaces the readers' copy of the complete ledgers. The copy is
+    // rendered here, so readers never write to it.
+    // The caller holds mCompleteLock, or is the constructor.
+    void publishCompleteLedgers ()
+    {
+        auto snapshot = std::make_shared<RangeSet> (mCompleteLedgers);
+        snapshot->toString ();
+        std::atomic_store (&mCompleteSnapshot,
+            std::shared_ptr<RangeSet const> (std::move (snapshot)));
+    }
+
+    std::shared_ptr<RangeSet const> completeLedgers () const
+    {
+        return std::atomic_load (&mCompleteSnapshot);
+    }
+
     LedgerIndex getCurrentLedgerIndex () override
     {
         return app_.openLedger().current()->info().seq;
@@ -411,14 +456,14 @@ public:
 
     bool haveLedger (std::uint32_t seq) override
     {
-        ScopedLockType sl (mCompleteLock);
-        return mCompleteLedgers.hasValue (seq);
+        return completeLedgers ()->hasValue (seq);
     }
 
     void clearLedger (std::uint32_t seq) override
     {
         ScopedLockType sl (mCompleteLock);
-        return mCompleteLedgers.clearValue (seq);
+        mCompleteLedgers.clearValue (seq);
+        publishCompleteLedgers ();
     }
 
     // returns Ledgers we have all the nodes for
@@ -431,10 +476,7 @@ public:
         if (!maxVal)
             return false;
 
-        {
-            ScopedLockType sl (mCompleteLock);
-            minVal = mCompleteLedgers.prevMissing (maxVal);
-        }
+        minVal = completeLedgers ()->prevMissing (maxVal);
 
         if (minVal == RangeSet::absent)
             minVal = maxVal;
@@ -454,10 +496,7 @@ public:
         if (!maxVal)
             return false;
 
-        {
-            ScopedLockType sl (mCompleteLock);
-            minVal = mCompleteLedgers.prevMissing (maxVal);
-        }
+        minVal = completeLedgers ()->prevMissing (maxVal);
 
         if (minVal == RangeSet::absent)
             minVal = maxVal;
@@ -544,6 +583,7 @@ public:
                 {
                     ScopedLockType ml (mCompleteLock);
                     mCompleteLedgers.setRange (minHas, maxHas);
+                    publishCompleteLedgers ();
                 }
                 maxHas = minHas;
                 ledgerHashes = getHashesByIndex ((seq < 500)
@@ -564,6 +604,7 @@ public:
         {
             ScopedLockType ml (mCompleteLock);
             mCompleteLedgers.setRange (minHas, maxHas);
+            publishCompleteLedgers ();
         }
         {
             ScopedLockType ml (m_mutex);
@@ -697,6 +738,7 @@ public:
             {
                 ScopedLockType ml (mCompleteLock);
                 mCompleteLedgers.setValue (ledger->info().seq);
+                publishCompleteLedgers ();
             }
 
             ScopedLockType ml (m_mutex);
@@ -1065,6 +1107,8 @@ public:
     // Try to publish ledgers, acquire missing ledgers
     void doAdvance ();
 
+    void fetchHistory (std::uint32_t missing);
+
     std::vector<Ledger::pointer> findNewLedgersToPublish ()
     {
         std::vector<Ledger::pointer> ret;
@@ -1095,6 +1139,7 @@ public:
             int acqCount = 0;
 
             auto pubSeq = mPubLedgerSeq + 1; // Next sequence to publish
+            Ledger::pointer pubLedger = mPubLedger;
             Ledger::pointer valLedger = mValidLedger.get ();
             std::uint32_t valSeq = valLedger->info().seq;
 
@@ -1130,6 +1175,14 @@ public:
                         ledger = mLedgerHistory.getLedgerByHash (*hash);
                     }
 
+                    // Can we rebuild it and the ones after it?
+                    if (! ledger && seq == pubSeq && ledger_replay_ > 0)
+                    {
+                        ledger = replay (
+                            ret.empty () ? pubLedger : ret.back (),
+                                *valLedger, seq, *hash);
+                    }
+
                     // Can we try to acquire the ledger we need?
                     if (! ledger && (++acqCount < 4))
                         ledger = app_.getInboundLedgers ().acquire(
@@ -1157,6 +1210,38 @@ public:
         return ret;
     }
 
+    // Rebuild the ledger with this hash and those after it up to the
+    // validated ledger, while their transactions are stored.
+    // Returns the first ledger, if it was rebuilt.
+    Ledger::pointer replay (Ledger::pointer const& parent,
+        Ledger const& valLedger, std::uint32_t seq, uint256 const& hash)
+    {
+        if (! parent || parent->info().seq + 1 != seq)
+            return {};
+
+        std::vector<uint256> hashes {hash};
+        auto const last = std::min<std::uint32_t> (
+            valLedger.info().seq - 1, seq + ledger_replay_ - 1);
+        for (auto s = seq + 1; s <= last; ++s)
+        {
+            auto const h = hashOfSeq (valLedger, s, m_journal);
+            if (! h)
+                break;
+            hashes.push_back (*h);
+        }
+
+        auto const ledgers = replayLedgers (app_, parent, hashes,
+            app_.journal ("LedgerReplayer"));
+        if (ledgers.empty ())
+            return {};
+
+        JLOG (m_journal.info) << "Rebuilt ledgers " << seq <<
+            " to " << ledgers.back ()->info().seq;
+        for (auto const& ledger : ledgers)
+            mLedgerHistory.addLedger (ledger, false);
+        return ledgers.front ();
+    }
+
     void tryAdvance() override
     {
         ScopedLockType ml (m_mutex);
@@ -1413,8 +1498,7 @@ public:
 
     std::string getCompleteLedgers () override
     {
-        ScopedLockType sl (mCompleteLock);
-        return mCompleteLedgers.toString ();
+        return completeLedgers ()->toString ();
     }
 
     boost::optional <uint32_t>
@@ -1533,6 +1617,9 @@ public:
         if (index <= mValidLedgerSeq)
         {
             // Always prefer a validated ledger
+            if (auto recent = mLedgerHistory.getRecentLedger (index))
+                return recent;
+
             auto valid = mValidLedger.get ();
             if (valid)
             {
@@ -1582,10 +1669,16 @@ public:
         mLedgerCleaner->doClean (parameters);
     }
 
+    LedgerSaver& getLedgerSaver () override
+    {
+        return *mLedgerSaver;
+    }
+
     void setLedgerRangePresent (std::uint32_t minV, std::uint32_t maxV) override
     {
         ScopedLockType sl (mCompleteLock);
         mCompleteLedgers.setRange (minV, maxV);
+        publishCompleteLedgers ();
     }
     void tune (int size, int age) override
     {
@@ -1603,6 +1696,21 @@ public:
         return mLedgerHistory.getCacheHitRate ();
     }
 
+    std::pair <std::uint64_t, std::uint64_t> getCacheHitsAndMisses () override
+    {
+        return mLedgerHistory.getCacheHitsAndMisses ();
+    }
+
+    int getCacheSize () override
+    {
+        return mLedgerHistory.getCacheSize ();
+    }
+
+    void setCacheSize (int size) override
+    {
+        mLedgerHistory.setCacheSize (size);
+    }
+
     beast::PropertyStream::Source& getPropertySource () override
     {
         return *mLedgerCleaner;
@@ -1613,9 +1721,10 @@ public:
         ScopedLockType sl (mCompleteLock);
         for (LedgerIndex i = mCompleteLedgers.getFirst(); i < seq; ++i)
         {
-            if (haveLedger (i))
-                clearLedger (i);
+            if (mCompleteLedgers.hasValue (i))
+                mCompleteLedgers.clearValue (i);
         }
+        publishCompleteLedgers ();
     }
 
     void clearLedgerCachePrior (LedgerIndex seq) override
@@ -1673,6 +1782,44 @@ bool LedgerMasterImp::shouldAcquire (
     return ret;
 }
 
+// Keep up to ledger_fetch_bulk_ past ledgers in flight, newest first.
+// None are started while a newer ledger is being acquired.
+void LedgerMasterImp::fetchHistory (std::uint32_t missing)
+{
+    auto& inbound = app_.getInboundLedgers ();
+    if (inbound.isAcquiringTip ())
+        return;
+
+    std::size_t const bulk = ledger_fetch_bulk_;
+    auto count = inbound.getHistoryCount ();
+    auto seq = missing;
+    try
+    {
+        for (std::size_t i = 0; (i < 2 * bulk) && (count < bulk); ++i)
+        {
+            seq = completeLedgers ()->prevMissing (seq);
+            if ((seq == RangeSet::absent) || (seq == 0) ||
+                ! shouldAcquire (mValidLedgerSeq, ledger_history_,
+                    app_.getSHAMapStore ().getCanDelete (), seq))
+                break;
+
+            auto const hash = getLedgerHashForHistory (seq);
+            if (hash.isZero ())
+                break;
+
+            if (! inbound.hasLedger (hash) && ! inbound.isFailure (hash))
+            {
+                inbound.acquire (hash, seq, InboundLedger::fcHISTORY);
+                ++count;
+            }
+        }
+    }
+    catch (std::exception const&)
+    {
+        JLOG (m_journal.warning) << "Threw while fetching history";
+    }
+}
+
 // Try to publish ledgers, acquire missing ledgers
 void LedgerMasterImp::doAdvance ()
 {
@@ -1688,15 +1835,13 @@ void LedgerMasterImp::doAdvance ()
         {
             if (!standalone_ && !app_.getFeeTrack().isLoadedLocal() &&
                 (app_.getJobQueue().getJobCount(jtPUBOLDLEDGER) < 10) &&
+                (mLedgerSaver->getQueueSize() < MAX_SAVE_QUEUE_ACQUIRE) &&
+                (app_.getNodeStore().getWriteLoad() < MAX_WRITE_LOAD_ACQUIRE) &&
                 (mValidLedgerSeq == mPubLedgerSeq) &&
                 (getValidatedLedgerAge() < MAX_LEDGER_AGE_ACQUIRE))
             { // We are in sync, so can acquire
-                std::uint32_t missing;
-                {
-                    ScopedLockType sl (mCompleteLock);
-                    missing = mCompleteLedgers.prevMissing(
-                        mPubLedger->info().seq);
-                }
+                std::uint32_t const missing =
+                    completeLedgers ()->prevMissing (mPubLedger->info().seq);
                 JLOG (m_journal.trace)
                     << "tryAdvance discovered missing " << missing;
                 if ((missing != RangeSet::absent) && (missing > 0) &&
@@ -1774,6 +1919,10 @@ void LedgerMasterImp::doAdvance ()
 
                                 progress = true;
                             }
+                            else if (ledger_fetch_bulk_ > 0)
+                            {
+                                fetchHistory (missing);
+                            }
                             else
                             {
                                 try
@@ -1843,6 +1992,9 @@ void LedgerMasterImp::doAdvance ()
 
                 {
                     ScopedUnlockType sul(m_mutex);
+                    LedgerCloseTimings::ScopedTimer timer (
+                        app_.getLedgerCloseTimings (), ledger->info().seq,
+                            LedgerCloseTimings::Phase::publish);
                     app_.getOPs().pubLedger(ledger);
                 }
             }
@@ -1951,80 +2103,9 @@ void LedgerMasterImp::makeFetchPack (
     }
 
 
-    auto fpAppender = [](
-        protocol::TMGetObjectByHash* reply,
-        std::uint32_t ledgerSeq,
-        uint256 const& hash,
-        const Blob& blob)
-    {
-        protocol::TMIndexedObject& newObj = * (reply->add_objects ());
-        newObj.set_ledgerseq (ledgerSeq);
-        newObj.set_hash (hash.begin (), 256 / 8);
-        newObj.set_data (&blob[0], blob.size ());
-    };
-
-    try
-    {
-        protocol::TMGetObjectByHash reply;
-        reply.set_query (false);
-
-        if (request->has_seq ())
-            reply.set_seq (request->seq ());
-
-        reply.set_ledgerhash (request->ledgerhash ());
-        reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
-
-        // Building a fetch pack:
-        //  1. Add the header for the requested ledger.
-        //  2. Add the nodes for the AccountStateMap of that ledger.
-        //  3. If there are transactions, add the nodes for the
-        //     transactions of the ledger.
-        //  4. If the FetchPack now contains greater than or equal to
-        //     256 entries then stop.
-        //  5. If not very much time has elapsed, then loop back and repeat
-        //     the same process adding the previous ledger to the FetchPack.
-        do
-        {
-            std::uint32_t lSeq = wantLedger->info().seq;
-
-            protocol::TMIndexedObject& newObj = *reply.add_objects ();
-            newObj.set_hash (wantLedger->getHash ().begin (), 256 / 8);
-            Serializer s (256);
-            s.add32 (HashPrefix::ledgerMaster);
-            wantLedger->addRaw (s);
-            newObj.set_data (s.getDataPtr (), s.getLength ());
-            newObj.set_ledgerseq (lSeq);
-
-            wantLedger->stateMap().getFetchPack
-                (&haveLedger->stateMap(), true, 16384,
-                    std::bind (fpAppender, &reply, lSeq, std::placeholders::_1,
-                               std::placeholders::_2));
-
-            if (wantLedger->info().txHash.isNonZero ())
-                wantLedger->txMap().getFetchPack (
-                    nullptr, true, 512,
-                    std::bind (fpAppender, &reply, lSeq, std::placeholders::_1,
-                               std::placeholders::_2));
-
-            if (reply.objects ().size () >= 512)
-                break;
-
-            // move may save a ref/unref
-            haveLedger = std::move (wantLedger);
-            wantLedger = getLedgerByHash (haveLedger->info().parentHash);
-        }
-        while (wantLedger &&
-               UptimeTimer::getInstance ().getElapsedSeconds () <= uUptime + 1);
-
-        m_journal.info
-            << "Built fetch pack with " << reply.objects ().size () << " nodes";
-        auto msg = std::make_shared<Message> (reply, protocol::mtGET_OBJECTS);
-        peer->send (msg);
-    }
-    catch (std::exception const&)
-    {
-        m_journal.warning << "Exception building fetch pach";
-    }
+    // The pack is built and sent a message at a time by the streamer
+    if (! mFetchPackStreamer->add (wPeer, *request, haveLedger, wantLedger))
+        m_journal.info << "Too many fetch packs on the way";
 }
 
 std::size_t LedgerMasterImp::getFetchPackCacheSize () const
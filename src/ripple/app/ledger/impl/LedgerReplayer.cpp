@@ -0,0 +1,180 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/impl/LedgerReplayer.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/app/tx/applySteps.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/TimeKeeper.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+#include <boost/optional.hpp>
+#include <future>
+#include <map>
+
+namespace ripple {
+
+namespace {
+
+// Transactions whose state is prefetched before the ledger is rebuilt
+std::size_t const replayPrefetchTxs = 8;
+
+// A ledger's header and its transactions, in the order they were applied
+struct ReplayLedger
+{
+    std::shared_ptr<Ledger> header;
+    std::map<std::uint32_t, std::shared_ptr<STTx const>> txs;
+};
+
+boost::optional<ReplayLedger>
+loadReplay (Application& app, uint256 const& hash,
+    std::shared_ptr<Ledger const> const& parent, beast::Journal j)
+{
+    auto const node = app.getNodeStore ().fetch (hash);
+    if (! node)
+        return boost::none;
+
+    ReplayLedger stored;
+    stored.header = std::make_shared<Ledger> (node->getData ().data (),
+        node->getData ().size (), true, app.config (), app.family ());
+    auto const& info = stored.header->info ();
+    if (info.hash != hash)
+    {
+        JLOG (j.warning) << hash << " cannot be a ledger";
+        return boost::none;
+    }
+
+    if (info.txHash.isNonZero ())
+    {
+        try
+        {
+            if (! stored.header->txMap ().fetchRoot (
+                    SHAMapHash {info.txHash}, nullptr))
+                return boost::none;
+
+            for (auto const& tx : stored.header->txs)
+                stored.txs.emplace (
+                    (*tx.second)[sfTransactionIndex], tx.first);
+        }
+        catch (SHAMapMissingNode const&)
+        {
+            JLOG (j.debug) << "Transactions of ledger " << info.seq <<
+                " are not all stored";
+            return boost::none;
+        }
+    }
+
+    // The parent has the state the first transactions read, unless the
+    // ledger before this one changes it
+    std::size_t count = 0;
+    for (auto const& tx : stored.txs)
+    {
+        if (++count > replayPrefetchTxs)
+            break;
+        parent->prefetch (prefetchKeys (*tx.second));
+    }
+    return std::move (stored);
+}
+
+std::shared_ptr<Ledger>
+buildReplay (Application& app, Ledger const& parent,
+    ReplayLedger const& stored, beast::Journal j)
+{
+    auto const& info = stored.header->info ();
+    auto ledger = std::make_shared<Ledger> (
+        open_ledger, parent, app.timeKeeper ().closeTime ());
+    ledger->setClosed ();
+    {
+        OpenView accum (&*ledger);
+        TxPrefetch prefetch (accum);
+        for (auto iter = stored.txs.begin ();
+            iter != stored.txs.end (); ++iter)
+        {
+            prefetch (iter, stored.txs.end ());
+            auto const result = apply (app, accum, *iter->second,
+                tapNO_CHECK_SIGN, j);
+            if (! result.second)
+            {
+                JLOG (j.warning) << "Transaction " <<
+                    iter->second->getTransactionID () << " of ledger " <<
+                    info.seq << " is not applied: " <<
+                    transHuman (result.first);
+                return {};
+            }
+        }
+        accum.apply (*ledger);
+    }
+
+    ledger->updateSkipList ();
+    ledger->stateMap ().flushDirty (hotACCOUNT_NODE, ledger->info ().seq);
+    ledger->txMap ().flushDirty (hotTRANSACTION_NODE, ledger->info ().seq);
+    ledger->setAccepted (info.closeTime, info.closeTimeResolution,
+        (info.closeFlags & sLCF_NoConsensusTime) == 0, app.config ());
+
+    if (ledger->getHash () != info.hash)
+    {
+        JLOG (j.warning) << "Ledger " << info.seq << " rebuilt as " <<
+            ledger->getHash () << " instead of " << info.hash;
+        return {};
+    }
+    return ledger;
+}
+
+}
+
+std::vector<std::shared_ptr<Ledger>>
+replayLedgers (Application& app, std::shared_ptr<Ledger const> parent,
+    std::vector<uint256> const& hashes, beast::Journal journal)
+{
+    std::vector<std::shared_ptr<Ledger>> ledgers;
+    if (hashes.empty ())
+        return ledgers;
+
+    auto next = loadReplay (app, hashes.front (), parent, journal);
+    for (std::size_t i = 0; next; ++i)
+    {
+        auto const stored = std::move (*next);
+        if (stored.header->info ().parentHash != parent->info ().hash)
+            break;
+
+        // The next ledger is read while this one is built on its parent
+        std::future<boost::optional<ReplayLedger>> pending;
+        if (i + 1 < hashes.size ())
+            pending = std::async (std::launch::async,
+                &loadReplay, std::ref (app), hashes[i + 1], parent, journal);
+
+        std::shared_ptr<Ledger> ledger;
+        try
+        {
+            ledger = buildReplay (app, *parent, stored, journal);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (journal.warning) << "Unable to rebuild ledger " <<
+                stored.header->info ().seq << ": " << e.what ();
+        }
+
+        next = boost::none;
+        try
+        {
+            if (pending.valid ())
+                next = pending.get ();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (journal.warning) << "Unable to read ledger " <<
+                hashes[i + 1] << ": " << e.what ();
+        }
+        if (! ledger)
+            break;
+
+        JLOG (journal.debug) << "Rebuilt ledger " <<
+            ledger->info ().seq << " with " << stored.txs.size () <<
+            " transactions";
+        ledgers.push_back (ledger);
+        parent = std::move (ledger);
+    }
+    return ledgers;
+}
+
+} // ripple
@@ -0,0 +1,31 @@
+#ifndef RIPPLE_APP_LEDGER_LEDGERREPLAYER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERREPLAYER_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <beast/utility/Journal.h>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+/** Rebuild validated ledgers from the ledger before each of them.
+
+    Each ledger's header and transactions are read from the node store and
+    the transactions are applied to the ledger before it in the order they
+    were first applied. While one ledger is being rebuilt the next one is
+    read, and the state its first transactions touch is prefetched.
+
+    @param parent The ledger before the first one.
+    @param hashes The validated hashes of the ledgers to rebuild, in order.
+
+    @return The ledgers rebuilt, in order. This stops at the first ledger
+            which is not stored or does not come out with its hash.
+*/
+std::vector<std::shared_ptr<Ledger>>
+replayLedgers (Application& app, std::shared_ptr<Ledger const> parent,
+    std::vector<uint256> const& hashes, beast::Journal journal);
+
+} // ripple
+
+#endif
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/impl/LedgerSaver.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/ConfigSections.h>
+#include <beast/threads/Thread.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace ripple {
+
+class LedgerSaverImp : public LedgerSaver
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        LedgerSave save;
+        clock_type::time_point queued;
+    };
+
+    Application& app_;
+    beast::Journal j_;
+    std::size_t const queueMax_;
+    std::size_t const batchMax_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable space_;
+    std::deque<Entry> queue_;
+    bool running_ = false;
+    bool shouldExit_ = false;
+
+    std::thread thread_;
+
+public:
+    LedgerSaverImp (
+        Application& app,
+        Stoppable& stoppable,
+        beast::Journal journal)
+        : LedgerSaver (stoppable)
+        , app_ (app)
+        , j_ (journal)
+        , queueMax_ (std::max<std::size_t> (1, get<std::size_t> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "save_queue", 256)))
+        , batchMax_ (std::max<std::size_t> (1, get<std::size_t> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "save_batch", 16)))
+    {
+    }
+
+    ~LedgerSaverImp () override
+    {
+        if (thread_.joinable())
+            LogicError ("LedgerSaverImp::onStop not called.");
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Stoppable
+    //
+    //--------------------------------------------------------------------------
+
+    void onPrepare () override
+    {
+    }
+
+    void onStart () override
+    {
+        thread_ = std::thread {&LedgerSaverImp::run, this};
+        std::lock_guard<std::mutex> lock (mutex_);
+        running_ = true;
+    }
+
+    // The ledgers still queued are saved before stopping
+    void onStop () override
+    {
+        JLOG (j_.info) << "Stopping";
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            shouldExit_ = true;
+            wakeup_.notify_one();
+            space_.notify_all();
+        }
+        thread_.join();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // LedgerSaver
+    //
+    //--------------------------------------------------------------------------
+
+    void save (std::shared_ptr<Ledger> const& ledger, bool current) override
+    {
+        std::unique_lock<std::mutex> lock (mutex_);
+
+        // Ledgers being acquired can wait, current ones arrive once a close
+        if (! current)
+            space_.wait (lock, [this]()
+                {
+                    return shouldExit_ || queue_.size () < queueMax_;
+                });
+
+        if (! running_ || shouldExit_)
+        {
+            lock.unlock ();
+            saveValidatedLedgers (app_, {{ledger, current}});
+            return;
+        }
+
+        queue_.push_back ({{ledger, current}, clock_type::now ()});
+        wakeup_.notify_one();
+    }
+
+    std::size_t getQueueSize () const override
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return queue_.size ();
+    }
+
+    std::chrono::seconds getLag () const override
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (queue_.empty ())
+            return std::chrono::seconds (0);
+        return std::chrono::duration_cast<std::chrono::seconds> (
+            clock_type::now () - queue_.front ().queued);
+    }
+
+private:
+    void run ()
+    {
+        beast::Thread::setCurrentThreadName ("LedgerSaver");
+        JLOG (j_.debug) << "Started";
+
+        std::vector<LedgerSave> batch;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock (mutex_);
+                wakeup_.wait (lock, [this]()
+                    {
+                        return shouldExit_ || ! queue_.empty ();
+                    });
+                if (queue_.empty ())
+                    break;
+
+                batch.clear ();
+                while (! queue_.empty () && batch.size () < batchMax_)
+                {
+                    batch.push_back (std::move (queue_.front ().save));
+                    queue_.pop_front ();
+                }
+                space_.notify_all();
+            }
+
+            if (batch.size () > 1)
+                JLOG (j_.debug) << "Saving " << batch.size () <<
+                    " ledgers together";
+            saveValidatedLedgers (app_, batch);
+        }
+
+        stopped();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+LedgerSaver::LedgerSaver (Stoppable& parent)
+    : Stoppable ("LedgerSaver", parent)
+{
+}
+
+LedgerSaver::~LedgerSaver ()
+{
+}
+
+std::unique_ptr<LedgerSaver>
+make_LedgerSaver (Application& app,
+    beast::Stoppable& parent, beast::Journal journal)
+{
+    return std::make_unique<LedgerSaverImp>(app, parent, journal);
+}
+
+} // ripple
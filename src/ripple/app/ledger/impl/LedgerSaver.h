@@ -0,0 +1,71 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_LEDGERSAVER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERSAVER_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/utility/Journal.h>
+#include <chrono>
+#include <memory>
+
+namespace ripple {
+
+/** Saves validated ledgers to the SQL databases on a thread of its own.
+
+    Ledgers are saved in the order they are queued. When the databases
+    fall behind, the ledgers waiting are saved together in one SQL
+    transaction, so publishing does not wait for the databases.
+*/
+class LedgerSaver
+    : public beast::Stoppable
+{
+protected:
+    explicit LedgerSaver (Stoppable& parent);
+
+public:
+    /** Destroy the object. */
+    virtual ~LedgerSaver () = 0;
+
+    /** Queue a ledger to be saved.
+
+        Current ledgers are always queued. Other ledgers wait while the
+        queue is full.
+
+        Thread safety:
+            Safe to call from any thread at any time.
+    */
+    virtual void save (std::shared_ptr<Ledger> const& ledger, bool current) = 0;
+
+    /** Number of ledgers waiting to be saved. */
+    virtual std::size_t getQueueSize () const = 0;
+
+    /** How long the oldest ledger waiting to be saved has waited. */
+    virtual std::chrono::seconds getLag () const = 0;
+};
+
+std::unique_ptr<LedgerSaver>
+make_LedgerSaver (Application& app,
+    beast::Stoppable& parent, beast::Journal journal);
+
+} // ripple
+
+#endif
@@ -0,0 +1,465 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerSnapshot.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <boost/filesystem/operations.hpp>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+char const snapshotMagic[8] = {'R', 'D', 'L', 'S', 'N', 'A', 'P', '1'};
+
+/** On-disk layout of the start of a snapshot, in host byte order. */
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t seq;
+    std::uint32_t reserved;
+    std::uint8_t hash[32];
+    std::uint8_t accountHash[32];
+    std::uint64_t count;
+    std::uint64_t indexOffset;
+    std::uint64_t indexCount;
+};
+
+/** On-disk layout of a key of the index. */
+struct IndexEntry
+{
+    std::uint8_t key[32];
+    std::uint64_t offset;
+};
+
+/** A leaf is its key and the size of its data, then the data. */
+std::size_t const leafHeader = 32 + sizeof (std::uint32_t);
+
+void
+writeBytes (std::ofstream& out, void const* data, std::size_t size)
+{
+    out.write (static_cast<char const*> (data), size);
+}
+
+}
+
+void
+LedgerSnapshot::write (boost::filesystem::path const& path,
+    LedgerInfo const& info, SHAMap const& stateMap)
+{
+    auto const temp = path.string () + ".tmp";
+    std::ofstream out (temp.c_str (), std::ios::binary | std::ios::trunc);
+    if (!out)
+        Throw<std::runtime_error> ("can not create " + temp);
+
+    FileHeader header {};
+    std::memcpy (header.magic, snapshotMagic, sizeof (header.magic));
+    header.seq = info.seq;
+    std::memcpy (header.hash, info.hash.data (), sizeof (header.hash));
+    std::memcpy (header.accountHash, info.accountHash.data (),
+        sizeof (header.accountHash));
+    writeBytes (out, &header, sizeof (header));
+
+    std::vector<IndexEntry> index;
+    std::uint64_t offset = sizeof (header);
+    for (auto const& item : stateMap)
+    {
+        if (header.count % indexInterval == 0)
+        {
+            IndexEntry entry;
+            std::memcpy (entry.key, item.key ().data (), sizeof (entry.key));
+            entry.offset = offset;
+            index.push_back (entry);
+        }
+
+        std::uint32_t const size = item.size ();
+        writeBytes (out, item.key ().data (), 32);
+        writeBytes (out, &size, sizeof (size));
+        writeBytes (out, item.data (), size);
+        offset += leafHeader + size;
+        ++header.count;
+    }
+
+    header.indexOffset = offset;
+    header.indexCount = index.size ();
+    writeBytes (out, index.data (), index.size () * sizeof (IndexEntry));
+
+    out.seekp (0);
+    writeBytes (out, &header, sizeof (header));
+    out.close ();
+    if (out.fail ())
+        Throw<std::runtime_error> ("can not write " + temp);
+
+    boost::filesystem::rename (temp, path);
+}
+
+LedgerSnapshot::LedgerSnapshot (boost::filesystem::path const& path)
+{
+    using namespace boost::interprocess;
+
+    file_mapping (path.string ().c_str (), read_only).swap (file_);
+    mapped_region (file_, read_only).swap (region_);
+
+    auto const size = region_.get_size ();
+    FileHeader header;
+    if (size < sizeof (header))
+        Throw<std::runtime_error> ("not a ledger snapshot: " + path.string ());
+    std::memcpy (&header, at (0), sizeof (header));
+
+    if (std::memcmp (header.magic, snapshotMagic, sizeof (header.magic)) ||
+        header.indexOffset < sizeof (header) ||
+        header.indexOffset > size ||
+        header.indexCount * sizeof (IndexEntry) != size - header.indexOffset ||
+        header.indexCount != (header.count + indexInterval - 1) / indexInterval)
+    {
+        Throw<std::runtime_error> ("not a ledger snapshot: " + path.string ());
+    }
+
+    seq_ = header.seq;
+    hash_ = uint256::fromVoid (header.hash);
+    accountHash_ = uint256::fromVoid (header.accountHash);
+    count_ = header.count;
+    leavesBegin_ = sizeof (header);
+    leavesEnd_ = header.indexOffset;
+    indexCount_ = header.indexCount;
+}
+
+std::uint32_t
+LedgerSnapshot::leafSize (position pos) const
+{
+    std::uint32_t size = 0;
+    if (pos + leafHeader <= leavesEnd_)
+        std::memcpy (&size, at (pos + 32), sizeof (size));
+    if (pos < leavesBegin_ || pos + leafHeader + size > leavesEnd_)
+        Throw<std::runtime_error> ("corrupt ledger snapshot");
+    return size;
+}
+
+auto
+LedgerSnapshot::next (position pos) const -> position
+{
+    return pos + leafHeader + leafSize (pos);
+}
+
+uint256
+LedgerSnapshot::key (position pos) const
+{
+    leafSize (pos);
+    return uint256::fromVoid (at (pos));
+}
+
+Slice
+LedgerSnapshot::data (position pos) const
+{
+    auto const size = leafSize (pos);
+    return Slice (at (pos + leafHeader), size);
+}
+
+auto
+LedgerSnapshot::lower_bound (uint256 const& key) const -> position
+{
+    // The last key of the index that is less than key, if any
+    std::uint64_t lo = 0;
+    std::uint64_t hi = indexCount_;
+    IndexEntry entry;
+    while (lo < hi)
+    {
+        auto const mid = lo + (hi - lo) / 2;
+        std::memcpy (&entry, at (leavesEnd_ + mid * sizeof (entry)),
+            sizeof (entry));
+        if (uint256::fromVoid (entry.key) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    position pos = leavesBegin_;
+    if (lo != 0)
+    {
+        std::memcpy (&entry, at (leavesEnd_ + (lo - 1) * sizeof (entry)),
+            sizeof (entry));
+        pos = entry.offset;
+    }
+
+    while (pos != leavesEnd_ && this->key (pos) < key)
+        pos = next (pos);
+    return pos;
+}
+
+auto
+LedgerSnapshot::upper_bound (uint256 const& key) const -> position
+{
+    auto pos = lower_bound (key);
+    if (pos != leavesEnd_ && this->key (pos) == key)
+        pos = next (pos);
+    return pos;
+}
+
+boost::optional<Slice>
+LedgerSnapshot::find (uint256 const& key) const
+{
+    auto const pos = lower_bound (key);
+    if (pos == leavesEnd_ || this->key (pos) != key)
+        return boost::none;
+    return data (pos);
+}
+
+//------------------------------------------------------------------------------
+
+class SnapshotView::sles_iter_impl
+    : public sles_type::iter_base
+{
+private:
+    LedgerSnapshot const* snapshot_;
+    LedgerSnapshot::position pos_;
+
+public:
+    sles_iter_impl() = delete;
+    sles_iter_impl& operator= (sles_iter_impl const&) = delete;
+
+    sles_iter_impl (sles_iter_impl const&) = default;
+
+    sles_iter_impl (LedgerSnapshot const& snapshot,
+            LedgerSnapshot::position pos)
+        : snapshot_ (&snapshot)
+        , pos_ (pos)
+    {
+    }
+
+    std::unique_ptr<base_type>
+    copy() const override
+    {
+        return std::make_unique<
+            sles_iter_impl>(*this);
+    }
+
+    bool
+    equal (base_type const& impl) const override
+    {
+        auto const& other = dynamic_cast<
+            sles_iter_impl const&>(impl);
+        return pos_ == other.pos_;
+    }
+
+    void
+    increment() override
+    {
+        pos_ = snapshot_->next (pos_);
+    }
+
+    sles_type::value_type
+    dereference() const override
+    {
+        SerialIter sit (snapshot_->data (pos_));
+        return std::make_shared<SLE const>(
+            sit, snapshot_->key (pos_));
+    }
+};
+
+SnapshotView::SnapshotView (std::shared_ptr<ReadView const> const& base,
+        std::shared_ptr<LedgerSnapshot const> const& snapshot)
+    : base_ (base)
+    , snapshot_ (snapshot)
+{
+    assert (base_->info ().hash == snapshot_->hash ());
+}
+
+LedgerInfo const&
+SnapshotView::info () const
+{
+    return base_->info ();
+}
+
+Fees const&
+SnapshotView::fees () const
+{
+    return base_->fees ();
+}
+
+Rules const&
+SnapshotView::rules () const
+{
+    return base_->rules ();
+}
+
+bool
+SnapshotView::exists (Keylet const& k) const
+{
+    return static_cast<bool> (snapshot_->find (k.key));
+}
+
+auto
+SnapshotView::succ (key_type const& key,
+    boost::optional<key_type> const& last) const ->
+        boost::optional<key_type>
+{
+    auto const pos = snapshot_->upper_bound (key);
+    if (pos == snapshot_->end ())
+        return boost::none;
+    auto const next = snapshot_->key (pos);
+    if (last && next >= last)
+        return boost::none;
+    return next;
+}
+
+std::shared_ptr<SLE const>
+SnapshotView::read (Keylet const& k) const
+{
+    if (k.key == zero)
+    {
+        assert(false);
+        return nullptr;
+    }
+    auto const data = snapshot_->find (k.key);
+    if (! data)
+        return nullptr;
+    SerialIter sit (*data);
+    auto sle = std::make_shared<SLE>(sit, k.key);
+    if (! k.check(*sle))
+        return nullptr;
+    sle->setImmutable();
+    sle->share();
+    return std::move(sle);
+}
+
+auto
+SnapshotView::slesBegin() const ->
+    std::unique_ptr<sles_type::iter_base>
+{
+    return std::make_unique<sles_iter_impl>(
+        *snapshot_, snapshot_->begin ());
+}
+
+auto
+SnapshotView::slesEnd() const ->
+    std::unique_ptr<sles_type::iter_base>
+{
+    return std::make_unique<sles_iter_impl>(
+        *snapshot_, snapshot_->end ());
+}
+
+auto
+SnapshotView::slesUpperBound(key_type const& key) const ->
+    std::unique_ptr<sles_type::iter_base>
+{
+    return std::make_unique<sles_iter_impl>(
+        *snapshot_, snapshot_->upper_bound (key));
+}
+
+auto
+SnapshotView::txsBegin() const ->
+    std::unique_ptr<txs_type::iter_base>
+{
+    return base_->txsBegin ();
+}
+
+auto
+SnapshotView::txsEnd() const ->
+    std::unique_ptr<txs_type::iter_base>
+{
+    return base_->txsEnd ();
+}
+
+bool
+SnapshotView::txExists (key_type const& key) const
+{
+    return base_->txExists (key);
+}
+
+auto
+SnapshotView::txRead (key_type const& key) const -> tx_type
+{
+    return base_->txRead (key);
+}
+
+//------------------------------------------------------------------------------
+
+LedgerSnapshots::LedgerSnapshots (Section const& section,
+        beast::Journal journal)
+    : journal_ (journal)
+{
+    std::string path;
+    if (set (path, "path", section) && !path.empty ())
+    {
+        path_ = path;
+        boost::filesystem::create_directories (path_);
+    }
+}
+
+boost::filesystem::path
+LedgerSnapshots::file (LedgerIndex seq) const
+{
+    return path_ / ("ledger_" + std::to_string (seq) + ".snapshot");
+}
+
+void
+LedgerSnapshots::add (Ledger const& ledger)
+{
+    if (!enabled ())
+        Throw<std::runtime_error> ("no [ledger_snapshots] path");
+    if (ledger.info ().open)
+        Throw<std::runtime_error> ("ledger is not closed");
+
+    auto const seq = ledger.info ().seq;
+    auto const path = file (seq);
+    LedgerSnapshot::write (path, ledger.info (), ledger.stateMap ());
+    auto snapshot = std::make_shared<LedgerSnapshot const> (path);
+
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        snapshots_[seq] = snapshot;
+    }
+
+    JLOG (journal_.info) << "Snapshot of ledger " << seq << ", "
+        << snapshot->size () << " items";
+}
+
+std::shared_ptr<ReadView const>
+LedgerSnapshots::view (std::shared_ptr<ReadView const> const& ledger)
+{
+    if (!enabled () || !ledger || ledger->info ().open)
+        return nullptr;
+
+    auto const seq = ledger->info ().seq;
+    std::shared_ptr<LedgerSnapshot const> snapshot;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const iter = snapshots_.find (seq);
+        if (iter != snapshots_.end ())
+        {
+            snapshot = iter->second;
+        }
+        else
+        {
+            auto const path = file (seq);
+            boost::system::error_code ec;
+            if (!boost::filesystem::exists (path, ec))
+                return nullptr;
+
+            try
+            {
+                snapshot = std::make_shared<LedgerSnapshot const> (path);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG (journal_.warning) << "Snapshot " << path.string ()
+                    << ": " << e.what ();
+                return nullptr;
+            }
+            snapshots_.emplace (seq, snapshot);
+        }
+    }
+
+    // A snapshot of a ledger with the same sequence on another chain
+    if (snapshot->hash () != ledger->info ().hash)
+        return nullptr;
+
+    return std::make_shared<SnapshotView> (ledger, snapshot);
+}
+
+}
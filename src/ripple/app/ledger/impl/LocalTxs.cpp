@@ -21,6 +21,7 @@
 #include <ripple/app/ledger/LocalTxs.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/protocol/Indexes.h>
+#include <algorithm>
 
 /*
  This code prevents scenarios like the following:
@@ -59,8 +60,10 @@ public:
     // get into a fully-validated ledger.
     static int const holdLedgers = 5;
 
-    LocalTx (LedgerIndex index, std::shared_ptr<STTx const> const& txn)
+    LocalTx (LedgerIndex index, std::shared_ptr<STTx const> const& txn,
+            CanonicalTXSet::iterator position)
         : m_txn (txn)
+        , m_position (position)
         , m_expire (index + holdLedgers)
         , m_id (txn->getTransactionID ())
         , m_account (txn->getAccountID(sfAccount))
@@ -95,9 +98,16 @@ public:
         return m_account;
     }
 
+    // Where the transaction is in the canonical set
+    CanonicalTXSet::iterator getPosition () const
+    {
+        return m_position;
+    }
+
 private:
 
     std::shared_ptr<STTx const> m_txn;
+    CanonicalTXSet::iterator       m_position;
     LedgerIndex                    m_expire;
     uint256                        m_id;
     AccountID                      m_account;
@@ -117,7 +127,21 @@ public:
     {
         std::lock_guard <std::mutex> lock (m_lock);
 
-        m_txns.emplace_back (index, txn);
+        auto const result = m_ordered.insert (txn);
+        if (result.second)
+        {
+            m_txns.emplace_back (index, txn, result.first);
+        }
+        else
+        {
+            // Submitted again, so it is held from this ledger on
+            auto const& id = txn->getTransactionID ();
+            auto const iter = std::find_if (m_txns.begin (), m_txns.end (),
+                [&id](LocalTx const& t) { return t.getID () == id; });
+            if (iter != m_txns.end ())
+                *iter = LocalTx (index, txn, result.first);
+        }
+        m_snapshot.reset ();
     }
 
     bool can_remove (LocalTx& txn, Ledger::ref ledger)
@@ -135,21 +159,18 @@ public:
         return false;
     }
 
-    CanonicalTXSet
+    std::shared_ptr<CanonicalTXSet const>
     getTxSet () override
     {
-        CanonicalTXSet tset (uint256 {});
-
-        // Get the set of local transactions as a canonical
-        // set (so they apply in a valid order)
-        {
-            std::lock_guard <std::mutex> lock (m_lock);
+        // The local transactions are kept as a canonical set (so
+        // they apply in a valid order), and copied only after they
+        // have changed
+        std::lock_guard <std::mutex> lock (m_lock);
 
-            for (auto const& it : m_txns)
-                tset.insert (it.getTX());
-        }
+        if (! m_snapshot)
+            m_snapshot = std::make_shared<CanonicalTXSet const> (m_ordered);
 
-        return tset;
+        return m_snapshot;
     }
 
     // Remove transactions that have either been accepted into a fully-validated
@@ -161,7 +182,11 @@ public:
         for (auto it = m_txns.begin (); it != m_txns.end (); )
         {
             if (can_remove (*it, validLedger))
+            {
+                m_ordered.erase (it->getPosition ());
                 it = m_txns.erase (it);
+                m_snapshot.reset ();
+            }
             else
                 ++it;
         }
@@ -177,6 +202,8 @@ public:
 private:
     std::mutex m_lock;
     std::list <LocalTx> m_txns;
+    CanonicalTXSet m_ordered {uint256 {}};
+    std::shared_ptr<CanonicalTXSet const> m_snapshot;
 };
 
 std::unique_ptr<LocalTxs>
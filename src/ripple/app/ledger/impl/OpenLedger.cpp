@@ -19,13 +19,262 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/main/Application.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/ledger/CachedView.h>
 #include <ripple/protocol/Feature.h>
 #include <boost/range/adaptor/transformed.hpp>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
 
 namespace ripple {
 
+namespace {
+
+// Transactions applied in parallel per thread in each round
+std::size_t const windowPerThread = 32;
+
+// The keys changed in a view since some point
+struct WriteSet
+{
+    std::set<uint256> keys;
+    hash_set<uint256> txs;
+};
+
+// Forwards reads to a view, remembering what they depended on
+class ReadSetView : public ReadView
+{
+private:
+    ReadView const& base_;
+    mutable hash_set<uint256> keys_;
+    mutable std::vector<std::pair<uint256,
+        boost::optional<uint256>>> ranges_;
+    mutable hash_set<uint256> txKeys_;
+    mutable bool everything_ = false;
+
+public:
+    explicit
+    ReadSetView (ReadView const& base)
+        : base_ (base)
+    {
+    }
+
+    /** Returns `true` if nothing that was read
+        could have been changed by the writes.
+    */
+    bool
+    unchangedBy (WriteSet const& written) const
+    {
+        if (everything_)
+            return false;
+        for (auto const& key : keys_)
+        {
+            if (written.keys.count (key))
+                return false;
+        }
+        // A key added or removed between a key and
+        // its successor changes the successor
+        for (auto const& range : ranges_)
+        {
+            auto const iter =
+                written.keys.upper_bound (range.first);
+            if (iter != written.keys.end () &&
+                    (! range.second || *iter <= *range.second))
+                return false;
+        }
+        for (auto const& key : txKeys_)
+        {
+            if (written.txs.count (key))
+                return false;
+        }
+        return true;
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists (Keylet const& k) const override
+    {
+        keys_.insert (k.key);
+        return base_.exists (k);
+    }
+
+    boost::optional<key_type>
+    succ (key_type const& key, boost::optional<
+        key_type> const& last = boost::none) const override
+    {
+        auto const next = base_.succ (key, last);
+        ranges_.emplace_back (key, next ? next : last);
+        return next;
+    }
+
+    std::shared_ptr<SLE const>
+    read (Keylet const& k) const override
+    {
+        keys_.insert (k.key);
+        return base_.read (k);
+    }
+
+    void
+    prefetch (std::vector<key_type> const& keys) const override
+    {
+        base_.prefetch (keys);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        everything_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        everything_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound (uint256 const& key) const override
+    {
+        everything_ = true;
+        return base_.slesUpperBound (key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        everything_ = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        everything_ = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists (key_type const& key) const override
+    {
+        txKeys_.insert (key);
+        return base_.txExists (key);
+    }
+
+    tx_type
+    txRead (key_type const& key) const override
+    {
+        txKeys_.insert (key);
+        return base_.txRead (key);
+    }
+};
+
+// Forwards changes to a view, remembering the keys they touch
+class WriteSetView : public TxsRawView
+{
+private:
+    OpenView& to_;
+    WriteSet& written_;
+
+public:
+    WriteSetView (OpenView& to, WriteSet& written)
+        : to_ (to)
+        , written_ (written)
+    {
+    }
+
+    void
+    rawErase (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.keys.insert (sle->key());
+        to_.rawErase (sle);
+    }
+
+    void
+    rawInsert (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.keys.insert (sle->key());
+        to_.rawInsert (sle);
+    }
+
+    void
+    rawReplace (std::shared_ptr<SLE> const& sle) override
+    {
+        written_.keys.insert (sle->key());
+        to_.rawReplace (sle);
+    }
+
+    void
+    rawDestroyXRP (XRPAmount const& fee) override
+    {
+        to_.rawDestroyXRP (fee);
+    }
+
+    void
+    rawCreateXRP (XRPAmount const& drops) override
+    {
+        to_.rawCreateXRP (drops);
+    }
+
+    void
+    rawCreateVBC (XRPAmount const& drops) override
+    {
+        to_.rawCreateVBC (drops);
+    }
+
+    void
+    rawTxInsert (ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+            std::shared_ptr<Serializer const> const& metaData) override
+    {
+        written_.txs.insert (key);
+        to_.rawTxInsert (key, txn, metaData);
+    }
+};
+
+// Transactions whose effects are all in the state they read and
+// write. The others can change what is cached outside the ledger,
+// like the referral chains, so they are applied one at a time and
+// what follows them in their window is applied again.
+bool
+speculative (STTx const& tx)
+{
+    switch (tx.getTxnType ())
+    {
+    case ttPAYMENT:
+    case ttACCOUNT_SET:
+    case ttREGULAR_KEY_SET:
+    case ttOFFER_CREATE:
+    case ttOFFER_CANCEL:
+    case ttTRUST_SET:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}
+
 OpenLedger::OpenLedger(std::shared_ptr<
     Ledger const> const& ledger,
         CachedSLEs& cache,
@@ -153,6 +402,118 @@ OpenLedger::apply_one (Application& app, OpenView& view,
     return Result::retry;
 }
 
+int
+OpenLedger::parallelThreads (Application& app,
+    ReadView const& view)
+{
+    // Closed views number their metadata in
+    // the order transactions are applied
+    if (! view.open ())
+        return 0;
+    auto const threads = app.config ().PARALLEL_APPLY;
+    return (threads > 1) ? threads : 0;
+}
+
+void
+OpenLedger::apply_parallel (Application& app, OpenView& view,
+    ReadView const& check, std::vector<std::shared_ptr<
+        STTx const>> const& txs, OrderedTxs& retries,
+            ApplyFlags flags, int threads,
+                beast::Journal j)
+{
+    struct Speculation
+    {
+        std::unique_ptr<ReadSetView> reads;
+        std::unique_ptr<OpenView> changes;
+        Result result = Result::failure;
+        bool done = false;
+    };
+
+    std::size_t const window = windowPerThread * threads;
+    std::size_t reapplied = 0;
+    for (std::size_t first = 0; first < txs.size (); first += window)
+    {
+        auto const last = std::min (first + window, txs.size ());
+        std::vector<Speculation> speculations (last - first);
+
+        // Nothing changes the view while the threads read it.
+        std::atomic<std::size_t> next (first);
+        auto worker = [&]()
+        {
+            for (std::size_t i; (i = next++) < last;)
+            {
+                auto const& tx = txs[i];
+                if (! speculative (*tx) ||
+                        check.txExists (tx->getTransactionID ()))
+                    continue;
+                auto& s = speculations[i - first];
+                try
+                {
+                    s.reads = std::make_unique<ReadSetView> (view);
+                    s.changes = std::make_unique<OpenView> (s.reads.get ());
+                    s.result = apply_one (app, *s.changes,
+                        tx, true, flags, j);
+                    s.done = true;
+                }
+                catch (std::exception const&)
+                {
+                    // Applied again below
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        auto const count = std::min<std::size_t> (threads, last - first);
+        workers.reserve (count - 1);
+        for (std::size_t i = 1; i < count; ++i)
+            workers.emplace_back (worker);
+        worker ();
+        for (auto& t : workers)
+            t.join ();
+
+        WriteSet written;
+        bool barrier = false;
+        for (auto i = first; i < last; ++i)
+        {
+            auto const& tx = txs[i];
+            auto& s = speculations[i - first];
+            try
+            {
+                if (check.txExists (tx->getTransactionID ()) ||
+                    view.txExists (tx->getTransactionID ()))
+                    continue;
+                WriteSetView to (view, written);
+                Result result;
+                if (s.done && ! barrier && s.reads->unchangedBy (written))
+                {
+                    s.changes->apply (to);
+                    result = s.result;
+                }
+                else
+                {
+                    OpenView changes (&view);
+                    result = apply_one (app, changes,
+                        tx, true, flags, j);
+                    changes.apply (to);
+                    ++reapplied;
+                }
+                if (! speculative (*tx))
+                    barrier = true;
+                if (result == Result::retry)
+                    retries.insert (tx);
+            }
+            catch (std::exception const&)
+            {
+                JLOG(j.error) <<
+                    "Caught exception";
+            }
+        }
+    }
+
+    JLOG(j.debug) << "Applied " << txs.size () << " transactions on " <<
+        threads << " threads, " << reapplied << " applied again";
+}
+
 //------------------------------------------------------------------------------
 
 std::string
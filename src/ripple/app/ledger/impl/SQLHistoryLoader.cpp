@@ -0,0 +1,421 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/SQLHistoryLoader.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/nodestore/Database.h>
+#include <beast/threads/Thread.h>
+#include <boost/format.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace ripple {
+
+namespace {
+
+struct SQLIndex
+{
+    char const* table;
+    char const* name;
+    char const* columns;
+};
+
+class SQLHistoryLoader
+{
+    using AcceptedLedgers = std::vector<std::shared_ptr<AcceptedLedger>>;
+
+    Application& app_;
+    beast::Journal j_;
+    std::uint32_t const first_;
+    std::uint32_t const last_;
+
+    // Threads reading ledgers from the node store
+    std::size_t const threads_;
+
+    // Ledgers written in one SQL transaction
+    std::uint32_t const batch_;
+
+    bool const isMySQL_;
+
+    // The next ledger to walk, from the newest down
+    uint256 nextHash_;
+    std::uint32_t nextSeq_;
+
+public:
+    SQLHistoryLoader (
+        Application& app,
+        std::uint32_t first,
+        std::uint32_t last)
+        : app_ (app)
+        , j_ (app.journal ("SQLHistoryLoader"))
+        , first_ (first)
+        , last_ (last)
+        , threads_ (std::max<std::size_t> (1, get<std::size_t> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "load_threads", std::thread::hardware_concurrency ())))
+        , batch_ (std::max<std::uint32_t> (1, get<std::uint32_t> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "load_batch", 1000)))
+        , isMySQL_ (app.getTxnDB ().getType () == DatabaseCon::Type::MySQL)
+        , nextSeq_ (last)
+    {
+    }
+
+    int run ()
+    {
+        if (first_ == 0 || first_ > last_)
+        {
+            JLOG (j_.fatal) << "Invalid range of ledgers to load";
+            return 1;
+        }
+
+        if (app_.getTxnDB ().getType () == DatabaseCon::Type::None)
+        {
+            JLOG (j_.fatal) << "There is no transaction database to load";
+            return 1;
+        }
+
+        // Every ledger from the cursor up is written
+        std::uint32_t cursor = last_ + 1;
+        {
+            auto db = app_.getTxnDB ().checkoutDb ();
+
+            if (auto const loading = getState (*db, "SQLHistoryLast"))
+            {
+                if (*loading != last_)
+                {
+                    JLOG (j_.fatal) << "The load of the ledgers up to " <<
+                        *loading << " is incomplete and must be finished "
+                        "first";
+                    return 1;
+                }
+                cursor = rangeCheckedCast<std::uint32_t> (
+                    getState (*db, "SQLHistoryCursor").value_or (cursor));
+                JLOG (j_.info) << "Resuming the load below ledger " << cursor;
+            }
+            else
+            {
+                int rows = 0;
+                *db << "SELECT COUNT(*) FROM Transactions "
+                       "WHERE LedgerSeq BETWEEN :first AND :last;",
+                    soci::into (rows), soci::use (first_), soci::use (last_);
+                if (rows != 0)
+                {
+                    JLOG (j_.fatal) << "The transaction database already "
+                        "holds ledgers from " << first_ << " to " << last_;
+                    return 1;
+                }
+
+                soci::transaction tr (*db);
+                setState (*db, "SQLHistoryLast", last_);
+                setState (*db, "SQLHistoryCursor", cursor);
+                tr.commit ();
+            }
+        }
+
+        try
+        {
+            dropIndexes ();
+
+            nextHash_ = getHashByIndex (last_, app_);
+            if (nextHash_.isZero ())
+            {
+                JLOG (j_.fatal) << "Ledger " << last_ <<
+                    " is not in the ledger database";
+                return 1;
+            }
+
+            // The ledgers already written are only walked past
+            if (cursor <= last_)
+                walk (cursor);
+
+            // Each batch is read from the node store while the one
+            // before it is written
+            std::uint32_t lo = cursor;
+            std::future<AcceptedLedgers> pending;
+            auto const readBatch = [&]()
+            {
+                std::uint32_t const hi = lo - 1;
+                lo = (hi - first_ >= batch_) ? hi - batch_ + 1 : first_;
+                pending = std::async (std::launch::async,
+                    &SQLHistoryLoader::accept, this, walk (lo));
+            };
+
+            if (lo > first_)
+                readBatch ();
+
+            while (pending.valid ())
+            {
+                auto const ledgers = pending.get ();
+                std::uint32_t const written = lo;
+                if (lo > first_)
+                    readBatch ();
+                write (written, ledgers);
+            }
+
+            buildIndexes ();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (j_.fatal) << "The load failed: " << e.what () <<
+                ". Run it again to resume it";
+            return 1;
+        }
+
+        {
+            auto db = app_.getTxnDB ().checkoutDb ();
+            *db << "DELETE FROM TxnDBState WHERE "
+                   "Name IN ('SQLHistoryLast', 'SQLHistoryCursor');";
+        }
+
+        JLOG (j_.info) << "Loaded ledgers " << first_ << " to " << last_;
+        return 0;
+    }
+
+private:
+    // The secondary indexes of the tables written. Keys are kept.
+    std::vector<SQLIndex> indexes () const
+    {
+        auto const schema = app_.getAccountTxMigrator ().getSchema ();
+
+        std::vector<SQLIndex> result {
+            {"Transactions", "TxLgrIndex", "LedgerSeq"}};
+        if (! isMySQL_)
+        {
+            result.push_back ({"Transactions", "TxLgrIDIndex",
+                "LedgerSeq, TransID"});
+        }
+        if (schema != AccountTxMigrator::Schema::binary)
+        {
+            result.push_back ({"AccountTransactions", "AcctTxIDIndex",
+                "TransID"});
+            result.push_back ({"AccountTransactions", "AcctTxIndex",
+                "Account, LedgerSeq, TxnSeq, TransID"});
+            result.push_back ({"AccountTransactions", "AcctLgrIndex",
+                "LedgerSeq, Account, TransID"});
+            result.push_back ({"AccountTransactions", "AcctTxTypeIndex",
+                "Account, TransType, LedgerSeq, TxnSeq"});
+        }
+        if (schema != AccountTxMigrator::Schema::legacy)
+        {
+            result.push_back ({"AccountTxs", "AcctTxsIDIndex",
+                "TransID"});
+            result.push_back ({"AccountTxs", "AcctTxsLgrIndex",
+                "LedgerSeq"});
+            result.push_back ({"AccountTxs", "AcctTxsTypeIndex",
+                "Account, TransType, LedgerSeq, TxnSeq"});
+        }
+        return result;
+    }
+
+    bool hasIndex (soci::session& db, SQLIndex const& index) const
+    {
+        std::string const table (index.table);
+        std::string const name (index.name);
+        int count = 0;
+        if (isMySQL_)
+            db << "SELECT COUNT(*) FROM information_schema.statistics "
+                  "WHERE table_schema = DATABASE() AND table_name = :table "
+                  "AND index_name = :name;",
+                soci::into (count), soci::use (table), soci::use (name);
+        else
+            db << "SELECT COUNT(*) FROM sqlite_master "
+                  "WHERE type = 'index' AND name = :name;",
+                soci::into (count), soci::use (name);
+        return count != 0;
+    }
+
+    void dropIndexes ()
+    {
+        auto db = app_.getTxnDB ().checkoutDb ();
+        for (auto const& index : indexes ())
+        {
+            if (! hasIndex (*db, index))
+                continue;
+
+            JLOG (j_.info) << "Dropping " << index.name << " for the load";
+            if (isMySQL_)
+                *db << boost::str (boost::format ("DROP INDEX %s ON %s;") %
+                    index.name % index.table);
+            else
+                *db << boost::str (boost::format ("DROP INDEX %s;") %
+                    index.name);
+        }
+    }
+
+    void buildIndexes ()
+    {
+        auto db = app_.getTxnDB ().checkoutDb ();
+        for (auto const& index : indexes ())
+        {
+            if (hasIndex (*db, index))
+                continue;
+
+            JLOG (j_.info) << "Building " << index.name;
+            *db << boost::str (boost::format ("CREATE INDEX %s ON %s(%s);") %
+                index.name % index.table % index.columns);
+        }
+    }
+
+    boost::optional<std::uint64_t>
+    getState (soci::session& db, char const* name)
+    {
+        std::string const key (name);
+        boost::optional<std::uint64_t> value;
+        db << "SELECT Value FROM TxnDBState WHERE Name = :name;",
+            soci::into (value), soci::use (key);
+        return value;
+    }
+
+    void setState (soci::session& db, char const* name, std::uint64_t value)
+    {
+        std::string const key (name);
+        db << "REPLACE INTO TxnDBState (Name, Value) VALUES (:name, :value);",
+            soci::use (key), soci::use (value);
+    }
+
+    std::shared_ptr<Ledger> fetchLedger (uint256 const& hash)
+    {
+        auto const node = app_.getNodeStore ().fetch (hash);
+        if (! node)
+            Throw<std::runtime_error> ("ledger " + to_string (hash) +
+                " is not in the node store");
+
+        auto ledger = std::make_shared<Ledger> (node->getData ().data (),
+            node->getData ().size (), true, app_.config (), app_.family ());
+        if (ledger->getHash () != hash)
+            Throw<std::runtime_error> (to_string (hash) +
+                " is not a ledger");
+        ledger->setClosed ();
+        return ledger;
+    }
+
+    // The hashes of the ledgers from the next one down to lo. The ledger
+    // database is followed where it agrees with the parent hashes.
+    std::vector<uint256> walk (std::uint32_t lo)
+    {
+        auto const known = getHashesByIndex (lo, nextSeq_, app_);
+
+        std::vector<uint256> hashes;
+        hashes.reserve (nextSeq_ - lo + 1);
+        for (; nextSeq_ >= lo; --nextSeq_)
+        {
+            hashes.push_back (nextHash_);
+
+            auto const it = known.find (nextSeq_);
+            if (it != known.end () && it->second.first == nextHash_)
+            {
+                nextHash_ = it->second.second;
+                continue;
+            }
+
+            auto const ledger = fetchLedger (nextHash_);
+            if (ledger->info ().seq != nextSeq_)
+                Throw<std::runtime_error> ("ledger " + to_string (nextHash_) +
+                    " is not ledger " + std::to_string (nextSeq_));
+            nextHash_ = ledger->info ().parentHash;
+        }
+        return hashes;
+    }
+
+    // Read the transactions of the ledgers on threads_ threads
+    AcceptedLedgers accept (std::vector<uint256> const& hashes)
+    {
+        AcceptedLedgers ledgers (hashes.size ());
+        std::atomic<std::size_t> next (0);
+        std::atomic<bool> failed (false);
+        std::mutex mutex;
+        std::string error;
+
+        auto const work = [&]()
+        {
+            try
+            {
+                while (! failed)
+                {
+                    auto const i = next++;
+                    if (i >= hashes.size ())
+                        break;
+                    ledgers[i] = std::make_shared<AcceptedLedger> (
+                        fetchLedger (hashes[i]), app_.accountIDCache (),
+                            app_.logs ());
+                }
+            }
+            catch (std::exception const& e)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                if (! failed.exchange (true))
+                    error = e.what ();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < threads_; ++i)
+            workers.emplace_back ([&work]()
+            {
+                beast::Thread::setCurrentThreadName ("SQLHistoryLoader");
+                work ();
+            });
+        work ();
+        for (auto& worker : workers)
+            worker.join ();
+
+        if (failed)
+            Throw<std::runtime_error> (error);
+        return ledgers;
+    }
+
+    void write (std::uint32_t lo, AcceptedLedgers const& ledgers)
+    {
+        std::size_t txns = 0;
+        for (auto const& ledger : ledgers)
+            txns += ledger->getTxnCount ();
+
+        auto db = app_.getTxnDB ().checkoutDb ();
+        soci::transaction tr (*db);
+        insertAcceptedLedgers (app_, *db, ledgers);
+        setState (*db, "SQLHistoryCursor", lo);
+        tr.commit ();
+
+        JLOG (j_.info) << "Wrote " << txns << " transactions of ledgers " <<
+            lo << " to " << (lo + ledgers.size () - 1);
+    }
+};
+
+}
+
+int
+loadSQLHistory (Application& app, std::uint32_t first, std::uint32_t last)
+{
+    SQLHistoryLoader loader (app, first, last);
+    return loader.run ();
+}
+
+} // ripple
@@ -26,7 +26,9 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/overlay/Overlay.h>
 #include <beast/utility/make_lock.h>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace ripple {
 
@@ -37,6 +39,12 @@ enum
 
     NORM_TIMEOUTS = 4,
     MAX_TIMEOUTS = 20,
+
+    // Missing nodes asked of one peer at a time
+    MAX_NODES = 256,
+
+    // Peers missing nodes are asked of at once
+    MAX_HOLDERS = 8,
 };
 
 TransactionAcquire::TransactionAcquire (Application& app, uint256 const& hash, clock_type& clock)
@@ -141,10 +149,17 @@ void TransactionAcquire::trigger (Peer::ptr const& peer)
     }
     else
     {
+        // When a peer answers, the missing nodes are split among all the
+        // peers which have the set, so that each sends part of them
+        std::vector<Peer::ptr> holders;
+        if (peer)
+            holders = getHolders (peer);
+
         std::vector<SHAMapNodeID> nodeIDs;
         std::vector<uint256> nodeHashes;
         ConsensusTransSetSF sf (app_, app_.getTempNodeCache ());
-        mMap->getMissingNodes (nodeIDs, nodeHashes, 256, &sf);
+        mMap->getMissingNodes (nodeIDs, nodeHashes,
+            MAX_NODES * std::max<int> (holders.size (), 1), &sf);
 
         if (nodeIDs.empty ())
         {
@@ -157,23 +172,65 @@ void TransactionAcquire::trigger (Peer::ptr const& peer)
             return;
         }
 
-        protocol::TMGetLedger tmGL;
-        tmGL.set_ledgerhash (mHash.begin (), mHash.size ());
-        tmGL.set_itype (protocol::liTS_CANDIDATE);
+        auto const makeRequest = [&]
+        {
+            protocol::TMGetLedger tmGL;
+            tmGL.set_ledgerhash (mHash.begin (), mHash.size ());
+            tmGL.set_itype (protocol::liTS_CANDIDATE);
 
-        if (getTimeouts () != 0)
-            tmGL.set_querytype (protocol::qtINDIRECT);
+            if (getTimeouts () != 0)
+                tmGL.set_querytype (protocol::qtINDIRECT);
+            return tmGL;
+        };
 
-        for (SHAMapNodeID& it : nodeIDs)
+        if (holders.size () <= 1)
         {
-            *tmGL.add_nodeids () = it.getRawString ();
+            auto tmGL = makeRequest ();
+            for (SHAMapNodeID& it : nodeIDs)
+            {
+                *tmGL.add_nodeids () = it.getRawString ();
+            }
+            sendRequest (tmGL, peer);
+            return;
         }
-        sendRequest (tmGL, peer);
+
+        auto const perPeer =
+            (nodeIDs.size () + holders.size () - 1) / holders.size ();
+        for (std::size_t i = 0;
+            i < holders.size () && i * perPeer < nodeIDs.size (); ++i)
+        {
+            auto tmGL = makeRequest ();
+            auto const end = std::min (nodeIDs.size (), (i + 1) * perPeer);
+            for (auto j = i * perPeer; j < end; ++j)
+                *tmGL.add_nodeids () = nodeIDs[j].getRawString ();
+            sendRequest (tmGL, holders[i]);
+        }
+        JLOG (j_.trace) << "Asked " << holders.size () << " peers for " <<
+            nodeIDs.size () << " nodes of TX set " << mHash;
     }
 }
 
+std::vector<Peer::ptr>
+TransactionAcquire::getHolders (Peer::ptr const& first)
+{
+    std::vector<Peer::ptr> holders;
+    holders.push_back (first);
+
+    for (auto const& p : mPeers)
+    {
+        if (holders.size () >= MAX_HOLDERS)
+            break;
+        if (p.first == first->id ())
+            continue;
+        auto peer = app_.overlay ().findPeerByShortID (p.first);
+        if (peer && peer->hasTxSet (mHash))
+            holders.push_back (std::move (peer));
+    }
+    return holders;
+}
+
 SHAMapAddNode TransactionAcquire::takeNodes (const std::list<SHAMapNodeID>& nodeIDs,
-        const std::list< Blob >& data, Peer::ptr const& peer)
+        const std::list< Slice >& data, Peer::ptr const& peer)
 {
     ScopedLockType sl (mLock);
 
@@ -195,7 +252,7 @@ SHAMapAddNode TransactionAcquire::takeNodes (const std::list<SHAMapNodeID>& node
             return SHAMapAddNode::invalid ();
 
         std::list<SHAMapNodeID>::const_iterator nodeIDit = nodeIDs.begin ();
-        std::list< Blob >::const_iterator nodeDatait = data.begin ();
+        std::list< Slice >::const_iterator nodeDatait = data.begin ();
         ConsensusTransSetSF sf (app_, app_.getTempNodeCache ());
 
         while (nodeIDit != nodeIDs.end ())
@@ -238,11 +295,21 @@ void TransactionAcquire::addPeers (int numPeers)
     app_.overlay().selectPeers (*this, numPeers, ScoreHasTxSet (getHash()));
 }
 
+void TransactionAcquire::addHolders ()
+{
+    for (auto const& peer : app_.overlay ().getActivePeers ())
+    {
+        if (peer->hasTxSet (mHash))
+            insert (peer);
+    }
+}
+
 void TransactionAcquire::init (int numPeers)
 {
     ScopedLockType sl (mLock);
 
     addPeers (numPeers);
+    addHolders ();
 
     setTimer ();
 }
@@ -48,7 +48,7 @@ public:
     }
 
     SHAMapAddNode takeNodes (const std::list<SHAMapNodeID>& IDs,
-                             const std::list< Blob >& data, Peer::ptr const&);
+                             const std::list< Slice >& data, Peer::ptr const&);
 
     void init (int startPeers);
 
@@ -73,6 +73,12 @@ private:
     // Tries to add the specified number of peers
     void addPeers (int num);
 
+    // Adds every peer which told us it has the set
+    void addHolders ();
+
+    // The peers in the set which have it, starting with the given one
+    std::vector<Peer::ptr> getHolders (Peer::ptr const& first);
+
     void trigger (Peer::ptr const&);
     std::weak_ptr<PeerSet> pmDowncast ();
 };
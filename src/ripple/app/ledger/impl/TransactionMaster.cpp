@@ -27,6 +27,11 @@
 
 namespace ripple {
 
+// How long a transaction not found on disk is reported missing without
+// looking again, and how many such transactions are remembered
+static std::chrono::seconds const missAge (2);
+static std::size_t const missLimit (65536);
+
 TransactionMaster::TransactionMaster (Application& app)
     : mApp (app)
     , mCache ("TransactionCache", 65536, 1800, stopwatch(),
@@ -36,6 +41,11 @@ TransactionMaster::TransactionMaster (Application& app)
 
 bool TransactionMaster::inLedger (uint256 const& hash, std::uint32_t ledger)
 {
+    {
+        std::lock_guard <std::mutex> lock (mMissLock);
+        mMisses.erase (hash);
+    }
+
     auto txn = mCache.fetch (hash);
 
     if (!txn)
@@ -50,13 +60,19 @@ TransactionMaster::fetch (uint256 const& txnID, bool checkDisk)
 {
     auto txn = mCache.fetch (txnID);
 
-    if (!checkDisk || txn)
+    if (!checkDisk || txn || missed (txnID))
         return txn;
 
     txn = Transaction::load (txnID, mApp);
 
     if (!txn)
+    {
+        std::lock_guard <std::mutex> lock (mMissLock);
+        if (mMisses.size () >= missLimit)
+            mMisses.clear ();
+        mMisses[txnID] = stopwatch ().now ();
         return txn;
+    }
 
     mCache.canonicalize (txnID, txn);
 
@@ -109,12 +125,36 @@ TransactionMaster::canonicalize(std::shared_ptr<Transaction>* pTransaction)
     }
 }
 
+bool TransactionMaster::missed (uint256 const& hash)
+{
+    std::lock_guard <std::mutex> lock (mMissLock);
+    auto const iter = mMisses.find (hash);
+    if (iter == mMisses.end ())
+        return false;
+
+    if (stopwatch ().now () - iter->second < missAge)
+        return true;
+
+    mMisses.erase (iter);
+    return false;
+}
+
 void TransactionMaster::sweep (void)
 {
     mCache.sweep ();
+
+    std::lock_guard <std::mutex> lock (mMissLock);
+    auto const expired = stopwatch ().now () - missAge;
+    for (auto iter = mMisses.begin (); iter != mMisses.end ();)
+    {
+        if (iter->second <= expired)
+            iter = mMisses.erase (iter);
+        else
+            ++iter;
+    }
 }
 
-TaggedCache <uint256, Transaction>& TransactionMaster::getCache()
+ShardedTaggedCache <uint256, Transaction>& TransactionMaster::getCache()
 {
     return mCache;
 }
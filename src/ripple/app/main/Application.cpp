@@ -25,23 +25,29 @@
 #include <ripple/app/main/Tuning.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerSnapshot.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/ledger/SQLHistoryLoader.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/main/LocalCredentials.h>
 #include <ripple/app/main/NodeStoreScheduler.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/DividendMaster.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/app/misc/TxQ.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <ripple/app/misc/TxVerifier.h>
 #include <ripple/app/misc/Validations.h>
 #include <ripple/app/paths/Pathfinder.h>
 #include <ripple/app/paths/PathRequests.h>
@@ -49,13 +55,16 @@
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/MemoryTag.h>
 #include <ripple/basics/ResolverAsio.h>
 #include <ripple/basics/Sustain.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/to_string.h>
+#include <ripple/core/CacheBudget.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/core/LoadFeeTrack.h>
+#include <ripple/core/ThreadPools.h>
 #include <ripple/core/TimeKeeper.h>
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/nodestore/Database.h>
@@ -67,7 +76,12 @@
 #include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/protocol/types.h>
+#include <ripple/rpc/LedgerDataCursors.h>
+#include <ripple/rpc/TxHistoryIndex.h>
+#include <ripple/rpc/RPCResponseCache.h>
+#include <ripple/rpc/RPCStats.h>
 #include <ripple/server/make_ServerHandler.h>
+#include <ripple/shamap/CacheSnapshot.h>
 #include <ripple/shamap/Family.h>
 #include <ripple/unity/git_id.h>
 #include <ripple/websocket/MakeServer.h>
@@ -78,6 +92,7 @@
 #include <boost/asio/signal_set.hpp>
 #include <boost/optional.hpp>
 #include <fstream>
+#include <thread>
 
 namespace ripple {
 
@@ -94,8 +109,11 @@ private:
     Application& app_;
     TreeNodeCache treecache_;
     FullBelowCache fullbelow_;
+    std::unique_ptr<SerializedNodeCache> serialcache_;
     NodeStore::Database& db_;
     beast::Journal j_;
+    unsigned walkThreads_;
+    int prefetchWindow_;
 
     // missing node handler
     std::uint32_t maxSeq = 0;
@@ -115,7 +133,22 @@ public:
                 fullBelowTargetSize, fullBelowExpirationSeconds)
         , db_ (db)
         , j_ (app.journal("SHAMap"))
-    {
+        , walkThreads_ (std::max (1u, get<unsigned> (
+            app.config().section (ConfigSection::nodeDatabase ()),
+                "flush_threads", std::min (4u,
+                    std::max (1u, std::thread::hardware_concurrency ())))))
+        , prefetchWindow_ (get<int> (
+            app.config().section (ConfigSection::nodeDatabase ()),
+                "prefetch_window", -1))
+    {
+        auto const& section =
+            app.config().section (ConfigSection::nodeDatabase ());
+        auto const size = get<int> (section, "serve_cache_size", 0);
+        if (size > 0)
+            serialcache_ = std::make_unique<SerializedNodeCache> (
+                "SerializedNodeCache", size,
+                    get<int> (section, "serve_cache_age", 120),
+                        stopwatch(), app.journal("TaggedCache"));
     }
 
     beast::Journal const&
@@ -148,6 +181,12 @@ public:
         return treecache_;
     }
 
+    SerializedNodeCache*
+    serialcache() override
+    {
+        return serialcache_.get ();
+    }
+
     NodeStore::Database&
     db() override
     {
@@ -160,6 +199,21 @@ public:
         return db_;
     }
 
+    unsigned
+    walkThreads() const override
+    {
+        return walkThreads_;
+    }
+
+    int
+    prefetchWindow() const override
+    {
+        // By default as many as the node store likes to have pending
+        if (prefetchWindow_ < 0)
+            return db_.getDesiredAsyncReadCount ();
+        return prefetchWindow_;
+    }
+
     void
     missing_node (std::uint32_t seq) override
     {
@@ -332,7 +386,19 @@ public:
     std::unique_ptr <HashRouter> mHashRouter;
     std::unique_ptr <Validations> mValidations;
     std::unique_ptr <LoadManager> m_loadManager;
+    std::unique_ptr <AccountTxMigrator> m_accountTxMigrator;
+    std::unique_ptr <LedgerSnapshots> m_ledgerSnapshots;
+    std::unique_ptr <LedgerDataCursors> m_ledgerDataCursors;
+    std::unique_ptr <TxHistoryIndex> m_txHistoryIndex;
+    std::unique_ptr <LedgerCloseTimings> m_ledgerCloseTimings;
+    std::unique_ptr <RPCStats> m_rpcStats;
+    std::unique_ptr <MemoryGauges> m_memoryGauges;
+    std::unique_ptr <RPCResponseCache> m_rpcResponseCache;
+    std::unique_ptr <CacheBudget> m_cacheBudget;
+    std::unique_ptr <TxVerifier> m_txVerifier;
+    std::unique_ptr <TxTrace> m_txTrace;
     std::unique_ptr <TxQ> txQ_;
+    ThreadPools threadPools_;
     beast::DeadlineTimer m_sweepTimer;
     beast::DeadlineTimer m_entropyTimer;
 
@@ -358,17 +424,28 @@ public:
     #if RIPPLE_SINGLE_IO_SERVICE_THREAD
         return 1;
     #else
+        if (config.THREADS.io.threads != 0)
+            return config.THREADS.io.threads;
         return (config.NODE_SIZE >= 2) ? 2 : 1;
     #endif
     }
 
+    static
+    int
+    nodeStoreThreads (Config const& config)
+    {
+        if (config.THREADS.nodestore.threads != 0)
+            return config.THREADS.nodestore.threads;
+        return 4;
+    }
+
     //--------------------------------------------------------------------------
 
     ApplicationImp (
             std::unique_ptr<Config const> config,
             std::unique_ptr<Logs> logs)
         : RootStoppable ("Application")
-        , BasicApp (numberOfThreads(*config))
+        , BasicApp (numberOfThreads(*config), config->THREADS.io.cpus)
         , config_ (std::move(config))
         , logs_ (std::move(logs))
 
@@ -386,7 +463,8 @@ public:
             logs_->journal ("SHAMapStore"), logs_->journal ("NodeObject"),
             m_txMaster, *config_))
 
-        , m_nodeStore (m_shaMapStore->makeDatabase ("NodeStore.main", 4))
+        , m_nodeStore (m_shaMapStore->makeDatabase ("NodeStore.main",
+            nodeStoreThreads (*config_)))
 
         , accountIDCache_(128000)
 
@@ -469,6 +547,42 @@ public:
 
         , m_loadManager (make_LoadManager (*this, *this, logs_->journal("LoadManager")))
 
+        , m_accountTxMigrator (make_AccountTxMigrator (*this, *this,
+            logs_->journal("AccountTxMigrator")))
+
+        , m_ledgerSnapshots (std::make_unique <LedgerSnapshots> (
+            config_->section (SECTION_LEDGER_SNAPSHOTS),
+                logs_->journal("LedgerSnapshots")))
+
+        , m_ledgerDataCursors (std::make_unique <LedgerDataCursors> (
+            stopwatch ()))
+
+        , m_txHistoryIndex (std::make_unique <TxHistoryIndex> ())
+
+        , m_ledgerCloseTimings (std::make_unique <LedgerCloseTimings> (
+            ledgerCloseTimingsSize, m_collectorManager->group ("ledger_close")))
+
+        , m_rpcStats (std::make_unique <RPCStats> (
+            m_collectorManager->group ("rpc")))
+
+        , m_memoryGauges (std::make_unique <MemoryGauges> (
+            m_collectorManager->group ("memory")))
+
+        , m_rpcResponseCache (std::make_unique <RPCResponseCache> (
+            config_->section (SECTION_RPC_CACHE),
+                logs_->journal("RPCResponseCache")))
+
+        , m_cacheBudget (std::make_unique <CacheBudget> (
+            config_->section (SECTION_CACHE_BUDGET),
+                logs_->journal("CacheBudget")))
+
+        , m_txVerifier (std::make_unique <TxVerifier> (*this,
+            std::chrono::milliseconds (config_->SIGNATURE_BATCH),
+                logs_->journal("TxVerifier")))
+
+        , m_txTrace (std::make_unique <TxTrace> (
+            config_->section (SECTION_TX_TRACE)))
+
         , txQ_(make_TxQ(setup_TxQ(*config_), logs_->journal("TxQ")))
 
         , m_sweepTimer (this)
@@ -501,6 +615,9 @@ public:
 
         // VFALCO HACK
         m_nodeStoreScheduler.setJobQueue (*m_jobQueue);
+        m_nodeStoreScheduler.setCollector (
+            m_collectorManager->group ("nodestore"));
+        m_nodeStoreScheduler.setLedgerCloseTimings (*m_ledgerCloseTimings);
 
         add (m_ledgerMaster->getPropertySource ());
         add (*serverHandler_);
@@ -682,6 +799,61 @@ public:
         return *m_shaMapStore;
     }
 
+    AccountTxMigrator& getAccountTxMigrator () override
+    {
+        return *m_accountTxMigrator;
+    }
+
+    LedgerSnapshots& getLedgerSnapshots () override
+    {
+        return *m_ledgerSnapshots;
+    }
+
+    LedgerDataCursors& getLedgerDataCursors () override
+    {
+        return *m_ledgerDataCursors;
+    }
+
+    TxHistoryIndex& getTxHistoryIndex () override
+    {
+        return *m_txHistoryIndex;
+    }
+
+    LedgerCloseTimings& getLedgerCloseTimings () override
+    {
+        return *m_ledgerCloseTimings;
+    }
+
+    RPCStats& getRPCStats () override
+    {
+        return *m_rpcStats;
+    }
+
+    RPCResponseCache& getRPCResponseCache () override
+    {
+        return *m_rpcResponseCache;
+    }
+
+    CacheBudget& getCacheBudget () override
+    {
+        return *m_cacheBudget;
+    }
+
+    ThreadPools const& getThreadPools () const override
+    {
+        return threadPools_;
+    }
+
+    TxVerifier& getTxVerifier () override
+    {
+        return *m_txVerifier;
+    }
+
+    TxTrace& getTxTrace () override
+    {
+        return *m_txTrace;
+    }
+
     PendingSaves& pendingSaves() override
     {
         return pendingSaves_;
@@ -753,8 +925,30 @@ public:
                                      get<std::string> (params, "username") %
                                      get<std::string> (params, "password"))
                                         .str ();
-            mTxnDB = std::make_unique <DatabaseCon> (setup, DatabaseCon::Type::MySQL, connectionString,
-                TxnDBInitMySQL, TxnDBCountMySQL);
+            auto const readers = get<std::size_t> (params, "read_connections", 0);
+            auto const writers = get<std::size_t> (params, "write_connections", 0);
+            auto const replicaHost = get<std::string> (params, "replica_host");
+            if (readers == 0 && writers == 0 && replicaHost.empty ())
+            {
+                mTxnDB = std::make_unique <DatabaseCon> (setup, DatabaseCon::Type::MySQL, connectionString,
+                    TxnDBInitMySQL, TxnDBCountMySQL);
+            }
+            else
+            {
+                DatabaseCon::PoolSetup pool;
+                pool.readers = std::max<std::size_t> (readers, 1);
+                pool.writers = std::max<std::size_t> (writers, 1);
+                if (! replicaHost.empty ())
+                    pool.replica = (boost::format ("host=%s port=%s db=%s user=%s password='%s'") %
+                                    replicaHost %
+                                    get<std::string> (params, "replica_port", get<std::string> (params, "port")) %
+                                    get<std::string> (params, "database") %
+                                    get<std::string> (params, "username") %
+                                    get<std::string> (params, "password"))
+                                        .str ();
+                mTxnDB = std::make_unique <DatabaseCon> (setup, connectionString, pool,
+                    TxnDBInitMySQL, TxnDBCountMySQL);
+            }
         }
         else if (type == "none")
         {
@@ -842,6 +1036,8 @@ public:
 
         m_overlay->saveValidatorKeyManifests (getWalletDB ());
 
+        saveCacheSnapshot ();
+
         stopped ();
     }
 
@@ -897,6 +1093,7 @@ public:
         // VFALCO TODO fix the dependency inversion using an observer,
         //         have listeners register for "onSweep ()" notification.
 
+        m_cacheBudget->rebalance ();
         family().fullbelow().sweep ();
         getMasterTransaction().sweep();
         getNodeStore().sweep();
@@ -906,6 +1103,8 @@ public:
         getInboundLedgers().sweep();
         m_acceptedLedgerCache.sweep();
         family().treecache().sweep();
+        if (auto cache = family().serialcache())
+            cache->sweep();
         cachedSLEs_.expire();
 
         // VFALCO NOTE does the call to sweep() happen on another thread?
@@ -914,24 +1113,137 @@ public:
 
 
 private:
+    void addBudgetedCaches ();
+    void loadCacheSnapshot ();
+    void saveCacheSnapshot ();
     void addTxnSeqField();
+    void addTransTypeField();
     void updateTables ();
     void startGenesisLedger ();
     Ledger::pointer getLastFullLedger();
     bool loadOldLedger (
         std::string const& ledgerID, bool replay, bool isFilename);
+    void verifyLoadedLedger (std::shared_ptr<Ledger const> const& ledger);
 };
 
 //------------------------------------------------------------------------------
 
+// The bytes per item are rough estimates of what an entry keeps alive:
+// a tree node with its item or child hashes, a node object with its data,
+// a state entry, and the part of a ledger its history does not share with
+// the ledgers around it. No cache is made smaller than a quarter of its size
+// from [node_size].
+//
+void ApplicationImp::addBudgetedCaches ()
+{
+    auto& treecache = family().treecache();
+    m_cacheBudget->add ({"treenode_cache", 640,
+        config_->getSize (siTreeCacheSize) / 4,
+        [&treecache] () { return treecache.getHitsAndMisses (); },
+        [&treecache] () { return treecache.getCacheSize (); },
+        [&treecache] (int size) { treecache.setTargetSize (size); }},
+        config_->getSize (siTreeCacheSize));
+
+    auto& fullbelow = family().fullbelow();
+    m_cacheBudget->add ({"fullbelow_cache", 64,
+        config_->getSize (siTreeCacheSize) / 4,
+        [&fullbelow] () { return fullbelow.getHitsAndMisses (); },
+        [&fullbelow] () { return static_cast<int> (fullbelow.size ()); },
+        [&fullbelow] (int size) { fullbelow.setTargetSize (size); }},
+        config_->getSize (siTreeCacheSize));
+
+    auto& nodeStore = *m_nodeStore;
+    m_cacheBudget->add ({"node_cache", 512,
+        config_->getSize (siNodeCacheSize) / 4,
+        [&nodeStore] () { return nodeStore.getCacheHitsAndMisses (); },
+        [&nodeStore] () { return nodeStore.getCacheSize (); },
+        [&nodeStore] (int size) { nodeStore.setCacheSize (size); }},
+        config_->getSize (siNodeCacheSize));
+
+    auto& sles = cachedSLEs_;
+    m_cacheBudget->add ({"sle_cache", 384, 1024,
+        [&sles] () { return sles.hitsAndMisses (); },
+        [&sles] () { return static_cast<int> (sles.size ()); },
+        [&sles] (int size) { sles.setTargetSize (size); }},
+        config_->getSize (siTreeCacheSize) / 4);
+
+    auto& ledgerMaster = *m_ledgerMaster;
+    m_cacheBudget->add ({"ledger_cache", 16384,
+        config_->getSize (siLedgerSize) / 4,
+        [&ledgerMaster] () { return ledgerMaster.getCacheHitsAndMisses (); },
+        [&ledgerMaster] () { return ledgerMaster.getCacheSize (); },
+        [&ledgerMaster] (int size) { ledgerMaster.setCacheSize (size); }},
+        config_->getSize (siLedgerSize));
+}
+
+// The snapshot only holds keys, so a snapshot of another node store or an
+// older one just finds fewer nodes.
+//
+void ApplicationImp::loadCacheSnapshot ()
+{
+    auto const& section = config_->section (SECTION_CACHE_SNAPSHOT);
+    auto const path = get<std::string> (section, "path");
+    if (path.empty () || ! boost::filesystem::exists (path))
+        return;
+
+    try
+    {
+        auto const start = std::chrono::steady_clock::now ();
+        CacheSnapshot const snapshot (path);
+        auto const found = snapshot.load (family (),
+            std::max (1u, get<unsigned> (section, "threads", 8)));
+        m_journal.info << "Loaded " << found << " of " <<
+            (snapshot.treeNodes () + snapshot.nodes ()) <<
+                " cached nodes in " << std::chrono::duration_cast<
+                    std::chrono::milliseconds> (
+                        std::chrono::steady_clock::now () - start).count () <<
+                            "ms";
+    }
+    catch (std::exception const& e)
+    {
+        m_journal.warning << "Cache snapshot " << path << ": " << e.what ();
+    }
+}
+
+void ApplicationImp::saveCacheSnapshot ()
+{
+    auto const path = get<std::string> (
+        config_->section (SECTION_CACHE_SNAPSHOT), "path");
+    if (path.empty ())
+        return;
+
+    try
+    {
+        CacheSnapshot::write (path, family ());
+    }
+    catch (std::exception const& e)
+    {
+        m_journal.warning << "Cache snapshot " << path << ": " << e.what ();
+    }
+}
+
+//------------------------------------------------------------------------------
+
 // VFALCO TODO Break this function up into many small initialization segments.
 //             Or better yet refactor these initializations into RAII classes
 //             which are members of the Application object.
 //
 void ApplicationImp::setup()
 {
+    m_jobQueue->setOutlierThresholds (
+        config_->section (SECTION_JOB_LATENCY));
+
+    m_jobQueue->setThreadAffinity (config_->THREADS.jobs.cpus);
+    m_nodeStore->setThreadAffinity (config_->THREADS.nodestore.cpus);
+
     // VFALCO NOTE: 0 means use heuristics to determine the thread count.
-    m_jobQueue->setThreadCount (0, config_->RUN_STANDALONE);
+    m_jobQueue->setThreadCount (config_->THREADS.jobs.threads,
+        config_->RUN_STANDALONE);
+
+    threadPools_ = config_->THREADS;
+    threadPools_.jobs.threads = m_jobQueue->getThreadCount ();
+    threadPools_.io.threads = numberOfThreads (*config_);
+    threadPools_.nodestore.threads = nodeStoreThreads (*config_);
 
     // We want to intercept and wait for CTRL-C to terminate the process
     m_signals.add (SIGINT);
@@ -955,6 +1267,9 @@ void ApplicationImp::setup()
             logs_->severity (beast::Journal::kDebug);
     }
 
+    if (config_->LOG_QUEUE > 0)
+        logs_->queue (config_->LOG_QUEUE * 1024);
+
     if (!config_->RUN_STANDALONE)
         timeKeeper_->run(config_->SNTP_SERVERS);
 
@@ -973,13 +1288,22 @@ void ApplicationImp::setup()
             << boost::str (boost::format ("PRAGMA cache_size=-%d;") %
                             (config_->getSize (siTxnDBCache) * 1024));
 
-    mTxnDB->setupCheckpointing (m_jobQueue.get(), logs());
+    mTxnDB->setupCheckpointing (
+        m_collectorManager->group ("transaction_db"), logs());
     }
-    mLedgerDB->setupCheckpointing (m_jobQueue.get(), logs());
+    mLedgerDB->setupCheckpointing (
+        m_collectorManager->group ("ledger_db"), logs());
 
     if (!config_->RUN_STANDALONE)
         updateTables ();
 
+    m_accountTxMigrator->setup ();
+
+    if (config_->LOAD_SQL_HISTORY)
+        exitWithCode (loadSQLHistory (*this,
+            config_->LOAD_SQL_HISTORY->first,
+            config_->LOAD_SQL_HISTORY->second));
+
     m_amendmentTable->addInitial (
         config_->section (SECTION_AMENDMENTS));
     Pathfinder::initPathTable();
@@ -1043,6 +1367,12 @@ void ApplicationImp::setup()
     family().treecache().setTargetSize (config_->getSize (siTreeCacheSize));
     family().treecache().setTargetAge (config_->getSize (siTreeCacheAge));
 
+    if (m_cacheBudget->enabled ())
+        addBudgetedCaches ();
+
+    // Before clients are served, so their first requests find the nodes
+    loadCacheSnapshot ();
+
     //----------------------------------------------------------------------
     //
     // Server
@@ -1220,6 +1550,36 @@ ApplicationImp::getLastFullLedger()
     }
 }
 
+// Read every node of a ledger loaded at startup while the server runs, and
+// only count it among the complete ledgers once none is missing.
+void
+ApplicationImp::verifyLoadedLedger (std::shared_ptr<Ledger const> const& ledger)
+{
+    auto const seq = ledger->info().seq;
+    m_journal.info << "Checking the nodes of ledger " << seq <<
+        " in the background";
+
+    m_jobQueue->addJob (jtADVANCE, "verifyLedger", [this, ledger, seq](Job&)
+    {
+        auto const start = std::chrono::steady_clock::now ();
+        auto const window = std::max (family().prefetchWindow (), 1);
+        auto const stopping = [this] { return m_jobQueue->isStopping (); };
+
+        if (ledger->walkLedger (journal ("Ledger"), window, stopping))
+        {
+            m_ledgerMaster->setLedgerRangePresent (seq, seq);
+            m_journal.info << "Ledger " << seq << " has all its nodes, "
+                "checked in " << std::chrono::duration_cast<
+                    std::chrono::seconds> (std::chrono::steady_clock::now () -
+                        start).count () << "s";
+        }
+        else if (!stopping ())
+        {
+            m_journal.fatal << "Ledger " << seq << " is missing nodes.";
+        }
+    });
+}
+
 bool ApplicationImp::loadOldLedger (
     std::string const& ledgerID, bool replay, bool isFileName)
 {
@@ -1411,7 +1771,9 @@ bool ApplicationImp::loadOldLedger (
             return false;
         }
 
-        if (!loadLedger->walkLedger (journal ("Ledger")))
+        // In the background the roots are checked by assertSane
+        if (!config_->BACKGROUND_VERIFY &&
+            !loadLedger->walkLedger (journal ("Ledger")))
         {
             m_journal.fatal << "Ledger is missing nodes.";
             assert(false);
@@ -1425,7 +1787,10 @@ bool ApplicationImp::loadOldLedger (
             return false;
         }
 
-        m_ledgerMaster->setLedgerRangePresent (loadLedger->info().seq, loadLedger->info().seq);
+        if (config_->BACKGROUND_VERIFY)
+            verifyLoadedLedger (loadLedger);
+        else
+            m_ledgerMaster->setLedgerRangePresent (loadLedger->info().seq, loadLedger->info().seq);
 
         auto const openLedger =
             std::make_shared<Ledger>(open_ledger, *loadLedger, timeKeeper().closeTime());
@@ -1657,6 +2022,87 @@ void ApplicationImp::addTxnSeqField ()
     tr.commit ();
 }
 
+// Returns true if the table exists but has no such column
+static bool columnMissing (
+    DatabaseCon& dbc, std::string const& table, std::string const& column)
+{
+    if (dbc.getType () != DatabaseCon::Type::MySQL)
+    {
+        std::vector<std::string> schema = getSchema (dbc, table);
+        return ! schema.empty () &&
+            schema[0].find (column) == std::string::npos;
+    }
+
+    int tables = 0, columns = 0;
+    auto db = dbc.checkoutDb ();
+    *db << "SELECT COUNT(*) FROM information_schema.tables "
+           "WHERE table_schema = DATABASE() AND table_name = :table;",
+        soci::use (table), soci::into (tables);
+    *db << "SELECT COUNT(*) FROM information_schema.columns "
+           "WHERE table_schema = DATABASE() AND table_name = :table AND "
+           "column_name = :column;",
+        soci::use (table), soci::use (column), soci::into (columns);
+    return tables != 0 && columns == 0;
+}
+
+void ApplicationImp::addTransTypeField ()
+{
+    if (getTxnDB ().getType () == DatabaseCon::Type::None)
+        return;
+
+    bool const isMySQL = getTxnDB ().getType () == DatabaseCon::Type::MySQL;
+
+    // The account tables copy the type of each transaction, so that
+    // account_tx can filter by type without reading Transactions
+    struct AccountTable
+    {
+        char const* name;
+        char const* index;
+        char const* join;
+    };
+    std::vector<AccountTable> tables {{"AccountTransactions",
+        "AcctTxTypeIndex", "Transactions.TransID = AccountTransactions.TransID"}};
+    if (isMySQL)
+        tables.push_back ({"AccountTxs", "AcctTxsTypeIndex",
+            "Transactions.TransID = HEX(AccountTxs.TransID)"});
+
+    for (auto const& table : tables)
+    {
+        if (! columnMissing (getTxnDB (), table.name, "TransType"))
+            continue;
+
+        JLOG (m_journal.warning) << "Transaction type field is missing from "
+            << table.name;
+
+        auto db = getTxnDB ().checkoutDb ();
+        soci::transaction tr (*db);
+
+        JLOG (m_journal.info) << "Altering table";
+        *db << boost::str (boost::format (
+            "ALTER TABLE %s ADD COLUMN TransType CHARACTER(24);") %
+                table.name);
+
+        JLOG (m_journal.info) << "Copying transaction types";
+        if (isMySQL)
+            *db << boost::str (boost::format (
+                "UPDATE %s INNER JOIN Transactions ON %s "
+                "SET %s.TransType = Transactions.TransType;") %
+                    table.name % table.join % table.name);
+        else
+            *db << boost::str (boost::format (
+                "UPDATE %s SET TransType = (SELECT TransType "
+                "FROM Transactions WHERE %s);") %
+                    table.name % table.join);
+
+        JLOG (m_journal.info) << "Building new index";
+        *db << boost::str (boost::format (
+            "CREATE INDEX %s ON %s(Account, TransType, LedgerSeq, TxnSeq);") %
+                table.index % table.name);
+
+        tr.commit ();
+    }
+}
+
 void ApplicationImp::updateTables ()
 {
     if (config_->section (ConfigSection::nodeDatabase ()).empty ())
@@ -1671,6 +2117,7 @@ void ApplicationImp::updateTables ()
     assert (!schemaHas (getTxnDB (), "AccountTransactions", 0, "foobar", m_journal));
     */
     addTxnSeqField ();
+    addTransTypeField ();
 
     /*
     if (schemaHas (getTxnDB (), "AccountTransactions", 0, "PRIMARY", m_journal))
@@ -39,6 +39,7 @@ namespace NodeStore { class Database; }
 // VFALCO TODO Fix forward declares required for header dependency loops
 class AmendmentTable;
 class DividendMaster;
+class CacheBudget;
 class CachedSLEs;
 class CollectorManager;
 class Family;
@@ -64,10 +65,20 @@ class STLedgerEntry;
 class TimeKeeper;
 class TransactionMaster;
 class TxQ;
+class TxVerifier;
+class TxTrace;
+struct ThreadPools;
 class Validations;
 class Cluster;
 
+class AccountTxMigrator;
 class DatabaseCon;
+class LedgerCloseTimings;
+class LedgerSnapshots;
+class LedgerDataCursors;
+class TxHistoryIndex;
+class RPCResponseCache;
+class RPCStats;
 class SHAMapStore;
 
 using NodeCache     = TaggedCache <uint256, Blob>;
@@ -135,6 +146,16 @@ public:
     virtual Resource::Manager&      getResourceManager () = 0;
     virtual PathRequests&           getPathRequests () = 0;
     virtual SHAMapStore&            getSHAMapStore () = 0;
+    virtual AccountTxMigrator&      getAccountTxMigrator () = 0;
+    virtual LedgerSnapshots&        getLedgerSnapshots () = 0;
+    virtual LedgerDataCursors&      getLedgerDataCursors () = 0;
+    virtual TxHistoryIndex&         getTxHistoryIndex () = 0;
+    virtual LedgerCloseTimings&     getLedgerCloseTimings () = 0;
+    virtual RPCStats&               getRPCStats () = 0;
+    virtual RPCResponseCache&       getRPCResponseCache () = 0;
+    virtual CacheBudget&            getCacheBudget () = 0;
+    virtual TxVerifier&             getTxVerifier () = 0;
+    virtual TxTrace&                getTxTrace () = 0;
     virtual PendingSaves&           pendingSaves() = 0;
     virtual AccountIDCache const&   accountIDCache() const = 0;
     virtual OpenLedger&             openLedger() = 0;
@@ -143,6 +164,9 @@ public:
 
     virtual std::chrono::milliseconds getIOLatency () = 0;
 
+    /** The size and processors of the thread pools in use. */
+    virtual ThreadPools const& getThreadPools () const = 0;
+
     virtual bool serverOkay (std::string& reason) = 0;
 
     virtual beast::Journal journal (std::string const& name) = 0;
@@ -21,16 +21,17 @@
 #include <ripple/app/main/BasicApp.h>
 #include <beast/threads/Thread.h>
 
-BasicApp::BasicApp(std::size_t numberOfThreads)
+BasicApp::BasicApp(std::size_t numberOfThreads, ripple::CpuSet const& cpus)
 {
     work_.emplace (io_service_);
     threads_.reserve(numberOfThreads);
     while(numberOfThreads--)
         threads_.emplace_back(
-            [this, numberOfThreads](){
+            [this, numberOfThreads, cpus](){
                 beast::Thread::setCurrentThreadName(
                     std::string("io_service #") +
                         std::to_string(numberOfThreads));
+                ripple::setCurrentThreadAffinity(cpus);
                 this->io_service_.run();
             });
 }
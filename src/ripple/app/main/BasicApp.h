@@ -20,6 +20,7 @@
 #ifndef RIPPLE_APP_BASICAPP_H_INCLUDED
 #define RIPPLE_APP_BASICAPP_H_INCLUDED
 
+#include <ripple/basics/ThreadAffinity.h>
 #include <boost/asio/io_service.hpp>
 #include <boost/optional.hpp>
 #include <thread>
@@ -34,7 +35,7 @@ private:
     boost::asio::io_service io_service_;
 
 protected:
-    BasicApp(std::size_t numberOfThreads);
+    BasicApp(std::size_t numberOfThreads, ripple::CpuSet const& cpus = {});
     ~BasicApp();
 
 public:
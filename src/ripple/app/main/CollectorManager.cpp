@@ -29,6 +29,7 @@ class CollectorManagerImp
 public:
     beast::Journal m_journal;
     beast::insight::Collector::ptr m_collector;
+    std::shared_ptr <beast::insight::ScrapeCollector> m_scrape;
     std::unique_ptr <beast::insight::Groups> m_groups;
 
     CollectorManagerImp (Section const& params,
@@ -50,6 +51,13 @@ public:
             m_collector = beast::insight::NullCollector::New ();
         }
 
+        if (get<bool> (params, "scrape"))
+        {
+            m_scrape = beast::insight::ScrapeCollector::New (m_collector,
+                get<std::string> (params, "prefix"));
+            m_collector = m_scrape;
+        }
+
         m_groups = beast::insight::make_Groups (m_collector);
     }
 
@@ -62,6 +70,12 @@ public:
         return m_collector;
     }
 
+    std::shared_ptr <beast::insight::ScrapeCollector> const&
+        scrape () override
+    {
+        return m_scrape;
+    }
+
     beast::insight::Group::ptr const& group (std::string const& name) override
     {
         return m_groups->get (name);
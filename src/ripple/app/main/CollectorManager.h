@@ -34,6 +34,13 @@ public:
 
     virtual ~CollectorManager () = 0;
     virtual beast::insight::Collector::ptr const& collector () = 0;
+
+    /** Returns the collector holding the metrics to be pulled over HTTP.
+        This is null unless scrape is set in the [insight] section.
+    */
+    virtual std::shared_ptr <beast::insight::ScrapeCollector> const&
+        scrape () = 0;
+
     virtual beast::insight::Group::ptr const& group (
         std::string const& name) = 0;
 };
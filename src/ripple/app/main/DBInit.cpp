@@ -49,12 +49,16 @@ const char* TxnDBInit[] =
     );",
     "CREATE INDEX IF NOT EXISTS TxLgrIndex ON                 \
         Transactions(LedgerSeq);",
+    // Pages of tx_history, read from a ledger and ID
+    "CREATE INDEX IF NOT EXISTS TxLgrIDIndex ON               \
+        Transactions(LedgerSeq, TransID);",
 
     "CREATE TABLE IF NOT EXISTS AccountTransactions (         \
         TransID     CHARACTER(64),              \
         Account     CHARACTER(64),              \
         LedgerSeq   BIGINT UNSIGNED,            \
-        TxnSeq      INTEGER                     \
+        TxnSeq      INTEGER,                    \
+        TransType   CHARACTER(24)               \
     );",
     "CREATE INDEX IF NOT EXISTS AcctTxIDIndex ON              \
         AccountTransactions(TransID);",
@@ -62,6 +66,13 @@ const char* TxnDBInit[] =
         AccountTransactions(Account, LedgerSeq, TxnSeq, TransID);",
     "CREATE INDEX IF NOT EXISTS AcctLgrIndex ON               \
         AccountTransactions(LedgerSeq, Account, TransID);",
+    "CREATE INDEX IF NOT EXISTS AcctTxTypeIndex ON            \
+        AccountTransactions(Account, TransType, LedgerSeq, TxnSeq);",
+
+    "CREATE TABLE IF NOT EXISTS TxnDBState (                  \
+        Name        CHARACTER(32) PRIMARY KEY,  \
+        Value       BIGINT UNSIGNED             \
+    );",
 
     "END TRANSACTION;"
     
@@ -85,21 +96,32 @@ const char* TxnDBInitMySQL[] =
         RawTxn      LONGBLOB,                       \
         TxnMeta     LONGBLOB                       \
     );",
+    // InnoDB keeps the primary key in the index, which covers the pages
+    // of tx_history
     "CREATE INDEX TxLgrIndex ON                     \
         Transactions(LedgerSeq);",
     
-    "CREATE TABLE IF NOT EXISTS AccountTransactions (    \
-        TransID     CHARACTER(64),                      \
-        Account     CHARACTER(64),                      \
-        LedgerSeq   BIGINT UNSIGNED,                    \
-        TxnSeq      INTEGER                             \
+    // Older databases also have AccountTransactions, which has the
+    // accounts in base58 and is migrated by AccountTxMigrator
+    "CREATE TABLE IF NOT EXISTS AccountTxs (             \
+        Account     BINARY(20) NOT NULL,                \
+        LedgerSeq   INT UNSIGNED NOT NULL,              \
+        TxnSeq      INT UNSIGNED NOT NULL,              \
+        TransID     BINARY(32) NOT NULL,                \
+        TransType   CHARACTER(24),                      \
+        PRIMARY KEY (Account, LedgerSeq, TxnSeq)        \
+    ) ENGINE=InnoDB;",
+    "CREATE INDEX AcctTxsIDIndex ON             \
+        AccountTxs(TransID);",
+    "CREATE INDEX AcctTxsLgrIndex ON            \
+        AccountTxs(LedgerSeq);",
+    "CREATE INDEX AcctTxsTypeIndex ON           \
+        AccountTxs(Account, TransType, LedgerSeq, TxnSeq);",
+
+    "CREATE TABLE IF NOT EXISTS TxnDBState (             \
+        Name        VARCHAR(32) PRIMARY KEY,            \
+        Value       BIGINT UNSIGNED                     \
     );",
-    "CREATE INDEX AcctTxIDIndex ON              \
-        AccountTransactions(TransID);",
-    "CREATE INDEX AcctTxIndex ON                \
-        AccountTransactions(Account, LedgerSeq, TxnSeq, TransID);",
-    "CREATE INDEX AcctLgrIndex ON               \
-        AccountTransactions(LedgerSeq, Account, TransID);",
     
     "COMMIT;"
 };
@@ -170,6 +192,18 @@ const char* WalletDBInit[] =
         FetchUpdated    DATETIME                    \
     );",
 
+    // Where the ledger cleaner left off, so it can resume after a restart.
+    // Integer: 1 : Used to simplify SQL.
+    // MinLedger, MaxLedger: the ledgers still to be cleaned, 0 when idle.
+    // CheckNodes, FixTxns: the options it was started with.
+    "CREATE TABLE IF NOT EXISTS CleanerState (      \
+        Magic           INTEGER UNIQUE NOT NULL,    \
+        MinLedger       INTEGER,                    \
+        MaxLedger       INTEGER,                    \
+        CheckNodes      INTEGER,                    \
+        FixTxns         INTEGER                     \
+    );",
+
     // Scoring and other information for domains.
     //
     // Domain:
@@ -300,6 +334,67 @@ const char* WalletDBInit[] =
 
 int WalletDBCount = std::extent<decltype(WalletDBInit)>::value;
 
+// Dividend database holds the inputs of the dividend calculation,
+// maintained incrementally from validated ledgers, and the results of
+// past dividends.
+const char* DividendDBInit[] =
+{
+    "PRAGMA synchronous=NORMAL;",
+    "PRAGMA journal_mode=WAL;",
+    "PRAGMA journal_size_limit=1582080;",
+
+    "BEGIN TRANSACTION;",
+
+    // Account:
+    //  Hex AccountID.
+    // Referee:
+    //  Hex AccountID of sfReferee, NULL if none.
+    // BalanceVBC:
+    //  Mantissa of sfBalanceVBC.
+    // LedgerSeq:
+    //  Ledger in which the AccountRoot last changed.
+    "CREATE TABLE IF NOT EXISTS DividendAccounts (  \
+        Account         CHARACTER(40) PRIMARY KEY,  \
+        Referee         CHARACTER(40),              \
+        BalanceVBC      BIGINT UNSIGNED,            \
+        LedgerSeq       BIGINT UNSIGNED             \
+    );",
+    "CREATE INDEX IF NOT EXISTS DividendAccountsByReferee ON \
+        DividendAccounts(Referee);",
+
+    // Magic:
+    //  Always 1, used to simplify SQL.
+    // LedgerSeq:
+    //  Last ledger applied to DividendAccounts.
+    "CREATE TABLE IF NOT EXISTS DividendIndexState (\
+        Magic           INTEGER UNIQUE NOT NULL,    \
+        LedgerSeq       BIGINT UNSIGNED             \
+    );",
+
+    // Account:
+    //  Hex AccountID of the destination.
+    // DividendLedger:
+    //  sfDividendLedger of the dividend.
+    // Coins, CoinsVBC, CoinsVBCRank, CoinsVBCSprd, VRank, VSprd, TSprd:
+    //  Fields of the DivType_Apply transaction.
+    "CREATE TABLE IF NOT EXISTS DividendResults (   \
+        Account         CHARACTER(40) NOT NULL,     \
+        DividendLedger  BIGINT UNSIGNED NOT NULL,   \
+        Coins           BIGINT UNSIGNED,            \
+        CoinsVBC        BIGINT UNSIGNED,            \
+        CoinsVBCRank    BIGINT UNSIGNED,            \
+        CoinsVBCSprd    BIGINT UNSIGNED,            \
+        VRank           BIGINT UNSIGNED,            \
+        VSprd           BIGINT UNSIGNED,            \
+        TSprd           BIGINT UNSIGNED,            \
+        PRIMARY KEY (Account, DividendLedger)       \
+    );",
+
+    "END TRANSACTION;"
+};
+
+int DividendDBCount = std::extent<decltype(DividendDBInit)>::value;
+
 // Hash node database holds nodes indexed by hash
 // VFALCO TODO Remove this since it looks unused
 /*
@@ -41,6 +41,7 @@
 #include <beast/utility/Debug.h>
 #include <beast/streams/debug_ostream.h>
 #include <beast/module/core/system/SystemStats.h>
+#include <beast/module/core/text/LexicalCast.h>
 #include <google/protobuf/stubs/common.h>
 #include <boost/program_options.hpp>
 #include <cstdlib>
@@ -145,13 +146,17 @@ void printHelp (const po::options_description& desc)
            "     ledger_closed\n"
            "     ledger_current\n"
            "     ledger_request <ledger>\n"
+           "     ledger_snapshot <ledger>\n"
+           "     ledger_timings [<limit>]\n"
            "     log_level [[<partition>] <severity>]\n"
            "     logrotate \n"
            "     peers\n"
            "     ping\n"
+           "     profile [start [<frequency>]|stop|status]\n"
            "     random\n"
            "     ripple ...\n"
            "     ripple_path_find <json> [<ledger>]\n"
+           "     rpc_stats\n"
            "     version\n"
            "     server_info\n"
            "     sign <private_key> <tx_json> [offline]\n"
@@ -305,6 +310,7 @@ int run (int argc, char** argv)
     ("net", "Get the initial ledger from the network.")
     ("fg", "Run in the foreground.")
     ("import", importText.c_str ())
+    ("load-sql-history", po::value<std::string> (), "Write the transactions of a range of ledgers, such as 1-1000, to the transaction database, then exit.")
     ("version", "Display the build version.")
     ;
 
@@ -349,7 +355,8 @@ int run (int argc, char** argv)
         && !vm.count ("fg")
         && !vm.count ("standalone")
         && !vm.count ("shutdowntest")
-        && !vm.count ("unittest"))
+        && !vm.count ("unittest")
+        && !vm.count ("load-sql-history"))
     {
         std::string logMe = DoSustain ();
 
@@ -396,6 +403,24 @@ int run (int argc, char** argv)
     if (vm.count ("import"))
         config->doImport = true;
 
+    if (vm.count ("load-sql-history"))
+    {
+        auto const range = vm["load-sql-history"].as<std::string> ();
+        auto const dash = range.find ('-');
+        std::uint32_t first = 0, last = 0;
+
+        if (dash == std::string::npos ||
+            ! beast::lexicalCastChecked (first, range.substr (0, dash)) ||
+            ! beast::lexicalCastChecked (last, range.substr (dash + 1)) ||
+            first == 0 || first > last)
+        {
+            std::cerr << "Invalid load-sql-history = " << range << std::endl;
+            return -1;
+        }
+
+        config->LOAD_SQL_HISTORY.emplace (first, last);
+    }
+
     if (vm.count ("ledger"))
     {
         config->START_LEDGER = vm["ledger"].as<std::string> ();
@@ -19,12 +19,15 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/main/NodeStoreScheduler.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
+#include <cctype>
 
 namespace ripple {
 
 NodeStoreScheduler::NodeStoreScheduler (Stoppable& parent)
     : Stoppable ("NodeStoreScheduler", parent)
     , m_jobQueue (nullptr)
+    , m_ledgerCloseTimings (nullptr)
     , m_taskCount (0)
 {
 }
@@ -34,6 +37,23 @@ void NodeStoreScheduler::setJobQueue (JobQueue& jobQueue)
     m_jobQueue = &jobQueue;
 }
 
+void NodeStoreScheduler::setCollector (
+    beast::insight::Collector::ptr const& collector)
+{
+    m_batchFetch = collector->make_event ("batch_fetch");
+    m_batchFetchObject = collector->make_event ("batch_fetch_object");
+    m_batchLimit = collector->make_gauge ("batch_limit");
+
+    std::lock_guard<std::mutex> lock (m_backendMutex);
+    m_collector = collector;
+    m_backends.clear ();
+}
+
+void NodeStoreScheduler::setLedgerCloseTimings (LedgerCloseTimings& timings)
+{
+    m_ledgerCloseTimings = &timings;
+}
+
 void NodeStoreScheduler::onStop ()
 {
 }
@@ -72,6 +92,49 @@ void NodeStoreScheduler::onBatchWrite (NodeStore::BatchWriteReport const& report
 {
     m_jobQueue->addLoadEvents (jtNS_WRITE,
         report.writeCount, report.elapsed);
+    if (m_ledgerCloseTimings)
+        m_ledgerCloseTimings->addStoreBatch (report.elapsed);
+}
+
+void NodeStoreScheduler::onBatchFetch (NodeStore::BatchFetchReport const& report)
+{
+    // The collector keeps the latency histograms.
+    m_batchFetch.notify (report.elapsed);
+    if (report.fetchCount > 0)
+        m_batchFetchObject.notify (report.elapsed / report.fetchCount);
+    m_batchLimit = report.batchLimit;
+}
+
+void NodeStoreScheduler::onBackendLatency (
+    NodeStore::BackendLatencyReport const& report)
+{
+    std::lock_guard<std::mutex> lock (m_backendMutex);
+    if (! m_collector)
+        return;
+
+    auto iter = m_backends.find (report.name);
+    if (iter == m_backends.end ())
+    {
+        // Backend names are hosts or paths, which are not valid metric names
+        std::string prefix (report.name);
+        for (auto& c : prefix)
+        {
+            if (! std::isalnum (static_cast<unsigned char> (c)))
+                c = '_';
+        }
+
+        BackendMetrics metrics;
+        metrics.fetchP99 = m_collector->make_gauge (prefix, "fetch_p99_us");
+        metrics.hedged = m_collector->make_counter (prefix, "fetch_hedged");
+        metrics.late = m_collector->make_counter (prefix, "fetch_late");
+        iter = m_backends.emplace (report.name, std::move (metrics)).first;
+    }
+
+    iter->second.fetchP99 = report.p99.count ();
+    if (report.hedgedCount > 0)
+        iter->second.hedged.increment (report.hedgedCount);
+    if (report.lateCount > 0)
+        iter->second.late.increment (report.lateCount);
 }
 
 } // ripple
@@ -22,11 +22,20 @@
 
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/core/JobQueue.h>
+#include <beast/insight/Collector.h>
+#include <beast/insight/Counter.h>
+#include <beast/insight/Event.h>
+#include <beast/insight/Gauge.h>
 #include <beast/threads/Stoppable.h>
 #include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
 
 namespace ripple {
 
+class LedgerCloseTimings;
+
 /** A NodeStore::Scheduler which uses the JobQueue and implements the Stoppable API. */
 class NodeStoreScheduler
     : public NodeStore::Scheduler
@@ -40,17 +49,42 @@ public:
     //
     void setJobQueue (JobQueue& jobQueue);
 
+    /** Report the batch fetches to the collector. */
+    void setCollector (beast::insight::Collector::ptr const& collector);
+
+    /** Add the batch writes to the close timings of the newest ledger. */
+    void setLedgerCloseTimings (LedgerCloseTimings& timings);
+
     void onStop () override;
     void onChildrenStopped () override;
     void scheduleTask (NodeStore::Task& task) override;
     void onFetch (NodeStore::FetchReport const& report) override;
     void onBatchWrite (NodeStore::BatchWriteReport const& report) override;
+    void onBatchFetch (NodeStore::BatchFetchReport const& report) override;
+    void onBackendLatency (NodeStore::BackendLatencyReport const& report) override;
 
 private:
     void doTask (NodeStore::Task& task);
 
     JobQueue* m_jobQueue;
+    LedgerCloseTimings* m_ledgerCloseTimings;
     std::atomic <int> m_taskCount;
+
+    beast::insight::Event m_batchFetch;
+    beast::insight::Event m_batchFetchObject;
+    beast::insight::Gauge m_batchLimit;
+
+    // The read latency of each backend, by name
+    struct BackendMetrics
+    {
+        beast::insight::Gauge fetchP99;
+        beast::insight::Counter hedged;
+        beast::insight::Counter late;
+    };
+
+    std::mutex m_backendMutex;
+    beast::insight::Collector::ptr m_collector;
+    std::map<std::string, BackendMetrics> m_backends;
 };
 
 } // ripple
@@ -26,6 +26,12 @@ enum
 {
      fullBelowTargetSize = 524288
     ,fullBelowExpirationSeconds = 600
+
+    // Ledgers whose close timings are kept
+    ,ledgerCloseTimingsSize = 256
+
+    // Transactions whose signatures one job checks together
+    ,signatureBatchSize = 64
 };
 
 }
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_APP_MISC_ACCOUNTSUBSCRIPTIONS_H_INCLUDED
+#define RIPPLE_APP_MISC_ACCOUNTSUBSCRIPTIONS_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/json/json_value.h>
+#include <ripple/net/InfoSub.h>
+#include <ripple/net/SharedMessage.h>
+#include <ripple/protocol/AccountID.h>
+#include <boost/container/flat_set.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** The subscribers of the accounts streams, and their queues.
+
+    Each account maps to the sequence numbers of its subscribers, kept in
+    a short vector, so a million subscribed accounts cost one allocation
+    each. A transaction looks up each account it affects once and gets
+    its subscribers in order, each listed once however many of the
+    accounts it follows.
+
+    Events are rendered once by the publisher and queued to each
+    subscriber. A job drains a subscriber's queue in order, so the slow
+    sends happen off the publishing thread. A subscriber which falls
+    maxQueued events behind misses the newer ones.
+*/
+class AccountSubscriptions
+{
+public:
+    // A transaction, as sent to every subscriber
+    struct Event
+    {
+        explicit
+        Event (Json::Value jv)
+            : json (std::move (jv))
+            , message (json)
+        {
+        }
+
+        Json::Value const json;
+        SharedMessage const message;
+    };
+
+    /** Runs a drain of a subscriber's queue later. */
+    using Schedule = std::function<void (std::function<void ()>)>;
+
+    struct Stats
+    {
+        std::size_t accounts = 0;
+        std::size_t subscribers = 0;
+        std::uint64_t queued = 0;
+        std::uint64_t dropped = 0;
+    };
+
+    // Events sent by a drain before it makes way for other jobs
+    static std::size_t const drainBatch = 64;
+
+    /** Create the index.
+
+        @param schedule Runs the drains, nullptr to send from the
+                        publishing thread.
+        @param maxQueued The most events waiting for a subscriber.
+    */
+    AccountSubscriptions (Schedule schedule, std::size_t maxQueued);
+
+    /** Add a subscriber of the accounts. */
+    void insert (InfoSub::ref sub,
+        hash_set<AccountID> const& accounts, bool rt);
+
+    /** Remove a subscriber of the accounts. */
+    void erase (std::uint64_t seq,
+        hash_set<AccountID> const& accounts, bool rt);
+
+    /** Returns true if nobody follows proposed, or also validated,
+        transactions.
+    */
+    bool empty (bool accepted) const;
+
+    /** Returns the subscribers of any of the accounts, each once.
+
+        Real time subscribers are always included, the others only for
+        a validated transaction. Subscribers which are gone are skipped,
+        they remove themselves as they are destroyed.
+    */
+    template <class Accounts>
+    std::vector<InfoSub::pointer>
+    find (Accounts const& accounts, bool accepted);
+
+    /** Queue an event to each of the subscribers. */
+    void publish (std::vector<InfoSub::pointer> const& subs,
+        std::shared_ptr<Event const> const& event);
+
+    Stats getStats () const;
+
+private:
+    struct Queue
+    {
+        InfoSub::wptr sub;
+
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Event const>> events;
+        bool draining = false;
+    };
+
+    struct Subscriber
+    {
+        std::shared_ptr<Queue> queue;
+
+        // The accounts followed, of both kinds
+        std::size_t accounts = 0;
+    };
+
+    using Index = hash_map<AccountID, std::vector<std::uint64_t>>;
+
+    void
+    add (Index const& index, AccountID const& account,
+        boost::container::flat_set<std::uint64_t>& seqs) const;
+
+    void drain (std::shared_ptr<Queue> const& queue);
+
+    Schedule const schedule_;
+    std::size_t const maxQueued_;
+
+    mutable std::mutex mutex_;
+    Index normal_;
+    Index realTime_;
+    hash_map<std::uint64_t, Subscriber> subscribers_;
+
+    std::uint64_t queued_ = 0;
+    std::uint64_t dropped_ = 0;
+};
+
+template <class Accounts>
+std::vector<InfoSub::pointer>
+AccountSubscriptions::find (Accounts const& accounts, bool accepted)
+{
+    std::vector<InfoSub::pointer> subs;
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    if (realTime_.empty () && (! accepted || normal_.empty ()))
+        return subs;
+
+    boost::container::flat_set<std::uint64_t> seqs;
+    for (auto const& account : accounts)
+    {
+        add (realTime_, account, seqs);
+        if (accepted)
+            add (normal_, account, seqs);
+    }
+
+    subs.reserve (seqs.size ());
+    for (auto const seq : seqs)
+    {
+        auto const it = subscribers_.find (seq);
+        if (it == subscribers_.end ())
+            continue;
+
+        if (auto sub = it->second.queue->sub.lock ())
+            subs.push_back (std::move (sub));
+    }
+    return subs;
+}
+
+} // ripple
+
+#endif
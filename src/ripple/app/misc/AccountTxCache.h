@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_APP_MISC_ACCOUNTTXCACHE_H_INCLUDED
+#define RIPPLE_APP_MISC_ACCOUNTTXCACHE_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/AccountID.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** The newest transactions of recently active accounts.
+
+    Published ledgers add their transactions to the accounts they affect,
+    keeping up to a fixed number per account for a fixed number of
+    accounts, least recently used first out. An account_tx page found
+    entirely within what is kept is served without the transaction
+    database, with the same rows and marker the database would return.
+*/
+class AccountTxCache
+{
+public:
+    struct Tx
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t txnSeq;
+        Blob rawTxn;
+        Blob rawMeta;
+    };
+
+    // A transaction with the accounts it affects
+    using Entry = std::pair<std::shared_ptr<Tx const>, std::vector<AccountID>>;
+
+    using OnTransaction = std::function<void (std::uint32_t,
+        std::string const&, Blob const&, Blob const&)>;
+
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t accounts = 0;
+    };
+
+    /** Create the cache.
+
+        @param accounts The most accounts kept, zero to disable.
+        @param depth The most transactions kept for each account.
+    */
+    AccountTxCache (std::size_t accounts, std::size_t depth);
+
+    /** Add the transactions of a published ledger, in ledger order.
+
+        A ledger which does not follow the last one added empties the
+        cache, as the transactions in between are unknown.
+    */
+    void addLedger (std::uint32_t seq, std::vector<Entry> const& txs);
+
+    /** Serve a page of account_tx if every row of it is kept.
+
+        The arguments are those of accountTxPage. On a miss the token is
+        left unchanged and nothing is called.
+
+        @return true if the page was served.
+    */
+    bool page (
+        AccountID const& account,
+        std::int32_t minLedger,
+        std::int32_t maxLedger,
+        bool forward,
+        Json::Value& token,
+        int limit,
+        bool bAdmin,
+        std::uint32_t pageLength,
+        OnTransaction const& onTransaction);
+
+    Stats getStats () const;
+
+    bool enabled () const
+    {
+        return maxAccounts_ != 0;
+    }
+
+private:
+    void evict ();
+
+    struct AccountTxs
+    {
+        // Oldest first
+        std::deque<std::shared_ptr<Tx const>> txs;
+
+        // Every transaction of the account from this ledger on is kept
+        std::uint32_t complete;
+
+        std::list<AccountID>::iterator lru;
+    };
+
+    std::size_t const maxAccounts_;
+    std::size_t const depth_;
+
+    mutable std::mutex mutex_;
+    hardened_hash_map<AccountID, AccountTxs> accounts_;
+
+    // Most recently used first
+    std::list<AccountID> lru_;
+
+    // The published ledgers added, none if first_ is zero
+    std::uint32_t first_ = 0;
+    std::uint32_t last_ = 0;
+
+    // The newest ledger with a transaction of an account no longer kept
+    std::uint32_t evicted_ = 0;
+
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+} // ripple
+
+#endif
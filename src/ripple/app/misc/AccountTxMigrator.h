@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_APP_MISC_ACCOUNTTXMIGRATOR_H_INCLUDED
+#define RIPPLE_APP_MISC_ACCOUNTTXMIGRATOR_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/protocol/AccountID.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ripple {
+
+/** Moves the accounts of each transaction to the binary schema.
+
+    The AccountTransactions table keys accounts by their base58 text and
+    transactions by hex. On MySQL the AccountTxs table holds the same rows
+    with binary accounts and IDs, clustered by (Account, LedgerSeq, TxnSeq).
+
+    A database created by this version only has AccountTxs. An older one
+    keeps using AccountTransactions until a migration is started with
+    migrate_account_tx in [transaction_db]. From then on both tables are
+    written while a thread copies the older ledgers down to the first one,
+    a chunk at a time and resuming after a restart. Queries move to
+    AccountTxs once the copy completes.
+*/
+class AccountTxMigrator
+    : public beast::Stoppable
+{
+protected:
+    explicit AccountTxMigrator (Stoppable& parent);
+
+public:
+    enum class Schema
+    {
+        legacy,     // AccountTransactions only
+        migrating,  // Both written, AccountTransactions queried
+        binary      // AccountTxs only
+    };
+
+    /** Destroy the object. */
+    virtual ~AccountTxMigrator () = 0;
+
+    /** Find the schema of the transaction database.
+
+        Called once the databases are open, before any ledger is saved.
+    */
+    virtual void setup () = 0;
+
+    /** The tables to write and to query.
+
+        Thread safety:
+            Safe to call from any thread at any time.
+    */
+    virtual Schema getSchema () const = 0;
+
+    /** The ledger below which rows remain to be copied, zero when done. */
+    virtual std::uint32_t getCursor () const = 0;
+};
+
+/** The table of account rows, aliased as AccountTransactions so queries
+    name its columns the same way in either schema.
+*/
+std::string
+accountTxTable (AccountTxMigrator::Schema schema);
+
+/** The condition joining Transactions to the account rows. */
+std::string
+accountTxJoin (AccountTxMigrator::Schema schema);
+
+/** The SQL literal matching an account in the account rows. */
+std::string
+accountTxLiteral (AccountTxMigrator::Schema schema,
+    AccountIDCache const& idCache, AccountID const& account);
+
+std::unique_ptr<AccountTxMigrator>
+make_AccountTxMigrator (Application& app,
+    beast::Stoppable& parent, beast::Journal journal);
+
+} // ripple
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef RIPPLE_APP_MISC_BINARYSTREAM_H_INCLUDED
+#define RIPPLE_APP_MISC_BINARYSTREAM_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TER.h>
+#include <cstdint>
+
+namespace ripple {
+
+/** Events of the ledger and transactions streams, in binary.
+
+    Subscribers which ask for "binary" get each event of these streams as
+    one binary websocket message, built from the serialized ledger data
+    instead of rendered as JSON. Integers are big endian, and variable
+    length fields have the length prefix used in serialized objects.
+
+    Every message starts with one byte holding its type.
+
+    transaction:
+        4   ledger index
+        32  ledger hash
+        4   ledger close time
+        4   engine result code (signed)
+        VL  transaction
+        VL  metadata
+
+    ledger:
+        the ledger header, as its hash is computed over
+        32  ledger hash
+        4   number of transactions
+        8   reference transaction cost (drops)
+        4   reference fee units
+        4   reserve base (drops)
+        4   reserve increment (drops)
+*/
+namespace BinaryStream {
+
+enum Type : std::uint8_t
+{
+    transaction = 1,
+    ledger = 2
+};
+
+/** Returns the message for a transaction validated in a ledger. */
+Blob
+makeTransaction (LedgerInfo const& info, STTx const& txn, TER result,
+    Blob const& rawMeta);
+
+/** Returns the message for a validated ledger. */
+Blob
+makeLedger (LedgerInfo const& info, Fees const& fees,
+    std::uint32_t txnCount);
+
+} // BinaryStream
+
+} // ripple
+
+#endif
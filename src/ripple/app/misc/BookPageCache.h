@@ -0,0 +1,76 @@
+#ifndef RIPPLE_APP_MISC_BOOKPAGECACHE_H_INCLUDED
+#define RIPPLE_APP_MISC_BOOKPAGECACHE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/Book.h>
+#include <ripple/protocol/Protocol.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+/** The offers of book pages served from recent closed ledgers.
+
+    The offers of a closed ledger never change, so book_offers requests
+    and book snapshots asking again for the same page of a book get the
+    offers built the first time, without computing the funds of their
+    owners again. Pages are kept for the newest few ledgers asked about.
+*/
+class BookPageCache
+{
+public:
+    using Page = std::shared_ptr<Json::Value const>;
+
+    /** Create the cache.
+
+        @param ledgers The most ledgers pages are kept for.
+        @param pages The most pages kept for each ledger.
+    */
+    BookPageCache (std::size_t ledgers, std::size_t pages);
+
+    BookPageCache (BookPageCache const&) = delete;
+    BookPageCache& operator= (BookPageCache const&) = delete;
+
+    /** Returns the key of a page.
+
+        The offers only depend on the taker in whether it is the issuer
+        of what the offers sell.
+    */
+    static
+    uint256
+    key (Book const& book, bool takerIsIssuer, unsigned int limit);
+
+    /** Returns a page of a ledger, or `nullptr` if it is not kept. */
+    Page
+    fetch (uint256 const& ledgerHash, uint256 const& key) const;
+
+    /** Keep a page of a ledger. */
+    void
+    insert (uint256 const& ledgerHash, LedgerIndex seq,
+        uint256 const& key, Page page);
+
+    /** Returns the number of pages kept. */
+    std::size_t
+    size () const;
+
+private:
+    struct Ledger
+    {
+        LedgerIndex seq;
+        hash_map<uint256, Page> pages;
+    };
+
+    std::size_t const maxLedgers_;
+    std::size_t const maxPages_;
+
+    std::mutex mutable mutex_;
+    hash_map<uint256, Ledger> ledgers_;
+};
+
+} // ripple
+
+#endif
@@ -74,13 +74,14 @@ bool CanonicalTXSet::Key::operator>= (Key const& rhs)const
     return mTXid >= rhs.mTXid;
 }
 
-void CanonicalTXSet::insert (std::shared_ptr<STTx const> const& txn)
+std::pair<CanonicalTXSet::iterator, bool>
+CanonicalTXSet::insert (std::shared_ptr<STTx const> const& txn)
 {
     uint256 effectiveAccount = mSetHash;
 
     effectiveAccount ^= to256 (txn->getAccountID(sfAccount));
 
-    mMap.insert (std::make_pair (
+    return mMap.insert (std::make_pair (
                      Key (effectiveAccount, txn->getSequence (), txn->getTransactionID ()),
                      txn));
 }
@@ -22,6 +22,8 @@
 
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/protocol/STTx.h>
+#include <map>
+#include <utility>
 
 namespace ripple {
 
@@ -81,7 +83,13 @@ public:
     {
     }
 
-    void insert (std::shared_ptr<STTx const> const& txn);
+    /** Add a transaction.
+
+        @return The position of the transaction, and `false` if it was
+                already in the set.
+    */
+    std::pair<iterator, bool>
+    insert (std::shared_ptr<STTx const> const& txn);
 
     // VFALCO TODO remove this function
     void reset (LedgerHash const& saltHash)
@@ -0,0 +1,61 @@
+#ifndef RIPPLE_APP_MISC_DEADOFFERS_H_INCLUDED
+#define RIPPLE_APP_MISC_DEADOFFERS_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/ledger/ApplyView.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/shamap/SHAMap.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+/** Choosing the offers an OfferPurge pseudo-transaction removes.
+
+    Books are ranked by the offers the transactions of the last closed
+    ledger created, changed or removed in them. Up to maxBooks of the
+    busiest are walked from their tip for up to maxSteps offers each,
+    and up to maxOffers of those no taker could cross are listed. Every
+    validator reads the same ledger, so they all propose the same
+    transaction.
+*/
+namespace DeadOffers {
+
+std::size_t const maxBooks = 8;
+std::size_t const maxSteps = 64;
+std::size_t const maxOffers = 64;
+
+/** Returns true if a taker reaching the offer would remove it.
+
+    The offer is expired, has an empty amount, or its owner has nothing
+    to pay it with.
+
+    @param when The close time of the parent of the ledger under
+                construction.
+*/
+bool
+isDead (ApplyView& view, SLE const& offer, std::uint32_t when,
+    beast::Journal j);
+
+/** Returns the dead offers of the busiest books, in key order. */
+std::vector<uint256>
+find (ReadView const& lastClosedLedger, beast::Journal j);
+
+/** Returns the pseudo-transaction removing the offers. */
+STTx
+makeTx (std::vector<uint256> const& offers);
+
+/** Add an OfferPurge of the ledger's dead offers to a position. */
+void
+addToPosition (ReadView const& lastClosedLedger,
+    std::shared_ptr<SHAMap> const& initialPosition, beast::Journal j);
+
+} // DeadOffers
+
+} // ripple
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef RIPPLE_APP_MISC_DIVIDENDBATCH_H_INCLUDED
+#define RIPPLE_APP_MISC_DIVIDENDBATCH_H_INCLUDED
+
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+/** Applying a dividend a subtree of its transaction map at a time.
+
+    The dividend map holds one unsigned DivType_Apply transaction per
+    account, and validators agree on its root hash only, they do not hold
+    the map. A DivType_ApplyBatch transaction carries the payees of every
+    leaf under one node of the map, the depth of that node and, for each
+    inner node above it, the hashes of its sixteen branches. Validators
+    rebuild the leaves from the payees, hash the subtree, fold the hashes
+    up to the root and apply the batch only if it is the agreed root.
+
+    A node at depth zero is the root. Every other node holding a single
+    leaf is that leaf, as in the map.
+*/
+namespace DividendBatch {
+
+/** Most payees one batch credits. */
+std::size_t const maxPayees = 256;
+
+/** Deepest node a batch may cover. */
+int const maxDepth = 64;
+
+/** A node of the map and the keys of the leaves under it. */
+struct Batch
+{
+    /** Leaves under the node, indexes into the sorted keys. */
+    std::size_t first;
+    std::size_t last;
+
+    int depth;
+    uint256 hash;
+
+    /** The branch hashes of the inner nodes above, root first, sixteen
+        per node. The branch leading to the node is zero.
+    */
+    std::vector<uint256> proof;
+};
+
+/** Returns the payee entry of one account's dividend. */
+STObject
+makePayee (AccountID const& account,
+    DividendMaster::AccountsDividend::mapped_type const& result);
+
+/** Returns the payee entry of an unsigned DivType_Apply transaction. */
+STObject
+makePayee (STTx const& apply);
+
+/** Returns the unsigned DivType_Apply transaction of a payee, as it is
+    in the dividend map.
+*/
+STTx
+makeApply (STObject const& payee, std::uint32_t dividendLedger,
+    Blob const& publicKey);
+
+/** Returns the key of a transaction in the dividend map. */
+uint256
+itemKey (STTx const& apply);
+
+/** Returns the hash of the node at a depth holding the leaves with
+    sorted keys [first, last), which share their first depth nibbles.
+*/
+uint256
+subtreeHash (uint256 const* first, uint256 const* last, int depth);
+
+/** Returns the root hash reached from the hash of a node through the
+    branch hashes of the inner nodes above it.
+    @param path A key under the node.
+*/
+uint256
+rootHash (uint256 const& hash, uint256 const& path, int depth,
+    std::vector<uint256> const& proof);
+
+/** Splits the map with the sorted keys into the nodes holding at most
+    maxBatch leaves, each as shallow as possible.
+    @return The root hash of the map.
+*/
+uint256
+split (std::vector<uint256> const& keys, std::size_t maxBatch,
+    std::vector<Batch>& batches);
+
+/** Returns the unsigned DivType_ApplyBatch transaction of a batch.
+    @param payees The payees of the leaves of the batch, in key order.
+*/
+STTx
+makeTx (std::uint32_t dividendLedger, uint256 const& dividendHash,
+    Batch const& batch, STArray payees, Blob const& publicKey);
+
+/** Returns the sorted keys of the payees of a batch transaction, or
+    nothing if a payee is malformed or listed twice.
+*/
+std::vector<uint256>
+payeeKeys (STTx const& tx);
+
+/** Returns true if the payees of a batch transaction are the leaves of
+    its node, and the node is in the map with its sfDividendHash.
+*/
+bool
+verify (STTx const& tx, beast::Journal j);
+
+} // DividendBatch
+
+} // ripple
+
+#endif
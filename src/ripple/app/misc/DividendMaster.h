@@ -3,6 +3,7 @@
 
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/shamap/SHAMap.h>
+#include <boost/optional.hpp>
 
 namespace ripple {
 
@@ -13,7 +14,8 @@ public:
     {
         DivType_Done = 0,   /// Deprecated, do not use.
         DivType_Start = 1,
-        DivType_Apply = 2
+        DivType_Apply = 2,
+        DivType_ApplyBatch = 3  /// A subtree of the map, see DividendBatch.
     } DivdendType;
     typedef enum { DivState_Done = 0, DivState_Start = 1 } DivdendState;
     
@@ -21,6 +23,14 @@ public:
     //typedef std::vector<std::tuple<AccountID, uint64_t, uint64_t, uint64_t, uint64_t, uint32_t, uint64_t, uint64_t>> AccountsDividend;
     
     typedef std::map<AccountID, std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint32_t, uint64_t, uint64_t>> AccountsDividend;
+
+    /** The accounts below an account in the referral forest. */
+    struct ReferralSubtree
+    {
+        std::uint32_t ledgerSeq;    // Last validated ledger indexed
+        std::uint64_t count;        // Descendants
+        std::uint64_t vbc;          // sfBalanceVBC of the descendants
+    };
     
     virtual ~DividendMaster(){}
     
@@ -31,10 +41,32 @@ public:
     
     virtual bool calcDividend (const uint32_t ledgerIndex) = 0;
     virtual bool dumpTransactionMap (const uint32_t ledgerIndex, const std::string& hash) = 0;
+
+    /** Compare the map of the last calculated dividend with the map of a
+        hash, as far as the node store has its nodes.
+        @param limit The most accounts reported.
+        @return The differing accounts and their fields.
+    */
+    virtual std::pair<bool, Json::Value>
+    verifyTransactionMap (std::uint32_t ledgerIndex, std::string const& hash,
+        std::size_t limit) = 0;
     virtual std::pair<bool, Json::Value> checkDividend (const uint32_t ledgerIndex, const std::string hash) = 0;
     virtual bool launchDividend (const uint32_t ledgerIndex) = 0;
+
+    /** Result of an account in the dividend of a ledger, if it got one. */
+    virtual boost::optional<AccountsDividend::mapped_type>
+    getAccountDividend (AccountID const& account, std::uint32_t dividendLedger) = 0;
+
+    /** Descendants of an account, from the dividend index.
+        @return boost::none if the index is disabled or not built.
+    */
+    virtual boost::optional<ReferralSubtree>
+    getReferralSubtree (AccountID const& account) = 0;
     
     virtual void getMissingTxns () = 0;
+
+    /** Called for each ledger that becomes fully validated. */
+    virtual void onLedgerAccepted (Ledger::ref ledger) = 0;
 };
 
 std::unique_ptr<DividendMaster>
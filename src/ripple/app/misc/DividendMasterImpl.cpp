@@ -4,23 +4,30 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #endif
-#include <boost/multiprecision/cpp_int.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/depth_first_search.hpp>
-
 #include <beast/threads/RecursiveMutex.h>
 
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 //#include <ripple/app/misc/DefaultMissingNodeHandler.h>
 #include <ripple/app/misc/DividendMaster.h>
+#include <ripple/app/misc/impl/DividendEngine.h>
+#include <ripple/app/misc/impl/DividendHistory.h>
+#include <ripple/app/misc/impl/DividendIndex.h>
+#include <ripple/app/misc/impl/DividendProgress.h>
+#include <ripple/app/misc/impl/DividendResultFile.h>
+#include <ripple/app/misc/impl/DividendSigner.h>
+#include <ripple/app/misc/impl/DividendSubmitter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/core/DatabaseCon.h>
 #include <ripple/protocol/SystemParameters.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/json/to_string.h>
 #include <ripple/server/Role.h>
 #include <ripple/rpc/impl/TransactionSign.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+#include <mutex>
 
 namespace ripple {
         
@@ -42,8 +49,20 @@ class DividendMasterImpl : public DividendMaster
 {
 public:
     DividendMasterImpl (Application& app, beast::Journal journal)
-        : app_ (app), m_journal (journal)
+        : app_ (app), m_journal (journal), m_engine (journal)
+        , m_signer (app.config ()[ConfigSection::dividendAccount ()],
+            app.getCollectorManager (), journal)
+        , m_submitter (app, m_signer, journal)
+        , m_progress (journal)
+        , m_history (app, journal)
     {
+        auto const& section = app.config ()[ConfigSection::dividendAccount ()];
+        if (get<bool> (section, "spill", false))
+        {
+            m_resultFile = std::make_unique<DividendResultFile> (
+                setup_DatabaseCon (app.config ()).dataDir /
+                    "dividend_result.bin");
+        }
     }
 
     AccountsDividend& getDivResult()
@@ -110,113 +129,6 @@ public:
         return std::make_tuple (dividendCoins, dividendCoinsVBC);
     }
 
-    /// Prepare #m_accountsByBalance and #m_accountsGraph for dividend.
-    void prepareAccounts (Ledger::pointer ledger)
-    {
-        // Accounts that are under minimal VBC requirement and with no
-        // reference yet.
-        std::unordered_map<AccountID, std::shared_ptr<AccountData>> accountsUnqualified;
-
-        auto& accounts = m_accounts;
-        accounts.clear ();
-        auto& accountsByBalance = m_accountsByBalance;
-        accountsByBalance.clear ();
-        auto& accountsGraph = m_accountsGraph;
-        accountsGraph.clear ();
-
-        /// push an AccountData into #accounts and #accountsGraph.
-        /// @return std::pair<iterator in accounts, true as succeeded>.
-        auto pushAccount = [&](const std::shared_ptr<AccountData>& accountData)
-        {
-            auto result = accounts.emplace (accountData->account, accountData);
-            if (result.second)
-                accountData->vertex = boost::add_vertex ({accountData}, accountsGraph);
-            return result;
-        };
-
-        /// Visit all AccountRoots to fill #accounts, #accountsGraph and #accountsByBalance.
-        auto accountVisitor = [&](SLE::ref sle)
-        {
-            if (sle->getType () != ltACCOUNT_ROOT)
-                return;
-
-            uint64_t vbc = sle->getFieldAmount (sfBalanceVBC).mantissa ();
-
-            auto account = sle->getAccountID (sfAccount);
-            auto accountParent = sle->getAccountID (sfReferee);
-            bool noParent = !accountParent;
-
-            auto iter = accounts.find (account);
-
-            if (iter != accounts.end ())
-            {
-                // Already qualified as referee.
-                iter->second->vbc = vbc;
-            }
-            else if (vbc < SYSTEM_CURRENCY_PARTS_VBC && noParent)
-            {
-                // Not qualified, store in accountsUnqualified temporary.
-                accountsUnqualified.emplace (account, std::make_shared<AccountData> (account, vbc));
-                return;
-            }
-            else
-            {
-                // Qualified.
-                bool result;
-                std::tie (iter, result) = pushAccount (std::make_shared<AccountData> (account, vbc));
-                if (!result)
-                {
-                    // this should not happen.
-                    if (m_journal.fatal)
-                        m_journal.fatal << "Can not get AccountData for " << account;
-                }
-            }
-
-            if (vbc >= SYSTEM_CURRENCY_PARTS_VBC)
-            {
-                // Qualified for vRank calc, add to accountsByBalance.
-                accountsByBalance.emplace (vbc, iter->second);
-            }
-
-            // Add an edge [referee->reference] in graph.
-            if (!noParent)
-            {
-                auto iterParent = accounts.find (accountParent);
-                if (iterParent == accounts.end ())
-                {
-                    // Not in accounts yet, try move from accountsUnqualified or construct an later-init one.
-                    std::shared_ptr<AccountData> accountData;
-                    auto iterUnqualified = accountsUnqualified.find (accountParent);
-                    if (iterUnqualified != accountsUnqualified.end ())
-                    {
-                        accountData = iterUnqualified->second;
-                        accountsUnqualified.erase (iterUnqualified);
-                    }
-                    else
-                    {
-                        accountData.reset (new AccountData (accountParent, 0));
-                    }
-
-                    std::tie (iterParent, std::ignore) = pushAccount (accountData);
-                    if (iterParent == accounts.end ())
-                    {
-                        // this should not happen.
-                        if (m_journal.fatal)
-                            m_journal.fatal << "Can not get AccountData for " << sle->getAccountID (sfAccount);
-                    }
-                }
-                auto& parentPtr = iterParent->second;
-                add_edge (parentPtr->vertex, iter->second->vertex, accountsGraph);
-                iter->second->parent = parentPtr->vertex;
-            }
-        };
-
-        ledger->visitStateItems (accountVisitor);
-
-        if (m_journal.info)
-            m_journal.info << accountsUnqualified.size () << " unqualified accounts found. Mem " << memUsed ();
-    }
-
     bool calcDividend (const uint32_t ledgerIndex) override
     {
         Ledger::pointer ledger = app_.getLedgerMaster ().getLedgerBySeq (ledgerIndex);
@@ -245,10 +157,21 @@ public:
         if (m_journal.info)
             m_journal.info << "Expected dividend: " << dividendCoins << " " << dividendCoinsVBC << " for ledger " << ledgerSeq << ". Mem " << memUsed ();
 
-        prepareAccounts (ledger);
+        if (auto index = getIndex ())
+        {
+            if (!m_engine.prepare (*ledger, *index))
+            {
+                JLOG (m_journal.info) << "Dividend index can not serve ledger " << ledgerSeq << ", walking state map.";
+                m_engine.prepare (ledger);
+            }
+        }
+        else
+        {
+            m_engine.prepare (ledger);
+        }
 
         if (m_journal.info)
-            m_journal.info << m_accountsByBalance.size () << " accounts found for ranking, " << m_accounts.size () << " accounts for sprd. Mem " << memUsed ();
+            m_journal.info << m_engine.rankedSize () << " accounts found for ranking, " << m_engine.size () << " accounts for sprd. Mem " << memUsed ();
 
         ledger.reset ();
 
@@ -256,357 +179,182 @@ public:
         uint64_t actualTotalDividend = 0, actualTotalDividendVBC = 0,
                  sumVRank = 0, sumVSpd = 0;
 
-        getDivResult ().clear ();
+        std::size_t results = 0;
+        try
+        {
+            if (m_resultFile)
+            {
+                // Stream the results to disk as soon as they are known.
+                getDivResult ().clear ();
+                m_resultFile->create ();
+                m_engine.calcDividend (dividendCoins, dividendCoinsVBC,
+                                       actualTotalDividend, actualTotalDividendVBC,
+                                       sumVRank, sumVSpd,
+                                       [this](AccountID const& account, DividendEngine::Result const& result)
+                                       {
+                                           m_resultFile->append (account, result);
+                                       });
+                m_resultFile->finish ();
+                results = m_resultFile->size ();
+            }
+            else
+            {
+                m_engine.calcDividend (dividendCoins, dividendCoinsVBC,
+                                       actualTotalDividend, actualTotalDividendVBC,
+                                       sumVRank, sumVSpd, getDivResult ());
+                results = getDivResult ().size ();
+            }
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (m_journal.error) << "calcDividend failed: " << e.what ();
+            m_engine.clear ();
+            if (m_resultFile)
+                m_resultFile->clear ();
+            return false;
+        }
+        m_engine.clear ();
 
-        calcDividend (dividendCoins, dividendCoinsVBC,
-                      actualTotalDividend, actualTotalDividendVBC,
-                      sumVRank, sumVSpd);
+        m_dividendVRank = sumVRank;
+        m_dividendVSprd = sumVSpd;
+
+        JLOG (m_journal.info) << "calcDividend done with " << results << " accounts Mem " << memUsed ();
 
         return true;
     }
     std::pair<bool, Json::Value> checkDividend (const uint32_t ledgerIndex, const std::string hash) override;
     bool launchDividend (uint32_t const ledgerIndex) override;
 
-    void calcDividend (uint64_t dividendCoins, uint64_t dividendCoinsVBC, uint64_t& actualTotalDividend, uint64_t& actualTotalDividendVBC, uint64_t& sumVRank, uint64_t& sumVSpd);
-
-    bool dumpTransactionMap (const uint32_t ledgerIndex, const std::string& hash) override;
-    
-    void getMissingTxns() override;
-
-private:
-    Application& app_;
-    beast::Journal m_journal;
-
-    AccountsDividend m_divResult;
-    SHAMapHash m_resultHash;
-    uint64_t m_dividendTotalCoins;
-    uint64_t m_dividendTotalCoinsVBC;
-    uint64_t m_dividendVRank;
-    uint64_t m_dividendVSprd;
-    int m_dividendState = DivType_Start;
-    
-    class AccountData
+    boost::optional<AccountsDividend::mapped_type>
+    getAccountDividend (AccountID const& account, std::uint32_t dividendLedger) override
     {
-    public:
-        typedef std::shared_ptr<AccountData> Pointer;
-        struct Property
+        try
         {
-            Pointer data;
-        };
-        typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Property> Graph;
-        typedef boost::graph_traits<Graph>::vertex_descriptor Vertex;
-
-        AccountData (const AccountID& accountId, uint64_t balanceVBC)
-            : account (accountId), vbc (balanceVBC) {}
-        AccountID account;
-        uint64_t vbc = 0;
-        uint64_t vRank = 0, vSprd = 0, tSprd = 0;
-        uint64_t maxChildHolding = 0;
-        Vertex vertex = boost::graph_traits<Graph>::null_vertex ();
-        Vertex parent = boost::graph_traits<Graph>::null_vertex ();
-    };
-
-    class Visitor : public boost::default_dfs_visitor
-    {
-    public:
-        typedef std::function<void(AccountData::Vertex, const AccountData::Graph&)> VertexFunc;
-
-        Visitor (VertexFunc start_vertex, VertexFunc finish_vertex)
-            : m_start_vertex (start_vertex), m_finish_vertex (finish_vertex)
+            return m_history.find (account, dividendLedger);
+        }
+        catch (std::exception const& e)
         {
+            JLOG (m_journal.error) << "Dividend history lookup failed: " << e.what ();
+            return boost::none;
         }
+    }
 
-        template <class Vertex, class Graph>
-        void start_vertex (Vertex vertex, const Graph& accountsGraph)
+    boost::optional<ReferralSubtree>
+    getReferralSubtree (AccountID const& account) override
+    {
+        auto index = getIndex ();
+        if (!index)
+            return boost::none;
+
+        try
         {
-            m_start_vertex (vertex, accountsGraph);
+            return index->subtree (account);
         }
-
-        template <typename Vertex, typename Graph>
-        void finish_vertex (Vertex vertex, const Graph& accountsGraph)
+        catch (std::exception const& e)
         {
-            m_finish_vertex (vertex, accountsGraph);
+            JLOG (m_journal.error) << "Dividend index lookup failed: " << e.what ();
+            return boost::none;
         }
-
-    private:
-        VertexFunc m_start_vertex, m_finish_vertex;
-    };
-
-    /// Reference Graph
-    AccountData::Graph m_accountsGraph;
-
-    /// Accounts with enough VBC or references.
-    std::unordered_map<AccountID, std::shared_ptr<AccountData>> m_accounts;
-
-    /// Accounts to calculate vRank. Sorted by balance.
-    std::multimap<uint64_t, std::shared_ptr<AccountData>> m_accountsByBalance;
-};
-
-void DividendMasterImpl::getMissingTxns ()
-{
-    if (app_.getOPs ().isNeedNetworkLedger ())
-    {
-        return;
     }
-    
-    beast::Journal journal(app_.journal("DividendMaster"));
-    auto const& curLedger = app_.getLedgerMaster ().getCurrentLedger ();
-    auto const& dividendObj = curLedger->read (keylet::dividend ());
-    if (!dividendObj)
-        return;
 
-    SHAMapHash fullHash (dividendObj->getFieldH256 (sfDividendHash));
+    bool dumpTransactionMap (const uint32_t ledgerIndex, const std::string& hash) override;
 
-    std::shared_ptr<SHAMap> fullDivMap = std::make_shared<SHAMap> (
-        SHAMapType::TRANSACTION,
-        fullHash.as_uint256(),
-        app_.family ());
-    std::vector<SHAMapNodeID> nodeIDs;
-    std::vector<uint256> nodeHashes;
-    nodeIDs.reserve (1);
-    nodeHashes.reserve (1);
-    if (fullDivMap->fetchRoot (fullHash, nullptr))
-    {
-        fullDivMap->getMissingNodes(nodeIDs, nodeHashes, 1, nullptr);
-        if (!nodeIDs.empty())
-        {
-            journal.fatal << "Dividend job, full dividend map is empty.";
-            return;
-        }
-    }
-    else
-    {
-        journal.fatal << "Dividend job, fetch full root hash failed.";
-        return;
-    }
+    std::pair<bool, Json::Value>
+    verifyTransactionMap (std::uint32_t ledgerIndex, std::string const& hash,
+        std::size_t limit) override;
     
-//    SHAMap const& transMap = curLedger->txMap ();
-    std::string secret_key = get<std::string> (app_.config ()[ConfigSection::dividendAccount ()], "secret_key");
-    RippleAddress secret = RippleAddress::createSeedGeneric (secret_key);
-    RippleAddress generator = RippleAddress::createGeneratorPublic (secret);
-    RippleAddress naAccountPrivate = RippleAddress::createAccountPrivate (generator, secret, 0);
-    
-    uint32_t dividendLedger = dividendObj->getFieldU32 (sfDividendLedger);
-    uint256 prevTxnID = dividendObj->getFieldH256 (sfDividendMarker);
-    auto txnIter = fullDivMap->upper_bound (prevTxnID);
-    if (txnIter != fullDivMap->end ())
-        txnIter++;
-
-    uint256 lastTxn = prevTxnID;
-    int shots = 200;
-    int passes = 1;
-
-    JLOG(journal.info) << "Dividend job, begin submit, dividend state " << getDividendState();
-    while (shots > 0 && getDividendState() == DividendMaster::DivType_Start)
+    void getMissingTxns() override;
+
+    void onLedgerAccepted (Ledger::ref ledger) override
     {
-        if (txnIter == fullDivMap->end ())
-        {
-            txnIter = fullDivMap->begin ();
-        }
-        auto const& item = *txnIter;
-        txnIter++;
+        if (auto index = getIndex ())
+            index->onLedgerAccepted (ledger);
 
-        JLOG(journal.trace) << "Dividend job, prev transaction " << prevTxnID;
-        JLOG(journal.trace) << "Dividend job, this transaction " << item.key ();
-        prevTxnID = item.key ();
-        
-        auto sitTrans = SerialIter{item.data (), item.size ()};
-        std::shared_ptr<STTx> stpTrans = std::make_shared<STTx> (std::ref (sitTrans));
-        
-        auto accountSLE = curLedger->read (keylet::account (stpTrans->getAccountID (sfDestination)));
-        if (accountSLE->getFieldU32 (sfDividendLedger) == dividendLedger)
-        {
-            if (lastTxn == item.key ())
-            {
-                setDividendState(DividendMaster::DivType_Done);
-                JLOG(journal.debug) << "Dividend job, finish last txn " << lastTxn;
-                break;
-            }
-            JLOG(journal.trace) << "Dividend job, account: "<< stpTrans->getAccountID (sfDestination) << " dividend ledger: " << accountSLE->getFieldU32 (sfDividendLedger);
-            JLOG(journal.trace) << "Dividend job, "<< passes << " pass applied transaction " << item.key ();
-            passes++;
-            continue;
-        }
         try
         {
-            shots--;
-            lastTxn = item.key ();
-            stpTrans->sign(naAccountPrivate);
-            JLOG(journal.debug) << "Dividend job, submit tx " << lastTxn << " with signed tx id " << stpTrans->getTransactionID();
-            app_.getOPs ().submitTransaction (stpTrans);
-
+            m_history.onLedgerAccepted (*ledger);
         }
-        catch (std::runtime_error& e)
+        catch (std::exception const& e)
         {
-            JLOG(journal.debug) << "Duplicate transaction applied" << e.what ();
+            JLOG (m_journal.error) << "Dividend history update failed: " << e.what ();
         }
-    }
-    JLOG(journal.info) << "Dividend job, ends submit, passes " << passes << ", dividend state " << getDividendState();
-}
-
-static inline uint64_t adjust (uint64_t coin)
-{
-    return coin >= 10000000000 ? coin + 90000000000 : coin * 10;
-}
-
-void DividendMasterImpl::calcDividend (uint64_t dividendCoins, uint64_t dividendCoinsVBC, uint64_t& actualTotalDividend, uint64_t& actualTotalDividendVBC, uint64_t& sumVRank, uint64_t& sumVSpd)
-{
-    auto& accountsOut = m_divResult;
-    accountsOut.clear ();
-    const auto& accountsByBalance = m_accountsByBalance;
-    const auto& accountsGraph = m_accountsGraph;
 
-    if (accountsByBalance.empty () && num_edges (accountsGraph) == 0)
-    {
-        actualTotalDividend = 0;
-        actualTotalDividendVBC = 0;
-        sumVRank = 0;
-        sumVSpd = 0;
-        return;
-    }
-
-    // traverse accountsByBalance to caculate V ranking into VRank in accountsByReference
-    sumVRank = 0;
-    {
-        uint64_t lastBalance = 0;
-        uint32_t pos = 1, rank = 1;
-        for (auto it = accountsByBalance.begin (); it != accountsByBalance.end (); ++pos, ++it)
+        if (m_progress.onLedgerAccepted (*ledger))
         {
-            if (lastBalance < it->first)
+            app_.getOPs ().pubDividend ([this]()
             {
-                rank = pos;
-                lastBalance = it->first;
-            }
-            it->second->vRank = rank;
-            sumVRank += rank;
+                return m_progress.getJson ();
+            });
         }
-        m_dividendVRank = sumVRank;
     }
-    JLOG (m_journal.info) << "calcDividend got v rank total: " << sumVRank << " Mem " << memUsed ();
 
-
-    // traverse accountsTree to caculate V spreading into VSpd
-    sumVSpd = 0;
+    /// @return the incremental dividend index, nullptr if disabled.
+    DividendIndex* getIndex ()
     {
-        Visitor::VertexFunc startVertex = [&](AccountData::Vertex vertex, const AccountData::Graph& accountsGraph)
-        {
-            JLOG (m_journal.info) << "Got root node " << accountsGraph[vertex].data->account << " Mem " << memUsed ();
-        };
-        Visitor::VertexFunc finishVertex = [&](AccountData::Vertex vertex, const AccountData::Graph& accountsGraph)
+        std::call_once (m_indexFlag, [this]()
         {
-            auto& accountData = *accountsGraph[vertex].data;
-
-            if (accountData.vSprd != 0)
-            {
-                // Qualified for vSprd calc
-                if (accountData.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
-                {
-                    accountData.vSprd = accountData.vSprd - adjust (accountData.maxChildHolding) + static_cast<uint64_t> (pow (accountData.maxChildHolding / SYSTEM_CURRENCY_PARTS_VBC, 1.0 / 3) * SYSTEM_CURRENCY_PARTS_VBC);
-                    sumVSpd += accountData.vSprd;
-                }
-            }
+            auto const& section = app_.config ()[ConfigSection::dividendAccount ()];
+            // Only servers launching the dividend or serving
+            // account_referrals need the index.
+            if ((!m_signer.enabled () ||
+                 !get<bool> (section, "incremental", true)) &&
+                !get<bool> (section, "referrals", false))
+                return;
+            m_index = std::make_unique<DividendIndex> (app_, m_journal);
+        });
+        return m_index.get ();
+    }
 
-            auto& t = accountData.tSprd;
+private:
+    /** The unsigned transaction map of the last calculated dividend. */
+    std::shared_ptr<SHAMap> makeTransactionMap (std::uint32_t ledgerIndex);
 
-            t += accountData.vbc;
+    Application& app_;
+    beast::Journal m_journal;
 
-            if (accountData.parent == boost::graph_traits<AccountData::Graph>::null_vertex ())
-                return;
+    AccountsDividend m_divResult;
+    SHAMapHash m_resultHash;
+    uint64_t m_dividendTotalCoins;
+    uint64_t m_dividendTotalCoinsVBC;
+    uint64_t m_dividendVRank;
+    uint64_t m_dividendVSprd;
+    int m_dividendState = DivType_Start;
+    
+    DividendEngine m_engine;
+    DividendSigner m_signer;
+    DividendSubmitter m_submitter;
+    DividendProgress m_progress;
+    DividendHistory m_history;
 
-            auto& parentData = *accountsGraph[accountData.parent].data;
+    /// Results of the last calculation when they are spilled to disk.
+    std::unique_ptr<DividendResultFile> m_resultFile;
 
-            parentData.tSprd += t;
-            if (parentData.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
-            {
-                parentData.vSprd += adjust (t);
+    std::once_flag m_indexFlag;
+    std::unique_ptr<DividendIndex> m_index;
+};
 
-                if (parentData.maxChildHolding < t)
-                    parentData.maxChildHolding = t;
-            }
-        };
-        boost::depth_first_search (accountsGraph, boost::visitor (Visitor (startVertex, finishVertex)));
-        m_dividendVSprd = sumVSpd;
-    }
-    JLOG (m_journal.info) << "calcDividend got v spread total: " << sumVSpd << " Mem " << memUsed ();
-
-    // traverse accountsByReference to calc dividend
-    //accountsOut.reserve(m_accounts.size()+1);
-    actualTotalDividend = 0; actualTotalDividendVBC = 0;
-    uint64_t totalDivVBCbyRank = dividendCoinsVBC / 2;
-    uint64_t totalDivVBCbyPower = dividendCoinsVBC - totalDivVBCbyRank;
-    for (const auto& it : m_accounts) {
-        uint64_t divVBC = 0;
-        auto accountPtr = it.second;
-        boost::multiprecision::uint128_t divVBCbyRank(0), divVBCbyPower(0);
-        if (dividendCoinsVBC > 0 && sumVSpd > 0 && sumVRank > 0) {
-            divVBCbyRank = totalDivVBCbyRank;
-            divVBCbyRank *= accountPtr->vRank;
-            divVBCbyRank /= sumVRank;
-            divVBCbyPower = totalDivVBCbyPower;
-            divVBCbyPower *= accountPtr->vSprd;
-            divVBCbyPower /= sumVSpd;
-            divVBC = static_cast<uint64_t>(divVBCbyRank + divVBCbyPower);
-            if (divVBC < VBC_DIVIDEND_MIN) {
-                divVBC = 0;
-                divVBCbyRank = 0;
-                divVBCbyPower = 0;
-            }
-            actualTotalDividendVBC += divVBC;
-        }
-        uint64_t div = 0;
-        if (dividendCoins > 0 && (dividendCoinsVBC == 0 || divVBC >= VBC_DIVIDEND_MIN)) {
-            div = accountPtr->vbc * VRP_INCREASE_RATE / VRP_INCREASE_RATE_PARTS;
-            actualTotalDividend += div;
-        }
-        
-        JLOG (m_journal.info) << "{\"account\":\"" << accountPtr->account << "\",\"data\":{\"divVBCByRank\":\"" << divVBCbyRank << "\",\"divVBCByPower\":\"" << divVBCbyPower << "\",\"divVBC\":\"" << divVBC << "\",\"divVRP\":\"" << div << "\",\"balance\":\"" << accountPtr->vbc << "\",\"vrank\":\"" << accountPtr->vRank << "\",\"vsprd\":\"" << accountPtr->vSprd << "\",\"tsprd\":\"" << accountPtr->tSprd << "\"}}";
-        
-        if (div !=0 || divVBC !=0 || accountPtr->vSprd > MIN_VSPD_TO_GET_FEE_SHARE)
-        {
-            //accountsOut.push_back(std::make_tuple(accountPtr->account, div, divVBC, static_cast<uint64_t>(divVBCbyRank), static_cast<uint64_t>(divVBCbyPower), accountPtr->vRank, accountPtr->vSprd, accountPtr->tSprd));
-            
-            std::pair<AccountsDividend::iterator, bool> ret = accountsOut.emplace(std::piecewise_construct, 
-                        std::forward_as_tuple(accountPtr->account), 
-                        std::forward_as_tuple(div, divVBC, static_cast<uint64_t>(divVBCbyRank), 
-                            static_cast<uint64_t>(divVBCbyPower), accountPtr->vRank, 
-                            accountPtr->vSprd, accountPtr->tSprd));
-            if (ret.second == false)
-            {
-                JLOG (m_journal.warning) << "Insert same account: " << accountPtr->account << "into dividend account map!";
-            }
-        }
+void DividendMasterImpl::getMissingTxns ()
+{
+    if (app_.getOPs ().isNeedNetworkLedger ())
+    {
+        return;
     }
     
-    JLOG (m_journal.info) << "calcDividend got actualTotalDividend " << actualTotalDividend << " actualTotalDividendVBC " << actualTotalDividendVBC << " Mem " << memUsed();
-    
-    // collect remainning
-    uint64_t remainCoins = 0, remainCoinsVBC = 0;
-    if (dividendCoins > actualTotalDividend) {
-        remainCoins = dividendCoins - actualTotalDividend;
-        actualTotalDividend = dividendCoins;
-    }
-    if (dividendCoinsVBC > actualTotalDividendVBC) {
-        remainCoinsVBC = dividendCoinsVBC - actualTotalDividendVBC;
-        actualTotalDividendVBC = dividendCoinsVBC;
-    }
-    if (remainCoins > 0 || remainCoinsVBC > 0)
+    auto const& curLedger = app_.getLedgerMaster ().getCurrentLedger ();
+    auto const& dividendObj = curLedger->read (keylet::dividend ());
+    if (!dividendObj)
+        return;
+
+    if (!m_signer.enabled ())
+        return;
+
+    JLOG(m_journal.info) << "Dividend job, begin submit, dividend state " << getDividendState();
+    if (getDividendState() == DividendMaster::DivType_Start &&
+        m_submitter.submit (*curLedger, *dividendObj))
     {
-        //accountsOut.push_back (std::make_tuple (from_hex_text<AccountID> ("0x56CE5173B6A2CBEDF203BD69159212094C651041"), remainCoins, remainCoinsVBC, 0, 0, 0, 0, 0));
-        AccountsDividend::iterator spec = accountsOut.find (from_hex_text<AccountID> ("0x56CE5173B6A2CBEDF203BD69159212094C651041"));
-        if (spec != accountsOut.end())
-        {
-            std::get<0> (spec->second) += remainCoins;
-            std::get<1> (spec->second) += remainCoinsVBC;
-        }
-        else
-        {
-            accountsOut.emplace(std::piecewise_construct, 
-                std::forward_as_tuple(from_hex_text<AccountID> ("0x56CE5173B6A2CBEDF203BD69159212094C651041")), 
-                std::forward_as_tuple(remainCoins, remainCoinsVBC, 0, 0, 0, 0, 0));
-        }
+        setDividendState(DividendMaster::DivType_Done);
     }
-
-    JLOG (m_journal.info) << "calcDividend done with " << accountsOut.size() << " accounts Mem " << memUsed();
+    JLOG(m_journal.info) << "Dividend job, ends submit, dividend state " << getDividendState();
 }
 
 std::pair<bool, Json::Value> 
@@ -614,6 +362,12 @@ DividendMasterImpl::checkDividend (const uint32_t ledgerIndex, const std::string
 {
     Json::Value jvResult;
     SHAMapHash fullHash (from_hex_text<uint256>(hash));
+
+    // Only the first request for a dividend reads the ledger, later ones
+    // are answered from the counters kept by onLedgerAccepted.
+    if (m_progress.tracking (ledgerIndex, fullHash))
+        return std::pair<bool, Json::Value> (true, m_progress.getJson ());
+
     std::shared_ptr<SHAMap> fullDivMap = std::make_shared<SHAMap> (
         SHAMapType::TRANSACTION,
         fullHash.as_uint256(),
@@ -637,40 +391,27 @@ DividendMasterImpl::checkDividend (const uint32_t ledgerIndex, const std::string
         jvResult[jss::error_message] = "can not fetch dividend full map root hash";
         return std::pair<bool, Json::Value> (false, jvResult);
     }
-    JLOG(m_journal.info) << "check dividend start";
-    auto ledger = app_.getLedgerMaster ().getCurrentLedger ();
-    uint32 txnDone = 0;
-    uint32 txnLeft = 0;
-    for (auto item = fullDivMap->begin (); item != fullDivMap->end (); ++item)
+
+    auto ledger = app_.getLedgerMaster ().getValidatedLedger ();
+    if (!ledger)
     {
-        auto sitTrans = SerialIter{item->data (), item->size ()};
-        std::shared_ptr<STTx> stpTrans = std::make_shared<STTx> (std::ref (sitTrans));
-        auto accountSLE = ledger->read (keylet::account (stpTrans->getAccountID (sfDestination)));
-        if (accountSLE->getFieldU32 (sfDividendLedger) == ledgerIndex)
-        {
-            // dividend is in progress
-            JLOG(m_journal.trace) << "dividend in progress txn " << stpTrans->getTransactionID();
-            txnDone++;
-        }
-        else
-        {
-            txnLeft++;
-        }
+        jvResult[jss::error_message] = "no validated ledger";
+        return std::pair<bool, Json::Value> (false, jvResult);
     }
-    jvResult ["done"] = txnDone;
-    jvResult ["left"] = txnLeft;
 
-    return std::pair<bool, Json::Value> (true, jvResult);
+    JLOG(m_journal.info) << "check dividend start";
+    m_progress.track (ledgerIndex, *fullDivMap, *ledger);
+
+    return std::pair<bool, Json::Value> (true, m_progress.getJson ());
 }
 
 bool DividendMasterImpl::launchDividend (const uint32_t ledgerIndex)
 {
-    std::string secret_key = get<std::string> (app_.config ()[ConfigSection::dividendAccount ()], "secret_key");
-
-    RippleAddress secret = RippleAddress::createSeedGeneric (secret_key);
-    RippleAddress generator = RippleAddress::createGeneratorPublic (secret);
-    RippleAddress naAccountPrivate = RippleAddress::createAccountPrivate (generator, secret, 0);
-    RippleAddress accountPublic = RippleAddress::createAccountPublic (generator, 0);
+    if (!m_signer.enabled ())
+    {
+        JLOG(m_journal.warning) << "Launch dividend, no dividend secret key configured";
+        return false;
+    }
 
     std::shared_ptr<STTx> trans = std::make_shared<STTx> (ttDIVIDEND);
     trans->setFieldU8 (sfDividendType, DividendMaster::DivType_Start);
@@ -683,9 +424,9 @@ bool DividendMasterImpl::launchDividend (const uint32_t ledgerIndex)
     trans->setFieldU64 (sfDividendVRank, m_dividendVRank);
     trans->setFieldU64 (sfDividendVSprd, m_dividendVSprd);
     trans->setFieldH256 (sfDividendHash, getResultHash().as_uint256());
-    trans->setFieldVL (sfSigningPubKey, accountPublic.getAccountPublic ());
+    trans->setFieldVL (sfSigningPubKey, m_signer.publicKey ());
 
-    trans->sign (naAccountPrivate);
+    m_signer.sign (*trans);
 
     app_.getJobQueue ().addJob (
         jtTRANSACTION, "launchDividend",
@@ -697,63 +438,50 @@ bool DividendMasterImpl::launchDividend (const uint32_t ledgerIndex)
     return true;
 }
 
-bool DividendMasterImpl::dumpTransactionMap(const uint32_t ledgerIndex, const std::string& hash)
+std::shared_ptr<SHAMap>
+DividendMasterImpl::makeTransactionMap (std::uint32_t ledgerIndex)
 {
-    bool doSave = !hash.empty ();
-
-    std::string secret_key = get<std::string> (app_.config ()[ConfigSection::dividendAccount ()], "secret_key");
-    RippleAddress secret = RippleAddress::createSeedGeneric (secret_key);
-    RippleAddress generator = RippleAddress::createGeneratorPublic (secret);
-    RippleAddress naAccountPrivate = RippleAddress::createAccountPrivate (generator, secret, 0);
-    RippleAddress accountPublic = RippleAddress::createAccountPublic (generator, 0);
-
-    std::shared_ptr<SHAMap> divUnsignedMap = std::make_shared<SHAMap> (
-        SHAMapType::TRANSACTION,
-        app_.family ());
+    std::vector<AccountsDividend::const_iterator> divs;
+    if (!m_resultFile)
+    {
+        divs.reserve (m_divResult.size ());
+        for (auto it = m_divResult.cbegin (); it != m_divResult.cend (); ++it)
+            divs.push_back (it);
+    }
+    auto const count = m_resultFile ? m_resultFile->size () : divs.size ();
 
-    for (auto const& div : m_divResult)
+    auto makeItem = [&](std::size_t i)
     {
-        // make transaction
-        STTx trans (ttDIVIDEND);
-        trans.setFieldU8 (sfDividendType, DividendMaster::DivType_Apply);
-        trans.setFieldU32 (sfDividendLedger, ledgerIndex);
-        trans.setFieldU32 (sfFlags, tfFullyCanonicalSig);
-        trans.setAccountID (sfAccount, AccountID ());
-        
-        trans.setAccountID (sfDestination, div.first);
-        trans.setFieldU64 (sfDividendCoins, std::get<0> (div.second));
-        trans.setFieldU64 (sfDividendCoinsVBC, std::get<1> (div.second));
-        trans.setFieldU64 (sfDividendCoinsVBCRank, std::get<2> (div.second));
-        trans.setFieldU64 (sfDividendCoinsVBCSprd, std::get<3> (div.second));
-        trans.setFieldU64 (sfDividendVRank, std::get<4> (div.second));
-        trans.setFieldU64 (sfDividendVSprd, std::get<5> (div.second));
-        trans.setFieldU64 (sfDividendTSprd, std::get<6> (div.second));
-        trans.setFieldVL (sfSigningPubKey, accountPublic.getAccountPublic ());
-
-        uint256 txID = trans.getHash(HashPrefix::transactionID);
-        Serializer s;
-        trans.add (s);
-        auto tItem = std::make_shared<SHAMapItem> (txID, s.peekData ());
-
-        if (!divUnsignedMap->addGiveItem (tItem, true, false))
+        if (m_resultFile)
         {
-            if (m_journal.fatal)
-            {
-                m_journal.fatal << "Add transaction hash " << txID
-                                << " to transaction unsigned map hash failed.";
-            }
-            return false;
-        }
-        else
-        {
-            if (m_journal.trace)
-            {
-                m_journal.trace << "Add transaction hash " << txID
-                                << " to transaction unsigned map hash.";
-                m_journal.trace << trans.STObject::getJson (0);
-            }
+            return DividendEngine::makeItem (m_resultFile->account (i),
+                m_resultFile->result (i), ledgerIndex,
+                    m_signer.publicKey (), m_journal);
         }
+        return DividendEngine::makeItem (divs[i]->first, divs[i]->second,
+            ledgerIndex, m_signer.publicKey (), m_journal);
+    };
+
+    return DividendEngine::makeMap (
+        count, makeItem, app_.family (), m_journal);
+}
+
+bool DividendMasterImpl::dumpTransactionMap(const uint32_t ledgerIndex, const std::string& hash)
+{
+    bool doSave = !hash.empty ();
+
+    std::vector<AccountsDividend::const_iterator> divs;
+    if (!m_resultFile)
+    {
+        divs.reserve (m_divResult.size ());
+        for (auto it = m_divResult.cbegin (); it != m_divResult.cend (); ++it)
+            divs.push_back (it);
     }
+    auto const count = m_resultFile ? m_resultFile->size () : divs.size ();
+
+    auto const divUnsignedMap = makeTransactionMap (ledgerIndex);
+    if (!divUnsignedMap)
+        return false;
     
     setResultHash (divUnsignedMap->getHash ());
 
@@ -765,15 +493,98 @@ bool DividendMasterImpl::dumpTransactionMap(const uint32_t ledgerIndex, const st
         JLOG(m_journal.info) << "Transaction full map hash is " << divUnsignedMap->getHash ();
         
         if (to_string (getResultHash ()) != hash)
+        {
+            JLOG (m_journal.warning) << "Dividend map hash mismatch, "
+                "load_dividend with verify lists the differing accounts.";
             return false;
+        }
         
         // flush full hashmap to nodestore
         divUnsignedMap->flushDirty (hotTRANSACTION_NODE, 0);
         setResultHash (divUnsignedMap->getHash ());
+
+        try
+        {
+            m_history.save (ledgerIndex, count, [&](std::size_t i)
+            {
+                if (m_resultFile)
+                {
+                    return std::make_pair (m_resultFile->account (i),
+                        m_resultFile->result (i));
+                }
+                return std::make_pair (divs[i]->first, divs[i]->second);
+            });
+        }
+        catch (std::exception const& e)
+        {
+            // The results come from the validated ledgers as well.
+            JLOG (m_journal.warning) << "Dividend history not saved: " << e.what ();
+        }
     }
     return true;
 }
 
+std::pair<bool, Json::Value>
+DividendMasterImpl::verifyTransactionMap (std::uint32_t ledgerIndex,
+    std::string const& hash, std::size_t limit)
+{
+    Json::Value jvResult;
+    uint256 theirHash;
+    if (!theirHash.SetHex (hash))
+    {
+        jvResult[jss::error_message] = "invalid dividend hash";
+        return std::make_pair (false, jvResult);
+    }
+
+    auto const ours = makeTransactionMap (ledgerIndex);
+    if (!ours)
+    {
+        jvResult[jss::error_message] = "can not build dividend map";
+        return std::make_pair (false, jvResult);
+    }
+    jvResult[jss::hash] = to_string (ours->getHash ());
+    if (ours->getHash ().as_uint256 () == theirHash)
+    {
+        jvResult[jss::mismatch] = Json::objectValue;
+        jvResult[jss::mismatch][jss::accounts] = Json::arrayValue;
+        jvResult[jss::mismatch][jss::complete] = true;
+        return std::make_pair (true, jvResult);
+    }
+
+    // Only the nodes below the branches which differ are read
+    auto const theirs = std::make_shared<SHAMap> (
+        SHAMapType::TRANSACTION, theirHash, app_.family ());
+    if (!theirs->fetchRoot (SHAMapHash (theirHash), nullptr))
+    {
+        jvResult[jss::error_message] = "can not fetch dividend full map root hash";
+        return std::make_pair (false, jvResult);
+    }
+    theirs->setImmutable ();
+
+    try
+    {
+        jvResult[jss::mismatch] =
+            DividendEngine::compareMaps (*ours, *theirs, limit);
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        jvResult[jss::error_message] =
+            std::string ("dividend full map is incomplete: ") + e.what ();
+        return std::make_pair (false, jvResult);
+    }
+
+    auto const& accounts = jvResult[jss::mismatch][jss::accounts];
+    JLOG (m_journal.warning) << "Dividend map " << ours->getHash ()
+        << " differs from " << hash << " in " << accounts.size ()
+        << " accounts";
+    if (m_journal.info)
+    {
+        for (auto const& account : accounts)
+            m_journal.info << "Dividend mismatch: " << to_string (account);
+    }
+    return std::make_pair (true, jvResult);
+}
+
 std::unique_ptr<DividendMaster>
 make_DividendMaster(Application& app, beast::Journal journal)
 {
@@ -0,0 +1,66 @@
+#ifndef RIPPLE_APP_MISC_FEESHARESETTLEMENT_H_INCLUDED
+#define RIPPLE_APP_MISC_FEESHARESETTLEMENT_H_INCLUDED
+
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/shamap/SHAMap.h>
+#include <beast/utility/Journal.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace ripple {
+
+/** Settling the fee shares accrued with FeeShareAccrual.
+
+    Transactions record the shares they owe referees as FeeShareAccruals
+    in their metadata, and the FeeShareAccrual entry holds the last ledger
+    whose accruals were credited. Every validator sums the accruals of the
+    ledgers after it, up to the last closed ledger and at most maxLedgers
+    of them, and proposes one FeeShareSettle crediting the totals. They
+    all read the same ledgers, so they propose the same transaction.
+*/
+namespace FeeShareSettlement {
+
+std::uint32_t const maxLedgers = 32;
+
+/** Returns the closed ledger with a sequence, or nullptr. */
+using LedgerLoader = std::function<
+    std::shared_ptr<ReadView const> (std::uint32_t seq)>;
+
+/** Returns true if the shares are sorted by account and then by issue,
+    each listed once with a positive amount which is not native.
+*/
+bool
+isCanonical (STArray const& takers);
+
+/** Adds the accruals of a ledger's transactions to the totals. */
+void
+addAccruals (ReadView const& ledger, STArray& totals);
+
+/** Returns the settlement of the ledgers after the last settled one.
+
+    No settlement is built before the first accrual, while the ledgers
+    after the last settled one accrued nothing unless they are maxLedgers,
+    nor if one of the ledgers can't be loaded.
+*/
+boost::optional<STTx>
+build (ReadView const& lastClosedLedger, LedgerLoader const& load,
+    beast::Journal j);
+
+/** Returns the pseudo-transaction crediting the shares. */
+STTx
+makeTx (std::uint32_t settledThrough, STArray const& takers);
+
+/** Add a FeeShareSettle of the accrued shares to a position. */
+void
+addToPosition (ReadView const& lastClosedLedger, LedgerLoader const& load,
+    std::shared_ptr<SHAMap> const& initialPosition, beast::Journal j);
+
+} // FeeShareSettlement
+
+} // ripple
+
+#endif
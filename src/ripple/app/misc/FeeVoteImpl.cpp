@@ -227,7 +227,7 @@ FeeVoteImpl::doVoting (Ledger::ref lastClosedLedger,
         Serializer s;
         trans.add (s);
 
-        auto tItem = std::make_shared<SHAMapItem> (txID, s.peekData ());
+        auto tItem = make_shamapitem (txID, s.peekData ());
 
         if (!initialPosition->addGiveItem (tItem, true, false))
         {
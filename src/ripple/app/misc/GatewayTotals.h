@@ -0,0 +1,102 @@
+#ifndef RIPPLE_APP_MISC_GATEWAYTOTALS_H_INCLUDED
+#define RIPPLE_APP_MISC_GATEWAYTOTALS_H_INCLUDED
+
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/STAmount.h>
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+namespace ripple {
+
+/** The balances gateway_balances reports for recently queried issuers.
+
+    The first query for an issuer on the last validated ledger scans its
+    trust lines. From then on the totals follow the changed trust lines in
+    the metadata of each validated ledger, and queries on the newest one
+    are answered without a scan. An issuer not queried for a while is
+    dropped, and all of them are when a validated ledger does not follow
+    the last one.
+*/
+class GatewayTotals
+{
+public:
+    struct Totals
+    {
+        // What the issuer owes, for each currency
+        std::map<Currency, STAmount> obligations;
+
+        // The lines the issuer owes on, for each currency
+        std::map<Currency, std::size_t> lines;
+
+        // What accounts owe the issuer, for each account and currency
+        std::map<AccountID, std::map<Currency, STAmount>> assets;
+    };
+
+    /** Create the totals.
+
+        @param issuers The most issuers followed.
+        @param idle The ledgers after which an issuer not queried is
+                    dropped.
+    */
+    GatewayTotals (std::size_t issuers, LedgerIndex idle);
+
+    GatewayTotals (GatewayTotals const&) = delete;
+    GatewayTotals& operator= (GatewayTotals const&) = delete;
+
+    /** Returns the totals of an issuer by scanning its trust lines. */
+    static
+    Totals
+    scan (ReadView const& ledger, AccountID const& issuer);
+
+    /** Returns the totals of an issuer in a validated ledger.
+
+        If the ledger is the last one added, the issuer is followed from
+        then on.
+    */
+    Totals
+    get (ReadView const& ledger, AccountID const& issuer);
+
+    /** Apply the trust line changes of a validated ledger. */
+    void
+    addLedger (AcceptedLedger const& ledger);
+
+    /** Returns the number of issuers followed. */
+    std::size_t
+    size () const;
+
+private:
+    struct Issuer
+    {
+        Totals totals;
+        LedgerIndex used;
+    };
+
+    // Add or remove the balance of a line, as seen by the issuer
+    static
+    void
+    apply (Totals& totals, AccountID const& peer, STAmount const& balance,
+        bool add);
+
+    // Apply the change of a trust line in a transaction's metadata
+    void
+    change (STObject const& node);
+
+    std::size_t const maxIssuers_;
+    LedgerIndex const idle_;
+
+    std::mutex mutable mutex_;
+    hash_map<AccountID, Issuer> issuers_;
+
+    // The last ledger added
+    LedgerIndex seq_ = 0;
+    uint256 hash_;
+};
+
+} // ripple
+
+#endif
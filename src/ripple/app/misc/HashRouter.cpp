@@ -19,53 +19,127 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/misc/HashRouter.h>
+#include <algorithm>
 
 namespace ripple {
 
+HashRouter::HashRouter (Stopwatch& clock,
+        std::chrono::seconds entryHoldTimeInSeconds)
+    : mClock (clock)
+    , mHoldTime (entryHoldTimeInSeconds)
+{
+    // Entries last used in one second are due together, a hold time later
+    auto const now = seconds (mClock.now ());
+    for (auto& shard : mShards)
+    {
+        shard.wheel.resize (mHoldTime.count () + 2);
+        shard.next = now - mHoldTime.count ();
+    }
+}
+
+std::int64_t
+HashRouter::seconds (Stopwatch::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::seconds> (
+        t.time_since_epoch ()).count ();
+}
+
+std::vector<uint256>&
+HashRouter::slot (Shard& shard, std::int64_t second)
+{
+    std::int64_t const size = shard.wheel.size ();
+    return shard.wheel[((second % size) + size) % size];
+}
+
+void
+HashRouter::expire (Shard& shard, Stopwatch::time_point now)
+{
+    auto const limit = seconds (now) - mHoldTime.count ();
+    std::int64_t const size = shard.wheel.size ();
+
+    // After a long pause every slot is due once
+    if (limit - shard.next >= size)
+        shard.next = limit - size + 1;
+
+    std::vector<uint256> due;
+    for (; shard.next <= limit; ++shard.next)
+    {
+        auto& keys = slot (shard, shard.next);
+        if (keys.empty ())
+            continue;
+
+        due.clear ();
+        due.swap (keys);
+        for (auto const& key : due)
+        {
+            auto const iter = shard.entries.find (key);
+            if (iter == shard.entries.end ())
+                continue;
+
+            auto const touched = iter->second.touched ();
+            if (touched <= now - mHoldTime)
+                shard.entries.erase (iter);
+            else
+                slot (shard, std::max (seconds (touched), limit + 1)).
+                    push_back (key);
+        }
+    }
+}
+
 auto
-HashRouter::emplace (uint256 const& key)
+HashRouter::emplace (Shard& shard, uint256 const& key)
     -> std::pair<Entry&, bool>
 {
-    auto iter = mSuppressionMap.find (key);
+    auto const now = mClock.now ();
+    auto iter = shard.entries.find (key);
 
-    if (iter != mSuppressionMap.end ())
+    if (iter != shard.entries.end ())
     {
-        mSuppressionMap.touch(iter);
+        auto& entry = iter->second;
+        // An entry due but not yet erased is gone
+        bool const expired = entry.touched () <= now - mHoldTime;
+        if (expired)
+            entry.reset (now);
+        else
+            entry.touch (now);
         return std::make_pair(
-            std::ref(iter->second), false);
+            std::ref(entry), expired);
     }
 
     // See if any supressions need to be expired
-    expire(mSuppressionMap,
-        mHoldTime);
+    expire (shard, now);
 
+    slot (shard, seconds (now)).push_back (key);
     return std::make_pair(std::ref(
-        mSuppressionMap.emplace (
-            key, Entry ()).first->second),
+        shard.entries.emplace (
+            key, Entry (now)).first->second),
                 true);
 }
 
 void HashRouter::addSuppression (uint256 const& key)
 {
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& s = shard (key);
+    std::lock_guard <std::mutex> lock (s.mutex);
 
-    emplace (key);
+    emplace (s, key);
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer)
 {
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& s = shard (key);
+    std::lock_guard <std::mutex> lock (s.mutex);
 
-    auto result = emplace(key);
+    auto result = emplace(s, key);
     result.first.addPeer(peer);
     return result.second;
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer, int& flags)
 {
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& shard = this->shard (key);
+    std::lock_guard <std::mutex> lock (shard.mutex);
 
-    auto result = emplace(key);
+    auto result = emplace(shard, key);
     auto& s = result.first;
     s.addPeer (peer);
     flags = s.getFlags ();
@@ -74,18 +148,20 @@ bool HashRouter::addSuppressionPeer (uint256 const& key, PeerShortID peer, int&
 
 int HashRouter::getFlags (uint256 const& key)
 {
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& s = shard (key);
+    std::lock_guard <std::mutex> lock (s.mutex);
 
-    return emplace(key).first.getFlags ();
+    return emplace(s, key).first.getFlags ();
 }
 
 bool HashRouter::setFlags (uint256 const& key, int flags)
 {
     assert (flags != 0);
 
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& shard = this->shard (key);
+    std::lock_guard <std::mutex> lock (shard.mutex);
 
-    auto& s = emplace(key).first;
+    auto& s = emplace(shard, key).first;
 
     if ((s.getFlags () & flags) == flags)
         return false;
@@ -96,9 +172,10 @@ bool HashRouter::setFlags (uint256 const& key, int flags)
 
 bool HashRouter::swapSet (uint256 const& key, std::set<PeerShortID>& peers, int flag)
 {
-    std::lock_guard <std::mutex> lock (mMutex);
+    auto& shard = this->shard (key);
+    std::lock_guard <std::mutex> lock (shard.mutex);
 
-    auto& s = emplace(key).first;
+    auto& s = emplace(shard, key).first;
 
     if ((s.getFlags () & flag) == flag)
         return false;
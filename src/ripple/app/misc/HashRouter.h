@@ -23,8 +23,14 @@
 #include <ripple/basics/base_uint.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/ShardedTaggedCache.h>
 #include <ripple/basics/UnorderedContainers.h>
-#include <beast/container/aged_unordered_map.h>
+#include <boost/container/flat_set.hpp>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace ripple {
 
@@ -48,6 +54,11 @@ namespace ripple {
     This table keeps track of which hashes have been received by which peers.
     It is used to manage the routing and broadcasting of messages in the peer
     to peer overlay.
+
+    The table is split in shards by hash, each with its own lock. An entry
+    expires once it has not been used for the hold time. Each shard files
+    its entries in a wheel by the second they were last used, and entries
+    are erased when a wheel slot comes due and they are still unused.
 */
 class HashRouter
 {
@@ -63,16 +74,12 @@ private:
     public:
         static char const* getCountedObjectName () { return "HashRouterEntry"; }
 
-        Entry ()
+        explicit Entry (Stopwatch::time_point now)
             : flags_ (0)
+            , touched_ (now)
         {
         }
 
-        std::set <PeerShortID> const& peekPeers () const
-        {
-            return peers_;
-        }
-
         void addPeer (PeerShortID peer)
         {
             if (peer != 0)
@@ -106,14 +113,56 @@ private:
 
         void swapSet (std::set <PeerShortID>& other)
         {
-            peers_.swap (other);
+            std::set <PeerShortID> peers (peers_.begin (), peers_.end ());
+            peers_ = PeerSet (boost::container::ordered_unique_range,
+                other.begin (), other.end ());
+            other.swap (peers);
+        }
+
+        Stopwatch::time_point touched () const
+        {
+            return touched_;
+        }
+
+        void touch (Stopwatch::time_point now)
+        {
+            touched_ = now;
+        }
+
+        // Start over as a new entry
+        void reset (Stopwatch::time_point now)
+        {
+            flags_ = 0;
+            peers_.clear ();
+            touched_ = now;
         }
 
     private:
+        // Most hashes come from a handful of peers, so they are kept
+        // sorted in one block rather than a node each
+        using PeerSet = boost::container::flat_set <PeerShortID>;
+
         int flags_;
-        std::set <PeerShortID> peers_;
+        PeerSet peers_;
+        Stopwatch::time_point touched_;
     };
 
+    struct Shard
+    {
+        std::mutex mutex;
+        hardened_hash_map <uint256, Entry> entries;
+
+        // The hashes filed by the second their entry was last used, at
+        // that second modulo the size of the wheel. An entry is filed
+        // once, and filed again when its slot comes due and it is in use.
+        std::vector <std::vector <uint256>> wheel;
+
+        // The next second whose slot is due
+        std::int64_t next;
+    };
+
+    static std::size_t const shardCount = 16;
+
 public:
     static inline std::chrono::seconds getDefaultHoldTime ()
     {
@@ -122,11 +171,7 @@ public:
         return 300s;
     }
 
-    HashRouter (Stopwatch& clock, std::chrono::seconds entryHoldTimeInSeconds)
-        : mSuppressionMap(clock)
-        , mHoldTime (entryHoldTimeInSeconds)
-    {
-    }
+    HashRouter (Stopwatch& clock, std::chrono::seconds entryHoldTimeInSeconds);
 
     HashRouter& operator= (HashRouter const&) = delete;
 
@@ -152,16 +197,27 @@ public:
     bool swapSet (uint256 const& key, std::set<PeerShortID>& peers, int flag);
 
 private:
+    static std::int64_t seconds (Stopwatch::time_point t);
+
+    // The wheel slot of the entries last used in this second
+    static std::vector<uint256>& slot (Shard& shard, std::int64_t second);
+
+    Shard& shard (uint256 const& key)
+    {
+        return mShards[KeyBitsShardSelector () (key) % shardCount];
+    }
+
     // pair.second indicates whether the entry was created
-    std::pair<Entry&, bool> emplace (uint256 const&);
+    std::pair<Entry&, bool> emplace (Shard& shard, uint256 const& key);
 
-    std::mutex mutable mMutex;
+    // Erase the entries whose slots are due and which are still unused
+    void expire (Shard& shard, Stopwatch::time_point now);
 
-    // Stores all suppressed hashes and their expiration time
-    beast::aged_unordered_map<uint256, Entry, Stopwatch::clock_type,
-        hardened_hash<strong_hash>> mSuppressionMap;
+    Stopwatch& mClock;
 
     std::chrono::seconds const mHoldTime;
+
+    std::array <Shard, shardCount> mShards;
 };
 
 } // ripple
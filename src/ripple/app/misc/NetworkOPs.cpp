@@ -33,11 +33,21 @@
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/TransactionMaster.h>
+#include <ripple/app/ledger/impl/LedgerSaver.h>
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/main/LocalCredentials.h>
+#include <ripple/app/misc/AccountSubscriptions.h>
+#include <ripple/app/misc/AccountTxCache.h>
+#include <ripple/app/misc/BinaryStream.h>
+#include <ripple/app/misc/BookPageCache.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/app/misc/GatewayTotals.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/TxQ.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <ripple/app/misc/TxVerifier.h>
 #include <ripple/app/misc/Validations.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/impl/AccountTxPaging.h>
@@ -49,9 +59,11 @@
 #include <ripple/protocol/digest.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/UptimeTimer.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/LoadFeeTrack.h>
+#include <ripple/core/ThreadPools.h>
 #include <ripple/core/TimeKeeper.h>
 #include <ripple/crypto/RandomNumbers.h>
 #include <ripple/crypto/RFC1751.h>
@@ -195,12 +207,26 @@ public:
         , m_clusterTimer (this)
         , mConsensus (make_Consensus (app_.config(), app_.logs()))
         , m_ledgerMaster (ledgerMaster)
+        , accountSubs_ (
+            [this](std::function<void ()> drain)
+            {
+                m_job_queue.addJob (jtCLIENT, "AccountSubs.drain",
+                    [drain](Job&) { drain (); });
+            }, 4096)
         , mLastLoadBase (256)
         , mLastLoadFactor (256)
+        , mLastFeeLevel (0)
         , m_job_queue (job_queue)
         , m_standalone (standalone)
         , m_network_quorum (start_valid ? 0 : network_quorum)
         , accounting_ ()
+        , accountTxCache_ (
+            get<std::size_t> (app.config().section (
+                ConfigSection::transactionDatabase ()), "cache_accounts", 4096),
+            get<std::size_t> (app.config().section (
+                ConfigSection::transactionDatabase ()), "cache_depth", 20))
+        , bookPages_ (4, 1024)
+        , gatewayTotals_ (64, 1024)
     {
     }
 
@@ -361,20 +387,35 @@ public:
     {
         return m_localTX->size ();
     }
+    AccountSubscriptions const& getAccountSubscriptions () const override
+    {
+        return accountSubs_;
+    }
+
+    AccountTxCache const& getAccountTxCache () const override
+    {
+        return accountTxCache_;
+    }
+    GatewayTotals& getGatewayTotals () override
+    {
+        return gatewayTotals_;
+    }
 
     //Helper function to generate SQL query to get transactions.
     std::string transactionsSQL (
         std::string selection, AccountID const& account,
         std::int32_t minLedger, std::int32_t maxLedger,
         bool descending, std::uint32_t offset, int limit,
-        bool binary, bool count, bool bUnlimited);
+        bool binary, bool count, bool bUnlimited,
+        Json::Value& marker, std::uint32_t& pageLength);
 
     // Client information retrieval functions.
     using NetworkOPs::AccountTxs;
     AccountTxs getAccountTxs (
         AccountID const& account,
         std::int32_t minLedger, std::int32_t maxLedger, bool descending,
-        std::uint32_t offset, int limit, bool bUnlimited) override;
+        std::uint32_t offset, int limit, bool bUnlimited,
+        Json::Value& marker) override;
 
     AccountTxs getTxsAccount (
         AccountID const& account, std::int32_t minLedger,
@@ -388,7 +429,7 @@ public:
     getAccountTxsB (
         AccountID const& account, std::int32_t minLedger,
         std::int32_t maxLedger,  bool descending, std::uint32_t offset,
-        int limit, bool bUnlimited) override;
+        int limit, bool bUnlimited, Json::Value& marker) override;
 
     MetaTxsList
     getTxsAccountB (
@@ -446,6 +487,13 @@ public:
     bool unsubPeerStatus (std::uint64_t uListener) override;
     void pubPeerStatus (std::function<Json::Value(void)> const&) override;
 
+    bool subDividend (InfoSub::ref ispListener) override;
+    bool unsubDividend (std::uint64_t uListener) override;
+    void pubDividend (std::function<Json::Value(void)> const&) override;
+
+    bool subFee (InfoSub::ref ispListener, Json::Value& jvResult) override;
+    bool unsubFee (std::uint64_t uListener) override;
+
     InfoSub::pointer findRpcSub (std::string const& strUrl) override;
     InfoSub::pointer addRpcSub (
         std::string const& strUrl, InfoSub::ref) override;
@@ -486,13 +534,13 @@ private:
         bool isAccepted);
 
     void pubServer ();
+    void pubFee (bool force);
     void pubValidation (STValidation::ref val);
 
     std::string getHostId (bool forAdmin);
 
 private:
     using SubMapType = hash_map <std::uint64_t, InfoSub::wptr>;
-    using SubInfoMapType = hash_map <AccountID, SubMapType>;
     using subRpcMapType = hash_map<std::string, InfoSub::pointer>;
 
     // XXX Split into more locks.
@@ -520,8 +568,8 @@ private:
     LedgerMaster& m_ledgerMaster;
     InboundLedger::pointer mAcquiringLedger;
 
-    SubInfoMapType mSubAccount;
-    SubInfoMapType mSubRTAccount;
+    // The accounts streams, sent by jobs
+    AccountSubscriptions accountSubs_;
 
     subRpcMapType mRpcSubMap;
 
@@ -531,9 +579,12 @@ private:
     SubMapType mSubRTTransactions;    // All proposed and accepted transactions.
     SubMapType mSubValidations;       // Received validations.
     SubMapType mSubPeerStatus;        // peer status changes
+    SubMapType mSubDividend;          // Dividend progress changes.
+    SubMapType mSubFee;               // Fee levels and queue changes.
 
     std::uint32_t mLastLoadBase;
     std::uint32_t mLastLoadFactor;
+    std::uint64_t mLastFeeLevel;
 
     JobQueue& m_job_queue;
 
@@ -550,6 +601,15 @@ private:
     std::vector <TransactionStatus> mTransactions;
 
     StateAccounting accounting_;
+
+    // The newest transactions of hot accounts, for account_tx
+    AccountTxCache accountTxCache_;
+
+    // The book pages of recent closed ledgers, for book_offers
+    BookPageCache bookPages_;
+
+    // The balances of issuers queried lately, for gateway_balances
+    GatewayTotals gatewayTotals_;
 };
 
 //------------------------------------------------------------------------------
@@ -742,6 +802,7 @@ void NetworkOPsImp::submitTransaction (std::shared_ptr<STTx const> const& iTrans
     auto const trans = sterilize(*iTrans);
 
     auto const txid = trans->getTransactionID ();
+    app_.getTxTrace ().mark (txid, TxTrace::Phase::received);
     auto const flags = app_.getHashRouter().getFlags(txid);
 
     if ((flags & SF_RETRY) != 0)
@@ -756,43 +817,30 @@ void NetworkOPsImp::submitTransaction (std::shared_ptr<STTx const> const& iTrans
         return;
     }
 
-    try
-    {
-        auto const validity = checkValidity(
-            app_.getHashRouter(), *trans,
-                m_ledgerMaster.getValidatedRules(),
-                    app_.config());
-
-        if (validity.first != Validity::Valid)
+    // The signature is checked along with other transactions'
+    app_.getTxVerifier().verify(trans,
+        [this, trans] (Validity validity, std::string const& reason)
         {
-            JLOG(m_journal.warning) <<
-                "Submitted transaction invalid: " <<
-                validity.second;
-            return;
-        }
-    }
-    catch (std::exception const&)
-    {
-        JLOG(m_journal.warning) << "Exception checking transaction" << txid;
-
-        return;
-    }
-
-    std::string reason;
-
-    auto tx = std::make_shared<Transaction> (
-        trans, reason, app_);
+            if (validity != Validity::Valid)
+            {
+                JLOG(m_journal.warning) <<
+                    "Submitted transaction invalid: " << reason;
+                return;
+            }
 
-    m_job_queue.addJob (jtTRANSACTION, "submitTxn", [this, tx] (Job&) {
-        auto t = tx;
-        processTransaction(t, false, false, FailHard::no);
-    });
+            std::string unused;
+            auto tx = std::make_shared<Transaction> (
+                trans, unused, app_);
+            processTransaction(tx, false, false, FailHard::no);
+        });
 }
 
 void NetworkOPsImp::processTransaction (std::shared_ptr<Transaction>& transaction,
         bool bUnlimited, bool bLocal, FailHard failType)
 {
     auto ev = m_job_queue.getLoadEventAP (jtTXN_PROC, "ProcessTXN");
+    // Transactions submitted by RPC are received here
+    app_.getTxTrace ().mark (transaction->getID (), TxTrace::Phase::received);
     auto const newFlags = app_.getHashRouter ().getFlags (transaction->getID ());
 
     if ((newFlags & SF_BAD) != 0)
@@ -825,6 +873,8 @@ void NetworkOPsImp::processTransaction (std::shared_ptr<Transaction>& transactio
         return;
     }
 
+    app_.getTxTrace ().mark (transaction->getID (), TxTrace::Phase::checked);
+
     // canonicalize can change our pointer
     app_.getMasterTransaction ().canonicalize (&transaction);
 
@@ -946,6 +996,8 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
         {
             if (e.applied)
             {
+                app_.getTxTrace ().mark (e.transaction->getID (),
+                    TxTrace::Phase::applied);
                 pubProposedTransaction (newOL,
                     e.transaction->getSTransaction(), e.result);
             }
@@ -1034,14 +1086,14 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
                     tx.set_receivetimestamp (app_.timeKeeper().now().time_since_epoch().count());
                     tx.set_deferred(e.result == terQUEUED);
                     // FIXME: This should be when we received it
-                    app_.overlay().foreach (send_if_not (
-                        std::make_shared<Message> (tx, protocol::mtTRANSACTION),
-                        peer_in_set(peers)));
+                    app_.overlay().relay (tx, peers);
                 }
             }
         }
     }
 
+    pubFee (false);
+
     batchLock.lock();
 
     for (TransactionStatus& e : transactions)
@@ -1369,7 +1421,7 @@ void NetworkOPsImp::switchLastClosedLedger (
         // Apply tx in old open ledger to new
         // open ledger. Then apply local tx.
 
-        auto retries = m_localTX->getTxSet();
+        auto retries = *m_localTX->getTxSet();
         auto const lastVal =
             app_.getLedgerMaster().getValidatedLedger();
         boost::optional<Rules> rules;
@@ -1577,8 +1629,7 @@ void NetworkOPsImp::pubServer ()
         jvObj [jss::load_factor]   =
                 (mLastLoadFactor = app_.getFeeTrack ().getLoadFactor ());
 
-        std::string sObj = to_string (jvObj);
-
+        SharedMessage const message (jvObj, "serverStatus");
 
         for (auto i = mSubServer.begin (); i != mSubServer.end (); )
         {
@@ -1589,7 +1640,7 @@ void NetworkOPsImp::pubServer ()
             //             sending of JSON data.
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                p->send (jvObj, message, true);
                 ++i;
             }
             else
@@ -1600,6 +1651,49 @@ void NetworkOPsImp::pubServer ()
     }
 }
 
+void NetworkOPsImp::pubFee (bool force)
+{
+    ScopedLockType sl (mSubLock);
+
+    if (mSubFee.empty ())
+        return;
+
+    auto& txQ = app_.getTxQ ();
+    auto const view = app_.openLedger ().current ();
+    auto const feeLevel = txQ.getMetrics (*view).expFeeLevel;
+
+    // Between ledgers only publish when the open ledger's
+    // fee level rose or fell by half since it was published
+    if (! force && mLastFeeLevel != 0 &&
+        feeLevel < mLastFeeLevel + mLastFeeLevel / 2 &&
+        feeLevel > mLastFeeLevel / 2)
+        return;
+    mLastFeeLevel = feeLevel;
+
+    Json::Value jvObj (txQ.doRPC (app_));
+
+    jvObj [jss::type]                 = "feeStatus";
+    jvObj [jss::ledger_current_index] = view->info ().seq;
+    jvObj [jss::load_base]            = app_.getFeeTrack ().getLoadBase ();
+    jvObj [jss::load_factor]          = app_.getFeeTrack ().getLoadFactor ();
+
+    SharedMessage const message (jvObj, "feeStatus");
+
+    for (auto i = mSubFee.begin (); i != mSubFee.end (); )
+    {
+        InfoSub::pointer p = i->second.lock ();
+
+        if (p)
+        {
+            p->send (jvObj, message, true);
+            ++i;
+        }
+        else
+        {
+            i = mSubFee.erase (i);
+        }
+    }
+}
 
 void NetworkOPsImp::pubValidation (STValidation::ref val)
 {
@@ -1615,13 +1709,15 @@ void NetworkOPsImp::pubValidation (STValidation::ref val)
         jvObj [jss::ledger_hash]           = to_string (val->getLedgerHash ());
         jvObj [jss::signature]             = strHex (val->getSignature ());
 
+        SharedMessage const message (jvObj);
+
         for (auto i = mSubValidations.begin (); i != mSubValidations.end (); )
         {
             InfoSub::pointer p = i->second.lock ();
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (jvObj, message, true);
                 ++i;
             }
             else
@@ -1643,13 +1739,15 @@ void NetworkOPsImp::pubPeerStatus (
 
         jvObj [jss::type]                  = "peerStatusChange";
 
+        SharedMessage const message (jvObj);
+
         for (auto i = mSubPeerStatus.begin (); i != mSubPeerStatus.end (); )
         {
             InfoSub::pointer p = i->second.lock ();
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (jvObj, message, true);
                 ++i;
             }
             else
@@ -1660,6 +1758,36 @@ void NetworkOPsImp::pubPeerStatus (
     }
 }
 
+void NetworkOPsImp::pubDividend (
+    std::function<Json::Value(void)> const& func)
+{
+    ScopedLockType sl (mSubLock);
+
+    if (!mSubDividend.empty ())
+    {
+        Json::Value jvObj (func());
+
+        jvObj [jss::type]                  = "dividendProgress";
+
+        SharedMessage const message (jvObj, "dividendProgress");
+
+        for (auto i = mSubDividend.begin (); i != mSubDividend.end (); )
+        {
+            InfoSub::pointer p = i->second.lock ();
+
+            if (p)
+            {
+                p->send (jvObj, message, true);
+                ++i;
+            }
+            else
+            {
+                i = mSubDividend.erase (i);
+            }
+        }
+    }
+}
+
 void NetworkOPsImp::setMode (OperatingMode om)
 {
     if (om == omCONNECTED)
@@ -1693,7 +1821,8 @@ NetworkOPsImp::transactionsSQL (
     std::string selection, AccountID const& account,
     std::int32_t minLedger, std::int32_t maxLedger, bool descending,
     std::uint32_t offset, int limit,
-    bool binary, bool count, bool bUnlimited)
+    bool binary, bool count, bool bUnlimited,
+    Json::Value& marker, std::uint32_t& pageLength)
 {
     std::uint32_t NONBINARY_PAGE_LENGTH = 200;
     std::uint32_t BINARY_PAGE_LENGTH = 500;
@@ -1719,6 +1848,37 @@ NetworkOPsImp::transactionsSQL (
         numberOfResults = limit;
     }
 
+    // The marker is the first row of the page. It replaces the offset, so
+    // a deep page costs no more than the first.
+    std::uint32_t findLedger = 0, findSeq = 0;
+    if (marker.isObject () &&
+        marker.isMember (jss::ledger) && marker.isMember (jss::seq))
+    {
+        findLedger = marker[jss::ledger].asUInt ();
+        findSeq = marker[jss::seq].asUInt ();
+    }
+    marker = Json::nullValue;
+
+    std::string keyClause = "";
+
+    if (findLedger != 0)
+    {
+        offset = 0;
+        keyClause = boost::str (boost::format (descending ?
+            "AND AccountTransactions.LedgerSeq <= '%u' AND "
+            "(AccountTransactions.LedgerSeq < '%u' OR "
+            "AccountTransactions.TxnSeq <= '%u')" :
+            "AND AccountTransactions.LedgerSeq >= '%u' AND "
+            "(AccountTransactions.LedgerSeq > '%u' OR "
+            "AccountTransactions.TxnSeq >= '%u')")
+            % findLedger % findLedger % findSeq);
+    }
+
+    // One more row than the page gives the marker of the next page
+    pageLength = numberOfResults;
+    if (!count)
+        ++numberOfResults;
+
     std::string maxClause = "";
     std::string minClause = "";
 
@@ -1734,39 +1894,53 @@ NetworkOPsImp::transactionsSQL (
             "AND AccountTransactions.LedgerSeq >= '%u'") % minLedger);
     }
 
+    // Until the migration completes the base58 rows are queried
+    auto const schema = app_.getAccountTxMigrator ().getSchema ();
     std::string sql;
 
     if (count)
         sql =
             boost::str (boost::format (
-                "SELECT %s FROM AccountTransactions "
-                "WHERE Account = '%s' %s %s LIMIT %u, %u;")
+                "SELECT %s FROM %s "
+                "WHERE Account = %s %s %s %s LIMIT %u, %u;")
             % selection
-            % app_.accountIDCache().toBase58(account)
+            % accountTxTable (schema)
+            % accountTxLiteral (schema, app_.accountIDCache(), account)
             % maxClause
             % minClause
+            % keyClause
             % beast::lexicalCastThrow <std::string> (offset)
             % beast::lexicalCastThrow <std::string> (numberOfResults)
         );
     else
         sql =
             boost::str (boost::format (
+                // The page is found in the account index first, so only
+                // its rows are joined to Transactions
                 "SELECT %s FROM "
-                "AccountTransactions INNER JOIN Transactions "
-                "ON Transactions.TransID = AccountTransactions.TransID "
-                "WHERE Account = '%s' %s %s "
+                "(SELECT LedgerSeq, TxnSeq, TransID FROM %s "
+                "WHERE Account = %s %s %s %s "
                 "ORDER BY AccountTransactions.LedgerSeq %s, "
                 "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s "
-                "LIMIT %u, %u;")
+                "LIMIT %u, %u) AS AccountTransactions "
+                "INNER JOIN Transactions ON %s "
+                "ORDER BY AccountTransactions.LedgerSeq %s, "
+                "AccountTransactions.TxnSeq %s, AccountTransactions.TransID %s;")
                     % selection
-                    % app_.accountIDCache().toBase58(account)
+                    % accountTxTable (schema)
+                    % accountTxLiteral (schema, app_.accountIDCache(), account)
                     % maxClause
                     % minClause
+                    % keyClause
                     % (descending ? "DESC" : "ASC")
                     % (descending ? "DESC" : "ASC")
                     % (descending ? "DESC" : "ASC")
                     % beast::lexicalCastThrow <std::string> (offset)
                     % beast::lexicalCastThrow <std::string> (numberOfResults)
+                    % accountTxJoin (schema)
+                    % (descending ? "DESC" : "ASC")
+                    % (descending ? "DESC" : "ASC")
+                    % (descending ? "DESC" : "ASC")
                    );
     m_journal.trace << "txSQL query: " << sql;
     return sql;
@@ -1775,21 +1949,24 @@ NetworkOPsImp::transactionsSQL (
 NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
     AccountID const& account,
     std::int32_t minLedger, std::int32_t maxLedger, bool descending,
-    std::uint32_t offset, int limit, bool bUnlimited)
+    std::uint32_t offset, int limit, bool bUnlimited, Json::Value& marker)
 {
     // can be called with no locks
     AccountTxs ret;
 
+    std::uint32_t pageLength;
     std::string sql = transactionsSQL (
-        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
+        "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
+        "Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, false, false,
-        bUnlimited);
+        bUnlimited, marker, pageLength);
 
     {
         bool isMySQL = app_.getTxnDB ().getType () == DatabaseCon::Type::MySQL;
-        auto db = app_.getTxnDB ().checkoutDb ();
+        auto db = app_.getTxnDB ().checkoutReadDb ();
 
         boost::optional<std::uint64_t> ledgerSeq;
+        boost::optional<std::uint32_t> txnSeq;
         boost::optional<std::string> status;
         boost::optional<std::string> sociTxnStr, sociTxnMetaStr;
         std::unique_ptr<soci::blob> sociTxnBlob (isMySQL ? nullptr : new soci::blob (*db)),
@@ -1801,18 +1978,30 @@ NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
             isMySQL ?
                 (db->prepare << sql,
                  soci::into(ledgerSeq),
+                 soci::into(txnSeq),
                  soci::into(status),
                  soci::into(sociTxnStr, rti),
                  soci::into(sociTxnMetaStr, tmi)):
                 (db->prepare << sql,
                  soci::into(ledgerSeq),
+                 soci::into(txnSeq),
                  soci::into(status),
                  soci::into(*sociTxnBlob, rti),
                  soci::into(*sociTxnMetaBlob, tmi));
 
+        std::uint32_t found = 0;
         st.execute ();
         while (st.fetch ())
         {
+            if (found++ == pageLength)
+            {
+                marker = Json::objectValue;
+                marker[jss::ledger] = rangeCheckedCast<std::uint32_t>(
+                    ledgerSeq.value_or (0));
+                marker[jss::seq] = txnSeq.value_or (0);
+                break;
+            }
+
             if (soci::i_ok == rti)
             {
                 if (isMySQL)
@@ -1860,20 +2049,23 @@ NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
 std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
     AccountID const& account,
     std::int32_t minLedger, std::int32_t maxLedger, bool descending,
-    std::uint32_t offset, int limit, bool bUnlimited)
+    std::uint32_t offset, int limit, bool bUnlimited, Json::Value& marker)
 {
     // can be called with no locks
     std::vector<txnMetaLedgerType> ret;
 
+    std::uint32_t pageLength;
     std::string sql = transactionsSQL (
-        "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
+        "AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,"
+        "Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, true/*binary*/, false,
-        bUnlimited);
+        bUnlimited, marker, pageLength);
 
     {
-        auto db = app_.getTxnDB ().checkoutDb ();
+        auto db = app_.getTxnDB ().checkoutReadDb ();
 
         boost::optional<std::uint64_t> ledgerSeq;
+        boost::optional<std::uint32_t> txnSeq;
         boost::optional<std::string> status;
         soci::blob sociTxnBlob (*db), sociTxnMetaBlob (*db);
         soci::indicator rti, tmi;
@@ -1881,13 +2073,24 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
         soci::statement st =
                 (db->prepare << sql,
                  soci::into(ledgerSeq),
+                 soci::into(txnSeq),
                  soci::into(status),
                  soci::into(sociTxnBlob, rti),
                  soci::into(sociTxnMetaBlob, tmi));
 
+        std::uint32_t found = 0;
         st.execute ();
         while (st.fetch ())
         {
+            if (found++ == pageLength)
+            {
+                marker = Json::objectValue;
+                marker[jss::ledger] = rangeCheckedCast<std::uint32_t>(
+                    ledgerSeq.value_or (0));
+                marker[jss::seq] = txnSeq.value_or (0);
+                break;
+            }
+
             Blob rawTxn;
             if (soci::i_ok == rti)
                 convert (sociTxnBlob, rawTxn);
@@ -1927,11 +2130,17 @@ NetworkOPsImp::getTxsAccount (
             ret, ledger_index, status, rawTxn, rawMeta, app);
     };
 
+    // The cache keeps transactions of every type
+    if (txType.empty () && accountTxCache_.page (account, minLedger,
+            maxLedger, forward, token, limit, bUnlimited, page_length, bound))
+        return ret;
+
     accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
         std::bind(saveLedgerAsync, std::ref(app_),
             std::placeholders::_1), bound, account, minLedger,
                 maxLedger, forward, token, limit, bUnlimited,
-                    page_length);
+                    page_length, txType,
+                        app_.getAccountTxMigrator ().getSchema ());
 
     return ret;
 }
@@ -1955,11 +2164,16 @@ NetworkOPsImp::getTxsAccountB (
         ret.emplace_back (strHex(rawTxn), strHex (rawMeta), ledgerIndex);
     };
 
+    if (txType.empty () && accountTxCache_.page (account, minLedger,
+            maxLedger, forward, token, limit, bUnlimited, page_length, bound))
+        return ret;
+
     accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
         std::bind(saveLedgerAsync, std::ref(app_),
             std::placeholders::_1), bound, account, minLedger,
                 maxLedger, forward, token, limit, bUnlimited,
-                    page_length);
+                    page_length, txType,
+                        app_.getAccountTxMigrator ().getSchema ());
     return ret;
 }
 
@@ -2001,6 +2215,8 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
 
     info[jss::io_latency_ms] = static_cast<Json::UInt> (
         app_.getIOLatency().count());
+    info[jss::overlay_io_latency_ms] = static_cast<Json::UInt> (
+        app_.overlay().getIOLatency().count());
 
     if (admin)
     {
@@ -2013,6 +2229,8 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
         {
             info[jss::pubkey_validator] = "none";
         }
+
+        info[jss::threads] = getJson (app_.getThreadPools ());
     }
 
     info[jss::pubkey_node] =
@@ -2030,6 +2248,15 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
     if (fp != 0)
         info[jss::fetch_pack] = Json::UInt (fp);
 
+    if (app_.getTxnDB ().getType () != DatabaseCon::Type::None)
+    {
+        auto& saver = m_ledgerMaster.getLedgerSaver ();
+        info[jss::sql_save_queue] = static_cast<Json::UInt> (
+            saver.getQueueSize ());
+        info[jss::sql_save_lag] = static_cast<Json::UInt> (
+            saver.getLag ().count ());
+    }
+
     info[jss::peers] = Json::UInt (app_.overlay ().size ());
 
     Json::Value lastClose = Json::objectValue;
@@ -2178,6 +2405,8 @@ void NetworkOPsImp::pubProposedTransaction (
     {
         ScopedLockType sl (mSubLock);
 
+        std::unique_ptr<SharedMessage> message;
+
         auto it = mSubRTTransactions.begin ();
         while (it != mSubRTTransactions.end ())
         {
@@ -2185,7 +2414,9 @@ void NetworkOPsImp::pubProposedTransaction (
 
             if (p)
             {
-                p->send (jvObj, true);
+                if (!message)
+                    message = std::make_unique<SharedMessage> (jvObj);
+                p->send (jvObj, *message, true);
                 ++it;
             }
             else
@@ -2243,13 +2474,29 @@ void NetworkOPsImp::pubLedger (Ledger::ref lpAccepted)
                         = app_.getLedgerMaster ().getCompleteLedgers ();
             }
 
+            SharedMessage const message (jvObj, "ledgerClosed");
+            std::unique_ptr<SharedMessage> binary;
+
             auto it = mSubLedger.begin ();
             while (it != mSubLedger.end ())
             {
                 InfoSub::pointer p = it->second.lock ();
                 if (p)
                 {
-                    p->send (jvObj, true);
+                    if (p->getBinary ())
+                    {
+                        if (! binary)
+                            binary = std::make_unique<SharedMessage> (
+                                BinaryStream::makeLedger (lpAccepted->info (),
+                                    lpAccepted->fees (),
+                                        alpAccepted->getTxnCount ()),
+                                            "ledgerClosed");
+                        p->send (*binary, true);
+                    }
+                    else
+                    {
+                        p->send (jvObj, message, true);
+                    }
                     ++it;
                 }
                 else
@@ -2258,6 +2505,32 @@ void NetworkOPsImp::pubLedger (Ledger::ref lpAccepted)
         }
     }
     
+    if (accountTxCache_.enabled ())
+    {
+        std::vector<AccountTxCache::Entry> txs;
+        for (auto const& vt : alpAccepted->getMap ())
+        {
+            // Not saved to the transaction database either
+            if (vt.second->getTxnType () == ttDIVIDEND)
+                continue;
+
+            auto tx = std::make_shared<AccountTxCache::Tx> ();
+            tx->ledgerSeq = lpAccepted->info().seq;
+            tx->txnSeq = vt.second->getTxnSeq ();
+            Serializer s;
+            vt.second->getTxn ()->add (s);
+            tx->rawTxn = s.peekData ();
+            tx->rawMeta = vt.second->getRawMeta ();
+
+            auto const& affected = vt.second->getAffected ();
+            txs.emplace_back (std::move (tx), std::vector<AccountID> (
+                affected.begin (), affected.end ()));
+        }
+        accountTxCache_.addLedger (lpAccepted->info().seq, txs);
+    }
+
+    gatewayTotals_.addLedger (*alpAccepted);
+
     m_journal.info << "start pubAccepted: " << alpAccepted->getMap ().size ();
     // Don't lock since pubAcceptedTransaction is locking.
     for (auto const& vt : alpAccepted->getMap ())
@@ -2267,6 +2540,10 @@ void NetworkOPsImp::pubLedger (Ledger::ref lpAccepted)
         pubValidatedTransaction (lpAccepted, *vt.second);
     }
     m_journal.info << "finish pubAccepted: " << alpAccepted->getMap ().size ();
+
+    app_.getDividendMaster ().onLedgerAccepted (lpAccepted);
+
+    pubFee (true);
 }
 
 void NetworkOPsImp::reportFeeChange ()
@@ -2340,8 +2617,15 @@ void NetworkOPsImp::pubValidatedTransaction (
 {
     Json::Value jvObj;
 
-    std::string sObj;
-    bool bSobjInitialized = false;
+    std::unique_ptr<SharedMessage> message;
+    std::unique_ptr<SharedMessage> binary;
+
+    // Admin subscribers also get the phases of a traced transaction
+    auto& trace = app_.getTxTrace ();
+    trace.mark (alTx.getTransactionID (), TxTrace::Phase::validated);
+    auto const jvTrace = trace.getJson (alTx.getTransactionID ());
+    Json::Value jvTraced;
+    std::unique_ptr<SharedMessage> traced;
 
     {
         ScopedLockType sl (mSubLock);
@@ -2351,15 +2635,37 @@ void NetworkOPsImp::pubValidatedTransaction (
         {
             InfoSub::pointer p = it->second.lock ();
 
-            if (p)
+            if (p && p->getBinary ())
             {
-                if (!bSobjInitialized) {
+                if (! binary)
+                    binary = std::make_unique<SharedMessage> (
+                        BinaryStream::makeTransaction (alAccepted->info (),
+                            *alTx.getTxn (), alTx.getResult (),
+                                alTx.getRawMeta ()));
+                p->send (*binary, true);
+                ++it;
+            }
+            else if (p)
+            {
+                if (!message) {
                     jvObj = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
                     jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
-                    sObj = to_string (jvObj);
-                    bSobjInitialized = true;
+                    message = std::make_unique<SharedMessage> (jvObj);
+                }
+                if (p->getTrace () && ! jvTrace.isNull ())
+                {
+                    if (! traced)
+                    {
+                        jvTraced = jvObj;
+                        jvTraced[jss::trace] = jvTrace;
+                        traced = std::make_unique<SharedMessage> (jvTraced);
+                    }
+                    p->send (jvTraced, *traced, true);
+                }
+                else
+                {
+                    p->send (jvObj, *message, true);
                 }
-                p->send (jvObj, sObj, true);
                 ++it;
             }
             else
@@ -2374,13 +2680,12 @@ void NetworkOPsImp::pubValidatedTransaction (
 
             if (p)
             {
-                if (!bSobjInitialized) {
+                if (!message) {
                     jvObj = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
                     jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
-                    sObj = to_string (jvObj);
-                    bSobjInitialized = true;
+                    message = std::make_unique<SharedMessage> (jvObj);
                 }
-                p->send (jvObj, sObj, true);
+                p->send (jvObj, *message, true);
                 ++it;
             }
             else
@@ -2396,68 +2701,14 @@ void NetworkOPsImp::pubAccountTransaction (
     const AcceptedLedgerTx& alTx,
     bool bAccepted)
 {
-    hash_set<InfoSub::pointer>  notify;
-    int                             iProposed   = 0;
-    int                             iAccepted   = 0;
-
-    {
-        ScopedLockType sl (mSubLock);
-
-        if (!bAccepted && mSubRTAccount.empty ()) return;
-
-        if (!mSubAccount.empty () || (!mSubRTAccount.empty ()) )
-        {
-            for (auto const& affectedAccount: alTx.getAffected ())
-            {
-                auto simiIt
-                        = mSubRTAccount.find (affectedAccount);
-                if (simiIt != mSubRTAccount.end ())
-                {
-                    auto it = simiIt->second.begin ();
-
-                    while (it != simiIt->second.end ())
-                    {
-                        InfoSub::pointer p = it->second.lock ();
-
-                        if (p)
-                        {
-                            notify.insert (p);
-                            ++it;
-                            ++iProposed;
-                        }
-                        else
-                            it = simiIt->second.erase (it);
-                    }
-                }
+    if (accountSubs_.empty (bAccepted))
+        return;
 
-                if (bAccepted)
-                {
-                    simiIt  = mSubAccount.find (affectedAccount);
+    auto const notify = accountSubs_.find (alTx.getAffected (), bAccepted);
 
-                    if (simiIt != mSubAccount.end ())
-                    {
-                        auto it = simiIt->second.begin ();
-                        while (it != simiIt->second.end ())
-                        {
-                            InfoSub::pointer p = it->second.lock ();
-
-                            if (p)
-                            {
-                                notify.insert (p);
-                                ++it;
-                                ++iAccepted;
-                            }
-                            else
-                                it = simiIt->second.erase (it);
-                        }
-                    }
-                }
-            }
-        }
-    }
     m_journal.trace << "pubAccountTransaction:" <<
-        " iProposed=" << iProposed <<
-        " iAccepted=" << iAccepted;
+        " accepted=" << bAccepted <<
+        " subscribers=" << notify.size ();
 
     if (!notify.empty ())
     {
@@ -2467,12 +2718,8 @@ void NetworkOPsImp::pubAccountTransaction (
         if (alTx.isApplied ())
             jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-        std::string sObj = to_string (jvObj);
-
-        for (InfoSub::ref isrListener : notify)
-        {
-            isrListener->send (jvObj, sObj, true);
-        }
+        accountSubs_.publish (notify,
+            std::make_shared<AccountSubscriptions::Event> (std::move (jvObj)));
     }
 }
 
@@ -2484,8 +2731,6 @@ void NetworkOPsImp::subAccount (
     InfoSub::ref isrListener,
     hash_set<AccountID> const& vnaAccountIDs, bool rt)
 {
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
     for (auto const& naAccountID : vnaAccountIDs)
     {
         if (m_journal.trace) m_journal.trace <<
@@ -2494,26 +2739,7 @@ void NetworkOPsImp::subAccount (
         isrListener->insertSubAccountInfo (naAccountID, rt);
     }
 
-    ScopedLockType sl (mSubLock);
-
-    for (auto const& naAccountID : vnaAccountIDs)
-    {
-        auto simIterator = subMap.find (naAccountID);
-        if (simIterator == subMap.end ())
-        {
-            // Not found, note that account has a new single listner.
-            SubMapType  usisElement;
-            usisElement[isrListener->getSeq ()] = isrListener;
-            // VFALCO NOTE This is making a needless copy of naAccountID
-            subMap.insert (simIterator,
-                make_pair(naAccountID, usisElement));
-        }
-        else
-        {
-            // Found, note that the account has another listener.
-            simIterator->second[isrListener->getSeq ()] = isrListener;
-        }
-    }
+    accountSubs_.insert (isrListener, vnaAccountIDs, rt);
 }
 
 void NetworkOPsImp::unsubAccount (
@@ -2536,26 +2762,7 @@ void NetworkOPsImp::unsubAccountInternal (
     hash_set<AccountID> const& vnaAccountIDs,
     bool rt)
 {
-    ScopedLockType sl (mSubLock);
-
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
-    for (auto const& naAccountID : vnaAccountIDs)
-    {
-        auto simIterator = subMap.find (naAccountID);
-
-        if (simIterator != subMap.end ())
-        {
-            // Found
-            simIterator->second.erase (uSeq);
-
-            if (simIterator->second.empty ())
-            {
-                // Don't need hash entry.
-                subMap.erase (simIterator);
-            }
-        }
-    }
+    accountSubs_.erase (uSeq, vnaAccountIDs, rt);
 }
 
 bool NetworkOPsImp::subBook (InfoSub::ref isrListener, Book const& book)
@@ -2715,6 +2922,38 @@ bool NetworkOPsImp::unsubPeerStatus (std::uint64_t uSeq)
     return mSubPeerStatus.erase (uSeq);
 }
 
+// <-- bool: true=added, false=already there
+bool NetworkOPsImp::subDividend (InfoSub::ref isrListener)
+{
+    ScopedLockType sl (mSubLock);
+    return mSubDividend.emplace (isrListener->getSeq (), isrListener).second;
+}
+
+// <-- bool: true=erased, false=was not there
+bool NetworkOPsImp::unsubDividend (std::uint64_t uSeq)
+{
+    ScopedLockType sl (mSubLock);
+    return mSubDividend.erase (uSeq);
+}
+
+// <-- bool: true=added, false=already there
+bool NetworkOPsImp::subFee (InfoSub::ref isrListener, Json::Value& jvResult)
+{
+    auto const fee = app_.getTxQ ().doRPC (app_);
+    for (auto const& name : fee.getMemberNames ())
+        jvResult[name] = fee[name];
+
+    ScopedLockType sl (mSubLock);
+    return mSubFee.emplace (isrListener->getSeq (), isrListener).second;
+}
+
+// <-- bool: true=erased, false=was not there
+bool NetworkOPsImp::unsubFee (std::uint64_t uSeq)
+{
+    ScopedLockType sl (mSubLock);
+    return mSubFee.erase (uSeq);
+}
+
 InfoSub::pointer NetworkOPsImp::findRpcSub (std::string const& strUrl)
 {
     ScopedLockType sl (mSubLock);
@@ -2753,6 +2992,22 @@ void NetworkOPsImp::getBookPage (
     Json::Value const& jvMarker,
     Json::Value& jvResult)
 { // CAUTION: This is the old get book page logic
+    unsigned int left (iLimit == 0 ? 300 : iLimit);
+    if (! bUnlimited && left > 300)
+        left = 300;
+
+    // The pages of a closed ledger never change
+    boost::optional<uint256> pageKey;
+    if (! lpLedger->open ())
+    {
+        pageKey = BookPageCache::key (book, uTakerID == book.out.account, left);
+        if (auto const page = bookPages_.fetch (lpLedger->info ().hash, *pageKey))
+        {
+            jvResult[jss::offers] = *page;
+            return;
+        }
+    }
+
     Json::Value& jvOffers =
             (jvResult[jss::offers] = Json::Value (Json::arrayValue));
 
@@ -2786,10 +3041,6 @@ void NetworkOPsImp::getBookPage (
     auto uTransferRate = rippleTransferRate(view, book.out.account);
     auto viewJ = app_.journal ("View");
 
-    unsigned int left (iLimit == 0 ? 300 : iLimit);
-    if (! bUnlimited && left > 300)
-        left = 300;
-
     while (!bDone && left-- > 0)
     {
         if (bDirectAdvance)
@@ -2958,6 +3209,10 @@ void NetworkOPsImp::getBookPage (
 
     //  jvResult[jss::marker]  = Json::Value(Json::arrayValue);
     //  jvResult[jss::nodes]   = Json::Value(Json::arrayValue);
+
+    if (pageKey)
+        bookPages_.insert (lpLedger->info ().hash, lpLedger->info ().seq,
+            *pageKey, std::make_shared<Json::Value const> (jvOffers));
 }
 
 
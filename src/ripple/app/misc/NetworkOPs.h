@@ -38,6 +38,9 @@ namespace ripple {
 // Operations that clients may wish to perform against the network
 // Master operational handler, server sequencer, network tracker
 
+class AccountSubscriptions;
+class AccountTxCache;
+class GatewayTotals;
 class Peer;
 class LedgerMaster;
 class Transaction;
@@ -197,15 +200,25 @@ public:
 
     virtual void updateLocalTx (Ledger::ref newValidLedger) = 0;
     virtual std::size_t getLocalTxCount () = 0;
+    virtual AccountSubscriptions const& getAccountSubscriptions () const = 0;
+    virtual AccountTxCache const& getAccountTxCache () const = 0;
+    virtual GatewayTotals& getGatewayTotals () = 0;
 
     // client information retrieval functions
     using AccountTx  = std::pair<std::shared_ptr<Transaction>, TxMeta::pointer>;
     using AccountTxs = std::vector<AccountTx>;
 
+    /** The transactions of an account, a page at a time.
+
+        A marker holding the ledger and seq of a row starts the page at
+        that row instead of skipping offset rows. It is set to the first
+        row of the next page, or null after the last page.
+    */
     virtual AccountTxs getAccountTxs (
         AccountID const& account,
         std::int32_t minLedger, std::int32_t maxLedger,  bool descending,
-        std::uint32_t offset, int limit, bool bUnlimited) = 0;
+        std::uint32_t offset, int limit, bool bUnlimited,
+        Json::Value& marker) = 0;
 
     virtual AccountTxs getTxsAccount (
         AccountID const& account,
@@ -217,7 +230,8 @@ public:
 
     virtual MetaTxsList getAccountTxsB (AccountID const& account,
         std::int32_t minLedger, std::int32_t maxLedger,  bool descending,
-            std::uint32_t offset, int limit, bool bUnlimited) = 0;
+            std::uint32_t offset, int limit, bool bUnlimited,
+                Json::Value& marker) = 0;
 
     virtual MetaTxsList getTxsAccountB (AccountID const& account,
         std::int32_t minLedger, std::int32_t maxLedger,  bool forward,
@@ -23,6 +23,7 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/ConfigSections.h>
 #include <boost/format.hpp>
@@ -251,7 +252,7 @@ SHAMapStoreImp::onLedgerClosed (Ledger::pointer validatedLedger)
 }
 
 bool
-SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
+SHAMapStoreImp::copyNode (std::atomic<std::uint64_t>& nodeCount,
         SHAMapAbstractNode const& node)
 {
     // Copy a single record from node to database_
@@ -338,11 +339,13 @@ SHAMapStoreImp::run()
                     ;
             }
 
-            std::uint64_t nodeCount = 0;
+            // The subtrees below the root are copied on several threads
+            std::atomic<std::uint64_t> nodeCount (0);
             validatedLedger_->stateMap().snapShot (
                     false)->visitNodes (
                     std::bind (&SHAMapStoreImp::copyNode, this,
-                    std::ref(nodeCount), std::placeholders::_1));
+                    std::ref(nodeCount), std::placeholders::_1),
+                    setup_.copyThreads);
             journal_.debug << "copied ledger " << validatedSeq
                     << " nodecount " << nodeCount;
             switch (health())
@@ -488,6 +491,8 @@ SHAMapStoreImp::makeBackendRotating (std::string path)
         newPath = boost::filesystem::unique_path (p);
     }
     parameters.set("path", newPath.string());
+    // Names the generation for backends without a local path of their own.
+    parameters.set("generation", newPath.filename().string());
 
     return NodeStore::Manager::instance().make_Backend (parameters, scheduler_,
             nodeStoreJournal_);
@@ -527,14 +532,27 @@ SHAMapStoreImp::clearSql (DatabaseCon& database,
 
     if (journal_.debug) journal_.debug <<
         "start: " << deleteQuery << " from " << min << " to " << lastRotated;
+
+    // Each delete should hold the database no longer than the pause after
+    // it, so the ledgers deleted at a time follow how long it took.
+    using namespace std::chrono;
+    auto const target = milliseconds (std::max<std::uint32_t> (
+        setup_.backOff, 1));
+    std::uint32_t batch = std::max<std::uint32_t> (setup_.deleteBatch, 1);
+    std::uint32_t const maxBatch = batch * 64;
     while (min < lastRotated)
     {
-        min = (min + setup_.deleteBatch >= lastRotated) ? lastRotated :
-            min + setup_.deleteBatch;
+        min = (min + batch >= lastRotated) ? lastRotated : min + batch;
+        auto const start = steady_clock::now ();
         {
             auto db =  database.checkoutDb ();
             *db << boost::str (formattedDeleteQuery % min);
         }
+        auto const elapsed = steady_clock::now () - start;
+        if (elapsed > target)
+            batch = std::max<std::uint32_t> (batch / 2, 1);
+        else if (elapsed < target / 2)
+            batch = std::min (batch * 2, maxBatch);
         if (health())
             return;
         if (min < lastRotated)
@@ -600,11 +618,24 @@ SHAMapStoreImp::clearPrior (LedgerIndex lastRotated)
     if (health())
         return;
 
-    clearSql (*transactionDb_, lastRotated,
-        "SELECT MIN(LedgerSeq) FROM AccountTransactions;",
-        "DELETE FROM AccountTransactions WHERE LedgerSeq < %u;");
-    if (health())
-        return;
+    auto const schema = app_.getAccountTxMigrator ().getSchema ();
+    if (schema != AccountTxMigrator::Schema::binary)
+    {
+        clearSql (*transactionDb_, lastRotated,
+            "SELECT MIN(LedgerSeq) FROM AccountTransactions;",
+            "DELETE FROM AccountTransactions WHERE LedgerSeq < %u;");
+        if (health())
+            return;
+    }
+
+    if (schema != AccountTxMigrator::Schema::legacy)
+    {
+        clearSql (*transactionDb_, lastRotated,
+            "SELECT MIN(LedgerSeq) FROM AccountTxs;",
+            "DELETE FROM AccountTxs WHERE LedgerSeq < %u;");
+        if (health())
+            return;
+    }
 }
 
 SHAMapStoreImp::Health
@@ -697,6 +728,11 @@ setup_SHAMapStore (Config const& c)
     get_if_exists (setup.nodeDatabase, "backOff", setup.backOff);
     get_if_exists (setup.nodeDatabase, "age_threshold", setup.ageThreshold);
 
+    setup.copyThreads = std::max (1u, std::min (4u,
+        std::thread::hardware_concurrency ()));
+    get_if_exists (setup.nodeDatabase, "copy_threads", setup.copyThreads);
+    setup.copyThreads = std::max (1u, std::min (16u, setup.copyThreads));
+
     return setup;
 }
 
@@ -27,6 +27,7 @@
 #include <ripple/nodestore/impl/Tuning.h>
 #include <ripple/nodestore/DatabaseRotating.h>
 #include <iostream>
+#include <atomic>
 #include <condition_variable>
 #include <thread>
 
@@ -90,7 +91,7 @@ private:
     SavedStateDB state_db_;
     std::thread thread_;
     bool stop_ = false;
-    bool healthy_ = true;
+    std::atomic<bool> healthy_ {true};
     mutable std::condition_variable cond_;
     mutable std::mutex mutex_;
     Ledger::pointer newLedger_;
@@ -161,8 +162,9 @@ public:
     void onLedgerClosed (Ledger::pointer validatedLedger) override;
 
 private:
-    // callback for visitNodes
-    bool copyNode (std::uint64_t& nodeCount, SHAMapAbstractNode const &node);
+    // callback for visitNodes, which may be called on several threads
+    bool copyNode (std::atomic<std::uint64_t>& nodeCount,
+        SHAMapAbstractNode const &node);
     void run();
     void dbPaths();
     std::shared_ptr <NodeStore::Backend> makeBackendRotating (
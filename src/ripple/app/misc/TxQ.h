@@ -25,9 +25,11 @@
 #include <ripple/ledger/ApplyView.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/LoadFeeTrack.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/protocol/TER.h>
 #include <ripple/protocol/STTx.h>
 #include <boost/intrusive/set.hpp>
+#include <deque>
 
 namespace ripple {
 
@@ -142,6 +144,12 @@ public:
     {
         std::size_t ledgersInQueue = 20;
         std::uint32_t retrySequencePercent = 125;
+        // Don't preclaim candidates whose account has not changed
+        // since they were last found to be ahead of its sequence.
+        bool skipUnchanged = true;
+        // Dividend transactions applied to each open ledger, in
+        // a lane of their own which does not escalate fees.
+        std::size_t dividendsPerLedger = 1000;
         bool standAlone = false;
     };
 
@@ -155,6 +163,9 @@ public:
         std::uint64_t minFeeLevel;        // Minimum fee level to get in the queue
         std::uint64_t medFeeLevel;        // Median fee level of the last ledger
         std::uint64_t expFeeLevel;        // Estimated fee level to get in next ledger
+        std::size_t dividendsInLedger;  // Dividend transactions in the ledger
+        std::size_t dividendsPerLedger; // Dividend transactions per ledger
+        std::size_t dividendsHeld;      // Dividend transactions waiting
     };
 
     TxQ(Setup const& setup,
@@ -185,6 +196,10 @@ public:
                         Yes: Remove the end item, and add `txn`.
                         No: Reject `txn` with a low fee TER code.
 
+        Dividend transactions skip these steps. They are applied
+        until the open ledger has its quota of them, then held in
+        a lane of their own until the next open ledger.
+
         If the transaction is queued, addTransaction will return
         { TD_held, terQUEUED }
 
@@ -203,6 +218,9 @@ public:
         As we apply more transactions to the ledger, the required
         fee will increase.
 
+        Held dividend transactions are applied first, up to the
+        open ledger's quota of them.
+
         Iterate over the transactions from highest fee to lowest.
         For each transaction, compute the required fee.
         Is the transaction fee is less than the required fee?
@@ -280,6 +298,10 @@ private:
         // construction and replacement without a copy
         // assignment operation.
         boost::optional<PreflightResult const> pfresult;
+        // The account sequence this candidate last failed with
+        // terPRE_SEQ at, or zero if the account did not exist.
+        // Until the account changes, it will fail the same way.
+        boost::optional<TxSeq> retrySeq;
 
     public:
         CandidateTxn(std::shared_ptr<STTx const> const&,
@@ -346,8 +368,11 @@ private:
 
     detail::FeeMetrics feeMetrics_;
     FeeMultiSet byFee_;
-    std::map <AccountID, TxQAccount> byAccount_;
+    hardened_hash_map <AccountID, TxQAccount> byAccount_;
     boost::optional<size_t> maxSize_;
+    // Dividend transactions waiting for room in an open ledger
+    std::deque<std::pair<std::shared_ptr<STTx const>, ApplyFlags>>
+        dividendLane_;
 
     // Most queue operations are done under the master lock,
     // but use this mutex for the RPC "fee" command, which isn't.
@@ -361,6 +386,13 @@ private:
 
     bool canBeHeld(std::shared_ptr<STTx const> const&);
 
+    std::pair<TER, bool>
+    applyDividend(Application& app, OpenView& view,
+        std::shared_ptr<STTx const> const& tx,
+            ApplyFlags flags, beast::Journal j);
+
+    bool acceptDividends(Application& app, OpenView& view);
+
     FeeMultiSet::iterator_type erase(FeeMultiSet::const_iterator_type);
 
 };
@@ -0,0 +1,113 @@
+#ifndef RIPPLE_APP_MISC_TXTRACE_H_INCLUDED
+#define RIPPLE_APP_MISC_TXTRACE_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/core/LatencyWindow.h>
+#include <ripple/json/json_value.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+/** Where a sample of transactions spend their time on the way to SQL.
+
+    One transaction in every `sample_rate` is traced, chosen by its ID so
+    every server traces the same ones. The time it reaches each phase is
+    kept from when it was first received, and the latency of every phase
+    since then goes into a histogram over the last ten minutes.
+
+    A transaction not picked costs one modulo of its ID, so the trace
+    points are free to sit on the hot paths. Transactions first seen in a
+    consensus set are not traced, as they have no time received.
+*/
+class TxTrace
+{
+public:
+    using clock_type = LatencyWindow::clock_type;
+
+    enum class Phase
+    {
+        received,       // submitted, or relayed by a peer
+        checked,        // its signature and validity were checked
+        applied,        // applied to the open ledger
+        closed,         // applied to the ledger built by consensus
+        validated,      // its ledger was validated and published
+        saved           // its ledger was saved to SQL
+    };
+
+    static std::size_t const phaseCount = 6;
+
+    /** The phases reached by one transaction, in microseconds since it
+        was received. A phase not reached is negative.
+    */
+    using Offsets = std::array <std::int64_t, phaseCount>;
+
+    /** Create the trace from the [tx_trace] section. */
+    explicit
+    TxTrace (Section const& section);
+
+    TxTrace (TxTrace const&) = delete;
+    TxTrace& operator= (TxTrace const&) = delete;
+
+    /** Returns true if any transaction is traced. */
+    bool enabled () const
+    {
+        return sampleRate_ != 0;
+    }
+
+    /** Returns true if the transaction with this ID is traced. */
+    bool sampled (uint256 const& id) const;
+
+    /** Record that a transaction reached a phase.
+
+        Only the first time it reaches each phase is kept.
+    */
+    void mark (uint256 const& id, Phase phase,
+        clock_type::time_point now = clock_type::now ());
+
+    /** The phases a traced transaction reached, if it is still kept. */
+    std::unique_ptr <Offsets> find (uint256 const& id) const;
+
+    /** The trace of one transaction, for its validated stream event. */
+    Json::Value getJson (uint256 const& id) const;
+
+    /** The latency percentiles of each phase. */
+    Json::Value getJson () const;
+
+    /** The number of transactions being traced. */
+    std::size_t size () const;
+
+    static char const* getName (Phase phase);
+
+private:
+    struct Entry
+    {
+        clock_type::time_point received;
+        Offsets offsets;
+    };
+
+    // Forget the transactions received too long ago
+    void expire (clock_type::time_point now);
+
+    std::uint64_t const sampleRate_;
+    std::size_t const maxSize_;
+    clock_type::duration const age_;
+
+    std::mutex mutable mutex_;
+    hash_map <uint256, Entry> entries_;
+    // The traced transactions, oldest first
+    std::deque <std::pair <clock_type::time_point, uint256>> order_;
+
+    // Every phase after received
+    std::array <std::unique_ptr <LatencyWindow>, phaseCount> latency_;
+};
+
+} // ripple
+
+#endif
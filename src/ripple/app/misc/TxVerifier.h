@@ -0,0 +1,81 @@
+#ifndef RIPPLE_APP_MISC_TXVERIFIER_H_INCLUDED
+#define RIPPLE_APP_MISC_TXVERIFIER_H_INCLUDED
+
+#include <ripple/app/tx/apply.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/intrusive/List.h>
+#include <beast/module/core/thread/DeadlineTimer.h>
+#include <beast/utility/Journal.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/** Checks the signatures of incoming transactions in batches.
+
+    A transaction waits a few milliseconds for others to arrive, and the
+    ones waiting are then checked together by a job. Batches that fill up
+    before then get a job of their own, so a burst of transactions is
+    checked on several threads. The results are cached in the HashRouter,
+    where later checks of the same transactions find them.
+*/
+class TxVerifier
+    : private beast::DeadlineTimer::Listener
+{
+public:
+    using Handler = std::function<void (Validity, std::string const&)>;
+
+    /** Create the verifier.
+
+        @param window How long a transaction waits for others. With zero,
+                      each transaction is checked on its own.
+    */
+    TxVerifier (Application& app, std::chrono::milliseconds window,
+        beast::Journal journal);
+
+    TxVerifier (TxVerifier const&) = delete;
+    TxVerifier& operator= (TxVerifier const&) = delete;
+
+    /** Check the signature and local checks of a transaction.
+
+        The handler is called from a job once it is checked.
+    */
+    void verify (std::shared_ptr<STTx const> const& tx, Handler handler);
+
+    /** The number of transactions waiting for a batch to be checked. */
+    std::size_t size () const;
+
+private:
+    struct Item
+    {
+        std::shared_ptr<STTx const> tx;
+        Handler handler;
+    };
+
+    void onDeadlineTimer (beast::DeadlineTimer&) override;
+
+    // Hand the waiting transactions to a job
+    void flush (std::lock_guard<std::mutex> const&);
+
+    void check (std::vector<Item> const& items);
+
+    Application& app_;
+    std::chrono::milliseconds const window_;
+    beast::Journal j_;
+
+    std::mutex mutable mutex_;
+    std::vector<Item> pending_;
+    bool timerSet_ = false;
+
+    beast::DeadlineTimer timer_;
+};
+
+} // ripple
+
+#endif
@@ -43,10 +43,17 @@ private:
     using ScopedLockType = std::lock_guard <LockType>;
     using ScopedUnlockType = beast::GenericScopedUnlock <LockType>;
 
+    // The trusted validations of one ledger, tallied as they arrive
+    struct LedgerValidations
+    {
+        ValidationSet validations;
+        int full = 0;
+    };
+
     Application& app_;
     std::mutex mutable mLock;
 
-    TaggedCache<uint256, ValidationSet> mValidations;
+    TaggedCache<uint256, LedgerValidations> mValidations;
     ValidationSet mCurrentValidations;
     ValidationVector mStaleValidations;
 
@@ -54,20 +61,20 @@ private:
     beast::Journal j_;
 
 private:
-    std::shared_ptr<ValidationSet> findCreateSet (uint256 const& ledgerHash)
+    std::shared_ptr<LedgerValidations> findCreateSet (uint256 const& ledgerHash)
     {
         auto j = mValidations.fetch (ledgerHash);
 
         if (!j)
         {
-            j = std::make_shared<ValidationSet> ();
+            j = std::make_shared<LedgerValidations> ();
             mValidations.canonicalize (ledgerHash, j);
         }
 
         return j;
     }
 
-    std::shared_ptr<ValidationSet> findSet (uint256 const& ledgerHash)
+    std::shared_ptr<LedgerValidations> findSet (uint256 const& ledgerHash)
     {
         return mValidations.fetch (ledgerHash);
     }
@@ -105,8 +112,11 @@ private:
         {
             ScopedLockType sl (mLock);
 
-            if (!findCreateSet (hash)->insert (std::make_pair (node, val)).second)
+            auto const set = findCreateSet (hash);
+            if (!set->validations.insert (std::make_pair (node, val)).second)
                 return false;
+            if (val->isFull ())
+                ++set->full;
 
             auto it = mCurrentValidations.find (node);
 
@@ -162,7 +172,7 @@ private:
             auto set = findSet (ledger);
 
             if (set)
-                return *set;
+                return set->validations;
         }
         return ValidationSet ();
     }
@@ -193,9 +203,13 @@ private:
         ScopedLockType sl (mLock);
         auto set = findSet (ledger);
 
-        if (set)
+        if (set && !currentOnly)
         {
-            for (auto& it: *set)
+            trusted = set->validations.size ();
+        }
+        else if (set)
+        {
+            for (auto& it: set->validations)
             {
                 bool isTrusted = it.second->isTrusted ();
 
@@ -223,16 +237,8 @@ private:
 
         if (set)
         {
-            for (auto& it:*set)
-            {
-                if (it.second->isTrusted ())
-                {
-                    if (it.second->isFull ())
-                        ++full;
-                    else
-                        ++partial;
-                }
-            }
+            full = set->full;
+            partial = set->validations.size () - set->full;
         }
 
         JLOG (j_.trace) << "VC: " << ledger << "f:" << full << " p:" << partial;
@@ -241,20 +247,10 @@ private:
 
     int getTrustedValidationCount (uint256 const& ledger) override
     {
-        int trusted = 0;
+        // Only trusted validations are added to a ledger's set
         ScopedLockType sl (mLock);
         auto set = findSet (ledger);
-
-        if (set)
-        {
-            for (auto& it: *set)
-            {
-                if (it.second->isTrusted ())
-                    ++trusted;
-            }
-        }
-
-        return trusted;
+        return set ? set->validations.size () : 0;
     }
 
     std::vector <std::uint64_t>
@@ -265,7 +261,7 @@ private:
         auto const set = findSet (ledger);
         if (set)
         {
-            for (auto const& v : *set)
+            for (auto const& v : set->validations)
             {
                 if (v.second->isTrusted())
                 {
@@ -409,7 +405,7 @@ private:
         std::vector <std::uint32_t> times;
         ScopedLockType sl (mLock);
         if (auto j = findSet (hash))
-            for (auto& it : *j)
+            for (auto& it : j->validations)
                 if (it.second->isTrusted())
                     times.push_back (it.second->getSignTime());
         return times;
@@ -444,6 +440,12 @@ private:
 
     void condWrite ()
     {
+        if (! app_.config ().SAVE_VALIDATIONS)
+        {
+            mStaleValidations.clear ();
+            return;
+        }
+
         if (mWriting)
             return;
 
@@ -456,8 +458,9 @@ private:
     void doWrite ()
     {
         LoadEvent::autoptr event (app_.getJobQueue ().getLoadEventAP (jtDISK, "ValidationWrite"));
-        boost::format insVal ("INSERT INTO Validations "
-                              "(LedgerHash,NodePubKey,SignTime,RawData) VALUES ('%s','%s','%u',%s);");
+        static char const* const sql =
+            "INSERT INTO Validations (LedgerHash,NodePubKey,SignTime,RawData) "
+            "VALUES (:ledgerHash,:nodePubKey,:signTime,:rawData);";
 
         ScopedLockType sl (mLock);
         assert (mWriting);
@@ -473,16 +476,28 @@ private:
                 {
                     auto db = app_.getLedgerDB ().checkoutDb ();
 
+                    // The whole batch is written in one transaction by a
+                    // statement prepared once. soci does not support bulk
+                    // insertion of blob data, so it runs once per row.
+                    std::string ledgerHash;
+                    std::string nodePubKey;
+                    unsigned long long signTime = 0;
+                    soci::blob rawData (*db);
+
                     Serializer s (1024);
                     soci::transaction tr(*db);
-                    for (auto it: vector)
+                    soci::statement st = (db->prepare << sql,
+                        soci::use (ledgerHash), soci::use (nodePubKey),
+                        soci::use (signTime), soci::use (rawData));
+                    for (auto const& it: vector)
                     {
                         s.erase ();
                         it->add (s);
-                        *db << boost::str (
-                            insVal % to_string (it->getLedgerHash ()) %
-                            it->getSignerPublic ().humanNodePublic () %
-                            it->getSignTime () % sqlEscape (s.peekData ()));
+                        ledgerHash = to_string (it->getLedgerHash ());
+                        nodePubKey = it->getSignerPublic ().humanNodePublic ();
+                        signTime = it->getSignTime ();
+                        convert (s.peekData (), rawData);
+                        st.execute (true);
                     }
 
                     tr.commit ();
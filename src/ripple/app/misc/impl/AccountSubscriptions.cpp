@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountSubscriptions.h>
+#include <algorithm>
+
+namespace ripple {
+
+AccountSubscriptions::AccountSubscriptions (
+        Schedule schedule, std::size_t maxQueued)
+    : schedule_ (std::move (schedule))
+    , maxQueued_ (maxQueued)
+{
+}
+
+void
+AccountSubscriptions::insert (InfoSub::ref sub,
+    hash_set<AccountID> const& accounts, bool rt)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    auto& subscriber = subscribers_[sub->getSeq ()];
+    if (! subscriber.queue)
+    {
+        subscriber.queue = std::make_shared<Queue> ();
+        subscriber.queue->sub = sub;
+    }
+
+    auto& index = rt ? realTime_ : normal_;
+    for (auto const& account : accounts)
+    {
+        auto& seqs = index[account];
+        auto const it = std::lower_bound (
+            seqs.begin (), seqs.end (), sub->getSeq ());
+        if (it != seqs.end () && *it == sub->getSeq ())
+            continue;
+
+        seqs.insert (it, sub->getSeq ());
+        ++subscriber.accounts;
+    }
+}
+
+void
+AccountSubscriptions::erase (std::uint64_t seq,
+    hash_set<AccountID> const& accounts, bool rt)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    auto const subscriber = subscribers_.find (seq);
+    if (subscriber == subscribers_.end ())
+        return;
+
+    auto& index = rt ? realTime_ : normal_;
+    for (auto const& account : accounts)
+    {
+        auto const entry = index.find (account);
+        if (entry == index.end ())
+            continue;
+
+        auto& seqs = entry->second;
+        auto const it = std::lower_bound (seqs.begin (), seqs.end (), seq);
+        if (it == seqs.end () || *it != seq)
+            continue;
+
+        seqs.erase (it);
+        if (seqs.empty ())
+            index.erase (entry);
+        --subscriber->second.accounts;
+    }
+
+    // Queued events are still sent by the drain
+    if (subscriber->second.accounts == 0)
+        subscribers_.erase (subscriber);
+}
+
+bool
+AccountSubscriptions::empty (bool accepted) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return realTime_.empty () && (! accepted || normal_.empty ());
+}
+
+void
+AccountSubscriptions::add (Index const& index, AccountID const& account,
+    boost::container::flat_set<std::uint64_t>& seqs) const
+{
+    auto const it = index.find (account);
+    if (it != index.end ())
+        seqs.insert (it->second.begin (), it->second.end ());
+}
+
+void
+AccountSubscriptions::publish (std::vector<InfoSub::pointer> const& subs,
+    std::shared_ptr<Event const> const& event)
+{
+    if (! schedule_)
+    {
+        for (auto const& sub : subs)
+            sub->send (event->json, event->message, true);
+        return;
+    }
+
+    std::vector<std::shared_ptr<Queue>> queues;
+    queues.reserve (subs.size ());
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        for (auto const& sub : subs)
+        {
+            auto const it = subscribers_.find (sub->getSeq ());
+            if (it != subscribers_.end ())
+                queues.push_back (it->second.queue);
+        }
+    }
+
+    std::uint64_t queued = 0;
+    std::uint64_t dropped = 0;
+    for (auto const& queue : queues)
+    {
+        bool start = false;
+        {
+            std::lock_guard<std::mutex> lock (queue->mutex);
+            if (queue->events.size () >= maxQueued_)
+            {
+                ++dropped;
+                continue;
+            }
+
+            queue->events.push_back (event);
+            ++queued;
+            if (! queue->draining)
+                start = queue->draining = true;
+        }
+
+        if (start)
+            schedule_ ([this, queue]() { drain (queue); });
+    }
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    queued_ += queued;
+    dropped_ += dropped;
+}
+
+void
+AccountSubscriptions::drain (std::shared_ptr<Queue> const& queue)
+{
+    for (std::size_t sent = 0; sent < drainBatch; ++sent)
+    {
+        std::shared_ptr<Event const> event;
+        {
+            std::lock_guard<std::mutex> lock (queue->mutex);
+            if (queue->events.empty ())
+            {
+                queue->draining = false;
+                return;
+            }
+            event = std::move (queue->events.front ());
+            queue->events.pop_front ();
+        }
+
+        auto const sub = queue->sub.lock ();
+        if (! sub)
+        {
+            std::lock_guard<std::mutex> lock (queue->mutex);
+            queue->events.clear ();
+            queue->draining = false;
+            return;
+        }
+        sub->send (event->json, event->message, true);
+    }
+
+    // Still draining, the rest goes behind the other jobs
+    schedule_ ([this, queue]() { drain (queue); });
+}
+
+AccountSubscriptions::Stats
+AccountSubscriptions::getStats () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    Stats stats;
+    stats.accounts = normal_.size () + realTime_.size ();
+    stats.subscribers = subscribers_.size ();
+    stats.queued = queued_;
+    stats.dropped = dropped_;
+    return stats;
+}
+
+} // ripple
@@ -0,0 +1,231 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountTxCache.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/protocol/STTx.h>
+#include <algorithm>
+#include <limits>
+
+namespace ripple {
+
+AccountTxCache::AccountTxCache (std::size_t accounts, std::size_t depth)
+    : maxAccounts_ (depth == 0 ? 0 : accounts)
+    , depth_ (depth)
+{
+}
+
+void
+AccountTxCache::addLedger (std::uint32_t seq, std::vector<Entry> const& txs)
+{
+    if (! enabled ())
+        return;
+
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    if (first_ != 0 && seq <= last_)
+        return;
+
+    if (first_ == 0 || seq != last_ + 1)
+    {
+        accounts_.clear ();
+        lru_.clear ();
+        first_ = seq;
+        evicted_ = 0;
+    }
+    last_ = seq;
+
+    for (auto const& entry : txs)
+    {
+        for (auto const& account : entry.second)
+        {
+            auto it = accounts_.find (account);
+            if (it == accounts_.end ())
+            {
+                if (accounts_.size () >= maxAccounts_)
+                    evict ();
+
+                // Any earlier transaction was evicted with the account
+                lru_.push_front (account);
+                it = accounts_.emplace (account, AccountTxs {{},
+                    std::max (first_, evicted_ + 1), lru_.begin ()}).first;
+            }
+            else
+            {
+                lru_.splice (lru_.begin (), lru_, it->second.lru);
+            }
+
+            auto& kept = it->second;
+            kept.txs.push_back (entry.first);
+            if (kept.txs.size () > depth_)
+            {
+                kept.complete = std::max (kept.complete,
+                    kept.txs.front ()->ledgerSeq + 1);
+                kept.txs.pop_front ();
+            }
+        }
+    }
+}
+
+void
+AccountTxCache::evict ()
+{
+    auto const it = accounts_.find (lru_.back ());
+    if (! it->second.txs.empty ())
+        evicted_ = std::max (evicted_, it->second.txs.back ()->ledgerSeq);
+    accounts_.erase (it);
+    lru_.pop_back ();
+}
+
+bool
+AccountTxCache::page (
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool forward,
+    Json::Value& token,
+    int limit,
+    bool bAdmin,
+    std::uint32_t pageLength,
+    OnTransaction const& onTransaction)
+{
+    if (! enabled () || minLedger < 0 || maxLedger < 0)
+        return false;
+
+    std::uint32_t numberOfResults;
+
+    if (limit <= 0 || (limit > pageLength && !bAdmin))
+        numberOfResults = pageLength;
+    else
+        numberOfResults = limit;
+
+    // One more row than the page gives the marker of the next page
+    std::size_t const queryLimit = numberOfResults + 1;
+
+    // The rows between lo and hi, inclusive, as accountTxPage reads them
+    using Key = std::pair<std::uint32_t, std::uint32_t>;
+    Key lo (minLedger, 0);
+    Key hi (maxLedger, std::numeric_limits<std::uint32_t>::max ());
+
+    if (! token.isNull ())
+    {
+        if (! token.isMember (jss::ledger) || ! token.isMember (jss::seq))
+            return false;
+
+        Key const marker (token[jss::ledger].asUInt (),
+            token[jss::seq].asUInt ());
+        if (forward)
+            lo = marker;
+        else
+            hi = marker;
+    }
+
+    std::vector<std::shared_ptr<Tx const>> rows;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+
+        std::uint32_t complete = std::max (first_, evicted_ + 1);
+        auto const it = accounts_.find (account);
+        if (it != accounts_.end ())
+        {
+            auto const& kept = it->second;
+            complete = kept.complete;
+            lru_.splice (lru_.begin (), lru_, kept.lru);
+
+            auto const key = [](std::shared_ptr<Tx const> const& tx)
+            {
+                return Key (tx->ledgerSeq, tx->txnSeq);
+            };
+
+            if (forward)
+            {
+                for (auto iter = kept.txs.begin ();
+                    iter != kept.txs.end () && rows.size () < queryLimit;
+                        ++iter)
+                {
+                    if (key (*iter) < lo)
+                        continue;
+                    if (key (*iter) > hi)
+                        break;
+                    rows.push_back (*iter);
+                }
+            }
+            else
+            {
+                for (auto iter = kept.txs.rbegin ();
+                    iter != kept.txs.rend () && rows.size () < queryLimit;
+                        ++iter)
+                {
+                    if (key (*iter) > hi)
+                        continue;
+                    if (key (*iter) < lo)
+                        break;
+                    rows.push_back (*iter);
+                }
+            }
+        }
+
+        // What is kept of an account is its newest transactions, so a
+        // page from the newest end is known once it is full. Otherwise
+        // every ledger it spans has to be complete.
+        bool const served = first_ != 0 && hi.first <= last_ &&
+            (lo.first >= complete ||
+                (! forward && rows.size () == queryLimit));
+
+        if (! served)
+        {
+            ++misses_;
+            return false;
+        }
+        ++hits_;
+    }
+
+    token = Json::nullValue;
+
+    static std::string const status (1, TXN_SQL_VALIDATED);
+    for (std::size_t i = 0; i < rows.size (); ++i)
+    {
+        auto const& tx = *rows[i];
+        if (i == numberOfResults)
+        {
+            token = Json::objectValue;
+            token[jss::ledger] = tx.ledgerSeq;
+            token[jss::seq] = tx.txnSeq;
+            break;
+        }
+        onTransaction (tx.ledgerSeq, status, tx.rawTxn, tx.rawMeta);
+    }
+
+    return true;
+}
+
+AccountTxCache::Stats
+AccountTxCache::getStats () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.accounts = accounts_.size ();
+    return stats;
+}
+
+} // ripple
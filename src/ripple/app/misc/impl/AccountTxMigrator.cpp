@@ -0,0 +1,349 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/protocol/AccountID.h>
+#include <beast/threads/Thread.h>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ripple {
+
+class AccountTxMigratorImp : public AccountTxMigrator
+{
+    Application& app_;
+    beast::Journal j_;
+
+    // Start the migration when the database has not begun it
+    bool const enabled_;
+
+    // Ledgers copied in one transaction
+    std::uint32_t const chunk_;
+
+    std::atomic<Schema> schema_;
+    std::atomic<std::uint32_t> cursor_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool shouldExit_ = false;
+
+    std::thread thread_;
+
+public:
+    AccountTxMigratorImp (
+        Application& app,
+        Stoppable& stoppable,
+        beast::Journal journal)
+        : AccountTxMigrator (stoppable)
+        , app_ (app)
+        , j_ (journal)
+        , enabled_ (get<bool> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "migrate_account_tx", false))
+        , chunk_ (std::max<std::uint32_t> (1, get<std::uint32_t> (
+            app.config().section (ConfigSection::transactionDatabase ()),
+                "migrate_chunk", 1000)))
+        , schema_ (Schema::legacy)
+        , cursor_ (0)
+    {
+    }
+
+    ~AccountTxMigratorImp () override
+    {
+        if (thread_.joinable())
+            LogicError ("AccountTxMigratorImp::onStop not called.");
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Stoppable
+    //
+    //--------------------------------------------------------------------------
+
+    void onPrepare () override
+    {
+    }
+
+    void onStart () override
+    {
+        if (schema_ == Schema::migrating && enabled_)
+            thread_ = std::thread {&AccountTxMigratorImp::run, this};
+    }
+
+    void onStop () override
+    {
+        if (thread_.joinable ())
+        {
+            JLOG (j_.info) << "Stopping";
+            {
+                std::lock_guard<std::mutex> lock (mutex_);
+                shouldExit_ = true;
+                wakeup_.notify_one();
+            }
+            thread_.join();
+        }
+        stopped();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // AccountTxMigrator
+    //
+    //--------------------------------------------------------------------------
+
+    void setup () override
+    {
+        if (app_.getTxnDB ().getType () != DatabaseCon::Type::MySQL)
+            return;
+
+        auto db = app_.getTxnDB ().checkoutDb ();
+
+        int legacyTables = 0;
+        *db << "SELECT COUNT(*) FROM information_schema.tables "
+               "WHERE table_schema = DATABASE() AND "
+               "table_name = 'AccountTransactions';",
+            soci::into (legacyTables);
+
+        if (legacyTables == 0)
+        {
+            schema_ = Schema::binary;
+            return;
+        }
+
+        boost::optional<std::uint64_t> cursor;
+        *db << "SELECT Value FROM TxnDBState "
+               "WHERE Name = 'AccountTxsCursor';",
+            soci::into (cursor);
+
+        if (! cursor)
+        {
+            if (! enabled_)
+                return;
+
+            // Ledgers saved from now on are written to both tables
+            boost::optional<std::uint64_t> top;
+            *db << "SELECT MAX(LedgerSeq) FROM AccountTransactions;",
+                soci::into (top);
+            std::uint64_t const next = top ? *top + 1 : 0;
+            *db << "INSERT INTO TxnDBState (Name, Value) "
+                   "VALUES ('AccountTxsCursor', :cursor);",
+                soci::use (next);
+            cursor = next;
+
+            JLOG (j_.info) << "Migrating the accounts of ledgers below " <<
+                next << " to AccountTxs";
+        }
+
+        cursor_ = rangeCheckedCast<std::uint32_t> (*cursor);
+        if (cursor_ == 0)
+        {
+            schema_ = Schema::binary;
+            JLOG (j_.info) <<
+                "AccountTransactions is no longer used and may be dropped";
+            return;
+        }
+
+        schema_ = Schema::migrating;
+        if (! enabled_)
+            JLOG (j_.warning) << "The migration to AccountTxs is paused "
+                "below ledger " << cursor_;
+    }
+
+    Schema getSchema () const override
+    {
+        return schema_;
+    }
+
+    std::uint32_t getCursor () const override
+    {
+        return cursor_;
+    }
+
+private:
+    void run ()
+    {
+        beast::Thread::setCurrentThreadName ("AccountTxMigrator");
+        JLOG (j_.debug) << "Started";
+
+        try
+        {
+            while (copyChunk ())
+            {
+                // Leave the database to the servers between chunks
+                std::unique_lock<std::mutex> lock (mutex_);
+                if (wakeup_.wait_for (lock, std::chrono::milliseconds (100),
+                        [this]() { return shouldExit_; }))
+                    return;
+            }
+        }
+        catch (std::exception const& e)
+        {
+            // The cursor is kept, so a restart resumes the copy
+            JLOG (j_.error) << "Migration failed below ledger " <<
+                cursor_ << ": " << e.what ();
+        }
+    }
+
+    // Copy the rows of up to chunk_ ledgers below the cursor. Returns false
+    // once every ledger is copied.
+    bool copyChunk ()
+    {
+        std::uint32_t const cursor = cursor_;
+        auto db = app_.getTxnDB ().checkoutDb ();
+
+        boost::optional<std::uint64_t> bottom;
+        *db << "SELECT MIN(LedgerSeq) FROM AccountTransactions;",
+            soci::into (bottom);
+
+        if (! bottom || *bottom >= cursor)
+        {
+            std::uint64_t const done = 0;
+            *db << "UPDATE TxnDBState SET Value = :cursor "
+                   "WHERE Name = 'AccountTxsCursor';",
+                soci::use (done);
+            cursor_ = 0;
+            schema_ = Schema::binary;
+            JLOG (j_.info) << "Migration to AccountTxs complete. "
+                "AccountTransactions is no longer used and may be dropped";
+            return false;
+        }
+
+        std::uint32_t const first = (cursor - *bottom > chunk_) ?
+            cursor - chunk_ : static_cast<std::uint32_t> (*bottom);
+
+        std::vector<std::string> accounts, txIDs, txTypes;
+        std::vector<std::uint32_t> ledgerSeqs, txnSeqs;
+        std::size_t skipped = 0;
+        {
+            std::string txID, account;
+            std::uint64_t ledgerSeq = 0;
+            boost::optional<std::uint64_t> txnSeq;
+            boost::optional<std::string> txType;
+            uint256 hash;
+
+            soci::statement st = (db->prepare <<
+                "SELECT TransID, Account, LedgerSeq, TxnSeq, TransType "
+                "FROM AccountTransactions "
+                "WHERE LedgerSeq >= :first AND LedgerSeq < :cursor;",
+                soci::into (txID), soci::into (account),
+                soci::into (ledgerSeq), soci::into (txnSeq),
+                soci::into (txType),
+                soci::use (first), soci::use (cursor));
+
+            st.execute ();
+            while (st.fetch ())
+            {
+                auto const id = parseBase58<AccountID> (account);
+                if (! id || ! txnSeq || ! hash.SetHex (txID, true))
+                {
+                    ++skipped;
+                    continue;
+                }
+                accounts.emplace_back (
+                    reinterpret_cast<char const*> (id->data ()), id->size ());
+                txIDs.emplace_back (
+                    reinterpret_cast<char const*> (hash.data ()), hash.size ());
+                ledgerSeqs.push_back (
+                    rangeCheckedCast<std::uint32_t> (ledgerSeq));
+                txnSeqs.push_back (rangeCheckedCast<std::uint32_t> (*txnSeq));
+                txTypes.push_back (txType.value_or (""));
+            }
+        }
+
+        {
+            // Rows already written by a ledger save are kept
+            soci::transaction tr (*db);
+            bulkExecute (*db, 100,
+                "INSERT IGNORE INTO AccountTxs "
+                "(Account, LedgerSeq, TxnSeq, TransID, TransType) VALUES ",
+                "(?, ?, ?, ?, ?)", ", ", ";",
+                accounts, ledgerSeqs, txnSeqs, txIDs, txTypes);
+
+            std::uint64_t const next = first;
+            *db << "UPDATE TxnDBState SET Value = :cursor "
+                   "WHERE Name = 'AccountTxsCursor';",
+                soci::use (next);
+            tr.commit ();
+        }
+        cursor_ = first;
+
+        JLOG (j_.debug) << "Copied " << accounts.size () <<
+            " rows of ledgers " << first << " to " << (cursor - 1);
+        if (skipped != 0)
+            JLOG (j_.warning) << "Skipped " << skipped <<
+                " malformed rows of ledgers " << first << " to " << (cursor - 1);
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+AccountTxMigrator::AccountTxMigrator (Stoppable& parent)
+    : Stoppable ("AccountTxMigrator", parent)
+{
+}
+
+AccountTxMigrator::~AccountTxMigrator ()
+{
+}
+
+std::string
+accountTxTable (AccountTxMigrator::Schema schema)
+{
+    if (schema == AccountTxMigrator::Schema::binary)
+        return "AccountTxs AS AccountTransactions";
+    return "AccountTransactions";
+}
+
+std::string
+accountTxJoin (AccountTxMigrator::Schema schema)
+{
+    // Transactions keeps its hex IDs
+    if (schema == AccountTxMigrator::Schema::binary)
+        return "Transactions.TransID = HEX(AccountTransactions.TransID)";
+    return "Transactions.TransID = AccountTransactions.TransID";
+}
+
+std::string
+accountTxLiteral (AccountTxMigrator::Schema schema,
+    AccountIDCache const& idCache, AccountID const& account)
+{
+    if (schema == AccountTxMigrator::Schema::binary)
+        return "X'" + strHex (account.data (), account.size ()) + "'";
+    return "'" + idCache.toBase58 (account) + "'";
+}
+
+std::unique_ptr<AccountTxMigrator>
+make_AccountTxMigrator (Application& app,
+    beast::Stoppable& parent, beast::Journal journal)
+{
+    return std::make_unique<AccountTxMigratorImp>(app, parent, journal);
+}
+
+} // ripple
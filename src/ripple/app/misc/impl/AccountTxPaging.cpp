@@ -78,7 +78,9 @@ accountTxPage (
     Json::Value& token,
     int limit,
     bool bAdmin,
-    std::uint32_t page_length)
+    std::uint32_t page_length,
+    std::string const& txType,
+    AccountTxMigrator::Schema schema)
 {
     bool lookingForMarker =  !token.isNull() && token.isObject();
 
@@ -116,90 +118,74 @@ accountTxPage (
     // we need to clear it in between.
     token = Json::nullValue;
 
-    static std::string const prefix (
-        R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
-          Status,RawTxn,TxnMeta
-          FROM AccountTransactions INNER JOIN Transactions
-          ON Transactions.TransID = AccountTransactions.TransID
-          AND AccountTransactions.Account = '%s' WHERE
-          )");
-
-    std::string sql;
+    // SQL's BETWEEN uses a closed interval ([a,b]). The marker bounds
+    // the ledgers as well, so the account index finds the first row
+    // without scanning the pages before it.
+    std::string range;
 
-    // SQL's BETWEEN uses a closed interval ([a,b])
-
-    if (forward && (findLedger == 0))
+    if (findLedger == 0)
     {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u'
-             ORDER BY AccountTransactions.LedgerSeq ASC,
-             AccountTransactions.TxnSeq ASC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
+        range = boost::str (boost::format(
+            R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u')")
             % minLedger
-            % maxLedger
-            % queryLimit);
+            % maxLedger);
     }
-    else if (forward && (findLedger != 0))
+    else if (forward)
     {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(
-            AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' OR
-            ( AccountTransactions.LedgerSeq = '%u' AND
-              AccountTransactions.TxnSeq >= '%u' )
-            ORDER BY AccountTransactions.LedgerSeq ASC,
-            AccountTransactions.TxnSeq ASC
-            LIMIT %u;
-            )"))
-        % idCache.toBase58(account)
-        % (findLedger + 1)
-        % maxLedger
-        % findLedger
-        % findSeq
-        % queryLimit);
-    }
-    else if (!forward && (findLedger == 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u'
-             ORDER BY AccountTransactions.LedgerSeq DESC,
-             AccountTransactions.TxnSeq DESC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
-            % minLedger
+        range = boost::str (boost::format(
+            R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' AND
+            (AccountTransactions.LedgerSeq > '%u' OR
+             AccountTransactions.TxnSeq >= '%u'))")
+            % findLedger
             % maxLedger
-            % queryLimit);
-    }
-    else if (!forward && (findLedger != 0))
-    {
-        sql = boost::str (boost::format(
-            prefix +
-            (R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' OR
-             (AccountTransactions.LedgerSeq = '%u' AND
-              AccountTransactions.TxnSeq <= '%u')
-             ORDER BY AccountTransactions.LedgerSeq DESC,
-             AccountTransactions.TxnSeq DESC
-             LIMIT %u;)"))
-            % idCache.toBase58(account)
-            % minLedger
-            % (findLedger - 1)
             % findLedger
-            % findSeq
-            % queryLimit);
+            % findSeq);
     }
     else
     {
-        assert (false);
-        // sql is empty
-        return;
+        range = boost::str (boost::format(
+            R"(AccountTransactions.LedgerSeq BETWEEN '%u' AND '%u' AND
+            (AccountTransactions.LedgerSeq < '%u' OR
+             AccountTransactions.TxnSeq <= '%u'))")
+            % minLedger
+            % findLedger
+            % findLedger
+            % findSeq);
     }
 
+    // The callers check that the type is a known name. The account
+    // tables keep the type of each row, so the type index finds the
+    // page as well.
+    if (! txType.empty ())
+        range += " AND AccountTransactions.TransType = '" + txType + "'";
+
+    // The page is found in the account index first, so only its rows
+    // are joined to Transactions
+    char const* const order = forward ? "ASC" : "DESC";
+    std::string const sql = boost::str (boost::format(
+        R"(SELECT AccountTransactions.LedgerSeq,AccountTransactions.TxnSeq,
+          Status,RawTxn,TxnMeta
+          FROM (SELECT LedgerSeq,TxnSeq,TransID FROM %s
+            WHERE AccountTransactions.Account = %s AND %s
+            ORDER BY AccountTransactions.LedgerSeq %s,
+            AccountTransactions.TxnSeq %s
+            LIMIT %u) AS AccountTransactions
+          INNER JOIN Transactions ON %s
+          ORDER BY AccountTransactions.LedgerSeq %s,
+          AccountTransactions.TxnSeq %s;)")
+        % accountTxTable (schema)
+        % accountTxLiteral (schema, idCache, account)
+        % range
+        % order
+        % order
+        % queryLimit
+        % accountTxJoin (schema)
+        % order
+        % order);
+
     {
         bool isMySQL = connection.getType () == DatabaseCon::Type::MySQL;
-        auto db =connection.checkoutDb();
+        auto db = connection.checkoutReadDb ();
 
         Blob rawData;
         Blob rawMeta;
@@ -21,6 +21,7 @@
 #define RIPPLE_APP_MISC_IMPL_ACCOUNTTXPAGING_H_INCLUDED
 
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/app/misc/AccountTxMigrator.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <cstdint>
 #include <string>
@@ -59,7 +60,9 @@ accountTxPage (
     Json::Value& token,
     int limit,
     bool bAdmin,
-    std::uint32_t pageLength);
+    std::uint32_t pageLength,
+    std::string const& txType = std::string (),
+    AccountTxMigrator::Schema schema = AccountTxMigrator::Schema::legacy);
 
 }
 
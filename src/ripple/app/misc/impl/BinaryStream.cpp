@@ -0,0 +1,43 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/BinaryStream.h>
+#include <ripple/protocol/Serializer.h>
+
+namespace ripple {
+namespace BinaryStream {
+
+Blob
+makeTransaction (LedgerInfo const& info, STTx const& txn, TER result,
+    Blob const& rawMeta)
+{
+    Serializer tx;
+    txn.add (tx);
+
+    Serializer s (tx.getDataLength () + rawMeta.size () + 64);
+    s.add8 (transaction);
+    s.add32 (info.seq);
+    s.add256 (info.hash);
+    s.add32 (info.closeTime);
+    s.add32 (static_cast<std::uint32_t> (result));
+    s.addVL (tx.peekData ());
+    s.addVL (rawMeta);
+    return std::move (s.modData ());
+}
+
+Blob
+makeLedger (LedgerInfo const& info, Fees const& fees,
+    std::uint32_t txnCount)
+{
+    Serializer s (192);
+    s.add8 (ledger);
+    addRaw (info, s);
+    s.add256 (info.hash);
+    s.add32 (txnCount);
+    s.add64 (fees.base);
+    s.add32 (fees.units);
+    s.add32 (fees.reserve);
+    s.add32 (fees.increment);
+    return std::move (s.modData ());
+}
+
+} // BinaryStream
+} // ripple
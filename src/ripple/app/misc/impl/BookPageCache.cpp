@@ -0,0 +1,83 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/BookPageCache.h>
+#include <ripple/protocol/Serializer.h>
+#include <algorithm>
+
+namespace ripple {
+
+BookPageCache::BookPageCache (std::size_t ledgers, std::size_t pages)
+    : maxLedgers_ (ledgers)
+    , maxPages_ (pages)
+{
+}
+
+uint256
+BookPageCache::key (Book const& book, bool takerIsIssuer, unsigned int limit)
+{
+    Serializer s;
+    s.add160 (book.in.currency);
+    s.add160 (book.in.account);
+    s.add160 (book.out.currency);
+    s.add160 (book.out.account);
+    s.add8 (takerIsIssuer ? 1 : 0);
+    s.add32 (limit);
+    return s.getSHA512Half ();
+}
+
+BookPageCache::Page
+BookPageCache::fetch (uint256 const& ledgerHash, uint256 const& key) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const ledger = ledgers_.find (ledgerHash);
+    if (ledger == ledgers_.end ())
+        return {};
+    auto const page = ledger->second.pages.find (key);
+    if (page == ledger->second.pages.end ())
+        return {};
+    return page->second;
+}
+
+void
+BookPageCache::insert (uint256 const& ledgerHash, LedgerIndex seq,
+    uint256 const& key, Page page)
+{
+    if (maxLedgers_ == 0 || maxPages_ == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto iter = ledgers_.find (ledgerHash);
+    if (iter == ledgers_.end ())
+    {
+        if (ledgers_.size () >= maxLedgers_)
+        {
+            // Make room by forgetting the oldest ledger, unless this one
+            // is older still
+            auto const oldest = std::min_element (
+                ledgers_.begin (), ledgers_.end (),
+                [](auto const& a, auto const& b)
+                {
+                    return a.second.seq < b.second.seq;
+                });
+            if (oldest->second.seq >= seq)
+                return;
+            ledgers_.erase (oldest);
+        }
+        iter = ledgers_.emplace (ledgerHash, Ledger {seq, {}}).first;
+    }
+
+    auto& pages = iter->second.pages;
+    if (pages.size () < maxPages_)
+        pages.emplace (key, std::move (page));
+}
+
+std::size_t
+BookPageCache::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::size_t count = 0;
+    for (auto const& ledger : ledgers_)
+        count += ledger.second.pages.size ();
+    return count;
+}
+
+} // ripple
@@ -0,0 +1,155 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/DeadOffers.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/Sandbox.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/TxFormats.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace ripple {
+namespace DeadOffers {
+
+bool
+isDead (ApplyView& view, SLE const& offer, std::uint32_t when,
+    beast::Journal j)
+{
+    if (offer.isFieldPresent (sfExpiration) &&
+            offer.getFieldU32 (sfExpiration) <= when)
+        return true;
+
+    auto const& takerGets = offer.getFieldAmount (sfTakerGets);
+    if (takerGets <= zero || offer.getFieldAmount (sfTakerPays) <= zero)
+        return true;
+
+    return accountFunds (view, offer.getAccountID (sfAccount),
+        takerGets, fhZERO_IF_FROZEN, j) <= zero;
+}
+
+// The books whose offers the ledger's transactions touched most
+static
+std::vector<uint256>
+busiestBooks (ReadView const& ledger)
+{
+    std::map<uint256, std::size_t> touched;
+    for (auto const& item : ledger.txs)
+    {
+        if (! item.second)
+            continue;
+
+        for (auto const& node : item.second->getFieldArray (sfAffectedNodes))
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltOFFER)
+                continue;
+
+            auto const data = dynamic_cast<STObject const*> (
+                node.peekAtPField ((node.getFName () == sfCreatedNode) ?
+                    sfNewFields : sfFinalFields));
+            if (! data || ! data->isFieldPresent (sfBookDirectory))
+                continue;
+
+            ++touched[getQualityIndex (
+                data->getFieldH256 (sfBookDirectory))];
+        }
+    }
+
+    std::vector<std::pair<std::size_t, uint256>> ranked;
+    ranked.reserve (touched.size ());
+    for (auto const& book : touched)
+        ranked.emplace_back (book.second, book.first);
+    std::sort (ranked.begin (), ranked.end (),
+        [](std::pair<std::size_t, uint256> const& a,
+            std::pair<std::size_t, uint256> const& b)
+        {
+            if (a.first != b.first)
+                return a.first > b.first;
+            return a.second < b.second;
+        });
+
+    std::vector<uint256> books;
+    for (auto const& book : ranked)
+    {
+        if (books.size () == maxBooks)
+            break;
+        books.push_back (book.second);
+    }
+    return books;
+}
+
+std::vector<uint256>
+find (ReadView const& lastClosedLedger, beast::Journal j)
+{
+    // The pseudo-transaction is applied in the next ledger, whose parent
+    // closed when this one did
+    auto const when = lastClosedLedger.info ().closeTime;
+    Sandbox view (&lastClosedLedger, tapNONE);
+
+    std::vector<uint256> offers;
+    for (auto const& base : busiestBooks (lastClosedLedger))
+    {
+        auto const end = getQualityNext (base);
+        auto tip = base;
+        std::size_t steps = 0;
+        while (steps < maxSteps && offers.size () < maxOffers)
+        {
+            auto const dir = view.succ (tip, end);
+            if (! dir)
+                break;
+            tip = *dir;
+
+            std::shared_ptr<SLE const> page;
+            unsigned int entry;
+            uint256 index;
+            if (! cdirFirst (view, tip, page, entry, index, j))
+                continue;
+            do
+            {
+                ++steps;
+                auto const offer = view.read (keylet::offer (index));
+                if (offer && isDead (view, *offer, when, j))
+                    offers.push_back (index);
+            }
+            while (steps < maxSteps && offers.size () < maxOffers &&
+                cdirNext (view, tip, page, entry, index, j));
+        }
+    }
+
+    std::sort (offers.begin (), offers.end ());
+    offers.erase (std::unique (offers.begin (), offers.end ()),
+        offers.end ());
+    return offers;
+}
+
+STTx
+makeTx (std::vector<uint256> const& offers)
+{
+    STTx tx (ttOFFER_PURGE);
+    tx[sfAccount] = AccountID ();
+    tx.setFieldV256 (sfIndexes, STVector256 (sfIndexes, offers));
+    return tx;
+}
+
+void
+addToPosition (ReadView const& lastClosedLedger,
+    std::shared_ptr<SHAMap> const& initialPosition, beast::Journal j)
+{
+    auto const offers = find (lastClosedLedger, j);
+    if (offers.empty ())
+        return;
+
+    auto const tx = makeTx (offers);
+    auto const txID = tx.getTransactionID ();
+    JLOG (j.debug) << "Purging " << offers.size () << " offers: " << txID;
+
+    Serializer s;
+    tx.add (s);
+    if (! initialPosition->addGiveItem (
+            make_shamapitem (txID, s.peekData ()), true, false))
+        JLOG (j.warning) << "Ledger already had offer purge";
+}
+
+} // DeadOffers
+} // ripple
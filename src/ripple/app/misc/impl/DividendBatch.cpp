@@ -0,0 +1,323 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/DividendBatch.h>
+#include <ripple/basics/Log.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/STVector256.h>
+#include <ripple/protocol/TxFlags.h>
+#include <algorithm>
+#include <cassert>
+
+namespace ripple {
+namespace DividendBatch {
+
+/** The fields of a payee, in the apply transaction too. */
+static SF_U64 const* const payeeFields[] = {
+    &sfDividendCoins,
+    &sfDividendCoinsVBC,
+    &sfDividendCoinsVBCRank,
+    &sfDividendCoinsVBCSprd,
+    &sfDividendVRank,
+    &sfDividendVSprd,
+    &sfDividendTSprd,
+};
+
+/** Returns the branch of the inner node at a depth a key is under. */
+static
+int
+branch (uint256 const& key, int depth)
+{
+    auto const byte = *(key.begin () + depth / 2);
+    return (depth & 1) ? (byte & 0xf) : (byte >> 4);
+}
+
+static
+uint256
+innerHash (uint256 const (&hashes)[16])
+{
+    // An inner node hashes all sixteen branches, empty ones as zero.
+    return sha512Half (HashPrefix::innerNode,
+        Slice (hashes[0].data (), sizeof (hashes)));
+}
+
+STObject
+makePayee (AccountID const& account,
+    DividendMaster::AccountsDividend::mapped_type const& result)
+{
+    STObject payee (sfDividendPayee);
+    payee.setAccountID (sfDestination, account);
+    payee.setFieldU64 (sfDividendCoins, std::get<0> (result));
+    payee.setFieldU64 (sfDividendCoinsVBC, std::get<1> (result));
+    payee.setFieldU64 (sfDividendCoinsVBCRank, std::get<2> (result));
+    payee.setFieldU64 (sfDividendCoinsVBCSprd, std::get<3> (result));
+    payee.setFieldU64 (sfDividendVRank, std::get<4> (result));
+    payee.setFieldU64 (sfDividendVSprd, std::get<5> (result));
+    payee.setFieldU64 (sfDividendTSprd, std::get<6> (result));
+    return payee;
+}
+
+STObject
+makePayee (STTx const& apply)
+{
+    STObject payee (sfDividendPayee);
+    payee.setAccountID (sfDestination, apply.getAccountID (sfDestination));
+    for (auto const field : payeeFields)
+        payee.setFieldU64 (*field, apply.getFieldU64 (*field));
+    return payee;
+}
+
+STTx
+makeApply (STObject const& payee, std::uint32_t dividendLedger,
+    Blob const& publicKey)
+{
+    STTx trans (ttDIVIDEND);
+    trans.setFieldU8 (sfDividendType, DividendMaster::DivType_Apply);
+    trans.setFieldU32 (sfDividendLedger, dividendLedger);
+    trans.setFieldU32 (sfFlags, tfFullyCanonicalSig);
+    trans.setAccountID (sfAccount, AccountID ());
+
+    trans.setAccountID (sfDestination, payee.getAccountID (sfDestination));
+    for (auto const field : payeeFields)
+        trans.setFieldU64 (*field, payee.getFieldU64 (*field));
+    trans.setFieldVL (sfSigningPubKey, publicKey);
+    return trans;
+}
+
+uint256
+itemKey (STTx const& apply)
+{
+    Serializer s;
+    apply.add (s);
+    return sha512Half (HashPrefix::transactionID, s.slice ());
+}
+
+uint256
+subtreeHash (uint256 const* first, uint256 const* last, int depth)
+{
+    if (first == last)
+        return zero;
+
+    // Below the root a single leaf takes the place of its inner node.
+    if (depth > 0 && last - first == 1)
+        return *first;
+
+    assert (depth < maxDepth);
+    uint256 hashes[16];
+    while (first != last)
+    {
+        auto const b = branch (*first, depth);
+        auto next = first + 1;
+        while (next != last && branch (*next, depth) == b)
+            ++next;
+        hashes[b] = subtreeHash (first, next, depth + 1);
+        first = next;
+    }
+    return innerHash (hashes);
+}
+
+uint256
+rootHash (uint256 const& hash, uint256 const& path, int depth,
+    std::vector<uint256> const& proof)
+{
+    assert (proof.size () == 16 * static_cast<std::size_t> (depth));
+
+    uint256 result = hash;
+    for (int level = depth - 1; level >= 0; --level)
+    {
+        uint256 hashes[16];
+        std::copy (proof.begin () + 16 * level,
+            proof.begin () + 16 * (level + 1), hashes);
+        hashes[branch (path, level)] = result;
+        result = innerHash (hashes);
+    }
+    return result;
+}
+
+static
+uint256
+splitNode (std::vector<uint256> const& keys, std::size_t first,
+    std::size_t last, int depth, std::size_t maxBatch,
+        std::vector<Batch>& batches)
+{
+    if (last - first <= maxBatch || depth + 1 >= maxDepth)
+    {
+        Batch batch;
+        batch.first = first;
+        batch.last = last;
+        batch.depth = depth;
+        batch.hash = subtreeHash (&keys[0] + first, &keys[0] + last, depth);
+        batch.proof.resize (16 * depth);
+        batches.push_back (std::move (batch));
+        return batches.back ().hash;
+    }
+
+    // The branch hashes of this node are known once every branch is,
+    // they go to the proof of each batch below it.
+    auto const below = batches.size ();
+    uint256 hashes[16];
+    while (first != last)
+    {
+        auto const b = branch (keys[first], depth);
+        auto next = first + 1;
+        while (next != last && branch (keys[next], depth) == b)
+            ++next;
+        hashes[b] = splitNode (keys, first, next, depth + 1,
+            maxBatch, batches);
+        first = next;
+    }
+
+    for (auto i = below; i < batches.size (); ++i)
+    {
+        auto& batch = batches[i];
+        auto const proof = batch.proof.begin () + 16 * depth;
+        std::copy (std::begin (hashes), std::end (hashes), proof);
+        proof[branch (keys[batch.first], depth)] = zero;
+    }
+    return innerHash (hashes);
+}
+
+uint256
+split (std::vector<uint256> const& keys, std::size_t maxBatch,
+    std::vector<Batch>& batches)
+{
+    batches.clear ();
+    if (keys.empty ())
+        return zero;
+    return splitNode (keys, 0, keys.size (), 0,
+        std::max<std::size_t> (maxBatch, 1), batches);
+}
+
+STTx
+makeTx (std::uint32_t dividendLedger, uint256 const& dividendHash,
+    Batch const& batch, STArray payees, Blob const& publicKey)
+{
+    std::uint64_t coins = 0;
+    std::uint64_t coinsVBC = 0;
+    for (auto const& payee : payees)
+    {
+        coins += payee.getFieldU64 (sfDividendCoins);
+        coinsVBC += payee.getFieldU64 (sfDividendCoinsVBC);
+    }
+
+    STTx trans (ttDIVIDEND);
+    trans.setFieldU8 (sfDividendType, DividendMaster::DivType_ApplyBatch);
+    trans.setFieldU32 (sfDividendLedger, dividendLedger);
+    trans.setFieldU32 (sfFlags, tfFullyCanonicalSig);
+    trans.setAccountID (sfAccount, AccountID ());
+
+    trans.setFieldU64 (sfDividendCoins, coins);
+    trans.setFieldU64 (sfDividendCoinsVBC, coinsVBC);
+    trans.setFieldU64 (sfDividendVRank, 0);
+    trans.setFieldU64 (sfDividendVSprd, 0);
+    trans.setFieldH256 (sfDividendHash, dividendHash);
+    trans.setFieldU8 (sfDividendDepth, batch.depth);
+    trans.setFieldH256 (sfDividendSubtree, batch.hash);
+    trans.setFieldV256 (sfDividendProof, STVector256 (batch.proof));
+    trans.setFieldArray (sfDividendPayees, std::move (payees));
+    trans.setFieldVL (sfSigningPubKey, publicKey);
+    return trans;
+}
+
+std::vector<uint256>
+payeeKeys (STTx const& tx)
+{
+    auto const dividendLedger = tx.getFieldU32 (sfDividendLedger);
+    auto const publicKey = tx.getSigningPubKey ();
+
+    std::vector<uint256> keys;
+    auto const& payees = tx.getFieldArray (sfDividendPayees);
+    keys.reserve (payees.size ());
+    for (auto const& payee : payees)
+    {
+        if (payee.getFName () != sfDividendPayee ||
+                ! payee.isFieldPresent (sfDestination))
+            return {};
+        for (auto const field : payeeFields)
+        {
+            if (! payee.isFieldPresent (*field))
+                return {};
+        }
+        keys.push_back (itemKey (
+            makeApply (payee, dividendLedger, publicKey)));
+    }
+
+    std::sort (keys.begin (), keys.end ());
+    if (std::adjacent_find (keys.begin (), keys.end ()) != keys.end ())
+        return {};
+    return keys;
+}
+
+bool
+verify (STTx const& tx, beast::Journal j)
+{
+    if (! tx.isFieldPresent (sfDividendHash) ||
+        ! tx.isFieldPresent (sfDividendDepth) ||
+        ! tx.isFieldPresent (sfDividendSubtree) ||
+        ! tx.isFieldPresent (sfDividendProof) ||
+        ! tx.isFieldPresent (sfDividendPayees))
+    {
+        JLOG (j.warning) << "Dividend batch: missing field";
+        return false;
+    }
+
+    int const depth = tx.getFieldU8 (sfDividendDepth);
+    auto const& proof = tx.getFieldV256 (sfDividendProof).value ();
+    auto const& payees = tx.getFieldArray (sfDividendPayees);
+    if (depth >= maxDepth || proof.size () != 16 * std::size_t (depth) ||
+        payees.empty () || payees.size () > maxPayees)
+    {
+        JLOG (j.warning) << "Dividend batch: bad size";
+        return false;
+    }
+
+    std::uint64_t coins = 0;
+    std::uint64_t coinsVBC = 0;
+    auto const keys = payeeKeys (tx);
+    if (keys.empty ())
+    {
+        JLOG (j.warning) << "Dividend batch: bad payee";
+        return false;
+    }
+    for (auto const& payee : payees)
+    {
+        coins += payee.getFieldU64 (sfDividendCoins);
+        coinsVBC += payee.getFieldU64 (sfDividendCoinsVBC);
+    }
+    if (coins != tx.getFieldU64 (sfDividendCoins) ||
+        coinsVBC != tx.getFieldU64 (sfDividendCoinsVBC))
+    {
+        JLOG (j.warning) << "Dividend batch: coins mismatch";
+        return false;
+    }
+
+    // Every leaf is under the node, and the proof leaves its place empty
+    // so a batch has one form.
+    auto const& path = keys.front ();
+    for (int level = 0; level < depth; ++level)
+    {
+        auto const b = branch (path, level);
+        if (branch (keys.back (), level) != b ||
+                proof[16 * level + b].isNonZero ())
+        {
+            JLOG (j.warning) << "Dividend batch: leaf off the node";
+            return false;
+        }
+    }
+
+    auto const hash = subtreeHash (&keys[0], &keys[0] + keys.size (), depth);
+    if (hash != tx.getFieldH256 (sfDividendSubtree))
+    {
+        JLOG (j.warning) << "Dividend batch: subtree hash mismatch";
+        return false;
+    }
+    if (rootHash (hash, path, depth, proof) != tx.getFieldH256 (sfDividendHash))
+    {
+        JLOG (j.warning) << "Dividend batch: root hash mismatch";
+        return false;
+    }
+    return true;
+}
+
+} // DividendBatch
+} // ripple
@@ -0,0 +1,665 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendEngine.h>
+#include <ripple/app/misc/DividendBatch.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/Log.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/STObjectView.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/SystemParameters.h>
+#include <ripple/protocol/TxFlags.h>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace ripple {
+
+DividendEngine::DividendEngine (beast::Journal journal)
+    : m_journal (journal)
+{
+}
+
+void
+DividendEngine::clear ()
+{
+    // Swap with empty vectors to give the memory back.
+    std::vector<AccountID> ().swap (account_);
+    std::vector<std::uint64_t> ().swap (vbc_);
+    std::vector<Index> ().swap (parent_);
+    std::vector<std::uint32_t> ().swap (vRank_);
+    std::vector<std::uint64_t> ().swap (vSprd_);
+    std::vector<std::uint64_t> ().swap (tSprd_);
+    std::vector<std::uint64_t> ().swap (maxChildHolding_);
+    std::vector<Index> ().swap (ranked_);
+    std::vector<Index> ().swap (late_);
+    edges_ = 0;
+}
+
+void
+DividendEngine::addAccount (Shard& shard, AccountID const& account,
+    AccountID const& referee, std::uint64_t vbc)
+{
+    if (vbc < SYSTEM_CURRENCY_PARTS_VBC && !referee)
+        // Not qualified unless referenced by another account.
+        shard.unqualified.push_back ({account, vbc});
+    else
+        shard.entries.push_back ({account, referee, vbc});
+}
+
+void
+DividendEngine::prepare (Ledger::pointer const& ledger, unsigned threads)
+{
+    clear ();
+
+    if (threads == 0)
+        threads = std::max (1u, std::thread::hardware_concurrency ());
+
+    std::vector<Shard> shards (shardCount);
+    ledger->visitStateItems (ltACCOUNT_ROOT, shardDepth, threads,
+        [&shards](std::size_t shard, SHAMapItem const& item)
+        {
+            STObjectView const sle (item.slice ());
+            addAccount (shards[shard], sle.getAccountID (sfAccount),
+                sle.getAccountID (sfReferee),
+                sle.getFieldAmount (sfBalanceVBC).mantissa ());
+        });
+
+    merge (shards);
+}
+
+bool
+DividendEngine::prepare (ReadView const& ledger, DividendIndex& index)
+{
+    return prepare ([&](Visitor const& visitor)
+        {
+            return index.visit (ledger, visitor);
+        });
+}
+
+bool
+DividendEngine::prepare (std::function<bool (Visitor const&)> const& source)
+{
+    clear ();
+
+    // Accounts come in no particular order, the result does not depend on
+    // the dense indexes.
+    std::vector<Shard> shards (1);
+    auto& shard = shards.front ();
+    if (!source (
+        [&shard](AccountID const& account, AccountID const& referee,
+            std::uint64_t vbc)
+        {
+            addAccount (shard, account, referee, vbc);
+        }))
+    {
+        return false;
+    }
+
+    merge (shards);
+    return true;
+}
+
+DividendEngine::Index
+DividendEngine::push (AccountID const& account, std::uint64_t vbc)
+{
+    auto const index = static_cast<Index> (account_.size ());
+    account_.push_back (account);
+    vbc_.push_back (vbc);
+    parent_.push_back (none);
+    return index;
+}
+
+void
+DividendEngine::merge (std::vector<Shard>& shards)
+{
+    std::size_t qualified = 0, unqualified = 0;
+    for (auto const& shard : shards)
+    {
+        qualified += shard.entries.size ();
+        unqualified += shard.unqualified.size ();
+    }
+
+    // Unqualified accounts are only looked up by referee, keep them sorted.
+    std::vector<Unqualified> accountsUnqualified;
+    accountsUnqualified.reserve (unqualified);
+    for (auto& shard : shards)
+    {
+        accountsUnqualified.insert (accountsUnqualified.end (),
+            shard.unqualified.begin (), shard.unqualified.end ());
+        std::vector<Unqualified> ().swap (shard.unqualified);
+    }
+    std::sort (accountsUnqualified.begin (), accountsUnqualified.end (),
+        [](Unqualified const& a, Unqualified const& b)
+        {
+            return a.account < b.account;
+        });
+
+    account_.reserve (qualified);
+    vbc_.reserve (qualified);
+    parent_.reserve (qualified);
+
+    std::unordered_map<AccountID, Index> index;
+    index.reserve (qualified);
+
+    for (auto const& shard : shards)
+    {
+        for (auto const& entry : shard.entries)
+        {
+            index.emplace (entry.account, push (entry.account, entry.vbc));
+            if (entry.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
+                ranked_.push_back (static_cast<Index> (account_.size () - 1));
+        }
+    }
+
+    // Dense indexes follow the order of the entries.
+    Index child = 0;
+    std::size_t promoted = 0;
+    for (auto& shard : shards)
+    {
+        for (auto const& entry : shard.entries)
+        {
+            if (entry.referee.isNonZero ())
+            {
+                auto iter = index.find (entry.referee);
+                if (iter == index.end ())
+                {
+                    // Referee is unqualified or missing from the ledger.
+                    std::uint64_t vbc = 0;
+                    auto const unq = std::lower_bound (
+                        accountsUnqualified.begin (), accountsUnqualified.end (),
+                        entry.referee,
+                        [](Unqualified const& a, AccountID const& b)
+                        {
+                            return a.account < b;
+                        });
+                    if (unq != accountsUnqualified.end () &&
+                        unq->account == entry.referee)
+                    {
+                        vbc = unq->vbc;
+                        ++promoted;
+                    }
+                    iter = index.emplace (
+                        entry.referee, push (entry.referee, vbc)).first;
+                }
+                parent_[child] = iter->second;
+                ++edges_;
+            }
+            ++child;
+        }
+        std::vector<Entry> ().swap (shard.entries);
+    }
+
+    auto const size = account_.size ();
+    vRank_.assign (size, 0);
+    vSprd_.assign (size, 0);
+    tSprd_.assign (size, 0);
+    maxChildHolding_.assign (size, 0);
+
+    sortTopologically ();
+
+    JLOG (m_journal.info) << (unqualified - promoted)
+        << " unqualified accounts found.";
+}
+
+std::uint64_t
+DividendEngine::calcRank ()
+{
+    // Ranked by balance, accounts with the same balance share a rank.
+    std::sort (ranked_.begin (), ranked_.end (),
+        [this](Index a, Index b)
+        {
+            return vbc_[a] < vbc_[b];
+        });
+
+    std::uint64_t sumVRank = 0;
+    std::uint64_t lastBalance = 0;
+    std::uint32_t pos = 1, rank = 1;
+    for (auto it = ranked_.begin (); it != ranked_.end (); ++pos, ++it)
+    {
+        if (lastBalance < vbc_[*it])
+        {
+            rank = pos;
+            lastBalance = vbc_[*it];
+        }
+        vRank_[*it] = rank;
+        sumVRank += rank;
+    }
+    return sumVRank;
+}
+
+void
+DividendEngine::sortTopologically ()
+{
+    auto const size = account_.size ();
+
+    // Number of references not placed in the order yet.
+    std::vector<Index> pending (size, 0);
+    for (auto const p : parent_)
+    {
+        if (p != none)
+            ++pending[p];
+    }
+
+    std::vector<Index> order;
+    order.reserve (size);
+    for (Index i = 0; i < size; ++i)
+    {
+        if (pending[i] == 0)
+            order.push_back (i);
+    }
+    for (std::size_t k = 0; k < order.size (); ++k)
+    {
+        auto const p = parent_[order[k]];
+        if (p != none && --pending[p] == 0)
+            order.push_back (p);
+    }
+
+    // Accounts left are on a referral cycle. A depth first search entering
+    // the cycle at `entry` finishes the cycle in referee order and `entry`
+    // last, its edge to its own referee closes the cycle. Entering at the
+    // smallest AccountID keeps the result independent of the input order.
+    std::vector<Index> late;
+    for (Index i = 0; order.size () < size && i < size; ++i)
+    {
+        if (pending[i] == 0)
+            continue;
+
+        Index entry = i;
+        for (Index j = parent_[i]; j != i; j = parent_[j])
+        {
+            if (account_[j] < account_[entry])
+                entry = j;
+        }
+        for (Index j = parent_[entry]; j != entry; j = parent_[j])
+        {
+            order.push_back (j);
+            pending[j] = 0;
+        }
+        order.push_back (entry);
+        pending[entry] = 0;
+        late.push_back (entry);
+    }
+    assert (order.size () == size);
+
+    std::vector<Index> position (size);
+    for (Index k = 0; k < size; ++k)
+        position[order[k]] = k;
+
+    {
+        std::vector<AccountID> account (size);
+        std::vector<std::uint64_t> vbc (size);
+        std::vector<Index> parent (size);
+        for (Index k = 0; k < size; ++k)
+        {
+            auto const i = order[k];
+            account[k] = account_[i];
+            vbc[k] = vbc_[i];
+            parent[k] = parent_[i] == none ? none : position[parent_[i]];
+        }
+        account_.swap (account);
+        vbc_.swap (vbc);
+        parent_.swap (parent);
+    }
+
+    for (auto& i : ranked_)
+        i = position[i];
+
+    late_.clear ();
+    late_.reserve (late.size ());
+    for (auto const i : late)
+        late_.push_back (position[i]);
+}
+
+static inline
+std::uint64_t
+adjust (std::uint64_t coin)
+{
+    return coin >= 10000000000 ? coin + 90000000000 : coin * 10;
+}
+
+std::uint64_t
+DividendEngine::calcSpread ()
+{
+    auto const size = account_.size ();
+
+    // References come before their referee, one forward pass folds every
+    // subtree into its root. A referee placed before its reference closes
+    // a referral cycle and is folded after the adjustment below.
+    for (Index i = 0; i < size; ++i)
+    {
+        auto const t = (tSprd_[i] += vbc_[i]);
+        auto const p = parent_[i];
+        if (p == none || p <= i)
+            continue;
+
+        tSprd_[p] += t;
+        if (vbc_[p] >= SYSTEM_CURRENCY_PARTS_VBC)
+        {
+            vSprd_[p] += adjust (t);
+            if (maxChildHolding_[p] < t)
+                maxChildHolding_[p] = t;
+        }
+    }
+
+    // Replace the largest referral line by its cube root, once per account.
+    std::uint64_t sumVSpd = 0;
+    for (Index i = 0; i < size; ++i)
+    {
+        // Qualified for vSprd calc
+        if (vSprd_[i] != 0 && vbc_[i] >= SYSTEM_CURRENCY_PARTS_VBC)
+        {
+            auto const m = maxChildHolding_[i];
+            vSprd_[i] = vSprd_[i] - adjust (m) + static_cast<std::uint64_t> (
+                pow (m / SYSTEM_CURRENCY_PARTS_VBC, 1.0 / 3) *
+                    SYSTEM_CURRENCY_PARTS_VBC);
+            sumVSpd += vSprd_[i];
+        }
+    }
+
+    for (auto const i : late_)
+    {
+        auto const t = tSprd_[i];
+        auto const p = parent_[i];
+        tSprd_[p] += t;
+        if (vbc_[p] >= SYSTEM_CURRENCY_PARTS_VBC)
+        {
+            vSprd_[p] += adjust (t);
+            if (maxChildHolding_[p] < t)
+                maxChildHolding_[p] = t;
+        }
+    }
+
+    return sumVSpd;
+}
+
+void
+DividendEngine::calcDividend (
+    std::uint64_t dividendCoins, std::uint64_t dividendCoinsVBC,
+    std::uint64_t& actualTotalDividend, std::uint64_t& actualTotalDividendVBC,
+    std::uint64_t& sumVRank, std::uint64_t& sumVSpd,
+    DividendMaster::AccountsDividend& accountsOut)
+{
+    accountsOut.clear ();
+
+    calcDividend (dividendCoins, dividendCoinsVBC, actualTotalDividend,
+        actualTotalDividendVBC, sumVRank, sumVSpd,
+        [&](AccountID const& account, Result const& result)
+        {
+            auto const ret = accountsOut.emplace (account, result);
+            if (ret.second)
+                return;
+
+            // The account collecting the remainder also earned a dividend.
+            std::get<0> (ret.first->second) += std::get<0> (result);
+            std::get<1> (ret.first->second) += std::get<1> (result);
+        });
+}
+
+void
+DividendEngine::calcDividend (
+    std::uint64_t dividendCoins, std::uint64_t dividendCoinsVBC,
+    std::uint64_t& actualTotalDividend, std::uint64_t& actualTotalDividendVBC,
+    std::uint64_t& sumVRank, std::uint64_t& sumVSpd, Sink const& accountsOut)
+{
+    if (ranked_.empty () && edges_ == 0)
+    {
+        actualTotalDividend = 0;
+        actualTotalDividendVBC = 0;
+        sumVRank = 0;
+        sumVSpd = 0;
+        return;
+    }
+
+    sumVRank = calcRank ();
+    JLOG (m_journal.info) << "calcDividend got v rank total: " << sumVRank;
+
+    sumVSpd = calcSpread ();
+    JLOG (m_journal.info) << "calcDividend got v spread total: " << sumVSpd;
+
+    actualTotalDividend = 0; actualTotalDividendVBC = 0;
+    std::uint64_t totalDivVBCbyRank = dividendCoinsVBC / 2;
+    std::uint64_t totalDivVBCbyPower = dividendCoinsVBC - totalDivVBCbyRank;
+    for (Index i = 0; i < account_.size (); ++i)
+    {
+        std::uint64_t divVBC = 0;
+        boost::multiprecision::uint128_t divVBCbyRank (0), divVBCbyPower (0);
+        if (dividendCoinsVBC > 0 && sumVSpd > 0 && sumVRank > 0)
+        {
+            divVBCbyRank = totalDivVBCbyRank;
+            divVBCbyRank *= vRank_[i];
+            divVBCbyRank /= sumVRank;
+            divVBCbyPower = totalDivVBCbyPower;
+            divVBCbyPower *= vSprd_[i];
+            divVBCbyPower /= sumVSpd;
+            divVBC = static_cast<std::uint64_t> (divVBCbyRank + divVBCbyPower);
+            if (divVBC < VBC_DIVIDEND_MIN)
+            {
+                divVBC = 0;
+                divVBCbyRank = 0;
+                divVBCbyPower = 0;
+            }
+            actualTotalDividendVBC += divVBC;
+        }
+        std::uint64_t div = 0;
+        if (dividendCoins > 0 && (dividendCoinsVBC == 0 || divVBC >= VBC_DIVIDEND_MIN))
+        {
+            div = vbc_[i] * VRP_INCREASE_RATE / VRP_INCREASE_RATE_PARTS;
+            actualTotalDividend += div;
+        }
+
+        JLOG (m_journal.info) << "{\"account\":\"" << account_[i] << "\",\"data\":{\"divVBCByRank\":\"" << divVBCbyRank << "\",\"divVBCByPower\":\"" << divVBCbyPower << "\",\"divVBC\":\"" << divVBC << "\",\"divVRP\":\"" << div << "\",\"balance\":\"" << vbc_[i] << "\",\"vrank\":\"" << vRank_[i] << "\",\"vsprd\":\"" << vSprd_[i] << "\",\"tsprd\":\"" << tSprd_[i] << "\"}}";
+
+        if (div != 0 || divVBC != 0 || vSprd_[i] > MIN_VSPD_TO_GET_FEE_SHARE)
+        {
+            // Dense indexes are unique, every account is output once.
+            accountsOut (account_[i], Result (div, divVBC,
+                static_cast<std::uint64_t> (divVBCbyRank),
+                static_cast<std::uint64_t> (divVBCbyPower), vRank_[i],
+                vSprd_[i], tSprd_[i]));
+        }
+    }
+
+    JLOG (m_journal.info) << "calcDividend got actualTotalDividend " << actualTotalDividend << " actualTotalDividendVBC " << actualTotalDividendVBC;
+
+    // collect remainning
+    std::uint64_t remainCoins = 0, remainCoinsVBC = 0;
+    if (dividendCoins > actualTotalDividend)
+    {
+        remainCoins = dividendCoins - actualTotalDividend;
+        actualTotalDividend = dividendCoins;
+    }
+    if (dividendCoinsVBC > actualTotalDividendVBC)
+    {
+        remainCoinsVBC = dividendCoinsVBC - actualTotalDividendVBC;
+        actualTotalDividendVBC = dividendCoinsVBC;
+    }
+    if (remainCoins > 0 || remainCoinsVBC > 0)
+    {
+        auto const remainAccount = from_hex_text<AccountID> (
+            "0x56CE5173B6A2CBEDF203BD69159212094C651041");
+        accountsOut (remainAccount,
+            Result (remainCoins, remainCoinsVBC, 0, 0, 0, 0, 0));
+    }
+}
+
+std::shared_ptr<SHAMapItem const>
+DividendEngine::makeItem (AccountID const& account, Result const& result,
+    std::uint32_t ledgerIndex, Blob const& publicKey, beast::Journal journal)
+{
+    // The batches of DividendBatch rebuild the same transaction.
+    auto const trans = DividendBatch::makeApply (
+        DividendBatch::makePayee (account, result), ledgerIndex, publicKey);
+
+    Serializer s;
+    trans.add (s);
+    auto const txID = sha512Half (HashPrefix::transactionID, s.slice ());
+
+    if (journal.trace)
+    {
+        journal.trace << "Add transaction hash " << txID
+                      << " to transaction unsigned map hash.";
+        journal.trace << trans.STObject::getJson (0);
+    }
+
+    return make_shamapitem (txID, std::move (s));
+}
+
+std::shared_ptr<SHAMap>
+DividendEngine::makeMap (std::size_t count, ItemSource const& source,
+    Family& family, beast::Journal journal)
+{
+    // Serializing and hashing the transactions is spread over all cores.
+    std::vector<std::shared_ptr<SHAMapItem const>> items (count);
+    {
+        std::size_t const chunk = 1024;
+        unsigned const threads = std::min<std::size_t> (
+            std::max (1u, std::thread::hardware_concurrency ()),
+                (count + chunk - 1) / chunk);
+        std::atomic<std::size_t> next (0);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto worker = [&]()
+        {
+            try
+            {
+                for (std::size_t first; (first = next.fetch_add (chunk)) < count;)
+                {
+                    auto const last = std::min (first + chunk, count);
+                    for (auto i = first; i < last; ++i)
+                        items[i] = source (i);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (errorMutex);
+                if (!error)
+                    error = std::current_exception ();
+                next = count;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads; ++i)
+            workers.emplace_back (worker);
+        worker ();
+        for (auto& t : workers)
+            t.join ();
+
+        if (error)
+            std::rethrow_exception (error);
+    }
+
+    std::sort (items.begin (), items.end (),
+        [](std::shared_ptr<SHAMapItem const> const& a,
+           std::shared_ptr<SHAMapItem const> const& b)
+        {
+            return a->key () < b->key ();
+        });
+
+    auto map = std::make_shared<SHAMap> (SHAMapType::TRANSACTION, family);
+    if (!map->addSortedItems (items, true, false))
+    {
+        JLOG (journal.fatal) << "Add " << items.size ()
+            << " transactions to transaction unsigned map failed.";
+        return nullptr;
+    }
+    return map;
+}
+
+Json::Value
+DividendEngine::compareMaps (SHAMap const& ours, SHAMap const& theirs,
+    std::size_t limit)
+{
+    // An item's key is the hash of its transaction, so an account whose
+    // result differs has an item in each map, under different keys.
+    SHAMap::Delta differences;
+    bool const complete = ours.compare (theirs, differences,
+        static_cast<int> (std::min<std::size_t> (2 * limit,
+            std::numeric_limits<int>::max ())));
+
+    using Pair = std::pair<std::shared_ptr<STTx const>,
+        std::shared_ptr<STTx const>>;
+    std::map<AccountID, Pair> accounts;
+    for (auto const& difference : differences)
+    {
+        auto const& items = difference.second;
+        if (items.first)
+        {
+            auto tx = std::make_shared<STTx const> (
+                SerialIter (items.first->slice ()));
+            accounts[tx->getAccountID (sfDestination)].first = std::move (tx);
+        }
+        if (items.second)
+        {
+            auto tx = std::make_shared<STTx const> (
+                SerialIter (items.second->slice ()));
+            accounts[tx->getAccountID (sfDestination)].second = std::move (tx);
+        }
+    }
+
+    // The fields of a that b lacks or has another value of
+    auto const differing = [](STObject const& a, STObject const& b,
+        std::function<void (STBase const&, STBase const*)> const& f)
+    {
+        for (auto const& field : a)
+        {
+            if (field.getSType () == STI_NOTPRESENT)
+                continue;
+            auto const other = b.peekAtPField (field.getFName ());
+            if (!other || other->getSType () == STI_NOTPRESENT ||
+                    !field.isEquivalent (*other))
+                f (field, other);
+        }
+    };
+
+    Json::Value ret (Json::objectValue);
+    Json::Value& list = (ret[jss::accounts] = Json::arrayValue);
+    for (auto const& account : accounts)
+    {
+        Json::Value& entry = list.append (Json::objectValue);
+        entry[jss::account] = toBase58 (account.first);
+        auto const& pair = account.second;
+        if (!pair.first || !pair.second)
+        {
+            entry[jss::only] = pair.first ? "ours" : "theirs";
+            auto const& tx = pair.first ? *pair.first : *pair.second;
+            entry[jss::tx_json] = tx.getJson (0);
+            continue;
+        }
+
+        Json::Value& fields = (entry[jss::fields] = Json::objectValue);
+        differing (*pair.first, *pair.second,
+            [&](STBase const& field, STBase const* other)
+            {
+                Json::Value& f = fields[field.getFName ().getJsonName ()];
+                f[jss::ours] = field.getJson (0);
+                f[jss::theirs] = other ? other->getJson (0) : Json::Value ();
+            });
+        differing (*pair.second, *pair.first,
+            [&](STBase const& field, STBase const* other)
+            {
+                if (!other || other->getSType () == STI_NOTPRESENT)
+                {
+                    Json::Value& f = fields[field.getFName ().getJsonName ()];
+                    f[jss::ours] = Json::Value ();
+                    f[jss::theirs] = field.getJson (0);
+                }
+            });
+    }
+    ret[jss::complete] = complete;
+    return ret;
+}
+
+}
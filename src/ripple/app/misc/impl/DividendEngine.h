@@ -0,0 +1,204 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDENGINE_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDENGINE_H_INCLUDED
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/app/misc/impl/DividendIndex.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/AccountID.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+/** Computes the per-account dividend of a ledger.
+
+    Account data is kept in flat arrays indexed by a dense account index
+    instead of one heap object per account. The AccountRoots of the state map
+    are visited in shards by the first byte of the key, on several threads.
+
+    Dense indexes are assigned in topological order of the referral forest,
+    references before their referee, so subtree totals are folded bottom-up
+    in one pass over contiguous arrays.
+*/
+class DividendEngine
+{
+public:
+    using Index = std::uint32_t;
+
+    /** Index of an account without referee. */
+    static Index const none = std::numeric_limits<Index>::max ();
+
+    explicit
+    DividendEngine (beast::Journal journal);
+
+    /** Collect the accounts taking part in the dividend from a ledger.
+        @param threads The number of threads walking the state map, zero
+                       means one per hardware thread.
+    */
+    void
+    prepare (Ledger::pointer const& ledger, unsigned threads = 0);
+
+    /** Collect the accounts taking part in the dividend from the index.
+        @return false if the index can not serve the ledger.
+    */
+    bool
+    prepare (ReadView const& ledger, DividendIndex& index);
+
+    using Visitor = DividendIndex::Visitor;
+
+    /** Collect the accounts taking part in the dividend from a source
+        calling the visitor once per AccountRoot.
+        @return false if the source failed.
+    */
+    bool
+    prepare (std::function<bool (Visitor const&)> const& source);
+
+    /** Release all collected account data. */
+    void
+    clear ();
+
+    /** Number of accounts taking part in the spread calculation. */
+    std::size_t
+    size () const
+    {
+        return account_.size ();
+    }
+
+    /** Number of accounts taking part in the rank calculation. */
+    std::size_t
+    rankedSize () const
+    {
+        return ranked_.size ();
+    }
+
+    /** Calculate the dividend of every account into accountsOut. */
+    void
+    calcDividend (std::uint64_t dividendCoins, std::uint64_t dividendCoinsVBC,
+        std::uint64_t& actualTotalDividend,
+            std::uint64_t& actualTotalDividendVBC,
+                std::uint64_t& sumVRank, std::uint64_t& sumVSpd,
+                    DividendMaster::AccountsDividend& accountsOut);
+
+    using Result = DividendMaster::AccountsDividend::mapped_type;
+    using Sink = std::function<void (AccountID const&, Result const&)>;
+
+    /** Calculate the dividend of every account, passing each result to
+        accountsOut as soon as it is known. The account collecting the
+        remainder may be passed twice, its results add up.
+    */
+    void
+    calcDividend (std::uint64_t dividendCoins, std::uint64_t dividendCoinsVBC,
+        std::uint64_t& actualTotalDividend,
+            std::uint64_t& actualTotalDividendVBC,
+                std::uint64_t& sumVRank, std::uint64_t& sumVSpd,
+                    Sink const& accountsOut);
+
+    /** Make the unsigned apply transaction of one dividend result. */
+    static
+    std::shared_ptr<SHAMapItem const>
+    makeItem (AccountID const& account, Result const& result,
+        std::uint32_t ledgerIndex, Blob const& publicKey,
+            beast::Journal journal);
+
+    using ItemSource = std::function<
+        std::shared_ptr<SHAMapItem const> (std::size_t)>;
+
+    /** Build the transaction map of a dividend. The items are made in
+        parallel and the map is loaded in key order.
+        @param count The number of items.
+        @param source Returns the item at an index.
+        @return The map, nullptr if it can not be built.
+    */
+    static
+    std::shared_ptr<SHAMap>
+    makeMap (std::size_t count, ItemSource const& source, Family& family,
+        beast::Journal journal);
+
+    /** The accounts whose dividend transactions differ in two maps.
+        Only the branches whose hashes differ are walked, so the nodes
+        read from the node store are those of the differing subtrees.
+        Each account has the fields whose values differ, or which map
+        alone has its transaction.
+        @param limit The most accounts compared.
+        @return JSON, "complete" is false if there were more.
+        Throws SHAMapMissingNode if a differing node is missing.
+    */
+    static
+    Json::Value
+    compareMaps (SHAMap const& ours, SHAMap const& theirs,
+        std::size_t limit);
+
+private:
+    struct Entry
+    {
+        AccountID account;
+        AccountID referee;      // zero when the account has no referee
+        std::uint64_t vbc;
+    };
+
+    struct Unqualified
+    {
+        AccountID account;
+        std::uint64_t vbc;
+    };
+
+    /** Accounts collected from keys sharing the same first byte. */
+    struct Shard
+    {
+        std::vector<Entry> entries;
+        std::vector<Unqualified> unqualified;
+    };
+
+    // The first byte of the key, two levels of the state map
+    static int const shardDepth = 2;
+    static unsigned const shardCount = 256;
+
+    static
+    void
+    addAccount (Shard& shard, AccountID const& account,
+        AccountID const& referee, std::uint64_t vbc);
+
+    void
+    merge (std::vector<Shard>& shards);
+
+    std::uint64_t
+    calcRank ();
+
+    /** Relabel accounts so that references come before their referee. */
+    void
+    sortTopologically ();
+
+    std::uint64_t
+    calcSpread ();
+
+    Index
+    push (AccountID const& account, std::uint64_t vbc);
+
+    beast::Journal m_journal;
+
+    std::vector<AccountID> account_;
+    std::vector<std::uint64_t> vbc_;
+    std::vector<Index> parent_;
+    std::vector<std::uint32_t> vRank_;
+    std::vector<std::uint64_t> vSprd_;
+    std::vector<std::uint64_t> tSprd_;
+    std::vector<std::uint64_t> maxChildHolding_;
+
+    /** Accounts with enough VBC for vRank calc. */
+    std::vector<Index> ranked_;
+
+    /** Accounts whose referee edge closes a referral cycle. */
+    std::vector<Index> late_;
+
+    /** Number of referee edges. */
+    std::size_t edges_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendHistory.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/main/DBInit.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TER.h>
+
+namespace ripple {
+
+static char const* const insertDividendResults =
+    "INSERT OR REPLACE INTO DividendResults "
+    "(Account, DividendLedger, Coins, CoinsVBC, CoinsVBCRank, CoinsVBCSprd, "
+    "VRank, VSprd, TSprd) VALUES ";
+
+static
+void
+appendRow (std::string& sql, AccountID const& account,
+    std::uint32_t dividendLedger, DividendHistory::Result const& result)
+{
+    if (!sql.empty ())
+        sql += ", ";
+    sql += "('";
+    sql += strHex (account.data (), account.size ());
+    sql += "',";
+    sql += std::to_string (dividendLedger);
+    sql += ",";
+    sql += std::to_string (std::get<0> (result));
+    sql += ",";
+    sql += std::to_string (std::get<1> (result));
+    sql += ",";
+    sql += std::to_string (std::get<2> (result));
+    sql += ",";
+    sql += std::to_string (std::get<3> (result));
+    sql += ",";
+    sql += std::to_string (std::get<4> (result));
+    sql += ",";
+    sql += std::to_string (std::get<5> (result));
+    sql += ",";
+    sql += std::to_string (std::get<6> (result));
+    sql += ")";
+}
+
+DividendHistory::DividendHistory (Application& app, beast::Journal journal)
+    : app_ (app)
+    , m_journal (journal)
+{
+}
+
+bool
+DividendHistory::load ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    if (!loaded_)
+    {
+        loaded_ = true;
+        db_ = std::make_unique <DatabaseCon> (
+            setup_DatabaseCon (app_.config ()), "dividend.db",
+                DividendDBInit, DividendDBCount);
+    }
+    return db_ != nullptr;
+}
+
+void
+DividendHistory::save (std::uint32_t dividendLedger, std::size_t count,
+    Source const& source)
+{
+    if (!load ())
+        return;
+
+    auto db = db_->checkoutDb ();
+    soci::transaction tr (*db);
+
+    std::string sql;
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto const entry = source (i);
+        appendRow (sql, entry.first, dividendLedger, entry.second);
+        if (++rows == insertBatchSize)
+        {
+            *db << (insertDividendResults + sql + ";");
+            sql.clear ();
+            rows = 0;
+        }
+    }
+    if (rows != 0)
+        *db << (insertDividendResults + sql + ";");
+    tr.commit ();
+
+    JLOG (m_journal.info) << "Dividend history saved " << count
+        << " results of ledger " << dividendLedger;
+}
+
+void
+DividendHistory::onLedgerAccepted (ReadView const& ledger)
+{
+    std::vector<std::string> inserts;
+    std::string sql;
+    std::size_t rows = 0;
+    for (auto const& item : ledger.txs)
+    {
+        auto const& tx = *item.first;
+        if (tx.getTxnType () != ttDIVIDEND)
+            continue;
+
+        auto const type = tx.getFieldU8 (sfDividendType);
+        if (type != DividendMaster::DivType_Apply &&
+            type != DividendMaster::DivType_ApplyBatch)
+            continue;
+
+        if (!item.second || item.second->getFieldU8 (
+                sfTransactionResult) != tesSUCCESS)
+            continue;
+
+        // A payee holds the fields of its apply transaction. Rows of the
+        // payees a batch skipped are replaced by the same values.
+        auto const dividendLedger = tx.getFieldU32 (sfDividendLedger);
+        auto const append = [&](STObject const& payee)
+        {
+            appendRow (sql, payee.getAccountID (sfDestination),
+                dividendLedger,
+                Result (payee.getFieldU64 (sfDividendCoins),
+                    payee.getFieldU64 (sfDividendCoinsVBC),
+                    payee.getFieldU64 (sfDividendCoinsVBCRank),
+                    payee.getFieldU64 (sfDividendCoinsVBCSprd),
+                    static_cast<std::uint32_t> (
+                        payee.getFieldU64 (sfDividendVRank)),
+                    payee.getFieldU64 (sfDividendVSprd),
+                    payee.getFieldU64 (sfDividendTSprd)));
+            if (++rows % insertBatchSize == 0)
+            {
+                inserts.push_back (std::move (sql));
+                sql.clear ();
+            }
+        };
+
+        if (type == DividendMaster::DivType_Apply)
+            append (tx);
+        else for (auto const& payee : tx.getFieldArray (sfDividendPayees))
+            append (payee);
+    }
+
+    if (!sql.empty ())
+        inserts.push_back (std::move (sql));
+
+    if (rows == 0 || !load ())
+        return;
+
+    // Batches put thousands of results in a ledger.
+    auto db = db_->checkoutDb ();
+    soci::transaction tr (*db);
+    for (auto const& values : inserts)
+        *db << (insertDividendResults + values + ";");
+    tr.commit ();
+
+    JLOG (m_journal.trace) << "Dividend history saved " << rows
+        << " results of ledger " << ledger.info ().seq;
+}
+
+boost::optional<DividendHistory::Result>
+DividendHistory::find (AccountID const& account, std::uint32_t dividendLedger)
+{
+    if (!load ())
+        return boost::none;
+
+    auto const hex = strHex (account.data (), account.size ());
+    boost::optional<std::uint64_t> coins, coinsVBC, coinsVBCRank,
+        coinsVBCSprd, vRank, vSprd, tSprd;
+    {
+        auto db = db_->checkoutDb ();
+        *db << "SELECT Coins, CoinsVBC, CoinsVBCRank, CoinsVBCSprd, "
+            "VRank, VSprd, TSprd FROM DividendResults "
+            "WHERE Account = :account AND DividendLedger = "
+                << dividendLedger << ";",
+            soci::use (hex),
+            soci::into (coins), soci::into (coinsVBC),
+            soci::into (coinsVBCRank), soci::into (coinsVBCSprd),
+            soci::into (vRank), soci::into (vSprd), soci::into (tSprd);
+    }
+
+    if (!coins)
+        return boost::none;
+
+    return Result (*coins, coinsVBC.value_or (0), coinsVBCRank.value_or (0),
+        coinsVBCSprd.value_or (0),
+            static_cast<std::uint32_t> (vRank.value_or (0)),
+                vSprd.value_or (0), tSprd.value_or (0));
+}
+
+}
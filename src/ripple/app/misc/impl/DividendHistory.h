@@ -0,0 +1,69 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDHISTORY_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDHISTORY_H_INCLUDED
+
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <beast/utility/Journal.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace ripple {
+
+class Application;
+
+/** Per-account results of every dividend, keyed by account and ledger.
+
+    Dividend transactions are not saved to the transaction database, so
+    the results are kept in dividend.db instead. They are written once
+    per dividend from the calculated results when this server stores the
+    dividend, and from the DivType_Apply transactions of each validated
+    ledger on every other server.
+*/
+class DividendHistory
+{
+public:
+    using Result = DividendMaster::AccountsDividend::mapped_type;
+    using Source = std::function<std::pair<AccountID, Result> (std::size_t)>;
+
+    DividendHistory (Application& app, beast::Journal journal);
+
+    /** Store the results of a dividend.
+        @param count The number of accounts with a result.
+        @param source Returns the account and result at an index.
+    */
+    void
+    save (std::uint32_t dividendLedger, std::size_t count,
+        Source const& source);
+
+    /** Store the results applied by a validated ledger. */
+    void
+    onLedgerAccepted (ReadView const& ledger);
+
+    /** Result of an account in a dividend, if it got one. */
+    boost::optional<Result>
+    find (AccountID const& account, std::uint32_t dividendLedger);
+
+private:
+    bool
+    load ();
+
+    /** Rows written by one INSERT statement. */
+    static std::size_t const insertBatchSize = 512;
+
+    Application& app_;
+    beast::Journal m_journal;
+    std::unique_ptr<DatabaseCon> db_;
+
+    std::mutex mutex_;
+    bool loaded_ = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,433 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendIndex.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/main/DBInit.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/LedgerFormats.h>
+#include <ripple/protocol/STObjectView.h>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+static char const* const insertDividendAccounts =
+    "INSERT OR REPLACE INTO DividendAccounts "
+    "(Account, Referee, BalanceVBC, LedgerSeq) VALUES ";
+
+/** Rows written by one INSERT statement. */
+static std::size_t const insertBatchSize = 512;
+
+// A rebuild walks the state map in partitions by the first nibble of the key
+static int const rebuildDepth = 1;
+
+static
+void
+appendRow (std::string& sql, AccountID const& account,
+    AccountID const& referee, std::uint64_t vbc, std::uint32_t seq)
+{
+    if (!sql.empty ())
+        sql += ", ";
+    sql += "('";
+    sql += strHex (account.data (), account.size ());
+    sql += "',";
+    if (referee.isNonZero ())
+    {
+        sql += "'";
+        sql += strHex (referee.data (), referee.size ());
+        sql += "'";
+    }
+    else
+    {
+        sql += "NULL";
+    }
+    sql += ",";
+    sql += std::to_string (vbc);
+    sql += ",";
+    sql += std::to_string (seq);
+    sql += ")";
+}
+
+// Entry is an SLE or an STObjectView of one
+template <class Entry>
+static
+void
+appendRow (std::string& sql, Entry const& sle, std::uint32_t seq)
+{
+    appendRow (sql, sle.getAccountID (sfAccount),
+        sle.getAccountID (sfReferee),
+        sle.getFieldAmount (sfBalanceVBC).mantissa (), seq);
+}
+
+DividendIndex::DividendIndex (Application& app, beast::Journal journal)
+    : app_ (app)
+    , m_journal (journal)
+{
+}
+
+void
+DividendIndex::load ()
+{
+    if (loaded_)
+        return;
+    loaded_ = true;
+
+    db_ = std::make_unique <DatabaseCon> (setup_DatabaseCon (app_.config ()),
+        "dividend.db", DividendDBInit, DividendDBCount);
+
+    boost::optional<std::uint64_t> seq;
+    {
+        auto db = db_->checkoutDb ();
+        *db << "SELECT LedgerSeq FROM DividendIndexState WHERE Magic = 1;",
+            soci::into (seq);
+    }
+    seq_ = seq ? static_cast<std::uint32_t> (*seq) : 0;
+
+    JLOG (m_journal.info) << "Dividend index at ledger " << seq_;
+}
+
+void
+DividendIndex::setLedgerSeq (soci::session& session, std::uint32_t seq)
+{
+    session << "INSERT OR REPLACE INTO DividendIndexState "
+        "(Magic, LedgerSeq) VALUES (1, " << seq << ");";
+}
+
+void
+DividendIndex::apply (ReadView const& ledger)
+{
+    auto const seq = ledger.info ().seq;
+
+    // AccountRoots affected by the ledger, with the owner of deleted ones.
+    std::map<uint256, AccountID> affected;
+    for (auto const& item : ledger.txs)
+    {
+        if (!item.second || !item.second->isFieldPresent (sfAffectedNodes))
+            continue;
+
+        for (auto const& node : item.second->getFieldArray (sfAffectedNodes))
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltACCOUNT_ROOT)
+                continue;
+
+            AccountID account;
+            if (node.getFName () == sfDeletedNode &&
+                node.isFieldPresent (sfFinalFields))
+            {
+                auto const& fields = dynamic_cast<STObject const&> (
+                    node.peekAtField (sfFinalFields));
+                account = fields.getAccountID (sfAccount);
+            }
+            affected[node.getFieldH256 (sfLedgerIndex)] = account;
+        }
+    }
+
+    auto db = db_->checkoutDb ();
+    soci::transaction tr (*db);
+
+    std::string sql;
+    for (auto const& entry : affected)
+    {
+        auto const sle = ledger.read (Keylet (ltACCOUNT_ROOT, entry.first));
+        if (sle)
+            appendRow (sql, *sle, seq);
+        else if (entry.second.isNonZero ())
+            // Deleted, keep it as an account without balance.
+            appendRow (sql, entry.second, AccountID (), 0, seq);
+    }
+
+    if (!sql.empty ())
+        *db << (insertDividendAccounts + sql + ";");
+    setLedgerSeq (*db, seq);
+    tr.commit ();
+
+    seq_ = seq;
+
+    JLOG (m_journal.trace) << "Dividend index applied ledger " << seq
+        << ", " << affected.size () << " accounts";
+}
+
+void
+DividendIndex::applyDelta (Ledger const& from, Ledger const& to)
+{
+    auto const seq = to.info ().seq;
+
+    auto db = db_->checkoutDb ();
+    soci::transaction tr (*db);
+
+    std::string sql;
+    std::size_t rows = 0, total = 0;
+    from.stateMap ().visitDelta (to.stateMap (),
+        [&](uint256 const& key,
+            std::shared_ptr<SHAMapItem const> const& before,
+            std::shared_ptr<SHAMapItem const> const& after)
+        {
+            auto const& item = after ? after : before;
+            STObjectView const sle (item->slice ());
+            if (sle.getFieldU16 (sfLedgerEntryType) != ltACCOUNT_ROOT)
+                return true;
+
+            if (after)
+                appendRow (sql, sle, sle.isFieldPresent (sfPreviousTxnLgrSeq)
+                    ? sle.getFieldU32 (sfPreviousTxnLgrSeq) : seq);
+            else
+                // Deleted, keep it as an account without balance.
+                appendRow (sql, sle.getAccountID (sfAccount), AccountID (),
+                    0, seq);
+            ++total;
+            if (++rows == insertBatchSize)
+            {
+                *db << (insertDividendAccounts + sql + ";");
+                sql.clear ();
+                rows = 0;
+            }
+            return true;
+        });
+    if (rows != 0)
+        *db << (insertDividendAccounts + sql + ";");
+
+    setLedgerSeq (*db, seq);
+    tr.commit ();
+
+    JLOG (m_journal.debug) << "Dividend index moved from ledger "
+        << from.info ().seq << " to " << seq << ", " << total << " accounts";
+
+    seq_ = seq;
+}
+
+bool
+DividendIndex::catchUp (std::uint32_t seq)
+{
+    while (seq_ < seq && seq <= seq_ + maxCatchUp)
+    {
+        auto const ledger = app_.getLedgerMaster ().getLedgerBySeq (seq_ + 1);
+        if (!ledger)
+        {
+            JLOG (m_journal.debug) << "Dividend index missing ledger "
+                << (seq_ + 1);
+            break;
+        }
+        apply (*ledger);
+    }
+    if (seq_ >= seq)
+        return true;
+
+    // Without the ledgers between, the difference of the two state maps
+    // moves the index just as well.
+    auto const from = app_.getLedgerMaster ().getLedgerBySeq (seq_);
+    auto const to = app_.getLedgerMaster ().getLedgerBySeq (seq);
+    if (!from || !to)
+        return false;
+
+    try
+    {
+        applyDelta (*from, *to);
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        JLOG (m_journal.debug) << "Dividend index can not compare ledgers "
+            << from->info ().seq << " and " << seq << ": " << e.what ();
+        return false;
+    }
+    return true;
+}
+
+void
+DividendIndex::onLedgerAccepted (Ledger::pointer const& ledger)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    try
+    {
+        load ();
+
+        if (building_)
+            return;
+
+        auto const seq = ledger->info ().seq;
+        if (seq_ != 0 && seq <= seq_)
+            return;
+
+        if (seq_ != 0 && catchUp (seq - 1))
+        {
+            apply (*ledger);
+            return;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (m_journal.error) << "Dividend index update failed: " << e.what ();
+    }
+
+    if (!db_)
+        return;
+
+    // The index has a gap it can not fill, build it again from this ledger.
+    JLOG (m_journal.warning) << "Rebuilding dividend index from ledger "
+        << ledger->info ().seq;
+    seq_ = 0;
+    building_ = true;
+    app_.getJobQueue ().addJob (jtDIVIDEND_INDEX, "DividendIndex::rebuild",
+        [this, ledger] (Job&)
+        {
+            rebuild (ledger);
+        });
+}
+
+void
+DividendIndex::rebuild (Ledger::pointer const& ledger)
+{
+    auto const seq = ledger->info ().seq;
+
+    try
+    {
+        auto db = db_->checkoutDb ();
+        soci::transaction tr (*db);
+
+        *db << "DELETE FROM DividendAccounts;";
+
+        // The rows of each partition are built on its thread and inserted
+        // a batch at a time, one batch at once.
+        struct Rows
+        {
+            std::string sql;
+            std::size_t count = 0;
+        };
+        std::vector<Rows> rows (std::size_t (1) << (4 * rebuildDepth));
+        std::atomic<std::size_t> total (0);
+        std::mutex dbMutex;
+        ledger->visitStateItems (ltACCOUNT_ROOT, rebuildDepth,
+            ledger->stateMap ().family ().walkThreads (),
+            [&](std::size_t partition, SHAMapItem const& item)
+            {
+                STObjectView const sle (item.slice ());
+
+                // The ledger the AccountRoot last changed in lets older
+                // ledgers be served without reading every account again.
+                auto& r = rows[partition];
+                appendRow (r.sql, sle, sle.isFieldPresent (sfPreviousTxnLgrSeq)
+                    ? sle.getFieldU32 (sfPreviousTxnLgrSeq) : seq);
+                ++total;
+                if (++r.count == insertBatchSize)
+                {
+                    std::lock_guard<std::mutex> lock (dbMutex);
+                    *db << (insertDividendAccounts + r.sql + ";");
+                    r.sql.clear ();
+                    r.count = 0;
+                }
+            });
+        for (auto const& r : rows)
+        {
+            if (r.count != 0)
+                *db << (insertDividendAccounts + r.sql + ";");
+        }
+
+        setLedgerSeq (*db, seq);
+        tr.commit ();
+
+        std::lock_guard<std::mutex> lock (mutex_);
+        seq_ = seq;
+        building_ = false;
+
+        JLOG (m_journal.info) << "Dividend index built from ledger " << seq
+            << ", " << total.load () << " accounts";
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (m_journal.error) << "Dividend index rebuild failed: " << e.what ();
+
+        std::lock_guard<std::mutex> lock (mutex_);
+        seq_ = 0;
+        building_ = false;
+    }
+}
+
+bool
+DividendIndex::visit (ReadView const& ledger, Visitor const& visitor)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    load ();
+
+    if (!db_ || building_ || seq_ == 0)
+        return false;
+
+    auto const seq = ledger.info ().seq;
+    if (seq > seq_ && !catchUp (seq))
+        return false;
+
+    auto db = db_->checkoutDb ();
+
+    boost::optional<std::string> account, referee;
+    boost::optional<std::uint64_t> vbc, lastSeq;
+    soci::statement st = (db->prepare <<
+        "SELECT Account, Referee, BalanceVBC, LedgerSeq "
+        "FROM DividendAccounts;",
+        soci::into (account),
+        soci::into (referee),
+        soci::into (vbc),
+        soci::into (lastSeq));
+
+    st.execute ();
+    while (st.fetch ())
+    {
+        AccountID accountID;
+        if (!account || !accountID.SetHex (*account))
+            continue;
+
+        if (lastSeq && *lastSeq > seq)
+        {
+            // Changed after the ledger, read it as of the ledger.
+            if (auto const sle = ledger.read (keylet::account (accountID)))
+            {
+                visitor (accountID, sle->getAccountID (sfReferee),
+                    sle->getFieldAmount (sfBalanceVBC).mantissa ());
+            }
+            continue;
+        }
+
+        AccountID refereeID;
+        if (referee)
+            refereeID.SetHex (*referee);
+        visitor (accountID, refereeID, vbc ? *vbc : 0);
+    }
+    return true;
+}
+
+boost::optional<DividendMaster::ReferralSubtree>
+DividendIndex::subtree (AccountID const& account)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    load ();
+
+    if (!db_ || building_ || seq_ == 0)
+        return boost::none;
+
+    auto const hex = strHex (account.data (), account.size ());
+    auto db = db_->checkoutDb ();
+
+    // UNION drops the accounts already reached, so referral cycles end.
+    boost::optional<std::uint64_t> count, vbc;
+    *db << "WITH RECURSIVE Subtree (Account) AS ("
+               "SELECT Account FROM DividendAccounts WHERE Referee = '" << hex << "' "
+               "UNION "
+               "SELECT d.Account FROM DividendAccounts d "
+                   "JOIN Subtree s ON d.Referee = s.Account) "
+           "SELECT COUNT (*), SUM (d.BalanceVBC) FROM DividendAccounts d "
+               "JOIN Subtree s ON d.Account = s.Account "
+               "WHERE d.Account != '" << hex << "';",
+        soci::into (count),
+        soci::into (vbc);
+
+    return DividendMaster::ReferralSubtree {
+        seq_, count ? *count : 0, vbc ? *vbc : 0};
+}
+
+}
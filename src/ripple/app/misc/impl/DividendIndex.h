@@ -0,0 +1,94 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDINDEX_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDINDEX_H_INCLUDED
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/protocol/AccountID.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+class Application;
+
+/** Incrementally maintained inputs of the dividend calculation.
+
+    The sfReferee and sfBalanceVBC of every AccountRoot is kept in a side
+    database. Each validated ledger only updates the AccountRoots its
+    transactions affected, so a dividend run reads one table instead of
+    walking the whole state map.
+
+    A gap in the accepted ledgers is filled one ledger at a time or, when
+    it is long or ledgers in it are missing, from the difference of the
+    state maps at its ends.
+
+    The index is built once from a full state map walk, on a job, the
+    first time a ledger is accepted and whenever a gap can not be filled.
+*/
+class DividendIndex
+{
+public:
+    using Visitor = std::function<void (AccountID const& account,
+        AccountID const& referee, std::uint64_t vbc)>;
+
+    DividendIndex (Application& app, beast::Journal journal);
+
+    /** Apply the AccountRoot changes of a validated ledger. */
+    void
+    onLedgerAccepted (Ledger::pointer const& ledger);
+
+    /** Visit every AccountRoot as of a ledger.
+        @return false if the index can not serve this ledger, nothing is
+                visited then.
+    */
+    bool
+    visit (ReadView const& ledger, Visitor const& visitor);
+
+    /** Count the descendants of an account as of the last ledger applied.
+        @return boost::none if the index is not built.
+    */
+    boost::optional<DividendMaster::ReferralSubtree>
+    subtree (AccountID const& account);
+
+private:
+    void
+    load ();
+
+    bool
+    catchUp (std::uint32_t seq);
+
+    void
+    apply (ReadView const& ledger);
+
+    /** Move the index between two ledgers by comparing their state maps. */
+    void
+    applyDelta (Ledger const& from, Ledger const& to);
+
+    void
+    rebuild (Ledger::pointer const& ledger);
+
+    void
+    setLedgerSeq (soci::session& session, std::uint32_t seq);
+
+    /** Gap in accepted ledgers the index fills one ledger at a time. */
+    static std::uint32_t const maxCatchUp = 1024;
+
+    Application& app_;
+    beast::Journal m_journal;
+    std::unique_ptr<DatabaseCon> db_;
+
+    std::mutex mutex_;
+    bool loaded_ = false;
+    bool building_ = false;
+
+    /** Last ledger applied, zero if the index must be rebuilt. */
+    std::uint32_t seq_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendProgress.h>
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/basics/Log.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STObjectView.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TER.h>
+#include <algorithm>
+
+namespace ripple {
+
+DividendProgress::DividendProgress (beast::Journal journal)
+    : m_journal (journal)
+{
+    total_.fill (0);
+    done_.fill (0);
+}
+
+bool
+DividendProgress::tracking (std::uint32_t dividendLedger,
+    SHAMapHash const& hash) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return seq_ != 0 && dividendLedger == dividendLedger_ && hash == hash_;
+}
+
+void
+DividendProgress::track (std::uint32_t dividendLedger, SHAMap const& map,
+    ReadView const& ledger)
+{
+    std::array<std::uint32_t, shardCount> total, done;
+    total.fill (0);
+    done.fill (0);
+
+    for (auto const& item : map)
+    {
+        STObjectView const tx (item.slice ());
+        auto const account = tx.getAccountID (sfDestination);
+        auto const i = shard (account);
+        ++total[i];
+
+        auto const sle = ledger.read (keylet::account (account));
+        if (sle && sle->getFieldU32 (sfDividendLedger) == dividendLedger)
+            ++done[i];
+    }
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    hash_ = map.getHash ();
+    dividendLedger_ = dividendLedger;
+    seq_ = ledger.info ().seq;
+    total_ = total;
+    done_ = done;
+
+    JLOG (m_journal.info) << "Dividend progress for ledger " << dividendLedger
+        << " counted at ledger " << seq_;
+}
+
+bool
+DividendProgress::onLedgerAccepted (ReadView const& ledger)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    auto const seq = ledger.info ().seq;
+    if (seq_ == 0 || seq <= seq_)
+        return false;
+
+    if (seq != seq_ + 1)
+    {
+        // A ledger was missed, count again on the next request.
+        JLOG (m_journal.debug) << "Dividend progress lost at ledger " << seq;
+        seq_ = 0;
+        return false;
+    }
+    seq_ = seq;
+
+    bool changed = false;
+    for (auto const& item : ledger.txs)
+    {
+        auto const& tx = *item.first;
+        if (tx.getTxnType () != ttDIVIDEND ||
+            tx.getFieldU32 (sfDividendLedger) != dividendLedger_)
+            continue;
+
+        auto const type = tx.getFieldU8 (sfDividendType);
+        if (type != DividendMaster::DivType_Apply &&
+            type != DividendMaster::DivType_ApplyBatch)
+            continue;
+
+        if (!item.second || item.second->getFieldU8 (
+                sfTransactionResult) != tesSUCCESS)
+            continue;
+
+        // A destination is only paid once per dividend. A batch skips
+        // those paid before it, the counts are capped by the totals.
+        if (type == DividendMaster::DivType_Apply)
+            ++done_[shard (tx.getAccountID (sfDestination))];
+        else for (auto const& payee : tx.getFieldArray (sfDividendPayees))
+            ++done_[shard (payee.getAccountID (sfDestination))];
+        changed = true;
+    }
+    return changed;
+}
+
+Json::Value
+DividendProgress::getJson () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    Json::Value ret (Json::objectValue);
+    Json::Value& shards = (ret["shards"] = Json::arrayValue);
+
+    std::uint32_t done = 0, left = 0;
+    for (std::size_t i = 0; i < shardCount; ++i)
+    {
+        auto const shardDone = std::min (done_[i], total_[i]);
+        Json::Value& entry = shards.append (Json::objectValue);
+        entry["done"] = shardDone;
+        entry["left"] = total_[i] - shardDone;
+        done += shardDone;
+        left += total_[i] - shardDone;
+    }
+    ret["done"] = done;
+    ret["left"] = left;
+    ret["validated_ledger"] = seq_;
+    return ret;
+}
+
+}
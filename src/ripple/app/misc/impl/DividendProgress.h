@@ -0,0 +1,79 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDPROGRESS_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDPROGRESS_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/shamap/SHAMap.h>
+#include <beast/utility/Journal.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace ripple {
+
+/** Running count of the transactions a dividend applied.
+
+    The dividend transaction map and the destination of every transaction
+    are read once, when a dividend is first tracked. After that each
+    validated ledger only adds the DivType_Apply transactions it holds, so
+    reporting the progress does not read the ledger at all.
+
+    Transactions are grouped in shards by the first bits of their
+    destination, to tell which part of the accounts is lagging.
+*/
+class DividendProgress
+{
+public:
+    static std::size_t const shardCount = 16;
+
+    explicit
+    DividendProgress (beast::Journal journal);
+
+    /** @return true if the counters describe this dividend. */
+    bool
+    tracking (std::uint32_t dividendLedger, SHAMapHash const& hash) const;
+
+    /** Start counting a dividend.
+        @param map The complete dividend transaction map.
+        @param ledger The validated ledger the count starts from.
+    */
+    void
+    track (std::uint32_t dividendLedger, SHAMap const& map,
+        ReadView const& ledger);
+
+    /** Add the dividend transactions of a validated ledger.
+        @return true if the counters changed.
+    */
+    bool
+    onLedgerAccepted (ReadView const& ledger);
+
+    /** Counters as reported by load_dividend and the dividend stream. */
+    Json::Value
+    getJson () const;
+
+private:
+    static
+    std::size_t
+    shard (AccountID const& account)
+    {
+        return *account.begin () >> 4;
+    }
+
+    beast::Journal m_journal;
+
+    mutable std::mutex mutex_;
+
+    SHAMapHash hash_;
+    std::uint32_t dividendLedger_ = 0;
+
+    /** Last ledger counted, zero if nothing is tracked. */
+    std::uint32_t seq_ = 0;
+
+    std::array<std::uint32_t, shardCount> total_;
+    std::array<std::uint32_t, shardCount> done_;
+};
+
+}
+
+#endif
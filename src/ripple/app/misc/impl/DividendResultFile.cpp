@@ -0,0 +1,160 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendResultFile.h>
+#include <ripple/basics/contract.h>
+#include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace ripple {
+
+DividendResultFile::DividendResultFile (boost::filesystem::path const& path)
+    : path_ (path)
+{
+}
+
+DividendResultFile::~DividendResultFile ()
+{
+    try
+    {
+        clear ();
+    }
+    catch (std::exception const&)
+    {
+    }
+}
+
+void
+DividendResultFile::create ()
+{
+    clear ();
+
+    out_ = std::make_unique<std::ofstream> (path_.string ().c_str (),
+        std::ios::binary | std::ios::trunc);
+    if (!*out_)
+        Throw<std::runtime_error> ("can not create " + path_.string ());
+}
+
+void
+DividendResultFile::append (AccountID const& account, Result const& result)
+{
+    assert (out_);
+
+    Record r;
+    std::memcpy (r.account, account.data (), sizeof (r.account));
+    r.coins = std::get<0> (result);
+    r.coinsVBC = std::get<1> (result);
+    r.coinsVBCRank = std::get<2> (result);
+    r.coinsVBCSprd = std::get<3> (result);
+    r.vRank = std::get<4> (result);
+    r.vSprd = std::get<5> (result);
+    r.tSprd = std::get<6> (result);
+
+    if (!out_->write (reinterpret_cast<char const*> (&r), sizeof (r)))
+        Throw<std::runtime_error> ("can not write " + path_.string ());
+    ++size_;
+}
+
+void
+DividendResultFile::finish ()
+{
+    using namespace boost::interprocess;
+
+    assert (out_);
+    out_->close ();
+    bool const ok = !out_->fail ();
+    out_.reset ();
+    if (!ok)
+        Throw<std::runtime_error> ("can not write " + path_.string ());
+
+    if (size_ == 0)
+        return;
+
+    file_mapping (path_.string ().c_str (), read_write).swap (file_);
+    mapped_region (file_, read_write, 0, size_ * sizeof (Record)).swap (region_);
+
+    auto const first = static_cast<Record*> (region_.get_address ());
+    auto const last = first + size_;
+    auto const less = [](Record const& a, Record const& b)
+    {
+        return std::memcmp (a.account, b.account, sizeof (a.account)) < 0;
+    };
+    std::sort (first, last, less);
+
+    // Accounts added twice, like the account collecting the remainder of
+    // the dividend, get the sum of their results.
+    auto out = first;
+    for (auto in = first + 1; in != last; ++in)
+    {
+        if (less (*out, *in))
+        {
+            *++out = *in;
+            continue;
+        }
+        out->vRank = std::max (out->vRank, in->vRank);
+        out->coins += in->coins;
+        out->coinsVBC += in->coinsVBC;
+        out->coinsVBCRank += in->coinsVBCRank;
+        out->coinsVBCSprd += in->coinsVBCSprd;
+        out->vSprd += in->vSprd;
+        out->tSprd += in->tSprd;
+    }
+    size_ = out - first + 1;
+}
+
+void
+DividendResultFile::clear ()
+{
+    out_.reset ();
+    boost::interprocess::mapped_region ().swap (region_);
+    boost::interprocess::file_mapping ().swap (file_);
+    size_ = 0;
+
+    boost::system::error_code ec;
+    boost::filesystem::remove (path_, ec);
+}
+
+DividendResultFile::Result
+DividendResultFile::toResult (Record const& r)
+{
+    return Result (r.coins, r.coinsVBC, r.coinsVBCRank, r.coinsVBCSprd,
+        r.vRank, r.vSprd, r.tSprd);
+}
+
+AccountID
+DividendResultFile::account (std::size_t i) const
+{
+    assert (i < size_ && !out_);
+    return AccountID::fromVoid (records ()[i].account);
+}
+
+DividendResultFile::Result
+DividendResultFile::result (std::size_t i) const
+{
+    assert (i < size_ && !out_);
+    return toResult (records ()[i]);
+}
+
+boost::optional<DividendResultFile::Result>
+DividendResultFile::find (AccountID const& account) const
+{
+    if (size_ == 0 || out_)
+        return boost::none;
+
+    auto const first = records ();
+    auto const last = first + size_;
+    auto const iter = std::lower_bound (first, last, account,
+        [](Record const& r, AccountID const& a)
+        {
+            return std::memcmp (r.account, a.data (), sizeof (r.account)) < 0;
+        });
+    if (iter == last ||
+        std::memcmp (iter->account, account.data (), sizeof (iter->account)))
+    {
+        return boost::none;
+    }
+    return toResult (*iter);
+}
+
+}
@@ -0,0 +1,103 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDRESULTFILE_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDRESULTFILE_H_INCLUDED
+
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/protocol/AccountID.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+
+namespace ripple {
+
+/** Per-account dividend results kept in a file instead of in memory.
+
+    Results are appended in any order as they are computed, then sorted
+    by account in place through a memory mapping of the file. Reading a
+    result only touches the pages holding it, so the resident memory of
+    a dividend does not grow with the number of accounts.
+*/
+class DividendResultFile
+{
+public:
+    using Result = DividendMaster::AccountsDividend::mapped_type;
+
+    explicit
+    DividendResultFile (boost::filesystem::path const& path);
+
+    ~DividendResultFile ();
+
+    DividendResultFile (DividendResultFile const&) = delete;
+    DividendResultFile& operator= (DividendResultFile const&) = delete;
+
+    /** Start a new set of results, discarding the previous one. */
+    void
+    create ();
+
+    /** Add the result of one account. An account added more than once
+        gets the sum of its results.
+    */
+    void
+    append (AccountID const& account, Result const& result);
+
+    /** Sort the results and make them readable. */
+    void
+    finish ();
+
+    /** Discard the results and remove the file. */
+    void
+    clear ();
+
+    /** Number of accounts with a result. */
+    std::size_t
+    size () const
+    {
+        return size_;
+    }
+
+    AccountID
+    account (std::size_t i) const;
+
+    Result
+    result (std::size_t i) const;
+
+    boost::optional<Result>
+    find (AccountID const& account) const;
+
+private:
+    /** On-disk layout of one result, in host byte order. */
+    struct Record
+    {
+        std::uint8_t account[20];
+        std::uint32_t vRank;
+        std::uint64_t coins;
+        std::uint64_t coinsVBC;
+        std::uint64_t coinsVBCRank;
+        std::uint64_t coinsVBCSprd;
+        std::uint64_t vSprd;
+        std::uint64_t tSprd;
+    };
+
+    Record const*
+    records () const
+    {
+        return static_cast<Record const*> (region_.get_address ());
+    }
+
+    static
+    Result
+    toResult (Record const& r);
+
+    boost::filesystem::path path_;
+    std::unique_ptr<std::ofstream> out_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::size_t size_ = 0;
+};
+
+}
+
+#endif
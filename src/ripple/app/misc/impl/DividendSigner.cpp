@@ -0,0 +1,54 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendSigner.h>
+#include <ripple/app/main/CollectorManager.h>
+#include <ripple/basics/Log.h>
+#include <chrono>
+
+namespace ripple {
+
+DividendSigner::DividendSigner (Section const& section, CollectorManager& cm,
+    beast::Journal journal)
+    : m_journal (journal)
+{
+    auto const& group (cm.group ("dividend"));
+    signed_ = group->make_counter ("signed");
+    signTime_ = group->make_event ("sign_time");
+
+    auto const secret_key = get<std::string> (section, "secret_key");
+    if (secret_key.empty ())
+        return;
+
+    RippleAddress secret = RippleAddress::createSeedGeneric (secret_key);
+    RippleAddress generator = RippleAddress::createGeneratorPublic (secret);
+    accountPrivate_ = RippleAddress::createAccountPrivate (generator, secret, 0);
+    publicKey_ = RippleAddress::createAccountPublic (
+        generator, 0).getAccountPublic ();
+    enabled_ = true;
+
+    JLOG (m_journal.info) << "Dividend signing key loaded";
+}
+
+void
+DividendSigner::sign (STTx& tx) const
+{
+    auto const start = std::chrono::steady_clock::now ();
+    tx.sign (accountPrivate_);
+    ++signed_;
+    signTime_.notify (static_cast <beast::insight::Event::value_type> (
+        std::chrono::duration_cast <std::chrono::milliseconds> (
+            std::chrono::steady_clock::now () - start)));
+}
+
+void
+DividendSigner::sign (std::vector<std::shared_ptr<STTx>> const& txs) const
+{
+    auto const start = std::chrono::steady_clock::now ();
+    for (auto const& tx : txs)
+        tx->sign (accountPrivate_);
+    signed_.increment (txs.size ());
+    signTime_.notify (static_cast <beast::insight::Event::value_type> (
+        std::chrono::duration_cast <std::chrono::milliseconds> (
+            std::chrono::steady_clock::now () - start)));
+}
+
+}
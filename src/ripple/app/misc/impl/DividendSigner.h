@@ -0,0 +1,60 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDSIGNER_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDSIGNER_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/protocol/RippleAddress.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/insight/Counter.h>
+#include <beast/insight/Event.h>
+#include <beast/utility/Journal.h>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+class CollectorManager;
+
+/** Signs dividend transactions with the [dividend_account] key.
+
+    The keypair is derived from the configured secret once, when the
+    server starts, instead of for every transaction.
+*/
+class DividendSigner
+{
+public:
+    DividendSigner (Section const& section, CollectorManager& cm,
+        beast::Journal journal);
+
+    /** @return true if this server has a dividend secret key. */
+    bool
+    enabled () const
+    {
+        return enabled_;
+    }
+
+    /** Public key for sfSigningPubKey of dividend transactions. */
+    Blob const&
+    publicKey () const
+    {
+        return publicKey_;
+    }
+
+    void
+    sign (STTx& tx) const;
+
+    void
+    sign (std::vector<std::shared_ptr<STTx>> const& txs) const;
+
+private:
+    beast::Journal m_journal;
+    bool enabled_ = false;
+    RippleAddress accountPrivate_;
+    Blob publicKey_;
+
+    beast::insight::Counter signed_;
+    beast::insight::Event signTime_;
+};
+
+}
+
+#endif
@@ -0,0 +1,337 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendSubmitter.h>
+#include <ripple/app/misc/impl/DividendSigner.h>
+#include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TxQ.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STObjectView.h>
+#include <ripple/protocol/STTx.h>
+#include <algorithm>
+
+namespace ripple {
+
+DividendSubmitter::DividendSubmitter (Application& app,
+    DividendSigner const& signer, beast::Journal journal)
+    : app_ (app)
+    , signer_ (signer)
+    , m_journal (journal)
+{
+}
+
+bool
+DividendSubmitter::load (ReadView const& ledger, SLE const& dividendObj)
+{
+    SHAMapHash const hash (dividendObj.getFieldH256 (sfDividendHash));
+    auto const dividendLedger = dividendObj.getFieldU32 (sfDividendLedger);
+    bool const batching = ledger.rules ().enabled (
+        featureDividendBatch, app_.config ().features);
+    if (map_ && hash == hash_ && dividendLedger == dividendLedger_ &&
+            batching == batching_)
+        return true;
+
+    map_.reset ();
+    keys_.clear ();
+    destinations_.clear ();
+    batches_.clear ();
+    applied_.clear ();
+    sent_.clear ();
+    inFlight_.clear ();
+    appliedCount_ = 0;
+    cursor_ = 0;
+
+    auto map = std::make_shared<SHAMap> (
+        SHAMapType::TRANSACTION, hash.as_uint256 (), app_.family ());
+    if (!map->fetchRoot (hash, nullptr))
+    {
+        JLOG (m_journal.fatal) << "Dividend job, fetch full root hash failed.";
+        return false;
+    }
+
+    std::vector<SHAMapNodeID> nodeIDs;
+    std::vector<uint256> nodeHashes;
+    map->getMissingNodes (nodeIDs, nodeHashes, 1, nullptr);
+    if (!nodeIDs.empty ())
+    {
+        JLOG (m_journal.fatal) << "Dividend job, full dividend map is incomplete.";
+        return false;
+    }
+
+    // Every transaction is read once per dividend, and only its
+    // destination is decoded.
+    for (auto const& item : *map)
+    {
+        STObjectView const tx (item.slice ());
+        keys_.push_back (item.key ());
+        destinations_.push_back (tx.getAccountID (sfDestination));
+    }
+
+    if (batching &&
+        DividendBatch::split (keys_, DividendBatch::maxPayees, batches_) !=
+            hash.as_uint256 ())
+    {
+        // Validators would reject every batch, submit one at a time.
+        JLOG (m_journal.error) << "Dividend job, batches do not hash to "
+            << hash;
+        batches_.clear ();
+    }
+
+    hash_ = hash;
+    dividendLedger_ = dividendLedger;
+    batching_ = batching;
+    map_ = std::move (map);
+
+    applied_.assign (keys_.size (), false);
+    sent_.assign (units (), false);
+    for (std::size_t i = 0; i < keys_.size (); ++i)
+    {
+        if (isApplied (ledger, i))
+            setApplied (i);
+    }
+
+    // Continue after the last transaction the dividend applied.
+    auto const next = std::upper_bound (keys_.begin (), keys_.end (),
+        dividendObj.getFieldH256 (sfDividendMarker)) - keys_.begin ();
+    cursor_ = 0;
+    while (cursor_ < units () && last (cursor_) <= next)
+        ++cursor_;
+    if (cursor_ == units ())
+        cursor_ = 0;
+
+    JLOG (m_journal.info) << "Dividend job, loaded " << keys_.size ()
+        << " transactions in " << units () << " units for ledger "
+        << dividendLedger_ << ", " << appliedCount_ << " applied";
+    return true;
+}
+
+bool
+DividendSubmitter::isApplied (ReadView const& ledger, std::size_t i) const
+{
+    auto const sle = ledger.read (keylet::account (destinations_[i]));
+    if (!sle)
+    {
+        JLOG (m_journal.warning) << "Dividend job, account not found: "
+            << destinations_[i];
+        // The transaction can never apply, do not wait for it.
+        return true;
+    }
+    return sle->getFieldU32 (sfDividendLedger) == dividendLedger_;
+}
+
+void
+DividendSubmitter::setApplied (std::size_t i)
+{
+    if (!applied_[i])
+    {
+        applied_[i] = true;
+        ++appliedCount_;
+    }
+}
+
+bool
+DividendSubmitter::isUnitApplied (std::size_t unit) const
+{
+    for (auto i = first (unit); i < last (unit); ++i)
+    {
+        if (!applied_[i])
+            return false;
+    }
+    return true;
+}
+
+void
+DividendSubmitter::refresh (ReadView const& ledger)
+{
+    auto const seq = ledger.info ().seq;
+
+    std::deque<std::pair<std::size_t, std::uint32_t>> pending;
+    for (auto const& sent : inFlight_)
+    {
+        for (auto i = first (sent.first); i < last (sent.first); ++i)
+        {
+            if (!applied_[i] && isApplied (ledger, i))
+                setApplied (i);
+        }
+
+        if (isUnitApplied (sent.first))
+            continue;
+        if (seq > sent.second + retryLedgers)
+            sent_[sent.first] = false;
+        else
+            pending.push_back (sent);
+    }
+    inFlight_.swap (pending);
+}
+
+std::size_t
+DividendSubmitter::capacity () const
+{
+    auto const metrics = app_.getTxQ ().getMetrics (
+        *app_.openLedger ().current ());
+    return std::min<std::size_t> (
+        std::max<std::size_t> (metrics.dividendsPerLedger, minBatchSize),
+            maxBatchSize);
+}
+
+bool
+DividendSubmitter::submit (ReadView const& ledger, SLE const& dividendObj)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    Items batch;
+    std::vector<std::pair<DividendBatch::Batch, Items>> subtrees;
+    try
+    {
+        if (!load (ledger, dividendObj))
+            return false;
+
+        refresh (ledger);
+
+        if (appliedCount_ == keys_.size ())
+        {
+            JLOG (m_journal.debug) << "Dividend job, all " << keys_.size ()
+                << " transactions applied";
+            return true;
+        }
+
+        auto const capacity = batches_.empty () ? this->capacity () :
+            std::min (this->capacity (), maxBatchesPerLedger);
+        auto const budget = capacity > inFlight_.size ()
+            ? capacity - inFlight_.size () : 0;
+        auto const seq = ledger.info ().seq;
+
+        for (std::size_t n = 0; n < units () &&
+            batch.size () + subtrees.size () < budget; ++n)
+        {
+            auto const u = cursor_;
+            if (++cursor_ == units ())
+                cursor_ = 0;
+
+            if (sent_[u] || isUnitApplied (u))
+                continue;
+
+            Items items;
+            for (auto i = first (u); i < last (u); ++i)
+            {
+                if (auto const& item = map_->peekItem (keys_[i]))
+                    items.push_back (item);
+            }
+            if (items.size () != last (u) - first (u))
+                continue;
+
+            sent_[u] = true;
+            inFlight_.emplace_back (u, seq);
+            if (batches_.empty ())
+                batch.push_back (items.front ());
+            else
+                subtrees.emplace_back (batches_[u], std::move (items));
+        }
+
+        JLOG (m_journal.info) << "Dividend job, submit "
+            << batch.size () + subtrees.size () << " transactions, "
+            << inFlight_.size () << " in flight, " << appliedCount_
+            << " of " << keys_.size () << " applied";
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (m_journal.error) << "Dividend job, submit failed: " << e.what ();
+        // Read the map again on the next ledger.
+        map_.reset ();
+        return false;
+    }
+
+    // Sign in parallel, NetworkOPs batches the transactions it receives.
+    for (std::size_t b = 0; b < batch.size (); b += signBatchSize)
+    {
+        auto const items = std::make_shared<Items> (batch.begin () + b,
+            batch.begin () + std::min (b + signBatchSize, batch.size ()));
+        app_.getJobQueue ().addJob (jtDIVIDEND_SIGN, "DividendSubmitter::sign",
+            [this, items] (Job&)
+            {
+                sign (*items);
+            });
+    }
+
+    // A batch is one large transaction, each is signed by its own job.
+    for (auto& subtree : subtrees)
+    {
+        auto const job = std::make_shared<
+            std::pair<DividendBatch::Batch, Items>> (std::move (subtree));
+        auto const dividendLedger = dividendLedger_;
+        auto const dividendHash = hash_.as_uint256 ();
+        app_.getJobQueue ().addJob (jtDIVIDEND_SIGN, "DividendSubmitter::sign",
+            [this, job, dividendLedger, dividendHash] (Job&)
+            {
+                signBatch (job->first, job->second,
+                    dividendLedger, dividendHash);
+            });
+    }
+    return false;
+}
+
+void
+DividendSubmitter::sign (Items const& items)
+{
+    std::vector<std::shared_ptr<STTx>> txs;
+    txs.reserve (items.size ());
+    for (auto const& item : items)
+    {
+        try
+        {
+            SerialIter sit (item->data (), item->size ());
+            txs.push_back (std::make_shared<STTx> (std::ref (sit)));
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (m_journal.warning) << "Dividend job, bad tx "
+                << item->key () << ": " << e.what ();
+        }
+    }
+
+    signer_.sign (txs);
+
+    for (auto const& tx : txs)
+    {
+        JLOG (m_journal.trace) << "Dividend job, submit signed tx "
+            << tx->getTransactionID ();
+        app_.getOPs ().submitTransaction (tx);
+    }
+}
+
+void
+DividendSubmitter::signBatch (DividendBatch::Batch const& batch,
+    Items const& items, std::uint32_t dividendLedger,
+        uint256 const& dividendHash)
+{
+    std::shared_ptr<STTx> tx;
+    try
+    {
+        STArray payees (sfDividendPayees, items.size ());
+        for (auto const& item : items)
+        {
+            SerialIter sit (item->data (), item->size ());
+            payees.push_back (DividendBatch::makePayee (STTx (sit)));
+        }
+        tx = std::make_shared<STTx> (DividendBatch::makeTx (dividendLedger,
+            dividendHash, batch, std::move (payees), signer_.publicKey ()));
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (m_journal.warning) << "Dividend job, bad batch at depth "
+            << batch.depth << ": " << e.what ();
+        return;
+    }
+
+    signer_.sign (*tx);
+
+    JLOG (m_journal.trace) << "Dividend job, submit signed batch "
+        << tx->getTransactionID () << " of " << items.size ()
+        << " transactions";
+    app_.getOPs ().submitTransaction (tx);
+}
+
+}
@@ -0,0 +1,139 @@
+#ifndef RIPPLE_APP_MISC_IMPL_DIVIDENDSUBMITTER_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_DIVIDENDSUBMITTER_H_INCLUDED
+
+#include <ripple/app/misc/DividendBatch.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <ripple/shamap/SHAMap.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+class DividendSigner;
+
+/** Streams the transactions of a dividend in progress to the network.
+
+    The dividend transaction map is read once per dividend, keeping the
+    key and destination of every transaction and a bitmap of destinations
+    the dividend already applied to. Each call continues from a cursor and
+    hands at most one ledger's worth of transactions to NetworkOPs, signed
+    in parallel on the job queue. Transactions which do not apply within a
+    few ledgers are submitted again once the cursor comes back to them.
+
+    Once DividendBatch is enabled the map is split into subtrees of at
+    most DividendBatch::maxPayees transactions, and each subtree is
+    submitted as one DivType_ApplyBatch transaction instead.
+*/
+class DividendSubmitter
+{
+public:
+    DividendSubmitter (Application& app, DividendSigner const& signer,
+        beast::Journal journal);
+
+    /** Submit the next batch of the dividend described by dividendObj.
+        @param ledger The ledger used to tell applied transactions.
+        @return true once every transaction of the dividend has applied.
+    */
+    bool
+    submit (ReadView const& ledger, SLE const& dividendObj);
+
+private:
+    using Items = std::vector<std::shared_ptr<SHAMapItem const>>;
+
+    bool
+    load (ReadView const& ledger, SLE const& dividendObj);
+
+    bool
+    isApplied (ReadView const& ledger, std::size_t i) const;
+
+    void
+    setApplied (std::size_t i);
+
+    /** Transactions are submitted in units, a key or a batch of keys. */
+    std::size_t
+    units () const
+    {
+        return batches_.empty () ? keys_.size () : batches_.size ();
+    }
+
+    std::size_t
+    first (std::size_t unit) const
+    {
+        return batches_.empty () ? unit : batches_[unit].first;
+    }
+
+    std::size_t
+    last (std::size_t unit) const
+    {
+        return batches_.empty () ? unit + 1 : batches_[unit].last;
+    }
+
+    bool
+    isUnitApplied (std::size_t unit) const;
+
+    void
+    refresh (ReadView const& ledger);
+
+    std::size_t
+    capacity () const;
+
+    void
+    sign (Items const& items);
+
+    void
+    signBatch (DividendBatch::Batch const& batch, Items const& items,
+        std::uint32_t dividendLedger, uint256 const& dividendHash);
+
+    /** Ledgers a submitted transaction has to apply before it is retried. */
+    static std::uint32_t const retryLedgers = 4;
+
+    /** Bounds on the transactions submitted for one ledger. */
+    static std::size_t const minBatchSize = 200;
+    static std::size_t const maxBatchSize = 10000;
+
+    /** Batch transactions submitted for one ledger, each crediting up to
+        DividendBatch::maxPayees accounts.
+    */
+    static std::size_t const maxBatchesPerLedger = 64;
+
+    /** Transactions signed by one job. */
+    static std::size_t const signBatchSize = 64;
+
+    Application& app_;
+    DividendSigner const& signer_;
+    beast::Journal m_journal;
+
+    std::mutex mutex_;
+
+    SHAMapHash hash_;
+    std::uint32_t dividendLedger_ = 0;
+    std::shared_ptr<SHAMap> map_;
+    bool batching_ = false;
+
+    /** Keys of the dividend map in key order and their destination. */
+    std::vector<uint256> keys_;
+    std::vector<AccountID> destinations_;
+
+    /** Subtrees of the map in key order, empty unless batching. */
+    std::vector<DividendBatch::Batch> batches_;
+
+    /** Applied by key, sent by unit. */
+    std::vector<bool> applied_;
+    std::vector<bool> sent_;
+    std::size_t appliedCount_ = 0;
+    std::size_t cursor_ = 0;
+
+    /** Submitted units and the ledger they were submitted on. */
+    std::deque<std::pair<std::size_t, std::uint32_t>> inFlight_;
+};
+
+}
+
+#endif
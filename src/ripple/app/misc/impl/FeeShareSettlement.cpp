@@ -0,0 +1,137 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/FeeShareSettlement.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/st.h>
+#include <ripple/protocol/TxFormats.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <algorithm>
+#include <tuple>
+
+namespace ripple {
+namespace FeeShareSettlement {
+
+static
+bool
+lessShare (STObject const& a, STObject const& b)
+{
+    auto const& ia = a.getFieldAmount (sfAmount).issue ();
+    auto const& ib = b.getFieldAmount (sfAmount).issue ();
+    return std::make_tuple (a.getAccountID (sfAccount),
+            ia.currency, ia.account) <
+        std::make_tuple (b.getAccountID (sfAccount),
+            ib.currency, ib.account);
+}
+
+bool
+isCanonical (STArray const& takers)
+{
+    for (auto const& taker : takers)
+    {
+        if (taker.getFName () != sfFeeShareTaker ||
+                ! taker.isFieldPresent (sfAccount) ||
+                ! taker.isFieldPresent (sfAmount))
+            return false;
+
+        auto const& amount = taker.getFieldAmount (sfAmount);
+        if (amount.native () || amount <= zero)
+            return false;
+    }
+
+    return std::adjacent_find (takers.begin (), takers.end (),
+        [](STObject const& a, STObject const& b)
+        {
+            return ! lessShare (a, b);
+        }) == takers.end ();
+}
+
+void
+addAccruals (ReadView const& ledger, STArray& totals)
+{
+    for (auto const& item : ledger.txs)
+    {
+        if (! item.second ||
+                ! item.second->isFieldPresent (sfFeeShareAccruals))
+            continue;
+
+        for (auto const& share :
+                item.second->getFieldArray (sfFeeShareAccruals))
+            addFeeShare (totals, share.getAccountID (sfAccount),
+                share.getFieldAmount (sfAmount));
+    }
+}
+
+boost::optional<STTx>
+build (ReadView const& lastClosedLedger, LedgerLoader const& load,
+    beast::Journal j)
+{
+    auto const sle = lastClosedLedger.read (keylet::feeShareAccrual ());
+    if (! sle)
+        return boost::none;
+
+    auto const settled = sle->getFieldU32 (sfLedgerSequence);
+    auto const lastSeq = lastClosedLedger.seq ();
+    if (settled >= lastSeq)
+        return boost::none;
+    auto const through = std::min (lastSeq, settled + maxLedgers);
+
+    STArray totals (sfFeeShareTakers);
+    for (auto seq = settled + 1; seq <= through; ++seq)
+    {
+        if (seq == lastSeq)
+        {
+            addAccruals (lastClosedLedger, totals);
+            continue;
+        }
+
+        auto const ledger = load (seq);
+        if (! ledger)
+        {
+            JLOG (j.debug) << "FeeShareSettle: ledger " << seq <<
+                " not available";
+            return boost::none;
+        }
+        addAccruals (*ledger, totals);
+    }
+
+    // Settling nothing only moves the range forward, once it is full
+    if (totals.empty () && through - settled < maxLedgers)
+        return boost::none;
+
+    totals.sort (&lessShare);
+    return makeTx (through, totals);
+}
+
+STTx
+makeTx (std::uint32_t settledThrough, STArray const& takers)
+{
+    STTx tx (ttFEE_SHARE_SETTLE);
+    tx[sfAccount] = AccountID ();
+    tx.setFieldU32 (sfLedgerSequence, settledThrough);
+    if (! takers.empty ())
+        tx.setFieldArray (sfFeeShareTakers, takers);
+    return tx;
+}
+
+void
+addToPosition (ReadView const& lastClosedLedger, LedgerLoader const& load,
+    std::shared_ptr<SHAMap> const& initialPosition, beast::Journal j)
+{
+    auto const tx = build (lastClosedLedger, load, j);
+    if (! tx)
+        return;
+
+    auto const txID = tx->getTransactionID ();
+    JLOG (j.debug) << "Settling fee shares through ledger " <<
+        tx->getFieldU32 (sfLedgerSequence) << ": " << txID;
+
+    Serializer s;
+    tx->add (s);
+    if (! initialPosition->addGiveItem (
+            make_shamapitem (txID, s.peekData ()), true, false))
+        JLOG (j.warning) << "Ledger already had fee share settlement";
+}
+
+} // FeeShareSettlement
+} // ripple
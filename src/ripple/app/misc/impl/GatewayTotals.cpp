@@ -0,0 +1,222 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/GatewayTotals.h>
+#include <ripple/app/paths/RippleState.h>
+#include <ripple/ledger/View.h>
+#include <ripple/ledger/TxMeta.h>
+#include <algorithm>
+
+namespace ripple {
+
+GatewayTotals::GatewayTotals (std::size_t issuers, LedgerIndex idle)
+    : maxIssuers_ (issuers)
+    , idle_ (idle)
+{
+}
+
+GatewayTotals::Totals
+GatewayTotals::scan (ReadView const& ledger, AccountID const& issuer)
+{
+    Totals totals;
+    forEachItem (ledger, issuer,
+        [&](std::shared_ptr<SLE const> const& sle)
+        {
+            if (auto rs = RippleState::makeItem (issuer, sle))
+                apply (totals, rs->getAccountIDPeer (), rs->getBalance (),
+                    true);
+        });
+    return totals;
+}
+
+GatewayTotals::Totals
+GatewayTotals::get (ReadView const& ledger, AccountID const& issuer)
+{
+    auto const& info = ledger.info ();
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const iter = issuers_.find (issuer);
+        if (iter != issuers_.end () &&
+            info.seq == seq_ && info.hash == hash_)
+        {
+            iter->second.used = seq_;
+            return iter->second.totals;
+        }
+    }
+
+    auto totals = scan (ledger, issuer);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    // Only the last ledger added is followed
+    if (info.seq != seq_ || info.hash != hash_ || maxIssuers_ == 0)
+        return totals;
+
+    if (issuers_.size () >= maxIssuers_ && issuers_.count (issuer) == 0)
+    {
+        auto const oldest = std::min_element (
+            issuers_.begin (), issuers_.end (),
+            [](auto const& a, auto const& b)
+            {
+                return a.second.used < b.second.used;
+            });
+        issuers_.erase (oldest);
+    }
+    issuers_[issuer] = {totals, seq_};
+    return totals;
+}
+
+void
+GatewayTotals::addLedger (AcceptedLedger const& ledger)
+{
+    auto const& info = ledger.getLedger ()->info ();
+
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    // The changes in between are not known
+    if (info.seq != seq_ + 1 || info.parentHash != hash_)
+        issuers_.clear ();
+
+    seq_ = info.seq;
+    hash_ = info.hash;
+
+    for (auto iter = issuers_.begin (); iter != issuers_.end ();)
+    {
+        if (seq_ - iter->second.used > idle_)
+            iter = issuers_.erase (iter);
+        else
+            ++iter;
+    }
+
+    if (issuers_.empty ())
+        return;
+
+    for (auto const& item : ledger.getMap ())
+    {
+        for (auto const& node : item.second->getMeta ()->getNodes ())
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) == ltRIPPLE_STATE)
+                change (node);
+        }
+    }
+}
+
+std::size_t
+GatewayTotals::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return issuers_.size ();
+}
+
+void
+GatewayTotals::apply (Totals& totals, AccountID const& peer,
+    STAmount const& balance, bool add)
+{
+    auto const& currency = balance.getCurrency ();
+
+    // A positive balance is owed to the issuer
+    if (balance > zero)
+    {
+        auto& assets = totals.assets[peer];
+        if (add)
+        {
+            assets[currency] = balance;
+        }
+        else
+        {
+            assets.erase (currency);
+            if (assets.empty ())
+                totals.assets.erase (peer);
+        }
+    }
+    else if (balance < zero)
+    {
+        auto& total = totals.obligations[currency];
+        auto& lines = totals.lines[currency];
+        if (add)
+        {
+            ++lines;
+
+            // The first amount sets the currency
+            if (total == zero)
+                total = -balance;
+            else
+                total -= balance;
+        }
+        else
+        {
+            // Without lines nothing is owed, whatever was rounded off
+            if (lines <= 1)
+            {
+                totals.obligations.erase (currency);
+                totals.lines.erase (currency);
+            }
+            else
+            {
+                --lines;
+                total += balance;
+            }
+        }
+    }
+}
+
+void
+GatewayTotals::change (STObject const& node)
+{
+    auto fields = [&node](SField const& field)
+    {
+        return dynamic_cast<STObject const*> (node.peekAtPField (field));
+    };
+
+    STObject const* final = nullptr;
+    STObject const* previous = nullptr;
+    bool const created = node.getFName () == sfCreatedNode;
+    bool const deleted = node.getFName () == sfDeletedNode;
+
+    if (created)
+    {
+        final = fields (sfNewFields);
+    }
+    else
+    {
+        final = fields (sfFinalFields);
+        previous = fields (sfPreviousFields);
+    }
+
+    if (! final)
+        return;
+
+    boost::optional<STAmount> before;
+    boost::optional<STAmount> after;
+
+    if (previous && previous->isFieldPresent (sfBalance))
+        before = previous->getFieldAmount (sfBalance);
+    else if (deleted && final->isFieldPresent (sfBalance))
+        before = final->getFieldAmount (sfBalance);
+    else if (! created)
+        return;
+
+    if (! deleted && final->isFieldPresent (sfBalance))
+        after = final->getFieldAmount (sfBalance);
+
+    auto const low = final->getFieldAmount (sfLowLimit).getIssuer ();
+    auto const high = final->getFieldAmount (sfHighLimit).getIssuer ();
+
+    // The balance is positive if the high account owes the low one
+    auto update = [&](AccountID const& issuer, AccountID const& peer,
+        bool isLow)
+    {
+        auto const iter = issuers_.find (issuer);
+        if (iter == issuers_.end ())
+            return;
+
+        auto& totals = iter->second.totals;
+        if (before && *before != zero)
+            apply (totals, peer, isLow ? *before : -*before, false);
+        if (after && *after != zero)
+            apply (totals, peer, isLow ? *after : -*after, true);
+    };
+
+    update (low, high, true);
+    update (high, low, false);
+}
+
+} // ripple
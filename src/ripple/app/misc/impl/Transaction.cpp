@@ -119,28 +119,28 @@ Transaction::pointer Transaction::transactionFromSQLValidated(
 
 Transaction::pointer Transaction::load(uint256 const& id, Application& app)
 {
-    std::string sql = "SELECT LedgerSeq,Status,RawTxn "
-            "FROM Transactions WHERE TransID='";
-    sql.append (to_string (id));
-    sql.append ("';");
+    // The ID is bound, so every lookup runs the same statement
+    static char const* const sql = "SELECT LedgerSeq,Status,RawTxn "
+            "FROM Transactions WHERE TransID = :id;";
+    std::string const txID = to_string (id);
 
     boost::optional<std::uint64_t> ledgerSeq;
     boost::optional<std::string> status;
     Blob rawTxn;
     {
         bool isMySQL = app.getTxnDB ().getType () == DatabaseCon::Type::MySQL;
-        
-        auto db = app.getTxnDB ().checkoutDb ();
+
+        auto db = app.getTxnDB ().checkoutReadDb ();
         boost::optional<std::string> sociRawTxnStr;
         std::unique_ptr<soci::blob> sociRawTxnBlob (isMySQL ? nullptr : new soci::blob (*db));
         soci::indicator rti;
 
         if (isMySQL)
             *db << sql, soci::into (ledgerSeq), soci::into (status),
-                soci::into (sociRawTxnStr, rti);
+                soci::into (sociRawTxnStr, rti), soci::use (txID);
         else
             *db << sql, soci::into (ledgerSeq), soci::into (status),
-                soci::into (*sociRawTxnBlob, rti);
+                soci::into (*sociRawTxnBlob, rti), soci::use (txID);
 
         if (!db->got_data () || rti != soci::i_ok)
             return {};
@@ -88,10 +88,13 @@ FeeMetrics::updateFeeMetrics(Application& app,
     }
     for (auto const& tx : view.txs)
     {
-        auto const baseFee = calculateBaseFee(app, view,
+        // Dividend transactions have a lane of their own
+        if (tx.first->getTxnType() == ttDIVIDEND)
+            continue;
+        auto const feeCost = calculateFeeCost(app, view,
             *tx.first, j_);
         feeLevels.push_back(getFeeLevelPaid(*tx.first,
-            baseLevel, baseFee));
+            baseLevel, feeCost));
     }
     std::sort(feeLevels.begin(), feeLevels.end());
     auto const size = feeLevels.size();
@@ -151,8 +154,9 @@ FeeMetrics::scaleFeeLevel(OpenView const& view) const
 {
     auto fee = baseLevel;
 
-    // Transactions in the open ledger so far
-    auto const current = view.txCount();
+    // Transactions in the open ledger so far, other
+    // than the dividend transactions in their lane
+    auto const current = view.txCount() - view.exemptCount();
 
     std::size_t target;
     std::uint32_t multiplier;
@@ -315,6 +319,9 @@ TxQ::apply(Application& app, OpenView& view,
         return ripple::apply(app, view, *tx, flags, j);
     }
 
+    if (tx->getTxnType() == ttDIVIDEND)
+        return applyDividend(app, view, tx, flags, j);
+
     auto const account = (*tx)[sfAccount];
     auto currentSeq = true;
 
@@ -352,9 +359,8 @@ TxQ::apply(Application& app, OpenView& view,
     if (!pcresult.likelyToClaimFee)
         return{ pcresult.ter, false };
 
-    auto const baseFee = pcresult.baseFee;
     auto const feeLevelPaid = getFeeLevelPaid(*tx,
-        feeMetrics_.baseLevel, baseFee);
+        feeMetrics_.baseLevel, pcresult.feeCost);
     auto const requiredFeeLevel = feeMetrics_.scaleFeeLevel(view);
     auto const transactionID = tx->getTransactionID();
 
@@ -503,6 +509,75 @@ TxQ::apply(Application& app, OpenView& view,
     return { terQUEUED, false };
 }
 
+std::pair<TER, bool>
+TxQ::applyDividend(Application& app, OpenView& view,
+    std::shared_ptr<STTx const> const& tx,
+        ApplyFlags flags, beast::Journal j)
+{
+    // Apply to the open ledger while it has room,
+    // and there are none held from before.
+    if (dividendLane_.empty() &&
+        view.exemptCount() < setup_.dividendsPerLedger)
+    {
+        return ripple::apply(app, view, *tx, flags, j);
+    }
+
+    auto const pfresult = preflight(app, view.rules(), *tx, flags, j);
+    if (pfresult.ter != tesSUCCESS)
+        return { pfresult.ter, false };
+
+    if (dividendLane_.size() >=
+        setup_.dividendsPerLedger * setup_.ledgersInQueue)
+    {
+        JLOG(j_.warning) << "Dividend lane is full, and transaction " <<
+            tx->getTransactionID() << " is dropped";
+        return { telINSUF_FEE_P, false };
+    }
+
+    dividendLane_.emplace_back(tx, flags);
+    JLOG(j_.trace) << "Added dividend transaction " <<
+        tx->getTransactionID() << " to the lane, which has " <<
+        dividendLane_.size() << " entries.";
+    return { terQUEUED, false };
+}
+
+bool
+TxQ::acceptDividends(Application& app, OpenView& view)
+{
+    auto ledgerChanged = false;
+    std::size_t applied = 0;
+    while (! dividendLane_.empty() &&
+        view.exemptCount() < setup_.dividendsPerLedger)
+    {
+        auto const held = std::move(dividendLane_.front());
+        dividendLane_.pop_front();
+
+        // Dividend transactions which don't apply are
+        // submitted again by the DividendMaster.
+        auto const result = ripple::apply(app, view,
+            *held.first, held.second, j_);
+        if (result.second)
+        {
+            ++applied;
+            ledgerChanged = true;
+        }
+        else
+        {
+            JLOG(j_.debug) << "Held dividend transaction " <<
+                held.first->getTransactionID() << " failed with " <<
+                transToken(result.first) << ". Remove from lane.";
+        }
+    }
+
+    if (applied)
+    {
+        JLOG(j_.debug) << "Applied " << applied <<
+            " held dividend transactions, " << dividendLane_.size() <<
+            " left in the lane.";
+    }
+    return ledgerChanged;
+}
+
 void
 TxQ::processValidatedLedger(Application& app,
     OpenView const& view, bool timeLeap,
@@ -579,10 +654,10 @@ TxQ::accept(Application& app,
        Stop when the transaction fee gets lower than the required fee.
     */
 
-    auto ledgerChanged = false;
-
     std::lock_guard<std::mutex> lock(mutex_);
 
+    auto ledgerChanged = acceptDividends(app, view);
+
     for (auto candidateIter = byFee_.begin(); candidateIter != byFee_.end();)
     {
         auto const requiredFeeLevel = feeMetrics_.scaleFeeLevel(view);
@@ -596,9 +671,6 @@ TxQ::accept(Application& app,
         {
             auto firstTxn = candidateIter->txn;
 
-            JLOG(j_.trace) << "Applying queued transaction " <<
-                candidateIter->txID << " to open ledger.";
-
             // If the rules or flags change, preflight again
             assert(candidateIter->pfresult);
             if (candidateIter->pfresult->rules != view.rules() ||
@@ -609,8 +681,28 @@ TxQ::accept(Application& app,
                         candidateIter->pfresult->tx,
                             candidateIter->flags,
                                 candidateIter->pfresult->j));
+                candidateIter->retrySeq = boost::none;
             }
 
+            // The sequence check comes first in preclaim, so a
+            // candidate that was ahead of its account is still
+            // ahead of it until the account's sequence moves.
+            auto const sle = view.read(
+                keylet::account(candidateIter->account));
+            auto const accountSeq = sle ? (*sle)[sfSequence] : 0;
+            if (setup_.skipUnchanged && candidateIter->retrySeq &&
+                *candidateIter->retrySeq == accountSeq)
+            {
+                JLOG(j_.trace) << "Queued transaction " <<
+                    candidateIter->txID << " is still ahead of " <<
+                    "its account. Leave in queue.";
+                ++candidateIter;
+                continue;
+            }
+
+            JLOG(j_.trace) << "Applying queued transaction " <<
+                candidateIter->txID << " to open ledger.";
+
             auto pcresult = preclaim(
                 *candidateIter->pfresult, app, view);
 
@@ -641,6 +733,11 @@ TxQ::accept(Application& app,
                 JLOG(j_.debug) << "Transaction " <<
                     candidateIter->txID << " failed with " <<
                     transToken(txnResult) << ". Leave in queue.";
+                if (txnResult == terPRE_SEQ ||
+                        (txnResult == terNO_ACCOUNT && ! sle))
+                    candidateIter->retrySeq = accountSeq;
+                else
+                    candidateIter->retrySeq = boost::none;
                 candidateIter++;
             }
 
@@ -670,6 +767,9 @@ TxQ::getMetrics(OpenView const& view) const
         feeMetrics_.baseLevel;
     result.medFeeLevel = feeMetrics_.getEscalationMultiplier();
     result.expFeeLevel = feeMetrics_.scaleFeeLevel(view);
+    result.dividendsInLedger = view.exemptCount();
+    result.dividendsPerLedger = setup_.dividendsPerLedger;
+    result.dividendsHeld = dividendLane_.size();
 
     return result;
 }
@@ -734,6 +834,8 @@ setup_TxQ(Config const& config)
     auto const& section = config.section("transaction_queue");
     set(setup.ledgersInQueue, "ledgers_in_queue", section);
     set(setup.retrySequencePercent, "retry_sequence_percent", section);
+    set(setup.skipUnchanged, "skip_unchanged", section);
+    set(setup.dividendsPerLedger, "dividends_per_ledger", section);
     setup.standAlone = config.RUN_STANDALONE;
     return setup;
 }
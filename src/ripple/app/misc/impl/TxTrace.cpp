@@ -0,0 +1,156 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ripple {
+
+TxTrace::TxTrace (Section const& section)
+    : sampleRate_ (get<std::uint64_t> (section, "sample_rate", 0))
+    , maxSize_ (std::max <std::size_t> (
+        get<std::size_t> (section, "size", 10000), 1))
+    , age_ (std::chrono::seconds (std::max <std::uint64_t> (
+        get<std::uint64_t> (section, "age", 600), 1)))
+{
+    for (std::size_t i = 1; i < phaseCount; ++i)
+        latency_[i] = std::make_unique <LatencyWindow> (
+            std::chrono::minutes (10), 10);
+}
+
+bool
+TxTrace::sampled (uint256 const& id) const
+{
+    if (sampleRate_ == 0)
+        return false;
+
+    // The ID is a hash, so any of its bits will do
+    std::uint64_t value;
+    std::memcpy (&value, id.begin (), sizeof (value));
+    return value % sampleRate_ == 0;
+}
+
+void
+TxTrace::mark (uint256 const& id, Phase phase, clock_type::time_point now)
+{
+    if (! sampled (id))
+        return;
+
+    auto const index = static_cast<std::size_t> (phase);
+    std::chrono::microseconds elapsed;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (phase == Phase::received)
+        {
+            expire (now);
+            if (entries_.count (id))
+                return;
+            if (entries_.size () >= maxSize_)
+            {
+                entries_.erase (order_.front ().second);
+                order_.pop_front ();
+            }
+            Entry entry;
+            entry.received = now;
+            entry.offsets.fill (-1);
+            entry.offsets[index] = 0;
+            entries_.emplace (id, entry);
+            order_.emplace_back (now, id);
+            return;
+        }
+
+        auto const iter = entries_.find (id);
+        if (iter == entries_.end () || iter->second.offsets[index] >= 0)
+            return;
+        elapsed = std::chrono::duration_cast<std::chrono::microseconds> (
+            now - iter->second.received);
+        iter->second.offsets[index] = elapsed.count ();
+    }
+    latency_[index]->add (elapsed, now);
+}
+
+void
+TxTrace::expire (clock_type::time_point now)
+{
+    while (! order_.empty () && now - order_.front ().first > age_)
+    {
+        entries_.erase (order_.front ().second);
+        order_.pop_front ();
+    }
+}
+
+std::unique_ptr <TxTrace::Offsets>
+TxTrace::find (uint256 const& id) const
+{
+    if (! sampled (id))
+        return nullptr;
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto const iter = entries_.find (id);
+    if (iter == entries_.end ())
+        return nullptr;
+    return std::make_unique <Offsets> (iter->second.offsets);
+}
+
+Json::Value
+TxTrace::getJson (uint256 const& id) const
+{
+    auto const offsets = find (id);
+    if (! offsets)
+        return Json::nullValue;
+
+    // Microseconds since received
+    Json::Value ret (Json::objectValue);
+    for (std::size_t i = 1; i < phaseCount; ++i)
+        if ((*offsets)[i] >= 0)
+            ret[getName (static_cast<Phase> (i))] =
+                static_cast<Json::UInt> ((*offsets)[i]);
+    return ret;
+}
+
+Json::Value
+TxTrace::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret["sample_rate"] = static_cast<Json::UInt> (sampleRate_);
+    ret["traced"] = static_cast<Json::UInt> (size ());
+
+    // Percentiles since received over the last ten minutes, in microseconds
+    auto const now = clock_type::now ();
+    for (std::size_t i = 1; i < phaseCount; ++i)
+    {
+        auto const p = latency_[i]->get (now);
+        if (p.count == 0)
+            continue;
+        Json::Value& phase = ret[getName (static_cast<Phase> (i))];
+        phase["count"] = static_cast<Json::UInt> (p.count);
+        phase["p50"] = static_cast<Json::UInt> (p.p50.count ());
+        phase["p99"] = static_cast<Json::UInt> (p.p99.count ());
+        phase["p999"] = static_cast<Json::UInt> (p.p999.count ());
+        phase["max"] = static_cast<Json::UInt> (p.max.count ());
+    }
+    return ret;
+}
+
+std::size_t
+TxTrace::size () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return entries_.size ();
+}
+
+char const*
+TxTrace::getName (Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::received:   return "received";
+    case Phase::checked:    return "checked";
+    case Phase::applied:    return "applied";
+    case Phase::closed:     return "closed";
+    case Phase::validated:  return "validated";
+    case Phase::saved:      return "saved";
+    }
+    return "unknown";
+}
+
+} // ripple
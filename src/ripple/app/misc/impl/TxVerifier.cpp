@@ -0,0 +1,95 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/TxVerifier.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/main/Tuning.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
+
+namespace ripple {
+
+TxVerifier::TxVerifier (Application& app,
+        std::chrono::milliseconds window, beast::Journal journal)
+    : app_ (app)
+    , window_ (window)
+    , j_ (journal)
+    , timer_ (this)
+{
+}
+
+void
+TxVerifier::verify (
+    std::shared_ptr<STTx const> const& tx, Handler handler)
+{
+    bool setTimer = false;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        pending_.push_back ({tx, std::move (handler)});
+        if (window_ == window_.zero () ||
+                pending_.size () >= signatureBatchSize)
+        {
+            flush (lock);
+        }
+        else if (! timerSet_)
+        {
+            timerSet_ = setTimer = true;
+        }
+    }
+
+    // The timer calls back with its own lock held, so it is set
+    // without holding ours
+    if (setTimer)
+        timer_.setExpiration (window_);
+}
+
+std::size_t
+TxVerifier::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return pending_.size ();
+}
+
+void
+TxVerifier::onDeadlineTimer (beast::DeadlineTimer&)
+{
+    app_.getJobQueue ().addJob (jtTRANSACTION, "TxVerifier.timer",
+        [this] (Job&)
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            timerSet_ = false;
+            if (! pending_.empty ())
+                flush (lock);
+        });
+}
+
+void
+TxVerifier::flush (std::lock_guard<std::mutex> const&)
+{
+    auto items = std::make_shared<std::vector<Item>> ();
+    items->swap (pending_);
+    app_.getJobQueue ().addJob (jtTRANSACTION, "checkSignatures",
+        [this, items] (Job&)
+        {
+            check (*items);
+        });
+}
+
+void
+TxVerifier::check (std::vector<Item> const& items)
+{
+    std::vector<std::shared_ptr<STTx const>> txs;
+    txs.reserve (items.size ());
+    for (auto const& item : items)
+        txs.push_back (item.tx);
+
+    auto const results = checkValidity (app_.getHashRouter (), txs,
+        app_.getLedgerMaster ().getValidatedRules (), app_.config ());
+
+    JLOG (j_.trace) << "Checked " << items.size () << " signatures";
+
+    for (std::size_t i = 0; i < items.size (); ++i)
+        items[i].handler (results[i].first, results[i].second);
+}
+
+} // ripple
@@ -29,7 +29,7 @@ namespace path {
 
 struct Node
 {
-    using List = std::vector<Node>;
+    using List = std::vector<Node, Allocator<Node>>;
 
     inline bool isAccount() const
     {
@@ -0,0 +1,179 @@
+#include <BeastConfig.h>
+#include <ripple/app/paths/PathCorridors.h>
+#include <ripple/app/paths/Pathfinder.h>
+#include <ripple/app/paths/Tuning.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/Config.h>
+#include <ripple/protocol/AccountID.h>
+#include <boost/algorithm/string.hpp>
+#include <stdexcept>
+
+namespace ripple {
+
+PathCorridors::PathCorridors (Application& app, Section const& section,
+        beast::Journal journal)
+    : app_ (app)
+    , journal_ (journal)
+{
+    for (auto const& line : section.values ())
+    {
+        // <currency>/<issuer> <value>/<currency>/<issuer>
+        std::vector<std::string> fields;
+        boost::split (fields, line, boost::is_any_of (" \t"),
+            boost::token_compress_on);
+        std::vector<std::string> source;
+        if (fields.size () == 2)
+            boost::split (source, fields[0], boost::is_any_of ("/"));
+
+        Corridor corridor;
+        boost::optional<AccountID> issuer;
+        if (source.size () == 2 &&
+            to_currency (corridor.source.currency, source[0]) &&
+            (issuer = parseBase58<AccountID> (source[1])))
+        {
+            corridor.source.account = *issuer;
+            try
+            {
+                corridor.destination = amountFromJson (
+                    sfGeneric, Json::Value (fields[1]));
+            }
+            catch (std::exception const&)
+            {
+                corridor.destination.clear ();
+            }
+        }
+
+        if (isNative (corridor.source.currency) ||
+            isNative (corridor.destination.getCurrency ()) ||
+            corridor.destination <= zero)
+        {
+            Throw<std::runtime_error> (
+                "Invalid [path_corridors] line: " + line);
+        }
+        corridors_.push_back (std::move (corridor));
+    }
+}
+
+void
+PathCorridors::update (RippleLineCache::ref cache)
+{
+    if (corridors_.empty () || app_.config ().PATH_SEARCH_MAX == 0)
+        return;
+
+    std::lock_guard<std::mutex> sl (updateLock_);
+
+    auto const seq = cache->getLedger ()->seq ();
+    auto const previous = std::atomic_load (&found_);
+    if (previous && previous->seq >= seq)
+        return;
+
+    auto found = std::make_shared<Found> (corridors_.size ());
+    found->seq = seq;
+    for (std::size_t i = 0; i < corridors_.size (); ++i)
+    {
+        auto const& corridor = corridors_[i];
+        auto const& srcAccount = corridor.source.account;
+        auto const& dstAccount = corridor.destination.getIssuer ();
+        STPathSet paths;
+        bool search = ! previous || previous->paths[i].empty () ||
+            seq >= previous->searched[i] + PATHFINDER_CORRIDOR_SEARCH_LEDGERS;
+        if (previous)
+        {
+            paths = previous->paths[i];
+            found->searched[i] = previous->searched[i];
+        }
+
+        try
+        {
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                Pathfinder pathfinder (cache, srcAccount, dstAccount,
+                    corridor.source.currency, boost::none,
+                        corridor.destination, boost::none, app_);
+
+                // Without a search only the paths found before are ranked
+                if (search)
+                {
+                    found->searched[i] = seq;
+                    if (! pathfinder.findPaths (app_.config ().PATH_SEARCH))
+                        break;
+                }
+                pathfinder.computePathRanks (PATHFINDER_CORRIDOR_PATHS);
+
+                STPath fullLiquidityPath;
+                auto best = pathfinder.getBestPaths (PATHFINDER_CORRIDOR_PATHS,
+                    fullLiquidityPath, paths, srcAccount);
+                if (! fullLiquidityPath.empty ())
+                    best.push_back (fullLiquidityPath);
+
+                found->paths[i] = std::move (best);
+                if (search || ! found->paths[i].empty ())
+                    break;
+
+                // None of the paths is left, so look for new ones
+                search = true;
+            }
+        }
+        catch (std::exception const& e)
+        {
+            JLOG (journal_.warning) << "Corridor " <<
+                corridor.source << " to " << corridor.destination.issue () <<
+                ": " << e.what ();
+        }
+
+        JLOG (journal_.debug) << "Corridor " << corridor.source << " to " <<
+            corridor.destination.issue () << " has " <<
+            found->paths[i].size () << " paths at " << seq;
+    }
+
+    std::atomic_store (&found_,
+        std::shared_ptr<Found const> (std::move (found)));
+}
+
+STPathSet
+PathCorridors::getPaths (AccountID const& srcAccount, Issue const& srcIssue,
+    AccountID const& dstAccount, Issue const& dstIssue) const
+{
+    STPathSet result;
+    auto const found = std::atomic_load (&found_);
+    if (! found)
+        return result;
+
+    for (std::size_t i = 0; i < corridors_.size (); ++i)
+    {
+        auto const& source = corridors_[i].source;
+        auto const destination = corridors_[i].destination.issue ();
+        if (source.currency != srcIssue.currency ||
+            (srcIssue.account != source.account &&
+                srcIssue.account != srcAccount) ||
+            destination.currency != dstIssue.currency ||
+            (dstIssue.account != destination.account &&
+                dstIssue.account != dstAccount))
+            continue;
+
+        // The paths go between the issuers, so the accounts paying and
+        // being paid are linked to them
+        for (auto const& corridorPath : found->paths[i])
+        {
+            STPath path;
+            if (srcAccount != source.account)
+                path.emplace_back (STPathElement::typeAccount,
+                    source.account, source.currency, source.account);
+            for (auto const& element : corridorPath)
+                path.push_back (element);
+            if (dstAccount != destination.account &&
+                    (path.empty () ||
+                        path.back ().getAccountID () != destination.account))
+                path.emplace_back (STPathElement::typeAccount,
+                    destination.account, destination.currency,
+                        destination.account);
+            if (! path.empty ())
+                result.push_back (std::move (path));
+        }
+    }
+    return result;
+}
+
+} // ripple
@@ -0,0 +1,88 @@
+#ifndef RIPPLE_APP_PATHS_PATHCORRIDORS_H_INCLUDED
+#define RIPPLE_APP_PATHS_PATHCORRIDORS_H_INCLUDED
+
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/protocol/Issue.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/STPathSet.h>
+#include <beast/utility/Journal.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/** The best paths of the corridors payments are often made through.
+
+    A corridor is an issue payments are sent from and an amount of another
+    issue they deliver, as listed in [path_corridors]. Its paths are found
+    from the issuer of the one to the issuer of the other. Every ledger they
+    are ranked again, which is cheap, and every few ledgers, or when none
+    of them is left, they are searched for again.
+
+    Requests which pay through a corridor try its paths along with their
+    own, so that even their first answer can use them.
+*/
+class PathCorridors
+{
+public:
+    PathCorridors (Application& app, Section const& section,
+        beast::Journal journal);
+
+    PathCorridors (PathCorridors const&) = delete;
+    PathCorridors& operator= (PathCorridors const&) = delete;
+
+    /** Bring the paths of each corridor up to the ledger of a cache. */
+    void
+    update (RippleLineCache::ref cache);
+
+    /** Returns the corridor paths a payment can take.
+
+        The paths go from the source account to the destination account.
+        An issue account which is the source or destination account itself
+        stands for any issuer of the currency.
+    */
+    STPathSet
+    getPaths (AccountID const& srcAccount, Issue const& srcIssue,
+        AccountID const& dstAccount, Issue const& dstIssue) const;
+
+    bool
+    empty () const
+    {
+        return corridors_.empty ();
+    }
+
+private:
+    struct Corridor
+    {
+        Issue source;
+        STAmount destination;
+    };
+
+    struct Found
+    {
+        Found (std::size_t size)
+            : paths (size)
+            , searched (size, 0)
+        {
+        }
+
+        LedgerIndex seq = 0;
+        std::vector<STPathSet> paths;
+        std::vector<LedgerIndex> searched;
+    };
+
+    Application& app_;
+    beast::Journal journal_;
+    std::vector<Corridor> corridors_;
+
+    std::mutex updateLock_;
+    std::shared_ptr<Found const> found_;
+};
+
+} // ripple
+
+#endif
@@ -22,6 +22,7 @@
 #include <ripple/app/paths/RippleCalc.h>
 #include <ripple/app/paths/PathRequest.h>
 #include <ripple/app/paths/PathRequests.h>
+#include <ripple/app/paths/PathfinderCache.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
@@ -40,6 +41,7 @@ PathRequest::PathRequest (
     Application& app,
     const std::shared_ptr<InfoSub>& subscriber,
     int id,
+    Role role,
     PathRequests& owner,
     beast::Journal journal)
         : app_ (app)
@@ -47,6 +49,8 @@ PathRequest::PathRequest (
         , mOwner (owner)
         , wpSubscriber (subscriber)
         , jvStatus (Json::objectValue)
+        , role_ (role)
+        , mTimedOut (false)
         , mLastIndex (0)
         , mInProgress (false)
         , iLastLevel (0)
@@ -62,6 +66,7 @@ PathRequest::PathRequest (
     Application& app,
     std::function <void(void)> const& completion,
     int id,
+    Role role,
     PathRequests& owner,
     beast::Journal journal)
         : app_ (app)
@@ -69,6 +74,8 @@ PathRequest::PathRequest (
         , mOwner (owner)
         , fCompletion (completion)
         , jvStatus (Json::objectValue)
+        , role_ (role)
+        , mTimedOut (false)
         , mLastIndex (0)
         , mInProgress (false)
         , iLastLevel (0)
@@ -439,6 +446,19 @@ int PathRequest::parseJson (Json::Value const& jvParams)
         }
     }
 
+    if (jvParams.isMember (jss::deadline))
+    {
+        // The milliseconds each update may search for
+        auto const& deadline = jvParams[jss::deadline];
+        if (! (deadline.isUInt () || deadline.isInt ()) ||
+            deadline.asInt () <= 0)
+        {
+            jvStatus = rpcError (rpcINVALID_PARAMS);
+            return PFR_PJ_INVALID;
+        }
+        mDeadline = std::chrono::milliseconds (deadline.asUInt ());
+    }
+
     if (jvParams.isMember ("id"))
         jvId = jvParams["id"];
 
@@ -466,30 +486,60 @@ void PathRequest::resetLevel (int l)
         iLastLevel = l;
 }
 
-std::unique_ptr<Pathfinder> const&
+std::shared_ptr<Pathfinder const> const&
 PathRequest::getPathFinder(RippleLineCache::ref cache,
-    hash_map<Currency, std::unique_ptr<Pathfinder>>& currency_map,
+    PathfinderCache* pathfinders,
+    hash_map<Currency, std::shared_ptr<Pathfinder const>>& currency_map,
         Currency const& currency, STAmount const& dst_amount,
-            int const level)
+            int const level, bool search)
 {
     if (currency == assetCurrency ())
         return currency_map[currency];
     auto i = currency_map.find(currency);
     if (i != currency_map.end())
         return i->second;
+
+    // A search which may be cut short is not shared with other requests
+    if (pathfinders && search && ! mUpdateDeadline)
+    {
+        assert (pathfinders->getLineCache () == cache);
+        bool searched = false;
+        auto& shared = currency_map[currency] = pathfinders->get (
+            *raSrcAccount, *raDstAccount, currency, dst_amount, saSendMax,
+                level, max_paths_, app_, &searched);
+        if (shared)
+        {
+            mStats += shared->stats ();
+            if (searched)
+                mOwnStats += shared->stats ();
+        }
+        return shared;
+    }
     auto pathfinder = std::make_unique<Pathfinder>(
         cache, *raSrcAccount, *raDstAccount, currency,
             boost::none, dst_amount, saSendMax, app_);
-    if (pathfinder->findPaths(level))
+    if (mUpdateDeadline)
+        pathfinder->setDeadline (*mUpdateDeadline);
+    if (! search)
+        pathfinder->computePathRanks(max_paths_);  // Rank given paths only
+    else if (pathfinder->findPaths(level))
         pathfinder->computePathRanks(max_paths_);
     else
         pathfinder.reset();  // It's a bad request - clear it.
+    if (pathfinder)
+    {
+        mStats += pathfinder->stats ();
+        mOwnStats += pathfinder->stats ();
+        if (pathfinder->timedOut ())
+            mTimedOut = true;
+    }
     return currency_map[currency] = std::move(pathfinder);
 }
 
 void
-PathRequest::findPaths (RippleLineCache::ref cache, int const level,
-    Json::Value& jvArray)
+PathRequest::findPaths (RippleLineCache::ref cache,
+    PathfinderCache* pathfinders, int const level, bool fast,
+        Json::Value& jvArray)
 {
     auto sourceCurrencies = sciSourceCurrencies;
     if (sourceCurrencies.empty ())
@@ -510,7 +560,7 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
     auto const dst_amount = convert_all_ ?
         STAmount(saDstAmount.issue(), STAmount::cMaxValue, STAmount::cMaxOffset)
             : saDstAmount;
-    hash_map<Currency, std::unique_ptr<Pathfinder>> currency_map;
+    hash_map<Currency, std::shared_ptr<Pathfinder const>> currency_map;
     for (auto const& issue : sourceCurrencies)
     {
         if (issue.currency == assetCurrency())
@@ -521,8 +571,17 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
             << " Trying to find paths: "
             << STAmount(issue, 1).getFullText();
 
-        auto& pathfinder = getPathFinder(cache, currency_map,
-            issue.currency, dst_amount, level);
+        // Paths through a configured corridor are tried too, and are enough
+        // for a fast answer
+        auto extraPaths = mContext[issue];
+        auto const corridorPaths = mOwner.getCorridors ().getPaths (
+            *raSrcAccount, issue, *raDstAccount, dst_amount.issue ());
+        for (auto const& path : corridorPaths)
+            extraPaths.push_back (path);
+
+        auto& pathfinder = getPathFinder(cache, pathfinders, currency_map,
+            issue.currency, dst_amount, level,
+                ! fast || corridorPaths.empty ());
         if (! pathfinder)
         {
             assert(false);
@@ -531,8 +590,9 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
         }
 
         STPath fullLiquidityPath;
+        PathSearchStats best;
         auto ps = pathfinder->getBestPaths(max_paths_,
-            fullLiquidityPath, mContext[issue], issue.account);
+            fullLiquidityPath, extraPaths, issue.account, &best);
         mContext[issue] = ps;
 
         auto& sourceAccount = ! isXRP(issue.account)
@@ -551,6 +611,7 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
             rcInput.partialPaymentAllowed = true;
         auto sandbox = std::make_unique<PaymentSandbox>
             (&*cache->getLedger(), tapNONE);
+        ++best.rippleCalcs;
         auto rc = path::RippleCalc::rippleCalculate(
             *sandbox,
             saMaxAmount,    // --> Amount to send is unlimited
@@ -572,6 +633,7 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
             ps.push_back(fullLiquidityPath);
             sandbox = std::make_unique<PaymentSandbox>
                 (&*cache->getLedger(), tapNONE);
+            ++best.rippleCalcs;
             rc = path::RippleCalc::rippleCalculate(
                 *sandbox,
                 saMaxAmount,    // --> Amount to send is unlimited
@@ -595,6 +657,8 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
                     << transHuman(rc.result());
             }
         }
+        mStats += best;
+        mOwnStats += best;
 
         if (rc.result () == tesSUCCESS)
         {
@@ -622,7 +686,8 @@ PathRequest::findPaths (RippleLineCache::ref cache, int const level,
     }
 }
 
-Json::Value PathRequest::doUpdate (RippleLineCache::ref cache, bool fast)
+Json::Value PathRequest::doUpdate (RippleLineCache::ref cache, bool fast,
+    PathfinderCache* pathfinders)
 {
     m_journal.debug << iIdentifier << " update " << (fast ? "fast" : "normal");
 
@@ -685,11 +750,32 @@ Json::Value PathRequest::doUpdate (RippleLineCache::ref cache, bool fast)
 
     m_journal.debug << iIdentifier << " processing at level " << iLevel;
 
+    mStats = PathSearchStats ();
+    mOwnStats = PathSearchStats ();
+    mTimedOut = false;
+    auto const start = Pathfinder::clock_type::now ();
+    if (mDeadline.count () != 0)
+        mUpdateDeadline = start + mDeadline;
+    else
+        mUpdateDeadline = boost::none;
+
     Json::Value jvArray = Json::arrayValue;
-    findPaths(cache, iLevel, jvArray);
+    findPaths(cache, pathfinders, iLevel, fast, jvArray);
     bLastSuccess = jvArray.size();
     iLastLevel = iLevel;
 
+    auto const elapsed = Pathfinder::clock_type::now () - start;
+    mOwner.reportStats (mOwnStats);
+    if (mTimedOut)
+        jvStatus[jss::deadline_exceeded] = true;
+    if (role_ == Role::ADMIN)
+    {
+        auto& stats = (jvStatus[jss::search_stats] = mStats.getJson ());
+        stats[jss::total_ms] = static_cast<Json::UInt> (
+            std::chrono::duration_cast<std::chrono::milliseconds> (
+                elapsed).count ());
+    }
+
     if (fast && ptQuickReply.is_not_a_date_time())
     {
         ptQuickReply = boost::posix_time::microsec_clock::universal_time();
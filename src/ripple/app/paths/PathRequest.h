@@ -26,7 +26,9 @@
 #include <ripple/json/json_value.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/protocol/types.h>
+#include <ripple/server/Role.h>
 #include <boost/optional.hpp>
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <set>
@@ -38,6 +40,7 @@ namespace ripple {
 
 class RippleLineCache;
 class PathRequests;
+class PathfinderCache;
 
 // Return values from parseJson <0 = invalid, >0 = valid
 #define PFR_PJ_INVALID              -1
@@ -62,6 +65,7 @@ public:
         Application& app,
         std::shared_ptr <InfoSub> const& subscriber,
         int id,
+        Role role,
         PathRequests&,
         beast::Journal journal);
 
@@ -69,6 +73,7 @@ public:
         Application& app,
         std::function <void (void)> const& completion,
         int id,
+        Role role,
         PathRequests&,
         beast::Journal journal);
 
@@ -86,8 +91,9 @@ public:
     Json::Value doClose (Json::Value const&);
     Json::Value doStatus (Json::Value const&);
 
-    // update jvStatus
-    Json::Value doUpdate (const std::shared_ptr<RippleLineCache>&, bool fast);
+    // update jvStatus, sharing searches with other requests if given
+    Json::Value doUpdate (const std::shared_ptr<RippleLineCache>&, bool fast,
+        PathfinderCache* pathfinders = nullptr);
     InfoSub::pointer getSubscriber ();
     bool hasCompletion ();
 
@@ -98,13 +104,14 @@ private:
     void setValid ();
     void resetLevel (int level);
 
-    std::unique_ptr<Pathfinder> const&
-    getPathFinder(RippleLineCache::ref,
-        hash_map<Currency, std::unique_ptr<Pathfinder>>&, Currency const&,
-            STAmount const&, int const);
+    std::shared_ptr<Pathfinder const> const&
+    getPathFinder(RippleLineCache::ref, PathfinderCache*,
+        hash_map<Currency, std::shared_ptr<Pathfinder const>>&,
+            Currency const&, STAmount const&, int const, bool search);
 
     void
-    findPaths (RippleLineCache::ref, int const, Json::Value&);
+    findPaths (RippleLineCache::ref, PathfinderCache*, int const, bool fast,
+        Json::Value&);
 
     int parseJson (Json::Value const&);
 
@@ -132,6 +139,19 @@ private:
 
     bool convert_all_;
 
+    // How long an update may search, if it is limited
+    std::chrono::milliseconds mDeadline {0};
+
+    // Only administrators are shown the work each update does
+    Role const role_;
+
+    // The work of the update in progress, and the part of it which was
+    // not shared with other requests
+    PathSearchStats mStats;
+    PathSearchStats mOwnStats;
+    boost::optional<Pathfinder::clock_type::time_point> mUpdateDeadline;
+    bool mTimedOut;
+
     std::recursive_mutex mIndexLock;
     LedgerIndex mLastIndex;
     bool mInProgress;
@@ -21,9 +21,15 @@
 #include <ripple/app/paths/PathRequests.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/paths/PathfinderCache.h>
+#include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/resource/Fees.h>
+#include <algorithm>
+#include <exception>
+#include <set>
+#include <thread>
 
 namespace ripple {
 
@@ -44,7 +50,12 @@ RippleLineCache::pointer PathRequests::getLineCache (
          (authoritative && ((lgrSeq + 8)  < lineSeq)) ||   // we jumped way back for some reason
          (lgrSeq > (lineSeq + 8)))                         // we jumped way forward for some reason
     {
-        mLineCache = std::make_shared<RippleLineCache> (ledger);
+        // The lines of the next ledger mostly carry over
+        if (mLineCache && (lgrSeq == (lineSeq + 1)))
+            mLineCache = std::make_shared<RippleLineCache> (
+                ledger, *mLineCache);
+        else
+            mLineCache = std::make_shared<RippleLineCache> (ledger);
     }
     return mLineCache;
 }
@@ -65,77 +76,140 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
     }
 
     bool newRequests = app_.getLedgerMaster().isNewPathRequest();
-    bool mustBreak = false;
+    std::atomic<bool> mustBreak (false);
 
     mJournal.trace << "updateAll seq=" << cache->getLedger()->seq() << ", " <<
         requests.size() << " requests";
-    int processed = 0, removed = 0;
+    std::atomic<int> processed (0);
+    int removed = 0;
+
+    // Requests for the same payment share its search while the ledger
+    // stays the same
+    std::unique_ptr<PathfinderCache> pathfinders;
+    auto const threads = app_.config().PATH_SEARCH_THREADS;
 
     do
     {
-        for (auto& wRequest : requests)
+        if (!pathfinders || pathfinders->getLineCache () != cache)
         {
-            if (shouldCancel())
-                break;
+            mCorridors.update (cache);
+            pathfinders = std::make_unique<PathfinderCache> (cache);
+        }
 
-            bool remove = true;
-            PathRequest::pointer pRequest = wRequest.lock ();
+        // Each request is updated by one thread
+        mustBreak = false;
+        std::vector<char> remove (requests.size (), 0);
+        std::atomic<std::size_t> next (0);
+        std::atomic<bool> stop (false);
+        std::exception_ptr error;
+        std::mutex errorLock;
 
-            if (pRequest)
+        auto updateOne = [&](PathRequest::pointer const& pRequest)
+        {
+            if (!pRequest)
+                return false;
+
+            if (!pRequest->needsUpdate (newRequests, cache->getLedger()->seq()))
+                return true;
+
+            InfoSub::pointer ipSub = pRequest->getSubscriber ();
+            if (ipSub)
             {
-                if (!pRequest->needsUpdate (newRequests, cache->getLedger()->seq()))
-                    remove = false;
-                else
+                ipSub->getConsumer ().charge (Resource::feePathFindUpdate);
+                if (!ipSub->getConsumer ().warn ())
                 {
-                    InfoSub::pointer ipSub = pRequest->getSubscriber ();
-                    if (ipSub)
-                    {
-                        ipSub->getConsumer ().charge (Resource::feePathFindUpdate);
-                        if (!ipSub->getConsumer ().warn ())
-                        {
-                            Json::Value update = pRequest->doUpdate (cache, false);
-                            pRequest->updateComplete ();
-                            update[jss::type] = "path_find";
-                            ipSub->send (update, false);
-                            remove = false;
-                            ++processed;
-                        }
-                    }
-                    else if (pRequest->hasCompletion ())
-                    {
-                        // One-shot request with completion function
-                        pRequest->doUpdate (cache, false);
-                        pRequest->updateComplete();
-                        ++processed;
-                    }
+                    Json::Value update = pRequest->doUpdate (
+                        cache, false, pathfinders.get ());
+                    pRequest->updateComplete ();
+                    update[jss::type] = "path_find";
+                    ipSub->send (update, false);
+                    ++processed;
+                    return true;
                 }
             }
+            else if (pRequest->hasCompletion ())
+            {
+                // One-shot request with completion function
+                pRequest->doUpdate (cache, false, pathfinders.get ());
+                pRequest->updateComplete();
+                ++processed;
+            }
+            return false;
+        };
 
-            if (remove)
+        auto worker = [&]()
+        {
+            for (std::size_t i; !stop && (i = next++) < requests.size ();)
             {
-                ScopedLockType sl (mLock);
+                if (shouldCancel())
+                {
+                    stop = true;
+                    break;
+                }
 
-                // Remove any dangling weak pointers or weak pointers that refer to this path request.
-                std::vector<PathRequest::wptr>::iterator it = mRequests.begin();
-                while (it != mRequests.end())
+                try
                 {
-                    PathRequest::pointer itRequest = it->lock ();
-                    if (!itRequest || (itRequest == pRequest))
-                    {
-                        ++removed;
-                        it = mRequests.erase (it);
-                    }
-                    else
-                        ++it;
+                    remove[i] = ! updateOne (requests[i].lock ());
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> sl (errorLock);
+                    if (!error)
+                        error = std::current_exception ();
+                    stop = true;
+                    break;
+                }
+
+                // We weren't handling new requests and then there was a new request
+                if (!newRequests && app_.getLedgerMaster().isNewPathRequest())
+                {
+                    mustBreak = true;
+                    stop = true;
                 }
             }
+        };
 
-            mustBreak = !newRequests && app_.getLedgerMaster().isNewPathRequest();
-            if (mustBreak) // We weren't handling new requests and then there was a new request
-                break;
+        std::vector<std::thread> workers;
+        auto const count = std::min<std::size_t> (threads, requests.size ());
+        for (std::size_t i = 1; i < count; ++i)
+            workers.emplace_back (worker);
+        worker ();
+        for (auto& t : workers)
+            t.join ();
+
+        if (std::find (remove.begin (), remove.end (), 1) != remove.end ())
+        {
+            ScopedLockType sl (mLock);
+
+            // Remove any dangling weak pointers or weak pointers that refer to
+            // the path requests we are done with.
+            std::set<PathRequest::pointer> done;
+            for (std::size_t i = 0; i < requests.size (); ++i)
+            {
+                if (remove[i])
+                {
+                    if (auto pRequest = requests[i].lock ())
+                        done.insert (pRequest);
+                }
+            }
 
+            std::vector<PathRequest::wptr>::iterator it = mRequests.begin();
+            while (it != mRequests.end())
+            {
+                PathRequest::pointer itRequest = it->lock ();
+                if (!itRequest || done.count (itRequest))
+                {
+                    ++removed;
+                    it = mRequests.erase (it);
+                }
+                else
+                    ++it;
+            }
         }
 
+        if (error)
+            std::rethrow_exception (error);
+
         if (mustBreak)
         { // a new request came in while we were working
             newRequests = true;
@@ -166,7 +240,7 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
     while (!shouldCancel ());
 
     mJournal.debug << "updateAll complete " << processed << " process and " <<
-        removed << " removed";
+        removed << " removed, " << pathfinders->shared () << " searches shared";
 }
 
 void PathRequests::insertPathRequest (PathRequest::pointer const& req)
@@ -192,10 +266,11 @@ Json::Value
 PathRequests::makePathRequest(
     std::shared_ptr <InfoSub> const& subscriber,
     std::shared_ptr<ReadView const> const& inLedger,
-    Json::Value const& requestJson)
+    Json::Value const& requestJson,
+    Role role)
 {
     PathRequest::pointer req = std::make_shared<PathRequest> (
-        app_, subscriber, ++mLastIdentifier, *this, mJournal);
+        app_, subscriber, ++mLastIdentifier, role, *this, mJournal);
 
     RippleLineCache::pointer cache;
 
@@ -222,12 +297,13 @@ PathRequests::makeLegacyPathRequest(
     PathRequest::pointer& req,
     std::function <void (void)> completion,
     std::shared_ptr<ReadView const> const& inLedger,
-    Json::Value const& request)
+    Json::Value const& request,
+    Role role)
 {
     // This assignment must take place before the
     // completion function is called
     req = std::make_shared<PathRequest> (
-        app_, completion, ++mLastIdentifier, *this, mJournal);
+        app_, completion, ++mLastIdentifier, role, *this, mJournal);
 
     RippleLineCache::pointer cache;
 
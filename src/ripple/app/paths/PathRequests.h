@@ -21,6 +21,7 @@
 #define RIPPLE_APP_PATHS_PATHREQUESTS_H_INCLUDED
 
 #include <ripple/app/main/Application.h>
+#include <ripple/app/paths/PathCorridors.h>
 #include <ripple/app/paths/PathRequest.h>
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/core/Job.h>
@@ -36,10 +37,15 @@ public:
             beast::Journal journal, beast::insight::Collector::ptr const& collector)
         : app_ (app)
         , mJournal (journal)
+        , mCorridors (app, app.config().section ("path_corridors"), journal)
         , mLastIdentifier (0)
     {
         mFast = collector->make_event ("pathfind_fast");
         mFull = collector->make_event ("pathfind_full");
+        mNodes = collector->make_counter ("pathfind_nodes");
+        mLines = collector->make_counter ("pathfind_lines");
+        mRippleCalcs = collector->make_counter ("pathfind_ripple_calcs");
+        mSearchTime = collector->make_event ("pathfind_search");
     }
 
     void updateAll (std::shared_ptr<ReadView const> const& ledger,
@@ -51,13 +57,20 @@ public:
     Json::Value makePathRequest (
         std::shared_ptr <InfoSub> const& subscriber,
         std::shared_ptr<ReadView const> const& ledger,
-        Json::Value const& request);
+        Json::Value const& request,
+        Role role);
 
     Json::Value makeLegacyPathRequest (
         PathRequest::pointer& req,
         std::function <void (void)> completion,
         std::shared_ptr<ReadView const> const& inLedger,
-        Json::Value const& request);
+        Json::Value const& request,
+        Role role);
+
+    PathCorridors const& getCorridors () const
+    {
+        return mCorridors;
+    }
 
     void reportFast (int milliseconds)
     {
@@ -69,6 +82,17 @@ public:
         mFull.notify (static_cast < beast::insight::Event::value_type> (milliseconds));
     }
 
+    // Searches shared by several requests are reported once
+    void reportStats (PathSearchStats const& stats)
+    {
+        using namespace std::chrono;
+        mNodes.increment (stats.nodes);
+        mLines.increment (stats.lines);
+        mRippleCalcs.increment (stats.rippleCalcs);
+        mSearchTime.notify (duration_cast<milliseconds> (
+            stats.findTime + stats.rankTime + stats.bestTime));
+    }
+
 private:
     void insertPathRequest (PathRequest::pointer const&);
 
@@ -77,6 +101,10 @@ private:
 
     beast::insight::Event            mFast;
     beast::insight::Event            mFull;
+    beast::insight::Counter          mNodes;
+    beast::insight::Counter          mLines;
+    beast::insight::Counter          mRippleCalcs;
+    beast::insight::Event            mSearchTime;
 
     // Track all requests
     std::vector<PathRequest::wptr>   mRequests;
@@ -84,6 +112,9 @@ private:
     // Use a RippleLineCache
     RippleLineCache::pointer         mLineCache;
 
+    // The paths of the configured corridors
+    PathCorridors                    mCorridors;
+
     std::atomic<int>                 mLastIdentifier;
 
     using ScopedLockType = std::lock_guard <std::recursive_mutex>;
@@ -28,6 +28,19 @@
 
 namespace ripple {
 
+namespace path {
+
+// Blocks are kept once free, so a thread holds on to the
+// most memory its path states have needed at once.
+Allocator <char> const&
+arena ()
+{
+    static thread_local Allocator <char> const alloc;
+    return alloc;
+}
+
+}
+
 // OPTIMIZE: When calculating path increment, note if increment consumes all
 // liquidity. No need to revisit path in the future if all liquidity is used.
 //
@@ -438,6 +451,9 @@ TER PathState::expandPath (
 
     terStatus = tesSUCCESS;
 
+    // Most elements imply at most one more node
+    nodes_.reserve (2 * spSourcePath.size () + 3);
+
     // VRP or VBC with issuer is malformed.
     if ((isXRP (uMaxCurrencyID) && !isXRP (uMaxIssuerID))
         || (isXRP (currencyOutID) && !isXRP (issuerOutID))
@@ -31,7 +31,7 @@ namespace ripple {
 class PathState : public CountedObject <PathState>
 {
   public:
-    using OfferIndexList = std::vector<uint256>;
+    using OfferIndexList = std::vector<uint256, path::Allocator<uint256>>;
     using Ptr = std::shared_ptr<PathState>;
     using List = std::vector<Ptr>;
 
@@ -43,6 +43,8 @@ class PathState : public CountedObject <PathState>
         , uQuality (0)
         , saInReq (saSendMax)
         , saOutReq (saSend)
+        , nodes_ (path::arena ())
+        , unfundedOffers_ (path::arena ())
         , j_ (j)
     {
         view_.emplace(&parent);
@@ -28,6 +28,7 @@
 #include <ripple/basics/Log.h>
 #include <ripple/json/to_string.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/protocol/JsonFields.h>
 #include <tuple>
 
 /*
@@ -141,6 +142,35 @@ std::string pathTypeToString (Pathfinder::PathType const& type)
 
 }  // namespace
 
+PathSearchStats&
+PathSearchStats::operator+= (PathSearchStats const& other)
+{
+    nodes += other.nodes;
+    lines += other.lines;
+    rippleCalcs += other.rippleCalcs;
+    findTime += other.findTime;
+    rankTime += other.rankTime;
+    bestTime += other.bestTime;
+    return *this;
+}
+
+Json::Value
+PathSearchStats::getJson () const
+{
+    using namespace std::chrono;
+    Json::Value ret (Json::objectValue);
+    ret[jss::nodes] = static_cast<Json::UInt> (nodes);
+    ret[jss::lines] = static_cast<Json::UInt> (lines);
+    ret[jss::ripple_calcs] = static_cast<Json::UInt> (rippleCalcs);
+    ret[jss::find_paths_ms] = static_cast<Json::UInt> (
+        duration_cast<milliseconds> (findTime).count ());
+    ret[jss::rank_paths_ms] = static_cast<Json::UInt> (
+        duration_cast<milliseconds> (rankTime).count ());
+    ret[jss::best_paths_ms] = static_cast<Json::UInt> (
+        duration_cast<milliseconds> (bestTime).count ());
+    return ret;
+}
+
 Pathfinder::Pathfinder (
     RippleLineCache::ref cache,
     AccountID const& uSrcAccount,
@@ -174,7 +204,23 @@ Pathfinder::~Pathfinder()
 {
 }
 
+bool Pathfinder::pastDeadline () const
+{
+    if (! mTimedOut && mDeadline && clock_type::now () >= *mDeadline)
+        mTimedOut = true;
+    return mTimedOut;
+}
+
 bool Pathfinder::findPaths (int searchLevel)
+{
+    auto const start = clock_type::now ();
+    auto const found = searchPaths (searchLevel);
+    mStats.findTime += std::chrono::duration_cast<std::chrono::microseconds> (
+        clock_type::now () - start);
+    return found;
+}
+
+bool Pathfinder::searchPaths (int searchLevel)
 {
     if (mDstAmount == zero)
     {
@@ -336,6 +382,12 @@ bool Pathfinder::findPaths (int searchLevel)
         // Only use paths with at most the current search level.
         if (costedPath.searchLevel <= searchLevel)
         {
+            if (pastDeadline ())
+            {
+                JLOG (j_.debug) << "Search stopped at the deadline";
+                break;
+            }
+
             addPathsForType (costedPath.type);
 
             // TODO(tom): we might be missing other good paths with this
@@ -358,7 +410,8 @@ TER Pathfinder::getPathLiquidity (
     STAmount const& minDstAmount,  // IN:  The minimum output this path must
                                    //      deliver to be worth keeping.
     STAmount& amountOut,           // OUT: The actual liquidity along the path.
-    uint64_t& qualityOut) const    // OUT: The returned initial quality
+    uint64_t& qualityOut,          // OUT: The returned initial quality
+    PathSearchStats& stats) const  // OUT: The payments calculated.
 {
     STPathSet pathSet;
     pathSet.push_back (path);
@@ -374,6 +427,7 @@ TER Pathfinder::getPathLiquidity (
         if (convert_all_)
             rcInput.partialPaymentAllowed = true;
 
+        ++stats.rippleCalcs;
         auto rc = path::RippleCalc::rippleCalculate (
             sandbox,
             mSrcAmount,
@@ -394,6 +448,7 @@ TER Pathfinder::getPathLiquidity (
         {
             // Now try to compute the remaining liquidity.
             rcInput.partialPaymentAllowed = true;
+            ++stats.rippleCalcs;
             rc = path::RippleCalc::rippleCalculate (
                 sandbox,
                 mSrcAmount,
@@ -433,6 +488,7 @@ STAmount smallestUsefulAmount (STAmount const& amount, int maxPaths)
 
 void Pathfinder::computePathRanks (int maxPaths)
 {
+    auto const start = clock_type::now ();
     mRemainingAmount = convert_all_ ?
         STAmount(mDstAmount.issue(), STAmount::cMaxValue,
             STAmount::cMaxOffset)
@@ -445,6 +501,7 @@ void Pathfinder::computePathRanks (int maxPaths)
 
         path::RippleCalc::Input rcInput;
         rcInput.partialPaymentAllowed = true;
+        ++mStats.rippleCalcs;
         auto rc = path::RippleCalc::rippleCalculate (
             sandbox,
             mSrcAmount,
@@ -472,7 +529,9 @@ void Pathfinder::computePathRanks (int maxPaths)
         JLOG (j_.debug) << "Default path causes exception";
     }
 
-    rankPaths (maxPaths, mCompletePaths, mPathRanks);
+    rankPaths (maxPaths, mCompletePaths, mPathRanks, mStats, true);
+    mStats.rankTime += std::chrono::duration_cast<std::chrono::microseconds> (
+        clock_type::now () - start);
 }
 
 static bool isDefaultPath (STPath const& path)
@@ -511,7 +570,9 @@ static STPath removeIssuer (STPath const& path)
 void Pathfinder::rankPaths (
     int maxPaths,
     STPathSet const& paths,
-    std::vector <PathRank>& rankedPaths)
+    std::vector <PathRank>& rankedPaths,
+    PathSearchStats& stats,
+    bool stopAtDeadline) const
 {
     rankedPaths.clear ();
     rankedPaths.reserve (paths.size());
@@ -532,13 +593,20 @@ void Pathfinder::rankPaths (
 
     for (int i = 0; i < paths.size (); ++i)
     {
+        if (stopAtDeadline && pastDeadline ())
+        {
+            JLOG (j_.debug) << "Ranking stopped at the deadline after " <<
+                i << " of " << paths.size () << " paths";
+            break;
+        }
+
         auto const& currentPath = paths[i];
         if (! currentPath.empty())
         {
             STAmount liquidity;
             uint64_t uQuality;
             auto const resultCode = getPathLiquidity (
-                currentPath, saMinDstAmount, liquidity, uQuality);
+                currentPath, saMinDstAmount, liquidity, uQuality, stats);
             if (resultCode != tesSUCCESS)
             {
                 JLOG (j_.debug) <<
@@ -588,8 +656,13 @@ Pathfinder::getBestPaths (
     int maxPaths,
     STPath& fullLiquidityPath,
     STPathSet const& extraPaths,
-    AccountID const& srcIssuer)
+    AccountID const& srcIssuer,
+    PathSearchStats* stats) const
 {
+    auto const start = clock_type::now ();
+    PathSearchStats unused;
+    auto& work = stats ? *stats : unused;
+
     JLOG (j_.debug) << "findPaths: " <<
         mCompletePaths.size() << " paths and " <<
         extraPaths.size () << " extras";
@@ -601,7 +674,7 @@ Pathfinder::getBestPaths (
     const bool issuerIsSender = isXRP (mSrcCurrency) || isVBC (mSrcCurrency) || (srcIssuer == mSrcAccount);
 
     std::vector <PathRank> extraPathRanks;
-    rankPaths (maxPaths, extraPaths, extraPathRanks);
+    rankPaths (maxPaths, extraPaths, extraPathRanks, work, false);
 
     STPathSet bestPaths;
 
@@ -708,6 +781,8 @@ Pathfinder::getBestPaths (
         JLOG (j_.debug) <<
             "findPaths: RESULTS: " << bestPaths.getJson (0);
     }
+    work.bestTime += std::chrono::duration_cast<std::chrono::microseconds> (
+        clock_type::now () - start);
     return bestPaths;
 }
 
@@ -751,7 +826,10 @@ int Pathfinder::getPathsOut (
     {
         count = app_.getOrderBookDB ().getBookSize (issue);
 
-        for (auto const& item : mRLCache->getRippleLines (account))
+        auto& rippleLines (mRLCache->getRippleLines (account));
+        mStats.lines += rippleLines.size ();
+
+        for (auto const& item : rippleLines)
         {
             RippleState* rspEntry = (RippleState*) item.get ();
 
@@ -796,7 +874,11 @@ void Pathfinder::addLinks (
         << "addLink< on " << currentPaths.size ()
         << " source(s), flags=" << addFlags;
     for (auto const& path: currentPaths)
+    {
+        if (pastDeadline ())
+            return;
         addLink (path, incompletePaths, addFlags);
+    }
 }
 
 STPathSet& Pathfinder::addPathsForType (PathType const& pathType)
@@ -921,6 +1003,7 @@ void Pathfinder::addLink (
     STPathSet& incompletePaths,     // The set of partial paths we add to
     int addFlags)
 {
+    ++mStats.nodes;
     auto const& pathEnd = currentPath.empty() ? mSource : currentPath.back ();
     auto const& uEndCurrency = pathEnd.getCurrency ();
     auto const& uEndIssuer = pathEnd.getIssuerID ();
@@ -970,6 +1053,7 @@ void Pathfinder::addLink (
                     addFlags & afAC_LAST);
 
                 auto& rippleLines (mRLCache->getRippleLines (uEndAccount));
+                mStats.lines += rippleLines.size ();
 
                 AccountCandidates candidates;
                 candidates.reserve (rippleLines.size ());
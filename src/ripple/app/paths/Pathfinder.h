@@ -23,11 +23,37 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/core/LoadEvent.h>
+#include <ripple/json/json_value.h>
 #include <ripple/protocol/STAmount.h>
 #include <ripple/protocol/STPathSet.h>
+#include <boost/optional.hpp>
+#include <chrono>
 
 namespace ripple {
 
+/** The work done to find, rank and choose payment paths. */
+struct PathSearchStats
+{
+    // Partial paths extended while searching
+    std::size_t nodes = 0;
+
+    // Trust lines looked at while searching
+    std::size_t lines = 0;
+
+    // Payments calculated to measure the liquidity of paths
+    std::size_t rippleCalcs = 0;
+
+    std::chrono::microseconds findTime {0};
+    std::chrono::microseconds rankTime {0};
+    std::chrono::microseconds bestTime {0};
+
+    PathSearchStats&
+    operator+= (PathSearchStats const& other);
+
+    Json::Value
+    getJson () const;
+};
+
 /** Calculates payment paths.
 
     The @ref RippleCalc determines the quality of the found paths.
@@ -49,8 +75,32 @@ public:
         Application& app);
     ~Pathfinder();
 
+    using clock_type = std::chrono::steady_clock;
+
     static void initPathTable ();
 
+    /** Stop searching and ranking new paths at a point in time.
+
+        The paths found and ranked before then are kept, so the best of
+        them can still be returned.
+    */
+    void setDeadline (clock_type::time_point deadline)
+    {
+        mDeadline = deadline;
+    }
+
+    /** Returns `true` if the deadline cut the search or ranking short. */
+    bool timedOut () const
+    {
+        return mTimedOut;
+    }
+
+    /** Returns the work done by findPaths and computePathRanks. */
+    PathSearchStats const& stats () const
+    {
+        return mStats;
+    }
+
     bool findPaths (int searchLevel);
 
     /** Compute the rankings of the paths. */
@@ -59,14 +109,16 @@ public:
     /* Get the best paths, up to maxPaths in number, from mCompletePaths.
 
        On return, if fullLiquidityPath is not empty, then it contains the best
-       additional single path which can consume all the liquidity.
+       additional single path which can consume all the liquidity. The work
+       of ranking the extra paths is added to stats, if given.
     */
     STPathSet
     getBestPaths (
         int maxPaths,
         STPath& fullLiquidityPath,
         STPathSet const& extraPaths,
-        AccountID const& srcIssuer);
+        AccountID const& srcIssuer,
+        PathSearchStats* stats = nullptr) const;
 
     enum NodeType
     {
@@ -110,26 +162,35 @@ private:
       Call graph of Pathfinder methods.
 
       findPaths:
-          addPathsForType:
-              addLinks:
-                  addLink:
-                      getPathsOut
-                      issueMatchesOrigin
-                      isNoRippleOut:
-                          isNoRipple
+          searchPaths:
+              addPathsForType:
+                  addLinks:
+                      addLink:
+                          getPathsOut
+                          issueMatchesOrigin
+                          isNoRippleOut:
+                              isNoRipple
 
       computePathRanks:
           rippleCalculate
-          getPathLiquidity:
-              rippleCalculate
+          rankPaths:
+              getPathLiquidity:
+                  rippleCalculate
 
       getBestPaths
+          rankPaths
      */
 
 
+    // The search itself, timed by findPaths.
+    bool searchPaths (int searchLevel);
+
     // Add all paths of one type to mCompletePaths.
     STPathSet& addPathsForType (PathType const& type);
 
+    // Has the deadline, if there is one, passed?
+    bool pastDeadline () const;
+
     bool issueMatchesOrigin (Issue const&);
 
     int getPathsOut (
@@ -156,7 +217,8 @@ private:
         STAmount const& minDstAmount,  // IN:  The minimum output this path must
                                        //      deliver to be worth keeping.
         STAmount& amountOut,           // OUT: The actual liquidity on the path.
-        uint64_t& qualityOut) const;   // OUT: The returned initial quality
+        uint64_t& qualityOut,          // OUT: The returned initial quality
+        PathSearchStats& stats) const; // OUT: The payments calculated.
 
     // Does this path end on an account-to-account link whose last account has
     // set the "no ripple" flag on the link?
@@ -168,10 +230,14 @@ private:
         AccountID const& toAccount,
         Currency const& currency);
 
+    // Stops at the deadline only if asked to, so that paths found earlier
+    // are always ranked.
     void rankPaths (
         int maxPaths,
         STPathSet const& paths,
-        std::vector <PathRank>& rankedPaths);
+        std::vector <PathRank>& rankedPaths,
+        PathSearchStats& stats,
+        bool stopAtDeadline) const;
 
     AccountID mSrcAccount;
     AccountID mDstAccount;
@@ -196,6 +262,10 @@ private:
 
     hash_map<Issue, int> mPathsOutCountMap;
 
+    boost::optional<clock_type::time_point> mDeadline;
+    bool mutable mTimedOut = false;
+    PathSearchStats mStats;
+
     Application& app_;
     beast::Journal j_;
 
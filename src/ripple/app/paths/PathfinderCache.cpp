@@ -0,0 +1,73 @@
+#include <BeastConfig.h>
+#include <ripple/app/paths/PathfinderCache.h>
+#include <ripple/protocol/Serializer.h>
+
+namespace ripple {
+
+PathfinderCache::pointer
+PathfinderCache::get (AccountID const& srcAccount,
+    AccountID const& dstAccount, Currency const& srcCurrency,
+    STAmount const& dstAmount, boost::optional<STAmount> const& srcAmount,
+    int level, int maxPaths, Application& app, bool* searched)
+{
+    Serializer s;
+    s.add160 (srcAccount);
+    s.add160 (dstAccount);
+    s.add160 (srcCurrency);
+    dstAmount.add (s);
+    s.add8 (srcAmount ? 1 : 0);
+    if (srcAmount)
+        srcAmount->add (s);
+    s.add32 (level);
+    s.add32 (maxPaths);
+    auto const key = s.getSHA512Half ();
+
+    std::shared_future<pointer> search;
+    std::promise<pointer> result;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const iter = searches_.find (key);
+        if (iter != searches_.end ())
+        {
+            ++shared_;
+            search = iter->second;
+        }
+        else
+        {
+            searches_.emplace (key, result.get_future ().share ());
+        }
+    }
+
+    if (search.valid ())
+        return search.get ();
+
+    if (searched)
+        *searched = true;
+
+    try
+    {
+        auto pathfinder = std::make_shared<Pathfinder> (cache_,
+            srcAccount, dstAccount, srcCurrency, boost::none,
+                dstAmount, srcAmount, app);
+        if (pathfinder->findPaths (level))
+            pathfinder->computePathRanks (maxPaths);
+        else
+            pathfinder.reset ();  // It's a bad request
+        result.set_value (pathfinder);
+        return pathfinder;
+    }
+    catch (...)
+    {
+        result.set_exception (std::current_exception ());
+        throw;
+    }
+}
+
+std::size_t
+PathfinderCache::shared () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return shared_;
+}
+
+} // ripple
@@ -0,0 +1,65 @@
+#ifndef RIPPLE_APP_PATHS_PATHFINDERCACHE_H_INCLUDED
+#define RIPPLE_APP_PATHS_PATHFINDERCACHE_H_INCLUDED
+
+#include <ripple/app/paths/Pathfinder.h>
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/protocol/STAmount.h>
+#include <boost/optional.hpp>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+
+/** The pathfinders searched against one line cache.
+
+    Requests which pay the same amount between the same accounts, from
+    the same source currency, search for the same paths. The first of them
+    to ask searches, the others wait for it and rank its paths themselves.
+*/
+class PathfinderCache
+{
+public:
+    using pointer = std::shared_ptr<Pathfinder const>;
+
+    explicit
+    PathfinderCache (RippleLineCache::ref cache)
+        : cache_ (cache)
+    {
+    }
+
+    PathfinderCache (PathfinderCache const&) = delete;
+    PathfinderCache& operator= (PathfinderCache const&) = delete;
+
+    RippleLineCache::pointer const&
+    getLineCache () const
+    {
+        return cache_;
+    }
+
+    /** Returns the ranked paths of a search, searching if nobody has.
+
+        @param searched Set to `true` if this call made the search.
+        @return `nullptr` if the search cannot be made.
+    */
+    pointer
+    get (AccountID const& srcAccount, AccountID const& dstAccount,
+        Currency const& srcCurrency, STAmount const& dstAmount,
+        boost::optional<STAmount> const& srcAmount, int level,
+        int maxPaths, Application& app, bool* searched = nullptr);
+
+    /** Returns the number of searches shared with an earlier request. */
+    std::size_t
+    shared () const;
+
+private:
+    RippleLineCache::pointer const cache_;
+    std::mutex mutable mutex_;
+    hash_map<uint256, std::shared_future<pointer>> searches_;
+    std::size_t shared_ = 0;
+};
+
+} // ripple
+
+#endif
@@ -95,7 +95,7 @@ RippleCalc::Output RippleCalc::rippleCalculate (
 
 bool RippleCalc::addPathState(STPath const& path, TER& resultCode)
 {
-    auto pathState = std::make_shared<PathState> (
+    auto pathState = std::allocate_shared<PathState> (path::arena (),
         view, saDstAmountReq_, saMaxAmountReq_, j_);
 
     if (!pathState)
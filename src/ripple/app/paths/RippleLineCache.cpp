@@ -23,8 +23,12 @@
 
 namespace ripple {
 
+// Lines not looked up for this many ledgers are not carried over
+static std::uint32_t const lineCacheLedgers = 16;
+
 RippleLineCache::RippleLineCache(
     std::shared_ptr <ReadView const> const& ledger)
+    : mLedgerHash (ledger->info().hash)
 {
     // We want the caching that OpenView provides
     // And we need to own a shared_ptr to the input view
@@ -32,19 +36,80 @@ RippleLineCache::RippleLineCache(
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
 }
 
+RippleLineCache::RippleLineCache(
+    std::shared_ptr <ReadView const> const& ledger,
+        RippleLineCache& previous)
+    : RippleLineCache (ledger)
+{
+    // Only the metadata of a closed ledger says what it changed
+    if (ledger->open() ||
+        ledger->info().parentHash != previous.mLedgerHash)
+        return;
+
+    hash_set <AccountID> changed;
+    for (auto const& item : ledger->txs)
+    {
+        if (! item.second)
+            return;
+
+        for (auto const& node : item.second->getFieldArray (sfAffectedNodes))
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltRIPPLE_STATE)
+                continue;
+
+            auto const data = dynamic_cast<STObject const*> (
+                node.peekAtPField ((node.getFName () == sfCreatedNode) ?
+                    sfNewFields : sfFinalFields));
+            if (! data)
+                return;
+
+            for (auto const field : {&sfLowLimit, &sfHighLimit})
+            {
+                if (! data->isFieldPresent (*field))
+                    return;
+                changed.insert (data->getFieldAmount (*field).getIssuer ());
+            }
+        }
+    }
+
+    auto const seq = ledger->info().seq;
+    std::lock_guard <std::mutex> sl (previous.mLock);
+    mRLMap.reserve (previous.mRLMap.size ());
+    for (auto const& entry : previous.mRLMap)
+    {
+        if ((entry.second.used + lineCacheLedgers) > seq &&
+                changed.count (entry.first.account_) == 0)
+            mRLMap.emplace (AccountKey (entry.first.account_,
+                hasher_ (entry.first.account_)), entry.second);
+    }
+}
+
 RippleLineCache::RippleStateVector const&
 RippleLineCache::getRippleLines (AccountID const& accountID)
 {
     AccountKey key (accountID, hasher_ (accountID));
 
-    std::lock_guard <std::mutex> sl (mLock);
+    {
+        std::lock_guard <std::mutex> sl (mLock);
+
+        auto const it = mRLMap.find (key);
+        if (it != mRLMap.end ())
+        {
+            it->second.used = mLedger->info().seq;
+            return *it->second.lines;
+        }
+    }
 
-    auto it = mRLMap.emplace (key, RippleStateVector ());
+    // The directory is walked without the lock, so other lookups need
+    // not wait for it. If another thread got there first, its lines win.
+    Lines entry;
+    entry.lines = std::make_shared<RippleStateVector const> (
+        ripple::getRippleStateItems (accountID, *mLedger));
+    entry.used = mLedger->info().seq;
 
-    if (it.second)
-        it.first->second = ripple::getRippleStateItems (accountID, *mLedger);
+    std::lock_guard <std::mutex> sl (mLock);
 
-    return it.first->second;
+    return *mRLMap.emplace (key, std::move (entry)).first->second.lines;
 }
 
 } // ripple
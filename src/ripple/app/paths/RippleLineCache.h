@@ -40,6 +40,16 @@ public:
 
     explicit RippleLineCache (std::shared_ptr <ReadView const> const& l);
 
+    /** Create the cache of the ledger after the one of another cache.
+
+        The lines of the accounts whose trust lines the ledger did not
+        touch are taken over from the other cache instead of being read
+        again. If the ledger does not follow the other cache's ledger
+        nothing is taken over.
+    */
+    RippleLineCache (std::shared_ptr <ReadView const> const& l,
+        RippleLineCache& previous);
+
     std::shared_ptr <ReadView const> const&
     getLedger () // VFALCO TODO const?
     {
@@ -54,6 +64,7 @@ private:
 
     ripple::hardened_hash<> hasher_;
     std::shared_ptr <ReadView const> mLedger;
+    uint256 mLedgerHash;
 
     struct AccountKey
     {
@@ -91,7 +102,16 @@ private:
         };
     };
 
-    hash_map <AccountKey, RippleStateVector, AccountKey::Hash> mRLMap;
+    struct Lines
+    {
+        // Shared with the caches of later ledgers
+        std::shared_ptr<RippleStateVector const> lines;
+
+        // The last ledger the lines were looked up in
+        std::uint32_t used;
+    };
+
+    hash_map <AccountKey, Lines, AccountKey::Hash> mRLMap;
 };
 
 } // ripple
@@ -30,6 +30,8 @@ int const PATHFINDER_HIGH_PRIORITY = 100000;
 int const PATHFINDER_MAX_PATHS = 50;
 int const PATHFINDER_MAX_COMPLETE_PATHS = 1000;
 int const PATHFINDER_MAX_PATHS_FROM_SOURCE = 10;
+int const PATHFINDER_CORRIDOR_PATHS = 6;
+int const PATHFINDER_CORRIDOR_SEARCH_LEDGERS = 16;
 
 } // ripple
 
@@ -20,21 +20,100 @@
 #ifndef RIPPLE_APP_PATHS_TYPES_H_INCLUDED
 #define RIPPLE_APP_PATHS_TYPES_H_INCLUDED
 
+#include <ripple/basics/qalloc.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/Issue.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace ripple {
 
 // account id, issue.
 using AccountIssue = std::pair <AccountID, Issue>;
 
-// Map of account, issue to node index.
 namespace path {
 
 using NodeIndex = unsigned int;
 
 using OfferSet = hash_set <uint256>;
 
+// Path states come from an arena shared by the payments of one thread, so
+// a payment reuses the memory of the one before it. They must be destroyed
+// on the thread that made them.
+template <class T>
+using Allocator = qalloc_type <T, true>;
+
+Allocator <char> const&
+arena ();
+
 }
 
-using AccountIssueToNodeIndex = hash_map <AccountIssue, path::NodeIndex>;
+// Map of account, issue to node index.
+//
+// A path has few nodes, so the entries are kept in a vector and looked up
+// in turn. Clearing it keeps the storage for the next pass.
+class AccountIssueToNodeIndex
+{
+public:
+    using value_type = std::pair <AccountIssue, path::NodeIndex>;
+
+private:
+    using list_type = std::vector <value_type, path::Allocator <value_type>>;
+
+    list_type list_;
+
+public:
+    using const_iterator = list_type::const_iterator;
+
+    AccountIssueToNodeIndex ()
+        : list_ (path::arena ())
+    {
+    }
+
+    const_iterator begin () const
+    {
+        return list_.begin ();
+    }
+
+    const_iterator end () const
+    {
+        return list_.end ();
+    }
+
+    const_iterator find (AccountIssue const& key) const
+    {
+        return std::find_if (list_.begin (), list_.end (),
+            [&key](value_type const& v) { return v.first == key; });
+    }
+
+    std::pair <const_iterator, bool> insert (value_type const& v)
+    {
+        auto const iter = find (v.first);
+        if (iter != list_.end ())
+            return { iter, false };
+        list_.push_back (v);
+        return { list_.end () - 1, true };
+    }
+
+    template <class Iterator>
+    void insert (Iterator first, Iterator last)
+    {
+        for (; first != last; ++first)
+            insert (*first);
+    }
+
+    void clear ()
+    {
+        list_.clear ();
+    }
+
+    std::size_t size () const
+    {
+        return list_.size ();
+    }
+};
 
 } // ripple
 
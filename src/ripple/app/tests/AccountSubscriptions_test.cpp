@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountSubscriptions.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class AccountSubscriptions_test : public beast::unit_test::suite
+{
+    // Forwards the account unsubscribes of a destroyed InfoSub
+    class Source : public InfoSub::Source
+    {
+    public:
+        AccountSubscriptions* subs = nullptr;
+
+        explicit
+        Source (beast::Stoppable& parent)
+            : InfoSub::Source ("Source", parent)
+        {
+        }
+
+        void subAccount (InfoSub::ref, hash_set<AccountID> const&,
+            bool) override { }
+        void unsubAccount (InfoSub::ref, hash_set<AccountID> const&,
+            bool) override { }
+        void unsubAccountInternal (std::uint64_t seq,
+            hash_set<AccountID> const& accounts, bool rt) override
+        {
+            if (subs)
+                subs->erase (seq, accounts, rt);
+        }
+        bool subLedger (InfoSub::ref, Json::Value&) override { return false; }
+        bool unsubLedger (std::uint64_t) override { return false; }
+        bool subServer (InfoSub::ref, Json::Value&, bool) override
+            { return false; }
+        bool unsubServer (std::uint64_t) override { return false; }
+        bool subBook (InfoSub::ref, Book const&) override { return false; }
+        bool unsubBook (std::uint64_t, Book const&) override { return false; }
+        bool subTransactions (InfoSub::ref) override { return false; }
+        bool unsubTransactions (std::uint64_t) override { return false; }
+        bool subRTTransactions (InfoSub::ref) override { return false; }
+        bool unsubRTTransactions (std::uint64_t) override { return false; }
+        bool subValidations (InfoSub::ref) override { return false; }
+        bool unsubValidations (std::uint64_t) override { return false; }
+        bool subPeerStatus (InfoSub::ref) override { return false; }
+        bool unsubPeerStatus (std::uint64_t) override { return false; }
+        void pubPeerStatus (std::function<Json::Value(void)> const&)
+            override { }
+        bool subDividend (InfoSub::ref) override { return false; }
+        bool unsubDividend (std::uint64_t) override { return false; }
+        void pubDividend (std::function<Json::Value(void)> const&)
+            override { }
+        bool subFee (InfoSub::ref, Json::Value&) override { return false; }
+        bool unsubFee (std::uint64_t) override { return false; }
+        InfoSub::pointer findRpcSub (std::string const&) override
+            { return {}; }
+        InfoSub::pointer addRpcSub (std::string const&, InfoSub::ref)
+            override { return {}; }
+    };
+
+    class Sub : public InfoSub
+    {
+    public:
+        std::vector<Json::Value> received;
+
+        explicit
+        Sub (Source& source)
+            : InfoSub (source, Consumer ())
+        {
+        }
+
+        void send (Json::Value const& jv, bool) override
+        {
+            received.push_back (jv);
+        }
+    };
+
+    static
+    AccountID
+    account (std::uint8_t n)
+    {
+        AccountID id;
+        id.zero ();
+        *id.begin () = n;
+        return id;
+    }
+
+    // As NetworkOPs subscribes, so the InfoSub unsubscribes as it goes
+    static
+    void
+    subscribe (AccountSubscriptions& subs, InfoSub::ref sub,
+        hash_set<AccountID> const& accounts, bool rt)
+    {
+        for (auto const& account : accounts)
+            sub->insertSubAccountInfo (account, rt);
+        subs.insert (sub, accounts, rt);
+    }
+
+    static
+    std::shared_ptr<AccountSubscriptions::Event const>
+    event (int n)
+    {
+        Json::Value jv (Json::objectValue);
+        jv["n"] = n;
+        return std::make_shared<AccountSubscriptions::Event> (std::move (jv));
+    }
+
+    void
+    testFind ()
+    {
+        testcase ("find");
+
+        beast::RootStoppable root ("AccountSubscriptions_test");
+        Source source (root);
+        AccountSubscriptions subs (nullptr, 16);
+        source.subs = &subs;
+
+        auto a = std::make_shared<Sub> (source);
+        auto b = std::make_shared<Sub> (source);
+        subscribe (subs, a, {account (1), account (2), account (3)}, false);
+        subscribe (subs, b, {account (2)}, true);
+
+        expect (subs.empty (false) == false);
+        expect (subs.getStats ().accounts == 4);
+        expect (subs.getStats ().subscribers == 2);
+
+        // One entry for a subscriber of several of the accounts
+        std::vector<AccountID> const affected {
+            account (1), account (2), account (3)};
+        expect (subs.find (affected, true).size () == 2);
+
+        // Only real time subscribers see proposed transactions
+        {
+            auto const proposed = subs.find (affected, false);
+            expect (proposed.size () == 1 && proposed[0] == b);
+        }
+
+        subs.publish (subs.find (affected, true), event (1));
+        expect (a->received.size () == 1);
+        expect (b->received.size () == 1);
+
+        subs.erase (a->getSeq (), {account (1), account (2)}, false);
+        expect (subs.find (std::vector<AccountID> {account (1)},
+            true).empty ());
+        expect (subs.find (std::vector<AccountID> {account (3)},
+            true).size () == 1);
+
+        // Destroying the subscriber removes it from the index
+        a.reset ();
+        b.reset ();
+        expect (subs.empty (true));
+        expect (subs.getStats ().subscribers == 0);
+    }
+
+    void
+    testQueue ()
+    {
+        testcase ("queue");
+
+        beast::RootStoppable root ("AccountSubscriptions_test");
+        Source source (root);
+        std::vector<std::function<void ()>> jobs;
+        AccountSubscriptions subs (
+            [&jobs](std::function<void ()> drain)
+            {
+                jobs.push_back (std::move (drain));
+            }, 3);
+        source.subs = &subs;
+
+        auto a = std::make_shared<Sub> (source);
+        subscribe (subs, a, {account (1)}, true);
+        auto const found = subs.find (
+            std::vector<AccountID> {account (1)}, false);
+
+        for (int i = 0; i < 5; ++i)
+            subs.publish (found, event (i));
+
+        // One drain is scheduled, the queue holds the first three
+        expect (jobs.size () == 1);
+        expect (a->received.empty ());
+        expect (subs.getStats ().queued == 3);
+        expect (subs.getStats ().dropped == 2);
+
+        auto const drain = std::move (jobs.front ());
+        jobs.clear ();
+        drain ();
+        expect (jobs.empty ());
+        expect (a->received.size () == 3);
+        for (int i = 0; i < 3; ++i)
+            expect (a->received[i]["n"].asInt () == i);
+
+        // A queue longer than a batch makes way for other jobs
+        AccountSubscriptions big (
+            [&jobs](std::function<void ()> drain)
+            {
+                jobs.push_back (std::move (drain));
+            }, 1000);
+        source.subs = &big;
+        auto b = std::make_shared<Sub> (source);
+        subscribe (big, b, {account (2)}, false);
+        auto const all = big.find (
+            std::vector<AccountID> {account (2)}, true);
+        auto const count = AccountSubscriptions::drainBatch + 1;
+        for (std::size_t i = 0; i < count; ++i)
+            big.publish (all, event (i));
+
+        while (! jobs.empty ())
+        {
+            auto const job = std::move (jobs.front ());
+            jobs.erase (jobs.begin ());
+            job ();
+        }
+        expect (b->received.size () == count);
+        b.reset ();
+        source.subs = &subs;
+    }
+
+public:
+    void run ()
+    {
+        testFind ();
+        testQueue ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountSubscriptions, app, ripple)
+
+} // test
+} // ripple
@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/AccountTxCache.h>
+#include <ripple/protocol/JsonFields.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace ripple {
+namespace test {
+
+class AccountTxCache_test : public beast::unit_test::suite
+{
+    using Key = std::pair<std::uint32_t, std::uint32_t>;
+
+    // Every transaction added, as the database would hold them
+    std::map<AccountID, std::vector<Key>> history_;
+
+    void
+    add (AccountTxCache& cache, std::uint32_t seq,
+        std::vector<std::vector<AccountID>> const& txs)
+    {
+        std::vector<AccountTxCache::Entry> entries;
+        std::uint32_t txnSeq = 0;
+        for (auto const& accounts : txs)
+        {
+            auto tx = std::make_shared<AccountTxCache::Tx> ();
+            tx->ledgerSeq = seq;
+            tx->txnSeq = txnSeq++;
+            tx->rawTxn = Blob (1, static_cast<std::uint8_t> (tx->txnSeq));
+            entries.emplace_back (tx, accounts);
+            for (auto const& account : accounts)
+                history_[account].emplace_back (seq, tx->txnSeq);
+        }
+        cache.addLedger (seq, entries);
+    }
+
+    // The page accountTxPage reads from the database
+    std::vector<Key>
+    expected (AccountID const& account, std::uint32_t minLedger,
+        std::uint32_t maxLedger, bool forward, Json::Value& token,
+        std::uint32_t limit)
+    {
+        Key lo (minLedger, 0);
+        Key hi (maxLedger, std::numeric_limits<std::uint32_t>::max ());
+        if (token.isMember (jss::ledger))
+        {
+            Key const marker (token[jss::ledger].asUInt (),
+                token[jss::seq].asUInt ());
+            (forward ? lo : hi) = marker;
+        }
+        token = Json::nullValue;
+
+        std::vector<Key> rows;
+        for (auto const& key : history_[account])
+            if (key >= lo && key <= hi)
+                rows.push_back (key);
+        if (! forward)
+            std::reverse (rows.begin (), rows.end ());
+
+        if (rows.size () > limit)
+        {
+            token = Json::objectValue;
+            token[jss::ledger] = rows[limit].first;
+            token[jss::seq] = rows[limit].second;
+            rows.resize (limit);
+        }
+        return rows;
+    }
+
+    // Returns true if the cache served the page, checking it
+    bool
+    check (AccountTxCache& cache, AccountID const& account,
+        std::uint32_t minLedger, std::uint32_t maxLedger, bool forward,
+        Json::Value& token, int limit)
+    {
+        std::vector<Key> rows;
+        auto const onTransaction = [&rows](std::uint32_t ledgerSeq,
+            std::string const& status, Blob const& rawTxn, Blob const&)
+        {
+            rows.emplace_back (ledgerSeq, rawTxn.front ());
+        };
+
+        Json::Value want = token;
+        Json::Value got = token;
+        if (! cache.page (account, minLedger, maxLedger, forward, got,
+                limit, false, 200, onTransaction))
+        {
+            expect (got == token);
+            expect (rows.empty ());
+            return false;
+        }
+
+        expect (rows == expected (
+            account, minLedger, maxLedger, forward, want, limit));
+        expect (got == want);
+        token = got;
+        return true;
+    }
+
+    void
+    testServed ()
+    {
+        testcase ("served");
+        history_.clear ();
+
+        AccountID const alice (1), bob (2);
+        AccountTxCache cache (16, 4);
+
+        Json::Value token;
+        expect (! check (cache, alice, 1, 10, false, token, 2));
+
+        add (cache, 10, {{alice}, {alice, bob}});
+        add (cache, 11, {{bob}});
+        add (cache, 12, {{alice}, {alice}});
+
+        // The newest page is known once it has a row past its end
+        expect (check (cache, alice, 1, 12, false, token, 2));
+        expect (token.isMember (jss::ledger));
+        expect (check (cache, alice, 1, 12, false, token, 1));
+        expect (token.isMember (jss::ledger));
+
+        // Bob's oldest transaction could be older than the cache
+        token = Json::nullValue;
+        expect (! check (cache, bob, 1, 12, false, token, 2));
+        expect (check (cache, bob, 10, 12, false, token, 2));
+        expect (token.isNull ());
+
+        // Forward pages need the whole range
+        expect (! check (cache, alice, 9, 12, true, token, 10));
+        expect (check (cache, alice, 10, 12, true, token, 2));
+        expect (token.isMember (jss::ledger));
+        expect (check (cache, alice, 10, 12, true, token, 2));
+        expect (token.isNull ());
+
+        // Ledgers not yet published
+        expect (! check (cache, alice, 10, 13, true, token, 2));
+
+        // An account without transactions
+        expect (check (cache, AccountID (3), 10, 12, false, token, 5));
+        expect (! check (cache, AccountID (3), 9, 12, false, token, 5));
+
+        auto const stats = cache.getStats ();
+        expect (stats.accounts == 2);
+        expect (stats.hits == 6);
+        expect (stats.misses == 5);
+    }
+
+    void
+    testEviction ()
+    {
+        testcase ("eviction");
+        history_.clear ();
+
+        AccountID const alice (1), bob (2), carol (3);
+        AccountTxCache cache (2, 2);
+
+        add (cache, 5, {{alice}, {alice}, {alice}, {bob}});
+
+        // Only alice's newest two are kept
+        Json::Value token;
+        expect (check (cache, alice, 5, 5, false, token, 1));
+        token = Json::nullValue;
+        expect (! check (cache, alice, 5, 5, false, token, 2));
+
+        add (cache, 6, {{alice}});
+        expect (! check (cache, alice, 5, 6, true, token, 5));
+        expect (check (cache, alice, 6, 6, true, token, 5));
+
+        // Bob, used least recently, makes room for carol. Nothing
+        // of his after that ledger can be missing.
+        add (cache, 7, {{carol}});
+        expect (cache.getStats ().accounts == 2);
+        expect (check (cache, bob, 7, 7, false, token, 5));
+        expect (! check (cache, bob, 5, 7, false, token, 5));
+        expect (check (cache, carol, 7, 7, true, token, 5));
+        expect (! check (cache, carol, 8, 8, true, token, 5));
+
+        add (cache, 8, {{carol}});
+        expect (check (cache, carol, 8, 8, true, token, 5));
+        expect (check (cache, bob, 8, 8, false, token, 5));
+
+        // A ledger out of sequence empties the cache
+        add (cache, 10, {{alice}});
+        expect (cache.getStats ().accounts == 1);
+        expect (! check (cache, alice, 8, 10, true, token, 5));
+        expect (check (cache, alice, 10, 10, true, token, 5));
+    }
+
+    void
+    testRandom ()
+    {
+        testcase ("random");
+        history_.clear ();
+
+        std::mt19937 gen (42);
+        AccountTxCache cache (8, 6);
+        std::uniform_int_distribution<int> pick (1, 12);
+        std::uniform_int_distribution<int> count (0, 4);
+
+        std::size_t served = 0;
+        for (std::uint32_t seq = 100; seq < 400; ++seq)
+        {
+            std::vector<std::vector<AccountID>> txs (count (gen));
+            for (auto& accounts : txs)
+            {
+                accounts.emplace_back (pick (gen));
+                auto const other = AccountID (pick (gen));
+                if (other != accounts.front ())
+                    accounts.push_back (other);
+                std::sort (accounts.begin (), accounts.end ());
+            }
+            add (cache, seq, txs);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                AccountID const account (pick (gen));
+                bool const forward = (gen () % 2) == 0;
+                std::uint32_t const minLedger =
+                    (gen () % 2) ? 100 : seq - gen () % 20;
+                int const limit = 1 + gen () % 5;
+
+                // Pages on until the cache misses
+                Json::Value token;
+                while (check (cache, account, minLedger, seq, forward,
+                        token, limit))
+                {
+                    ++served;
+                    if (token.isNull ())
+                        break;
+                }
+            }
+        }
+        expect (served > 100);
+    }
+
+public:
+    void
+    run ()
+    {
+        testServed ();
+        testEviction ();
+        testRandom ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountTxCache, app, ripple)
+
+}
+}
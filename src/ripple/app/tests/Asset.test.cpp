@@ -1,5 +1,6 @@
 #include <BeastConfig.h>
 #include <ripple/test/jtx.h>
+#include <ripple/protocol/Feature.h>
 #include <ripple/protocol/JsonFields.h>
 
 namespace ripple
@@ -602,6 +603,72 @@ struct Asset_test : public beast::unit_test::suite
                           gw.id (), ASSET.currency)));
     }
 
+    static Json::Value
+    compact (jtx::Account const& account,
+             std::vector<uint256> const& lines)
+    {
+        Json::Value jv;
+        jv[jss::Account] = account.human ();
+        jv[jss::TransactionType] = "CompactAsset";
+        auto& indexes = (jv["Indexes"] = Json::arrayValue);
+        for (auto const& line : lines)
+            indexes.append (to_string (line));
+        return jv;
+    }
+
+    void testCompact ()
+    {
+        using namespace jtx;
+        auto const gw = Account ("gw");
+        auto const ASSET = gw["4153534554000000000000000000000000000000"];
+        auto const line = keylet::line (Account ("bob").id (), gw.id (),
+                                        ASSET.currency).key;
+        uint256 assetStateIndexZero = getQualityIndex (
+            getAssetStateIndex (Account ("bob").id (), gw.id (), ASSET.currency));
+        uint256 assetStateIndexNext = getQualityNext (assetStateIndexZero);
+
+        {
+            Env env (*this);
+            env.fund (XRP (100000), "bob", gw);
+            env (compact ("bob", {line}), ter (temDISABLED));
+        }
+
+        auto config = std::make_unique<Config> ();
+        setupConfigForUnitTests (*config);
+        config->features.insert (featureCompactAsset);
+        Env env (*this, std::move (config));
+        env.fund (XRP (100000), "alice", "bob", "carol", gw);
+
+        auto jv = issue (gw, "alice", ASSET (40000000));
+        appendReleasePoint (jv, 0, 500000000);
+        appendReleasePoint (jv, 86400, 1000000000);
+        env (jv);
+        env.close (std::chrono::seconds (86400 + 600));
+
+        env (trust ("bob", ASSET (100)));
+        env (pay ("alice", "bob", ASSET (10)));
+        expectBalanceAndReserve (env, Account ("bob"), gw, ASSET, 5, 5);
+        expect (env.open ()->succ (assetStateIndexZero, assetStateIndexNext),
+                "asset state missing");
+
+        env (compact ("bob", {}), ter (temMALFORMED));
+        env (compact ("bob", {line, line}), ter (temMALFORMED));
+        env (compact ("bob", {assetStateIndexZero}), ter (tecNO_LINE));
+
+        // Nothing due yet
+        env (compact ("bob", {line}));
+        expectBalanceAndReserve (env, Account ("bob"), gw, ASSET, 5, 5);
+
+        env.close (std::chrono::seconds (2 * 86400));
+
+        // Only the holder or the issuer
+        env (compact ("carol", {line}), ter (tecNO_PERMISSION));
+        env (compact ("bob", {line}));
+        expectBalanceAndReserve (env, Account ("bob"), gw, ASSET, 10, 0);
+        unexpected (env.open ()->succ (assetStateIndexZero, assetStateIndexNext),
+                    "asset state not removed");
+    }
+
     void run () override
     {
         testIssue ();
@@ -609,6 +676,7 @@ struct Asset_test : public beast::unit_test::suite
         testRelease (0, 10, 95);
         testPayment ();
         testOffer ();
+        testCompact ();
     }
 };
 
@@ -0,0 +1,99 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/BinaryStream.h>
+#include <ripple/protocol/Serializer.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class BinaryStream_test : public beast::unit_test::suite
+{
+    static
+    LedgerInfo
+    info ()
+    {
+        LedgerInfo info;
+        info.seq = 1234;
+        info.hash = uint256 (5);
+        info.parentHash = uint256 (4);
+        info.closeTime = 500000000;
+        info.parentCloseTime = 499999990;
+        info.closeTimeResolution = 10;
+        return info;
+    }
+
+    void
+    testTransaction ()
+    {
+        testcase ("transaction");
+
+        STTx tx (ttACCOUNT_SET);
+        tx.setAccountID (sfAccount, AccountID (1));
+        tx.setFieldU32 (sfSequence, 7);
+        Blob const meta (300, 0x5a);
+
+        auto const data = BinaryStream::makeTransaction (
+            info (), tx, tecNO_DST, meta);
+        SerialIter sit (makeSlice (data));
+        expect (sit.get8 () == BinaryStream::transaction);
+        expect (sit.get32 () == 1234);
+        expect (sit.get256 () == uint256 (5));
+        expect (sit.get32 () == 500000000);
+        expect (static_cast<TER> (sit.get32 ()) == tecNO_DST);
+
+        Serializer expected;
+        tx.add (expected);
+        auto const raw = sit.getVL ();
+        expect (raw == expected.peekData ());
+        STTx const copy (SerialIter {makeSlice (raw)});
+        expect (copy.getFieldU32 (sfSequence) == 7);
+        expect (sit.getVL () == meta);
+        expect (sit.empty ());
+
+        // Results below zero keep their sign
+        auto const failed = BinaryStream::makeTransaction (
+            info (), tx, tefPAST_SEQ, meta);
+        SerialIter fit (makeSlice (failed));
+        fit.skip (41);
+        expect (static_cast<TER> (fit.get32 ()) == tefPAST_SEQ);
+    }
+
+    void
+    testLedger ()
+    {
+        testcase ("ledger");
+
+        Fees fees;
+        fees.base = 10;
+        fees.units = 10;
+        fees.reserve = 20000000;
+        fees.increment = 5000000;
+
+        auto const data = BinaryStream::makeLedger (info (), fees, 42);
+        Serializer header;
+        addRaw (info (), header);
+
+        SerialIter sit (makeSlice (data));
+        expect (sit.get8 () == BinaryStream::ledger);
+        expect (sit.getRaw (header.getDataLength ()) == header.peekData ());
+        expect (sit.get256 () == uint256 (5));
+        expect (sit.get32 () == 42);
+        expect (sit.get64 () == 10);
+        expect (sit.get32 () == 10);
+        expect (sit.get32 () == 20000000);
+        expect (sit.get32 () == 5000000);
+        expect (sit.empty ());
+    }
+
+    void
+    run ()
+    {
+        testTransaction ();
+        testLedger ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BinaryStream,app,ripple);
+
+} // test
+} // ripple
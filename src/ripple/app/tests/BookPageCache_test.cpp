@@ -0,0 +1,77 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/BookPageCache.h>
+#include <ripple/protocol/UintTypes.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class BookPageCache_test : public beast::unit_test::suite
+{
+    static
+    BookPageCache::Page
+    page (int offers)
+    {
+        Json::Value jv (Json::arrayValue);
+        for (int i = 0; i < offers; ++i)
+            jv.append (i);
+        return std::make_shared<Json::Value const> (std::move (jv));
+    }
+
+    void
+    testKey ()
+    {
+        testcase ("key");
+
+        Book const book ({to_currency ("USD"), AccountID (1)},
+            {to_currency ("EUR"), AccountID (2)});
+        auto const key = BookPageCache::key (book, false, 300);
+        expect (key == BookPageCache::key (book, false, 300));
+        expect (key != BookPageCache::key (book, true, 300));
+        expect (key != BookPageCache::key (book, false, 20));
+        expect (key != BookPageCache::key (reversed (book), false, 300));
+    }
+
+    void
+    testLedgers ()
+    {
+        testcase ("ledgers");
+
+        BookPageCache cache (2, 2);
+        uint256 const first (1), second (2), third (3);
+        uint256 const a (10), b (11), c (12);
+
+        cache.insert (first, 1, a, page (1));
+        cache.insert (first, 1, b, page (2));
+        cache.insert (first, 1, c, page (3));
+        expect (cache.size () == 2);
+        expect (cache.fetch (first, a)->size () == 1);
+        expect (cache.fetch (first, b)->size () == 2);
+        expect (! cache.fetch (first, c));
+        expect (! cache.fetch (second, a));
+
+        // A newer ledger pushes out the oldest
+        cache.insert (second, 2, a, page (4));
+        cache.insert (third, 3, a, page (5));
+        expect (! cache.fetch (first, a));
+        expect (cache.fetch (second, a)->size () == 4);
+        expect (cache.fetch (third, a)->size () == 5);
+
+        // An older one is not kept
+        cache.insert (first, 1, a, page (1));
+        expect (! cache.fetch (first, a));
+        expect (cache.size () == 2);
+    }
+
+    void
+    run ()
+    {
+        testKey ();
+        testLedgers ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BookPageCache,app,ripple);
+
+} // test
+} // ripple
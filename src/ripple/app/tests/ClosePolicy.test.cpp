@@ -0,0 +1,107 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/ClosePolicy.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class ClosePolicy_test : public beast::unit_test::suite
+{
+public:
+    using Decision = ClosePolicy::Decision;
+
+    void
+    testDecide ()
+    {
+        testcase ("decide");
+
+        using namespace std::chrono;
+        ClosePolicy::Setup setup;
+        setup.targetApply = milliseconds (1000);
+        setup.smallLedger = 10;
+        setup.linger = milliseconds (4000);
+        ClosePolicy policy (setup);
+
+        // Nothing measured yet
+        expect (policy.decide (100000, 0) == Decision::normal);
+        expect (policy.decide (5, 0) == Decision::linger);
+        expect (policy.decide (5, 1) == Decision::normal);
+
+        // Empty ledgers are not measured
+        policy.onApplied (0, seconds (1));
+        expect (policy.projectApply (1000) == milliseconds (0));
+
+        // One millisecond per transaction
+        policy.onApplied (100, milliseconds (100));
+        expect (policy.projectApply (500) == milliseconds (500));
+        expect (policy.decide (999, 0) == Decision::normal);
+        expect (policy.decide (1000, 0) == Decision::early);
+
+        // Later ledgers move the average
+        policy.onApplied (100, milliseconds (500));
+        expect (policy.projectApply (1000) == milliseconds (2000));
+        expect (policy.decide (500, 0) == Decision::early);
+
+        auto const json = policy.getJson ();
+        expect (json["decision"] == "early");
+        expect (json["projected_apply_ms"] == 1000);
+        expect (json["last_apply_ms"] == 500);
+        expect (json["last_transactions"] == 100);
+    }
+
+    void
+    testSetup ()
+    {
+        testcase ("setup");
+
+        using namespace std::chrono;
+        {
+            auto const setup = setup_ClosePolicy (Section ("ledger_close"));
+            expect (setup.targetApply == milliseconds (1500));
+            expect (setup.smallLedger == 0);
+            expect (setup.linger == milliseconds (0));
+
+            // Lingering is off, and so is adapting with no target
+            ClosePolicy policy (ClosePolicy::Setup {milliseconds (0)});
+            policy.onApplied (1, seconds (1));
+            expect (policy.decide (0, 0) == Decision::normal);
+            expect (policy.decide (100, 0) == Decision::normal);
+        }
+        {
+            Section section ("ledger_close");
+            section.append ({"target_apply_ms=800", "small_ledger=20",
+                "linger_ms=3000"});
+            auto const setup = setup_ClosePolicy (section);
+            expect (setup.targetApply == milliseconds (800));
+            expect (setup.smallLedger == 20);
+            expect (setup.linger == milliseconds (3000));
+        }
+        for (auto const line : {"target_apply_ms=-1", "small_ledger=few",
+            "linger_ms=soon"})
+        {
+            Section section ("ledger_close");
+            section.append (line);
+            try
+            {
+                setup_ClosePolicy (section);
+                fail (line);
+            }
+            catch (std::runtime_error const&)
+            {
+                pass ();
+            }
+        }
+    }
+
+    void
+    run () override
+    {
+        testDecide ();
+        testSetup ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ClosePolicy,app,ripple);
+
+} // test
+} // ripple
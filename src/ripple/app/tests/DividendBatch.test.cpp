@@ -0,0 +1,234 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/DividendBatch.h>
+#include <ripple/protocol/STVector256.h>
+#include <ripple/shamap/tests/common.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <random>
+
+namespace ripple {
+namespace test {
+
+class DividendBatch_test : public beast::unit_test::suite
+{
+    static std::uint32_t const dividendLedger = 1000;
+
+    struct Map
+    {
+        std::vector<STObject> payees;   // in key order
+        std::vector<uint256> keys;
+        uint256 hash;
+    };
+
+    static
+    Blob
+    publicKey ()
+    {
+        return Blob (33, 2);
+    }
+
+    /** A dividend map of random accounts, hashed by a SHAMap. */
+    static
+    Map
+    makeMap (std::size_t count, beast::xor_shift_engine& gen,
+        tests::TestFamily& family)
+    {
+        std::uniform_int_distribution<std::uint64_t> coins (0, 1000000);
+        std::vector<std::pair<uint256, STObject>> items;
+        SHAMap map (SHAMapType::TRANSACTION, family);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            AccountID account;
+            for (auto& b : account)
+                b = static_cast<std::uint8_t> (gen ());
+            auto payee = DividendBatch::makePayee (account,
+                DividendMaster::AccountsDividend::mapped_type (coins (gen),
+                    coins (gen), coins (gen), coins (gen), 1, i, i));
+
+            auto const apply = DividendBatch::makeApply (
+                payee, dividendLedger, publicKey ());
+            Serializer s;
+            apply.add (s);
+            auto const key = DividendBatch::itemKey (apply);
+            map.addGiveItem (make_shamapitem (key, std::move (s)),
+                true, false);
+            items.emplace_back (key, std::move (payee));
+        }
+
+        std::sort (items.begin (), items.end (),
+            [](std::pair<uint256, STObject> const& a,
+               std::pair<uint256, STObject> const& b)
+            {
+                return a.first < b.first;
+            });
+        Map result;
+        for (auto& item : items)
+        {
+            result.keys.push_back (item.first);
+            result.payees.push_back (std::move (item.second));
+        }
+        result.hash = map.getHash ().as_uint256 ();
+        return result;
+    }
+
+    static
+    STTx
+    makeTx (Map const& map, DividendBatch::Batch const& batch)
+    {
+        STArray payees (sfDividendPayees);
+        for (auto i = batch.first; i < batch.last; ++i)
+            payees.push_back (map.payees[i]);
+        return DividendBatch::makeTx (dividendLedger, map.hash, batch,
+            std::move (payees), publicKey ());
+    }
+
+    /** A batch transaction after a round trip through its serialization. */
+    static
+    STTx
+    roundTrip (STTx const& tx)
+    {
+        Serializer s;
+        tx.add (s);
+        SerialIter sit (s.slice ());
+        return STTx (sit);
+    }
+
+    void
+    testSplit ()
+    {
+        testcase ("split");
+
+        beast::Journal const j;
+        tests::TestFamily family (j);
+        beast::xor_shift_engine gen (47);
+
+        for (std::size_t count : {1, 2, 17, 300, 3000})
+        {
+            auto const map = makeMap (count, gen, family);
+            expect (DividendBatch::subtreeHash (&map.keys[0],
+                &map.keys[0] + map.keys.size (), 0) == map.hash, "root");
+
+            for (std::size_t maxBatch : {1, 16, 256})
+            {
+                std::vector<DividendBatch::Batch> batches;
+                expect (DividendBatch::split (map.keys, maxBatch, batches) ==
+                    map.hash, "split root");
+
+                // The batches cover the map once, in key order.
+                std::size_t next = 0;
+                bool valid = true;
+                for (auto const& batch : batches)
+                {
+                    valid = valid && batch.first == next &&
+                        batch.last > batch.first &&
+                        batch.last - batch.first <= maxBatch;
+                    next = batch.last;
+
+                    auto const tx = roundTrip (makeTx (map, batch));
+                    valid = valid && DividendBatch::verify (tx, j);
+                }
+                expect (valid && next == map.keys.size (),
+                    "batches of " + std::to_string (count));
+            }
+        }
+
+        std::vector<DividendBatch::Batch> batches;
+        expect (DividendBatch::split ({}, 256, batches) == zero &&
+            batches.empty (), "empty");
+    }
+
+    void
+    testTampered ()
+    {
+        testcase ("tampered");
+
+        beast::Journal const j;
+        tests::TestFamily family (j);
+        beast::xor_shift_engine gen (53);
+
+        auto map = makeMap (600, gen, family);
+        std::vector<DividendBatch::Batch> batches;
+        DividendBatch::split (map.keys, 64, batches);
+        expect (batches.size () > 1 && batches[1].depth > 0, "split");
+        auto const batch = batches[1];
+        expect (DividendBatch::verify (makeTx (map, batch), j), "valid");
+
+        {
+            // A payee credited more
+            auto changed = map;
+            changed.payees[batch.first].setFieldU64 (sfDividendCoins,
+                changed.payees[batch.first].getFieldU64 (sfDividendCoins) + 1);
+            expect (!DividendBatch::verify (makeTx (changed, batch), j),
+                "changed payee");
+        }
+        {
+            // A payee left out
+            auto smaller = batch;
+            --smaller.last;
+            expect (!DividendBatch::verify (makeTx (map, smaller), j),
+                "missing payee");
+        }
+        {
+            // A payee from another subtree
+            auto larger = batch;
+            ++larger.last;
+            expect (!DividendBatch::verify (makeTx (map, larger), j),
+                "extra payee");
+        }
+        {
+            // The node claimed one level higher
+            auto higher = batch;
+            --higher.depth;
+            higher.proof.resize (16 * higher.depth);
+            expect (!DividendBatch::verify (makeTx (map, higher), j),
+                "wrong depth");
+        }
+        {
+            // A sibling hash changed
+            auto other = batch;
+            auto const path = std::find_if (other.proof.begin (),
+                other.proof.end (), [](uint256 const& h)
+                {
+                    return h.isNonZero ();
+                });
+            ++*path;
+            expect (!DividendBatch::verify (makeTx (map, other), j),
+                "wrong proof");
+        }
+        {
+            // Some other map
+            auto other = map;
+            ++other.hash;
+            expect (!DividendBatch::verify (makeTx (other, batch), j),
+                "wrong root");
+        }
+        {
+            // Totals which do not add up
+            auto tx = makeTx (map, batch);
+            tx.setFieldU64 (sfDividendCoinsVBC,
+                tx.getFieldU64 (sfDividendCoinsVBC) + 1);
+            expect (!DividendBatch::verify (tx, j), "wrong total");
+        }
+        {
+            // A payee listed twice
+            auto tx = makeTx (map, batch);
+            auto payees = tx.getFieldArray (sfDividendPayees);
+            payees.push_back (payees[0]);
+            tx.setFieldArray (sfDividendPayees, payees);
+            expect (!DividendBatch::verify (tx, j), "duplicate payee");
+        }
+    }
+
+    void
+    run ()
+    {
+        testSplit ();
+        testTampered ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DividendBatch,app,ripple);
+
+}
+}
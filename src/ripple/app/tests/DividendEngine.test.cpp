@@ -0,0 +1,582 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/DividendEngine.h>
+#include <ripple/app/misc/impl/DividendResultFile.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/protocol/SystemParameters.h>
+#include <ripple/shamap/tests/common.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/depth_first_search.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+namespace ripple {
+namespace test {
+
+struct DividendEngine_test : public beast::unit_test::suite
+{
+    struct Account
+    {
+        AccountID account;
+        AccountID referee;
+        std::uint64_t vbc;
+    };
+
+    using Accounts = std::vector<Account>;
+
+    struct Result
+    {
+        std::uint64_t actualTotal = 0;
+        std::uint64_t actualTotalVBC = 0;
+        std::uint64_t sumVRank = 0;
+        std::uint64_t sumVSpd = 0;
+        DividendMaster::AccountsDividend accounts;
+    };
+
+    static
+    std::uint64_t
+    adjust (std::uint64_t coin)
+    {
+        return coin >= 10000000000 ? coin + 90000000000 : coin * 10;
+    }
+
+    /** The calculation DividendEngine replaced, one shared AccountData per
+        account in a boost graph folded by a depth first search.
+    */
+    class Reference
+    {
+    public:
+        Reference (Accounts const& input)
+        {
+            std::unordered_map<AccountID,
+                std::shared_ptr<AccountData>> accountsUnqualified;
+
+            auto pushAccount = [&](std::shared_ptr<AccountData> const& data)
+            {
+                auto result = accounts_.emplace (data->account, data);
+                if (result.second)
+                    data->vertex = boost::add_vertex ({data}, graph_);
+                return result;
+            };
+
+            for (auto const& a : input)
+            {
+                bool const noParent = a.referee.isZero ();
+                auto iter = accounts_.find (a.account);
+                if (iter != accounts_.end ())
+                {
+                    iter->second->vbc = a.vbc;
+                }
+                else if (a.vbc < SYSTEM_CURRENCY_PARTS_VBC && noParent)
+                {
+                    accountsUnqualified.emplace (a.account,
+                        std::make_shared<AccountData> (a.account, a.vbc));
+                    continue;
+                }
+                else
+                {
+                    iter = pushAccount (std::make_shared<AccountData> (
+                        a.account, a.vbc)).first;
+                }
+
+                if (a.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
+                    byBalance_.emplace (a.vbc, iter->second);
+
+                if (!noParent)
+                {
+                    auto iterParent = accounts_.find (a.referee);
+                    if (iterParent == accounts_.end ())
+                    {
+                        std::shared_ptr<AccountData> data;
+                        auto unq = accountsUnqualified.find (a.referee);
+                        if (unq != accountsUnqualified.end ())
+                        {
+                            data = unq->second;
+                            accountsUnqualified.erase (unq);
+                        }
+                        else
+                        {
+                            data = std::make_shared<AccountData> (a.referee, 0);
+                        }
+                        iterParent = pushAccount (data).first;
+                    }
+                    add_edge (iterParent->second->vertex,
+                        iter->second->vertex, graph_);
+                    iter->second->parent = iterParent->second->vertex;
+                }
+            }
+        }
+
+        Result
+        calc (std::uint64_t dividendCoins, std::uint64_t dividendCoinsVBC)
+        {
+            Result r;
+
+            std::uint64_t lastBalance = 0;
+            std::uint32_t pos = 1, rank = 1;
+            for (auto it = byBalance_.begin (); it != byBalance_.end ();
+                ++pos, ++it)
+            {
+                if (lastBalance < it->first)
+                {
+                    rank = pos;
+                    lastBalance = it->first;
+                }
+                it->second->vRank = rank;
+                r.sumVRank += rank;
+            }
+
+            auto& graph = graph_;
+            Visitor::VertexFunc finishVertex = [&](Vertex vertex)
+            {
+                auto& data = *graph[vertex].data;
+                if (data.vSprd != 0 && data.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
+                {
+                    data.vSprd = data.vSprd - adjust (data.maxChildHolding) +
+                        static_cast<std::uint64_t> (pow (
+                            data.maxChildHolding / SYSTEM_CURRENCY_PARTS_VBC,
+                                1.0 / 3) * SYSTEM_CURRENCY_PARTS_VBC);
+                    r.sumVSpd += data.vSprd;
+                }
+
+                auto& t = data.tSprd;
+                t += data.vbc;
+                if (data.parent == boost::graph_traits<Graph>::null_vertex ())
+                    return;
+
+                auto& parent = *graph[data.parent].data;
+                parent.tSprd += t;
+                if (parent.vbc >= SYSTEM_CURRENCY_PARTS_VBC)
+                {
+                    parent.vSprd += adjust (t);
+                    if (parent.maxChildHolding < t)
+                        parent.maxChildHolding = t;
+                }
+            };
+            boost::depth_first_search (graph_,
+                boost::visitor (Visitor (finishVertex)));
+
+            std::uint64_t const byRank = dividendCoinsVBC / 2;
+            std::uint64_t const byPower = dividendCoinsVBC - byRank;
+            for (auto const& it : accounts_)
+            {
+                auto const& a = *it.second;
+                std::uint64_t divVBC = 0;
+                boost::multiprecision::uint128_t divRank (0), divPower (0);
+                if (dividendCoinsVBC > 0 && r.sumVSpd > 0 && r.sumVRank > 0)
+                {
+                    divRank = byRank;
+                    divRank *= a.vRank;
+                    divRank /= r.sumVRank;
+                    divPower = byPower;
+                    divPower *= a.vSprd;
+                    divPower /= r.sumVSpd;
+                    divVBC = static_cast<std::uint64_t> (divRank + divPower);
+                    if (divVBC < VBC_DIVIDEND_MIN)
+                    {
+                        divVBC = 0;
+                        divRank = 0;
+                        divPower = 0;
+                    }
+                    r.actualTotalVBC += divVBC;
+                }
+                std::uint64_t div = 0;
+                if (dividendCoins > 0 &&
+                    (dividendCoinsVBC == 0 || divVBC >= VBC_DIVIDEND_MIN))
+                {
+                    div = a.vbc * VRP_INCREASE_RATE / VRP_INCREASE_RATE_PARTS;
+                    r.actualTotal += div;
+                }
+                if (div != 0 || divVBC != 0 ||
+                    a.vSprd > MIN_VSPD_TO_GET_FEE_SHARE)
+                {
+                    r.accounts.emplace (std::piecewise_construct,
+                        std::forward_as_tuple (a.account),
+                        std::forward_as_tuple (div, divVBC,
+                            static_cast<std::uint64_t> (divRank),
+                            static_cast<std::uint64_t> (divPower),
+                            static_cast<std::uint32_t> (a.vRank),
+                            a.vSprd, a.tSprd));
+                }
+            }
+
+            std::uint64_t remain = 0, remainVBC = 0;
+            if (dividendCoins > r.actualTotal)
+            {
+                remain = dividendCoins - r.actualTotal;
+                r.actualTotal = dividendCoins;
+            }
+            if (dividendCoinsVBC > r.actualTotalVBC)
+            {
+                remainVBC = dividendCoinsVBC - r.actualTotalVBC;
+                r.actualTotalVBC = dividendCoinsVBC;
+            }
+            if (remain > 0 || remainVBC > 0)
+            {
+                auto const remainAccount = from_hex_text<AccountID> (
+                    "0x56CE5173B6A2CBEDF203BD69159212094C651041");
+                auto& entry = r.accounts[remainAccount];
+                std::get<0> (entry) += remain;
+                std::get<1> (entry) += remainVBC;
+            }
+            return r;
+        }
+
+    private:
+        struct AccountData;
+
+        struct Property
+        {
+            std::shared_ptr<AccountData> data;
+        };
+
+        using Graph = boost::adjacency_list<boost::vecS, boost::vecS,
+            boost::directedS, Property>;
+        using Vertex = boost::graph_traits<Graph>::vertex_descriptor;
+
+        struct AccountData
+        {
+            AccountData (AccountID const& id, std::uint64_t balance)
+                : account (id), vbc (balance) {}
+            AccountID account;
+            std::uint64_t vbc = 0;
+            std::uint64_t vRank = 0, vSprd = 0, tSprd = 0;
+            std::uint64_t maxChildHolding = 0;
+            Vertex vertex = boost::graph_traits<Graph>::null_vertex ();
+            Vertex parent = boost::graph_traits<Graph>::null_vertex ();
+        };
+
+        class Visitor : public boost::default_dfs_visitor
+        {
+        public:
+            using VertexFunc = std::function<void (Vertex)>;
+
+            explicit
+            Visitor (VertexFunc finish)
+                : finish_ (finish)
+            {
+            }
+
+            template <class V, class G>
+            void finish_vertex (V vertex, G const&)
+            {
+                finish_ (vertex);
+            }
+
+        private:
+            VertexFunc finish_;
+        };
+
+        Graph graph_;
+        std::unordered_map<AccountID, std::shared_ptr<AccountData>> accounts_;
+        std::multimap<std::uint64_t, std::shared_ptr<AccountData>> byBalance_;
+    };
+
+    static
+    Result
+    calcEngine (Accounts const& input, std::uint64_t dividendCoins,
+        std::uint64_t dividendCoinsVBC)
+    {
+        DividendEngine engine ((beast::Journal ()));
+        engine.prepare ([&](DividendEngine::Visitor const& visitor)
+            {
+                for (auto const& a : input)
+                    visitor (a.account, a.referee, a.vbc);
+                return true;
+            });
+
+        Result r;
+        engine.calcDividend (dividendCoins, dividendCoinsVBC,
+            r.actualTotal, r.actualTotalVBC, r.sumVRank, r.sumVSpd,
+                r.accounts);
+        return r;
+    }
+
+    static
+    AccountID
+    makeAccount (beast::xor_shift_engine& gen)
+    {
+        AccountID id;
+        auto const p = id.begin ();
+        std::uniform_int_distribution<int> byte (0, 255);
+        for (std::size_t i = 0; i < id.size (); ++i)
+            p[i] = static_cast<std::uint8_t> (byte (gen));
+        return id;
+    }
+
+    static
+    std::uint64_t
+    makeBalance (beast::xor_shift_engine& gen)
+    {
+        switch (std::uniform_int_distribution<int> (0, 5) (gen))
+        {
+        case 0:
+            return 0;
+        case 1:
+            // Below the minimum for ranking.
+            return std::uniform_int_distribution<std::uint64_t> (
+                1, SYSTEM_CURRENCY_PARTS_VBC - 1) (gen);
+        case 2:
+            // Shared balances share a rank.
+            return 5 * SYSTEM_CURRENCY_PARTS_VBC;
+        default:
+            return std::uniform_int_distribution<std::uint64_t> (
+                SYSTEM_CURRENCY_PARTS_VBC,
+                    100000 * SYSTEM_CURRENCY_PARTS_VBC) (gen);
+        }
+    }
+
+    /** Accounts of a random referral forest, listed in random order.
+        Some referees have no AccountRoot of their own.
+    */
+    static
+    Accounts
+    makeForest (beast::xor_shift_engine& gen, std::size_t size)
+    {
+        std::vector<AccountID> ids;
+        ids.reserve (size);
+        Accounts accounts;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            ids.push_back (makeAccount (gen));
+            AccountID referee;
+            if (i != 0 && std::uniform_int_distribution<int> (0, 3) (gen) != 0)
+            {
+                // Deep lines as well as wide trees.
+                auto const lo = i > 8 && (i & 1) ? i - 8 : 0;
+                referee = ids[std::uniform_int_distribution<std::size_t> (
+                    lo, i - 1) (gen)];
+            }
+            accounts.push_back ({ids.back (), referee, makeBalance (gen)});
+        }
+
+        std::shuffle (accounts.begin (), accounts.end (), gen);
+        auto const missing = std::min<std::size_t> (accounts.size (), size / 20);
+        accounts.erase (accounts.end () - missing, accounts.end ());
+        return accounts;
+    }
+
+    void
+    expectSame (Result const& a, Result const& b)
+    {
+        expect (a.actualTotal == b.actualTotal, "actualTotalDividend");
+        expect (a.actualTotalVBC == b.actualTotalVBC, "actualTotalDividendVBC");
+        expect (a.sumVRank == b.sumVRank, "sumVRank");
+        expect (a.sumVSpd == b.sumVSpd, "sumVSpd");
+        expect (a.accounts == b.accounts, "accounts");
+    }
+
+    void
+    testEmpty ()
+    {
+        testcase ("empty");
+
+        auto const r = calcEngine ({}, 1000, 1000);
+        expect (r.accounts.empty ());
+        expect (r.actualTotal == 0);
+        expect (r.sumVSpd == 0);
+    }
+
+    void
+    testForest ()
+    {
+        testcase ("forest");
+
+        beast::xor_shift_engine gen (17);
+        for (auto const size : {1, 2, 10, 100, 1000, 5000})
+        {
+            auto const accounts = makeForest (gen, size);
+            for (auto const coins : {std::uint64_t (0),
+                std::uint64_t (1000000000000)})
+            {
+                Reference reference (accounts);
+                expectSame (calcEngine (accounts, coins, 100000000000),
+                    reference.calc (coins, 100000000000));
+            }
+        }
+    }
+
+    void
+    testLine ()
+    {
+        testcase ("line");
+
+        // One referral line deeper than any recursion would allow.
+        beast::xor_shift_engine gen (3);
+        Accounts accounts;
+        AccountID referee;
+        for (int i = 0; i < 200000; ++i)
+        {
+            auto const account = makeAccount (gen);
+            accounts.push_back ({account, referee,
+                (i % 7 + 1) * SYSTEM_CURRENCY_PARTS_VBC});
+            referee = account;
+        }
+
+        auto const r = calcEngine (accounts, 0, 100000000000);
+        Reference reference (accounts);
+        expectSame (r, reference.calc (0, 100000000000));
+    }
+
+    void
+    testCycle ()
+    {
+        testcase ("cycle");
+
+        beast::xor_shift_engine gen (29);
+        auto accounts = makeForest (gen, 300);
+
+        // Close referral cycles, with trees hanging off them.
+        for (std::size_t i = 0; i + 5 < accounts.size (); i += 50)
+        {
+            accounts[i].referee = accounts[i + 1].account;
+            accounts[i + 1].referee = accounts[i + 2].account;
+            accounts[i + 2].referee = accounts[i].account;
+            accounts[i + 3].referee = accounts[i + 1].account;
+            accounts[i + 4].referee = accounts[i + 5].account;
+            accounts[i + 5].referee = accounts[i + 4].account;
+        }
+
+        auto const expected = calcEngine (accounts, 1000000000000,
+            100000000000);
+        expect (expected.sumVSpd != 0);
+        for (int pass = 0; pass < 5; ++pass)
+        {
+            std::shuffle (accounts.begin (), accounts.end (), gen);
+            expectSame (calcEngine (accounts, 1000000000000, 100000000000),
+                expected);
+        }
+    }
+
+    void
+    testSpill ()
+    {
+        testcase ("spill");
+
+        beast::xor_shift_engine gen (41);
+        auto const accounts = makeForest (gen, 2000);
+        auto const expected = calcEngine (accounts, 1000000000000,
+            100000000000);
+
+        auto const path = boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ();
+        DividendResultFile file (path);
+        file.create ();
+
+        DividendEngine engine ((beast::Journal ()));
+        engine.prepare ([&](DividendEngine::Visitor const& visitor)
+            {
+                for (auto const& a : accounts)
+                    visitor (a.account, a.referee, a.vbc);
+                return true;
+            });
+
+        Result r;
+        engine.calcDividend (1000000000000, 100000000000,
+            r.actualTotal, r.actualTotalVBC, r.sumVRank, r.sumVSpd,
+            [&](AccountID const& account, DividendEngine::Result const& result)
+            {
+                file.append (account, result);
+            });
+        file.finish ();
+
+        for (std::size_t i = 0; i < file.size (); ++i)
+            r.accounts.emplace (file.account (i), file.result (i));
+        expectSame (r, expected);
+        expect (file.size () == expected.accounts.size ());
+        for (std::size_t i = 1; i < file.size (); ++i)
+            expect (file.account (i - 1) < file.account (i), "sorted");
+
+        auto const& first = *expected.accounts.begin ();
+        auto const found = file.find (first.first);
+        expect (found && *found == first.second);
+        expect (!file.find (AccountID ()));
+
+        file.clear ();
+        expect (file.size () == 0);
+        expect (!boost::filesystem::exists (path));
+    }
+
+    void
+    testCompare ()
+    {
+        testcase ("compare");
+
+        beast::Journal const j;
+        tests::TestFamily family (j);
+        beast::xor_shift_engine gen (43);
+
+        std::vector<std::pair<AccountID, DividendEngine::Result>> results;
+        for (std::uint64_t i = 0; i < 500; ++i)
+            results.emplace_back (makeAccount (gen),
+                DividendEngine::Result (i, 2 * i, i, i, 1, i, i));
+        std::sort (results.begin (), results.end ());
+
+        auto const makeMap = [&](std::vector<std::pair<AccountID,
+            DividendEngine::Result>> const& input)
+        {
+            return DividendEngine::makeMap (input.size (),
+                [&](std::size_t i)
+                {
+                    return DividendEngine::makeItem (input[i].first,
+                        input[i].second, 1000, Blob (33, 2), j);
+                }, family, j);
+        };
+
+        auto const ours = makeMap (results);
+        expect (DividendEngine::compareMaps (*ours, *makeMap (results), 10)
+            [jss::accounts].size () == 0, "same maps");
+
+        // One result changed, one account missing and one added
+        auto changed = results;
+        std::get<1> (changed[10].second) += 1;
+        changed.erase (changed.begin () + 20);
+        changed.emplace_back (makeAccount (gen),
+            DividendEngine::Result (1, 1, 1, 1, 1, 1, 1));
+        auto const theirs = makeMap (changed);
+        theirs->setImmutable ();
+
+        auto const report = DividendEngine::compareMaps (*ours, *theirs, 10);
+        expect (report[jss::complete].asBool (), "complete");
+        auto const& accounts = report[jss::accounts];
+        expect (accounts.size () == 3, "three accounts");
+
+        std::map<std::string, Json::Value> byAccount;
+        for (auto const& a : accounts)
+            byAccount[a[jss::account].asString ()] = a;
+
+        auto const& fields = byAccount[toBase58 (results[10].first)][jss::fields];
+        expect (fields.size () == 1 && fields.isMember ("DividendCoinsVBC"),
+            "changed field");
+        expect (byAccount[toBase58 (results[20].first)][jss::only] == "ours",
+            "missing account");
+        expect (byAccount[toBase58 (changed.back ().first)][jss::only] ==
+            "theirs", "added account");
+
+        // Fewer accounts than differ
+        expect (!DividendEngine::compareMaps (*ours, *theirs, 1)
+            [jss::complete].asBool (), "limited");
+    }
+
+    void
+    run ()
+    {
+        testEmpty ();
+        testForest ();
+        testLine ();
+        testCycle ();
+        testSpill ();
+        testCompare ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DividendEngine,app,ripple);
+
+}
+}
@@ -0,0 +1,312 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/impl/DividendEngine.h>
+#include <ripple/app/misc/impl/DividendProgress.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/core/Config.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/SystemParameters.h>
+#include <ripple/shamap/tests/common.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#if ! (defined (_WIN32) || defined (_WIN64))
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+namespace ripple {
+namespace test {
+
+/** Times the phases of a dividend on a synthetic ledger.
+
+    Each run builds a ledger of AccountRoots arranged in referral trees of
+    a given depth and fan-out, then times collecting the accounts, the
+    calculation, building the transaction map and counting the progress,
+    with the peak memory of each phase.
+
+    Runs are separated by ';', parameters of a run by ',':
+
+        accounts    Number of AccountRoots, default 100000.
+        depth       Depth of each referral tree, default 8.
+        fanout      References of each referee, default 4.
+        vbc         Balance distribution, "flat" or "pareto".
+        threads     Threads walking the state map, 0 for all.
+        seed        Seed of the account and balance generator.
+*/
+class DividendTiming_test : public beast::unit_test::suite
+{
+public:
+    struct Params
+    {
+        std::size_t accounts;
+        std::size_t depth;
+        std::size_t fanout;
+        std::string vbc;
+        unsigned threads;
+        std::uint64_t seed;
+    };
+
+    using clock_type = std::chrono::steady_clock;
+
+    struct Phase
+    {
+        std::chrono::milliseconds elapsed;
+        std::uint64_t peakMB;
+    };
+
+    /** Forget the peak resident memory so far, where supported. */
+    static
+    void
+    resetPeakMemory ()
+    {
+#if defined (__linux__)
+        std::ofstream ("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    /** Peak resident memory in MB since the last reset. */
+    static
+    std::uint64_t
+    peakMemory ()
+    {
+#if defined (__linux__)
+        std::ifstream status ("/proc/self/status");
+        std::string line;
+        while (std::getline (status, line))
+        {
+            if (boost::starts_with (line, "VmHWM:"))
+                return std::stoull (line.substr (6)) / 1024;
+        }
+#endif
+#if ! (defined (_WIN32) || defined (_WIN64))
+        struct rusage ru;
+        getrusage (RUSAGE_SELF, &ru);
+        return ru.ru_maxrss / 1024;
+#else
+        return 0;
+#endif
+    }
+
+    template <class Function>
+    static
+    Phase
+    measure (Function&& f)
+    {
+        resetPeakMemory ();
+        auto const start = clock_type::now ();
+        f ();
+        return Phase {std::chrono::duration_cast<std::chrono::milliseconds> (
+            clock_type::now () - start), peakMemory ()};
+    }
+
+    static
+    Params
+    parse (std::string const& args)
+    {
+        std::vector<std::string> lines;
+        boost::split (lines, args, boost::algorithm::is_any_of (","));
+        Section section;
+        section.append (lines);
+
+        Params params;
+        params.accounts = get<std::size_t> (section, "accounts", 100000);
+        params.depth = get<std::size_t> (section, "depth", 8);
+        params.fanout = std::max<std::size_t> (
+            get<std::size_t> (section, "fanout", 4), 1);
+        params.vbc = get<std::string> (section, "vbc", "pareto");
+        params.threads = get<unsigned> (section, "threads", 0);
+        params.seed = get<std::uint64_t> (section, "seed", 42);
+        return params;
+    }
+
+    /** Balances in drops of VBC. */
+    static
+    std::uint64_t
+    makeVBC (Params const& params, beast::xor_shift_engine& engine)
+    {
+        if (params.vbc == "flat")
+            return 1000 * SYSTEM_CURRENCY_PARTS_VBC;
+
+        // Pareto with a minimum of 10 VBC, most accounts hold little.
+        std::uniform_real_distribution<double> dist (
+            std::numeric_limits<double>::min (), 1.0);
+        double const vbc = 10.0 / std::pow (dist (engine), 1.0 / 1.16);
+        return static_cast<std::uint64_t> (
+            std::min (vbc, 1e9) * SYSTEM_CURRENCY_PARTS_VBC);
+    }
+
+    /** Build the state of a ledger with referral trees of accounts. */
+    static
+    std::shared_ptr<Ledger>
+    makeLedger (Params const& params, Config const& config, Family& family)
+    {
+        beast::xor_shift_engine engine (params.seed);
+
+        std::vector<AccountID> ids (params.accounts);
+        for (auto& id : ids)
+        {
+            for (auto p = id.begin (); p != id.end (); ++p)
+                *p = static_cast<unsigned char> (engine ());
+        }
+
+        // Accounts in one full tree of the forest.
+        std::size_t treeSize = 0;
+        for (std::size_t level = 0, width = 1;
+            level <= params.depth && treeSize < params.accounts;
+                ++level, width *= params.fanout)
+        {
+            treeSize += width;
+        }
+        treeSize = std::max<std::size_t> (
+            std::min (treeSize, params.accounts), 1);
+
+        auto const genesis = std::make_shared<Ledger> (
+            create_genesis, config, family);
+        auto ledger = std::make_shared<Ledger> (
+            open_ledger, *genesis, NetClock::time_point {});
+
+        for (std::size_t i = 0; i < ids.size (); ++i)
+        {
+            auto const sle = std::make_shared<SLE> (keylet::account (ids[i]));
+            sle->setFieldU32 (sfSequence, 1);
+            sle->setAccountID (sfAccount, ids[i]);
+            sle->setFieldAmount (sfBalance,
+                STAmount (SYSTEM_CURRENCY_PARTS));
+            sle->setFieldAmount (sfBalanceVBC,
+                STAmount (sfBalanceVBC, true, makeVBC (params, engine)));
+
+            // Referees precede their references within a tree.
+            auto const tree = i / treeSize * treeSize;
+            auto const pos = i - tree;
+            if (pos != 0)
+            {
+                sle->setAccountID (sfReferee,
+                    ids[tree + (pos - 1) / params.fanout]);
+            }
+            ledger->rawInsert (sle);
+        }
+        return ledger;
+    }
+
+    void
+    runOne (Params const& params)
+    {
+        beast::Journal const j;
+        tests::TestFamily family (j);
+        Config config;
+
+        auto const ledger = makeLedger (params, config, family);
+        auto const ledgerIndex = ledger->info ().seq;
+
+        DividendEngine engine (j);
+        DividendMaster::AccountsDividend results;
+        std::shared_ptr<SHAMap> map;
+        DividendProgress progress (j);
+
+        auto const prepare = measure ([&]()
+        {
+            engine.prepare (ledger, params.threads);
+        });
+
+        auto const calc = measure ([&]()
+        {
+            std::uint64_t actualTotal = 0, actualTotalVBC = 0;
+            std::uint64_t sumVRank = 0, sumVSpd = 0;
+            engine.calcDividend (1000000 * SYSTEM_CURRENCY_PARTS,
+                1000000 * SYSTEM_CURRENCY_PARTS_VBC, actualTotal,
+                    actualTotalVBC, sumVRank, sumVSpd, results);
+            engine.clear ();
+        });
+
+        auto const dump = measure ([&]()
+        {
+            std::vector<DividendMaster::AccountsDividend::const_iterator> divs;
+            divs.reserve (results.size ());
+            for (auto it = results.cbegin (); it != results.cend (); ++it)
+                divs.push_back (it);
+
+            map = DividendEngine::makeMap (divs.size (),
+                [&](std::size_t i)
+                {
+                    return DividendEngine::makeItem (divs[i]->first,
+                        divs[i]->second, ledgerIndex, Blob (), j);
+                }, family, j);
+            if (map)
+                map->flushDirty (hotTRANSACTION_NODE, 0);
+        });
+        expect (map != nullptr, "dividend map");
+        if (!map)
+            return;
+
+        auto const check = measure ([&]()
+        {
+            // As checkDividend does, read the map back from the node store.
+            SHAMap stored (SHAMapType::TRANSACTION,
+                map->getHash ().as_uint256 (), family);
+            if (stored.fetchRoot (map->getHash (), nullptr))
+                progress.track (ledgerIndex, stored, *ledger);
+        });
+        expect (progress.tracking (ledgerIndex, map->getHash ()), "progress");
+
+        auto const field = [](Phase const& phase)
+        {
+            std::stringstream ss;
+            ss << std::setw (8) << phase.elapsed.count () << "ms"
+               << std::setw (7) << phase.peakMB << "MB";
+            return ss.str ();
+        };
+
+        std::stringstream ss;
+        ss << std::left << std::setw (10) << params.accounts << std::right
+           << std::setw (4) << params.depth << std::setw (4) << params.fanout
+           << std::setw (7) << params.vbc
+           << field (prepare) << field (calc) << field (dump) << field (check)
+           << std::setw (10) << results.size ();
+        log << ss.str ();
+    }
+
+    void
+    run () override
+    {
+        testcase ("Timing", suite::abort_on_fail);
+
+        std::string const default_args =
+            "accounts=100000,depth=8,fanout=4,vbc=pareto;"
+            "accounts=100000,depth=100000,fanout=1,vbc=pareto;"
+            "accounts=1000000,depth=8,fanout=4,vbc=flat";
+
+        auto const args = arg ().empty () ? default_args : arg ();
+        std::vector<std::string> runs;
+        boost::split (runs, args, boost::algorithm::is_any_of (";"));
+
+        log <<
+            "Accounts  Dep Fan    VBC"
+            "         Prepare"
+            "            Calc"
+            "            Dump"
+            "           Check   Results";
+
+        for (auto const& r : runs)
+        {
+            if (!r.empty ())
+                runOne (parse (r));
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(DividendTiming,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,245 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/app/tx/applySteps.h>
+#include <ripple/app/tx/impl/FeePolicy.h>
+#include <ripple/core/Config.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/Quality.h>
+#include <ripple/test/jtx.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class FeePolicy_test : public beast::unit_test::suite
+{
+public:
+    /** The fee on a native amount, always through STAmount. */
+    static
+    XRPAmount
+    slowTransferFee (Config const& config, STAmount const& amount)
+    {
+        return std::max (multiply (amount, amountFromRate (
+            static_cast<std::uint64_t> (config.FEE_DEFAULT_RATE_NATIVE)),
+                amount.issue ()),
+                    STAmount (config.FEE_DEFAULT_MIN_NATIVE)).xrp ();
+    }
+
+    void
+    testNativeTransferFee ()
+    {
+        testcase ("native transfer fee");
+
+        beast::xor_shift_engine engine (7);
+        for (auto const rate : {1000000.0, 1234567.0, 2500000.0})
+        {
+            Config config;
+            config.FEE_DEFAULT_RATE_NATIVE = rate;
+
+            std::vector<std::uint64_t> drops = {
+                1, 999, 1000, 999999, 1000000, 1000001, 1234567,
+                1000000000, 1999999999, 123456789012345,
+                100000000000000000ull};
+            std::uniform_int_distribution<std::uint64_t> dist (
+                1, 100000000000000000ull);
+            for (int i = 0; i < 1000; ++i)
+                drops.push_back (dist (engine));
+
+            for (auto const d : drops)
+            {
+                for (auto const isVBC : {false, true})
+                {
+                    STAmount const amount (sfAmount, isVBC, d);
+                    expect (nativeTransferFee (config, amount) ==
+                        slowTransferFee (config, amount), std::to_string (d));
+                }
+            }
+        }
+    }
+
+    void
+    testFeeCost ()
+    {
+        testcase ("fee cost");
+
+        Fees fees;
+        fees.base = 10;
+        fees.units = 10;
+
+        // Without a transfer fee, or a smaller one, the base fee is the cost.
+        expect (calculateFeeCost (fees, 10, zero) == 10);
+        expect (calculateFeeCost (fees, 20, XRPAmount (5)) == 20);
+
+        // A larger transfer fee is the cost, converted to fee units.
+        expect (calculateFeeCost (fees, 10, XRPAmount (1000)) == 1000);
+        fees.base = 20;
+        expect (calculateFeeCost (fees, 10, XRPAmount (1000)) == 500);
+    }
+
+    void
+    testPolicies ()
+    {
+        testcase ("policies");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const USD = gw["USD"];
+        env.fund (XRP (100000), "alice", "bob", gw);
+        env.close ();
+
+        auto const& config = env.app ().config ();
+        auto const transferFee = [&](JTx const& jt)
+        {
+            PreclaimContext const ctx (env.app (), *env.open (),
+                tesSUCCESS, *jt.stx, tapNONE, env.journal);
+            return feePolicy (jt.stx->getTxnType ()).transferFee (ctx);
+        };
+
+        expect (transferFee (env.jt (noop ("alice"))) == zero);
+        expect (transferFee (env.jt (pay ("alice", "bob", XRP (1000)))) ==
+            XRPAmount (1000000));
+        expect (transferFee (env.jt (pay ("alice", "bob", USD (10)))) ==
+            XRPAmount (config.FEE_DEFAULT_NONE_NATIVE));
+
+        // Creating the destination costs more.
+        expect (transferFee (env.jt (pay ("alice", "carol", XRP (1000)))) ==
+            XRPAmount (1000000 + config.FEE_DEFAULT_CREATE));
+    }
+
+    void
+    run () override
+    {
+        testNativeTransferFee ();
+        testFeeCost ();
+        testPolicies ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FeePolicy,app,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Times preflight, preclaim and apply of mixed native and IOU payments.
+
+    Runs are separated by ';', parameters of a run by ',':
+
+        count       Number of payments, default 10000.
+        iou         Percent of the payments in IOU, default 50.
+*/
+class ApplyStepsTiming_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    void
+    runOne (std::size_t count, std::size_t iou)
+    {
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const USD = gw["USD"];
+        env.fund (XRP (10000000), "alice", "bob", gw);
+        env.trust (USD (100000000), "alice", "bob");
+        env (pay (gw, "alice", USD (10000000)));
+        env.close ();
+
+        auto const first = env.seq ("alice");
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve (count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const jt = (i % 100 < iou) ?
+                env.jt (pay ("alice", "bob", USD (1 + i % 100)),
+                    seq (first + i), fee (XRP (1))) :
+                env.jt (pay ("alice", "bob", XRP (1 + i % 1000)),
+                    seq (first + i), fee (XRP (1)));
+            txs.push_back (jt.stx);
+        }
+
+        OpenView view (&*env.open ());
+        clock_type::duration preflightTime {}, preclaimTime {}, applyTime {};
+        std::size_t applied = 0;
+        for (auto const& tx : txs)
+        {
+            auto start = clock_type::now ();
+            auto const pfresult = preflight (env.app (), view.rules (),
+                *tx, tapNONE, env.journal);
+            preflightTime += clock_type::now () - start;
+
+            start = clock_type::now ();
+            auto const pcresult = preclaim (pfresult, env.app (), view);
+            preclaimTime += clock_type::now () - start;
+
+            start = clock_type::now ();
+            if (doApply (pcresult, env.app (), view).second)
+                ++applied;
+            applyTime += clock_type::now () - start;
+        }
+        expect (applied == count, "applied");
+
+        auto const field = [count](clock_type::duration elapsed)
+        {
+            auto const us = std::chrono::duration_cast<
+                std::chrono::microseconds> (elapsed).count ();
+            std::stringstream ss;
+            ss << std::setw (10) << us / 1000 << "ms" << std::setw (9) <<
+                (us ? count * 1000000 / us : 0) << "/s";
+            return ss.str ();
+        };
+
+        std::stringstream ss;
+        ss << std::left << std::setw (8) << count << std::right <<
+            std::setw (4) << iou << field (preflightTime) <<
+                field (preclaimTime) << field (applyTime);
+        log << ss.str ();
+    }
+
+    void
+    run () override
+    {
+        testcase ("Timing", suite::abort_on_fail);
+
+        std::string const default_args =
+            "count=10000,iou=0;"
+            "count=10000,iou=50;"
+            "count=10000,iou=100";
+
+        auto const args = arg ().empty () ? default_args : arg ();
+        std::vector<std::string> runs;
+        boost::split (runs, args, boost::algorithm::is_any_of (";"));
+
+        log <<
+            "Count    IOU"
+            "           Preflight"
+            "            Preclaim"
+            "               Apply";
+
+        for (auto const& r : runs)
+        {
+            if (r.empty ())
+                continue;
+            std::vector<std::string> lines;
+            boost::split (lines, r, boost::algorithm::is_any_of (","));
+            Section section;
+            section.append (lines);
+            runOne (get<std::size_t> (section, "count", 10000),
+                std::min<std::size_t> (
+                    get<std::size_t> (section, "iou", 50), 100));
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ApplyStepsTiming,app,ripple);
+
+} // test
+} // ripple
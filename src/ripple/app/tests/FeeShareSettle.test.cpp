@@ -0,0 +1,158 @@
+#include <BeastConfig.h>
+#include <ripple/test/jtx.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/FeeShareSettlement.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/ledger/Sandbox.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+
+namespace ripple {
+namespace test {
+
+class FeeShareSettle_test : public beast::unit_test::suite
+{
+public:
+    // Apply a transaction to a closed ledger made on the last one, which
+    // had its fee shares settled through a ledger
+    std::pair<TER, std::shared_ptr<Ledger>>
+    applyClosed (jtx::Env& env, STTx const& tx,
+        boost::optional<std::uint32_t> settled)
+    {
+        auto const closed = std::dynamic_pointer_cast<Ledger const> (
+            env.closed ());
+        auto next = std::make_shared<Ledger> (open_ledger, *closed,
+            env.app ().timeKeeper ().closeTime ());
+        if (settled)
+        {
+            auto const sle = std::make_shared<SLE> (
+                keylet::feeShareAccrual ());
+            sle->setFieldU32 (sfLedgerSequence, *settled);
+            next->rawInsert (sle);
+        }
+        next->setClosed ();
+        OpenView accum (&*next);
+        auto const result = ripple::apply (env.app (),
+            accum, tx, tapNONE, env.journal);
+        accum.apply (*next);
+        return {result.first, next};
+    }
+
+    void
+    testShares ()
+    {
+        testcase ("shares");
+
+        auto const alice = AccountID (1);
+        auto const bob = AccountID (2);
+        auto const usd = Issue (to_currency ("USD"), AccountID (3));
+        auto const eur = Issue (to_currency ("EUR"), AccountID (3));
+
+        // Shares of the same account and issue are merged
+        STArray shares (sfFeeShareTakers);
+        addFeeShare (shares, bob, STAmount (usd, 1));
+        addFeeShare (shares, alice, STAmount (usd, 2));
+        addFeeShare (shares, bob, STAmount (usd, 3));
+        addFeeShare (shares, bob, STAmount (eur, 4));
+        expect (shares.size () == 3);
+        expect (shares[0].getFieldAmount (sfAmount) == STAmount (usd, 4));
+        expect (! FeeShareSettlement::isCanonical (shares));
+
+        auto const tx = FeeShareSettlement::makeTx (10, [&]
+            {
+                STArray sorted (sfFeeShareTakers);
+                addFeeShare (sorted, alice, STAmount (usd, 2));
+                addFeeShare (sorted, bob, STAmount (eur, 4));
+                addFeeShare (sorted, bob, STAmount (usd, 4));
+                return sorted;
+            }());
+        expect (FeeShareSettlement::isCanonical (
+            tx.getFieldArray (sfFeeShareTakers)));
+        expect (tx.getFieldU32 (sfLedgerSequence) == 10);
+    }
+
+    void
+    testSettle ()
+    {
+        testcase ("settle");
+
+        using namespace jtx;
+        auto const alice = Account ("alice");
+        auto const gw = Account ("gw");
+        auto const USD = gw["USD"];
+
+        auto config = std::make_unique<Config> ();
+        setupConfigForUnitTests (*config);
+        config->features.insert (featureFeeShareAccrual);
+        Env env (*this, std::move (config));
+
+        env.fund (XRP (10000), alice, gw);
+        env.trust (USD (100), alice);
+        env.close ();
+
+        auto const parent = env.closed ()->seq ();
+        STArray takers (sfFeeShareTakers);
+        addFeeShare (takers, alice.id (), USD (5).value ());
+
+        // Nothing accrued yet
+        expect (applyClosed (env, FeeShareSettlement::makeTx (
+            parent, takers), boost::none).first == tefFAILURE);
+
+        auto const result = applyClosed (env,
+            FeeShareSettlement::makeTx (parent, takers), parent - 1);
+        expect (result.first == tesSUCCESS);
+        Sandbox holds (&*result.second, tapNONE);
+        expect (accountHolds (holds, alice.id (), USD.currency, gw.id (),
+            fhIGNORE_FREEZE, env.journal) == USD (5).value ());
+        expect (result.second->read (keylet::feeShareAccrual ())->
+            getFieldU32 (sfLedgerSequence) == parent);
+
+        // Ledgers are settled once, and only when closed
+        expect (applyClosed (env, FeeShareSettlement::makeTx (
+            parent, takers), parent).first == tefFAILURE);
+        expect (applyClosed (env, FeeShareSettlement::makeTx (
+            parent + 1, takers), parent - 1).first == tefFAILURE);
+        expect (applyClosed (env, FeeShareSettlement::makeTx (parent,
+            takers), parent - 1 - FeeShareSettlement::maxLedgers).first ==
+                tefFAILURE);
+
+        // Nothing to credit still moves the range forward
+        auto const empty = applyClosed (env, FeeShareSettlement::makeTx (
+            parent, STArray (sfFeeShareTakers)), parent - 1);
+        expect (empty.first == tesSUCCESS);
+
+        // Never in an open ledger
+        OpenView open (open_ledger, &*env.closed (),
+            env.closed ()->rules ());
+        expect (ripple::apply (env.app (), open, FeeShareSettlement::makeTx (
+            parent, takers), tapNONE, env.journal).first == temINVALID);
+    }
+
+    void
+    testDisabled ()
+    {
+        testcase ("disabled");
+
+        using namespace jtx;
+        Env env (*this);
+        env.close ();
+        expect (applyClosed (env, FeeShareSettlement::makeTx (
+            env.closed ()->seq (), STArray (sfFeeShareTakers)),
+                boost::none).first == temDISABLED);
+    }
+
+    void
+    run ()
+    {
+        testShares ();
+        testSettle ();
+        testDisabled ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FeeShareSettle,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,122 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/misc/GatewayTotals.h>
+#include <ripple/test/jtx.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class GatewayTotals_test : public beast::unit_test::suite
+{
+public:
+    static
+    void
+    add (jtx::Env& env, GatewayTotals& totals)
+    {
+        totals.addLedger (AcceptedLedger (env.closed (),
+            env.app ().accountIDCache (), env.app ().logs ()));
+    }
+
+    bool
+    same (GatewayTotals::Totals const& a, GatewayTotals::Totals const& b)
+    {
+        return a.obligations == b.obligations && a.lines == b.lines &&
+            a.assets == b.assets;
+    }
+
+    void
+    testFollow ()
+    {
+        testcase ("follow");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const carol = Account ("carol");
+        env.fund (XRP (10000), gw, alice, bob, carol);
+        env.close ();
+        env.trust (gw["USD"] (1000), alice, bob);
+        env.trust (gw["EUR"] (1000), alice);
+        env.close ();
+        env (pay (gw, alice, gw["USD"] (100)));
+        env (pay (gw, bob, gw["USD"] (50)));
+        env (pay (gw, alice, gw["EUR"] (5)));
+        env.close ();
+
+        GatewayTotals totals (8, 1024);
+        add (env, totals);
+
+        auto t = totals.get (*env.closed (), gw);
+        expect (totals.size () == 1);
+        expect (t.obligations[gw["USD"].currency] == gw["USD"] (150));
+        expect (t.obligations[gw["EUR"].currency] == gw["EUR"] (5));
+        expect (t.assets.empty ());
+
+        // Lines which change, are created and are deleted
+        env.trust (gw["USD"] (1000), carol);
+        env.trust (carol["CNY"] (1000), gw);
+        env.close ();
+        add (env, totals);
+        env (pay (alice, bob, gw["USD"] (30)));
+        env (pay (bob, gw, gw["USD"] (80)));
+        env (pay (gw, carol, gw["USD"] (7)));
+        env (pay (carol, gw, carol["CNY"] (20)));
+        env (pay (alice, gw, gw["EUR"] (5)));
+        env (trust (alice, gw["EUR"] (0)));
+        env.close ();
+        add (env, totals);
+
+        t = totals.get (*env.closed (), gw);
+        expect (same (t, GatewayTotals::scan (*env.closed (), gw)));
+        expect (t.obligations[gw["USD"].currency] == gw["USD"] (77));
+        expect (t.obligations.count (gw["EUR"].currency) == 0);
+        expect (t.assets[carol.id ()][carol["CNY"].currency] ==
+            carol["CNY"] (20));
+    }
+
+    void
+    testGap ()
+    {
+        testcase ("gap");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        env.fund (XRP (10000), gw, "alice");
+        env.close ();
+        env.trust (gw["USD"] (1000), "alice");
+        env (pay (gw, "alice", gw["USD"] (10)));
+        env.close ();
+
+        GatewayTotals totals (8, 1024);
+
+        // Not the last ledger added
+        totals.get (*env.closed (), gw);
+        expect (totals.size () == 0);
+
+        add (env, totals);
+        totals.get (*env.closed (), gw);
+        expect (totals.size () == 1);
+
+        // A ledger is skipped
+        env.close ();
+        env.close ();
+        add (env, totals);
+        expect (totals.size () == 0);
+    }
+
+    void
+    run ()
+    {
+        testFollow ();
+        testGap ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(GatewayTotals,app,ripple);
+
+} // test
+} // ripple
@@ -212,6 +212,46 @@ class HashRouter_test : public beast::unit_test::suite
         expect(router.getFlags(key1) == (135 | 24));
     }
 
+    void
+    testShards()
+    {
+        TestStopwatch stopwatch;
+        HashRouter router(stopwatch, std::chrono::seconds(2));
+
+        // Hashes in different shards
+        uint256 key1;
+        uint256 key2;
+        key1.begin()[0] = 1;
+        key2.begin()[0] = 2;
+
+        // t=0
+        router.setFlags(key1, 10);
+        expect(router.addSuppressionPeer(key2, 3));
+        expect(!router.addSuppressionPeer(key2, 3));
+        expect(!router.addSuppressionPeer(key2, 1));
+
+        ++stopwatch;
+        ++stopwatch;
+
+        // t=2
+        // Nothing was inserted in the shard of key1,
+        // but it has not been used for the hold time
+        expect(router.getFlags(key1) == 0);
+
+        // key2 is new again, with its peers forgotten
+        std::set<HashRouter::PeerShortID> peers;
+        expect(router.addSuppressionPeer(key2, 4));
+        expect(router.swapSet(key2, peers, 1));
+        expect(peers.size() == 1 && *peers.begin() == 4);
+
+        // After a long pause, every slot of the wheel comes due
+        for (int i = 0; i < 100; ++i)
+            ++stopwatch;
+        expect(router.setFlags(key1, 20));
+        expect(router.getFlags(key1) == 20);
+        expect(router.getFlags(key2) == 0);
+    }
+
 public:
 
     void
@@ -222,6 +262,7 @@ public:
         testSuppression();
         testSetFlags();
         testSwapSet();
+        testShards();
     }
 };
 
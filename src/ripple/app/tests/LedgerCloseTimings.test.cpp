@@ -0,0 +1,57 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
+#include <ripple/protocol/JsonFields.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class LedgerCloseTimings_test : public beast::unit_test::suite
+{
+public:
+    using Phase = LedgerCloseTimings::Phase;
+
+    void
+    testRecords ()
+    {
+        testcase ("records");
+
+        using namespace std::chrono;
+        LedgerCloseTimings timings (3, beast::insight::NullCollector::New ());
+        for (LedgerIndex seq = 1; seq <= 4; ++seq)
+            timings.add (seq, Phase::apply, nanoseconds (seq));
+        timings.add (4, Phase::apply, nanoseconds (10));
+        timings.addTx (4, ttPAYMENT, nanoseconds (5));
+        timings.addTx (4, ttPAYMENT, nanoseconds (7));
+        timings.addStoreBatch (milliseconds (2));
+
+        // Too old to be kept
+        timings.add (1, Phase::save, nanoseconds (1));
+
+        auto const json = timings.getJson (10);
+        expect (json.size () == 3);
+        expect (json[0u][jss::ledger_index] == 4);
+        expect (json[2u][jss::ledger_index] == 2);
+        expect (json[0u][jss::phases]["apply"] == "14");
+        expect (json[0u][jss::phases]["store_batch"] == "2000000");
+        expect (json[1u][jss::phases]["store_batch"] == "0");
+
+        auto const& payment = json[0u][jss::transactions]["Payment"];
+        expect (payment[jss::count] == 2);
+        expect (payment[jss::elapsed] == "12");
+
+        expect (timings.getJson (1).size () == 1);
+    }
+
+    void
+    run () override
+    {
+        testRecords ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerCloseTimings,app,ripple);
+
+} // test
+} // ripple
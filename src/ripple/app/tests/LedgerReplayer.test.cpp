@@ -0,0 +1,90 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/impl/LedgerReplayer.h>
+#include <ripple/nodestore/Database.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/test/jtx.h>
+#include <beast/unit_test/suite.h>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class LedgerReplayer_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::shared_ptr<Ledger const>
+    closed (jtx::Env& env)
+    {
+        return std::dynamic_pointer_cast<Ledger const> (env.closed ());
+    }
+
+    static
+    void
+    storeHeader (jtx::Env& env, Ledger const& ledger)
+    {
+        Serializer s (128);
+        s.add32 (HashPrefix::ledgerMaster);
+        ledger.addRaw (s);
+        env.app ().getNodeStore ().store (
+            hotLEDGER, std::move (s.modData ()), ledger.info ().hash);
+    }
+
+    void
+    testReplay ()
+    {
+        testcase ("replay");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        env.fund (XRP (10000), "alice", "bob", gw);
+        env.close ();
+        auto const parent = closed (env);
+
+        std::vector<uint256> hashes;
+        env.trust (gw["USD"] (1000), "alice", "bob");
+        env.close ();
+        hashes.push_back (closed (env)->info ().hash);
+        storeHeader (env, *closed (env));
+
+        env (pay (gw, "alice", gw["USD"] (100)));
+        env (pay ("alice", "bob", gw["USD"] (10)));
+        env.close ();
+        hashes.push_back (closed (env)->info ().hash);
+        storeHeader (env, *closed (env));
+
+        // No transactions
+        env.close ();
+        hashes.push_back (closed (env)->info ().hash);
+        storeHeader (env, *closed (env));
+
+        auto const ledgers = replayLedgers (
+            env.app (), parent, hashes, env.journal);
+        expect (ledgers.size () == hashes.size (), "all rebuilt");
+        for (std::size_t i = 0; i < ledgers.size (); ++i)
+            expect (ledgers[i]->info ().hash == hashes[i]);
+
+        // Not stored
+        auto partial = hashes;
+        partial.insert (partial.begin () + 1, uint256 (1));
+        expect (replayLedgers (env.app (), parent,
+            partial, env.journal).size () == 1, "stops");
+
+        // Not built on this parent
+        expect (replayLedgers (env.app (), closed (env),
+            hashes, env.journal).empty (), "wrong parent");
+    }
+
+    void
+    run () override
+    {
+        testReplay ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerReplayer,app,ripple);
+
+} // test
+} // ripple
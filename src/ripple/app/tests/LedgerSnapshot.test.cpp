@@ -0,0 +1,170 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerSnapshot.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/test/jtx.h>
+#include <beast/unit_test/suite.h>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class LedgerSnapshot_test : public beast::unit_test::suite
+{
+public:
+    static
+    boost::filesystem::path
+    tempPath ()
+    {
+        return boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ();
+    }
+
+    static
+    Blob
+    bytes (std::shared_ptr<SLE const> const& sle)
+    {
+        return sle ? sle->getSerializer ().peekData () : Blob ();
+    }
+
+    void
+    testView ()
+    {
+        testcase ("view");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        env.fund (XRP (10000), "alice", "bob", gw);
+        env.trust (gw["USD"] (1000), "alice", "bob");
+        env (pay (gw, "alice", gw["USD"] (100)));
+        env.close ();
+
+        auto const ledger = std::dynamic_pointer_cast<Ledger const> (
+            env.closed ());
+        auto const path = tempPath ();
+        LedgerSnapshot::write (path, ledger->info (), ledger->stateMap ());
+
+        auto const snapshot = std::make_shared<LedgerSnapshot const> (path);
+        expect (snapshot->seq () == ledger->info ().seq);
+        expect (snapshot->hash () == ledger->info ().hash);
+        SnapshotView const view (ledger, snapshot);
+
+        // The same items, in the same order
+        std::vector<uint256> keys;
+        auto iter = view.sles.begin ();
+        bool same = true;
+        for (auto const& sle : ledger->sles)
+        {
+            keys.push_back (sle->key ());
+            same = same && iter != view.sles.end () &&
+                (*iter)->key () == sle->key () && bytes (*iter) == bytes (sle);
+            if (iter != view.sles.end ())
+                ++iter;
+        }
+        expect (same && iter == view.sles.end (), "same items");
+        expect (snapshot->size () == keys.size (), "size");
+
+        for (auto const& key : keys)
+        {
+            same = same && view.exists (keylet::unchecked (key)) &&
+                bytes (view.read (keylet::unchecked (key))) ==
+                    bytes (ledger->read (keylet::unchecked (key))) &&
+                view.succ (key) == ledger->succ (key);
+        }
+        expect (same, "same lookups");
+        expect (view.succ (uint256 ()) == ledger->succ (uint256 ()));
+
+        auto const dave = keylet::account (Account ("dave").id ());
+        expect (!view.exists (dave) && !view.read (dave), "missing item");
+        expect (view.read (keylet::account (Account ("alice").id ())) !=
+            nullptr, "alice");
+        expect (!view.read (Keylet (ltOFFER,
+            keylet::account (Account ("alice").id ()).key)), "wrong type");
+        expect (view.info ().hash == ledger->info ().hash);
+
+        boost::filesystem::remove (path);
+    }
+
+    void
+    testSnapshots ()
+    {
+        testcase ("snapshots");
+
+        using namespace jtx;
+        Env env (*this);
+        env.fund (XRP (10000), "alice");
+        env.close ();
+        auto const first = env.closed ();
+        env.fund (XRP (10000), "bob");
+        env.close ();
+
+        auto const dir = tempPath ();
+        Section section;
+        section.set ("path", dir.string ());
+        LedgerSnapshots snapshots (section, beast::Journal ());
+        expect (snapshots.enabled ());
+
+        auto const ledger = std::dynamic_pointer_cast<Ledger const> (
+            env.closed ());
+        expect (!snapshots.view (ledger), "no snapshot yet");
+        snapshots.add (*ledger);
+        auto const view = snapshots.view (ledger);
+        expect (view != nullptr, "snapshot view");
+        if (view)
+            expect (view->read (keylet::account (Account ("bob").id ())) !=
+                nullptr, "bob");
+        expect (!snapshots.view (first), "other ledger");
+
+        // Found again after a restart
+        LedgerSnapshots reopened (section, beast::Journal ());
+        expect (reopened.view (ledger) != nullptr, "reopened");
+
+        LedgerSnapshots disabled {Section (), beast::Journal ()};
+        expect (!disabled.enabled () && !disabled.view (ledger), "disabled");
+
+        boost::filesystem::remove_all (dir);
+    }
+
+    void
+    testCorrupt ()
+    {
+        testcase ("corrupt");
+
+        auto const path = tempPath ();
+        {
+            std::ofstream out (path.string ().c_str (), std::ios::binary);
+            // Long enough for a header, but not one
+            out << std::string (256, 'x');
+        }
+
+        bool threw = false;
+        try
+        {
+            LedgerSnapshot snapshot (path);
+        }
+        catch (std::runtime_error const&)
+        {
+            threw = true;
+        }
+        expect (threw, "rejected");
+
+        boost::filesystem::remove (path);
+    }
+
+    void
+    run () override
+    {
+        testView ();
+        testSnapshots ();
+        testCorrupt ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerSnapshot,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,497 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/impl/DividendEngine.h>
+#include <ripple/app/paths/Pathfinder.h>
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/MemoryTag.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/protocol/SystemParameters.h>
+#include <ripple/test/jtx.h>
+#include <beast/random/xor_shift_engine.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#if ! (defined (_WIN32) || defined (_WIN64))
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+namespace ripple {
+namespace test {
+
+/** Drives a mix of transactions and queries through a standalone server.
+
+    Each run funds a pool of accounts holding the IOU of one gateway, then
+    submits operations picked at random by weight, closing a ledger after
+    every `close` of them. It reports the transactions per second, the
+    latency percentiles of each kind of operation and of a transaction
+    from its submission to the close of its ledger, and the CPU time and
+    peak memory of the run.
+
+    Runs are separated by ';', parameters of a run by ',':
+
+        ops         Operations in the run, default 5000.
+        accounts    Accounts in the pool, default 200.
+        close       Operations between ledger closes, default 250.
+        payment     Weight of XRP and IOU payments, default 60.
+        active      Weight of ActiveAccount creating accounts, default 10.
+        issue       Weight of IssueAsset, each by a new issuer, default 5.
+        offer       Weight of OfferCreate, default 20.
+        query       Weight of account and trust line reads, default 5.
+        path_find   Weight of path finding between accounts, default 0.
+        dividend    Ledgers between dividend calculations, 0 for none.
+        seed        Seed of the operation generator.
+
+    For example:
+
+        radard --unittest=NodeLoad --unittest-arg="ops=20000,path_find=5"
+*/
+class NodeLoad_test : public beast::unit_test::suite
+{
+public:
+    enum Kind
+    {
+        opPayment,
+        opActive,
+        opIssue,
+        opOffer,
+        opQuery,
+        opPathFind,
+        kindCount
+    };
+
+    struct Params
+    {
+        std::size_t ops;
+        std::size_t accounts;
+        std::size_t close;
+        std::array<double, kindCount> weights;
+        std::size_t dividend;
+        std::uint64_t seed;
+    };
+
+    using clock_type = std::chrono::steady_clock;
+
+    // Microseconds of each sample
+    using Samples = std::vector<std::uint64_t>;
+
+    static
+    char const*
+    getName (Kind kind)
+    {
+        switch (kind)
+        {
+        case opPayment:     return "payment";
+        case opActive:      return "active";
+        case opIssue:       return "issue";
+        case opOffer:       return "offer";
+        case opQuery:       return "query";
+        case opPathFind:    return "path_find";
+        default:            break;
+        }
+        return "unknown";
+    }
+
+    static
+    Params
+    parse (std::string const& args)
+    {
+        std::vector<std::string> lines;
+        boost::split (lines, args, boost::algorithm::is_any_of (","));
+        Section section;
+        section.append (lines);
+
+        Params params;
+        params.ops = get<std::size_t> (section, "ops", 5000);
+        params.accounts = std::max<std::size_t> (
+            get<std::size_t> (section, "accounts", 200), 2);
+        params.close = std::max<std::size_t> (
+            get<std::size_t> (section, "close", 250), 1);
+        params.weights[opPayment] = get<double> (section, "payment", 60);
+        params.weights[opActive] = get<double> (section, "active", 10);
+        params.weights[opIssue] = get<double> (section, "issue", 5);
+        params.weights[opOffer] = get<double> (section, "offer", 20);
+        params.weights[opQuery] = get<double> (section, "query", 5);
+        params.weights[opPathFind] = get<double> (section, "path_find", 0);
+        params.dividend = get<std::size_t> (section, "dividend", 0);
+        params.seed = get<std::uint64_t> (section, "seed", 42);
+        return params;
+    }
+
+    static
+    std::uint64_t
+    elapsed (clock_type::time_point start, clock_type::time_point end)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds> (
+            end - start).count ();
+    }
+
+    static
+    std::uint64_t
+    percentile (Samples& samples, double p)
+    {
+        if (samples.empty ())
+            return 0;
+        auto const nth = samples.begin () + std::min<std::size_t> (
+            samples.size () - 1, static_cast<std::size_t> (
+                p * samples.size ()));
+        std::nth_element (samples.begin (), nth, samples.end ());
+        return *nth;
+    }
+
+    /** User and system CPU time of the process in milliseconds. */
+    static
+    std::uint64_t
+    cpuTime ()
+    {
+#if ! (defined (_WIN32) || defined (_WIN64))
+        struct rusage ru;
+        getrusage (RUSAGE_SELF, &ru);
+        return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000 +
+            (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+#else
+        return 0;
+#endif
+    }
+
+    /** Peak resident memory of the process in MB. */
+    static
+    std::uint64_t
+    peakMemory ()
+    {
+#if ! (defined (_WIN32) || defined (_WIN64))
+        struct rusage ru;
+        getrusage (RUSAGE_SELF, &ru);
+        return ru.ru_maxrss / 1024;
+#else
+        return 0;
+#endif
+    }
+
+    static
+    Json::Value
+    issueJson (jtx::Account const& issuer, jtx::Account const& dest)
+    {
+        auto const ASSET = issuer["4153534554000000000000000000000000000000"];
+        Json::Value jv;
+        jv[jss::Account] = issuer.human ();
+        jv[jss::Destination] = dest.human ();
+        jv[jss::Amount] = STAmount (ASSET (1000000)).getJson (0);
+        jv[jss::TransactionType] = "Issue";
+        auto& schedule = jv["ReleaseSchedule"];
+        auto& first = schedule.append (Json::Value::null)["ReleasePoint"];
+        first["Expiration"] = 0;
+        first["ReleaseRate"] = std::to_string (500000000);
+        auto& second = schedule.append (Json::Value::null)["ReleasePoint"];
+        second["Expiration"] = 86400;
+        second["ReleaseRate"] = std::to_string (1000000000);
+        return jv;
+    }
+
+    static
+    Json::Value
+    activeJson (jtx::Account const& account, jtx::Account const& dest,
+        jtx::Account const& referee)
+    {
+        Json::Value jv;
+        jv[jss::Account] = account.human ();
+        jv[jss::Reference] = dest.human ();
+        jv[jss::Referee] = referee.human ();
+        jv[jss::Amount] = STAmount (jtx::XRP (100)).getJson (0);
+        jv[jss::TransactionType] = "ActiveAccount";
+        return jv;
+    }
+
+    /** The time to calculate the dividend of the last closed ledger.
+
+        The unit test genesis ledger holds no VBC, so a copy of the ledger
+        gives every account as much VBC as it has XRP first.
+    */
+    std::uint64_t
+    runDividend (jtx::Env& env)
+    {
+        auto const closed = std::dynamic_pointer_cast<Ledger const> (
+            env.closed ());
+        if (! closed)
+            return 0;
+        auto const ledger = std::make_shared<Ledger> (*closed, true);
+        for (auto const& sle : closed->sles)
+        {
+            if (sle->getType () != ltACCOUNT_ROOT)
+                continue;
+            auto const copy = std::make_shared<SLE> (*sle);
+            copy->setFieldAmount (sfBalanceVBC, STAmount (sfBalanceVBC, true,
+                sle->getFieldAmount (sfBalance).mantissa ()));
+            ledger->rawReplace (copy);
+        }
+
+        auto const start = clock_type::now ();
+        DividendEngine engine (env.journal);
+        engine.prepare (ledger);
+        DividendMaster::AccountsDividend results;
+        std::uint64_t actualTotal = 0, actualTotalVBC = 0;
+        std::uint64_t sumVRank = 0, sumVSpd = 0;
+        engine.calcDividend (1000000 * SYSTEM_CURRENCY_PARTS,
+            1000000 * SYSTEM_CURRENCY_PARTS_VBC, actualTotal,
+                actualTotalVBC, sumVRank, sumVSpd, results);
+        engine.clear ();
+        return elapsed (start, clock_type::now ());
+    }
+
+    void
+    runOne (Params const& params)
+    {
+        using namespace jtx;
+        beast::xor_shift_engine engine (params.seed);
+
+        // The operations are picked first, to know the issuers needed
+        std::vector<Kind> kinds (params.ops);
+        {
+            std::discrete_distribution<int> dist (
+                params.weights.begin (), params.weights.end ());
+            for (auto& kind : kinds)
+                kind = static_cast<Kind> (dist (engine));
+        }
+        auto const issuers = std::count (
+            kinds.begin (), kinds.end (), opIssue);
+
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const USD = gw["USD"];
+        env.fund (XRP (10000000), gw);
+
+        std::vector<Account> pool;
+        for (std::size_t i = 0; i < params.accounts; ++i)
+        {
+            pool.emplace_back ("load" + std::to_string (i));
+            env.fund (XRP (1000000), pool.back ());
+        }
+        for (std::ptrdiff_t i = 0; i < issuers; ++i)
+            env.fund (XRP (1000), Account ("issuer" + std::to_string (i)));
+        env.close ();
+        for (auto const& account : pool)
+            env (trust (account, USD (10000000)));
+        env.close ();
+        for (auto const& account : pool)
+            env (pay (gw, account, USD (100000)));
+        env.close ();
+
+        std::array<Samples, kindCount> latency;
+        Samples confirm;
+        Samples closes;
+        Samples dividends;
+        std::vector<clock_type::time_point> pending;
+        std::size_t submitted = 0;
+        std::size_t failed = 0;
+        std::size_t created = 0;
+        std::size_t issued = 0;
+        std::size_t ledgers = 0;
+        std::size_t found = 0;
+
+        auto const closeLedger = [&]()
+        {
+            auto const start = clock_type::now ();
+            env.close ();
+            auto const end = clock_type::now ();
+            closes.push_back (elapsed (start, end));
+            for (auto const& t : pending)
+                confirm.push_back (elapsed (t, end));
+            pending.clear ();
+
+            ++ledgers;
+            if (params.dividend != 0 && ledgers % params.dividend == 0)
+                dividends.push_back (runDividend (env));
+        };
+
+        std::uniform_int_distribution<std::size_t> pick (
+            0, params.accounts - 1);
+        auto const pickTwo = [&]()
+        {
+            auto const from = pick (engine);
+            auto to = pick (engine);
+            if (to == from)
+                to = (to + 1) % params.accounts;
+            return std::make_pair (from, to);
+        };
+
+        auto const cpuStart = cpuTime ();
+        auto const runStart = clock_type::now ();
+        for (std::size_t i = 0; i < kinds.size (); ++i)
+        {
+            auto const kind = kinds[i];
+            auto const accounts = pickTwo ();
+            Account const& a = pool[accounts.first];
+            Account const& b = pool[accounts.second];
+            auto const r = engine ();
+
+            // Accounts are made before the clock starts
+            boost::optional<Account> other;
+            if (kind == opActive)
+                other.emplace ("active" + std::to_string (created++));
+            else if (kind == opIssue)
+                other.emplace ("issuer" + std::to_string (issued++));
+
+            auto const start = clock_type::now ();
+            switch (kind)
+            {
+            case opPayment:
+                if (r & 1)
+                    env (pay (a, b, XRP (1 + r % 100)), ter (std::ignore));
+                else
+                    env (pay (a, b, USD (1 + r % 100)), ter (std::ignore));
+                break;
+
+            case opActive:
+                env (activeJson (a, *other, b), ter (std::ignore));
+                break;
+
+            case opIssue:
+                env (issueJson (*other, a), ter (std::ignore));
+                break;
+
+            case opOffer:
+                // Prices straddle one, so some offers cross
+                if (r & 1)
+                    env (offer (a, XRP (95 + r % 10), USD (100)),
+                        ter (std::ignore));
+                else
+                    env (offer (a, USD (100), XRP (95 + r % 10)),
+                        ter (std::ignore));
+                break;
+
+            case opQuery:
+            {
+                auto const view = env.open ();
+                if (view->read (keylet::account (a.id ())))
+                {
+                    forEachItem (*view, a.id (),
+                        [&](std::shared_ptr<SLE const> const& sle)
+                        {
+                            if (sle->getType () == ltRIPPLE_STATE)
+                                ++found;
+                        });
+                }
+                break;
+            }
+
+            case opPathFind:
+            {
+                auto const cache = std::make_shared<RippleLineCache> (
+                    env.open ());
+                Pathfinder pf (cache, a.id (), b.id (), USD.currency,
+                    boost::none, b["USD"](1 + r % 100), boost::none,
+                        env.app ());
+                if (pf.findPaths (4))
+                {
+                    pf.computePathRanks (4);
+                    ++found;
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+            auto const end = clock_type::now ();
+            latency[kind].push_back (elapsed (start, end));
+
+            if (kind != opQuery && kind != opPathFind)
+            {
+                ++submitted;
+                pending.push_back (start);
+                if (env.ter () != tesSUCCESS)
+                    ++failed;
+            }
+
+            if ((i + 1) % params.close == 0)
+                closeLedger ();
+        }
+        if (! pending.empty ())
+            closeLedger ();
+        auto const runTime = elapsed (runStart, clock_type::now ());
+        auto const cpu = cpuTime () - cpuStart;
+
+        std::stringstream ss;
+        ss << std::left << std::setw (10) << params.ops << std::right
+           << std::setw (9) << params.accounts
+           << std::setw (7) << ledgers
+           << std::setw (9) << (runTime ? submitted * 1000000 / runTime : 0)
+           << std::setw (9) << failed
+           << std::setw (10) << percentile (confirm, 0.5)
+           << std::setw (10) << percentile (confirm, 0.99)
+           << std::setw (10) << percentile (closes, 0.5)
+           << std::setw (10) << percentile (closes, 1.0)
+           << std::setw (9) << cpu
+           << std::setw (7) << peakMemory ();
+        log << ss.str ();
+
+        log << "  Kind         Count  p50 us  p99 us    max us";
+        for (int k = 0; k < kindCount; ++k)
+        {
+            auto& samples = latency[k];
+            if (samples.empty ())
+                continue;
+            std::stringstream line;
+            line << "  " << std::left << std::setw (10)
+                 << getName (static_cast<Kind> (k)) << std::right
+                 << std::setw (8) << samples.size ()
+                 << std::setw (8) << percentile (samples, 0.5)
+                 << std::setw (8) << percentile (samples, 0.99)
+                 << std::setw (10) << percentile (samples, 1.0);
+            log << line.str ();
+        }
+        if (! dividends.empty ())
+        {
+            std::stringstream line;
+            line << "  " << std::left << std::setw (10) << "dividend"
+                 << std::right << std::setw (8) << dividends.size ()
+                 << std::setw (8) << percentile (dividends, 0.5)
+                 << std::setw (8) << percentile (dividends, 0.99)
+                 << std::setw (10) << percentile (dividends, 1.0);
+            log << line.str ();
+        }
+        for (auto const& tag : MemoryTag::getBytes ())
+            log << "  " << tag.first << " " << tag.second / 1024 << "KB";
+
+        expect (submitted == 0 || failed < submitted, "transactions applied");
+    }
+
+    void
+    run () override
+    {
+        testcase ("Load", suite::abort_on_fail);
+
+        std::string const default_args =
+            "ops=5000;"
+            "ops=5000,payment=20,offer=20,path_find=20,query=40;"
+            "ops=5000,active=50,close=100,dividend=5";
+
+        auto const args = arg ().empty () ? default_args : arg ();
+        std::vector<std::string> runs;
+        boost::split (runs, args, boost::algorithm::is_any_of (";"));
+
+        for (auto const& r : runs)
+        {
+            if (r.empty ())
+                continue;
+            log <<
+                "Ops        Accounts Closes      TPS   Failed"
+                "   p50 (us)  p99 (us) close p50 close max    CPU ms  MB";
+            runOne (parse (r));
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(NodeLoad,app,ripple);
+
+} // test
+} // ripple
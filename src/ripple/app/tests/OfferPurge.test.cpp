@@ -0,0 +1,114 @@
+#include <BeastConfig.h>
+#include <ripple/test/jtx.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/misc/DeadOffers.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/Feature.h>
+
+namespace ripple {
+namespace test {
+
+class OfferPurge_test : public beast::unit_test::suite
+{
+public:
+    // Apply a transaction to a closed ledger made on the last one
+    std::pair<TER, std::shared_ptr<Ledger>>
+    applyClosed (jtx::Env& env, STTx const& tx)
+    {
+        auto const closed = std::dynamic_pointer_cast<Ledger const> (
+            env.closed ());
+        auto next = std::make_shared<Ledger> (open_ledger, *closed,
+            env.app ().timeKeeper ().closeTime ());
+        next->setClosed ();
+        OpenView accum (&*next);
+        auto const result = ripple::apply (env.app (),
+            accum, tx, tapNONE, env.journal);
+        accum.apply (*next);
+        return {result.first, next};
+    }
+
+    void
+    testPurge ()
+    {
+        testcase ("purge");
+
+        using namespace jtx;
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const gw = Account ("gw");
+        auto const USD = gw["USD"];
+
+        auto config = std::make_unique<Config> ();
+        setupConfigForUnitTests (*config);
+        config->features.insert (featureOfferPurge);
+        Env env (*this, std::move (config));
+
+        env.fund (XRP (10000), alice, bob, gw);
+        env.trust (USD (100), alice, bob);
+        env (pay (gw, alice, USD (50)));
+        env (pay (gw, bob, USD (50)));
+        env.close ();
+
+        // Alice gives back the dollars she offers, so nobody can take
+        // her offer
+        auto const aliceOffer = keylet::offer (alice.id (), env.seq (alice));
+        auto const bobOffer = keylet::offer (bob.id (), env.seq (bob));
+        env (offer (alice, XRP (50), USD (50)));
+        env (offer (bob, XRP (60), USD (50)));
+        env (pay (alice, gw, USD (50)));
+        env.close ();
+
+        auto const dead = DeadOffers::find (*env.closed (), env.journal);
+        expect (dead == std::vector<uint256> ({aliceOffer.key}));
+
+        auto const result = applyClosed (env, DeadOffers::makeTx (dead));
+        expect (result.first == tesSUCCESS);
+        expect (! result.second->exists (aliceOffer));
+        expect (result.second->exists (bobOffer));
+        expect (result.second->read (keylet::account (alice.id ()))->
+            getFieldU32 (sfOwnerCount) == 1);
+
+        // An offer that can be taken is left alone
+        auto const keep = applyClosed (env,
+            DeadOffers::makeTx ({bobOffer.key}));
+        expect (keep.first == tesSUCCESS);
+        expect (keep.second->exists (bobOffer));
+
+        // Offers are listed once, in order
+        expect (applyClosed (env, DeadOffers::makeTx (
+            {bobOffer.key, bobOffer.key})).first == temMALFORMED);
+        expect (applyClosed (env, DeadOffers::makeTx (
+            {})).first == temMALFORMED);
+
+        // Never in an open ledger
+        OpenView open (open_ledger, &*env.closed (),
+            env.closed ()->rules ());
+        expect (ripple::apply (env.app (), open, DeadOffers::makeTx (dead),
+            tapNONE, env.journal).first == temINVALID);
+    }
+
+    void
+    testDisabled ()
+    {
+        testcase ("disabled");
+
+        using namespace jtx;
+        Env env (*this);
+        env.close ();
+        expect (applyClosed (env, DeadOffers::makeTx (
+            {uint256 (1)})).first == temDISABLED);
+    }
+
+    void
+    run ()
+    {
+        testPurge ();
+        testDisabled ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OfferPurge,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,151 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/core/Config.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/test/jtx.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class OpenLedger_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::unique_ptr<Config>
+    config (int threads)
+    {
+        auto config = std::make_unique<Config> ();
+        setupConfigForUnitTests (*config);
+        config->PARALLEL_APPLY = threads;
+        return config;
+    }
+
+    static
+    std::vector<jtx::Account>
+    setup (jtx::Env& env, jtx::Account const& gw, std::size_t count)
+    {
+        using namespace jtx;
+        std::vector<Account> accounts;
+        env.fund (XRP (100000), gw);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            accounts.emplace_back ("a" + std::to_string (i));
+            env.fund (XRP (10000), accounts.back ());
+            env.trust (gw["USD"] (1000), accounts.back ());
+            env (pay (gw, accounts.back (), gw["USD"] (100)));
+        }
+        env.close ();
+        return accounts;
+    }
+
+    // Payments between neighbours, some of them out of sequence, and
+    // offers that cross each other
+    static
+    std::vector<std::shared_ptr<STTx const>>
+    makeTxs (jtx::Env& env, jtx::Account const& gw,
+        std::vector<jtx::Account> const& accounts)
+    {
+        using namespace jtx;
+        std::vector<std::shared_ptr<STTx const>> txs;
+        auto const USD = gw["USD"];
+        auto const n = accounts.size ();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto const& from = accounts[i];
+            auto const s = env.seq (from);
+            auto const first = env.jt (pay (from,
+                accounts[(i + 1) % n], XRP (10)), seq (s));
+            auto const second = env.jt (pay (from,
+                accounts[(i + 5) % n], USD (5)), seq (s + 1));
+            if (i % 3 == 0)
+            {
+                txs.push_back (second.stx);
+                txs.push_back (first.stx);
+            }
+            else
+            {
+                txs.push_back (first.stx);
+                txs.push_back (second.stx);
+            }
+            if (i % 2 == 0)
+                txs.push_back (env.jt (offer (from,
+                    USD (10), XRP (10)), seq (s + 2)).stx);
+            else
+                txs.push_back (env.jt (offer (from,
+                    XRP (10), USD (10)), seq (s + 2)).stx);
+            // Already used
+            txs.push_back (env.jt (pay (from,
+                gw, XRP (1)), seq (s - 1)).stx);
+        }
+        return txs;
+    }
+
+    static
+    std::vector<Blob>
+    contents (ReadView const& view)
+    {
+        std::vector<Blob> result;
+        for (auto const& sle : view.sles)
+            result.push_back (sle->getSerializer ().peekData ());
+        for (auto const& tx : view.txs)
+        {
+            auto const id = tx.first->getTransactionID ();
+            result.emplace_back (id.begin (), id.end ());
+        }
+        return result;
+    }
+
+    std::vector<Blob>
+    apply (jtx::Env& env, std::vector<std::shared_ptr<
+        STTx const>> const& txs, std::size_t& retries)
+    {
+        auto const closed = env.closed ();
+        OpenView view (open_ledger, closed->rules (), closed);
+        OrderedTxs retried (uint256 {});
+        OpenLedger::apply (env.app (), view, *closed, txs,
+            retried, tapENABLE_TESTING, env.journal);
+        retries = retried.size ();
+        expect (view.txCount () > 0);
+        return contents (view);
+    }
+
+    void
+    testParallel (int threads, std::size_t count)
+    {
+        testcase ("parallel " + std::to_string (threads) +
+            " threads, " + std::to_string (count) + " accounts");
+
+        using namespace jtx;
+        auto const gw = Account ("gateway");
+        Env serial (*this, config (0));
+        Env parallel (*this, config (threads));
+        auto const accounts = setup (serial, gw, count);
+        setup (parallel, gw, count);
+        expect (serial.closed ()->info ().hash ==
+            parallel.closed ()->info ().hash, "same ledgers");
+
+        auto const txs = makeTxs (serial, gw, accounts);
+        std::size_t serialRetries = 0;
+        std::size_t parallelRetries = 0;
+        auto const expected = apply (serial, txs, serialRetries);
+        auto const actual = apply (parallel, txs, parallelRetries);
+        expect (expected == actual, "same state");
+        expect (serialRetries == parallelRetries, "same retries");
+    }
+
+    void
+    run () override
+    {
+        testParallel (2, 5);
+        testParallel (4, 40);
+        testParallel (8, 100);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OpenLedger,app,ripple);
+
+} // test
+} // ripple
@@ -19,15 +19,20 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/paths/AccountCurrencies.h>
+#include <ripple/app/paths/Pathfinder.h>
+#include <ripple/app/paths/RippleCalc.h>
 #include <ripple/basics/contract.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/to_string.h>
+#include <ripple/ledger/PaymentSandbox.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/rpc/RipplePathFind.h>
 #include <ripple/test/jtx.h>
+#include <beast/module/core/text/LexicalCast.h>
 #include <beast/unit_test/suite.h>
+#include <chrono>
 
 namespace ripple {
 namespace test {
@@ -256,6 +261,58 @@ public:
         expect(equal(sa, Account("alice")["USD"](5)));
     }
 
+    void
+    path_find_stats_and_deadline()
+    {
+        using namespace jtx;
+        testcase("path find stats and deadline");
+        Env env(*this);
+        auto const gw = Account("gateway");
+        auto const USD = gw["USD"];
+        env.fund(XRP(10000), "alice", "bob", gw);
+        env.trust(USD(600), "alice");
+        env.trust(USD(700), "bob");
+        env(pay(gw, "alice", USD(70)));
+        env(pay(gw, "bob", USD(50)));
+
+        auto const alice = Account("alice");
+        auto const bob = Account("bob");
+        auto const cache = std::make_shared<RippleLineCache>(env.open());
+        STAmount const amount = bob["USD"](5);
+
+        Pathfinder pf(cache, alice.id(), bob.id(), USD.currency,
+            boost::none, amount, boost::none, env.app());
+        expect(pf.findPaths(8));
+        pf.computePathRanks(4);
+        expect(! pf.timedOut());
+        expect(pf.stats().nodes > 0);
+        expect(pf.stats().lines > 0);
+        expect(pf.stats().rippleCalcs > 0);
+
+        STPath fullLiquidityPath;
+        PathSearchStats best;
+        auto const found = pf.getBestPaths(4, fullLiquidityPath,
+            STPathSet(), alice.id(), &best);
+        expect(same(found, stpath("gateway")));
+        expect(best.rippleCalcs == 0);
+
+        // Past the deadline nothing new is found, but paths found
+        // before are still ranked
+        Pathfinder late(cache, alice.id(), bob.id(), USD.currency,
+            boost::none, amount, boost::none, env.app());
+        late.setDeadline(Pathfinder::clock_type::now());
+        expect(late.findPaths(8));
+        late.computePathRanks(4);
+        expect(late.timedOut());
+        expect(late.stats().nodes == 0);
+
+        STPath lateFullLiquidityPath;
+        auto const kept = late.getBestPaths(4, lateFullLiquidityPath,
+            found, alice.id(), &best);
+        expect(same(kept, stpath("gateway")));
+        expect(best.rippleCalcs > 0);
+    }
+
     void
     path_find_consume_all()
     {
@@ -692,6 +749,7 @@ public:
         direct_path_no_intermediary();
         payment_auto_path_find();
         path_find();
+        path_find_stats_and_deadline();
         path_find_consume_all();
         alternative_path_consume_both();
         alternative_paths_consume_best_transfer();
@@ -708,7 +766,70 @@ public:
     }
 };
 
+// Times RippleCalc on a payment crossing currencies through several books
+class PathBench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run()
+    {
+        using namespace jtx;
+        using clock_type = std::chrono::steady_clock;
+        std::size_t const count = arg().empty() ?
+            10000 : beast::lexicalCastThrow<std::size_t>(arg());
+
+        Env env(*this);
+        auto const gw = Account("gateway");
+        auto const gw2 = Account("gateway2");
+        auto const USD = gw["USD"];
+        auto const EUR = gw2["EUR"];
+        env.fund(XRP(100000), "alice", "bob", "carol", "dan", gw, gw2);
+        env.trust(USD(10000), "alice", "carol", "dan");
+        env.trust(EUR(10000), "bob", "carol", "dan");
+        env(pay(gw, "alice", USD(1000)));
+        env(pay(gw2, "carol", EUR(1000)));
+        env(pay(gw2, "dan", EUR(1000)));
+
+        // Through XRP, and straight from one currency to the other
+        for (int i = 1; i <= 5; ++i)
+        {
+            env(offer("carol", USD(10 * i), XRP(10 * i + 1)));
+            env(offer("carol", XRP(10 * i), EUR(10 * i - 1)));
+            env(offer("dan", USD(10 * i + 2), EUR(10 * i)));
+        }
+        env.close();
+
+        STPathSet st;
+        std::tie(st, std::ignore, std::ignore) = find_paths(env,
+            "alice", "bob", EUR(100), STAmount(USD(200)));
+        expect(! st.empty(), "paths");
+
+        auto const saMaxAmount = Account("alice")["USD"](200);
+        auto const saDstAmount = EUR(100);
+        for (int pass = 1; pass <= 3; ++pass)
+        {
+            std::size_t succeeded = 0;
+            auto const start = clock_type::now();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                PaymentSandbox sandbox(&*env.open(), tapNONE);
+                auto const rc = ripple::path::RippleCalc::rippleCalculate(sandbox,
+                    saMaxAmount, saDstAmount, Account("bob"),
+                        Account("alice"), st, env.app().logs());
+                if (rc.result() == tesSUCCESS)
+                    ++succeeded;
+            }
+            auto const elapsed = std::chrono::duration_cast<
+                std::chrono::milliseconds>(clock_type::now() - start);
+            log << "pass " << pass << ": " << count << " payments over " <<
+                st.size() << " paths in " << elapsed.count() << "ms";
+            expect(succeeded == count, "succeeded");
+        }
+    }
+};
+
 BEAST_DEFINE_TESTSUITE(Path,app,ripple)
+BEAST_DEFINE_TESTSUITE_MANUAL(PathBench,app,ripple)
 
 } // test
 } // ripple
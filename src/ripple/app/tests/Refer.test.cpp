@@ -1,4 +1,8 @@
 #include <BeastConfig.h>
+#include <ripple/ledger/Sandbox.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/test/jtx.h>
 
@@ -24,6 +28,25 @@ struct Refer_test : public beast::unit_test::suite
         return jv;
     }
 
+    static Json::Value
+    activeAll (jtx::Account const& account,
+               std::vector<jtx::Account> const& dests,
+               jtx::Account const& referee,
+               STAmount const& amount)
+    {
+        using namespace jtx;
+        Json::Value jv;
+        jv[jss::Account] = account.human ();
+        jv[jss::Referee] = referee.human ();
+        jv[jss::Amount] = amount.getJson (0);
+        jv[jss::TransactionType] = "ActiveAccounts";
+        auto& references = jv["References"] = Json::arrayValue;
+        for (auto const& dest : dests)
+            references.append (Json::objectValue)
+                ["ReferenceHolder"][jss::Reference] = dest.human ();
+        return jv;
+    }
+
     void testActive ()
     {
         using namespace jtx;
@@ -66,9 +89,111 @@ struct Refer_test : public beast::unit_test::suite
                           gw.id (), USD.currency)));
     }
 
+    void testReferences ()
+    {
+        using namespace jtx;
+        auto const gw = Account ("gw");
+
+        Env env (*this);
+        env.fund (XRP (100000), "alice", "dan", gw);
+        env (active ("alice", "bob", gw, XRP (100)));
+        env (active ("alice", "carol", gw, XRP (100)));
+
+        // Entries of the referral directory follow the ltREFER ones
+        Sandbox sb (&*env.open (), tapNONE);
+        std::uint64_t uNode;
+        expect (dirAdd (sb, uNode, getReferDirIndex (gw.id ()),
+            keylet::account (Account ("dan").id ()).key,
+                describeOwnerDir (gw.id ()), env.journal) == tesSUCCESS);
+
+        std::vector<AccountID> references;
+        forEachReference (sb, gw.id (),
+            [&](std::shared_ptr<SLE const> const& sle)
+            {
+                references.push_back (sle->getAccountID (sfAccount));
+                return true;
+            });
+        expect (references == std::vector<AccountID> ({
+            Account ("bob").id (), Account ("carol").id (),
+                Account ("dan").id ()}));
+
+        references.clear ();
+        forEachReference (sb, gw.id (),
+            [&](std::shared_ptr<SLE const> const& sle)
+            {
+                references.push_back (sle->getAccountID (sfAccount));
+                return references.size () < 2;
+            });
+        expect (references.size () == 2);
+
+        references.clear ();
+        forEachReference (sb, Account ("dan").id (),
+            [&](std::shared_ptr<SLE const> const& sle)
+            {
+                references.push_back (sle->getAccountID (sfAccount));
+                return true;
+            });
+        expect (references.empty ());
+    }
+
+    void testActiveAccounts ()
+    {
+        using namespace jtx;
+        auto const gw = Account ("gw");
+        auto const bob = Account ("bob");
+        auto const carol = Account ("carol");
+        auto const dan = Account ("dan");
+
+        {
+            Env env (*this);
+            env.fund (XRP (100000), "alice", gw);
+            env (activeAll ("alice", {bob}, gw, XRP (100)), fee (XRP (1)),
+                 ter (temDISABLED));
+        }
+
+        auto config = std::make_unique<Config> ();
+        setupConfigForUnitTests (*config);
+        config->features.insert (featureActiveAccounts);
+        Env env (*this, std::move (config));
+        env.fund (XRP (100000), "alice", gw);
+
+        env (activeAll ("alice", {}, gw, XRP (100)), fee (XRP (1)),
+             ter (temMALFORMED));
+        env (activeAll ("alice", {bob, bob}, gw, XRP (100)), fee (XRP (1)),
+             ter (temMALFORMED));
+        env (activeAll ("alice", {bob, gw}, gw, XRP (100)), fee (XRP (1)),
+             ter (temDST_IS_SRC));
+        env (activeAll ("alice", {bob}, gw, XRP (0)), fee (XRP (1)),
+             ter (temBAD_AMOUNT));
+        env (activeAll ("alice", {bob}, carol, XRP (100)), fee (XRP (1)),
+             ter (tecNO_DST));
+        env (activeAll ("alice", {bob}, gw, XRP (200000)), fee (XRP (300)),
+             ter (tecUNFUNDED_PAYMENT));
+
+        // Each reference pays for its creation
+        env (activeAll ("alice", {bob, carol, dan}, gw, XRP (100)),
+             fee (drops (110000)), ter (telINSUF_FEE_P));
+        env (activeAll ("alice", {bob, carol, dan}, gw, XRP (100)),
+             fee (XRP (1)));
+
+        for (auto const& account : {bob, carol, dan})
+        {
+            auto const sle = env.le (account);
+            expect (sle &&
+                    sle->getAccountID (sfReferee) == gw.id () &&
+                    sle->getFieldAmount (sfBalance) == XRP (100));
+        }
+
+        env (activeAll ("alice", {Account ("eve"), dan}, gw, XRP (100)),
+             fee (XRP (1)), ter (tefCREATED));
+        expect (! env.le ("eve"));
+    }
+
     void run () override
     {
         testActive ();
+        testReferences ();
+        testActiveAccounts ();
     }
 };
 
@@ -26,6 +26,9 @@
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/test/jtx.h>
+#include <beast/module/core/text/LexicalCast.h>
+#include <chrono>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -551,6 +554,48 @@ public:
 
     }
 
+    void testSkipUnchanged()
+    {
+        using namespace jtx;
+
+        Env env(*this, makeConfig());
+
+        auto& txq = env.app().getTxQ();
+        txq.setMinimumTx(2);
+
+        auto alice = Account("alice");
+        auto bob = Account("bob");
+
+        auto queued = ter(terQUEUED);
+
+        env.fund(XRP(1000), noripple(alice, bob));
+        env.close();
+
+        // Fill the open ledger, then queue alice's next transaction
+        env(noop(alice));
+        env(noop(bob));
+        env(noop(bob));
+        submit(env, env.jt(noop(alice), queued));
+        expect(txq.getMetrics(*env.open()).txCount == 1);
+
+        // Without the open ledger's transactions, alice's queued
+        // transaction is ahead of her account every time.
+        auto const rules = env.open()->rules();
+        for (int i = 0; i < 2; ++i)
+        {
+            OpenView view(open_ledger, rules, env.closed());
+            expect(! txq.accept(env.app(), view, tapENABLE_TESTING));
+            expect(view.txCount() == 0);
+            expect(txq.getMetrics(*env.open()).txCount == 1);
+        }
+
+        // Once her sequence moves, it is tried again
+        txq.setMinimumTx(4);
+        OpenView view(*env.open());
+        expect(txq.accept(env.app(), view, tapENABLE_TESTING));
+        expect(txq.getMetrics(*env.open()).txCount == 0);
+    }
+
     void run()
     {
         testQueue();
@@ -558,10 +603,99 @@ public:
         testZeroFeeTxn();
         testPreclaimFailures();
         testQueuedFailure();
+        testSkipUnchanged();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** Times TxQ::accept over many queued transactions that are ahead of
+    their accounts, with and without skipping the unchanged ones.
+
+    Each account applies a transaction to the open ledger and queues the
+    next one. Every pass then accepts the queue into a view of the closed
+    ledger, where none of the queued transactions can apply.
+
+    The argument is the number of queued transactions, default 100000.
+*/
+class TxQBench_test : public TestSuite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    static
+    std::unique_ptr<Config const>
+    makeConfig(bool skipUnchanged)
+    {
+        auto p = std::make_unique<Config>();
+        setupConfigForUnitTests(*p);
+        auto& section = p->section("transaction_queue");
+        section.set("skip_unchanged", skipUnchanged ? "1" : "0");
+        return std::move(p);
+    }
+
+    void
+    bench(std::size_t count, bool skipUnchanged)
+    {
+        using namespace jtx;
+
+        Env env(*this, makeConfig(skipUnchanged));
+        auto& txq = env.app().getTxQ();
+
+        std::vector<Account> accounts;
+        accounts.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            accounts.emplace_back("bench" + std::to_string(i));
+            env.fund(XRP(1000), noripple(accounts.back()));
+            if ((i + 1) % 1000 == 0)
+                env.close();
+        }
+        env.close();
+
+        for (auto const& account : accounts)
+            env(noop(account));
+
+        // Fees escalate at once, so every next transaction is queued
+        txq.setMinimumTx(1);
+        for (auto const& account : accounts)
+        {
+            auto const jt = env.jt(noop(account));
+            env.openLedger.modify(
+                [&](OpenView& view, beast::Journal j)
+                {
+                    return txq.apply(env.app(), view, jt.stx,
+                        tapENABLE_TESTING, env.journal).second;
+                });
+        }
+        expect(txq.getMetrics(*env.open()).txCount == count, "txCount");
+
+        auto const rules = env.open()->rules();
+        for (int pass = 1; pass <= 3; ++pass)
+        {
+            OpenView view(open_ledger, rules, env.closed());
+            auto const start = clock_type::now();
+            txq.accept(env.app(), view, tapENABLE_TESTING);
+            auto const elapsed = std::chrono::duration_cast<
+                std::chrono::milliseconds>(clock_type::now() - start);
+            log << (skipUnchanged ? "skip" : "noskip") <<
+                " pass " << pass << ": " << count <<
+                " queued in " << elapsed.count() << "ms";
+        }
+        expect(txq.getMetrics(*env.open()).txCount == count, "txCount");
+    }
+
+public:
+    void run()
+    {
+        std::size_t const count = arg().empty() ?
+            100000 : beast::lexicalCastThrow<std::size_t>(arg());
+        bench(count, false);
+        bench(count, true);
     }
 };
 
 BEAST_DEFINE_TESTSUITE(TxQ,app,ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(TxQBench,app,ripple);
 
 }
 }
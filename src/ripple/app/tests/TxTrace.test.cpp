@@ -0,0 +1,157 @@
+#include <BeastConfig.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+
+namespace ripple {
+namespace test {
+
+class TxTrace_test : public beast::unit_test::suite
+{
+public:
+    using Phase = TxTrace::Phase;
+    using clock_type = TxTrace::clock_type;
+
+    // An ID whose sampled bits all hold one byte
+    static
+    uint256
+    makeID (unsigned char byte)
+    {
+        uint256 id;
+        std::fill (id.begin (), id.end (), byte);
+        return id;
+    }
+
+    void
+    testSampling ()
+    {
+        testcase ("sampling");
+
+        TxTrace off {Section ()};
+        expect (! off.enabled ());
+        off.mark (makeID (2), Phase::received);
+        expect (off.size () == 0);
+
+        Section section;
+        section.set ("sample_rate", "2");
+        TxTrace trace (section);
+        expect (trace.enabled ());
+        expect (trace.sampled (makeID (2)));
+        expect (! trace.sampled (makeID (3)));
+
+        trace.mark (makeID (2), Phase::received);
+        trace.mark (makeID (3), Phase::received);
+        expect (trace.size () == 1);
+        expect (trace.find (makeID (3)) == nullptr);
+        expect (trace.getJson (makeID (3)).isNull ());
+    }
+
+    void
+    testPhases ()
+    {
+        testcase ("phases");
+
+        using namespace std::chrono;
+        Section section;
+        section.set ("sample_rate", "1");
+        TxTrace trace (section);
+
+        clock_type::time_point const now {hours (1)};
+        auto const id = makeID (1);
+
+        // Not traced until it is received
+        trace.mark (id, Phase::checked, now);
+        expect (trace.size () == 0);
+
+        trace.mark (id, Phase::received, now);
+        trace.mark (id, Phase::checked, now + milliseconds (1));
+        trace.mark (id, Phase::applied, now + milliseconds (3));
+        // Only the first time counts
+        trace.mark (id, Phase::received, now + milliseconds (4));
+        trace.mark (id, Phase::applied, now + milliseconds (5));
+        trace.mark (id, Phase::validated, now + seconds (4));
+
+        auto const offsets = trace.find (id);
+        expect (offsets != nullptr);
+        if (offsets)
+        {
+            expect ((*offsets)[0] == 0);
+            expect ((*offsets)[1] == 1000);
+            expect ((*offsets)[2] == 3000);
+            expect ((*offsets)[3] < 0);
+            expect ((*offsets)[4] == 4000000);
+            expect ((*offsets)[5] < 0);
+        }
+
+        auto const json = trace.getJson (id);
+        expect (json["checked"] == 1000);
+        expect (json["applied"] == 3000);
+        expect (! json.isMember ("closed"));
+        expect (json["validated"] == 4000000);
+    }
+
+    void
+    testLimits ()
+    {
+        testcase ("limits");
+
+        using namespace std::chrono;
+        Section section;
+        section.set ("sample_rate", "1");
+        section.set ("size", "2");
+        section.set ("age", "60");
+        TxTrace trace (section);
+
+        clock_type::time_point const now {hours (1)};
+        trace.mark (makeID (1), Phase::received, now);
+        trace.mark (makeID (2), Phase::received, now);
+        trace.mark (makeID (3), Phase::received, now);
+        expect (trace.size () == 2);
+        expect (trace.find (makeID (1)) == nullptr, "oldest dropped");
+
+        // Transactions received too long ago are forgotten
+        trace.mark (makeID (4), Phase::received, now + minutes (2));
+        expect (trace.size () == 1);
+        expect (trace.find (makeID (4)) != nullptr);
+    }
+
+    void
+    testAggregate ()
+    {
+        testcase ("aggregate");
+
+        using namespace std::chrono;
+        Section section;
+        section.set ("sample_rate", "1");
+        TxTrace trace (section);
+
+        // The percentiles are of the last ten minutes until now
+        auto const start = clock_type::now () - milliseconds (20);
+        for (unsigned char i = 1; i <= 10; ++i)
+        {
+            trace.mark (makeID (i), Phase::received, start);
+            trace.mark (makeID (i), Phase::saved, start + milliseconds (i));
+        }
+
+        auto const json = trace.getJson ();
+        expect (json["sample_rate"] == 1);
+        expect (json["traced"] == 10);
+        expect (json["saved"]["count"] == 10);
+        expect (json["saved"]["max"] == 10000);
+        expect (! json.isMember ("checked"));
+    }
+
+    void
+    run () override
+    {
+        testSampling ();
+        testPhases ();
+        testLimits ();
+        testAggregate ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxTrace,app,ripple);
+
+} // test
+} // ripple
@@ -27,6 +27,7 @@
 #include <beast/utility/Journal.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -69,6 +70,20 @@ checkValidity(HashRouter& router,
         Config const& config,
             ApplyFlags const& flags = tapNONE);
 
+/** Checks the signatures and local checks of several transactions.
+
+    The signatures whose state is not cached yet are checked together,
+    which is faster than checking each transaction alone. The results
+    are cached as with the single transaction checkValidity.
+
+    @return The validity of each transaction, and the reason
+            where one is not Valid, in order.
+*/
+std::vector<std::pair<Validity, std::string>>
+checkValidity(HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        Rules const& rules, Config const& config);
+
 
 /** Sets the validity of a given transaction in the cache.
     Use with extreme care.
@@ -22,6 +22,9 @@
 
 #include <ripple/ledger/ApplyViewImpl.h>
 #include <beast/utility/Journal.h>
+#include <deque>
+#include <iterator>
+#include <vector>
 
 namespace ripple {
 
@@ -66,17 +69,21 @@ public:
     // result
     TER const ter;
     std::uint64_t const baseFee;
+    // The fee units the fee paid is measured against, see calculateFeeCost
+    std::uint64_t const feeCost;
     bool const likelyToClaimFee;
 
     template<class Context>
     PreclaimResult(Context const& ctx_,
-        TER ter_, std::uint64_t const& baseFee_)
+        TER ter_, std::uint64_t const& baseFee_,
+            std::uint64_t const& feeCost_)
         : view(ctx_.view)
         , tx(ctx_.tx)
         , flags(ctx_.flags)
         , j(ctx_.j)
         , ter(ter_)
         , baseFee(baseFee_)
+        , feeCost(feeCost_)
         , likelyToClaimFee(ter == tesSUCCESS
             || isTecClaim(ter))
     {
@@ -84,8 +91,8 @@ public:
 
     template<class Context>
     PreclaimResult(Context const& ctx_,
-        std::pair<TER, std::uint64_t> const& result)
-        : PreclaimResult(ctx_, result.first, result.second)
+        TER ter_, std::uint64_t const& baseFee_)
+        : PreclaimResult(ctx_, ter_, baseFee_, baseFee_)
     {
     }
 
@@ -142,6 +149,25 @@ preclaim(PreflightResult const& preflightResult,
 std::uint64_t
 calculateBaseFee(Application& app, ReadView const& view,
     STTx const& tx, beast::Journal j);
+
+/** Compute the cost of a transaction in fee units.
+
+    This is the base fee, or what the transaction's FeePolicy charges
+    for what it moves and creates when that is more. The TxQ divides
+    the fee paid by it, so that payments whose fee is a share of the
+    amount are not ranked above transactions that pay more per unit of
+    what they owe.
+
+    @param app The current running `Application`.
+    @param view The current open ledger.
+    @param tx The transaction to be checked.
+    @param j A journal.
+
+    @return The cost in fee units.
+*/
+std::uint64_t
+calculateFeeCost(Application& app, ReadView const& view,
+    STTx const& tx, beast::Journal j);
 /** Apply a prechecked transaction to an OpenView.
 
     See also: apply()
@@ -156,6 +182,78 @@ std::pair<TER, bool>
 doApply(PreclaimResult const& preclaimResult,
     Application& app, OpenView& view);
 
+/** Return the keys of the state entries a transaction is likely to read.
+
+    They are known from the transaction alone, so the entries can be
+    prefetched before the transaction is applied. Malformed transactions
+    give what could be found.
+*/
+std::vector<uint256>
+prefetchKeys(STTx const& tx);
+
+/** Prefetches the state entries of the transactions applied next.
+
+    Called before each transaction is applied, in the order they are
+    applied, it asks the view for the entries of the window of
+    transactions after it. Each ask goes a level further down the paths
+    to the entries, so that on a cold ledger a transaction's entries are
+    in memory by the time it is applied.
+*/
+class TxPrefetch
+{
+private:
+    ReadView const& view_;
+    std::size_t const window_;
+    bool started_ = false;
+
+    // The keys of the transaction being applied and those after it
+    std::deque<std::vector<uint256>> keys_;
+
+    static
+    STTx const&
+    get (std::shared_ptr<STTx const> const& tx)
+    {
+        return *tx;
+    }
+
+    template <class Key>
+    static
+    STTx const&
+    get (std::pair<Key const, std::shared_ptr<STTx const>> const& item)
+    {
+        return *item.second;
+    }
+
+public:
+    explicit
+    TxPrefetch (ReadView const& view, std::size_t window = 8)
+        : view_ (view)
+        , window_ (window)
+    {
+    }
+
+    /** Call before applying the transaction at iter.
+
+        The ones from iter to end must be those that follow the
+        transaction of the previous call, if any.
+    */
+    template <class FwdIter>
+    void
+    operator() (FwdIter iter, FwdIter end)
+    {
+        if (started_ && ! keys_.empty ())
+            keys_.pop_front ();
+        started_ = true;
+
+        std::advance (iter, keys_.size ());
+        for (; iter != end && keys_.size () <= window_; ++iter)
+            keys_.push_back (prefetchKeys (get (*iter)));
+
+        for (std::size_t i = 1; i < keys_.size (); ++i)
+            view_.prefetch (keys_[i]);
+    }
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/impl/ActiveAccounts.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+#include <algorithm>
+
+namespace ripple
+{
+
+TER
+ActiveAccounts::preflight (PreflightContext const& ctx)
+{
+    if (! (ctx.flags & tapENABLE_TESTING) &&
+        ! ctx.rules.enabled(featureActiveAccounts,
+            ctx.app.config().features))
+        return temDISABLED;
+
+    auto const ret = preflight1 (ctx);
+    if (!isTesSuccess (ret))
+        return ret;
+
+    auto& tx = ctx.tx;
+    auto& j = ctx.j;
+
+    STAmount const saDstAmount (tx.getFieldAmount (sfAmount));
+    if (!saDstAmount.native () || isVBC (saDstAmount) ||
+        saDstAmount <= zero || !isLegalNet (saDstAmount))
+    {
+        JLOG(j.trace) << "Malformed transaction: " <<
+            "bad amount: " << saDstAmount.getFullText ();
+        return temBAD_AMOUNT;
+    }
+
+    auto const account = tx.getAccountID (sfAccount);
+    auto const uReferee = tx.getAccountID (sfReferee);
+    if (!uReferee)
+    {
+        JLOG(j.trace) << "Malformed transaction: " <<
+            "Referee account not specified.";
+        return temDST_NEEDED;
+    }
+
+    auto const& references = tx.getFieldArray (sfReferences);
+    if (references.empty () || references.size () > maxReferences)
+    {
+        JLOG(j.trace) << "Malformed transaction: " <<
+            references.size () << " references.";
+        return temMALFORMED;
+    }
+
+    std::vector<AccountID> accounts;
+    accounts.reserve (references.size ());
+    for (auto const& reference : references)
+    {
+        if (reference.getFName () != sfReferenceHolder ||
+            !reference.isFieldPresent (sfReference))
+        {
+            JLOG(j.trace) << "Malformed transaction: " <<
+                "Reference account not specified.";
+            return temDST_NEEDED;
+        }
+
+        auto const uReference = reference.getAccountID (sfReference);
+        if (!uReference || uReference == account)
+        {
+            JLOG(j.trace) << "Malformed transaction: " <<
+                "Bad reference account.";
+            return temDST_NEEDED;
+        }
+        if (uReference == uReferee)
+        {
+            JLOG(j.trace) << "Malformed transaction: " <<
+                "Referee should not be same with reference.";
+            return temDST_IS_SRC;
+        }
+        accounts.push_back (uReference);
+    }
+
+    std::sort (accounts.begin (), accounts.end ());
+    if (std::adjacent_find (accounts.begin (), accounts.end ()) != accounts.end ())
+    {
+        JLOG(j.trace) << "Malformed transaction: duplicate references.";
+        return temMALFORMED;
+    }
+
+    return preflight2 (ctx);
+}
+
+TER
+ActiveAccounts::preclaim (PreclaimContext const& ctx)
+{
+    STAmount const saDstAmount (ctx.tx[sfAmount]);
+    if (saDstAmount < STAmount (ctx.view.fees ().accountReserve (0)))
+    {
+        JLOG(ctx.j.trace) <<
+            "Insufficent payment to create account.";
+        return tecNO_DST_INSUF_XRP;
+    }
+
+    if (!ctx.view.exists (keylet::account (ctx.tx.getAccountID (sfReferee))))
+    {
+        JLOG(ctx.j.trace) <<
+            "Referee account does not exist.";
+        return tecNO_DST;
+    }
+
+    for (auto const& reference : ctx.tx.getFieldArray (sfReferences))
+    {
+        if (ctx.view.exists (keylet::account (
+                reference.getAccountID (sfReference))))
+        {
+            JLOG(ctx.j.trace) <<
+                "account already created";
+            return tefCREATED;
+        }
+    }
+
+    return tesSUCCESS;
+}
+
+TER
+ActiveAccounts::doApply ()
+{
+    auto& tx = ctx_.tx;
+    auto viewJ = ctx_.app.journal ("View");
+
+    AccountID const refereeID (tx.getAccountID (sfReferee));
+    STAmount const saDstAmount (tx.getFieldAmount (sfAmount));
+    auto const& references = tx.getFieldArray (sfReferences);
+
+    // preflight bounds both, the total can not overflow
+    XRPAmount const total (saDstAmount.xrp ().drops () *
+        static_cast<std::int64_t> (references.size ()));
+
+    auto const sle = view ().peek (keylet::account (account_));
+
+    // Allow final spend to use reserve for fee, as a payment does.
+    auto const reserve = view ().fees ().accountReserve (
+        sle->getFieldU32 (sfOwnerCount));
+    auto const mmm = std::max (reserve, tx.getFieldAmount (sfFee).xrp ());
+
+    if (mPriorBalance < total + mmm)
+    {
+        JLOG(j_.trace) << "Delay transaction: Insufficient funds: " <<
+            " " << to_string (mPriorBalance) <<
+            " / " << to_string (total + mmm) <<
+            " (" << to_string (reserve) << ")";
+        return tecUNFUNDED_PAYMENT;
+    }
+
+    sle->setFieldAmount (sfBalance, mSourceBalance - total);
+
+    for (auto const& reference : references)
+    {
+        AccountID const dstAccountID (reference.getAccountID (sfReference));
+
+        auto const k = keylet::account (dstAccountID);
+        if (view ().exists (k))
+            return tefCREATED;
+
+        // Create the account.
+        auto const sleDst = std::make_shared<SLE> (k);
+        sleDst->setAccountID (sfAccount, dstAccountID);
+        sleDst->setFieldU32 (sfSequence, 1);
+        sleDst->setFieldAmount (sfBalance, saDstAmount);
+        view ().insert (sleDst);
+
+        // The referee's references are rewritten in this view only, they
+        // reach the ledger once with the transaction.
+        auto const ter = addRefer (view (), refereeID, dstAccountID, viewJ);
+        if (ter != tesSUCCESS)
+            return ter;
+    }
+
+    return tesSUCCESS;
+}
+
+} // ripple
@@ -0,0 +1,38 @@
+#ifndef RIPPLE_TX_ACTIVEACCOUNTS_H_INCLUDED
+#define RIPPLE_TX_ACTIVEACCOUNTS_H_INCLUDED
+
+#include <ripple/app/tx/impl/Transactor.h>
+
+namespace ripple {
+
+/** Creates and funds many references of one referee.
+
+    Each reference is created as by ActiveAccount with the same XRP
+    amount, and linked to the referee, in a single transaction.
+*/
+class ActiveAccounts
+    : public Transactor
+{
+public:
+    // References in one transaction
+    static std::size_t const maxReferences = 32;
+
+    ActiveAccounts (ApplyContext& ctx)
+        : Transactor(ctx)
+    {
+    }
+
+    static
+    TER
+    preflight (PreflightContext const& ctx);
+
+    static
+    TER
+    preclaim(PreclaimContext const& ctx);
+
+    TER doApply () override;
+};
+
+} // ripple
+
+#endif
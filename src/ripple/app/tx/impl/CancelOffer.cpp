@@ -73,6 +73,14 @@ CancelOffer::preclaim(PreclaimContext const& ctx)
     return tesSUCCESS;
 }
 
+void
+CancelOffer::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    Transactor::prefetch (tx, keys);
+    keys.push_back (keylet::offer (
+        tx[sfAccount], tx[sfOfferSequence]).key);
+}
+
 //------------------------------------------------------------------------------
 
 TER
@@ -0,0 +1,75 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/impl/CompactAsset.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/UintTypes.h>
+#include <algorithm>
+
+namespace ripple
+{
+
+TER CompactAsset::preflight (PreflightContext const& ctx)
+{
+    if (! (ctx.flags & tapENABLE_TESTING) &&
+        ! ctx.rules.enabled(featureCompactAsset,
+            ctx.app.config().features))
+        return temDISABLED;
+
+    auto const ret = preflight1 (ctx);
+    if (!isTesSuccess (ret))
+        return ret;
+
+    auto lines = ctx.tx.getFieldV256 (sfIndexes).value ();
+    if (lines.empty () || lines.size () > maxLines)
+    {
+        JLOG(ctx.j.trace) << "Malformed transaction: " << lines.size () << " lines.";
+        return temMALFORMED;
+    }
+
+    std::sort (lines.begin (), lines.end ());
+    if (std::adjacent_find (lines.begin (), lines.end ()) != lines.end ())
+    {
+        JLOG(ctx.j.trace) << "Malformed transaction: duplicate lines.";
+        return temMALFORMED;
+    }
+
+    return preflight2(ctx);
+}
+
+TER CompactAsset::doApply ()
+{
+    auto viewJ = ctx_.app.journal("View");
+
+    for (auto const& index : ctx_.tx.getFieldV256 (sfIndexes))
+    {
+        auto sleRippleState = view ().peek (keylet::line (index));
+        if (!sleRippleState ||
+            sleRippleState->getFieldAmount (sfBalance).getCurrency () !=
+                assetCurrency ())
+        {
+            JLOG(j_.trace) << "No ASSET line " << index;
+            return tecNO_LINE;
+        }
+
+        AccountID const uLowAccountID =
+            sleRippleState->getFieldAmount (sfLowLimit).getIssuer ();
+        AccountID const uHighAccountID =
+            sleRippleState->getFieldAmount (sfHighLimit).getIssuer ();
+        if (account_ != uLowAccountID && account_ != uHighAccountID)
+        {
+            JLOG(j_.trace) << "Not a party to line " << index;
+            return tecNO_PERMISSION;
+        }
+
+        auto const ter = assetRelease (view (), uLowAccountID,
+            uHighAccountID, assetCurrency (), sleRippleState, viewJ);
+        if (ter != tesSUCCESS)
+            return ter;
+    }
+
+    return tesSUCCESS;
+}
+
+} // ripple
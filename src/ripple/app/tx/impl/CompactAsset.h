@@ -0,0 +1,35 @@
+#ifndef RIPPLE_TX_COMPACTASSET_H_INCLUDED
+#define RIPPLE_TX_COMPACTASSET_H_INCLUDED
+
+#include <ripple/app/tx/impl/Transactor.h>
+
+namespace ripple {
+
+/** Folds the finished asset states of some ASSET lines of the account.
+
+    Finished states are otherwise only folded into the line's zero state
+    when a transaction happens to move the line's asset, so the states
+    of dormant holders stay in the ledger.
+*/
+class CompactAsset
+    : public Transactor
+{
+public:
+    // Lines in one transaction
+    static std::size_t const maxLines = 32;
+
+    CompactAsset (ApplyContext& ctx)
+        : Transactor(ctx)
+    {
+    }
+
+    static
+    TER
+    preflight (PreflightContext const& ctx);
+
+    TER doApply () override;
+};
+
+} // ripple
+
+#endif
@@ -931,6 +931,27 @@ CreateOffer::applyGuts (ApplyView& view, ApplyView& view_cancel)
     return { result, true };
 }
 
+void
+CreateOffer::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    Transactor::prefetch (tx, keys);
+
+    auto const account = tx[sfAccount];
+    auto const pays = tx[sfTakerPays].issue ();
+    auto const gets = tx[sfTakerGets].issue ();
+
+    // The book the offer crosses and the one it goes into either
+    // start at or lead to the entries next to their bases.
+    keys.push_back (keylet::book (Book (gets, pays)).key);
+    keys.push_back (keylet::book (Book (pays, gets)).key);
+    keys.push_back (keylet::ownerDir (account).key);
+    for (auto const& issue : { pays, gets })
+    {
+        if (! isNative (issue.currency) && issue.account != account)
+            keys.push_back (keylet::line (account, issue).key);
+    }
+}
+
 TER
 CreateOffer::doApply()
 {
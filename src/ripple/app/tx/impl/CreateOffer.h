@@ -53,6 +53,10 @@ public:
     TER
     preclaim(PreclaimContext const& ctx);
 
+    static
+    void
+    prefetch (STTx const& tx, std::vector<uint256>& keys);
+
     void
     preCompute() override;
 
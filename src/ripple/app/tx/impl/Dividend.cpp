@@ -1,10 +1,13 @@
 #include <BeastConfig.h>
 #include <ripple/app/tx/impl/Dividend.h>
+#include <ripple/app/misc/DividendBatch.h>
 #include <ripple/app/misc/DividendMaster.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/protocol/Feature.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/TxFlags.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -30,26 +33,8 @@ Dividend::preflight (PreflightContext const& ctx)
         return temBAD_FEE;
     }
     
-    if (!ctx.tx.isFieldPresent (sfDividendType))
-    {
-        JLOG(ctx.j.warning) << "No dividend type";
-        return temBAD_DIV_TYPE;
-    }
-    if (!ctx.tx.isFieldPresent (sfDividendLedger))
-    {
-        JLOG(ctx.j.warning) << "No dividend ledger";
-        return temINVALID;
-    }
-    if (!ctx.tx.isFieldPresent (sfDividendCoins))
-    {
-        JLOG(ctx.j.warning) << "No dividend coins";
-        return temINVALID;
-    }
-    if (!ctx.tx.isFieldPresent (sfDividendCoinsVBC))
-    {
-        JLOG(ctx.j.warning) << "No dividend coins vbc";
-        return temINVALID;
-    }
+    // The type, ledger and coins are required by the Dividend format, so
+    // a transaction without them could not have been constructed.
     if (!ctx.tx.isFieldPresent (sfDividendVRank))
     {
         JLOG(ctx.j.warning) << "No dividend v rank";
@@ -83,6 +68,19 @@ Dividend::preflight (PreflightContext const& ctx)
         return temBAD_SEQUENCE;
     }
 
+    if (ctx.tx.getFieldU8 (sfDividendType) == DividendMaster::DivType_ApplyBatch)
+    {
+        if (! (ctx.flags & tapENABLE_TESTING) &&
+            ! ctx.rules.enabled(featureDividendBatch,
+                ctx.app.config().features))
+            return temDISABLED;
+
+        // Checked against the hash in the transaction, preclaim compares
+        // that with the hash of the dividend in progress.
+        if (! DividendBatch::verify (ctx.tx, ctx.j))
+            return temINVALID;
+    }
+
     return tesSUCCESS;
 }
 
@@ -136,6 +134,37 @@ TER Dividend::preclaim (PreclaimContext const &ctx)
             return tefBAD_LEDGER;
         }
     }
+    else if (divType == DividendMaster::DivType_ApplyBatch)
+    {
+        auto const sle = ctx.view.read (keylet::dividend ());
+        if (!sle || !sle->isFieldPresent (sfDividendLedger))
+        {
+            JLOG(ctx.j.warning) << "No dividend object or ledger seq";
+            return tefBAD_LEDGER;
+        }
+        auto const dividendLedger = ctx.tx.getFieldU32 (sfDividendLedger);
+        if (dividendLedger != sle->getFieldU32 (sfDividendLedger) ||
+            ctx.tx.getFieldH256 (sfDividendHash) != sle->getFieldH256 (sfDividendHash))
+        {
+            JLOG(ctx.j.warning) << "Dividend ledger or hash mismatch";
+            return tefBAD_LEDGER;
+        }
+
+        // Payees may have been applied one at a time before the batches.
+        auto const& payees = ctx.tx.getFieldArray (sfDividendPayees);
+        if (std::none_of (payees.begin (), payees.end (),
+            [&](STObject const& payee)
+            {
+                auto const accountSLE = ctx.view.read (
+                    keylet::account (payee.getAccountID (sfDestination)));
+                return accountSLE &&
+                    accountSLE->getFieldU32 (sfDividendLedger) != dividendLedger;
+            }))
+        {
+            JLOG(ctx.j.warning) << "Transaction has already applied";
+            return tefBAD_LEDGER;
+        }
+    }
     else if (divType == DividendMaster::DivType_Start)
     {
         if (!ctx.tx.isFieldPresent (sfDividendHash))
@@ -246,8 +275,8 @@ bool Dividend::updateDividendMap ()
     stpTrans.delField (sfTxnSignature);
     stpTrans.add (s2);
     
-    //auto tItem = std::make_shared<SHAMapItem> (mTxn.getSigningHash(), s2.peekData ());
-    auto tItem = std::make_shared<SHAMapItem> (stpTrans.getTransactionID(), s2.peekData ());
+    //auto tItem = make_shamapitem (mTxn.getSigningHash(), s2.peekData ());
+    auto tItem = make_shamapitem (stpTrans.getTransactionID(), s2.peekData ());
     if (!divValidMap->addGiveItem (std::move(tItem), true, false))
     {
         JLOG(ctx.j.warning) << "dividend failed, while adding item to valid map.";
@@ -299,6 +328,50 @@ bool Dividend::updateDividendMap ()
     return true;
 }
 
+void Dividend::credit (SLE::ref sle, STObject const& payee,
+    std::uint32_t dividendLedger)
+{
+    uint64_t divCoinsVBC = payee.getFieldU64 (sfDividendCoinsVBC);
+    uint64_t divCoins = payee.getFieldU64 (sfDividendCoins);
+
+    if (divCoinsVBC > 0)
+    {
+        sle->setFieldAmount (sfBalanceVBC,
+            sle->getFieldAmount (sfBalanceVBC) + divCoinsVBC);
+        ctx_.createVBC (divCoinsVBC);
+    }
+    if (divCoins > 0)
+    {
+        sle->setFieldAmount (sfBalance,
+            sle->getFieldAmount (sfBalance) + divCoins);
+        ctx_.createXRP (divCoins);
+    }
+
+    //Record VSpd, TSpd, DividendLedgerSeq
+    sle->setFieldU32 (sfDividendLedger, dividendLedger);
+
+    if (payee.isFieldPresent (sfDividendVRank))
+    {
+        std::uint64_t divVRank = payee.getFieldU64 (sfDividendVRank);
+        sle->setFieldU64 (sfDividendVRank, divVRank);
+    }
+
+    if (payee.isFieldPresent (sfDividendVSprd))
+    {
+        std::uint64_t divVSpd = payee.getFieldU64 (sfDividendVSprd);
+        sle->setFieldU64 (sfDividendVSprd, divVSpd);
+    }
+
+    if (payee.isFieldPresent (sfDividendTSprd))
+    {
+        std::uint64_t divTSpd = payee.getFieldU64 (sfDividendTSprd);
+        sle->setFieldU64 (sfDividendTSprd, divTSpd);
+    }
+    view ().update(sle);
+
+    JLOG(j_.trace) << "Dividend Applied:" << sle->getText ();
+}
+
 //apply dividend result here
 TER Dividend::applyTx ()
 {
@@ -310,54 +383,11 @@ TER Dividend::applyTx ()
 
     JLOG(j_.trace) << "des account " << account;
 
-    uint64_t divCoinsVBC = tx.getFieldU64 (sfDividendCoinsVBC);
-    uint64_t divCoins = tx.getFieldU64 (sfDividendCoins);
-
     auto sleAccoutModified = view ().peek (keylet::account (account));
 
     if (sleAccoutModified)
     {
-        if (divCoinsVBC > 0)
-        {
-            sleAccoutModified->setFieldAmount (sfBalanceVBC,
-                sleAccoutModified->getFieldAmount (sfBalanceVBC) + divCoinsVBC);
-            ctx_.createVBC (divCoinsVBC);
-        }
-        if (divCoins > 0)
-        {
-            sleAccoutModified->setFieldAmount (sfBalance,
-                sleAccoutModified->getFieldAmount (sfBalance) + divCoins);
-            ctx_.createXRP (divCoins);
-        }
-
-
-        //Record VSpd, TSpd, DividendLedgerSeq
-        if (tx.isFieldPresent (sfDividendLedger))
-        {
-            std::uint32_t divLedgerSeq = tx.getFieldU32 (sfDividendLedger);
-            sleAccoutModified->setFieldU32 (sfDividendLedger, divLedgerSeq);
-
-            if (tx.isFieldPresent (sfDividendVRank))
-            {
-                std::uint64_t divVRank = tx.getFieldU64 (sfDividendVRank);
-                sleAccoutModified->setFieldU64 (sfDividendVRank, divVRank);
-            }
-
-            if (tx.isFieldPresent (sfDividendVSprd))
-            {
-                std::uint64_t divVSpd = tx.getFieldU64 (sfDividendVSprd);
-                sleAccoutModified->setFieldU64 (sfDividendVSprd, divVSpd);
-            }
-
-            if (tx.isFieldPresent (sfDividendTSprd))
-            {
-                std::uint64_t divTSpd = tx.getFieldU64 (sfDividendTSprd);
-                sleAccoutModified->setFieldU64 (sfDividendTSprd, divTSpd);
-            }
-        }
-        view ().update(sleAccoutModified);
-
-        JLOG(j_.trace) << "Dividend Applied:" << sleAccoutModified->getText ();
+        credit (sleAccoutModified, tx, tx.getFieldU32 (sfDividendLedger));
     }
     else
     {
@@ -371,6 +401,46 @@ TER Dividend::applyTx ()
     return tesSUCCESS;
 }
 
+//apply the dividend results of a subtree of the dividend map
+TER Dividend::applyBatch ()
+{
+    auto& tx = ctx_.tx;
+    auto const dividendLedger = tx.getFieldU32 (sfDividendLedger);
+
+    std::size_t credited = 0;
+    for (auto const& payee : tx.getFieldArray (sfDividendPayees))
+    {
+        auto const account = payee.getAccountID (sfDestination);
+        auto sle = view ().peek (keylet::account (account));
+        if (!sle)
+        {
+            // Its transaction would never apply either.
+            JLOG(j_.warning) << "Dividend account not found :" << account;
+            continue;
+        }
+        if (sle->getFieldU32 (sfDividendLedger) == dividendLedger)
+            continue;
+
+        credit (sle, payee, dividendLedger);
+        ++credited;
+    }
+
+    JLOG(j_.debug) << "Dividend batch credited " << credited << " of "
+        << tx.getFieldArray (sfDividendPayees).size () << " accounts";
+    if (credited == 0)
+        return tefBAD_LEDGER;
+
+    // The marker is the last transaction of the map applied.
+    auto const keys = DividendBatch::payeeKeys (tx);
+    if (keys.empty ())
+        return tefFAILURE;
+
+    SLE::pointer dividendObj = view ().peek (keylet::dividend ());
+    dividendObj->setFieldH256 (sfDividendMarker, keys.back ());
+    view ().update (dividendObj);
+    return tesSUCCESS;
+}
+
 //mark as we have done dividend apply
 TER Dividend::doneApply ()
 {
@@ -421,6 +491,10 @@ TER Dividend::doApply ()
         {
             return applyTx ();
         }
+        case DividendMaster::DivType_ApplyBatch:
+        {
+            return applyBatch ();
+        }
         }
     }
     return temUNKNOWN;
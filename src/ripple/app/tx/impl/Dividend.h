@@ -40,9 +40,13 @@ public:
 private:
     TER startCalc ();
     TER applyTx ();
+    TER applyBatch ();
     TER doneApply ();
 
     bool updateDividendMap ();
+
+    void credit (SLE::ref sle, STObject const& payee,
+        std::uint32_t dividendLedger);
 };
 
 } // ripple
@@ -0,0 +1,132 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/impl/FeePolicy.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/Quality.h>
+#include <algorithm>
+#include <limits>
+
+namespace ripple {
+
+XRPAmount
+nativeTransferFee (Config const& config, STAmount const& amount)
+{
+    XRPAmount const minimum = config.FEE_DEFAULT_MIN_NATIVE;
+    auto const rate = static_cast<std::uint64_t> (
+        config.FEE_DEFAULT_RATE_NATIVE);
+    auto const drops = static_cast<std::uint64_t> (
+        amount.xrp ().drops ());
+    std::uint64_t const one = QUALITY_ONE;
+
+    // Rates are parts per QUALITY_ONE. When the product is below the
+    // minimum, or divides exactly, STAmount would give the same drops.
+    if (rate == 0 || drops <= std::numeric_limits<std::uint64_t>::max () / rate)
+    {
+        auto const product = drops * rate;
+        if (product < static_cast<std::uint64_t> (minimum.drops ()) * one)
+            return minimum;
+        if (product % one == 0)
+            return std::max (minimum, XRPAmount (
+                static_cast<std::int64_t> (product / one)));
+    }
+
+    return std::max (multiply (amount, amountFromRate (rate),
+        amount.issue ()), STAmount (config.FEE_DEFAULT_MIN_NATIVE)).xrp ();
+}
+
+std::uint64_t
+calculateFeeCost (Fees const& fees, std::uint64_t baseFee,
+    XRPAmount transferFee)
+{
+    if (transferFee <= zero || fees.base == 0)
+        return baseFee;
+
+    return std::max (baseFee, mulDivNoThrow (
+        static_cast<std::uint64_t> (transferFee.drops ()),
+            fees.units, fees.base));
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+/** Most transactions owe only the reference fee. */
+class ReferenceFeePolicy : public FeePolicy
+{
+public:
+    XRPAmount
+    transferFee (PreclaimContext const&) const override
+    {
+        return zero;
+    }
+};
+
+/** A Payment or ActiveAccount pays for its amount, and for creating the
+    account it sends to.
+*/
+class PaymentFeePolicy : public FeePolicy
+{
+private:
+    SField const& destination_;
+
+public:
+    explicit
+    PaymentFeePolicy (SField const& destination)
+        : destination_ (destination)
+    {
+    }
+
+    XRPAmount
+    transferFee (PreclaimContext const& ctx) const override
+    {
+        auto const& config = ctx.app.config ();
+        XRPAmount fee = zero;
+
+        // The destination does not exist yet, charge a fixed fee for
+        // creating it.
+        if (!ctx.view.exists (keylet::account (
+                ctx.tx.getAccountID (destination_))))
+            fee = config.FEE_DEFAULT_CREATE;
+
+        STAmount const amount (ctx.tx.getFieldAmount (sfAmount));
+        return fee + (amount.native () ?
+            nativeTransferFee (config, amount) :
+            XRPAmount (config.FEE_DEFAULT_NONE_NATIVE));
+    }
+};
+
+/** ActiveAccounts pays for each reference as one ActiveAccount would. */
+class ActiveAccountsFeePolicy : public FeePolicy
+{
+public:
+    XRPAmount
+    transferFee (PreclaimContext const& ctx) const override
+    {
+        auto const& config = ctx.app.config ();
+        XRPAmount const feeEach = config.FEE_DEFAULT_CREATE +
+            nativeTransferFee (config, ctx.tx.getFieldAmount (sfAmount));
+        return feeEach.drops () * static_cast<std::int64_t> (
+            ctx.tx.getFieldArray (sfReferences).size ());
+    }
+};
+
+} // detail
+
+FeePolicy const&
+feePolicy (TxType txType)
+{
+    static detail::ReferenceFeePolicy const reference;
+    static detail::PaymentFeePolicy const payment (sfDestination);
+    static detail::PaymentFeePolicy const activation (sfReference);
+    static detail::ActiveAccountsFeePolicy const activations;
+
+    switch (txType)
+    {
+    case ttPAYMENT:         return payment;
+    case ttACTIVEACCOUNT:   return activation;
+    case ttACTIVE_ACCOUNTS: return activations;
+    default:                return reference;
+    }
+}
+
+} // ripple
@@ -0,0 +1,59 @@
+#ifndef RIPPLE_TX_FEEPOLICY_H_INCLUDED
+#define RIPPLE_TX_FEEPOLICY_H_INCLUDED
+
+#include <ripple/app/tx/impl/Transactor.h>
+#include <ripple/core/Config.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/TxFormats.h>
+#include <ripple/protocol/XRPAmount.h>
+#include <cstdint>
+
+namespace ripple {
+
+/** Decides what a transaction owes beyond the reference fee.
+
+    Every transaction pays at least the reference fee scaled by the load.
+    Payments and activations instead pay for what they move and create:
+    1/1000 of a native amount with a floor, a flat fee for other
+    currencies, and a fee for each account created. That part is not
+    scaled by the load; the transaction pays the larger of the two.
+*/
+class FeePolicy
+{
+public:
+    virtual ~FeePolicy () = default;
+
+    /** Returns the drops owed for transfers and account creation. */
+    virtual
+    XRPAmount
+    transferFee (PreclaimContext const& ctx) const = 0;
+};
+
+/** Returns the policy that prices transactions of a type. */
+FeePolicy const&
+feePolicy (TxType txType);
+
+/** Returns the fee owed on moving a native amount.
+
+    This is the amount at the configured rate, but no less than the
+    configured minimum. Amounts that price exactly skip the STAmount
+    arithmetic.
+*/
+XRPAmount
+nativeTransferFee (Config const& config, STAmount const& amount);
+
+/** Returns the cost, in fee units, a transaction's fee level is measured
+    against.
+
+    This is the base fee, or the transfer fee converted to fee units when
+    that is larger, so that the TxQ ranks transactions by what they paid
+    per unit of what they owe.
+*/
+std::uint64_t
+calculateFeeCost (Fees const& fees, std::uint64_t baseFee,
+    XRPAmount transferFee);
+
+} // ripple
+
+#endif
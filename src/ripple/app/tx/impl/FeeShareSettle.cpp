@@ -0,0 +1,151 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/impl/FeeShareSettle.h>
+#include <ripple/app/misc/FeeShareSettlement.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+
+namespace ripple {
+
+TER
+FeeShareSettle::preflight (PreflightContext const& ctx)
+{
+    if (! (ctx.flags & tapENABLE_TESTING) &&
+        ! ctx.rules.enabled(featureFeeShareAccrual,
+            ctx.app.config().features))
+        return temDISABLED;
+
+    auto const ret = preflight0 (ctx);
+    if (!isTesSuccess (ret))
+        return ret;
+
+    if (ctx.tx.getAccountID (sfAccount) != zero)
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: Bad source id";
+        return temBAD_SRC_ACCOUNT;
+    }
+
+    auto const fee = ctx.tx.getFieldAmount (sfFee);
+    if (!fee.native () || fee != beast::zero)
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: invalid fee";
+        return temBAD_FEE;
+    }
+
+    if (!ctx.tx.getSigningPubKey ().empty () ||
+        !ctx.tx.getSignature ().empty () ||
+        ctx.tx.isFieldPresent (sfSigners))
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: Bad signature";
+        return temBAD_SIGNATURE;
+    }
+
+    if (ctx.tx.getSequence () != 0 || ctx.tx.isFieldPresent (sfPreviousTxnID))
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: Bad sequence";
+        return temBAD_SEQUENCE;
+    }
+
+    // Validators sort the totals, so there is only one transaction for
+    // a set of accruals
+    if (ctx.tx.isFieldPresent (sfFeeShareTakers) &&
+        ! FeeShareSettlement::isCanonical (
+            ctx.tx.getFieldArray (sfFeeShareTakers)))
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: Bad shares";
+        return temMALFORMED;
+    }
+
+    return tesSUCCESS;
+}
+
+TER
+FeeShareSettle::preclaim (PreclaimContext const& ctx)
+{
+    if (ctx.view.open())
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle transaction against open ledger";
+        return temINVALID;
+    }
+
+    auto const sle = ctx.view.read (keylet::feeShareAccrual ());
+    if (! sle)
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: nothing accrued";
+        return tefFAILURE;
+    }
+
+    // The range starts after the last ledger settled and ends at the
+    // parent of this one at the latest
+    auto const settled = sle->getFieldU32 (sfLedgerSequence);
+    auto const through = ctx.tx.getFieldU32 (sfLedgerSequence);
+    if (through <= settled || through >= ctx.view.seq () ||
+        through - settled > FeeShareSettlement::maxLedgers)
+    {
+        JLOG(ctx.j.warning) << "FeeShareSettle: Bad range " <<
+            settled << " to " << through;
+        return tefFAILURE;
+    }
+
+    return tesSUCCESS;
+}
+
+void
+FeeShareSettle::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    keys.push_back (keylet::feeShareAccrual ().key);
+    if (! tx.isFieldPresent (sfFeeShareTakers))
+        return;
+    for (auto const& share : tx.getFieldArray (sfFeeShareTakers))
+    {
+        auto const taker = share.getAccountID (sfAccount);
+        auto const& issue = share.getFieldAmount (sfAmount).issue ();
+        keys.push_back (keylet::account (taker).key);
+        keys.push_back (keylet::line (taker, issue).key);
+    }
+}
+
+void
+FeeShareSettle::preCompute ()
+{
+    account_ = ctx_.tx.getAccountID (sfAccount);
+    assert (account_ == zero);
+}
+
+TER
+FeeShareSettle::doApply ()
+{
+    auto const viewJ = ctx_.app.journal ("View");
+    auto const sle = view().peek (keylet::feeShareAccrual ());
+    if (! sle)
+        return tefFAILURE;
+
+    std::size_t credited = 0;
+    if (ctx_.tx.isFieldPresent (sfFeeShareTakers))
+    {
+        for (auto const& share : ctx_.tx.getFieldArray (sfFeeShareTakers))
+        {
+            auto const taker = share.getAccountID (sfAccount);
+            auto const& amount = share.getFieldAmount (sfAmount);
+            if (taker == amount.getIssuer ())
+                continue;
+
+            auto const ter = rippleCredit (view(),
+                amount.getIssuer (), taker, amount, false, viewJ);
+            if (ter != tesSUCCESS)
+                return ter;
+            ++credited;
+        }
+    }
+
+    sle->setFieldU32 (sfLedgerSequence,
+        ctx_.tx.getFieldU32 (sfLedgerSequence));
+    view().update (sle);
+
+    JLOG(j_.debug) << "FeeShareSettle: credited " << credited <<
+        " shares through ledger " << ctx_.tx.getFieldU32 (sfLedgerSequence);
+    return tesSUCCESS;
+}
+
+} // ripple
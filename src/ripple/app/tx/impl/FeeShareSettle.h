@@ -0,0 +1,49 @@
+#ifndef RIPPLE_TX_FEESHARESETTLE_H_INCLUDED
+#define RIPPLE_TX_FEESHARESETTLE_H_INCLUDED
+
+#include <ripple/app/tx/impl/Transactor.h>
+
+namespace ripple {
+
+/** Credits the fee shares accrued by earlier ledgers.
+
+    A pseudo-transaction every validator proposes from the last closed
+    ledger, see FeeShareSettlement. Each listed share is credited by its
+    issuer, and the FeeShareAccrual entry moves to the last ledger
+    settled, so no accrual is credited twice.
+*/
+class FeeShareSettle
+    : public Transactor
+{
+public:
+    FeeShareSettle (ApplyContext& ctx)
+        : Transactor(ctx)
+    {
+    }
+
+    static
+    TER
+    preflight (PreflightContext const& ctx);
+
+    static
+    TER
+    preclaim (PreclaimContext const& ctx);
+
+    static
+    std::uint64_t
+    calculateBaseFee (PreclaimContext const& ctx)
+    {
+        return 0;
+    }
+
+    static
+    void
+    prefetch (STTx const& tx, std::vector<uint256>& keys);
+
+    TER doApply () override;
+    void preCompute () override;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,117 @@
+#include <BeastConfig.h>
+#include <ripple/app/tx/impl/OfferPurge.h>
+#include <ripple/app/misc/DeadOffers.h>
+#include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+#include <algorithm>
+
+namespace ripple {
+
+TER
+OfferPurge::preflight (PreflightContext const& ctx)
+{
+    if (! (ctx.flags & tapENABLE_TESTING) &&
+        ! ctx.rules.enabled(featureOfferPurge,
+            ctx.app.config().features))
+        return temDISABLED;
+
+    auto const ret = preflight0 (ctx);
+    if (!isTesSuccess (ret))
+        return ret;
+
+    if (ctx.tx.getAccountID (sfAccount) != zero)
+    {
+        JLOG(ctx.j.warning) << "OfferPurge: Bad source id";
+        return temBAD_SRC_ACCOUNT;
+    }
+
+    auto const fee = ctx.tx.getFieldAmount (sfFee);
+    if (!fee.native () || fee != beast::zero)
+    {
+        JLOG(ctx.j.warning) << "OfferPurge: invalid fee";
+        return temBAD_FEE;
+    }
+
+    if (!ctx.tx.getSigningPubKey ().empty () ||
+        !ctx.tx.getSignature ().empty () ||
+        ctx.tx.isFieldPresent (sfSigners))
+    {
+        JLOG(ctx.j.warning) << "OfferPurge: Bad signature";
+        return temBAD_SIGNATURE;
+    }
+
+    if (ctx.tx.getSequence () != 0 || ctx.tx.isFieldPresent (sfPreviousTxnID))
+    {
+        JLOG(ctx.j.warning) << "OfferPurge: Bad sequence";
+        return temBAD_SEQUENCE;
+    }
+
+    // Validators list the offers in key order, so there is only one
+    // transaction for a set of offers
+    auto const& offers = ctx.tx.getFieldV256 (sfIndexes);
+    if (offers.empty () || offers.size () > DeadOffers::maxOffers ||
+        std::adjacent_find (offers.begin (), offers.end (),
+            [](uint256 const& a, uint256 const& b)
+            {
+                return ! (a < b);
+            }) != offers.end ())
+    {
+        JLOG(ctx.j.warning) << "OfferPurge: Bad offers";
+        return temMALFORMED;
+    }
+
+    return tesSUCCESS;
+}
+
+TER
+OfferPurge::preclaim (PreclaimContext const& ctx)
+{
+    if (ctx.view.open())
+    {
+        JLOG(ctx.j.warning) << "OfferPurge transaction against open ledger";
+        return temINVALID;
+    }
+    return tesSUCCESS;
+}
+
+void
+OfferPurge::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    if (! tx.isFieldPresent (sfIndexes))
+        return;
+    for (auto const& offer : tx.getFieldV256 (sfIndexes))
+        keys.push_back (keylet::offer (offer).key);
+}
+
+void
+OfferPurge::preCompute ()
+{
+    account_ = ctx_.tx.getAccountID (sfAccount);
+    assert (account_ == zero);
+}
+
+TER
+OfferPurge::doApply ()
+{
+    auto const viewJ = ctx_.app.journal ("View");
+    auto const when = view().parentCloseTime();
+    std::size_t removed = 0;
+    for (auto const& index : ctx_.tx.getFieldV256 (sfIndexes))
+    {
+        // A transaction before this one may have taken or changed it
+        auto const sle = view().peek (keylet::offer (index));
+        if (! sle || ! DeadOffers::isDead (view(), *sle, when, viewJ))
+            continue;
+
+        offerDelete (view(), sle, viewJ);
+        ++removed;
+    }
+
+    JLOG(j_.debug) << "OfferPurge: removed " << removed << " of " <<
+        ctx_.tx.getFieldV256 (sfIndexes).size () << " offers";
+    return tesSUCCESS;
+}
+
+} // ripple
@@ -0,0 +1,48 @@
+#ifndef RIPPLE_TX_OFFERPURGE_H_INCLUDED
+#define RIPPLE_TX_OFFERPURGE_H_INCLUDED
+
+#include <ripple/app/tx/impl/Transactor.h>
+
+namespace ripple {
+
+/** Removes offers no taker could cross.
+
+    A pseudo-transaction every validator proposes from the last closed
+    ledger, see DeadOffers. Each listed offer is checked again and only
+    removed if it is still dead, as a taker stepping over it would.
+*/
+class OfferPurge
+    : public Transactor
+{
+public:
+    OfferPurge (ApplyContext& ctx)
+        : Transactor(ctx)
+    {
+    }
+
+    static
+    TER
+    preflight (PreflightContext const& ctx);
+
+    static
+    TER
+    preclaim (PreclaimContext const& ctx);
+
+    static
+    std::uint64_t
+    calculateBaseFee (PreclaimContext const& ctx)
+    {
+        return 0;
+    }
+
+    static
+    void
+    prefetch (STTx const& tx, std::vector<uint256>& keys);
+
+    TER doApply () override;
+    void preCompute () override;
+};
+
+} // ripple
+
+#endif
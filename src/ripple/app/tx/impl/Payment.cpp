@@ -21,6 +21,7 @@
 #include <ripple/app/tx/impl/Payment.h>
 #include <ripple/app/paths/RippleCalc.h>
 #include <ripple/basics/Log.h>
+#include <ripple/ledger/View.h>
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/JsonFields.h>
 
@@ -311,6 +312,26 @@ Payment::preclaim(PreclaimContext const& ctx)
     return tesSUCCESS;
 }
 
+void
+Payment::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    Transactor::prefetch (tx, keys);
+
+    auto const account = tx[sfAccount];
+    auto const destination = tx[sfDestination];
+    keys.push_back (keylet::account (destination).key);
+
+    // The lines of a direct IOU payment
+    auto const amount = tx[sfAmount];
+    if (isNative (amount))
+        return;
+    auto const& issuer = amount.getIssuer ();
+    keys.push_back (keylet::account (issuer).key);
+    if (account != issuer)
+        keys.push_back (keylet::line (account, amount.issue ()).key);
+    if (destination != issuer)
+        keys.push_back (keylet::line (destination, amount.issue ()).key);
+}
 
 TER
 Payment::doApply ()
@@ -458,19 +479,17 @@ Payment::doApply ()
         {
             // The source account does have enough money, so do the
             // arithmetic for the transfer and make the ledger change.
+            auto const drops = saDstAmount.xrp ();
+            auto const sleSrc = view().peek(keylet::account(account_));
             if (!isVBCTransaction)
             {
-                view().peek(keylet::account(account_))->setFieldAmount (sfBalance,
-                    mSourceBalance - saDstAmount);
-                sleDst->setFieldAmount (sfBalance,
-                    sleDst->getFieldAmount (sfBalance) + saDstAmount);
+                sleSrc->setFieldAmount (sfBalance, mSourceBalance - drops);
+                adjustNativeBalance (*sleDst, sfBalance, drops);
             }
             else
             {
-                view().peek(keylet::account(account_))->setFieldAmount (sfBalanceVBC,
-                    sle->getFieldAmount (sfBalanceVBC) - saDstAmount);
-                sleDst->setFieldAmount (sfBalanceVBC,
-                    sleDst->getFieldAmount (sfBalanceVBC) + saDstAmount);
+                adjustNativeBalance (*sleSrc, sfBalanceVBC, -drops);
+                adjustNativeBalance (*sleDst, sfBalanceVBC, drops);
             }
 
             // Re-arm the password change fee if we can and need to.
@@ -130,6 +130,19 @@ SetTrust::preclaim(PreclaimContext const& ctx)
     return tesSUCCESS;
 }
 
+void
+SetTrust::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    Transactor::prefetch (tx, keys);
+
+    auto const limit = tx[sfLimitAmount];
+    auto const& issuer = limit.getIssuer ();
+    keys.push_back (keylet::account (issuer).key);
+    keys.push_back (keylet::line (
+        tx[sfAccount], issuer, limit.getCurrency ()).key);
+    keys.push_back (keylet::ownerDir (tx[sfAccount]).key);
+}
+
 TER
 SetTrust::doApply ()
 {
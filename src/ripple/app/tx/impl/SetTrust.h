@@ -45,6 +45,10 @@ public:
     TER
     preclaim(PreclaimContext const& ctx);
 
+    static
+    void
+    prefetch (STTx const& tx, std::vector<uint256>& keys);
+
     TER doApply () override;
 };
 
@@ -100,32 +100,6 @@ calculateFee(Application& app, std::uint64_t const baseFee,
         baseFee, fees.base, fees.units, flags & tapUNLIMITED);
 }
 
-XRPAmount
-calculateFeeForPayment(PreclaimContext const& ctx, Application& app, std::uint64_t const baseFee,
-    Fees const& fees, ApplyFlags flags)
-{
-    XRPAmount feeDue = calculateFee (app, baseFee, fees, flags);
-
-    XRPAmount feeByTrans = 0;
-
-    AccountID const uDstAccountID (ctx.tx.getAccountID (ctx.tx.getTxnType () == ttACTIVEACCOUNT ? sfReference : sfDestination));
-
-    //dst account not exist yet, charge a fix amount of fee(0.01) for creating
-    if (!ctx.view.exists (keylet::account (uDstAccountID)))
-    {
-        feeByTrans = app.config ().FEE_DEFAULT_CREATE;
-    }
-
-    //if currency is native(VRP/VBC), charge 1/1000 of transfer amount,
-    //otherwise charge a fix amount of fee(0.001)
-    STAmount const amount (ctx.tx.getFieldAmount (sfAmount));
-    feeByTrans += amount.native () ?
-                      std::max (multiply (amount, amountFromRate (app.config ().FEE_DEFAULT_RATE_NATIVE), amount.issue ()), STAmount (app.config ().FEE_DEFAULT_MIN_NATIVE)).xrp () :
-                      app.config ().FEE_DEFAULT_NONE_NATIVE;
-
-    return std::max (feeDue, feeByTrans);
-}
-
 //------------------------------------------------------------------------------
 
 PreflightContext::PreflightContext(Application& app_, STTx const& tx_,
@@ -148,6 +122,13 @@ Transactor::Transactor(
 {
 }
 
+void Transactor::prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    auto const id = tx.getAccountID (sfAccount);
+    if (id != zero)
+        keys.push_back (keylet::account (id).key);
+}
+
 std::uint64_t Transactor::calculateBaseFee (
     PreclaimContext const& ctx)
 {
@@ -168,17 +149,15 @@ std::uint64_t Transactor::calculateBaseFee (
 }
 
 TER
-Transactor::checkFee (PreclaimContext const& ctx, std::uint64_t baseFee)
+Transactor::checkFee (PreclaimContext const& ctx, std::uint64_t baseFee,
+    XRPAmount transferFee)
 {
     auto const feePaid = ctx.tx[sfFee].xrp ();
     if (!isLegalAmount (feePaid) || feePaid < beast::zero)
         return temBAD_FEE;
 
-    auto const txType = ctx.tx.getTxnType ();
-
-    auto const feeDue = (txType == ttPAYMENT || txType == ttACTIVEACCOUNT) ?
-                            calculateFeeForPayment (ctx, ctx.app, baseFee, ctx.view.fees (), ctx.flags) :
-                            calculateFee (ctx.app, baseFee, ctx.view.fees (), ctx.flags);
+    auto const feeDue = std::max (transferFee, calculateFee (
+        ctx.app, baseFee, ctx.view.fees (), ctx.flags));
 
     // Only check fee is sufficient when the ledger is open.
     if (ctx.view.open() && feePaid < feeDue)
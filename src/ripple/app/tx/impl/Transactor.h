@@ -111,9 +111,11 @@ public:
     TER
     checkSeq (PreclaimContext const& ctx);
 
+    // transferFee is what the FeePolicy charges besides the base fee.
     static
     TER
-    checkFee (PreclaimContext const& ctx, std::uint64_t baseFee);
+    checkFee (PreclaimContext const& ctx, std::uint64_t baseFee,
+        XRPAmount transferFee);
 
     static
     TER
@@ -133,6 +135,12 @@ public:
         // after checkSeq/Fee/Sign.
         return tesSUCCESS;
     }
+
+    // Adds the keys of the state entries the transaction is likely
+    // to read, known from the transaction alone, for prefetching.
+    static
+    void
+    prefetch (STTx const& tx, std::vector<uint256>& keys);
     /////////////////////////////////////////////////////
 
 protected:
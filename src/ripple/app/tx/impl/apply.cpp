@@ -90,6 +90,37 @@ checkValidity(HashRouter& router,
     return checkValidity(router, tx, allowMultiSign);
 }
 
+std::vector<std::pair<Validity, std::string>>
+checkValidity(HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        Rules const& rules, Config const& config)
+{
+    auto const allowMultiSign =
+        rules.enabled(featureMultiSign, config.features);
+
+    // Check the signatures nobody knows the state of together
+    std::vector<std::shared_ptr<STTx const>> unknown;
+    for (auto const& tx : txs)
+    {
+        auto const flags = router.getFlags(tx->getTransactionID());
+        if (!(flags & (SF_SIGBAD | SF_SIGGOOD)))
+            unknown.push_back(tx);
+    }
+    if (!unknown.empty())
+    {
+        auto const good = checkSignBatch(unknown, allowMultiSign);
+        for (std::size_t i = 0; i < unknown.size(); ++i)
+            router.setFlags(unknown[i]->getTransactionID(),
+                good[i] ? SF_SIGGOOD : SF_SIGBAD);
+    }
+
+    std::vector<std::pair<Validity, std::string>> result;
+    result.reserve(txs.size());
+    for (auto const& tx : txs)
+        result.push_back(checkValidity(router, *tx, allowMultiSign));
+    return result;
+}
+
 void
 forceValidity(HashRouter& router, uint256 const& txid,
     Validity validity)
@@ -25,6 +25,9 @@
 #include <ripple/app/tx/impl/Change.h>
 #include <ripple/app/tx/impl/CreateOffer.h>
 #include <ripple/app/tx/impl/CreateTicket.h>
+#include <ripple/app/tx/impl/OfferPurge.h>
+#include <ripple/app/tx/impl/FeeShareSettle.h>
+#include <ripple/app/tx/impl/FeePolicy.h>
 #include <ripple/app/tx/impl/Payment.h>
 #include <ripple/app/tx/impl/SetAccount.h>
 #include <ripple/app/tx/impl/SetRegularKey.h>
@@ -34,41 +37,14 @@
 
 #include <ripple/app/tx/impl/AddReferee.h>
 #include <ripple/app/tx/impl/ActiveAccount.h>
+#include <ripple/app/tx/impl/ActiveAccounts.h>
 #include <ripple/app/tx/impl/Dividend.h>
 #include <ripple/app/tx/impl/IssueAsset.h>
+#include <ripple/app/tx/impl/CompactAsset.h>
 
-namespace ripple {
+#include <array>
 
-static
-TER
-invoke_preflight (PreflightContext const& ctx)
-{
-    switch(ctx.tx.getTxnType())
-    {
-    case ttDIVIDEND:        return Dividend         ::preflight(ctx);
-    case ttADDREFEREE:      return AddReferee       ::preflight(ctx);
-    case ttISSUE:           return IssueAsset       ::preflight(ctx);
-    case ttACTIVEACCOUNT:   return ActiveAccount    ::preflight(ctx);
-
-    case ttACCOUNT_SET:     return SetAccount       ::preflight(ctx);
-    case ttOFFER_CANCEL:    return CancelOffer      ::preflight(ctx);
-    case ttOFFER_CREATE:    return CreateOffer      ::preflight(ctx);
-    case ttPAYMENT:         return Payment          ::preflight(ctx);
-    case ttSUSPAY_CREATE:   return SusPayCreate     ::preflight(ctx);
-    case ttSUSPAY_FINISH:   return SusPayFinish     ::preflight(ctx);
-    case ttSUSPAY_CANCEL:   return SusPayCancel     ::preflight(ctx);
-    case ttREGULAR_KEY_SET: return SetRegularKey    ::preflight(ctx);
-    case ttSIGNER_LIST_SET: return SetSignerList    ::preflight(ctx);
-    case ttTICKET_CANCEL:   return CancelTicket     ::preflight(ctx);
-    case ttTICKET_CREATE:   return CreateTicket     ::preflight(ctx);
-    case ttTRUST_SET:       return SetTrust         ::preflight(ctx);
-    case ttAMENDMENT:
-    case ttFEE:             return Change           ::preflight(ctx);
-    default:
-        assert(false);
-        return temUNKNOWN;
-    }
-}
+namespace ripple {
 
 /* invoke_preclaim<T> uses name hiding to accomplish
     compile-time polymorphism of (presumably) static
@@ -76,7 +52,7 @@ invoke_preflight (PreflightContext const& ctx)
 */
 template<class T>
 static
-std::pair<TER, std::uint64_t>
+PreclaimResult
 invoke_preclaim(PreclaimContext const& ctx)
 {
     // If the transactor requires a valid account and the transaction doesn't
@@ -89,122 +65,173 @@ invoke_preclaim(PreclaimContext const& ctx)
         result = T::checkSeq(ctx);
 
         if (result != tesSUCCESS)
-            return { result, baseFee };
+            return { ctx, result, baseFee };
 
-        result = T::checkFee(ctx, baseFee);
+        // The policy is consulted once, for both the fee
+        // check and the cost the TxQ ranks by.
+        auto const transferFee =
+            feePolicy(ctx.tx.getTxnType()).transferFee(ctx);
+        auto const feeCost = calculateFeeCost(
+            ctx.view.fees(), baseFee, transferFee);
+
+        result = T::checkFee(ctx, baseFee, transferFee);
 
         if (result != tesSUCCESS)
-            return { result, baseFee };
+            return { ctx, result, baseFee, feeCost };
 
         result = T::checkSign(ctx);
 
         if (result != tesSUCCESS)
-            return { result, baseFee };
+            return { ctx, result, baseFee, feeCost };
 
         result = T::preclaim(ctx);
 
         if (result != tesSUCCESS)
-            return{ result, baseFee };
+            return { ctx, result, baseFee, feeCost };
+
+        return { ctx, tesSUCCESS, baseFee, feeCost };
     }
-    else
+
+    return { ctx, tesSUCCESS, baseFee };
+}
+
+template<class T>
+static
+std::pair<TER, bool>
+invoke_apply (ApplyContext& ctx)
+{
+    T p(ctx);
+    return p();
+}
+
+namespace {
+
+// The steps of applying one type of transaction
+struct TransactorSteps
+{
+    TER (*preflight) (PreflightContext const&);
+    PreclaimResult (*preclaim) (PreclaimContext const&);
+    std::uint64_t (*calculateBaseFee) (PreclaimContext const&);
+    std::pair<TER, bool> (*apply) (ApplyContext&);
+    void (*prefetch) (STTx const&, std::vector<uint256>&);
+};
+
+// Like invoke_preclaim<T>, these pick the functions of T by name hiding
+template<class T>
+TransactorSteps const&
+stepsFor ()
+{
+    static TransactorSteps const steps {
+        &T::preflight,
+        &invoke_preclaim<T>,
+        &T::calculateBaseFee,
+        &invoke_apply<T>,
+        &T::prefetch };
+    return steps;
+}
+
+} // anonymous namespace
+
+// Returns the steps for a transaction type, or nullptr if it is unknown
+static
+TransactorSteps const*
+findSteps (TxType type)
+{
+    using Table = std::array<TransactorSteps const*, 256>;
+    static Table const table = []
     {
-        result = tesSUCCESS;
-    }
+        Table t;
+        t.fill (nullptr);
+        t[ttDIVIDEND]           = &stepsFor<Dividend>();
+        t[ttADDREFEREE]         = &stepsFor<AddReferee>();
+        t[ttISSUE]              = &stepsFor<IssueAsset>();
+        t[ttCOMPACT_ASSET]      = &stepsFor<CompactAsset>();
+        t[ttACTIVEACCOUNT]      = &stepsFor<ActiveAccount>();
+        t[ttACTIVE_ACCOUNTS]    = &stepsFor<ActiveAccounts>();
+        t[ttOFFER_PURGE]        = &stepsFor<OfferPurge>();
+        t[ttFEE_SHARE_SETTLE]   = &stepsFor<FeeShareSettle>();
+
+        t[ttACCOUNT_SET]        = &stepsFor<SetAccount>();
+        t[ttOFFER_CANCEL]       = &stepsFor<CancelOffer>();
+        t[ttOFFER_CREATE]       = &stepsFor<CreateOffer>();
+        t[ttPAYMENT]            = &stepsFor<Payment>();
+        t[ttSUSPAY_CREATE]      = &stepsFor<SusPayCreate>();
+        t[ttSUSPAY_FINISH]      = &stepsFor<SusPayFinish>();
+        t[ttSUSPAY_CANCEL]      = &stepsFor<SusPayCancel>();
+        t[ttREGULAR_KEY_SET]    = &stepsFor<SetRegularKey>();
+        t[ttSIGNER_LIST_SET]    = &stepsFor<SetSignerList>();
+        t[ttTICKET_CANCEL]      = &stepsFor<CancelTicket>();
+        t[ttTICKET_CREATE]      = &stepsFor<CreateTicket>();
+        t[ttTRUST_SET]          = &stepsFor<SetTrust>();
+        t[ttAMENDMENT]          = &stepsFor<Change>();
+        t[ttFEE]                = &stepsFor<Change>();
+        return t;
+    }();
 
-    return { tesSUCCESS, baseFee };
+    if (type < 0 || static_cast<std::size_t> (type) >= table.size ())
+        return nullptr;
+    return table[type];
 }
 
 static
-std::pair<TER, std::uint64_t>
+TER
+invoke_preflight (PreflightContext const& ctx)
+{
+    auto const steps = findSteps (ctx.tx.getTxnType());
+    if (! steps)
+    {
+        assert(false);
+        return temUNKNOWN;
+    }
+    return steps->preflight(ctx);
+}
+
+static
+PreclaimResult
 invoke_preclaim (PreclaimContext const& ctx)
 {
-    switch(ctx.tx.getTxnType())
+    auto const steps = findSteps (ctx.tx.getTxnType());
+    if (! steps)
     {
-    case ttDIVIDEND:        return invoke_preclaim<Dividend>(ctx);
-    case ttADDREFEREE:      return invoke_preclaim<AddReferee>(ctx);
-    case ttISSUE:           return invoke_preclaim<IssueAsset>(ctx);
-    case ttACTIVEACCOUNT:   return invoke_preclaim<ActiveAccount>(ctx);
-
-    case ttACCOUNT_SET:     return invoke_preclaim<SetAccount>(ctx);
-    case ttOFFER_CANCEL:    return invoke_preclaim<CancelOffer>(ctx);
-    case ttOFFER_CREATE:    return invoke_preclaim<CreateOffer>(ctx);
-    case ttPAYMENT:         return invoke_preclaim<Payment>(ctx);
-    case ttSUSPAY_CREATE:   return invoke_preclaim<SusPayCreate>(ctx);
-    case ttSUSPAY_FINISH:   return invoke_preclaim<SusPayFinish>(ctx);
-    case ttSUSPAY_CANCEL:   return invoke_preclaim<SusPayCancel>(ctx);
-    case ttREGULAR_KEY_SET: return invoke_preclaim<SetRegularKey>(ctx);
-    case ttSIGNER_LIST_SET: return invoke_preclaim<SetSignerList>(ctx);
-    case ttTICKET_CANCEL:   return invoke_preclaim<CancelTicket>(ctx);
-    case ttTICKET_CREATE:   return invoke_preclaim<CreateTicket>(ctx);
-    case ttTRUST_SET:       return invoke_preclaim<SetTrust>(ctx);
-    case ttAMENDMENT:
-    case ttFEE:             return invoke_preclaim<Change>(ctx);
-    default:
         assert(false);
-        return { temUNKNOWN, 0 };
+        return { ctx, temUNKNOWN, 0 };
     }
+    return steps->preclaim(ctx);
 }
 
 static
 std::uint64_t
 invoke_calculateBaseFee(PreclaimContext const& ctx)
 {
-    switch (ctx.tx.getTxnType())
+    auto const steps = findSteps (ctx.tx.getTxnType());
+    if (! steps)
     {
-    case ttDIVIDEND:        return Dividend::calculateBaseFee(ctx);
-    case ttADDREFEREE:      return AddReferee::calculateBaseFee(ctx);
-    case ttISSUE:           return IssueAsset::calculateBaseFee(ctx);
-    case ttACTIVEACCOUNT:   return ActiveAccount::calculateBaseFee(ctx);
-
-    case ttACCOUNT_SET:     return SetAccount::calculateBaseFee(ctx);
-    case ttOFFER_CANCEL:    return CancelOffer::calculateBaseFee(ctx);
-    case ttOFFER_CREATE:    return CreateOffer::calculateBaseFee(ctx);
-    case ttPAYMENT:         return Payment::calculateBaseFee(ctx);
-    case ttSUSPAY_CREATE:   return SusPayCreate::calculateBaseFee(ctx);
-    case ttSUSPAY_FINISH:   return SusPayFinish::calculateBaseFee(ctx);
-    case ttSUSPAY_CANCEL:   return SusPayCancel::calculateBaseFee(ctx);
-    case ttREGULAR_KEY_SET: return SetRegularKey::calculateBaseFee(ctx);
-    case ttSIGNER_LIST_SET: return SetSignerList::calculateBaseFee(ctx);
-    case ttTICKET_CANCEL:   return CancelTicket::calculateBaseFee(ctx);
-    case ttTICKET_CREATE:   return CreateTicket::calculateBaseFee(ctx);
-    case ttTRUST_SET:       return SetTrust::calculateBaseFee(ctx);
-    case ttAMENDMENT:
-    case ttFEE:             return Change::calculateBaseFee(ctx);
-    default:
         assert(false);
         return 0;
     }
+    return steps->calculateBaseFee(ctx);
 }
 
 static
 std::pair<TER, bool>
 invoke_apply (ApplyContext& ctx)
 {
-    switch(ctx.tx.getTxnType())
+    auto const steps = findSteps (ctx.tx.getTxnType());
+    if (! steps)
     {
-    case ttDIVIDEND:        { Dividend      p(ctx); return p(); }
-    case ttADDREFEREE:      { AddReferee    p(ctx); return p(); }
-    case ttISSUE:           { IssueAsset    p(ctx); return p(); }
-    case ttACTIVEACCOUNT:   { ActiveAccount p(ctx); return p(); }
-
-    case ttACCOUNT_SET:     { SetAccount    p(ctx); return p(); }
-    case ttOFFER_CANCEL:    { CancelOffer   p(ctx); return p(); }
-    case ttOFFER_CREATE:    { CreateOffer   p(ctx); return p(); }
-    case ttPAYMENT:         { Payment       p(ctx); return p(); }
-    case ttSUSPAY_CREATE:   { SusPayCreate  p(ctx); return p(); }
-    case ttSUSPAY_FINISH:   { SusPayFinish  p(ctx); return p(); }
-    case ttSUSPAY_CANCEL:   { SusPayCancel  p(ctx); return p(); }
-    case ttREGULAR_KEY_SET: { SetRegularKey p(ctx); return p(); }
-    case ttSIGNER_LIST_SET: { SetSignerList p(ctx); return p(); }
-    case ttTICKET_CANCEL:   { CancelTicket  p(ctx); return p(); }
-    case ttTICKET_CREATE:   { CreateTicket  p(ctx); return p(); }
-    case ttTRUST_SET:       { SetTrust      p(ctx); return p(); }
-    case ttAMENDMENT:
-    case ttFEE:             { Change        p(ctx); return p(); }
-    default:
         assert(false);
         return { temUNKNOWN, false };
     }
+    return steps->apply(ctx);
+}
+
+static
+void
+invoke_prefetch (STTx const& tx, std::vector<uint256>& keys)
+{
+    if (auto const steps = findSteps (tx.getTxnType()))
+        return steps->prefetch(tx, keys);
+    Transactor::prefetch(tx, keys);
 }
 
 PreflightResult
@@ -249,7 +276,7 @@ preclaim (PreflightResult const& preflightResult,
     {
         if (ctx->preflightResult != tesSUCCESS)
             return { *ctx, ctx->preflightResult, 0 };
-        return{ *ctx, invoke_preclaim(*ctx) };
+        return invoke_preclaim(*ctx);
     }
     catch (std::exception const& e)
     {
@@ -270,6 +297,19 @@ calculateBaseFee(Application& app, ReadView const& view,
     return invoke_calculateBaseFee(ctx);
 }
 
+std::uint64_t
+calculateFeeCost(Application& app, ReadView const& view,
+    STTx const& tx, beast::Journal j)
+{
+    PreclaimContext const ctx(
+        app, view, tesSUCCESS, tx,
+            tapNONE, j);
+
+    return calculateFeeCost(view.fees(),
+        invoke_calculateBaseFee(ctx),
+            feePolicy(tx.getTxnType()).transferFee(ctx));
+}
+
 std::pair<TER, bool>
 doApply(PreclaimResult const& preclaimResult,
     Application& app, OpenView& view)
@@ -293,7 +333,13 @@ doApply(PreclaimResult const& preclaimResult,
             JLOG (preclaimResult.j.warning) << "transaction duplicates!";
             return {tefALREADY, false};
         }
-        return invoke_apply(ctx);
+        auto const result = invoke_apply(ctx);
+        // Dividend transactions have their own lane in the
+        // open ledger, see TxQ.
+        if (result.second && view.open() &&
+                ctx.tx.getTxnType() == ttDIVIDEND)
+            view.addExempt();
+        return result;
     }
     catch (std::exception const& e)
     {
@@ -303,4 +349,19 @@ doApply(PreclaimResult const& preclaimResult,
     }
 }
 
+std::vector<uint256>
+prefetchKeys(STTx const& tx)
+{
+    std::vector<uint256> keys;
+    try
+    {
+        invoke_prefetch(tx, keys);
+    }
+    catch (std::exception const&)
+    {
+        // Preflight rejects the transaction later
+    }
+    return keys;
+}
+
 } // ripple
\ No newline at end of file
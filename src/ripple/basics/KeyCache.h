@@ -26,6 +26,7 @@
 #include <beast/chrono/chrono_io.h>
 #include <beast/Insight.h>
 #include <mutex>
+#include <utility>
 
 namespace ripple {
 
@@ -162,6 +163,19 @@ public:
         m_target_size = s;
     }
 
+    size_type getTargetSize () const
+    {
+        lock_guard lock (m_mutex);
+        return m_target_size;
+    }
+
+    /** Return the number of hits, then of misses. */
+    std::pair <std::uint64_t, std::uint64_t> getHitsAndMisses () const
+    {
+        lock_guard lock (m_mutex);
+        return std::make_pair (m_stats.hits, m_stats.misses);
+    }
+
     void setTargetAge (size_type s)
     {
         lock_guard lock (m_mutex);
@@ -24,8 +24,11 @@
 #include <beast/utility/ci_char_traits.h>
 #include <beast/utility/Journal.h>
 #include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 namespace ripple {
@@ -126,6 +129,9 @@ private:
         */
         void writeln (char const* text);
 
+        /** Flush what was written to the log file. */
+        void flush ();
+
         /** Write to the log file using std::string. */
         /** @{ */
         void write (std::string const& str)
@@ -147,11 +153,30 @@ private:
     std::mutex mutable mutex_;
     std::map <std::string, Sink, beast::ci_less> sinks_;
     beast::Journal::Severity level_;
+
+    // Held while writing to the file and the console
+    std::mutex fileMutex_;
     File file_;
 
+    // Lines waiting for the writer thread, when there is one
+    std::mutex mutable queueMutex_;
+    std::condition_variable queueCond_;
+    std::condition_variable writtenCond_;
+    std::string queue_;
+    std::size_t queueLimit_ = 0;
+    std::uint64_t queued_ = 0;
+    std::uint64_t written_ = 0;
+    std::uint64_t dropped_ = 0;
+    std::uint64_t totalDropped_ = 0;
+    bool queueing_ = false;
+    std::thread thread_;
+
 public:
     Logs();
 
+    /** Write the lines which are still waiting, and stop the writer. */
+    ~Logs();
+
     Logs (Logs const&) = delete;
     Logs& operator= (Logs const&) = delete;
 
@@ -183,6 +208,21 @@ public:
     std::string
     rotate();
 
+    /** Write the log on a thread of its own.
+        A line is then formatted by the thread logging it and added to a
+        queue, and the writer thread writes the waiting lines together.
+        When the queue holds `bytes` or more, lines less severe than
+        errors are dropped and counted instead of making the logging
+        thread wait for the disk. Fatal lines wait until they are written.
+        Calling this again only changes the limit.
+    */
+    void
+    queue (std::size_t bytes);
+
+    /** The number of lines dropped because the queue was full. */
+    std::uint64_t
+    dropped () const;
+
 public:
     static
     LogSeverity
@@ -201,6 +241,14 @@ public:
     fromString (std::string const& s);
 
 private:
+    // Write lines, which each end with a newline
+    void
+    writeLines (std::string const& lines);
+
+    // The writer thread
+    void
+    run ();
+
     enum
     {
         // Maximum line length for log messages.
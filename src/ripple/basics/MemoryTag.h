@@ -0,0 +1,296 @@
+#ifndef RIPPLE_BASICS_MEMORYTAG_H_INCLUDED
+#define RIPPLE_BASICS_MEMORYTAG_H_INCLUDED
+
+#include <beast/insight/Collector.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** The live bytes held by one kind of object.
+
+    Tags are made once, as function local statics, and live until the
+    program ends. The bytes of every tag are reported by get_counts and
+    as insight gauges, next to the object counts of CountedObject.
+*/
+class MemoryTag
+{
+public:
+    explicit
+    MemoryTag (char const* name);
+
+    MemoryTag (MemoryTag const&) = delete;
+    MemoryTag& operator= (MemoryTag const&) = delete;
+
+    char const*
+    name () const
+    {
+        return name_;
+    }
+
+    std::int64_t
+    bytes () const noexcept
+    {
+        return bytes_.load (std::memory_order_relaxed);
+    }
+
+    void
+    add (std::int64_t bytes) noexcept
+    {
+        bytes_.fetch_add (bytes, std::memory_order_relaxed);
+    }
+
+    using List = std::vector <std::pair <std::string, std::int64_t>>;
+
+    /** The bytes of every tag, by name. */
+    static
+    List
+    getBytes ();
+
+private:
+    char const* name_;
+    std::atomic <std::int64_t> bytes_;
+    MemoryTag* next_;
+};
+
+//------------------------------------------------------------------------------
+
+/** Charges bytes to a tag for the lifetime of the object holding it.
+
+    For objects whose storage is not allocated through a TaggedAllocator,
+    with the size of the storage when it is made.
+*/
+class MemoryCharge
+{
+public:
+    MemoryCharge (MemoryTag& tag, std::size_t bytes) noexcept
+        : tag_ (&tag)
+        , bytes_ (bytes)
+    {
+        tag_->add (bytes_);
+    }
+
+    MemoryCharge (MemoryCharge const& other) noexcept
+        : MemoryCharge (*other.tag_, other.bytes_)
+    {
+    }
+
+    MemoryCharge&
+    operator= (MemoryCharge const& other) noexcept
+    {
+        other.tag_->add (other.bytes_);
+        tag_->add (-bytes_);
+        tag_ = other.tag_;
+        bytes_ = other.bytes_;
+        return *this;
+    }
+
+    ~MemoryCharge ()
+    {
+        tag_->add (-bytes_);
+    }
+
+    /** Charge more bytes, for storage made later. */
+    void
+    add (std::size_t bytes) noexcept
+    {
+        bytes_ += bytes;
+        tag_->add (bytes);
+    }
+
+private:
+    MemoryTag* tag_;
+    std::int64_t bytes_;
+};
+
+//------------------------------------------------------------------------------
+
+/** Standard allocator charging the storage of a container to a tag. */
+template <class T, MemoryTag& (*Tag) ()>
+class TaggedAllocator
+{
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = TaggedAllocator <U, Tag>;
+    };
+
+    TaggedAllocator () = default;
+
+    template <class U>
+    TaggedAllocator (TaggedAllocator <U, Tag> const&) noexcept
+    {
+    }
+
+    T*
+    allocate (std::size_t n)
+    {
+        auto const p = std::allocator <T> ().allocate (n);
+        Tag ().add (n * sizeof (T));
+        return p;
+    }
+
+    void
+    deallocate (T* p, std::size_t n) noexcept
+    {
+        Tag ().add (-static_cast<std::int64_t> (n * sizeof (T)));
+        std::allocator <T> ().deallocate (p, n);
+    }
+
+    template <class U>
+    bool
+    operator== (TaggedAllocator <U, Tag> const&) const noexcept
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!= (TaggedAllocator <U, Tag> const&) const noexcept
+    {
+        return false;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/** The objects made by make_shared_inline. */
+struct InlineCounts
+{
+    std::uint64_t objects;
+
+    // Bytes saved against a Blob with its own heap block in every object
+    std::uint64_t bytesSaved () const;
+
+    static
+    InlineCounts
+    get ();
+};
+
+namespace detail {
+
+std::atomic <std::int64_t>&
+inlineObjects ();
+
+/** Allocates the block of make_shared_inline, charging it to a tag.
+
+    The payload follows the shared count and the object in the block.
+*/
+template <class T, MemoryTag& (*Tag) ()>
+class InlineAllocator
+{
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = InlineAllocator <U, Tag>;
+    };
+
+    InlineAllocator (std::size_t bytes, std::uint8_t** payload) noexcept
+        : bytes_ (bytes)
+        , payload_ (payload)
+    {
+    }
+
+    template <class U>
+    InlineAllocator (InlineAllocator <U, Tag> const& other) noexcept
+        : bytes_ (other.bytes_)
+        , payload_ (other.payload_)
+    {
+    }
+
+    T*
+    allocate (std::size_t n)
+    {
+        auto const p = static_cast <std::uint8_t*> (
+            ::operator new (n * sizeof (T) + bytes_));
+        *payload_ = p + n * sizeof (T);
+        Tag ().add (n * sizeof (T) + bytes_);
+        ++inlineObjects ();
+        return reinterpret_cast <T*> (p);
+    }
+
+    void
+    deallocate (T* p, std::size_t n) noexcept
+    {
+        --inlineObjects ();
+        Tag ().add (-static_cast<std::int64_t> (n * sizeof (T) + bytes_));
+        ::operator delete (p);
+    }
+
+    template <class U>
+    bool
+    operator== (InlineAllocator <U, Tag> const& other) const noexcept
+    {
+        return bytes_ == other.bytes_;
+    }
+
+    template <class U>
+    bool
+    operator!= (InlineAllocator <U, Tag> const& other) const noexcept
+    {
+        return ! (*this == other);
+    }
+
+private:
+    template <class, MemoryTag& (*) ()>
+    friend class InlineAllocator;
+
+    std::size_t bytes_;
+    // Only used by allocate, while make_shared_inline runs
+    std::uint8_t** payload_;
+};
+
+}
+
+/** Make a shared object and its payload in a single heap block.
+
+    The block holds the shared count, the object and `bytes` of payload,
+    and is charged to the tag. The object is constructed with a reference
+    to the payload pointer, which is set before the constructor runs,
+    followed by args.
+*/
+template <class T, MemoryTag& (*Tag) (), class... Args>
+std::shared_ptr <T>
+make_shared_inline (std::size_t bytes, Args&&... args)
+{
+    std::uint8_t* payload = nullptr;
+    return std::allocate_shared <T> (
+        detail::InlineAllocator <T, Tag> (bytes, &payload),
+            static_cast <std::uint8_t* const&> (payload),
+                std::forward <Args> (args)...);
+}
+
+//------------------------------------------------------------------------------
+
+/** Insight gauges of the bytes of every tag, set when they are collected. */
+class MemoryGauges
+{
+public:
+    explicit
+    MemoryGauges (beast::insight::Collector::ptr const& collector);
+
+private:
+    void
+    collect ();
+
+    beast::insight::Collector::ptr collector_;
+    std::mutex mutex_;
+    std::map <std::string, beast::insight::Gauge> gauges_;
+    beast::insight::Hook hook_;
+};
+
+} // ripple
+
+#endif
@@ -21,13 +21,20 @@
 #define RIPPLE_BASICS_RANGESET_H_INCLUDED
 
 #include <cstdint>
-#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
-/** A sparse set of integers. */
-// VFALCO TODO Replace with juce::SparseSet
+/** A sparse set of integers.
+
+    The set is kept as a sorted vector of disjoint closed intervals, so
+    lookups are binary searches over contiguous memory. The rendered
+    string is cached until the set next changes; because toString fills
+    the cache, a set read from several threads at once must have been
+    rendered before it is shared.
+*/
 class RangeSet
 {
 public:
@@ -54,7 +61,14 @@ public:
 
     void clearValue (std::uint32_t);
 
-    std::string toString () const;
+    std::string const& toString () const;
+
+    /** Returns the number of disjoint ranges in the set. */
+    std::size_t
+    ranges () const
+    {
+        return mRanges.size ();
+    }
 
     /** Returns the sum of the Lebesgue measures of all sub-ranges. */
     std::size_t
@@ -67,23 +81,31 @@ public:
     void checkInternalConsistency () const noexcept;
 
 private:
-    void simplify ();
+    // First is lowest value in range, second is highest value in range
+    using Range = std::pair <std::uint32_t, std::uint32_t>;
+    using Ranges = std::vector <Range>;
 
-private:
-    using Map = std::map <std::uint32_t, std::uint32_t>;
+    using const_iterator = Ranges::const_iterator;
+    using iterator       = Ranges::iterator;
 
-    using const_iterator         = Map::const_iterator;
-    using const_reverse_iterator = Map::const_reverse_iterator;
-    using value_type             = Map::value_type;
-    using iterator               = Map::iterator;
+    static bool contains (Range const& range, std::uint32_t v)
+    {
+        return (range.first <= v) && (range.second >= v);
+    }
 
-    static bool contains (value_type const& it, std::uint32_t v)
+    // The first range that ends at or after the value
+    const_iterator find (std::uint32_t v) const;
+
+    void changed ()
     {
-        return (it.first <= v) && (it.second >= v);
+        mRendered = false;
+        checkInternalConsistency ();
     }
 
-    // First is lowest value in range, last is highest value in range
-    Map mRanges;
+    Ranges mRanges;
+
+    mutable std::string mString;
+    mutable bool mRendered = false;
 };
 
 } // ripple
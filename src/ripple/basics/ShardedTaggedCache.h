@@ -0,0 +1,259 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+#define RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+
+#include <ripple/basics/TaggedCache.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ripple {
+
+/** Selects the shard of a key from its first two bytes.
+    Meant for keys which are hashes, such as uint256.
+*/
+struct KeyBitsShardSelector
+{
+    template <class Key>
+    std::size_t
+    operator() (Key const& key) const
+    {
+        auto const p = key.begin ();
+        return static_cast<std::size_t> (p[0]) |
+            (static_cast<std::size_t> (p[1]) << 8);
+    }
+};
+
+/** A TaggedCache split in shards, each with its own lock.
+
+    A key always goes to the same shard, which keeps its own recently
+    used entries and sweeps them on its own. The target size is divided
+    among the shards. The sizes and the hit rate are those of all the
+    shards together.
+*/
+template <
+    class Key,
+    class T,
+    std::size_t Shards = 16,
+    class Hash = hardened_hash <>,
+    class KeyEqual = std::equal_to <Key>,
+    class Mutex = std::recursive_mutex,
+    class ShardSelector = KeyBitsShardSelector
+>
+class ShardedTaggedCache
+{
+public:
+    using shard_type = TaggedCache <Key, T, Hash, KeyEqual, Mutex>;
+    using key_type = Key;
+    using mapped_type = T;
+    using weak_mapped_ptr = typename shard_type::weak_mapped_ptr;
+    using mapped_ptr = typename shard_type::mapped_ptr;
+    using clock_type = typename shard_type::clock_type;
+
+    static_assert (Shards > 0, "A cache needs a shard");
+
+    ShardedTaggedCache (std::string const& name, int size,
+        typename clock_type::rep expiration_seconds, clock_type& clock, beast::Journal journal,
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New ())
+        : m_clock (clock)
+        , m_stats (name,
+            std::bind (&ShardedTaggedCache::collect_metrics, this),
+                collector)
+    {
+        for (auto& shard : m_shards)
+            shard = std::make_unique <shard_type> (name, shardSize (size),
+                expiration_seconds, clock, journal);
+    }
+
+    /** Return the clock associated with the cache. */
+    clock_type& clock ()
+    {
+        return m_clock;
+    }
+
+    int getTargetSize () const
+    {
+        return sum ([](shard_type const& shard) { return shard.getTargetSize (); });
+    }
+
+    void setTargetSize (int s)
+    {
+        for (auto& shard : m_shards)
+            shard->setTargetSize (shardSize (s));
+    }
+
+    typename clock_type::rep getTargetAge () const
+    {
+        return m_shards.front ()->getTargetAge ();
+    }
+
+    void setTargetAge (typename clock_type::rep s)
+    {
+        for (auto& shard : m_shards)
+            shard->setTargetAge (s);
+    }
+
+    int getCacheSize () const
+    {
+        return sum ([](shard_type const& shard) { return shard.getCacheSize (); });
+    }
+
+    int getTrackSize () const
+    {
+        return sum ([](shard_type const& shard) { return shard.getTrackSize (); });
+    }
+
+    float getHitRate ()
+    {
+        auto const stats = getHitsAndMisses ();
+        auto const total = static_cast<float> (stats.first + stats.second);
+        return stats.first * (100.0f / std::max (1.0f, total));
+    }
+
+    /** Return the number of hits, then of misses, over all the shards. */
+    std::pair <std::uint64_t, std::uint64_t> getHitsAndMisses () const
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        for (auto const& shard : m_shards)
+        {
+            auto const stats = shard->getHitsAndMisses ();
+            hits += stats.first;
+            misses += stats.second;
+        }
+        return std::make_pair (hits, misses);
+    }
+
+    void clearStats ()
+    {
+        for (auto& shard : m_shards)
+            shard->clearStats ();
+    }
+
+    void clear ()
+    {
+        for (auto& shard : m_shards)
+            shard->clear ();
+    }
+
+    void sweep ()
+    {
+        for (auto& shard : m_shards)
+            shard->sweep ();
+    }
+
+    bool del (const key_type& key, bool valid)
+    {
+        return shard (key).del (key, valid);
+    }
+
+    /** @see TaggedCache::canonicalize */
+    bool canonicalize (const key_type& key, std::shared_ptr<T>& data, bool replace = false)
+    {
+        return shard (key).canonicalize (key, data, replace);
+    }
+
+    std::shared_ptr<T> fetch (const key_type& key)
+    {
+        return shard (key).fetch (key);
+    }
+
+    bool insert (key_type const& key, T const& value)
+    {
+        return shard (key).insert (key, value);
+    }
+
+    bool retrieve (const key_type& key, T& data)
+    {
+        return shard (key).retrieve (key, data);
+    }
+
+    bool refreshIfPresent (const key_type& key)
+    {
+        return shard (key).refreshIfPresent (key);
+    }
+
+    std::vector <key_type> getKeys ()
+    {
+        std::vector <key_type> v;
+        for (auto& shard : m_shards)
+        {
+            auto keys = shard->getKeys ();
+            v.insert (v.end (), keys.begin (), keys.end ());
+        }
+        return v;
+    }
+
+private:
+    static int shardSize (int size)
+    {
+        // 0 means no target, any other target keeps at least one entry
+        return (size + static_cast<int> (Shards) - 1) / static_cast<int> (Shards);
+    }
+
+    shard_type& shard (key_type const& key)
+    {
+        return *m_shards[ShardSelector () (key) % Shards];
+    }
+
+    template <class Function>
+    int sum (Function f) const
+    {
+        int result = 0;
+        for (auto const& shard : m_shards)
+            result += f (*shard);
+        return result;
+    }
+
+    void collect_metrics ()
+    {
+        m_stats.size.set (getCacheSize ());
+        m_stats.hit_rate.set (
+            static_cast<beast::insight::Gauge::value_type> (getHitRate ()));
+    }
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats (std::string const& prefix, Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge (prefix, "size"))
+            , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    clock_type& m_clock;
+    std::array <std::unique_ptr <shard_type>, Shards> m_shards;
+
+    // Last, so the hook goes away before the shards.
+    Stats m_stats;
+};
+
+}
+
+#endif
@@ -62,20 +62,10 @@ inline static std::string sqlEscape (Blob const& vecSrc)
 
     std::string j (size * 2 + 3, 0);
 
-    unsigned char* oPtr = reinterpret_cast<unsigned char*> (&*j.begin ());
-    const unsigned char* iPtr = &vecSrc[0];
-
-    *oPtr++ = 'X';
-    *oPtr++ = '\'';
-
-    for (int i = size; i != 0; --i)
-    {
-        unsigned char c = *iPtr++;
-        *oPtr++ = charHex (c >> 4);
-        *oPtr++ = charHex (c & 15);
-    }
-
-    *oPtr++ = '\'';
+    j[0] = 'X';
+    j[1] = '\'';
+    hexEncode (&j[2], vecSrc.data (), size);
+    j[size * 2 + 2] = '\'';
     return j;
 }
 
@@ -25,8 +25,10 @@
 #include <beast/chrono/abstract_clock.h>
 #include <beast/chrono/chrono_io.h>
 #include <beast/Insight.h>
+#include <algorithm>
 #include <functional>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 namespace ripple {
@@ -146,6 +148,13 @@ public:
         return m_hits * (100.0f / std::max (1.0f, total));
     }
 
+    /** Return the number of hits, then of misses. */
+    std::pair <std::uint64_t, std::uint64_t> getHitsAndMisses () const
+    {
+        lock_guard lock (m_mutex);
+        return std::make_pair (m_hits, m_misses);
+    }
+
     void clearStats ()
     {
         lock_guard lock (m_mutex);
@@ -160,21 +169,23 @@ public:
         m_cache_count = 0;
     }
 
+    /** Remove the entries which have expired.
+
+        The map is swept a few buckets at a time, and the lock is released
+        between them, so fetches are not held up while a large map is
+        swept. An entry which a rehash moves meanwhile may be skipped and
+        is then swept the next time.
+    */
     void sweep ()
     {
         int cacheRemovals = 0;
         int mapRemovals = 0;
-        int cc = 0;
+        std::size_t size = 0;
 
-        // Keep references to all the stuff we sweep
-        // so that we can destroy them outside the lock.
-        //
-        std::vector <mapped_ptr> stuffToSweep;
+        clock_type::time_point const now (m_clock.now());
+        clock_type::time_point when_expire;
 
         {
-            clock_type::time_point const now (m_clock.now());
-            clock_type::time_point when_expire;
-
             lock_guard lock (m_mutex);
 
             if (m_target_size == 0 ||
@@ -196,59 +207,72 @@ public:
                     m_name << " is growing fast " << m_cache.size () << " of " << m_target_size <<
                         " aging at " << (now - when_expire) << " of " << m_target_age;
             }
+        }
 
-            stuffToSweep.reserve (m_cache.size ());
-
-            cache_iterator cit = m_cache.begin ();
+        // Keep references to all the stuff we sweep
+        // so that we can destroy them outside the lock.
+        //
+        std::vector <mapped_ptr> stuffToSweep;
+        std::vector <key_type> keysToErase;
 
-            while (cit != m_cache.end ())
+        for (std::size_t bucket = 0;;)
+        {
             {
-                if (cit->second.isWeak ())
+                lock_guard lock (m_mutex);
+
+                auto const buckets = m_cache.bucket_count ();
+                if (bucket >= buckets)
                 {
-                    // weak
-                    if (cit->second.isExpired ())
-                    {
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        ++cit;
-                    }
+                    size = m_cache.size ();
+                    break;
                 }
-                else if (cit->second.last_access <= when_expire)
+
+                auto const last = std::min (buckets, bucket + sweepBuckets);
+                for (; bucket < last; ++bucket)
                 {
-                    // strong, expired
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique ())
-                    {
-                        stuffToSweep.push_back (cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
+                    for (auto cit = m_cache.begin (bucket);
+                        cit != m_cache.end (bucket); ++cit)
                     {
-                        // remains weakly cached
-                        cit->second.ptr.reset ();
-                        ++cit;
+                        if (cit->second.isWeak ())
+                        {
+                            // weak
+                            if (cit->second.isExpired ())
+                                keysToErase.push_back (cit->first);
+                        }
+                        else if (cit->second.last_access <= when_expire)
+                        {
+                            // strong, expired
+                            --m_cache_count;
+                            ++cacheRemovals;
+                            if (cit->second.ptr.unique ())
+                            {
+                                stuffToSweep.push_back (cit->second.ptr);
+                                keysToErase.push_back (cit->first);
+                            }
+                            else
+                            {
+                                // remains weakly cached
+                                cit->second.ptr.reset ();
+                            }
+                        }
                     }
                 }
-                else
-                {
-                    // strong, not expired
-                    ++cc;
-                    ++cit;
-                }
+
+                mapRemovals += keysToErase.size ();
+                for (auto const& key : keysToErase)
+                    m_cache.erase (key);
             }
+
+            keysToErase.clear ();
+
+            // Outside the lock, decrement the reference count on each
+            // strong pointer.
+            stuffToSweep.clear ();
         }
 
         if (m_journal.trace && (mapRemovals || cacheRemovals)) m_journal.trace <<
-            m_name << ": cache = " << m_cache.size () << "-" << cacheRemovals <<
+            m_name << ": cache = " << size << "-" << cacheRemovals <<
                 ", map-=" << mapRemovals;
-
-        // At this point stuffToSweep will go out of scope outside the lock
-        // and decrement the reference count on each strong pointer.
     }
 
     bool del (const key_type& key, bool valid)
@@ -545,6 +569,9 @@ private:
     using cache_type = hardened_hash_map <key_type, Entry, Hash, KeyEqual>;
     using cache_iterator = typename cache_type::iterator;
 
+    // The buckets swept each time the lock is taken
+    static std::size_t const sweepBuckets = 1024;
+
     beast::Journal m_journal;
     clock_type& m_clock;
     Stats m_stats;
@@ -0,0 +1,41 @@
+#ifndef RIPPLE_BASICS_THREADAFFINITY_H_INCLUDED
+#define RIPPLE_BASICS_THREADAFFINITY_H_INCLUDED
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** A set of processors, in ascending order without duplicates. */
+using CpuSet = std::vector<unsigned>;
+
+/** Parse a list of processors such as "0-3,8,10-11".
+
+    Throws std::runtime_error if the list is malformed.
+*/
+CpuSet
+parseCpuSet (std::string const& s);
+
+/** Format a set of processors the way parseCpuSet reads it. */
+std::string
+to_string (CpuSet const& cpus);
+
+/** Restrict the calling thread to a set of processors.
+
+    Nothing is done for an empty set. Memory a thread touches first is
+    placed on the NUMA node it runs on, so a thread kept on the
+    processors of one node also keeps the caches it fills local.
+
+    @return `false` if the platform or the kernel refused.
+*/
+bool
+setCurrentThreadAffinity (CpuSet const& cpus);
+
+/** Restrict a running thread to a set of processors. */
+bool
+setThreadAffinity (std::thread& thread, CpuSet const& cpus);
+
+} // ripple
+
+#endif
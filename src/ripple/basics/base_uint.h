@@ -31,6 +31,7 @@
 #include <ripple/basics/hardened_hash.h>
 #include <beast/utility/Zero.h>
 #include <boost/functional/hash.hpp>
+#include <cstring>
 #include <functional>
 #include <type_traits>
 
@@ -318,24 +319,11 @@ public:
     */
     bool SetHexExact (const char* psz)
     {
-        unsigned char* pOut  = begin ();
+        // The string must hold exactly as many digits as we need
+        if (std::strlen (psz) != 2 * sizeof (pn))
+            return false;
 
-        for (int i = 0; i < sizeof (pn); ++i)
-        {
-            auto hi = charUnHex(*psz++);
-            if (hi == -1)
-                return false;
-
-            auto lo = charUnHex (*psz++);
-            if (lo == -1)
-                return false;
-
-            *pOut++ = (hi << 4) | lo;
-        }
-
-        // We've consumed exactly as many bytes as we needed at this point
-        // so we should be at the end of the string.
-        return (*psz == 0);
+        return hexDecode (begin (), psz, sizeof (pn));
     }
 
     /** Parse a hex string into a base_uint
@@ -380,18 +368,9 @@ public:
         if ((pEnd - pBegin) & 1)
             *pOut++ = charUnHex(*pBegin++);
 
-        while (pBegin != pEnd)
-        {
-            auto cHigh = charUnHex(*pBegin++);
-            auto cLow  = pBegin == pEnd
-                            ? 0
-                            : charUnHex(*pBegin++);
-
-            if (cHigh == -1 || cLow == -1)
-                return false;
-
-            *pOut++ = (cHigh << 4) | cLow;
-        }
+        // Every character up to the end is a digit
+        hexDecode (pOut, reinterpret_cast<char const*> (pBegin),
+            (pEnd - pBegin) / 2);
 
         return !*pEnd;
     }
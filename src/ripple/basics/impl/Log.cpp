@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/basics/Log.h>
+#include <beast/threads/Thread.h>
 #include <boost/algorithm/string.hpp>
 // VFALCO TODO Use std::chrono
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -108,6 +109,12 @@ void Logs::File::writeln (char const* text)
     }
 }
 
+void Logs::File::flush ()
+{
+    if (m_stream != nullptr)
+        m_stream->flush ();
+}
+
 //------------------------------------------------------------------------------
 
 Logs::Logs()
@@ -115,9 +122,21 @@ Logs::Logs()
 {
 }
 
+Logs::~Logs()
+{
+    {
+        std::lock_guard <std::mutex> lock (queueMutex_);
+        queueing_ = false;
+    }
+    queueCond_.notify_all ();
+    if (thread_.joinable ())
+        thread_.join ();
+}
+
 bool
 Logs::open (boost::filesystem::path const& pathToLogFile)
 {
+    std::lock_guard <std::mutex> lock (fileMutex_);
     return file_.open(pathToLogFile);
 }
 
@@ -176,9 +195,26 @@ Logs::write (beast::Journal::Severity level, std::string const& partition,
 {
     std::string s;
     format (s, text, level, partition);
-    std::lock_guard <std::mutex> lock (mutex_);
-    file_.writeln (s);
-    std::cerr << s << '\n';
+    s += '\n';
+    {
+        std::unique_lock <std::mutex> lock (queueMutex_);
+        if (queueing_)
+        {
+            if (queue_.size () >= queueLimit_ &&
+                level < beast::Journal::kError)
+            {
+                ++dropped_;
+                return;
+            }
+            queue_ += s;
+            auto const line = ++queued_;
+            queueCond_.notify_one ();
+            if (level >= beast::Journal::kFatal)
+                writtenCond_.wait (lock, [&] { return written_ >= line; });
+            return;
+        }
+    }
+    writeLines (s);
     // VFALCO TODO Fix console output
     //if (console)
     //    out_.write_console(s);
@@ -187,13 +223,83 @@ Logs::write (beast::Journal::Severity level, std::string const& partition,
 std::string
 Logs::rotate()
 {
-    std::lock_guard <std::mutex> lock (mutex_);
+    std::lock_guard <std::mutex> lock (fileMutex_);
     bool const wasOpened = file_.closeAndReopen ();
     if (wasOpened)
         return "The log file was closed and reopened.";
     return "The log file could not be closed and reopened.";
 }
 
+void
+Logs::queue (std::size_t bytes)
+{
+    std::lock_guard <std::mutex> lock (queueMutex_);
+    queueLimit_ = bytes;
+    if (! thread_.joinable ())
+    {
+        queueing_ = true;
+        thread_ = std::thread (&Logs::run, this);
+    }
+}
+
+std::uint64_t
+Logs::dropped () const
+{
+    std::lock_guard <std::mutex> lock (queueMutex_);
+    return totalDropped_ + dropped_;
+}
+
+void
+Logs::writeLines (std::string const& lines)
+{
+    std::lock_guard <std::mutex> lock (fileMutex_);
+    file_.write (lines);
+    file_.flush ();
+    std::cerr << lines;
+}
+
+void
+Logs::run ()
+{
+    beast::Thread::setCurrentThreadName ("Logs");
+
+    std::string lines;
+    std::unique_lock <std::mutex> lock (queueMutex_);
+    for (;;)
+    {
+        queueCond_.wait (lock, [this]
+        {
+            return ! queueing_ || ! queue_.empty () || dropped_ != 0;
+        });
+        if (queue_.empty () && dropped_ == 0)
+            break;
+
+        // The emptied buffer is given back, so the queue keeps its memory
+        lines.swap (queue_);
+        auto const line = queued_;
+        auto const dropped = dropped_;
+        totalDropped_ += dropped;
+        dropped_ = 0;
+        lock.unlock ();
+
+        if (dropped != 0)
+        {
+            std::string s;
+            format (s, std::to_string (dropped) +
+                " lines were dropped because the log queue was full",
+                    beast::Journal::kWarning, "Logs");
+            lines += s;
+            lines += '\n';
+        }
+        writeLines (lines);
+        lines.clear ();
+
+        lock.lock ();
+        written_ = line;
+        writtenCond_.notify_all ();
+    }
+}
+
 LogSeverity
 Logs::fromSeverity (beast::Journal::Severity level)
 {
@@ -305,8 +411,11 @@ Logs::format (std::string& output, std::string const& message,
     output = boost::posix_time::to_simple_string (
         boost::posix_time::second_clock::universal_time ());
 
-    output += boost::str( boost::format(" <%X>") % std::this_thread::get_id());
-    
+    // Formatting the thread ID is slow, so each thread does it once
+    static thread_local std::string const thread = boost::str (
+        boost::format (" <%X>") % std::this_thread::get_id ());
+    output += thread;
+
     if (! partition.empty ())
         output += partition + ":";
 
@@ -0,0 +1,93 @@
+#include <BeastConfig.h>
+#include <ripple/basics/MemoryTag.h>
+#include <algorithm>
+#include <functional>
+
+namespace ripple {
+
+namespace {
+
+// Tags are never destroyed, so the list only grows at the front.
+std::atomic <MemoryTag*>&
+head ()
+{
+    static std::atomic <MemoryTag*> instance (nullptr);
+    return instance;
+}
+
+}
+
+MemoryTag::MemoryTag (char const* name)
+    : name_ (name)
+    , bytes_ (0)
+{
+    auto& list = head ();
+    MemoryTag* first = list.load ();
+    do
+    {
+        next_ = first;
+    }
+    while (! list.compare_exchange_weak (first, this));
+}
+
+MemoryTag::List
+MemoryTag::getBytes ()
+{
+    List result;
+    for (auto tag = head ().load (); tag != nullptr; tag = tag->next_)
+        result.emplace_back (tag->name (), tag->bytes ());
+    std::sort (result.begin (), result.end ());
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+std::atomic <std::int64_t>&
+inlineObjects ()
+{
+    static std::atomic <std::int64_t> instance (0);
+    return instance;
+}
+
+}
+
+std::uint64_t
+InlineCounts::bytesSaved () const
+{
+    // The vector and the bookkeeping of a separate block, on common
+    // 64 bit heaps
+    return objects * (sizeof (std::vector <std::uint8_t>) + 2 * sizeof (void*));
+}
+
+InlineCounts
+InlineCounts::get ()
+{
+    return { static_cast <std::uint64_t> (
+        std::max <std::int64_t> (detail::inlineObjects ().load (), 0)) };
+}
+
+//------------------------------------------------------------------------------
+
+MemoryGauges::MemoryGauges (beast::insight::Collector::ptr const& collector)
+    : collector_ (collector)
+    , hook_ (collector->make_hook (std::bind (&MemoryGauges::collect, this)))
+{
+}
+
+void
+MemoryGauges::collect ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    for (auto const& entry : MemoryTag::getBytes ())
+    {
+        auto iter = gauges_.find (entry.first);
+        if (iter == gauges_.end ())
+            iter = gauges_.emplace (entry.first,
+                collector_->make_gauge (entry.first)).first;
+        iter->second = std::max <std::int64_t> (entry.second, 0);
+    }
+}
+
+} // ripple
@@ -18,221 +18,190 @@
 //==============================================================================
 
 #include <BeastConfig.h>
-#include <ripple/basics/Log.h>
 #include <ripple/basics/RangeSet.h>
-#include <beast/unit_test/suite.h>
 #include <beast/module/core/text/LexicalCast.h>
-#include <boost/foreach.hpp>
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 
 namespace ripple {
 
-// VFALCO NOTE std::min and std::max not good enough?
-//        NOTE Why isn't this written as a template?
-//        TODO Replace this with std calls.
-//
-inline std::uint32_t min (std::uint32_t x, std::uint32_t y)
-{
-    return (x < y) ? x : y;
-}
-inline std::uint32_t max (std::uint32_t x, std::uint32_t y)
+RangeSet::const_iterator RangeSet::find (std::uint32_t v) const
 {
-    return (x > y) ? x : y;
+    return std::lower_bound (mRanges.begin (), mRanges.end (), v,
+        [](Range const& range, std::uint32_t value)
+        {
+            return range.second < value;
+        });
 }
 
 bool RangeSet::hasValue (std::uint32_t v) const
 {
-    for (auto const& it : mRanges)
-    {
-        if (contains (it, v))
-            return true;
-    }
-    return false;
+    auto const it = find (v);
+    return (it != mRanges.end ()) && (it->first <= v);
 }
 
 std::uint32_t RangeSet::getFirst () const
 {
-    const_iterator it = mRanges.begin ();
-
-    if (it == mRanges.end ())
+    if (mRanges.empty ())
         return absent;
 
-    return it->first;
+    return mRanges.front ().first;
 }
 
 std::uint32_t RangeSet::getNext (std::uint32_t v) const
 {
-    for (auto const& it : mRanges)
-    {
-        if (it.first > v)
-            return it.first;
+    if (v == absent)
+        return absent;
 
-        if (contains (it, v + 1))
-            return v + 1;
-    }
-    return absent;
+    auto const it = find (v + 1);
+
+    if (it == mRanges.end ())
+        return absent;
+
+    return std::max (it->first, v + 1);
 }
 
 std::uint32_t RangeSet::getLast () const
 {
-    const_reverse_iterator it = mRanges.rbegin ();
-
-    if (it == mRanges.rend ())
+    if (mRanges.empty ())
         return absent;
 
-    return it->second;
+    return mRanges.back ().second;
 }
 
 std::uint32_t RangeSet::getPrev (std::uint32_t v) const
 {
-    BOOST_REVERSE_FOREACH (const value_type & it, mRanges)
-    {
-        if (it.second < v)
-            return it.second;
+    if (v == 0)
+        return absent;
 
-        if (contains (it, v + 1))
-            return v - 1;
-    }
-    return absent;
+    auto const it = find (v - 1);
+
+    if ((it != mRanges.end ()) && (it->first <= v - 1))
+        return v - 1;
+
+    if (it == mRanges.begin ())
+        return absent;
+
+    return std::prev (it)->second;
 }
 
 // Return the largest number not in the set that is less than the given number
 //
 std::uint32_t RangeSet::prevMissing (std::uint32_t v) const
 {
-    std::uint32_t result = absent;
-
-    if (v != 0)
-    {
-        checkInternalConsistency ();
+    if (v == 0)
+        return absent;
 
-        // Handle the case where the loop reaches the terminating condition
-        //
-        result = v - 1;
+    std::uint32_t result = v - 1;
 
-        for (const_reverse_iterator cur = mRanges.rbegin (); cur != mRanges.rend (); ++cur)
-        {
-            // See if v-1 is in the range
-            if (contains (*cur, result))
-            {
-                result = cur->first - 1;
-                break;
-            }
-        }
-    }
+    // Ranges never touch, so the number below the range holding v-1 is
+    // missing. Below a range starting at zero this wraps to absent.
+    auto const it = find (result);
+    if ((it != mRanges.end ()) && (it->first <= result))
+        result = it->first - 1;
 
-    bassert (result == absent || !hasValue (result));
+    assert (result == absent || !hasValue (result));
 
     return result;
 }
 
 void RangeSet::setValue (std::uint32_t v)
 {
-    if (!hasValue (v))
-    {
-        mRanges[v] = v;
-
-        simplify ();
-    }
+    setRange (v, v);
 }
 
 void RangeSet::setRange (std::uint32_t minV, std::uint32_t maxV)
 {
-    while (hasValue (minV))
-    {
-        ++minV;
+    if (minV > maxV)
+        return;
 
-        if (minV >= maxV)
-            return;
+    // The first range that overlaps or touches the new one
+    auto first = std::lower_bound (mRanges.begin (), mRanges.end (), minV,
+        [](Range const& range, std::uint32_t value)
+        {
+            return static_cast<std::uint64_t> (range.second) + 1 < value;
+        });
+
+    if ((first != mRanges.end ()) &&
+            (first->first <= minV) && (first->second >= maxV))
+        return;
+
+    auto last = first;
+    while ((last != mRanges.end ()) &&
+        (last->first <= static_cast<std::uint64_t> (maxV) + 1))
+    {
+        minV = std::min (minV, last->first);
+        maxV = std::max (maxV, last->second);
+        ++last;
     }
 
-    mRanges[minV] = maxV;
+    if (first == last)
+    {
+        mRanges.emplace (first, minV, maxV);
+    }
+    else
+    {
+        *first = Range (minV, maxV);
+        mRanges.erase (std::next (first), last);
+    }
 
-    simplify ();
+    changed ();
 }
 
 void RangeSet::clearValue (std::uint32_t v)
 {
-    for (iterator it = mRanges.begin (); it != mRanges.end (); ++it)
+    auto const found = find (v);
+
+    if ((found == mRanges.end ()) || (found->first > v))
+        return;
+
+    auto const it = mRanges.begin () + (found - mRanges.cbegin ());
+
+    if (it->first == v)
     {
-        if (contains (*it, v))
-        {
-            if (it->first == v)
-            {
-                if (it->second == v)
-                {
-                    mRanges.erase (it);
-                }
-                else
-                {
-                    std::uint32_t oldEnd = it->second;
-                    mRanges.erase(it);
-                    mRanges[v + 1] = oldEnd;
-                }
-            }
-            else if (it->second == v)
-            {
-                -- (it->second);
-            }
-            else
-            {
-                std::uint32_t oldEnd = it->second;
-                it->second = v - 1;
-                mRanges[v + 1] = oldEnd;
-            }
-
-            checkInternalConsistency();
-            return;
-        }
+        if (it->second == v)
+            mRanges.erase (it);
+        else
+            ++ (it->first);
+    }
+    else if (it->second == v)
+    {
+        -- (it->second);
+    }
+    else
+    {
+        Range const upper (v + 1, it->second);
+        it->second = v - 1;
+        mRanges.insert (std::next (it), upper);
     }
+
+    changed ();
 }
 
-std::string RangeSet::toString () const
+std::string const& RangeSet::toString () const
 {
-    std::string ret;
+    if (mRendered)
+        return mString;
+
+    mString.clear ();
     for (auto const& it : mRanges)
     {
-        if (!ret.empty ())
-            ret += ",";
+        if (!mString.empty ())
+            mString += ",";
 
         if (it.first == it.second)
-            ret += beast::lexicalCastThrow <std::string> ((it.first));
+            mString += beast::lexicalCastThrow <std::string> ((it.first));
         else
-            ret += beast::lexicalCastThrow <std::string> (it.first) + "-"
+            mString += beast::lexicalCastThrow <std::string> (it.first) + "-"
                    + beast::lexicalCastThrow <std::string> (it.second);
     }
 
-    if (ret.empty ())
-        return "empty";
+    if (mString.empty ())
+        mString = "empty";
 
-    return ret;
-}
-
-void RangeSet::simplify ()
-{
-    iterator it = mRanges.begin ();
-
-    while (1)
-    {
-        iterator nit = it;
-
-        if (++nit == mRanges.end ())
-        {
-            checkInternalConsistency();
-            return;
-        }
-
-        if (it->second >= (nit->first - 1))
-        {
-            // ranges overlap
-            it->second = std::max(it->second, nit->second);
-            mRanges.erase (nit);
-        }
-        else
-        {
-            it = nit;
-        }
-    }
+    mRendered = true;
+    return mString;
 }
 
 std::size_t
@@ -247,22 +216,14 @@ RangeSet::lebesgue_sum() const
 void RangeSet::checkInternalConsistency () const noexcept
 {
 #ifndef NDEBUG
-    if (mRanges.size () > 1)
+    for (auto cur = mRanges.begin (); cur != mRanges.end (); ++cur)
     {
-        const_iterator const last = std::prev (mRanges.end ());
+        assert (cur->first <= cur->second);
 
-        for (const_iterator cur = mRanges.begin (); cur != last; ++cur)
-        {
-            const_iterator const next = std::next (cur);
-            assert (cur->first <= cur->second);
-            assert (next->first <= next->second);
-            assert (cur->second + 1 < next->first);
-        }
-    }
-    else if (mRanges.size () == 1)
-    {
-        const_iterator const iter = mRanges.begin ();
-        assert (iter->first <= iter->second);
+        auto const next = std::next (cur);
+        if (next != mRanges.end ())
+            assert (static_cast<std::uint64_t> (cur->second) + 1 <
+                next->first);
     }
 #endif
 }
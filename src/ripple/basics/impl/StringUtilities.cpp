@@ -31,44 +31,36 @@
 
 namespace ripple {
 
-// NIKB NOTE: This function is only used by strUnHex (std::string const& strSrc)
-// which results in a pointless copy from std::string into std::vector. Should
-// we just scrap this function altogether?
-int strUnHex (std::string& strDst, std::string const& strSrc)
+// Decodes into a string or a Blob
+template <class Buffer>
+static
+bool
+unHex (Buffer& out, std::string const& strSrc)
 {
-    std::string tmp;
-
-    tmp.reserve ((strSrc.size () + 1) / 2);
+    auto const odd = strSrc.size () & 1;
+    out.resize (strSrc.size () / 2 + odd);
+    if (out.empty ())
+        return true;
 
-    auto iter = strSrc.cbegin ();
-
-    if (strSrc.size () & 1)
+    if (odd)
     {
-        int c = charUnHex (*iter);
+        int c = charUnHex (strSrc[0]);
 
         if (c < 0)
-            return -1;
+            return false;
 
-        tmp.push_back(c);
-        ++iter;
+        out[0] = static_cast<typename Buffer::value_type> (c);
     }
 
-    while (iter != strSrc.cend ())
-    {
-        int cHigh = charUnHex (*iter);
-        ++iter;
-
-        if (cHigh < 0)
-            return -1;
-
-        int cLow = charUnHex (*iter);
-        ++iter;
+    return hexDecode (&out[odd], strSrc.data () + odd, strSrc.size () / 2);
+}
 
-        if (cLow < 0)
-            return -1;
+int strUnHex (std::string& strDst, std::string const& strSrc)
+{
+    std::string tmp;
 
-        tmp.push_back (static_cast<char>((cHigh << 4) | cLow));
-    }
+    if (! unHex (tmp, strSrc))
+        return -1;
 
     strDst = std::move(tmp);
 
@@ -77,12 +69,12 @@ int strUnHex (std::string& strDst, std::string const& strSrc)
 
 std::pair<Blob, bool> strUnHex (std::string const& strSrc)
 {
-    std::string strTmp;
+    Blob result;
 
-    if (strUnHex (strTmp, strSrc) == -1)
+    if (! unHex (result, strSrc))
         return std::make_pair (Blob (), false);
 
-    return std::make_pair(strCopy (strTmp), true);
+    return std::make_pair (std::move (result), true);
 }
 
 uint64_t uintFromHex (std::string const& strSrc)
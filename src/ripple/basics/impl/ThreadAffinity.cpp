@@ -0,0 +1,122 @@
+#include <BeastConfig.h>
+#include <ripple/basics/ThreadAffinity.h>
+#include <ripple/basics/contract.h>
+#include <beast/module/core/text/LexicalCast.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+#if BEAST_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ripple {
+
+// Larger numbers are certainly a typo
+static unsigned const maxCpu = 4095;
+
+CpuSet
+parseCpuSet (std::string const& s)
+{
+    CpuSet cpus;
+    std::vector<std::string> ranges;
+    boost::split (ranges, s, boost::is_any_of (","));
+    for (auto range : ranges)
+    {
+        boost::trim (range);
+        if (range.empty ())
+            continue;
+
+        unsigned first;
+        unsigned last;
+        auto const dash = range.find ('-');
+        if (dash == std::string::npos)
+        {
+            if (! beast::lexicalCastChecked (first, range))
+                Throw<std::runtime_error> ("Invalid processor '" + range + "'");
+            last = first;
+        }
+        else if (! beast::lexicalCastChecked (first,
+                    boost::trim_copy (range.substr (0, dash))) ||
+                ! beast::lexicalCastChecked (last,
+                    boost::trim_copy (range.substr (dash + 1))) ||
+                last < first)
+        {
+            Throw<std::runtime_error> ("Invalid processors '" + range + "'");
+        }
+        if (last > maxCpu)
+            Throw<std::runtime_error> ("Invalid processors '" + range + "'");
+
+        for (auto cpu = first; cpu <= last; ++cpu)
+            cpus.push_back (cpu);
+    }
+    std::sort (cpus.begin (), cpus.end ());
+    cpus.erase (std::unique (cpus.begin (), cpus.end ()), cpus.end ());
+    return cpus;
+}
+
+std::string
+to_string (CpuSet const& cpus)
+{
+    std::string s;
+    for (std::size_t i = 0; i < cpus.size ();)
+    {
+        auto j = i;
+        while (j + 1 < cpus.size () && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+        if (! s.empty ())
+            s += ",";
+        s += std::to_string (cpus[i]);
+        if (j != i)
+            s += "-" + std::to_string (cpus[j]);
+        i = j + 1;
+    }
+    return s;
+}
+
+#if BEAST_LINUX
+
+static
+bool
+setAffinity (pthread_t thread, CpuSet const& cpus)
+{
+    if (cpus.empty ())
+        return true;
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    for (auto cpu : cpus)
+        if (cpu < CPU_SETSIZE)
+            CPU_SET (cpu, &set);
+    return pthread_setaffinity_np (thread, sizeof (set), &set) == 0;
+}
+
+bool
+setCurrentThreadAffinity (CpuSet const& cpus)
+{
+    return setAffinity (pthread_self (), cpus);
+}
+
+bool
+setThreadAffinity (std::thread& thread, CpuSet const& cpus)
+{
+    return setAffinity (thread.native_handle (), cpus);
+}
+
+#else
+
+bool
+setCurrentThreadAffinity (CpuSet const& cpus)
+{
+    return cpus.empty ();
+}
+
+bool
+setThreadAffinity (std::thread&, CpuSet const& cpus)
+{
+    return cpus.empty ();
+}
+
+#endif
+
+} // ripple
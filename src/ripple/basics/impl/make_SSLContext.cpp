@@ -538,5 +538,22 @@ make_SSLContextAuthed (std::string const& key_file,
     return context;
 }
 
+void
+enableSessionResumption (boost::asio::ssl::context& context)
+{
+    SSL_CTX* const ctx = context.native_handle ();
+
+    // Sessions are only resumed on the context which created them
+    static unsigned char const id[] = "rippled";
+    if (SSL_CTX_set_session_id_context (ctx, id, sizeof(id) - 1) != 1)
+        Throw<std::runtime_error> ("SSL_CTX_set_session_id_context failed");
+
+    SSL_CTX_set_session_cache_mode (ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_timeout (ctx, 60 * 60);
+
+    // Tickets keep the session state on the client instead of in our cache
+    SSL_CTX_clear_options (ctx, SSL_OP_NO_TICKET);
+}
+
 } // ripple
 
@@ -21,6 +21,14 @@
 #include <ripple/basics/Slice.h>
 #include <ripple/basics/strHex.h>
 #include <algorithm>
+#include <cstdint>
+
+#if (defined (__GNUC__) || defined (__clang__)) && defined (__x86_64__)
+#define RIPPLE_HEX_SIMD 1
+#include <immintrin.h>
+#else
+#define RIPPLE_HEX_SIMD 0
+#endif
 
 namespace ripple {
 
@@ -58,4 +66,230 @@ strHex(Slice const& slice)
     return strHex(slice.data(), slice.size());
 }
 
+//------------------------------------------------------------------------------
+
+static
+void
+hexEncodeBytes (char* out, std::uint8_t const* in, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        *out++ = charHex (in[i] >> 4);
+        *out++ = charHex (in[i] & 15);
+    }
+}
+
+static
+bool
+hexDecodeBytes (std::uint8_t* out, char const* in, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        int const hi = charUnHex (*in++);
+        int const lo = charUnHex (*in++);
+        if ((hi | lo) < 0)
+            return false;
+        out[i] = static_cast<std::uint8_t> ((hi << 4) | lo);
+    }
+    return true;
+}
+
+#if RIPPLE_HEX_SIMD
+
+// The digits are looked up with a byte shuffle. A character is decoded
+// as a digit or, with its case bit set, as a letter; the values of the
+// two digits of each byte are then combined by a multiply and add.
+
+__attribute__((target ("ssse3")))
+static
+void
+hexEncode16 (char* out, std::uint8_t const* in, std::size_t size)
+{
+    __m128i const digits = _mm_setr_epi8 ('0', '1', '2', '3', '4', '5',
+        '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    __m128i const mask = _mm_set1_epi8 (0x0f);
+
+    for (; size >= 16; size -= 16, in += 16, out += 32)
+    {
+        __m128i const v = _mm_loadu_si128 (
+            reinterpret_cast<__m128i const*> (in));
+        __m128i const hi = _mm_shuffle_epi8 (digits,
+            _mm_and_si128 (_mm_srli_epi16 (v, 4), mask));
+        __m128i const lo = _mm_shuffle_epi8 (digits,
+            _mm_and_si128 (v, mask));
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (out),
+            _mm_unpacklo_epi8 (hi, lo));
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (out + 16),
+            _mm_unpackhi_epi8 (hi, lo));
+    }
+    hexEncodeBytes (out, in, size);
+}
+
+// Returns the values of 16 digits, or false if one is not a digit
+__attribute__((target ("ssse3")))
+static inline
+bool
+hexDigits16 (__m128i c, __m128i& values)
+{
+    __m128i const letter = _mm_or_si128 (c, _mm_set1_epi8 (0x20));
+    __m128i const isDigit = _mm_and_si128 (
+        _mm_cmpgt_epi8 (c, _mm_set1_epi8 ('0' - 1)),
+        _mm_cmplt_epi8 (c, _mm_set1_epi8 ('9' + 1)));
+    __m128i const isLetter = _mm_and_si128 (
+        _mm_cmpgt_epi8 (letter, _mm_set1_epi8 ('a' - 1)),
+        _mm_cmplt_epi8 (letter, _mm_set1_epi8 ('f' + 1)));
+    if (_mm_movemask_epi8 (_mm_or_si128 (isDigit, isLetter)) != 0xffff)
+        return false;
+    values = _mm_or_si128 (
+        _mm_and_si128 (isDigit, _mm_sub_epi8 (c, _mm_set1_epi8 ('0'))),
+        _mm_and_si128 (isLetter,
+            _mm_sub_epi8 (letter, _mm_set1_epi8 ('a' - 10))));
+    return true;
+}
+
+__attribute__((target ("ssse3")))
+static
+bool
+hexDecode16 (std::uint8_t* out, char const* in, std::size_t size)
+{
+    __m128i const weights = _mm_set1_epi16 (0x0110);
+
+    for (; size >= 16; size -= 16, in += 32, out += 16)
+    {
+        __m128i first;
+        __m128i second;
+        if (! hexDigits16 (_mm_loadu_si128 (
+                reinterpret_cast<__m128i const*> (in)), first) ||
+            ! hexDigits16 (_mm_loadu_si128 (
+                reinterpret_cast<__m128i const*> (in + 16)), second))
+            return false;
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (out),
+            _mm_packus_epi16 (_mm_maddubs_epi16 (first, weights),
+                _mm_maddubs_epi16 (second, weights)));
+    }
+    return hexDecodeBytes (out, in, size);
+}
+
+__attribute__((target ("avx2")))
+static
+void
+hexEncode32 (char* out, std::uint8_t const* in, std::size_t size)
+{
+    __m256i const digits = _mm256_setr_epi8 (
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    __m256i const mask = _mm256_set1_epi8 (0x0f);
+
+    for (; size >= 32; size -= 32, in += 32, out += 64)
+    {
+        __m256i const v = _mm256_loadu_si256 (
+            reinterpret_cast<__m256i const*> (in));
+        __m256i const hi = _mm256_shuffle_epi8 (digits,
+            _mm256_and_si256 (_mm256_srli_epi16 (v, 4), mask));
+        __m256i const lo = _mm256_shuffle_epi8 (digits,
+            _mm256_and_si256 (v, mask));
+
+        // The unpacks work within each half of the registers
+        __m256i const a = _mm256_unpacklo_epi8 (hi, lo);
+        __m256i const b = _mm256_unpackhi_epi8 (hi, lo);
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out),
+            _mm256_permute2x128_si256 (a, b, 0x20));
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out + 32),
+            _mm256_permute2x128_si256 (a, b, 0x31));
+    }
+    hexEncode16 (out, in, size);
+}
+
+__attribute__((target ("avx2")))
+static inline
+bool
+hexDigits32 (__m256i c, __m256i& values)
+{
+    __m256i const letter = _mm256_or_si256 (c, _mm256_set1_epi8 (0x20));
+    __m256i const isDigit = _mm256_and_si256 (
+        _mm256_cmpgt_epi8 (c, _mm256_set1_epi8 ('0' - 1)),
+        _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('9' + 1), c));
+    __m256i const isLetter = _mm256_and_si256 (
+        _mm256_cmpgt_epi8 (letter, _mm256_set1_epi8 ('a' - 1)),
+        _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('f' + 1), letter));
+    if (_mm256_movemask_epi8 (_mm256_or_si256 (isDigit, isLetter)) != -1)
+        return false;
+    values = _mm256_or_si256 (
+        _mm256_and_si256 (isDigit,
+            _mm256_sub_epi8 (c, _mm256_set1_epi8 ('0'))),
+        _mm256_and_si256 (isLetter,
+            _mm256_sub_epi8 (letter, _mm256_set1_epi8 ('a' - 10))));
+    return true;
+}
+
+__attribute__((target ("avx2")))
+static
+bool
+hexDecode32 (std::uint8_t* out, char const* in, std::size_t size)
+{
+    __m256i const weights = _mm256_set1_epi16 (0x0110);
+
+    for (; size >= 32; size -= 32, in += 64, out += 32)
+    {
+        __m256i first;
+        __m256i second;
+        if (! hexDigits32 (_mm256_loadu_si256 (
+                reinterpret_cast<__m256i const*> (in)), first) ||
+            ! hexDigits32 (_mm256_loadu_si256 (
+                reinterpret_cast<__m256i const*> (in + 32)), second))
+            return false;
+
+        // The pack works within each half of the registers
+        __m256i const packed = _mm256_packus_epi16 (
+            _mm256_maddubs_epi16 (first, weights),
+            _mm256_maddubs_epi16 (second, weights));
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*> (out),
+            _mm256_permute4x64_epi64 (packed, 0xd8));
+    }
+    return hexDecode16 (out, in, size);
+}
+
+#endif
+
+int
+hexWidth ()
+{
+#if RIPPLE_HEX_SIMD
+    static int const width =
+        __builtin_cpu_supports ("avx2") ? 32 :
+        __builtin_cpu_supports ("ssse3") ? 16 : 0;
+    return width;
+#else
+    return 0;
+#endif
+}
+
+void
+hexEncode (char* out, void const* data, std::size_t size, int width)
+{
+    auto const in = static_cast<std::uint8_t const*> (data);
+#if RIPPLE_HEX_SIMD
+    if (width == 32)
+        return hexEncode32 (out, in, size);
+    if (width == 16)
+        return hexEncode16 (out, in, size);
+#endif
+    hexEncodeBytes (out, in, size);
+}
+
+bool
+hexDecode (void* out, char const* hex, std::size_t size, int width)
+{
+    auto const o = static_cast<std::uint8_t*> (out);
+#if RIPPLE_HEX_SIMD
+    if (width == 32)
+        return hexDecode32 (o, hex, size);
+    if (width == 16)
+        return hexDecode16 (o, hex, size);
+#endif
+    return hexDecodeBytes (o, hex, size);
+}
+
 }
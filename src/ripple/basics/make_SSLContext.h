@@ -34,6 +34,10 @@ std::shared_ptr<boost::asio::ssl::context>
 make_SSLContextAuthed (std::string const& key_file,
     std::string const& cert_file, std::string const& chain_file);
 
+/** Let clients of a server context resume their earlier sessions. */
+void
+enableSessionResumption (boost::asio::ssl::context& context);
+
 }
 
 #endif
@@ -26,7 +26,10 @@
 #define RIPPLE_BASICS_STRHEX_H_INCLUDED
 
 #include <cassert>
+#include <cstddef>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace ripple {
 
@@ -62,6 +65,104 @@ charUnHex (char c)
 }
 /** @} */
 
+/** Returns the widest hex codec the processor supports.
+    This is 32 bytes at a time with AVX2, 16 with SSSE3, or 0 where
+    only the bytewise codec can be used.
+*/
+int
+hexWidth ();
+
+/** Writes the uppercase hex digits of bytes, two for each byte.
+    @param width The codec to use, from hexWidth.
+*/
+void
+hexEncode (char* out, void const* data, std::size_t size, int width);
+
+inline
+void
+hexEncode (char* out, void const* data, std::size_t size)
+{
+    hexEncode (out, data, size, hexWidth ());
+}
+
+/** Reads the bytes from their hex digits, two for each byte.
+    Upper and lower case digits are accepted.
+    @param width The codec to use, from hexWidth.
+    @return false if a character is not a hex digit, in which case the
+            contents of out are unspecified.
+*/
+bool
+hexDecode (void* out, char const* hex, std::size_t size, int width);
+
+inline
+bool
+hexDecode (void* out, char const* hex, std::size_t size)
+{
+    return hexDecode (out, hex, size, hexWidth ());
+}
+
+namespace detail {
+
+// Whether an iterator points at contiguous bytes, which the codecs read
+template <class It>
+struct is_byte_iterator
+    : std::false_type
+{
+};
+
+template <class T>
+struct is_byte_iterator<T*>
+    : std::integral_constant<bool,
+        std::is_integral<T>::value && sizeof (T) == 1>
+{
+};
+
+template <>
+struct is_byte_iterator<std::string::iterator>
+    : std::true_type
+{
+};
+
+template <>
+struct is_byte_iterator<std::string::const_iterator>
+    : std::true_type
+{
+};
+
+template <>
+struct is_byte_iterator<std::vector<unsigned char>::iterator>
+    : std::true_type
+{
+};
+
+template <>
+struct is_byte_iterator<std::vector<unsigned char>::const_iterator>
+    : std::true_type
+{
+};
+
+template <class FwdIt>
+void
+strHex (char* out, FwdIt first, int size, std::true_type)
+{
+    if (size > 0)
+        hexEncode (out, &*first, size);
+}
+
+template <class FwdIt>
+void
+strHex (char* out, FwdIt first, int size, std::false_type)
+{
+    for (int i = 0; i < size; i++)
+    {
+        unsigned char c = *first++;
+        *out++ = charHex (c >> 4);
+        *out++ = charHex (c & 15);
+    }
+}
+
+} // detail
+
 // NIKB TODO cleanup this function and reduce the need for the many overloads
 //           it has in various places.
 template<class FwdIt>
@@ -69,12 +170,8 @@ std::string strHex (FwdIt first, int size)
 {
     std::string s;
     s.resize (size * 2);
-    for (int i = 0; i < size; i++)
-    {
-        unsigned char c = *first++;
-        s[i * 2]     = charHex (c >> 4);
-        s[i * 2 + 1] = charHex (c & 15);
-    }
+    detail::strHex (&s[0], first, size,
+        detail::is_byte_iterator<FwdIt>{});
     return s;
 }
 
@@ -0,0 +1,142 @@
+#include <BeastConfig.h>
+#include <ripple/basics/Log.h>
+#include <beast/unit_test/suite.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace ripple {
+
+class Log_test : public beast::unit_test::suite
+{
+public:
+    static
+    boost::filesystem::path
+    tempPath ()
+    {
+        return boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ();
+    }
+
+    static
+    std::vector<std::string>
+    readLines (boost::filesystem::path const& path)
+    {
+        std::vector<std::string> lines;
+        std::ifstream in (path.string ());
+        std::string line;
+        while (std::getline (in, line))
+            lines.push_back (line);
+        return lines;
+    }
+
+    // The number of lines which contain the text
+    static
+    std::size_t
+    count (std::vector<std::string> const& lines, std::string const& text)
+    {
+        return std::count_if (lines.begin (), lines.end (),
+            [&](std::string const& line)
+            {
+                return boost::algorithm::contains (line, text);
+            });
+    }
+
+    void
+    testWrite (bool queued)
+    {
+        testcase (queued ? "queued" : "direct");
+
+        auto const path = tempPath ();
+        {
+            Logs logs;
+            expect (logs.open (path));
+            if (queued)
+                logs.queue (1024 * 1024);
+
+            auto const j = logs.journal ("LogTest");
+            for (int i = 0; i < 20; ++i)
+                j.warning << "line " << i;
+            j.info << "not written";
+        }
+
+        auto const lines = readLines (path);
+        expect (lines.size () == 20, std::to_string (lines.size ()));
+        for (std::size_t i = 0; i < lines.size (); ++i)
+        {
+            expect (boost::algorithm::ends_with (lines[i],
+                "LogTest:WRN line " + std::to_string (i)), lines[i]);
+        }
+        boost::filesystem::remove (path);
+    }
+
+    void
+    testDrop ()
+    {
+        testcase ("drop");
+
+        auto const path = tempPath ();
+        std::uint64_t dropped = 0;
+        int const count = 50;
+        {
+            Logs logs;
+            expect (logs.open (path));
+
+            // Any line waiting fills the queue
+            logs.queue (1);
+
+            auto const j = logs.journal ("LogTest");
+            for (int i = 0; i < count; ++i)
+            {
+                j.warning << "warning " << i;
+                j.error << "error " << i;
+            }
+            dropped = logs.dropped ();
+        }
+
+        auto const lines = readLines (path);
+        expect (Log_test::count (lines, "LogTest:ERR error") == count);
+        expect (Log_test::count (lines, "LogTest:WRN warning") ==
+            count - dropped);
+        if (dropped != 0)
+        {
+            expect (Log_test::count (lines,
+                "lines were dropped because the log queue was full") != 0);
+        }
+        boost::filesystem::remove (path);
+    }
+
+    void
+    testFatal ()
+    {
+        testcase ("fatal");
+
+        auto const path = tempPath ();
+        Logs logs;
+        expect (logs.open (path));
+        logs.queue (1024 * 1024);
+
+        // A fatal line is written before the logging thread goes on
+        auto const j = logs.journal ("LogTest");
+        j.warning << "before";
+        j.fatal << "fatal";
+        auto const lines = readLines (path);
+        expect (lines.size () == 2, std::to_string (lines.size ()));
+        expect (count (lines, "LogTest:FTL fatal") == 1);
+        boost::filesystem::remove (path);
+    }
+
+    void
+    run () override
+    {
+        testWrite (false);
+        testWrite (true);
+        testDrop ();
+        testFatal ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Log,ripple_basics,ripple);
+
+} // ripple
@@ -0,0 +1,86 @@
+#include <BeastConfig.h>
+#include <ripple/basics/MemoryTag.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <vector>
+
+namespace ripple {
+
+class MemoryTag_test : public beast::unit_test::suite
+{
+public:
+    static
+    MemoryTag&
+    memory ()
+    {
+        static MemoryTag tag ("MemoryTag_test");
+        return tag;
+    }
+
+    void
+    testCharge ()
+    {
+        testcase ("charge");
+
+        auto const before = memory ().bytes ();
+        {
+            MemoryCharge a (memory (), 100);
+            expect (memory ().bytes () == before + 100);
+            {
+                MemoryCharge b (a);
+                b.add (20);
+                expect (memory ().bytes () == before + 220);
+                a = b;
+                expect (memory ().bytes () == before + 240);
+            }
+            expect (memory ().bytes () == before + 120);
+        }
+        expect (memory ().bytes () == before);
+    }
+
+    void
+    testAllocator ()
+    {
+        testcase ("allocator");
+
+        auto const before = memory ().bytes ();
+        {
+            std::vector <int, TaggedAllocator <int, &MemoryTag_test::memory>> v;
+            v.reserve (10);
+            expect (memory ().bytes () ==
+                before + std::int64_t (v.capacity () * sizeof (int)));
+            v.resize (1000);
+            expect (memory ().bytes () ==
+                before + std::int64_t (v.capacity () * sizeof (int)));
+        }
+        expect (memory ().bytes () == before);
+    }
+
+    void
+    testList ()
+    {
+        testcase ("list");
+
+        MemoryCharge charge (memory (), 1);
+        auto const list = MemoryTag::getBytes ();
+        expect (std::is_sorted (list.begin (), list.end ()));
+        auto const iter = std::find_if (list.begin (), list.end (),
+            [](MemoryTag::List::value_type const& entry)
+            {
+                return entry.first == "MemoryTag_test";
+            });
+        expect (iter != list.end () && iter->second >= 1);
+    }
+
+    void
+    run () override
+    {
+        testCharge ();
+        testAllocator ();
+        testList ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryTag,basics,ripple);
+
+}
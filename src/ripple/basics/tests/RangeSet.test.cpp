@@ -78,13 +78,80 @@ public:
         }
     }
 
+    void testTraverse ()
+    {
+        testcase ("traverse");
+
+        RangeSet const set = createPredefinedSet ();
+
+        expect (set.getFirst () == 0);
+        expect (set.getLast () == 95);
+        expect (set.getNext (3) == 4);
+        expect (set.getNext (5) == 10);
+        expect (set.getNext (95) == RangeSet::absent);
+        expect (set.getPrev (0) == RangeSet::absent);
+        expect (set.getPrev (4) == 3);
+        expect (set.getPrev (10) == 5);
+        expect (set.getPrev (1000) == 95);
+
+        RangeSet const empty;
+        expect (empty.getFirst () == RangeSet::absent);
+        expect (empty.getLast () == RangeSet::absent);
+        expect (empty.getNext (0) == RangeSet::absent);
+        expect (empty.getPrev (10) == RangeSet::absent);
+    }
+
+    void testMerge ()
+    {
+        testcase ("merge");
+
+        RangeSet set = createPredefinedSet ();
+        expect (set.ranges () == 10);
+
+        // Touching ranges join
+        set.setRange (6, 9);
+        expect (set.ranges () == 9);
+        expect (set.hasValue (7));
+        expect (set.getNext (15) == 20);
+
+        // One range can swallow several
+        set.setRange (18, 62);
+        expect (set.ranges () == 5);
+        expect (set.toString () == "0-15,18-65,70-75,80-85,90-95");
+
+        set.setValue (17);
+        set.setValue (16);
+        expect (set.toString () == "0-65,70-75,80-85,90-95");
+        expect (set.lebesgue_sum () == 84);
+
+        set.clearValue (40);
+        set.clearValue (0);
+        set.clearValue (65);
+        set.clearValue (90);
+        set.clearValue (100);
+        expect (set.toString () == "1-39,41-64,70-75,80-85,91-95");
+
+        set.setRange (RangeSet::absent - 1, RangeSet::absent);
+        expect (set.hasValue (RangeSet::absent));
+        expect (set.getNext (RangeSet::absent - 1) == RangeSet::absent);
+
+        RangeSet empty;
+        expect (empty.toString () == "empty");
+        empty.setValue (7);
+        expect (empty.toString () == "7");
+        empty.clearValue (7);
+        expect (empty.toString () == "empty");
+    }
+
     void run ()
     {
         testMembership ();
 
         testPrevMissing ();
 
-        // TODO: Traverse functions must be tested
+        testTraverse ();
+
+        testMerge ();
     }
 };
 
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <beast/unit_test/suite.h>
+#include <beast/chrono/manual_clock.h>
+
+namespace ripple {
+
+class ShardedTaggedCache_test : public beast::unit_test::suite
+{
+public:
+    using Cache = ShardedTaggedCache <uint256, std::string, 4>;
+
+    static
+    uint256
+    key (unsigned char shard, unsigned char n)
+    {
+        uint256 result;
+        result.begin()[0] = shard;
+        result.begin()[31] = n;
+        return result;
+    }
+
+    void testShards ()
+    {
+        testcase ("shards");
+
+        beast::Journal const j;
+        TestStopwatch clock;
+        clock.set (0);
+
+        // Each of the 4 shards targets 2 entries.
+        Cache c ("test", 8, 1, clock, j);
+        expect (c.getTargetSize () == 8);
+
+        for (unsigned char shard = 0; shard < 4; ++shard)
+        {
+            expect (! c.insert (key (shard, 1), "one"));
+            expect (! c.insert (key (shard, 2), "two"));
+        }
+        expect (c.getCacheSize () == 8);
+        expect (c.getTrackSize () == 8);
+        expect (c.getKeys ().size () == 8);
+
+        {
+            std::string s;
+            expect (c.retrieve (key (3, 2), s));
+            expect (s == "two");
+            expect (! c.retrieve (key (3, 3), s));
+        }
+        expect (c.getHitRate () == 50);
+
+        // Equal objects are canonicalized within their shard.
+        {
+            Cache::mapped_ptr const p1 (c.fetch (key (1, 1)));
+            Cache::mapped_ptr p2 (std::make_shared <std::string> ("one"));
+            expect (c.canonicalize (key (1, 1), p2));
+            expect (p1.get () == p2.get ());
+        }
+
+        // A strong pointer keeps its entry tracked past a sweep.
+        {
+            Cache::mapped_ptr const p (c.fetch (key (2, 1)));
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize () == 0);
+            expect (c.getTrackSize () == 1);
+            expect (c.refreshIfPresent (key (2, 1)));
+        }
+
+        ++clock;
+        c.sweep ();
+        ++clock;
+        c.sweep ();
+        expect (c.getCacheSize () == 0);
+        expect (c.getTrackSize () == 0);
+
+        c.setTargetSize (6);
+        expect (c.getTargetSize () == 8);
+        c.setTargetSize (0);
+        expect (c.getTargetSize () == 0);
+    }
+
+    void run ()
+    {
+        testShards ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardedTaggedCache,common,ripple);
+
+}
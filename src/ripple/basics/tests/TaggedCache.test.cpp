@@ -144,6 +144,33 @@ public:
             expect (c.getCacheSize() == 0);
             expect (c.getTrackSize() == 0);
         }
+
+        // Sweep a map of many more buckets than are swept at a time,
+        // keeping every tenth object alive.
+        {
+            Cache big ("big", 0, 1, clock, j);
+            std::vector <Cache::mapped_ptr> kept;
+            for (int i = 0; i < 10000; ++i)
+            {
+                expect (! big.insert (i, std::to_string (i)));
+                if (i % 10 == 0)
+                    kept.push_back (big.fetch (i));
+            }
+            expect (big.getCacheSize() == 10000);
+
+            ++clock;
+            big.sweep ();
+            expect (big.getCacheSize() == 0);
+            expect (big.getTrackSize() == 1000);
+
+            expect (big.refreshIfPresent (10));
+            expect (big.getCacheSize() == 1);
+            kept.clear ();
+            ++clock;
+            big.sweep ();
+            expect (big.getCacheSize() == 0);
+            expect (big.getTrackSize() == 0);
+        }
     }
 };
 
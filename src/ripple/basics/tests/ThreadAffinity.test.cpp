@@ -0,0 +1,67 @@
+#include <BeastConfig.h>
+#include <ripple/basics/ThreadAffinity.h>
+#include <beast/unit_test/suite.h>
+#include <stdexcept>
+
+namespace ripple {
+
+class ThreadAffinity_test : public beast::unit_test::suite
+{
+public:
+    void
+    testParse ()
+    {
+        testcase ("parse");
+
+        expect (parseCpuSet ("").empty ());
+        expect (parseCpuSet ("3") == CpuSet ({3}));
+        expect (parseCpuSet ("8, 0-2 ,1") == CpuSet ({0, 1, 2, 8}));
+        expect (to_string (parseCpuSet ("10-11,0-3,5")) == "0-3,5,10-11");
+        expect (to_string (CpuSet ()) == "");
+
+        for (auto const s : {"x", "1-", "3-1", "-2", "0-5000", "1.5"})
+        {
+            try
+            {
+                parseCpuSet (s);
+                fail (std::string ("accepted ") + s);
+            }
+            catch (std::runtime_error const&)
+            {
+                pass ();
+            }
+        }
+    }
+
+    void
+    testAffinity ()
+    {
+        testcase ("affinity");
+
+        expect (setCurrentThreadAffinity ({}));
+#if BEAST_LINUX
+        // Every process may run on some processor it already has
+        cpu_set_t set;
+        expect (sched_getaffinity (0, sizeof (set), &set) == 0);
+        unsigned cpu = 0;
+        while (! CPU_ISSET (cpu, &set))
+            ++cpu;
+        std::thread t ([&]
+        {
+            expect (setCurrentThreadAffinity ({cpu}));
+        });
+        t.join ();
+#endif
+    }
+
+    void
+    run ()
+    {
+        testParse ();
+        testAffinity ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ThreadAffinity,basics,ripple);
+
+} // ripple
@@ -0,0 +1,201 @@
+#include <BeastConfig.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/base_uint.h>
+#include <beast/unit_test/suite.h>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <random>
+
+namespace ripple {
+
+class strHex_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::vector<int>
+    widths ()
+    {
+        std::vector<int> result {0};
+        if (hexWidth () >= 16)
+            result.push_back (16);
+        if (hexWidth () >= 32)
+            result.push_back (32);
+        return result;
+    }
+
+    static
+    Blob
+    randomBytes (std::mt19937& gen, std::size_t size)
+    {
+        std::uniform_int_distribution<int> dist (0, 255);
+        Blob result (size);
+        for (auto& b : result)
+            b = static_cast<unsigned char> (dist (gen));
+        return result;
+    }
+
+    void
+    testEncode ()
+    {
+        testcase ("encode");
+        log << "hex width " << hexWidth ();
+
+        std::mt19937 gen (7);
+        for (std::size_t size = 0; size <= 100; ++size)
+        {
+            auto const bytes = randomBytes (gen, size);
+
+            std::string expected;
+            for (auto b : bytes)
+            {
+                expected += charHex (b >> 4);
+                expected += charHex (b & 15);
+            }
+
+            for (auto width : widths ())
+            {
+                std::string out (2 * size, 0);
+                hexEncode (&out[0], bytes.data (), size, width);
+                expect (out == expected, std::to_string (width));
+            }
+            expect (strHex (bytes) == expected);
+            expect (sqlEscape (bytes) == "X'" + expected + "'");
+        }
+    }
+
+    void
+    testDecode ()
+    {
+        testcase ("decode");
+
+        std::mt19937 gen (11);
+        for (std::size_t size = 0; size <= 100; ++size)
+        {
+            auto const bytes = randomBytes (gen, size);
+            auto upper = strHex (bytes);
+            auto lower = boost::algorithm::to_lower_copy (upper);
+
+            for (auto width : widths ())
+            {
+                Blob out (size);
+                expect (hexDecode (out.data (), upper.data (), size, width) &&
+                    out == bytes, "upper");
+                std::fill (out.begin (), out.end (), 0);
+                expect (hexDecode (out.data (), lower.data (), size, width) &&
+                    out == bytes, "lower");
+            }
+        }
+
+        // Every character which is not a digit, in every position
+        std::string digits (128, '0');
+        for (int c = 0; c < 256; ++c)
+        {
+            if (charUnHex (static_cast<unsigned char> (c)) >= 0)
+                continue;
+            for (std::size_t i = 0; i < digits.size (); i += 9)
+            {
+                auto bad = digits;
+                bad[i] = static_cast<char> (c);
+                for (auto width : widths ())
+                {
+                    Blob out (bad.size () / 2);
+                    expect (! hexDecode (out.data (), bad.data (),
+                        out.size (), width));
+                }
+            }
+        }
+    }
+
+    void
+    testCallers ()
+    {
+        testcase ("callers");
+
+        auto const text =
+            "0123456789ABCDEFfedcba98765432100123456789ABCDEFfedcba9876543210";
+        uint256 exact;
+        expect (exact.SetHexExact (text));
+        expect (to_string (exact) ==
+            "0123456789ABCDEFFEDCBA98765432100123456789ABCDEFFEDCBA9876543210");
+        expect (! exact.SetHexExact (std::string (text) + "0"));
+        expect (! exact.SetHexExact (std::string (text).substr (1)));
+        auto bad = std::string (text);
+        bad[40] = 'g';
+        expect (! exact.SetHexExact (bad));
+
+        uint256 loose;
+        expect (loose.SetHex ("0x123"));
+        expect (loose == uint256 (0x123));
+        expect (loose.SetHex (std::string ("FF") + text));
+        expect (loose == exact);
+        expect (! loose.SetHex ("12z"));
+
+        auto const blob = strUnHex ("0" + std::string (text));
+        expect (blob.second && blob.first.size () == 33 &&
+            blob.first[0] == 0 && blob.first[1] == 0x01 &&
+            blob.first[32] == 0x10);
+        expect (! strUnHex (bad).second);
+    }
+
+    void
+    run () override
+    {
+        testEncode ();
+        testDecode ();
+        testCallers ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(strHex,ripple_basics,ripple);
+
+//------------------------------------------------------------------------------
+
+class strHex_timing_test : public beast::unit_test::suite
+{
+public:
+    template <class F>
+    std::chrono::milliseconds
+    time (F&& f)
+    {
+        using clock = std::chrono::steady_clock;
+        auto const start = clock::now ();
+        f ();
+        return std::chrono::duration_cast<std::chrono::milliseconds> (
+            clock::now () - start);
+    }
+
+    void
+    run () override
+    {
+        // About the size of a transaction with its metadata
+        std::size_t const size = 1024;
+        int const rounds = 200000;
+
+        Blob bytes (size);
+        for (std::size_t i = 0; i < size; ++i)
+            bytes[i] = static_cast<unsigned char> (i * 37);
+        std::string text (2 * size, 0);
+
+        for (auto width : strHex_test::widths ())
+        {
+            auto const encode = time ([&]
+                {
+                    for (int i = 0; i < rounds; ++i)
+                        hexEncode (&text[0], bytes.data (), size, width);
+                });
+            auto const decode = time ([&]
+                {
+                    for (int i = 0; i < rounds; ++i)
+                        hexDecode (bytes.data (), text.data (), size, width);
+                });
+            log << rounds << " blobs of " << size << " bytes, width " <<
+                width << ": encode " << encode.count () << "ms, decode " <<
+                    decode.count () << "ms";
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(strHex_timing,ripple_basics,ripple);
+
+} // ripple
@@ -0,0 +1,92 @@
+#ifndef RIPPLE_CORE_CACHEBUDGET_H_INCLUDED
+#define RIPPLE_CORE_CACHEBUDGET_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/json/json_value.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Shares one memory budget between the target sizes of several caches.
+
+    The budget is given in [cache_budget] as mb=. The first rebalance
+    scales the configured targets so that, at the estimated bytes per item,
+    they add up to the budget. Every later rebalance looks at the misses
+    each cache had since the previous one per byte it holds, and moves a
+    twentieth of the budget from the cache that would miss the bytes least
+    to the one that would gain most. A cache that is not full can give its
+    bytes away for free.
+*/
+class CacheBudget
+{
+public:
+    struct Cache
+    {
+        std::string name;
+
+        /** The estimated memory held by one entry. */
+        std::size_t itemBytes;
+
+        /** The target size is not made smaller than this. */
+        int minimum;
+
+        /** The hits, then the misses, since the cache was created. */
+        std::function<std::pair<std::uint64_t, std::uint64_t>()> hitsAndMisses;
+
+        std::function<int()> size;
+
+        std::function<void(int)> setTargetSize;
+    };
+
+    CacheBudget (Section const& section, beast::Journal journal);
+
+    /** Returns true if a budget is configured. */
+    bool
+    enabled () const
+    {
+        return bytes_ != 0;
+    }
+
+    /** Share the budget with a cache, starting from its configured size. */
+    void
+    add (Cache cache, int target);
+
+    /** Move part of the budget towards the cache that misses most.
+        Called on every sweep.
+    */
+    void
+    rebalance ();
+
+    /** The budget and the target of each cache. */
+    Json::Value
+    getJson () const;
+
+private:
+    struct Entry
+    {
+        Cache cache;
+        int target;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    void
+    scale ();
+
+    std::uint64_t const bytes_;
+    beast::Journal journal_;
+
+    std::mutex mutable mutex_;
+    std::vector<Entry> entries_;
+    bool scaled_ = false;
+};
+
+}
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/basics/base_uint.h>
+#include <ripple/core/ThreadPools.h>
 #include <ripple/protocol/SystemParameters.h> // VFALCO Breaks levelization
 #include <ripple/protocol/RippleAddress.h> // VFALCO Breaks levelization
 #include <ripple/json/json_value.h>
@@ -160,6 +161,11 @@ public:
     beast::File getModuleDatabasePath () const;
 
     bool doImport = false;
+
+    // The first and last ledgers written to the transaction database by
+    // --load-sql-history, after which the server exits
+    boost::optional<std::pair<std::uint32_t, std::uint32_t>> LOAD_SQL_HISTORY;
+
     bool                        QUIET = false;
     bool                        ELB_SUPPORT = false;
 
@@ -183,6 +189,10 @@ public:
 
     bool                        START_VALID = false;
 
+    // Check the nodes of a loaded ledger once the server runs, rather than
+    // before it starts
+    bool                        BACKGROUND_VERIFY = false;
+
     std::string                 START_LEDGER;
 
     // Network parameters
@@ -202,6 +212,7 @@ public:
     // Note: The following parameters do not relate to the UNL or trust at all
     std::size_t                 NETWORK_QUORUM = 0;         // Minimum number of nodes to consider the network present
     int                         VALIDATION_QUORUM = 1;      // Minimum validations to consider ledger authoritative
+    bool                        SAVE_VALIDATIONS = true;    // Write replaced validations to the ledger database
     bool                        LOCK_QUORUM = false;        // Do not raise the quorum
 
     // Peer networking parameters
@@ -219,6 +230,26 @@ public:
     int                         PATH_SEARCH_FAST = 2;
     int                         PATH_SEARCH_MAX = 10;
 
+    // Threads updating path_find subscriptions
+    int                         PATH_SEARCH_THREADS = 1;
+
+    // Kilobytes of log lines waiting for the log writer thread, 0 to write
+    // each line on the thread logging it
+    int                         LOG_QUEUE = 0;
+
+    // Threads applying open ledger transactions, 0 to apply them one at a time
+    int                         PARALLEL_APPLY = 0;
+
+    // Milliseconds peer transactions wait to have their signatures checked
+    // together, 0 to check each one alone
+    int                         SIGNATURE_BATCH = 2;
+
+    // Threads checking ledgers for the ledger cleaner
+    int                         LEDGER_CLEANER_THREADS = 1;
+
+    // The size and processors of the thread pools
+    ThreadPools                 THREADS;
+
     // Validation
     RippleAddress               VALIDATION_SEED;
     RippleAddress               VALIDATION_PUB;
@@ -247,6 +278,10 @@ public:
     // Node storage configuration
     std::uint32_t                      LEDGER_HISTORY = 256;
     std::uint32_t                      FETCH_DEPTH = 1000000000;
+    // Past ledgers to acquire at once, 0 to acquire them a few at a time
+    int                         LEDGER_FETCH_BULK = 0;
+    // Missing ledgers to rebuild from stored transactions, 0 to acquire them
+    int                         LEDGER_REPLAY = 0;
     int                         NODE_SIZE = 0;
 
     bool                        SSL_VERIFY = true;
@@ -31,10 +31,14 @@ struct ConfigSection
     static std::string importNodeDatabase () { return "import_db"; }
     static std::string transactionDatabase () { return "transaction_db"; }
     static std::string dividendAccount ()    { return "dividend_account";}
+    static std::string sqlite ()             { return "sqlite"; }
 };
 
 // VFALCO TODO Rename and replace these macros with variables.
 #define SECTION_AMENDMENTS              "amendments"
+#define SECTION_BACKGROUND_VERIFY       "background_verify"
+#define SECTION_CACHE_BUDGET            "cache_budget"
+#define SECTION_CACHE_SNAPSHOT          "cache_snapshot"
 #define SECTION_CLUSTER_NODES           "cluster_nodes"
 #define SECTION_DEBUG_LOGFILE           "debug_logfile"
 #define SECTION_ELB_SUPPORT             "elb_support"
@@ -43,24 +47,37 @@ struct ConfigSection
 #define SECTION_FEE_ACCOUNT_RESERVE     "fee_account_reserve"
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
+#define SECTION_LEDGER_CLEANER_THREADS  "ledger_cleaner_threads"
+#define SECTION_LEDGER_FETCH_BULK       "ledger_fetch_bulk"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
+#define SECTION_LEDGER_REPLAY           "ledger_replay"
+#define SECTION_LEDGER_SNAPSHOTS        "ledger_snapshots"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
 #define SECTION_IPS_FIXED               "ips_fixed"
+#define SECTION_JOB_LATENCY             "job_latency"
+#define SECTION_LOG_QUEUE               "log_queue"
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
 #define SECTION_NODE_SIZE               "node_size"
+#define SECTION_PARALLEL_APPLY          "parallel_apply"
 #define SECTION_PATH_SEARCH_OLD         "path_search_old"
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
 #define SECTION_PATH_SEARCH_MAX         "path_search_max"
+#define SECTION_PATH_SEARCH_THREADS     "path_search_threads"
 #define SECTION_PEER_PRIVATE            "peer_private"
 #define SECTION_PEERS_MAX               "peers_max"
+#define SECTION_RPC_CACHE               "rpc_cache"
 #define SECTION_RPC_STARTUP             "rpc_startup"
+#define SECTION_SAVE_VALIDATIONS        "save_validations"
+#define SECTION_SIGNATURE_BATCH         "signature_batch"
 #define SECTION_SNTP                    "sntp_servers"
 #define SECTION_SSL_VERIFY              "ssl_verify"
 #define SECTION_SSL_VERIFY_FILE         "ssl_verify_file"
 #define SECTION_SSL_VERIFY_DIR          "ssl_verify_dir"
+#define SECTION_THREADS                 "threads"
+#define SECTION_TX_TRACE                "tx_trace"
 #define SECTION_VALIDATORS_FILE         "validators_file"
 #define SECTION_VALIDATION_QUORUM       "validation_quorum"
 #define SECTION_VALIDATION_SEED         "validation_seed"
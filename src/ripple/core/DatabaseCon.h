@@ -23,6 +23,9 @@
 #include <ripple/core/Config.h>
 #include <ripple/core/SociDB.h>
 #include <boost/filesystem/path.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -72,7 +75,62 @@ public:
     }
 };
 
-using LockedSociSession = LockedPointer<soci::session, std::recursive_mutex>;
+/** A session checked out of a DatabaseCon.
+
+    Holds either the lock of the single session or the lease of a
+    session from a pool, which is given back on destruction.
+*/
+class LockedSociSession
+{
+public:
+    using mutex = std::recursive_mutex;
+
+private:
+    soci::session* it_;
+    std::unique_lock<mutex> lock_;
+    soci::connection_pool* pool_ = nullptr;
+    std::size_t pos_ = 0;
+
+public:
+    LockedSociSession (soci::session* it, mutex& m) : it_ (it), lock_ (m)
+    {
+    }
+    LockedSociSession (soci::connection_pool& pool, std::size_t pos)
+        : it_ (&pool.at (pos)), pool_ (&pool), pos_ (pos)
+    {
+    }
+    LockedSociSession (LockedSociSession&& rhs) noexcept
+        : it_ (rhs.it_), lock_ (std::move (rhs.lock_))
+        , pool_ (rhs.pool_), pos_ (rhs.pos_)
+    {
+        rhs.pool_ = nullptr;
+    }
+    ~LockedSociSession ()
+    {
+        if (pool_)
+            pool_->give_back (pos_);
+    }
+    LockedSociSession () = delete;
+    LockedSociSession (LockedSociSession const& rhs) = delete;
+    LockedSociSession& operator=(LockedSociSession const& rhs) = delete;
+
+    soci::session* get ()
+    {
+        return it_;
+    }
+    soci::session& operator*()
+    {
+        return *it_;
+    }
+    soci::session* operator->()
+    {
+        return it_;
+    }
+    explicit operator bool() const
+    {
+        return bool (it_);
+    }
+};
 
 class DatabaseCon
 {
@@ -88,6 +146,31 @@ public:
         Config::StartUpType startUp = Config::NORMAL;
         bool standAlone = false;
         boost::filesystem::path dataDir;
+        // Pages in the write ahead log of a sqlite database that start a
+        // checkpoint
+        int checkpointPages = 1000;
+    };
+
+    /** Sessions for a MySQL database used from many threads.
+
+        Writes take a session from the write pool, queries from the
+        read pool, which connects to the replica if there is one.
+    */
+    struct PoolSetup
+    {
+        std::size_t readers = 1;
+        std::size_t writers = 1;
+        // Connection string of a read replica, empty for the primary
+        std::string replica;
+    };
+
+    struct PoolStats
+    {
+        std::size_t connections = 0;
+        std::uint64_t checkouts = 0;
+        // Time spent waiting for a free session
+        std::chrono::microseconds waitTotal {0};
+        std::chrono::microseconds waitMax {0};
     };
 
     DatabaseCon (Setup const& setup,
@@ -102,17 +185,46 @@ public:
                  const char* initString[],
                  int countInit);
 
+    /** Open a MySQL database with pools of sessions. */
+    DatabaseCon (Setup const& setup,
+                 std::string const& connection,
+                 PoolSetup const& pool,
+                 const char* initString[],
+                 int countInit);
+
+    ~DatabaseCon ();
+
+    /** The session used to set up the database.
+
+        With pools this session is not used by checkoutDb.
+    */
     soci::session& getSession()
     {
         return session_;
     }
 
-    LockedSociSession checkoutDb ()
+    /** Check out a session for writing. */
+    LockedSociSession checkoutDb ();
+
+    /** Check out a session for queries, which may see a replica. */
+    LockedSociSession checkoutReadDb ();
+
+    bool isPooled () const
     {
-        return LockedSociSession (&session_, lock_);
+        return bool (writers_);
     }
 
-    void setupCheckpointing (JobQueue*, Logs&);
+    PoolStats getReadStats () const;
+
+    PoolStats getWriteStats () const;
+
+    /** Reconnect the sessions used for writing. */
+    void reconnect ();
+
+    /** Checkpoint the write ahead log of a sqlite database in the
+        background, reporting to the group, which may be null.
+    */
+    void setupCheckpointing (beast::insight::Group::ptr const&, Logs&);
 
     Type getType () { return type_; }
     
@@ -137,12 +249,17 @@ public:
     }
 
 private:
+    class Pool;
+
     LockedSociSession::mutex lock_;
     std::mutex mutex_;
     bool isConnecting = false;
 
     soci::session session_;
+    std::unique_ptr<Pool> readers_;
+    std::unique_ptr<Pool> writers_;
     std::unique_ptr<Checkpointer> checkpointer_;
+    int checkpointPages_;
     
     Type type_;
 };
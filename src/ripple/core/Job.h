@@ -44,8 +44,10 @@ enum JobType
     jtPROPOSAL_ut,   // A proposal from an untrusted source
     jtLEDGER_DATA,   // Received data for a ledger we're acquiring
     jtCLIENT,        // A websocket command from the client
+    jtCLIENT_IO,     // Database reads for a suspended client command
     jtRPC,           // A websocket command from the client
     jtUPDATE_PF,     // Update pathfinding requests
+    jtHANDSHAKE,     // Verify the handshake of a new peer connection
     jtTRANSACTION,   // A transaction received from the network
     jtBATCH,         // Apply batched transactions
     jtUNL,           // A Score or Fetch of the UNL (DEPRECATED)
@@ -59,6 +61,8 @@ enum JobType
     jtACCEPT,        // Accept a consensus ledger
     jtPROPOSAL_t,    // A proposal from a trusted source
     jtDIVIDEND,      // Process dividend
+    jtDIVIDEND_INDEX,// Rebuild the incremental dividend index
+    jtDIVIDEND_SIGN, // Sign and submit dividend transactions
     jtSWEEP,         // Sweep for stale structures
     jtNETOP_CLUSTER, // NetworkOPs cluster peer report
     jtNETOP_TIMER,   // NetworkOPs net timer processing
@@ -110,13 +114,15 @@ public:
          std::string const& name,
          std::uint64_t index,
          LoadMonitor& lm,
-         std::function <void (Job&)> const& job,
+         std::function <void (Job&)> job,
          CancelCallback cancelCallback);
 
     //Job& operator= (Job const& other);
 
     JobType getType () const;
 
+    std::string const& getName () const;
+
     CancelCallback getCancelCallback () const;
 
     /** Returns the time when the job was queued. */
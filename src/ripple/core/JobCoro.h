@@ -21,8 +21,11 @@
 #define RIPPLE_CORE_JOBCORO_H_INCLUDED
 
 #include <ripple/core/Job.h>
+#include <ripple/json/Arena.h>
 #include <beast/win32_workaround.h>
 #include <boost/coroutine/all.hpp>
+#include <boost/optional.hpp>
+#include <exception>
 #include <string>
 #include <mutex>
 
@@ -72,6 +75,18 @@ public:
         Undefined behavior if called consecutively without a corresponding yield.
     */
     void post ();
+
+    /** Run a function as a job of another type and wait for it.
+        Effects:
+          The coroutine is suspended while the function runs, so its own
+            job thread is free for other jobs.
+          Returns what the function returns, or throws what it throws.
+        Note:
+          The function must not return void.
+          Must be called from within the coroutine.
+    */
+    template <class F>
+    auto await (JobType type, std::string const& name, F&& f) -> decltype (f ());
 };
 
 } // ripple
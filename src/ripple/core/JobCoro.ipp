@@ -43,6 +43,8 @@ inline
 void
 JobCoro::yield () const
 {
+    // The coroutine may resume on another thread
+    Json::Arena::Suspend suspend;
     (*yield_)();
 }
 
@@ -59,6 +61,35 @@ JobCoro::post ()
         });
 }
 
+template <class F>
+auto
+JobCoro::await (JobType type, std::string const& name, F&& f) -> decltype (f ())
+{
+    boost::optional<decltype (f ())> result;
+    std::exception_ptr error;
+
+    // The coroutine is suspended until the job posts it, so the job may
+    // use what is on its stack.
+    jq_.addJob (type, name,
+        [&, sp = shared_from_this()](Job&)
+        {
+            try
+            {
+                result.emplace (f ());
+            }
+            catch (...)
+            {
+                error = std::current_exception ();
+            }
+            sp->post ();
+        });
+    yield ();
+
+    if (error)
+        std::rethrow_exception (error);
+    return std::move (*result);
+}
+
 } // ripple
 
 #endif
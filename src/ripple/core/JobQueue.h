@@ -20,6 +20,8 @@
 #ifndef RIPPLE_CORE_JOBQUEUE_H_INCLUDED
 #define RIPPLE_CORE_JOBQUEUE_H_INCLUDED
 
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/ThreadAffinity.h>
 #include <ripple/core/JobTypes.h>
 #include <ripple/core/JobTypeData.h>
 #include <ripple/core/JobCoro.h>
@@ -28,8 +30,10 @@
 #include <beast/threads/Stoppable.h>
 #include <beast/module/core/thread/Workers.h>
 #include <boost/function.hpp>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <thread>
-#include <set>
 
 namespace ripple {
 
@@ -46,7 +50,7 @@ public:
         Stoppable& parent, beast::Journal journal, Logs& logs);
     ~JobQueue ();
 
-    void addJob (JobType type, std::string const& name, JobFunction const& func);
+    void addJob (JobType type, std::string const& name, JobFunction func);
 
     /** Creates a coroutine and adds a job to the queue which will run it.
 
@@ -77,6 +81,14 @@ public:
     */
     void setThreadCount (int c, bool const standaloneMode);
 
+    /** Returns the number of threads serving the job queue. */
+    int getThreadCount () const;
+
+    /** Keep the threads serving the job queue on a set of processors.
+        Called before setThreadCount.
+    */
+    void setThreadAffinity (CpuSet cpus);
+
     // VFALCO TODO Rename these to newLoadEventMeasurement or something similar
     //             since they create the object.
     LoadEvent::pointer getLoadEvent (JobType t, std::string const& name);
@@ -99,22 +111,48 @@ public:
     // Cannot be const because LoadMonitor has no const methods.
     Json::Value getJson (int c = 0);
 
+    /** Set the wait or run time over which a job of each type is logged.
+        Keys are job type names and values are milliseconds. Types not
+        in the section use their peak latency target, if they have one.
+    */
+    void setOutlierThresholds (Section const& section);
+
 private:
     using JobDataMap = std::map <JobType, JobTypeData>;
 
+    // The number of job types, which index the lanes
+    static std::size_t const numJobTypes = jtNS_WRITE + 1;
+
+    // The waiting jobs of one type, oldest first
+    struct Lane
+    {
+        std::deque <Job> jobs;
+        JobTypeData* data = nullptr;
+
+        // For jobs with no limit, this is the largest int
+        int limit = 0;
+    };
+
     beast::Journal m_journal;
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set <Job> m_jobSet;
+    std::atomic <std::uint64_t> m_lastJob;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
+    // Jobs are taken from the lane of the highest priority which is below
+    // its limit. Each lane refers to its entry in m_jobData.
+    std::array <Lane, numJobTypes> m_lanes;
+
+    // The number of jobs waiting in all of the lanes
+    std::size_t m_jobCount;
+
     std::map <std::thread::id, Job*> m_threadIds;
 
     // The number of jobs currently in processTask()
     int m_processCount;
 
     beast::Workers m_workers;
+    CpuSet m_cpus;
     Job::CancelCallback m_cancelCallback;
 
     // Statistics tracking
@@ -131,6 +169,10 @@ private:
     void collect();
     JobTypeData& getJobTypeData (JobType type);
 
+    // Returns the lane of a job type, or nullptr if it has none
+    Lane* findLane (JobType type);
+    Lane const* findLane (JobType type) const;
+
     // Signals the service stopped if the stopped condition is met.
     void checkStopped (std::lock_guard <std::mutex> const& lock);
 
@@ -138,29 +180,30 @@ private:
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
+    //  The Job is at the back of the lane for its type.
     //  Count of waiting jobs of that type will be incremented.
     //  If JobQueue exists, and has at least one thread, Job will eventually run.
     //
     // Invariants:
     //  The calling thread owns the JobLock
-    void queueJob (Job const& job, std::lock_guard <std::mutex> const& lock);
+    void queueJob (Lane& lane, Job&& job,
+        std::lock_guard <std::mutex> const& lock);
 
     // Returns the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  The oldest Job in a lane whose running count is below its limit.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  The lanes must not be empty.
+    //  The lanes hold at least one RunnableJob
     //
     // Post-conditions:
-    //  job is a valid Job object.
-    //  job is removed from mJobQueue.
+    //  job is the RunnableJob of the highest priority.
+    //  job is removed from its lane.
     //  Waiting job count of its type is decremented
     //  Running job count of its type is incremented
     //
@@ -171,7 +214,7 @@ private:
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
+    //  Job must not be in a lane.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
@@ -190,10 +233,15 @@ private:
     void on_execute (JobType type,
         std::chrono::duration <Rep, Period> const& value);
 
+    // Add a job's latencies to the windows of its type, and log it if
+    // they are over the threshold of the type.
+    void on_finish (Job const& job, JobTypeData& data,
+        Job::clock_type::duration wait, Job::clock_type::duration run);
+
     // Runs the next appropriate waiting Job.
     //
     // Pre-conditions:
-    //  A RunnableJob must exist in the JobSet
+    //  A RunnableJob must exist in the lanes
     //
     // Post-conditions:
     //  The chosen RunnableJob will have Job::doJob() called.
@@ -208,11 +256,6 @@ private:
     // to determine if a long running or non-mandatory operation should be canceled.
     bool skipOnStop (JobType type);
 
-    // Returns the limit of running jobs for the given job type.
-    // For jobs with no limit, we return the largest int. Hopefully that
-    // will be enough.
-    int getJobLimit (JobType type);
-
     void onStop () override;
     void onChildrenStopped () override;
 };
@@ -22,6 +22,7 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobTypeInfo.h>
+#include <ripple/core/LatencyWindow.h>
 #include <beast/insight/Collector.h>
 
 namespace ripple
@@ -52,6 +53,25 @@ public:
     beast::insight::Event dequeue;
     beast::insight::Event execute;
 
+    /* Latencies over the last minute, from queueing to running and
+       of running
+    */
+    LatencyWindow waitLatency;
+    LatencyWindow runLatency;
+
+    /* Percentiles of the latencies, in microseconds */
+    struct Gauges
+    {
+        beast::insight::Gauge p50;
+        beast::insight::Gauge p99;
+        beast::insight::Gauge p999;
+    };
+    Gauges waitGauges;
+    Gauges runGauges;
+
+    /* Jobs waiting or running longer than this are logged, if set */
+    std::chrono::milliseconds outlierThreshold {0};
+
     JobTypeData (JobTypeInfo const& info_,
             beast::insight::Collector::ptr const& collector, Logs& logs) noexcept
         : m_load (logs.journal ("LoadMonitor"))
@@ -69,6 +89,17 @@ public:
         {
             dequeue = m_collector->make_event (info.name () + "_q");
             execute = m_collector->make_event (info.name ());
+
+            auto const gauges = [this](std::string const& prefix)
+            {
+                Gauges result;
+                result.p50 = m_collector->make_gauge (prefix, "p50");
+                result.p99 = m_collector->make_gauge (prefix, "p99");
+                result.p999 = m_collector->make_gauge (prefix, "p999");
+                return result;
+            };
+            waitGauges = gauges (info.name () + "_wait");
+            runGauges = gauges (info.name () + "_run");
         }
     }
 
@@ -95,6 +126,20 @@ public:
     {
         return m_load.getStats ();
     }
+
+    /* Set the gauges from the latencies of the window */
+    void collect ()
+    {
+        auto const set = [](Gauges& gauges,
+            LatencyWindow::Percentiles const& p)
+        {
+            gauges.p50 = p.p50.count ();
+            gauges.p99 = p.p99.count ();
+            gauges.p999 = p.p999.count ();
+        };
+        set (waitGauges, waitLatency.get ());
+        set (runGauges, runLatency.get ());
+    }
 };
 
 }
@@ -70,6 +70,11 @@ public:
         add (jtCLIENT,        "clientCommand",
             maxLimit, true,   false, 2000,  5000);
 
+        // Database reads for a client command, which is suspended until
+        // they are done. The limit bounds the threads blocked on reads.
+        add (jtCLIENT_IO,     "clientIO",
+            4,        false,  false, 0,     0);
+
         // A websocket command from the client
         add (jtRPC,           "RPC",
             maxLimit, false,  false, 0,     0);
@@ -78,6 +83,10 @@ public:
         add (jtUPDATE_PF,     "updatePaths",
             maxLimit, true,   false, 0,     0);
 
+        // Verify the handshake of a new peer connection
+        add (jtHANDSHAKE,     "peerHandshake",
+            maxLimit, true,   false, 0,     0);
+
         // A transaction received from the network
         add (jtTRANSACTION,   "transaction",
             maxLimit, true,   false, 250,   1000);
@@ -130,6 +139,14 @@ public:
         add (jtDIVIDEND,      "dividend",
             1,        false,  false, 0,     0);
 
+        // Rebuild the incremental dividend index
+        add (jtDIVIDEND_INDEX, "dividendIndex",
+            1,        true,   false, 0,     0);
+
+        // Sign and submit dividend transactions
+        add (jtDIVIDEND_SIGN, "dividendSign",
+            maxLimit, true,   false, 0,     0);
+
         // Sweep for stale structures
         add (jtSWEEP,         "sweep",
             maxLimit, true,   false, 0,     0);
@@ -0,0 +1,81 @@
+#ifndef RIPPLE_CORE_LATENCYWINDOW_H_INCLUDED
+#define RIPPLE_CORE_LATENCYWINDOW_H_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Percentiles of the latencies added over a sliding window.
+
+    The window is split into slices of equal length, and the oldest
+    slice is emptied as time moves past it. Latencies are counted in
+    buckets, four to each doubling, so a percentile is the upper bound
+    of its bucket: at most a quarter above the exact value, and never
+    above the largest latency in the window.
+*/
+class LatencyWindow
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Percentiles
+    {
+        std::uint64_t count = 0;
+        std::chrono::microseconds p50 {0};
+        std::chrono::microseconds p99 {0};
+        std::chrono::microseconds p999 {0};
+        std::chrono::microseconds max {0};
+    };
+
+    static std::size_t const bucketCount = 160;
+
+    explicit
+    LatencyWindow (clock_type::duration window = std::chrono::minutes (1),
+        std::size_t slices = 6);
+
+    LatencyWindow (LatencyWindow const&) = delete;
+    LatencyWindow& operator= (LatencyWindow const&) = delete;
+
+    void
+    add (std::chrono::microseconds latency,
+        clock_type::time_point now = clock_type::now ());
+
+    Percentiles
+    get (clock_type::time_point now = clock_type::now ()) const;
+
+    /** The bucket holding a latency in microseconds. */
+    static
+    std::size_t
+    bucket (std::uint64_t value);
+
+    /** The largest latency a bucket holds. */
+    static
+    std::uint64_t
+    upperBound (std::size_t bucket);
+
+private:
+    struct Slice
+    {
+        std::array <std::uint32_t, bucketCount> counts {};
+        std::uint64_t count = 0;
+        std::uint64_t max = 0;
+
+        // Slice lengths from the epoch of the clock to the slice start
+        std::int64_t index = -1;
+    };
+
+    std::int64_t
+    sliceIndex (clock_type::time_point now) const;
+
+    clock_type::duration const sliceLength_;
+    std::mutex mutable mutex_;
+    std::vector <Slice> slices_;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef RIPPLE_CORE_PROFILER_H_INCLUDED
+#define RIPPLE_CORE_PROFILER_H_INCLUDED
+
+#include <ripple/core/Job.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Sampling profiler of the CPU time of every thread.
+
+    While it runs, a timer signal interrupts the thread using the CPU,
+    which records its stack and the type of the job it runs into a
+    buffer of its own. Another thread drains the buffers and counts each
+    distinct stack. The stacks are reported as folded stacks, one line
+    each, as read by flame graph tools:
+
+        thread;job;outermost frame;...;innermost frame count
+
+    The signal has one handler, so there is one profiler per process.
+*/
+class Profiler
+{
+public:
+    struct Status
+    {
+        bool running = false;
+        int frequency = 0;
+        std::uint64_t samples = 0;
+        std::uint64_t dropped = 0;
+    };
+
+    /** What was sampled between start and stop. */
+    struct Report
+    {
+        Status status;
+        std::string folded;
+    };
+
+    static
+    Profiler&
+    getInstance ();
+
+    Profiler (Profiler const&) = delete;
+    Profiler& operator= (Profiler const&) = delete;
+
+    ~Profiler ();
+
+    /** Start sampling.
+        @param frequency Samples per second of CPU time.
+        @return false if it is running, or if sampling is not supported
+                on this platform.
+    */
+    bool
+    start (int frequency);
+
+    /** Stop sampling.
+        @return The folded stacks, empty if it was not running.
+    */
+    Report
+    stop ();
+
+    Status
+    status () const;
+
+    /** Set the type of the job the calling thread runs.
+        jtINVALID while it runs none.
+    */
+    static
+    void
+    setJobType (JobType type) noexcept;
+
+    class Impl;
+
+private:
+    Profiler ();
+
+    std::mutex mutable mutex_;
+    std::unique_ptr <Impl> impl_;
+};
+
+} // ripple
+
+#endif
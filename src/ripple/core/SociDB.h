@@ -30,9 +30,11 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
+#include <beast/insight/Group.h>
 #include <beast/threads/Thread.h>
 #define SOCI_USE_BOOST
 #include <soci/soci.h>
+#include <algorithm>
 #include <string>
 #include <cstdint>
 #include <vector>
@@ -116,19 +118,72 @@ void convert (soci::blob& from, std::string& to);
 void convert (std::vector<std::uint8_t> const& from, soci::blob& to);
 void convert (std::string const& from, soci::blob& to);
 
+/*  Run a statement for each chunk of up to maxRows rows.
+
+    The statement is the head, then the row once for each row in the
+    chunk with the separator in between, then the tail. Each '?' in the
+    row is bound to the next column, so the values are never formatted
+    into the SQL.
+*/
+template <class... Columns>
+void bulkExecute (soci::session& session, std::size_t maxRows,
+    std::string const& head, std::string const& row,
+    std::string const& separator, std::string const& tail,
+    std::vector<Columns>&... columns)
+{
+    using expand = int[];
+    std::size_t const rows = std::min ({columns.size ()...});
+
+    for (std::size_t first = 0; first < rows; first += maxRows)
+    {
+        std::size_t const last = std::min (rows, first + maxRows);
+        std::string sql (head);
+        soci::statement st (session);
+        int name = 0;
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            if (i != first)
+                sql += separator;
+            for (auto const c : row)
+            {
+                if (c == '?')
+                {
+                    sql += ":p";
+                    sql += std::to_string (name++);
+                }
+                else
+                    sql += c;
+            }
+            (void) expand {0, (st.exchange (soci::use (columns[i])), 0)...};
+        }
+        sql += tail;
+
+        st.alloc ();
+        st.prepare (sql);
+        st.define_and_bind ();
+        st.execute (true);
+    }
+}
+
 class Checkpointer
 {
   public:
     virtual ~Checkpointer() = default;
 };
 
-/** Returns a new checkpointer which makes checkpoints of a
-    soci database every checkpointPageCount pages, using a job on the job queue.
+/** Returns a new checkpointer which makes passive checkpoints of a
+    soci database each time its write ahead log reaches the given number
+    of pages, using a thread of its own.
+
+    The time checkpoints take and the pages they write are reported to
+    the group, which may be null.
 
-    The Checkpointer contains references to the session and job queue
-    and so must outlive them both.
+    The Checkpointer contains a reference to the session and so must not
+    outlive it.
  */
-std::unique_ptr <Checkpointer> makeCheckpointer (soci::session&, JobQueue&, Logs&);
+std::unique_ptr <Checkpointer> makeCheckpointer (soci::session&, int pages,
+    beast::insight::Group::ptr const&, Logs&);
 
 } // ripple
 
@@ -0,0 +1,45 @@
+#ifndef RIPPLE_CORE_THREADPOOLS_H_INCLUDED
+#define RIPPLE_CORE_THREADPOOLS_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/ThreadAffinity.h>
+#include <ripple/json/json_value.h>
+
+namespace ripple {
+
+/** The size and processors of the thread pools, from [threads]. */
+struct ThreadPools
+{
+    struct Pool
+    {
+        /** The number of threads, or zero for the built-in default. */
+        int threads = 0;
+
+        /** The processors the threads run on, or empty for any. */
+        CpuSet cpus;
+    };
+
+    /** The JobQueue workers, which run consensus, ledger and RPC jobs. */
+    Pool jobs;
+
+    /** The io_service threads of the application and of the overlay. */
+    Pool io;
+
+    /** The NodeStore prefetch threads. */
+    Pool nodestore;
+
+    /** The websocket servers. Each port has one thread. */
+    Pool rpc;
+};
+
+/** Read [threads]. Throws std::runtime_error on an invalid value. */
+ThreadPools
+setup_ThreadPools (Section const& section);
+
+/** The configured layout, as reported by server_info. */
+Json::Value
+getJson (ThreadPools const& pools);
+
+} // ripple
+
+#endif
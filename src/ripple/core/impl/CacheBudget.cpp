@@ -0,0 +1,156 @@
+#include <BeastConfig.h>
+#include <ripple/core/CacheBudget.h>
+#include <ripple/basics/Log.h>
+#include <ripple/protocol/JsonFields.h>
+#include <algorithm>
+#include <limits>
+
+namespace ripple {
+
+CacheBudget::CacheBudget (Section const& section, beast::Journal journal)
+    : bytes_ (get<std::uint64_t> (section, "mb", 0) * 1024 * 1024)
+    , journal_ (journal)
+{
+}
+
+void
+CacheBudget::add (Cache cache, int target)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    Entry entry;
+    entry.cache = std::move (cache);
+    entry.target = std::max (target, entry.cache.minimum);
+    entries_.push_back (std::move (entry));
+    scaled_ = false;
+}
+
+void
+CacheBudget::scale ()
+{
+    double total = 0;
+    for (auto const& e : entries_)
+        total += double (e.target) * e.cache.itemBytes;
+
+    for (auto& e : entries_)
+    {
+        // Caches configured with no size share the budget evenly
+        double const bytes = (total == 0)
+            ? double (bytes_) / entries_.size ()
+            : double (bytes_) * e.target * e.cache.itemBytes / total;
+        e.target = std::max (e.cache.minimum,
+            static_cast<int> (std::min (bytes / e.cache.itemBytes,
+                double (std::numeric_limits<int>::max ()))));
+        e.cache.setTargetSize (e.target);
+
+        auto const stats = e.cache.hitsAndMisses ();
+        e.hits = stats.first;
+        e.misses = stats.second;
+
+        JLOG (journal_.info) << e.cache.name << " target " << e.target;
+    }
+    scaled_ = true;
+}
+
+void
+CacheBudget::rebalance ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (! enabled () || entries_.empty ())
+        return;
+
+    if (! scaled_)
+    {
+        scale ();
+        return;
+    }
+
+    // Misses since the last call per byte held. Only a full cache would
+    // have hit some of them with more room, and a cache that is not full
+    // loses nothing by giving room away.
+    std::vector<double> utility (entries_.size (), 0);
+    std::vector<bool> full (entries_.size (), false);
+    for (std::size_t i = 0; i < entries_.size (); ++i)
+    {
+        auto& e = entries_[i];
+        auto const stats = e.cache.hitsAndMisses ();
+        // Statistics that were cleared count from zero again
+        auto const misses = (stats.second < e.misses)
+            ? stats.second : stats.second - e.misses;
+        e.hits = stats.first;
+        e.misses = stats.second;
+
+        full[i] = e.cache.size () >= e.target - e.target / 10;
+        if (full[i])
+            utility[i] = double (misses) /
+                (double (std::max (e.target, 1)) * e.cache.itemBytes);
+    }
+
+    auto receiver = entries_.size ();
+    for (std::size_t i = 0; i < entries_.size (); ++i)
+    {
+        if (full[i] && utility[i] > 0 &&
+                (receiver == entries_.size () ||
+                    utility[i] > utility[receiver]))
+            receiver = i;
+    }
+    if (receiver == entries_.size ())
+        return;
+
+    auto donor = entries_.size ();
+    for (std::size_t i = 0; i < entries_.size (); ++i)
+    {
+        if (i != receiver &&
+                entries_[i].target > entries_[i].cache.minimum &&
+                (donor == entries_.size () ||
+                    utility[i] < utility[donor]))
+            donor = i;
+    }
+    if (donor == entries_.size () ||
+            utility[receiver] < 2 * utility[donor])
+        return;
+
+    auto& from = entries_[donor];
+    auto& to = entries_[receiver];
+
+    std::uint64_t const step = bytes_ / 20;
+    auto const loss = std::min<std::uint64_t> (
+        from.target - from.cache.minimum,
+        std::max<std::uint64_t> (1, step / from.cache.itemBytes));
+    auto const gain = static_cast<int> (std::min<std::uint64_t> (
+        loss * from.cache.itemBytes / to.cache.itemBytes,
+        std::numeric_limits<int>::max () - to.target));
+    if (gain == 0)
+        return;
+
+    from.target -= static_cast<int> (loss);
+    to.target += gain;
+    from.cache.setTargetSize (from.target);
+    to.cache.setTargetSize (to.target);
+
+    JLOG (journal_.debug) << "Moved " << loss * from.cache.itemBytes <<
+        " bytes from " << from.cache.name << " (" << from.target <<
+        ") to " << to.cache.name << " (" << to.target << ")";
+}
+
+Json::Value
+CacheBudget::getJson () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    Json::Value ret (Json::objectValue);
+    ret[jss::mb] = static_cast<Json::UInt> (bytes_ / (1024 * 1024));
+
+    Json::Value& caches = (ret[jss::caches] = Json::objectValue);
+    for (auto const& e : entries_)
+    {
+        auto const stats = e.cache.hitsAndMisses ();
+        Json::Value& cache = (caches[e.cache.name] = Json::objectValue);
+        cache[jss::target_size] = e.target;
+        cache[jss::size] = e.cache.size ();
+        cache[jss::item_bytes] = static_cast<Json::UInt> (e.cache.itemBytes);
+        cache[jss::hits] = std::to_string (stats.first);
+        cache[jss::misses] = std::to_string (stats.second);
+    }
+    return ret;
+}
+
+}
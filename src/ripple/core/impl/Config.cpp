@@ -445,6 +445,12 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_VALIDATION_QUORUM, strTemp, j_))
         VALIDATION_QUORUM   = std::max (0, beast::lexicalCastThrow <int> (strTemp));
 
+    if (getSingleSection (secConfig, SECTION_SAVE_VALIDATIONS, strTemp, j_))
+        SAVE_VALIDATIONS    = beast::lexicalCastThrow <bool> (strTemp);
+
+    if (getSingleSection (secConfig, SECTION_BACKGROUND_VERIFY, strTemp, j_))
+        BACKGROUND_VERIFY   = beast::lexicalCastThrow <bool> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_FEE_ACCOUNT_RESERVE, strTemp, j_))
         FEE_ACCOUNT_RESERVE = beast::lexicalCastThrow <std::uint64_t> (strTemp);
 
@@ -488,6 +494,32 @@ void Config::loadFromString (std::string const& fileContents)
         PATH_SEARCH_FAST    = beast::lexicalCastThrow <int> (strTemp);
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH_MAX, strTemp, j_))
         PATH_SEARCH_MAX     = beast::lexicalCastThrow <int> (strTemp);
+    if (getSingleSection (secConfig, SECTION_PATH_SEARCH_THREADS, strTemp, j_))
+        PATH_SEARCH_THREADS = std::max (1,
+            beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_FETCH_BULK, strTemp, j_))
+        LEDGER_FETCH_BULK = std::max (0,
+            beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
+        LEDGER_REPLAY = std::max (0,
+            beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_CLEANER_THREADS,
+            strTemp, j_))
+        LEDGER_CLEANER_THREADS = std::max (1,
+            beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_LOG_QUEUE, strTemp, j_))
+        LOG_QUEUE = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_PARALLEL_APPLY, strTemp, j_))
+        PARALLEL_APPLY = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
+    if (getSingleSection (secConfig, SECTION_SIGNATURE_BATCH, strTemp, j_))
+        SIGNATURE_BATCH = std::max (0,
+            beast::lexicalCastThrow <int> (strTemp));
 
     if (getSingleSection (secConfig, SECTION_VALIDATORS_FILE, strTemp, j_))
     {
@@ -502,6 +534,8 @@ void Config::loadFromString (std::string const& fileContents)
         for(auto const& s : part.values())
             features.insert(feature(s));
     }
+
+    THREADS = setup_ThreadPools (section (SECTION_THREADS));
 }
 
 int Config::getSize (SizedItemName item) const
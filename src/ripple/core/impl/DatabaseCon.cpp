@@ -20,19 +20,76 @@
 #include <BeastConfig.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/SociDB.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace ripple {
 
+class DatabaseCon::Pool
+{
+public:
+    Pool (std::size_t size, std::string const& connection)
+        : pool_ (size)
+    {
+        stats_.connections = size;
+        for (std::size_t i = 0; i < size; ++i)
+            open (pool_.at (i), "mysql", connection);
+    }
+
+    LockedSociSession
+    checkout ()
+    {
+        auto const start = std::chrono::steady_clock::now ();
+        auto const pos = pool_.lease ();
+        auto const wait = std::chrono::duration_cast<std::chrono::microseconds> (
+            std::chrono::steady_clock::now () - start);
+
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            ++stats_.checkouts;
+            stats_.waitTotal += wait;
+            stats_.waitMax = std::max (stats_.waitMax, wait);
+        }
+        return LockedSociSession (pool_, pos);
+    }
+
+    PoolStats
+    stats () const
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return stats_;
+    }
+
+    // Waits until every session is free
+    void
+    reconnect ()
+    {
+        std::vector<LockedSociSession> sessions;
+        sessions.reserve (stats_.connections);
+        for (std::size_t i = 0; i < stats_.connections; ++i)
+            sessions.emplace_back (pool_, pool_.lease ());
+        for (auto& session : sessions)
+            session->reconnect ();
+    }
+
+private:
+    soci::connection_pool pool_;
+    std::mutex mutable mutex_;
+    PoolStats stats_;
+};
+
 DatabaseCon::DatabaseCon (
     Setup const& setup,
     Type const& type,
     std::string const& strName,
     const char* initStrings[],
     int initCount)
-    : type_ (type)
+    : checkpointPages_ (setup.checkpointPages)
+    , type_ (type)
 {
     auto const useTempFiles  // Use temporary files or regular DB files?
         = setup.standAlone &&
@@ -59,6 +116,60 @@ DatabaseCon::DatabaseCon (
     }
 }
 
+DatabaseCon::DatabaseCon (
+    Setup const& setup,
+    std::string const& connection,
+    PoolSetup const& pool,
+    const char* initStrings[],
+    int initCount)
+    : DatabaseCon (setup, Type::MySQL, connection, initStrings, initCount)
+{
+    // Standalone servers use temporary SQLite files instead
+    if (session_.get_backend_name () != "mysql")
+        return;
+
+    if (pool.readers < 1 || pool.writers < 1)
+        Throw<std::runtime_error> ("Invalid pool size for MySQL");
+
+    writers_ = std::make_unique<Pool> (pool.writers, connection);
+    readers_ = std::make_unique<Pool> (pool.readers,
+        pool.replica.empty () ? connection : pool.replica);
+}
+
+DatabaseCon::~DatabaseCon () = default;
+
+LockedSociSession DatabaseCon::checkoutDb ()
+{
+    if (writers_)
+        return writers_->checkout ();
+    return LockedSociSession (&session_, lock_);
+}
+
+LockedSociSession DatabaseCon::checkoutReadDb ()
+{
+    if (readers_)
+        return readers_->checkout ();
+    return LockedSociSession (&session_, lock_);
+}
+
+DatabaseCon::PoolStats DatabaseCon::getReadStats () const
+{
+    return readers_ ? readers_->stats () : PoolStats ();
+}
+
+DatabaseCon::PoolStats DatabaseCon::getWriteStats () const
+{
+    return writers_ ? writers_->stats () : PoolStats ();
+}
+
+void DatabaseCon::reconnect ()
+{
+    if (writers_)
+        writers_->reconnect ();
+    std::lock_guard<LockedSociSession::mutex> lock (lock_);
+    session_.reconnect ();
+}
+
 DatabaseCon::Setup setup_DatabaseCon (Config const& c)
 {
     DatabaseCon::Setup setup;
@@ -66,15 +177,18 @@ DatabaseCon::Setup setup_DatabaseCon (Config const& c)
     setup.startUp = c.START_UP;
     setup.standAlone = c.RUN_STANDALONE;
     setup.dataDir = c.legacy ("database_path");
+    setup.checkpointPages = get<int> (c.section (ConfigSection::sqlite ()),
+        "checkpoint_pages", setup.checkpointPages);
+    if (setup.checkpointPages < 1)
+        Throw<std::runtime_error> ("Invalid [sqlite] checkpoint_pages");
 
     return setup;
 }
 
-void DatabaseCon::setupCheckpointing (JobQueue* q, Logs& l)
+void DatabaseCon::setupCheckpointing (
+    beast::insight::Group::ptr const& group, Logs& l)
 {
-    if (! q)
-        Throw<std::logic_error> ("No JobQueue");
-    checkpointer_ = makeCheckpointer (session_, *q, l);
+    checkpointer_ = makeCheckpointer (session_, checkpointPages_, group, l);
 }
 
 } // ripple
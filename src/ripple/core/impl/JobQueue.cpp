@@ -22,12 +22,12 @@
 #include <ripple/core/JobTypes.h>
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/core/JobTypeData.h>
+#include <ripple/core/Profiler.h>
 #include <beast/chrono/chrono_util.h>
 #include <beast/module/core/thread/Workers.h>
 #include <chrono>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <thread>
 
 namespace ripple {
@@ -38,6 +38,7 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
     , m_journal (journal)
     , m_lastJob (0)
     , m_invalidJobData (getJobTypes ().getInvalid (), collector, logs)
+    , m_jobCount (0)
     , m_processCount (0)
     , m_workers (*this, "JobQueue", 0)
     , m_cancelCallback (std::bind (&Stoppable::isStopping, this))
@@ -59,6 +60,14 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
                 std::forward_as_tuple (jt, m_collector, logs)));
             assert (result.second == true);
             (void) result.second;
+            result.first->second.outlierThreshold =
+                std::chrono::milliseconds (jt.getPeakLatency ());
+
+            assert (jt.type () >= 0 &&
+                static_cast<std::size_t> (jt.type ()) < numJobTypes);
+            Lane& lane = m_lanes[jt.type ()];
+            lane.data = &result.first->second;
+            lane.limit = jt.limit ();
         }
     }
 }
@@ -73,22 +82,22 @@ void
 JobQueue::collect ()
 {
     std::lock_guard <std::mutex> lock (m_mutex);
-    job_count = m_jobSet.size ();
+    job_count = m_jobCount;
+    for (auto& x : m_jobData)
+        x.second.collect ();
 }
 
 void
 JobQueue::addJob (JobType type, std::string const& name,
-    JobFunction const& func)
+    JobFunction func)
 {
     assert (type != jtINVALID);
 
-    auto iter (m_jobData.find (type));
-    assert (iter != m_jobData.end ());
-    if (iter == m_jobData.end ())
+    Lane* const lane = findLane (type);
+    assert (lane != nullptr);
+    if (lane == nullptr)
         return;
 
-    JobTypeData& data (iter->second);
-
     // FIXME: Workaround incorrect client shutdown ordering
     // do not add jobs to a queue with no threads
     assert (type == jtCLIENT || m_workers.getNumberOfThreads () > 0);
@@ -108,7 +117,7 @@ JobQueue::addJob (JobType type, std::string const& name,
         std::lock_guard <std::mutex> lock (m_mutex);
         assert (! isStopped() && (
             m_processCount>0 ||
-            ! m_jobSet.empty () ||
+            m_jobCount != 0 ||
             ! areChildrenStopped()));
     }
 
@@ -122,13 +131,14 @@ JobQueue::addJob (JobType type, std::string const& name,
         return;
     }
 
+    // The job is made before taking the lock, which is only held to put
+    // it in its lane
+    Job job (type, name, ++m_lastJob, lane->data->load (),
+        std::move (func), m_cancelCallback);
+
     {
         std::lock_guard <std::mutex> lock (m_mutex);
-
-        std::pair <std::set <Job>::iterator, bool> result (
-            m_jobSet.insert (Job (type, name, ++m_lastJob,
-                data.load (), func, m_cancelCallback)));
-        queueJob (*result.first, lock);
+        queueJob (*lane, std::move (job), lock);
     }
 }
 
@@ -137,11 +147,11 @@ JobQueue::getJobCount (JobType t) const
 {
     std::lock_guard <std::mutex> lock (m_mutex);
 
-    JobDataMap::const_iterator c = m_jobData.find (t);
+    Lane const* const lane = findLane (t);
 
-    return (c == m_jobData.end ())
+    return (lane == nullptr)
         ? 0
-        : c->second.waiting;
+        : lane->data->waiting;
 }
 
 int
@@ -149,11 +159,11 @@ JobQueue::getJobCountTotal (JobType t) const
 {
     std::lock_guard <std::mutex> lock (m_mutex);
 
-    JobDataMap::const_iterator c = m_jobData.find (t);
+    Lane const* const lane = findLane (t);
 
-    return (c == m_jobData.end ())
+    return (lane == nullptr)
         ? 0
-        : (c->second.waiting + c->second.running);
+        : (lane->data->waiting + lane->data->running);
 }
 
 int
@@ -200,38 +210,50 @@ JobQueue::setThreadCount (int c, bool const standaloneMode)
     m_workers.setNumberOfThreads (c);
 }
 
+int
+JobQueue::getThreadCount () const
+{
+    return m_workers.getNumberOfThreads ();
+}
+
+void
+JobQueue::setThreadAffinity (CpuSet cpus)
+{
+    m_cpus = std::move (cpus);
+}
+
 LoadEvent::pointer
 JobQueue::getLoadEvent (JobType t, std::string const& name)
 {
-    JobDataMap::iterator iter (m_jobData.find (t));
-    assert (iter != m_jobData.end ());
+    Lane* const lane = findLane (t);
+    assert (lane != nullptr);
 
-    if (iter == m_jobData.end ())
+    if (lane == nullptr)
         return std::shared_ptr<LoadEvent> ();
 
     return std::make_shared<LoadEvent> (
-        std::ref (iter-> second.load ()), name, true);
+        std::ref (lane->data->load ()), name, true);
 }
 
 LoadEvent::autoptr
 JobQueue::getLoadEventAP (JobType t, std::string const& name)
 {
-    JobDataMap::iterator iter (m_jobData.find (t));
-    assert (iter != m_jobData.end ());
+    Lane* const lane = findLane (t);
+    assert (lane != nullptr);
 
-    if (iter == m_jobData.end ())
+    if (lane == nullptr)
         return {};
 
-    return std::make_unique<LoadEvent> (iter-> second.load (), name, true);
+    return std::make_unique<LoadEvent> (lane->data->load (), name, true);
 }
 
 void
 JobQueue::addLoadEvents (JobType t, int count,
     std::chrono::milliseconds elapsed)
 {
-    JobDataMap::iterator iter (m_jobData.find (t));
-    assert (iter != m_jobData.end ());
-    iter->second.load().addSamples (count, elapsed);
+    Lane* const lane = findLane (t);
+    assert (lane != nullptr);
+    lane->data->load().addSamples (count, elapsed);
 }
 
 bool
@@ -297,6 +319,25 @@ JobQueue::getJson (int c)
 
             if (running != 0)
                 pri["in_progress"] = running;
+
+            // Percentiles over the last minute, in microseconds
+            auto const percentiles = [](LatencyWindow const& window)
+            {
+                auto const p = window.get ();
+                Json::Value ret (Json::objectValue);
+                ret["count"] = static_cast<Json::UInt> (p.count);
+                ret["p50"] = static_cast<Json::UInt> (p.p50.count ());
+                ret["p99"] = static_cast<Json::UInt> (p.p99.count ());
+                ret["p999"] = static_cast<Json::UInt> (p.p999.count ());
+                ret["max"] = static_cast<Json::UInt> (p.max.count ());
+                return ret;
+            };
+            auto wait = percentiles (data.waitLatency);
+            if (wait["count"].asUInt () != 0)
+            {
+                pri["wait_us"] = std::move (wait);
+                pri["run_us"] = percentiles (data.runLatency);
+            }
         }
     }
 
@@ -315,18 +356,48 @@ JobQueue::getJobForThread (std::thread::id const& id) const
     return (i == m_threadIds.end()) ? nullptr : i->second;
 }
 
+void
+JobQueue::setOutlierThresholds (Section const& section)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    for (auto& x : m_jobData)
+    {
+        std::uint64_t ms;
+        if (set (ms, x.second.name (), section))
+            x.second.outlierThreshold = std::chrono::milliseconds (ms);
+    }
+}
+
 JobTypeData&
 JobQueue::getJobTypeData (JobType type)
 {
-    JobDataMap::iterator c (m_jobData.find (type));
-    assert (c != m_jobData.end ());
+    Lane* const lane = findLane (type);
+    assert (lane != nullptr);
 
     // NIKB: This is ugly and I hate it. We must remove jtINVALID completely
     //       and use something sane.
-    if (c == m_jobData.end ())
+    if (lane == nullptr)
         return m_invalidJobData;
 
-    return c->second;
+    return *lane->data;
+}
+
+auto
+JobQueue::findLane (JobType type) -> Lane*
+{
+    if (type < 0 || static_cast<std::size_t> (type) >= numJobTypes ||
+            m_lanes[type].data == nullptr)
+        return nullptr;
+    return &m_lanes[type];
+}
+
+auto
+JobQueue::findLane (JobType type) const -> Lane const*
+{
+    if (type < 0 || static_cast<std::size_t> (type) >= numJobTypes ||
+            m_lanes[type].data == nullptr)
+        return nullptr;
+    return &m_lanes[type];
 }
 
 void
@@ -342,22 +413,25 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
     if (isStopping() &&
         areChildrenStopped() &&
         (m_processCount == 0) &&
-        m_jobSet.empty())
+        (m_jobCount == 0))
     {
         stopped();
     }
 }
 
 void
-JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
+JobQueue::queueJob (Lane& lane, Job&& job,
+    std::lock_guard <std::mutex> const& lock)
 {
-    JobType const type (job.getType ());
-    assert (type != jtINVALID);
-    assert (m_jobSet.find (job) != m_jobSet.end ());
+    assert (job.getType () != jtINVALID);
+    assert (lane.data->type () == job.getType ());
+
+    JobTypeData& data (*lane.data);
 
-    JobTypeData& data (getJobTypeData (type));
+    lane.jobs.push_back (std::move (job));
+    ++m_jobCount;
 
-    if (data.waiting + data.running < getJobLimit (type))
+    if (data.waiting + data.running < lane.limit)
     {
         m_workers.addTask ();
     }
@@ -373,32 +447,35 @@ JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
 void
 JobQueue::getNextJob (Job& job)
 {
-    assert (! m_jobSet.empty ());
+    assert (m_jobCount != 0);
 
-    std::set <Job>::const_iterator iter;
-    for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
+    // Later job types have higher priority
+    Lane* lane = nullptr;
+    for (auto iter = m_lanes.rbegin (); iter != m_lanes.rend (); ++iter)
     {
-        JobTypeData& data (getJobTypeData (iter->getType ()));
+        if (iter->jobs.empty ())
+            continue;
+
+        JobTypeData& data (*iter->data);
 
-        assert (data.running <= getJobLimit (data.type ()));
+        assert (data.running <= iter->limit);
 
         // Run this job if we're running below the limit.
-        if (data.running < getJobLimit (data.type ()))
+        if (data.running < iter->limit)
         {
             assert (data.waiting > 0);
+            lane = &*iter;
             break;
         }
     }
 
-    assert (iter != m_jobSet.end ());
+    assert (lane != nullptr);
 
-    JobType const type = iter->getType ();
-    JobTypeData& data (getJobTypeData (type));
+    JobTypeData& data (*lane->data);
 
-    assert (type != jtINVALID);
-
-    job = *iter;
-    m_jobSet.erase (iter);
+    job = std::move (lane->jobs.front ());
+    lane->jobs.pop_front ();
+    --m_jobCount;
 
     m_threadIds[std::this_thread::get_id()] = &job;
 
@@ -411,15 +488,15 @@ JobQueue::finishJob (Job const& job)
 {
     JobType const type = job.getType ();
 
-    assert (m_jobSet.find (job) == m_jobSet.end ());
     assert (type != jtINVALID);
 
-    JobTypeData& data (getJobTypeData (type));
+    Lane& lane = *findLane (type);
+    JobTypeData& data (*lane.data);
 
     // Queue a deferred task if possible
     if (data.deferred > 0)
     {
-        assert (data.running + data.waiting >= getJobLimit (type));
+        assert (data.running + data.waiting >= lane.limit);
 
         --data.deferred;
         m_workers.addTask ();
@@ -452,6 +529,30 @@ void JobQueue::on_execute (JobType type,
         getJobTypeData (type).execute.notify (ms);
 }
 
+void
+JobQueue::on_finish (Job const& job, JobTypeData& data,
+    Job::clock_type::duration wait, Job::clock_type::duration run)
+{
+    using namespace std::chrono;
+
+    data.waitLatency.add (duration_cast <microseconds> (wait));
+    data.runLatency.add (duration_cast <microseconds> (run));
+
+    auto const threshold = data.outlierThreshold;
+    if (threshold.count () == 0 || (wait <= threshold && run <= threshold))
+        return;
+
+    if (auto stream = m_journal.warning)
+    {
+        auto const p99 = data.runLatency.get ().p99;
+        stream << "Slow " << data.name () << " job '" << job.getName () <<
+            "': waited " << duration_cast <milliseconds> (wait).count () <<
+            "ms, ran " << duration_cast <milliseconds> (run).count () <<
+            "ms, p99 run over the last minute " <<
+            duration_cast <milliseconds> (p99).count () << "ms";
+    }
+}
+
 void
 JobQueue::processTask ()
 {
@@ -470,15 +571,37 @@ JobQueue::processTask ()
     //
     if (!isStopping() || !data.info.skip ())
     {
-        beast::Thread::setCurrentThreadName (data.name ());
+        // Naming the thread is a system call, so it is only done when the
+        // thread runs a different type of job
+        static thread_local JobType named = jtINVALID;
+        if (named != job.getType ())
+        {
+            beast::Thread::setCurrentThreadName (data.name ());
+            named = job.getType ();
+        }
+
+        static thread_local bool pinned = false;
+        if (! pinned)
+        {
+            if (! setCurrentThreadAffinity (m_cpus))
+                m_journal.warning << "Unable to set the processors of a "
+                    "job thread";
+            pinned = true;
+        }
         m_journal.trace << "Doing " << data.name () << " job";
 
         Job::clock_type::time_point const start_time (
             Job::clock_type::now());
 
         on_dequeue (job.getType (), start_time - job.queue_time ());
+        Profiler::setJobType (job.getType ());
         job.doJob ();
-        on_execute (job.getType (), Job::clock_type::now() - start_time);
+        Profiler::setJobType (jtINVALID);
+
+        auto const finish_time = Job::clock_type::now();
+        on_execute (job.getType (), finish_time - start_time);
+        on_finish (job, data, start_time - job.queue_time (),
+            finish_time - start_time);
     }
     else
     {
@@ -505,15 +628,6 @@ JobQueue::skipOnStop (JobType type)
     return j.skip ();
 }
 
-int
-JobQueue::getJobLimit (JobType type)
-{
-    JobTypeInfo const& j (getJobTypes ().get (type));
-    assert (j.type () != jtINVALID);
-
-    return j.limit ();
-}
-
 void
 JobQueue::onStop ()
 {
@@ -0,0 +1,112 @@
+#include <BeastConfig.h>
+#include <ripple/core/LatencyWindow.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace ripple {
+
+LatencyWindow::LatencyWindow (clock_type::duration window, std::size_t slices)
+    : sliceLength_ (window / std::max <std::size_t> (slices, 1))
+    , slices_ (std::max <std::size_t> (slices, 1))
+{
+    assert (sliceLength_.count () > 0);
+}
+
+std::int64_t
+LatencyWindow::sliceIndex (clock_type::time_point now) const
+{
+    return now.time_since_epoch () / sliceLength_;
+}
+
+std::size_t
+LatencyWindow::bucket (std::uint64_t value)
+{
+    if (value < 4)
+        return value;
+
+    // The doubling holding the value, then its quarter of it
+    int msb = 63;
+    while (! (value >> msb))
+        --msb;
+    std::size_t const result = (msb - 1) * 4 + ((value >> (msb - 2)) & 3);
+    return std::min (result, bucketCount - 1);
+}
+
+std::uint64_t
+LatencyWindow::upperBound (std::size_t bucket)
+{
+    if (bucket < 4)
+        return bucket;
+
+    auto const msb = bucket / 4 + 1;
+    auto const width = std::uint64_t (1) << (msb - 2);
+    return (4 + bucket % 4) * width + width - 1;
+}
+
+void
+LatencyWindow::add (std::chrono::microseconds latency,
+    clock_type::time_point now)
+{
+    auto const value = static_cast<std::uint64_t> (
+        std::max <std::int64_t> (latency.count (), 0));
+    auto const index = sliceIndex (now);
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto& slice = slices_[index % slices_.size ()];
+    if (slice.index != index)
+        slice = Slice {};
+    slice.index = index;
+    ++slice.counts[bucket (value)];
+    ++slice.count;
+    slice.max = std::max (slice.max, value);
+}
+
+LatencyWindow::Percentiles
+LatencyWindow::get (clock_type::time_point now) const
+{
+    auto const index = sliceIndex (now);
+    auto const oldest = index - static_cast<std::int64_t> (slices_.size ());
+
+    std::array <std::uint64_t, bucketCount> counts {};
+    Percentiles result;
+    std::uint64_t max = 0;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        for (auto const& slice : slices_)
+        {
+            if (slice.index <= oldest || slice.index > index)
+                continue;
+            for (std::size_t i = 0; i < bucketCount; ++i)
+                counts[i] += slice.counts[i];
+            result.count += slice.count;
+            max = std::max (max, slice.max);
+        }
+    }
+
+    if (result.count == 0)
+        return result;
+
+    auto const percentile = [&](double p)
+    {
+        auto const rank = static_cast<std::uint64_t> (
+            std::ceil (p * result.count));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucketCount; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+                return std::chrono::microseconds (
+                    std::min (upperBound (i), max));
+        }
+        return std::chrono::microseconds (max);
+    };
+
+    result.p50 = percentile (0.5);
+    result.p99 = percentile (0.99);
+    result.p999 = percentile (0.999);
+    result.max = std::chrono::microseconds (max);
+    return result;
+}
+
+} // ripple
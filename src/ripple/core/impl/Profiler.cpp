@@ -0,0 +1,404 @@
+#include <BeastConfig.h>
+#include <ripple/core/Profiler.h>
+#include <ripple/core/JobTypes.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#endif
+
+namespace ripple {
+
+namespace {
+
+// The job of each thread is set even while nothing samples, so it is
+// a plain value the signal handler can read.
+thread_local JobType currentJob = jtINVALID;
+
+}
+
+void
+Profiler::setJobType (JobType type) noexcept
+{
+    currentJob = type;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int const maxThreads = 64;
+
+// Frames kept per sample, past the handler and the signal trampoline
+int const maxDepth = 48;
+int const skipFrames = 2;
+
+// Samples a thread can hold before the drain thread takes them
+std::uint64_t const ringSize = 256;
+
+std::chrono::milliseconds const drainInterval (20);
+
+struct Sample
+{
+    JobType job;
+    int depth;
+    void* frames[maxDepth + skipFrames];
+};
+
+// Filled by the signal handler of one thread, drained by another
+struct Ring
+{
+    std::atomic <pid_t> owner {0};
+    char name[17] = {};
+    std::atomic <std::uint64_t> head {0};
+    std::atomic <std::uint64_t> tail {0};
+    Sample samples[ringSize];
+};
+
+std::atomic <Ring*> rings {nullptr};
+std::atomic <bool> sampling {false};
+std::atomic <int> inHandler {0};
+std::atomic <std::uint32_t> run {0};
+std::atomic <std::uint64_t> dropped {0};
+
+// The ring of the calling thread in the current run
+thread_local Ring* threadRing = nullptr;
+thread_local std::uint32_t threadRun = 0;
+
+Ring*
+claimRing (Ring* all)
+{
+    pid_t const tid = static_cast<pid_t> (syscall (SYS_gettid));
+    for (int i = 0; i < maxThreads; ++i)
+    {
+        pid_t expected = 0;
+        if (all[i].owner.compare_exchange_strong (expected, tid))
+        {
+            prctl (PR_GET_NAME, all[i].name, 0, 0, 0);
+            return &all[i];
+        }
+    }
+    return nullptr;
+}
+
+// Only async signal safe calls from here on. backtrace is, once it
+// has been called outside of a handler and has loaded the unwinder.
+void
+onSignal (int)
+{
+    int const savedErrno = errno;
+    inHandler.fetch_add (1);
+    if (sampling.load ())
+    {
+        auto const current = run.load (std::memory_order_relaxed);
+        if (threadRun != current)
+        {
+            threadRun = current;
+            threadRing = claimRing (rings.load ());
+        }
+
+        auto const ring = threadRing;
+        auto const head = ring ?
+            ring->head.load (std::memory_order_relaxed) : 0;
+        if (! ring ||
+            head - ring->tail.load (std::memory_order_acquire) >= ringSize)
+        {
+            dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+        else
+        {
+            auto& sample = ring->samples[head % ringSize];
+            sample.job = currentJob;
+            sample.depth = backtrace (sample.frames, maxDepth + skipFrames);
+            ring->head.store (head + 1, std::memory_order_release);
+        }
+    }
+    inHandler.fetch_sub (1);
+    errno = savedErrno;
+}
+
+std::string
+symbolize (void* address)
+{
+    Dl_info info;
+    if (dladdr (address, &info) && info.dli_sname)
+    {
+        int status = 0;
+        char* const demangled = abi::__cxa_demangle (
+            info.dli_sname, nullptr, nullptr, &status);
+        std::string result = status == 0 ? demangled : info.dli_sname;
+        std::free (demangled);
+        return result;
+    }
+
+    // Without a symbol, the module and the offset into it
+    std::ostringstream ss;
+    if (info.dli_fname && *info.dli_fname)
+    {
+        std::string const module (info.dli_fname);
+        ss << module.substr (module.find_last_of ('/') + 1) << "+0x" <<
+            std::hex << (static_cast<char*> (address) -
+                static_cast<char*> (info.dli_fbase));
+    }
+    else
+    {
+        ss << address;
+    }
+    return ss.str ();
+}
+
+}
+
+class Profiler::Impl
+{
+public:
+    using Key = std::tuple <std::string, JobType, std::vector <void*>>;
+
+    explicit
+    Impl (int frequency)
+        : frequency_ (frequency)
+        , rings_ (new Ring[maxThreads])
+    {
+        // Load the unwinder before any handler needs it
+        void* frames[1];
+        backtrace (frames, 1);
+
+        // The handler is never removed, since a signal still pending
+        // while stopping would otherwise end the process.
+        static std::once_flag installed;
+        std::call_once (installed, []
+        {
+            struct sigaction action {};
+            action.sa_handler = &onSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset (&action.sa_mask);
+            sigaction (SIGPROF, &action, nullptr);
+        });
+
+        dropped = 0;
+        rings = rings_.get ();
+        ++run;
+        sampling = true;
+
+        auto const interval = std::max (1000000 / frequency, 1);
+        itimerval timer {};
+        timer.it_interval.tv_sec = interval / 1000000;
+        timer.it_interval.tv_usec = interval % 1000000;
+        timer.it_value = timer.it_interval;
+        setitimer (ITIMER_PROF, &timer, nullptr);
+
+        thread_ = std::thread (&Impl::drainLoop, this);
+    }
+
+    ~Impl ()
+    {
+        if (thread_.joinable ())
+            finish ();
+    }
+
+    // Stop the timer and wait for handlers still recording
+    void
+    finish ()
+    {
+        itimerval timer {};
+        setitimer (ITIMER_PROF, &timer, nullptr);
+        sampling = false;
+        while (inHandler.load () != 0)
+            std::this_thread::yield ();
+
+        stop_ = true;
+        thread_.join ();
+        drain ();
+        rings = nullptr;
+    }
+
+    Status
+    status () const
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        Status result;
+        result.running = true;
+        result.frequency = frequency_;
+        result.samples = samples_;
+        result.dropped = dropped.load ();
+        return result;
+    }
+
+    std::string
+    folded () const
+    {
+        static JobTypes const types;
+        std::unordered_map <void*, std::string> names;
+
+        // Stacks at different addresses in the same functions fold together
+        std::map <std::string, std::uint64_t> stacks;
+        for (auto const& entry : counts_)
+        {
+            auto const& thread = std::get<0> (entry.first);
+            auto const job = std::get<1> (entry.first);
+            auto const& frames = std::get<2> (entry.first);
+
+            std::string stack = thread.empty () ? "unnamed" : thread;
+            stack += ';';
+            stack += job == jtINVALID ? "none" : types.get (job).name ();
+
+            // Outer frames are return addresses, one byte past their call
+            for (auto iter = frames.rbegin (); iter != frames.rend (); ++iter)
+            {
+                auto const address = static_cast<char*> (*iter) -
+                    (iter + 1 == frames.rend () ? 0 : 1);
+                auto found = names.find (address);
+                if (found == names.end ())
+                    found = names.emplace (address,
+                        symbolize (address)).first;
+                stack += ';';
+                stack += found->second;
+            }
+            stacks[stack] += entry.second;
+        }
+
+        std::ostringstream ss;
+        for (auto const& stack : stacks)
+            ss << stack.first << ' ' << stack.second << '\n';
+        return ss.str ();
+    }
+
+private:
+    void
+    drainLoop ()
+    {
+        while (! stop_)
+        {
+            std::this_thread::sleep_for (drainInterval);
+            drain ();
+        }
+    }
+
+    void
+    drain ()
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        for (int i = 0; i < maxThreads; ++i)
+        {
+            auto& ring = rings_[i];
+            if (ring.owner.load () == 0)
+                continue;
+
+            auto const head = ring.head.load (std::memory_order_acquire);
+            auto tail = ring.tail.load (std::memory_order_relaxed);
+            for (; tail != head; ++tail)
+            {
+                auto const& sample = ring.samples[tail % ringSize];
+                if (sample.depth <= skipFrames)
+                    continue;
+                ++counts_[std::make_tuple (std::string (ring.name),
+                    sample.job, std::vector <void*> (
+                        sample.frames + skipFrames,
+                            sample.frames + sample.depth))];
+                ++samples_;
+            }
+            ring.tail.store (tail, std::memory_order_release);
+        }
+    }
+
+    int const frequency_;
+    std::unique_ptr <Ring[]> rings_;
+    std::mutex mutable mutex_;
+    std::map <Key, std::uint64_t> counts_;
+    std::uint64_t samples_ = 0;
+    std::atomic <bool> stop_ {false};
+    std::thread thread_;
+};
+
+bool
+Profiler::start (int frequency)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    if (impl_ || frequency <= 0)
+        return false;
+    impl_ = std::make_unique <Impl> (frequency);
+    return true;
+}
+
+Profiler::Report
+Profiler::stop ()
+{
+    std::unique_ptr <Impl> impl;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        impl = std::move (impl_);
+    }
+
+    Report report;
+    if (impl)
+    {
+        impl->finish ();
+        report.status = impl->status ();
+        report.status.running = false;
+        report.folded = impl->folded ();
+    }
+    return report;
+}
+
+Profiler::Status
+Profiler::status () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return impl_ ? impl_->status () : Status ();
+}
+
+#else
+
+class Profiler::Impl
+{
+};
+
+bool
+Profiler::start (int)
+{
+    return false;
+}
+
+Profiler::Report
+Profiler::stop ()
+{
+    return {};
+}
+
+Profiler::Status
+Profiler::status () const
+{
+    return {};
+}
+
+#endif
+
+Profiler&
+Profiler::getInstance ()
+{
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler () = default;
+
+Profiler::~Profiler () = default;
+
+} // ripple
@@ -23,7 +23,10 @@
 #include <ripple/core/ConfigSections.h>
 #include <ripple/core/SociDB.h>
 #include <ripple/core/Config.h>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <thread>
 #include <soci/sqlite3/soci-sqlite3.h>
 #ifdef USE_MYSQL
 #include <soci/mysql/soci-mysql.h>
@@ -33,8 +36,6 @@
 
 namespace ripple {
 
-static auto checkpointPageCount = 1000;
-
 namespace detail {
 
 std::pair<std::string, soci::backend_factory const&>
@@ -211,90 +212,164 @@ void convert (std::string const& from, soci::blob& to)
 namespace {
 
 /** Run a thread to checkpoint the write ahead log (wal) for
-    the given soci::session every 1000 pages. This is only implemented
-    for sqlite databases.
-
-    Note: According to: https://www.sqlite.org/wal.html#ckpt this
-    is the default behavior of sqlite. We may be able to remove this
-    class.
+    the given soci::session once it has grown by a number of pages.
+    This is only implemented for sqlite databases.
+
+    The checkpoints are passive and made through a connection of their
+    own, so they do not hold the mutex of the connection writing to the
+    database while the pages are copied and synced. Installing the hook
+    turns off the automatic checkpoints sqlite would otherwise make as
+    part of a commit.
 */
 class WALCheckpointer : public Checkpointer
 {
 public:
-    WALCheckpointer (sqlite_api::sqlite3& conn, JobQueue& q, Logs& logs)
-            : conn_ (conn), jobQueue_ (q), j_ (logs.journal ("WALCheckpointer"))
+    WALCheckpointer (sqlite_api::sqlite3& conn, int pages,
+        beast::insight::Group::ptr const& group, Logs& logs)
+            : conn_ (conn)
+            , pages_ (std::max (pages, 1))
+            , j_ (logs.journal ("WALCheckpointer"))
     {
+        if (group)
+        {
+            checkpoints_ = group->make_counter ("checkpoints");
+            time_ = group->make_event ("checkpoint_time");
+            written_ = group->make_event ("checkpoint_pages");
+        }
+
+        // Reading the schema puts the new connection in wal mode
+        auto fname = sqlite_api::sqlite3_db_filename (&conn_, "main");
+        if (fname && *fname && (sqlite_api::sqlite3_open_v2 (
+                fname, &own_, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK ||
+            sqlite_api::sqlite3_exec (own_, "PRAGMA schema_version;",
+                nullptr, nullptr, nullptr) != SQLITE_OK))
+        {
+            JLOG (j_.warning)
+                << "WAL(" << fname << "): no connection to checkpoint, "
+                "sharing the writer's: " << sqlite_api::sqlite3_errmsg (own_);
+            sqlite_api::sqlite3_close (own_);
+            own_ = nullptr;
+        }
+
+        thread_ = std::thread (&WALCheckpointer::run, this);
         sqlite_api::sqlite3_wal_hook (&conn_, &sqliteWALHook, this);
     }
 
-    ~WALCheckpointer () override = default;
+    ~WALCheckpointer () override
+    {
+        sqlite_api::sqlite3_wal_hook (&conn_, nullptr, nullptr);
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            stop_ = true;
+        }
+        cond_.notify_one ();
+        thread_.join ();
+        if (own_)
+            sqlite_api::sqlite3_close (own_);
+    }
 
 private:
     sqlite_api::sqlite3& conn_;
-    std::mutex mutex_;
-    JobQueue& jobQueue_;
-
-    bool running_ = false;
+    // Our connection to the same file, null if it could not be opened
+    sqlite_api::sqlite3* own_ = nullptr;
+    int const pages_;
     beast::Journal j_;
 
+    beast::insight::Counter checkpoints_;
+    beast::insight::Event time_;
+    beast::insight::Event written_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool pending_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+
     static
     int sqliteWALHook (
         void* cp, sqlite_api::sqlite3*, const char* dbName, int walSize)
     {
-        if (walSize >= checkpointPageCount)
-        {
-            if (auto checkpointer = reinterpret_cast <WALCheckpointer*> (cp))
-                checkpointer->scheduleCheckpoint();
-            else
-                Throw<std::logic_error> ("Didn't get a WALCheckpointer");
-        }
+        auto checkpointer = reinterpret_cast <WALCheckpointer*> (cp);
+        if (! checkpointer)
+            Throw<std::logic_error> ("Didn't get a WALCheckpointer");
+        if (walSize >= checkpointer->pages_)
+            checkpointer->scheduleCheckpoint ();
         return SQLITE_OK;
     }
 
+    // Called by the writer with its connection locked, so it only wakes
+    // the thread.
     void scheduleCheckpoint ()
     {
         {
             std::lock_guard <std::mutex> lock (mutex_);
-            if (running_)
+            if (pending_)
                 return;
-            running_ = true;
+            pending_ = true;
         }
+        cond_.notify_one ();
+    }
+
+    void run ()
+    {
+        beast::Thread::setCurrentThreadName ("WALCheckpointer");
 
-        jobQueue_.addJob (jtWAL, "WAL", [this] (Job&) { checkpoint(); });
+        std::unique_lock <std::mutex> lock (mutex_);
+        for (;;)
+        {
+            cond_.wait (lock, [this] { return pending_ || stop_; });
+            if (stop_)
+                return;
+
+            lock.unlock ();
+            checkpoint ();
+            lock.lock ();
+            pending_ = false;
+        }
     }
 
     void checkpoint ()
     {
+        auto const conn = own_ ? own_ : &conn_;
+        auto const start = std::chrono::steady_clock::now ();
         int log = 0, ckpt = 0;
-        int ret = sqlite3_wal_checkpoint_v2 (
-            &conn_, nullptr, SQLITE_CHECKPOINT_PASSIVE, &log, &ckpt);
+        int ret = sqlite_api::sqlite3_wal_checkpoint_v2 (
+            conn, nullptr, SQLITE_CHECKPOINT_PASSIVE, &log, &ckpt);
+        auto const elapsed =
+            std::chrono::duration_cast <std::chrono::milliseconds> (
+                std::chrono::steady_clock::now () - start);
 
-        auto fname = sqlite3_db_filename (&conn_, "main");
+        auto fname = sqlite_api::sqlite3_db_filename (conn, "main");
         if (ret != SQLITE_OK)
         {
-            auto& jm = (ret == SQLITE_LOCKED) ? j_.trace : j_.warning;
+            auto& jm = (ret == SQLITE_LOCKED || ret == SQLITE_BUSY)
+                ? j_.trace : j_.warning;
             JLOG (jm)
                 << "WAL(" << fname << "): error " << ret;
+            return;
         }
-        else
-        {
-            JLOG (j_.trace)
-                << "WAL(" << fname << "): frames="
-                << log << ", written=" << ckpt;
-        }
 
-        std::lock_guard <std::mutex> lock (mutex_);
-        running_ = false;
+        ++checkpoints_;
+        time_.notify (static_cast <beast::insight::Event::value_type> (
+            elapsed));
+        written_.notify (beast::insight::Event::value_type (ckpt));
+
+        auto& jm = (elapsed >= std::chrono::seconds (1))
+            ? j_.warning : j_.trace;
+        JLOG (jm)
+            << "WAL(" << fname << "): frames=" << log
+            << ", written=" << ckpt << ", " << elapsed.count () << "ms";
     }
 };
 
 } // namespace
 
 std::unique_ptr <Checkpointer> makeCheckpointer (
-    soci::session& session, JobQueue& queue, Logs& logs)
+    soci::session& session, int pages,
+    beast::insight::Group::ptr const& group, Logs& logs)
 {
     if (auto conn = getConnection (session))
-        return std::make_unique <WALCheckpointer> (*conn, queue, logs);
+        return std::make_unique <WALCheckpointer> (*conn, pages, group, logs);
     return {};
 }
 
@@ -0,0 +1,58 @@
+#include <BeastConfig.h>
+#include <ripple/core/ThreadPools.h>
+#include <ripple/basics/contract.h>
+#include <ripple/protocol/JsonFields.h>
+#include <stdexcept>
+
+namespace ripple {
+
+static
+void
+setup (ThreadPools::Pool& pool, Section const& section,
+    std::string const& name, bool sized)
+{
+    if (sized)
+    {
+        set (pool.threads, name, section);
+        if (pool.threads < 0 || pool.threads > 1024)
+            Throw<std::runtime_error> ("Invalid [threads] " + name);
+    }
+    std::string cpus;
+    if (set (cpus, name + "_cpus", section))
+        pool.cpus = parseCpuSet (cpus);
+}
+
+ThreadPools
+setup_ThreadPools (Section const& section)
+{
+    ThreadPools pools;
+    setup (pools.jobs, section, "jobs", true);
+    setup (pools.io, section, "io", true);
+    setup (pools.nodestore, section, "nodestore", true);
+    setup (pools.rpc, section, "rpc", false);
+    return pools;
+}
+
+static
+Json::Value
+getJson (ThreadPools::Pool const& pool)
+{
+    Json::Value ret (Json::objectValue);
+    if (pool.threads != 0)
+        ret[jss::threads] = pool.threads;
+    ret[jss::cpus] = pool.cpus.empty () ? "any" : to_string (pool.cpus);
+    return ret;
+}
+
+Json::Value
+getJson (ThreadPools const& pools)
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::jobs] = getJson (pools.jobs);
+    ret[jss::io] = getJson (pools.io);
+    ret[jss::nodestore] = getJson (pools.nodestore);
+    ret[jss::rpc] = getJson (pools.rpc);
+    return ret;
+}
+
+} // ripple
@@ -0,0 +1,144 @@
+#include <BeastConfig.h>
+#include <ripple/core/CacheBudget.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class CacheBudget_test : public beast::unit_test::suite
+{
+public:
+    struct FakeCache
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        int size = 0;
+        int target = 0;
+
+        CacheBudget::Cache
+        make (std::string const& name, std::size_t itemBytes, int minimum)
+        {
+            return { name, itemBytes, minimum,
+                [this] () { return std::make_pair (hits, misses); },
+                [this] () { return size; },
+                [this] (int s) { target = s; } };
+        }
+    };
+
+    static
+    Section
+    budget (int mb)
+    {
+        Section section;
+        if (mb != 0)
+            section.set ("mb", std::to_string (mb));
+        return section;
+    }
+
+    void
+    testDisabled ()
+    {
+        testcase ("disabled");
+
+        CacheBudget cb (budget (0), beast::Journal ());
+        expect (! cb.enabled ());
+
+        FakeCache a;
+        a.target = 100;
+        cb.add (a.make ("a", 100, 0), 100);
+        cb.rebalance ();
+        expect (a.target == 100, "untouched");
+    }
+
+    void
+    testScale ()
+    {
+        testcase ("scale");
+
+        CacheBudget cb (budget (1), beast::Journal ());
+        expect (cb.enabled ());
+
+        FakeCache a, b;
+        cb.add (a.make ("a", 100, 0), 1000);
+        cb.add (b.make ("b", 300, 0), 1000);
+        cb.rebalance ();
+
+        // Each keeps its share of the configured bytes
+        expect (a.target == 2621, std::to_string (a.target));
+        expect (b.target == 2621, std::to_string (b.target));
+        expect (a.target * 100 + b.target * 300 <= 1024 * 1024);
+
+        auto const json = cb.getJson ();
+        expect (json[jss::mb].asUInt () == 1);
+        expect (json[jss::caches]["a"][jss::target_size].asInt () == 2621);
+        expect (json[jss::caches]["b"][jss::item_bytes].asUInt () == 300);
+    }
+
+    void
+    testRebalance ()
+    {
+        testcase ("rebalance");
+
+        CacheBudget cb (budget (1), beast::Journal ());
+        FakeCache a, b;
+        cb.add (a.make ("a", 100, 0), 1000);
+        cb.add (b.make ("b", 100, 500), 1000);
+        cb.rebalance ();
+        expect (a.target == 5242 && b.target == 5242);
+
+        // Nobody misses: nothing moves
+        a.size = a.target;
+        b.size = b.target;
+        cb.rebalance ();
+        expect (a.target == 5242 && b.target == 5242, "no misses");
+
+        // Both full, a misses far more often
+        a.misses += 1000;
+        b.misses += 10;
+        cb.rebalance ();
+        expect (a.target == 5242 + 524, std::to_string (a.target));
+        expect (b.target == 5242 - 524, std::to_string (b.target));
+
+        // Misses at similar rates: nothing moves
+        a.size = a.target;
+        b.size = b.target;
+        a.misses += 100;
+        b.misses += 80;
+        cb.rebalance ();
+        expect (a.target == 5242 + 524, "similar rates");
+
+        // b misses but a is not full, so a gives way for free
+        a.size = 0;
+        b.misses += 10;
+        cb.rebalance ();
+        expect (b.target == 5242, std::to_string (b.target));
+
+        // a keeps missing, b never goes below its minimum
+        for (int i = 0; i < 40; ++i)
+        {
+            a.size = a.target;
+            b.size = b.target;
+            a.misses += 1000;
+            cb.rebalance ();
+        }
+        expect (b.target == 500, std::to_string (b.target));
+        expect (a.target * 100 + b.target * 100 <= 1024 * 1024);
+
+        // Cleared statistics count from zero
+        a.misses = 0;
+        b.misses = 0;
+        cb.rebalance ();
+        expect (b.target == 500);
+    }
+
+    void
+    run () override
+    {
+        testDisabled ();
+        testScale ();
+        testRebalance ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CacheBudget,core,ripple);
+
+}
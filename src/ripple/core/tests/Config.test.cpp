@@ -346,10 +346,47 @@ port_wss_admin
                     "dbPath No Path");
         }
     }
+    void testThreads ()
+    {
+        testcase ("threads");
+
+        {
+            Config c;
+            c.loadFromString ("");
+            expect (c.THREADS.jobs.threads == 0);
+            expect (c.THREADS.io.cpus.empty ());
+        }
+        {
+            Config c;
+            c.loadFromString (R"rippleConfig(
+[threads]
+jobs = 6
+jobs_cpus = 0-5
+io_cpus = 6,7
+nodestore = 2
+rpc_cpus = 8
+)rippleConfig");
+            expect (c.THREADS.jobs.threads == 6);
+            expect (to_string (c.THREADS.jobs.cpus) == "0-5");
+            expect (c.THREADS.io.threads == 0);
+            expect (to_string (c.THREADS.io.cpus) == "6-7");
+            expect (c.THREADS.nodestore.threads == 2);
+            expect (c.THREADS.nodestore.cpus.empty ());
+            expect (to_string (c.THREADS.rpc.cpus) == "8");
+        }
+        expectException ([] {
+            Config c;
+            c.loadFromString ("[threads]\njobs = -1\n");});
+        expectException ([] {
+            Config c;
+            c.loadFromString ("[threads]\nio_cpus = 3-1\n");});
+    }
+
     void run ()
     {
         testLegacy ();
         testDbPath ();
+        testThreads ();
     }
 };
 
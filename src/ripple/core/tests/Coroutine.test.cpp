@@ -103,11 +103,59 @@ public:
         expect(i == 1);
     }
 
+    void
+    test_await()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env(*this);
+        std::atomic<int> i{0};
+        std::condition_variable cv;
+        auto& jq = env.app().getJobQueue();
+        jq.setThreadCount(0, false);
+        jq.postCoro(jtCLIENT, "Coroutine-Test",
+            [&](std::shared_ptr<JobCoro> jc)
+            {
+                i += jc->await(jtCLIENT_IO, "Coroutine-Test",
+                    []()
+                    {
+                        return 1;
+                    });
+                try
+                {
+                    jc->await(jtCLIENT_IO, "Coroutine-Test",
+                        []() -> int
+                        {
+                            Throw<std::runtime_error>("await");
+                            return 0;
+                        });
+                }
+                catch (std::runtime_error const&)
+                {
+                    ++i;
+                }
+                cv.notify_one();
+            });
+
+        {
+            std::mutex m;
+            std::unique_lock<std::mutex> lk(m);
+            expect(cv.wait_for(lk, 1s,
+                [&]()
+                {
+                    return i == 2;
+                }));
+        }
+        jq.shutdown();
+        expect(i == 2);
+    }
+
     void
     run()
     {
         test_coroutine();
         test_incorrect_order();
+        test_await();
     }
 };
 
@@ -0,0 +1,220 @@
+#include <BeastConfig.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/basics/Log.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/threads/Stoppable.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+// A job queue with its own root, which is stopped when it is destroyed
+class TestJobQueue
+{
+public:
+    explicit
+    TestJobQueue (int threads)
+        : root_ ("root")
+        , jq_ (beast::insight::NullCollector::New (), root_,
+            beast::Journal (), logs_)
+    {
+        jq_.setThreadCount (threads, false);
+        root_.prepare ();
+        root_.start ();
+    }
+
+    ~TestJobQueue ()
+    {
+        root_.stop ();
+    }
+
+    JobQueue&
+    operator* ()
+    {
+        return jq_;
+    }
+
+    JobQueue*
+    operator-> ()
+    {
+        return &jq_;
+    }
+
+private:
+    beast::RootStoppable root_;
+    Logs logs_;
+    JobQueue jq_;
+};
+
+// Counts down, and wakes a waiting thread when it reaches zero
+class Latch
+{
+public:
+    explicit
+    Latch (int count)
+        : count_ (count)
+    {
+    }
+
+    void
+    countDown ()
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (--count_ == 0)
+            cv_.notify_all ();
+    }
+
+    void
+    wait ()
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        cv_.wait (lock, [this] { return count_ <= 0; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int count_;
+};
+
+class JobQueue_test : public beast::unit_test::suite
+{
+public:
+    void
+    testPriority ()
+    {
+        testcase ("priority");
+
+        TestJobQueue jq (1);
+
+        // Hold the only thread while the other jobs are added
+        Latch started (1);
+        Latch release (1);
+        Latch done (6);
+        jq->addJob (jtCLIENT, "block", [&](Job&)
+            {
+                started.countDown ();
+                release.wait ();
+                done.countDown ();
+            });
+        started.wait ();
+
+        std::mutex mutex;
+        std::vector<std::string> order;
+        auto add = [&](JobType type, std::string const& name)
+        {
+            jq->addJob (type, name, [&, name](Job&)
+                {
+                    {
+                        std::lock_guard <std::mutex> lock (mutex);
+                        order.push_back (name);
+                    }
+                    done.countDown ();
+                });
+        };
+        add (jtPACK, "pack1");
+        add (jtTRANSACTION, "tx1");
+        add (jtPACK, "pack2");
+        add (jtADMIN, "admin");
+        add (jtTRANSACTION, "tx2");
+        expect (jq->getJobCount (jtPACK) == 2);
+        expect (jq->getJobCountGE (jtTRANSACTION) == 3);
+
+        release.countDown ();
+        done.wait ();
+
+        std::vector<std::string> const expected {
+            "admin", "tx1", "tx2", "pack1", "pack2" };
+        expect (order == expected);
+    }
+
+    void
+    testLimit ()
+    {
+        testcase ("limit");
+
+        TestJobQueue jq (6);
+
+        int const count = 12;
+        Latch done (count);
+        std::mutex mutex;
+        int running = 0;
+        int most = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            jq->addJob (jtLEDGER_REQ, "limited", [&](Job&)
+                {
+                    {
+                        std::lock_guard <std::mutex> lock (mutex);
+                        most = std::max (most, ++running);
+                    }
+                    std::this_thread::sleep_for (
+                        std::chrono::milliseconds (5));
+                    {
+                        std::lock_guard <std::mutex> lock (mutex);
+                        --running;
+                    }
+                    done.countDown ();
+                });
+        }
+        done.wait ();
+
+        // JobTypes limits ledger requests to two at a time
+        expect (most >= 1 && most <= 2, std::to_string (most));
+    }
+
+    void
+    run () override
+    {
+        testPriority ();
+        testLimit ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JobQueue,core,ripple);
+
+//------------------------------------------------------------------------------
+
+class JobQueue_timing_test : public beast::unit_test::suite
+{
+public:
+    void
+    run () override
+    {
+        int const count = 500000;
+        for (int threads : {1, 4})
+        {
+            TestJobQueue jq (threads);
+            Latch done (count);
+
+            using clock = std::chrono::steady_clock;
+            auto const start = clock::now ();
+            for (int i = 0; i < count; ++i)
+            {
+                jq->addJob ((i % 2) ? jtTRANSACTION : jtCLIENT, "timing",
+                    [&](Job&)
+                    {
+                        done.countDown ();
+                    });
+            }
+            done.wait ();
+            auto const elapsed = std::chrono::duration_cast<
+                std::chrono::milliseconds> (clock::now () - start);
+
+            log << count << " empty jobs on " << threads << " threads: " <<
+                elapsed.count () << "ms";
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueue_timing,core,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,103 @@
+#include <BeastConfig.h>
+#include <ripple/core/LatencyWindow.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class LatencyWindow_test : public beast::unit_test::suite
+{
+public:
+    using us = std::chrono::microseconds;
+
+    void
+    testBuckets ()
+    {
+        testcase ("buckets");
+
+        // Every value falls in the bucket whose bounds hold it, and the
+        // buckets follow each other with no gaps.
+        bool ok = true;
+        std::uint64_t lower = 0;
+        for (std::size_t i = 0; ok && i + 1 < LatencyWindow::bucketCount; ++i)
+        {
+            auto const upper = LatencyWindow::upperBound (i);
+            ok = upper >= lower &&
+                LatencyWindow::bucket (lower) == i &&
+                LatencyWindow::bucket (upper) == i;
+            // A bucket is at most a quarter of its lower bound wide
+            if (lower >= 4)
+                ok = ok && (upper - lower + 1) * 4 <= lower;
+            lower = upper + 1;
+        }
+        expect (ok, "buckets are contiguous");
+        expect (LatencyWindow::bucket (~std::uint64_t (0)) ==
+            LatencyWindow::bucketCount - 1);
+    }
+
+    void
+    testPercentiles ()
+    {
+        testcase ("percentiles");
+
+        LatencyWindow::clock_type::time_point now {std::chrono::hours (1)};
+        LatencyWindow window;
+        expect (window.get (now).count == 0);
+
+        // 990 fast jobs, 9 slow ones and one very slow
+        for (int i = 0; i < 990; ++i)
+            window.add (us (100), now);
+        for (int i = 0; i < 9; ++i)
+            window.add (us (10000), now);
+        window.add (us (1000000), now);
+
+        auto const p = window.get (now);
+        expect (p.count == 1000);
+        expect (p.p50 >= us (100) && p.p50 <= us (125));
+        expect (p.p99 >= us (100) && p.p99 <= us (125));
+        expect (p.p999 >= us (10000) && p.p999 <= us (12500));
+        expect (p.max == us (1000000));
+
+        // The bound never passes the largest value
+        LatencyWindow one;
+        one.add (us (1000), now);
+        expect (one.get (now).p50 == us (1000));
+    }
+
+    void
+    testSliding ()
+    {
+        testcase ("sliding");
+
+        using namespace std::chrono;
+        LatencyWindow::clock_type::time_point now {hours (1)};
+        LatencyWindow window (minutes (1), 6);
+
+        window.add (us (5000), now);
+        window.add (us (10), now + seconds (30));
+        expect (window.get (now + seconds (35)).count == 2);
+        expect (window.get (now + seconds (35)).max == us (5000));
+
+        // Once a minute has passed the first latency is gone
+        auto const later = window.get (now + seconds (65));
+        expect (later.count == 1);
+        expect (later.max == us (10));
+
+        // A latency added long after empties the slice it reuses
+        window.add (us (20), now + minutes (10));
+        auto const last = window.get (now + minutes (10));
+        expect (last.count == 1);
+        expect (last.max == us (20));
+    }
+
+    void
+    run () override
+    {
+        testBuckets ();
+        testPercentiles ();
+        testSliding ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LatencyWindow,ripple_core,ripple);
+
+} // ripple
@@ -0,0 +1,80 @@
+#include <BeastConfig.h>
+#include <ripple/core/Profiler.h>
+#include <beast/unit_test/suite.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace ripple {
+
+class Profiler_test : public beast::unit_test::suite
+{
+public:
+    // Use the CPU under a job type until told to stop
+    static
+    void
+    spin (std::atomic <bool>& stop, std::atomic <std::uint64_t>& sink)
+    {
+        Profiler::setJobType (jtCLIENT);
+        std::uint64_t x = 1;
+        while (! stop.load (std::memory_order_relaxed))
+        {
+            for (int i = 0; i < 10000; ++i)
+                x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            sink += x;
+        }
+        Profiler::setJobType (jtINVALID);
+    }
+
+    void
+    run () override
+    {
+        auto& profiler = Profiler::getInstance ();
+        expect (! profiler.status ().running);
+        expect (profiler.stop ().folded.empty ());
+
+        if (! profiler.start (1000))
+        {
+            pass ();
+            log << "Sampling is not supported on this platform";
+            return;
+        }
+        expect (profiler.status ().running);
+        expect (profiler.status ().frequency == 1000);
+        expect (! profiler.start (1000), "only one run at a time");
+
+        std::atomic <bool> stop {false};
+        std::atomic <std::uint64_t> sink {0};
+        std::thread thread (&Profiler_test::spin,
+            std::ref (stop), std::ref (sink));
+        std::this_thread::sleep_for (std::chrono::milliseconds (300));
+        stop = true;
+        thread.join ();
+
+        auto const report = profiler.stop ();
+        expect (! profiler.status ().running);
+        expect (! report.status.running);
+        expect (report.status.samples > 0, "samples were taken");
+        expect (report.folded.find (";clientCommand;") != std::string::npos,
+            "stacks carry the job type");
+
+        // Every line is a stack and a count
+        bool folded = ! report.folded.empty ();
+        std::size_t start = 0;
+        while (folded && start < report.folded.size ())
+        {
+            auto const end = report.folded.find ('\n', start);
+            auto const space = report.folded.rfind (' ', end);
+            folded = end != std::string::npos && space != std::string::npos &&
+                space > start && space + 1 < end &&
+                    std::stoul (report.folded.substr (space + 1,
+                        end - space - 1)) > 0;
+            start = end + 1;
+        }
+        expect (folded, "folded stacks");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Profiler,ripple_core,ripple);
+
+} // ripple
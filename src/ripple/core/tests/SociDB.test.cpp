@@ -26,6 +26,8 @@
 #include <ripple/basics/BasicConfig.h>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <thread>
 
 namespace ripple {
 class SociDB_test final : public TestSuite
@@ -362,12 +364,47 @@ public:
         if (is_regular_file (dbPath))
             remove (dbPath);
     }
+    void testSQLiteCheckpoint ()
+    {
+        testcase ("checkpoint");
+        BasicConfig c;
+        setupSQLiteConfig (c, getDatabasePath ());
+        SociConfig sc (c, "SociTestDB");
+        boost::filesystem::path dbPath (sc.connectionString ());
+        {
+            soci::session s;
+            sc.open (s);
+            s << "PRAGMA journal_mode=WAL;";
+            s << "CREATE TABLE Blobs (Data BLOB);";
+            Logs logs;
+            auto checkpointer = makeCheckpointer (s, 8, {}, logs);
+            expect (bool (checkpointer));
+
+            // Until a checkpoint the pages stay in the log
+            auto const empty = boost::filesystem::file_size (dbPath);
+            std::string const blob (4096, 'x');
+            for (int i = 0; i < 16; ++i)
+                s << "INSERT INTO Blobs (Data) VALUES (:d);", soci::use (blob);
+
+            auto grown = false;
+            for (int i = 0; i < 500 && ! grown; ++i)
+            {
+                std::this_thread::sleep_for (std::chrono::milliseconds (10));
+                grown = boost::filesystem::file_size (dbPath) > empty;
+            }
+            expect (grown, "checkpointed");
+        }
+        using namespace boost::filesystem;
+        if (is_regular_file (dbPath))
+            remove (dbPath);
+    }
     void testSQLite ()
     {
         testSQLiteFileNames ();
         testSQLiteSession ();
         testSQLiteSelect ();
         testSQLiteDeleteWithSubselect();
+        testSQLiteCheckpoint ();
     }
     void run ()
     {
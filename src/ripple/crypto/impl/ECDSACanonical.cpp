@@ -20,9 +20,9 @@
 #include <BeastConfig.h>
 #include <ripple/crypto/ECDSACanonical.h>
 #include <beast/unit_test/suite.h>
-#include <openssl/bn.h>
-#include <openssl/ecdsa.h>
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
 
@@ -30,126 +30,86 @@ namespace ripple {
 
 namespace detail {
 
-// A simple wrapper for a BIGNUM to make it
-// easier to allocate, construct, and free them
-struct BigNum
+// A number of a signature, as 32 big-endian bytes. Every number a
+// canonical signature holds fits, so none needs a heap allocation.
+using SigNumber = std::array <std::uint8_t, 32>;
+
+// The order of the secp256k1 group
+static SigNumber const order = {{
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+    0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b,
+    0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41 }};
+
+// Half the order, rounded down. As the order is odd, S <= order - S
+// exactly when S is no more than this.
+static SigNumber const halfOrder = {{
+    0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x5d, 0x57, 0x6e, 0x73, 0x57, 0xa4, 0x50, 0x1d,
+    0xdf, 0xe9, 0x2f, 0x46, 0x68, 0x1b, 0x20, 0xa0 }};
+
+inline
+int
+compare (SigNumber const& a, SigNumber const& b)
 {
-    BIGNUM* num;
-
-    BigNum& operator=(BigNum const&) = delete;
-
-    BigNum ()
-        : num (BN_new ())
-    {
-
-    }
-
-    BigNum (const char *hex)
-        : num (BN_new ())
-    {
-        BN_hex2bn (&num, hex);
-    }
-
-    BigNum (unsigned char const* ptr, std::size_t len)
-        : num (BN_new ())
-    {
-        set (ptr, len);
-    }
-
-    BigNum (BigNum const& other)
-        : num (BN_new ())
-    {
-        if (BN_copy (num, other.num) == nullptr)
-            BN_clear (num);
-    }
-
-    ~BigNum ()
-    {
-        BN_free (num);
-    }
-
-    operator BIGNUM* ()
-    {
-        return num;
-    }
-
-    operator BIGNUM const* () const
-    {
-        return num;
-    }
+    return std::memcmp (a.data (), b.data (), a.size ());
+}
 
-    bool set (unsigned char const* ptr, std::size_t len)
+// Load up to 32 big-endian bytes, ignoring any before the last 32
+inline
+void
+load (SigNumber& number, unsigned char const* data, std::size_t size)
+{
+    if (size > number.size ())
     {
-        if (BN_bin2bn (ptr, len, num) == nullptr)
-            return false;
-
-        return true;
+        data += size - number.size ();
+        size = number.size ();
     }
-};
+    number.fill (0);
+    std::memcpy (number.data () + number.size () - size, data, size);
+}
 
-class SignaturePart
+// Parse a part of a signature and return the bytes it takes, or zero
+// if it is malformed or too large to be below the order.
+//  Format: <02> <length of number> <number>
+static
+std::size_t
+sigPart (unsigned char const* sig, std::size_t size, SigNumber& number)
 {
-private:
-    std::size_t m_skip;
-    BigNum m_bn;
-
-public:
-    SignaturePart (unsigned char const* sig, std::size_t size)
-        : m_skip (0)
-    {
-        // The format is: <02> <length of signature> <signature>
-        if ((size < 3) || (sig[0] != 0x02))
-            return;
-
-        std::size_t const len (sig[1]);
+    if ((size < 3) || (sig[0] != 0x02))
+        return 0;
 
-        // Claimed length can't be longer than amount of data available
-        if (len > (size - 2))
-            return;
+    std::size_t const len (sig[1]);
 
-        // Signature must be between 1 and 33 bytes.
-        if ((len < 1) || (len > 33))
-            return;
+    // Claimed length can't be longer than amount of data available
+    if (len > (size - 2))
+        return 0;
 
-        // The signature can't be negative
-        if ((sig[2] & 0x80) != 0)
-            return;
+    // Number must be between 1 and 33 bytes.
+    if ((len < 1) || (len > 33))
+        return 0;
 
-        // It can't be zero
-        if ((sig[2] == 0) && (len == 1))
-            return;
-
-        // And it can't be padded
-        if ((sig[2] == 0) && ((sig[3] & 0x80) == 0))
-            return;
-
-        // Load the signature (ignore the marker prefix and length) and if
-        // successful, count the number of bytes we consumed.
-        if (m_bn.set (sig + 2, len))
-            m_skip = len + 2;
-    }
+    // The number can't be negative
+    if ((sig[2] & 0x80) != 0)
+        return 0;
 
-    bool valid () const
-    {
-        return m_skip != 0;
-    }
+    // It can't be zero
+    if ((sig[2] == 0) && (len == 1))
+        return 0;
 
-    // The signature as a BIGNUM
-    BigNum getBigNum () const
-    {
-        return m_bn;
-    }
+    // And it can't be padded
+    if ((sig[2] == 0) && ((sig[3] & 0x80) == 0))
+        return 0;
 
-    // Returns the number of bytes to skip for this signature part
-    std::size_t skip () const
-    {
-        return m_skip;
-    }
-};
+    // Of 33 bytes, only the first may be the pad; otherwise the number
+    // is past 2^256.
+    if ((len == 33) && (sig[2] != 0))
+        return 0;
 
-// The SECp256k1 modulus
-static BigNum const modulus (
-    "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141");
+    load (number, sig + 2, len);
+    return len + 2;
+}
 
 } // detail
 
@@ -182,38 +142,35 @@ bool isCanonicalECDSASig (void const* vSig, std::size_t sigLen, ECDSA strict_par
     sig += 2;
     sigLen -= 2;
 
-    // Verify the R signature
-    detail::SignaturePart sigR (sig, sigLen);
+    // Verify the R signature, and eat the number of bytes it took
+    detail::SigNumber r;
+    std::size_t skip = detail::sigPart (sig, sigLen, r);
 
-    if (!sigR.valid ())
+    if (skip == 0)
         return false;
 
-    // Eat the number of bytes we consumed
-    sig += sigR.skip ();
-    sigLen -= sigR.skip ();
+    sig += skip;
+    sigLen -= skip;
 
-    // Verify the S signature
-    detail::SignaturePart sigS (sig, sigLen);
+    // Verify the S signature, and eat the number of bytes it took
+    detail::SigNumber s;
+    skip = detail::sigPart (sig, sigLen, s);
 
-    if (!sigS.valid ())
+    if (skip == 0)
         return false;
 
-    // Eat the number of bytes we consumed
-    sig += sigS.skip ();
-    sigLen -= sigS.skip ();
+    sig += skip;
+    sigLen -= skip;
 
     // Nothing should remain at this point.
     if (sigLen != 0)
         return false;
 
     // Check whether R or S are greater than the modulus.
-    auto bnR (sigR.getBigNum ());
-    auto bnS (sigS.getBigNum ());
-
-    if (BN_cmp (bnR, detail::modulus) != -1)
+    if (detail::compare (r, detail::order) >= 0)
         return false;
 
-    if (BN_cmp (bnS, detail::modulus) != -1)
+    if (detail::compare (s, detail::order) >= 0)
         return false;
 
     // For a given signature, (R,S), the signature (R, N-S) is also valid. For
@@ -221,12 +178,7 @@ bool isCanonicalECDSASig (void const* vSig, std::size_t sigLen, ECDSA strict_par
     // be specified. If operating in strict mode, check that as well.
     if (strict_param == ECDSA::strict)
     {
-        detail::BigNum mS;
-
-        if (BN_sub (mS, detail::modulus, bnS) == 0)
-            return false;
-
-        if (BN_cmp (bnS, mS) == 1)
+        if (detail::compare (s, detail::halfOrder) > 0)
             return false;
     }
 
@@ -243,40 +195,52 @@ bool isCanonicalECDSASig (void const* vSig, std::size_t sigLen, ECDSA strict_par
 bool makeCanonicalECDSASig (void* vSig, std::size_t& sigLen)
 {
     unsigned char * sig = reinterpret_cast<unsigned char *> (vSig);
-    bool ret = false;
 
     // Find internals
     int rLen = sig[3];
     int sPos = rLen + 6, sLen = sig[rLen + 5];
 
-    detail::BigNum origS, newS;
-    BN_bin2bn (&sig[sPos], sLen, origS);
-    BN_sub (newS, detail::modulus, origS);
+    detail::SigNumber origS;
+    detail::load (origS, &sig[sPos], sLen);
 
-    if (BN_cmp (origS, newS) == 1)
-    { // original signature is not fully canonical
-        unsigned char newSbuf [64];
-        int newSlen = BN_bn2bin (newS, newSbuf);
+    if (detail::compare (origS, detail::halfOrder) <= 0)
+        return true;
 
-        if ((newSbuf[0] & 0x80) == 0)
-        { // no extra padding byte is needed
-            sig[1] = sig[1] - sLen + newSlen;
-            sig[sPos - 1] = newSlen;
-            std::memcpy (&sig[sPos], newSbuf, newSlen);
-        }
-        else
-        { // an extra padding byte is needed
-            sig[1] = sig[1] - sLen + newSlen + 1;
-            sig[sPos - 1] = newSlen + 1;
-            sig[sPos] = 0;
-            std::memcpy (&sig[sPos + 1], newSbuf, newSlen);
-        }
-        sigLen = sig[1] + 2;
+    // The original signature is not fully canonical: subtract S from
+    // the order, byte by byte from the least significant.
+    detail::SigNumber newS;
+    int borrow = 0;
+    for (std::size_t i = newS.size (); i-- != 0;)
+    {
+        int const d = detail::order[i] - origS[i] - borrow;
+        borrow = d < 0;
+        newS[i] = static_cast <std::uint8_t> (d);
+    }
+
+    // S was past the order, so was never canonical
+    if (borrow != 0)
+        return false;
+
+    auto const newSbuf = std::find_if (newS.begin (), newS.end (),
+        [](std::uint8_t b) { return b != 0; });
+    int const newSlen = std::distance (newSbuf, newS.end ());
+
+    if ((newSbuf[0] & 0x80) == 0)
+    { // no extra padding byte is needed
+        sig[1] = sig[1] - sLen + newSlen;
+        sig[sPos - 1] = newSlen;
+        std::memcpy (&sig[sPos], &*newSbuf, newSlen);
     }
     else
-        ret = true;
+    { // an extra padding byte is needed
+        sig[1] = sig[1] - sLen + newSlen + 1;
+        sig[sPos - 1] = newSlen + 1;
+        sig[sPos] = 0;
+        std::memcpy (&sig[sPos + 1], &*newSbuf, newSlen);
+    }
+    sigLen = sig[1] + 2;
 
-    return ret;
+    return false;
 }
 
 template <class FwdIter, class Container>
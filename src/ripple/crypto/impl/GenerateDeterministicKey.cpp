@@ -19,50 +19,17 @@
 
 #include <BeastConfig.h>
 #include <ripple/crypto/GenerateDeterministicKey.h>
-#include <ripple/crypto/impl/ec_key.h>
-#include <ripple/crypto/impl/openssl.h>
+#include <ripple/basics/contract.h>
 #include <ripple/protocol/digest.h>
-#include <beast/module/core/diagnostic/FatalError.h>
+#include <ripple/protocol/impl/secp256k1.h>
 #include <array>
+#include <stdexcept>
 #include <string>
-#include <openssl/pem.h>
-#include <openssl/sha.h>
 
 namespace ripple {
 
-namespace openssl {
-
-struct secp256k1_data
-{
-    EC_GROUP const* group;
-    bignum order;
-
-    secp256k1_data ()
-    {
-        group = EC_GROUP_new_by_curve_name (NID_secp256k1);
-
-        if (!group)
-            beast::FatalError ("The OpenSSL library on this system lacks elliptic curve support.");
-
-        bn_ctx ctx;
-        order = get_order (group, ctx);
-    }
-};
-
-static secp256k1_data const secp256k1curve;
-
-}  // namespace openssl
-
-using namespace openssl;
-
-static Blob serialize_ec_point (ec_point const& point)
-{
-    Blob result (33);
-
-    serialize_ec_point (point, &result[0]);
-
-    return result;
-}
+// The derivation uses the precomputed tables of the process wide
+// libsecp256k1 context, which the signing and verifying code shares.
 
 template <class FwdIt>
 void
@@ -74,16 +41,24 @@ copy_uint32 (FwdIt out, std::uint32_t v)
     *out   =  v        & 0xff;
 }
 
-// #define EC_DEBUG
-
 // Functions to add support for deterministic EC keys
 
+// A hash is a valid secret key if it is not zero and is
+// less than the curve's order.
+static
+bool
+isValidSecret (uint256 const& key)
+{
+    return secp256k1_ec_seckey_verify (
+        secp256k1Context(), key.data()) == 1;
+}
+
 // --> seed
 // <-- private root generator + public root generator
-static bignum generateRootDeterministicKey (uint128 const& seed)
+static uint256 generateRootDeterministicKey (uint128 const& seed)
 {
     // find non-zero private key less than the curve's order
-    bignum privKey;
+    uint256 privKey;
     std::uint32_t seq = 0;
 
     do
@@ -93,12 +68,10 @@ static bignum generateRootDeterministicKey (uint128 const& seed)
         std::array<std::uint8_t, 20> buf;
         std::copy(seed.begin(), seed.end(), buf.begin());
         copy_uint32 (buf.begin() + 16, seq++);
-        auto root = sha512Half(buf);
+        privKey = sha512Half(buf);
         std::fill (buf.begin(), buf.end(), 0); // security erase
-        privKey.assign ((unsigned char const*) &root, sizeof (root));
-        root.zero(); // security erase
     }
-    while (privKey.is_zero() || privKey >= secp256k1curve.order);
+    while (! isValidSecret (privKey));
 
     return privKey;
 }
@@ -107,41 +80,33 @@ static bignum generateRootDeterministicKey (uint128 const& seed)
 // <-- private root generator + public root generator
 Blob generateRootDeterministicPublicKey (uint128 const& seed)
 {
-    bn_ctx ctx;
-
-    bignum privKey = generateRootDeterministicKey (seed);
+    uint256 privKey = generateRootDeterministicKey (seed);
 
     // compute the corresponding public key point
-    ec_point pubKey = multiply (secp256k1curve.group, privKey, ctx);
+    Blob result (33);
+    int len = 0;
+    auto const ok = secp256k1_ec_pubkey_create (secp256k1Context(),
+        result.data(), &len, privKey.data(), 1);
 
-    privKey.clear();  // security erase
+    privKey.zero();  // security erase
 
-    return serialize_ec_point (pubKey);
-}
+    if (ok != 1 || len != 33)
+        Throw<std::runtime_error> ("secp256k1_ec_pubkey_create failed");
 
-uint256 generateRootDeterministicPrivateKey (uint128 const& seed)
-{
-    bignum key = generateRootDeterministicKey (seed);
-
-    return uint256_from_bignum_clear (key);
+    return result;
 }
 
-// Take ripple address.
-// --> root public generator (consumes)
-// <-- root public generator in EC format
-static ec_point generateRootPubKey (bignum&& pubGenerator)
+uint256 generateRootDeterministicPrivateKey (uint128 const& seed)
 {
-    ec_point pubPoint = bn2point (secp256k1curve.group, pubGenerator.get());
-
-    return pubPoint;
+    return generateRootDeterministicKey (seed);
 }
 
 // --> public generator
-static bignum makeHash (Blob const& pubGen, int seq, bignum const& order)
+static uint256 makeHash (Blob const& pubGen, int seq)
 {
     int subSeq = 0;
 
-    bignum result;
+    uint256 result;
 
     assert(pubGen.size() == 33);
     do
@@ -152,11 +117,10 @@ static bignum makeHash (Blob const& pubGen, int seq, bignum const& order)
         std::copy (pubGen.begin(), pubGen.end(), buf.begin());
         copy_uint32 (buf.begin() + 33, seq);
         copy_uint32 (buf.begin() + 37, subSeq++);
-        auto root = sha512Half_s(buf);
+        result = sha512Half_s(buf);
         std::fill(buf.begin(), buf.end(), 0); // security erase
-        result.assign ((unsigned char const*) &root, sizeof (root));
     }
-    while (result.is_zero()  ||  result >= order);
+    while (! isValidSecret (result));
 
     return result;
 }
@@ -165,20 +129,15 @@ static bignum makeHash (Blob const& pubGen, int seq, bignum const& order)
 Blob generatePublicDeterministicKey (Blob const& pubGen, int seq)
 {
     // publicKey(n) = rootPublicKey EC_POINT_+ Hash(pubHash|seq)*point
-    ec_point rootPubKey = generateRootPubKey (bignum (pubGen));
-
-    bn_ctx ctx;
-
-    // Calculate the private additional key.
-    bignum hash = makeHash (pubGen, seq, secp256k1curve.order);
-
-    // Calculate the corresponding public key.
-    ec_point newPoint = multiply (secp256k1curve.group, hash, ctx);
+    uint256 const hash = makeHash (pubGen, seq);
 
-    // Add the master public key and set.
-    add_to (secp256k1curve.group, rootPubKey, newPoint, ctx);
+    Blob result (pubGen);
+    if (secp256k1_ec_pubkey_tweak_add (secp256k1Context(),
+            result.data(), static_cast<int>(result.size()),
+                hash.data()) != 1)
+        Throw<std::runtime_error> ("secp256k1_ec_pubkey_tweak_add failed");
 
-    return serialize_ec_point (newPoint);
+    return result;
 }
 
 // --> root private key
@@ -186,19 +145,17 @@ uint256 generatePrivateDeterministicKey (
     Blob const& pubGen, uint128 const& seed, int seq)
 {
     // privateKey(n) = (rootPrivateKey + Hash(pubHash|seq)) % order
-    bignum rootPrivKey = generateRootDeterministicKey (seed);
-
-    bn_ctx ctx;
+    uint256 privKey = generateRootDeterministicKey (seed);
 
     // calculate the private additional key
-    bignum privKey = makeHash (pubGen, seq, secp256k1curve.order);
+    uint256 const hash = makeHash (pubGen, seq);
 
     // calculate the final private key
-    add_to (rootPrivKey, privKey, secp256k1curve.order, ctx);
+    if (secp256k1_ec_privkey_tweak_add (secp256k1Context(),
+            privKey.data(), hash.data()) != 1)
+        privKey.zero();
 
-    rootPrivKey.clear();  // security erase
-
-    return uint256_from_bignum_clear (privKey);
+    return privKey;
 }
 
 } // ripple
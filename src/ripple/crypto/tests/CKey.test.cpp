@@ -20,7 +20,9 @@
 #include <BeastConfig.h>
 #include <ripple/crypto/GenerateDeterministicKey.h>
 #include <ripple/basics/base_uint.h>
+#include <ripple/basics/StringUtilities.h>
 #include <beast/unit_test/suite.h>
+#include <stdexcept>
 
 namespace ripple {
 
@@ -34,8 +36,10 @@ class CKey_test : public beast::unit_test::suite
 {
 public:
     void
-    run ()
+    testRoot ()
     {
+        testcase ("root keys");
+
         uint128 seed1, seed2;
         seed1.SetHex ("71ED064155FFADFA38782C5E0158CB26");
         seed2.SetHex ("CF0C3BE4485961858C4198515AE5B965");
@@ -50,6 +54,69 @@ public:
         unexpected (to_string (priv2) != "98BC2EACB26EB021D1A6293C044D88BA2F0B"
                     "6729A2772DEEBF2E21A263C1740B",
                     "Incorrect private key for generator");
+
+        expect (strHex (generateRootDeterministicPublicKey (seed1)) ==
+            "0388E5BA87A000CB807240DF8C848EB0B5FFA5C8E5A521BC8E105C0F0A44217828",
+            "Incorrect public generator");
+    }
+
+    // The keys derived by the original OpenSSL implementation
+    void
+    testDerived ()
+    {
+        testcase ("derived keys");
+
+        uint128 seed;
+        seed.SetHex ("71ED064155FFADFA38782C5E0158CB26");
+        auto const generator = generateRootDeterministicPublicKey (seed);
+
+        struct Vector
+        {
+            int seq;
+            char const* publicKey;
+            char const* privateKey;
+        };
+
+        Vector const vectors[] =
+        {
+            { 0,
+                "03FA25B68DA6FF6832E4462FDFB9A2AAA58888C0ED17285FFE92E4465E0C6E782A",
+                "A5EF877564D096EA445E72FDA77C77BB45002261087C69D57CEA56B008102D52" },
+            { 1,
+                "030C6107ED84D7FAA4B14AFEC5CAEE6F389104EA867A000CC887E2EF59FBF38E09",
+                "20876B1A06B8BDF5C88D416D65CDC483DC16D1856CA4C8426121180885805C37" },
+            { 1000000,
+                "028D064D3A9103A7C5251065B5F5CE54B7AC7293E9524DDCFEB60B87FB0B4D30FA",
+                "1050A4502FF1C0EAAB5B1AD2EEA7C044DE41B6DEBE3D90A9EF2BC850B4369DC2" }
+        };
+
+        for (auto const& v : vectors)
+        {
+            expect (strHex (generatePublicDeterministicKey (
+                generator, v.seq)) == v.publicKey);
+            expect (to_string (generatePrivateDeterministicKey (
+                generator, seed, v.seq)) == v.privateKey);
+        }
+
+        // A generator which is not a point on the curve
+        Blob bad (generator);
+        bad[0] = 0x05;
+        try
+        {
+            generatePublicDeterministicKey (bad, 0);
+            fail ("invalid generator");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    void
+    run ()
+    {
+        testRoot ();
+        testDerived ();
     }
 };
 
@@ -299,6 +299,58 @@ public:
             "Spadded");
     }
 
+    // Verify the checks at the edges of the range of R and S
+    void testBoundaries ()
+    {
+        testcase ("Boundary values");
+
+        expect (isStrictlyCanonical ("3044"
+            "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A0"),
+            "S is half the order");
+
+        expect (isValid ("3044"
+            "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A1"),
+            "S is past half the order");
+
+        expect (!isStrictlyCanonical ("3044"
+            "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A1"),
+            "S is past half the order");
+
+        expect (isStrictlyCanonical ("3045"
+            "022100FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364140"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A0"),
+            "R is one below the order");
+
+        expect (!isValid ("3045"
+            "022100FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A0"),
+            "R is the order");
+
+        expect (!isValid ("3045"
+            "0221015990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+            "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A0"),
+            "R is past 2^256");
+
+        convertNonCanonical (
+            "3044"
+                "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+                "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A1",
+            "3044"
+                "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+                "02207FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF5D576E7357A4501DDFE92F46681B20A0");
+
+        convertNonCanonical (
+            "3045"
+                "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+                "022100FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364140",
+            "3025"
+                "02205990E0584B2B238E1DFAAD8D6ED69ECC1A4A13AC85FC0B31D0DF395EB1BA6105"
+                "020101");
+    }
+
     void convertNonCanonical(std::string const& hex, std::string const& canonHex)
     {
         Blob b (loadSignature(hex));
@@ -372,6 +424,7 @@ public:
         testStrictlyCanonicalSignatures ();
         testMalformedSignatures ();
         testCanonicalConversions ();
+        testBoundaries ();
     }
 };
 
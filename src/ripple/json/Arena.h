@@ -0,0 +1,116 @@
+#ifndef RIPPLE_JSON_ARENA_H_INCLUDED
+#define RIPPLE_JSON_ARENA_H_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Json {
+
+namespace detail {
+
+struct ArenaImpl
+{
+    ArenaImpl* prev = nullptr;
+    void* block = nullptr;
+};
+
+/** Allocates memory for a Json::Value.
+    The memory comes from the calling thread's Arena if there is one.
+*/
+void* allocate (std::size_t bytes);
+
+/** Frees memory from allocate(), on any thread. */
+void deallocate (void* p) noexcept;
+
+/** Standard allocator for the containers inside a Json::Value. */
+template <class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator () = default;
+
+    template <class U>
+    ArenaAllocator (ArenaAllocator<U> const&)
+    {
+    }
+
+    T*
+    allocate (std::size_t n)
+    {
+        static_assert (std::alignment_of<T>::value <=
+            std::alignment_of<void*>::value, "");
+        return static_cast<T*> (detail::allocate (n * sizeof (T)));
+    }
+
+    void
+    deallocate (T* p, std::size_t)
+    {
+        detail::deallocate (p);
+    }
+
+    template <class U>
+    bool
+    operator== (ArenaAllocator<U> const&) const
+    {
+        return true;
+    }
+
+    template <class U>
+    bool
+    operator!= (ArenaAllocator<U> const&) const
+    {
+        return false;
+    }
+};
+
+} // detail
+
+/** Carves the memory of Json::Value trees out of large blocks.
+
+    While an Arena is current on a thread, the object members and strings
+    of values created there are bump allocated from blocks owned by the
+    arena, instead of one heap allocation each. A block goes back to the
+    heap in one piece once the arena is gone and the last value using it
+    is destroyed. Values may safely outlive the arena or be destroyed on
+    other threads; they only hold on to their block until then.
+
+    Arenas nest. Code which can be suspended and resumed on another thread
+    must use Arena::Suspend.
+*/
+class Arena
+{
+public:
+    Arena ();
+    ~Arena ();
+
+    Arena (Arena const&) = delete;
+    Arena& operator= (Arena const&) = delete;
+
+    /** Takes the calling thread's arena away for the lifetime of this object.
+
+        This is created around a point where a coroutine yields, and
+        destroyed where it resumes. The arena then becomes current on the
+        resuming thread.
+    */
+    class Suspend
+    {
+    public:
+        Suspend ();
+        ~Suspend ();
+
+        Suspend (Suspend const&) = delete;
+        Suspend& operator= (Suspend const&) = delete;
+
+    private:
+        detail::ArenaImpl* impl_;
+    };
+
+private:
+    detail::ArenaImpl impl_;
+};
+
+} // Json
+
+#endif
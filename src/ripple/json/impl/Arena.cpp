@@ -0,0 +1,162 @@
+#include <BeastConfig.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/MemoryTag.h>
+#include <ripple/json/Arena.h>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace Json {
+namespace detail {
+
+namespace {
+
+// Every allocation is preceded by a pointer to the block it was
+// carved from or, if it came straight from the heap, by its size
+// shifted left with the low bit set. Blocks are aligned, so the low
+// bit of a pointer to one is clear.
+struct Block
+{
+    // Live allocations, plus one while an arena allocates from it
+    std::atomic<std::size_t> refs;
+    char* free;
+    char* end;
+
+    explicit
+    Block (std::size_t bytes)
+        : refs (1)
+        , free (reinterpret_cast<char*> (this + 1))
+        , end (reinterpret_cast<char*> (this) + bytes)
+    {
+    }
+};
+
+enum
+{
+    blockSize = 32 * 1024,
+
+    // Anything larger always comes from the heap
+    maxArenaBytes = 2 * 1024
+};
+
+std::size_t const header = sizeof (Block*);
+
+thread_local ArenaImpl* current = nullptr;
+
+ripple::MemoryTag&
+memory ()
+{
+    static ripple::MemoryTag tag ("Json");
+    return tag;
+}
+
+char*
+heapAllocate (std::size_t bytes)
+{
+    auto const p = static_cast<char*> (std::malloc (bytes));
+    if (! p)
+        ripple::Throw<std::bad_alloc> ();
+    memory ().add (bytes);
+    return p;
+}
+
+void
+heapFree (void* p, std::size_t bytes) noexcept
+{
+    memory ().add (-static_cast<std::int64_t> (bytes));
+    std::free (p);
+}
+
+void
+release (Block* b)
+{
+    if (b->refs.fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+        b->~Block ();
+        heapFree (b, blockSize);
+    }
+}
+
+} // namespace
+
+void*
+allocate (std::size_t bytes)
+{
+    auto const impl = current;
+    if (! impl || bytes > maxArenaBytes)
+    {
+        auto const p = heapAllocate (header + bytes);
+        *reinterpret_cast<std::uintptr_t*> (p) = ((header + bytes) << 1) | 1;
+        return p + header;
+    }
+
+    // Keep every allocation aligned like the header
+    auto const n = (header + bytes + header - 1) & ~(header - 1);
+    auto b = static_cast<Block*> (impl->block);
+    if (! b || std::size_t (b->end - b->free) < n)
+    {
+        auto const p = heapAllocate (blockSize);
+        if (b)
+            release (b);
+        b = new (p) Block (blockSize);
+        impl->block = b;
+    }
+
+    auto const p = b->free;
+    b->free += n;
+    b->refs.fetch_add (1, std::memory_order_relaxed);
+    *reinterpret_cast<Block**> (p) = b;
+    return p + header;
+}
+
+void
+deallocate (void* p) noexcept
+{
+    if (! p)
+        return;
+
+    auto const raw = static_cast<char*> (p) - header;
+    auto const word = *reinterpret_cast<std::uintptr_t*> (raw);
+    if (word & 1)
+        heapFree (raw, word >> 1);
+    else
+        release (reinterpret_cast<Block*> (word));
+}
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+Arena::Arena ()
+{
+    impl_.prev = detail::current;
+    detail::current = &impl_;
+}
+
+Arena::~Arena ()
+{
+    assert (detail::current == &impl_);
+    detail::current = impl_.prev;
+    if (impl_.block)
+        detail::release (static_cast<detail::Block*> (impl_.block));
+}
+
+Arena::Suspend::Suspend ()
+    : impl_ (detail::current)
+{
+    if (impl_)
+        detail::current = impl_->prev;
+}
+
+Arena::Suspend::~Suspend ()
+{
+    if (impl_)
+    {
+        impl_->prev = detail::current;
+        detail::current = impl_;
+    }
+}
+
+} // Json
@@ -22,6 +22,7 @@
 #include <ripple/json/json_reader.h>
 #include <string>
 #include <cctype>
+#include <cstring>
 
 namespace Json
 {
@@ -79,10 +80,33 @@ bool
 Reader::parse ( std::string const& document,
                 Value& root)
 {
+    // The document is only copied when there are errors to report, since
+    // their locations must stay valid after the caller's string is gone.
+    const char* begin = document.c_str ();
+    const char* end = begin + document.length ();
+
+    if ( parse ( begin, end, root ) )
+        return true;
+
     document_ = document;
-    const char* begin = document_.c_str ();
-    const char* end = begin + document_.length ();
-    return parse ( begin, end, root );
+    auto const rebase = [&]( Location& location )
+    {
+        if ( location )
+            location = document_.c_str () + ( location - begin );
+    };
+
+    for ( auto& error : errors_ )
+    {
+        rebase ( error.token_.start_ );
+        rebase ( error.token_.end_ );
+        rebase ( error.extra_ );
+    }
+
+    rebase ( begin_ );
+    rebase ( end_ );
+    rebase ( current_ );
+    rebase ( lastValueEnd_ );
+    return false;
 }
 
 
@@ -409,19 +433,31 @@ Reader::readNumber ()
 bool
 Reader::readString ()
 {
-    Char c = 0;
-
     while ( current_ != end_ )
     {
-        c = getNextChar ();
+        auto const quote = static_cast<Location> (
+            std::memchr ( current_, '"', end_ - current_ ) );
 
-        if ( c == '\\' )
-            getNextChar ();
-        else if ( c == '"' )
-            break;
+        if ( !quote )
+        {
+            current_ = end_;
+            return false;
+        }
+
+        current_ = quote + 1;
+
+        // The quote is escaped if an odd number of backslashes precede it.
+        // The opening quote of the string stops the scan.
+        Location escapes = quote;
+
+        while ( escapes[-1] == '\\' )
+            --escapes;
+
+        if ( ( quote - escapes ) % 2 == 0 )
+            return true;
     }
 
-    return c == '"';
+    return false;
 }
 
 
@@ -463,10 +499,13 @@ Reader::readObject ( Token& tokenStart )
         }
 
         // Reject duplicate names
-        if (currentValue ().isMember (name))
+        Value& object = currentValue ();
+        auto const size = object.size ();
+        Value& value = object[ name ];
+
+        if ( object.size () == size )
             return addError ( "Key '" + name + "' appears twice.", tokenName );
 
-        Value& value = currentValue ()[ name ];
         nodes_.push ( &value );
         bool ok = readValue ();
         nodes_.pop ();
@@ -665,6 +704,16 @@ Reader::decodeDouble( Token &token )
 bool
 Reader::decodeString ( Token& token )
 {
+    Location begin = token.start_ + 1;
+    Location end = token.end_ - 1;
+
+    // Most strings have no escapes and are stored without a copy
+    if ( !std::memchr ( begin, '\\', end - begin ) )
+    {
+        currentValue () = Value ( begin, end );
+        return true;
+    }
+
     std::string decoded;
 
     if ( !decodeString ( token, decoded ) )
@@ -684,69 +733,73 @@ Reader::decodeString ( Token& token, std::string& decoded )
 
     while ( current != end )
     {
-        Char c = *current++;
+        // Copy everything up to the next escape at once
+        auto next = static_cast<Location> (
+            std::memchr ( current, '\\', end - current ) );
 
-        if ( c == '"' )
-            break;
-        else if ( c == '\\' )
-        {
-            if ( current == end )
-                return addError ( "Empty escape sequence in string", token, current );
+        if ( !next )
+            next = end;
 
-            Char escape = *current++;
+        decoded.append ( current, next );
+        current = next;
 
-            switch ( escape )
-            {
-            case '"':
-                decoded += '"';
-                break;
+        if ( current == end )
+            break;
 
-            case '/':
-                decoded += '/';
-                break;
+        ++current; // skip '\\'
 
-            case '\\':
-                decoded += '\\';
-                break;
+        if ( current == end )
+            return addError ( "Empty escape sequence in string", token, current );
 
-            case 'b':
-                decoded += '\b';
-                break;
+        Char escape = *current++;
 
-            case 'f':
-                decoded += '\f';
-                break;
+        switch ( escape )
+        {
+        case '"':
+            decoded += '"';
+            break;
 
-            case 'n':
-                decoded += '\n';
-                break;
+        case '/':
+            decoded += '/';
+            break;
 
-            case 'r':
-                decoded += '\r';
-                break;
+        case '\\':
+            decoded += '\\';
+            break;
 
-            case 't':
-                decoded += '\t';
-                break;
+        case 'b':
+            decoded += '\b';
+            break;
 
-            case 'u':
-            {
-                unsigned int unicode;
+        case 'f':
+            decoded += '\f';
+            break;
 
-                if ( !decodeUnicodeCodePoint ( token, current, end, unicode ) )
-                    return false;
+        case 'n':
+            decoded += '\n';
+            break;
 
-                decoded += codePointToUTF8 (unicode);
-            }
+        case 'r':
+            decoded += '\r';
             break;
 
-            default:
-                return addError ( "Bad escape sequence in string", token, current );
-            }
-        }
-        else
+        case 't':
+            decoded += '\t';
+            break;
+
+        case 'u':
         {
-            decoded += c;
+            unsigned int unicode;
+
+            if ( !decodeUnicodeCodePoint ( token, current, end, unicode ) )
+                return false;
+
+            decoded += codePointToUTF8 (unicode);
+        }
+        break;
+
+        default:
+            return addError ( "Bad escape sequence in string", token, current );
         }
     }
 
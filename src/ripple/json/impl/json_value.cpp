@@ -62,7 +62,7 @@ public:
         if ( length == unknown )
             length = (unsigned int)strlen (value);
 
-        char* newString = static_cast<char*> ( malloc ( length + 1 ) );
+        char* newString = static_cast<char*> ( detail::allocate ( length + 1 ) );
         memcpy ( newString, value, length );
         newString[length] = 0;
         return newString;
@@ -70,8 +70,7 @@ public:
 
     virtual void releaseStringValue ( char* value )
     {
-        if ( value )
-            free ( value );
+        detail::deallocate ( value );
     }
 };
 
@@ -81,6 +80,29 @@ static ValueAllocator*& valueAllocator ()
     return valueAllocator;
 }
 
+// The member containers come from the same arena as their members
+template <class... Args>
+static Value::ObjectValues* newObjectValues ( Args&&... args )
+{
+    void* p = detail::allocate ( sizeof ( Value::ObjectValues ) );
+    try
+    {
+        return new (p) Value::ObjectValues ( std::forward<Args> (args)... );
+    }
+    catch (...)
+    {
+        detail::deallocate ( p );
+        throw;
+    }
+}
+
+static void deleteObjectValues ( Value::ObjectValues* map )
+{
+    using ObjectValues = Value::ObjectValues;
+    map->~ObjectValues ();
+    detail::deallocate ( map );
+}
+
 static struct DummyValueAllocatorInitializer
 {
     DummyValueAllocatorInitializer ()
@@ -217,7 +239,7 @@ Value::Value ( ValueType type )
 
     case arrayValue:
     case objectValue:
-        value_.map_ = new ObjectValues ();
+        value_.map_ = newObjectValues ();
         break;
 
     case booleanValue:
@@ -325,7 +347,7 @@ Value::Value ( const Value& other )
 
     case arrayValue:
     case objectValue:
-        value_.map_ = new ObjectValues ( *other.value_.map_ );
+        value_.map_ = newObjectValues ( *other.value_.map_ );
         break;
 
     default:
@@ -353,7 +375,7 @@ Value::~Value ()
 
     case arrayValue:
     case objectValue:
-        delete value_.map_;
+        deleteObjectValues ( value_.map_ );
         break;
 
     default:
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 #define RIPPLE_JSON_JSON_VALUE_H_INCLUDED
 
+#include <ripple/json/Arena.h>
 #include <ripple/json/json_forwards.h>
 #include <beast/strings/String.h>
 #include <functional>
@@ -192,7 +193,8 @@ private:
     };
 
 public:
-    using ObjectValues = std::map<CZString, Value>;
+    using ObjectValues = std::map<CZString, Value, std::less<CZString>,
+        detail::ArenaAllocator<std::pair<CZString const, Value>>>;
 
 public:
     /** \brief Create a default Value of the given type.
@@ -0,0 +1,173 @@
+#include <BeastConfig.h>
+#include <ripple/json/Arena.h>
+#include <ripple/json/json_value.h>
+#include <ripple/json/to_string.h>
+#include <beast/unit_test/suite.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace Json {
+
+// Looks like the "lines" of a large account_lines reply
+static
+Value
+makeLines (int count)
+{
+    Value result (objectValue);
+    result["account"] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+    Value& lines = result["lines"] = Value (arrayValue);
+    for (int i = 0; i < count; ++i)
+    {
+        Value& line = lines.append (Value (objectValue));
+        line["account"] = "r" + std::to_string (1000000 + i) +
+            "pPgB3sqECQr3eiKm1b5Cq8a7";
+        line["balance"] = std::to_string (i) + ".5";
+        line["currency"] = "USD";
+        line["limit"] = "1000000";
+        line["limit_peer"] = "0";
+        line["quality_in"] = 0;
+        line["quality_out"] = 0;
+        line["no_ripple"] = true;
+    }
+    return result;
+}
+
+class Arena_test : public beast::unit_test::suite
+{
+public:
+    void
+    testOutlive ()
+    {
+        testcase ("outlive");
+
+        std::string expected;
+        Value kept;
+        {
+            Arena arena;
+            auto lines = makeLines (500);
+            expected = to_string (lines);
+
+            // Moved and copied out of the arena
+            kept = std::move (lines["lines"][100u]);
+            kept["copy"] = lines["lines"][101u];
+            lines["lines"][102u]["extra"] = std::string (10000, 'x');
+        }
+        expect (kept["currency"].asString () == "USD");
+        expect (kept["copy"]["balance"].asString () == "101.5");
+
+        // The values are the same as without an arena
+        expect (to_string (makeLines (500)) == expected);
+    }
+
+    void
+    testThreads ()
+    {
+        testcase ("threads");
+
+        auto lines = std::make_shared<Value> ();
+        {
+            Arena arena;
+            *lines = makeLines (200);
+        }
+
+        // Destroyed on another thread
+        std::thread t ([&]
+            {
+                expect ((*lines)["lines"].size () == 200);
+                lines.reset ();
+            });
+        t.join ();
+        expect (! lines);
+    }
+
+    void
+    testSuspend ()
+    {
+        testcase ("suspend");
+
+        Value v;
+        {
+            Arena outer;
+            {
+                Arena arena;
+                v = makeLines (10);
+
+                // Resumed on another thread
+                auto suspend = std::make_unique<Arena::Suspend> ();
+                Value other = makeLines (10);
+                std::thread t ([&]
+                    {
+                        suspend.reset ();
+                        v["lines"].append (makeLines (10));
+                        suspend = std::make_unique<Arena::Suspend> ();
+                    });
+                t.join ();
+                suspend.reset ();
+                v["other"] = other;
+            }
+            v["after"] = makeLines (10);
+        }
+        expect (v["lines"].size () == 11);
+        expect (v["other"]["lines"].size () == 10);
+        expect (v["after"]["lines"].size () == 10);
+    }
+
+    void
+    run ()
+    {
+        testOutlive ();
+        testThreads ();
+        testSuspend ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Arena,json,ripple);
+
+//------------------------------------------------------------------------------
+
+class Arena_timing_test : public beast::unit_test::suite
+{
+public:
+    template <class F>
+    std::chrono::milliseconds
+    time (F&& f)
+    {
+        using clock = std::chrono::steady_clock;
+        auto const start = clock::now ();
+        f ();
+        return std::chrono::duration_cast<std::chrono::milliseconds> (
+            clock::now () - start);
+    }
+
+    void
+    run ()
+    {
+        int const rounds = 50;
+        int const count = 20000;
+
+        auto const heap = time ([&]
+            {
+                for (int i = 0; i < rounds; ++i)
+                    makeLines (count);
+            });
+        auto const arena = time ([&]
+            {
+                for (int i = 0; i < rounds; ++i)
+                {
+                    Arena arena;
+                    makeLines (count);
+                }
+            });
+
+        log << rounds << " account_lines replies of " << count <<
+            " lines: heap " << heap.count () << "ms, arena " <<
+                arena.count () << "ms";
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Arena_timing,json,ripple);
+
+} // Json
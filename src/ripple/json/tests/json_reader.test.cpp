@@ -0,0 +1,77 @@
+#include <BeastConfig.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/json_value.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+
+namespace ripple {
+
+struct json_reader_test : beast::unit_test::suite
+{
+    void
+    testStrings ()
+    {
+        testcase ("strings");
+
+        std::string const blob (2000, 'A');
+        Json::Value v;
+        Json::Reader r;
+        expect (r.parse (
+            "{\"method\":\"submit\",\"params\":[{\"tx_blob\":\"" + blob +
+                "\"}]}", v));
+        expect (v["method"].asString () == "submit");
+        expect (v["params"][0u]["tx_blob"].asString () == blob);
+
+        expect (r.parse (R"({"a":"","b":"x\"y","c":"\\","d":"\\\"",)"
+            R"("e":"é\n\t\/","f":"\\\\"})", v));
+        expect (v["a"].asString () == "");
+        expect (v["b"].asString () == "x\"y");
+        expect (v["c"].asString () == "\\");
+        expect (v["d"].asString () == "\\\"");
+        expect (v["e"].asString () == "\xc3\xa9\n\t/");
+        expect (v["f"].asString () == "\\\\");
+
+        // Escaped quotes in member names
+        expect (r.parse (R"({"a\"b":1,"a\\":2})", v));
+        expect (v["a\"b"].asInt () == 1);
+        expect (v["a\\"].asInt () == 2);
+
+        // Unterminated
+        expect (! r.parse (R"({"a":"b)", v));
+        expect (! r.parse (R"({"a":"b\")", v));
+        expect (! r.parse (R"({"a":"b\"})", v));
+        expect (! r.parse (R"({"a":"\q"})", v));
+    }
+
+    void
+    testErrors ()
+    {
+        testcase ("errors");
+
+        Json::Reader r;
+        Json::Value v;
+        expect (! r.parse (std::string (R"({"a":1,"a":2})"), v));
+
+        // The document is gone but the message can still be formatted
+        auto const message = r.getFormatedErrorMessages ();
+        expect (message.find ("Key 'a' appears twice.") != std::string::npos,
+            message);
+        expect (message.find ("Line 1, Column 8") != std::string::npos,
+            message);
+
+        expect (r.parse (R"({"a":1,"b":2})", v));
+        expect (r.getFormatedErrorMessages ().empty ());
+        expect (v.size () == 2);
+    }
+
+    void
+    run ()
+    {
+        testStrings ();
+        testErrors ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(json_reader, json, ripple);
+
+}
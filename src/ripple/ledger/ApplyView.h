@@ -218,6 +218,12 @@ public:
     virtual
     STArray&
     peekFeeShareTakers () = 0;
+
+    // The fee shares accrued for a later settlement, see
+    // shareFeeWithReferee
+    virtual
+    STArray&
+    peekFeeShareAccruals () = 0;
 };
 
 } // ripple
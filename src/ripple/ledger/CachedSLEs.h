@@ -24,7 +24,9 @@
 #include <ripple/protocol/STLedgerEntry.h>
 #include <beast/container/aged_unordered_map.h>
 #include <memory>
+#include <cstdint>
 #include <mutex>
+#include <utility>
 
 namespace ripple {
 
@@ -51,6 +53,9 @@ public:
 
     /** Discard expired entries.
 
+        Entries in use are kept. When there is a target size, the
+        oldest entries beyond it are discarded even if not yet expired.
+
         Needs to be called periodically.
     */
     void
@@ -98,9 +103,22 @@ public:
     double
     rate() const;
 
+    /** Returns the number of hits, then of misses. */
+    std::pair<std::uint64_t, std::uint64_t>
+    hitsAndMisses() const;
+
+    /** Returns the number of cached entries. */
+    std::size_t
+    size() const;
+
+    /** Set the number of entries kept by expire, 0 for no limit. */
+    void
+    setTargetSize (std::size_t size);
+
 private:
     std::size_t hit_ = 0;
     std::size_t miss_ = 0;
+    std::size_t targetSize_ = 0;
     std::mutex mutable mutex_;
     Stopwatch::duration timeToLive_;
     beast::aged_unordered_map <digest_type,
@@ -27,6 +27,7 @@
 #include <memory>
 #include <mutex>
 #include <type_traits>
+#include <utility>
 
 namespace ripple {
 
@@ -43,6 +44,11 @@ private:
         std::shared_ptr<SLE const>,
             hardened_hash<>> mutable map_;
 
+    // The base never changes, so neither do the successors of a key.
+    // Crossing a book asks for the same ones over and over.
+    std::map<std::pair<key_type, boost::optional<key_type>>,
+        boost::optional<key_type>> mutable succ_;
+
 public:
     CachedViewImpl() = delete;
     CachedViewImpl (CachedViewImpl const&) = delete;
@@ -65,6 +71,12 @@ public:
     std::shared_ptr<SLE const>
     read (Keylet const& k) const override;
 
+    void
+    prefetch (std::vector<key_type> const& keys) const override
+    {
+        base_.prefetch(keys);
+    }
+
     LedgerInfo const&
     info() const override
     {
@@ -85,10 +97,7 @@ public:
 
     boost::optional<key_type>
     succ (key_type const& key, boost::optional<
-        key_type> const& last = boost::none) const override
-    {
-        return base_.succ(key, last);
-    }
+        key_type> const& last = boost::none) const override;
 
     std::unique_ptr<sles_type::iter_base>
     slesBegin() const override
@@ -62,6 +62,7 @@ private:
 
     Rules rules_;
     txs_map txs_;
+    std::size_t exemptCount_ = 0;
     LedgerInfo info_;
     ReadView const* base_;
     detail::RawStateTable items_;
@@ -142,6 +143,22 @@ public:
     std::size_t
     txCount() const;
 
+    /** Return the number of tx inserted since creation
+        which do not count toward fee escalation.
+    */
+    std::size_t
+    exemptCount() const
+    {
+        return exemptCount_;
+    }
+
+    /** Exempt the last tx inserted from fee escalation. */
+    void
+    addExempt()
+    {
+        ++exemptCount_;
+    }
+
     /** Apply changes. */
     void
     apply (TxsRawView& to) const;
@@ -167,6 +184,9 @@ public:
     std::shared_ptr<SLE const>
     read (Keylet const& k) const override;
 
+    void
+    prefetch (std::vector<key_type> const& keys) const override;
+
     std::unique_ptr<sles_type::iter_base>
     slesBegin() const override;
 
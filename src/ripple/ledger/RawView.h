@@ -22,6 +22,7 @@
 
 #include <ripple/ledger/ReadView.h>
 #include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/STArray.h>
 #include <ripple/protocol/STLedgerEntry.h>
 #include <boost/optional.hpp>
 #include <cstdint>
@@ -94,6 +95,16 @@ public:
     virtual
     void
     rawCreateVBC (XRPAmount const& drops) = 0;
+
+    /** Add fee shares accrued by a transaction.
+
+        Only views which build the transaction's metadata keep them.
+    */
+    virtual
+    void
+    rawAccrueFeeShares (STArray const& shares)
+    {
+    }
 };
 
 //------------------------------------------------------------------------------
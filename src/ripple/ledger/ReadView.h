@@ -35,6 +35,7 @@
 #include <cstdint>
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 namespace ripple {
 
@@ -316,6 +317,18 @@ public:
     std::shared_ptr<SLE const>
     read (Keylet const& k) const = 0;
 
+    /** Start bringing the state items with these keys into memory.
+
+        Returns without waiting. Views backed by a node store begin the
+        reads the items need, so that reading them later waits less.
+        Keys of items that do not exist are ignored.
+    */
+    virtual
+    void
+    prefetch (std::vector<key_type> const& keys) const
+    {
+    }
+
     // Called to adjust returned balances
     // This is required to support PaymentSandbox
     virtual
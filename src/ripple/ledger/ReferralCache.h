@@ -0,0 +1,118 @@
+#ifndef RIPPLE_LEDGER_REFERRALCACHE_H_INCLUDED
+#define RIPPLE_LEDGER_REFERRALCACHE_H_INCLUDED
+
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Caches the fee share takers of an account's referral chain.
+
+    The takers of an account depend on the referral chain above it and on
+    the results of the dividend round, so they are kept for each ledger
+    under construction, identified by its parent, and for each round.
+    Every view built on the same parent holds the same referral chains
+    until one of them adds a reference: the ledger is then marked stale
+    and no longer cached.
+*/
+class ReferralCache
+{
+public:
+    using takers_type = std::vector<AccountID>;
+
+    ReferralCache (ReferralCache const&) = delete;
+    ReferralCache& operator= (ReferralCache const&) = delete;
+
+    /** Create the cache.
+
+        @param ledgers The number of ledgers kept, the ones with the
+                       lowest sequence are dropped first.
+    */
+    explicit
+    ReferralCache (std::size_t ledgers = 4)
+        : maxLedgers_ (ledgers)
+    {
+    }
+
+    /** Fetch the takers of an account from the cache.
+
+        If they were not found, Handler will be called with this
+        signature:
+
+            takers_type(void)
+    */
+    template <class Handler>
+    takers_type
+    fetch (ReadView const& view, AccountID const& account,
+        std::uint32_t round, Handler const& h)
+    {
+        auto const& info = view.info ();
+        key_type const key (account, round);
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            auto const iter = ledgers_.find (info.parentHash);
+            if (iter != ledgers_.end ())
+            {
+                if (iter->second.stale)
+                    return h ();
+                auto const found = iter->second.takers.find (key);
+                if (found != iter->second.takers.end ())
+                {
+                    ++hit_;
+                    return found->second;
+                }
+            }
+        }
+        auto takers = h ();
+        std::lock_guard<std::mutex> lock (mutex_);
+        ++miss_;
+        auto& ledger = insert (info);
+        if (! ledger.stale)
+            ledger.takers.emplace (key, takers);
+        return takers;
+    }
+
+    /** Drop the takers cached for the ledger of the view.
+
+        Called when a reference is added, the ledger is not cached
+        anymore.
+    */
+    void
+    invalidate (ReadView const& view);
+
+    /** Returns the fraction of cache hits. */
+    double
+    rate() const;
+
+private:
+    using key_type = std::pair<AccountID, std::uint32_t>;
+
+    struct Ledger
+    {
+        LedgerIndex seq;
+        bool stale = false;
+        std::map <key_type, takers_type> takers;
+    };
+
+    Ledger&
+    insert (LedgerInfo const& info);
+
+    std::size_t const maxLedgers_;
+    std::size_t hit_ = 0;
+    std::size_t miss_ = 0;
+    std::mutex mutable mutex_;
+    std::map <uint256, Ledger> ledgers_;
+};
+
+/** The cache of the fee share takers used by shareFeeWithReferee. */
+ReferralCache&
+referralCache ();
+
+} // ripple
+
+#endif
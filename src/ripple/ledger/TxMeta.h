@@ -145,6 +145,21 @@ public:
         return !mFeeShareTakers.empty();
     }
 
+    void setFeeShareAccruals (STArray const& feeShareAccruals)
+    {
+        mFeeShareAccruals = feeShareAccruals;
+    }
+
+    const STArray& getFeeShareAccruals () const
+    {
+        return mFeeShareAccruals;
+    }
+
+    bool hasFeeShareAccruals() const
+    {
+        return !mFeeShareAccruals.empty();
+    }
+
     static bool thread (STObject& node, uint256 const& prevTxID, std::uint32_t prevLgrID);
 
 private:
@@ -157,6 +172,7 @@ private:
 
     STArray mNodes;
     STArray mFeeShareTakers;
+    STArray mFeeShareAccruals;
 
     beast::Journal j_;
 };
@@ -73,6 +73,15 @@ accountFunds (ApplyView& view, AccountID const& id,
     STAmount const& saDefault, FreezeHandling freezeHandling,
         beast::Journal j);
 
+/** Start reading the items of a directory page and the page after it.
+    Returns without waiting. Reading a page of items one at a time then
+    waits about as long as reading one of them.
+    @see ReadView::prefetch
+*/
+void
+prefetchDirPage (ReadView const& view, Keylet const& root,
+    SLE const& page);
+
 /** Iterate all items in an account's owner directory. */
 void
 forEachItem (ReadView const& view, AccountID const& id,
@@ -90,6 +99,27 @@ forEachItemAfter (ReadView const& view, AccountID const& id,
         unsigned int limit, std::function<
             bool (std::shared_ptr<SLE const> const&)> f);
 
+/** Iterate the state entries with keys after `first` and before
+    `last`, in order, until the function returns `false`.
+
+    The range is found with one descent of the state map, instead of
+    one for each entry as with succ and read.
+*/
+void
+forEachSLE (ReadView const& view,
+    uint256 const& first, uint256 const& last,
+        std::function<bool (std::shared_ptr<SLE const> const&)> f);
+
+/** Iterate the account roots of a referee's references until the
+    function returns `false`.
+
+    The references kept in the referee's ltREFER entry come first, then
+    those of its referral directory.
+*/
+void
+forEachReference (ReadView const& view, AccountID const& refereeID,
+    std::function<bool (std::shared_ptr<SLE const> const&)> f);
+
 std::uint32_t
 rippleTransferRate (ReadView const& view,
     AccountID const& issuer);
@@ -290,11 +320,25 @@ addRefer (ApplyView& view,
     AccountID const& refereeID, AccountID const& referenceID,
         beast::Journal j);
 
+/** Give a share of a transfer fee to the referees of the sender.
+
+    With FeeShareAccrual enabled the shares are not credited here: they
+    are recorded as the transaction's FeeShareAccruals and credited by
+    the FeeShareSettle of a later ledger, so the transaction only changes
+    the lines of its own accounts.
+*/
 TER
 shareFeeWithReferee (ApplyView& view,
     AccountID const& uSenderID, AccountID const& uIssuerID, const STAmount& saAmount,
         beast::Journal j);
 
+/** Add an amount to the share of an account, merging shares of the same
+    account and issue.
+*/
+void
+addFeeShare (STArray& shares,
+    AccountID const& account, STAmount const& amount);
+
 std::tuple<STAmount, bool>
 assetReleased (ApplyView& view,
     STAmount const& amount,
@@ -347,6 +391,20 @@ redeemIOU (ApplyView& view,
             Issue const& issue,
                 beast::Journal j);
 
+/** Returns the native balance of an account root in drops.
+    @param field sfBalance or sfBalanceVBC
+*/
+XRPAmount
+nativeBalance (SLE const& sle, SF_Amount const& field);
+
+/** Adds drops, which may be negative, to the native balance of an
+    account root. Native balances are whole numbers of drops, so this
+    does not need the general STAmount arithmetic.
+    @param field sfBalance or sfBalanceVBC
+*/
+void
+adjustNativeBalance (SLE& sle, SF_Amount const& field, XRPAmount delta);
+
 TER
 transferXRP (ApplyView& view,
     AccountID const& from,
@@ -26,7 +26,9 @@
 #include <ripple/ledger/TxMeta.h>
 #include <ripple/protocol/TER.h>
 #include <ripple/protocol/XRPAmount.h>
+#include <ripple/basics/qalloc.h>
 #include <beast/utility/Journal.h>
+#include <map>
 #include <memory>
 
 namespace ripple {
@@ -47,8 +49,14 @@ private:
         modify,
     };
 
+    // The nodes come from an arena shared by the tables of one thread,
+    // so applying a transaction reuses the memory of the one before it.
     using items_t = std::map<key_type,
-        std::pair<Action, std::shared_ptr<SLE>>>;
+        std::pair<Action, std::shared_ptr<SLE>>,
+        std::less<key_type>, qalloc_type<std::pair<key_type const,
+        std::pair<Action, std::shared_ptr<SLE>>>, false>>;
+
+    class sles_iter_impl;
 
     items_t items_;
     XRPAmount dropsDestroyed_ = 0;
@@ -56,9 +64,10 @@ private:
     XRPAmount dropsVBCCreated_ = 0;
 
     STArray feeShareTakers_;
+    STArray feeShareAccruals_;
 
 public:
-    ApplyStateTable() = default;
+    ApplyStateTable();
     ApplyStateTable (ApplyStateTable&&) = default;
 
     ApplyStateTable (ApplyStateTable const&) = delete;
@@ -91,6 +100,15 @@ public:
     peek (ReadView const& base,
         Keylet const& k);
 
+    std::unique_ptr<ReadView::sles_type::iter_base>
+    slesBegin (ReadView const& base) const;
+
+    std::unique_ptr<ReadView::sles_type::iter_base>
+    slesEnd (ReadView const& base) const;
+
+    std::unique_ptr<ReadView::sles_type::iter_base>
+    slesUpperBound (ReadView const& base, uint256 const& key) const;
+
     std::size_t
     size ();
 
@@ -134,10 +152,20 @@ public:
     STArray&
     peekFeeShareTakers () { return feeShareTakers_; }
 
+    STArray&
+    peekFeeShareAccruals () { return feeShareAccruals_; }
+
+    void
+    accrueFeeShares (STArray const& shares);
+
 private:
     using Mods = hash_map<key_type,
         std::shared_ptr<SLE>>;
 
+    static
+    items_t::allocator_type
+    arena();
+
     static
     void
     threadItem (TxMeta& meta,
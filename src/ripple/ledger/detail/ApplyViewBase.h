@@ -133,9 +133,16 @@ public:
     rawCreateVBC (
         XRPAmount const& drops) override;
 
+    void
+    rawAccrueFeeShares (
+        STArray const& shares) override;
+
     STArray&
     peekFeeShareTakers () override;
 
+    STArray&
+    peekFeeShareAccruals () override;
+
 protected:
     ApplyFlags flags_;
     ReadView const* base_;
@@ -63,6 +63,15 @@ public:
     virtual
     value_type
     dereference() const = 0;
+
+    // Start reading about count of the nodes which
+    // follow, without waiting. Views which do not
+    // read from the node store do nothing.
+    virtual
+    void
+    prefetch (std::size_t count) const
+    {
+    }
 };
 
 // A range using type-erased ForwardIterator
@@ -125,6 +134,10 @@ public:
         iterator
         operator++(int);
 
+        // Start reading the items which follow
+        void
+        prefetch (std::size_t count) const;
+
     private:
         ReadView const* view_ = nullptr;
         std::unique_ptr<iter_base> impl_;
@@ -123,6 +123,14 @@ ReadViewFwdRange<ValueType>::iterator::operator++() ->
     return *this;
 }
 
+template<class ValueType>
+void
+ReadViewFwdRange<ValueType>::iterator::prefetch (
+    std::size_t count) const
+{
+    impl_->prefetch (count);
+}
+
 template<class ValueType>
 auto
 ReadViewFwdRange<ValueType>::iterator::operator++(int) ->
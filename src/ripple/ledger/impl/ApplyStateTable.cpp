@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/ledger/detail/ApplyStateTable.h>
+#include <ripple/ledger/View.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/json/to_string.h>
@@ -28,12 +29,135 @@
 namespace ripple {
 namespace detail {
 
+// Merges the base's entries with ours, skipping those we erased
+class ApplyStateTable::sles_iter_impl
+    : public ReadView::sles_type::iter_base
+{
+private:
+    std::shared_ptr<SLE const> sle0_;
+    ReadView::sles_type::iterator iter0_;
+    ReadView::sles_type::iterator end0_;
+    items_t::const_iterator iter1_;
+    items_t::const_iterator end1_;
+
+public:
+    sles_iter_impl (sles_iter_impl const&) = default;
+
+    sles_iter_impl (items_t::const_iterator iter1,
+        items_t::const_iterator end1,
+            ReadView::sles_type::iterator iter0,
+                ReadView::sles_type::iterator end0)
+        : iter0_ (iter0)
+        , end0_ (end0)
+        , iter1_ (iter1)
+        , end1_ (end1)
+    {
+        if (iter0_ != end0_)
+            sle0_ = *iter0_;
+        skip ();
+    }
+
+    std::unique_ptr<base_type>
+    copy() const override
+    {
+        return std::make_unique<sles_iter_impl>(*this);
+    }
+
+    bool
+    equal (base_type const& impl) const override
+    {
+        auto const& other = dynamic_cast<
+            sles_iter_impl const&>(impl);
+        assert(end1_ == other.end1_ &&
+            end0_ == other.end0_);
+        return iter1_ == other.iter1_ &&
+            iter0_ == other.iter0_;
+    }
+
+    void
+    increment() override
+    {
+        assert (sle0_ || iter1_ != end1_);
+
+        if (iter1_ == end1_)
+        {
+            inc0();
+        }
+        else if (! sle0_ || iter1_->first < sle0_->key())
+        {
+            ++iter1_;
+        }
+        else if (iter1_->first == sle0_->key())
+        {
+            ++iter1_;
+            inc0();
+        }
+        else
+        {
+            inc0();
+        }
+        skip();
+    }
+
+    value_type
+    dereference() const override
+    {
+        if (iter1_ != end1_ &&
+                (! sle0_ || iter1_->first <= sle0_->key()))
+            return iter1_->second.second;
+        return sle0_;
+    }
+
+private:
+    void inc0()
+    {
+        ++iter0_;
+        if (iter0_ == end0_)
+            sle0_ = nullptr;
+        else
+            sle0_ = *iter0_;
+    }
+
+    // Erased entries hide the base's entry with the same key
+    void skip()
+    {
+        while (iter1_ != end1_ &&
+            iter1_->second.first == Action::erase &&
+                (! sle0_ || iter1_->first <= sle0_->key()))
+        {
+            if (sle0_ && iter1_->first == sle0_->key())
+                inc0();
+            ++iter1_;
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+ApplyStateTable::ApplyStateTable()
+    : items_ (std::less<key_type>(), arena())
+{
+}
+
+// A table must be destroyed on the thread that made it.
+// Blocks are kept once free, so a thread holds on to the
+// most memory its tables have needed at once.
+auto
+ApplyStateTable::arena() ->
+    items_t::allocator_type
+{
+    static thread_local items_t::allocator_type const alloc;
+    return alloc;
+}
+
 void
 ApplyStateTable::apply (RawView& to) const
 {
     to.rawCreateXRP(dropsCreated_);
     to.rawCreateVBC(dropsVBCCreated_);
     to.rawDestroyXRP(dropsDestroyed_);
+    if (! feeShareAccruals_.empty())
+        to.rawAccrueFeeShares(feeShareAccruals_);
     for (auto const& item : items_)
     {
         auto const& sle =
@@ -46,9 +170,11 @@ ApplyStateTable::apply (RawView& to) const
             to.rawErase(sle);
             break;
         case Action::insert:
+            sle->share();
             to.rawInsert(sle);
             break;
         case Action::modify:
+            sle->share();
             to.rawReplace(sle);
             break;
         };
@@ -127,6 +253,8 @@ ApplyStateTable::apply (OpenView& to,
             meta.setDeliveredAmount(*deliver);
         if (!feeShareTakers_.empty ())
             meta.setFeeShareTakers(feeShareTakers_);
+        if (!feeShareAccruals_.empty ())
+            meta.setFeeShareAccruals(feeShareAccruals_);
         Mods newMod;
         for (auto& item : items_)
         {
@@ -346,6 +474,31 @@ ApplyStateTable::read (ReadView const& base,
     return sle;
 }
 
+std::unique_ptr<ReadView::sles_type::iter_base>
+ApplyStateTable::slesBegin (ReadView const& base) const
+{
+    return std::make_unique<sles_iter_impl>(
+        items_.begin(), items_.end(),
+            base.sles.begin(), base.sles.end());
+}
+
+std::unique_ptr<ReadView::sles_type::iter_base>
+ApplyStateTable::slesEnd (ReadView const& base) const
+{
+    return std::make_unique<sles_iter_impl>(
+        items_.end(), items_.end(),
+            base.sles.end(), base.sles.end());
+}
+
+std::unique_ptr<ReadView::sles_type::iter_base>
+ApplyStateTable::slesUpperBound (ReadView const& base,
+    uint256 const& key) const
+{
+    return std::make_unique<sles_iter_impl>(
+        items_.upper_bound(key), items_.end(),
+            base.sles.upper_bound(key), base.sles.end());
+}
+
 std::shared_ptr<SLE>
 ApplyStateTable::peek (ReadView const& base,
     Keylet const& k)
@@ -357,7 +510,7 @@ ApplyStateTable::peek (ReadView const& base,
         auto const sle = base.read(k);
         if (! sle)
             return nullptr;
-        // Make our own copy
+        // Make our own copy, sharing the fields until they change
         using namespace std;
         iter = items_.emplace_hint (iter,
             piecewise_construct,
@@ -542,6 +695,14 @@ ApplyStateTable::createVBC(XRPAmount const&  drops)
     dropsVBCCreated_ += drops;
 }
 
+void
+ApplyStateTable::accrueFeeShares (STArray const& shares)
+{
+    for (auto const& share : shares)
+        addFeeShare (feeShareAccruals_, share.getAccountID (sfAccount),
+            share.getFieldAmount (sfAmount));
+}
+
 //------------------------------------------------------------------------------
 
 // Insert this transaction to the SLE's threading list
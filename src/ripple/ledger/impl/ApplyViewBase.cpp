@@ -75,21 +75,21 @@ auto
 ApplyViewBase::slesBegin() const ->
     std::unique_ptr<sles_type::iter_base>
 {
-    return base_->slesBegin();
+    return items_.slesBegin(*base_);
 }
 
 auto
 ApplyViewBase::slesEnd() const ->
     std::unique_ptr<sles_type::iter_base>
 {
-    return base_->slesEnd();
+    return items_.slesEnd(*base_);
 }
 
 auto
 ApplyViewBase::slesUpperBound(uint256 const& key) const ->
     std::unique_ptr<sles_type::iter_base>
 {
-    return base_->slesUpperBound(key);
+    return items_.slesUpperBound(*base_, key);
 }
 
 auto
@@ -199,11 +199,24 @@ ApplyViewBase::rawCreateVBC(
     items_.createVBC(drops);
 }
 
+void
+ApplyViewBase::rawAccrueFeeShares(
+    STArray const& shares)
+{
+    items_.accrueFeeShares(shares);
+}
+
 STArray&
 ApplyViewBase::peekFeeShareTakers ()
 {
     return items_.peekFeeShareTakers ();
 }
 
+STArray&
+ApplyViewBase::peekFeeShareAccruals ()
+{
+    return items_.peekFeeShareAccruals ();
+}
+
 } // detail
 } // ripple
@@ -34,9 +34,11 @@ CachedSLEs::expire()
         std::lock_guard<
             std::mutex> lock(mutex_);
         for (auto iter = map_.chronological.begin();
-            iter != map_.chronological.end(); ++iter)
+            iter != map_.chronological.end();)
         {
-            if (iter.when() > expireTime)
+            if (iter.when() > expireTime &&
+                    (targetSize_ == 0 ||
+                        map_.size() <= targetSize_))
                 break;
             if (iter->second.unique())
             {
@@ -44,10 +46,38 @@ CachedSLEs::expire()
                     std::move(iter->second));
                 iter = map_.erase(iter);
             }
+            else
+            {
+                ++iter;
+            }
         }
     }
 }
 
+std::pair<std::uint64_t, std::uint64_t>
+CachedSLEs::hitsAndMisses() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return { hit_, miss_ };
+}
+
+std::size_t
+CachedSLEs::size() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return map_.size();
+}
+
+void
+CachedSLEs::setTargetSize (std::size_t size)
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    targetSize_ = size;
+}
+
 double
 CachedSLEs::rate() const
 {
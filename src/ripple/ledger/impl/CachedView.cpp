@@ -66,5 +66,24 @@ CachedViewImpl::read (Keylet const& k) const
 
 }
 
+boost::optional<uint256>
+CachedViewImpl::succ (key_type const& key,
+    boost::optional<key_type> const& last) const
+{
+    auto const query = std::make_pair(key, last);
+    {
+        std::lock_guard<
+            std::mutex> lock(mutex_);
+        auto const iter = succ_.find(query);
+        if (iter != succ_.end())
+            return iter->second;
+    }
+    auto const next = base_.succ(key, last);
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    succ_.emplace(query, next);
+    return next;
+}
+
 } // detail
 } // ripple
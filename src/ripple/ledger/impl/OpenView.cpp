@@ -167,6 +167,12 @@ OpenView::read (Keylet const& k) const
     return items_.read(*base_, k);
 }
 
+void
+OpenView::prefetch (std::vector<key_type> const& keys) const
+{
+    base_->prefetch(keys);
+}
+
 auto
 OpenView::slesBegin() const ->
     std::unique_ptr<sles_type::iter_base>
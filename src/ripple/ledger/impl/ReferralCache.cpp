@@ -0,0 +1,55 @@
+#include <BeastConfig.h>
+#include <ripple/ledger/ReferralCache.h>
+#include <algorithm>
+
+namespace ripple {
+
+void
+ReferralCache::invalidate (ReadView const& view)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto& ledger = insert (view.info ());
+    ledger.stale = true;
+    ledger.takers.clear ();
+}
+
+double
+ReferralCache::rate() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    auto const tot = hit_ + miss_;
+    if (tot == 0)
+        return 0;
+    return double(hit_) / tot;
+}
+
+ReferralCache::Ledger&
+ReferralCache::insert (LedgerInfo const& info)
+{
+    auto iter = ledgers_.find (info.parentHash);
+    if (iter != ledgers_.end ())
+        return iter->second;
+
+    if (ledgers_.size () >= maxLedgers_)
+    {
+        ledgers_.erase (std::min_element (ledgers_.begin (), ledgers_.end (),
+            [](auto const& a, auto const& b)
+            {
+                return a.second.seq < b.second.seq;
+            }));
+    }
+
+    iter = ledgers_.emplace (info.parentHash, Ledger ()).first;
+    iter->second.seq = info.seq;
+    return iter->second;
+}
+
+ReferralCache&
+referralCache ()
+{
+    static ReferralCache cache;
+    return cache;
+}
+
+} // ripple
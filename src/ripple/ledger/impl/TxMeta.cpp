@@ -36,6 +36,7 @@ TxMeta::TxMeta (uint256 const& txid,
     , mLedger (ledger)
     , mNodes (sfAffectedNodes, 32)
     , mFeeShareTakers (sfFeeShareTakers, 5)
+    , mFeeShareAccruals (sfFeeShareAccruals, 5)
     , j_ (j)
 {
     SerialIter sit (makeSlice(data));
@@ -50,6 +51,9 @@ TxMeta::TxMeta (uint256 const& txid,
 
     if (obj.isFieldPresent (sfFeeShareTakers))
         mFeeShareTakers = obj.getFieldArray(sfFeeShareTakers);
+
+    if (obj.isFieldPresent (sfFeeShareAccruals))
+        mFeeShareAccruals = obj.getFieldArray(sfFeeShareAccruals);
 }
 
 TxMeta::TxMeta (uint256 const& txid, std::uint32_t ledger, STObject const& obj,
@@ -70,6 +74,9 @@ TxMeta::TxMeta (uint256 const& txid, std::uint32_t ledger, STObject const& obj,
 
     if (obj.isFieldPresent (sfDeliveredAmount))
         setDeliveredAmount (obj.getFieldAmount (sfDeliveredAmount));
+
+    if (obj.isFieldPresent (sfFeeShareAccruals))
+        mFeeShareAccruals = obj.getFieldArray(sfFeeShareAccruals);
 }
 
 TxMeta::TxMeta (uint256 const& txid,
@@ -222,6 +229,7 @@ void TxMeta::init (uint256 const& id, std::uint32_t ledger)
     mNodes = STArray (sfAffectedNodes, 32);
     mDelivered = boost::optional <STAmount> ();
     mFeeShareTakers = STArray (sfFeeShareTakers, 5);
+    mFeeShareAccruals = STArray (sfFeeShareAccruals, 5);
 }
 
 void TxMeta::swap (TxMeta& s) noexcept
@@ -229,6 +237,7 @@ void TxMeta::swap (TxMeta& s) noexcept
     assert ((mTransactionID == s.mTransactionID) && (mLedger == s.mLedger));
     mNodes.swap (s.mNodes);
     mFeeShareTakers.swap (s.mFeeShareTakers);
+    mFeeShareAccruals.swap (s.mFeeShareAccruals);
 }
 
 bool TxMeta::thread (STObject& node, uint256 const& prevTxID, std::uint32_t prevLgrID)
@@ -262,6 +271,8 @@ STObject TxMeta::getAsObject () const
         metaData.setFieldAmount (sfDeliveredAmount, getDeliveredAmount ());
     if (hasFeeShareTakers ())
         metaData.setFieldArray (sfFeeShareTakers, getFeeShareTakers ());
+    if (hasFeeShareAccruals ())
+        metaData.setFieldArray (sfFeeShareAccruals, getFeeShareAccruals ());
     return metaData;
 }
 
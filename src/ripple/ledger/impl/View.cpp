@@ -20,14 +20,18 @@
 #include <BeastConfig.h>
 #include <ripple/app/misc/DividendMaster.h>
 #include <ripple/ledger/ReadView.h>
+#include <ripple/ledger/ReferralCache.h>
 #include <ripple/ledger/View.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/Feature.h>
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/Quality.h>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 namespace ripple {
 
@@ -196,6 +200,19 @@ accountFunds (ApplyView& view, AccountID const& id,
     return saFunds;
 }
 
+void
+prefetchDirPage (ReadView const& view, Keylet const& root,
+    SLE const& page)
+{
+    auto const& indexes = page.getFieldV256 (sfIndexes);
+    std::vector<uint256> keys;
+    keys.reserve (indexes.size () + 1);
+    keys.insert (keys.end (), indexes.begin (), indexes.end ());
+    if (auto const next = page.getFieldU64 (sfIndexNext))
+        keys.push_back (keylet::page (root, next).key);
+    view.prefetch (keys);
+}
+
 void
 forEachItem (ReadView const& view, AccountID const& id,
     std::function<void(std::shared_ptr<SLE const> const&)> f)
@@ -207,6 +224,7 @@ forEachItem (ReadView const& view, AccountID const& id,
         auto sle = view.read(pos);
         if (! sle)
             return;
+        prefetchDirPage (view, root, *sle);
         // VFALCO NOTE We aren't checking field exists?
         for (auto const& key : sle->getFieldV256(sfIndexes))
             f(view.read(keylet::child(key)));
@@ -218,6 +236,56 @@ forEachItem (ReadView const& view, AccountID const& id,
     }
 }
 
+void
+forEachSLE (ReadView const& view,
+    uint256 const& first, uint256 const& last,
+        std::function<bool (std::shared_ptr<SLE const> const&)> f)
+{
+    auto const end = view.sles.end ();
+    for (auto iter = view.sles.upper_bound (first); iter != end; ++iter)
+    {
+        auto const sle = *iter;
+        if (sle->key () >= last || ! f (sle))
+            return;
+    }
+}
+
+void
+forEachReference (ReadView const& view, AccountID const& refereeID,
+    std::function<bool (std::shared_ptr<SLE const> const&)> f)
+{
+    if (auto const sleRefer = view.read (keylet::refer (refereeID)))
+    {
+        if (sleRefer->isFieldPresent (sfReferences))
+        {
+            for (auto const& it : sleRefer->getFieldArray (sfReferences))
+            {
+                if (! f (view.read (keylet::account (
+                        it.getAccountID (sfReference)))))
+                    return;
+            }
+        }
+    }
+
+    auto const root = keylet::referDir (refereeID);
+    auto pos = root;
+    for (;;)
+    {
+        auto const sle = view.read (pos);
+        if (! sle)
+            return;
+        for (auto const& key : sle->getFieldV256 (sfIndexes))
+        {
+            if (! f (view.read (Keylet (ltACCOUNT_ROOT, key))))
+                return;
+        }
+        auto const next = sle->getFieldU64 (sfIndexNext);
+        if (! next)
+            return;
+        pos = keylet::page (root, next);
+    }
+}
+
 bool
 forEachItemAfter (ReadView const& view, AccountID const& id,
     uint256 const& after, std::uint64_t const hint,
@@ -251,6 +319,7 @@ forEachItemAfter (ReadView const& view, AccountID const& id,
             auto const ownerDir = view.read(currentIndex);
             if (! ownerDir)
                 return found;
+            prefetchDirPage (view, rootIndex, *ownerDir);
             for (auto const& key : ownerDir->getFieldV256 (sfIndexes))
             {
                 if (! found)
@@ -278,6 +347,7 @@ forEachItemAfter (ReadView const& view, AccountID const& id,
             auto const ownerDir = view.read(currentIndex);
             if (! ownerDir)
                 return true;
+            prefetchDirPage (view, rootIndex, *ownerDir);
             for (auto const& key : ownerDir->getFieldV256 (sfIndexes))
                 if (f (view.read(keylet::child(key))) && limit-- <= 1)
                     return true;
@@ -1210,6 +1280,22 @@ addRefer (ApplyView& view,
 
         return tefREFEREE_EXIST;
     }
+    else if (view.rules ().enabled (featureReferDirectory, {}))
+    {
+        // A reference has a single referee, so the sfReferee check above
+        // already rules out duplicates and the directory is only appended to.
+        std::uint64_t uNode;
+        auto const terResult = dirAdd (view, uNode,
+            getReferDirIndex (refereeID), keylet::account (referenceID).key,
+                describeOwnerDir (refereeID), j);
+        if (terResult != tesSUCCESS)
+            return terResult;
+
+        // set referee for reference
+        sleReference->setAccountID (sfReferee, refereeID);
+        view.update (sleReference);
+        referralCache ().invalidate (view);
+    }
     else
     {
         // set references for referee
@@ -1245,11 +1331,83 @@ addRefer (ApplyView& view,
         // set referee for reference
         sleReference->setAccountID (sfReferee, refereeID);
         view.update (sleReference);
+        referralCache ().invalidate (view);
     }
     
     return tesSUCCESS;
 }
 
+// The accounts of the referral chain above the sender that take a share
+// of its fees, at most five. They only depend on the referral chain and on
+// the results of the dividend round.
+static
+ReferralCache::takers_type
+feeShareTakers (ReadView const& view,
+    AccountID const& uSenderID, std::uint32_t divLedgerSeq,
+        beast::Journal j)
+{
+    // try find parent referee start from the sender itself
+    auto sleCurrent = view.read (keylet::account (uSenderID));
+    ReferralCache::takers_type takers;
+    while (sleCurrent && takers.size () < 5)
+    {
+        //no referee anymore
+        if (!sleCurrent->isFieldPresent(sfReferee))
+            break;
+
+        auto const currentAccountID = sleCurrent->getAccountID(sfReferee);
+        JLOG (j.debug) << "FeeShare: check " << currentAccountID;
+
+        sleCurrent = view.read (keylet::account (currentAccountID));
+        if (!sleCurrent)
+            break;
+
+        // there is a referee and it has field sfDividendLedger, which is exact the same as divObjLedgerSeq
+        if (!sleCurrent->isFieldPresent (sfDividendLedger) ||
+            sleCurrent->getFieldU32 (sfDividendLedger) != divLedgerSeq)
+            continue;
+
+        if (!sleCurrent->isFieldPresent (sfDividendVSprd))
+            continue;
+
+        std::uint64_t divVSpd = sleCurrent->getFieldU64 (sfDividendVSprd);
+        // only VSpd greater than 10000(000000) get the fee share
+        if (divVSpd <= MIN_VSPD_TO_GET_FEE_SHARE)
+            continue;
+
+        if (sleCurrent->isFieldPresent (sfReferee))
+        {
+            auto const parent = sleCurrent->getAccountID (sfReferee);
+            bool hasChildren = false;
+            bool isMaxChild = true;
+            forEachReference (view, parent,
+                [&](std::shared_ptr<SLE const> const& sleChild)
+                {
+                    hasChildren = true;
+                    if (sleChild &&
+                        sleChild->getAccountID (sfAccount) != currentAccountID &&
+                        sleChild->isFieldPresent (sfDividendLedger) &&
+                        sleChild->getFieldU32 (sfDividendLedger) == divLedgerSeq &&
+                        sleChild->isFieldPresent (sfDividendVSprd) &&
+                        sleChild->getFieldU64 (sfDividendVSprd) > divVSpd)
+                    {
+                        isMaxChild = false;
+                        return false;
+                    }
+                    return true;
+                });
+            if (hasChildren && isMaxChild)
+            {
+                JLOG (j.debug) << "\tskip as max child";
+                continue;
+            }
+        }
+
+        takers.push_back (currentAccountID);
+    }
+    return takers;
+}
+
 TER
 shareFeeWithReferee (ApplyView& view,
     AccountID const& uSenderID, AccountID const& uIssuerID, const STAmount& saAmount,
@@ -1272,68 +1430,23 @@ shareFeeWithReferee (ApplyView& view,
         std::map<AccountID, STAmount> takersMap;
         // extract ledgerSeq and total VSpd
         std::uint32_t divLedgerSeq = sleDivObj->getFieldU32(sfDividendLedger);
-        // try find parent referee start from the sender itself
-        auto sleCurrent = view.read (keylet::account (uSenderID));
+        auto const takers = referralCache ().fetch (
+            view, uSenderID, divLedgerSeq, [&]()
+            {
+                return feeShareTakers (view, uSenderID, divLedgerSeq, j);
+            });
+        // Accrued shares are credited by a later FeeShareSettle
+        bool const accrue = view.rules ().enabled (featureFeeShareAccrual, {});
+        auto const credit = [&](AccountID const& taker, STAmount const& share)
+            {
+                return accrue ? tesSUCCESS :
+                    rippleCredit (view, uIssuerID, taker, share, false, j);
+            };
         int sendCnt = 0;
         AccountID lastAccount;
-        while (tesSUCCESS == terResult && sleCurrent && sendCnt < 5)
+        for (auto const& currentAccountID : takers)
         {
-            //no referee anymore
-            if (!sleCurrent->isFieldPresent(sfReferee))
-                break;
-
-            auto const currentAccountID = sleCurrent->getAccountID(sfReferee);
-            JLOG (j.debug) << "FeeShare: check " << currentAccountID;
-
-            sleCurrent = view.read (keylet::account (currentAccountID));
-            if (!sleCurrent)
-                break;
-
-            // there is a referee and it has field sfDividendLedger, which is exact the same as divObjLedgerSeq
-            if (!sleCurrent->isFieldPresent (sfDividendLedger) ||
-                sleCurrent->getFieldU32 (sfDividendLedger) != divLedgerSeq)
-                continue;
-
-            if (!sleCurrent->isFieldPresent (sfDividendVSprd))
-                continue;
-
-            std::uint64_t divVSpd = sleCurrent->getFieldU64 (sfDividendVSprd);
-            // only VSpd greater than 10000(000000) get the fee share
-            if (divVSpd <= MIN_VSPD_TO_GET_FEE_SHARE)
-                continue;
-
-            if (sleCurrent->isFieldPresent (sfReferee))
-            {
-                auto const parent = sleCurrent->getAccountID (sfReferee);
-                auto const sleReferences = view.read (keylet::refer (parent));
-                if (sleReferences)
-                {
-                    bool isMaxChild = true;;
-                    for (auto const& child : sleReferences->getFieldArray(sfReferences))
-                    {
-                        auto const childId = child.getAccountID(sfReference);
-                        if (childId == currentAccountID)
-                            continue;
-                        auto const sleChild = view.read (keylet::account (childId));
-                        if (sleChild &&
-                            sleChild->isFieldPresent (sfDividendLedger) &&
-                            sleChild->getFieldU32 (sfDividendLedger) == divLedgerSeq &&
-                            sleChild->isFieldPresent (sfDividendVSprd) &&
-                            sleChild->getFieldU64 (sfDividendVSprd) > divVSpd)
-                        {
-                            isMaxChild = false;
-                            break;
-                        }
-                    }
-                    if (isMaxChild)
-                    {
-                        JLOG (j.debug) << "\tskip as max child";
-                        continue;
-                    }
-                }
-            }
-
-            terResult = rippleCredit (view, uIssuerID, currentAccountID, saTransFeeShareEach, false, j);
+            terResult = credit (currentAccountID, saTransFeeShareEach);
             if (tesSUCCESS != terResult)
                 break;
 
@@ -1353,7 +1466,7 @@ shareFeeWithReferee (ApplyView& view,
             {
                 // can't find 5 ancestors, give all share to last ancestor
                 STAmount saLeft = multiply (saTransFeeShareEach, STAmount (saTransFeeShareEach.issue (), 5 - sendCnt), saTransFeeShareEach.issue ());
-                terResult = rippleCredit (view, uIssuerID, lastAccount, saLeft, false, j);
+                terResult = credit (lastAccount, saLeft);
                 if (terResult == tesSUCCESS)
                 {
                     auto itTaker = takersMap.find(lastAccount);
@@ -1367,7 +1480,22 @@ shareFeeWithReferee (ApplyView& view,
                 JLOG (j.debug) << "FeeShare: left " << saLeft << " goes to "<< lastAccount;
             }
             
-            if (terResult == tesSUCCESS && takersMap.size())
+            if (terResult == tesSUCCESS && takersMap.size() && accrue)
+            {
+                // The settlement state starts with the first accrual
+                if (! view.exists (keylet::feeShareAccrual ()))
+                {
+                    auto const sle = std::make_shared<SLE> (
+                        keylet::feeShareAccrual ());
+                    sle->setFieldU32 (sfLedgerSequence, view.seq () - 1);
+                    view.insert (sle);
+                }
+
+                STArray& accruals (view.peekFeeShareAccruals ());
+                for (auto const& taker : takersMap)
+                    addFeeShare (accruals, taker.first, taker.second);
+            }
+            else if (terResult == tesSUCCESS && takersMap.size())
             {
                 // if there are FeeShareTakers, record it
                 STArray& feeShareTakers (view.peekFeeShareTakers ());
@@ -1400,44 +1528,133 @@ shareFeeWithReferee (ApplyView& view,
     return terResult;
 }
 
+void
+addFeeShare (STArray& shares,
+    AccountID const& account, STAmount const& amount)
+{
+    for (auto& share : shares)
+    {
+        if (share.getAccountID (sfAccount) != account)
+            continue;
+        auto const before = share.getFieldAmount (sfAmount);
+        if (before.issue () == amount.issue ())
+        {
+            share.setFieldAmount (sfAmount, before + amount);
+            return;
+        }
+    }
+    STObject share (sfFeeShareTaker);
+    share.setAccountID (sfAccount, account);
+    share.setFieldAmount (sfAmount, amount);
+    shares.push_back (std::move (share));
+}
+
+namespace {
+
+// The release schedule of an asset, decoded once for all the asset
+// states of a line rather than for each of them.
+class ReleaseSchedule
+{
+private:
+    boost::optional<Issue> issue_;
+    bool exists_ = false;
+    // Sorted, as IssueAsset requires increasing expirations
+    std::vector<uint32> expirations_;
+    std::vector<uint32> rates_;
+
+public:
+    // Returns false if the asset does not exist
+    bool
+    load (ReadView const& view, Issue const& issue)
+    {
+        if (issue_ && *issue_ == issue)
+            return exists_;
+
+        issue_ = issue;
+        expirations_.clear ();
+        rates_.clear ();
+        auto const sleAsset = view.read (keylet::asset (issue));
+        exists_ = bool (sleAsset);
+        if (exists_)
+        {
+            STArray const& releaseSchedule =
+                sleAsset->getFieldArray (sfReleaseSchedule);
+            expirations_.reserve (releaseSchedule.size ());
+            rates_.reserve (releaseSchedule.size ());
+            for (auto const& releasePoint : releaseSchedule)
+            {
+                expirations_.push_back (releasePoint.getFieldU32 (sfExpiration));
+                rates_.push_back (releasePoint.getFieldU32 (sfReleaseRate));
+            }
+        }
+        return exists_;
+    }
+
+    bool
+    empty () const
+    {
+        return expirations_.empty ();
+    }
+
+    std::size_t
+    size () const
+    {
+        return expirations_.size ();
+    }
+
+    // The first point not yet reached by a state bought at the given time
+    std::size_t
+    next (uint64 boughtTime, uint32 parentCloseTime) const
+    {
+        if (boughtTime > parentCloseTime)
+            return 0;
+        auto const elapsed = parentCloseTime - boughtTime;
+        auto const it = std::upper_bound (
+            expirations_.begin (), expirations_.end (), elapsed);
+        return it - expirations_.begin ();
+    }
+
+    uint32
+    expiration (std::size_t i) const
+    {
+        return expirations_[i];
+    }
+
+    uint32
+    rate (std::size_t i) const
+    {
+        return rates_[i];
+    }
+};
+
 std::tuple<STAmount, bool>
 assetReleased (ApplyView& view,
     STAmount const& amount,
     uint256 assetStateIndex,
     std::shared_ptr<SLE>& sleAssetState,
+    ReleaseSchedule& schedule,
         beast::Journal j)
 {
     STAmount released(amount.issue());
     bool bIsReleaseFinished = false;
-    auto const& sleAsset = view.read (keylet::asset (amount.issue ()));
 
-    if (sleAsset) {
+    if (schedule.load (view, amount.issue ())) {
         uint64 boughtTime = getQuality(assetStateIndex);
-        STArray const& releaseSchedule = sleAsset->getFieldArray(sfReleaseSchedule);
         uint32 releaseRate = 0;
-        uint32 nextInterval = 0;
 
-        if (releaseSchedule.empty ())
+        if (schedule.empty ())
             bIsReleaseFinished = true;
         else
         {
-            auto iteReleasePoint = releaseSchedule.begin ();
-            for (;iteReleasePoint != releaseSchedule.end (); ++iteReleasePoint)
-            {
-                if (boughtTime + iteReleasePoint->getFieldU32 (sfExpiration) > view.info ().parentCloseTime)
-                {
-                    nextInterval = iteReleasePoint->getFieldU32 (sfExpiration);
-                    break;
-                }
-                
-                releaseRate = iteReleasePoint->getFieldU32 (sfReleaseRate);
-            }
-            if (iteReleasePoint == releaseSchedule.end ())
+            auto const next = schedule.next (
+                boughtTime, view.info ().parentCloseTime);
+            if (next > 0)
+                releaseRate = schedule.rate (next - 1);
+            if (next == schedule.size ())
             {
                 bIsReleaseFinished = true;
-                releaseRate = releaseSchedule.back ().getFieldU32 (sfReleaseRate);
             }
-            else if (nextInterval > 0)
+            else if (auto const nextInterval = schedule.expiration (next))
             {
                 sleAssetState->setFieldU32 (sfNextReleaseTime,
                                             (uint32)boughtTime + nextInterval);
@@ -1455,6 +1672,20 @@ assetReleased (ApplyView& view,
     return std::make_tuple(released, bIsReleaseFinished);
 }
 
+} // namespace
+
+std::tuple<STAmount, bool>
+assetReleased (ApplyView& view,
+    STAmount const& amount,
+    uint256 assetStateIndex,
+    std::shared_ptr<SLE>& sleAssetState,
+        beast::Journal j)
+{
+    ReleaseSchedule schedule;
+    return assetReleased (
+        view, amount, assetStateIndex, sleAssetState, schedule, j);
+}
+
 TER
 assetRelease (ApplyView& view,
     AccountID const& uSrcAccountID,
@@ -1464,6 +1695,23 @@ assetRelease (ApplyView& view,
         beast::Journal j)
 {
     TER terResult = tesSUCCESS;
+    auto const parentCloseTime = view.info ().parentCloseTime;
+
+    // Lines keep the earliest time any of their asset states releases,
+    // so that nothing needs to be read before then.
+    bool const bSummary = view.rules ().enabled (
+        featureAssetReleaseSummary, {});
+    if (bSummary &&
+        sleRippleState->isFieldPresent (sfNextReleaseTime) &&
+        sleRippleState->isFieldPresent (sfReserve) &&
+        sleRippleState->getFieldU32 (sfNextReleaseTime) > parentCloseTime)
+    {
+        return terResult;
+    }
+    // No release is known to be due before
+    uint32 uNextRelease = std::numeric_limits<uint32>::max ();
+    ReleaseSchedule schedule;
+
     STAmount saBalance = sleRippleState->getFieldAmount(sfBalance);
     STAmount saReserve ({assetCurrency (), noAccount ()});
     uint256 baseIndex = getAssetStateIndex(uSrcAccountID, uDstAccountID, currency);
@@ -1484,37 +1732,50 @@ assetRelease (ApplyView& view,
         }
     }
     
-    for (;;)
-    {
-        auto key = view.succ (assetStateIndex, assetStateEnd);
-
-        if (!key)
-            break;
-
-        assetStateIndex = *key;
+    // Those not due are only read
+    std::vector<std::shared_ptr<SLE const>> states;
+    forEachSLE (view, assetStateIndex, assetStateEnd,
+        [&](std::shared_ptr<SLE const> const& sle)
+        {
+            if (sle->getType () == ltASSET_STATE)
+                states.push_back (sle);
+            return true;
+        });
 
-        auto sleAssetState = view.peek (keylet::asset_state (assetStateIndex));
-        if (!sleAssetState)
-            continue;
+    for (auto const& state : states)
+    {
+        assetStateIndex = state->key ();
 
-        STAmount amount = sleAssetState->getFieldAmount(sfAmount);
-        AccountID const& owner = sleAssetState->getAccountID(sfAccount);
+        STAmount amount = state->getFieldAmount(sfAmount);
+        AccountID const& owner = state->getAccountID(sfAccount);
         if (!(owner == uSrcAccountID && amount.getIssuer() == uDstAccountID) &&
             !(owner == uDstAccountID && amount.getIssuer() == uSrcAccountID))
             continue;
 
-        STAmount delivered = sleAssetState->getFieldAmount(sfDeliveredAmount);
+        STAmount delivered = state->getFieldAmount(sfDeliveredAmount);
         if (!delivered)
             delivered.setIssue(amount.issue());
 
         STAmount released;
         bool bIsReleaseFinished = false;
+        std::shared_ptr<SLE> sleAssetState;
         // Make sure next release time is up.
-        uint32 nextReleaseTime = sleAssetState->getFieldU32(sfNextReleaseTime);
-        if (nextReleaseTime > view.info ().parentCloseTime)
+        uint32 nextReleaseTime = state->getFieldU32(sfNextReleaseTime);
+        if (nextReleaseTime > parentCloseTime)
             released = delivered;
         else
-            std::tie (released, bIsReleaseFinished) = assetReleased (view, amount, assetStateIndex, sleAssetState, j);
+        {
+            sleAssetState = view.peek (keylet::asset_state (assetStateIndex));
+            if (!sleAssetState)
+                continue;
+            std::tie (released, bIsReleaseFinished) = assetReleased (view, amount, assetStateIndex, sleAssetState, schedule, j);
+            nextReleaseTime = sleAssetState->getFieldU32 (sfNextReleaseTime);
+        }
+
+        // Finished states release nothing more. Others without a next
+        // release time must be read again next time.
+        if (!bIsReleaseFinished)
+            uNextRelease = std::min (uNextRelease, nextReleaseTime);
 
         bool bIssuerHigh = amount.getIssuer() > owner;
 
@@ -1629,6 +1890,13 @@ assetRelease (ApplyView& view,
         view.update (sleRippleState);
     }
 
+    if (bSummary && tesSUCCESS == terResult &&
+        (!sleRippleState->isFieldPresent (sfNextReleaseTime) ||
+         sleRippleState->getFieldU32 (sfNextReleaseTime) != uNextRelease)) {
+        sleRippleState->setFieldU32 (sfNextReleaseTime, uNextRelease);
+        view.update (sleRippleState);
+    }
+
     JLOG(j.trace) << __func__ << ": final balance:" << saBalance << " reserved:" << saReserve;
 
     return terResult;
@@ -1740,7 +2008,13 @@ issueAsset (ApplyView& view,
             }
             // Move released amount to TrustLine
             if (tesSUCCESS == terResult)
+            {
+                // The new asset state has not been counted in the line's
+                // next release time.
+                if (sleRippleState->isFieldPresent (sfNextReleaseTime))
+                    sleRippleState->makeFieldAbsent (sfNextReleaseTime);
                 assetRelease (view, uSenderID, uReceiverID, currency, sleRippleState, j);
+            }
             return {true, terResult};
         }
     }
@@ -2054,10 +2328,12 @@ accountSend (ApplyView& view,
     }
 
     bool const bVBC (isVBC(saAmount));
+    auto const& field = bVBC ? sfBalanceVBC : sfBalance;
+    auto const drops = saAmount.xrp ();
 
     if (sender)
     {
-        if (sender->getFieldAmount (bVBC?sfBalanceVBC:sfBalance) < saAmount)
+        if (nativeBalance (*sender, field) < drops)
         {
             // VFALCO Its laborious to have to mutate the
             //        TER based on params everywhere
@@ -2068,8 +2344,7 @@ accountSend (ApplyView& view,
         else
         {
             // Decrement XRP balance.
-            sender->setFieldAmount (bVBC?sfBalanceVBC:sfBalance,
-                sender->getFieldAmount (bVBC?sfBalanceVBC:sfBalance) - saAmount);
+            adjustNativeBalance (*sender, field, -drops);
             view.update (sender);
         }
     }
@@ -2077,8 +2352,7 @@ accountSend (ApplyView& view,
     if (tesSUCCESS == terResult && receiver)
     {
         // Increment XRP balance.
-        receiver->setFieldAmount (bVBC?sfBalanceVBC:sfBalance,
-            receiver->getFieldAmount (bVBC?sfBalanceVBC:sfBalance) + saAmount);
+        adjustNativeBalance (*receiver, field, drops);
         view.update (receiver);
     }
 
@@ -2305,6 +2579,20 @@ redeemIOU (ApplyView& view,
     return tesSUCCESS;
 }
 
+XRPAmount
+nativeBalance (SLE const& sle, SF_Amount const& field)
+{
+    return sle.getFieldAmount (field).xrp ();
+}
+
+void
+adjustNativeBalance (SLE& sle, SF_Amount const& field, XRPAmount delta)
+{
+    auto const balance = nativeBalance (sle, field) + delta;
+    sle.setFieldAmount (field,
+        STAmount (field, &field == &sfBalanceVBC, balance.drops ()));
+}
+
 TER
 transferXRP (ApplyView& view,
     AccountID const& from,
@@ -2325,8 +2613,9 @@ transferXRP (ApplyView& view,
         ") : " << amount.getFullText ();
 
     auto const& field = isVBC (amount) ? sfBalanceVBC : sfBalance;
+    auto const drops = amount.xrp ();
 
-    if (sender->getFieldAmount (field) < amount)
+    if (nativeBalance (*sender, field) < drops)
     {
         // VFALCO Its unfortunate we have to keep
         //        mutating these TER everywhere
@@ -2337,12 +2626,10 @@ transferXRP (ApplyView& view,
     }
 
     // Decrement XRP balance.
-    sender->setFieldAmount (field,
-        sender->getFieldAmount (field) - amount);
+    adjustNativeBalance (*sender, field, -drops);
     view.update (sender);
 
-    receiver->setFieldAmount (field,
-        receiver->getFieldAmount (field) + amount);
+    adjustNativeBalance (*receiver, field, drops);
     view.update (receiver);
 
     return tesSUCCESS;
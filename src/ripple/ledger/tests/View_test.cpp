@@ -21,8 +21,10 @@
 #include <ripple/test/jtx.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/ledger/ApplyViewImpl.h>
+#include <ripple/ledger/CachedView.h>
 #include <ripple/ledger/OpenView.h>
 #include <ripple/ledger/PaymentSandbox.h>
+#include <ripple/ledger/ReferralCache.h>
 #include <ripple/ledger/Sandbox.h>
 #include <type_traits>
 
@@ -178,6 +180,46 @@ class View_test
         expect(v.exists(k(3)));
     }
 
+    // Successors are cached once, under changes made above the cache
+    void
+    testCachedSucc()
+    {
+        using namespace jtx;
+        Env env(*this);
+        Config config;
+        std::shared_ptr<Ledger const> const genesis =
+            std::make_shared<Ledger>(
+                create_genesis, config, env.app().family());
+        auto const ledger =
+            std::make_shared<Ledger>(
+                open_ledger, *genesis,
+                env.app().timeKeeper().closeTime());
+        wipe(*ledger);
+        ledger->rawInsert(sle(1));
+        ledger->rawInsert(sle(4));
+
+        CachedSLEs cache(std::chrono::minutes(1), stopwatch());
+        auto const cached = std::make_shared<CachedLedger const>(
+            ledger, cache);
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            succ(*cached, 0, 1);
+            succ(*cached, 1, 4);
+            succ(*cached, 2, 4);
+            succ(*cached, 4, boost::none);
+            expect(cached->succ(k(0).key, k(1).key) == boost::none);
+        }
+
+        OpenView open(open_ledger, cached.get(), ledger->rules());
+        ApplyViewImpl v(&open, tapNONE);
+        v.insert(sle(2));
+        v.erase(v.peek(k(4)));
+        succ(v, 0, 1);
+        succ(v, 1, 2);
+        succ(v, 2, boost::none);
+        succ(*cached, 2, 4);
+    }
+
     void
     testMeta()
     {
@@ -561,18 +603,141 @@ class View_test
         }
     }
 
+    // Keys after first and before last found via forEachSLE
+    static
+    std::vector<uint256>
+    range (ReadView const& view,
+        std::uint64_t first, std::uint64_t last)
+    {
+        std::vector<uint256> v;
+        forEachSLE (view, uint256(first), uint256(last),
+            [&v](std::shared_ptr<SLE const> const& sle)
+            {
+                v.push_back(sle->key());
+                return true;
+            });
+        return v;
+    }
+
+    // Exercise sles through the apply views
+    void
+    testMetaSles()
+    {
+        using namespace jtx;
+        Env env(*this);
+        wipe(env.openLedger);
+        auto const open = env.open();
+        ApplyViewImpl v0(&*open, tapNONE);
+        v0.insert(sle(1));
+        v0.insert(sle(2));
+        v0.insert(sle(4));
+        v0.insert(sle(7));
+        {
+            Sandbox v1(&v0);
+            v1.insert(sle(3));
+            v1.insert(sle(5));
+            v1.insert(sle(6));
+
+            // v0: 12-4--7
+            // v1: --3-56-
+
+            expect (sles (v0) == list (1, 2, 4, 7));
+            expect (sles (v1) == list (1, 2, 3, 4, 5, 6, 7));
+
+            v1.erase(v1.peek(k(4)));
+            v1.erase(v1.peek(k(7)));
+            auto s = v1.peek(k(2));
+            seq(s, 2);
+            v1.update(s);
+
+            // v1: 123-56-
+            expect (sles (v1) == list (1, 2, 3, 5, 6));
+            expect (seq (*std::next (v1.sles.begin ())) == 2);
+            expect (range (v1, 1, 6) == list (2, 3, 5));
+            expect (range (v1, 3, 8) == list (5, 6));
+            expect (range (v1, 6, 8).empty ());
+
+            auto b = v1.sles.begin();
+            expect (v1.sles.upper_bound(uint256(0)) == b); ++b;
+            expect (v1.sles.upper_bound(uint256(1)) == b); ++b;
+            expect (v1.sles.upper_bound(uint256(2)) == b); ++b;
+            expect (v1.sles.upper_bound(uint256(3)) == b);
+            expect (v1.sles.upper_bound(uint256(4)) == b); ++b;
+            expect (v1.sles.upper_bound(uint256(5)) == b); ++b;
+            expect (v1.sles.upper_bound(uint256(6)) == b);
+            expect (v1.sles.upper_bound(uint256(7)) == b);
+            expect (b == v1.sles.end());
+        }
+    }
+
+    void
+    testReferralCache()
+    {
+        using namespace jtx;
+        Env env(*this);
+        Config config;
+        std::shared_ptr<Ledger const> const genesis =
+            std::make_shared<Ledger>(
+                create_genesis, config, env.app().family());
+        auto const ledger =
+            std::make_shared<Ledger>(
+                open_ledger, *genesis,
+                env.app().timeKeeper().closeTime());
+        auto const alice = Account("alice").id();
+        auto const bob = Account("bob").id();
+
+        ReferralCache cache;
+        int calls = 0;
+        auto fetch = [&](ReadView const& view,
+            AccountID const& account, std::uint32_t round)
+        {
+            return cache.fetch(view, account, round, [&]()
+            {
+                ++calls;
+                return ReferralCache::takers_type{bob};
+            });
+        };
+
+        OpenView v0(ledger.get());
+        OpenView v1(ledger.get());
+        expect(fetch(v0, alice, 1) == ReferralCache::takers_type{bob});
+        expect(calls == 1);
+
+        // Views on the same parent share the takers
+        expect(fetch(v1, alice, 1) == ReferralCache::takers_type{bob});
+        expect(calls == 1);
+
+        // but not across accounts and dividend rounds
+        fetch(v0, bob, 1);
+        expect(calls == 2);
+        fetch(v0, alice, 2);
+        expect(calls == 3);
+        fetch(v1, alice, 2);
+        expect(calls == 3);
+
+        // A reference added in any of them makes the ledger stale
+        cache.invalidate(v1);
+        fetch(v0, alice, 1);
+        fetch(v0, alice, 1);
+        expect(calls == 5);
+        expect(cache.rate() > 0);
+    }
+
     void run()
     {
         // This had better work, or else
         expect(k(0).key < k(1).key);
 
         testLedger();
+        testCachedSucc();
         testMeta();
         testMetaSucc();
+        testMetaSles();
         testStacked();
         testContext();
         testSles();
         testRegressions();
+        testReferralCache();
     }
 };
 
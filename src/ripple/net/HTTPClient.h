@@ -24,6 +24,7 @@
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/streambuf.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <memory>
 
 namespace ripple {
 
@@ -71,6 +72,30 @@ public:
         boost::posix_time::time_duration timeout,
         std::function <bool (const boost::system::error_code& ecResult, int iStatus, std::string const& strData)> complete,
         Logs& l);
+
+    /** Requests made one after another to the same site.
+
+        The connection is kept for the next request while the server allows
+        it. A request is made only after the last one completes.
+    */
+    class Session
+    {
+    public:
+        virtual ~Session () = default;
+
+        virtual void request (
+            std::function <void (boost::asio::streambuf& sb, std::string const& strHost)> build,
+            boost::posix_time::time_duration timeout,
+            std::function <bool (const boost::system::error_code& ecResult, int iStatus, std::string const& strData)> complete) = 0;
+    };
+
+    static std::shared_ptr <Session> makeSession (
+        bool bSSL,
+        boost::asio::io_service& io_service,
+        std::string strSite,
+        const unsigned short port,
+        std::size_t responseMax,
+        Logs& l);
 };
 
 } // ripple
@@ -22,10 +22,12 @@
 
 #include <ripple/basics/CountedObject.h>
 #include <ripple/json/json_value.h>
+#include <ripple/net/SharedMessage.h>
 #include <ripple/protocol/RippleAddress.h>
 #include <ripple/resource/Consumer.h>
 #include <ripple/protocol/Book.h>
 #include <beast/threads/Stoppable.h>
+#include <atomic>
 #include <mutex>
 
 namespace ripple {
@@ -105,6 +107,13 @@ public:
         virtual bool unsubPeerStatus (std::uint64_t uListener) = 0;
         virtual void pubPeerStatus (std::function<Json::Value(void)> const&) = 0;
 
+        virtual bool subDividend (ref ispListener) = 0;
+        virtual bool unsubDividend (std::uint64_t uListener) = 0;
+        virtual void pubDividend (std::function<Json::Value(void)> const&) = 0;
+
+        virtual bool subFee (ref ispListener, Json::Value& jvResult) = 0;
+        virtual bool unsubFee (std::uint64_t uListener) = 0;
+
         // VFALCO TODO Remove
         //             This was added for one particular partner, it
         //             "pushes" subscription data to a particular URL.
@@ -124,7 +133,28 @@ public:
 
     // virtual so that a derived class can optimize this case
     virtual void send (
-        Json::Value const& jvObj, std::string const& sObj, bool broadcast);
+        Json::Value const& jvObj, SharedMessage const& message,
+            bool broadcast);
+
+    /** Send a binary stream event.
+        Only subscribers which can send binary messages may ask for them,
+        the default discards the message.
+    */
+    virtual void send (SharedMessage const& message, bool broadcast);
+
+    /** Returns true if the ledger and transactions streams are sent in
+        binary. @see BinaryStream
+    */
+    bool getBinary () const;
+
+    void setBinary (bool binary);
+
+    /** Returns true if validated transactions carry their trace.
+        Only admin subscribers get them. @see TxTrace
+    */
+    bool getTrace () const;
+
+    void setTrace (bool trace);
 
     std::uint64_t getSeq ();
 
@@ -156,6 +186,8 @@ private:
     hash_set <AccountID> normalSubscriptions_;
     std::shared_ptr <PathRequest> mPathRequest;
     std::uint64_t                 mSeq;
+    std::atomic <bool>            binary_ {false};
+    std::atomic <bool>            trace_ {false};
 };
 
 } // ripple
@@ -22,6 +22,7 @@
 
 #include <ripple/core/Config.h>
 #include <ripple/json/json_value.h>
+#include <ripple/net/HTTPClient.h>
 #include <boost/asio/io_service.hpp>
 #include <functional>
 #include <string>
@@ -51,6 +52,27 @@ void fromNetwork (
     Json::Value const& jvParams, const bool bSSL, bool quiet,
     Logs& logs,
     std::function<void (Json::Value const& jvInput)> callbackFuncP = std::function<void (Json::Value const& jvInput)> ());
+
+/** Make a session for calls to the same server, which keeps the connection
+    open between them.
+*/
+std::shared_ptr<HTTPClient::Session> makeSession (
+    boost::asio::io_service& io_service,
+    std::string const& strIp, const int iPort, const bool bSSL,
+    Logs& logs);
+
+/** Call a method on the server of a session.
+
+    The reply is not parsed. The callback is told if the server accepted
+    the call with a 2xx status.
+*/
+void fromNetwork (
+    HTTPClient::Session& session,
+    std::string const& strUsername, std::string const& strPassword,
+    std::string const& strPath, std::string const& strMethod,
+    Json::Value const& jvParams,
+    Logs& logs,
+    std::function<void (bool bAccepted)> callbackFuncP);
 }
 
 } // ripple
@@ -22,6 +22,7 @@
 
 #include <ripple/core/JobQueue.h>
 #include <ripple/net/InfoSub.h>
+#include <beast/insight/Collector.h>
 #include <beast/threads/Stoppable.h>
 #include <boost/asio/io_service.hpp>
 
@@ -38,11 +39,24 @@ protected:
     explicit RPCSub (InfoSub::Source& source);
 };
 
+/** How events are delivered to the server of a subscription. */
+struct RPCSubOptions
+{
+    // Most events in one request. With more than one the method is
+    // "events", and the params are an array of events.
+    std::size_t batch = 1;
+
+    // Most requests in flight, each on its own connection.
+    std::size_t connections = 4;
+};
+
 // VFALCO Why is the io_service needed?
 std::shared_ptr<RPCSub> make_RPCSub (
     InfoSub::Source& source, boost::asio::io_service& io_service,
     JobQueue& jobQueue, std::string const& strUrl,
     std::string const& strUsername, std::string const& strPassword,
+    RPCSubOptions const& options,
+    beast::insight::Collector::ptr const& collector,
     Logs& logs);
 
 } // ripple
@@ -0,0 +1,105 @@
+#ifndef RIPPLE_NET_SHAREDMESSAGE_H_INCLUDED
+#define RIPPLE_NET_SHAREDMESSAGE_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/json/json_value.h>
+#include <ripple/json/to_string.h>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** An event published to every subscriber of a stream.
+
+    The event is serialized once, and all subscribers are sent the same
+    payload. A transport may also keep encodings of the payload, such as
+    websocket frames, which are then built once and shared as well.
+
+    An event which only matters in its latest form, such as a ledger
+    closing, has a key. A subscriber which is behind may skip to the newest
+    queued event with the same key. @see SendQueue
+*/
+class SharedMessage
+{
+public:
+    explicit
+    SharedMessage (Json::Value const& jv, std::string key = {})
+        : payload_ (to_string (jv))
+        , key_ (std::move (key))
+    {
+    }
+
+    /** Create a binary message. */
+    explicit
+    SharedMessage (Blob const& data, std::string key = {})
+        : payload_ (data.begin (), data.end ())
+        , key_ (std::move (key))
+        , binary_ (true)
+    {
+    }
+
+    SharedMessage (SharedMessage const&) = delete;
+    SharedMessage& operator= (SharedMessage const&) = delete;
+
+    /** Returns the JSON text, or the data of a binary message. */
+    std::string const&
+    payload () const
+    {
+        return payload_;
+    }
+
+    bool
+    binary () const
+    {
+        return binary_;
+    }
+
+    std::string const&
+    key () const
+    {
+        return key_;
+    }
+
+    /** The number of encodings a transport can keep. */
+    static std::size_t const encodings = 8;
+
+    /** Returns one of the transport's encodings of the text.
+
+        A transport keeps one encoding for each way it sends the message,
+        such as with each set of compression parameters. The first caller
+        makes it with make (*this), which returns a Ptr. Every caller for
+        an encoding must use the same Ptr, and must not modify what it
+        points to.
+    */
+    template <class Ptr, class Make>
+    Ptr const&
+    encoded (std::size_t index, Make&& make) const
+    {
+        std::call_once (once_[index], [&]
+            {
+                encoded_[index] = std::make_shared<Ptr> (make (*this));
+            });
+        return *static_cast<Ptr const*> (encoded_[index].get ());
+    }
+
+    template <class Ptr, class Make>
+    Ptr const&
+    encoded (Make&& make) const
+    {
+        return encoded<Ptr> (0, std::forward<Make> (make));
+    }
+
+private:
+    std::string payload_;
+    std::string key_;
+    bool binary_ = false;
+    mutable std::array<std::once_flag, encodings> once_;
+    mutable std::array<std::shared_ptr<void>, encodings> encoded_;
+};
+
+} // ripple
+
+#endif
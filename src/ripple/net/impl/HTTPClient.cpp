@@ -104,13 +104,16 @@ public:
     HTTPClientImp (boost::asio::io_service& io_service,
         const unsigned short port,
         std::size_t responseMax,
-        Logs& l)
+        Logs& l,
+        bool persistent = false)
         : mSocket (io_service, httpClientSSLContext->context (), l.journal ("AutoSocket"))
         , mResolver (io_service)
         , mHeader (maxClientHeaderBytes)
         , mPort (port)
+        , mResponseLimit (responseMax)
         , mResponseMax (responseMax)
         , mDeadline (io_service)
+        , mPersistent (persistent)
         , j_ (l.journal ("HTTPClient"))
     {
         if (!httpClientSSLContext->sslVerify())
@@ -150,6 +153,49 @@ public:
         httpsNext ();
     }
 
+    /** Make another request on the connection of the previous one.
+        @see reusable
+    */
+    void requestAgain (
+        std::function<void (boost::asio::streambuf& sb, std::string const& strHost)> build,
+        boost::posix_time::time_duration timeout,
+        std::function<bool (const boost::system::error_code& ecResult,
+            int iStatus, std::string const& strData)> complete)
+    {
+        mBuild      = build;
+        mComplete   = complete;
+        mTimeout    = timeout;
+
+        mResponseMax = mResponseLimit;
+        mStatus     = 0;
+        mBody.clear ();
+        mHeader.consume (mHeader.size ());
+        mResponse.consume (mResponse.size ());
+        mKeepAlive  = false;
+        mResponded  = false;
+
+        startDeadline ();
+
+        if (mShutdown)
+            invokeComplete (mShutdown);
+        else
+            handleRequest (mShutdown);
+    }
+
+    /** Returns true if the server keeps the connection open for another
+        request. Only persistent clients ask it to.
+    */
+    bool reusable () const
+    {
+        return mKeepAlive && !mShutdown;
+    }
+
+    /** Returns true if the server began to respond to the last request. */
+    bool responded () const
+    {
+        return mResponded;
+    }
+
     //--------------------------------------------------------------------------
 
     void get (
@@ -185,18 +231,7 @@ public:
                 boost::asio::ip::resolver_query_base::numeric_service);
         mQuery  = query;
 
-        mDeadline.expires_from_now (mTimeout, mShutdown);
-
-        JLOG (j_.trace) << "expires_from_now: " << mShutdown.message ();
-
-        if (!mShutdown)
-        {
-            mDeadline.async_wait (
-                std::bind (
-                    &HTTPClientImp::handleDeadline,
-                    shared_from_this (),
-                    beast::asio::placeholders::error));
-        }
+        startDeadline ();
 
         if (!mShutdown)
         {
@@ -214,6 +249,22 @@ public:
             invokeComplete (mShutdown);
     }
 
+    void startDeadline ()
+    {
+        mDeadline.expires_from_now (mTimeout, mShutdown);
+
+        JLOG (j_.trace) << "expires_from_now: " << mShutdown.message ();
+
+        if (!mShutdown)
+        {
+            mDeadline.async_wait (
+                std::bind (
+                    &HTTPClientImp::handleDeadline,
+                    shared_from_this (),
+                    beast::asio::placeholders::error));
+        }
+    }
+
     void handleDeadline (const boost::system::error_code& ecResult)
     {
         if (ecResult == boost::asio::error::operation_aborted)
@@ -388,6 +439,9 @@ public:
         std::string     strHeader ((std::istreambuf_iterator<char> (&mHeader)), std::istreambuf_iterator<char> ());
         JLOG (j_.trace) << "Header: \"" << strHeader << "\"";
 
+        if (!ecResult)
+            mResponded  = true;
+
         static boost::regex reStatus ("\\`HTTP/1\\S+ (\\d{3}) .*\\'");          // HTTP/1.1 200 OK
         static boost::regex reSize ("\\`.*\\r\\nContent-Length:\\s+([0-9]+).*\\'");
         static boost::regex reBody ("\\`.*\\r\\n\\r\\n(.*)\\'");
@@ -409,12 +463,33 @@ public:
         if (boost::regex_match (strHeader, smMatch, reBody)) // we got some body
             mBody = smMatch[1];
 
+        bool    bSize   = false;
+
         if (boost::regex_match (strHeader, smMatch, reSize))
         {
             int size = beast::lexicalCastThrow <int> (std::string(smMatch[1]));
 
             if (size < mResponseMax)
                 mResponseMax = size;
+
+            bSize   = (size == mResponseMax) && (std::size_t (size) >= mBody.size ());
+        }
+
+        if (mPersistent && bSize)
+        {
+            // HTTP/1.1 keeps the connection unless the server says otherwise
+            static boost::regex reVersion ("\\`HTTP/1\\.1 .*\\'");
+            static boost::regex reClose (
+                "\\`.*\\r\\nConnection:\\s*close\\r\\n.*\\'", boost::regex::icase);
+            static boost::regex reKeepAlive (
+                "\\`.*\\r\\nConnection:\\s*keep-alive\\r\\n.*\\'", boost::regex::icase);
+
+            std::string const strHead (strHeader, 0, strHeader.find ("\r\n\r\n") + 2);
+
+            if (boost::regex_match (strHead, reVersion))
+                mKeepAlive  = !boost::regex_match (strHead, reClose);
+            else
+                mKeepAlive  = boost::regex_match (strHead, reKeepAlive);
         }
 
         if (mResponseMax == 0)
@@ -454,14 +529,14 @@ public:
         {
             if (mShutdown)
             {
+                // The body ends where the server closed the connection
                 JLOG (j_.trace) << "Complete.";
+                mKeepAlive  = false;
             }
-            else
-            {
-                mResponse.commit (bytes_transferred);
-                std::string strBody ((std::istreambuf_iterator<char> (&mResponse)), std::istreambuf_iterator<char> ());
-                invokeComplete (ecResult, mStatus, mBody + strBody);
-            }
+
+            mResponse.commit (bytes_transferred);
+            std::string strBody ((std::istreambuf_iterator<char> (&mResponse)), std::istreambuf_iterator<char> ());
+            invokeComplete (boost::system::error_code (), mStatus, mBody + strBody);
         }
     }
 
@@ -477,6 +552,18 @@ public:
             JLOG (j_.trace) << "invokeComplete: Deadline cancel error: " << ecCancel.message ();
         }
 
+        if (mPersistent)
+        {
+            // There is one site, and the caller decides about trying again.
+            // The handler is released so it does not keep the caller alive.
+            auto complete = std::move (mComplete);
+            mComplete = nullptr;
+
+            if (complete)
+                complete (ecResult ? ecResult : ecCancel, iStatus, strData);
+            return;
+        }
+
         JLOG (j_.debug) << "invokeComplete: Deadline popping: " << mDeqSites.size ();
 
         if (!mDeqSites.empty ())
@@ -512,6 +599,7 @@ private:
     boost::asio::streambuf                                      mResponse;
     std::string                                                 mBody;
     const unsigned short                                        mPort;
+    const int                                                   mResponseLimit;
     int                                                         mResponseMax;
     int                                                         mStatus;
     std::function<void (boost::asio::streambuf& sb, std::string const& strHost)>         mBuild;
@@ -522,6 +610,11 @@ private:
     // If not success, we are shutting down.
     boost::system::error_code                                   mShutdown;
 
+    // Connections of persistent clients are used for more requests
+    bool const                                                  mPersistent;
+    bool                                                        mKeepAlive = false;
+    bool                                                        mResponded = false;
+
     std::deque<std::string>                                     mDeqSites;
     boost::posix_time::time_duration                            mTimeout;
     beast::Journal                                              j_;
@@ -584,4 +677,98 @@ void HTTPClient::request (
     client->request (bSSL, deqSites, setRequest, timeout, complete);
 }
 
+//------------------------------------------------------------------------------
+
+// Keeps the connection of the last request while the server allows it
+class HTTPClientSession
+    : public HTTPClient::Session
+    , public std::enable_shared_from_this <HTTPClientSession>
+{
+public:
+    using Build = std::function <void (boost::asio::streambuf& sb, std::string const& strHost)>;
+    using Complete = std::function <bool (const boost::system::error_code& ecResult, int iStatus, std::string const& strData)>;
+
+    HTTPClientSession (bool bSSL, boost::asio::io_service& io_service,
+            std::string strSite, const unsigned short port,
+            std::size_t responseMax, Logs& l)
+        : mSSL (bSSL)
+        , mIOService (io_service)
+        , mSite (std::move (strSite))
+        , mPort (port)
+        , mResponseMax (responseMax)
+        , mLogs (l)
+    {
+    }
+
+    void request (Build build, boost::posix_time::time_duration timeout,
+        Complete complete) override
+    {
+        auto client = std::move (mClient);
+        mClient = nullptr;
+
+        start (std::move (client), build, timeout, complete);
+    }
+
+private:
+    void start (std::shared_ptr <HTTPClientImp> client, Build build,
+        boost::posix_time::time_duration timeout, Complete complete)
+    {
+        bool const bReused = client != nullptr;
+
+        if (!bReused)
+            client = std::make_shared <HTTPClientImp> (
+                mIOService, mPort, mResponseMax, mLogs, true);
+
+        // The client owns the handler, so this must not own the client
+        HTTPClientImp* const pClient = client.get ();
+        auto self = shared_from_this ();
+
+        auto done = [self, pClient, bReused, build, timeout, complete] (
+            const boost::system::error_code& ecResult, int iStatus,
+                std::string const& strData)
+        {
+            // The server may have closed the connection while it was idle.
+            // The request is sent again once, on a new connection.
+            if (ecResult && bReused && !pClient->responded ())
+            {
+                self->start (nullptr, build, timeout, complete);
+                return false;
+            }
+
+            if (pClient->reusable ())
+                self->mClient = pClient->shared_from_this ();
+
+            return complete && complete (ecResult, iStatus, strData);
+        };
+
+        if (bReused)
+            client->requestAgain (build, timeout, done);
+        else
+            client->request (mSSL, std::deque <std::string> (1, mSite),
+                build, timeout, done);
+    }
+
+    bool const                          mSSL;
+    boost::asio::io_service&            mIOService;
+    std::string const                   mSite;
+    unsigned short const                mPort;
+    std::size_t const                   mResponseMax;
+    Logs&                               mLogs;
+
+    // The idle connection, if the server keeps it open
+    std::shared_ptr <HTTPClientImp>     mClient;
+};
+
+std::shared_ptr <HTTPClient::Session> HTTPClient::makeSession (
+    bool bSSL,
+    boost::asio::io_service& io_service,
+    std::string strSite,
+    const unsigned short port,
+    std::size_t responseMax,
+    Logs& l)
+{
+    return std::make_shared <HTTPClientSession> (
+        bSSL, io_service, std::move (strSite), port, responseMax, l);
+}
+
 } // ripple
@@ -59,6 +59,8 @@ InfoSub::~InfoSub ()
     m_source.unsubServer (mSeq);
     m_source.unsubValidations (mSeq);
     m_source.unsubPeerStatus (mSeq);
+    m_source.unsubDividend (mSeq);
+    m_source.unsubFee (mSeq);
 
     // Use the internal unsubscribe so that it won't call
     // back to us and modify its own parameter
@@ -77,11 +79,35 @@ Resource::Consumer& InfoSub::getConsumer()
 }
 
 void InfoSub::send (
-    Json::Value const& jvObj, std::string const& sObj, bool broadcast)
+    Json::Value const& jvObj, SharedMessage const& message, bool broadcast)
 {
     send (jvObj, broadcast);
 }
 
+void InfoSub::send (SharedMessage const&, bool)
+{
+}
+
+bool InfoSub::getBinary () const
+{
+    return binary_;
+}
+
+void InfoSub::setBinary (bool binary)
+{
+    binary_ = binary;
+}
+
+bool InfoSub::getTrace () const
+{
+    return trace_;
+}
+
+void InfoSub::setTrace (bool trace)
+{
+    trace_ = trace;
+}
+
 std::uint64_t InfoSub::getSeq ()
 {
     return mSeq;
@@ -439,6 +439,17 @@ private:
         return jvRequest;
     }
 
+    // ledger_timings [<limit>]
+    Json::Value parseLedgerTimings (Json::Value const& jvParams)
+    {
+        Json::Value     jvRequest (Json::objectValue);
+
+        if (jvParams.size ())
+            jvRequest[jss::limit]  = jvParams[0u].asUInt ();
+
+        return jvRequest;
+    }
+
     // sign_for <account> <secret> <json> offline
     // sign_for <account> <secret> <json>
     Json::Value parseSignFor (Json::Value const& jvParams)
@@ -661,6 +672,28 @@ private:
         return jvRequest;
     }
 
+    // profile [status]
+    // profile start [<frequency>]
+    // profile stop
+    Json::Value parseProfile (Json::Value const& jvParams)
+    {
+        Json::Value jvRequest (Json::objectValue);
+
+        if (jvParams.size () >= 1)
+            jvRequest[jss::action] = jvParams[0u].asString ();
+
+        if (jvParams.size () == 2)
+        {
+            auto const frequency = beast::lexicalCast <int> (
+                jvParams[1u].asString (), 0);
+            if (frequency <= 0)
+                return rpcError (rpcINVALID_PARAMS);
+            jvRequest[jss::frequency] = frequency;
+        }
+
+        return jvRequest;
+    }
+
     // ripple_path_find <json> [<ledger>]
     Json::Value parseRipplePathFind (Json::Value const& jvParams)
     {
@@ -973,6 +1006,8 @@ public:
     //      {   "ledger_entry",         &RPCParser::parseLedgerEntry,          -1, -1   },
             {   "ledger_header",        &RPCParser::parseLedgerId,              1,  1   },
             {   "ledger_request",       &RPCParser::parseLedgerId,              1,  1   },
+            {   "ledger_snapshot",      &RPCParser::parseLedgerId,              1,  1   },
+            {   "ledger_timings",       &RPCParser::parseLedgerTimings,         0,  1   },
             {   "dividend_object",      &RPCParser::parseDividendTime,          0,  1   },
             {   "account_dividend",     &RPCParser::parseAccountDividend,          0,  1   },
             {   "ancestors",            &RPCParser::parseAncestors,          0,  1   },
@@ -982,9 +1017,10 @@ public:
             {   "peers",                &RPCParser::parseAsIs,                  0,  0   },
             {   "ping",                 &RPCParser::parseAsIs,                  0,  0   },
             {   "print",                &RPCParser::parseAsIs,                  0,  1   },
-    //      {   "profile",              &RPCParser::parseProfile,               1,  9   },
+            {   "profile",              &RPCParser::parseProfile,               0,  2   },
             {   "random",               &RPCParser::parseAsIs,                  0,  0   },
             {   "ripple_path_find",     &RPCParser::parseRipplePathFind,        1,  2   },
+            {   "rpc_stats",            &RPCParser::parseAsIs,                  0,  0   },
             {   "sign",                 &RPCParser::parseSignSubmit,            2,  3   },
             {   "sign_for",             &RPCParser::parseSignFor,               3,  4   },
             {   "submit",               &RPCParser::parseSignSubmit,            1,  3   },
@@ -1272,6 +1308,9 @@ int fromCommandLine (
 
 //------------------------------------------------------------------------------
 
+static const int RPC_REPLY_MAX_BYTES (256*1024*1024);
+static const int RPC_NOTIFY_SECONDS (600);
+
 void fromNetwork (
     boost::asio::io_service& io_service,
     std::string const& strIp, const int iPort,
@@ -1297,9 +1336,6 @@ void fromNetwork (
 
     // Send request
 
-    const int RPC_REPLY_MAX_BYTES (256*1024*1024);
-    const int RPC_NOTIFY_SECONDS (600);
-
     auto j = logs.journal ("HTTPClient");
 
     HTTPClient::request (
@@ -1321,6 +1357,57 @@ void fromNetwork (
         logs);
 }
 
+std::shared_ptr<HTTPClient::Session> makeSession (
+    boost::asio::io_service& io_service,
+    std::string const& strIp, const int iPort, const bool bSSL,
+    Logs& logs)
+{
+    return HTTPClient::makeSession (
+        bSSL, io_service, strIp, iPort, RPC_REPLY_MAX_BYTES, logs);
+}
+
+void fromNetwork (
+    HTTPClient::Session& session,
+    std::string const& strUsername, std::string const& strPassword,
+    std::string const& strPath, std::string const& strMethod,
+    Json::Value const& jvParams,
+    Logs& logs,
+    std::function<void (bool bAccepted)> callbackFuncP)
+{
+    // HTTP basic authentication
+    auto const auth = RPCParser::EncodeBase64 (strUsername + ":" + strPassword);
+
+    std::map<std::string, std::string> mapRequestHeaders;
+
+    mapRequestHeaders["Authorization"] = std::string ("Basic ") + auth;
+
+    // The request is HTTP/1.0, which closes the connection unless asked not to
+    mapRequestHeaders["Connection"] = "keep-alive";
+
+    auto j = logs.journal ("HTTPClient");
+
+    session.request (
+        std::bind (
+            &RPCCallImp::onRequest,
+            strMethod,
+            jvParams,
+            mapRequestHeaders,
+            strPath, std::placeholders::_1, std::placeholders::_2, j),
+        boost::posix_time::seconds (RPC_NOTIFY_SECONDS),
+        [callbackFuncP, j] (const boost::system::error_code& ecResult,
+            int iStatus, std::string const& strData)
+        {
+            if (ecResult)
+            {
+                JLOG (j.debug) << "RPC call failed: " << ecResult.message ();
+            }
+
+            if (callbackFuncP)
+                callbackFuncP (!ecResult && iStatus >= 200 && iStatus < 300);
+            return false;
+        });
+}
+
 }
 
 } // ripple
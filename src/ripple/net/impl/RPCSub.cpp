@@ -24,18 +24,24 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/json/to_string.h>
 #include <ripple/net/RPCCall.h>
-#include <deque>
+#include <ripple/server/SendQueue.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <vector>
 
 namespace ripple {
 
 // Subscription object for JSON-RPC
 class RPCSubImp
     : public RPCSub
+    , public std::enable_shared_from_this <RPCSubImp>
 {
 public:
     RPCSubImp (InfoSub::Source& source, boost::asio::io_service& io_service,
         JobQueue& jobQueue, std::string const& strUrl, std::string const& strUsername,
-             std::string const& strPassword, Logs& logs)
+             std::string const& strPassword, RPCSubOptions const& options,
+                 beast::insight::Collector::ptr const& collector, Logs& logs)
         : RPCSub (source)
         , m_io_service (io_service)
         , m_jobQueue (jobQueue)
@@ -43,7 +49,10 @@ public:
         , mSSL (false)
         , mUsername (strUsername)
         , mPassword (strPassword)
-        , mSending (false)
+        , mBatch (std::max<std::size_t> (options.batch, 1))
+        , mConnections (std::max<std::size_t> (options.connections, 1))
+        , mSending (0)
+        , mDeque (limits (mBatch * mConnections))
         , j_ (logs.journal ("RPCSub"))
         , logs_ (logs)
     {
@@ -65,7 +74,21 @@ public:
             "RPCCall::fromNetwork sub: ip=" << mIp <<
             " port=" << mPort <<
             " ssl= "<< (mSSL ? "yes" : "no") <<
-            " path='" << mPath << "'";
+            " path='" << mPath << "'" <<
+            " batch=" << mBatch <<
+            " connections=" << mConnections;
+
+        // One set of metrics for each server
+        std::string name = mIp + "_" + std::to_string (mPort);
+        std::replace_if (name.begin (), name.end (),
+            [](char c) { return ! std::isalnum (
+                static_cast<unsigned char> (c)); }, '_');
+
+        std::string const prefix = "rpc_sub." + name;
+        mLag        = collector->make_event (prefix, "lag");
+        mQueued     = collector->make_gauge (prefix, "queued");
+        mDelivered  = collector->make_counter (prefix, "delivered");
+        mFailed     = collector->make_counter (prefix, "failed");
     }
 
     ~RPCSubImp ()
@@ -74,33 +97,13 @@ public:
 
     void send (Json::Value const& jvObj, bool broadcast)
     {
-        ScopedLockType sl (mLock);
-
-        if (mDeque.size () >= eventQueueMax)
-        {
-            // Drop the previous event.
-            JLOG (j_.warning) << "RPCCall::fromNetwork drop";
-            mDeque.pop_back ();
-        }
-
-        auto& jm = broadcast ? j_.debug : j_.info;
-        JLOG (jm) <<
-            "RPCCall::fromNetwork push: " << jvObj;
-
-        mDeque.push_back (std::make_pair (mSeq++, jvObj));
-
-        if (!mSending)
-        {
-            // Start a sending thread.
-            mSending    = true;
-
-            JLOG (j_.info) << "RPCCall::fromNetwork start";
+        push (jvObj, to_string (jvObj).size (), {}, broadcast);
+    }
 
-            m_jobQueue.addJob (
-                jtCLIENT, "RPCSub::sendThread", [this] (Job&) {
-                    sendThread();
-                });
-        }
+    void send (Json::Value const& jvObj, SharedMessage const& message,
+        bool broadcast)
+    {
+        push (jvObj, message.payload ().size (), message.key (), broadcast);
     }
 
     void setUsername (std::string const& strUsername)
@@ -118,61 +121,169 @@ public:
     }
 
 private:
-    // XXX Could probably create a bunch of send jobs in a single get of the lock.
+    using clock_type = std::chrono::steady_clock;
+
+    struct Event
+    {
+        int seq;
+        Json::Value jvObj;
+        clock_type::time_point queued;
+    };
+
+    // Only a few events are kept waiting for each request in flight
+    static
+    SendLimits
+    limits (std::size_t inFlight)
+    {
+        SendLimits limits;
+        limits.bytes = inFlight * 1024 * 1024;
+        limits.messages = std::max<std::size_t> (inFlight, eventQueueMax);
+        limits.policy = SendPolicy::dropOldest;
+        return limits;
+    }
+
+    void push (Json::Value const& jvObj, std::size_t bytes,
+        std::string const& key, bool broadcast)
+    {
+        ScopedLockType sl (mLock);
+
+        auto& jm = broadcast ? j_.debug : j_.info;
+        JLOG (jm) <<
+            "RPCCall::fromNetwork push: " << jvObj;
+
+        auto const dropped = mDeque.dropped ();
+        mDeque.push ({mSeq++, jvObj, clock_type::now ()}, bytes, key);
+        if (mDeque.dropped () != dropped)
+        {
+            JLOG (j_.warning) << "RPCCall::fromNetwork drop " <<
+                (mDeque.dropped () - dropped);
+            mFailed.increment (mDeque.dropped () - dropped);
+        }
+        mQueued = mDeque.size ();
+
+        if (mSending < mConnections)
+        {
+            // Start another sender.
+            ++mSending;
+
+            JLOG (j_.info) << "RPCCall::fromNetwork start";
+
+            startSending ();
+        }
+    }
+
+    void startSending ()
+    {
+        auto self = shared_from_this ();
+        m_jobQueue.addJob (
+            jtCLIENT, "RPCSub::sendThread", [self] (Job&) {
+                self->sendThread();
+            });
+    }
+
+    // Sends one batch of events. The sender starts again when the batch is
+    // delivered, until the queue is empty.
     void sendThread ()
     {
-        Json::Value jvEvent;
-        bool bSend;
+        Json::Value jvParams;
+        std::size_t count = 0;
+        clock_type::time_point queued;
+        std::shared_ptr <HTTPClient::Session> session;
+        std::string strUsername;
+        std::string strPassword;
 
-        do
         {
+            // Obtain the lock to manipulate the queue and change sending.
+            ScopedLockType sl (mLock);
+
+            if (mDeque.empty ())
             {
-                // Obtain the lock to manipulate the queue and change sending.
-                ScopedLockType sl (mLock);
-
-                if (mDeque.empty ())
-                {
-                    mSending    = false;
-                    bSend       = false;
-                }
-                else
-                {
-                    std::pair<int, Json::Value> pEvent  = mDeque.front ();
+                --mSending;
+                return;
+            }
 
-                    mDeque.pop_front ();
+            if (mBatch > 1)
+                jvParams = Json::Value (Json::arrayValue);
 
-                    jvEvent     = pEvent.second;
-                    jvEvent["seq"]  = pEvent.first;
+            while (!mDeque.empty () && count < mBatch)
+            {
+                Event event = mDeque.pop ();
+
+                if (count == 0)
+                    queued = event.queued;
+
+                event.jvObj["seq"] = event.seq;
+
+                if (mBatch > 1)
+                    jvParams.append (std::move (event.jvObj));
+                else
+                    jvParams = std::move (event.jvObj);
 
-                    bSend       = true;
-                }
+                ++count;
             }
+            mQueued = mDeque.size ();
 
-            // Send outside of the lock.
-            if (bSend)
+            if (mSessions.empty ())
             {
-                // XXX Might not need this in a try.
-                try
-                {
-                    JLOG (j_.info) << "RPCCall::fromNetwork: " << mIp;
-
-                    RPCCall::fromNetwork (
-                        m_io_service,
-                        mIp, mPort,
-                        mUsername, mPassword,
-                        mPath, "event",
-                        jvEvent,
-                        mSSL,
-                        true,
-                        logs_);
-                }
-                catch (const std::exception& e)
-                {
-                    JLOG (j_.info) << "RPCCall::fromNetwork exception: " << e.what ();
-                }
+                session = RPCCall::makeSession (
+                    m_io_service, mIp, mPort, mSSL, logs_);
             }
+            else
+            {
+                session = std::move (mSessions.back ());
+                mSessions.pop_back ();
+            }
+
+            strUsername = mUsername;
+            strPassword = mPassword;
+        }
+
+        // Send outside of the lock.
+        auto self = shared_from_this ();
+        auto sent = [self, session, count, queued] (bool bDelivered)
+        {
+            self->onSent (session, count, queued, bDelivered);
+        };
+
+        try
+        {
+            JLOG (j_.info) << "RPCCall::fromNetwork: " << mIp;
+
+            RPCCall::fromNetwork (
+                *session,
+                strUsername, strPassword,
+                mPath, mBatch > 1 ? "events" : "event",
+                jvParams,
+                logs_,
+                sent);
+        }
+        catch (const std::exception& e)
+        {
+            JLOG (j_.info) << "RPCCall::fromNetwork exception: " << e.what ();
+
+            sent (false);
+        }
+    }
+
+    void onSent (std::shared_ptr <HTTPClient::Session> const& session,
+        std::size_t count, clock_type::time_point queued, bool bDelivered)
+    {
+        mLag.notify (std::chrono::duration_cast<std::chrono::milliseconds> (
+            clock_type::now () - queued));
+
+        if (bDelivered)
+            mDelivered.increment (count);
+        else
+            mFailed.increment (count);
+
+        {
+            ScopedLockType sl (mLock);
+
+            mSessions.push_back (session);
         }
-        while (bSend);
+
+        // The sender goes on with the next batch, if any.
+        startSending ();
     }
 
 private:
@@ -194,9 +305,19 @@ private:
 
     int                     mSeq;                       // Next id to allocate.
 
-    bool                    mSending;                   // Sending threead is active.
+    std::size_t const       mBatch;                     // Most events in a request.
+    std::size_t const       mConnections;               // Most requests in flight.
+    std::size_t             mSending;                   // Senders which are active.
+
+    SendQueue<Event>        mDeque;
+
+    // Sessions of the senders which are not sending
+    std::vector <std::shared_ptr <HTTPClient::Session>> mSessions;
 
-    std::deque<std::pair<int, Json::Value> >    mDeque;
+    beast::insight::Event   mLag;
+    beast::insight::Gauge   mQueued;
+    beast::insight::Counter mDelivered;
+    beast::insight::Counter mFailed;
 
     beast::Journal j_;
     Logs& logs_;
@@ -213,11 +334,13 @@ std::shared_ptr<RPCSub> make_RPCSub (
     InfoSub::Source& source, boost::asio::io_service& io_service,
     JobQueue& jobQueue, std::string const& strUrl,
     std::string const& strUsername, std::string const& strPassword,
+    RPCSubOptions const& options,
+    beast::insight::Collector::ptr const& collector,
     Logs& logs)
 {
     return std::make_shared<RPCSubImp> (std::ref (source),
         std::ref (io_service), std::ref (jobQueue),
-            strUrl, strUsername, strPassword, logs);
+            strUrl, strUsername, strPassword, options, collector, logs);
 }
 
 } // ripple
@@ -21,6 +21,8 @@
 #define RIPPLE_NODESTORE_BACKEND_H_INCLUDED
 
 #include <ripple/nodestore/Types.h>
+#include <functional>
+#include <set>
 
 namespace ripple {
 namespace NodeStore {
@@ -61,7 +63,8 @@ public:
         @note This will be called concurrently.
         @param key A pointer to the key data.
         @param pObject [out] The created object if successful.
-        @return The result of the operation.
+        @return The result of the operation, `retryLater` if the read
+                was abandoned at its deadline.
     */
     virtual Status fetch (void const* key, std::shared_ptr<NodeObject>* pObject) = 0;
 
@@ -90,6 +93,34 @@ public:
         return 4096;
     }
 
+    /** Called with the objects found and the hashes not found.
+        Hashes whose read failed or was abandoned at its deadline are in
+        neither, they should be read again later.
+    */
+    using FetchCallback = std::function <void (
+        std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>)>;
+
+    /** Return `true` if fetchBatchAsync does not block the caller. */
+    virtual
+    bool
+    canFetchAsync ()
+    {
+        return false;
+    }
+
+    /** Fetch a batch asynchronously.
+        The callback is called exactly once, possibly from another thread
+        and before this function returns. Every pending callback is
+        called before the backend is destroyed.
+    */
+    virtual
+    void
+    fetchBatchAsync (std::set<uint256> const& hashes, FetchCallback callback)
+    {
+        auto result = fetchBatch (hashes);
+        callback (std::move (result.first), std::move (result.second));
+    }
+
     /** Store a single object.
         Depending on the implementation this may happen immediately
         or deferred using a scheduled task.
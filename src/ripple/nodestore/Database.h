@@ -22,7 +22,8 @@
 
 #include <ripple/nodestore/NodeObject.h>
 #include <ripple/nodestore/Backend.h>
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/ThreadAffinity.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -88,6 +89,14 @@ public:
     */
     virtual void waitReads () = 0;
 
+    /** Wait for some of the pending async reads to complete.
+
+        Returns once a batch of reads completes, or at once when the
+        calling thread has none pending. Backends that read one object at
+        a time wait as waitReads does.
+    */
+    virtual void waitSomeReads () = 0;
+
     /** Get the maximum number of async reads the node store prefers.
         @return The number of async reads preferred.
     */
@@ -129,6 +138,18 @@ public:
     /** Get the positive cache hits to total attempts ratio. */
     virtual float getCacheHitRate () = 0;
 
+    /** Return the positive cache hits, then its misses. */
+    virtual std::pair <std::uint64_t, std::uint64_t> getCacheHitsAndMisses () = 0;
+
+    /** Return the number of entries in the positive cache. */
+    virtual int getCacheSize () = 0;
+
+    /** Return the keys of the entries in the positive cache. */
+    virtual std::vector<uint256> getCacheKeys () = 0;
+
+    /** Set the maximum number of entries in both caches, keeping their age. */
+    virtual void setCacheSize (int size) = 0;
+
     /** Set the maximum number of entries and maximum cache age for both caches.
 
         @param size Number of cache entries (0 = ignore)
@@ -139,10 +160,15 @@ public:
     /** Remove expired entries from the positive and negative caches. */
     virtual void sweep () = 0;
 
+    /** Keep the prefetch threads on a set of processors. */
+    virtual void setThreadAffinity (CpuSet const& cpus) = 0;
+
     /** Gather statistics pertaining to read and write activities.
         Return the reads and writes, and total read and written bytes.
      */
     virtual std::uint32_t getStoreCount () const = 0;
+    /** Return the stores not written, as the backend held the object. */
+    virtual std::uint32_t getStoreSkipCount () const = 0;
     virtual std::uint32_t getFetchTotalCount () const = 0;
     virtual std::uint32_t getFetchHitCount () const = 0;
     virtual std::uint32_t getStoreSize () const = 0;
@@ -35,7 +35,7 @@ class DatabaseRotating
 public:
     virtual ~DatabaseRotating() = default;
 
-    virtual TaggedCache <uint256, NodeObject>& getPositiveCache() = 0;
+    virtual ShardedTaggedCache <uint256, NodeObject>& getPositiveCache() = 0;
 
     virtual std::mutex& peekMutex() const = 0;
 
@@ -35,6 +35,7 @@ public:
     void scheduledTasksStopped ();
     void onFetch (FetchReport const& report) override;
     void onBatchWrite (BatchWriteReport const& report) override;
+    void onBatchFetch (BatchFetchReport const& report) override;
 };
 
 }
@@ -21,6 +21,7 @@
 #define RIPPLE_NODESTORE_NODEOBJECT_H_INCLUDED
 
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/Slice.h>
 #include <ripple/protocol/Protocol.h>
 
 // VFALCO NOTE Intentionally not in the NodeStore namespace
@@ -43,6 +44,8 @@ enum NodeObjectType
     the blob. The blob is a variable length block of serialized data. The
     type identifies what the blob contains.
 
+    The object, its shared count and its blob are in a single heap block.
+
     @note No checking is performed to make sure the hash matches the data.
     @see SHAMap
 */
@@ -64,29 +67,37 @@ public:
 
 private:
     // This hack is used to make the constructor effectively private
-    // except for when we use it in the call to make_shared.
+    // except for when we use it in the call to make_shared_inline.
     // There's no portable way to make make_shared<> a friend work.
     struct PrivateAccess { };
 public:
     // This constructor is private, use createObject instead.
-    NodeObject (NodeObjectType type,
-                Blob&& data,
+    NodeObject (std::uint8_t* const& payload,
+                NodeObjectType type,
+                Slice data,
                 uint256 const& hash,
                 PrivateAccess);
 
-    /** Create an object from fields.
+    NodeObject (NodeObject const&) = delete;
+    NodeObject& operator= (NodeObject const&) = delete;
 
-        The caller's variable is modified during this call. The
-        underlying storage for the Blob is taken over by the NodeObject.
+    /** Create an object from fields.
 
         @param type The type of object.
-        @param ledgerIndex The ledger in which this object appears.
-        @param data A buffer containing the payload. The caller's variable
-                    is overwritten.
+        @param data The payload, which is copied into the object.
         @param hash The 256-bit hash of the payload data.
     */
     static
     std::shared_ptr<NodeObject>
+    createObject (NodeObjectType type,
+        Slice data, uint256 const& hash);
+
+    /** Create an object from fields.
+
+        The caller's variable is released during this call.
+    */
+    static
+    std::shared_ptr<NodeObject>
     createObject (NodeObjectType type,
         Blob&& data, uint256 const& hash);
 
@@ -97,12 +108,13 @@ public:
     uint256 const& getHash () const;
 
     /** Returns the underlying data. */
-    Blob const& getData () const;
+    Slice getData () const;
 
 private:
     NodeObjectType mType;
+    std::uint32_t mSize;
     uint256 mHash;
-    Blob mData;
+    std::uint8_t const* mData;
 };
 
 }
@@ -22,6 +22,7 @@
 
 #include <ripple/nodestore/Task.h>
 #include <chrono>
+#include <string>
 
 namespace ripple {
 namespace NodeStore {
@@ -42,6 +43,24 @@ struct BatchWriteReport
     int writeCount;
 };
 
+/** Contains information about a batch fetch operation. */
+struct BatchFetchReport
+{
+    std::chrono::milliseconds elapsed;
+    int fetchCount;
+    int foundCount;
+    int batchLimit;
+};
+
+/** Contains the recent read latency of a backend. */
+struct BackendLatencyReport
+{
+    std::string name;
+    std::chrono::microseconds p99;
+    int hedgedCount;    // duplicate reads sent since the last report
+    int lateCount;      // reads abandoned at their deadline
+};
+
 /** Scheduling for asynchronous backend activity
 
     For improved performance, a backend has the option of performing writes
@@ -71,6 +90,18 @@ public:
         Allows the scheduler to monitor the node store's performance
     */
     virtual void onBatchWrite (BatchWriteReport const& report) = 0;
+
+    /** Reports the completion of a batch fetch
+        Allows the scheduler to monitor the node store's performance
+    */
+    virtual void onBatchFetch (BatchFetchReport const& report) = 0;
+
+    /** Reports the read latency of a backend
+        Allows the scheduler to monitor the node store's performance
+    */
+    virtual void onBackendLatency (BackendLatencyReport const& report)
+    {
+    }
 };
 
 }
@@ -43,6 +43,9 @@ enum Status
     dataCorrupt,
     unknown,
 
+    // The read did not complete in time, the object may exist
+    retryLater,
+
     customCode = 100
 };
 
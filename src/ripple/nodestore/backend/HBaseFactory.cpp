@@ -24,15 +24,29 @@
 #if RIPPLE_THRIFT_AVAILABLE
 
 #include <ripple/app/main/Application.h>
+#include <ripple/basics/StringUtilities.h>
 #include <ripple/core/Config.h> // VFALCO Bad dependency
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
-#include <ripple/nodestore/impl/BatchWriter.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/FetchLatency.h>
+#include <ripple/nodestore/impl/ScanRange.h>
 #include <beast/threads/Thread.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/thread/tss.hpp>
 
 #include <thrift/protocol/TBinaryProtocol.h>
@@ -48,22 +62,39 @@
 namespace ripple {
 namespace NodeStore {
 
-class HbaseBackend
-    : public Backend
-    , public BatchWriter::Callback
+class HbaseBackend : public Backend
 {
 private:
     std::atomic <bool> m_deletePath;
     beast::Journal m_journal;
     size_t const m_keyBytes;
     Scheduler& m_scheduler;
-    BatchWriter m_batch;
 
     std::string m_host;
+    std::vector<std::string> m_hosts;
+    std::atomic<std::size_t> m_nextHost;
     std::string m_port;
     bool m_isCompactProtocol;
+    BlobCodecs const m_codecs;
     uint32_t m_fetchBatchLimit = 4096;
 
+    // Row keys are the hex text of the key in format 1 and the raw key
+    // bytes in format 2.
+    int m_keyFormat = 1;
+
+    // Also look up rows written in format 1 when using format 2.
+    bool m_legacyKeys = false;
+
+    // Parallel scans of for_each.
+    std::size_t m_scanThreads = 1;
+    bool m_scanRegions = true;
+    std::int32_t m_scanCaching = 1000;
+    std::int32_t m_scanBatch = 100;
+    std::string m_scanCheckpoint;
+
+    // With online deletion, the marker directory of this generation.
+    std::string m_path;
+
     std::string s_tableName = "radard";
     std::string s_columnFamily = "data:";
     std::string s_columnName = "data:data";
@@ -77,7 +108,7 @@ private:
         std::unique_ptr<apache::hadoop::hbase::thrift::HbaseClient> m_client;
         beast::Journal m_journal;
 
-        HbaseConnection (std::string host, std::string port, beast::Journal journal, bool isCompactProtocol) : m_journal (journal)
+        HbaseConnection (std::string host, std::string port, beast::Journal journal, bool isCompactProtocol, int recvTimeout = 5000) : m_journal (journal)
         {
             using namespace apache::thrift;
             using namespace apache::hadoop::hbase::thrift;
@@ -87,7 +118,7 @@ private:
             {
                 socket->setConnTimeout (5000);
                 socket->setSendTimeout (5000);
-                socket->setRecvTimeout (5000);
+                socket->setRecvTimeout (recvTimeout);
             }
             m_socket.reset (socket);
             m_transport.reset (new transport::TBufferedTransport (m_socket));
@@ -125,6 +156,83 @@ private:
 
     boost::thread_specific_ptr<HbaseConnection> m_connection;
 
+    using clock_type = std::chrono::steady_clock;
+
+    /** A batch read by the connection pool, shared by its copies. */
+    struct ReadState
+    {
+        std::set<uint256> hashes;
+        FetchCallback callback;
+        clock_type::time_point start;
+        std::atomic<bool> done {false};     // the callback was called
+        std::atomic<int> pending {1};       // copies still being read
+    };
+
+    /** One copy of a batch read by the connection pool. */
+    struct ReadRequest
+    {
+        std::shared_ptr<ReadState> state;
+        std::set<uint256> hashes;
+        int format;
+        int attempts = 0;
+        std::vector<std::shared_ptr<NodeObject>> objects;
+    };
+
+    // Requests sent together on one connection before reading the replies.
+    std::size_t m_pipeline = 4;
+
+    // Milliseconds a connection waits for a reply to a read.
+    int m_recvTimeout = 5000;
+
+    // A batch still unanswered at this percentile of the recent read
+    // latency is sent again on another connection, 0 for never. The
+    // first reply is used.
+    int m_hedgePercentile = 0;
+    std::chrono::milliseconds m_hedgeMin {5};
+
+    // A batch unanswered after this long is given up, without waiting
+    // for the receive timeout and the retries. 0 for never.
+    std::chrono::milliseconds m_readDeadline {0};
+
+    FetchLatency m_latency;
+    std::atomic<int> m_hedged;
+    std::atomic<int> m_late;
+
+    // The hedges and deadlines of the batches being read.
+    struct ReadTimer
+    {
+        std::shared_ptr<ReadState> state;
+        bool hedge;
+    };
+
+    std::mutex m_timerMutex;
+    std::condition_variable m_timerCond;
+    std::multimap<clock_type::time_point, ReadTimer> m_timers;
+    bool m_timerStop = false;
+    std::thread m_timer;
+
+    std::mutex m_readMutex;
+    std::condition_variable m_readCond;
+    std::deque<std::unique_ptr<ReadRequest>> m_readQueue;
+    std::vector<std::thread> m_readers;
+    bool m_readStop = false;
+
+    // Objects sent by one mutateRows, and their total size.
+    std::size_t m_writeBatchMax = 4096;
+    std::size_t m_writeBatchBytes = 16 * 1024 * 1024;
+
+    // Callers of store wait while this many bytes are not yet written.
+    std::size_t m_writeQueueBytes = 256 * 1024 * 1024;
+
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCond;
+    std::condition_variable m_writeSpace;
+    std::deque<std::shared_ptr<NodeObject>> m_writeQueue;
+    std::size_t m_writeBytes = 0;   // queued or being written
+    std::size_t m_writing = 0;      // objects being written
+    std::vector<std::thread> m_writers;
+    std::atomic<bool> m_writeStop;
+
 public:
     HbaseBackend (int keyBytes, Section const& keyValues,
         Scheduler& scheduler, beast::Journal journal)
@@ -132,10 +240,14 @@ public:
         , m_journal (journal)
         , m_keyBytes (keyBytes)
         , m_scheduler (scheduler)
-        , m_batch (*this, scheduler)
         , m_host (get<std::string>(keyValues, "host"))
+        , m_nextHost (0)
         , m_port (get<std::string>(keyValues, "port"))
         , m_isCompactProtocol (get<std::string>(keyValues, "protocol").compare ("compact") == 0)
+        , m_codecs (keyValues)
+        , m_hedged (0)
+        , m_late (0)
+        , m_writeStop (false)
     {
         if (m_host.empty())
             throw std::runtime_error ("Missing host in HbaseFactory backend");
@@ -143,10 +255,53 @@ public:
         if (m_port.empty())
             throw std::runtime_error ("Missing port in HbaseFactory backend");
 
+        // Several Thrift servers may be given, connections are spread
+        // over them.
+        boost::split (m_hosts, m_host, boost::algorithm::is_any_of (","));
+        for (auto& host : m_hosts)
+            boost::trim (host);
+        m_hosts.erase (std::remove (m_hosts.begin (), m_hosts.end (),
+            std::string ()), m_hosts.end ());
+        if (m_hosts.empty())
+            throw std::runtime_error ("Missing host in HbaseFactory backend");
+
+        // Online deletion rotates generations of the node store. Each
+        // one is a table of its own, so dropping the oldest is cheap.
+        auto const generation = get<std::string> (keyValues, "generation");
+        if (!generation.empty ())
+        {
+            s_tableName += "." + generation;
+            m_path = get<std::string> (keyValues, "path");
+            if (!m_path.empty ())
+                boost::filesystem::create_directories (m_path);
+        }
+
         auto fetchBatchLimit = boost::lexical_cast<int> (get<std::string> (keyValues, "fetch_batch_max", "0"));
         if (fetchBatchLimit > 0)
             m_fetchBatchLimit = fetchBatchLimit;
 
+        auto const keyFormat = get<std::string> (keyValues, "key_format", "hex");
+        if (keyFormat == "binary")
+            m_keyFormat = 2;
+        else if (keyFormat != "hex")
+            throw std::runtime_error ("Invalid key_format in HbaseFactory backend");
+        m_legacyKeys = m_keyFormat == 2 &&
+            get<bool> (keyValues, "legacy_keys", true);
+
+        m_recvTimeout = get<int> (keyValues, "recv_timeout_ms", m_recvTimeout);
+        if (m_recvTimeout <= 0)
+            throw std::runtime_error ("Invalid recv_timeout_ms in HbaseFactory backend");
+        m_hedgePercentile = get<int> (keyValues, "hedge_percentile", 0);
+        if (m_hedgePercentile < 0 || m_hedgePercentile > 100)
+            throw std::runtime_error ("Invalid hedge_percentile in HbaseFactory backend");
+        auto const hedgeMin = get<int> (keyValues, "hedge_min_ms",
+            static_cast<int> (m_hedgeMin.count ()));
+        auto const readDeadline = get<int> (keyValues, "read_deadline_ms", 0);
+        if (hedgeMin < 0 || readDeadline < 0)
+            throw std::runtime_error ("Invalid read deadline in HbaseFactory backend");
+        m_hedgeMin = std::chrono::milliseconds (hedgeMin);
+        m_readDeadline = std::chrono::milliseconds (readDeadline);
+
         using namespace apache::thrift;
         using namespace apache::hadoop::hbase::thrift;
 
@@ -158,7 +313,8 @@ public:
             columns.push_back (ColumnDescriptor ());
             columns.back ().name = s_columnFamily;
             columns.back ().maxVersions = 1;
-            columns.back ().compression = "SNAPPY";
+            // The blobs are compressed already, unless the codec is none.
+            columns.back ().compression = m_codecs.compresses () ? "NONE" : "SNAPPY";
 //            columns.back ().inMemory = true;
             columns.back ().blockCacheEnabled = true;
 //            columns.back ().bloomFilterType = "ROW";
@@ -175,6 +331,42 @@ public:
 //                return;
             throw std::runtime_error (std::string ("Unable to open/create Hbase: ") + te.what ());
         }
+
+        auto const pipeline = get<std::size_t> (keyValues, "pipeline", m_pipeline);
+        if (pipeline > 0)
+            m_pipeline = pipeline;
+
+        m_scanThreads = std::max<std::size_t> (
+            get<std::size_t> (keyValues, "scan_threads", m_scanThreads), 1);
+        auto const scanSplit = get<std::string> (keyValues, "scan_split", "regions");
+        if (scanSplit == "prefix")
+            m_scanRegions = false;
+        else if (scanSplit != "regions")
+            throw std::runtime_error ("Invalid scan_split in HbaseFactory backend");
+        m_scanCaching = std::max<std::int32_t> (
+            get<std::int32_t> (keyValues, "scan_caching", m_scanCaching), 1);
+        m_scanBatch = std::max<std::int32_t> (
+            get<std::int32_t> (keyValues, "scan_batch", m_scanBatch), 1);
+        m_scanCheckpoint = get<std::string> (keyValues, "scan_checkpoint");
+
+        m_writeBatchMax = std::max<std::size_t> (
+            get<std::size_t> (keyValues, "write_batch_max", m_writeBatchMax), 1);
+        m_writeBatchBytes = std::max<std::size_t> (get<std::size_t> (
+            keyValues, "write_batch_mb", m_writeBatchBytes >> 20), 1) << 20;
+        m_writeQueueBytes = std::max<std::size_t> (get<std::size_t> (
+            keyValues, "write_queue_mb", m_writeQueueBytes >> 20), 1) << 20;
+
+        auto const connections = get<std::size_t> (keyValues, "async_connections", 8);
+        for (std::size_t i = 0; i < connections; ++i)
+            m_readers.emplace_back (&HbaseBackend::readerEntry, this, i);
+        if (!m_readers.empty () &&
+                (m_hedgePercentile > 0 || m_readDeadline.count () > 0))
+            m_timer = std::thread (&HbaseBackend::timerEntry, this);
+
+        auto const writers = std::max<std::size_t> (
+            get<std::size_t> (keyValues, "write_threads", 2), 1);
+        for (std::size_t i = 0; i < writers; ++i)
+            m_writers.emplace_back (&HbaseBackend::writerEntry, this, i);
     }
 
     ~HbaseBackend ()
@@ -185,20 +377,87 @@ public:
     void
     close() override
     {
+        // Before the readers, the timer sends hedges to them.
+        if (m_timer.joinable ())
+        {
+            {
+                std::lock_guard<std::mutex> lock (m_timerMutex);
+                m_timerStop = true;
+                m_timerCond.notify_all ();
+            }
+            m_timer.join ();
+            m_timers.clear ();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock (m_readMutex);
+            m_readStop = true;
+            m_readCond.notify_all ();
+        }
+        for (auto& reader : m_readers)
+            reader.join ();
+        m_readers.clear ();
+
+        // After the readers, which store the objects they migrate. The
+        // writers empty the queue before they exit.
+        {
+            std::lock_guard<std::mutex> lock (m_writeMutex);
+            m_writeStop = true;
+            m_writeCond.notify_all ();
+            m_writeSpace.notify_all ();
+        }
+        for (auto& writer : m_writers)
+            writer.join ();
+        m_writers.clear ();
+
+        if (!m_path.empty () && m_deletePath.exchange (false))
+            dropTable ();
     }
 
     std::string
     getName()
     {
+        // Online deletion keeps track of the rotating backends by path.
+        if (!m_path.empty ())
+            return m_path;
         return m_host + ':' + m_port;
     }
 
+    /** Delete the table of a rotated out generation and its directory. */
+    void
+    dropTable ()
+    {
+        using namespace apache::thrift;
+
+        try
+        {
+            auto& client = *getConnection ()->m_client;
+            client.disableTable (s_tableName);
+            client.deleteTable (s_tableName);
+            m_journal.info << "Deleted table " << s_tableName;
+        }
+        catch (const TException& te)
+        {
+            m_journal.error << "Unable to delete table " << s_tableName <<
+                ", remove it by hand: " << te.what ();
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all (m_path, ec);
+    }
+
+    std::string const&
+    nextHost ()
+    {
+        return m_hosts[m_nextHost++ % m_hosts.size ()];
+    }
+
     HbaseConnection* getConnection ()
     {
         auto conn = m_connection.get ();
         if (!conn)
         {
-            conn = new HbaseConnection (m_host, m_port, m_journal, m_isCompactProtocol);
+            conn = new HbaseConnection (nextHost (), m_port, m_journal, m_isCompactProtocol, m_recvTimeout);
             m_connection.reset (conn);
         }
         return conn;
@@ -209,23 +468,79 @@ public:
         m_connection.reset ();
     }
 
+    /** Row key of a NodeObject in the given format. */
+    std::string
+    makeRow (void const* key, int format) const
+    {
+        if (format == 1)
+            return to_string (uint256::fromVoid (key));
+        return std::string (static_cast<char const*> (key), m_keyBytes);
+    }
+
+    std::string
+    makeRow (void const* key) const
+    {
+        return makeRow (key, m_keyFormat);
+    }
+
+    /** Key of a row in either format.
+        @return false if the row is not a NodeObject key.
+    */
+    bool
+    parseRow (std::string const& row, uint256& key) const
+    {
+        if (row.size () == m_keyBytes)
+        {
+            key = uint256::fromVoid (row.data ());
+            return true;
+        }
+        return row.size () == m_keyBytes * 2 && key.SetHexExact (row);
+    }
+
     //--------------------------------------------------------------------------
 
     Status
     fetch (void const* key, std::shared_ptr<NodeObject>* pObject)
+    {
+        pObject->reset ();
+
+        if (fetchesPooled ())
+        {
+            auto const result = fetchPooled ({uint256::fromVoid (key)});
+            if (!result.first.empty ())
+            {
+                *pObject = result.first.front ();
+                return ok;
+            }
+            return result.second.empty () ? retryLater : notFound;
+        }
+
+        auto status = fetchRow (makeRow (key), key, pObject);
+        if (status == notFound && m_legacyKeys)
+        {
+            status = fetchRow (makeRow (key, 1), key, pObject);
+            // Write the object again under its new key.
+            if (status == ok)
+                store (*pObject);
+        }
+        return status;
+    }
+
+    Status
+    fetchRow (std::string const& row, void const* key,
+        std::shared_ptr<NodeObject>* pObject)
     {
         using namespace apache::thrift;
         using namespace apache::hadoop::hbase::thrift;
-        
-        pObject->reset ();
 
         Status status (ok);
         try
         {
             std::vector<TRowResult> rowResult;
             std::map<Text, Text> attributes;
-            std::string row = to_string (uint256::fromVoid (key));
+            auto const start = clock_type::now ();
             getConnection ()->m_client->getRow (rowResult, s_tableName, row, attributes);
+            recordLatency (clock_type::now () - start);
             if (rowResult.empty ())
             {
                 status = notFound;
@@ -234,20 +549,22 @@ public:
             {
                 status = dataCorrupt;
                 if (m_journal.error)
-                    m_journal.error << rowResult.size () << " objects found for NodeObject #" << row;
+                    m_journal.error << rowResult.size () << " objects found for NodeObject #" << uint256::fromVoid (key);
             }
             else
             {
-                auto& columns = rowResult.front ().columns;
-                if (columns.find (s_columnName) == columns.end ())
+                auto const& columns = rowResult.front ().columns;
+                auto const column = columns.find (s_columnName);
+                if (column == columns.end ())
                 {
                     status = notFound;
                     if (m_journal.error)
-                        m_journal.error << "row found but column not found for NodeObject #" << row;
+                        m_journal.error << "row found but column not found for NodeObject #" << uint256::fromVoid (key);
                 }
                 else
                 {
-                    auto& data = columns[s_columnName].value;
+                    // Decode in place from the Thrift result.
+                    auto const& data = column->second.value;
                     DecodedBlob decoded (key, data.data (), data.size ());
 
                     if (decoded.wasOk ())
@@ -306,51 +623,48 @@ public:
     std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
     fetchBatch (const std::set<uint256>& hashes)
     {
-        using namespace apache::thrift;
-        using namespace apache::hadoop::hbase::thrift;
-        
+        if (fetchesPooled ())
+            return fetchPooled (hashes);
+
         std::vector<std::shared_ptr<NodeObject>> objects;
         std::set<uint256> hashesNotFound (hashes);
 
+        fetchRows (hashes, m_keyFormat, objects, hashesNotFound);
+        if (m_legacyKeys && !hashesNotFound.empty ())
+        {
+            auto const missing = hashesNotFound;
+            auto const found = objects.size ();
+            fetchRows (missing, 1, objects, hashesNotFound);
+            // Write the objects again under their new key.
+            for (auto i = found; i < objects.size (); ++i)
+                store (objects[i]);
+        }
+        return std::make_pair (objects, hashesNotFound);
+    }
+
+    void
+    fetchRows (std::set<uint256> const& hashes, int format,
+        std::vector<std::shared_ptr<NodeObject>>& objects,
+            std::set<uint256>& hashesNotFound)
+    {
+        using namespace apache::thrift;
+        using namespace apache::hadoop::hbase::thrift;
+
         std::vector<TRowResult> rowResults;
         std::map<Text, Text> attributes;
         std::vector<std::string> rows;
+        rows.reserve (hashes.size ());
         for (auto& hash : hashes)
-            rows.emplace_back (to_string (hash));
+            rows.emplace_back (makeRow (hash.data (), format));
 
         for (int i = 0; i < 3; ++i)
         {
             try
             {
+                auto const start = clock_type::now ();
                 getConnection ()->m_client->getRows (rowResults, s_tableName, rows, attributes);
-                for (auto& row : rowResults)
-                {
-                    auto& columns = row.columns;
-                    if (columns.find (s_columnName) == columns.end ())
-                    {
-                        if (m_journal.error)
-                            m_journal.error << "row found but column not found for NodeObject #" << row.row;
-                    }
-                    else
-                    {
-                        auto& data = columns[s_columnName].value;
-                        uint256 key = from_hex_text<uint256> (row.row);
-                        DecodedBlob decoded (key.data (), data.data (), data.size ());
-
-                        if (decoded.wasOk ())
-                        {
-                            objects.emplace_back (decoded.createObject ());
-                            hashesNotFound.erase (objects.back ()->getHash ());
-                        }
-                        else
-                        {
-                            // Decoding failed, probably corrupted!
-                            //
-                            if (m_journal.fatal)
-                                m_journal.fatal << "Corrupt NodeObject #" << row.row;
-                        }
-                    }
-                }
+                recordLatency (clock_type::now () - start);
+                decodeRows (rowResults, objects, hashesNotFound);
                 break;
             }
             catch (TApplicationException& tae)
@@ -368,123 +682,747 @@ public:
                 releaseConnection ();
             }
         }
-        return std::make_pair (objects, hashesNotFound);
+    }
+
+    void
+    decodeRows (std::vector<apache::hadoop::hbase::thrift::TRowResult> const& rowResults,
+        std::vector<std::shared_ptr<NodeObject>>& objects,
+            std::set<uint256>& hashesNotFound)
+    {
+        for (auto const& row : rowResults)
+        {
+            uint256 key;
+            auto const& columns = row.columns;
+            auto const column = columns.find (s_columnName);
+            if (!parseRow (row.row, key))
+            {
+                if (m_journal.error)
+                    m_journal.error << "Bad key size = " << row.row.size ();
+            }
+            else if (column == columns.end ())
+            {
+                if (m_journal.error)
+                    m_journal.error << "row found but column not found for NodeObject #" << key;
+            }
+            else
+            {
+                // Decode in place from the Thrift result.
+                auto const& data = column->second.value;
+                DecodedBlob decoded (key.data (), data.data (), data.size ());
+
+                if (decoded.wasOk ())
+                {
+                    objects.emplace_back (decoded.createObject ());
+                    hashesNotFound.erase (objects.back ()->getHash ());
+                }
+                else
+                {
+                    // Decoding failed, probably corrupted!
+                    //
+                    if (m_journal.fatal)
+                        m_journal.fatal << "Corrupt NodeObject #" << key;
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    bool
+    canFetchAsync () override
+    {
+        return !m_readers.empty ();
+    }
+
+    void
+    fetchBatchAsync (std::set<uint256> const& hashes, FetchCallback callback) override
+    {
+        auto state = std::make_shared<ReadState> ();
+        state->hashes = hashes;
+        state->callback = std::move (callback);
+        state->start = clock_type::now ();
+
+        auto request = std::make_unique<ReadRequest> ();
+        request->state = state;
+        request->hashes = hashes;
+        request->format = m_keyFormat;
+        schedule (state);
+        enqueue (std::move (request), false);
+    }
+
+    /** Return `true` if the reads wait on the pool, for their hedges and
+        deadline.
+    */
+    bool
+    fetchesPooled () const
+    {
+        return m_timer.joinable ();
+    }
+
+    /** Read a batch on the connection pool and wait for the result.
+        Hashes neither found nor not found were given up at the deadline.
+    */
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
+    fetchPooled (std::set<uint256> const& hashes)
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool called = false;
+        std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>> result;
+
+        fetchBatchAsync (hashes,
+            [&] (std::vector<std::shared_ptr<NodeObject>> objects,
+                std::set<uint256> hashesNotFound)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                result.first = std::move (objects);
+                result.second = std::move (hashesNotFound);
+                called = true;
+                cond.notify_all ();
+            });
+
+        std::unique_lock<std::mutex> lock (mutex);
+        while (!called)
+            cond.wait (lock);
+        return result;
+    }
+
+    /** Set the hedge and the deadline of a batch. */
+    void
+    schedule (std::shared_ptr<ReadState> const& state)
+    {
+        if (!m_timer.joinable ())
+            return;
+
+        // Until enough reads were timed, batches are not hedged.
+        auto hedge = m_latency.percentile (m_hedgePercentile);
+        bool const hedged = m_hedgePercentile > 0 && hedge.count () > 0;
+        if (hedge < m_hedgeMin)
+            hedge = m_hedgeMin;
+
+        std::lock_guard<std::mutex> lock (m_timerMutex);
+        auto const first = m_timers.empty () ? clock_type::time_point::max () :
+            m_timers.begin ()->first;
+        if (hedged)
+            m_timers.emplace (state->start + hedge, ReadTimer {state, true});
+        if (m_readDeadline.count () > 0)
+        {
+            m_timers.emplace (state->start + m_readDeadline,
+                ReadTimer {state, false});
+        }
+        if (!m_timers.empty () && m_timers.begin ()->first < first)
+            m_timerCond.notify_one ();
+    }
+
+    /** Send the hedges and give up the batches at their deadline. */
+    void
+    timerEntry ()
+    {
+        beast::Thread::setCurrentThreadName ("hbase timer");
+
+        std::unique_lock<std::mutex> lock (m_timerMutex);
+        while (!m_timerStop)
+        {
+            if (m_timers.empty ())
+            {
+                m_timerCond.wait (lock);
+                continue;
+            }
+            auto const when = m_timers.begin ()->first;
+            if (clock_type::now () < when)
+            {
+                m_timerCond.wait_until (lock, when);
+                continue;
+            }
+
+            auto timer = std::move (m_timers.begin ()->second);
+            m_timers.erase (m_timers.begin ());
+            lock.unlock ();
+            if (timer.hedge)
+                hedge (timer.state);
+            else
+                expire (timer.state);
+            lock.lock ();
+        }
+    }
+
+    /** Read a batch again, on the first reader free. */
+    void
+    hedge (std::shared_ptr<ReadState> const& state)
+    {
+        if (state->done)
+            return;
+        // A copy failing now knows it may not be the last.
+        ++state->pending;
+        if (state->done)
+        {
+            --state->pending;
+            return;
+        }
+
+        auto request = std::make_unique<ReadRequest> ();
+        request->state = state;
+        request->hashes = state->hashes;
+        request->format = m_keyFormat;
+        ++m_hedged;
+        enqueue (std::move (request), true);
+    }
+
+    /** Give up a batch, the hashes not yet read are neither found nor
+        not found.
+    */
+    void
+    expire (std::shared_ptr<ReadState> const& state)
+    {
+        if (state->done.exchange (true))
+            return;
+        ++m_late;
+        auto const callback = std::move (state->callback);
+        callback ({}, {});
+    }
+
+    /** Call back with the result of the first copy of a batch to succeed,
+        or of the last copy to fail.
+    */
+    void
+    deliver (std::unique_ptr<ReadRequest> request,
+        std::set<uint256> hashesNotFound, bool success)
+    {
+        auto const state = std::move (request->state);
+        auto const last = --state->pending == 0;
+        if (!success && !last)
+            return;
+        if (state->done.exchange (true))
+            return;
+
+        if (success)
+            recordLatency (clock_type::now () - state->start);
+        auto const callback = std::move (state->callback);
+        callback (std::move (request->objects), std::move (hashesNotFound));
+    }
+
+    void
+    recordLatency (clock_type::duration elapsed)
+    {
+        using namespace std::chrono;
+        if (!m_latency.record (duration_cast<microseconds> (elapsed)))
+            return;
+
+        BackendLatencyReport report;
+        report.name = getName ();
+        report.p99 = m_latency.percentile (99);
+        report.hedgedCount = m_hedged.exchange (0);
+        report.lateCount = m_late.exchange (0);
+        m_scheduler.onBackendLatency (report);
+    }
+
+    void
+    enqueue (std::unique_ptr<ReadRequest> request, bool front)
+    {
+        std::lock_guard<std::mutex> lock (m_readMutex);
+        if (front)
+            m_readQueue.push_front (std::move (request));
+        else
+            m_readQueue.push_back (std::move (request));
+        m_readCond.notify_one ();
+    }
+
+    /** Read the requests of the pool, each reader owns one connection. */
+    void
+    readerEntry (std::size_t index)
+    {
+        beast::Thread::setCurrentThreadName (
+            "hbase #" + std::to_string (index));
+
+        std::unique_ptr<HbaseConnection> connection;
+        std::vector<std::unique_ptr<ReadRequest>> batch;
+        for (;;)
+        {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock (m_readMutex);
+                while (!m_readStop && m_readQueue.empty ())
+                    m_readCond.wait (lock);
+                if (m_readQueue.empty ())
+                    return;
+                while (!m_readQueue.empty () && batch.size () < m_pipeline)
+                {
+                    batch.push_back (std::move (m_readQueue.front ()));
+                    m_readQueue.pop_front ();
+                }
+                stop = m_readStop;
+            }
+
+            if (stop)
+            {
+                // Shutting down, every callback must still be called.
+                for (auto& request : batch)
+                    fail (std::move (request));
+            }
+            else
+            {
+                readPipelined (connection, batch);
+            }
+            batch.clear ();
+        }
+    }
+
+    /** Send every request of the batch, then read the replies in order. */
+    void
+    readPipelined (std::unique_ptr<HbaseConnection>& connection,
+        std::vector<std::unique_ptr<ReadRequest>>& batch)
+    {
+        using namespace apache::thrift;
+        using namespace apache::hadoop::hbase::thrift;
+
+        std::size_t received = 0;
+        try
+        {
+            if (!connection)
+            {
+                connection = std::make_unique<HbaseConnection> (
+                    nextHost (), m_port, m_journal, m_isCompactProtocol,
+                        m_recvTimeout);
+            }
+
+            std::map<Text, Text> attributes;
+            for (auto const& request : batch)
+            {
+                std::vector<std::string> rows;
+                rows.reserve (request->hashes.size ());
+                for (auto const& hash : request->hashes)
+                    rows.emplace_back (makeRow (hash.data (), request->format));
+                connection->m_client->send_getRows (s_tableName, rows, attributes);
+            }
+
+            for (; received < batch.size (); ++received)
+            {
+                std::vector<TRowResult> rowResults;
+                connection->m_client->recv_getRows (rowResults);
+                complete (std::move (batch[received]), rowResults);
+            }
+        }
+        catch (const TException& te)
+        {
+            m_journal.error << te.what () << " getting " << (batch.size () - received)
+                << " batches of NodeObjects";
+            // The replies still pending on the connection are lost.
+            connection.reset ();
+
+            for (; received < batch.size (); ++received)
+            {
+                auto& request = batch[received];
+                if (++request->attempts < 3)
+                    enqueue (std::move (request), true);
+                else
+                    fail (std::move (request));
+            }
+        }
+    }
+
+    void
+    complete (std::unique_ptr<ReadRequest> request,
+        std::vector<apache::hadoop::hbase::thrift::TRowResult> const& rowResults)
+    {
+        auto hashesNotFound = request->hashes;
+        auto const found = request->objects.size ();
+        decodeRows (rowResults, request->objects, hashesNotFound);
+
+        if (request->format != m_keyFormat)
+        {
+            // Write the objects again under their new key.
+            for (auto i = found; i < request->objects.size (); ++i)
+                store (request->objects[i]);
+        }
+        else if (m_legacyKeys && !hashesNotFound.empty ())
+        {
+            request->hashes = std::move (hashesNotFound);
+            request->format = 1;
+            request->attempts = 0;
+            enqueue (std::move (request), true);
+            return;
+        }
+
+        deliver (std::move (request), std::move (hashesNotFound), true);
+    }
+
+    /** The hashes of a batch that could not be read are not known to be
+        missing, they are left out of the result.
+    */
+    void
+    fail (std::unique_ptr<ReadRequest> request)
+    {
+        deliver (std::move (request), {}, false);
     }
 
     void
     store (std::shared_ptr<NodeObject> const& object)
     {
-        m_batch.store (object);
+        std::unique_lock<std::mutex> lock (m_writeMutex);
+        while (!m_writeStop && m_writeBytes >= m_writeQueueBytes)
+            m_writeSpace.wait (lock);
+        m_writeBytes += object->getData ().size ();
+        m_writeQueue.push_back (object);
+        m_writeCond.notify_one ();
     }
 
     void
     storeBatch (Batch const& batch)
+    {
+        for (auto const& object : batch)
+            store (object);
+    }
+
+    /** Write the queued objects, each writer owns one connection. */
+    void
+    writerEntry (std::size_t index)
+    {
+        beast::Thread::setCurrentThreadName (
+            "hbase write #" + std::to_string (index));
+
+        std::unique_ptr<HbaseConnection> connection;
+        std::vector<apache::hadoop::hbase::thrift::BatchMutation> rowBatches;
+        Batch batch;
+        for (;;)
+        {
+            std::size_t bytes = 0;
+            {
+                std::unique_lock<std::mutex> lock (m_writeMutex);
+                while (!m_writeStop && m_writeQueue.empty ())
+                    m_writeCond.wait (lock);
+                if (m_writeQueue.empty ())
+                    return;
+                while (!m_writeQueue.empty () &&
+                    batch.size () < m_writeBatchMax &&
+                        (batch.empty () || bytes < m_writeBatchBytes))
+                {
+                    bytes += m_writeQueue.front ()->getData ().size ();
+                    batch.push_back (std::move (m_writeQueue.front ()));
+                    m_writeQueue.pop_front ();
+                }
+                m_writing += batch.size ();
+            }
+
+            BatchWriteReport report;
+            report.writeCount = batch.size ();
+            auto const before = std::chrono::steady_clock::now ();
+
+            writeRows (connection, rowBatches, batch);
+
+            report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+                (std::chrono::steady_clock::now () - before);
+            m_scheduler.onBatchWrite (report);
+
+            {
+                std::lock_guard<std::mutex> lock (m_writeMutex);
+                m_writeBytes -= bytes;
+                m_writing -= batch.size ();
+                m_writeSpace.notify_all ();
+            }
+            batch.clear ();
+        }
+    }
+
+    /** Write a batch, retrying until it succeeds or the backend closes.
+        The mutations are kept from one batch to the next, so their
+        strings keep their buffers.
+    */
+    void
+    writeRows (std::unique_ptr<HbaseConnection>& connection,
+        std::vector<apache::hadoop::hbase::thrift::BatchMutation>& rowBatches,
+            Batch const& batch)
     {
         using namespace apache::thrift;
         using namespace apache::hadoop::hbase::thrift;
-        
-        std::vector<BatchMutation> rowBatches;
 
         EncodedBlob encoded;
-
-        for (auto const& e : batch)
+        rowBatches.resize (batch.size ());
+        for (std::size_t i = 0; i < batch.size (); ++i)
         {
-            encoded.prepare (e);
-            
-            std::vector<Mutation> mutations;
-            mutations.clear ();
-            mutations.push_back (Mutation ());
-            mutations.back ().column = s_columnName;
-            mutations.back ().value.assign (static_cast<const char*> (encoded.getData ()), encoded.getSize ());
+            encoded.prepare (batch[i], m_codecs);
 
-            rowBatches.push_back (BatchMutation ());
-            rowBatches.back ().row = to_string (uint256::fromVoid (encoded.getKey ()));
-            rowBatches.back ().mutations = mutations;
+            auto& rowBatch = rowBatches[i];
+            rowBatch.row = makeRow (encoded.getKey ());
+            rowBatch.mutations.resize (1);
+            rowBatch.mutations.front ().column = s_columnName;
+            rowBatch.mutations.front ().value.assign (
+                static_cast<const char*> (encoded.getData ()), encoded.getSize ());
         }
 
-        for (int i = 0; i < 3; i++)
+        std::map<Text, Text> attributes;
+        auto delay = std::chrono::milliseconds (100);
+        for (int attempt = 1;; ++attempt)
         {
             try
             {
-                std::map<Text, Text> attributes;
-                getConnection ()->m_client->mutateRows (s_tableName, rowBatches, attributes);
+                if (!connection)
+                {
+                    connection = std::make_unique<HbaseConnection> (
+                        nextHost (), m_port, m_journal, m_isCompactProtocol);
+                }
+                connection->m_client->mutateRows (s_tableName, rowBatches, attributes);
                 return;
             }
             catch (const TException& te)
             {
-                m_journal.error << "storeBatch failed: " << te.what ();
-                releaseConnection ();
-//                if (getApp ().isShutdown ())
-//                    return;
+                m_journal.error << "storeBatch failed: " << te.what ()
+                    << ", attempt " << attempt;
+                connection.reset ();
+            }
+
+            if (m_writeStop && attempt >= 3)
+            {
+                m_journal.fatal << "Unable to store " << batch.size ()
+                    << " NodeObjects while closing";
+                return;
+            }
+
+            // Callers of store wait meanwhile, and the write load stays
+            // up so ledger acquisition slows down.
+            std::this_thread::sleep_for (delay);
+            delay = std::min (delay * 2, std::chrono::milliseconds (5000));
+        }
+    }
+
+    /** Split the table at its regions, or at the first key byte. */
+    std::vector<ScanRange>
+    makeScanRanges ()
+    {
+        using namespace apache::hadoop::hbase::thrift;
+
+        std::vector<std::string> splits;
+        if (m_scanRegions)
+        {
+            try
+            {
+                std::vector<TRegionInfo> regions;
+                getConnection ()->m_client->getTableRegions (regions, s_tableName);
+                for (auto const& region : regions)
+                {
+                    if (!region.startKey.empty ())
+                        splits.push_back (region.startKey);
+                }
+            }
+            catch (const apache::thrift::TException& te)
+            {
+                m_journal.warning << te.what () << " getting the regions, "
+                    "scanning by prefix";
+            }
+        }
+
+        if (splits.empty ())
+            splits = prefixSplits (m_keyFormat == 1);
+        return NodeStore::makeScanRanges (std::move (splits));
+    }
+
+    void
+    decodeScanned (std::vector<apache::hadoop::hbase::thrift::TRowResult> const& rowList,
+        std::vector<std::shared_ptr<NodeObject>>& objects)
+    {
+        for (auto& row : rowList)
+        {
+            uint256 key;
+            if (!parseRow (row.row, key))
+            {
+                // VFALCO NOTE What does it mean to find an
+                //             incorrectly sized key? Corruption?
+                if (m_journal.fatal)
+                    m_journal.fatal << "Bad key size = " << row.row.size ();
+                continue;
+            }
+
+            auto const& columns = row.columns;
+            auto const column = columns.find (s_columnName);
+            if (column == columns.end ())
+            {
+                if (m_journal.fatal)
+                    m_journal.fatal << "column not found for NodeObject #" << key;
+                continue;
+            }
+
+            auto const& data = column->second.value;
+            DecodedBlob decoded (key.data (),
+                                 data.data (),
+                                 data.size ());
+
+            if (decoded.wasOk ())
+            {
+                objects.emplace_back (decoded.createObject ());
+            }
+            else
+            {
+                // Uh oh, corrupted data!
+                if (m_journal.fatal)
+                    m_journal.fatal << "Corrupt NodeObject #" << row.row;
             }
         }
-        throw std::runtime_error ("storeBatch failed");
     }
 
+    /** Visit every object, scanning the ranges on several threads.
+
+        The rows of each range are read and decoded in parallel, the
+        callback is only ever invoked by one thread at a time. With a
+        checkpoint file, the position of every range is saved once a minute
+        and an interrupted scan resumes from it. The positions saved lag
+        one minute behind, so objects still buffered by the consumer are
+        read again rather than lost.
+    */
     void
     for_each (std::function <void(std::shared_ptr<NodeObject>)> f)
     {
         using namespace apache::thrift;
         using namespace apache::hadoop::hbase::thrift;
-        
-        auto scan = TScan ();
-        scan.caching = 1000;
+        using clock_type = std::chrono::steady_clock;
 
-        std::map<Text, Text> attributes;
+        std::vector<ScanRange> ranges;
+        if (!m_scanCheckpoint.empty ())
+            ranges = loadScanCheckpoint (m_scanCheckpoint);
+        if (ranges.empty ())
+            ranges = makeScanRanges ();
+        else
+            m_journal.info << "Resuming the scan of " << ranges.size ()
+                << " ranges from " << m_scanCheckpoint;
 
-        auto scanner = getConnection ()->m_client->scannerOpenWithScan(s_tableName, scan, attributes);
-        
-        std::vector<TRowResult> rowList;
+        // The positions written by the next checkpoint.
+        auto saved = ranges;
+        auto const started = clock_type::now ();
+        auto lastCheckpoint = started;
+        auto const first = scannedFraction (ranges, m_keyFormat == 1);
 
-        for (;;)
+        std::mutex mutex;
+        std::atomic<std::size_t> nextRange (0);
+        std::atomic<bool> failed (false);
+        std::exception_ptr error;
+
+        auto scanRange = [&](HbaseConnection& connection, ScanRange& range)
         {
-            getConnection ()->m_client->scannerGetList (rowList, scanner, 100);
-            if (rowList.empty ())
-                break;
-            
-            for (auto& row : rowList)
+            TScan scan;
+            scan.__set_caching (m_scanCaching);
             {
-                if (row.row.size () != m_keyBytes * 2)
-                {
-                    // VFALCO NOTE What does it mean to find an
-                    //             incorrectly sized key? Corruption?
-                    if (m_journal.fatal)
-                        m_journal.fatal << "Bad key size = " << row.row.size ();
-                    continue;
-                }
+                std::lock_guard<std::mutex> lock (mutex);
+                if (!range.next.empty ())
+                    scan.__set_startRow (range.next);
+            }
+            if (!range.stop.empty ())
+                scan.__set_stopRow (range.stop);
+
+            std::map<Text, Text> attributes;
+            auto const scanner = connection.m_client->scannerOpenWithScan (
+                s_tableName, scan, attributes);
+
+            std::vector<TRowResult> rowList;
+            std::vector<std::shared_ptr<NodeObject>> objects;
+            while (!failed)
+            {
+                connection.m_client->scannerGetList (rowList, scanner, m_scanBatch);
+                if (rowList.empty ())
+                    break;
+
+                objects.clear ();
+                decodeScanned (rowList, objects);
+
+                std::lock_guard<std::mutex> lock (mutex);
+                for (auto& object : objects)
+                    f (std::move (object));
 
-                auto& columns = row.columns;
-                if (columns.find (s_columnName) == columns.end ())
+                // The smallest row after the last one.
+                range.next = rowList.back ().row + '\0';
+
+                auto const now = clock_type::now ();
+                if (now - lastCheckpoint > std::chrono::minutes (1))
                 {
-                    if (m_journal.fatal)
-                        m_journal.fatal << "column not found for NodeObject #" << row.row;
-                    continue;
+                    logScanProgress (m_journal, first,
+                        scannedFraction (ranges, m_keyFormat == 1), now - started);
+                    if (!m_scanCheckpoint.empty ())
+                        saveScanCheckpoint (m_scanCheckpoint, saved);
+                    saved = ranges;
+                    lastCheckpoint = now;
                 }
+            }
+            connection.m_client->scannerClose (scanner);
 
-                auto& data = columns[s_columnName].value;
-                uint256 key = from_hex_text<uint256> (row.row);
-                DecodedBlob decoded (key.data (),
-                                     data.data (),
-                                     data.size ());
+            std::lock_guard<std::mutex> lock (mutex);
+            range.done = !failed;
+        };
 
-                if (decoded.wasOk ())
+        auto worker = [&]()
+        {
+            try
+            {
+                std::unique_ptr<HbaseConnection> connection;
+                for (auto i = nextRange++; i < ranges.size () && !failed; i = nextRange++)
                 {
-                    f (decoded.createObject ());
+                    if (ranges[i].done)
+                        continue;
+
+                    for (int attempt = 0;; ++attempt)
+                    {
+                        try
+                        {
+                            if (!connection)
+                            {
+                                connection = std::make_unique<HbaseConnection> (
+                                    nextHost (), m_port, m_journal, m_isCompactProtocol);
+                            }
+                            scanRange (*connection, ranges[i]);
+                            break;
+                        }
+                        catch (const TException& te)
+                        {
+                            // Resume the range on a new connection.
+                            m_journal.error << te.what () << " scanning range " << i;
+                            connection.reset ();
+                            if (attempt == 2)
+                                throw;
+                        }
+                    }
                 }
-                else
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                if (!failed.exchange (true))
+                    error = std::current_exception ();
+            }
+        };
+
+        auto const threads = std::min (m_scanThreads, ranges.size ());
+        if (threads <= 1)
+        {
+            worker ();
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back ([&worker, i]()
                 {
-                    // Uh oh, corrupted data!
-                    if (m_journal.fatal)
-                        m_journal.fatal << "Corrupt NodeObject #" << row.row;
-                }
+                    beast::Thread::setCurrentThreadName (
+                        "hbase scan #" + std::to_string (i));
+                    worker ();
+                });
             }
+            for (auto& w : workers)
+                w.join ();
+        }
+
+        if (error)
+        {
+            if (!m_scanCheckpoint.empty ())
+                saveScanCheckpoint (m_scanCheckpoint, saved);
+            std::rethrow_exception (error);
         }
+
+        if (!m_scanCheckpoint.empty ())
+            std::remove (m_scanCheckpoint.c_str ());
     }
 
     int
     getWriteLoad ()
     {
-        return m_batch.getWriteLoad ();
+        std::lock_guard<std::mutex> lock (m_writeMutex);
+        return static_cast<int> (m_writeQueue.size () + m_writing);
     }
 
     void
@@ -495,12 +1433,6 @@ public:
 
     //--------------------------------------------------------------------------
 
-    void
-    writeBatch (Batch const& batch)
-    {
-        storeBatch (batch);
-    }
-
     void
     verify() override
     {
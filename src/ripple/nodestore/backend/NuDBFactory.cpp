@@ -29,13 +29,17 @@
 #include <beast/nudb/detail/varint.h>
 #include <beast/nudb/visit.h>
 #include <beast/hash/xxhasher.h>
+#include <beast/threads/Thread.h>
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
 #include <cstdint>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -50,6 +54,9 @@ public:
         // distribution of data sizes.
         arena_alloc_size = 16 * 1024 * 1024,
 
+        // Fewest keys of a batch worth another lookup thread
+        fetch_thread_keys = 64,
+
         currentType = 1
     };
 
@@ -62,6 +69,7 @@ public:
     api::store db_;
     std::atomic <bool> deletePath_;
     Scheduler& scheduler_;
+    std::size_t fetchThreads_;
 
     NuDBBackend (int keyBytes, Section const& keyValues,
         Scheduler& scheduler, beast::Journal journal)
@@ -70,6 +78,8 @@ public:
         , name_ (get<std::string>(keyValues, "path"))
         , deletePath_(false)
         , scheduler_ (scheduler)
+        , fetchThreads_ (std::max<std::size_t> (
+            get<std::size_t> (keyValues, "fetch_threads", 4), 1))
     {
         if (name_.empty())
             Throw<std::runtime_error> (
@@ -149,14 +159,87 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        // Each lookup waits on its own reads of the key and data
+        // files, so a batch is split across threads to keep several
+        // reads in flight at once.
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        std::exception_ptr error;
+        std::mutex mutex;
+        auto const lookup = [&](std::size_t first, std::size_t last)
+        {
+            try
+            {
+                for (auto i = first; i < last; ++i)
+                {
+                    if (fetch (keys[i], &results[i]) == dataCorrupt)
+                        journal_.error << "Corrupt NodeObject #" <<
+                            uint256::fromVoid (keys[i]);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                if (! error)
+                    error = std::current_exception ();
+            }
+        };
+
+        auto const threads = std::min (fetchThreads_,
+            (n + fetch_thread_keys - 1) / fetch_thread_keys);
+        if (threads <= 1)
+        {
+            lookup (0, n);
+        }
+        else
+        {
+            auto const chunk = (n + threads - 1) / threads;
+            std::vector<std::thread> workers;
+            for (auto first = chunk; first < n; first += chunk)
+            {
+                workers.emplace_back ([&lookup, first, chunk, n]()
+                {
+                    beast::Thread::setCurrentThreadName ("nudb fetch");
+                    lookup (first, std::min (first + chunk, n));
+                });
+            }
+            lookup (0, chunk);
+            for (auto& w : workers)
+                w.join ();
+        }
+
+        if (error)
+            std::rethrow_exception (error);
+        return results;
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
+    fetchBatch (std::set<uint256> const& hashes) override
+    {
+        std::vector<void const*> keys;
+        keys.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            keys.push_back (hash.data ());
+        auto results = fetchBatch (keys.size (), keys.data ());
+
+        std::vector<std::shared_ptr<NodeObject>> objects;
+        std::set<uint256> hashesNotFound;
+        objects.reserve (results.size ());
+        auto hash = hashes.begin ();
+        for (auto& result : results)
+        {
+            if (result)
+                objects.emplace_back (std::move (result));
+            else
+                hashesNotFound.insert (hashesNotFound.end (), *hash);
+            ++hash;
+        }
+        return std::make_pair (std::move (objects), std::move (hashesNotFound));
     }
 
     void
@@ -30,9 +30,15 @@
 #include <ripple/nodestore/impl/BatchWriter.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/ScanRange.h>
+#include <ripple/nodestore/impl/Tuning.h>
 #include <beast/threads/Thread.h>
 #include <atomic>
+#include <chrono>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -98,7 +104,10 @@ public:
     Scheduler& m_scheduler;
     BatchWriter m_batch;
     std::string m_name;
+    BlobCodecs const m_codecs;
     std::unique_ptr <rocksdb::DB> m_db;
+    std::size_t m_scanThreads = 1;
+    std::string m_scanCheckpoint;
 
     RocksDBBackend (int keyBytes, Section const& keyValues,
         Scheduler& scheduler, beast::Journal journal, RocksDBEnv* env)
@@ -107,6 +116,7 @@ public:
         , m_keyBytes (keyBytes)
         , m_scheduler (scheduler)
         , m_batch (*this, scheduler)
+        , m_codecs (keyValues, BlobCodec::none)
     {
         if (! get_if_exists(keyValues, "path", m_name))
             Throw<std::runtime_error> ("Missing path in RocksDBFactory backend");
@@ -124,6 +134,10 @@ public:
 
         get_if_exists (keyValues, "open_files", options.max_open_files);
 
+        m_scanThreads = std::max<std::size_t> (
+            get<std::size_t> (keyValues, "scan_threads", m_scanThreads), 1);
+        m_scanCheckpoint = get<std::string> (keyValues, "scan_checkpoint");
+
         if (keyValues.exists ("file_size_mb"))
         {
             options.target_file_size_base = 1024 * 1024 * get<int>(keyValues,"file_size_mb");
@@ -210,8 +224,6 @@ public:
     {
         pObject->reset ();
 
-        Status status (ok);
-
         rocksdb::ReadOptions const options;
         rocksdb::Slice const slice (static_cast <char const*> (key), m_keyBytes);
 
@@ -219,6 +231,16 @@ public:
 
         rocksdb::Status getStatus = m_db->Get (options, slice, &string);
 
+        return decode (key, getStatus, string, pObject);
+    }
+
+    /** Decode the value read for a key or map the read's status. */
+    Status
+    decode (void const* key, rocksdb::Status const& getStatus,
+        std::string const& string, std::shared_ptr<NodeObject>* pObject)
+    {
+        Status status (ok);
+
         if (getStatus.ok ())
         {
             DecodedBlob decoded (key, string.data (), string.size ());
@@ -258,14 +280,63 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        std::vector<rocksdb::Slice> slices;
+        slices.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+            slices.emplace_back (static_cast <char const*> (keys[i]), m_keyBytes);
+        return multiGet (slices);
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
+    fetchBatch (std::set<uint256> const& hashes) override
+    {
+        // The set is ordered, so MultiGet visits the keys in
+        // the order they are laid out in the files.
+        std::vector<rocksdb::Slice> slices;
+        slices.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            slices.emplace_back (
+                reinterpret_cast <char const*> (hash.data ()), m_keyBytes);
+        auto results = multiGet (slices);
+
+        std::vector<std::shared_ptr<NodeObject>> objects;
+        std::set<uint256> hashesNotFound;
+        objects.reserve (results.size ());
+        auto hash = hashes.begin ();
+        for (auto& result : results)
+        {
+            if (result)
+                objects.emplace_back (std::move (result));
+            else
+                hashesNotFound.insert (hashesNotFound.end (), *hash);
+            ++hash;
+        }
+        return std::make_pair (std::move (objects), std::move (hashesNotFound));
+    }
+
+    /** Read the keys in one MultiGet, missing objects are null. */
+    std::vector<std::shared_ptr<NodeObject>>
+    multiGet (std::vector<rocksdb::Slice> const& slices)
+    {
+        std::vector<std::string> values;
+        auto const statuses = m_db->MultiGet (
+            rocksdb::ReadOptions (), slices, &values);
+
+        std::vector<std::shared_ptr<NodeObject>> results (slices.size ());
+        for (std::size_t i = 0; i < slices.size (); ++i)
+        {
+            if (decode (slices[i].data (), statuses[i], values[i],
+                    &results[i]) == dataCorrupt)
+                m_journal.error << "Corrupt NodeObject #" <<
+                    uint256::fromVoid (slices[i].data ());
+        }
+        return results;
     }
 
     void
@@ -283,7 +354,7 @@ public:
 
         for (auto const& e : batch)
         {
-            encoded.prepare (e);
+            encoded.prepare (e, m_codecs);
 
             wb.Put (
                 rocksdb::Slice (reinterpret_cast <char const*> (
@@ -300,41 +371,174 @@ public:
             Throw<std::runtime_error> ("storeBatch failed: " + ret.ToString());
     }
 
+    /** Visit every object, scanning the ranges on several threads.
+
+        The keys are split at their first 4 bits, each range is read and
+        decoded by its own iterator, and the callback is only ever invoked
+        by one thread at a time. With a checkpoint file an interrupted scan
+        resumes, as it does with the Hbase backend.
+    */
     void
     for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
     {
-        rocksdb::ReadOptions const options;
+        using clock_type = std::chrono::steady_clock;
 
-        std::unique_ptr <rocksdb::Iterator> it (m_db->NewIterator (options));
-
-        for (it->SeekToFirst (); it->Valid (); it->Next ())
+        std::vector<ScanRange> ranges;
+        if (!m_scanCheckpoint.empty ())
+            ranges = loadScanCheckpoint (m_scanCheckpoint);
+        if (ranges.empty ())
+            ranges = makeScanRanges (prefixSplits (false));
+        else
+            m_journal.info << "Resuming the scan of " << ranges.size ()
+                << " ranges from " << m_scanCheckpoint;
+
+        // The positions written by the next checkpoint, which lag a
+        // minute behind so objects still buffered by the consumer are
+        // read again rather than lost.
+        auto saved = ranges;
+        auto const started = clock_type::now ();
+        auto lastCheckpoint = started;
+        auto const first = scannedFraction (ranges, false);
+
+        std::mutex mutex;
+        std::atomic<std::size_t> nextRange (0);
+        std::atomic<bool> failed (false);
+        std::exception_ptr error;
+
+        auto scanRange = [&](ScanRange& range)
         {
-            if (it->key ().size () == m_keyBytes)
+            rocksdb::ReadOptions options;
+            options.fill_cache = false;
+            std::unique_ptr <rocksdb::Iterator> it (m_db->NewIterator (options));
             {
-                DecodedBlob decoded (it->key ().data (),
-                                                it->value ().data (),
-                                                it->value ().size ());
+                std::lock_guard<std::mutex> lock (mutex);
+                if (range.next.empty ())
+                    it->SeekToFirst ();
+                else
+                    it->Seek (range.next);
+            }
+            rocksdb::Slice const stop (range.stop);
 
-                if (decoded.wasOk ())
+            std::vector<std::shared_ptr<NodeObject>> objects;
+            while (!failed)
+            {
+                objects.clear ();
+                std::string last;
+                for (; it->Valid () && objects.size () < scanBatchSize; it->Next ())
                 {
-                    f (decoded.createObject ());
+                    if (!range.stop.empty () && it->key ().compare (stop) >= 0)
+                        break;
+                    last = it->key ().ToString ();
+                    decodeScanned (*it, objects);
                 }
-                else
+                if (!it->status ().ok ())
+                    Throw<std::runtime_error> ("for_each failed: " +
+                        it->status ().ToString ());
+                if (last.empty ())
+                    break;
+
+                std::lock_guard<std::mutex> lock (mutex);
+                for (auto& object : objects)
+                    f (std::move (object));
+
+                // The smallest key after the last one.
+                range.next = last + '\0';
+
+                auto const now = clock_type::now ();
+                if (now - lastCheckpoint > std::chrono::minutes (1))
                 {
-                    // Uh oh, corrupted data!
-                    if (m_journal.fatal) m_journal.fatal <<
-                        "Corrupt NodeObject #" <<
-                        from_hex_text<uint256>(it->key ().data ());
+                    logScanProgress (m_journal, first,
+                        scannedFraction (ranges, false), now - started);
+                    if (!m_scanCheckpoint.empty ())
+                        saveScanCheckpoint (m_scanCheckpoint, saved);
+                    saved = ranges;
+                    lastCheckpoint = now;
                 }
             }
+
+            std::lock_guard<std::mutex> lock (mutex);
+            range.done = !failed;
+        };
+
+        auto worker = [&]()
+        {
+            try
+            {
+                for (auto i = nextRange++; i < ranges.size () && !failed; i = nextRange++)
+                {
+                    if (!ranges[i].done)
+                        scanRange (ranges[i]);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                if (!failed.exchange (true))
+                    error = std::current_exception ();
+            }
+        };
+
+        auto const threads = std::min (m_scanThreads, ranges.size ());
+        if (threads <= 1)
+        {
+            worker ();
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back ([&worker, i]()
+                {
+                    beast::Thread::setCurrentThreadName (
+                        "rocksdb scan #" + std::to_string (i));
+                    worker ();
+                });
+            }
+            for (auto& w : workers)
+                w.join ();
+        }
+
+        if (error)
+        {
+            if (!m_scanCheckpoint.empty ())
+                saveScanCheckpoint (m_scanCheckpoint, saved);
+            std::rethrow_exception (error);
+        }
+
+        if (!m_scanCheckpoint.empty ())
+            std::remove (m_scanCheckpoint.c_str ());
+    }
+
+    void
+    decodeScanned (rocksdb::Iterator& it,
+        std::vector<std::shared_ptr<NodeObject>>& objects)
+    {
+        if (it.key ().size () == m_keyBytes)
+        {
+            DecodedBlob decoded (it.key ().data (),
+                                            it.value ().data (),
+                                            it.value ().size ());
+
+            if (decoded.wasOk ())
+            {
+                objects.push_back (decoded.createObject ());
+            }
             else
             {
-                // VFALCO NOTE What does it mean to find an
-                //             incorrectly sized key? Corruption?
+                // Uh oh, corrupted data!
                 if (m_journal.fatal) m_journal.fatal <<
-                    "Bad key size = " << it->key ().size ();
+                    "Corrupt NodeObject #" <<
+                    from_hex_text<uint256>(it.key ().data ());
             }
         }
+        else
+        {
+            // VFALCO NOTE What does it mean to find an
+            //             incorrectly sized key? Corruption?
+            if (m_journal.fatal) m_journal.fatal <<
+                "Bad key size = " << it.key ().size ();
+        }
     }
 
     int
@@ -94,6 +94,7 @@ public:
     beast::Journal m_journal;
     size_t const m_keyBytes;
     std::string m_name;
+    BlobCodecs const m_codecs;
     std::unique_ptr <rocksdb::DB> m_db;
 
     RocksDBQuickBackend (int keyBytes, Section const& keyValues,
@@ -102,6 +103,7 @@ public:
         , m_journal (journal)
         , m_keyBytes (keyBytes)
         , m_name (get<std::string>(keyValues, "path"))
+        , m_codecs (keyValues, BlobCodec::none)
     {
         if (m_name.empty())
             Throw<std::runtime_error> (
@@ -209,8 +211,6 @@ public:
     {
         pObject->reset ();
 
-        Status status (ok);
-
         rocksdb::ReadOptions const options;
         rocksdb::Slice const slice (static_cast <char const*> (key), m_keyBytes);
 
@@ -218,6 +218,16 @@ public:
 
         rocksdb::Status getStatus = m_db->Get (options, slice, &string);
 
+        return decode (key, getStatus, string, pObject);
+    }
+
+    /** Decode the value read for a key or map the read's status. */
+    Status
+    decode (void const* key, rocksdb::Status const& getStatus,
+        std::string const& string, std::shared_ptr<NodeObject>* pObject)
+    {
+        Status status (ok);
+
         if (getStatus.ok ())
         {
             DecodedBlob decoded (key, string.data (), string.size ());
@@ -257,7 +267,7 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     void
@@ -269,8 +279,57 @@ public:
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        std::vector<rocksdb::Slice> slices;
+        slices.reserve (n);
+        for (std::size_t i = 0; i < n; ++i)
+            slices.emplace_back (static_cast <char const*> (keys[i]), m_keyBytes);
+        return multiGet (slices);
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
+    fetchBatch (std::set<uint256> const& hashes) override
+    {
+        // The set is ordered, so MultiGet visits the keys in
+        // the order they are laid out in the files.
+        std::vector<rocksdb::Slice> slices;
+        slices.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            slices.emplace_back (
+                reinterpret_cast <char const*> (hash.data ()), m_keyBytes);
+        auto results = multiGet (slices);
+
+        std::vector<std::shared_ptr<NodeObject>> objects;
+        std::set<uint256> hashesNotFound;
+        objects.reserve (results.size ());
+        auto hash = hashes.begin ();
+        for (auto& result : results)
+        {
+            if (result)
+                objects.emplace_back (std::move (result));
+            else
+                hashesNotFound.insert (hashesNotFound.end (), *hash);
+            ++hash;
+        }
+        return std::make_pair (std::move (objects), std::move (hashesNotFound));
+    }
+
+    /** Read the keys in one MultiGet, missing objects are null. */
+    std::vector<std::shared_ptr<NodeObject>>
+    multiGet (std::vector<rocksdb::Slice> const& slices)
+    {
+        std::vector<std::string> values;
+        auto const statuses = m_db->MultiGet (
+            rocksdb::ReadOptions (), slices, &values);
+
+        std::vector<std::shared_ptr<NodeObject>> results (slices.size ());
+        for (std::size_t i = 0; i < slices.size (); ++i)
+        {
+            if (decode (slices[i].data (), statuses[i], values[i],
+                    &results[i]) == dataCorrupt)
+                m_journal.error << "Corrupt NodeObject #" <<
+                    uint256::fromVoid (slices[i].data ());
+        }
+        return results;
     }
 
     void
@@ -282,7 +341,7 @@ public:
 
         for (auto const& e : batch)
         {
-            encoded.prepare (e);
+            encoded.prepare (e, m_codecs);
 
             wb.Put(
                 rocksdb::Slice(reinterpret_cast<char const*>(encoded.getKey()),
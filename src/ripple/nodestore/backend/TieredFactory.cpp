@@ -0,0 +1,448 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A local hot tier over a shared cold backend.
+
+    Every object is written to both tiers and read from the hot tier
+    first. An object found in the cold tier is copied to the hot tier.
+
+    The hot tier is a series of generations of a local backend, in
+    directories named hot.<n> under the path. The oldest generation is
+    dropped when the current one holds hot_max_objects objects or is
+    hot_max_age seconds old, objects read from it move forward to the
+    current generation. With online deletion each rotating backend is a
+    tiered backend over the same cold store, and deleting it only removes
+    its hot tier.
+*/
+class TieredBackend : public Backend
+{
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    beast::Journal m_journal;
+    Scheduler& m_scheduler;
+    boost::filesystem::path m_path;
+    Section m_hotParameters;
+    std::uint64_t m_maxObjects;
+    std::chrono::seconds m_maxAge;
+    std::atomic <bool> m_deletePath;
+
+    std::mutex m_mutex;
+    std::shared_ptr <Backend> m_current;
+    std::shared_ptr <Backend> m_previous;
+    std::uint32_t m_generation;
+    std::atomic <std::uint64_t> m_stored;
+    clock_type::time_point m_started;
+
+    // Last, so pending reads complete while the hot tier is still open.
+    std::unique_ptr <Backend> m_cold;
+
+public:
+    TieredBackend (Section const& keyValues,
+        Scheduler& scheduler, beast::Journal journal)
+        : m_journal (journal)
+        , m_scheduler (scheduler)
+        , m_path (get<std::string> (keyValues, "path"))
+        , m_hotParameters (keyValues)
+        , m_maxObjects (get<std::uint64_t> (keyValues, "hot_max_objects", 20000000))
+        , m_maxAge (get<std::uint32_t> (keyValues, "hot_max_age", 0))
+        , m_deletePath (false)
+        , m_generation (0)
+        , m_stored (0)
+        , m_started (clock_type::now ())
+    {
+        if (m_path.empty ())
+            Throw<std::runtime_error> ("Missing path in Tiered backend");
+
+        m_hotParameters.set ("type",
+            get<std::string> (keyValues, "hot_type", "NuDB"));
+
+        Section coldParameters (keyValues);
+        coldParameters.set ("type",
+            get<std::string> (keyValues, "cold_type", "Hbase"));
+        coldParameters.set ("path", get<std::string> (keyValues, "cold_path"));
+        // Only the hot tier rotates with online deletion.
+        coldParameters.set ("generation", "");
+        m_cold = Manager::instance ().make_Backend (
+            coldParameters, scheduler, journal);
+
+        openGenerations ();
+    }
+
+    ~TieredBackend ()
+    {
+        close ();
+    }
+
+    std::string
+    getName () override
+    {
+        // Online deletion keeps track of the rotating backends by path.
+        return m_path.string ();
+    }
+
+    void
+    close () override
+    {
+        if (m_cold)
+        {
+            m_cold->close ();
+            m_cold.reset ();
+        }
+
+        std::lock_guard<std::mutex> lock (m_mutex);
+        for (auto hot : {&m_current, &m_previous})
+        {
+            if (*hot)
+            {
+                if (m_deletePath)
+                    (*hot)->setDeletePath ();
+                (*hot)->close ();
+                hot->reset ();
+            }
+        }
+
+        if (m_deletePath)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all (m_path, ec);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    Status
+    fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        if (fetchHot (key, pObject))
+            return ok;
+
+        auto const status = m_cold->fetch (key, pObject);
+        if (status == ok)
+            storeHot (*pObject);
+        return status;
+    }
+
+    bool
+    canFetchBatch () override
+    {
+        return m_cold->canFetchBatch ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::size_t n, void const* const* keys) override
+    {
+        return m_cold->fetchBatch (n, keys);
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, std::set<uint256>>
+    fetchBatch (std::set<uint256> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> objects;
+        auto const missing = fetchHot (hashes, objects);
+        if (missing.empty ())
+            return {std::move (objects), missing};
+
+        auto result = m_cold->fetchBatch (missing);
+        for (auto& object : result.first)
+        {
+            storeHot (object);
+            objects.push_back (std::move (object));
+        }
+        return {std::move (objects), std::move (result.second)};
+    }
+
+    uint32_t
+    fetchBatchLimit () override
+    {
+        return m_cold->fetchBatchLimit ();
+    }
+
+    bool
+    canFetchAsync () override
+    {
+        return m_cold->canFetchAsync ();
+    }
+
+    void
+    fetchBatchAsync (std::set<uint256> const& hashes,
+        FetchCallback callback) override
+    {
+        auto objects = std::make_shared<std::vector<std::shared_ptr<NodeObject>>> ();
+        auto const missing = fetchHot (hashes, *objects);
+        if (missing.empty ())
+        {
+            callback (std::move (*objects), missing);
+            return;
+        }
+
+        m_cold->fetchBatchAsync (missing,
+            [this, objects, callback] (
+                std::vector<std::shared_ptr<NodeObject>> found,
+                    std::set<uint256> notFound)
+            {
+                for (auto& object : found)
+                {
+                    storeHot (object);
+                    objects->push_back (std::move (object));
+                }
+                callback (std::move (*objects), std::move (notFound));
+            });
+    }
+
+    void
+    store (std::shared_ptr<NodeObject> const& object) override
+    {
+        storeHot (object);
+        m_cold->store (object);
+    }
+
+    void
+    storeBatch (Batch const& batch) override
+    {
+        // The local backends take batches and single stores concurrently.
+        current ()->storeBatch (batch);
+        m_stored += batch.size ();
+        m_cold->storeBatch (batch);
+        checkRotate ();
+    }
+
+    void
+    for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
+    {
+        m_cold->for_each (f);
+    }
+
+    int
+    getWriteLoad () override
+    {
+        return current ()->getWriteLoad () + m_cold->getWriteLoad ();
+    }
+
+    void
+    setDeletePath () override
+    {
+        // Only the hot tier, the cold store is shared.
+        m_deletePath = true;
+    }
+
+    void
+    verify () override
+    {
+        current ()->verify ();
+    }
+
+private:
+    static
+    char const*
+    generationPrefix ()
+    {
+        return "hot.";
+    }
+
+    std::shared_ptr <Backend>
+    openGeneration (std::uint32_t generation)
+    {
+        Section parameters (m_hotParameters);
+        parameters.set ("path", (m_path /
+            (generationPrefix () + std::to_string (generation))).string ());
+        return Manager::instance ().make_Backend (
+            parameters, m_scheduler, m_journal);
+    }
+
+    /** Open the two newest generations and remove the older ones. */
+    void
+    openGenerations ()
+    {
+        boost::filesystem::create_directories (m_path);
+
+        std::vector<std::uint32_t> generations;
+        for (boost::filesystem::directory_iterator it (m_path);
+                it != boost::filesystem::directory_iterator (); ++it)
+        {
+            auto const name = it->path ().filename ().string ();
+            if (!boost::starts_with (name, generationPrefix ()))
+                continue;
+            try
+            {
+                generations.push_back (std::stoul (
+                    name.substr (std::strlen (generationPrefix ()))));
+            }
+            catch (std::exception const&)
+            {
+            }
+        }
+        std::sort (generations.begin (), generations.end ());
+
+        while (generations.size () > 2)
+        {
+            boost::filesystem::remove_all (m_path /
+                (generationPrefix () + std::to_string (generations.front ())));
+            generations.erase (generations.begin ());
+        }
+
+        if (generations.size () == 2)
+            m_previous = openGeneration (generations.front ());
+        if (!generations.empty ())
+            m_generation = generations.back ();
+        m_current = openGeneration (m_generation);
+    }
+
+    std::shared_ptr <Backend>
+    current ()
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        return m_current;
+    }
+
+    bool
+    fetchHot (void const* key, std::shared_ptr<NodeObject>* pObject)
+    {
+        std::shared_ptr <Backend> current, previous;
+        {
+            std::lock_guard<std::mutex> lock (m_mutex);
+            current = m_current;
+            previous = m_previous;
+        }
+
+        if (current->fetch (key, pObject) == ok)
+            return true;
+
+        if (previous && previous->fetch (key, pObject) == ok)
+        {
+            // Keep it past the next rotation.
+            storeHot (*pObject);
+            return true;
+        }
+        return false;
+    }
+
+    /** @return The hashes not in the hot tier. */
+    std::set<uint256>
+    fetchHot (std::set<uint256> const& hashes,
+        std::vector<std::shared_ptr<NodeObject>>& objects)
+    {
+        std::set<uint256> missing;
+        for (auto const& hash : hashes)
+        {
+            std::shared_ptr<NodeObject> object;
+            if (fetchHot (hash.data (), &object))
+                objects.push_back (std::move (object));
+            else
+                missing.insert (hash);
+        }
+        return missing;
+    }
+
+    void
+    storeHot (std::shared_ptr<NodeObject> const& object)
+    {
+        current ()->store (object);
+        ++m_stored;
+        checkRotate ();
+    }
+
+    void
+    checkRotate ()
+    {
+        bool const full = m_maxObjects != 0 && m_stored >= m_maxObjects;
+        bool const old = m_maxAge.count () != 0 &&
+            clock_type::now () - m_started >= m_maxAge;
+        if (!full && !old)
+            return;
+
+        std::shared_ptr <Backend> dropped;
+        {
+            std::lock_guard<std::mutex> lock (m_mutex);
+            if ((m_maxObjects == 0 || m_stored < m_maxObjects) &&
+                    (m_maxAge.count () == 0 ||
+                        clock_type::now () - m_started < m_maxAge))
+                return;
+
+            dropped = std::move (m_previous);
+            m_previous = std::move (m_current);
+            m_current = openGeneration (++m_generation);
+            m_stored = 0;
+            m_started = clock_type::now ();
+        }
+
+        m_journal.info << "Hot tier of " << getName () << " rotated to generation "
+            << m_generation;
+
+        // Removed once no read uses it any more.
+        if (dropped)
+            dropped->setDeletePath ();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class TieredFactory : public Factory
+{
+public:
+    TieredFactory ()
+    {
+        Manager::instance().insert(*this);
+    }
+
+    ~TieredFactory ()
+    {
+        Manager::instance().erase(*this);
+    }
+
+    std::string
+    getName () const
+    {
+        return "Tiered";
+    }
+
+    std::unique_ptr <Backend>
+    createInstance (
+        size_t keyBytes,
+        Section const& keyValues,
+        Scheduler& scheduler,
+        beast::Journal journal)
+    {
+        return std::make_unique <TieredBackend> (
+            keyValues, scheduler, journal);
+    }
+};
+
+static TieredFactory tieredFactory;
+
+}
+}
@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/AccessTrace.h>
+#include <ripple/basics/contract.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+static char const traceMagic[8] = {'R', 'D', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/*  Record format, integers are little endian:
+
+    Bytes
+
+    0...7       when        Microseconds since the trace was opened
+    8           operation   One of AccessTrace::Operation
+    9           type        One of NodeObjectType
+    10...11     thread
+    12...15     size
+    16...47     hash
+*/
+
+template <class Integer>
+static
+void
+putInteger (unsigned char* out, Integer value, std::size_t bytes)
+{
+    for (std::size_t i = 0; i < bytes; ++i)
+        out[i] = static_cast<unsigned char> (
+            static_cast<std::uint64_t> (value) >> (8 * i));
+}
+
+static
+std::uint64_t
+getInteger (unsigned char const* in, std::size_t bytes)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = bytes; i--;)
+        value = (value << 8) | in[i];
+    return value;
+}
+
+AccessTrace::AccessTrace (std::string const& path)
+    : out_ (path, std::ios::binary | std::ios::app)
+    , start_ (std::chrono::steady_clock::now ())
+{
+    if (! out_)
+        Throw<std::runtime_error> ("Unable to open node store trace " + path);
+
+    // Each opening starts a new segment, its times count from there.
+    out_.write (traceMagic, sizeof (traceMagic));
+}
+
+AccessTrace::~AccessTrace ()
+{
+    out_.flush ();
+}
+
+void
+AccessTrace::record (Operation operation, uint256 const& hash,
+    NodeObjectType type, std::uint32_t size)
+{
+    auto const when = std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::steady_clock::now () - start_);
+
+    unsigned char buf[recordBytes];
+    putInteger (buf, when.count (), 8);
+    buf[8] = operation;
+    buf[9] = static_cast<unsigned char> (type);
+    putInteger (buf + 12, size, 4);
+    std::memcpy (buf + 16, hash.begin (), hash.size ());
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const thread = threads_.emplace (std::this_thread::get_id (),
+        static_cast<std::uint16_t> (threads_.size ())).first->second;
+    putInteger (buf + 10, thread, 2);
+    out_.write (reinterpret_cast<char const*> (buf), sizeof (buf));
+}
+
+std::vector<AccessTrace::Record>
+AccessTrace::read (std::string const& path)
+{
+    std::ifstream in (path, std::ios::binary);
+    if (! in)
+        Throw<std::runtime_error> ("Unable to open node store trace " + path);
+
+    std::vector<Record> records;
+    std::chrono::microseconds offset (0);
+    std::chrono::microseconds last (0);
+    unsigned char buf[recordBytes];
+    for (;;)
+    {
+        // A segment is the magic then its records.
+        if (! in.read (reinterpret_cast<char*> (buf), sizeof (traceMagic)))
+            break;
+        if (std::memcmp (buf, traceMagic, sizeof (traceMagic)) == 0)
+        {
+            offset = last;
+            continue;
+        }
+        if (! in.read (reinterpret_cast<char*> (buf) + sizeof (traceMagic),
+                recordBytes - sizeof (traceMagic)))
+            break;
+
+        Record record;
+        record.when = offset + std::chrono::microseconds (getInteger (buf, 8));
+        record.operation = static_cast<Operation> (buf[8]);
+        record.type = static_cast<NodeObjectType> (buf[9]);
+        record.thread = static_cast<std::uint16_t> (getInteger (buf + 10, 2));
+        record.size = static_cast<std::uint32_t> (getInteger (buf + 12, 4));
+        std::memcpy (record.hash.begin (), buf + 16, record.hash.size ());
+        if (record.operation > store)
+            Throw<std::runtime_error> ("Corrupt node store trace " + path);
+        last = record.when;
+        records.push_back (record);
+    }
+    return records;
+}
+
+}
+}
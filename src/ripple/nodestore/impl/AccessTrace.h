@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_NODESTORE_ACCESSTRACE_H_INCLUDED
+#define RIPPLE_NODESTORE_ACCESSTRACE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A file recording the fetches and stores made to a node store.
+
+    Each record holds the key, the operation, and the thread which made
+    it, so the trace can be replayed against another backend. The file
+    is appended to, records are written as they are made.
+*/
+class AccessTrace
+{
+public:
+    enum Operation : std::uint8_t
+    {
+        fetchSync = 0,
+        fetchAsync = 1,
+        store = 2
+    };
+
+    struct Record
+    {
+        // Since the trace was opened
+        std::chrono::microseconds when;
+        Operation operation;
+        NodeObjectType type;
+        // Numbered in the order the threads first appear
+        std::uint16_t thread;
+        // Of the stored or fetched object, 0 if unknown
+        std::uint32_t size;
+        uint256 hash;
+    };
+
+    /** Open the trace for writing. */
+    explicit
+    AccessTrace (std::string const& path);
+
+    ~AccessTrace ();
+
+    AccessTrace (AccessTrace const&) = delete;
+    AccessTrace& operator= (AccessTrace const&) = delete;
+
+    void
+    record (Operation operation, uint256 const& hash,
+        NodeObjectType type = hotUNKNOWN, std::uint32_t size = 0);
+
+    /** Read every record of a trace. */
+    static
+    std::vector<Record>
+    read (std::string const& path);
+
+private:
+    static std::size_t const recordBytes = 48;
+
+    std::mutex mutex_;
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point const start_;
+    std::map<std::thread::id, std::uint16_t> threads_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,165 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/BloomFilter.h>
+#include <ripple/basics/contract.h>
+#include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+static char const bloomMagic[8] = {'R', 'D', 'B', 'L', 'O', 'O', 'M', '1'};
+
+static_assert (sizeof (std::atomic<std::uint64_t>) == sizeof (std::uint64_t),
+    "BloomFilter maps its words as atomics");
+
+BloomFilter::BloomFilter (boost::filesystem::path const& path,
+        std::uint64_t megabytes, std::uint32_t hashes)
+    : path_ (path)
+    , complete_ (false)
+{
+    using namespace boost::interprocess;
+
+    auto const bits = std::max<std::uint64_t> (megabytes, 1) * 8 * 1024 * 1024;
+    auto const size = sizeof (Header) + bits / 8;
+
+    boost::system::error_code ec;
+    if (boost::filesystem::file_size (path_, ec) != size || ec)
+        create (bits, hashes);
+
+    file_mapping (path_.string ().c_str (), read_write).swap (file_);
+    mapped_region (file_, read_write, 0, size).swap (region_);
+
+    auto const h = header ();
+    if (std::memcmp (h->magic, bloomMagic, sizeof (bloomMagic)) != 0 ||
+        h->bits != bits || h->hashes != hashes)
+    {
+        mapped_region ().swap (region_);
+        file_mapping ().swap (file_);
+        create (bits, hashes);
+        file_mapping (path_.string ().c_str (), read_write).swap (file_);
+        mapped_region (file_, read_write, 0, size).swap (region_);
+    }
+    complete_ = header ()->complete != 0;
+}
+
+BloomFilter::~BloomFilter ()
+{
+    try
+    {
+        flush ();
+    }
+    catch (std::exception const&)
+    {
+    }
+}
+
+void
+BloomFilter::create (std::uint64_t bits, std::uint32_t hashes)
+{
+    Header h;
+    std::memcpy (h.magic, bloomMagic, sizeof (bloomMagic));
+    h.bits = bits;
+    h.hashes = hashes;
+    h.complete = 0;
+
+    {
+        std::ofstream out (path_.string ().c_str (),
+            std::ios::binary | std::ios::trunc);
+        if (!out.write (reinterpret_cast<char const*> (&h), sizeof (h)))
+            Throw<std::runtime_error> ("can not create " + path_.string ());
+    }
+
+    // The bit array is a sparse, zero filled extension of the file.
+    boost::filesystem::resize_file (path_, sizeof (h) + bits / 8);
+}
+
+template <class Function>
+void
+BloomFilter::forEachBit (uint256 const& key, Function&& f) const
+{
+    // Double hashing over two independent words of the key.
+    std::uint64_t h1, h2;
+    std::memcpy (&h1, key.data (), sizeof (h1));
+    std::memcpy (&h2, key.data () + sizeof (h1), sizeof (h2));
+    h2 |= 1;
+
+    auto const bits = header ()->bits;
+    for (std::uint32_t i = 0, n = header ()->hashes; i < n; ++i)
+    {
+        auto const bit = (h1 + i * h2) % bits;
+        if (!f (words ()[bit / 64], std::uint64_t (1) << (bit % 64)))
+            return;
+    }
+}
+
+void
+BloomFilter::insert (uint256 const& key)
+{
+    forEachBit (key, [](std::atomic<std::uint64_t>& word, std::uint64_t mask)
+    {
+        if ((word.load (std::memory_order_relaxed) & mask) == 0)
+            word.fetch_or (mask, std::memory_order_relaxed);
+        return true;
+    });
+}
+
+bool
+BloomFilter::mayContain (uint256 const& key) const
+{
+    bool found = true;
+    forEachBit (key, [&found](std::atomic<std::uint64_t>& word, std::uint64_t mask)
+    {
+        found = (word.load (std::memory_order_relaxed) & mask) != 0;
+        return found;
+    });
+    return found;
+}
+
+bool
+BloomFilter::complete () const
+{
+    return complete_;
+}
+
+void
+BloomFilter::setComplete ()
+{
+    // Every bit must reach the file before the flag does.
+    flush ();
+    header ()->complete = 1;
+    flush ();
+    complete_ = true;
+}
+
+void
+BloomFilter::flush ()
+{
+    if (region_.get_address ())
+        region_.flush ();
+}
+
+}
+}
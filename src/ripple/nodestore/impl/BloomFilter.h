@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_NODESTORE_BLOOMFILTER_H_INCLUDED
+#define RIPPLE_NODESTORE_BLOOMFILTER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A persistent Bloom filter of the keys in a backend.
+
+    The filter lives in a memory mapped file, so it survives restarts and
+    its pages are only loaded as they are used. A key the filter does not
+    hold is certainly not in the backend, a key it holds might be.
+
+    A new filter is empty and not complete: it must not be consulted
+    until every key already in the backend was added, see setComplete.
+    Keys stored meanwhile are added as usual.
+
+    Node keys are hashes, so the bit positions are taken from the key
+    itself rather than hashing it again.
+*/
+class BloomFilter
+{
+public:
+    /** Open the filter, creating it if it is missing or of another size.
+        @param megabytes Size of the bit array.
+        @param hashes Bits set for each key.
+    */
+    BloomFilter (boost::filesystem::path const& path,
+        std::uint64_t megabytes, std::uint32_t hashes);
+
+    ~BloomFilter ();
+
+    BloomFilter (BloomFilter const&) = delete;
+    BloomFilter& operator= (BloomFilter const&) = delete;
+
+    void
+    insert (uint256 const& key);
+
+    /** @return false if the key is certainly not in the backend. */
+    bool
+    mayContain (uint256 const& key) const;
+
+    /** @return true if the filter holds every key of the backend. */
+    bool
+    complete () const;
+
+    void
+    setComplete ();
+
+    /** Write the changed pages to the file. */
+    void
+    flush ();
+
+private:
+    struct Header
+    {
+        char magic[8];
+        std::uint64_t bits;
+        std::uint32_t hashes;
+        std::uint32_t complete;
+    };
+
+    void
+    create (std::uint64_t bits, std::uint32_t hashes);
+
+    Header*
+    header () const
+    {
+        return static_cast<Header*> (region_.get_address ());
+    }
+
+    std::atomic<std::uint64_t>*
+    words () const
+    {
+        return reinterpret_cast<std::atomic<std::uint64_t>*> (header () + 1);
+    }
+
+    template <class Function>
+    void
+    forEachBit (uint256 const& key, Function&& f) const;
+
+    boost::filesystem::path path_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::atomic<bool> complete_;
+};
+
+}
+}
+
+#endif
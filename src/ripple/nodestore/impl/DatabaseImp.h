@@ -22,16 +22,23 @@
 
 #include <ripple/nodestore/Database.h>
 #include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/impl/AccessTrace.h>
+#include <ripple/nodestore/impl/BloomFilter.h>
 #include <ripple/nodestore/impl/Tuning.h>
 #include <ripple/basics/KeyCache.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/protocol/digest.h>
 #include <ripple/basics/Slice.h>
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/contract.h>
 #include <beast/threads/Thread.h>
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <boost/thread.hpp>
@@ -49,27 +56,50 @@ private:
     std::unique_ptr <Backend> m_backend;
 protected:
     // Positive cache
-    TaggedCache <uint256, NodeObject> m_cache;
+    ShardedTaggedCache <uint256, NodeObject> m_cache;
 
     // Negative cache
     KeyCache <uint256> m_negCache;
 private:
+    // Keys recently read from or queued to the backend, whose stores
+    // need not be written again. Not kept when the backend rotates.
+    bool const                m_skipPersisted;
+    KeyCache <uint256>        m_persisted;
+
+    // Keys of the backend, consulted once complete
+    std::unique_ptr <BloomFilter> m_filter;
+    std::thread               m_filterThread;
+    std::atomic <bool>        m_filterStop;
+
+    // Records the fetches and stores made, for replaying them
+    std::unique_ptr <AccessTrace> m_trace;
+
     std::mutex                m_readLock;
     std::condition_variable   m_readCondVar;
     std::condition_variable   m_readGenCondVar;
     std::set <uint256>        m_readSet;        // set of reads to do
-    std::multimap<std::thread::id, std::set<uint256>> m_readSetBusy;
+    using BusyMap = std::multimap<std::thread::id, std::set<uint256>>;
+    BusyMap                   m_readSetBusy;    // batches being read
     std::map<std::thread::id, std::list<std::set<uint256>>> m_readSetWait;
+    std::set <uint256>        m_readPending;    // hashes waiting or busy
+    std::map<std::thread::id, std::set<uint256>> m_readSetJoined; // hashes read for another thread
+    std::size_t               m_batchLimit;     // size of the next batches
+    std::size_t               m_batchMaximum;
+    double                    m_batchRate;      // objects read per millisecond
     uint256                   m_readLast;       // last hash read
     std::vector <std::thread> m_readThreads;
     bool                      m_readShut;
     uint64_t                  m_readGen;        // current read generation
+    std::uint64_t             m_readsFinished;  // batches read
 public:
     DatabaseImp (std::string const& name,
                  Scheduler& scheduler,
                  int readThreads,
                  std::unique_ptr <Backend> backend,
-                 beast::Journal journal)
+                 beast::Journal journal,
+                 std::unique_ptr <BloomFilter> filter = nullptr,
+                 std::unique_ptr <AccessTrace> trace = nullptr,
+                 bool skipPersisted = true)
         : m_journal (journal)
         , m_scheduler (scheduler)
         , m_backend (std::move (backend))
@@ -77,21 +107,44 @@ public:
             stopwatch(), journal)
         , m_negCache ("NodeStore", stopwatch(),
             cacheTargetSize, cacheTargetSeconds)
+        , m_skipPersisted (skipPersisted)
+        , m_persisted ("NodeStorePersisted", stopwatch(),
+            cacheTargetSize, cacheTargetSeconds)
+        , m_filter (std::move (filter))
+        , m_filterStop (false)
+        , m_trace (std::move (trace))
         , m_readShut (false)
         , m_readGen (0)
+        , m_readsFinished (0)
+        , m_batchLimit (batchFetchInitial)
+        , m_batchMaximum (batchFetchInitial)
+        , m_batchRate (0)
         , m_storeCount (0)
+        , m_storeSkipCount (0)
         , m_fetchTotalCount (0)
         , m_fetchHitCount (0)
         , m_storeSize (0)
         , m_fetchSize (0)
     {
+        if (m_backend && m_backend->canFetchBatch ())
+        {
+            m_batchMaximum = std::max<std::size_t> (
+                m_backend->fetchBatchLimit (), batchFetchMinimum);
+            m_batchLimit = std::min (m_batchLimit, m_batchMaximum);
+        }
+
         for (int i = 0; i < readThreads; ++i)
             m_readThreads.push_back (std::thread (&DatabaseImp::threadEntry,
                     this));
+
+        if (m_filter && m_backend && !m_filter->complete ())
+            m_filterThread = std::thread (&DatabaseImp::rebuildFilter, this);
     }
 
     ~DatabaseImp ()
     {
+        stopFilter ();
+
         {
             std::unique_lock <std::mutex> lock (m_readLock);
             m_readShut = true;
@@ -101,6 +154,11 @@ public:
 
         for (auto& e : m_readThreads)
             e.join();
+
+        // Wait for the batches the backend is still reading.
+        std::unique_lock <std::mutex> lock (m_readLock);
+        while (!m_readSetBusy.empty ())
+            m_readGenCondVar.wait (lock);
     }
 
     std::string
@@ -109,9 +167,25 @@ public:
         return m_backend->getName ();
     }
 
+    void
+    setThreadAffinity (CpuSet const& cpus) override
+    {
+        for (auto& t : m_readThreads)
+        {
+            if (! ripple::setThreadAffinity (t, cpus))
+            {
+                m_journal.warning << "Unable to set the processors of "
+                    "the prefetch threads";
+                break;
+            }
+        }
+    }
+
     void
     close() override
     {
+        stopFilter ();
+
         if (m_backend)
         {
             m_backend->close();
@@ -121,8 +195,61 @@ public:
 
     //------------------------------------------------------------------------------
 
+    /** @return true if the filter tells the backend lacks the object. */
+    bool filtered (uint256 const& hash) const
+    {
+        return m_filter && m_filter->complete () && !m_filter->mayContain (hash);
+    }
+
+    struct FilterStopped : std::exception
+    {
+    };
+
+    /** Add every key of the backend to a new filter. */
+    void rebuildFilter ()
+    {
+        beast::Thread::setCurrentThreadName ("bloom rebuild");
+
+        m_journal.info << "Rebuilding the key filter of " << getName ();
+        std::uint64_t count = 0;
+        try
+        {
+            m_backend->for_each ([&](std::shared_ptr<NodeObject> object)
+            {
+                if (m_filterStop)
+                    Throw<FilterStopped> ();
+                m_filter->insert (object->getHash ());
+                if ((++count % 1000000) == 0)
+                    m_journal.debug << "Key filter rebuild at " << count << " keys";
+            });
+        }
+        catch (FilterStopped const&)
+        {
+            m_journal.info << "Key filter rebuild stopped after " << count << " keys";
+            return;
+        }
+        catch (std::exception const& e)
+        {
+            m_journal.error << "Key filter rebuild failed: " << e.what ();
+            return;
+        }
+
+        m_filter->setComplete ();
+        m_journal.info << "Key filter rebuilt with " << count << " keys";
+    }
+
+    void stopFilter ()
+    {
+        m_filterStop = true;
+        if (m_filterThread.joinable ())
+            m_filterThread.join ();
+    }
+
     bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) override
     {
+        if (m_trace)
+            m_trace->record (AccessTrace::fetchAsync, hash);
+
         // See if the object is in cache
         object = m_cache.fetch (hash);
         if (object || m_negCache.touch_if_exists (hash))
@@ -133,12 +260,19 @@ public:
             std::unique_lock <std::mutex> lock (m_readLock);
             if (m_backend && m_backend->canFetchBatch ())
             {
-                auto& readSetList = m_readSetWait[std::this_thread::get_id ()];
-                if (readSetList.empty () || readSetList.back ().size () >= m_backend->fetchBatchLimit ())
+                auto const threadId = std::this_thread::get_id ();
+                if (!m_readPending.insert (hash).second)
+                {
+                    // Already asked for, only wait for that read.
+                    m_readSetJoined[threadId].insert (hash);
+                    return false;
+                }
+
+                auto& readSetList = m_readSetWait[threadId];
+                if (readSetList.empty () || readSetList.back ().size () >= m_batchLimit)
                     readSetList.push_back ({});
-                auto& readSet = readSetList.back ();
-                if (readSet.insert (hash).second)
-                    m_readCondVar.notify_one ();
+                readSetList.back ().insert (hash);
+                m_readCondVar.notify_one ();
                 return false;
             }
             if (m_readSet.insert (hash).second)
@@ -155,7 +289,7 @@ public:
             if (m_backend && m_backend->canFetchBatch ())
             {
                 auto threadId = std::this_thread::get_id ();
-                while (!m_readShut && (m_readSetWait.count (threadId) > 0 || m_readSetBusy.count (threadId) > 0))
+                while (!m_readShut && readsPending (threadId))
                     m_readGenCondVar.wait (lock);
                 return;
             }
@@ -169,6 +303,47 @@ public:
 
     }
 
+    void waitSomeReads() override
+    {
+        {
+            std::unique_lock <std::mutex> lock (m_readLock);
+            if (m_backend && m_backend->canFetchBatch ())
+            {
+                auto const threadId = std::this_thread::get_id ();
+                auto const finished = m_readsFinished;
+                while (!m_readShut && readsPending (threadId) &&
+                        m_readsFinished == finished)
+                    m_readGenCondVar.wait (lock);
+                return;
+            }
+        }
+
+        waitReads ();
+    }
+
+    /** @return true if a thread still waits for batched reads.
+        The lock must be held.
+    */
+    bool readsPending (std::thread::id threadId)
+    {
+        if (m_readSetWait.count (threadId) > 0 || m_readSetBusy.count (threadId) > 0)
+            return true;
+
+        auto it = m_readSetJoined.find (threadId);
+        if (it == m_readSetJoined.end ())
+            return false;
+
+        auto& joined = it->second;
+        for (auto iter = joined.begin (); iter != joined.end ();)
+        {
+            if (m_readPending.count (*iter) > 0)
+                return true;
+            iter = joined.erase (iter);
+        }
+        m_readSetJoined.erase (it);
+        return false;
+    }
+
     int getDesiredAsyncReadCount () override
     {
         // We prefer a client not fill our cache
@@ -179,7 +354,16 @@ public:
 
     std::shared_ptr<NodeObject> fetch (uint256 const& hash) override
     {
-        return doTimedFetch (hash, false);
+        auto object = doTimedFetch (hash, false);
+        if (m_trace)
+        {
+            if (object)
+                m_trace->record (AccessTrace::fetchSync, hash, object->getType (),
+                    static_cast<std::uint32_t> (object->getData ().size ()));
+            else
+                m_trace->record (AccessTrace::fetchSync, hash);
+        }
+        return object;
     }
 
     /** Perform a fetch and report the time it took */
@@ -200,7 +384,10 @@ public:
         return ret;
     }
 
-    void doTimedFetch (std::set<uint256>& hashes)
+    /** Remove the hashes found in the caches.
+        @return true if some hashes must be read from the backend.
+    */
+    bool filterCached (std::set<uint256>& hashes)
     {
         FetchReport report;
         report.isAsync = true;
@@ -212,39 +399,46 @@ public:
             auto const before = std::chrono::steady_clock::now ();
             auto obj = m_cache.fetch (*it);
 
-            if (obj != nullptr || m_negCache.touch_if_exists (*it))
+            if (obj == nullptr && !m_negCache.touch_if_exists (*it))
             {
-                it = hashes.erase (it);
-
-                report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
-                    std::chrono::steady_clock::now () - before);
-                report.wasFound = (obj != nullptr);
+                if (!filtered (*it))
+                {
+                    ++it;
+                    continue;
+                }
 
-                m_scheduler.onFetch (report);
+                // Never stored, skip the backend.
+                m_negCache.insert (*it);
             }
-            else
-                ++it;
-        }
 
-        if (hashes.empty ())
-            return;
+            it = hashes.erase (it);
 
-        // Check the database(s). Fast backend is ignored.
+            report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+                std::chrono::steady_clock::now () - before);
+            report.wasFound = (obj != nullptr);
 
+            m_scheduler.onFetch (report);
+        }
+
+        return !hashes.empty ();
+    }
+
+    /** Cache the result of a batch read from the backend.
+        @param elapsed The time the read took for each object.
+    */
+    void onFetched (std::vector<std::shared_ptr<NodeObject>>& objects,
+        std::set<uint256> const& hashesNotFound,
+            std::chrono::milliseconds elapsed)
+    {
+        FetchReport report;
+        report.isAsync = true;
         report.wentToDisk = true;
-        auto before = std::chrono::steady_clock::now ();
-        std::vector<std::shared_ptr<NodeObject>> objects;
-        std::set<uint256> hashesNotFound;
-        std::tie (objects, hashesNotFound) = m_backend->fetchBatch (hashes);
-        std::chrono::milliseconds const elapsed =
-            std::chrono::duration_cast<std::chrono::milliseconds> (
-                std::chrono::steady_clock::now () - before) /
-            hashes.size ();
 
         for (auto& obj : objects)
         {
-            before = std::chrono::steady_clock::now ();
+            auto const before = std::chrono::steady_clock::now ();
             m_cache.canonicalize (obj->getHash (), obj);
+            persisted (obj->getHash ());
             report.elapsed = elapsed + std::chrono::duration_cast<std::chrono::milliseconds> (
                                            std::chrono::steady_clock::now () - before);
             report.wasFound = true;
@@ -258,7 +452,7 @@ public:
         
         for (auto& hash : hashesNotFound)
         {
-            before = std::chrono::steady_clock::now ();
+            auto const before = std::chrono::steady_clock::now ();
             // Just in case a write occurred
             if (m_cache.fetch (hash) == nullptr)
             {
@@ -276,6 +470,100 @@ public:
         }
     }
 
+    void doTimedFetch (std::set<uint256> hashes)
+    {
+        if (!filterCached (hashes))
+            return;
+
+        // Check the database(s). Fast backend is ignored.
+
+        auto const before = std::chrono::steady_clock::now ();
+        std::vector<std::shared_ptr<NodeObject>> objects;
+        std::set<uint256> hashesNotFound;
+        std::tie (objects, hashesNotFound) = m_backend->fetchBatch (hashes);
+        auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+            std::chrono::steady_clock::now () - before);
+        onFetched (objects, hashesNotFound, elapsed / hashes.size ());
+        onBatchFetched (hashes.size (), objects.size (), elapsed);
+    }
+
+    /** Read a batch without blocking, the batch stays busy until the
+        backend calls back.
+    */
+    void doAsyncFetch (BusyMap::iterator itBusy)
+    {
+        auto hashes = itBusy->second;
+        if (!filterCached (hashes))
+        {
+            finishRead (itBusy);
+            return;
+        }
+
+        auto const before = std::chrono::steady_clock::now ();
+        auto const count = hashes.size ();
+        m_backend->fetchBatchAsync (hashes,
+            [this, itBusy, before, count] (
+                std::vector<std::shared_ptr<NodeObject>> objects,
+                    std::set<uint256> hashesNotFound)
+            {
+                auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+                    std::chrono::steady_clock::now () - before);
+                onFetched (objects, hashesNotFound, elapsed / count);
+                onBatchFetched (count, objects.size (), elapsed);
+                finishRead (itBusy);
+            });
+    }
+
+    /** Size the next batches from the latency and throughput of a read.
+
+        Full batches grow while they return well within the target latency
+        and move at least as many objects per millisecond as the batches
+        before them. A batch over the target, or a full batch much slower
+        than the average, means the backend is busy and halves the size.
+    */
+    void onBatchFetched (std::size_t count, std::size_t found,
+        std::chrono::milliseconds elapsed)
+    {
+        BatchFetchReport report;
+        report.elapsed = elapsed;
+        report.fetchCount = static_cast<int> (count);
+        report.foundCount = static_cast<int> (found);
+
+        {
+            std::unique_lock<std::mutex> lock (m_readLock);
+
+            auto const ms = std::max<std::chrono::milliseconds::rep> (elapsed.count (), 1);
+            auto const rate = static_cast<double> (count) / ms;
+            bool const full = count >= m_batchLimit;
+            bool const slow = full && rate < m_batchRate / 2;
+            m_batchRate = (m_batchRate == 0) ? rate : (m_batchRate * 7 + rate) / 8;
+
+            if (ms > batchFetchTargetLatency || slow)
+            {
+                m_batchLimit = std::max<std::size_t> (
+                    m_batchLimit / 2, batchFetchMinimum);
+            }
+            else if (full && ms < batchFetchTargetLatency / 2)
+            {
+                m_batchLimit = std::min (
+                    m_batchLimit + m_batchLimit / 4, m_batchMaximum);
+            }
+            report.batchLimit = static_cast<int> (m_batchLimit);
+        }
+
+        m_scheduler.onBatchFetch (report);
+    }
+
+    void finishRead (BusyMap::iterator itBusy)
+    {
+        std::unique_lock<std::mutex> lock (m_readLock);
+        for (auto const& hash : itBusy->second)
+            m_readPending.erase (hash);
+        m_readSetBusy.erase (itBusy);
+        ++m_readsFinished;
+        m_readGenCondVar.notify_all ();
+    }
+
     std::shared_ptr<NodeObject> doFetch (uint256 const& hash, FetchReport &report)
     {
         // See if the object already exists in the cache
@@ -288,9 +576,17 @@ public:
         if (m_negCache.touch_if_exists (hash))
             return obj;
 
+        if (filtered (hash))
+        {
+            // Never stored, skip the backend.
+            m_negCache.insert (hash);
+            return obj;
+        }
+
         // Check the database(s).
 
         report.wentToDisk = true;
+        bool late = false;
 
         // Are we still without an object?
         //
@@ -298,11 +594,17 @@ public:
         {
             // Yes so at last we will try the main database.
             //
-            obj = fetchFrom (hash);
+            obj = fetchFrom (hash, late);
             ++m_fetchTotalCount;
         }
 
-        if (obj == nullptr)
+        if (obj == nullptr && late)
+        {
+            // The backend gave up in time, the object may still exist
+            if (m_journal.debug) m_journal.debug <<
+                "HOS: " << hash << " fetch: retry later";
+        }
+        else if (obj == nullptr)
         {
 
             // Just in case a write occurred
@@ -319,6 +621,7 @@ public:
             // Ensure all threads get the same object
             //
             m_cache.canonicalize (hash, obj);
+            persisted (hash);
 
             // Since this was a 'hard' fetch, we will log it.
             //
@@ -329,13 +632,17 @@ public:
         return obj;
     }
 
-    virtual std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash)
+    /** Read an object from the backend(s).
+        @param late [out] Set if a read was abandoned at its deadline.
+    */
+    virtual std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash,
+        bool& late)
     {
-        return fetchInternal (*m_backend, hash);
+        return fetchInternal (*m_backend, hash, late);
     }
 
     std::shared_ptr<NodeObject> fetchInternal (Backend& backend,
-        uint256 const& hash)
+        uint256 const& hash, bool& late)
     {
         std::shared_ptr<NodeObject> object;
 
@@ -350,6 +657,10 @@ public:
         case notFound:
             break;
 
+        case retryLater:
+            late = true;
+            break;
+
         case dataCorrupt:
             // VFALCO TODO Deal with encountering corrupt data!
             //
@@ -372,6 +683,10 @@ public:
                 Blob&& data,
                 uint256 const& hash) override
     {
+        if (m_trace)
+            m_trace->record (AccessTrace::store, hash, type,
+                static_cast<std::uint32_t> (data.size ()));
+
         storeInternal (type, std::move(data), hash, *m_backend.get());
     }
 
@@ -389,12 +704,31 @@ public:
 
         m_cache.canonicalize (hash, object, true);
 
+        // Already read from or written to the backend, so unchanged there
+        if (m_skipPersisted && m_persisted.touch_if_exists (hash))
+        {
+            ++m_storeSkipCount;
+            return;
+        }
+
+        // Before the backend, a fetch must not be filtered once stored.
+        if (m_filter)
+            m_filter->insert (hash);
+
         backend.store (object);
         ++m_storeCount;
         if (object)
             m_storeSize += object->getData().size();
 
         m_negCache.erase (hash);
+        persisted (hash);
+    }
+
+    /** Note that the backend holds an object. */
+    void persisted (uint256 const& hash)
+    {
+        if (m_skipPersisted)
+            m_persisted.insert (hash);
     }
 
     //------------------------------------------------------------------------------
@@ -404,18 +738,43 @@ public:
         return m_cache.getHitRate ();
     }
 
+    std::pair <std::uint64_t, std::uint64_t> getCacheHitsAndMisses () override
+    {
+        return m_cache.getHitsAndMisses ();
+    }
+
+    int getCacheSize () override
+    {
+        return m_cache.getCacheSize ();
+    }
+
+    std::vector<uint256> getCacheKeys () override
+    {
+        return m_cache.getKeys ();
+    }
+
+    void setCacheSize (int size) override
+    {
+        m_cache.setTargetSize (size);
+        m_negCache.setTargetSize (size);
+        m_persisted.setTargetSize (size);
+    }
+
     void tune (int size, int age) override
     {
         m_cache.setTargetSize (size);
         m_cache.setTargetAge (age);
         m_negCache.setTargetSize (size);
         m_negCache.setTargetAge (age);
+        m_persisted.setTargetSize (size);
+        m_persisted.setTargetAge (age);
     }
 
     void sweep () override
     {
         m_cache.sweep ();
         m_negCache.sweep ();
+        m_persisted.sweep ();
     }
 
     std::int32_t getWriteLoad() const override
@@ -434,7 +793,7 @@ public:
         {
             while (1)
             {
-                std::multimap<std::thread::id, std::set<uint256>>::iterator itBusy;
+                BusyMap::iterator itBusy;
 
                 {
                     std::unique_lock<std::mutex> lock (m_readLock);
@@ -457,13 +816,15 @@ public:
                         m_readSetWait.erase (itWait);
                 }
 
-                doTimedFetch (itBusy->second);
-
+                if (m_backend->canFetchAsync ())
                 {
-                    std::unique_lock<std::mutex> lock (m_readLock);
-                    m_readSetBusy.erase (itBusy);
-                    m_readGenCondVar.notify_all ();
+                    // The backend bounds the reads in flight.
+                    doAsyncFetch (itBusy);
+                    continue;
                 }
+
+                doTimedFetch (itBusy->second);
+                finishRead (itBusy);
             }
             return;
         }
@@ -518,28 +879,130 @@ public:
         importInternal (source, *m_backend.get());
     }
 
+    /** Copy every object of a database into a backend.
+
+        Full batches are written to the backend directly, by a thread of
+        their own, while the source goes on scanning. The scan waits when
+        too many batches are waiting to be written.
+    */
     void importInternal (Database& source, Backend& dest)
     {
-        Batch b;
-        b.reserve (batchWritePreallocationSize);
+        using clock_type = std::chrono::steady_clock;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<Batch> queue;
+        bool finished = false;
+        std::exception_ptr error;
+
+        std::thread writer ([&]()
+        {
+            beast::Thread::setCurrentThreadName ("import write");
+            std::unique_lock<std::mutex> lock (mutex);
+            for (;;)
+            {
+                cond.wait (lock, [&] { return finished || !queue.empty (); });
+                if (queue.empty ())
+                    break;
+                auto const batch = std::move (queue.front ());
+                queue.pop_front ();
+                cond.notify_all ();
+                lock.unlock ();
+                try
+                {
+                    dest.storeBatch (batch);
+                }
+                catch (...)
+                {
+                    lock.lock ();
+                    error = std::current_exception ();
+                    cond.notify_all ();
+                    break;
+                }
+                lock.lock ();
+            }
+        });
 
-        source.for_each ([&](std::shared_ptr<NodeObject> object)
+        auto const finish = [&]()
         {
-            if (b.size() >= batchWritePreallocationSize)
             {
-                dest.storeBatch (b);
-                b.clear();
-                b.reserve (batchWritePreallocationSize);
+                std::lock_guard<std::mutex> lock (mutex);
+                finished = true;
             }
+            cond.notify_all ();
+            writer.join ();
+        };
 
-            b.push_back (object);
-            ++m_storeCount;
-            if (object)
+        auto const push = [&](Batch& b)
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            cond.wait (lock, [&] {
+                return error || queue.size () < importQueueBatches; });
+            if (error)
+                std::rethrow_exception (error);
+            queue.push_back (std::move (b));
+            cond.notify_all ();
+            b.clear ();
+            b.reserve (importBatchSize);
+        };
+
+        auto const started = clock_type::now ();
+        auto lastReport = started;
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+
+        auto const report = [&](char const* what, clock_type::time_point now)
+        {
+            auto const seconds = std::max<std::int64_t> (1,
+                std::chrono::duration_cast<std::chrono::seconds> (
+                    now - started).count ());
+            m_journal.info << what << count << " objects, " <<
+                (bytes >> 20) << " MB, " << count / seconds <<
+                    " objects/s over " << seconds << "s";
+        };
+
+        Batch b;
+        b.reserve (importBatchSize);
+        try
+        {
+            source.for_each ([&](std::shared_ptr<NodeObject> object)
+            {
+                if (! object)
+                    return;
+
+                if (m_filter)
+                    m_filter->insert (object->getHash ());
+                ++m_storeCount;
                 m_storeSize += object->getData().size();
-        });
+                ++count;
+                bytes += object->getData().size();
+
+                b.push_back (std::move (object));
+                if (b.size () < importBatchSize)
+                    return;
+                push (b);
+
+                auto const now = clock_type::now ();
+                if (now - lastReport >= std::chrono::seconds (importReportSeconds))
+                {
+                    report ("Imported ", now);
+                    lastReport = now;
+                }
+            });
+
+            if (! b.empty ())
+                push (b);
+        }
+        catch (...)
+        {
+            finish ();
+            throw;
+        }
 
-        if (! b.empty())
-            dest.storeBatch (b);
+        finish ();
+        if (error)
+            std::rethrow_exception (error);
+        report ("Import complete: ", clock_type::now ());
     }
 
     std::uint32_t getStoreCount () const override
@@ -547,6 +1010,11 @@ public:
         return m_storeCount;
     }
 
+    std::uint32_t getStoreSkipCount () const override
+    {
+        return m_storeSkipCount;
+    }
+
     std::uint32_t getFetchTotalCount () const override
     {
         return m_fetchTotalCount;
@@ -569,6 +1037,7 @@ public:
 
 private:
     std::atomic <std::uint32_t> m_storeCount;
+    std::atomic <std::uint32_t> m_storeSkipCount;
     std::atomic <std::uint32_t> m_fetchTotalCount;
     std::atomic <std::uint32_t> m_fetchHitCount;
     std::atomic <std::uint32_t> m_storeSize;
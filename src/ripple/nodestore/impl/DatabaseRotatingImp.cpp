@@ -34,13 +34,15 @@ std::shared_ptr <Backend> DatabaseRotatingImp::rotateBackends (
     return oldBackend;
 }
 
-std::shared_ptr<NodeObject> DatabaseRotatingImp::fetchFrom (uint256 const& hash)
+std::shared_ptr<NodeObject> DatabaseRotatingImp::fetchFrom (uint256 const& hash,
+    bool& late)
 {
     Backends b = getBackends();
-    std::shared_ptr<NodeObject> object = fetchInternal (*b.writableBackend, hash);
+    std::shared_ptr<NodeObject> object = fetchInternal (*b.writableBackend,
+        hash, late);
     if (!object)
     {
-        object = fetchInternal (*b.archiveBackend, hash);
+        object = fetchInternal (*b.archiveBackend, hash, late);
         if (object)
         {
             getWritableBackend()->store (object);
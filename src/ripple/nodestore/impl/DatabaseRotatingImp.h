@@ -58,7 +58,10 @@ public:
                 scheduler,
                 readThreads,
                 std::unique_ptr <Backend>(),
-                journal)
+                journal,
+                nullptr,
+                nullptr,
+                false)
             , writableBackend_ (writableBackend)
             , archiveBackend_ (archiveBackend)
     {}
@@ -121,11 +124,13 @@ public:
 
     std::shared_ptr<NodeObject> fetchNode (uint256 const& hash) override
     {
-        return fetchFrom (hash);
+        bool late = false;
+        return fetchFrom (hash, late);
     }
 
-    std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash) override;
-    TaggedCache <uint256, NodeObject>& getPositiveCache() override
+    std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash,
+        bool& late) override;
+    ShardedTaggedCache <uint256, NodeObject>& getPositiveCache() override
     {
         return m_cache;
     }
@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
 #include <beast/ByteOrder.h>
 #include <algorithm>
 
@@ -35,6 +36,10 @@ DecodedBlob::DecodedBlob (void const* key, void const* value, int valueBytes)
         4...7       Unused?         An unused copy of the LedgerIndex
         8           char            One of NodeObjectType
         9...end                     The body of the object data
+
+        A compressed blob has zeros in bytes 0 to 3 and the blobMagic
+        bytes in 4 and 5. Byte 6 is the blobVersion, byte 7 one of
+        BlobCodec, and the rest is the blob above, compressed.
     */
 
     m_success = false;
@@ -50,6 +55,15 @@ DecodedBlob::DecodedBlob (void const* key, void const* value, int valueBytes)
     {
         unsigned char const* byte = static_cast <unsigned char const*> (value);
         m_objectType = static_cast <NodeObjectType> (byte [8]);
+
+        if (byte [0] == 0 && byte [1] == 0 && byte [2] == 0 && byte [3] == 0 &&
+            byte [4] == blobMagic0 && byte [5] == blobMagic1)
+        {
+            if (byte [6] != blobVersion ||
+                    ! decompress (static_cast <BlobCodec> (byte [7]),
+                        byte + 9, valueBytes - 9, value, valueBytes))
+                return;
+        }
     }
 
     if (valueBytes > 9)
@@ -71,6 +85,46 @@ DecodedBlob::DecodedBlob (void const* key, void const* value, int valueBytes)
     }
 }
 
+bool
+DecodedBlob::decompress (BlobCodec codec, void const* in, std::size_t inBytes,
+    void const*& value, int& valueBytes)
+{
+    auto const out = [this](std::size_t n)
+    {
+        m_buffer.resize (n);
+        return m_buffer.data ();
+    };
+
+    std::pair<void const*, std::size_t> result;
+    try
+    {
+        switch (codec)
+        {
+        case BlobCodec::lz4:
+            result = detail::lz4_decompress (in, inBytes, out);
+            break;
+
+        case BlobCodec::inner:
+            result = detail::nodeobject_decompress (in, inBytes, out);
+            break;
+
+        default:
+            return false;
+        }
+    }
+    catch (beast::nudb::codec_error const&)
+    {
+        return false;
+    }
+
+    // The type is taken from the header, the inner node codec does not
+    // keep it.
+    value = result.first;
+    valueBytes = static_cast <int> (result.second);
+    m_dataBytes = std::max (0, valueBytes - 9);
+    return true;
+}
+
 std::shared_ptr<NodeObject> DecodedBlob::createObject ()
 {
     bassert (m_success);
@@ -79,10 +133,8 @@ std::shared_ptr<NodeObject> DecodedBlob::createObject ()
 
     if (m_success)
     {
-        Blob data(m_objectData, m_objectData + m_dataBytes);
-
-        object = NodeObject::createObject (
-            m_objectType, std::move(data), uint256::fromVoid(m_key));
+        object = NodeObject::createObject (m_objectType,
+            Slice (m_objectData, m_dataBytes), uint256::fromVoid(m_key));
     }
 
     return object;
@@ -21,6 +21,7 @@
 #define RIPPLE_NODESTORE_DECODEDBLOB_H_INCLUDED
 
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -48,12 +49,18 @@ public:
     std::shared_ptr<NodeObject> createObject ();
 
 private:
+    bool decompress (BlobCodec codec, void const* in, std::size_t inBytes,
+        void const*& value, int& valueBytes);
+
     bool m_success;
 
     void const* m_key;
     NodeObjectType m_objectType;
     unsigned char const* m_objectData;
     int m_dataBytes;
+
+    // The uncompressed blob, when it was compressed.
+    Blob m_buffer;
 };
 
 }
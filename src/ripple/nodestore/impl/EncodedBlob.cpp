@@ -19,11 +19,68 @@
 
 #include <BeastConfig.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
 #include <beast/ByteOrder.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
 namespace ripple {
 namespace NodeStore {
 
+BlobCodecs::BlobCodecs (BlobCodec codec)
+{
+    m_codecs.fill (codec);
+}
+
+BlobCodecs::BlobCodecs (Section const& keyValues, BlobCodec codec)
+{
+    auto const parse = [&keyValues](std::string const& key, BlobCodec codec)
+    {
+        auto const name = ripple::get<std::string> (keyValues, key);
+        if (name.empty ())
+            return codec;
+        if (name == "none")
+            return BlobCodec::none;
+        if (name == "lz4")
+            return BlobCodec::lz4;
+        if (name == "inner")
+            return BlobCodec::inner;
+        Throw<std::runtime_error> ("Invalid " + key + " in node store: " + name);
+        return codec;
+    };
+
+    codec = parse ("codec", codec);
+    m_codecs.fill (codec);
+    set (hotUNKNOWN, parse ("codec_unknown", codec));
+    set (hotLEDGER, parse ("codec_ledger", codec));
+    set (hotACCOUNT_NODE, parse ("codec_account_node", codec));
+    set (hotTRANSACTION_NODE, parse ("codec_transaction_node", codec));
+}
+
+BlobCodec
+BlobCodecs::get (NodeObjectType type) const
+{
+    if (type < 0 || type >= m_codecs.size ())
+        return BlobCodec::none;
+    return m_codecs[type];
+}
+
+void
+BlobCodecs::set (NodeObjectType type, BlobCodec codec)
+{
+    m_codecs.at (type) = codec;
+}
+
+bool
+BlobCodecs::compresses () const
+{
+    return std::any_of (m_codecs.begin (), m_codecs.end (),
+        [](BlobCodec codec) { return codec != BlobCodec::none; });
+}
+
+//------------------------------------------------------------------------------
+
 void
 EncodedBlob::prepare (std::shared_ptr<NodeObject> const& object)
 {
@@ -51,5 +108,50 @@ EncodedBlob::prepare (std::shared_ptr<NodeObject> const& object)
     }
 }
 
+void
+EncodedBlob::prepare (std::shared_ptr<NodeObject> const& object,
+    BlobCodecs const& codecs)
+{
+    auto const codec = codecs.get (object->getType ());
+    if (codec == BlobCodec::none)
+    {
+        prepare (object);
+        return;
+    }
+
+    // The codecs compress the uncompressed blob, so the inner node codec
+    // sees the layout it expects.
+    m_data.swapWith (m_flat);
+    prepare (object);
+    m_data.swapWith (m_flat);
+
+    auto const out = [this](std::size_t n)
+    {
+        m_data.ensureSize (9 + n);
+        return static_cast<unsigned char*> (m_data.getData ()) + 9;
+    };
+    std::size_t size;
+    if (codec == BlobCodec::lz4)
+        size = detail::lz4_compress (m_flat.getData (), m_size, out).second;
+    else
+        size = detail::nodeobject_compress (m_flat.getData (), m_size, out).second;
+
+    if (size >= object->getData ().size ())
+    {
+        prepare (object);
+        return;
+    }
+
+    unsigned char* buf = static_cast <
+        unsigned char*> (m_data.getData ());
+    std::memset (buf, 0, 4);
+    buf [4] = blobMagic0;
+    buf [5] = blobMagic1;
+    buf [6] = blobVersion;
+    buf [7] = static_cast <unsigned char> (codec);
+    buf [8] = static_cast <unsigned char> (object->getType ());
+    m_size = 9 + size;
+}
+
 }
 }
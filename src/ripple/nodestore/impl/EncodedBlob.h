@@ -20,13 +20,63 @@
 #ifndef RIPPLE_NODESTORE_ENCODEDBLOB_H_INCLUDED
 #define RIPPLE_NODESTORE_ENCODEDBLOB_H_INCLUDED
 
+#include <ripple/basics/BasicConfig.h>
 #include <ripple/nodestore/NodeObject.h>
 #include <beast/module/core/memory/MemoryBlock.h>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 
 namespace ripple {
 namespace NodeStore {
 
+/** How the body of a stored object is compressed. */
+enum class BlobCodec : std::uint8_t
+{
+    none = 0,
+    lz4 = 1,
+
+    // Inner nodes without their empty branches, lz4 for other objects.
+    inner = 2
+};
+
+/** Bytes 4 and 5 of a compressed blob, followed by the format version.
+    Uncompressed blobs have zeros there.
+*/
+std::uint8_t const blobMagic0 = 'N';
+std::uint8_t const blobMagic1 = 'S';
+std::uint8_t const blobVersion = 1;
+
+/** The codec used for each type of NodeObject. */
+class BlobCodecs
+{
+public:
+    /** Use the same codec for every type. */
+    explicit
+    BlobCodecs (BlobCodec codec = BlobCodec::none);
+
+    /** Read the codec and codec_<type> keys of a backend.
+        The types are ledger, account_node, transaction_node and unknown.
+        @param codec The codec of types without a key.
+    */
+    explicit
+    BlobCodecs (Section const& keyValues,
+        BlobCodec codec = BlobCodec::lz4);
+
+    BlobCodec
+    get (NodeObjectType type) const;
+
+    void
+    set (NodeObjectType type, BlobCodec codec);
+
+    /** Return `true` if any type is compressed. */
+    bool
+    compresses () const;
+
+private:
+    std::array<BlobCodec, hotTRANSACTION_NODE + 1> m_codecs;
+};
+
 /** Utility for producing flattened node objects.
     @note This defines the database format of a NodeObject!
 */
@@ -34,7 +84,15 @@ namespace NodeStore {
 struct EncodedBlob
 {
 public:
+    /** Flatten an object without compressing it. */
     void prepare (std::shared_ptr<NodeObject> const& object);
+
+    /** Flatten an object, compressed with the codec of its type.
+        An object that does not get smaller is stored uncompressed.
+    */
+    void prepare (std::shared_ptr<NodeObject> const& object,
+        BlobCodecs const& codecs);
+
     void const* getKey () const noexcept { return m_key; }
     std::size_t getSize () const noexcept { return m_size; }
     void const* getData () const noexcept { return m_data.getData (); }
@@ -42,6 +100,7 @@ public:
 private:
     void const* m_key;
     beast::MemoryBlock m_data;
+    beast::MemoryBlock m_flat;
     std::size_t m_size;
 };
 
@@ -0,0 +1,58 @@
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/FetchLatency.h>
+#include <algorithm>
+
+namespace ripple {
+namespace NodeStore {
+
+std::size_t const FetchLatency::refreshInterval;
+std::size_t const FetchLatency::minimumSamples;
+
+FetchLatency::FetchLatency (std::size_t capacity)
+    : capacity_ (std::max<std::size_t> (capacity, minimumSamples))
+{
+    samples_.reserve (capacity_);
+}
+
+bool
+FetchLatency::record (std::chrono::microseconds elapsed)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (samples_.size () < capacity_)
+        samples_.push_back (elapsed);
+    else
+        samples_[next_] = elapsed;
+    next_ = (next_ + 1) % capacity_;
+
+    // Until the first refresh, every sample counts
+    if (++sinceRefresh_ < refreshInterval &&
+            (! sorted_.empty () || samples_.size () < minimumSamples))
+        return false;
+
+    sinceRefresh_ = 0;
+    sorted_ = samples_;
+    std::sort (sorted_.begin (), sorted_.end ());
+    return true;
+}
+
+std::chrono::microseconds
+FetchLatency::percentile (int percent) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (sorted_.empty ())
+        return std::chrono::microseconds (0);
+    percent = std::min (std::max (percent, 0), 100);
+    auto const index = std::min (sorted_.size () - 1,
+        sorted_.size () * percent / 100);
+    return sorted_[index];
+}
+
+std::size_t
+FetchLatency::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return samples_.size ();
+}
+
+}
+}
@@ -0,0 +1,61 @@
+#ifndef RIPPLE_NODESTORE_FETCHLATENCY_H_INCLUDED
+#define RIPPLE_NODESTORE_FETCHLATENCY_H_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** The latency of the most recent reads of a backend.
+
+    The samples are kept in a ring. Percentiles are taken from a sorted
+    copy, which is only refreshed every few samples so that asking for
+    one on every read costs no more than a lookup.
+*/
+class FetchLatency
+{
+public:
+    // Samples between two refreshes of the percentiles
+    static std::size_t const refreshInterval = 128;
+
+    // Samples needed before percentiles are given
+    static std::size_t const minimumSamples = 64;
+
+    explicit
+    FetchLatency (std::size_t capacity = 1024);
+
+    FetchLatency (FetchLatency const&) = delete;
+    FetchLatency& operator= (FetchLatency const&) = delete;
+
+    /** Adds the latency of a read.
+        @return true if the percentiles were refreshed.
+    */
+    bool
+    record (std::chrono::microseconds elapsed);
+
+    /** The latency under which the given percent of the reads completed.
+        @return zero until there are enough samples.
+    */
+    std::chrono::microseconds
+    percentile (int percent) const;
+
+    std::size_t
+    size () const;
+
+private:
+    std::size_t const capacity_;
+
+    std::mutex mutable mutex_;
+    std::vector<std::chrono::microseconds> samples_;
+    std::size_t next_ = 0;
+    std::size_t sinceRefresh_ = 0;
+    std::vector<std::chrono::microseconds> sorted_;
+};
+
+}
+}
+
+#endif
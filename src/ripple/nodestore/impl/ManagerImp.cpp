@@ -94,6 +94,20 @@ ManagerImp::make_Database (
     int readThreads,
     Section const& backendParameters)
 {
+    std::unique_ptr <BloomFilter> filter;
+    auto const filterPath = get<std::string> (backendParameters, "bloom_filter");
+    if (! filterPath.empty ())
+    {
+        filter = std::make_unique <BloomFilter> (filterPath,
+            get<std::uint64_t> (backendParameters, "bloom_size", 1024),
+            get<std::uint32_t> (backendParameters, "bloom_hashes", 7));
+    }
+
+    std::unique_ptr <AccessTrace> trace;
+    auto const tracePath = get<std::string> (backendParameters, "trace");
+    if (! tracePath.empty ())
+        trace = std::make_unique <AccessTrace> (tracePath);
+
     return std::make_unique <DatabaseImp> (
         name,
         scheduler,
@@ -102,7 +116,9 @@ ManagerImp::make_Database (
             backendParameters,
             scheduler,
             journal),
-        journal);
+        journal,
+        std::move (filter),
+        std::move (trace));
 }
 
 std::unique_ptr <DatabaseRotating>
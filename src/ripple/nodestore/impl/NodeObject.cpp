@@ -19,21 +19,45 @@
 
 #include <BeastConfig.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/basics/MemoryTag.h>
+#include <cstring>
 #include <memory>
 
 namespace ripple {
 
+static
+MemoryTag&
+nodeObjectMemory ()
+{
+    static MemoryTag tag ("NodeObject");
+    return tag;
+}
+
 //------------------------------------------------------------------------------
 
 NodeObject::NodeObject (
+    std::uint8_t* const& payload,
     NodeObjectType type,
-    Blob&& data,
+    Slice data,
     uint256 const& hash,
     PrivateAccess)
     : mType (type)
+    , mSize (static_cast<std::uint32_t> (data.size ()))
     , mHash (hash)
+    , mData (payload)
+{
+    if (! data.empty ())
+        std::memcpy (payload, data.data (), data.size ());
+}
+
+std::shared_ptr<NodeObject>
+NodeObject::createObject (
+    NodeObjectType type,
+    Slice data,
+    uint256 const& hash)
 {
-    mData = std::move (data);
+    return make_shared_inline <NodeObject, nodeObjectMemory> (
+        data.size (), type, data, hash, PrivateAccess ());
 }
 
 std::shared_ptr<NodeObject>
@@ -42,8 +66,8 @@ NodeObject::createObject (
     Blob&& data,
     uint256 const& hash)
 {
-    return std::make_shared <NodeObject> (
-        type, std::move (data), hash, PrivateAccess ());
+    Blob const blob (std::move (data));
+    return createObject (type, makeSlice (blob), hash);
 }
 
 NodeObjectType
@@ -58,10 +82,10 @@ NodeObject::getHash () const
     return mHash;
 }
 
-Blob const&
+Slice
 NodeObject::getData () const
 {
-    return mData;
+    return Slice (mData, mSize);
 }
 
 }
@@ -0,0 +1,161 @@
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/ScanRange.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/strHex.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+std::string
+checkpointField (std::string const& key)
+{
+    return key.empty () ? "-" : strHex (key.data (), key.size ());
+}
+
+// The place of a key among every key, from 0 to 1
+double
+position (std::string const& key, bool hex)
+{
+    int const base = hex ? 16 : 256;
+    double scale = 1;
+    double result = 0;
+    for (std::size_t i = 0; i < std::min<std::size_t> (key.size (), 6); ++i)
+    {
+        int const digit = hex ?
+            charUnHex (key[i]) : static_cast<unsigned char> (key[i]);
+        scale /= base;
+        result += std::max (digit, 0) * scale;
+    }
+    return result;
+}
+
+}
+
+std::vector<ScanRange>
+makeScanRanges (std::vector<std::string> splits)
+{
+    std::sort (splits.begin (), splits.end ());
+    splits.erase (std::unique (splits.begin (), splits.end ()), splits.end ());
+    splits.erase (std::remove (splits.begin (), splits.end (), std::string ()),
+        splits.end ());
+
+    std::vector<ScanRange> ranges (splits.size () + 1);
+    for (std::size_t i = 0; i < splits.size (); ++i)
+    {
+        ranges[i].stop = splits[i];
+        ranges[i + 1].start = splits[i];
+    }
+    for (auto& range : ranges)
+        range.next = range.start;
+    return ranges;
+}
+
+std::vector<std::string>
+prefixSplits (bool hex)
+{
+    // Hex keys start with 0-9 or A-F, binary keys with any byte.
+    std::vector<std::string> splits;
+    for (int i = 1; i < 16; ++i)
+    {
+        if (hex)
+            splits.emplace_back (1, "0123456789ABCDEF"[i]);
+        else
+            splits.emplace_back (1, static_cast<char> (i << 4));
+    }
+    return splits;
+}
+
+std::vector<ScanRange>
+loadScanCheckpoint (std::string const& path)
+{
+    std::vector<ScanRange> ranges;
+    std::ifstream in (path);
+    std::string start, stop, next;
+    int done;
+    while (in >> start >> stop >> next >> done)
+    {
+        ScanRange range;
+        for (auto field : {std::make_pair (&start, &range.start),
+            std::make_pair (&stop, &range.stop),
+                std::make_pair (&next, &range.next)})
+        {
+            if (*field.first != "-" &&
+                    strUnHex (*field.second, *field.first) == -1)
+                Throw<std::runtime_error> ("Bad scan checkpoint " + path);
+        }
+        range.done = done != 0;
+        ranges.push_back (std::move (range));
+    }
+    return ranges;
+}
+
+void
+saveScanCheckpoint (std::string const& path,
+    std::vector<ScanRange> const& ranges)
+{
+    auto const temp = path + ".tmp";
+    {
+        std::ofstream out (temp, std::ios::trunc);
+        for (auto const& range : ranges)
+        {
+            out << checkpointField (range.start) << ' '
+                << checkpointField (range.stop) << ' '
+                << checkpointField (range.next) << ' '
+                << (range.done ? 1 : 0) << '\n';
+        }
+        if (!out)
+            Throw<std::runtime_error> ("Unable to write " + temp);
+    }
+    std::rename (temp.c_str (), path.c_str ());
+}
+
+double
+scannedFraction (std::vector<ScanRange> const& ranges, bool hex)
+{
+    double result = 0;
+    for (auto const& range : ranges)
+    {
+        auto const start = position (range.start, hex);
+        auto const stop = range.stop.empty () ? 1.0 : position (range.stop, hex);
+        if (range.done)
+            result += stop - start;
+        else
+            result += std::min (std::max (
+                position (range.next, hex) - start, 0.0), stop - start);
+    }
+    return std::min (result, 1.0);
+}
+
+void
+logScanProgress (beast::Journal journal, double first, double scanned,
+    std::chrono::steady_clock::duration elapsed)
+{
+    if (! journal.info)
+        return;
+
+    auto const seconds =
+        std::chrono::duration_cast<std::chrono::seconds> (elapsed).count ();
+    std::ostringstream ss;
+    ss << "Scanned " << std::fixed << std::setprecision (1) <<
+        scanned * 100 << "% of the keys";
+    if (scanned > first && seconds > 0)
+    {
+        auto const left = static_cast<std::int64_t> (
+            seconds * (1 - scanned) / (scanned - first));
+        ss << ", about " << left / 3600 << "h " <<
+            (left / 60) % 60 << "m left";
+    }
+    journal.info << ss.str ();
+}
+
+}
+}
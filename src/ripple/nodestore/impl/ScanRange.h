@@ -0,0 +1,61 @@
+#ifndef RIPPLE_NODESTORE_SCANRANGE_H_INCLUDED
+#define RIPPLE_NODESTORE_SCANRANGE_H_INCLUDED
+
+#include <beast/utility/Journal.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Part of the keys of a backend visited by for_each.
+
+    Backends which can start a scan at any key split their keys into
+    ranges and scan them on several threads. Keys compare as byte
+    strings: binary keys, or the hex text of the hash.
+*/
+struct ScanRange
+{
+    std::string start;      // empty for the first key
+    std::string stop;       // empty for past the last key
+    std::string next;       // first key not yet handed out
+    bool done = false;
+};
+
+/** Ranges between split keys, covering every key. */
+std::vector<ScanRange>
+makeScanRanges (std::vector<std::string> splits);
+
+/** The 15 splits of the keys at their first 4 bits. */
+std::vector<std::string>
+prefixSplits (bool hex);
+
+/** Ranges of an interrupted scan, empty if there is none.
+    Throws if the file is not a checkpoint.
+*/
+std::vector<ScanRange>
+loadScanCheckpoint (std::string const& path);
+
+/** Save the ranges under a temporary name and rename the file. */
+void
+saveScanCheckpoint (std::string const& path,
+    std::vector<ScanRange> const& ranges);
+
+/** The part of the keys scanned, from 0 to 1.
+    Node keys are hashes, so their prefixes are uniformly spread.
+*/
+double
+scannedFraction (std::vector<ScanRange> const& ranges, bool hex);
+
+/** Log the part of the keys scanned and when the scan should end.
+    @param first The part scanned when the scan started or resumed.
+*/
+void
+logScanProgress (beast::Journal journal, double first, double scanned,
+    std::chrono::steady_clock::duration elapsed);
+
+}
+}
+
+#endif
@@ -33,6 +33,23 @@ enum
 
     // Fraction of the cache one query source can take
     ,asyncDivider = 8
+
+    // Smallest and first size of the batched reads
+    ,batchFetchMinimum = 64
+    ,batchFetchInitial = 256
+
+    // Latency a batched read should stay under, in milliseconds
+    ,batchFetchTargetLatency = 100
+
+    // Objects a range scan hands to its consumer at a time
+    ,scanBatchSize = 256
+
+    // Objects an import stores at a time, and batches waiting to be stored
+    ,importBatchSize = 8192
+    ,importQueueBatches = 4
+
+    // Seconds between reports of the progress of an import
+    ,importReportSeconds = 30
 };
 
 }
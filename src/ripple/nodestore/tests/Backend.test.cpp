@@ -22,6 +22,7 @@
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
 #include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <set>
 
 namespace ripple {
 namespace NodeStore {
@@ -71,6 +72,27 @@ public:
                 fetchCopyOfBatch (*backend, &copy, batch);
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
+
+            if (backend->canFetchBatch ())
+            {
+                // Read it back in one batch, with some missing keys
+                Batch missing;
+                createPredictableBatch (missing, 100, seedValue + 1);
+                std::set<uint256> hashes;
+                for (auto const& object : batch)
+                    hashes.insert (object->getHash ());
+                for (auto const& object : missing)
+                    hashes.insert (object->getHash ());
+
+                auto result = backend->fetchBatch (hashes);
+                Batch copy (result.first.begin (), result.first.end ());
+                std::sort (batch.begin (), batch.end (), LessThan{});
+                std::sort (copy.begin (), copy.end (), LessThan{});
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+                expect (result.second.size () == missing.size ());
+                for (auto const& object : missing)
+                    expect (result.second.count (object->getHash ()) == 1);
+            }
         }
 
         {
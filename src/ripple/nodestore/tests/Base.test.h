@@ -200,7 +200,8 @@ public:
         {
             std::shared_ptr<NodeObject> const object (batch [i]);
 
-            Blob data (object->getData ());
+            auto const slice = object->getData ();
+            Blob data (slice.data (), slice.data () + slice.size ());
 
             db.store (object->getType (),
                       std::move (data),
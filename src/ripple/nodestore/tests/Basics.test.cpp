@@ -21,8 +21,11 @@
 #include <ripple/nodestore/tests/Base.test.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/AccessTrace.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -77,6 +80,131 @@ public:
         }
     }
 
+    // An inner node with the given branches, and a leaf that compresses.
+    static
+    Batch
+    createCompressibleBatch (std::int64_t const seedValue)
+    {
+        beast::Random r (seedValue);
+        Batch batch;
+        for (int branches : {1, 5})
+        {
+            Blob data (4 + 16 * 32, 0);
+            auto const prefix = static_cast<std::uint32_t> (HashPrefix::innerNode);
+            for (int i = 0; i < 4; ++i)
+                data[i] = static_cast<unsigned char> (prefix >> (24 - 8 * i));
+            for (int i = 0; i < branches; ++i)
+                r.fillBitsRandomly (&data[4 + 32 * i], 32);
+
+            uint256 hash;
+            r.fillBitsRandomly (hash.begin (), hash.size ());
+            batch.push_back (NodeObject::createObject (
+                hotACCOUNT_NODE, std::move (data), hash));
+        }
+
+        Blob data (1000);
+        for (int i = 0; i < data.size (); ++i)
+            data[i] = static_cast<unsigned char> (r.nextInt (4));
+        uint256 hash;
+        r.fillBitsRandomly (hash.begin (), hash.size ());
+        batch.push_back (NodeObject::createObject (
+            hotTRANSACTION_NODE, std::move (data), hash));
+        return batch;
+    }
+
+    // Checks compressed blobs round trip and get smaller
+    void testCodecs (std::int64_t const seedValue)
+    {
+        testcase ("codecs");
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        auto const compressible = createCompressibleBatch (seedValue);
+        batch.insert (batch.end (), compressible.begin (), compressible.end ());
+
+        for (auto const codec : {BlobCodec::none, BlobCodec::lz4, BlobCodec::inner})
+        {
+            BlobCodecs const codecs (codec);
+            EncodedBlob encoded;
+            for (auto const& object : batch)
+            {
+                encoded.prepare (object, codecs);
+                expect (encoded.getSize () <= object->getData ().size () + 9,
+                    "Should not grow");
+
+                DecodedBlob decoded (encoded.getKey (), encoded.getData (), encoded.getSize ());
+                expect (decoded.wasOk (), "Should be ok");
+                if (decoded.wasOk ())
+                    expect (isSame (object, decoded.createObject ()), "Should be clones");
+            }
+
+            for (auto const& object : compressible)
+            {
+                encoded.prepare (object, codecs);
+                if (codec == BlobCodec::none)
+                    expect (encoded.getSize () == object->getData ().size () + 9,
+                        "Should not be compressed");
+                else
+                    expect (encoded.getSize () < object->getData ().size (),
+                        "Should be compressed");
+            }
+        }
+
+        Section section;
+        section.set ("codec_account_node", "inner");
+        section.set ("codec_ledger", "none");
+        BlobCodecs const codecs (section);
+        expect (codecs.get (hotACCOUNT_NODE) == BlobCodec::inner, "Should be inner");
+        expect (codecs.get (hotLEDGER) == BlobCodec::none, "Should be none");
+        expect (codecs.get (hotTRANSACTION_NODE) == BlobCodec::lz4, "Should be lz4");
+    }
+
+    // Checks traces read back what was recorded, across reopens
+    void testTrace (std::int64_t const seedValue)
+    {
+        testcase ("trace");
+
+        beast::UnitTestUtilities::TempDirectory file ("node_trace");
+        auto const path = file.getFullPathName ().toStdString ();
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            AccessTrace trace (path);
+            for (auto const& object : batch)
+            {
+                trace.record (AccessTrace::store, object->getHash (),
+                    object->getType (), object->getData ().size ());
+                trace.record (AccessTrace::fetchAsync, object->getHash ());
+            }
+        }
+
+        auto const records = AccessTrace::read (path);
+        expect (records.size () == 4 * batch.size (), "Should read every record");
+        if (records.size () != 4 * batch.size ())
+            return;
+
+        for (std::size_t i = 0; i < records.size (); i += 2)
+        {
+            auto const& object = batch[(i / 2) % batch.size ()];
+            auto const& stored = records[i];
+            auto const& fetched = records[i + 1];
+            expect (stored.operation == AccessTrace::store &&
+                stored.hash == object->getHash () &&
+                stored.type == object->getType () &&
+                stored.size == object->getData ().size (), "Should be the store");
+            expect (fetched.operation == AccessTrace::fetchAsync &&
+                fetched.hash == object->getHash () &&
+                fetched.type == hotUNKNOWN && fetched.size == 0,
+                "Should be the fetch");
+            expect (stored.thread == 0 && fetched.thread == 0, "Should be one thread");
+            if (i > 0)
+                expect (stored.when >= records[i - 1].when, "Should be in order");
+        }
+    }
+
     void run ()
     {
         std::int64_t const seedValue = 50;
@@ -84,6 +212,10 @@ public:
         testBatches (seedValue);
 
         testBlobs (seedValue);
+
+        testCodecs (seedValue);
+
+        testTrace (seedValue);
     }
 };
 
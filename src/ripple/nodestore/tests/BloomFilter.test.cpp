@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/impl/BloomFilter.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class BloomFilter_test : public TestBase
+{
+public:
+    void testFilter (std::int64_t const seedValue)
+    {
+        testcase ("filter");
+
+        beast::UnitTestUtilities::TempDirectory dir ("bloom");
+        auto const path = dir.getFullPathName ().toStdString () + "/bloom";
+
+        Batch stored;
+        createPredictableBatch (stored, numObjectsToTest, seedValue);
+        Batch missing;
+        createPredictableBatch (missing, numObjectsToTest, seedValue + 1);
+
+        {
+            BloomFilter filter (path, 1, 7);
+            expect (! filter.complete (), "new filter is not complete");
+            for (auto const& object : stored)
+                filter.insert (object->getHash ());
+            filter.setComplete ();
+        }
+
+        {
+            BloomFilter filter (path, 1, 7);
+            expect (filter.complete (), "complete after reopening");
+
+            bool all = true;
+            for (auto const& object : stored)
+                all = all && filter.mayContain (object->getHash ());
+            expect (all, "every stored key is found");
+
+            int falsePositives = 0;
+            for (auto const& object : missing)
+            {
+                if (filter.mayContain (object->getHash ()))
+                    ++falsePositives;
+            }
+            expect (falsePositives < numObjectsToTest / 100,
+                "few false positives");
+        }
+
+        {
+            // Another size starts over.
+            BloomFilter filter (path, 2, 7);
+            expect (! filter.complete (), "resized filter is not complete");
+            expect (! filter.mayContain (stored.front ()->getHash ()),
+                "resized filter is empty");
+        }
+    }
+
+    void run ()
+    {
+        testFilter (50);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BloomFilter,NodeStore,ripple);
+
+}
+}
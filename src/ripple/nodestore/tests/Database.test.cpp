@@ -21,6 +21,7 @@
 #include <ripple/nodestore/tests/Base.test.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/Tuning.h>
 #include <beast/module/core/diagnostic/UnitTestUtilities.h>
 
 namespace ripple {
@@ -30,7 +31,8 @@ class Database_test : public TestBase
 {
 public:
     void testImport (std::string const& destBackendType,
-        std::string const& srcBackendType, std::int64_t seedValue)
+        std::string const& srcBackendType, std::int64_t seedValue,
+            int count = numObjectsToTest)
     {
         DummyScheduler scheduler;
 
@@ -41,7 +43,7 @@ public:
 
         // Create a batch
         Batch batch;
-        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        createPredictableBatch (batch, count, seedValue);
 
         beast::Journal j;
 
@@ -153,6 +155,48 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void testSkipPersisted (std::int64_t const seedValue)
+    {
+        testcase ("skip persisted");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+        Section nodeParams;
+        nodeParams.set ("type", "memory");
+        nodeParams.set ("path", "skip_persisted");
+
+        Batch batch;
+        createPredictableBatch (batch, 200, seedValue);
+        auto const size = static_cast<std::uint32_t> (batch.size ());
+
+        {
+            std::unique_ptr <Database> db = Manager::instance().make_Database (
+                "test", scheduler, j, 2, nodeParams);
+
+            // Stored objects are not written again
+            storeBatch (*db, batch);
+            expect (db->getStoreCount () == size);
+            storeBatch (*db, batch);
+            expect (db->getStoreCount () == size);
+            expect (db->getStoreSkipCount () == size);
+        }
+
+        {
+            // Nor are objects read from the backend
+            std::unique_ptr <Database> db = Manager::instance().make_Database (
+                "test", scheduler, j, 2, nodeParams);
+
+            Batch copy;
+            fetchCopyOfBatch (*db, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+            storeBatch (*db, batch);
+            expect (db->getStoreCount () == 0);
+            expect (db->getStoreSkipCount () == size);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
     void runBackendTests (std::int64_t const seedValue)
     {
         testNodeStore ("nudb", true, seedValue);
@@ -166,6 +210,9 @@ public:
 
     void runImportTests (std::int64_t const seedValue)
     {
+        // Enough objects for several batches to be waiting on the writer
+        testImport ("memory", "memory", seedValue, 3 * importBatchSize + 1);
+
         testImport ("nudb", "nudb", seedValue);
 
     #if RIPPLE_ROCKSDB_AVAILABLE
@@ -185,6 +232,8 @@ public:
 
         testNodeStore ("memory", false, seedValue);
 
+        testSkipPersisted (seedValue);
+
         runBackendTests (seedValue);
 
         runImportTests (seedValue);
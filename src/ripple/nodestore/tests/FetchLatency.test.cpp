@@ -0,0 +1,69 @@
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/FetchLatency.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class FetchLatency_test : public beast::unit_test::suite
+{
+public:
+    using us = std::chrono::microseconds;
+
+    void
+    testPercentiles ()
+    {
+        testcase ("percentiles");
+
+        FetchLatency latency (1000);
+        expect (latency.percentile (99) == us (0));
+
+        // Nothing is given before the minimum number of samples
+        for (std::size_t i = 1; i < FetchLatency::minimumSamples; ++i)
+            expect (! latency.record (us (i)));
+        expect (latency.percentile (50) == us (0));
+        expect (latency.record (us (FetchLatency::minimumSamples)));
+        expect (latency.percentile (0) == us (1));
+        expect (latency.percentile (100) ==
+            us (FetchLatency::minimumSamples));
+
+        // Later samples only count from the next refresh
+        std::size_t refreshed = 0;
+        for (auto i = FetchLatency::minimumSamples + 1; i <= 1000; ++i)
+            refreshed += latency.record (us (i));
+        expect (refreshed == (1000 - FetchLatency::minimumSamples) /
+            FetchLatency::refreshInterval);
+        for (std::size_t i = 0; i < FetchLatency::refreshInterval; ++i)
+            latency.record (us (1000));
+        expect (latency.size () == 1000);
+        expect (latency.percentile (50) > us (500));
+        expect (latency.percentile (99) == us (1000));
+    }
+
+    void
+    testRing ()
+    {
+        testcase ("ring");
+
+        // The oldest samples make room for the newest
+        FetchLatency latency (FetchLatency::refreshInterval);
+        for (std::size_t i = 0; i < FetchLatency::refreshInterval; ++i)
+            latency.record (us (100000));
+        for (std::size_t i = 0; i < 2 * FetchLatency::refreshInterval; ++i)
+            latency.record (us (10));
+        expect (latency.size () == FetchLatency::refreshInterval);
+        expect (latency.percentile (100) == us (10));
+    }
+
+    void
+    run ()
+    {
+        testPercentiles ();
+        testRing ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FetchLatency,nodestore,ripple);
+
+}
+}
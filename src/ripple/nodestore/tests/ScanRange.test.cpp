@@ -0,0 +1,92 @@
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/ScanRange.h>
+#include <beast/unit_test/suite.h>
+#include <boost/filesystem.hpp>
+#include <cmath>
+
+namespace ripple {
+namespace NodeStore {
+
+class ScanRange_test : public beast::unit_test::suite
+{
+public:
+    static
+    bool
+    near (double a, double b)
+    {
+        return std::abs (a - b) < 0.001;
+    }
+
+    void
+    testRanges ()
+    {
+        testcase ("ranges");
+
+        for (bool hex : {false, true})
+        {
+            auto ranges = makeScanRanges (prefixSplits (hex));
+            expect (ranges.size () == 16);
+            expect (ranges.front ().start.empty ());
+            expect (ranges.back ().stop.empty ());
+            for (std::size_t i = 1; i < ranges.size (); ++i)
+                expect (ranges[i].start == ranges[i - 1].stop);
+            expect (near (scannedFraction (ranges, hex), 0));
+
+            // Half of the first range, and the whole of the last
+            ranges.front ().next = hex ? "08" : std::string (1, '\x08');
+            ranges.back ().done = true;
+            expect (near (scannedFraction (ranges, hex), 1.5 / 16),
+                std::to_string (scannedFraction (ranges, hex)));
+
+            for (auto& range : ranges)
+                range.done = true;
+            expect (near (scannedFraction (ranges, hex), 1));
+        }
+
+        // Splits are sorted, once each
+        auto const ranges = makeScanRanges ({"b", "a", "b", ""});
+        expect (ranges.size () == 3);
+        expect (ranges[0].stop == "a" && ranges[1].stop == "b");
+        expect (ranges[2].start == "b" && ranges[2].next == "b");
+    }
+
+    void
+    testCheckpoint ()
+    {
+        testcase ("checkpoint");
+
+        auto const path = (boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ()).string ();
+        expect (loadScanCheckpoint (path).empty ());
+
+        auto ranges = makeScanRanges (prefixSplits (false));
+        ranges[0].next = std::string ("\x01\x02\0", 3);
+        ranges[3].done = true;
+        saveScanCheckpoint (path, ranges);
+
+        auto const loaded = loadScanCheckpoint (path);
+        expect (loaded.size () == ranges.size ());
+        bool same = loaded.size () == ranges.size ();
+        for (std::size_t i = 0; same && i < loaded.size (); ++i)
+        {
+            same = loaded[i].start == ranges[i].start &&
+                loaded[i].stop == ranges[i].stop &&
+                loaded[i].next == ranges[i].next &&
+                loaded[i].done == ranges[i].done;
+        }
+        expect (same, "the ranges are read back");
+        boost::filesystem::remove (path);
+    }
+
+    void
+    run () override
+    {
+        testRanges ();
+        testCheckpoint ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ScanRange,NodeStore,ripple);
+
+}
+}
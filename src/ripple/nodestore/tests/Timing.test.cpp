@@ -21,6 +21,10 @@
 #include <ripple/nodestore/tests/Base.test.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/AccessTrace.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/protocol/HashPrefix.h>
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/unity/rocksdb.h>
 #include <beast/module/core/diagnostic/UnitTestUtilities.h>
@@ -34,10 +38,12 @@
 #include <limits>
 #include <map>
 #include <random>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
 #include <type_traits>
+#include <unordered_set>
 #include <utility>
 
 #ifndef NODESTORE_TIMING_DO_VERIFY
@@ -118,8 +124,12 @@ public:
         rngcpy (data + 1, key.size() - 1, gen_);
         Blob value(d_size_(gen_));
         rngcpy (&value[0], value.size(), gen_);
+        // Type 2 was hotTRANSACTION, which is no longer decoded
+        auto type = d_type_(gen_);
+        if (type == 2)
+            type = hotLEDGER;
         return NodeObject::createObject (
-            static_cast<NodeObjectType>(d_type_(gen_)),
+            static_cast<NodeObjectType>(type),
                 std::move(value), key);
     }
 
@@ -142,7 +152,10 @@ public:
     enum
     {
         // percent of fetches for missing nodes
-        missingNodePercent = 20
+        missingNodePercent = 20,
+
+        // keys read by each fetchBatch
+        fetchBatchSize = 256
     };
 
     std::size_t const default_repeat = 3;
@@ -383,6 +396,80 @@ public:
         backend->close();
     }
 
+    // Fetch existing keys in batches
+    void
+    do_batch (Section const& config, Params const& params)
+    {
+        beast::Journal journal;
+        DummyScheduler scheduler;
+        auto backend = make_Backend (config, scheduler, journal);
+        expect (backend != nullptr);
+
+        class Body
+        {
+        private:
+            suite& suite_;
+            Backend& backend_;
+            Sequence seq1_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body (std::size_t id, suite& s,
+                    Params const& params, Backend& backend)
+                : suite_(s)
+                , backend_ (backend)
+                , seq1_ (1)
+                , gen_ (id + 1)
+                , dist_ (0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                try
+                {
+                    std::set<uint256> hashes;
+                    for (std::size_t j = 0; j < fetchBatchSize; ++j)
+                        hashes.insert (seq1_.obj (dist_(gen_))->getHash ());
+                    if (backend_.canFetchBatch ())
+                    {
+                        auto const result = backend_.fetchBatch (hashes);
+                        suite_.expect (result.second.empty () &&
+                            result.first.size () == hashes.size ());
+                        return;
+                    }
+                    for (auto const& hash : hashes)
+                    {
+                        std::shared_ptr<NodeObject> result;
+                        backend_.fetch (hash.data (), &result);
+                        suite_.expect (result != nullptr);
+                    }
+                }
+                catch(std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        try
+        {
+            parallel_for_id<Body>(
+                std::max<std::size_t> (params.items / fetchBatchSize, 1),
+                    params.threads, std::ref(*this), std::ref(params),
+                        std::ref(*backend));
+        }
+        catch (std::exception const&)
+        {
+        #if NODESTORE_TIMING_DO_VERIFY
+            backend->verify();
+        #endif
+            Throw();
+        }
+        backend->close();
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing (Section const& config, Params const& params)
@@ -695,6 +782,307 @@ public:
         }
     }
 
+    // An account state node is an inner node with a few branches or a
+    // ledger entry, a transaction node is a transaction with its metadata.
+    // Both leaves hold many small and repeated fields.
+    static
+    std::shared_ptr<NodeObject>
+    codec_object (NodeObjectType type, std::size_t n)
+    {
+        beast::xor_shift_engine gen (n + 1);
+        uint256 key;
+        rngcpy (&*key.begin(), key.size(), gen);
+
+        Blob value;
+        auto const putPrefix = [&value](std::uint32_t prefix)
+        {
+            for (int i = 0; i < 4; ++i)
+                value.push_back (static_cast<std::uint8_t> (prefix >> (24 - 8 * i)));
+        };
+        if (type == hotACCOUNT_NODE && gen() % 4 != 0)
+        {
+            putPrefix (HashPrefix::innerNode);
+            value.resize (4 + 16 * 32);
+            auto const branches = 1 + gen() % 16;
+            for (std::size_t i = 0; i < branches; ++i)
+                rngcpy (&value[4 + 32 * (gen() % 16)], 32, gen);
+        }
+        else
+        {
+            putPrefix (type == hotACCOUNT_NODE ?
+                HashPrefix::leafNode : HashPrefix::txNode);
+            auto const fields = 10 + gen() % (type == hotACCOUNT_NODE ? 10 : 40);
+            for (std::size_t i = 0; i < fields; ++i)
+            {
+                value.push_back (static_cast<std::uint8_t> (0x20 + gen() % 16));
+                auto const size = (gen() % 3 == 0) ? 20 : 4 + gen() % 5;
+                for (std::size_t j = 0; j < size; ++j)
+                    value.push_back (static_cast<std::uint8_t> (
+                        j < size / 2 ? gen() : 0));
+            }
+            value.insert (value.end (), key.begin (), key.end ());
+        }
+        return NodeObject::createObject (type, std::move (value), key);
+    }
+
+    // Size and time of encoding and decoding each type with each codec
+    void
+    do_codecs (std::size_t items)
+    {
+        using std::setw;
+        log <<
+            "\n" << items << " Objects\n" <<
+            std::left << setw(20) << "Type" << setw(8) << "Codec" << std::right <<
+            setw(10) << "Bytes" << setw(8) << "Ratio" <<
+            setw(10) << "Encode" << setw(10) << "Decode";
+
+        for (auto const type : {hotACCOUNT_NODE, hotTRANSACTION_NODE})
+        {
+            Batch batch;
+            batch.reserve (items);
+            std::size_t raw = 0;
+            for (std::size_t i = 0; i < items; ++i)
+            {
+                batch.push_back (codec_object (type, i));
+                raw += batch.back()->getData().size() + 9;
+            }
+
+            std::pair<BlobCodec, char const*> const codecs[] = {
+                { BlobCodec::none, "none" },
+                { BlobCodec::lz4, "lz4" },
+                { BlobCodec::inner, "inner" } };
+            for (auto const& codec : codecs)
+            {
+                BlobCodecs const blobCodecs (codec.first);
+                std::vector<Blob> blobs;
+                blobs.reserve (items);
+                std::size_t bytes = 0;
+
+                EncodedBlob encoded;
+                auto start = clock_type::now();
+                for (auto const& object : batch)
+                {
+                    encoded.prepare (object, blobCodecs);
+                    auto const data = static_cast<std::uint8_t const*> (
+                        encoded.getData());
+                    blobs.emplace_back (data, data + encoded.getSize());
+                    bytes += encoded.getSize();
+                }
+                auto const encode = std::chrono::duration_cast<duration_type> (
+                    clock_type::now() - start);
+
+                start = clock_type::now();
+                for (std::size_t i = 0; i < items; ++i)
+                {
+                    DecodedBlob decoded (batch[i]->getHash().begin(),
+                        blobs[i].data(), blobs[i].size());
+                    expect (decoded.wasOk() &&
+                        isSame (batch[i], decoded.createObject()));
+                }
+                auto const decode = std::chrono::duration_cast<duration_type> (
+                    clock_type::now() - start);
+
+                std::stringstream ss;
+                ss << std::left << setw(20) <<
+                    (type == hotACCOUNT_NODE ?
+                        "hotACCOUNT_NODE" : "hotTRANSACTION_NODE") <<
+                    setw(8) << codec.second << std::right <<
+                    setw(10) << bytes <<
+                    setw(8) << std::fixed << std::setprecision(3) <<
+                        (static_cast<double> (bytes) / raw) <<
+                    setw(10) << to_string (encode) <<
+                    setw(10) << to_string (decode);
+                log << ss.str();
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    // An object for a traced key, the same on every replay
+    static
+    std::shared_ptr<NodeObject>
+    replay_object (AccessTrace::Record const& record)
+    {
+        std::uint64_t seed;
+        std::memcpy (&seed, record.hash.begin(), sizeof(seed));
+        beast::xor_shift_engine gen (seed);
+        Blob value (record.size != 0 ? record.size : 512);
+        rngcpy (&value[0], value.size(), gen);
+        return NodeObject::createObject (
+            record.type != hotUNKNOWN ? record.type : hotACCOUNT_NODE,
+                std::move(value), record.hash);
+    }
+
+    static
+    std::string
+    to_string (std::vector<std::chrono::microseconds>& latencies)
+    {
+        std::stringstream ss;
+        if (latencies.empty())
+            return ss.str();
+        std::sort (latencies.begin(), latencies.end());
+        auto const at = [&latencies](double fraction)
+        {
+            return latencies[std::min<std::size_t> (latencies.size() - 1,
+                static_cast<std::size_t> (fraction * latencies.size()))].count();
+        };
+        ss << std::right << std::setw(10) << latencies.size() <<
+            std::setw(10) << at (0.5) << std::setw(10) << at (0.9) <<
+            std::setw(10) << at (0.99) << std::setw(10) << at (0.999) <<
+            std::setw(10) << latencies.back().count();
+        return ss.str();
+    }
+
+    /*  Replay a trace recorded with the trace key of a node store.
+
+        Each traced thread is replayed by a thread of its own, in the
+        order it made its calls and without waiting between them. The
+        asynchronous fetches a thread makes in a row are waited for
+        together, as a batch. Unless prefill=0, the objects fetched
+        before the trace stores them are stored first, except for
+        the fetches which found nothing.
+    */
+    void
+    do_replay (Section const& config)
+    {
+        beast::Journal journal;
+        DummyScheduler scheduler;
+
+        auto const path = get<std::string>(config, "trace");
+        auto const records = AccessTrace::read (path);
+        Section backendConfig (config);
+        backendConfig.set ("trace", "");
+
+        if (get<bool>(config, "prefill", true))
+        {
+            auto backend = make_Backend (backendConfig, scheduler, journal);
+            std::unordered_set<uint256, beast::uhash<>> stored;
+            Batch batch;
+            for (auto const& record : records)
+            {
+                if (record.operation == AccessTrace::fetchSync &&
+                        record.size == 0)
+                    continue;
+                if (! stored.insert (record.hash).second ||
+                        record.operation == AccessTrace::store)
+                    continue;
+                batch.push_back (replay_object (record));
+                if (batch.size() >= 4096)
+                {
+                    backend->storeBatch (batch);
+                    batch.clear();
+                }
+            }
+            if (! batch.empty())
+                backend->storeBatch (batch);
+            backend->close();
+        }
+
+        auto db = Manager::instance().make_Database ("replay", scheduler,
+            journal, get<int>(config, "read_threads", 4), backendConfig);
+
+        std::map<std::uint16_t, std::vector<AccessTrace::Record const*>> threads;
+        for (auto const& record : records)
+            threads[record.thread].push_back (&record);
+
+        struct Latencies
+        {
+            std::vector<std::chrono::microseconds> fetch;
+            std::vector<std::chrono::microseconds> batch;
+            std::vector<std::chrono::microseconds> store;
+        };
+        std::vector<Latencies> latencies (threads.size());
+
+        auto const start = clock_type::now();
+        {
+            std::vector<beast::unit_test::thread> t;
+            t.reserve (threads.size());
+            std::size_t index = 0;
+            for (auto const& thread : threads)
+            {
+                t.emplace_back (*this,
+                    [&db, &thread, &result = latencies[index++]]()
+                    {
+                        using std::chrono::microseconds;
+                        auto const& calls = thread.second;
+                        for (std::size_t i = 0; i < calls.size(); ++i)
+                        {
+                            auto const& record = *calls[i];
+                            auto const before = clock_type::now();
+                            if (record.operation == AccessTrace::fetchAsync)
+                            {
+                                std::shared_ptr<NodeObject> object;
+                                bool ready = db->asyncFetch (record.hash, object);
+                                while (i + 1 < calls.size() &&
+                                    calls[i + 1]->operation == AccessTrace::fetchAsync)
+                                {
+                                    ready = db->asyncFetch (
+                                        calls[++i]->hash, object) && ready;
+                                }
+                                if (! ready)
+                                    db->waitReads();
+                                result.batch.push_back (std::chrono::duration_cast<
+                                    microseconds> (clock_type::now() - before));
+                            }
+                            else if (record.operation == AccessTrace::fetchSync)
+                            {
+                                db->fetch (record.hash);
+                                result.fetch.push_back (std::chrono::duration_cast<
+                                    microseconds> (clock_type::now() - before));
+                            }
+                            else
+                            {
+                                auto object = replay_object (record);
+                                auto const slice = object->getData();
+                                Blob data (slice.data(),
+                                    slice.data() + slice.size());
+                                db->store (object->getType(), std::move(data),
+                                    record.hash);
+                                result.store.push_back (std::chrono::duration_cast<
+                                    microseconds> (clock_type::now() - before));
+                            }
+                        }
+                    });
+            }
+            for (auto& _ : t)
+                _.join();
+        }
+        auto const elapsed = std::chrono::duration_cast<duration_type> (
+            clock_type::now() - start);
+        db.reset();
+
+        Latencies total;
+        for (auto& l : latencies)
+        {
+            total.fetch.insert (total.fetch.end(), l.fetch.begin(), l.fetch.end());
+            total.batch.insert (total.batch.end(), l.batch.begin(), l.batch.end());
+            total.store.insert (total.store.end(), l.store.begin(), l.store.end());
+        }
+
+        auto const traced = records.empty() ? std::chrono::microseconds (0) :
+            records.back().when - records.front().when;
+        log <<
+            "\nReplay of " << records.size() << " calls from " <<
+            threads.size() << " threads in " << to_string (elapsed) <<
+            ", traced in " << to_string (
+                std::chrono::duration_cast<duration_type> (traced)) <<
+            ", " << static_cast<std::uint64_t> (records.size() * 1000.0 /
+                std::max<duration_type::rep> (elapsed.count(), 1)) << " calls/s" <<
+            "   " << to_string(config);
+        {
+            using std::setw;
+            std::stringstream ss;
+            ss << std::left << setw(12) << "Latency us" << std::right <<
+                setw(10) << "Count" << setw(10) << "50%" << setw(10) << "90%" <<
+                setw(10) << "99%" << setw(10) << "99.9%" << setw(10) << "Max";
+            log << ss.str();
+        }
+        log << std::left << std::setw(12) << "Fetch" << to_string (total.fetch);
+        log << std::left << std::setw(12) << "Batch" << to_string (total.batch);
+        log << std::left << std::setw(12) << "Store" << to_string (total.store);
+    }
+
     void
     run() override
     {
@@ -704,6 +1092,7 @@ public:
 
             repeat          Number of times to repeat each test
             items           Number of objects to create in the database
+            trace           Replay this trace instead, see do_replay
 
         */
         std::string default_args =
@@ -721,6 +1110,7 @@ public:
             {
                  { "Insert",    &Timing_test::do_insert }
                 ,{ "Fetch",     &Timing_test::do_fetch }
+                ,{ "Batch",     &Timing_test::do_batch }
                 ,{ "Missing",   &Timing_test::do_missing }
                 ,{ "Mixed",     &Timing_test::do_mixed }
                 ,{ "Work",      &Timing_test::do_work }
@@ -730,12 +1120,35 @@ public:
         std::vector <std::string> config_strings;
         boost::split (config_strings, args,
             boost::algorithm::is_any_of (";"));
+        bool replayed = false;
         for (auto iter = config_strings.begin();
                 iter != config_strings.end();)
+        {
             if (iter->empty())
+            {
                 iter = config_strings.erase (iter);
-            else
+                continue;
+            }
+
+            // A configuration with a trace replays it against its backend.
+            Section config = parse(*iter);
+            if (get<std::string>(config, "trace").empty())
+            {
                 ++iter;
+                continue;
+            }
+            if (get<std::string>(config, "path").empty())
+                config.set ("path",
+                    beast::UnitTestUtilities::TempDirectory(
+                        "test_db").getFullPathName().toStdString());
+            do_replay (config);
+            replayed = true;
+            iter = config_strings.erase (iter);
+        }
+        if (replayed && config_strings.empty())
+            return;
+
+        do_codecs (default_items);
 
         do_tests ( 1, tests, config_strings);
         do_tests ( 4, tests, config_strings);
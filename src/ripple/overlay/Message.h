@@ -21,12 +21,14 @@
 #define RIPPLE_OVERLAY_MESSAGE_H_INCLUDED
 
 #include "ripple.pb.h"
+#include <ripple/basics/MemoryTag.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 
 namespace ripple {
@@ -43,6 +45,10 @@ namespace ripple {
 // a string prepended by a header specifying the message length.
 // MessageType should be a Message class generated by the protobuf compiler.
 //
+// Large messages of some types can also be sent compressed to peers which
+// accept it. The top bit of the length flags them. Their payload is the
+// uncompressed length, in four bytes, followed by an LZ4 block.
+//
 
 class Message : public std::enable_shared_from_this <Message>
 {
@@ -54,13 +60,29 @@ public:
     */
     static size_t const kHeaderBytes = 6;
 
+    /** The bit of the length which flags a compressed message. */
+    static std::uint32_t const kCompressedFlag = 0x80000000;
+
+    /** The largest message a compressed one can expand to. */
+    static std::size_t const kMaxUncompressedBytes = 64 * 1024 * 1024;
+
     Message (::google::protobuf::Message const& message, int type);
 
-    /** Retrieve the packed message data. */
+    /** Retrieve the packed message data.
+
+        @param compressed Allow the compressed form, which is made the
+                          first time it is asked for. Messages which are
+                          too small, or of the wrong type, or which do not
+                          get smaller, are always uncompressed.
+    */
     std::vector <uint8_t> const&
-    getBuffer () const
+    getBuffer (bool compressed = false) const;
+
+    /** Returns the size of the message before it was packed. */
+    std::size_t
+    getUncompressedSize () const
     {
-        return mBuffer;
+        return mBuffer.size ();
     }
 
     /** Get the traffic category */
@@ -91,7 +113,7 @@ public:
         n += std::size_t{*first++} << 16;
         n += std::size_t{*first++} <<  8;
         n += std::size_t{*first};
-        return n;
+        return n & ~std::size_t{kCompressedFlag};
     }
 
     template <class BufferSequence>
@@ -104,6 +126,30 @@ public:
     }
     /** @} */
 
+    /** Determine if a packed message is compressed. */
+    /** @{ */
+    template <class FwdIter>
+    static
+    std::enable_if_t<std::is_same<typename
+        FwdIter::value_type, std::uint8_t>::value, bool>
+    compressed (FwdIter first, FwdIter last)
+    {
+        if (std::distance(first, last) <
+                Message::kHeaderBytes)
+            return false;
+        return (*first & 0x80) != 0;
+    }
+
+    template <class BufferSequence>
+    static
+    bool
+    compressed (BufferSequence const& buffers)
+    {
+        return compressed(buffers_begin(buffers),
+            buffers_end(buffers));
+    }
+    /** @} */
+
     /** Determine the type of a packed message. */
     /** @{ */
     static int getType (std::vector <uint8_t> const& buf);
@@ -154,8 +200,18 @@ private:
     //
     void encodeHeader (unsigned size, int type);
 
+    void compress () const;
+
     std::vector <uint8_t> mBuffer;
 
+    // The compressed form, empty if it is no smaller
+    std::vector <uint8_t> mutable mCompressed;
+    std::once_flag mutable mCompressOnce;
+    bool mCompressible;
+
+    // Both buffers, charged once they are filled
+    MemoryCharge mutable mCharge;
+
     int mCategory;
 };
 
@@ -23,6 +23,7 @@
 #include <ripple/json/json_value.h>
 #include <ripple/overlay/Peer.h>
 #include <ripple/overlay/PeerSet.h>
+#include <ripple/protocol/PublicKey.h>
 #include <ripple/server/Handoff.h>
 #include <beast/asio/ssl_bundle.h>
 #include <beast/http/message.h>
@@ -32,7 +33,9 @@
 #include <type_traits>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <chrono>
 #include <functional>
+#include <set>
 
 namespace boost { namespace asio { namespace ssl { class context; } } }
 
@@ -71,6 +74,12 @@ public:
         bool expire = false;
         beast::IP::Address public_ip;
         int ipLimit = 0;
+        bool squelch = false;
+        bool compression = false;
+        bool clusterFetch = false;
+        int ioThreads = 0;
+        // How long relayed transactions wait to be sent together (ms)
+        int txBatch = 0;
     };
 
     using PeerSequence = std::vector <Peer::ptr>;
@@ -112,6 +121,20 @@ public:
     Json::Value
     json () = 0;
 
+    /** Returns histograms, for each category of traffic, of how long
+        inbound messages waited in the job queue and in their handlers.
+    */
+    virtual
+    Json::Value
+    messageTimes () = 0;
+
+    /** Returns the latency of the io_services running the peers.
+        This is the application's own when the overlay shares it.
+    */
+    virtual
+    std::chrono::milliseconds
+    getIOLatency () = 0;
+
     /** Returns a sequence representing the current list of peers.
         The snapshot is made at the time of the call.
     */
@@ -157,7 +180,13 @@ public:
     virtual
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) = 0;
+        uint256 const& uid, PublicKey const& validator) = 0;
+
+    /** Relay a transaction to the peers not in skip. */
+    virtual
+    void
+    relay (protocol::TMTransaction const& m,
+        std::set<Peer::id_t> const& skip) = 0;
 
     virtual
     void
@@ -22,6 +22,7 @@
 #include <ripple/overlay/impl/ConnectAttempt.h>
 #include <ripple/overlay/impl/PeerImp.h>
 #include <ripple/overlay/impl/Tuning.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/json/json_reader.h>
 
 namespace ripple {
@@ -218,11 +219,13 @@ ConnectAttempt::onHandshake (error_code ec)
 
     beast::http::message req = makeRequest(
         ! overlay_.peerFinder().config().peerPrivate,
-            remote_endpoint_.address());
+            overlay_.setup().squelch, overlay_.setup().compression,
+                remote_endpoint_.address());
     auto const hello = buildHello (
         sharedValue,
         overlay_.setup().public_ip,
         beast::IPAddressConversion::from_asio(remote_endpoint_),
+        overlay_.setup().txBatch > 0,
         app_);
     appendHello (req, hello);
 
@@ -331,7 +334,7 @@ ConnectAttempt::onShutdown (error_code ec)
 //--------------------------------------------------------------------------
 
 beast::http::message
-ConnectAttempt::makeRequest (bool crawl,
+ConnectAttempt::makeRequest (bool crawl, bool squelch, bool compression,
     boost::asio::ip::address const& remote_address)
 {
     beast::http::message m;
@@ -344,6 +347,10 @@ ConnectAttempt::makeRequest (bool crawl,
     m.headers.append ("Connection", "Upgrade");
     m.headers.append ("Connect-As", "Peer");
     m.headers.append ("Crawl", crawl ? "public" : "private");
+    if (squelch)
+        m.headers.append ("Squelch", "1");
+    if (compression)
+        m.headers.append ("Compression", "lz4");
     return m;
 }
 
@@ -402,12 +409,32 @@ ConnectAttempt::processResponse (beast::http::message const& m,
     if(! success)
         return close(); // makeSharedValue logs
 
-    RippleAddress publicKey;
-    std::tie(publicKey, success) = verifyHello (hello,
-        sharedValue,
-        overlay_.setup().public_ip,
-        beast::IPAddressConversion::from_asio(remote_endpoint_),
-        journal_, app_);
+    // Checking the signature is slow, so it's done on the job queue
+    // instead of an I/O thread. The timer covers the wait.
+    setTimer();
+    app_.getJobQueue().addJob (jtHANDSHAKE, "ConnectAttempt::verify",
+        [self = shared_from_this(), hello, sharedValue] (Job&)
+        {
+            RippleAddress publicKey;
+            bool success;
+            std::tie(publicKey, success) = verifyHello (hello,
+                sharedValue,
+                self->overlay_.setup().public_ip,
+                beast::IPAddressConversion::from_asio(self->remote_endpoint_),
+                self->journal_, self->app_);
+            self->strand_.post (std::bind (&ConnectAttempt::onVerified,
+                self, hello, publicKey, success));
+        });
+}
+
+void
+ConnectAttempt::onVerified (protocol::TMHello const& hello,
+    RippleAddress const& publicKey, bool success)
+{
+    cancelTimer();
+
+    if(! stream_.next_layer().is_open())
+        return;
     if(! success)
         return close(); // verifyHello logs
     if(journal_.info) journal_.info <<
@@ -431,7 +458,7 @@ ConnectAttempt::processResponse (beast::http::message const& m,
     auto const peer = std::make_shared<PeerImp>(app_,
         std::move(ssl_bundle_), read_buf_.data(),
             std::move(slot_), std::move(response_),
-                usage_, std::move(hello), publicKey, id_, overlay_);
+                usage_, protocol::TMHello (hello), publicKey, id_, overlay_);
 
     overlay_.add_active (peer);
 }
@@ -102,13 +102,16 @@ private:
 
     static
     beast::http::message
-    makeRequest (bool crawl,
+    makeRequest (bool crawl, bool squelch, bool compression,
         boost::asio::ip::address const& remote_address);
 
     template <class Streambuf>
     void processResponse (beast::http::message const& m,
         Streambuf const& body);
 
+    void onVerified (protocol::TMHello const& hello,
+        RippleAddress const& publicKey, bool success);
+
     template <class = void>
     static
     boost::asio::ip::tcp::endpoint
@@ -0,0 +1,68 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/IOPool.h>
+#include <beast/chrono/chrono_util.h>
+#include <beast/threads/Thread.h>
+#include <boost/utility/in_place_factory.hpp>
+#include <algorithm>
+
+namespace ripple {
+
+IOPool::Service::Service ()
+    : work (boost::in_place (std::ref (io_service)))
+    , probe (std::chrono::milliseconds (100), io_service)
+{
+}
+
+IOPool::IOPool (std::size_t threads, std::string const& name,
+        beast::insight::Event event, CpuSet const& cpus)
+    : event_ (event)
+{
+    services_.reserve (threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        services_.emplace_back (std::make_unique <Service> ());
+        auto& s = *services_.back ();
+        s.probe.sample ([this, &s](std::chrono::steady_clock::duration d)
+        {
+            auto const ms = ceil <std::chrono::milliseconds> (d);
+            s.lastSample = ms.count ();
+            if (ms.count () >= 10)
+                event_.notify (ms);
+        });
+        s.thread = std::thread ([&s, name, i, cpus]
+        {
+            beast::Thread::setCurrentThreadName (
+                name + " #" + std::to_string (i));
+            setCurrentThreadAffinity (cpus);
+            s.io_service.run ();
+        });
+    }
+}
+
+IOPool::~IOPool ()
+{
+    for (auto& s : services_)
+    {
+        s->probe.cancel ();
+        s->work = boost::none;
+    }
+    for (auto& s : services_)
+        s->thread.join ();
+}
+
+boost::asio::io_service&
+IOPool::next ()
+{
+    return services_[next_++ % services_.size ()]->io_service;
+}
+
+std::chrono::milliseconds
+IOPool::latency () const
+{
+    std::chrono::milliseconds::rep ms = 0;
+    for (auto const& s : services_)
+        ms = std::max (ms, s->lastSample.load ());
+    return std::chrono::milliseconds (ms);
+}
+
+}
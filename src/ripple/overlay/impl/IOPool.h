@@ -0,0 +1,79 @@
+#ifndef RIPPLE_OVERLAY_IOPOOL_H_INCLUDED
+#define RIPPLE_OVERLAY_IOPOOL_H_INCLUDED
+
+#include <ripple/basics/ThreadAffinity.h>
+#include <beast/asio/io_latency_probe.h>
+#include <beast/insight/Event.h>
+#include <boost/asio/io_service.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** A set of io_services, each run by a thread of its own.
+
+    Connections are opened on the services in turn and stay there, so
+    their I/O is spread over the threads instead of competing with the
+    rest of the application's I/O. The latency of each service is
+    sampled, like that of the application's io_service.
+*/
+class IOPool
+{
+public:
+    /** Create the services and start their threads.
+
+        @param threads The number of services, each with one thread.
+        @param event Notified of latency samples of 10ms or more.
+        @param cpus The processors the threads run on, or empty for any.
+    */
+    IOPool (std::size_t threads, std::string const& name,
+        beast::insight::Event event, CpuSet const& cpus = {});
+
+    /** Stops sampling, then waits for the pending work to finish. */
+    ~IOPool ();
+
+    bool
+    empty () const
+    {
+        return services_.empty ();
+    }
+
+    std::size_t
+    size () const
+    {
+        return services_.size ();
+    }
+
+    /** Returns the service which the next connection should use. */
+    boost::asio::io_service&
+    next ();
+
+    /** Returns the largest of the last latency samples of the services. */
+    std::chrono::milliseconds
+    latency () const;
+
+private:
+    struct Service
+    {
+        boost::asio::io_service io_service;
+        boost::optional<boost::asio::io_service::work> work;
+        beast::io_latency_probe <std::chrono::steady_clock> probe;
+        std::atomic <std::chrono::milliseconds::rep> lastSample {0};
+        std::thread thread;
+
+        Service ();
+    };
+
+    beast::insight::Event event_;
+    std::vector <std::unique_ptr <Service>> services_;
+    std::atomic <std::size_t> next_ {0};
+};
+
+}
+
+#endif
@@ -24,6 +24,7 @@
 #include <ripple/overlay/impl/Manifest.h>
 #include <ripple/protocol/RippleAddress.h>
 #include <ripple/protocol/Sign.h>
+#include <ripple/protocol/digest.h>
 #include <beast/http/rfc2616.h>
 #include <stdexcept>
 
@@ -160,7 +161,7 @@ void
 ManifestCache::configManifest (
     Manifest m, UniqueNodeList& unl, beast::Journal journal)
 {
-    if (! m.verify())
+    if (! verify (m))
     {
         Throw<std::runtime_error> ("Unverifiable manifest in config");
     }
@@ -225,6 +226,28 @@ ManifestCache::canApply (PublicKey const& pk, std::uint32_t seq,
     return ManifestDisposition::accepted;
 }
 
+// The most signature checks remembered, the memo is cleared beyond this
+static std::size_t const maxVerified = 4096;
+
+bool
+ManifestCache::verify (Manifest const& m) const
+{
+    auto const key = sha512Half (makeSlice (m.serialized));
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        auto const iter = verified_.find (key);
+        if (iter != verified_.end ())
+            return iter->second;
+    }
+
+    bool const valid = m.verify ();
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (verified_.size () >= maxVerified)
+        verified_.clear ();
+    verified_.emplace (key, valid);
+    return valid;
+}
 
 ManifestDisposition
 ManifestCache::applyManifest (
@@ -245,7 +268,7 @@ ManifestCache::applyManifest (
         }
     }
 
-    if (! m.verify())
+    if (! verify (m))
     {
         /*
           A manifest's signature is invalid.
@@ -351,7 +374,8 @@ void ManifestCache::load (
         convert (sociRawData, serialized);
         if (auto mo = make_Manifest (std::move (serialized)))
         {
-            if (!mo->verify())
+            // The result is remembered for applyManifest below
+            if (! verify (*mo))
             {
                 Throw<std::runtime_error> ("Unverifiable manifest in db");
             }
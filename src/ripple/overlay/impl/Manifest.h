@@ -151,10 +151,17 @@ private:
     mutable std::mutex mutex_;
     MapType map_;
 
+    // Results of signature checks, by the hash of the serialized manifest
+    mutable hash_map<uint256, bool> verified_;
+
     ManifestDisposition
     canApply (PublicKey const& pk, std::uint32_t seq,
         beast::Journal journal) const;
 
+    // Checks the signature of a manifest, once for each distinct manifest
+    bool
+    verify (Manifest const& m) const;
+
 public:
     ManifestCache() = default;
     ManifestCache (ManifestCache const&) = delete;
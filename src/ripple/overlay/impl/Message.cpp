@@ -20,17 +20,29 @@
 #include <BeastConfig.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <lz4/lib/lz4.h>
 #include <cstdint>
 
 namespace ripple {
 
+static
+MemoryTag&
+messageMemory ()
+{
+    static MemoryTag tag ("Message");
+    return tag;
+}
+
 Message::Message (::google::protobuf::Message const& message, int type)
+    : mCharge (messageMemory (), sizeof (*this))
 {
     unsigned const messageBytes = message.ByteSize ();
 
     assert (messageBytes != 0);
 
     mBuffer.resize (kHeaderBytes + messageBytes);
+    mCharge.add (mBuffer.capacity ());
 
     encodeHeader (messageBytes, type);
 
@@ -41,6 +53,60 @@ Message::Message (::google::protobuf::Message const& message, int type)
 
     mCategory = static_cast<int>(TrafficCount::categorize
         (message, type, false));
+
+    // Ledger data and fetch packs are the bulk of what peers send
+    mCompressible = messageBytes >= Tuning::compressMinBytes &&
+        messageBytes <= kMaxUncompressedBytes &&
+        (type == protocol::mtLEDGER_DATA || type == protocol::mtGET_OBJECTS);
+}
+
+std::vector <uint8_t> const&
+Message::getBuffer (bool compressed) const
+{
+    if (! compressed || ! mCompressible)
+        return mBuffer;
+
+    std::call_once (mCompressOnce, [this] { compress (); });
+
+    if (mCompressed.empty ())
+        return mBuffer;
+
+    return mCompressed;
+}
+
+void Message::compress () const
+{
+    auto const in = reinterpret_cast<char const*> (
+        &mBuffer [Message::kHeaderBytes]);
+    int const inSize = mBuffer.size () - Message::kHeaderBytes;
+    int const bound = LZ4_compressBound (inSize);
+
+    std::vector <uint8_t> out (Message::kHeaderBytes + 4 + bound);
+    int const outSize = LZ4_compress_default (in,
+        reinterpret_cast<char*> (&out [Message::kHeaderBytes + 4]),
+            inSize, bound);
+
+    // Keep the plain message if this does not make it smaller
+    if (outSize <= 0 ||
+            Message::kHeaderBytes + 4 + outSize >= mBuffer.size ())
+        return;
+
+    out.resize (Message::kHeaderBytes + 4 + outSize);
+
+    std::uint32_t const size = (4 + outSize) | kCompressedFlag;
+    out[0] = static_cast<std::uint8_t> ((size >> 24) & 0xFF);
+    out[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
+    out[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
+    out[3] = static_cast<std::uint8_t> (size & 0xFF);
+    out[4] = mBuffer[4];
+    out[5] = mBuffer[5];
+    out[6] = static_cast<std::uint8_t> ((inSize >> 24) & 0xFF);
+    out[7] = static_cast<std::uint8_t> ((inSize >> 16) & 0xFF);
+    out[8] = static_cast<std::uint8_t> ((inSize >> 8) & 0xFF);
+    out[9] = static_cast<std::uint8_t> (inSize & 0xFF);
+
+    mCompressed = std::move (out);
+    mCharge.add (mCompressed.capacity ());
 }
 
 bool Message::operator== (Message const& other) const
@@ -61,6 +127,7 @@ unsigned Message::getLength (std::vector <uint8_t> const& buf)
         result |= buf [2];
         result <<= 8;
         result |= buf [3];
+        result &= ~kCompressedFlag;
     }
     else
     {
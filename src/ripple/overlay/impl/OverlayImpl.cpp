@@ -18,8 +18,10 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/make_SSLContext.h>
@@ -30,6 +32,7 @@
 #include <ripple/overlay/impl/OverlayImpl.h>
 #include <ripple/overlay/impl/PeerImp.h>
 #include <ripple/overlay/impl/TMHello.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/peerfinder/make_Manager.h>
 #include <ripple/protocol/STExchange.h>
 #include <beast/ByteOrder.h>
@@ -117,7 +120,10 @@ OverlayImpl::Timer::on_timer (error_code ec)
     overlay_.autoConnect();
 
     if ((++overlay_.timer_count_ % Tuning::checkSeconds) == 0)
+    {
         overlay_.check();
+        overlay_.squelch_.sweep();
+    }
 
     timer_.expires_from_now (std::chrono::seconds(1));
     timer_.async_wait(overlay_.strand_.wrap(std::bind(
@@ -149,9 +155,27 @@ OverlayImpl::OverlayImpl (
         stopwatch(), app_.journal("PeerFinder"), config))
     , m_resolver (resolver)
     , next_id_(1)
+    , squelch_ (stopwatch(), Tuning::squelchSources,
+        Tuning::squelchMessages,
+            std::chrono::seconds (Tuning::squelchSeconds))
+    , serveQueue_ (Tuning::maxServing, Tuning::maxQueuedRequests)
+    , ioPool_ (setup.ioThreads, "overlay io", app_.getCollectorManager ().
+        group ("overlay")->make_event ("ios_latency"),
+            app_.config ().THREADS.io.cpus)
     , timer_count_(0)
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
+
+    auto const& group = app_.getCollectorManager ().group ("overlay");
+    for (auto i = TrafficCount::category::CT_base;
+        i < TrafficCount::category::CT_unknown;
+        i = static_cast<TrafficCount::category>(static_cast<int>(i) + 1))
+    {
+        std::string const name = TrafficCount::getName (i);
+        auto& timers = messageTimers_[i];
+        timers.wait = group->make_event (name + "_wait");
+        timers.handler = group->make_event (name + "_handler");
+    }
 }
 
 OverlayImpl::~OverlayImpl ()
@@ -357,8 +381,10 @@ OverlayImpl::connect (beast::IP::Endpoint const& remote_endpoint)
         return;
     }
 
+    // The peer stays on the io_service it connects on
+    auto& io_service = ioPool_.empty() ? io_service_ : ioPool_.next();
     auto const p = std::make_shared<ConnectAttempt>(app_,
-        io_service_, beast::IPAddressConversion::to_asio_endpoint(remote_endpoint),
+        io_service, beast::IPAddressConversion::to_asio_endpoint(remote_endpoint),
             usage, setup_.context, next_id_++, slot,
                 app_.journal("Peer"), *this);
 
@@ -615,6 +641,27 @@ OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
         item["messages_out"] =
             beast::lexicalCast<std::string>
                 (i.second.messagesOut.load());
+        item["bytes_in_uncompressed"] =
+            beast::lexicalCast<std::string>
+                (i.second.bytesInUncompressed.load());
+        item["bytes_out_uncompressed"] =
+            beast::lexicalCast<std::string>
+                (i.second.bytesOutUncompressed.load());
+
+        auto const histogram = [&item](std::string const& key,
+            TrafficCount::Histogram const& h)
+        {
+            if (! h)
+                return;
+            beast::PropertyStream::Map buckets (key, item);
+            for (int b = 0; b < TrafficCount::Histogram::size; ++b)
+                buckets[TrafficCount::Histogram::getName (b)] =
+                    beast::lexicalCast<std::string> (h.count (b));
+            item[key + "_total"] =
+                beast::lexicalCast<std::string> (h.total ());
+        };
+        histogram ("wait_us", i.second.wait);
+        histogram ("handler_us", i.second.handler);
     }
 }
 
@@ -659,9 +706,19 @@ void
 OverlayImpl::onPeerDeactivate (Peer::id_t id,
     RippleAddress const& publicKey)
 {
-    std::lock_guard <decltype(mutex_)> lock (mutex_);
-    m_shortIdMap.erase(id);
-    m_publicKeyMap.erase(publicKey);
+    {
+        std::lock_guard <decltype(mutex_)> lock (mutex_);
+        m_shortIdMap.erase(id);
+        m_publicKeyMap.erase(publicKey);
+    }
+
+    // The peers squelched in favor of this one have to be told to
+    // resume, since it was the source of some validators' messages
+    if (setup_.squelch)
+        for (auto const& validator : squelch_.remove (id))
+            unsquelch (validator);
+
+    serveQueue_.remove (id);
 }
 
 void
@@ -743,9 +800,61 @@ void
 OverlayImpl::reportTraffic (
     TrafficCount::category cat,
     bool isInbound,
-    int number)
+    int number,
+    int uncompressed)
+{
+    m_traffic.addCount (cat, isInbound, number, uncompressed);
+}
+
+// Like the job queue's, the insight events only report the slow ones
+void
+OverlayImpl::reportWait (TrafficCount::category cat,
+    std::chrono::microseconds elapsed)
+{
+    m_traffic.addWait (cat, elapsed);
+    if (elapsed >= std::chrono::milliseconds (10))
+    {
+        auto const iter = messageTimers_.find (cat);
+        if (iter != messageTimers_.end ())
+            iter->second.wait.notify (elapsed);
+    }
+}
+
+void
+OverlayImpl::reportHandler (TrafficCount::category cat,
+    std::chrono::microseconds elapsed)
 {
-    m_traffic.addCount (cat, isInbound, number);
+    m_traffic.addHandler (cat, elapsed);
+    if (elapsed >= std::chrono::milliseconds (10))
+    {
+        auto const iter = messageTimers_.find (cat);
+        if (iter != messageTimers_.end ())
+            iter->second.handler.notify (elapsed);
+    }
+}
+
+bool
+OverlayImpl::serve (Peer::id_t id, ServeQueue::Work work)
+{
+    if (! serveQueue_.push (id, std::move (work)))
+        return false;
+    startServing ();
+    return true;
+}
+
+void
+OverlayImpl::startServing ()
+{
+    while (auto work = serveQueue_.pop ())
+    {
+        app_.getJobQueue ().addJob (
+            jtLEDGER_REQ, "recvGetLedger",
+            [this, work] (Job&) {
+                work ();
+                serveQueue_.done ();
+                startServing ();
+            });
+    }
 }
 
 std::size_t
@@ -835,6 +944,43 @@ OverlayImpl::json ()
     return foreach (get_peer_json());
 }
 
+std::chrono::milliseconds
+OverlayImpl::getIOLatency ()
+{
+    if (ioPool_.empty ())
+        return app_.getIOLatency ();
+    return ioPool_.latency ();
+}
+
+Json::Value
+OverlayImpl::messageTimes ()
+{
+    auto const histogram = [](TrafficCount::Histogram const& h)
+    {
+        Json::Value ret (Json::objectValue);
+        for (int b = 0; b < TrafficCount::Histogram::size; ++b)
+            ret[TrafficCount::Histogram::getName (b)] =
+                std::to_string (h.count (b));
+        return ret;
+    };
+
+    Json::Value ret (Json::objectValue);
+    for (auto const& i : m_traffic.getCounts ())
+    {
+        auto const& stats = i.second;
+        if (! stats.wait && ! stats.handler)
+            continue;
+
+        Json::Value& times = (ret[i.first] = Json::objectValue);
+        times[jss::wait_us] = histogram (stats.wait);
+        times[jss::wait_total_us] = std::to_string (stats.wait.total ());
+        times[jss::handler_us] = histogram (stats.handler);
+        times[jss::handler_total_us] =
+            std::to_string (stats.handler.total ());
+    }
+    return ret;
+}
+
 bool
 OverlayImpl::processRequest (beast::http::message const& req,
     Handoff& handoff)
@@ -941,18 +1087,13 @@ OverlayImpl::relay (protocol::TMProposeSet& m,
         return;
     auto const sm = std::make_shared<Message>(
         m, protocol::mtPROPOSE_LEDGER);
-    for_each([&](std::shared_ptr<PeerImp> const& p)
-    {
-        if (skip.find(p->id()) != skip.end())
-            return;
-        if (! m.has_hops() || p->hopsAware())
-            p->send(sm);
-    });
+    relaySigned (sm, m.has_hops(), skip,
+        PublicKey (makeSlice (m.nodepubkey())));
 }
 
 void
 OverlayImpl::relay (protocol::TMValidation& m,
-    uint256 const& uid)
+    uint256 const& uid, PublicKey const& validator)
 {
     if (m.has_hops() && m.hops() >= maxTTL)
         return;
@@ -962,11 +1103,92 @@ OverlayImpl::relay (protocol::TMValidation& m,
         return;
     auto const sm = std::make_shared<Message>(
         m, protocol::mtVALIDATION);
+    relaySigned (sm, m.has_hops(), skip, validator);
+}
+
+void
+OverlayImpl::relay (protocol::TMTransaction const& m,
+    std::set<Peer::id_t> const& skip)
+{
+    // Built on first use: one message shared by the peers taking them
+    // one at a time, one copy shared by the peers batching them
+    std::shared_ptr<Message> sm;
+    std::shared_ptr<protocol::TMTransaction const> tx;
+    for_each([&](std::shared_ptr<PeerImp> const& p)
+    {
+        if (skip.count (p->id()))
+            return;
+        if (setup_.txBatch > 0 && p->txBatchAware())
+        {
+            if (! tx)
+                tx = std::make_shared<protocol::TMTransaction const>(m);
+            p->sendTransaction (tx);
+        }
+        else
+        {
+            if (! sm)
+                sm = std::make_shared<Message>(
+                    m, protocol::mtTRANSACTION);
+            p->send (sm);
+        }
+    });
+}
+
+void
+OverlayImpl::relaySigned (std::shared_ptr<Message> const& sm, bool hops,
+    std::set<Peer::id_t> const& skip, PublicKey const& validator)
+{
+    if (! setup_.squelch)
+    {
+        for_each([&](std::shared_ptr<PeerImp> const& p)
+        {
+            if (skip.find(p->id()) != skip.end())
+                return;
+            if (! hops || p->hopsAware())
+                p->send(sm);
+        });
+        return;
+    }
+
+    // Once the sources of the validator are chosen, every other peer
+    // which can be squelched is asked to stop relaying its messages.
+    std::shared_ptr<Message> squelch;
+    if (squelch_.deliver (validator, skip))
+    {
+        protocol::TMSquelch m;
+        m.set_squelch (true);
+        m.set_validatorpubkey (validator.data(), validator.size());
+        m.set_squelchduration (squelch_.duration().count());
+        squelch = std::make_shared<Message>(m, protocol::mtSQUELCH);
+        if (journal_.debug) journal_.debug <<
+            "Squelching " << toBase58 (TokenType::TOKEN_NODE_PUBLIC,
+                validator) << " for " << squelch_.duration().count() << "s";
+    }
+
     for_each([&](std::shared_ptr<PeerImp> const& p)
     {
+        if (squelch && p->squelchAware() && ! p->cluster() &&
+                ! squelch_.isSource (validator, p->id()))
+            p->send(squelch);
         if (skip.find(p->id()) != skip.end())
             return;
-        if (! m.has_hops() || p->hopsAware())
+        if (hops && ! p->hopsAware())
+            return;
+        if (! p->squelched (validator))
+            p->send(sm);
+    });
+}
+
+void
+OverlayImpl::unsquelch (PublicKey const& validator)
+{
+    protocol::TMSquelch m;
+    m.set_squelch (false);
+    m.set_validatorpubkey (validator.data(), validator.size());
+    auto const sm = std::make_shared<Message>(m, protocol::mtSQUELCH);
+    for_each([&](std::shared_ptr<PeerImp> const& p)
+    {
+        if (p->squelchAware() && ! p->cluster())
             p->send(sm);
     });
 }
@@ -1060,11 +1282,22 @@ setup_Overlay (BasicConfig const& config)
     auto const& section = config.section("overlay");
     setup.context = make_SSLContext();
     setup.expire = get<bool>(section, "expire", false);
+    setup.squelch = get<bool>(section, "squelch", false);
+    setup.compression = get<bool>(section, "compression", false);
+    setup.clusterFetch = get<bool>(section, "cluster_fetch", false);
 
     set (setup.ipLimit, "ip_limit", section);
     if (setup.ipLimit < 0)
         throw std::runtime_error ("Configured IP limit is invalid");
 
+    set (setup.ioThreads, "io_threads", section);
+    if (setup.ioThreads < 0)
+        Throw<std::runtime_error> ("Configured io_threads is invalid");
+
+    set (setup.txBatch, "tx_batch", section);
+    if (setup.txBatch < 0)
+        Throw<std::runtime_error> ("Configured tx_batch is invalid");
+
     std::string ip;
     set (ip, "public_ip", section);
     if (! ip.empty ())
@@ -23,7 +23,10 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/core/Job.h>
 #include <ripple/overlay/Overlay.h>
+#include <ripple/overlay/impl/IOPool.h>
 #include <ripple/overlay/impl/Manifest.h>
+#include <ripple/overlay/impl/ServeQueue.h>
+#include <ripple/overlay/impl/Squelch.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <ripple/server/Handoff.h>
 #include <ripple/server/ServerHandler.h>
@@ -37,10 +40,12 @@
 #include <boost/asio/strand.hpp>
 #include <boost/asio/basic_waitable_timer.hpp>
 #include <boost/container/flat_map.hpp>
+#include <beast/insight/Event.h>
 #include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -98,6 +103,13 @@ private:
         on_timer (error_code ec);
     };
 
+    // Insight events for the inbound messages of a traffic category
+    struct MessageTimers
+    {
+        beast::insight::Event wait;
+        beast::insight::Event handler;
+    };
+
     Application& app_;
     boost::asio::io_service& io_service_;
     boost::optional<boost::asio::io_service::work> work_;
@@ -113,6 +125,7 @@ private:
     Resource::Manager& m_resourceManager;
     std::unique_ptr <PeerFinder::Manager> m_peerFinder;
     TrafficCount m_traffic;
+    std::map <TrafficCount::category, MessageTimers> messageTimers_;
     hash_map <PeerFinder::Slot::ptr,
         std::weak_ptr <PeerImp>> m_peers;
     hash_map<RippleAddress, std::weak_ptr<PeerImp>> m_publicKeyMap;
@@ -120,6 +133,9 @@ private:
     Resolver& m_resolver;
     std::atomic <Peer::id_t> next_id_;
     ManifestCache manifestCache_;
+    Squelch squelch_;
+    ServeQueue serveQueue_;
+    IOPool ioPool_;
     int timer_count_;
 
     //--------------------------------------------------------------------------
@@ -194,7 +210,11 @@ public:
 
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) override;
+        uint256 const& uid, PublicKey const& validator) override;
+
+    void
+    relay (protocol::TMTransaction const& m,
+        std::set<Peer::id_t> const& skip) override;
 
     virtual
     void
@@ -273,7 +293,25 @@ public:
     reportTraffic (
         TrafficCount::category cat,
         bool isInbound,
-        int bytes);
+        int bytes,
+        int uncompressedBytes);
+
+    /** Count the time an inbound message waited in the job queue. */
+    void
+    reportWait (TrafficCount::category cat,
+        std::chrono::microseconds elapsed);
+
+    /** Count the time an inbound message's handler took. */
+    void
+    reportHandler (TrafficCount::category cat,
+        std::chrono::microseconds elapsed);
+
+    /** Queue a ledger request of a peer, to be served in turn.
+
+        @return `false` if the peer has too many requests waiting.
+    */
+    bool
+    serve (Peer::id_t id, ServeQueue::Work work);
 
 private:
     std::shared_ptr<HTTP::Writer>
@@ -297,6 +335,12 @@ private:
     Json::Value
     json() override;
 
+    Json::Value
+    messageTimes() override;
+
+    std::chrono::milliseconds
+    getIOLatency() override;
+
     bool
     processRequest (beast::http::message const& req,
         Handoff& handoff);
@@ -345,6 +389,17 @@ private:
 
     void
     sendEndpoints();
+
+    void
+    relaySigned (std::shared_ptr<Message> const& sm, bool hops,
+        std::set<Peer::id_t> const& skip, PublicKey const& validator);
+
+    void
+    unsquelch (PublicKey const& validator);
+
+    // Starts jobs for the waiting ledger requests, as many as can be
+    void
+    startServing();
 };
 
 } // ripple
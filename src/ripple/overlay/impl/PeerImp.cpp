@@ -28,6 +28,8 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/Transaction.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <ripple/app/misc/TxVerifier.h>
 #include <ripple/app/misc/UniqueNodeList.h>
 #include <ripple/app/misc/Validations.h>
 #include <ripple/app/tx/apply.h>
@@ -73,6 +75,7 @@ PeerImp::PeerImp (Application& app, id_t id, endpoint_type remote_endpoint,
     , stream_ (ssl_bundle_->stream)
     , strand_ (socket_.get_io_service())
     , timer_ (socket_.get_io_service())
+    , txTimer_ (socket_.get_io_service())
     , remote_address_ (
         beast::IPAddressConversion::from_asio(remote_endpoint))
     , overlay_ (overlay)
@@ -125,6 +128,7 @@ PeerImp::run()
             }
         }
     }
+    compressed_ = overlay_.setup().compression && compressionAware();
     if (m_inbound)
     {
         doAccept();
@@ -199,9 +203,10 @@ PeerImp::send (Message::pointer const& m)
 
     overlay_.reportTraffic (
         static_cast<TrafficCount::category>(m->getCategory()),
-        false, static_cast<int>(m->getBuffer().size()));
+        false, static_cast<int>(m->getBuffer(compressed_).size()),
+            static_cast<int>(m->getUncompressedSize()));
 
-    auto sendq_size = send_queue_.size();
+    auto sendq_size = sendQueueSize();
 
     if (sendq_size < Tuning::targetSendQueue)
     {
@@ -211,16 +216,94 @@ PeerImp::send (Message::pointer const& m)
         large_sendq_ = 0;
     }
 
-    send_queue_.push(m);
+    // Time our own requests for ledger data
+    {
+        auto const type = Message::getType(m->getBuffer());
+        auto const category =
+            static_cast<TrafficCount::category>(m->getCategory());
+        if ((type == protocol::mtGET_LEDGER ||
+                type == protocol::mtGET_OBJECTS) &&
+            (category == TrafficCount::category::CT_get_ledger ||
+                category == TrafficCount::category::CT_get_trans))
+        {
+            std::lock_guard<std::mutex> sl(recentLock_);
+            replyTimes_.onRequest (type == protocol::mtGET_OBJECTS ?
+                ReplyTimes::objects : ReplyTimes::ledger,
+                    clock_type::now());
+        }
+    }
+
+    auto const c = sendClass(*m);
+    send_queues_[c].push_back(m);
+    ++queued_[c];
 
-    if(sendq_size != 0)
+    if(! sending_.empty())
         return;
 
-    boost::asio::async_write (stream_, boost::asio::buffer(
-        send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
-            &PeerImp::onWriteMessage, shared_from_this(),
-                beast::asio::placeholders::error,
-                    beast::asio::placeholders::bytes_transferred)));
+    writeQueued();
+}
+
+void
+PeerImp::sendTransaction (
+    std::shared_ptr<protocol::TMTransaction const> const& tx)
+{
+    if (! strand_.running_in_this_thread())
+        return strand_.post(std::bind (
+            &PeerImp::sendTransaction, shared_from_this(), tx));
+    if(gracefulClose_)
+        return;
+    if(detaching_)
+        return;
+
+    txBatch_.push_back (tx);
+    if (txBatch_.size() >= Tuning::maxBatchTransactions)
+    {
+        error_code ec;
+        txTimer_.cancel (ec);
+        return flushTransactions();
+    }
+    if (txBatch_.size() > 1)
+        return;
+
+    error_code ec;
+    txTimer_.expires_from_now (std::chrono::milliseconds (
+        overlay_.setup().txBatch), ec);
+    if (ec)
+        return flushTransactions();
+    txTimer_.async_wait (strand_.wrap (std::bind (&PeerImp::onTxTimer,
+        shared_from_this(), beast::asio::placeholders::error)));
+}
+
+void
+PeerImp::flushTransactions()
+{
+    if (txBatch_.empty())
+        return;
+
+    // A lone transaction is sent the way peers always took them
+    if (txBatch_.size() == 1)
+    {
+        send (std::make_shared<Message> (
+            *txBatch_.front(), protocol::mtTRANSACTION));
+    }
+    else
+    {
+        protocol::TMTransactions m;
+        for (auto const& tx : txBatch_)
+            *m.add_transactions() = *tx;
+        send (std::make_shared<Message> (m, protocol::mtTRANSACTIONS));
+    }
+    txBatch_.clear();
+}
+
+void
+PeerImp::onTxTimer (error_code const& ec)
+{
+    if (ec == boost::asio::error::operation_aborted)
+        return;
+    if (! socket_.is_open())
+        return;
+    flushTransactions();
 }
 
 void
@@ -245,6 +328,37 @@ PeerImp::crawl() const
     return beast::ci_equal(iter->second, "public");
 }
 
+bool
+PeerImp::squelchAware() const
+{
+    auto const iter = http_message_.headers.find("Squelch");
+    if (iter == http_message_.headers.end())
+        return false;
+    return iter->second == "1";
+}
+
+bool
+PeerImp::compressionAware() const
+{
+    auto const iter = http_message_.headers.find("Compression");
+    if (iter == http_message_.headers.end())
+        return false;
+    return beast::ci_equal(iter->second, "lz4");
+}
+
+bool
+PeerImp::squelched (PublicKey const& validator)
+{
+    std::lock_guard<std::mutex> lock (squelchLock_);
+    auto const iter = squelched_.find (validator);
+    if (iter == squelched_.end())
+        return false;
+    if (iter->second > clock_type::now())
+        return true;
+    squelched_.erase (iter);
+    return false;
+}
+
 std::string
 PeerImp::getVersion() const
 {
@@ -325,6 +439,20 @@ PeerImp::json()
             break;
     }
 
+    {
+        auto const consensus = queued_[sendConsensus].load ();
+        auto const transactions = queued_[sendTransactions].load ();
+        auto const bulk = queued_[sendBulk].load ();
+
+        if (consensus || transactions || bulk)
+        {
+            Json::Value& queue = (ret[jss::send_queue] = Json::objectValue);
+            queue[jss::consensus] = static_cast<Json::UInt> (consensus);
+            queue[jss::transactions] = static_cast<Json::UInt> (transactions);
+            queue[jss::bulk] = static_cast<Json::UInt> (bulk);
+        }
+    }
+
     if (last_status_.has_newstatus ())
     {
         switch (last_status_.newstatus ())
@@ -420,6 +548,7 @@ PeerImp::close()
         detaching_ = true; // DEPRECATED
         error_code ec;
         timer_.cancel(ec);
+        txTimer_.cancel(ec);
         socket_.close(ec);
         if(m_inbound)
         {
@@ -464,12 +593,7 @@ PeerImp::gracefulClose()
     assert(socket_.is_open());
     assert(! gracefulClose_);
     gracefulClose_ = true;
-#if 0
-    // Flush messages
-    while(send_queue_.size() > 1)
-        send_queue_.pop_back();
-#endif
-    if (send_queue_.size() > 0)
+    if (sendQueueSize() > 0)
         return;
     setTimer();
     stream_.async_shutdown(strand_.wrap(std::bind(&PeerImp::onShutdown,
@@ -566,6 +690,11 @@ PeerImp::onTimer (error_code const& ec)
             latency_ = minLatency;
     }
 
+    {
+        std::lock_guard<std::mutex> sl(recentLock_);
+        replyTimes_.expire (clock_type::now());
+    }
+
     setTimer();
 }
 
@@ -665,8 +794,13 @@ PeerImp::makeResponse (bool crawl,
     resp.headers.append("Connect-AS", "Peer");
     resp.headers.append("Server", BuildInfo::getFullVersionString());
     resp.headers.append ("Crawl", crawl ? "public" : "private");
+    if (overlay_.setup().squelch)
+        resp.headers.append ("Squelch", "1");
+    if (overlay_.setup().compression && compressionAware())
+        resp.headers.append ("Compression", "lz4");
     protocol::TMHello hello = buildHello(sharedValue,
-        overlay_.setup().public_ip, remote, app_);
+        overlay_.setup().public_ip, remote,
+            overlay_.setup().txBatch > 0, app_);
     appendHello(resp, hello);
     return resp;
 }
@@ -775,6 +909,106 @@ PeerImp::onReadMessage (error_code ec, std::size_t bytes_transferred)
                 beast::asio::placeholders::bytes_transferred)));
 }
 
+PeerImp::SendClass
+PeerImp::sendClass (Message const& m)
+{
+    switch (Message::getType (m.getBuffer ()))
+    {
+    case protocol::mtTRANSACTION:
+    case protocol::mtTRANSACTIONS:
+        return sendTransactions;
+
+    case protocol::mtGET_LEDGER:
+    case protocol::mtLEDGER_DATA:
+    case protocol::mtGET_OBJECTS:
+        return sendBulk;
+
+    default:
+        break;
+    }
+    return sendConsensus;
+}
+
+std::size_t
+PeerImp::sendQueueSize () const
+{
+    auto n = sending_.size();
+    for (auto const& q : send_queues_)
+        n += q.size();
+    return n;
+}
+
+void
+PeerImp::writeQueued ()
+{
+    assert(sending_.empty() && sendQueueSize() != 0);
+
+    // The classes go in priority order, except that one which has been
+    // passed over for too many writes goes first, so that a peer busy
+    // with consensus traffic still gets its ledger data.
+    std::array<int, sendClasses> order = {{
+        sendConsensus, sendTransactions, sendBulk }};
+    for (auto i = order.begin(); i != order.end(); ++i)
+    {
+        if (starved_[*i] >= Tuning::sendStarvedWrites)
+        {
+            std::rotate(order.begin(), i, i + 1);
+            break;
+        }
+    }
+
+    // Take small messages until a batch is full
+    std::size_t bytes = 0;
+    bool full = false;
+    for (auto const c : order)
+    {
+        auto& q = send_queues_[c];
+        bool const waiting = ! q.empty();
+        bool taken = false;
+        while (! full && ! q.empty())
+        {
+            auto const size = q.front()->getBuffer(compressed_).size();
+            if (! sending_.empty() && bytes + size > Tuning::sendBatchBytes)
+            {
+                full = true;
+                break;
+            }
+            sending_.push_back(std::move(q.front()));
+            q.pop_front();
+            --queued_[c];
+            taken = true;
+            bytes += size;
+            full = bytes >= Tuning::sendBatchBytes;
+        }
+        starved_[c] = (waiting && ! taken) ? starved_[c] + 1 : 0;
+    }
+
+    // A single message is written straight from its buffer
+    if (sending_.size() == 1)
+    {
+        return boost::asio::async_write (stream_, boost::asio::buffer(
+            sending_.front()->getBuffer(compressed_)), strand_.wrap(std::bind(
+                &PeerImp::onWriteMessage, shared_from_this(),
+                    beast::asio::placeholders::error,
+                        beast::asio::placeholders::bytes_transferred)));
+    }
+
+    // Small messages are joined so they take one write and one TLS
+    // record instead of one for each
+    send_batch_.clear();
+    send_batch_.reserve(bytes);
+    for (auto const& m : sending_)
+    {
+        auto const& buffer = m->getBuffer(compressed_);
+        send_batch_.insert(send_batch_.end(), buffer.begin(), buffer.end());
+    }
+    boost::asio::async_write (stream_, boost::asio::buffer(
+        send_batch_), strand_.wrap(std::bind(
+            &PeerImp::onWriteMessage, shared_from_this(),
+                beast::asio::placeholders::error,
+                    beast::asio::placeholders::bytes_transferred)));
+}
+
 void
 PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
 {
@@ -792,16 +1026,12 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
             "onWriteMessage";
     }
 
-    assert(! send_queue_.empty());
-    send_queue_.pop();
-    if (! send_queue_.empty())
+    assert(! sending_.empty());
+    sending_.clear();
+    if (sendQueueSize() != 0)
     {
         // Timeout on writes only
-        return boost::asio::async_write (stream_, boost::asio::buffer(
-            send_queue_.front()->getBuffer()), strand_.wrap(std::bind(
-                &PeerImp::onWriteMessage, shared_from_this(),
-                    beast::asio::placeholders::error,
-                        beast::asio::placeholders::bytes_transferred)));
+        return writeQueued();
     }
 
     if (gracefulClose_)
@@ -830,13 +1060,27 @@ PeerImp::onMessageUnknown (std::uint16_t type)
 PeerImp::error_code
 PeerImp::onMessageBegin (std::uint16_t type,
     std::shared_ptr <::google::protobuf::Message> const& m,
-    std::size_t size)
+    std::size_t size, std::size_t uncompressedSize)
 {
     load_event_ = app_.getJobQueue ().getLoadEventAP (
         jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
-    overlay_.reportTraffic (TrafficCount::categorize (*m, type, true),
-        true, static_cast<int>(size));
+    auto const category = TrafficCount::categorize (*m, type, true);
+    overlay_.reportTraffic (category,
+        true, static_cast<int>(size), static_cast<int>(uncompressedSize));
+    category_ = category;
+    messageBegin_ = clock_type::now();
+
+    // Replies to our own requests for ledger data
+    if ((type == protocol::mtLEDGER_DATA ||
+            type == protocol::mtGET_OBJECTS) &&
+        (category == TrafficCount::category::CT_get_ledger ||
+            category == TrafficCount::category::CT_get_trans))
+    {
+        std::lock_guard<std::mutex> sl(recentLock_);
+        replyTimes_.onReply (type == protocol::mtGET_OBJECTS ?
+            ReplyTimes::objects : ReplyTimes::ledger, clock_type::now());
+    }
     return error_code{};
 }
 
@@ -846,6 +1090,8 @@ PeerImp::onMessageEnd (std::uint16_t,
 {
     load_event_.reset();
     charge (fee_);
+    overlay_.reportHandler (category_, std::chrono::duration_cast<
+        std::chrono::microseconds>(clock_type::now() - messageBegin_));
 }
 
 void
@@ -861,7 +1107,8 @@ PeerImp::onMessage (std::shared_ptr<protocol::TMManifests> const& m)
     auto that = shared_from_this();
     app_.getJobQueue().addJob (
         jtVALIDATION_ut, "receiveManifests",
-        [this, that, m] (Job&) { overlay_.onManifests(m, that); });
+        timeWait ([this, that, m] (Job&) {
+            overlay_.onManifests(m, that); }));
 }
 
 void
@@ -971,6 +1218,43 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMCluster> const& m)
     app_.getFeeTrack().setClusterFee(clusterFee);
 }
 
+void
+PeerImp::onMessage (std::shared_ptr <protocol::TMSquelch> const& m)
+{
+    // Only a peer we told we support squelching should send one
+    if (! overlay_.setup().squelch)
+    {
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
+
+    if (! publicKeyType (makeSlice (m->validatorpubkey())))
+    {
+        p_journal_.warning << "Squelch: malformed";
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
+    PublicKey const validator (makeSlice (m->validatorpubkey()));
+
+    std::lock_guard<std::mutex> lock (squelchLock_);
+    if (! m->squelch())
+    {
+        squelched_.erase (validator);
+        return;
+    }
+
+    auto const duration = std::chrono::seconds (std::min<std::uint32_t> (
+        m->has_squelchduration() ? m->squelchduration() :
+            Tuning::squelchSeconds, Tuning::maxSquelchSeconds));
+    auto const iter = squelched_.find (validator);
+    if (iter != squelched_.end())
+        iter->second = clock_type::now() + duration;
+    else if (squelched_.size() < Tuning::maxSquelched)
+        squelched_.emplace (validator, clock_type::now() + duration);
+    else
+        p_journal_.debug << "Squelch: too many validators";
+}
+
 void
 PeerImp::onMessage (std::shared_ptr <protocol::TMGetPeers> const& m)
 {
@@ -1062,36 +1346,97 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
         return;
     }
 
-    SerialIter sit (makeSlice(m->rawtransaction()));
+    recvTransaction (*m, fee_, false);
+}
 
-    try
+void
+PeerImp::onMessage (std::shared_ptr <protocol::TMTransactions> const& m)
+{
+    // Only a peer we told we accept batches should send one
+    if (overlay_.setup().txBatch <= 0)
     {
-        auto stx = std::make_shared<STTx const>(sit);
-        uint256 txID = stx->getTransactionID ();
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
 
-        int flags;
+    if (m->transactions_size() > Tuning::maxBatchTransactions)
+    {
+        fee_ = Resource::feeInvalidRequest;
+        return;
+    }
 
-        if (! app_.getHashRouter ().addSuppressionPeer (
-            txID, id_, flags))
-        {
-            // we have seen this transaction recently
-            if (flags & SF_BAD)
-            {
-                fee_ = Resource::feeInvalidSignature;
+    if (sanity_.load() == Sanity::insane)
+        return;
+
+    if (app_.getOPs().isNeedNetworkLedger ())
+        return;
+
+    // The whole batch is decoded in one job, and the signatures go to
+    // the TxVerifier together
+    app_.getJobQueue ().addJob (
+        jtTRANSACTION, "recvTransactions",
+        timeWait ([weak = std::weak_ptr<PeerImp>(shared_from_this()), m]
+            (Job&) {
+            auto peer = weak.lock();
+            if (! peer)
                 return;
+            for (auto const& tx : m->transactions())
+            {
+                Resource::Charge fee = Resource::feeLightPeer;
+                peer->recvTransaction (tx, fee, true);
+                if (fee != Resource::feeLightPeer)
+                    peer->charge (fee);
             }
+        }));
+}
 
-            if (!(flags & SF_RETRY))
-                return;
+void
+PeerImp::recvTransaction (protocol::TMTransaction const& m,
+    Resource::Charge& fee, bool inJob)
+{
+    int flags;
+
+    // Returns true if the transaction was seen recently and is dropped
+    auto const suppressed = [&](uint256 const& id)
+    {
+        if (app_.getHashRouter ().addSuppressionPeer (id, id_, flags))
+            return false;
+
+        // we have seen this transaction recently
+        if (flags & SF_BAD)
+        {
+            fee = Resource::feeInvalidSignature;
+            return true;
         }
 
+        return !(flags & SF_RETRY);
+    };
+
+    // The hash of a canonically serialized transaction is its ID, so a
+    // transaction seen recently is dropped before it is decoded.
+    auto const raw = makeSlice (m.rawtransaction ());
+    auto const rawID = sha512Half (HashPrefix::transactionID, raw);
+    if (suppressed (rawID))
+        return;
+
+    SerialIter sit (raw);
+
+    try
+    {
+        auto stx = std::make_shared<STTx const>(sit);
+        uint256 txID = stx->getTransactionID ();
+
+        if (txID != rawID && suppressed (txID))
+            return;
+
         p_journal_.debug <<
             "Got tx " << txID;
+        app_.getTxTrace ().mark (txID, TxTrace::Phase::received);
 
         bool checkSignature = true;
         if (cluster())
         {
-            if (! m->has_deferred () || ! m->deferred ())
+            if (! m.has_deferred () || ! m.deferred ())
             {
                 // Skip local checks if a server we trust
                 // put the transaction in its open ledger
@@ -1110,22 +1455,36 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
             p_journal_.info << "Transaction queue is full";
         else if (app_.getLedgerMaster().getValidatedLedgerAge() > 240)
             p_journal_.trace << "No new transactions until synchronized";
+        else if (checkSignature)
+        {
+            // The signature is checked along with other transactions',
+            // and checkTransaction finds the result cached
+            app_.getTxVerifier ().verify (stx,
+                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+                flags, stx] (Validity, std::string const&) {
+                    if (auto peer = weak.lock())
+                        peer->checkTransaction(flags, true, stx);
+                });
+        }
+        else if (inJob)
+        {
+            checkTransaction(flags, false, stx);
+        }
         else
         {
             app_.getJobQueue ().addJob (
                 jtTRANSACTION, "recvTransaction->checkTransaction",
-                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                flags, checkSignature, stx] (Job&) {
+                timeWait ([weak = std::weak_ptr<PeerImp>(shared_from_this()),
+                flags, stx] (Job&) {
                     if (auto peer = weak.lock())
-                        peer->checkTransaction(flags,
-                            checkSignature, stx);
-                });
+                        peer->checkTransaction(flags, false, stx);
+                }));
         }
     }
     catch (std::exception const&)
     {
         p_journal_.warning << "Transaction invalid: " <<
-            strHex(m->rawtransaction ());
+            strHex(m.rawtransaction ());
     }
 }
 
@@ -1134,12 +1493,28 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetLedger> const& m)
 {
     fee_ = Resource::feeMediumBurdenPeer;
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob (
-        jtLEDGER_REQ, "recvGetLedger",
-        [weak, m] (Job&) {
+
+    // Candidate sets are needed for consensus, so they are served at once.
+    // Ledger requests wait their turn behind those of other peers.
+    if (m->itype () == protocol::liTS_CANDIDATE)
+    {
+        app_.getJobQueue().addJob (
+            jtLEDGER_REQ, "recvGetLedger",
+            timeWait ([weak, m] (Job&) {
+                if (auto peer = weak.lock())
+                    peer->getLedger(m);
+            }));
+        return;
+    }
+
+    if (! overlay_.serve (id_, timeWait ([weak, m] {
             if (auto peer = weak.lock())
                 peer->getLedger(m);
-        });
+        })))
+    {
+        if (p_journal_.debug) p_journal_.debug <<
+            "GetLedger: Too many waiting requests";
+    }
 }
 
 void
@@ -1188,10 +1563,10 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMLedgerData> const& m)
         auto& journal = p_journal_;
         app_.getJobQueue().addJob(
             jtTXN_DATA, "recvPeerData",
-            [weak, hash, journal, m] (Job&) {
+            timeWait ([weak, hash, journal, m] (Job&) {
                 if (auto peer = weak.lock())
                     peer->peerTXData(hash, m, journal);
-            });
+            }));
         return;
     }
 
@@ -1290,10 +1665,10 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMProposeSet> const& m)
     std::weak_ptr<PeerImp> weak = shared_from_this();
     app_.getJobQueue ().addJob (
         isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut, "recvPropose->checkPropose",
-        [weak, m, proposal] (Job& job) {
+        timeWait ([weak, m, proposal] (Job& job) {
             if (auto peer = weak.lock())
                 peer->checkPropose(job, m, proposal);
-        });
+        }));
 }
 
 void
@@ -1602,10 +1977,10 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMValidation> const& m)
             app_.getJobQueue ().addJob (
                 isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
                 "recvValidation->checkValidation",
-                [weak, val, isTrusted, m] (Job&) {
+                timeWait ([weak, val, isTrusted, m] (Job&) {
                     if (auto peer = weak.lock())
                         peer->checkValidation(val, isTrusted, m);
-                });
+                }));
         }
         else
         {
@@ -1629,7 +2004,7 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
     if (packet.query ())
     {
         // this is a query
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (sendQueueSize() >= Tuning::dropSendQueue)
         {
             if (p_journal_.debug) p_journal_.debug <<
                 "GetObject: Large send queue";
@@ -1675,7 +2050,7 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
                 {
                     protocol::TMIndexedObject& newObj = *reply.add_objects ();
                     newObj.set_hash (hash.begin (), hash.size ());
-                    newObj.set_data (&hObj->getData ().front (),
+                    newObj.set_data (hObj->getData ().data (),
                         hObj->getData ().size ());
 
                     if (obj.has_nodeid ())
@@ -1811,10 +2186,10 @@ PeerImp::doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet
     auto const pap = &app_;
     app_.getJobQueue ().addJob (
         jtPACK, "MakeFetchPack",
-        [pap, weak, packet, hash, elapsed] (Job&) {
+        timeWait ([pap, weak, packet, hash, elapsed] (Job&) {
             pap->getLedgerMaster().makeFetchPack(
                 weak, packet, hash, elapsed);
-        });
+        }));
 }
 
 void
@@ -1900,6 +2275,27 @@ PeerImp::checkPropose (Job& job,
     assert (packet);
     protocol::TMProposeSet& set = *packet;
 
+    if (! isTrusted)
+    {
+        // An untrusted proposal is only relayed, so there is no need
+        // to check the signature of one that will not be
+        uint256 consensusLCL;
+        {
+            std::lock_guard<Application::MutexType> lock (app_.getMasterMutex());
+            consensusLCL = app_.getOPs ().getConsensusLCL ();
+        }
+
+        if (consensusLCL != proposal->getPrevLedger())
+        {
+            p_journal_.debug <<
+                "Not relaying UNTRUSTED proposal";
+            return;
+        }
+    }
+
+    // The signature is checked here, on the job queue, so that consensus
+    // only ever sees proposals that are already verified and does no
+    // signature checking while it holds the master lock.
     if (! cluster() && ! proposal->checkSign (set.signature ()))
     {
         p_journal_.warning <<
@@ -1915,24 +2311,10 @@ PeerImp::checkPropose (Job& job,
     }
     else
     {
-        uint256 consensusLCL;
-        {
-            std::lock_guard<Application::MutexType> lock (app_.getMasterMutex());
-            consensusLCL = app_.getOPs ().getConsensusLCL ();
-        }
-
-        if (consensusLCL == proposal->getPrevLedger())
-        {
-            // relay untrusted proposal
-            p_journal_.trace <<
-                "relaying UNTRUSTED proposal";
-            overlay_.relay(set, proposal->getSuppressionID());
-        }
-        else
-        {
-            p_journal_.debug <<
-                "Not relaying UNTRUSTED proposal";
-        }
+        // relay untrusted proposal
+        p_journal_.trace <<
+            "relaying UNTRUSTED proposal";
+        overlay_.relay(set, proposal->getSuppressionID());
     }
 }
 
@@ -1954,7 +2336,16 @@ PeerImp::checkValidation (STValidation::pointer val,
 
         if (app_.getOPs ().recvValidation(
                 val, std::to_string(id())))
-            overlay_.relay(*packet, signingHash);
+        {
+            // Relaying is keyed by the signing hash, so this peer is
+            // noted under it: the validation is not sent back here and
+            // the peer counts as having delivered it.
+            app_.getHashRouter ().addSuppressionPeer (signingHash, id_);
+            auto const signer = val->getSignerPublic ().getNodePublic ();
+            if (publicKeyType (makeSlice (signer)))
+                overlay_.relay(*packet, signingHash,
+                    PublicKey (makeSlice (signer)));
+        }
     }
     catch (std::exception const&)
     {
@@ -2090,7 +2481,7 @@ PeerImp::getLedger (std::shared_ptr<protocol::TMGetLedger> const& m)
     }
     else
     {
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (sendQueueSize() >= Tuning::dropSendQueue)
         {
             if (p_journal_.debug) p_journal_.debug <<
                 "GetLedger: Large send queue";
@@ -2300,7 +2691,7 @@ PeerImp::getLedger (std::shared_ptr<protocol::TMGetLedger> const& m)
         }
 
         std::vector<SHAMapNodeID> nodeIDs;
-        std::vector< Blob > rawNodes;
+        std::vector<SerializedNode::pointer> rawNodes;
 
         try
         {
@@ -2312,7 +2703,7 @@ PeerImp::getLedger (std::shared_ptr<protocol::TMGetLedger> const& m)
                 if (p_journal_.trace) p_journal_.trace <<
                     "GetLedger: getNodeFat got " << rawNodes.size () << " nodes";
                 std::vector<SHAMapNodeID>::iterator nodeIDIterator;
-                std::vector< Blob >::iterator rawNodeIterator;
+                std::vector<SerializedNode::pointer>::iterator rawNodeIterator;
 
                 for (nodeIDIterator = nodeIDs.begin (),
                         rawNodeIterator = rawNodes.begin ();
@@ -2323,8 +2714,8 @@ PeerImp::getLedger (std::shared_ptr<protocol::TMGetLedger> const& m)
                     nodeIDIterator->addIDRaw (nID);
                     protocol::TMLedgerNode* node = reply.add_nodes ();
                     node->set_nodeid (nID.getDataPtr (), nID.getLength ());
-                    node->set_nodedata (&rawNodeIterator->front (),
-                        rawNodeIterator->size ());
+                    auto const data = (*rawNodeIterator)->slice ();
+                    node->set_nodedata (data.data (), data.size ());
                 }
             }
             else
@@ -2390,22 +2781,42 @@ PeerImp::getScore (bool haveItem) const
    // Should be roughly spRandom
    static const int spNoLatency =   8000;
 
+   // Score reduction for each millisecond a peer takes to answer
+   // our requests for ledger data, up to spMaxReply milliseconds.
+   // Peers not yet asked aren't penalized
+   static const int spReply    =       5;
+   static const int spMaxReply =    2000;
+
+   // Score for a cluster peer having the thing we are looking for,
+   // when cluster peers are asked first.
+   // Should be more than all the other components together
+   static const int spCluster  =  100000;
+
    int score = rand() % spRandom;
 
    if (haveItem)
+   {
        score += spHaveItem;
+       if (overlay_.setup().clusterFetch && cluster())
+           score += spCluster;
+   }
 
    std::chrono::milliseconds latency;
+   std::chrono::milliseconds reply;
    {
        std::lock_guard<std::mutex> sl (recentLock_);
 
        latency = latency_;
+       reply = replyTimes_.average();
    }
    if (latency != std::chrono::milliseconds (-1))
        score -= latency.count() * spLatency;
    else
        score -= spNoLatency;
 
+   if (reply != std::chrono::milliseconds (-1))
+       score -= std::min<int> (reply.count(), spMaxReply) * spReply;
+
    return score;
 }
 
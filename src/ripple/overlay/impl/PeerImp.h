@@ -26,6 +26,8 @@
 #include <ripple/overlay/predicates.h>
 #include <ripple/overlay/impl/ProtocolMessage.h>
 #include <ripple/overlay/impl/OverlayImpl.h>
+#include <ripple/overlay/impl/ReplyTimes.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/Job.h>
@@ -42,9 +44,13 @@
 #include <beast/http/message.h>
 #include <beast/http/parser.h>
 #include <beast/utility/WrappedSink.h>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <deque>
-#include <queue>
+#include <map>
+#include <vector>
 
 namespace ripple {
 
@@ -100,6 +106,15 @@ private:
     // The length of the smallest valid finished message
     static const size_t sslMinimumFinishedLength = 12;
 
+    // The classes of queued message, in the order they are sent
+    enum SendClass
+    {
+        sendConsensus       // proposals, validations and peer upkeep
+        ,sendTransactions
+        ,sendBulk           // ledger data and requests for it
+        ,sendClasses
+    };
+
     Application& app_;
     id_t const id_;
     beast::WrappedSink sink_;
@@ -112,6 +127,8 @@ private:
     boost::asio::io_service::strand strand_;
     boost::asio::basic_waitable_timer<
         std::chrono::steady_clock> timer_;
+    boost::asio::basic_waitable_timer<
+        std::chrono::steady_clock> txTimer_;
 
     //Type type_ = Type::legacy;
 
@@ -144,6 +161,8 @@ private:
     std::chrono::milliseconds latency_ = std::chrono::milliseconds (-1);
     std::uint64_t lastPingSeq_ = 0;
     clock_type::time_point lastPingTime_;
+    ReplyTimes replyTimes_ {std::chrono::seconds (Tuning::replyTimeoutSeconds),
+        Tuning::maxPendingReplies};
     clock_type::time_point creationTime_;
 
     std::mutex mutable recentLock_;
@@ -156,12 +175,28 @@ private:
     beast::http::message http_message_;
     beast::http::body http_body_;
     beast::asio::streambuf write_buffer_;
-    std::queue<Message::pointer> send_queue_;
+    // Queued messages, one queue for each class
+    std::array<std::deque<Message::pointer>, sendClasses> send_queues_;
+    std::array<std::atomic<std::size_t>, sendClasses> queued_ {};
+    std::array<int, sendClasses> starved_ {};
+    std::vector<Message::pointer> sending_;   // messages being written
+    std::vector<std::uint8_t> send_batch_;
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     int no_ping_ = 0;
     std::unique_ptr <LoadEvent> load_event_;
+    // The inbound message being handled and when its handler began
+    TrafficCount::category category_ = TrafficCount::category::CT_unknown;
+    clock_type::time_point messageBegin_;
     bool hopsAware_ = false;
+    bool compressed_ = false;
+
+    // Validators whose messages the peer asked us not to relay to it
+    std::mutex mutable squelchLock_;
+    std::map<PublicKey, clock_type::time_point> squelched_;
+
+    // Relayed transactions waiting to be sent together
+    std::vector<std::shared_ptr<protocol::TMTransaction const>> txBatch_;
 
     friend class OverlayImpl;
 
@@ -217,6 +252,11 @@ public:
     void
     send (Message::pointer const& m) override;
 
+    /** Relay a transaction with others sent in the next few milliseconds. */
+    void
+    sendTransaction (
+        std::shared_ptr<protocol::TMTransaction const> const& tx);
+
     /** Send a set of PeerFinder endpoints as a protocol message. */
     template <class FwdIt, class = typename std::enable_if_t<std::is_same<
         typename std::iterator_traits<FwdIt>::value_type,
@@ -258,6 +298,25 @@ public:
         return hopsAware_;
     }
 
+    /** Returns `true` if the peer can be asked to stop relaying. */
+    bool
+    squelchAware() const;
+
+    /** Returns `true` if the peer accepts compressed messages. */
+    bool
+    compressionAware() const;
+
+    /** Returns `true` if the peer accepts transactions sent together. */
+    bool
+    txBatchAware() const
+    {
+        return hello_.has_txbatch() && hello_.txbatch();
+    }
+
+    /** Returns `true` if the peer asked us not to relay a validator. */
+    bool
+    squelched (PublicKey const& validator);
+
     void
     check();
 
@@ -379,6 +438,19 @@ private:
     void
     onReadMessage (error_code ec, std::size_t bytes_transferred);
 
+    // Returns the class a message is queued in
+    static
+    SendClass
+    sendClass (Message const& m);
+
+    // Returns the number of messages queued or being written
+    std::size_t
+    sendQueueSize () const;
+
+    // Writes the messages at the front of the send queues
+    void
+    writeQueued ();
+
     // Called when protocol messages bytes are sent
     void
     onWriteMessage (error_code ec, std::size_t bytes_transferred);
@@ -404,7 +476,7 @@ public:
     error_code
     onMessageBegin (std::uint16_t type,
         std::shared_ptr <::google::protobuf::Message> const& m,
-        std::size_t size);
+        std::size_t size, std::size_t uncompressedSize);
 
     void
     onMessageEnd (std::uint16_t type,
@@ -414,10 +486,12 @@ public:
     void onMessage (std::shared_ptr <protocol::TMManifests> const& m);
     void onMessage (std::shared_ptr <protocol::TMPing> const& m);
     void onMessage (std::shared_ptr <protocol::TMCluster> const& m);
+    void onMessage (std::shared_ptr <protocol::TMSquelch> const& m);
     void onMessage (std::shared_ptr <protocol::TMGetPeers> const& m);
     void onMessage (std::shared_ptr <protocol::TMPeers> const& m);
     void onMessage (std::shared_ptr <protocol::TMEndpoints> const& m);
     void onMessage (std::shared_ptr <protocol::TMTransaction> const& m);
+    void onMessage (std::shared_ptr <protocol::TMTransactions> const& m);
     void onMessage (std::shared_ptr <protocol::TMGetLedger> const& m);
     void onMessage (std::shared_ptr <protocol::TMLedgerData> const& m);
     void onMessage (std::shared_ptr <protocol::TMProposeSet> const& m);
@@ -439,6 +513,15 @@ private:
 
     //--------------------------------------------------------------------------
 
+    /** Wrap work deferred while handling the current inbound message.
+
+        The time the work waits to run is counted against the message's
+        traffic category.
+    */
+    template <class Handler>
+    auto
+    timeWait (Handler&& handler);
+
     void
     sendGetPeers();
 
@@ -448,6 +531,20 @@ private:
     void
     doFetchPack (const std::shared_ptr<protocol::TMGetObjectByHash>& packet);
 
+    // Sends the transactions waiting to be sent together
+    void
+    flushTransactions();
+
+    void
+    onTxTimer (boost::system::error_code const& ec);
+
+    // Suppresses, decodes and checks a transaction from the peer. A bad
+    // signature seen before sets fee. In a job, a transaction whose
+    // signature is not checked is checked at once instead of in a job.
+    void
+    recvTransaction (protocol::TMTransaction const& m,
+        Resource::Charge& fee, bool inJob);
+
     void
     checkTransaction (int flags, bool checkSignature,
         std::shared_ptr<STTx const> const& stx);
@@ -473,6 +570,22 @@ private:
 
 //------------------------------------------------------------------------------
 
+template <class Handler>
+auto
+PeerImp::timeWait (Handler&& handler)
+{
+    auto& overlay = overlay_;
+    auto const cat = category_;
+    auto const queued = clock_type::now();
+    return [&overlay, cat, queued, handler = std::forward<Handler>(handler)]
+        (auto&... args) mutable
+    {
+        overlay.reportWait (cat, std::chrono::duration_cast<
+            std::chrono::microseconds>(clock_type::now() - queued));
+        handler (args...);
+    };
+}
+
 template <class Buffers>
 PeerImp::PeerImp (Application& app, std::unique_ptr<beast::asio::ssl_bundle>&& ssl_bundle,
     Buffers const& buffers, PeerFinder::Slot::ptr&& slot,
@@ -492,6 +605,7 @@ PeerImp::PeerImp (Application& app, std::unique_ptr<beast::asio::ssl_bundle>&& s
     , stream_ (ssl_bundle_->stream)
     , strand_ (socket_.get_io_service())
     , timer_ (socket_.get_io_service())
+    , txTimer_ (socket_.get_io_service())
     , remote_address_ (slot->remote_endpoint())
     , overlay_ (overlay)
     , m_inbound (false)
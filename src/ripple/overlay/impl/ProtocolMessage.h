@@ -23,6 +23,7 @@
 #include "ripple.pb.h"
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/ZeroCopyStream.h>
+#include <lz4/lib/lz4.h>
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
@@ -46,10 +47,12 @@ protocolMessageName (int type)
     case protocol::mtPING:              return "ping";
     case protocol::mtPROOFOFWORK:       return "proof_of_work";
     case protocol::mtCLUSTER:           return "cluster";
+    case protocol::mtSQUELCH:           return "squelch";
     case protocol::mtGET_PEERS:         return "get_peers";
     case protocol::mtPEERS:             return "peers";
     case protocol::mtENDPOINTS:         return "endpoints";
     case protocol::mtTRANSACTION:       return "tx";
+    case protocol::mtTRANSACTIONS:      return "txs";
     case protocol::mtGET_LEDGER:        return "get_ledger";
     case protocol::mtLEDGER_DATA:       return "ledger_data";
     case protocol::mtPROPOSE_LEDGER:    return "propose";
@@ -70,7 +73,7 @@ std::enable_if_t<std::is_base_of<
     ::google::protobuf::Message, T>::value,
         boost::system::error_code>
 invoke (int type, Buffers const& buffers,
-    Handler& handler)
+    Handler& handler, std::size_t wireBytes)
 {
     ZeroCopyInputStream<Buffers> stream(buffers);
     stream.Skip(Message::kHeaderBytes);
@@ -78,7 +81,7 @@ invoke (int type, Buffers const& buffers,
     if (! m->ParseFromZeroCopyStream(&stream))
         return boost::system::errc::make_error_code(
             boost::system::errc::invalid_argument);
-    auto ec = handler.onMessageBegin (type, m,
+    auto ec = handler.onMessageBegin (type, m, wireBytes,
        Message::kHeaderBytes + Message::size (buffers));
     if (! ec)
     {
@@ -88,6 +91,43 @@ invoke (int type, Buffers const& buffers,
     return ec;
 }
 
+/** Expand a compressed message into a plain one.
+
+    @return `false` if the message is malformed.
+*/
+template <class Buffers>
+bool
+decompress (Buffers const& buffers, std::size_t size,
+    std::vector<std::uint8_t>& plain)
+{
+    if (size < Message::kHeaderBytes + 4)
+        return false;
+    std::vector<std::uint8_t> in (size);
+    boost::asio::buffer_copy (boost::asio::buffer (in), buffers);
+
+    std::size_t n;
+    n  = std::size_t{in[6]} << 24;
+    n += std::size_t{in[7]} << 16;
+    n += std::size_t{in[8]} <<  8;
+    n += std::size_t{in[9]};
+    if (n == 0 || n > Message::kMaxUncompressedBytes)
+        return false;
+
+    plain.resize (Message::kHeaderBytes + n);
+    plain[0] = static_cast<std::uint8_t>((n >> 24) & 0xFF);
+    plain[1] = static_cast<std::uint8_t>((n >> 16) & 0xFF);
+    plain[2] = static_cast<std::uint8_t>((n >>  8) & 0xFF);
+    plain[3] = static_cast<std::uint8_t>( n        & 0xFF);
+    plain[4] = in[4];
+    plain[5] = in[5];
+    auto const used = Message::kHeaderBytes + 4;
+    return LZ4_decompress_safe (
+        reinterpret_cast<char const*>(&in[used]),
+        reinterpret_cast<char*>(&plain[Message::kHeaderBytes]),
+        static_cast<int>(size - used), static_cast<int>(n)) ==
+            static_cast<int>(n);
+}
+
 }
 
 /** Calls the handler for up to one protocol message in the passed buffers.
@@ -111,23 +151,50 @@ invokeProtocolMessage (Buffers const& buffers, Handler& handler)
     if (boost::asio::buffer_size(buffers) < size)
         return result;
 
+    if (Message::compressed(buffers))
+    {
+        // Only the large message types are ever compressed
+        std::vector<std::uint8_t> plain;
+        if (! detail::decompress (buffers, size, plain))
+        {
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+            return result;
+        }
+        auto const b = boost::asio::buffer (plain);
+        switch (type)
+        {
+        case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, b, handler, size); break;
+        case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, b, handler, size); break;
+        default:
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+            break;
+        }
+        if (! ec)
+            result.first = size;
+        return result;
+    }
+
     switch (type)
     {
-    case protocol::mtHELLO:         ec = detail::invoke<protocol::TMHello> (type, buffers, handler); break;
-    case protocol::mtMANIFESTS:     ec = detail::invoke<protocol::TMManifests> (type, buffers, handler); break;
-    case protocol::mtPING:          ec = detail::invoke<protocol::TMPing> (type, buffers, handler); break;
-    case protocol::mtCLUSTER:       ec = detail::invoke<protocol::TMCluster> (type, buffers, handler); break;
-    case protocol::mtGET_PEERS:     ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler); break;
-    case protocol::mtPEERS:         ec = detail::invoke<protocol::TMPeers> (type, buffers, handler); break;
-    case protocol::mtENDPOINTS:     ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler); break;
-    case protocol::mtTRANSACTION:   ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler); break;
-    case protocol::mtGET_LEDGER:    ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler); break;
-    case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler); break;
-    case protocol::mtPROPOSE_LEDGER:ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler); break;
-    case protocol::mtSTATUS_CHANGE: ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler); break;
-    case protocol::mtHAVE_SET:      ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler); break;
-    case protocol::mtVALIDATION:    ec = detail::invoke<protocol::TMValidation> (type, buffers, handler); break;
-    case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler); break;
+    case protocol::mtHELLO:         ec = detail::invoke<protocol::TMHello> (type, buffers, handler, size); break;
+    case protocol::mtMANIFESTS:     ec = detail::invoke<protocol::TMManifests> (type, buffers, handler, size); break;
+    case protocol::mtPING:          ec = detail::invoke<protocol::TMPing> (type, buffers, handler, size); break;
+    case protocol::mtCLUSTER:       ec = detail::invoke<protocol::TMCluster> (type, buffers, handler, size); break;
+    case protocol::mtSQUELCH:       ec = detail::invoke<protocol::TMSquelch> (type, buffers, handler, size); break;
+    case protocol::mtGET_PEERS:     ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler, size); break;
+    case protocol::mtPEERS:         ec = detail::invoke<protocol::TMPeers> (type, buffers, handler, size); break;
+    case protocol::mtENDPOINTS:     ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler, size); break;
+    case protocol::mtTRANSACTION:   ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler, size); break;
+    case protocol::mtTRANSACTIONS:  ec = detail::invoke<protocol::TMTransactions> (type, buffers, handler, size); break;
+    case protocol::mtGET_LEDGER:    ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler, size); break;
+    case protocol::mtLEDGER_DATA:   ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler, size); break;
+    case protocol::mtPROPOSE_LEDGER:ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler, size); break;
+    case protocol::mtSTATUS_CHANGE: ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler, size); break;
+    case protocol::mtHAVE_SET:      ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler, size); break;
+    case protocol::mtVALIDATION:    ec = detail::invoke<protocol::TMValidation> (type, buffers, handler, size); break;
+    case protocol::mtGET_OBJECTS:   ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler, size); break;
     default:
         ec = handler.onMessageUnknown (type);
         break;
@@ -0,0 +1,74 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/ReplyTimes.h>
+#include <algorithm>
+
+namespace ripple {
+
+ReplyTimes::ReplyTimes (std::chrono::milliseconds timeout,
+        std::size_t maxPending)
+    : timeout_ (timeout)
+    , maxPending_ (std::max<std::size_t> (maxPending, 1))
+{
+    average_.fill (std::chrono::milliseconds (-1));
+}
+
+void
+ReplyTimes::onRequest (Kind kind, clock_type::time_point now)
+{
+    auto& pending = pending_[kind];
+
+    // The peer is ignoring us, the oldest request won't be answered
+    if (pending.size () >= maxPending_)
+    {
+        pending.pop_front ();
+        sample (kind, timeout_);
+    }
+
+    pending.push_back (now);
+}
+
+void
+ReplyTimes::onReply (Kind kind, clock_type::time_point now)
+{
+    expire (now);
+
+    auto& pending = pending_[kind];
+    if (pending.empty ())
+        return;
+
+    sample (kind, std::chrono::duration_cast<std::chrono::milliseconds> (
+        now - pending.front ()));
+    pending.pop_front ();
+}
+
+void
+ReplyTimes::expire (clock_type::time_point now)
+{
+    for (int kind = 0; kind < kinds; ++kind)
+    {
+        auto& pending = pending_[kind];
+        while (! pending.empty () && now - pending.front () >= timeout_)
+        {
+            pending.pop_front ();
+            sample (static_cast<Kind> (kind), timeout_);
+        }
+    }
+}
+
+std::chrono::milliseconds
+ReplyTimes::average () const
+{
+    return *std::max_element (average_.begin (), average_.end ());
+}
+
+void
+ReplyTimes::sample (Kind kind, std::chrono::milliseconds elapsed)
+{
+    auto& average = average_[kind];
+    if (average == std::chrono::milliseconds (-1))
+        average = elapsed;
+    else
+        average = (average * 7 + elapsed) / 8;
+}
+
+} // ripple
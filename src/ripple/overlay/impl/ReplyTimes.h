@@ -0,0 +1,74 @@
+#ifndef RIPPLE_OVERLAY_REPLYTIMES_H_INCLUDED
+#define RIPPLE_OVERLAY_REPLYTIMES_H_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+
+namespace ripple {
+
+/** Measures how quickly a peer answers our requests for ledger data.
+
+    The times our requests of each kind were sent are kept in order, and
+    each reply of that kind is matched with the oldest of them. Requests
+    left unanswered for the timeout count as replies which took that long.
+    A moving average of the reply times is kept for each kind.
+*/
+class ReplyTimes
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    enum Kind
+    {
+        ledger      // TMGetLedger answered by TMLedgerData
+        ,objects    // TMGetObjectByHash queries
+        ,kinds
+    };
+
+    /** Create the measures.
+
+        @param timeout How long before a request counts as unanswered.
+        @param maxPending The most requests of each kind remembered.
+    */
+    ReplyTimes (std::chrono::milliseconds timeout, std::size_t maxPending);
+
+    /** Note that a request was sent. */
+    void
+    onRequest (Kind kind, clock_type::time_point now);
+
+    /** Note that a reply was received. */
+    void
+    onReply (Kind kind, clock_type::time_point now);
+
+    /** Count the requests which have now gone unanswered too long. */
+    void
+    expire (clock_type::time_point now);
+
+    /** Returns the average reply time, or -1 if there is none yet. */
+    /** @{ */
+    std::chrono::milliseconds
+    average (Kind kind) const
+    {
+        return average_[kind];
+    }
+
+    // The slowest of the kinds
+    std::chrono::milliseconds
+    average () const;
+    /** @} */
+
+private:
+    void
+    sample (Kind kind, std::chrono::milliseconds elapsed);
+
+    std::chrono::milliseconds const timeout_;
+    std::size_t const maxPending_;
+    std::array<std::deque<clock_type::time_point>, kinds> pending_;
+    std::array<std::chrono::milliseconds, kinds> average_;
+};
+
+} // ripple
+
+#endif
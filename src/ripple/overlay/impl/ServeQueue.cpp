@@ -0,0 +1,81 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/ServeQueue.h>
+#include <algorithm>
+#include <cassert>
+
+namespace ripple {
+
+ServeQueue::ServeQueue (std::size_t maxActive, std::size_t maxQueued)
+    : maxActive_ (std::max<std::size_t> (maxActive, 1))
+    , maxQueued_ (std::max<std::size_t> (maxQueued, 1))
+{
+}
+
+bool
+ServeQueue::push (Peer::id_t id, Work work)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto& q = queues_[id];
+    if (q.size () >= maxQueued_)
+        return false;
+    if (q.empty ())
+        turns_.push_back (id);
+    q.push_back (std::move (work));
+    ++queued_;
+    return true;
+}
+
+ServeQueue::Work
+ServeQueue::pop ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (active_ >= maxActive_ || turns_.empty ())
+        return {};
+
+    auto const id = turns_.front ();
+    turns_.pop_front ();
+    auto const iter = queues_.find (id);
+    assert (iter != queues_.end () && ! iter->second.empty ());
+    auto work = std::move (iter->second.front ());
+    iter->second.pop_front ();
+
+    // A peer with more waiting goes to the back of the line
+    if (iter->second.empty ())
+        queues_.erase (iter);
+    else
+        turns_.push_back (id);
+
+    --queued_;
+    ++active_;
+    return work;
+}
+
+void
+ServeQueue::done ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    assert (active_ != 0);
+    --active_;
+}
+
+void
+ServeQueue::remove (Peer::id_t id)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = queues_.find (id);
+    if (iter == queues_.end ())
+        return;
+    queued_ -= iter->second.size ();
+    queues_.erase (iter);
+    turns_.erase (std::remove (turns_.begin (), turns_.end (), id),
+        turns_.end ());
+}
+
+std::size_t
+ServeQueue::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return queued_;
+}
+
+} // ripple
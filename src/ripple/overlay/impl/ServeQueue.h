@@ -0,0 +1,79 @@
+#ifndef RIPPLE_OVERLAY_SERVEQUEUE_H_INCLUDED
+#define RIPPLE_OVERLAY_SERVEQUEUE_H_INCLUDED
+
+#include <ripple/overlay/Peer.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace ripple {
+
+/** Schedules the ledger requests we serve to peers.
+
+    Requests are queued for each peer and taken from the peers in turn,
+    so one peer syncing a whole ledger can't crowd out the others. Only
+    a few requests are served at once, which bounds the job threads and
+    node store reads that serving peers can take.
+*/
+class ServeQueue
+{
+public:
+    using Work = std::function<void()>;
+
+    /** Create the queue.
+
+        @param maxActive The requests served at once.
+        @param maxQueued The requests each peer can have waiting.
+    */
+    ServeQueue (std::size_t maxActive, std::size_t maxQueued);
+
+    ServeQueue (ServeQueue const&) = delete;
+    ServeQueue& operator= (ServeQueue const&) = delete;
+
+    /** Queue a request of a peer.
+
+        @return `false` if the peer has too many requests waiting.
+    */
+    bool
+    push (Peer::id_t id, Work work);
+
+    /** Take the next request to serve.
+
+        @return The request, or nothing if none are waiting or enough
+                are being served. Each request returned must be followed
+                by a call to done once it has been served.
+    */
+    Work
+    pop ();
+
+    /** Note that a request returned by pop was served. */
+    void
+    done ();
+
+    /** Forget the waiting requests of a peer which went away. */
+    void
+    remove (Peer::id_t id);
+
+    /** Returns the number of requests waiting. */
+    std::size_t
+    size () const;
+
+private:
+    std::size_t const maxActive_;
+    std::size_t const maxQueued_;
+    std::mutex mutable mutex_;
+
+    // Waiting requests of each peer which has some
+    std::map<Peer::id_t, std::deque<Work>> queues_;
+
+    // The peers with requests waiting, in the order they are served
+    std::deque<Peer::id_t> turns_;
+
+    std::size_t queued_ = 0;
+    std::size_t active_ = 0;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,104 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/Squelch.h>
+#include <algorithm>
+
+namespace ripple {
+
+Squelch::Squelch (Stopwatch& clock, std::size_t sources,
+        std::size_t messages, std::chrono::seconds duration)
+    : clock_ (clock)
+    , sources_ (std::max<std::size_t> (sources, 1))
+    , messages_ (std::max<std::size_t> (messages, 1))
+    , duration_ (duration)
+{
+}
+
+bool
+Squelch::deliver (PublicKey const& validator,
+    std::set<Peer::id_t> const& peers)
+{
+    auto const now = clock_.now ();
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto& v = validators_.emplace (
+        validator, Validator ()).first->second;
+    v.lastSeen = now;
+
+    if (! v.sources.empty ())
+    {
+        if (now - v.chosen < duration_)
+            return false;
+
+        // The squelches have run out, so every peer is relaying again
+        v.sources.clear ();
+    }
+
+    for (auto const id : peers)
+    {
+        if (++v.counts[id] == messages_)
+            v.ready.push_back (id);
+    }
+
+    if (v.ready.size () < sources_)
+        return false;
+
+    v.sources.insert (v.ready.begin (), v.ready.begin () + sources_);
+    v.ready.clear ();
+    v.counts.clear ();
+    v.chosen = now;
+    return true;
+}
+
+bool
+Squelch::isSource (PublicKey const& validator, Peer::id_t id) const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = validators_.find (validator);
+    if (iter == validators_.end ())
+        return false;
+    return iter->second.sources.count (id) != 0;
+}
+
+std::vector<PublicKey>
+Squelch::remove (Peer::id_t id)
+{
+    std::vector<PublicKey> ended;
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (auto& entry : validators_)
+    {
+        auto& v = entry.second;
+        if (v.sources.erase (id))
+        {
+            v.sources.clear ();
+            ended.push_back (entry.first);
+            continue;
+        }
+
+        v.counts.erase (id);
+        v.ready.erase (std::remove (v.ready.begin (), v.ready.end (), id),
+            v.ready.end ());
+    }
+    return ended;
+}
+
+void
+Squelch::sweep ()
+{
+    auto const now = clock_.now ();
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (auto iter = validators_.begin (); iter != validators_.end ();)
+    {
+        if (now - iter->second.lastSeen >= duration_)
+            iter = validators_.erase (iter);
+        else
+            ++iter;
+    }
+}
+
+std::size_t
+Squelch::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return validators_.size ();
+}
+
+} // ripple
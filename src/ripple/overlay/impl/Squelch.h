@@ -0,0 +1,101 @@
+#ifndef RIPPLE_OVERLAY_SQUELCH_H_INCLUDED
+#define RIPPLE_OVERLAY_SQUELCH_H_INCLUDED
+
+#include <ripple/basics/chrono.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/protocol/PublicKey.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace ripple {
+
+/** Chooses the peers the messages of each validator are taken from.
+
+    Every time a proposal or validation is relayed, the peers which
+    delivered it before it was relayed are counted against the validator
+    which signed it. Once enough peers have each delivered enough of a
+    validator's messages, the first of them become its sources and every
+    other peer can be asked to stop relaying that validator's messages.
+    The choice lasts for a fixed time, or until one of the sources goes
+    away, after which the peers are counted again.
+*/
+class Squelch
+{
+public:
+    /** Create the chooser.
+
+        @param sources The number of peers kept for each validator.
+        @param messages The messages a peer must deliver to be kept.
+        @param duration How long a choice and its squelches last.
+    */
+    Squelch (Stopwatch& clock, std::size_t sources,
+        std::size_t messages, std::chrono::seconds duration);
+
+    Squelch (Squelch const&) = delete;
+    Squelch& operator= (Squelch const&) = delete;
+
+    /** Count a message of a validator delivered by some peers.
+
+        @return `true` if this chose the sources of the validator, and
+                every other peer should now be squelched.
+    */
+    bool
+    deliver (PublicKey const& validator,
+        std::set<Peer::id_t> const& peers);
+
+    /** Returns `true` if a peer is a chosen source of a validator. */
+    bool
+    isSource (PublicKey const& validator, Peer::id_t id) const;
+
+    /** Forget a peer which went away.
+
+        @return The validators the peer was a source of. Their choice is
+                over, so their other peers should be unsquelched.
+    */
+    std::vector<PublicKey>
+    remove (Peer::id_t id);
+
+    /** Forget the validators not heard from for a whole duration. */
+    void
+    sweep ();
+
+    std::chrono::seconds
+    duration () const
+    {
+        return duration_;
+    }
+
+    /** Returns the number of validators being tracked. */
+    std::size_t
+    size () const;
+
+private:
+    struct Validator
+    {
+        // Messages delivered by each peer while choosing
+        std::map<Peer::id_t, std::size_t> counts;
+
+        // Peers which delivered enough messages, in the order they did
+        std::vector<Peer::id_t> ready;
+
+        // The chosen peers, empty while choosing
+        std::set<Peer::id_t> sources;
+
+        Stopwatch::time_point chosen;
+        Stopwatch::time_point lastSeen;
+    };
+
+    Stopwatch& clock_;
+    std::size_t const sources_;
+    std::size_t const messages_;
+    std::chrono::seconds const duration_;
+    std::mutex mutable mutex_;
+    std::map<PublicKey, Validator> validators_;
+};
+
+} // ripple
+
+#endif
@@ -109,6 +109,7 @@ buildHello (
     uint256 const& sharedValue,
     beast::IP::Address public_ip,
     beast::IP::Endpoint remote,
+    bool txBatch,
     Application& app)
 {
     protocol::TMHello h;
@@ -144,6 +145,9 @@ buildHello (
     // take over the functionality.
     h.set_nodeprivate (true);
 
+    if (txBatch)
+        h.set_txbatch (true);
+
     auto const closedLedger = app.getLedgerMaster().getClosedLedger();
 
     if (closedLedger && !closedLedger->info().open)
@@ -191,6 +195,9 @@ appendHello (beast::http::message& m,
     if (hello.has_remote_ip())
         h.append ("Remote-IP", beast::IP::to_string (
             beast::IP::AddressV4(hello.remote_ip())));
+
+    if (hello.has_txbatch() && hello.txbatch())
+        h.append ("Tx-Batch", "1");
 }
 
 std::vector<ProtocolVersion>
@@ -345,6 +352,12 @@ parseHello (beast::http::message const& m, beast::Journal journal)
         }
     }
 
+    {
+        auto const iter = h.find ("Tx-Batch");
+        if (iter != h.end())
+            hello.set_txbatch (iter->second == "1");
+    }
+
     result.second = true;
     return result;
 }
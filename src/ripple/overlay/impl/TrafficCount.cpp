@@ -22,6 +22,15 @@
 
 namespace ripple {
 
+const char* TrafficCount::Histogram::getName (int i)
+{
+    static const char* const names[size] = {
+        "16", "64", "256", "1024", "4096", "16384",
+        "65536", "262144", "1048576", "inf" };
+    assert (i >= 0 && i < size);
+    return names[i];
+}
+
 const char* TrafficCount::getName (category c)
 {
     switch (c)
@@ -66,10 +75,12 @@ TrafficCount::category TrafficCount::categorize (
     if ((type == protocol::mtMANIFESTS) ||
             (type == protocol::mtENDPOINTS) ||
             (type == protocol::mtPEERS) ||
-            (type == protocol::mtGET_PEERS))
+            (type == protocol::mtGET_PEERS) ||
+            (type == protocol::mtSQUELCH))
         return TrafficCount::category::CT_overlay;
 
-    if (type == protocol::mtTRANSACTION)
+    if ((type == protocol::mtTRANSACTION) ||
+            (type == protocol::mtTRANSACTIONS))
         return TrafficCount::category::CT_transaction;
 
     if (type == protocol::mtVALIDATION)
@@ -22,7 +22,9 @@
 
 #include "ripple.pb.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <map>
 
 namespace ripple {
@@ -34,6 +36,68 @@ public:
 
     using count_t = std::atomic <unsigned long>;
 
+    /** Counts of durations in buckets which grow by a factor of four.
+
+        The first bucket holds durations under 16 microseconds and the
+        last those of a second (1048576us) or more.
+    */
+    class Histogram
+    {
+    public:
+        enum { size = 10 };
+
+        Histogram () = default;
+
+        Histogram (Histogram const& h)
+            : total_ (h.total_.load ())
+        {
+            for (int i = 0; i < size; ++i)
+                buckets_[i] = h.buckets_[i].load ();
+        }
+
+        void add (std::chrono::microseconds d)
+        {
+            ++buckets_[bucket (d)];
+            total_ += static_cast <unsigned long> (d.count ());
+        }
+
+        /** The bucket a duration is counted in. */
+        static int bucket (std::chrono::microseconds d)
+        {
+            int i = 0;
+            for (std::chrono::microseconds::rep limit = 16;
+                i < size - 1 && d.count () >= limit; limit *= 4)
+                ++i;
+            return i;
+        }
+
+        /** The upper bound of a bucket in microseconds, "inf" for the last. */
+        static const char* getName (int i);
+
+        unsigned long count (int i) const
+        {
+            return buckets_[i].load ();
+        }
+
+        /** Microseconds of all the durations counted. */
+        unsigned long total () const
+        {
+            return total_.load ();
+        }
+
+        operator bool () const
+        {
+            for (auto const& b : buckets_)
+                if (b.load ())
+                    return true;
+            return false;
+        }
+
+    private:
+        std::array <count_t, size> buckets_ {};
+        count_t total_ {0};
+    };
+
     class TrafficStats
     {
         public:
@@ -43,8 +107,18 @@ public:
         count_t messagesIn;
         count_t messagesOut;
 
+        // What the bytes would have been without compression
+        count_t bytesInUncompressed;
+        count_t bytesOutUncompressed;
+
+        // How long inbound messages wait in the job queue before
+        // they're handled, and how long their handlers take
+        Histogram wait;
+        Histogram handler;
+
         TrafficStats() : bytesIn(0), bytesOut(0),
-            messagesIn(0), messagesOut(0)
+            messagesIn(0), messagesOut(0),
+            bytesInUncompressed(0), bytesOutUncompressed(0)
         { ; }
 
         TrafficStats(const TrafficStats& ts)
@@ -52,6 +126,10 @@ public:
             , bytesOut (ts.bytesOut.load())
             , messagesIn (ts.messagesIn.load())
             , messagesOut (ts.messagesOut.load())
+            , bytesInUncompressed (ts.bytesInUncompressed.load())
+            , bytesOutUncompressed (ts.bytesOutUncompressed.load())
+            , wait (ts.wait)
+            , handler (ts.handler)
         { ; }
 
         operator bool () const
@@ -81,20 +159,40 @@ public:
         ::google::protobuf::Message const& message,
         int type, bool inbound);
 
-    void addCount (category cat, bool inbound, int number)
+    /** Count a message.
+
+        @param number The bytes sent or received.
+        @param uncompressed The bytes of the message before it was
+                            compressed, the same as number if it wasn't.
+    */
+    void addCount (category cat, bool inbound, int number, int uncompressed)
     {
         if (inbound)
         {
             counts_[cat].bytesIn += number;
+            counts_[cat].bytesInUncompressed += uncompressed;
             ++counts_[cat].messagesIn;
         }
         else
         {
             counts_[cat].bytesOut += number;
+            counts_[cat].bytesOutUncompressed += uncompressed;
             ++counts_[cat].messagesOut;
         }
     }
 
+    /** Count the time an inbound message waited for a job to handle it. */
+    void addWait (category cat, std::chrono::microseconds d)
+    {
+        counts_[cat].wait.add (d);
+    }
+
+    /** Count the time an inbound message's handler took. */
+    void addHandler (category cat, std::chrono::microseconds d)
+    {
+        counts_[cat].handler.add (d);
+    }
+
     TrafficCount()
     {
         for (category i = category::CT_base;
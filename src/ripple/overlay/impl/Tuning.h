@@ -71,6 +71,49 @@ enum
 
     /** How many messages we consider reasonable sustained on a send queue */
     targetSendQueue     =   16,
+
+    /** How many peers we take each validator's messages from */
+    squelchSources      =    5,
+
+    /** How many of a validator's messages a peer must deliver first
+        to be one of those peers */
+    squelchMessages     =   20,
+
+    /** How long we squelch the other peers for (seconds) */
+    squelchSeconds      =  300,
+
+    /** The longest a peer can squelch us for (seconds) */
+    maxSquelchSeconds   =  600,
+
+    /** How many validators a peer can have squelched at once */
+    maxSquelched        = 1024,
+
+    /** The smallest message we try to compress (bytes) */
+    compressMinBytes    = 1024,
+
+    /** The most bytes of queued messages joined into one write. This
+        is the largest TLS record, so each write is one record. */
+    sendBatchBytes      = 16384,
+
+    /** The most transactions sent together in one message */
+    maxBatchTransactions =  256,
+
+    /** How many writes a class of queued message can be passed over
+        for before it goes first */
+    sendStarvedWrites   =    4,
+
+    /** How many ledger requests of peers we serve at once */
+    maxServing          =    4,
+
+    /** How many ledger requests a peer can have waiting to be served */
+    maxQueuedRequests   =   16,
+
+    /** How long a peer has to answer a request for ledger data
+        before it counts as unanswered (seconds) */
+    replyTimeoutSeconds =   10,
+
+    /** How many unanswered requests of each kind we time */
+    maxPendingReplies   =   64,
 };
 
 } // Tuning
@@ -0,0 +1,146 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/ProtocolMessage.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+
+namespace ripple {
+
+class Compression_test : public beast::unit_test::suite
+{
+public:
+    struct Handler
+    {
+        std::shared_ptr<protocol::TMLedgerData> data;
+        std::size_t size = 0;
+        std::size_t uncompressedSize = 0;
+
+        boost::system::error_code
+        onMessageUnknown (std::uint16_t)
+        {
+            return boost::system::errc::make_error_code (
+                boost::system::errc::invalid_argument);
+        }
+
+        boost::system::error_code
+        onMessageBegin (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const&,
+            std::size_t size_, std::size_t uncompressedSize_)
+        {
+            size = size_;
+            uncompressedSize = uncompressedSize_;
+            return {};
+        }
+
+        void
+        onMessageEnd (std::uint16_t,
+            std::shared_ptr <::google::protobuf::Message> const&)
+        {
+        }
+
+        void
+        onMessage (std::shared_ptr <protocol::TMLedgerData> const& m)
+        {
+            data = m;
+        }
+
+        template <class T>
+        void
+        onMessage (std::shared_ptr <T> const&)
+        {
+        }
+    };
+
+    static
+    protocol::TMLedgerData
+    makeLedgerData (std::size_t nodes)
+    {
+        protocol::TMLedgerData m;
+        m.set_ledgerhash (std::string (32, 'h'));
+        m.set_ledgerseq (7);
+        m.set_type (protocol::liAS_NODE);
+        for (std::size_t i = 0; i < nodes; ++i)
+        {
+            auto node = m.add_nodes ();
+            node->set_nodedata (std::string (200, 'a' + (i % 4)));
+            node->set_nodeid (std::string (33, 'n'));
+        }
+        return m;
+    }
+
+    void
+    testRoundTrip ()
+    {
+        testcase ("round trip");
+
+        auto const m = makeLedgerData (40);
+        Message message (m, protocol::mtLEDGER_DATA);
+        auto const& plain = message.getBuffer ();
+        auto const& packed = message.getBuffer (true);
+        expect (! Message::compressed (boost::asio::buffer (plain)));
+        expect (Message::compressed (boost::asio::buffer (packed)));
+        expect (packed.size () < plain.size ());
+        expect (message.getUncompressedSize () == plain.size ());
+        expect (Message::getType (packed) == protocol::mtLEDGER_DATA);
+
+        Handler h;
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (packed), h);
+        expect (! result.second);
+        expect (result.first == packed.size ());
+        expect (h.size == packed.size ());
+        expect (h.uncompressedSize == plain.size ());
+        if (expect (h.data != nullptr))
+            expect (h.data->SerializeAsString () == m.SerializeAsString ());
+    }
+
+    void
+    testUncompressed ()
+    {
+        testcase ("uncompressed");
+
+        // Too small
+        Message small (makeLedgerData (1), protocol::mtLEDGER_DATA);
+        expect (! Message::compressed (
+            boost::asio::buffer (small.getBuffer (true))));
+
+        // Not a type which is compressed
+        protocol::TMGetLedger gl;
+        gl.set_itype (protocol::liAS_NODE);
+        for (int i = 0; i < 100; ++i)
+            gl.add_nodeids (std::string (33, 'n'));
+        Message other (gl, protocol::mtGET_LEDGER);
+        expect (! Message::compressed (
+            boost::asio::buffer (other.getBuffer (true))));
+    }
+
+    void
+    testMalformed ()
+    {
+        testcase ("malformed");
+
+        Message message (makeLedgerData (40), protocol::mtLEDGER_DATA);
+        auto packed = message.getBuffer (true);
+        expect (Message::compressed (boost::asio::buffer (packed)));
+
+        // Claim an uncompressed size the block does not have
+        packed[9] ^= 0x01;
+        Handler h;
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (packed), h);
+        expect (result.second);
+        expect (h.data == nullptr);
+    }
+
+    void
+    run ()
+    {
+        testRoundTrip ();
+        testUncompressed ();
+        testMalformed ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Compression,overlay,ripple);
+
+}
@@ -0,0 +1,64 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/IOPool.h>
+#include <beast/unit_test/suite.h>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace ripple {
+
+class IOPool_test : public beast::unit_test::suite
+{
+public:
+    void
+    testThreads ()
+    {
+        testcase ("threads");
+
+        IOPool pool (3, "test io", beast::insight::Event ());
+        expect (pool.size () == 3);
+        expect (! pool.empty ());
+
+        std::mutex m;
+        std::condition_variable cv;
+        std::set <std::thread::id> ids;
+        int done = 0;
+        for (int i = 0; i < 6; ++i)
+        {
+            pool.next ().post ([&]
+            {
+                std::lock_guard <std::mutex> lock (m);
+                ids.insert (std::this_thread::get_id ());
+                ++done;
+                cv.notify_all ();
+            });
+        }
+
+        std::unique_lock <std::mutex> lock (m);
+        cv.wait (lock, [&] { return done == 6; });
+        expect (ids.size () == 3);
+        expect (ids.count (std::this_thread::get_id ()) == 0);
+    }
+
+    void
+    testEmpty ()
+    {
+        testcase ("empty");
+
+        IOPool pool (0, "test io", beast::insight::Event ());
+        expect (pool.empty ());
+        expect (pool.latency () == std::chrono::milliseconds (0));
+    }
+
+    void
+    run ()
+    {
+        testThreads ();
+        testEmpty ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(IOPool,overlay,ripple);
+
+}
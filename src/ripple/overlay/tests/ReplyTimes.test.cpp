@@ -0,0 +1,74 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/ReplyTimes.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class ReplyTimes_test : public beast::unit_test::suite
+{
+public:
+    using ms = std::chrono::milliseconds;
+
+    void
+    testAverage ()
+    {
+        testcase ("average");
+
+        ReplyTimes times (ms (1000), 8);
+        ReplyTimes::clock_type::time_point now;
+        expect (times.average () == ms (-1));
+
+        // Replies are matched with the oldest request
+        times.onRequest (ReplyTimes::ledger, now);
+        times.onRequest (ReplyTimes::ledger, now + ms (100));
+        times.onReply (ReplyTimes::ledger, now + ms (200));
+        expect (times.average (ReplyTimes::ledger) == ms (200));
+        times.onReply (ReplyTimes::ledger, now + ms (300));
+        expect (times.average (ReplyTimes::ledger) == ms (200));
+        expect (times.average (ReplyTimes::objects) == ms (-1));
+
+        // A reply nothing was asked for is ignored
+        times.onReply (ReplyTimes::ledger, now + ms (400));
+        expect (times.average (ReplyTimes::ledger) == ms (200));
+
+        // The kinds are kept apart, the slowest is the average
+        times.onRequest (ReplyTimes::objects, now);
+        times.onReply (ReplyTimes::objects, now + ms (600));
+        expect (times.average (ReplyTimes::objects) == ms (600));
+        expect (times.average () == ms (600));
+    }
+
+    void
+    testUnanswered ()
+    {
+        testcase ("unanswered");
+
+        ReplyTimes times (ms (1000), 2);
+        ReplyTimes::clock_type::time_point now;
+
+        times.onRequest (ReplyTimes::ledger, now);
+        times.expire (now + ms (999));
+        expect (times.average () == ms (-1));
+        times.expire (now + ms (1000));
+        expect (times.average (ReplyTimes::ledger) == ms (1000));
+
+        // Past the limit the oldest request is given up on
+        ReplyTimes full (ms (1000), 2);
+        full.onRequest (ReplyTimes::objects, now);
+        full.onRequest (ReplyTimes::objects, now);
+        expect (full.average () == ms (-1));
+        full.onRequest (ReplyTimes::objects, now);
+        expect (full.average (ReplyTimes::objects) == ms (1000));
+    }
+
+    void
+    run ()
+    {
+        testAverage ();
+        testUnanswered ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ReplyTimes,overlay,ripple);
+
+}
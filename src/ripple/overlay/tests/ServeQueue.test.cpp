@@ -0,0 +1,98 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/ServeQueue.h>
+#include <beast/unit_test/suite.h>
+#include <vector>
+
+namespace ripple {
+
+class ServeQueue_test : public beast::unit_test::suite
+{
+public:
+    void
+    testFair ()
+    {
+        testcase ("fair");
+
+        ServeQueue queue (10, 10);
+        std::vector<int> served;
+        auto const add = [&](Peer::id_t id, int n)
+        {
+            return queue.push (id, [&served, n] { served.push_back (n); });
+        };
+
+        // Peer 1 asks for three before the others ask for theirs
+        expect (add (1, 11));
+        expect (add (1, 12));
+        expect (add (1, 13));
+        expect (add (2, 21));
+        expect (add (3, 31));
+        expect (add (2, 22));
+        expect (queue.size () == 6);
+
+        while (auto work = queue.pop ())
+        {
+            work ();
+            queue.done ();
+        }
+        expect (served == std::vector<int>({11, 21, 31, 12, 22, 13}));
+        expect (queue.size () == 0);
+    }
+
+    void
+    testLimits ()
+    {
+        testcase ("limits");
+
+        ServeQueue queue (2, 2);
+        auto const nothing = [] {};
+
+        expect (queue.push (1, nothing));
+        expect (queue.push (1, nothing));
+        expect (! queue.push (1, nothing));
+        expect (queue.push (2, nothing));
+
+        // Only two are served at once
+        auto first = queue.pop ();
+        auto second = queue.pop ();
+        expect (first && second);
+        expect (! queue.pop ());
+        queue.done ();
+        expect (static_cast<bool> (queue.pop ()));
+        expect (! queue.pop ());
+
+        // The peer can queue again once its requests are taken
+        expect (queue.push (1, nothing));
+    }
+
+    void
+    testRemove ()
+    {
+        testcase ("remove");
+
+        ServeQueue queue (10, 10);
+        bool served = false;
+        expect (queue.push (1, [] {}));
+        expect (queue.push (1, [] {}));
+        expect (queue.push (2, [&served] { served = true; }));
+
+        queue.remove (1);
+        expect (queue.size () == 1);
+        auto work = queue.pop ();
+        if (expect (static_cast<bool> (work)))
+            work ();
+        expect (served);
+        expect (! queue.pop ());
+    }
+
+    void
+    run ()
+    {
+        testFair ();
+        testLimits ();
+        testRemove ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ServeQueue,overlay,ripple);
+
+}
@@ -0,0 +1,98 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/Squelch.h>
+#include <ripple/protocol/SecretKey.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class Squelch_test : public beast::unit_test::suite
+{
+public:
+    void
+    testChoose ()
+    {
+        testcase ("choose");
+
+        TestStopwatch clock;
+        Squelch squelch (clock, 2, 3, std::chrono::seconds (10));
+        auto const validator = randomKeyPair (KeyType::secp256k1).first;
+
+        // Peers 1 and 2 deliver every message, peer 3 every other one
+        expect (! squelch.deliver (validator, {1, 3}));
+        expect (! squelch.deliver (validator, {2}));
+        expect (! squelch.deliver (validator, {1, 2, 3}));
+        expect (! squelch.deliver (validator, {1}));
+        expect (! squelch.isSource (validator, 1));
+        expect (squelch.deliver (validator, {2, 3}));
+
+        expect (squelch.isSource (validator, 1));
+        expect (squelch.isSource (validator, 2));
+        expect (! squelch.isSource (validator, 3));
+
+        // Nothing changes until the choice runs out
+        ++clock;
+        expect (! squelch.deliver (validator, {3}));
+        expect (! squelch.isSource (validator, 3));
+
+        // After that every peer is counted again
+        clock.advance (std::chrono::seconds (10));
+        expect (! squelch.deliver (validator, {3}));
+        expect (! squelch.isSource (validator, 1));
+    }
+
+    void
+    testRemove ()
+    {
+        testcase ("remove");
+
+        TestStopwatch clock;
+        Squelch squelch (clock, 1, 1, std::chrono::seconds (10));
+        auto const first = randomKeyPair (KeyType::secp256k1).first;
+        auto const second = randomKeyPair (KeyType::ed25519).first;
+
+        expect (squelch.deliver (first, {1}));
+        expect (squelch.deliver (second, {2}));
+
+        // Only the validators the peer was a source of are affected
+        auto const ended = squelch.remove (1);
+        expect (ended.size () == 1 && ended.front () == first);
+        expect (! squelch.isSource (first, 1));
+        expect (squelch.isSource (second, 2));
+        expect (squelch.remove (1).empty ());
+
+        // A new choice is made on the next message
+        expect (squelch.deliver (first, {3}));
+        expect (squelch.isSource (first, 3));
+    }
+
+    void
+    testSweep ()
+    {
+        testcase ("sweep");
+
+        TestStopwatch clock;
+        Squelch squelch (clock, 3, 3, std::chrono::seconds (10));
+        auto const validator = randomKeyPair (KeyType::secp256k1).first;
+
+        expect (! squelch.deliver (validator, {1}));
+        expect (squelch.size () == 1);
+        clock.advance (std::chrono::seconds (9));
+        squelch.sweep ();
+        expect (squelch.size () == 1);
+        ++clock;
+        squelch.sweep ();
+        expect (squelch.size () == 0);
+    }
+
+    void
+    run ()
+    {
+        testChoose ();
+        testRemove ();
+        testSweep ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Squelch,overlay,ripple);
+
+}
@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/overlay/impl/TMHello.h>
+#include <ripple/protocol/RippleAddress.h>
 #include <beast/unit_test/suite.h>
 
 namespace ripple {
@@ -59,10 +60,39 @@ public:
         check("RTXP/1.1, RTXP/1.0", "1.0,1.1");
     }
 
+    void
+    test_txBatch()
+    {
+        auto const seed = RippleAddress::createSeedGeneric ("masterpassphrase");
+
+        auto roundTrip = [&](bool txBatch)
+        {
+            protocol::TMHello hello;
+            hello.set_nodepublic (
+                RippleAddress::createNodePublic (seed).humanNodePublic ());
+            hello.set_nodeproof ("proof");
+            if (txBatch)
+                hello.set_txbatch (true);
+
+            beast::http::message m;
+            m.request (true);
+            m.headers.append ("Upgrade", "RTXP/1.2");
+            appendHello (m, hello);
+
+            auto const result = parseHello (m, beast::Journal ());
+            expect (result.second);
+            return result.first.has_txbatch () && result.first.txbatch ();
+        };
+
+        expect (roundTrip (true));
+        expect (! roundTrip (false));
+    }
+
     void
     run()
     {
         test_protocolVersions();
+        test_txBatch();
     }
 };
 
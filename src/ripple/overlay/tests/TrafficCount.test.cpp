@@ -0,0 +1,67 @@
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+
+namespace ripple {
+
+class TrafficCount_test : public beast::unit_test::suite
+{
+public:
+    void
+    testBuckets ()
+    {
+        testcase ("buckets");
+
+        using us = std::chrono::microseconds;
+        using Histogram = TrafficCount::Histogram;
+        expect (Histogram::bucket (us (0)) == 0);
+        expect (Histogram::bucket (us (15)) == 0);
+        expect (Histogram::bucket (us (16)) == 1);
+        expect (Histogram::bucket (us (1023)) == 3);
+        expect (Histogram::bucket (us (1024)) == 4);
+        expect (Histogram::bucket (us (1048575)) == 8);
+        expect (Histogram::bucket (us (1048576)) == 9);
+        expect (Histogram::bucket (std::chrono::hours (1)) ==
+            Histogram::size - 1);
+        expect (std::string (Histogram::getName (4)) == "4096");
+        expect (std::string (Histogram::getName (Histogram::size - 1)) ==
+            "inf");
+    }
+
+    void
+    testCounts ()
+    {
+        testcase ("counts");
+
+        TrafficCount traffic;
+        auto const cat = TrafficCount::category::CT_proposal;
+        traffic.addCount (cat, true, 100, 100);
+        traffic.addWait (cat, std::chrono::milliseconds (2));
+        traffic.addHandler (cat, std::chrono::microseconds (10));
+        traffic.addHandler (cat, std::chrono::microseconds (20));
+
+        auto const counts = traffic.getCounts ();
+        auto const iter = counts.find (TrafficCount::getName (cat));
+        if (! expect (iter != counts.end ()))
+            return;
+        auto const& stats = iter->second;
+        expect (stats.wait.count (4) == 1);
+        expect (stats.wait.total () == 2000);
+        expect (stats.handler.count (0) == 1);
+        expect (stats.handler.count (1) == 1);
+        expect (stats.handler.total () == 30);
+        expect (! TrafficCount::Histogram ());
+    }
+
+    void
+    run ()
+    {
+        testBuckets ();
+        testCounts ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TrafficCount,overlay,ripple);
+
+}
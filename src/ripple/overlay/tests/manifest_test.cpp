@@ -228,6 +228,9 @@ public:
 
             expect (!ripple::make_Manifest(fake));
             expect (cache.applyManifest (clone (s_b2), unl, journal) == invalid);
+            // The remembered result of the signature check is the same
+            expect (cache.applyManifest (clone (s_b2), unl, journal) == invalid);
+            expect (cache.applyManifest (clone (s_b1), unl, journal) == accepted);
         }
         testLoadStore (cache, unl);
     }
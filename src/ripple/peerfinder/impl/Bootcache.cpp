@@ -111,6 +111,10 @@ Bootcache::load ()
                 ((n > 1) ? " addresses" : " address");
         prune ();
     }
+
+    // The burst of results from the first connection attempts is
+    // stored together once the cooldown has passed.
+    m_whenUpdate = m_clock.now () + Tuning::bootcacheCooldownTime;
 }
 
 bool
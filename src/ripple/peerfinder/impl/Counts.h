@@ -45,6 +45,7 @@ public:
 
         , m_acceptCount (0)
         , m_closingCount (0)
+        , m_warm (false)
     {
 #if 1
         std::random_device rd;
@@ -88,9 +89,17 @@ public:
     /** Returns the number of attempts needed to bring us to the max. */
     std::size_t attempts_needed () const
     {
-        if (m_attempts >= Tuning::maxConnectAttempts)
+        int const budget = m_warm ? Tuning::maxConnectAttempts :
+            Tuning::maxStartupConnectAttempts;
+        if (m_attempts >= budget)
             return 0;
-        return Tuning::maxConnectAttempts - m_attempts;
+        return budget - m_attempts;
+    }
+
+    /** Returns `true` once the outbound slots have been filled. */
+    bool warm () const
+    {
+        return m_warm;
     }
 
     /** Returns the number of outbound connection attempts. */
@@ -238,6 +247,7 @@ public:
         map ["fixed"]   = m_fixed_active;
         map ["cluster"] = m_cluster;
         map ["total"]   = m_active;
+        map ["warm"]    = m_warm ? "yes" : "no";
     }
 
     /** Records the state for diagnostics. */
@@ -287,6 +297,8 @@ private:
                 else
                     m_out_active += n;
             }
+            if (m_out_max > 0 && m_out_active >= m_out_max)
+                m_warm = true;
             m_active += n;
             break;
 
@@ -338,6 +350,9 @@ private:
     // Number of connections that are gracefully closing.
     int m_closingCount;
 
+    // Set once the outbound slots have been filled
+    bool m_warm;
+
     /** Fractional threshold below which we round down.
         This is used to round the value of Config::outPeers up or down in
         such a way that the network-wide average number of outgoing
@@ -43,6 +43,13 @@ enum
     /** Maximum number of simultaneous connection attempts. */
     ,maxConnectAttempts = 20
 
+    /** Maximum number of simultaneous connection attempts at startup.
+        Many stored addresses are stale after a restart, so until the
+        outbound slots have been filled once more of them are tried at
+        a time.
+    */
+    ,maxStartupConnectAttempts = 50
+
     /** The percentage of total peer slots that are outbound.
         The number of outbound peers will be the larger of the
         minOutCount and outPercent * Config::maxPeers specially
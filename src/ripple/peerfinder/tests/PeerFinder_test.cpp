@@ -147,10 +147,70 @@ public:
         expect (n <= (seconds+59)/60, "backoff");
     }
 
+    // Addresses which were stored before a restart
+    struct BootStore : TestStore
+    {
+        std::size_t
+        load (load_callback const& cb) override
+        {
+            for (int i = 1; i <= 100; ++i)
+                cb (beast::IP::Endpoint::from_string (
+                    "65.0.1." + std::to_string (i) + ":5"), 1);
+            return 100;
+        }
+    };
+
+    void
+    test_warmStart()
+    {
+        testcase("warm start");
+        BootStore store;
+        TestChecker checker;
+        TestStopwatch clock;
+        Logic<TestChecker> logic (clock, store, checker, beast::Journal{});
+        logic.load();
+        {
+            Config c;
+            c.autoConnect = true;
+            c.wantIncoming = false;
+            c.maxPeers = 2;
+            c.listeningPort = 1024;
+            logic.config(c);
+        }
+
+        // Until the outbound slots fill, many addresses are tried at once
+        auto list = logic.autoconnect();
+        expect (list.size() == Tuning::maxStartupConnectAttempts);
+
+        std::vector<SlotImp::ptr> slots;
+        for (auto const& ep : list)
+            slots.push_back (logic.new_outbound_slot (ep));
+        expect (logic.autoconnect().empty());
+
+        std::array<std::uint8_t, 33> key;
+        for (int i = 0; i < 2; ++i)
+        {
+            key.fill (i);
+            RipplePublicKey pk (key.begin(), key.end());
+            expect (logic.onConnected (slots[i],
+                beast::IP::Endpoint::from_string("65.0.0.2:5")));
+            expect (logic.activate (slots[i], pk, false) ==
+                PeerFinder::Result::success, "activate");
+        }
+        for (std::size_t i = 2; i < slots.size(); ++i)
+            logic.on_closed (slots[i]);
+
+        // Once they have, the normal budget applies again
+        logic.on_closed (slots[0]);
+        list = logic.autoconnect();
+        expect (list.size() == Tuning::maxConnectAttempts);
+    }
+
     void run ()
     {
         test_backoff1();
         test_backoff2();
+        test_warmStart();
     }
 };
 
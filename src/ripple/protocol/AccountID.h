@@ -43,7 +43,14 @@ class AccountIDTag { };
 using AccountID = base_uint<
     160, detail::AccountIDTag>;
 
-/** Convert AccountID to base58 checked string */
+/** Convert AccountID to base58 checked string
+
+    Recent conversions in both directions are kept in a
+    process wide cache.
+
+    Thread Safety:
+        Safe to call from any thread concurrently
+*/
 std::string
 toBase58 (AccountID const& v);
 
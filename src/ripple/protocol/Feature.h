@@ -38,6 +38,13 @@ extern uint256 const featureMultiSign;
 extern uint256 const featureSusPay;
 extern uint256 const featureTrustSetAuth;
 extern uint256 const featureFeeEscalation;
+extern uint256 const featureAssetReleaseSummary;
+extern uint256 const featureCompactAsset;
+extern uint256 const featureReferDirectory;
+extern uint256 const featureActiveAccounts;
+extern uint256 const featureOfferPurge;
+extern uint256 const featureFeeShareAccrual;
+extern uint256 const featureDividendBatch;
 
 } // ripple
 
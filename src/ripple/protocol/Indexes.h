@@ -221,6 +221,13 @@ struct dividend_t
 };
 static dividend_t const dividend {};
 
+/** The settlement state of the accrued fee shares */
+struct fee_share_accrual_t
+{
+    Keylet operator()() const;
+};
+static fee_share_accrual_t const feeShareAccrual {};
+
 /** A reference list belonging to an account */
 struct refer_t
 {
@@ -271,6 +278,9 @@ Keylet unchecked(uint256 const& key);
 /** The root page of an account's directory */
 Keylet ownerDir (AccountID const& id);
 
+/** The root page of the directory of an account's references */
+Keylet referDir (AccountID const& id);
+
 /** A page in a directory */
 /** @{ */
 Keylet page (uint256 const& root, std::uint64_t index);
@@ -293,9 +303,15 @@ susPay (AccountID const& source, std::uint32_t seq);
 uint256
 getAccountReferIndex (AccountID const& account);
 
+uint256
+getReferDirIndex (AccountID const& account);
+
 uint256
 getLedgerDividendIndex ();
 
+uint256
+getFeeShareAccrualIndex ();
+
 uint256
 getAssetIndex (AccountID const& a, Currency const& currency);
 
@@ -49,6 +49,8 @@ JSS ( Paths );                      // in/out: TransactionSign
 JSS ( Referee );                    // in: TransactionSign; field.
 JSS ( Reference );                  // in: TransactionSign; field.
 JSS ( TransferRate );               // in: TransferRate
+JSS ( cache_budget );               // out: GetCounts
+JSS ( caches );                     // out: GetCounts
 JSS ( historical_perminute );       // historical_perminute
 JSS ( SLE_hit_rate );               // out: GetCounts
 JSS ( SendMax );                    // in: TransactionSign
@@ -69,6 +71,8 @@ JSS ( account_hash );               // out: LedgerToJson
 JSS ( account_id );                 // out: WalletPropose
 JSS ( account_objects );            // out: AccountObjects
 JSS ( account_root );               // in: LedgerEntry
+JSS ( account_subscriptions );      // out: GetCounts
+JSS ( account_tx_cache );           // out: GetCounts
 JSS ( accounts );                   // in: LedgerEntry, Subscribe,
                                     //     handlers/Ledger, Unsubscribe
                                     // out: WalletAccounts
@@ -89,16 +93,22 @@ JSS ( balances );                   // out: GatewayBalances
 JSS ( base );                       // out: LogLevel
 JSS ( base_fee );                   // out: NetworkOPs
 JSS ( base_fee_xrp );               // out: NetworkOPs
+JSS ( best_paths_ms );              // out: PathFind
 JSS ( bids );                       // out: Subscribe
 JSS ( binary );                     // in: AccountTX, LedgerEntry,
-                                    //     AccountTxOld, Tx LedgerData
+                                    //     AccountTxOld, Tx LedgerData,
+                                    //     Subscribe
 JSS ( books );                      // in: Subscribe, Unsubscribe
 JSS ( both );                       // in: Subscribe, Unsubscribe
 JSS ( both_sides );                 // in: Subscribe, Unsubscribe
 JSS ( build_path );                 // in: TransactionSign
+JSS ( bulk );                       // out: Peers
 JSS ( build_version );              // out: NetworkOPs
+JSS ( bytes );                      // out: RPCStats
+JSS ( calls );                      // out: RPCStats
 JSS ( can_delete );                 // out: CanDelete
 JSS ( check_nodes );                // in: LedgerCleaner
+JSS ( checkouts );                  // out: GetCounts
 JSS ( clear );                      // in/out: FetchInfo
 JSS ( close_flags );                // out: LedgerToJson
 JSS ( close_time );                 // in: Application, out: NetworkOPs,
@@ -112,27 +122,36 @@ JSS ( closed );                     // out: NetworkOPs, LedgerToJson,
 JSS ( closed_ledger );              // out: NetworkOPs
 JSS ( cluster );                    // out: UniqueNodeList, PeerImp
 JSS ( code );                       // out: errors
+JSS ( commit );                     // out: GetCounts
 JSS ( command );                    // in: RPCHandler
 JSS ( comment );                    // in: UnlAdd
 JSS ( complete );                   // out: NetworkOPs, InboundLedger
 JSS ( complete_ledgers );           // out: NetworkOPs, PeerImp
+JSS ( connections );                // out: GetCounts
 JSS ( consensus );                  // out: NetworkOPs, LedgerConsensus
 JSS ( converge_time );              // out: NetworkOPs
 JSS ( converge_time_s );            // out: NetworkOPs
 JSS ( count );                      // in: AccountTx*
+JSS ( cpus );                       // out: ServerInfo
 JSS ( currency );                   // in: paths/PathRequest, STAmount
                                     // out: paths/Node, STPathSet, STAmount
 JSS ( current );                    // out: OwnerInfo
 JSS ( current_ledger_size );        // out: TxQ
 JSS ( current_queue_size );         // out: TxQ
+JSS ( cursor );                     // in/out: LedgerData
 JSS ( data );                       // out: LedgerData
 JSS ( date );                       // out: tx/Transaction, NetworkOPs
+JSS ( deadline );                   // in: PathRequest, RipplePathFind
+JSS ( deadline_exceeded );          // out: PathFind
 JSS ( dbKBLedger );                 // out: getCounts
 JSS ( dbKBTotal );                  // out: getCounts
 JSS ( dbKBTransaction );            // out: getCounts
 JSS ( debug_signing );              // in: TransactionSign
 JSS ( delivered_amount );           // out: addPaymentDeliveredAmount
+JSS ( deletes );                    // out: GetCounts
 JSS ( deprecated );                 // out: WalletSeed
+JSS ( descendants );                // out: AccountReferrals
+JSS ( descendants_vbc );            // out: AccountReferrals
 JSS ( descending );                 // in: AccountTx*
 JSS ( destination_account );        // in: PathRequest, RipplePathFind
 JSS ( destination_amount );         // in: PathRequest, RipplePathFind
@@ -144,8 +163,10 @@ JSS ( dir_root );                   // out: DirectoryEntryIterator
 JSS ( directory );                  // in: LedgerEntry
 JSS ( dividend_ledger );
 JSS ( dividend_object );
+JSS ( dropped );                    // out: Profile
 JSS ( drops );                      // out: TxQ
 JSS ( duration_us );                // out: NetworkOPs
+JSS ( elapsed );                    // out: LedgerTimings
 JSS ( enabled );                    // out: AmendmentTable
 JSS ( engine_result );              // out: NetworkOPs, TransactionSign, Submit
 JSS ( engine_result_code );         // out: NetworkOPs, TransactionSign, Submit
@@ -154,6 +175,7 @@ JSS ( error );                      // out: error
 JSS ( error_code );                 // out: error
 JSS ( error_exception );            // out: Submit
 JSS ( error_message );              // out: error
+JSS ( errors );                     // out: RPCStats
 JSS ( expand );                     // in: handler/Ledger
 JSS ( expected_ledger_size );       // out: TxQ
 JSS ( fail_hard );                  // in: Sign, Submit
@@ -165,10 +187,14 @@ JSS ( fee_base );                   // out: NetworkOPs
 JSS ( fee_mult_max );               // in: TransactionSign
 JSS ( fee_ref );                    // out: NetworkOPs
 JSS ( fetch_pack );                 // out: NetworkOPs
+JSS ( fields );                     // out: LoadDividend
+JSS ( find_paths_ms );              // out: PathFind
 JSS ( first );                      // out: rpc/Version
 JSS ( fix_txns );                   // in: LedgerCleaner
 JSS ( flags );                      // out: paths/Node, AccountOffers
+JSS ( folded );                     // out: Profile
 JSS ( forward );                    // in: AccountTx
+JSS ( frequency );                  // in/out: Profile
 JSS ( freeze );                     // out: AccountLines
 JSS ( freeze_peer );                // out: AccountLines
 JSS ( full );                       // in: LedgerClearer, handlers/Ledger
@@ -176,11 +202,14 @@ JSS ( full_reply );                 // out: PathFind
 JSS ( fullbelow_size );             // in: GetCounts
 JSS ( generator );                  // in: LedgerEntry
 JSS ( good );                       // out: RPCVersion
+JSS ( handler_total_us );           // out: GetCounts
+JSS ( handler_us );                 // out: GetCounts
 JSS ( hash );                       // out: NetworkOPs, InboundLedger,
                                     //      LedgerToJson, STTx; field
 JSS ( have_header );                // out: InboundLedger
 JSS ( have_state );                 // out: InboundLedger
 JSS ( have_transactions );          // out: InboundLedger
+JSS ( hits );                       // out: GetCounts
 JSS ( hostid );                     // out: NetworkOPs
 JSS ( id );                         // websocket.
 JSS ( ident );                      // in: AccountCurrencies, AccountInfo,
@@ -191,13 +220,19 @@ JSS ( index );                      // in: LedgerEntry; out: PathState,
                                     //     STLedgerEntry, LedgerEntry,
                                     //     TxHistory, LedgerData;
                                     // field
+JSS ( index_ledger );               // out: AccountReferrals
 JSS ( info );                       // out: ServerInfo, ConsensusInfo, FetchInfo
+JSS ( inline_count );               // out: GetCounts
+JSS ( inline_saved );               // out: GetCounts
 JSS ( internal_command );           // in: Internal
+JSS ( io );                         // out: ServerInfo
 JSS ( io_latency_ms );              // out: NetworkOPs
 JSS ( ip );                         // in: Connect, out: OverlayImpl
 JSS ( issuer );                     // in: RipplePathFind, Subscribe,
                                     //     Unsubscribe, BookOffers
                                     // out: paths/Node, STPathSet, STAmount
+JSS ( item_bytes );                 // out: GetCounts
+JSS ( jobs );                       // out: ServerInfo
 JSS ( key );                        // out: WalletSeed
 JSS ( key_type );                   // in/out: WalletPropose, TransactionSign
 JSS ( latency );                    // out: PeerImp
@@ -221,6 +256,7 @@ JSS ( ledger_index_min );           // in, out: AccountTx*
 JSS ( ledger_max );                 // in, out: AccountTx*
 JSS ( ledger_min );                 // in, out: AccountTx*
 JSS ( ledger_time );                // out: NetworkOPs
+JSS ( ledgers );                    // out: LedgerTimings
 JSS ( levels );                     // LogLevels
 JSS ( limit );                      // in/out: AccountTx*, AccountOffers,
                                     //         AccountLines, AccountObjects
@@ -236,6 +272,7 @@ JSS ( load_factor_net );            // out: NetworkOPs
 JSS ( load_fee );                   // out: LoadFeeTrackImp
 JSS ( local );                      // out: resource/Logic.h
 JSS ( local_txs );                  // out: GetCounts
+JSS ( log_dropped );                // out: GetCounts
 JSS ( marker );                     // in/out: AccountTx, AccountOffers,
                                     //         AccountLines, AccountObjects,
                                     //         LedgerData
@@ -243,19 +280,26 @@ JSS ( marker );                     // in/out: AccountTx, AccountOffers,
 JSS ( master_key );                 // out: WalletPropose
 JSS ( master_seed );                // out: WalletPropose
 JSS ( master_seed_hex );            // out: WalletPropose
+JSS ( max );                        // out: RPCStats
 JSS ( max_ledger );                 // in/out: LedgerCleaner
 JSS ( max_queue_size );             // out: TxQ
+JSS ( mb );                         // out: GetCounts
+JSS ( mean );                       // out: RPCStats
 JSS ( median_fee );                 // out: TxQ
 JSS ( median_level );               // out: TxQ
+JSS ( memory_bytes );               // out: GetCounts
 JSS ( message );                    // error.
 JSS ( meta );                       // out: NetworkOPs, AccountTx*, Tx
 JSS ( metaData );
 JSS ( metadata );                   // out: TransactionEntry
 JSS ( method );                     // RPC
+JSS ( methods );                    // out: RPCStats
 JSS ( min_count );                  // in: GetCounts
 JSS ( min_ledger );                 // in: LedgerCleaner
 JSS ( minimum_fee );                // out: TxQ
 JSS ( minimum_level );              // out: TxQ
+JSS ( mismatch );                   // out: LoadDividend
+JSS ( misses );                     // out: GetCounts
 JSS ( missingCommand );             // error
 JSS ( name );                       // out: AmendmentTableImpl, PeerImp
 JSS ( needed_state_hashes );        // out: InboundLedger
@@ -270,18 +314,26 @@ JSS ( node_read_bytes );            // out: GetCounts
 JSS ( node_reads_hit );             // out: GetCounts
 JSS ( node_reads_total );           // out: GetCounts
 JSS ( node_writes );                // out: GetCounts
+JSS ( node_writes_skipped );        // out: GetCounts
 JSS ( node_written_bytes );         // out: GetCounts
 JSS ( nodes );                      // out: PathState
+JSS ( nodestore );                  // out: ServerInfo
 JSS ( obligations );                // out: GatewayBalances
 JSS ( offer );                      // in: LedgerEntry
 JSS ( offers );                     // out: NetworkOPs, AccountOffers, Subscribe
 JSS ( offline );                    // in: TransactionSign
 JSS ( offset );                     // in/out: AccountTxOld
+JSS ( only );                       // out: LoadDividend
 JSS ( open );                       // out: handlers/Ledger
 JSS ( open_ledger_fee );            // out: TxQ
 JSS ( open_ledger_level );          // out: TxQ
+JSS ( ours );                       // out: LoadDividend
+JSS ( overlay_io_latency_ms );      // out: NetworkOPs
 JSS ( owner );                      // in: LedgerEntry, out: NetworkOPs
 JSS ( owner_funds );                // out: NetworkOPs, AcceptedLedgerTx
+JSS ( p50 );                        // out: RPCStats
+JSS ( p90 );                        // out: RPCStats
+JSS ( p99 );                        // out: RPCStats
 JSS ( params );                     // RPC
 JSS ( parent_close_time );          // out: LedgerToJson
 JSS ( parent_hash );                // out: LedgerToJson
@@ -294,7 +346,9 @@ JSS ( paths_computed );             // out: PathRequest, RipplePathFind
 JSS ( peer );                       // in: AccountLines
 JSS ( peer_authorized );            // out: AccountLines
 JSS ( peer_id );                    // out: LedgerProposal
+JSS ( peer_message_times );         // out: GetCounts
 JSS ( peers );                      // out: InboundLedger, handlers/Peers, Overlay
+JSS ( phases );                     // out: LedgerTimings
 JSS ( port );                       // in: Connect
 JSS ( previous_ledger );            // out: LedgerPropose
 JSS ( proof );                      // in: BookOffers
@@ -309,11 +363,14 @@ JSS ( published_ledger );           // out: NetworkOPs
 JSS ( quality );                    // out: NetworkOPs
 JSS ( quality_in );                 // out: AccountLines
 JSS ( quality_out );                // out: AccountLines
+JSS ( queued );                     // out: GetCounts
 JSS ( random );                     // out: Random
 JSS ( raw_meta );                   // out: AcceptedLedgerTx
+JSS ( rank_paths_ms );              // out: PathFind
 JSS ( receive_currencies );         // out: AccountCurrencies
 JSS ( reference_level );            // out: TxQ
 JSS ( referee );
+JSS ( references );                 // out: AccountReferrals
 JSS ( regular_seed );               // in/out: LedgerEntry
 JSS ( remote );                     // out: Logic.h
 JSS ( request );                    // RPC
@@ -324,29 +381,42 @@ JSS ( reserve_inc );                // out: NetworkOPs
 JSS ( reserve_inc_xrp );            // out: NetworkOPs
 JSS ( response );                   // websocket
 JSS ( result );                     // RPC
+JSS ( ripple_calcs );               // out: PathFind
 JSS ( ripple_lines );               // out: NetworkOPs
 JSS ( ripple_state );               // in: LedgerEntr
+JSS ( rpc );                        // out: ServerInfo
+JSS ( rpc_cache );                  // out: GetCounts
 JSS ( role );                       // out: Ping.cpp
 JSS ( rt_accounts );                // in: Subscribe, Unsubscribe
+JSS ( running );                    // out: Profile
+JSS ( samples );                    // out: Profile
 JSS ( sanity );                     // out: PeerImp
+JSS ( save_times_us );              // out: GetCounts
 JSS ( search_depth );               // in: RipplePathFind
+JSS ( search_stats );               // out: PathFind
 JSS ( secret );                     // in: TransactionSign, WalletSeed,
                                     //     ValidationCreate, ValidationSeed
 JSS ( seed );                       // in: WalletAccounts, out: WalletSeed
 JSS ( seed_hex );                   // in: WalletPropose, TransactionSign
 JSS ( send_currencies );            // out: AccountCurrencies
 JSS ( send_max );                   // in: PathRequest, RipplePathFind
+JSS ( send_queue );                 // out: Peers
 JSS ( seq );                        // in: LedgerEntry;
                                     // out: NetworkOPs, RPCSub, AccountOffers
 JSS ( seqNum );                     // out: LedgerToJson
+JSS ( serve_cache_size );           // out: GetCounts
+JSS ( serve_hit_rate );             // out: GetCounts
 JSS ( server_state );               // out: NetworkOPs
 JSS ( server_status );              // out: NetworkOPs
 JSS ( severity );                   // in: LogLevel
 JSS ( signature );                  // out: NetworkOPs
+JSS ( size );                       // out: GetCounts
 JSS ( snapshot );                   // in: Subscribe
 JSS ( source_account );             // in: PathRequest, RipplePathFind
 JSS ( source_amount );              // in: PathRequest, RipplePathFind
 JSS ( source_currencies );          // in: PathRequest, RipplePathFind
+JSS ( sql_save_lag );               // out: NetworkOPs
+JSS ( sql_save_queue );             // out: NetworkOPs
 JSS ( stand_alone );                // out: NetworkOPs
 JSS ( start );                      // in: TxHistory
 JSS ( state );                      // out: Logic.h, ServerState, LedgerData
@@ -359,6 +429,7 @@ JSS ( streams );                    // in: Subscribe, Unsubscribe
 JSS ( strict );                     // in: AccountCurrencies, AccountInfo
 JSS ( sub_index );                  // in: LedgerEntry
 JSS ( subcommand );                 // in: PathFind
+JSS ( subscribers );                // out: GetCounts
 JSS ( success );                    // rpc
 JSS ( supported );                  // out: AmendmentTableImpl
 JSS ( system_time_offset );         // out: NetworkOPs
@@ -368,6 +439,9 @@ JSS ( taker_gets );                 // in: Subscribe, Unsubscribe, BookOffers
 JSS ( taker_gets_funded );          // out: NetworkOPs
 JSS ( taker_pays );                 // in: Subscribe, Unsubscribe, BookOffers
 JSS ( taker_pays_funded );          // out: NetworkOPs
+JSS ( target_size );                // out: GetCounts
+JSS ( theirs );                     // out: LoadDividend
+JSS ( threads );                    // out: ServerInfo
 JSS ( threshold );                  // in: Blacklist
 JSS ( timeouts );                   // out: InboundLedger
 JSS ( traffic );                    // out: Overlay
@@ -375,6 +449,8 @@ JSS ( totalCoins );                 // out: LedgerToJson
 JSS ( total_coins );                // out: LedgerToJson
 JSS ( totalCoinsVBC );
 JSS ( total_coinsVBC );
+JSS ( total_ms );                   // out: PathFind
+JSS ( trace );                      // out: NetworkOPs
 JSS ( transTreeHash );              // out: ledger/Ledger.cpp
 JSS ( transaction );                // in: Tx
                                     // out: NetworkOPs, AcceptedLedgerTx,
@@ -383,6 +459,8 @@ JSS ( transactions );               // out: LedgerToJson,
                                     // in: AccountTx*, Unsubscribe
 JSS ( transitions );                // out: NetworkOPs
 JSS ( treenode_cache_size );        // out: GetCounts
+JSS ( treenode_inner_count );       // out: GetCounts
+JSS ( treenode_inner_saved );       // out: GetCounts
 JSS ( treenode_track_size );        // out: GetCounts
 JSS ( tx );                         // out: STTx, AccountTx*
 JSS ( tx_blob );                    // in/out: Submit,
@@ -391,8 +469,11 @@ JSS ( tx_hash );                    // in: TransactionEntry
 JSS ( tx_json );                    // in/out: TransactionSign
                                     // out: TransactionEntry
 JSS ( tx_signing_hash );            // out: TransactionSign
+JSS ( tx_trace );                   // out: GetCounts
 JSS ( tx_unsigned );                // out: TransactionSign
 JSS ( txn_count );                  // out: NetworkOPs
+JSS ( txn_db_read );                // out: GetCounts
+JSS ( txn_db_write );               // out: GetCounts
 JSS ( txs );                        // out: TxHistory
 JSS ( type );                       // in: AccountObjects
                                     // out: NetworkOPs
@@ -403,6 +484,8 @@ JSS ( unlimited);                   // out: Connection.h
 JSS ( uptime );                     // out: GetCounts
 JSS ( uptime_human );               // out: GetCounts
 JSS ( url );                        // in/out: Subscribe, Unsubscribe
+JSS ( url_batch );                  // in: Subscribe
+JSS ( url_connections );            // in: Subscribe
 JSS ( url_password );               // in: Subscribe
 JSS ( url_username );               // in: Subscribe
 JSS ( urlgravatar );                //
@@ -416,9 +499,13 @@ JSS ( validation_public_key );      // out: ValidationCreate, ValidationSeed
 JSS ( validation_quorum );          // out: NetworkOPs
 JSS ( validation_seed );            // out: ValidationCreate, ValidationSeed
 JSS ( value );                      // out: STAmount
+JSS ( verify );                     // in: LoadDividend
 JSS ( version );                    // out: RPCVersion
 JSS ( vetoed );                     // out: AmendmentTableImpl
 JSS ( vote );                       // in: Feature
+JSS ( wait_max_us );                // out: GetCounts
+JSS ( wait_total_us );              // out: GetCounts
+JSS ( wait_us );                    // out: GetCounts
 JSS ( warning );                    // rpc:
 JSS ( write_load );                 // out: GetCounts
 
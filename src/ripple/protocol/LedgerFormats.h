@@ -66,6 +66,9 @@ enum LedgerEntryType
 
     ltDIVIDEND          = 'D',
 
+    /// The last ledger whose accrued fee shares were settled
+    ltFEE_SHARE_ACCRUAL = 'F',
+
     ltRIPPLE_STATE      = 'r',
 
     ltREFER             = 'R',
@@ -117,10 +120,12 @@ enum LedgerNameSpace
     spaceFee            = 'e',
     spaceTicket         = 'T',
     spaceDividend       = 'D',
+    spaceFeeShareAccrual = 'F',
     spaceRefer          = 'R',
     spaceAsset          = 't',
     spaceAssetState     = 'S',
     spaceSignerList     = 'N',
+    spaceReferDir       = 'L',  // Directory of the references of an account.
 
     // No longer used or supported. Left here to reserve the space and
     // avoid accidental reuse of the space.
@@ -30,6 +30,7 @@
 #include <cstdint>
 #include <cstring>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -222,6 +223,21 @@ bool
 verify (PublicKey const& pk,
     Slice const& message, Slice const& signature);
 
+/** Verify several Ed25519 signatures at once.
+
+    The signatures are checked together, which costs much less than
+    checking each of them. A batch with a bad signature in it is checked
+    one signature at a time to find out which.
+
+    @param pks The keys, which must all be Ed25519 keys.
+
+    @return Whether each signature is good, in order.
+*/
+std::vector<bool>
+verifyEd25519Batch (std::vector<PublicKey> const& pks,
+    std::vector<Slice> const& messages,
+        std::vector<Slice> const& signatures);
+
 /** Calculate the 160-bit node ID from a node public key. */
 NodeID
 calcNodeID (PublicKey const&);
@@ -333,6 +333,7 @@ extern SF_U8 const sfTransactionResult;
 
 extern SF_U8 const sfDividendState;
 extern SF_U8 const sfDividendType;
+extern SF_U8 const sfDividendDepth;
 
 // 16-bit integers
 extern SF_U16 const sfLedgerEntryType;
@@ -425,6 +426,7 @@ extern SF_U256 const sfAccountTxnID;
 
 extern SF_U256 const sfDividendHash;
 extern SF_U256 const sfDividendMarker;
+extern SF_U256 const sfDividendSubtree;
 
 // 256-bit (uncommon)
 extern SF_U256 const sfBookDirectory;
@@ -489,6 +491,8 @@ extern SF_Vec256 const sfIndexes;
 extern SF_Vec256 const sfHashes;
 extern SF_Vec256 const sfAmendments;
 
+extern SF_Vec256 const sfDividendProof;
+
 // inner object
 // OBJECT/1 is reserved for end of object
 extern SField const sfTransactionMetaData;
@@ -508,6 +512,7 @@ extern SField const sfReferenceHolder;
 extern SField const sfFeeShareTaker;
 extern SField const sfReleasePoint;
 extern SField const sfEntry;
+extern SField const sfDividendPayee;
 
 // array of objects
 // ARRAY/1 is reserved for end of array
@@ -528,6 +533,8 @@ extern SField const sfFeeShareTakers;
 extern SField const sfReleaseSchedule;
 extern SField const sfAmounts;
 extern SField const sfLimits;
+extern SField const sfFeeShareAccruals;
+extern SField const sfDividendPayees;
 
 } // ripple
 
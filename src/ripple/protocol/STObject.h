@@ -22,6 +22,7 @@
 
 #include <ripple/basics/contract.h>
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/MemoryTag.h>
 #include <ripple/protocol/STAmount.h>
 #include <ripple/protocol/STPathSet.h>
 #include <ripple/protocol/STVector256.h>
@@ -42,6 +43,10 @@ namespace ripple {
 
 class STArray;
 
+/** The bytes of the field lists of every STObject. */
+MemoryTag&
+stObjectMemory ();
+
 /** Thrown on illegal access to non-present SField. */
 struct missing_field_error : std::logic_error
 {
@@ -289,11 +294,22 @@ private:
         }
     };
 
-    using list_type = std::vector<detail::STVar>;
+    using list_type = std::vector<detail::STVar,
+        TaggedAllocator<detail::STVar, stObjectMemory>>;
 
     list_type v_;
     SOTemplate const* mType;
 
+    // Fields shared with copies of this object. While own_ is false they
+    // are the fields and v_ is empty; a change first takes them over, or
+    // copies them if a copy still holds them.
+    std::shared_ptr<list_type> shared_;
+    bool own_ = true;
+
+    // True while the fields are in ascending field code order, as they are
+    // when deserialized, so a free object finds a field by binary search.
+    bool sorted_ = true;
+
 public:
     using iterator = boost::transform_iterator<
         Transform, STObject::list_type::const_iterator>;
@@ -301,7 +317,7 @@ public:
     static char const* getCountedObjectName () { return "STObject"; }
 
     STObject(STObject&&);
-    STObject(STObject const&) = default;
+    STObject(STObject const&);
     STObject (const SOTemplate & type, SField const& name);
     STObject (const SOTemplate & type, SerialIter & sit, SField const& name);
     STObject (SerialIter& sit, SField const& name);
@@ -309,7 +325,7 @@ public:
         : STObject(sit, name)
     {
     }
-    STObject& operator= (STObject const&) = default;
+    STObject& operator= (STObject const&);
     STObject& operator= (STObject&& other);
 
     explicit STObject (SField const& name);
@@ -330,24 +346,32 @@ public:
 
     iterator begin() const
     {
-        return iterator(v_.begin());
+        return iterator(fields().begin());
     }
 
     iterator end() const
     {
-        return iterator(v_.end());
+        return iterator(fields().end());
     }
 
     bool empty() const
     {
-        return v_.empty();
+        return fields().empty();
     }
 
     void reserve (std::size_t n)
     {
+        own ();
         v_.reserve (n);
     }
 
+    /** Let copies of this object share its fields until one changes.
+
+        Copies made afterwards cost no allocation for the fields. References
+        to fields taken before the call remain valid.
+    */
+    void share ();
+
     bool setType (const SOTemplate & type);
 
     enum ResultOfSetTypeFromSField : unsigned char
@@ -372,7 +396,7 @@ public:
     virtual bool isEquivalent (const STBase & t) const override;
     virtual bool isDefault () const override
     {
-        return v_.empty();
+        return fields().empty();
     }
 
     virtual void add (Serializer & s) const override
@@ -405,13 +429,17 @@ public:
     std::size_t
     emplace_back(Args&&... args)
     {
+        own ();
         v_.emplace_back(std::forward<Args>(args)...);
+        if (sorted_ && v_.size() > 1)
+            sorted_ = v_[v_.size() - 2]->getFName().fieldCode <
+                v_.back()->getFName().fieldCode;
         return v_.size() - 1;
     }
 
     int getCount () const
     {
-        return v_.size ();
+        return fields().size ();
     }
 
     bool setFlag (std::uint32_t);
@@ -424,18 +452,20 @@ public:
 
     const STBase& peekAtIndex (int offset) const
     {
-        return v_[offset].get();
+        return fields()[offset].get();
     }
     STBase& getIndex(int offset)
     {
+        own ();
         return v_[offset].get();
     }
     const STBase* peekAtPIndex (int offset) const
     {
-        return &v_[offset].get();
+        return &fields()[offset].get();
     }
     STBase* getPIndex (int offset)
     {
+        own ();
         return &v_[offset].get();
     }
 
@@ -566,6 +596,14 @@ public:
 private:
     void add (Serializer & s, bool withSigningFields) const;
 
+    list_type const& fields () const
+    {
+        return own_ ? v_ : *shared_;
+    }
+
+    // Make v_ hold the fields before they change
+    void own ();
+
     // Sort the entries in an STObject into the order that they will be
     // serialized.  Note: they are not sorted into pointer value order, they
     // are sorted by SField::fieldCode.
@@ -0,0 +1,116 @@
+#ifndef RIPPLE_PROTOCOL_STOBJECTVIEW_H_INCLUDED
+#define RIPPLE_PROTOCOL_STOBJECTVIEW_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/Serializer.h>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+/** A read only view of a serialized transaction or ledger entry.
+
+    Making the view finds where each top level field is in the serialized
+    data without decoding it, and a field is only decoded when it is read.
+    This is much cheaper than an STObject when a caller reads a few fields
+    of a large object: paths, arrays, inner objects and blobs are skipped.
+
+    The view does not own the data, which must outlive it. To change the
+    object, or to read it as a whole, construct an STTx or STLedgerEntry
+    from slice(); the data is the exact serialization of the object.
+
+    Like a templated STObject, a field which is not present reads as its
+    default value.
+*/
+class STObjectView
+{
+public:
+    /** Index the fields of a serialized object.
+        Only the layout of the values is checked until they are read.
+        Throws:
+            std::runtime_error if the data is not a valid object.
+    */
+    explicit
+    STObjectView (Slice const& data);
+
+    /** The serialized object. */
+    Slice const&
+    slice () const
+    {
+        return data_;
+    }
+
+    /** The number of top level fields. */
+    std::size_t
+    size () const
+    {
+        return fields_.size ();
+    }
+
+    bool
+    isFieldPresent (SField const& field) const;
+
+    // These throw if the field type doesn't match
+    unsigned char getFieldU8 (SField const& field) const;
+    std::uint16_t getFieldU16 (SField const& field) const;
+    std::uint32_t getFieldU32 (SField const& field) const;
+    std::uint64_t getFieldU64 (SField const& field) const;
+    uint128 getFieldH128 (SField const& field) const;
+    uint160 getFieldH160 (SField const& field) const;
+    uint256 getFieldH256 (SField const& field) const;
+    AccountID getAccountID (SField const& field) const;
+    STAmount getFieldAmount (SField const& field) const;
+
+    /** Returns a blob field, which refers to the viewed data. */
+    Slice getFieldVL (SField const& field) const;
+
+    /** Append the fields which are signed, as they were serialized.
+        This is the same as STObject::addWithoutSigningFields.
+    */
+    void
+    addWithoutSigningFields (Serializer& s) const;
+
+private:
+    struct Field
+    {
+        SField const* field;
+
+        // The serialized value, without the field ID
+        Slice value;
+
+        // The field ID and the value
+        Slice data;
+    };
+
+    // Advance past a value without decoding it
+    static
+    void
+    skip (SerialIter& sit, SField const& field);
+
+    // Advance past the fields of an inner object
+    static
+    void
+    skipObject (SerialIter& sit);
+
+    // Advance past the objects of an array
+    static
+    void
+    skipArray (SerialIter& sit);
+
+    Field const*
+    find (SField const& field) const;
+
+    template <class T>
+    typename T::value_type
+    getFieldByValue (SField const& field, SerializedTypeID type) const;
+
+    Slice data_;
+    std::vector<Field> fields_;
+};
+
+} // ripple
+
+#endif
@@ -21,11 +21,15 @@
 #define RIPPLE_PROTOCOL_STTX_H_INCLUDED
 
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/STObject.h>
 #include <ripple/protocol/TxFormats.h>
 #include <boost/container/flat_set.hpp>
 #include <boost/logic/tribool.hpp>
 #include <boost/optional.hpp>
+#include <memory>
+#include <vector>
 
 namespace ripple {
 
@@ -51,7 +55,11 @@ public:
     STTx () = delete;
     STTx& operator= (STTx const& other) = delete;
 
-    STTx (STTx const& other) = default;
+    /** Copy a transaction.
+        The copy does not keep the serialization, so that it may be
+        changed through the STObject interface and serialized again.
+    */
+    STTx (STTx const& other);
 
     explicit STTx (SerialIter& sit);
     explicit STTx (SerialIter&& sit) : STTx(sit) {}
@@ -78,11 +86,22 @@ public:
     }
     std::string getFullText () const override;
 
+    /** Serialize the transaction.
+        A transaction which was deserialized or signed appends the
+        serialization it kept instead of serializing its fields again.
+    */
+    void add (Serializer& s) const override;
+
+    Serializer getSerializer () const;
+
     // Outer transaction functions / signature functions.
     Blob getSignature () const;
 
     uint256 getSigningHash () const;
 
+    /** Returns the data which is signed: the prefix and signing fields. */
+    Blob getSigningData () const;
+
     TxType getTxnType () const
     {
         return tx_type_;
@@ -100,6 +119,7 @@ public:
     }
     void setSequence (std::uint32_t seq)
     {
+        raw_.clear ();
         return setFieldU32 (sfSequence, seq);
     }
 
@@ -113,6 +133,9 @@ public:
 
     void sign (RippleAddress const& private_key);
 
+    /** Sign with a key pair, without deriving the public key again. */
+    void sign (PublicKey const& publicKey, SecretKey const& secretKey);
+
     bool checkSign(bool allowMultiSign) const;
 
     // SQL Functions with metadata.
@@ -131,15 +154,43 @@ public:
         std::uint32_t closeTime) const;
 
 private:
+    friend
+    std::vector<std::shared_ptr<STTx const>>
+    makeTransactions (std::vector<Slice> const& data);
+
+    struct noID_t {};
+
+    // Deserializes without computing the transaction ID
+    STTx (SerialIter& sit, noID_t);
+
+    // Serializes the fields once, keeping the data and its ID
+    void keepSerialization ();
+
     bool checkSingleSign () const;
     bool checkMultiSign () const;
 
+    // The serialization of a transaction which was deserialized or
+    // signed, or empty. Like the ID, it is not updated by changes made
+    // through the STObject interface: sign the transaction again.
+    Blob raw_;
     boost::optional<uint256> tid_;
     TxType tx_type_;
 };
 
 bool passesLocalChecks (STObject const& st, std::string&);
 
+/** Checks the signatures of several transactions.
+
+    Single signatures made with Ed25519 keys are verified together, which
+    is much faster than verifying each of them. The other transactions are
+    checked one at a time, as checkSign does.
+
+    @return Whether each transaction's signature is good, in order.
+*/
+std::vector<bool>
+checkSignBatch (std::vector<std::shared_ptr<STTx const>> const& txs,
+    bool allowMultiSign);
+
 /** Sterilize a transaction.
 
     The transaction is serialized and then deserialized,
@@ -150,6 +201,13 @@ bool passesLocalChecks (STObject const& st, std::string&);
 std::shared_ptr<STTx const>
 sterilize (STTx const& stx);
 
+/** Deserializes several transactions, hashing their IDs together.
+
+    An entry is null where its data is not a valid transaction.
+*/
+std::vector<std::shared_ptr<STTx const>>
+makeTransactions (std::vector<Slice> const& data);
+
 } // ripple
 
 #endif
@@ -103,10 +103,18 @@ public:
     int addRaw (Blob const& vector);
     int addRaw (const void* ptr, int len);
     int addRaw (const Serializer& s);
+    int addRaw (Slice const& slice)
+    {
+        return addRaw (slice.data (), slice.size ());
+    }
     int addZeros (size_t uBytes);
 
     int addVL (Blob const& vector);
     int addVL (const void* ptr, int len);
+    int addVL (Slice const& slice)
+    {
+        return addVL (slice.data (), slice.size ());
+    }
 
     // disassemble functions
     bool get8 (int&, int offset) const;
@@ -57,6 +57,10 @@ enum TxType
     ttADDREFEREE        = 182,
     ttACTIVEACCOUNT     = 183,
     ttISSUE             = 184,
+    ttCOMPACT_ASSET     = 185,
+    ttACTIVE_ACCOUNTS   = 186,
+    ttOFFER_PURGE       = 187,
+    ttFEE_SHARE_SETTLE  = 188,
 };
 
 /** Manages the list of known transaction formats.
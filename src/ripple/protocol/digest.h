@@ -21,11 +21,13 @@
 #define RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 
 #include <ripple/basics/base_uint.h>
+#include <ripple/basics/Slice.h>
 #include <beast/crypto/ripemd.h>
 #include <beast/crypto/sha2.h>
 #include <beast/hash/endian.h>
 #include <algorithm>
 #include <array>
+#include <cstddef>
 
 namespace ripple {
 
@@ -291,6 +293,29 @@ sha512Half_s (Args const&... args)
         sha512_half_hasher_s::result_type>(h);
 }
 
+/** Computes the SHA512-Half of each of several independent messages.
+
+    On processors with AVX2 or AVX-512, messages padding to the same
+    number of blocks are hashed four or eight at a time. The digests are
+    the same as calling sha512Half on each message.
+*/
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count);
+
+namespace detail {
+
+/** Returns the messages the batch kernel hashes at a time, 0 if none. */
+int
+sha512HalfLanes();
+
+/** sha512HalfBatch using a kernel of the given lanes, 0 for per-call. */
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count, int lanes);
+
+} // detail
+
 } // ripple
 
 #endif
@@ -22,22 +22,153 @@
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/digest.h>
 #include <ripple/protocol/tokens.h>
+#include <array>
 #include <cstring>
 
 namespace ripple {
 
+namespace detail {
+
+/*  Recent conversions of account IDs to and from base58
+
+    Every account in a JSON reply or request is converted, and each
+    conversion computes a double SHA-256 checksum. The cache is split
+    into shards with their own locks, so threads rendering replies
+    rarely wait on each other. Each shard keeps two generations in each
+    direction; when the newer fills, the older is dropped.
+
+    Strings come from clients, so they are hashed with a seeded hasher.
+*/
+class AccountIDBase58Cache
+{
+private:
+    static std::size_t const shards = 16;
+
+    // The entries of a generation of one shard
+    static std::size_t const capacity = 1024;
+
+    template <class Map>
+    struct Generations
+    {
+        Map recent;
+        Map old;
+
+        boost::optional<typename Map::mapped_type>
+        find (typename Map::key_type const& key)
+        {
+            auto iter = recent.find (key);
+            if (iter != recent.end ())
+                return iter->second;
+            iter = old.find (key);
+            if (iter == old.end ())
+                return boost::none;
+            auto value = iter->second;
+            insert (key, value);
+            return value;
+        }
+
+        void
+        insert (typename Map::key_type const& key,
+            typename Map::mapped_type const& value)
+        {
+            if (recent.size () >= capacity)
+            {
+                old = std::move (recent);
+                recent.clear ();
+                recent.reserve (capacity);
+            }
+            recent.emplace (key, value);
+        }
+    };
+
+    using StringMap = hardened_hash_map<std::string, AccountID>;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        Generations<hash_map<AccountID, std::string>> strings;
+        Generations<StringMap> ids;
+    };
+
+    std::array<Shard, shards> shards_;
+    StringMap::hasher hasher_;
+
+    Shard&
+    shard (AccountID const& id)
+    {
+        // Account IDs are digests, so any bits select a shard
+        return shards_[*id.data () % shards];
+    }
+
+    Shard&
+    shard (std::string const& s)
+    {
+        return shards_[hasher_ (s) % shards];
+    }
+
+public:
+    static
+    AccountIDBase58Cache&
+    instance ()
+    {
+        static AccountIDBase58Cache cache;
+        return cache;
+    }
+
+    boost::optional<std::string>
+    find (AccountID const& id)
+    {
+        auto& s = shard (id);
+        std::lock_guard<std::mutex> lock (s.mutex);
+        return s.strings.find (id);
+    }
+
+    boost::optional<AccountID>
+    find (std::string const& str)
+    {
+        auto& s = shard (str);
+        std::lock_guard<std::mutex> lock (s.mutex);
+        return s.ids.find (str);
+    }
+
+    void
+    insert (AccountID const& id, std::string const& str)
+    {
+        {
+            auto& s = shard (id);
+            std::lock_guard<std::mutex> lock (s.mutex);
+            s.strings.insert (id, str);
+        }
+        {
+            auto& s = shard (str);
+            std::lock_guard<std::mutex> lock (s.mutex);
+            s.ids.insert (str, id);
+        }
+    }
+};
+
+} // detail
+
 std::string
 toBase58 (AccountID const& v)
 {
-    return base58EncodeToken(
+    auto& cache = detail::AccountIDBase58Cache::instance ();
+    if (auto const found = cache.find (v))
+        return *found;
+    auto result = base58EncodeToken(
         TOKEN_ACCOUNT_ID,
             v.data(), v.size());
+    cache.insert (v, result);
+    return result;
 }
 
 template<>
 boost::optional<AccountID>
 parseBase58 (std::string const& s)
 {
+    auto& cache = detail::AccountIDBase58Cache::instance ();
+    if (auto const found = cache.find (s))
+        return found;
     auto const result =
         decodeBase58Token(
             s, TOKEN_ACCOUNT_ID);
@@ -48,6 +179,7 @@ parseBase58 (std::string const& s)
         return boost::none;
     std::memcpy(id.data(),
         result.data(), result.size());
+    cache.insert (id, s);
     return id;
 }
 
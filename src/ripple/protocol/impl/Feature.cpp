@@ -49,5 +49,12 @@ uint256 const featureMultiSign = feature("MultiSign");
 uint256 const featureSusPay = feature("SusPay");
 uint256 const featureTrustSetAuth = feature("TrustSetAuth");
 uint256 const featureFeeEscalation = feature("FeeEscalation");
+uint256 const featureAssetReleaseSummary = feature("AssetReleaseSummary");
+uint256 const featureCompactAsset = feature("CompactAsset");
+uint256 const featureReferDirectory = feature("ReferDirectory");
+uint256 const featureActiveAccounts = feature("ActiveAccounts");
+uint256 const featureOfferPurge = feature("OfferPurge");
+uint256 const featureFeeShareAccrual = feature("FeeShareAccrual");
+uint256 const featureDividendBatch = feature("DividendBatch");
 
 } // ripple
@@ -236,6 +236,13 @@ getLedgerDividendIndex ()
         std::uint16_t(spaceDividend));
 }
 
+uint256
+getFeeShareAccrualIndex ()
+{
+    return sha512Half(
+        std::uint16_t(spaceFeeShareAccrual));
+}
+
 uint256
 getReferIndex (AccountID const& account)
 {
@@ -244,6 +251,14 @@ getReferIndex (AccountID const& account)
         account);
 }
 
+uint256
+getReferDirIndex (AccountID const& account)
+{
+    return sha512Half(
+        std::uint16_t(spaceReferDir),
+        account);
+}
+
 //------------------------------------------------------------------------------
 
 namespace keylet {
@@ -345,6 +360,12 @@ Keylet dividend_t::operator()() const
         getLedgerDividendIndex() };
 }
 
+Keylet fee_share_accrual_t::operator()() const
+{
+    return { ltFEE_SHARE_ACCRUAL,
+        getFeeShareAccrualIndex() };
+}
+
 Keylet refer_t::operator()(AccountID const& id) const
 {
     return { ltREFER,
@@ -391,6 +412,12 @@ Keylet ownerDir(AccountID const& id)
         getOwnerDirIndex(id) };
 }
 
+Keylet referDir(AccountID const& id)
+{
+    return { ltDIR_NODE,
+        getReferDirIndex(id) };
+}
+
 Keylet page(uint256 const& key,
     std::uint64_t index)
 {
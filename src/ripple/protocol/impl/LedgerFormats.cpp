@@ -107,6 +107,7 @@ LedgerFormats::LedgerFormats ()
             << SOElement (sfHighNode,            SOE_OPTIONAL)
             << SOElement (sfHighQualityIn,       SOE_OPTIONAL)
             << SOElement (sfHighQualityOut,      SOE_OPTIONAL)
+            << SOElement (sfNextReleaseTime,     SOE_OPTIONAL)  // for ASSET lines
             ;
 
     add ("SuspendedPayment", ltSUSPAY) <<
@@ -163,6 +164,12 @@ LedgerFormats::LedgerFormats ()
             << SOElement (sfDividendMarker,      SOE_OPTIONAL)
             ;
 
+    add ("FeeShareAccrual", ltFEE_SHARE_ACCRUAL)
+            << SOElement (sfLedgerSequence,      SOE_REQUIRED)
+            << SOElement (sfPreviousTxnID,       SOE_OPTIONAL)
+            << SOElement (sfPreviousTxnLgrSeq,   SOE_OPTIONAL)
+            ;
+
     add("Refer", ltREFER)
             << SOElement (sfAccount,             SOE_OPTIONAL)
             << SOElement (sfReferences,          SOE_OPTIONAL)
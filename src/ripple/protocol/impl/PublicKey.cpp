@@ -22,18 +22,12 @@
 #include <ripple/protocol/digest.h>
 #include <ripple/protocol/impl/secp256k1.h>
 #include <ripple/basics/contract.h>
-#include <beast/ByteOrder.h>
-#include <boost/multiprecision/cpp_int.hpp>
+#include <ripple/crypto/ECDSACanonical.h>
 #include <ed25519-donna/ed25519.h>
 #include <type_traits>
 
 namespace ripple {
 
-using uint264 = boost::multiprecision::number<
-    boost::multiprecision::cpp_int_backend<
-        264, 264, boost::multiprecision::signed_magnitude,
-            boost::multiprecision::unchecked, void>>;
-
 template<>
 boost::optional<PublicKey>
 parseBase58 (TokenType type, std::string const& s)
@@ -49,123 +43,10 @@ parseBase58 (TokenType type, std::string const& s)
 
 //------------------------------------------------------------------------------
 
-// Parse a length-prefixed number
-//  Format: 0x02 <length-byte> <number>
-static
-boost::optional<Slice>
-sigPart (Slice& buf)
-{
-    if (buf.size() < 3 || buf[0] != 0x02)
-        return boost::none;
-    auto const len = buf[1];
-    buf += 2;
-    if (len > buf.size() || len < 1 || len > 33)
-        return boost::none;
-    // Can't be negative
-    if ((buf[0] & 0x80) != 0)
-        return boost::none;
-    if (buf[0] == 0)
-    {
-        // Can't be zero
-        if (len == 1)
-            return boost::none;
-        // Can't be padded
-        if ((buf[1] & 0x80) == 0)
-            return boost::none;
-    }
-    boost::optional<Slice> number =
-        Slice(buf.data(), len);
-    buf += len;
-    return number;
-}
-
-template <std::size_t N>
-void
-swizzle (void* p);
-
-template<>
-void
-swizzle<4>(void* p)
-{
-    (*reinterpret_cast<std::uint32_t*>(p))=
-        beast::ByteOrder::swapIfLittleEndian(
-            *reinterpret_cast<std::uint32_t*>(p));
-}
-
-template<>
-void
-swizzle<8>(void* p)
-{
-    (*reinterpret_cast<std::uint64_t*>(p))=
-        beast::ByteOrder::swapIfLittleEndian(
-            *reinterpret_cast<std::uint64_t*>(p));
-}
-
-template <class Number>
-static
-void
-load (Number& mp, Slice const& buf)
-{
-    assert(buf.size() != 0);
-    auto& b = mp.backend();         // backend
-    auto const a = &b.limbs()[0];   // limb array
-    using Limb = std::decay_t<
-        decltype(a[0])>;            // word type
-    b.resize((buf.size() + sizeof(Limb) - 1) / sizeof(Limb), 1);
-    std::memset(&a[0], 0,
-        b.size() * sizeof(Limb));   // zero fill
-    auto n =
-        buf.size() / sizeof(Limb);
-    auto s = reinterpret_cast<Limb const*>(
-        buf.data() + buf.size() - sizeof(Limb));
-    auto d = a;
-    while(n--)
-    {
-        *d = *s;
-        swizzle<sizeof(Limb)>(d);
-        d++;
-        s--;
-    }
-    auto const r =
-        buf.size() % sizeof(Limb);
-    if (r > 0)
-    {
-        std::memcpy(
-            reinterpret_cast<std::uint8_t*>(d) + sizeof(Limb) - r,
-                buf.data(), r);
-        swizzle<sizeof(Limb)>(d);
-    }
-}
-
-static
-std::string
-sliceToHex (Slice const& slice)
-{
-    std::string s;
-    if (slice[0] & 0x80)
-    {
-        s.reserve(2 * (slice.size() + 2));
-        s = "0x00";
-    }
-    else
-    {
-        s.reserve(2 * (slice.size() + 1));
-        s = "0x";
-    }
-    for(int i = 0; i < slice.size(); ++i)
-    {
-        s += "0123456789ABCDEF"[((slice[i]&0xf0)>>4)];
-        s += "0123456789ABCDEF"[((slice[i]&0x0f)>>0)];
-    }
-    return s;
-}
-
 /** Determine whether a signature is canonical.
     Canonical signatures are important to protect against signature morphing
     attacks.
-    @param vSig the signature data
-    @param sigLen the length of the signature
-    @param strict_param whether to enforce strictly canonical semantics
+    @param sig the signature data
 
     @note For more details please see:
     https://ripple.com/wiki/Transaction_Malleability
@@ -175,40 +56,12 @@ sliceToHex (Slice const& slice)
 boost::optional<ECDSACanonicality>
 ecdsaCanonicality (Slice const& sig)
 {
-    static uint264 const G(
-        "0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141");
-
-    // The format of a signature should be:
-    // <30> <len> [ <02> <lenR> <R> ] [ <02> <lenS> <S> ]
-    if ((sig.size() < 8) || (sig.size() > 72))
-        return boost::none;
-    if ((sig[0] != 0x30) || (sig[1] != (sig.size() - 2)))
-        return boost::none;
-    Slice p = sig + 2;
-    auto r = sigPart(p);
-    auto s = sigPart(p);
-    if (! r || ! s || ! p.empty())
-        return boost::none;
-#if 0
-    uint264 R;
-    uint264 S;
-    load(R, *r);
-    load(S, *s);
-#else
-    uint264 R(sliceToHex(*r));
-    uint264 S(sliceToHex(*s));
-#endif
-
-    if (R >= G)
-        return boost::none;
-    if (S >= G)
-        return boost::none;
-    // (R,S) and (R,G-S) are canonical,
-    // but is fully canonical when S <= G-S
-    auto const Sp = G - S;
-    if (S > Sp)
+    // Most signatures are fully canonical, so check for that first
+    if (isCanonicalECDSASig (sig.data(), sig.size(), ECDSA::strict))
+        return ECDSACanonicality::fullyCanonical;
+    if (isCanonicalECDSASig (sig.data(), sig.size(), ECDSA::not_strict))
         return ECDSACanonicality::canonical;
-    return ECDSACanonicality::fullyCanonical;
+    return boost::none;
 }
 
 static
@@ -345,6 +198,44 @@ verify (PublicKey const& pk,
     }
 }
 
+std::vector<bool>
+verifyEd25519Batch (std::vector<PublicKey> const& pks,
+    std::vector<Slice> const& messages,
+        std::vector<Slice> const& signatures)
+{
+    assert (pks.size() == messages.size());
+    assert (pks.size() == signatures.size());
+
+    std::vector<bool> result (pks.size(), false);
+
+    // Non-canonical signatures are refused without being checked
+    std::vector<std::size_t> index;
+    std::vector<unsigned char const*> m;
+    std::vector<std::size_t> mlen;
+    std::vector<unsigned char const*> pk;
+    std::vector<unsigned char const*> rs;
+    for (std::size_t i = 0; i < pks.size(); ++i)
+    {
+        assert (pks[i].type() == KeyType::ed25519);
+        if (! ed25519Canonical(signatures[i]))
+            continue;
+        index.push_back(i);
+        m.push_back(messages[i].data());
+        mlen.push_back(messages[i].size());
+        pk.push_back(pks[i].data() + 1);
+        rs.push_back(signatures[i].data());
+    }
+    if (index.empty())
+        return result;
+
+    std::vector<int> valid (index.size());
+    ed25519_sign_open_batch(m.data(), mlen.data(),
+        pk.data(), rs.data(), index.size(), valid.data());
+    for (std::size_t i = 0; i < index.size(); ++i)
+        result[index[i]] = valid[i] == 1;
+    return result;
+}
+
 NodeID
 calcNodeID (PublicKey const& pk)
 {
@@ -83,6 +83,7 @@ SF_U8 const sfTransactionResult = make::one<SF_U8::type>(&sfTransactionResult, S
 
 SF_U8 const sfDividendState     = make::one<SF_U8::type>(&sfDividendState,     STI_UINT8, 181, "DividendState");
 SF_U8 const sfDividendType      = make::one<SF_U8::type>(&sfDividendType,      STI_UINT8, 182, "DividendType");
+SF_U8 const sfDividendDepth     = make::one<SF_U8::type>(&sfDividendDepth,     STI_UINT8, 183, "DividendDepth");
 
 // 16-bit integers
 SF_U16 const sfLedgerEntryType = make::one<SF_U16::type>(&sfLedgerEntryType, STI_UINT16, 1, "LedgerEntryType", SField::sMD_Never);
@@ -174,6 +175,7 @@ SF_U256 const sfAccountTxnID    = make::one<SF_U256::type>(&sfAccountTxnID,    S
 
 SF_U256 const sfDividendHash    = make::one<SF_U256::type>(&sfDividendHash,    STI_HASH256, 181, "DividendHash");
 SF_U256 const sfDividendMarker  = make::one<SF_U256::type>(&sfDividendMarker,  STI_HASH256, 182, "DividendMarker");
+SF_U256 const sfDividendSubtree = make::one<SF_U256::type>(&sfDividendSubtree, STI_HASH256, 183, "DividendSubtree");
 
 // 256-bit (uncommon)
 SF_U256 const sfBookDirectory = make::one<SF_U256::type>(&sfBookDirectory, STI_HASH256, 16, "BookDirectory");
@@ -241,6 +243,8 @@ SF_Vec256 const sfIndexes    = make::one<SF_Vec256::type>(&sfIndexes,    STI_VEC
 SF_Vec256 const sfHashes     = make::one<SF_Vec256::type>(&sfHashes,     STI_VECTOR256, 2, "Hashes");
 SF_Vec256 const sfAmendments = make::one<SF_Vec256::type>(&sfAmendments, STI_VECTOR256, 3, "Amendments");
 
+SF_Vec256 const sfDividendProof = make::one<SF_Vec256::type>(&sfDividendProof, STI_VECTOR256, 181, "DividendProof");
+
 // inner object
 // OBJECT/1 is reserved for end of object
 SField const sfTransactionMetaData = make::one(&sfTransactionMetaData, STI_OBJECT,  2, "TransactionMetaData");
@@ -258,6 +262,7 @@ SField const sfReferenceHolder     = make::one(&sfReferenceHolder,     STI_OBJEC
 SField const sfFeeShareTaker       = make::one(&sfFeeShareTaker,       STI_OBJECT, 182, "FeeShareTaker");
 SField const sfReleasePoint        = make::one(&sfReleasePoint,        STI_OBJECT, 183, "ReleasePoint");
 SField const sfEntry               = make::one(&sfEntry,               STI_OBJECT, 184, "Entry");
+SField const sfDividendPayee       = make::one(&sfDividendPayee,       STI_OBJECT, 185, "DividendPayee");
 
 // inner object (uncommon)
 SField const sfSigner              = make::one(&sfSigner,              STI_OBJECT, 16, "Signer");
@@ -280,6 +285,8 @@ SField const sfFeeShareTakers  = make::one(&sfFeeShareTakers,  STI_ARRAY, 182, "
 SField const sfReleaseSchedule = make::one(&sfReleaseSchedule, STI_ARRAY, 183, "ReleaseSchedule");
 SField const sfAmounts         = make::one(&sfAmounts,         STI_ARRAY, 184, "Amounts");
 SField const sfLimits          = make::one(&sfLimits,          STI_ARRAY, 185, "Limits");
+SField const sfFeeShareAccruals = make::one(&sfFeeShareAccruals, STI_ARRAY, 186, "FeeShareAccruals");
+SField const sfDividendPayees   = make::one(&sfDividendPayees,   STI_ARRAY, 187, "DividendPayees");
 
 // array of objects (uncommon)
 SField const sfMajorities      = make::one(&sfMajorities,      STI_ARRAY, 16, "Majorities");
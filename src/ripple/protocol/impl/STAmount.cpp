@@ -30,6 +30,7 @@
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <iostream>
 
@@ -65,6 +66,35 @@ areComparable (STAmount const& v1, STAmount const& v2)
         v1.issue().currency == v2.issue().currency;
 }
 
+// Compute (value * mul + add) / div, the core of the arithmetic below.
+// A quotient which does not fit in 64 bits comes back as all ones, just
+// as the BIGNUM it used to be computed with returns it.
+static
+std::uint64_t
+mulDivAdd (std::uint64_t value, std::uint64_t mul,
+    std::uint64_t add, std::uint64_t div)
+{
+#ifdef __SIZEOF_INT128__
+    using uint128 = unsigned __int128;
+    uint128 const v = (uint128 (value) * mul + add) / div;
+    if (v > std::numeric_limits<std::uint64_t>::max ())
+        return std::numeric_limits<std::uint64_t>::max ();
+    return static_cast<std::uint64_t> (v);
+#else
+    CBigNum v;
+
+    if ((BN_add_word64 (&v, value) != 1) ||
+            (BN_mul_word64 (&v, mul) != 1) ||
+            (add != 0 && BN_add_word64 (&v, add) != 1) ||
+            (BN_div_word64 (&v, div) == ((std::uint64_t) - 1)))
+    {
+        Throw<std::runtime_error> ("internal bn error");
+    }
+
+    return v.getuint64 ();
+#endif
+}
+
 STAmount::STAmount(SerialIter& sit, SField const& name)
     : STBase(name)
 {
@@ -1073,20 +1103,11 @@ divide (STAmount const& num, STAmount const& den, Issue const& issue)
     }
 
     // Compute (numerator * 10^17) / denominator
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, numVal) != 1) ||
-            (BN_mul_word64 (&v, tenTo17) != 1) ||
-            (BN_div_word64 (&v, denVal) == ((std::uint64_t) - 1)))
-    {
-        Throw<std::runtime_error> ("internal bn error");
-    }
-
     // 10^16 <= quotient <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
+    std::uint64_t const v = mulDivAdd (numVal, tenTo17, 0, denVal);
 
     // TODO(tom): where do 5 and 17 come from?
-    return STAmount (issue, v.getuint64 () + 5,
+    return STAmount (issue, v + 5,
                      numOffset - denOffset - 17,
                      num.negative() != den.negative());
 }
@@ -1137,21 +1158,11 @@ multiply (STAmount const& v1, STAmount const& v2, Issue const& issue)
     }
 
     // Compute (numerator * denominator) / 10^14 with rounding
-    // 10^16 <= result <= 10^18
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, value1) != 1) ||
-            (BN_mul_word64 (&v, value2) != 1) ||
-            (BN_div_word64 (&v, tenTo14) == ((std::uint64_t) - 1)))
-    {
-        Throw<std::runtime_error> ("internal bn error");
-    }
-
     // 10^16 <= product <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
+    std::uint64_t const v = mulDivAdd (value1, value2, 0, tenTo14);
 
     // TODO(tom): where do 7 and 14 come from?
-    return STAmount (issue, v.getuint64 () + 7,
+    return STAmount (issue, v + 7,
         offset1 + offset2 + 14, v1.negative() != v2.negative());
 }
 
@@ -1247,22 +1258,10 @@ mulRound (STAmount const& v1, STAmount const& v2,
 
     bool resultNegative = v1.negative() != v2.negative();
     // Compute (numerator * denominator) / 10^14 with rounding
-    // 10^16 <= result <= 10^18
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, value1) != 1) || (BN_mul_word64 (&v, value2) != 1))
-        Throw<std::runtime_error> ("internal bn error");
-
-    if (resultNegative != roundUp) // rounding down is automatic when we divide
-        BN_add_word64 (&v, tenTo14m1);
-
-    if  (BN_div_word64 (&v, tenTo14) == ((std::uint64_t) - 1))
-        Throw<std::runtime_error> ("internal bn error");
-
     // 10^16 <= product <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
-
-    std::uint64_t amount = v.getuint64 ();
+    // Rounding down is automatic when we divide
+    std::uint64_t amount = mulDivAdd (value1, value2,
+        (resultNegative != roundUp) ? tenTo14m1 : 0, tenTo14);
     int offset = offset1 + offset2 + 14;
     canonicalizeRound (
         isNative (issue), amount, offset, resultNegative != roundUp);
@@ -1308,21 +1307,10 @@ divRound (STAmount const& num, STAmount const& den,
 
     bool resultNegative = num.negative() != den.negative();
     // Compute (numerator * 10^17) / denominator
-    CBigNum v;
-
-    if ((BN_add_word64 (&v, numVal) != 1) || (BN_mul_word64 (&v, tenTo17) != 1))
-        Throw<std::runtime_error> ("internal bn error");
-
-    if (resultNegative != roundUp) // Rounding down is automatic when we divide
-        BN_add_word64 (&v, denVal - 1);
-
-    if (BN_div_word64 (&v, denVal) == ((std::uint64_t) - 1))
-        Throw<std::runtime_error> ("internal bn error");
-
     // 10^16 <= quotient <= 10^18
-    assert (BN_num_bytes (&v) <= 64);
-
-    std::uint64_t amount = v.getuint64 ();
+    // Rounding down is automatic when we divide
+    std::uint64_t amount = mulDivAdd (numVal, tenTo17,
+        (resultNegative != roundUp) ? denVal - 1 : 0, denVal);
     int offset = numOffset - denOffset - 17;
     canonicalizeRound (
         isNative (issue), amount, offset, resultNegative != roundUp);
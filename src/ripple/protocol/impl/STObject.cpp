@@ -24,15 +24,24 @@
 #include <ripple/protocol/STArray.h>
 #include <ripple/protocol/STBlob.h>
 #include <ripple/basics/Log.h>
+#include <algorithm>
+#include <array>
 
 namespace ripple {
 
+MemoryTag&
+stObjectMemory ()
+{
+    static MemoryTag tag ("STObject");
+    return tag;
+}
+
 STObject::~STObject()
 {
 #if 0
     // Turn this on to get a histogram on exit
     static Log log;
-    log(v_.size());
+    log(fields().size());
 #endif
 }
 
@@ -40,6 +49,20 @@ STObject::STObject(STObject&& other)
     : STBase(other.getFName())
     , v_(std::move(other.v_))
     , mType(other.mType)
+    , shared_(std::move(other.shared_))
+    , own_(other.own_)
+    , sorted_(other.sorted_)
+{
+    other.own_ = true;
+}
+
+STObject::STObject(STObject const& other)
+    : STBase(other)
+    , v_(other.own_ ? other.v_ : list_type())
+    , mType(other.mType)
+    , shared_(other.own_ ? nullptr : other.shared_)
+    , own_(other.own_)
+    , sorted_(other.sorted_)
 {
 }
 
@@ -74,20 +97,75 @@ STObject::STObject (SerialIter& sit, SField const& name)
     set(sit, 0);
 }
 
+STObject&
+STObject::operator= (STObject const& other)
+{
+    if (this == &other)
+        return *this;
+    STBase::operator= (other);
+    mType = other.mType;
+    if (other.own_)
+    {
+        v_ = other.v_;
+        shared_.reset();
+    }
+    else
+    {
+        v_.clear();
+        shared_ = other.shared_;
+    }
+    own_ = other.own_;
+    sorted_ = other.sorted_;
+    return *this;
+}
+
 STObject&
 STObject::operator= (STObject&& other)
 {
     setFName(other.getFName());
     mType = other.mType;
     v_ = std::move(other.v_);
+    shared_ = std::move(other.shared_);
+    own_ = other.own_;
+    sorted_ = other.sorted_;
+    other.own_ = true;
     return *this;
 }
 
+void STObject::share ()
+{
+    if (! own_ || v_.empty())
+        return;
+    // Moving the vector leaves its elements where they are
+    shared_ = std::make_shared<list_type>(std::move(v_));
+    v_.clear();
+    own_ = false;
+}
+
+void STObject::own ()
+{
+    if (own_)
+        return;
+    if (shared_.use_count() == 1)
+    {
+        v_ = std::move(*shared_);
+        shared_.reset();
+    }
+    else
+    {
+        // The shared fields are kept, references into them stay valid
+        v_ = *shared_;
+    }
+    own_ = true;
+}
+
 void STObject::set (const SOTemplate& type)
 {
+    own ();
     v_.clear();
     v_.reserve(type.size());
     mType = &type;
+    sorted_ = false;
 
     for (auto const& elem : type.all())
     {
@@ -101,6 +179,7 @@ void STObject::set (const SOTemplate& type)
 bool STObject::setType (const SOTemplate& type)
 {
     bool valid = true;
+    own ();
     mType = &type;
     decltype(v_) v;
     v.reserve(type.size());
@@ -147,6 +226,7 @@ bool STObject::setType (const SOTemplate& type)
     // Swap the template matching data in for the old data,
     // freeing any leftover junk
     v_.swap(v);
+    sorted_ = false;
     return valid;
 }
 
@@ -166,10 +246,11 @@ STObject::setTypeFromSField (SField const& sField)
 
 bool STObject::isValidForType ()
 {
-    auto it = v_.begin();
+    auto const& v = fields();
+    auto it = v.begin();
     for (auto const& elem : mType->all())
     {
-        if (it == v_.end())
+        if (it == v.end())
             return false;
         if (elem->e_field != it->get().getFName())
             return false;
@@ -191,7 +272,9 @@ bool STObject::set (SerialIter& sit, int depth)
 {
     bool reachedEndOfObject = false;
 
+    own ();
     v_.clear();
+    sorted_ = true;
 
     // Consume data in the pipe until we run out or reach the end
     //
@@ -228,6 +311,8 @@ bool STObject::set (SerialIter& sit, int depth)
             }
 
             // Unflatten the field
+            if (sorted_ && ! v_.empty())
+                sorted_ = v_.back()->getFName().fieldCode < fn.fieldCode;
             v_.emplace_back(sit, fn);
 
             // If the object type has a known SOTemplate then set it.
@@ -264,7 +349,7 @@ std::string STObject::getFullText () const
     }
     else ret = "{";
 
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (elem->getSType () != STI_NOTPRESENT)
         {
@@ -285,7 +370,7 @@ std::string STObject::getText () const
 {
     std::string ret = "{";
     bool first = false;
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (! first)
         {
@@ -316,9 +401,23 @@ bool STObject::isEquivalent (const STBase& t) const
     return equivalentSTObject (*this, *v);
 }
 
+// Objects are hashed in a buffer kept by the thread, which stops allocating
+// once it has grown to the size of the objects hashed. A buffer grown by an
+// unusually large object is given up.
+static
+Serializer&
+hashBuffer ()
+{
+    thread_local Serializer s;
+    if (s.capacity () > 64 * 1024)
+        s = Serializer ();
+    s.erase ();
+    return s;
+}
+
 uint256 STObject::getHash (std::uint32_t prefix) const
 {
-    Serializer s;
+    auto& s = hashBuffer ();
     s.add32 (prefix);
     add (s, true);
     return s.getSHA512Half ();
@@ -326,7 +425,7 @@ uint256 STObject::getHash (std::uint32_t prefix) const
 
 uint256 STObject::getSigningHash (std::uint32_t prefix) const
 {
-    Serializer s;
+    auto& s = hashBuffer ();
     s.add32 (prefix);
     add (s, false);
     return s.getSHA512Half ();
@@ -337,8 +436,22 @@ int STObject::getFieldIndex (SField const& field) const
     if (mType != nullptr)
         return mType->getIndex (field);
 
+    auto const& v = fields();
+    if (sorted_)
+    {
+        auto const iter = std::lower_bound (v.begin (), v.end (),
+            field.fieldCode,
+            [](detail::STVar const& e, int code)
+            {
+                return e->getFName ().fieldCode < code;
+            });
+        if (iter == v.end () || (*iter)->getFName () != field)
+            return -1;
+        return iter - v.begin ();
+    }
+
     int i = 0;
-    for (auto const& elem : v_)
+    for (auto const& elem : v)
     {
         if (elem->getFName () == field)
             return i;
@@ -370,7 +483,7 @@ STBase& STObject::getField (SField const& field)
 SField const&
 STObject::getFieldSType (int index) const
 {
-    return v_[index]->getFName ();
+    return fields()[index]->getFName ();
 }
 
 const STBase* STObject::peekAtPField (SField const& field) const
@@ -472,6 +585,7 @@ STBase* STObject::makeFieldPresent (SField const& field)
     if (f->getSType () != STI_NOTPRESENT)
         return f;
 
+    own ();
     v_[index] = detail::STVar(
         detail::defaultObject, f->getFName());
     return getPIndex (index);
@@ -488,6 +602,7 @@ void STObject::makeFieldAbsent (SField const& field)
 
     if (f.getSType () == STI_NOTPRESENT)
         return;
+    own ();
     v_[index] = detail::STVar(
         detail::nonPresentObject, f.getFName());
 }
@@ -505,6 +620,7 @@ bool STObject::delField (SField const& field)
 
 void STObject::delField (int index)
 {
+    own ();
     v_.erase (v_.begin () + index);
 }
 
@@ -599,6 +715,7 @@ STObject::set (std::unique_ptr<STBase> v)
 {
     auto const i =
         getFieldIndex(v->getFName());
+    own ();
     if (i != -1)
     {
         v_[i] = std::move(*v);
@@ -608,7 +725,7 @@ STObject::set (std::unique_ptr<STBase> v)
         if (! isFree())
             Throw<std::runtime_error> (
                 "missing field in templated STObject");
-        v_.emplace_back(std::move(*v));
+        emplace_back(std::move(*v));
     }
 }
 
@@ -683,7 +800,7 @@ Json::Value STObject::getJson (int options) const
 
     // TODO(tom): this variable is never changed...?
     int index = 1;
-    for (auto const& elem : v_)
+    for (auto const& elem : fields())
     {
         if (elem->getSType () != STI_NOTPRESENT)
         {
@@ -701,13 +818,13 @@ bool STObject::operator== (const STObject& obj) const
     // This is not particularly efficient, and only compares data elements
     // with binary representations
     int matches = 0;
-    for (auto const& t1 : v_)
+    for (auto const& t1 : fields())
     {
         if ((t1->getSType () != STI_NOTPRESENT) && t1->getFName ().isBinary ())
         {
             // each present field must have a matching field
             bool match = false;
-            for (auto const& t2 : obj.v_)
+            for (auto const& t2 : obj.fields())
             {
                 if (t1->getFName () == t2->getFName ())
                 {
@@ -731,7 +848,7 @@ bool STObject::operator== (const STObject& obj) const
     }
 
     int fields = 0;
-    for (auto const& t2 : obj.v_)
+    for (auto const& t2 : obj.fields())
     {
         if ((t2->getSType () != STI_NOTPRESENT) && t2->getFName ().isBinary ())
             ++fields;
@@ -749,22 +866,46 @@ bool STObject::operator== (const STObject& obj) const
 
 void STObject::add (Serializer& s, bool withSigningFields) const
 {
-    std::map<int, STBase const*> fields;
-    for (auto const& e : v_)
+    // Most objects have few enough fields to sort them on the stack
+    std::array<STBase const*, 32> small;
+    std::vector<STBase const*> large;
+    auto const& v = STObject::fields();
+    STBase const** first = small.data();
+    if (v.size() > small.size())
+    {
+        large.resize (v.size());
+        first = large.data();
+    }
+    STBase const** last = first;
+
+    // pick out the fields and sort them
+    for (auto const& e : v)
     {
-        // pick out the fields and sort them
         if ((e->getSType() != STI_NOTPRESENT) &&
             e->getFName().shouldInclude (withSigningFields))
         {
-            fields.insert (std::make_pair (
-                e->getFName().fieldCode, &e.get()));
+            // Insertion sort, which keeps the first of any duplicates
+            auto const code = e->getFName().fieldCode;
+            auto pos = last;
+            while (pos != first && (*(pos - 1))->getFName().fieldCode > code)
+            {
+                *pos = *(pos - 1);
+                --pos;
+            }
+            if (pos != first && (*(pos - 1))->getFName().fieldCode == code)
+            {
+                std::move (pos + 1, last + 1, pos);
+                continue;
+            }
+            *pos = &e.get();
+            ++last;
         }
     }
 
     // insert sorted
-    for (auto const& e : fields)
+    for (auto pos = first; pos != last; ++pos)
     {
-        auto const field = e.second;
+        auto const field = *pos;
 
         // When we serialize an object inside another object,
         // the type associated by rule with this field name
@@ -787,7 +928,7 @@ STObject::getSortedFields (STObject const& objToSort)
     sf.reserve (objToSort.getCount ());
 
     // Choose the fields that we need to sort.
-    for (detail::STVar const& elem : objToSort.v_)
+    for (detail::STVar const& elem : objToSort.fields())
     {
         // Pick out the fields and sort them.
         STBase const& base = elem.get();
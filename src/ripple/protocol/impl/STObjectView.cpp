@@ -0,0 +1,253 @@
+#include <BeastConfig.h>
+#include <ripple/protocol/STObjectView.h>
+#include <ripple/basics/contract.h>
+#include <ripple/protocol/STAccount.h>
+#include <ripple/protocol/STBitString.h>
+#include <ripple/protocol/STInteger.h>
+#include <ripple/protocol/STPathSet.h>
+
+namespace ripple {
+
+STObjectView::STObjectView (Slice const& data)
+    : data_ (data)
+{
+    SerialIter sit (data_);
+    while (! sit.empty ())
+    {
+        auto const start = data_.size () - sit.getBytesLeft ();
+        int type;
+        int name;
+        sit.getFieldID (type, name);
+
+        if ((type == STI_OBJECT || type == STI_ARRAY) && name == 1)
+            Throw<std::runtime_error> ("Illegal terminator in object");
+
+        auto const& field = SField::getField (type, name);
+        if (field.isInvalid ())
+            Throw<std::runtime_error> ("Unknown field");
+
+        auto const begin = data_.size () - sit.getBytesLeft ();
+        skip (sit, field);
+        auto const end = data_.size () - sit.getBytesLeft ();
+        fields_.push_back ({&field,
+            Slice (data_.data () + begin, end - begin),
+            Slice (data_.data () + start, end - start)});
+    }
+}
+
+void
+STObjectView::skip (SerialIter& sit, SField const& field)
+{
+    switch (field.fieldType)
+    {
+    case STI_UINT8:     sit.skip (1); return;
+    case STI_UINT16:    sit.skip (2); return;
+    case STI_UINT32:    sit.skip (4); return;
+    case STI_UINT64:    sit.skip (8); return;
+    case STI_HASH128:   sit.skip (16); return;
+    case STI_HASH160:   sit.skip (20); return;
+    case STI_HASH256:   sit.skip (32); return;
+
+    case STI_AMOUNT:
+    {
+        // A native amount is its value, an issued one adds the issue
+        auto const value = sit.get64 ();
+        if (value & STAmount::cNotNative)
+            sit.skip (40);
+        return;
+    }
+
+    case STI_VL:
+    case STI_ACCOUNT:
+    case STI_VECTOR256:
+        sit.skip (sit.getVLDataLength ());
+        return;
+
+    case STI_PATHSET:
+        for (;;)
+        {
+            int const element = sit.get8 ();
+            if (element == STPathElement::typeNone)
+                return;
+            if (element == STPathElement::typeBoundary)
+                continue;
+            if (element & ~STPathElement::typeAll)
+                Throw<std::runtime_error> ("bad path element");
+            if (element & STPathElement::typeAccount)
+                sit.skip (20);
+            if (element & STPathElement::typeCurrency)
+                sit.skip (20);
+            if (element & STPathElement::typeIssuer)
+                sit.skip (20);
+        }
+
+    case STI_OBJECT:
+        skipObject (sit);
+        return;
+
+    case STI_ARRAY:
+        skipArray (sit);
+        return;
+
+    default:
+        Throw<std::runtime_error> ("Unknown object type");
+    }
+}
+
+void
+STObjectView::skipObject (SerialIter& sit)
+{
+    while (! sit.empty ())
+    {
+        int type;
+        int name;
+        sit.getFieldID (type, name);
+
+        if (type == STI_OBJECT && name == 1)
+            return;
+        if (type == STI_ARRAY && name == 1)
+            Throw<std::runtime_error> ("Illegal terminator in object");
+
+        auto const& field = SField::getField (type, name);
+        if (field.isInvalid ())
+            Throw<std::runtime_error> ("Unknown field");
+        skip (sit, field);
+    }
+}
+
+void
+STObjectView::skipArray (SerialIter& sit)
+{
+    while (! sit.empty ())
+    {
+        int type;
+        int name;
+        sit.getFieldID (type, name);
+
+        if (type == STI_ARRAY && name == 1)
+            return;
+        if (type == STI_OBJECT && name == 1)
+            Throw<std::runtime_error> ("Illegal terminator in array");
+
+        auto const& field = SField::getField (type, name);
+        if (field.isInvalid ())
+            Throw<std::runtime_error> ("Unknown field");
+        if (field.fieldType != STI_OBJECT)
+            Throw<std::runtime_error> ("Non-object in array");
+        skipObject (sit);
+    }
+}
+
+auto
+STObjectView::find (SField const& field) const ->
+    Field const*
+{
+    for (auto const& f : fields_)
+    {
+        if (f.field->fieldCode == field.fieldCode)
+            return &f;
+    }
+    return nullptr;
+}
+
+bool
+STObjectView::isFieldPresent (SField const& field) const
+{
+    return find (field) != nullptr;
+}
+
+void
+STObjectView::addWithoutSigningFields (Serializer& s) const
+{
+    for (auto const& f : fields_)
+    {
+        if (f.field->isSigningField ())
+            s.addRaw (f.data.data (), f.data.size ());
+    }
+}
+
+template <class T>
+typename T::value_type
+STObjectView::getFieldByValue (SField const& field,
+    SerializedTypeID type) const
+{
+    if (field.fieldType != type)
+        Throw<std::runtime_error> ("Wrong field type");
+
+    auto const f = find (field);
+    if (! f)
+        return typename T::value_type{};
+
+    SerialIter sit (f->value);
+    return T (sit, field).value ();
+}
+
+unsigned char
+STObjectView::getFieldU8 (SField const& field) const
+{
+    return getFieldByValue<STUInt8> (field, STI_UINT8);
+}
+
+std::uint16_t
+STObjectView::getFieldU16 (SField const& field) const
+{
+    return getFieldByValue<STUInt16> (field, STI_UINT16);
+}
+
+std::uint32_t
+STObjectView::getFieldU32 (SField const& field) const
+{
+    return getFieldByValue<STUInt32> (field, STI_UINT32);
+}
+
+std::uint64_t
+STObjectView::getFieldU64 (SField const& field) const
+{
+    return getFieldByValue<STUInt64> (field, STI_UINT64);
+}
+
+uint128
+STObjectView::getFieldH128 (SField const& field) const
+{
+    return getFieldByValue<STHash128> (field, STI_HASH128);
+}
+
+uint160
+STObjectView::getFieldH160 (SField const& field) const
+{
+    return getFieldByValue<STHash160> (field, STI_HASH160);
+}
+
+uint256
+STObjectView::getFieldH256 (SField const& field) const
+{
+    return getFieldByValue<STHash256> (field, STI_HASH256);
+}
+
+AccountID
+STObjectView::getAccountID (SField const& field) const
+{
+    return getFieldByValue<STAccount> (field, STI_ACCOUNT);
+}
+
+STAmount
+STObjectView::getFieldAmount (SField const& field) const
+{
+    return getFieldByValue<STAmount> (field, STI_AMOUNT);
+}
+
+Slice
+STObjectView::getFieldVL (SField const& field) const
+{
+    if (field.fieldType != STI_VL)
+        Throw<std::runtime_error> ("Wrong field type");
+
+    auto const f = find (field);
+    if (! f)
+        return Slice ();
+
+    SerialIter sit (f->value);
+    return sit.getSlice (sit.getVLDataLength ());
+}
+
+} // ripple
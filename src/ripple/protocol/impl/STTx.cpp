@@ -20,12 +20,16 @@
 #include <BeastConfig.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/Sign.h>
 #include <ripple/protocol/STAccount.h>
 #include <ripple/protocol/STArray.h>
+#include <ripple/protocol/STObjectView.h>
 #include <ripple/protocol/TxFlags.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/protocol/types.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
@@ -36,6 +40,7 @@
 #include <array>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -81,6 +86,20 @@ STTx::STTx (STObject&& object)
 }
 
 STTx::STTx (SerialIter& sit)
+    : STTx (sit, noID_t {})
+{
+    keepSerialization ();
+}
+
+STTx::STTx (STTx const& other)
+    : STObject (other)
+    , CountedObject <STTx> (other)
+    , tid_ (other.tid_)
+    , tx_type_ (other.tx_type_)
+{
+}
+
+STTx::STTx (SerialIter& sit, noID_t)
     : STObject (sfTransaction)
 {
     int length = sit.getBytesLeft ();
@@ -110,8 +129,32 @@ STTx::STTx (SerialIter& sit)
             "Transaction not legal for format";
         Throw<std::runtime_error> ("transaction not valid");
     }
+}
 
-    tid_ = getHash(HashPrefix::transactionID);
+void
+STTx::keepSerialization ()
+{
+    Serializer s;
+    STObject::add (s);
+    raw_ = std::move (s.modData ());
+    tid_ = sha512Half (HashPrefix::transactionID, makeSlice (raw_));
+}
+
+void
+STTx::add (Serializer& s) const
+{
+    if (raw_.empty ())
+        STObject::add (s);
+    else
+        s.addRaw (raw_);
+}
+
+Serializer
+STTx::getSerializer () const
+{
+    Serializer s;
+    add (s);
+    return s;
 }
 
 std::string
@@ -149,18 +192,31 @@ STTx::getMentionedAccounts () const
     return list;
 }
 
-static Blob getSigningData (STTx const& that)
+// The signed fields are copied from the serialization where it was kept
+static
+void
+addSigningFields (STObject const& object, Blob const& raw, Serializer& s)
+{
+    if (raw.empty ())
+        object.addWithoutSigningFields (s);
+    else
+        STObjectView (makeSlice (raw)).addWithoutSigningFields (s);
+}
+
+Blob
+STTx::getSigningData () const
 {
     Serializer s;
     s.add32 (HashPrefix::txSign);
-    that.addWithoutSigningFields (s);
-    return s.getData();
+    addSigningFields (*this, raw_, s);
+    return std::move (s.modData ());
 }
 
 uint256
 STTx::getSigningHash () const
 {
-    return STObject::getSigningHash (HashPrefix::txSign);
+    auto const data = getSigningData ();
+    return sha512Half (makeSlice (data));
 }
 
 uint256
@@ -186,9 +242,20 @@ Blob STTx::getSignature () const
 
 void STTx::sign (RippleAddress const& private_key)
 {
-    Blob const signature = private_key.accountPrivateSign (getSigningData (*this));
+    raw_.clear ();
+    Blob const signature = private_key.accountPrivateSign (getSigningData ());
     setFieldVL (sfTxnSignature, signature);
-    tid_ = getHash(HashPrefix::transactionID);
+    keepSerialization ();
+}
+
+void STTx::sign (PublicKey const& publicKey, SecretKey const& secretKey)
+{
+    raw_.clear ();
+    auto const signature = ripple::sign (
+        publicKey, secretKey, makeSlice (getSigningData ()));
+    setFieldVL (sfTxnSignature,
+        Blob (signature.data (), signature.data () + signature.size ()));
+    keepSerialization ();
 }
 
 bool STTx::checkSign(bool allowMultiSign) const
@@ -218,6 +285,7 @@ bool STTx::checkSign(bool allowMultiSign) const
 
 void STTx::setSigningPubKey (RippleAddress const& naSignPubKey)
 {
+    raw_.clear ();
     setFieldVL (sfSigningPubKey, naSignPubKey.getAccountPublic ());
 }
 
@@ -233,7 +301,7 @@ Json::Value STTx::getJson (int options, bool binary) const
     if (binary)
     {
         Json::Value ret;
-        Serializer s = STObject::getSerializer ();
+        Serializer s = getSerializer ();
         ret[jss::tx] = strHex (s.peekData ());
         ret[jss::hash] = to_string (getTransactionID ());
         return ret;
@@ -304,7 +372,7 @@ STTx::checkSingleSign () const
         RippleAddress n;
         n.setAccountPublic (getFieldVL (sfSigningPubKey));
 
-        ret = n.accountPublicVerify (getSigningData (*this),
+        ret = n.accountPublicVerify (getSigningData (),
             getFieldVL (sfTxnSignature), fullyCanonical);
     }
     catch (std::exception const&)
@@ -337,7 +405,9 @@ STTx::checkMultiSign () const
     // We can ease the computational load inside the loop a bit by
     // pre-constructing part of the data that we hash.  Fill a Serializer
     // with the stuff that stays constant from signature to signature.
-    Serializer const dataStart {startMultiSigningData (*this)};
+    Serializer dataStart;
+    dataStart.add32 (HashPrefix::txMultiSign);
+    addSigningFields (*this, raw_, dataStart);
 
     // We also use the sfAccount field inside the loop.  Get it once.
     auto const txnAccountID = getAccountID (sfAccount);
@@ -517,6 +587,62 @@ bool passesLocalChecks (STObject const& st, std::string& reason)
     return true;
 }
 
+std::vector<bool>
+checkSignBatch (std::vector<std::shared_ptr<STTx const>> const& txs,
+    bool allowMultiSign)
+{
+    std::vector<bool> result (txs.size (), false);
+
+    std::vector<std::size_t> index;
+    std::vector<PublicKey> pks;
+    std::vector<Blob> data;
+    std::vector<Blob> signatures;
+    for (std::size_t i = 0; i < txs.size (); ++i)
+    {
+        auto const& tx = *txs[i];
+        try
+        {
+            if (! tx.isFieldPresent (sfSigners))
+            {
+                auto const pk = tx.getFieldVL (sfSigningPubKey);
+                auto const type = publicKeyType (makeSlice (pk));
+                if (type && *type == KeyType::ed25519)
+                {
+                    auto sig = tx.getFieldVL (sfTxnSignature);
+                    if (sig.size () != 64)
+                        continue;
+                    index.push_back (i);
+                    pks.emplace_back (makeSlice (pk));
+                    data.push_back (tx.getSigningData ());
+                    signatures.push_back (std::move (sig));
+                    continue;
+                }
+            }
+        }
+        catch (std::exception const&)
+        {
+            // Assume it was a signature failure.
+            continue;
+        }
+        result[i] = tx.checkSign (allowMultiSign);
+    }
+
+    if (! index.empty ())
+    {
+        std::vector<Slice> messages;
+        std::vector<Slice> sigs;
+        for (std::size_t i = 0; i < index.size (); ++i)
+        {
+            messages.push_back (makeSlice (data[i]));
+            sigs.push_back (makeSlice (signatures[i]));
+        }
+        auto const valid = verifyEd25519Batch (pks, messages, sigs);
+        for (std::size_t i = 0; i < index.size (); ++i)
+            result[index[i]] = valid[i];
+    }
+    return result;
+}
+
 std::shared_ptr<STTx const>
 sterilize (STTx const& stx)
 {
@@ -526,4 +652,61 @@ sterilize (STTx const& stx)
     return std::make_shared<STTx const>(std::ref(sit));
 }
 
+std::vector<std::shared_ptr<STTx const>>
+makeTransactions (std::vector<Slice> const& data)
+{
+    std::vector<std::shared_ptr<STTx>> txs;
+    txs.reserve (data.size ());
+
+    // What each ID covers, one after another
+    Serializer s;
+    std::vector<int> offsets;
+    offsets.reserve (data.size ());
+
+    for (auto const& slice : data)
+    {
+        try
+        {
+            SerialIter sit (slice);
+            txs.emplace_back (new STTx (sit, STTx::noID_t {}));
+        }
+        catch (std::exception const&)
+        {
+            txs.emplace_back ();
+            continue;
+        }
+        auto& tx = *txs.back ();
+        Serializer fields;
+        tx.STObject::add (fields);
+        tx.raw_ = std::move (fields.modData ());
+
+        offsets.push_back (s.getDataLength ());
+        s.add32 (HashPrefix::transactionID);
+        s.addRaw (tx.raw_);
+    }
+
+    std::vector<Slice> messages;
+    messages.reserve (offsets.size ());
+    for (std::size_t i = 0; i < offsets.size (); ++i)
+    {
+        auto const end = (i + 1 < offsets.size ()) ?
+            offsets[i + 1] : s.getDataLength ();
+        messages.emplace_back (s.peekData ().data () + offsets[i],
+            end - offsets[i]);
+    }
+    std::vector<uint256> ids (messages.size ());
+    sha512HalfBatch (messages.data (), ids.data (), messages.size ());
+
+    std::vector<std::shared_ptr<STTx const>> result;
+    result.reserve (txs.size ());
+    std::size_t next = 0;
+    for (auto& tx : txs)
+    {
+        if (tx)
+            tx->tid_ = ids[next++];
+        result.push_back (std::move (tx));
+    }
+    return result;
+}
+
 } // ripple
@@ -119,6 +119,10 @@ TxFormats::TxFormats ()
         << SOElement (sfDividendVSprd,       SOE_OPTIONAL)
         << SOElement (sfDividendTSprd,       SOE_OPTIONAL)
         << SOElement (sfDividendHash,        SOE_OPTIONAL)
+        << SOElement (sfDividendDepth,       SOE_OPTIONAL)
+        << SOElement (sfDividendSubtree,     SOE_OPTIONAL)
+        << SOElement (sfDividendProof,       SOE_OPTIONAL)
+        << SOElement (sfDividendPayees,      SOE_OPTIONAL)
         ;
 
     add("AddReferee", ttADDREFEREE)
@@ -134,12 +138,31 @@ TxFormats::TxFormats ()
         << SOElement(sfLimits,               SOE_OPTIONAL)
         ;
 
+    add("ActiveAccounts", ttACTIVE_ACCOUNTS)
+        << SOElement(sfReferee,              SOE_REQUIRED)
+        << SOElement(sfReferences,           SOE_REQUIRED)
+        << SOElement(sfAmount,               SOE_REQUIRED)
+        ;
+
     add("Issue", ttISSUE)
         << SOElement (sfDestination,         SOE_REQUIRED)
         << SOElement (sfAmount,              SOE_REQUIRED)
         << SOElement (sfReleaseSchedule,     SOE_REQUIRED)
         ;
 
+    add("CompactAsset", ttCOMPACT_ASSET)
+        << SOElement (sfIndexes,             SOE_REQUIRED)  // ASSET lines
+        ;
+
+    add("OfferPurge", ttOFFER_PURGE)
+        << SOElement (sfIndexes,             SOE_REQUIRED)  // offers
+        ;
+
+    add("FeeShareSettle", ttFEE_SHARE_SETTLE)
+        << SOElement (sfLedgerSequence,      SOE_REQUIRED)  // settled through
+        << SOElement (sfFeeShareTakers,      SOE_OPTIONAL)
+        ;
+
     // The SignerEntries are optional because a SignerList is deleted by
     // setting the SignerQuorum to zero and omitting SignerEntries.
     add ("SignerListSet", ttSIGNER_LIST_SET)
@@ -19,7 +19,11 @@
 
 #include <BeastConfig.h>
 #include <ripple/protocol/digest.h>
+#include <algorithm>
+#include <cstring>
 #include <type_traits>
+#include <utility>
+#include <vector>
 #include <openssl/ripemd.h>
 #include <openssl/sha.h>
 
@@ -113,4 +117,287 @@ openssl_sha256_hasher::operator result_type() noexcept
     return digest;
 }
 
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+// FIPS 180-4 round constants and initial hash value
+static std::uint64_t const sha512K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL};
+
+static std::uint64_t const sha512H[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+
+static
+std::size_t
+sha512Blocks (std::size_t size)
+{
+    // The message, a one bit, and the 128 bit length
+    return (size + 17 + 127) / 128;
+}
+
+/*  A message being hashed in a lane: its whole blocks are read in place,
+    the last one or two are copied and padded.
+*/
+struct sha512Lane
+{
+    std::uint8_t const* data;
+    std::size_t full;
+    std::uint8_t tail[256];
+
+    void
+    reset (Slice const& message, std::size_t blocks)
+    {
+        auto const size = message.size ();
+        data = message.data ();
+        full = size / 128;
+
+        auto const rest = size - full * 128;
+        auto const total = (blocks - full) * 128;
+        if (rest != 0)
+            std::memcpy (tail, data + full * 128, rest);
+        tail[rest] = 0x80;
+        std::memset (tail + rest + 1, 0, total - rest - 1);
+        std::uint64_t const bits = static_cast<std::uint64_t> (size) * 8;
+        for (int i = 0; i < 8; ++i)
+            tail[total - 1 - i] = static_cast<std::uint8_t> (bits >> (8 * i));
+    }
+
+    std::uint8_t const*
+    block (std::size_t b) const
+    {
+        return (b < full) ? data + b * 128 : tail + (b - full) * 128;
+    }
+};
+
+#if (defined (__GNUC__) || defined (__clang__)) && defined (__x86_64__)
+#define RIPPLE_SHA512_LANES 1
+#else
+#define RIPPLE_SHA512_LANES 0
+#endif
+
+#if RIPPLE_SHA512_LANES
+
+#define RIPPLE_SHA512_ROTR(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+/*  Runs SHA-512 over N messages of the same number of blocks, one in
+    each lane of the vector type V, and writes the first half of each
+    digest. The callers below compile it for AVX2 and AVX-512.
+*/
+template <class V, int N>
+__attribute__((always_inline)) inline
+void
+sha512Lanes (sha512Lane const* in, std::size_t blocks,
+    std::uint8_t* const* out)
+{
+    V s[8];
+    for (int i = 0; i < 8; ++i)
+        for (int l = 0; l < N; ++l)
+            s[i][l] = sha512H[i];
+
+    for (std::size_t b = 0; b < blocks; ++b)
+    {
+        // The message schedule, as a ring of sixteen words
+        V w[16];
+        for (int l = 0; l < N; ++l)
+        {
+            auto const block = in[l].block (b);
+            for (int t = 0; t < 16; ++t)
+            {
+                std::uint64_t x;
+                std::memcpy (&x, block + 8 * t, 8);
+                w[t][l] = __builtin_bswap64 (x);
+            }
+        }
+
+        V a = s[0], c1 = s[1], c2 = s[2], d = s[3];
+        V e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int t = 0; t < 80; ++t)
+        {
+            if (t >= 16)
+            {
+                V const w15 = w[(t - 15) & 15];
+                V const w2 = w[(t - 2) & 15];
+                w[t & 15] += w[(t - 7) & 15] +
+                    (RIPPLE_SHA512_ROTR (w15, 1) ^
+                        RIPPLE_SHA512_ROTR (w15, 8) ^ (w15 >> 7)) +
+                    (RIPPLE_SHA512_ROTR (w2, 19) ^
+                        RIPPLE_SHA512_ROTR (w2, 61) ^ (w2 >> 6));
+            }
+            V const t1 = h + sha512K[t] + w[t & 15] +
+                (RIPPLE_SHA512_ROTR (e, 14) ^ RIPPLE_SHA512_ROTR (e, 18) ^
+                    RIPPLE_SHA512_ROTR (e, 41)) +
+                ((e & f) ^ (~e & g));
+            V const t2 =
+                (RIPPLE_SHA512_ROTR (a, 28) ^ RIPPLE_SHA512_ROTR (a, 34) ^
+                    RIPPLE_SHA512_ROTR (a, 39)) +
+                ((a & c1) ^ (a & c2) ^ (c1 & c2));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c2;
+            c2 = c1;
+            c1 = a;
+            a = t1 + t2;
+        }
+        s[0] += a;
+        s[1] += c1;
+        s[2] += c2;
+        s[3] += d;
+        s[4] += e;
+        s[5] += f;
+        s[6] += g;
+        s[7] += h;
+    }
+
+    for (int l = 0; l < N; ++l)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            std::uint64_t const x = __builtin_bswap64 (s[i][l]);
+            std::memcpy (out[l] + 8 * i, &x, 8);
+        }
+    }
+}
+
+#undef RIPPLE_SHA512_ROTR
+
+using sha512x4_type = std::uint64_t __attribute__((vector_size (32)));
+using sha512x8_type = std::uint64_t __attribute__((vector_size (64)));
+
+__attribute__((target ("avx2")))
+static
+void
+sha512HalfX4 (sha512Lane const* in, std::size_t blocks,
+    std::uint8_t* const* out)
+{
+    sha512Lanes<sha512x4_type, 4> (in, blocks, out);
+}
+
+__attribute__((target ("avx512f")))
+static
+void
+sha512HalfX8 (sha512Lane const* in, std::size_t blocks,
+    std::uint8_t* const* out)
+{
+    sha512Lanes<sha512x8_type, 8> (in, blocks, out);
+}
+
+#endif
+
+int
+sha512HalfLanes()
+{
+#if RIPPLE_SHA512_LANES
+    static int const lanes =
+        __builtin_cpu_supports ("avx512f") ? 8 :
+        __builtin_cpu_supports ("avx2") ? 4 : 0;
+    return lanes;
+#else
+    return 0;
+#endif
+}
+
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count, int lanes)
+{
+#if RIPPLE_SHA512_LANES
+    // Fewer messages than this in a group are cheaper to hash one by one
+    int const minLanes = 3;
+
+    if (lanes == 4 || lanes == 8)
+    {
+        std::size_t const width = lanes;
+
+        // Group the messages by their number of blocks
+        std::vector<std::pair<std::size_t, std::size_t>> order;
+        order.reserve (count);
+        for (std::size_t i = 0; i < count; ++i)
+            order.emplace_back (sha512Blocks (messages[i].size ()), i);
+        std::sort (order.begin (), order.end ());
+
+        sha512Lane in[8];
+        std::uint8_t* out[8];
+        std::uint8_t scratch[8][32];
+
+        for (std::size_t i = 0; i < count;)
+        {
+            auto const blocks = order[i].first;
+            std::size_t n = 0;
+            while (n < width && i + n < count &&
+                order[i + n].first == blocks)
+            {
+                ++n;
+            }
+
+            if (n < minLanes)
+            {
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    auto const index = order[i + k].second;
+                    digests[index] = sha512Half (messages[index]);
+                }
+            }
+            else
+            {
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    auto const index = order[i + k].second;
+                    in[k].reset (messages[index], blocks);
+                    out[k] = digests[index].begin ();
+                }
+
+                // Unused lanes repeat the first message
+                for (auto k = n; k < width; ++k)
+                {
+                    in[k].reset (messages[order[i].second], blocks);
+                    out[k] = scratch[k];
+                }
+                if (lanes == 8)
+                    sha512HalfX8 (in, blocks, out);
+                else
+                    sha512HalfX4 (in, blocks, out);
+            }
+            i += n;
+        }
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < count; ++i)
+        digests[i] = sha512Half (messages[i]);
+}
+
+} // detail
+
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count)
+{
+    detail::sha512HalfBatch (messages, digests, count,
+        detail::sha512HalfLanes ());
+}
+
 } // ripple
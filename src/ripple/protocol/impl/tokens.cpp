@@ -98,11 +98,44 @@ checksum (void* out,
 // WARNING Do not call this directly, use
 //         encodeBase58Token instead since it
 //         calculates the size of buffer needed.
+// The largest power of 58 which fits in 32 bits. The codecs work on
+// limbs of five base58 digits rather than on single digits, so a limb
+// times 2^32 plus a carry still fits in 64 bits.
+static std::uint64_t const b58Limb = 58ull * 58 * 58 * 58 * 58;
+static int const b58LimbDigits = 5;
+
+// A scratch array of 64-bit limbs, on the stack for tokens
+class Limbs
+{
+private:
+    std::uint64_t stack_[64];
+    std::unique_ptr<std::uint64_t[]> heap_;
+    std::uint64_t* data_;
+
+public:
+    explicit
+    Limbs (std::size_t capacity)
+        : data_ (stack_)
+    {
+        if (capacity > sizeof(stack_) / sizeof(stack_[0]))
+        {
+            heap_.reset (new std::uint64_t[capacity]);
+            data_ = heap_.get();
+        }
+    }
+
+    std::uint64_t&
+    operator[] (std::size_t i)
+    {
+        return data_[i];
+    }
+};
+
 static
 std::string
 encodeBase58(
     void const* message, std::size_t size,
-        void *temp, char const* const alphabet)
+        char const* const alphabet)
 {
     auto pbegin = reinterpret_cast<
         unsigned char const*>(message);
@@ -114,35 +147,51 @@ encodeBase58(
         pbegin++;
         zeroes++;
     }
-    auto const b58begin = reinterpret_cast<
-        unsigned char*>(temp);
-    // log(256) / log(58), rounded up.
-    auto const b58end = b58begin +
-        size * (138 / 100 + 1);
-    std::fill(b58begin, b58end, 0);
+    // The number in base 58^5, least significant limb first.
+    // A limb holds log2(58^5) > 29 bits.
+    std::size_t const remain = pend - pbegin;
+    Limbs limbs (remain * 8 / 29 + 1);
+    std::size_t used = 0;
+    // Apply "b58 = b58 * 2^32 + chunk", with a short first chunk.
+    std::size_t chunk = remain % 4;
+    if (chunk == 0)
+        chunk = 4;
     while (pbegin != pend)
     {
-        int carry = *pbegin;
-        // Apply "b58 = b58 * 256 + ch".
-        for (auto iter = b58end; iter != b58begin; --iter)
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < chunk; ++i)
+            carry = (carry << 8) | *pbegin++;
+        auto const shift = 8 * chunk;
+        for (std::size_t i = 0; i < used; ++i)
         {
-            carry += 256 * (iter[-1]);
-            iter[-1] = carry % 58;
-            carry /= 58;
+            carry += limbs[i] << shift;
+            limbs[i] = carry % b58Limb;
+            carry /= b58Limb;
         }
-        assert(carry == 0);
-        pbegin++;
+        while (carry != 0)
+        {
+            limbs[used++] = carry % b58Limb;
+            carry /= b58Limb;
+        }
+        chunk = 4;
     }
-    // Skip leading zeroes in base58 result.
-    auto iter = b58begin;
-    while (iter != b58end && *iter == 0)
-        ++iter;
-    // Translate the result into a string.
+    // Translate the result into a string. The most significant
+    // limb is written without its leading zeroes.
     std::string str;
-    str.reserve(zeroes + (b58end - iter));
+    str.reserve(zeroes + used * b58LimbDigits);
     str.assign(zeroes, alphabet[0]);
-    while (iter != b58end)
-        str += alphabet[*(iter++)];
+    char digits[b58LimbDigits];
+    for (auto i = used; i-- > 0;)
+    {
+        auto v = limbs[i];
+        int n = b58LimbDigits;
+        while (n > 0 && (v != 0 || i + 1 != used))
+        {
+            digits[--n] = alphabet[v % 58];
+            v /= 58;
+        }
+        str.append(digits + n, b58LimbDigits - n);
+    }
     return str;
 }
 
@@ -168,15 +217,12 @@ base58EncodeToken (std::uint8_t type,
     char buf[1024];
     // expanded token includes type + checksum
     auto const expanded = 1 + size + 4;
-    // add scratch, log(256) / log(58), rounded up.
-    auto const needed = expanded +
-        size * (138 / 100 + 1);
     std::unique_ptr<
         char[]> pbuf;
     char* temp;
-    if (needed > sizeof(buf))
+    if (expanded > sizeof(buf))
     {
-        pbuf.reset(new char[needed]);
+        pbuf.reset(new char[expanded]);
         temp = pbuf.get();
     }
     else
@@ -188,18 +234,9 @@ base58EncodeToken (std::uint8_t type,
     temp[0] = type;
     std::memcpy(temp + 1, token, size);
     checksum(temp + 1 + size, temp, 1 + size);
-    return encodeBase58(temp, expanded,
-        temp + expanded, rippleAlphabet);
+    return encodeBase58(temp, expanded, rippleAlphabet);
 }
 
-//------------------------------------------------------------------------------
-
-// Code from Bitcoin: https://github.com/bitcoin/bitcoin
-// Copyright (c) 2014 The Bitcoin Core developers
-// Distributed under the MIT software license, see the accompanying
-// file COPYING or http://www.opensource.org/licenses/mit-license.php.
-//
-// Modified from the original
 template <class InverseArray>
 static
 std::string
@@ -216,36 +253,59 @@ decodeBase58 (std::string const& s,
         ++psz;
         --remain;
     }
-    // Allocate enough space in big-endian base256 representation.
-    // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(
-        remain * 733 / 1000 + 1);
+    // The number in base 2^32, least significant limb first.
+    // A digit holds log2(58) < 6 bits.
+    Limbs limbs (remain * 6 / 32 + 1);
+    std::size_t used = 0;
+    // Apply "b256 = b256 * 58^n + digits", five digits at a
+    // time, with a short first group.
+    std::size_t group = remain % b58LimbDigits;
+    if (group == 0)
+        group = b58LimbDigits;
     while (remain > 0)
     {
-        auto carry = inv[*psz];
-        if (carry == -1)
-            return {};
-        // Apply "b256 = b256 * 58 + carry".
-        for (auto iter = b256.rbegin();
-            iter != b256.rend(); ++iter)
+        std::uint64_t carry = 0;
+        std::uint64_t scale = 1;
+        for (std::size_t i = 0; i < group; ++i)
         {
-            carry += 58 * *iter;
-            *iter = carry % 256;
-            carry /= 256;
+            auto const digit = inv[*psz++];
+            if (digit == -1)
+                return {};
+            carry = carry * 58 + digit;
+            scale *= 58;
         }
-        assert(carry == 0);
-        ++psz;
-        --remain;
+        remain -= group;
+        for (std::size_t i = 0; i < used; ++i)
+        {
+            carry += limbs[i] * scale;
+            limbs[i] = carry & 0xffffffff;
+            carry >>= 32;
+        }
+        while (carry != 0)
+        {
+            limbs[used++] = carry & 0xffffffff;
+            carry >>= 32;
+        }
+        group = b58LimbDigits;
     }
-    // Skip leading zeroes in b256.
-    auto iter = std::find_if(
-        b256.begin(), b256.end(),[](unsigned char c)
-            { return c != 0; });
+    // Write the limbs out big endian, and skip the leading
+    // zeroes of the most significant limb.
     std::string result;
-    result.reserve (zeroes + (b256.end() - iter));
+    result.reserve (zeroes + used * 4);
     result.assign (zeroes, 0x00);
-    while (iter != b256.end())
-        result.push_back(*(iter++));
+    for (auto i = used; i-- > 0;)
+    {
+        auto const v = limbs[i];
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            if (i + 1 == used && result.size () ==
+                    static_cast<std::size_t>(zeroes) &&
+                (v >> shift) == 0)
+                continue;
+            result.push_back(static_cast<char>(
+                (v >> shift) & 0xff));
+        }
+    }
     return result;
 }
 
@@ -0,0 +1,284 @@
+#include <BeastConfig.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/json/json_reader.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/AccountID.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/UintTypes.h>
+#include <beast/unit_test/suite.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#if RIPPLE_COUNT_ALLOCATIONS
+
+// Every allocation of the program is counted, for allocs/op
+static std::atomic<std::uint64_t> allocationCount {0};
+
+void*
+operator new (std::size_t size)
+{
+    allocationCount.fetch_add (1, std::memory_order_relaxed);
+    if (auto const p = std::malloc (size ? size : 1))
+        return p;
+    throw std::bad_alloc ();
+}
+
+void*
+operator new[] (std::size_t size)
+{
+    return ::operator new (size);
+}
+
+void
+operator delete (void* p) noexcept
+{
+    std::free (p);
+}
+
+void
+operator delete[] (void* p) noexcept
+{
+    std::free (p);
+}
+
+#endif
+
+namespace ripple {
+
+/** Costs of the protocol primitives, in ns/op and allocs/op.
+
+    Allocations are only counted in builds with RIPPLE_COUNT_ALLOCATIONS.
+*/
+class ProtocolTiming_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // Keeps the results of the timed operations alive
+    std::size_t sink_ = 0;
+
+    static
+    std::uint64_t
+    allocations ()
+    {
+#if RIPPLE_COUNT_ALLOCATIONS
+        return allocationCount.load (std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    template <class F>
+    void
+    measure (std::string const& name, std::size_t rounds, F&& f)
+    {
+        f ();
+
+        auto const allocs = allocations ();
+        auto const start = clock_type::now ();
+        for (std::size_t i = 0; i < rounds; ++i)
+            f ();
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::nanoseconds> (clock_type::now () - start);
+        auto const allocated = allocations () - allocs;
+
+        std::stringstream ss;
+        ss << std::left << std::setw (30) << name << std::right <<
+            std::fixed << std::setprecision (1) << std::setw (12) <<
+                static_cast<double> (elapsed.count ()) / rounds << " ns/op";
+#if RIPPLE_COUNT_ALLOCATIONS
+        ss << std::setw (10) <<
+            static_cast<double> (allocated) / rounds << " allocs/op";
+#else
+        (void) allocated;
+#endif
+        log << ss.str ();
+    }
+
+    static
+    STTx
+    makePayment (KeyType type)
+    {
+        auto const keys = randomKeyPair (type);
+        STTx tx (ttPAYMENT);
+        tx.setAccountID (sfAccount, calcAccountID (keys.first));
+        tx.setAccountID (sfDestination,
+            calcAccountID (randomKeyPair (type).first));
+        tx.setFieldAmount (sfAmount, STAmount (1000000));
+        tx.setFieldAmount (sfFee, STAmount (10));
+        tx.setFieldU32 (sfSequence, 7);
+        tx.setFieldU32 (sfDestinationTag, 42);
+        tx.sign (keys.first, keys.second);
+        return tx;
+    }
+
+    void
+    timeTransactions (std::size_t rounds)
+    {
+        auto const tx = makePayment (KeyType::secp256k1);
+        auto const blob = tx.getSerializer ().peekData ();
+
+        measure ("STTx parse", rounds, [&]
+            {
+                STTx copy (SerialIter (blob.data (), blob.size ()));
+                sink_ += copy.getFieldU32 (sfSequence);
+            });
+        measure ("STTx serialize", rounds, [&]
+            {
+                Serializer s;
+                tx.add (s);
+                sink_ += s.size ();
+            });
+        measure ("STTx hash", rounds, [&]
+            {
+                sink_ += *tx.getHash (HashPrefix::transactionID).begin ();
+            });
+        measure ("STObject field access", rounds, [&]
+            {
+                sink_ += tx.getFieldAmount (sfAmount).mantissa ();
+                sink_ += tx.getAccountID (sfDestination).size ();
+                sink_ += tx.getFieldU32 (sfDestinationTag);
+                sink_ += tx.isFieldPresent (sfSourceTag);
+            });
+    }
+
+    void
+    timeAmounts (std::size_t rounds)
+    {
+        auto const issuer = calcAccountID (
+            randomKeyPair (KeyType::secp256k1).first);
+        Issue const usd (to_currency ("USD"), issuer);
+        Issue const asset (assetCurrency (), issuer);
+
+        STAmount const n1 (123456789);
+        STAmount const n2 (987654);
+        STAmount const i1 (usd, 12345678, -3);
+        STAmount const i2 (usd, 98765, -2);
+        STAmount const a1 (asset, 4200000);
+        STAmount const a2 (asset, 31400);
+
+        measure ("STAmount native add", rounds, [&]
+            {
+                sink_ += (n1 + n2).mantissa ();
+            });
+        measure ("STAmount native multiply", rounds, [&]
+            {
+                sink_ += multiply (n1, n2, xrpIssue ()).mantissa ();
+            });
+        measure ("STAmount IOU add", rounds, [&]
+            {
+                sink_ += (i1 + i2).mantissa ();
+            });
+        measure ("STAmount IOU multiply", rounds, [&]
+            {
+                sink_ += multiply (i1, i2, usd).mantissa ();
+            });
+        measure ("STAmount IOU divide", rounds, [&]
+            {
+                sink_ += divide (i1, i2, usd).mantissa ();
+            });
+        measure ("STAmount ASSET add", rounds, [&]
+            {
+                sink_ += (a1 + a2).mantissa ();
+            });
+        measure ("STAmount ASSET divide", rounds, [&]
+            {
+                sink_ += divide (a1, a2, asset).mantissa ();
+            });
+    }
+
+    void
+    timeCodecs (std::size_t rounds)
+    {
+        auto const account = calcAccountID (
+            randomKeyPair (KeyType::secp256k1).first);
+        auto const text = toBase58 (account);
+
+        measure ("base58 encode", rounds, [&]
+            {
+                sink_ += toBase58 (account).size ();
+            });
+        measure ("base58 decode", rounds, [&]
+            {
+                sink_ += parseBase58<AccountID> (text)->size ();
+            });
+
+        auto const blob = makePayment (KeyType::secp256k1)
+            .getSerializer ().peekData ();
+        auto const hex = strHex (blob);
+
+        measure ("hex encode", rounds, [&]
+            {
+                sink_ += strHex (blob).size ();
+            });
+        measure ("hex decode", rounds, [&]
+            {
+                sink_ += strUnHex (hex).first.size ();
+            });
+    }
+
+    void
+    timeJson (std::size_t rounds)
+    {
+        auto const tx = makePayment (KeyType::secp256k1);
+        auto const text = to_string (tx.getJson (0));
+
+        measure ("Json::Value build", rounds, [&]
+            {
+                sink_ += tx.getJson (0).size ();
+            });
+
+        auto const json = tx.getJson (0);
+        measure ("Json::Value stringify", rounds, [&]
+            {
+                sink_ += to_string (json).size ();
+            });
+        measure ("Json::Value parse", rounds, [&]
+            {
+                Json::Value v;
+                Json::Reader ().parse (text, v);
+                sink_ += v.size ();
+            });
+    }
+
+    void
+    timeVerify (std::size_t rounds)
+    {
+        std::string const message (256, 'x');
+        for (auto const type : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            auto const keys = randomKeyPair (type);
+            auto const sig = sign (keys.first, keys.second,
+                makeSlice (message));
+            measure (std::string ("PublicKey::verify ") + to_string (type),
+                rounds, [&]
+                {
+                    sink_ += verify (keys.first, makeSlice (message), sig);
+                });
+        }
+    }
+
+    void
+    run () override
+    {
+        timeTransactions (100000);
+        timeAmounts (1000000);
+        timeCodecs (100000);
+        timeJson (100000);
+        timeVerify (2000);
+        expect (sink_ != 0);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ProtocolTiming,protocol,ripple);
+
+} // ripple
@@ -463,6 +463,21 @@ public:
 
         for (int i = 0; i <= 100000; ++i)
             mulTest (rand () % 10000000, rand () % 10000000);
+
+        // A product of native mantissas too large for 64 bits saturates,
+        // and the results built from it must not change
+        {
+            STAmount const big (100000000000000000ull);
+
+            unexpected (mulRound (big, big, noIssue(), false,
+                    STAmountCalcSwitchovers{false}) !=
+                STAmount (noIssue(), std::uint64_t (1844674407370955), 18),
+                "STAmount mulRound saturation fail");
+
+            unexpected (multiply (big, big, noIssue()) !=
+                STAmount (noIssue(), 6, 14),
+                "STAmount multiply saturation fail");
+        }
     }
 
     //--------------------------------------------------------------------------
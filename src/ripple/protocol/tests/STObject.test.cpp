@@ -474,10 +474,104 @@ public:
         }
     }
 
+    // Copies share the fields until one of them changes
+    void
+    testShare()
+    {
+        testcase ("share");
+
+        auto const& sf1 = sfSequence;
+        auto const& sf2 = sfExpiration;
+
+        STObject st(sfGeneric);
+        st.setFieldU32(sf1, 1);
+        st.setFieldU32(sf2, 2);
+        auto const& before = st.peekAtField(sf1);
+        st.share();
+        expect(&st.peekAtField(sf1) == &before);
+        expect(st[sf1] == 1);
+        expect(st.getCount() == 2);
+
+        {
+            STObject copy (st);
+            expect(&copy.peekAtField(sf1) == &before);
+            expect(copy == st);
+
+            // References taken before a change stay valid
+            auto const& shared = copy.peekAtField(sf2);
+            copy.setFieldU32(sf1, 3);
+            expect(copy[sf1] == 3);
+            expect(st[sf1] == 1);
+            expect(&copy.peekAtField(sf1) != &before);
+            expect(shared.getText() == "2");
+            expect(copy[sf2] == 2);
+        }
+
+        // The last holder takes the fields over without a copy
+        st.setFieldU32(sf2, 4);
+        expect(&st.peekAtField(sf1) == &before);
+        expect(st[sf2] == 4);
+
+        st.share();
+        STObject assigned (sfGeneric);
+        assigned = st;
+        expect(&assigned.peekAtField(sf1) == &before);
+        STObject moved (std::move(assigned));
+        expect(&moved.peekAtField(sf1) == &before);
+        moved.delField(sf2);
+        expect(moved.getCount() == 1);
+        expect(st.getCount() == 2);
+    }
+
+    // Free objects find fields in or out of field code order
+    void
+    testLookup()
+    {
+        testcase ("lookup");
+
+        STObject st(sfGeneric);
+        st.setFieldU32(sfSequence, 1);
+        st.setFieldU32(sfFlags, 2);
+        st.setFieldAmount(sfAmount, STAmount(3));
+        st.setFieldU16(sfLedgerEntryType, 4);
+        expect(st.getFieldU32(sfSequence) == 1);
+        expect(st.getFieldU32(sfFlags) == 2);
+        expect(st.getFieldAmount(sfAmount) == STAmount(3));
+        expect(st.getFieldU16(sfLedgerEntryType) == 4);
+        expect(! st.isFieldPresent(sfExpiration));
+
+        // Deserialized fields are in order
+        auto const s = st.getSerializer();
+        STObject copy(SerialIter{s.slice()}, sfGeneric);
+        expect(copy.getFieldIndex(sfLedgerEntryType) == 0);
+        expect(copy.getFieldIndex(sfAmount) == 3);
+        expect(copy.getFieldU32(sfSequence) == 1);
+        expect(copy.getFieldAmount(sfAmount) == STAmount(3));
+        expect(copy.getFieldIndex(sfExpiration) == -1);
+        expect(copy.getFieldIndex(sfFee) == -1);
+
+        // Both serialize in field code order
+        expect(copy.getSerializer() == s);
+        expect(copy.getHash(HashPrefix::transactionID) ==
+            sha512Half(HashPrefix::transactionID, s.slice()));
+
+        copy.delField(sfFlags);
+        expect(copy.getFieldIndex(sfFlags) == -1);
+        expect(copy.getFieldU32(sfSequence) == 1);
+        copy.setFieldU32(sfExpiration, 5);
+        copy.setFieldU32(sfFlags, 6);
+        expect(copy.getFieldU32(sfExpiration) == 5);
+        expect(copy.getFieldU32(sfFlags) == 6);
+        expect(copy.getFieldAmount(sfAmount) == STAmount(3));
+        expect(! copy.isFieldPresent(sfFee));
+    }
+
     void
     run()
     {
         testFields();
+        testShare();
+        testLookup();
         testSerialization();
         testParseJSONArray();
         testParseJSONArrayWithInvalidChildrenObjects();
@@ -0,0 +1,168 @@
+#include <BeastConfig.h>
+#include <ripple/protocol/STObjectView.h>
+#include <ripple/protocol/st.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class STObjectView_test : public beast::unit_test::suite
+{
+public:
+    static
+    STObject
+    makeObject ()
+    {
+        AccountID const alice (0x10);
+        AccountID const bob (0x20);
+        Issue const usd (Currency (3), bob);
+
+        STObject obj (sfGeneric);
+        obj.setFieldU32 (sfFlags, 0x80000000);
+        obj.setAccountID (sfAccount, alice);
+        obj.setAccountID (sfDestination, bob);
+        obj.setFieldAmount (sfFee, STAmount (10));
+        obj.setFieldAmount (sfAmount, STAmount (usd, 25));
+
+        STPathSet paths;
+        STPath path;
+        path.emplace_back (bob, Currency (3), bob);
+        paths.push_back (path);
+        path.emplace_back (boost::none, Currency (4), alice);
+        paths.push_back (path);
+        obj.setFieldPathSet (sfPaths, paths);
+
+        STObject memo (sfMemo);
+        memo.setFieldVL (sfMemoData, Blob (300, 'm'));
+        STArray memos;
+        memos.push_back (memo);
+        memos.push_back (memo);
+        obj.setFieldArray (sfMemos, memos);
+
+        obj.setFieldVL (sfSigningPubKey, Blob (33, 2));
+        obj.setFieldU64 (sfDividendCoins, 123456789);
+        return obj;
+    }
+
+    void
+    testFields ()
+    {
+        testcase ("fields");
+
+        auto const obj = makeObject ();
+        auto const s = obj.getSerializer ();
+        STObjectView const view (s.slice ());
+
+        expect (view.slice () == s.slice ());
+        expect (view.size () == obj.getCount ());
+
+        // The fields after the paths and the memos are found
+        expect (view.getFieldU32 (sfFlags) == obj.getFieldU32 (sfFlags));
+        expect (view.getAccountID (sfAccount) == obj.getAccountID (sfAccount));
+        expect (view.getAccountID (sfDestination) ==
+            obj.getAccountID (sfDestination));
+        expect (view.getFieldAmount (sfFee) == obj.getFieldAmount (sfFee));
+        expect (view.getFieldAmount (sfAmount) ==
+            obj.getFieldAmount (sfAmount));
+        expect (view.getFieldU64 (sfDividendCoins) == 123456789);
+
+        auto const key = view.getFieldVL (sfSigningPubKey);
+        expect (key.size () == 33 && key[0] == 2);
+        expect (key.data () >= s.slice ().data () &&
+            key.data () + key.size () <= s.slice ().data () + s.size ());
+
+        // Fields which are not present read as their defaults
+        expect (! view.isFieldPresent (sfDestinationTag));
+        expect (view.getFieldU32 (sfDestinationTag) == 0);
+        expect (view.getAccountID (sfReferee) == AccountID ());
+        expect (view.getFieldAmount (sfBalanceVBC) == zero);
+        expect (view.getFieldVL (sfTxnSignature).empty ());
+
+        try
+        {
+            view.getFieldU16 (sfFlags);
+            fail ("wrong field type");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    void
+    testMalformed ()
+    {
+        testcase ("malformed");
+
+        auto const s = makeObject ().getSerializer ();
+        auto const data = s.peekData ();
+
+        auto const throws = [](Blob const& blob)
+        {
+            try
+            {
+                STObjectView const view (makeSlice (blob));
+            }
+            catch (std::runtime_error const&)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        expect (! throws (data));
+
+        // The paths are last, and lose their terminator
+        expect (throws (Blob (data.begin (), data.end () - 1)));
+
+        // The public key is cut short
+        auto const key = STObjectView (s.slice ()).getFieldVL (
+            sfSigningPubKey);
+        auto const offset = key.data () - s.slice ().data ();
+        expect (throws (Blob (data.begin (), data.begin () + offset + 10)));
+
+        Blob terminator (data);
+        terminator.push_back (0xe1);
+        expect (throws (terminator));
+
+        Blob unknown (data);
+        unknown.push_back (0x0f);
+        unknown.push_back (0xff);
+        expect (throws (unknown));
+    }
+
+    void
+    testSigningFields ()
+    {
+        testcase ("signing fields");
+
+        auto obj = makeObject ();
+        obj.setFieldVL (sfTxnSignature, Blob (70, 5));
+
+        STObject signer (sfSigner);
+        signer.setAccountID (sfAccount, AccountID (0x30));
+        signer.setFieldVL (sfTxnSignature, Blob (70, 6));
+        STArray signers;
+        signers.push_back (signer);
+        obj.setFieldArray (sfSigners, signers);
+
+        auto const s = obj.getSerializer ();
+        Serializer expected;
+        obj.addWithoutSigningFields (expected);
+        Serializer sliced;
+        STObjectView (s.slice ()).addWithoutSigningFields (sliced);
+        expect (sliced == expected);
+        expect (sliced.size () < s.size ());
+    }
+
+    void
+    run () override
+    {
+        testFields ();
+        testMalformed ();
+        testSigningFields ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(STObjectView,protocol,ripple);
+
+} // ripple
@@ -18,12 +18,15 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/Sign.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/STParsedJSON.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/protocol/types.h>
 #include <ripple/json/to_string.h>
 #include <beast/unit_test/suite.h>
+#include <vector>
 
 namespace ripple {
 
@@ -76,6 +79,122 @@ public:
         {
             pass ();
         }
+
+        testSerialization (j);
+        testMakeTransactions (publicAcct, privateAcct);
+        testCheckSignBatch ();
+    }
+
+    void testSerialization (STTx const& signed_)
+    {
+        testcase ("serialization");
+
+        auto const fresh = STObject (signed_).getSerializer ();
+        SerialIter sit (fresh.slice ());
+        STTx const tx (sit);
+
+        // The kept serialization is the one made from the fields
+        Serializer s;
+        tx.add (s);
+        expect (s == fresh, "add");
+        expect (tx.getSerializer () == fresh, "getSerializer");
+        expect (tx.getTransactionID () ==
+            sha512Half (HashPrefix::transactionID, fresh.slice ()), "id");
+        expect (tx.getSigningHash () ==
+            STObject (tx).getSigningHash (HashPrefix::txSign), "signing");
+        expect (tx.checkSign (false), "checkSign");
+
+        // A copy may be changed and serialized again
+        STTx copy (tx);
+        copy.delField (sfTxnSignature);
+        Serializer unsigned_;
+        copy.add (unsigned_);
+        expect (unsigned_ == STObject (copy).getSerializer (), "copy");
+        expect (unsigned_.size () < fresh.size (), "no signature");
+        expect (copy.getSigningHash () == tx.getSigningHash (), "copy signing");
+    }
+
+    void testMakeTransactions (RippleAddress const& publicAcct,
+        RippleAddress const& privateAcct)
+    {
+        testcase ("makeTransactions");
+
+        std::vector<Serializer> raw;
+        std::vector<uint256> ids;
+        for (std::uint32_t seq = 1; seq <= 20; ++seq)
+        {
+            STTx tx (ttACCOUNT_SET);
+            tx.setAccountID (sfAccount, calcAccountID (publicAcct));
+            tx.setFieldU32 (sfSequence, seq);
+            tx.setSigningPubKey (publicAcct);
+            if (seq % 3 == 0)
+                tx.setFieldVL (sfMessageKey, publicAcct.getAccountPublic ());
+            tx.sign (privateAcct);
+
+            raw.emplace_back ();
+            tx.add (raw.back ());
+            ids.push_back (tx.getTransactionID ());
+        }
+
+        std::vector<Slice> data;
+        for (auto const& s : raw)
+            data.push_back (s.slice ());
+        // Not a transaction
+        Blob const junk (40, 0xff);
+        data.insert (data.begin () + 5, makeSlice (junk));
+
+        auto const txs = makeTransactions (data);
+        expect (txs.size () == data.size ());
+        expect (!txs[5], "junk");
+        for (std::size_t i = 0, j = 0; i < txs.size (); ++i)
+        {
+            if (i == 5)
+                continue;
+            expect (txs[i] && txs[i]->getTransactionID () == ids[j++], "id");
+        }
+    }
+
+    void testCheckSignBatch ()
+    {
+        testcase ("checkSignBatch");
+
+        RippleAddress seed;
+        seed.setSeedRandom ();
+        auto const ed = generateKeysFromSeed (KeyType::ed25519, seed);
+        auto const secp = generateKeysFromSeed (KeyType::secp256k1, seed);
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        std::vector<bool> expected;
+        for (std::uint32_t seq = 1; seq <= 80; ++seq)
+        {
+            auto const& keys = (seq % 4 == 0) ? secp : ed;
+            auto tx = std::make_shared<STTx> (ttACCOUNT_SET);
+            tx->setAccountID (sfAccount, calcAccountID (keys.publicKey));
+            tx->setFieldU32 (sfSequence, seq);
+            tx->setSigningPubKey (keys.publicKey);
+            tx->sign (keys.secretKey);
+
+            // Break the signature of some of each kind
+            bool const good = (seq % 7 != 0);
+            if (! good)
+            {
+                auto sig = tx->getFieldVL (sfTxnSignature);
+                sig[sig.size () / 2] ^= 0x01;
+                tx->setFieldVL (sfTxnSignature, sig);
+            }
+            txs.push_back (tx);
+            expected.push_back (good);
+        }
+
+        auto const result = checkSignBatch (txs, false);
+        expect (result.size () == txs.size ());
+        for (std::size_t i = 0; i < txs.size (); ++i)
+        {
+            expect (result[i] == expected[i], "signature");
+            expect (result[i] == txs[i]->checkSign (false), "checkSign");
+        }
+
+        expect (checkSignBatch ({}, true).empty ());
     }
 };
 
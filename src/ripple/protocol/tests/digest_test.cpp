@@ -27,6 +27,7 @@
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <string>
 #include <vector>
 
 namespace ripple {
@@ -150,14 +151,105 @@ public:
         pass ();
     }
 
+    void testSHA512HalfBatch ()
+    {
+        testcase ("SHA512Half batch");
+
+        using namespace std::chrono;
+
+        // The size of an inner node's hash input
+        std::vector<std::uint8_t> data (516 * 65536);
+        beast::xor_shift_engine g (4);
+        beast::rngfill (data.data (), data.size (), g);
+        std::vector<Slice> messages;
+        for (std::size_t i = 0; i < data.size (); i += 516)
+            messages.emplace_back (&data[i], 516);
+        std::vector<uint256> digests (messages.size ());
+
+        auto const start = high_resolution_clock::now ();
+        for (std::size_t i = 0; i < messages.size (); ++i)
+            digests[i] = sha512Half (messages[i]);
+        auto const single = high_resolution_clock::now () - start;
+
+        log << "    " << messages.size () << " inner nodes:";
+        log << "         Per call = " <<
+            duration_cast<milliseconds> (single).count () << " ms";
+
+        for (int lanes = 4; lanes <= detail::sha512HalfLanes (); lanes *= 2)
+        {
+            auto const start = high_resolution_clock::now ();
+            detail::sha512HalfBatch (messages.data (), digests.data (),
+                messages.size (), lanes);
+            auto const batch = high_resolution_clock::now () - start;
+            log << "        " << lanes << " lanes = " <<
+                duration_cast<milliseconds> (batch).count () << " ms";
+        }
+        pass ();
+    }
+
     void run ()
     {
         testSHA512 ();
         testSHA256 ();
         testRIPEMD160 ();
+        testSHA512HalfBatch ();
     }
 };
 
 BEAST_DEFINE_TESTSUITE_MANUAL(digest,ripple_data,ripple);
 
+//------------------------------------------------------------------------------
+
+class sha512HalfBatch_test : public beast::unit_test::suite
+{
+public:
+    void
+    check (std::vector<Slice> const& messages, int lanes)
+    {
+        std::vector<uint256> digests (messages.size ());
+        detail::sha512HalfBatch (messages.data (), digests.data (),
+            messages.size (), lanes);
+
+        bool same = true;
+        for (std::size_t i = 0; i < messages.size (); ++i)
+            same = same && digests[i] == sha512Half (messages[i]);
+        expect (same, std::to_string (lanes) + " lanes, " +
+            std::to_string (messages.size ()) + " messages");
+    }
+
+    void
+    run ()
+    {
+        beast::xor_shift_engine g (11);
+        std::vector<std::uint8_t> data (1024);
+        beast::rngfill (data.data (), data.size (), g);
+
+        std::vector<int> lanes = {0};
+        for (int n = 4; n <= detail::sha512HalfLanes (); n *= 2)
+            lanes.push_back (n);
+
+        for (auto const n : lanes)
+        {
+            testcase ("lanes " + std::to_string (n));
+
+            // Every length over the first few block boundaries
+            std::vector<Slice> sizes;
+            for (std::size_t size = 0; size <= 400; ++size)
+                sizes.emplace_back (&data[size % 7], size);
+            check (sizes, n);
+
+            // Groups of the same size leaving every remainder
+            for (std::size_t count = 0; count <= 20; ++count)
+            {
+                std::vector<Slice> same;
+                for (std::size_t i = 0; i < count; ++i)
+                    same.emplace_back (&data[i * 16], 516);
+                check (same, n);
+            }
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(sha512HalfBatch,protocol,ripple);
+
 } // ripple
@@ -33,6 +33,36 @@ struct types_test : public beast::unit_test::suite
         if (expect(parseBase58<AccountID>(s)))
             expect(toBase58(
                 *parseBase58<AccountID>(s)) == s);
+
+        // Leading zero bytes and digits
+        expect(toBase58(xrpAccount()) ==
+            "rrrrrrrrrrrrrrrrrrrrrhoLvTp");
+        expect(toBase58(noAccount()) ==
+            "rrrrrrrrrrrrrrrrrrrrBZbvji");
+        expect(parseBase58<AccountID>(
+            "rrrrrrrrrrrrrrrrrrrrBZbvji") == noAccount());
+
+        // Conversions are the same when they are cached
+        for (int i = 0; i < 3; ++i)
+        {
+            AccountID id;
+            for (int j = 0; j < id.size(); ++j)
+                id.data()[j] = static_cast<unsigned char>(i * 37 + j * 11);
+            auto const encoded = toBase58(id);
+            expect(toBase58(id) == encoded);
+            expect(parseBase58<AccountID>(encoded) == id);
+            expect(parseBase58<AccountID>(encoded) == id);
+        }
+
+        // A bad checksum, a character outside the alphabet
+        // and a token of a different kind are not cached
+        expect(! parseBase58<AccountID>(
+            "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTi"));
+        expect(! parseBase58<AccountID>(
+            "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyT0"));
+        expect(! parseBase58<AccountID>(
+            "n9KorY8QtTdRx7TVDpwnG9NvyxsDwHUKUEeDLY3AkiGncVaSXZi5"));
+        expect(! parseBase58<AccountID>(""));
     }
 
     void
@@ -47,6 +47,7 @@ struct Entry
         , remote_balance (0)
         , lastWarningTime (0)
         , whenExpires (0)
+        , shard (0)
     {
     }
 
@@ -104,6 +105,9 @@ struct Entry
 
     // For inactive entries, time after which this entry will be erased
     clock_type::rep whenExpires;
+
+    // Index of the Logic shard which holds this entry
+    std::size_t shard;
 };
 
 std::ostream& operator<< (std::ostream& os, Entry const& v)
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+
 #ifndef RIPPLE_RESOURCE_LOGIC_H_INCLUDED
 #define RIPPLE_RESOURCE_LOGIC_H_INCLUDED
 
@@ -30,7 +31,9 @@
 #include <beast/chrono/abstract_clock.h>
 #include <beast/Insight.h>
 #include <beast/utility/PropertyStream.h>
+#include <array>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 namespace Resource {
@@ -55,30 +58,43 @@ private:
         beast::insight::Meter drop;
     };
 
-    Stats m_stats;
-    Stopwatch& m_clock;
-    beast::Journal m_journal;
+    // A slice of the consumer table, chosen by the hash of the key.
+    // Every entry lives in exactly one shard and is only touched
+    // under that shard's lock, so charges against unrelated
+    // consumers do not contend with each other.
+    struct Shard
+    {
+        std::recursive_mutex lock;
+
+        // Table of the entries in this shard
+        Table table;
 
-    std::recursive_mutex lock_;
+        // Because the following are intrusive lists, a given Entry may be in
+        // at most list at a given instant.  The Entry must be removed from
+        // one list before placing it in another.
 
-    // Table of all entries
-    Table table_;
+        // List of all active inbound entries
+        EntryIntrusiveList inbound;
 
-    // Because the following are intrusive lists, a given Entry may be in
-    // at most list at a given instant.  The Entry must be removed from
-    // one list before placing it in another.
+        // List of all active outbound entries
+        EntryIntrusiveList outbound;
 
-    // List of all active inbound entries
-    EntryIntrusiveList inbound_;
+        // List of all active admin entries
+        EntryIntrusiveList admin;
 
-    // List of all active outbound entries
-    EntryIntrusiveList outbound_;
+        // List of all inactve entries, in order of expiration
+        EntryIntrusiveList inactive;
+    };
+
+    Stats m_stats;
+    Stopwatch& m_clock;
+    beast::Journal m_journal;
 
-    // List of all active admin entries
-    EntryIntrusiveList admin_;
+    std::array <Shard, tableShards> shards_;
 
-    // List of all inactve entries
-    EntryIntrusiveList inactive_;
+    // Only guards the import table. It is never acquired while a
+    // shard lock is held.
+    std::mutex importLock_;
 
     // All imported gossip data
     Imports importTable_;
@@ -102,67 +118,30 @@ public:
         // destroyed before the consumer table.
         //
         importTable_.clear();
-        table_.clear();
+        for (auto& shard : shards_)
+            shard.table.clear();
     }
 
     Consumer newInboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindInbound, address.at_port (0)), // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                {
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                }
-                inbound_.push_back (*entry);
-            }
-        }
+        Key const key (kindInbound, address.at_port (0));
+        Entry& entry (activate (shardIndex (key), key, &Shard::inbound));
 
         m_journal.debug <<
-            "New inbound endpoint " << *entry;
+            "New inbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Consumer newOutboundEndpoint (beast::IP::Endpoint const& address)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (kindOutbound, address),            // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                outbound_.push_back (*entry);
-            }
-        }
+        Key const key (kindOutbound, address);
+        Entry& entry (activate (shardIndex (key), key, &Shard::outbound));
 
         m_journal.debug <<
-            "New outbound endpoint " << *entry;
+            "New outbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     /**
@@ -172,31 +151,13 @@ public:
      */
     Consumer newUnlimitedEndpoint (std::string const& name)
     {
-        Entry* entry (nullptr);
-
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                table_.emplace (std::piecewise_construct,
-                    std::make_tuple (name),                             // Key
-                    std::make_tuple (m_clock.now()));                   // Entry
-
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    inactive_.erase (
-                        inactive_.iterator_to (*entry));
-                admin_.push_back (*entry);
-            }
-        }
+        Key const key (name);
+        Entry& entry (activate (shardIndex (key), key, &Shard::admin));
 
         m_journal.debug <<
-            "New unlimited endpoint " << *entry;
+            "New unlimited endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Json::Value getJson ()
@@ -210,43 +171,47 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Json::Value ret (Json::objectValue);
-        std::lock_guard<std::recursive_mutex> _(lock_);
 
-        for (auto& inboundEntry : inbound_)
+        for (auto& shard : shards_)
         {
-            int localBalance = inboundEntry.local_balance.value (now);
-            if ((localBalance + inboundEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[inboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = inboundEntry.remote_balance;
-                entry[jss::type] = "outbound";
-            }
+            std::lock_guard<std::recursive_mutex> _(shard.lock);
 
-        }
-        for (auto& outboundEntry : outbound_)
-        {
-            int localBalance = outboundEntry.local_balance.value (now);
-            if ((localBalance + outboundEntry.remote_balance) >= threshold)
+            for (auto& inboundEntry : shard.inbound)
             {
-                Json::Value& entry = (ret[outboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = outboundEntry.remote_balance;
-                entry[jss::type] = "outbound";
-            }
+                int localBalance = inboundEntry.local_balance.value (now);
+                if ((localBalance + inboundEntry.remote_balance) >= threshold)
+                {
+                    Json::Value& entry = (ret[inboundEntry.to_string()] = Json::objectValue);
+                    entry[jss::local] = localBalance;
+                    entry[jss::remote] = inboundEntry.remote_balance;
+                    entry[jss::type] = "outbound";
+                }
 
-        }
-        for (auto& adminEntry : admin_)
-        {
-            int localBalance = adminEntry.local_balance.value (now);
-            if ((localBalance + adminEntry.remote_balance) >= threshold)
+            }
+            for (auto& outboundEntry : shard.outbound)
             {
-                Json::Value& entry = (ret[adminEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = adminEntry.remote_balance;
-                entry[jss::type] = "admin";
+                int localBalance = outboundEntry.local_balance.value (now);
+                if ((localBalance + outboundEntry.remote_balance) >= threshold)
+                {
+                    Json::Value& entry = (ret[outboundEntry.to_string()] = Json::objectValue);
+                    entry[jss::local] = localBalance;
+                    entry[jss::remote] = outboundEntry.remote_balance;
+                    entry[jss::type] = "outbound";
+                }
+
             }
+            for (auto& adminEntry : shard.admin)
+            {
+                int localBalance = adminEntry.local_balance.value (now);
+                if ((localBalance + adminEntry.remote_balance) >= threshold)
+                {
+                    Json::Value& entry = (ret[adminEntry.to_string()] = Json::objectValue);
+                    entry[jss::local] = localBalance;
+                    entry[jss::remote] = adminEntry.remote_balance;
+                    entry[jss::type] = "admin";
+                }
 
+            }
         }
 
         return ret;
@@ -257,18 +222,20 @@ public:
         clock_type::time_point const now (m_clock.now());
 
         Gossip gossip;
-        std::lock_guard<std::recursive_mutex> _(lock_);
 
-        gossip.items.reserve (inbound_.size());
-
-        for (auto& inboundEntry : inbound_)
+        for (auto& shard : shards_)
         {
-            Gossip::Item item;
-            item.balance = inboundEntry.local_balance.value (now);
-            if (item.balance >= minimumGossipBalance)
+            std::lock_guard<std::recursive_mutex> _(shard.lock);
+
+            for (auto& inboundEntry : shard.inbound)
             {
-                item.address = inboundEntry.key->address;
-                gossip.items.push_back (item);
+                Gossip::Item item;
+                item.balance = inboundEntry.local_balance.value (now);
+                if (item.balance >= minimumGossipBalance)
+                {
+                    item.address = inboundEntry.key->address;
+                    gossip.items.push_back (item);
+                }
             }
         }
 
@@ -280,55 +247,44 @@ public:
     void importConsumers (std::string const& origin, Gossip const& gossip)
     {
         clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
-        {
-            std::lock_guard<std::recursive_mutex> _(lock_);
-            auto result =
-                importTable_.emplace (std::piecewise_construct,
-                    std::make_tuple(origin),                  // Key
-                    std::make_tuple(m_clock.now().time_since_epoch().count()));     // Import
-
-            if (result.second)
-            {
-                // This is a new import
-                Import& next (result.first->second);
-                next.whenExpires = elapsed + gossipExpirationSeconds;
-                next.items.reserve (gossip.items.size());
 
-                for (auto const& gossipItem : gossip.items)
-                {
-                    Import::Item item;
-                    item.balance = gossipItem.balance;
-                    item.consumer = newInboundEndpoint (gossipItem.address);
-                    item.consumer.entry().remote_balance += item.balance;
-                    next.items.push_back (item);
-                }
-            }
-            else
-            {
-                // Previous import exists so add the new remote
-                // balances and then deduct the old remote balances.
+        // Sort the items by shard, so that each shard is locked once
+        // and the items of the import are stored grouped by shard.
+        std::array <std::vector <Gossip::Item const*>, tableShards> byShard;
+        for (auto const& gossipItem : gossip.items)
+            byShard [shardIndex (Key (kindInbound,
+                gossipItem.address.at_port (0)))].push_back (&gossipItem);
 
-                Import next;
-                next.whenExpires = elapsed + gossipExpirationSeconds;
-                next.items.reserve (gossip.items.size());
-                for (auto const& gossipItem : gossip.items)
-                {
-                    Import::Item item;
-                    item.balance = gossipItem.balance;
-                    item.consumer = newInboundEndpoint (gossipItem.address);
-                    item.consumer.entry().remote_balance += item.balance;
-                    next.items.push_back (item);
-                }
+        Import next;
+        next.whenExpires = elapsed + gossipExpirationSeconds;
+        next.items.reserve (gossip.items.size());
 
-                Import& prev (result.first->second);
-                for (auto& item : prev.items)
-                {
-                    item.consumer.entry().remote_balance -= item.balance;
-                }
+        for (std::size_t index = 0; index < shards_.size(); ++index)
+        {
+            if (byShard [index].empty())
+                continue;
 
-                std::swap (next, prev);
+            Shard& shard (shards_ [index]);
+            std::lock_guard<std::recursive_mutex> _(shard.lock);
+            for (auto const gossipItem : byShard [index])
+            {
+                Import::Item item;
+                item.balance = gossipItem->balance;
+                item.consumer = Consumer (*this, activate (index,
+                    Key (kindInbound, gossipItem->address.at_port (0)),
+                        &Shard::inbound));
+                item.consumer.entry().remote_balance += item.balance;
+                next.items.push_back (item);
             }
         }
+
+        // Replace the previous import from this origin, if any, and
+        // then deduct its remote balances.
+        {
+            std::lock_guard<std::mutex> _(importLock_);
+            std::swap (importTable_ [origin], next);
+        }
+        deduct (next);
     }
 
     //--------------------------------------------------------------------------
@@ -337,43 +293,47 @@ public:
     //
     void periodicActivity ()
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
         clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
 
-        for (auto iter (inactive_.begin()); iter != inactive_.end();)
+        for (auto& shard : shards_)
         {
-            if (iter->whenExpires <= elapsed)
-            {
-                m_journal.debug << "Expired " << *iter;
-                auto table_iter =
-                    table_.find (*iter->key);
-                ++iter;
-                erase (table_iter);
-            }
-            else
+            std::lock_guard<std::recursive_mutex> _(shard.lock);
+
+            for (auto iter (shard.inactive.begin()); iter != shard.inactive.end();)
             {
-                break;
+                if (iter->whenExpires <= elapsed)
+                {
+                    m_journal.debug << "Expired " << *iter;
+                    auto table_iter =
+                        shard.table.find (*iter->key);
+                    ++iter;
+                    erase (shard, table_iter);
+                }
+                else
+                {
+                    break;
+                }
             }
         }
 
-        auto iter = importTable_.begin();
-        while (iter != importTable_.end())
+        std::vector <Import> expired;
         {
-            Import& import (iter->second);
-            if (iter->second.whenExpires <= elapsed)
+            std::lock_guard<std::mutex> _(importLock_);
+            auto iter = importTable_.begin();
+            while (iter != importTable_.end())
             {
-                for (auto item_iter (import.items.begin());
-                    item_iter != import.items.end(); ++item_iter)
+                if (iter->second.whenExpires <= elapsed)
                 {
-                    item_iter->consumer.entry().remote_balance -= item_iter->balance;
+                    expired.push_back (std::move (iter->second));
+                    iter = importTable_.erase (iter);
                 }
-
-                iter = importTable_.erase (iter);
+                else
+                    ++iter;
             }
-            else
-                ++iter;
         }
+
+        for (auto& import : expired)
+            deduct (import);
     }
 
     //--------------------------------------------------------------------------
@@ -390,25 +350,26 @@ public:
         return Disposition::ok;
     }
 
-    void erase (Table::iterator iter)
+    void erase (Shard& shard, Table::iterator iter)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shard.lock);
         Entry& entry (iter->second);
         assert (entry.refcount == 0);
-        inactive_.erase (
-            inactive_.iterator_to (entry));
-        table_.erase (iter);
+        shard.inactive.erase (
+            shard.inactive.iterator_to (entry));
+        shard.table.erase (iter);
     }
 
     void acquire (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shards_ [entry.shard].lock);
         ++entry.refcount;
     }
 
     void release (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        Shard& shard (shards_ [entry.shard]);
+        std::lock_guard<std::recursive_mutex> _(shard.lock);
         if (--entry.refcount == 0)
         {
             m_journal.debug <<
@@ -417,29 +378,29 @@ public:
             switch (entry.key->kind)
             {
             case kindInbound:
-                inbound_.erase (
-                    inbound_.iterator_to (entry));
+                shard.inbound.erase (
+                    shard.inbound.iterator_to (entry));
                 break;
             case kindOutbound:
-                outbound_.erase (
-                    outbound_.iterator_to (entry));
+                shard.outbound.erase (
+                    shard.outbound.iterator_to (entry));
                 break;
             case kindUnlimited:
-                admin_.erase (
-                    admin_.iterator_to (entry));
+                shard.admin.erase (
+                    shard.admin.iterator_to (entry));
                 break;
             default:
                 bassertfalse;
                 break;
             }
-            inactive_.push_back (entry);
+            shard.inactive.push_back (entry);
             entry.whenExpires = m_clock.now().time_since_epoch().count() + secondsUntilExpiration;
         }
     }
 
     Disposition charge (Entry& entry, Charge const& fee)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shards_ [entry.shard].lock);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.add (fee.cost(), now));
         m_journal.trace <<
@@ -452,7 +413,7 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shards_ [entry.shard].lock);
         bool notify (false);
         clock_type::rep const elapsed (m_clock.now().time_since_epoch().count());
         if (entry.balance (m_clock.now()) >= warningThreshold &&
@@ -475,7 +436,7 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shards_ [entry.shard].lock);
         bool drop (false);
         clock_type::time_point const now (m_clock.now());
         int const balance (entry.balance (now));
@@ -498,7 +459,7 @@ public:
 
     int balance (Entry& entry)
     {
-        std::lock_guard<std::recursive_mutex> _(lock_);
+        std::lock_guard<std::recursive_mutex> _(shards_ [entry.shard].lock);
         return entry.balance (m_clock.now());
     }
 
@@ -507,17 +468,22 @@ public:
     void writeList (
         clock_type::time_point const now,
             beast::PropertyStream::Set& items,
-                EntryIntrusiveList& list)
+                EntryIntrusiveList Shard::* list)
     {
-        for (auto& entry : list)
+        for (auto& shard : shards_)
         {
-            beast::PropertyStream::Map item (items);
-            if (entry.refcount != 0)
-                item ["count"] = entry.refcount;
-            item ["name"] = entry.to_string();
-            item ["balance"] = entry.balance(now);
-            if (entry.remote_balance != 0)
-                item ["remote_balance"] = entry.remote_balance;
+            std::lock_guard<std::recursive_mutex> _(shard.lock);
+
+            for (auto& entry : shard.*list)
+            {
+                beast::PropertyStream::Map item (items);
+                if (entry.refcount != 0)
+                    item ["count"] = entry.refcount;
+                item ["name"] = entry.to_string();
+                item ["balance"] = entry.balance(now);
+                if (entry.remote_balance != 0)
+                    item ["remote_balance"] = entry.remote_balance;
+            }
         }
     }
 
@@ -525,26 +491,71 @@ public:
     {
         clock_type::time_point const now (m_clock.now());
 
-        std::lock_guard<std::recursive_mutex> _(lock_);
-
         {
             beast::PropertyStream::Set s ("inbound", map);
-            writeList (now, s, inbound_);
+            writeList (now, s, &Shard::inbound);
         }
 
         {
             beast::PropertyStream::Set s ("outbound", map);
-            writeList (now, s, outbound_);
+            writeList (now, s, &Shard::outbound);
         }
 
         {
             beast::PropertyStream::Set s ("admin", map);
-            writeList (now, s, admin_);
+            writeList (now, s, &Shard::admin);
         }
 
         {
             beast::PropertyStream::Set s ("inactive", map);
-            writeList (now, s, inactive_);
+            writeList (now, s, &Shard::inactive);
+        }
+    }
+
+private:
+    static std::size_t shardIndex (Key const& key)
+    {
+        return Key::hasher{} (key) % tableShards;
+    }
+
+    // Finds or creates the entry for the key in its shard and adds
+    // a reference, moving it to the given active list if needed.
+    Entry& activate (std::size_t index, Key const& key,
+        EntryIntrusiveList Shard::* list)
+    {
+        Shard& shard (shards_ [index]);
+        std::lock_guard<std::recursive_mutex> _(shard.lock);
+        auto result =
+            shard.table.emplace (std::piecewise_construct,
+                std::forward_as_tuple (key),                        // Key
+                std::make_tuple (m_clock.now()));                   // Entry
+
+        Entry& entry (result.first->second);
+        entry.key = &result.first->first;
+        entry.shard = index;
+        ++entry.refcount;
+        if (entry.refcount == 1)
+        {
+            if (! result.second)
+                shard.inactive.erase (
+                    shard.inactive.iterator_to (entry));
+            (shard.*list).push_back (entry);
+        }
+        return entry;
+    }
+
+    // Takes back the remote balances an import contributed. The items
+    // are grouped by shard, so each shard is locked once.
+    void deduct (Import& import)
+    {
+        auto iter = import.items.begin();
+        while (iter != import.items.end())
+        {
+            std::size_t const index (iter->consumer.entry().shard);
+            std::lock_guard<std::recursive_mutex> _(shards_ [index].lock);
+            for (; iter != import.items.end() &&
+                iter->consumer.entry().shard == index; ++iter)
+                iter->consumer.entry().remote_balance -= iter->balance;
         }
     }
 };
@@ -199,6 +199,57 @@ public:
         pass();
     }
 
+    void testImportBalances (beast::Journal j)
+    {
+        testcase ("Import balances");
+
+        TestLogic logic (j);
+
+        // Enough addresses to land in every shard
+        auto const makeGossip = [](int balance)
+        {
+            Gossip gossip;
+            for (int i = 1; i <= 200; ++i)
+            {
+                Gossip::Item item;
+                item.balance = balance;
+                item.address = beast::IP::Endpoint (
+                    beast::IP::AddressV4 (10, 0, i / 100, i % 100));
+                gossip.items.push_back (item);
+            }
+            return gossip;
+        };
+
+        auto const balances = [&](int expected)
+        {
+            bool ok = true;
+            for (int i = 1; i <= 200; ++i)
+            {
+                Consumer c (logic.newInboundEndpoint (beast::IP::Endpoint (
+                    beast::IP::AddressV4 (10, 0, i / 100, i % 100), 51235)));
+                if (c.balance () != expected)
+                    ok = false;
+            }
+            return ok;
+        };
+
+        logic.importConsumers ("a", makeGossip (200));
+        expect (balances (200));
+
+        // A newer import from the same origin replaces the old one
+        logic.importConsumers ("a", makeGossip (100));
+        expect (balances (100));
+
+        // Imports from other origins add up
+        logic.importConsumers ("b", makeGossip (50));
+        expect (balances (150));
+
+        for (int i = 0; i <= gossipExpirationSeconds; ++i)
+            logic.advance ();
+        logic.periodicActivity ();
+        expect (balances (0));
+    }
+
     void testCharges (beast::Journal j)
     {
         testcase ("Charge");
@@ -248,6 +299,7 @@ public:
         testCharges (j);
         testImports (j);
         testImport (j);
+        testImportBalances (j);
     }
 };
 
@@ -22,6 +22,7 @@
 
 #include <ripple/core/Config.h>
 #include <ripple/core/JobCoro.h>
+#include <ripple/json/Arena.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/server/Role.h>
 
@@ -57,6 +58,10 @@ struct Context
     std::shared_ptr<JobCoro> jobCoro;
     InfoSub::pointer infoSub;
     Headers headers;
+
+    /** Json values built while the context exists come from here, and
+        are freed together with it unless they are kept elsewhere. */
+    Json::Arena arena;
 };
 
 } // RPC
@@ -0,0 +1,81 @@
+#ifndef RIPPLE_RPC_LEDGERDATACURSORS_H_INCLUDED
+#define RIPPLE_RPC_LEDGERDATACURSORS_H_INCLUDED
+
+#include <ripple/basics/chrono.h>
+#include <ripple/ledger/ReadView.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Positions in the state of ledgers, kept between pages of ledger_data.
+
+    A client reading all the state of a ledger passes back the cursor of
+    the last page. The next page then starts where the last one stopped,
+    in the same ledger, instead of finding the ledger and the marker again.
+
+    A cursor which is not used for a while is dropped, and so is the least
+    recently used one when there are too many. Until then it holds its
+    ledger in memory.
+*/
+class LedgerDataCursors
+{
+public:
+    struct Cursor
+    {
+        std::string token;
+        std::shared_ptr<ReadView const> ledger;
+        bool validated = false;
+
+        // The first item of the next page, and the marker returned with
+        // the last page
+        ReadView::sles_type::iterator next;
+        ReadView::key_type marker;
+
+        Stopwatch::time_point used;
+    };
+
+    explicit
+    LedgerDataCursors (Stopwatch& clock, std::size_t maxCursors = 32,
+        std::chrono::seconds timeout = std::chrono::seconds (60));
+
+    LedgerDataCursors (LedgerDataCursors const&) = delete;
+    LedgerDataCursors& operator= (LedgerDataCursors const&) = delete;
+
+    /** Returns a new cursor, which has to be kept to be used again. */
+    std::unique_ptr<Cursor>
+    open (std::shared_ptr<ReadView const> ledger, bool validated);
+
+    /** Removes a cursor and returns it.
+        Returns nullptr if there is no cursor with the token or it expired.
+        The cursor can not be taken again until it is kept.
+    */
+    std::unique_ptr<Cursor>
+    take (std::string const& token);
+
+    /** Keep a cursor for the next page. */
+    void
+    keep (std::unique_ptr<Cursor> cursor);
+
+    /** Returns the number of cursors kept. */
+    std::size_t
+    size () const;
+
+private:
+    void
+    expire (std::lock_guard<std::mutex> const&);
+
+    Stopwatch& clock_;
+    std::size_t const maxCursors_;
+    std::chrono::seconds const timeout_;
+
+    std::mutex mutable mutex_;
+    std::map<std::string, std::unique_ptr<Cursor>> cursors_;
+};
+
+} // ripple
+
+#endif
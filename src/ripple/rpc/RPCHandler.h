@@ -21,6 +21,7 @@
 #define RIPPLE_RPC_RPCHANDLER_H_INCLUDED
 
 #include <ripple/core/Config.h>
+#include <ripple/json/Output.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/Status.h>
@@ -36,6 +37,19 @@ Status doCommand (RPC::Context&, Json::Value&);
 /** Execute an RPC command and store the results in an std::string. */
 void executeRPC (RPC::Context&, std::string&);
 
+/** Execute an RPC command and stream the results to an Output.
+
+    Handlers which write to a Json::Object have their results serialized
+    as they are produced, without building a Json::Value first.
+*/
+void executeRPC (RPC::Context&, Json::Output const&);
+
+/** Execute an RPC command and return the results as a Json::Value.
+
+    The results are the ones the other forms of executeRPC serialize.
+*/
+Json::Value executeRPC (RPC::Context&);
+
 Role roleRequired (std::string const& method );
 
 } // RPC
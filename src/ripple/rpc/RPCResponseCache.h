@@ -0,0 +1,93 @@
+#ifndef RIPPLE_RPC_RPCRESPONSECACHE_H_INCLUDED
+#define RIPPLE_RPC_RPCRESPONSECACHE_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <beast/utility/Journal.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ripple {
+
+/** Serialized replies to RPC queries against validated ledgers.
+
+    A query against a validated ledger gets the same reply every time, so
+    the reply can be kept and sent again. A reply is found by the method,
+    the request with its ledger fields removed, whether the client is an
+    administrator, and the hash of the ledger the request resolved to.
+
+    The cache is configured in [rpc_cache] with mb=, the memory it may
+    hold, and optionally methods=, the comma separated methods it keeps
+    replies for. The least recently used replies are dropped to stay
+    within the memory.
+*/
+class RPCResponseCache
+{
+public:
+    RPCResponseCache (Section const& section, beast::Journal journal);
+
+    RPCResponseCache (RPCResponseCache const&) = delete;
+    RPCResponseCache& operator= (RPCResponseCache const&) = delete;
+
+    /** Returns true if the cache is configured. */
+    bool
+    enabled () const
+    {
+        return bytes_ != 0;
+    }
+
+    /** Returns true if replies to a method are kept. */
+    bool
+    cacheable (std::string const& method) const;
+
+    /** Returns the key of a request against a ledger. */
+    static
+    std::string
+    makeKey (std::string const& method, Json::Value const& params,
+        bool admin, uint256 const& ledgerHash);
+
+    /** Returns the reply with a key, or nullptr. */
+    std::shared_ptr<std::string const>
+    find (std::string const& key);
+
+    /** Keep a reply, and return it.
+        A reply larger than a quarter of the memory is not kept.
+    */
+    std::shared_ptr<std::string const>
+    insert (std::string const& key, std::string reply);
+
+    /** The memory, the size and the hits and misses. */
+    Json::Value
+    getJson () const;
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<std::string const>>;
+    using List = std::list<Entry>;
+
+    static std::size_t
+    bytes (Entry const& entry);
+
+    std::uint64_t const bytes_;
+    std::set<std::string> methods_;
+    beast::Journal journal_;
+
+    std::mutex mutable mutex_;
+
+    // Most recently used first
+    List entries_;
+    std::unordered_map<std::string, List::iterator> index_;
+    std::uint64_t size_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+};
+
+} // ripple
+
+#endif
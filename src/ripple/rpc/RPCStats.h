@@ -0,0 +1,130 @@
+#ifndef RIPPLE_RPC_RPCSTATS_H_INCLUDED
+#define RIPPLE_RPC_RPCSTATS_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <beast/insight/Collector.h>
+#include <beast/insight/Counter.h>
+#include <beast/insight/Event.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Where the time goes while serving each RPC method.
+
+    For every method this counts the calls and the calls which failed, and
+    keeps a histogram of the time spent in each stage of a request and of
+    the size of the replies. Requests from HTTP and websocket clients are
+    both counted. Every stage is also reported to the insight collector as
+    an event named after the method.
+
+    A method is only tracked once its handler has been called, so requests
+    for methods which do not exist can not add entries.
+*/
+class RPCStats
+{
+public:
+    enum class Stage
+    {
+        parse,          // parsing the request
+        execute,        // running the handler
+        serialize       // serializing the reply
+    };
+
+    static std::size_t const stageCount = 3;
+
+    /** Counts of values in ranges which double in size.
+
+        Bucket 0 holds zero and each bucket n after it holds the values
+        from 2^(n-1) up to 2^n - 1. The last bucket also holds everything
+        larger.
+    */
+    class Histogram
+    {
+    public:
+        static std::size_t const bucketCount = 32;
+
+        void
+        add (std::uint64_t value);
+
+        std::uint64_t
+        count () const
+        {
+            return count_;
+        }
+
+        /** Returns the upper bound of the bucket holding a percentile.
+            The bound is never more than the largest value added.
+        */
+        std::uint64_t
+        percentile (double p) const;
+
+        /** Returns the count, mean, largest value and percentiles. */
+        Json::Value
+        getJson () const;
+
+    private:
+        std::array<std::uint64_t, bucketCount> buckets_ {};
+        std::uint64_t count_ = 0;
+        std::uint64_t total_ = 0;
+        std::uint64_t max_ = 0;
+    };
+
+    explicit
+    RPCStats (beast::insight::Collector::ptr const& collector);
+
+    RPCStats (RPCStats const&) = delete;
+    RPCStats& operator= (RPCStats const&) = delete;
+
+    /** Count a call of a method's handler and the time it took. */
+    void
+    addCall (std::string const& method, bool failed,
+        std::chrono::nanoseconds elapsed);
+
+    /** Add time spent on a request in one stage.
+        Nothing is added if the method's handler was never called.
+    */
+    void
+    add (std::string const& method, Stage stage,
+        std::chrono::nanoseconds elapsed);
+
+    /** Add the size of a reply.
+        Nothing is added if the method's handler was never called.
+    */
+    void
+    addReply (std::string const& method, std::size_t bytes);
+
+    /** The counts and histograms of every method called so far.
+        Times are in microseconds.
+    */
+    Json::Value
+    getJson () const;
+
+    static char const* getName (Stage stage);
+
+private:
+    struct Method
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t failed = 0;
+        std::array<Histogram, stageCount> stages;
+        Histogram bytes;
+
+        beast::insight::Counter callsCounter;
+        beast::insight::Counter failedCounter;
+        std::array<beast::insight::Event, stageCount> events;
+        beast::insight::Event bytesEvent;
+    };
+
+    beast::insight::Collector::ptr collector_;
+    std::mutex mutable mutex_;
+    std::map<std::string, Method> methods_;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef RIPPLE_RPC_TXHISTORYINDEX_H_INCLUDED
+#define RIPPLE_RPC_TXHISTORYINDEX_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** The keys of the most recent transactions, in tx_history order.
+
+    Transactions are paged newest first, by ledger and then by ID. The
+    index turns the start of a page into the key of its first transaction,
+    so the page is read from the database from that key instead of
+    skipping every transaction before it.
+
+    The keys are loaded again, at most once for each validated ledger, by
+    the first page asked for after it.
+*/
+class TxHistoryIndex
+{
+public:
+    struct Key
+    {
+        std::uint32_t ledgerSeq;
+        uint256 txID;
+    };
+
+    /** Loads the keys of the newest transactions, newest first. */
+    using Loader = std::function<std::vector<Key> (std::size_t count)>;
+
+    /** @param capacity The transactions indexed, enough for the largest
+                        start clients may ask for.
+    */
+    explicit
+    TxHistoryIndex (std::size_t capacity = 10020);
+
+    TxHistoryIndex (TxHistoryIndex const&) = delete;
+    TxHistoryIndex& operator= (TxHistoryIndex const&) = delete;
+
+    /** Returns the key of the transaction at a position, newest first.
+        @param ledgerSeq The last validated ledger.
+        @return none if the position is not indexed.
+    */
+    boost::optional<Key>
+    find (std::size_t start, std::uint32_t ledgerSeq, Loader const& load);
+
+    std::size_t
+    capacity () const
+    {
+        return capacity_;
+    }
+
+private:
+    std::size_t const capacity_;
+
+    std::mutex mutex_;
+    bool loaded_ = false;
+    std::uint32_t ledgerSeq_ = 0;
+    std::vector<Key> keys_;
+};
+
+} // ripple
+
+#endif
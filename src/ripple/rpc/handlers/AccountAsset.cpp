@@ -1,30 +1,232 @@
 #include <BeastConfig.h>
+#include <ripple/app/main/Application.h>
 #include <ripple/app/paths/RippleState.h>
 #include <ripple/ledger/PaymentSandbox.h>
+#include <ripple/ledger/View.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/resource/Fees.h>
+#include <ripple/rpc/Context.h>
 #include <ripple/rpc/impl/AccountFromString.h>
 #include <ripple/rpc/impl/LookupLedger.h>
+#include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/impl/Utilities.h>
+#include <limits>
 
 namespace ripple {
 
-void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const& line, std::shared_ptr<ReadView const> ledger);
+void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const& line, PaymentSandbox& les);
+
+// Appends the asset state to jsonAssetStates, signed from the point of view
+// of the line's account.
+static
+void addState (Json::Value& jsonAssetStates, SLE const& sle, RippleState const& line)
+{
+    STAmount amount = sle.getFieldAmount(sfAmount);
+    STAmount released = sle.getFieldAmount(sfDeliveredAmount);
+
+    if (sle.getAccountID(sfAccount) == line.getAccountIDPeer()) {
+        amount.negate();
+        released.negate();
+    }
+
+    auto reserved = released ? amount - released : amount;
+
+    Json::Value& state(jsonAssetStates.append(Json::objectValue));
+    state[jss::date] = static_cast<Json::UInt>(getQuality(sle.key ()));
+    state[jss::amount] = amount.getText();
+    state[jss::reserve] = reserved.getText();
+}
+
+// Lists, in date order, the asset states of the line strictly after `after`,
+// stopping once `remaining` states were listed. Returns the key to resume
+// after when the line has more states, zero otherwise.
+static
+uint256 addStates (Json::Value& jsonAssetStates, ReadView const& view,
+    RippleState const& line, uint256 const& after, unsigned int& remaining)
+{
+    uint256 const assetStateIndex = getQualityIndex (getAssetStateIndex (
+        line.getAccountID(), line.getAccountIDPeer(), assetCurrency()));
+    uint256 last = after;
+    bool more = false;
+
+    forEachSLE (view, after, getQualityNext (assetStateIndex),
+        [&](std::shared_ptr<SLE const> const& sle)
+        {
+            if (sle->getType () != ltASSET_STATE)
+                return true;
+            if (remaining == 0)
+            {
+                more = true;
+                return false;
+            }
+            addState (jsonAssetStates, *sle, line);
+            last = sle->key ();
+            --remaining;
+            return true;
+        });
+
+    return more ? last : uint256 ();
+}
+
+// Lists every ASSET line of the account with its asset states, paging over
+// the states.
+//
+// The marker is the line to resume at, optionally followed by a comma and the
+// last asset state of that line already returned.
+static
+Json::Value doAccountAssetLines (RPC::Context& context,
+    std::shared_ptr<ReadView const> const& ledger,
+        AccountID const& raAccount, Json::Value result)
+{
+    auto const& params(context.params);
+
+    unsigned int limit;
+    if (auto err = readLimitField (limit, RPC::Tuning::accountAsset, context))
+        return *err;
+
+    auto const isAssetLine = [](std::shared_ptr<SLE const> const& sle)
+    {
+        return sle && sle->getType () == ltRIPPLE_STATE &&
+            sle->getFieldAmount (sfBalance).getCurrency () == assetCurrency ();
+    };
+
+    // A page covers at most `limit` lines, the one after them is the marker.
+    std::vector<std::shared_ptr<SLE const>> sleLines;
+    uint256 startAfter;
+    std::uint64_t startHint = 0;
+    uint256 startState;
+
+    if (params.isMember (jss::marker))
+    {
+        Json::Value const& marker (params[jss::marker]);
+
+        if (! marker.isString ())
+            return RPC::expected_field_error (jss::marker, "string");
+
+        std::string const strMarker = marker.asString ();
+        auto const comma = strMarker.find (',');
+
+        if (! startAfter.SetHexExact (strMarker.substr (0, comma)))
+            return rpcError (rpcINVALID_PARAMS);
+
+        auto const sleLine = ledger->read ({ltRIPPLE_STATE, startAfter});
+
+        if (! isAssetLine (sleLine))
+            return rpcError (rpcINVALID_PARAMS);
+
+        if (sleLine->getFieldAmount (sfLowLimit).getIssuer () == raAccount)
+            startHint = sleLine->getFieldU64 (sfLowNode);
+        else if (sleLine->getFieldAmount (sfHighLimit).getIssuer () == raAccount)
+            startHint = sleLine->getFieldU64 (sfHighNode);
+        else
+            return rpcError (rpcINVALID_PARAMS);
+
+        if (comma != std::string::npos)
+        {
+            if (! startState.SetHexExact (strMarker.substr (comma + 1)))
+                return rpcError (rpcINVALID_PARAMS);
+
+            auto const line = RippleState::makeItem (raAccount, sleLine);
+            uint256 const assetStateIndex = getQualityIndex (getAssetStateIndex (
+                line->getAccountID(), line->getAccountIDPeer(), assetCurrency()));
+
+            if (startState < assetStateIndex ||
+                    startState >= getQualityNext (assetStateIndex))
+                return rpcError (rpcINVALID_PARAMS);
+        }
+
+        sleLines.push_back (sleLine);
+    }
+
+    if (sleLines.size () <= limit &&
+        ! forEachItemAfter (*ledger, raAccount, startAfter, startHint,
+            limit + 1 - sleLines.size (),
+            [&](std::shared_ptr<SLE const> const& sle)
+            {
+                if (! isAssetLine (sle))
+                    return false;
+                sleLines.push_back (sle);
+                return true;
+            }))
+    {
+        return rpcError (rpcINVALID_PARAMS);
+    }
+
+    // All the lines are released in the same sandbox. Its changes stay
+    // out of the directory walk above, which read the ledger itself.
+    PaymentSandbox les (&*ledger, tapNONE);
+    Json::Value& jsonLines (result[jss::lines] = Json::arrayValue);
+    unsigned int remaining = limit;
+    std::string strMarker;
+
+    for (std::size_t i = 0; i < sleLines.size (); ++i)
+    {
+        auto const line = RippleState::makeItem (raAccount, sleLines[i]);
+        if (line == nullptr)
+            continue;
+
+        if (i == limit || (remaining == 0 && startState.isZero ()))
+        {
+            strMarker = to_string (line->key ());
+            break;
+        }
+
+        addLine (context, jsonLines, *line, les);
+        Json::Value& jsonAssetStates (
+            jsonLines[jsonLines.size () - 1][jss::states] = Json::arrayValue);
+
+        if (startState.isZero ())
+        {
+            // The zero state first, then the others by date
+            startState = getQualityIndex (getAssetStateIndex (
+                line->getAccountID(), line->getAccountIDPeer(), assetCurrency()));
+            if (auto const sle = les.read (keylet::asset_state (startState)))
+            {
+                addState (jsonAssetStates, *sle, *line);
+                --remaining;
+            }
+        }
+
+        auto const last = addStates (
+            jsonAssetStates, les, *line, startState, remaining);
+
+        if (last.isNonZero ())
+        {
+            strMarker = to_string (line->key ()) + "," + to_string (last);
+            break;
+        }
+
+        startState.zero ();
+    }
+
+    if (! strMarker.empty ())
+    {
+        result[jss::limit] = limit;
+        result[jss::marker] = strMarker;
+    }
+
+    result[jss::account] = context.app.accountIDCache().toBase58 (raAccount);
+    context.loadType = Resource::feeLowBurdenRPC;
+    return result;
+}
 
 // {
 //   account: [<account>|<account_public_key>]
-//   peer: [<account>|<account_public_key>]
-//   currency: <currency>
+//   peer: [<account>|<account_public_key>]     // optional
+//   currency: <currency>                       // required with peer
 //   ledger_hash : <ledger>
 //   ledger_index : <ledger_index>
+//   limit: integer                             // optional, without peer
+//   marker: opaque                             // optional, without peer
 // }
 Json::Value doAccountAsset (RPC::Context& context)
 {
     auto const& params(context.params);
     if (!params.isMember(jss::account))
         return RPC::missing_field_error("account");
-    if (!params.isMember(jss::peer))
-        return RPC::missing_field_error("peer");
-    if (!params.isMember(jss::currency))
-        return RPC::missing_field_error("currency");
 
     std::shared_ptr<ReadView const> ledger;
     auto result = RPC::lookupLedger (ledger, context);
@@ -45,6 +247,13 @@ Json::Value doAccountAsset (RPC::Context& context)
     if (! ledger->exists(keylet::account (raAccount)))
         return rpcError (rpcACT_NOT_FOUND);
 
+    // Without a peer, every ASSET line of the account.
+    if (!params.isMember(jss::peer))
+        return doAccountAssetLines (context, ledger, raAccount, result);
+
+    if (!params.isMember(jss::currency))
+        return RPC::missing_field_error("currency");
+
     std::string strPeer (params[jss::peer].asString ());
     AccountID raPeerAccount;
 
@@ -71,49 +280,24 @@ Json::Value doAccountAsset (RPC::Context& context)
         raPeerAccount != line->getAccountIDPeer())
         return result;
 
+    // addLine runs the release, the states are then read from the same sandbox
+    PaymentSandbox les (&*ledger, tapNONE);
     Json::Value jsonLines(Json::arrayValue);
-    addLine(context, jsonLines, *line, ledger);
+    addLine(context, jsonLines, *line, les);
     result[jss::lines] = jsonLines[0u];
     
     Json::Value& jsonAssetStates(result[jss::states] = Json::arrayValue);
     
     // get asset_states for currency ASSET.
     if (assetCurrency() == line->getBalance().getCurrency()) {
-        PaymentSandbox les (&*ledger, tapNONE);
-        auto sleRippleState = les.peek (keylet::line (raAccount, raPeerAccount, assetCurrency ()));
-        assetRelease (les, raAccount, raPeerAccount, assetCurrency (), sleRippleState, context.app.journal ("View"));
-
         uint256 baseIndex = getAssetStateIndex(line->getAccountID(), line->getAccountIDPeer(), assetCurrency());
         uint256 assetStateIndex = getQualityIndex(baseIndex);
-        uint256 assetStateEnd = getQualityNext(assetStateIndex);
-
-        for (;;) {
-            auto const& sle = les.read (keylet::asset_state (assetStateIndex));
-            if (sle) {
-                STAmount amount = sle->getFieldAmount(sfAmount);
-                STAmount released = sle->getFieldAmount(sfDeliveredAmount);
-
-                if (sle->getAccountID(sfAccount) == line->getAccountIDPeer()) {
-                    amount.negate();
-                    released.negate();
-                }
+        unsigned int remaining = std::numeric_limits<unsigned int>::max ();
 
-                auto reserved = released ? amount - released : amount;
-
-                Json::Value& state(jsonAssetStates.append(Json::objectValue));
-                state[jss::date] = static_cast<Json::UInt>(getQuality(assetStateIndex));
-                state[jss::amount] = amount.getText();
-                state[jss::reserve] = reserved.getText();
-            }
-
-            auto const nextAssetState =
-                les.succ (assetStateIndex, assetStateEnd);
-
-            if (!nextAssetState)
-                break;
-
-            assetStateIndex = *nextAssetState;
-        }
+        // The zero state first, then the others by date
+        if (auto const sle = les.read (keylet::asset_state (assetStateIndex)))
+            addState (jsonAssetStates, *sle, *line);
+        addStates (jsonAssetStates, les, *line, assetStateIndex, remaining);
     }
 
     context.loadType = Resource::feeMediumBurdenRPC;
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/rpc/handlers/AccountBatch.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/resource/Fees.h>
+#include <ripple/rpc/impl/AccountFromString.h>
+#include <ripple/rpc/impl/LookupLedger.h>
+#include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/impl/Utilities.h>
+
+namespace ripple {
+namespace RPC {
+
+AccountBatch::AccountBatch (Context& context) : context_ (context)
+{
+}
+
+Status AccountBatch::check (Resource::Charge const& each, char const* label)
+{
+    auto const& params = context_.params;
+
+    if (! params.isMember (jss::accounts))
+        return {rpcINVALID_PARAMS, missing_field_message (std::string (jss::accounts))};
+
+    Json::Value const& jAccounts = params[jss::accounts];
+    if (! jAccounts.isArray () || jAccounts.size () == 0)
+        return {rpcINVALID_PARAMS,
+            expected_field_message (jss::accounts, "non-empty array")};
+
+    if (jAccounts.size () > Tuning::maxBatchAccounts &&
+            ! isUnlimited (context_.role))
+        return {rpcINVALID_PARAMS, "Too many accounts in one request."};
+
+    accounts_.reserve (jAccounts.size ());
+    for (auto const& jAccount : jAccounts)
+    {
+        auto const id = jAccount.isString () ?
+            accountFromStringStrict (jAccount.asString ()) : boost::none;
+        if (! id)
+            return {rpcACT_MALFORMED,
+                "Account malformed: " + jAccount.asString ()};
+        accounts_.push_back (*id);
+    }
+
+    if (auto s = lookupLedger (ledger_, context_, result_))
+        return s;
+
+    // Read the roots of all the accounts at once, rather than in turn
+    std::vector<uint256> keys;
+    keys.reserve (2 * accounts_.size ());
+    for (auto const& accountID : accounts_)
+    {
+        keys.push_back (keylet::account (accountID).key);
+        keys.push_back (keylet::ownerDir (accountID).key);
+    }
+    ledger_->prefetch (keys);
+
+    context_.loadType = Resource::Charge (each.cost () +
+        each.cost () * static_cast<int> (accounts_.size () - 1) / 2, label);
+    return Status::OK;
+}
+
+AccountInfoBatchHandler::AccountInfoBatchHandler (Context& context)
+    : AccountBatch (context)
+{
+}
+
+Status AccountInfoBatchHandler::check ()
+{
+    return AccountBatch::check (
+        Resource::feeReferenceRPC, "batch account info");
+}
+
+AccountLinesBatchHandler::AccountLinesBatchHandler (Context& context)
+    : AccountBatch (context)
+{
+}
+
+Status AccountLinesBatchHandler::check ()
+{
+    if (auto err = readLimitField (limit_, Tuning::accountLines, context_))
+    {
+        return {rpcINVALID_PARAMS,
+            expected_field_message (jss::limit, "unsigned integer")};
+    }
+
+    return AccountBatch::check (
+        Resource::feeMediumBurdenRPC, "batch account lines");
+}
+
+} // RPC
+} // ripple
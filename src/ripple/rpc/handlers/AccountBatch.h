@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_RPC_HANDLERS_ACCOUNTBATCH_H_INCLUDED
+#define RIPPLE_RPC_HANDLERS_ACCOUNTBATCH_H_INCLUDED
+
+#include <ripple/app/main/Application.h>
+#include <ripple/app/paths/RippleState.h>
+#include <ripple/json/Object.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/resource/Charge.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/Status.h>
+#include <ripple/rpc/impl/Handler.h>
+#include <ripple/server/Role.h>
+#include <vector>
+
+namespace ripple {
+namespace RPC {
+
+struct VisitData
+{
+    std::vector <RippleState::pointer> items;
+    AccountID const& accountID;
+    bool hasPeer;
+    AccountID const& raPeerAccount;
+};
+
+/** Write the account_info result for an account of a ledger. */
+void
+accountInfo (Context& context, ReadView const& ledger,
+    AccountID const& accountID, Json::Value& result);
+
+/** Write a page of an account's trust lines, and the marker of the next.
+
+    @param reserve The lines to read, one more than the limit unless the
+                   first line of the page came with the request's marker.
+    @return false if the owner directory could not be walked.
+*/
+bool
+accountLines (Context& context, std::shared_ptr<ReadView const> const& ledger,
+    VisitData& visitData, uint256 const& startAfter, std::uint64_t startHint,
+        unsigned int limit, unsigned int reserve, Json::Value& result);
+
+/** Write the first page of an account's trust lines. */
+bool
+accountLines (Context& context, std::shared_ptr<ReadView const> const& ledger,
+    AccountID const& accountID, unsigned int limit, Json::Value& result);
+
+// The accounts of a batch request, all read from one ledger
+//   Inputs:
+//     accounts:     array of account addresses
+//     ledger_hash : <ledger>
+//     ledger_index : <ledger_index>
+//   Outputs:
+//     ledger_hash:  chosen ledger's hash
+//     ledger_index: chosen ledger's index
+//     accounts:     array of the results of each account, in order
+//
+// The ledger is looked up once, and the account roots and owner
+// directories of all the accounts are read ahead together.
+class AccountBatch
+{
+public:
+    explicit AccountBatch (Context&);
+
+    /** Check the request, charging each account a part of its own.
+
+        The first account costs what its own request does, the others
+        half of that, as they share the ledger and the round trip.
+    */
+    Status check (Resource::Charge const& each, char const* label);
+
+protected:
+    Context& context_;
+    std::shared_ptr<ReadView const> ledger_;
+    Json::Value result_;
+    std::vector<AccountID> accounts_;
+};
+
+class AccountInfoBatchHandler : public AccountBatch
+{
+public:
+    explicit AccountInfoBatchHandler (Context&);
+
+    Status check ();
+
+    template <class Object>
+    void writeResult (Object&);
+
+    static const char* const name()
+    {
+        return "account_info_batch";
+    }
+
+    static Role role()
+    {
+        return Role::USER;
+    }
+
+    static Condition condition()
+    {
+        return NO_CONDITION;
+    }
+};
+
+// Also takes limit, the most lines of each account. An account with more
+// has the marker to page through them with account_lines.
+class AccountLinesBatchHandler : public AccountBatch
+{
+public:
+    explicit AccountLinesBatchHandler (Context&);
+
+    Status check ();
+
+    template <class Object>
+    void writeResult (Object&);
+
+    static const char* const name()
+    {
+        return "account_lines_batch";
+    }
+
+    static Role role()
+    {
+        return Role::USER;
+    }
+
+    static Condition condition()
+    {
+        return NO_CONDITION;
+    }
+
+private:
+    unsigned int limit_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation.
+
+// The accounts are written one at a time, so a streaming Object never
+// holds more than one of them.
+
+template <class Object>
+void AccountInfoBatchHandler::writeResult (Object& value)
+{
+    Json::copyFrom (value, result_);
+
+    auto&& accounts = Json::setArray (value, jss::accounts);
+    for (auto const& accountID : accounts_)
+    {
+        Json::Value entry (Json::objectValue);
+        entry[jss::account] =
+            context_.app.accountIDCache().toBase58 (accountID);
+        accountInfo (context_, *ledger_, accountID, entry);
+        accounts.append (entry);
+    }
+}
+
+template <class Object>
+void AccountLinesBatchHandler::writeResult (Object& value)
+{
+    Json::copyFrom (value, result_);
+
+    auto&& accounts = Json::setArray (value, jss::accounts);
+    for (auto const& accountID : accounts_)
+    {
+        Json::Value entry (Json::objectValue);
+        entry[jss::account] =
+            context_.app.accountIDCache().toBase58 (accountID);
+
+        if (! ledger_->exists (keylet::account (accountID)))
+            inject_error (rpcACT_NOT_FOUND, entry);
+        else if (! accountLines (context_, ledger_, accountID, limit_, entry))
+            inject_error (rpcINVALID_PARAMS, entry);
+        accounts.append (entry);
+    }
+}
+
+} // RPC
+} // ripple
+
+#endif
@@ -21,6 +21,7 @@
 
 #include <ripple/app/main/Application.h>
 #include <ripple/json/json_value.h>
+#include <ripple/ledger/View.h>
 #include <ripple/ledger/ReadView.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/Indexes.h>
@@ -28,11 +29,73 @@
 #include <ripple/protocol/types.h>
 #include <ripple/rpc/impl/Utilities.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/handlers/AccountBatch.h>
 #include <ripple/rpc/impl/AccountFromString.h>
 #include <ripple/rpc/impl/LookupLedger.h>
 
 namespace ripple {
 
+namespace RPC {
+
+void
+accountInfo (Context& context, ReadView const& ledger,
+    AccountID const& accountID, Json::Value& result)
+{
+    auto const sleAccepted = ledger.read(keylet::account(accountID));
+    if (sleAccepted)
+    {
+        Json::Value jvAccepted (Json::objectValue);
+        injectSLE(jvAccepted, *sleAccepted);
+
+        // See if there are References for this account.
+        Json::Value references (Json::arrayValue);
+        forEachReference (ledger, accountID,
+            [&references](std::shared_ptr<SLE const> const& sle)
+            {
+                if (sle)
+                {
+                    Json::Value& holder = references.append (Json::objectValue)
+                        [sfReferenceHolder.getName ()];
+                    holder[sfReference.getName ()] =
+                        toBase58 (sle->getAccountID (sfAccount));
+                }
+                return true;
+            });
+
+        if (references.size () != 0)
+        {
+            static const Json::StaticString referencesName("References");
+            jvAccepted[referencesName] = references;
+        }
+
+        // See if there's a SignerEntries for this account.
+        auto const signerList = ledger.read (keylet::signers(accountID));
+
+        if (signerList)
+        {
+            // Return multi-signing information if there are multi-signers.
+            static const Json::StaticString multiSignersName("multisigners");
+            jvAccepted[multiSignersName] = signerList->getJson (0);
+            Json::Value& multiSignerJson = jvAccepted[multiSignersName];
+
+            // Remove unwanted fields.
+            multiSignerJson.removeMember (sfFlags.getName ());
+            multiSignerJson.removeMember (sfLedgerEntryType.getName ());
+            multiSignerJson.removeMember (sfOwnerNode.getName ());
+            multiSignerJson.removeMember ("index");
+        }
+
+        result[jss::account_data] = jvAccepted;
+    }
+    else
+    {
+        result[jss::account] = context.app.accountIDCache().toBase58 (accountID);
+        inject_error (rpcACT_NOT_FOUND, result);
+    }
+}
+
+} // RPC
+
 // {
 //   account: <indent>,
 //   strict: <bool>
@@ -67,46 +130,7 @@ Json::Value doAccountInfo (RPC::Context& context)
     if (jvAccepted)
         return jvAccepted;
 
-    auto const sleAccepted = ledger->read(keylet::account(accountID));
-    if (sleAccepted)
-    {
-        RPC::injectSLE(jvAccepted, *sleAccepted);
-
-        // See if there's a References for this account.
-        auto const referList = ledger->read (keylet::refer(accountID));
-
-        if (referList)
-        {
-            // Return multi-signing information if there are multi-signers.
-            static const Json::StaticString referencesName("References");
-            jvAccepted[referencesName] = referList->getJson (0)["References"];
-        }
-
-        // See if there's a SignerEntries for this account.
-        auto const signerList = ledger->read (keylet::signers(accountID));
-
-        if (signerList)
-        {
-            // Return multi-signing information if there are multi-signers.
-            static const Json::StaticString multiSignersName("multisigners");
-            jvAccepted[multiSignersName] = signerList->getJson (0);
-            Json::Value& multiSignerJson = jvAccepted[multiSignersName];
-
-            // Remove unwanted fields.
-            multiSignerJson.removeMember (sfFlags.getName ());
-            multiSignerJson.removeMember (sfLedgerEntryType.getName ());
-            multiSignerJson.removeMember (sfOwnerNode.getName ());
-            multiSignerJson.removeMember ("index");
-        }
-
-        result[jss::account_data] = jvAccepted;
-    }
-    else
-    {
-        result[jss::account] = context.app.accountIDCache().toBase58 (accountID);
-        RPC::inject_error (rpcACT_NOT_FOUND, result);
-    }
-
+    RPC::accountInfo (context, *ledger, accountID, result);
     return result;
 }
 
@@ -27,6 +27,7 @@
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/handlers/AccountBatch.h>
 #include <ripple/rpc/impl/AccountFromString.h>
 #include <ripple/rpc/impl/LookupLedger.h>
 #include <ripple/rpc/impl/Tuning.h>
@@ -34,15 +35,7 @@
 
 namespace ripple {
 
-struct VisitData
-{
-    std::vector <RippleState::pointer> items;
-    AccountID const& accountID;
-    bool hasPeer;
-    AccountID const& raPeerAccount;
-};
-
-void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const& line, std::shared_ptr<ReadView const> ledger)
+void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const& line, PaymentSandbox& les)
 {
     STAmount saBalance (line.getBalance ());
     STAmount const& saLimit (line.getLimit ());
@@ -52,7 +45,6 @@ void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const&
     jPeer[jss::account] = to_string (line.getAccountIDPeer ());
     if (assetCurrency() == saBalance.getCurrency()) {
         // calculate released & reserved balance for asset.
-        PaymentSandbox les (&*ledger, tapNONE);
         auto sleRippleState = les.peek (keylet::line (line.getAccountID (), line.getAccountIDPeer (), assetCurrency ()));
         assetRelease(les, line.getAccountID(), line.getAccountIDPeer(), assetCurrency(), sleRippleState, context.app.journal ("View"));
         STAmount reserve = sleRippleState->getFieldAmount(sfReserve);
@@ -92,6 +84,67 @@ void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const&
         jPeer[jss::freeze_peer] = true;
 }
 
+void addLine (RPC::Context& context, Json::Value& jsonLines, RippleState const& line, std::shared_ptr<ReadView const> ledger)
+{
+    PaymentSandbox les (&*ledger, tapNONE);
+    addLine (context, jsonLines, line, les);
+}
+
+namespace RPC {
+
+bool
+accountLines (Context& context, std::shared_ptr<ReadView const> const& ledger,
+    VisitData& visitData, uint256 const& startAfter, std::uint64_t startHint,
+        unsigned int limit, unsigned int reserve, Json::Value& result)
+{
+    if (! forEachItemAfter(*ledger, visitData.accountID,
+            startAfter, startHint, reserve,
+        [&visitData](std::shared_ptr<SLE const> const& sleCur)
+        {
+            auto const line =
+                RippleState::makeItem (visitData.accountID, sleCur);
+            if (line != nullptr &&
+                (! visitData.hasPeer ||
+                 visitData.raPeerAccount == line->getAccountIDPeer ()))
+            {
+                visitData.items.emplace_back (line);
+                return true;
+            }
+
+            return false;
+        }))
+    {
+        return false;
+    }
+
+    if (visitData.items.size () == reserve)
+    {
+        result[jss::limit] = limit;
+
+        RippleState::pointer line (visitData.items.back ());
+        result[jss::marker] = to_string (line->key());
+        visitData.items.pop_back ();
+    }
+
+    Json::Value& jsonLines (result[jss::lines]);
+    for (auto const& item : visitData.items)
+        addLine (context, jsonLines, *item.get (), ledger);
+    return true;
+}
+
+bool
+accountLines (Context& context, std::shared_ptr<ReadView const> const& ledger,
+    AccountID const& accountID, unsigned int limit, Json::Value& result)
+{
+    result[jss::lines] = Json::arrayValue;
+    VisitData visitData = {{}, accountID, false, accountID};
+    visitData.items.reserve (limit + 1);
+    return accountLines (context, ledger, visitData,
+        uint256 (), 0, limit, limit + 1, result);
+}
+
+} // RPC
+
 // {
 //   account: <account>|<account_public_key>
 //   ledger_hash : <ledger>
@@ -144,7 +197,7 @@ Json::Value doAccountLines (RPC::Context& context)
         return *err;
 
     Json::Value& jsonLines (result[jss::lines] = Json::arrayValue);
-    VisitData visitData = {{}, accountID, hasPeer, raPeerAccount};
+    RPC::VisitData visitData = {{}, accountID, hasPeer, raPeerAccount};
     unsigned int reserve (limit);
     uint256 startAfter;
     std::uint64_t startHint;
@@ -186,42 +239,12 @@ Json::Value doAccountLines (RPC::Context& context)
         visitData.items.reserve (++reserve);
     }
 
-    {
-        if (! forEachItemAfter(*ledger, accountID,
-                startAfter, startHint, reserve,
-            [&visitData](std::shared_ptr<SLE const> const& sleCur)
-            {
-                auto const line =
-                    RippleState::makeItem (visitData.accountID, sleCur);
-                if (line != nullptr &&
-                    (! visitData.hasPeer ||
-                     visitData.raPeerAccount == line->getAccountIDPeer ()))
-                {
-                    visitData.items.emplace_back (line);
-                    return true;
-                }
-
-                return false;
-            }))
-        {
-            return rpcError (rpcINVALID_PARAMS);
-        }
-    }
-
-    if (visitData.items.size () == reserve)
-    {
-        result[jss::limit] = limit;
-
-        RippleState::pointer line (visitData.items.back ());
-        result[jss::marker] = to_string (line->key());
-        visitData.items.pop_back ();
-    }
+    if (! RPC::accountLines (context, ledger, visitData, startAfter,
+            startHint, limit, reserve, result))
+        return rpcError (rpcINVALID_PARAMS);
 
     result[jss::account] = context.app.accountIDCache().toBase58 (accountID);
 
-    for (auto const& item : visitData.items)
-        addLine (context, jsonLines, *item.get (), ledger);
-
     context.loadType = Resource::feeMediumBurdenRPC;
     return result;
 }
@@ -0,0 +1,141 @@
+#include <BeastConfig.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/DividendMaster.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/ledger/View.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/resource/Fees.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/AccountFromString.h>
+#include <ripple/rpc/impl/LookupLedger.h>
+#include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/impl/Utilities.h>
+
+namespace ripple {
+
+static
+void
+addSubtree (Json::Value& jv, DividendMaster& dividendMaster,
+    AccountID const& account)
+{
+    if (auto const subtree = dividendMaster.getReferralSubtree (account))
+    {
+        jv[jss::descendants] = to_string (subtree->count);
+        jv[jss::descendants_vbc] = to_string (subtree->vbc);
+    }
+}
+
+// {
+//   account: <account>|<account_public_key>
+//   ledger_hash : <ledger>
+//   ledger_index : <ledger_index>
+//   limit: integer                 // optional
+//   marker: opaque                 // optional, resume previous query
+// }
+//
+// The direct references are read from the ledger. The descendants and their
+// VBC come from the dividend index, as of the last validated ledger it
+// applied, and are only reported by servers keeping it.
+Json::Value doAccountReferrals (RPC::Context& context)
+{
+    auto const& params (context.params);
+    if (! params.isMember (jss::account))
+        return RPC::missing_field_error (jss::account);
+
+    std::shared_ptr<ReadView const> ledger;
+    auto result = RPC::lookupLedger (ledger, context);
+    if (! ledger)
+        return result;
+
+    std::string strIdent (params[jss::account].asString ());
+    AccountID accountID;
+
+    if (auto jv = RPC::accountFromString (accountID, strIdent))
+    {
+        for (auto it = jv.begin (); it != jv.end (); ++it)
+            result[it.memberName ()] = it.key ();
+
+        return result;
+    }
+
+    auto const sleAccount = ledger->read (keylet::account (accountID));
+    if (! sleAccount)
+        return rpcError (rpcACT_NOT_FOUND);
+
+    unsigned int limit;
+    if (auto err = readLimitField (limit, RPC::Tuning::accountReferrals, context))
+        return *err;
+
+    AccountID startAfter;
+    if (params.isMember (jss::marker))
+    {
+        Json::Value const& marker (params[jss::marker]);
+
+        if (! marker.isString ())
+            return RPC::expected_field_error (jss::marker, "string");
+
+        if (RPC::accountFromString (startAfter, marker.asString ()))
+            return rpcError (rpcINVALID_PARAMS);
+    }
+
+    auto& dividendMaster = context.app.getDividendMaster ();
+    auto& idCache = context.app.accountIDCache ();
+
+    result[jss::account] = idCache.toBase58 (accountID);
+    if (sleAccount->isFieldPresent (sfReferee))
+        result[jss::referee] = idCache.toBase58 (
+            sleAccount->getAccountID (sfReferee));
+
+    if (auto const subtree = dividendMaster.getReferralSubtree (accountID))
+    {
+        result[jss::index_ledger] = subtree->ledgerSeq;
+        result[jss::descendants] = to_string (subtree->count);
+        result[jss::descendants_vbc] = to_string (subtree->vbc);
+    }
+
+    Json::Value& jsonReferences (result[jss::references] = Json::arrayValue);
+    bool found = startAfter.isZero ();
+    AccountID last;
+
+    forEachReference (*ledger, accountID,
+        [&](std::shared_ptr<SLE const> const& sle)
+        {
+            if (! sle)
+                return true;
+
+            auto const reference = sle->getAccountID (sfAccount);
+            if (! found)
+            {
+                found = reference == startAfter;
+                return true;
+            }
+
+            if (jsonReferences.size () == limit)
+            {
+                result[jss::limit] = limit;
+                result[jss::marker] = idCache.toBase58 (last);
+                return false;
+            }
+
+            Json::Value& jv (jsonReferences.append (Json::objectValue));
+            jv[jss::account] = idCache.toBase58 (reference);
+            jv[sfBalanceVBC.getName ()] =
+                sle->getFieldAmount (sfBalanceVBC).getText ();
+            if (sle->isFieldPresent (sfDividendTSprd))
+                jv[sfDividendTSprd.getName ()] =
+                    to_string (sle->getFieldU64 (sfDividendTSprd));
+            addSubtree (jv, dividendMaster, reference);
+            last = reference;
+            return true;
+        });
+
+    if (! found)
+        return rpcError (rpcINVALID_PARAMS);
+
+    context.loadType = Resource::feeMediumBurdenRPC;
+    return result;
+}
+
+} // ripple
@@ -30,6 +30,7 @@
 #include <ripple/protocol/types.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/AwaitIO.h>
 #include <ripple/rpc/impl/LookupLedger.h>
 #include <ripple/rpc/impl/Utilities.h>
 #include <ripple/server/Role.h>
@@ -144,9 +145,13 @@ Json::Value doAccountTx (RPC::Context& context)
 
         if (bBinary)
         {
-            auto txns = context.netOps.getTxsAccountB (
-                *account, uLedgerMin, uLedgerMax, bForward, resumeToken, limit,
-                isUnlimited (context.role), txType);
+            auto txns = RPC::awaitIO (context, [&]
+                {
+                    return context.netOps.getTxsAccountB (
+                        *account, uLedgerMin, uLedgerMax, bForward,
+                        resumeToken, limit, isUnlimited (context.role),
+                        txType);
+                });
 
             for (auto& it: txns)
             {
@@ -165,9 +170,13 @@ Json::Value doAccountTx (RPC::Context& context)
         }
         else
         {
-            auto txns = context.netOps.getTxsAccount (
-                *account, uLedgerMin, uLedgerMax, bForward, resumeToken, limit,
-                isUnlimited (context.role), txType);
+            auto txns = RPC::awaitIO (context, [&]
+                {
+                    return context.netOps.getTxsAccount (
+                        *account, uLedgerMin, uLedgerMax, bForward,
+                        resumeToken, limit, isUnlimited (context.role),
+                        txType);
+                });
 
             for (auto& it: txns)
             {
@@ -28,6 +28,7 @@
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/AwaitIO.h>
 #include <ripple/rpc/impl/LookupLedger.h>
 #include <ripple/server/Role.h>
 
@@ -41,7 +42,8 @@ namespace ripple {
 //   count: boolean,               // optional, defaults to false
 //   descending: boolean,          // optional, defaults to false
 //   offset: integer,              // optional, defaults to 0
-//   limit: integer                // optional
+//   limit: integer,               // optional
+//   marker: opaque                // optional, resume previous query
 // }
 Json::Value doAccountTxOld (RPC::Context& context)
 {
@@ -56,6 +58,8 @@ Json::Value doAccountTxOld (RPC::Context& context)
             && context.params[jss::descending].asBool ();
     bool bCount = context.params.isMember (jss::count)
             && context.params[jss::count].asBool ();
+    Json::Value marker = context.params.isMember (jss::marker)
+            ? context.params[jss::marker] : Json::Value (Json::nullValue);
     std::uint32_t   uLedgerMin;
     std::uint32_t   uLedgerMax;
     std::uint32_t   uValidatedMin;
@@ -71,7 +75,8 @@ Json::Value doAccountTxOld (RPC::Context& context)
     if (! raAccount)
         return rpcError (rpcACT_MALFORMED);
 
-    if (offset > 3000)
+    // A marker pages without an offset
+    if (marker.isNull () && offset > 3000)
         return rpcError (rpcATX_DEPRECATED);
 
     context.loadType = Resource::feeHighBurdenRPC;
@@ -145,9 +150,12 @@ Json::Value doAccountTxOld (RPC::Context& context)
 
         if (bBinary)
         {
-            auto txns = context.netOps.getAccountTxsB (
-                *raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit,
-                isUnlimited (context.role));
+            auto txns = RPC::awaitIO (context, [&]
+                {
+                    return context.netOps.getAccountTxsB (
+                        *raAccount, uLedgerMin, uLedgerMax, bDescending,
+                        offset, limit, isUnlimited (context.role), marker);
+                });
 
             for (auto it = txns.begin (), end = txns.end (); it != end; ++it)
             {
@@ -167,9 +175,12 @@ Json::Value doAccountTxOld (RPC::Context& context)
         }
         else
         {
-            auto txns = context.netOps.getAccountTxs (
-                *raAccount, uLedgerMin, uLedgerMax, bDescending, offset, limit,
-                isUnlimited (context.role));
+            auto txns = RPC::awaitIO (context, [&]
+                {
+                    return context.netOps.getAccountTxs (
+                        *raAccount, uLedgerMin, uLedgerMax, bDescending,
+                        offset, limit, isUnlimited (context.role), marker);
+                });
 
             for (auto it = txns.begin (), end = txns.end (); it != end; ++it)
             {
@@ -211,6 +222,9 @@ Json::Value doAccountTxOld (RPC::Context& context)
         if (context.params.isMember (jss::limit))
             ret[jss::limit]        = limit;
 
+        if (!marker.isNull ())
+            ret[jss::marker]       = marker;
+
 
         return ret;
 #ifndef BEAST_DEBUG
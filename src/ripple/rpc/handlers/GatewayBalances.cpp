@@ -19,6 +19,8 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/GatewayTotals.h>
+#include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/paths/RippleState.h>
 #include <ripple/ledger/ReadView.h>
 #include <ripple/protocol/ErrorCodes.h>
@@ -47,6 +49,9 @@ namespace ripple {
 // 3) Object of "assets" indicating accounts that owe the gateway.
 //    (Gateways typically do not hold positive balances. This is unusual.)
 
+// Without hot wallets, the totals of a validated ledger are kept for the
+// following ledgers, so issuers with many lines are not scanned each time.
+
 // gateway_balances [<ledger>] <account> [<howallet> [<hotwallet [...
 
 Json::Value doGatewayBalances (RPC::Context& context)
@@ -139,8 +144,22 @@ Json::Value doGatewayBalances (RPC::Context& context)
     std::map <AccountID, std::vector <STAmount>> hotBalances;
     std::map <AccountID, std::vector <STAmount>> assets;
 
-    // Traverse the cold wallet's trust lines
+    if (hotWallets.empty () && result[jss::validated].asBool ())
+    {
+        auto const totals = context.app.getOPs ().getGatewayTotals ().get (
+            *ledger, accountID);
+
+        sums = totals.obligations;
+        for (auto const& account : totals.assets)
+        {
+            auto& balances = assets[account.first];
+            for (auto const& balance : account.second)
+                balances.push_back (balance.second);
+        }
+    }
+    else
     {
+        // Traverse the cold wallet's trust lines
         forEachItem(*ledger, accountID,
             [&](std::shared_ptr<SLE const> const& sle)
             {
@@ -21,17 +21,26 @@
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/AccountSubscriptions.h>
+#include <ripple/app/misc/AccountTxCache.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TxTrace.h>
+#include <ripple/basics/MemoryTag.h>
 #include <ripple/basics/UptimeTimer.h>
+#include <ripple/core/CacheBudget.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/json/json_value.h>
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/nodestore/Database.h>
+#include <ripple/overlay/Overlay.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/RPCResponseCache.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
 
 namespace ripple {
 
@@ -91,14 +100,71 @@ Json::Value doGetCounts (RPC::Context& context)
     if (dbKB > 0)
         ret[jss::dbKBTransaction] = dbKB;
 
+    if (context.app.getTxnDB ().isPooled ())
+    {
+        auto const pool = [](DatabaseCon::PoolStats const& stats)
+        {
+            Json::Value ret (Json::objectValue);
+            ret[jss::connections] = static_cast<Json::UInt> (stats.connections);
+            ret[jss::checkouts] = std::to_string (stats.checkouts);
+            ret[jss::wait_us] = std::to_string (stats.waitTotal.count ());
+            ret[jss::wait_max_us] = static_cast<Json::UInt> (stats.waitMax.count ());
+            return ret;
+        };
+        ret[jss::txn_db_read] = pool (context.app.getTxnDB ().getReadStats ());
+        ret[jss::txn_db_write] = pool (context.app.getTxnDB ().getWriteStats ());
+    }
+
     {
         std::size_t c = context.app.getOPs().getLocalTxCount ();
         if (c > 0)
             ret[jss::local_txs] = static_cast<Json::UInt> (c);
     }
 
+    if (context.app.getOPs().getAccountTxCache ().enabled ())
+    {
+        auto const stats = context.app.getOPs().getAccountTxCache ().getStats ();
+        Json::Value& cache = (ret[jss::account_tx_cache] = Json::objectValue);
+        cache[jss::hits] = std::to_string (stats.hits);
+        cache[jss::misses] = std::to_string (stats.misses);
+        cache[jss::accounts] = static_cast<Json::UInt> (stats.accounts);
+    }
+
+    {
+        auto const stats =
+            context.app.getOPs().getAccountSubscriptions ().getStats ();
+        if (stats.subscribers != 0)
+        {
+            Json::Value& subs = (ret[jss::account_subscriptions] =
+                Json::objectValue);
+            subs[jss::accounts] = static_cast<Json::UInt> (stats.accounts);
+            subs[jss::subscribers] =
+                static_cast<Json::UInt> (stats.subscribers);
+            subs[jss::queued] = std::to_string (stats.queued);
+            subs[jss::dropped] = std::to_string (stats.dropped);
+        }
+    }
+
     ret[jss::write_load] = context.app.getNodeStore ().getWriteLoad ();
 
+    {
+        auto const times = context.app.pendingSaves ().getTimes ();
+        Json::Value& saves = (ret[jss::save_times_us] = Json::objectValue);
+        saves[jss::count] = std::to_string (times.saves);
+        saves[jss::accepted] = std::to_string (times.accepted.count ());
+        saves[jss::deletes] = std::to_string (times.deletes.count ());
+        saves[jss::accounts] = std::to_string (times.accounts.count ());
+        saves[jss::transactions] = std::to_string (times.transactions.count ());
+        saves[jss::commit] = std::to_string (times.commit.count ());
+        saves[jss::ledger] = std::to_string (times.ledger.count ());
+    }
+
+    {
+        auto times = context.app.overlay ().messageTimes ();
+        if (times.size () > 0)
+            ret[jss::peer_message_times] = std::move (times);
+    }
+
     ret[jss::historical_perminute] = static_cast<int>(
         context.app.getInboundLedgers().fetchRate());
     ret[jss::SLE_hit_rate] = context.app.cachedSLEs().rate();
@@ -110,6 +176,45 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::treenode_cache_size] = context.app.family().treecache().getCacheSize();
     ret[jss::treenode_track_size] = context.app.family().treecache().getTrackSize();
 
+    if (auto cache = context.app.family().serialcache())
+    {
+        ret[jss::serve_cache_size] = cache->getCacheSize();
+        ret[jss::serve_hit_rate] = cache->getHitRate();
+    }
+
+    if (context.app.getCacheBudget ().enabled ())
+        ret[jss::cache_budget] = context.app.getCacheBudget ().getJson ();
+
+    if (context.app.getRPCResponseCache ().enabled ())
+        ret[jss::rpc_cache] = context.app.getRPCResponseCache ().getJson ();
+
+    if (context.app.getTxTrace ().enabled ())
+        ret[jss::tx_trace] = context.app.getTxTrace ().getJson ();
+
+    if (auto const dropped = context.app.logs ().dropped ())
+        ret[jss::log_dropped] = std::to_string (dropped);
+
+    {
+        // Bytes the sparse inner nodes save over sixteen branch slots each
+        auto const inner = SHAMapInnerNode::getCounts ();
+        ret[jss::treenode_inner_count] = std::to_string (inner.nodes);
+        ret[jss::treenode_inner_saved] = std::to_string (inner.bytesSaved ());
+    }
+
+    {
+        // Bytes the node objects and map items save by holding their data
+        // in the same heap block
+        auto const inlined = InlineCounts::get ();
+        ret[jss::inline_count] = std::to_string (inlined.objects);
+        ret[jss::inline_saved] = std::to_string (inlined.bytesSaved ());
+    }
+
+    {
+        Json::Value& memory = (ret[jss::memory_bytes] = Json::objectValue);
+        for (auto const& tag : MemoryTag::getBytes ())
+            memory[tag.first] = std::to_string (tag.second);
+    }
+
     std::string uptime;
     int s = UptimeTimer::getInstance ().getElapsedSeconds ();
     ret[jss::uptime] = s;
@@ -121,6 +226,7 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::uptime_human] = uptime;
 
     ret[jss::node_writes] = context.app.getNodeStore().getStoreCount();
+    ret[jss::node_writes_skipped] = context.app.getNodeStore().getStoreSkipCount();
     ret[jss::node_reads_total] = context.app.getNodeStore().getFetchTotalCount();
     ret[jss::node_reads_hit] = context.app.getNodeStore().getFetchHitCount();
     ret[jss::node_written_bytes] = context.app.getNodeStore().getStoreSize();
@@ -20,6 +20,8 @@
 #ifndef RIPPLE_RPC_HANDLERS_HANDLERS_H_INCLUDED
 #define RIPPLE_RPC_HANDLERS_HANDLERS_H_INCLUDED
 
+#include <ripple/rpc/handlers/AccountBatch.h>
+#include <ripple/rpc/handlers/LedgerData.h>
 #include <ripple/rpc/handlers/LedgerHandler.h>
 
 namespace ripple {
@@ -30,6 +32,7 @@ Json::Value doAccountInfo           (RPC::Context&);
 Json::Value doAccountLines          (RPC::Context&);
 Json::Value doAccountObjects        (RPC::Context&);
 Json::Value doAccountOffers         (RPC::Context&);
+Json::Value doAccountReferrals      (RPC::Context&);
 Json::Value doAccountTx             (RPC::Context&);
 Json::Value doAccountTxOld          (RPC::Context&);
 Json::Value doAccountTxSwitch       (RPC::Context&);
@@ -49,10 +52,11 @@ Json::Value doLedgerAccept          (RPC::Context&);
 Json::Value doLedgerCleaner         (RPC::Context&);
 Json::Value doLedgerClosed          (RPC::Context&);
 Json::Value doLedgerCurrent         (RPC::Context&);
-Json::Value doLedgerData            (RPC::Context&);
 Json::Value doLedgerEntry           (RPC::Context&);
 Json::Value doLedgerHeader          (RPC::Context&);
 Json::Value doLedgerRequest         (RPC::Context&);
+Json::Value doLedgerSnapshot        (RPC::Context&);
+Json::Value doLedgerTimings         (RPC::Context&);
 Json::Value doLogLevel              (RPC::Context&);
 Json::Value doLogRotate             (RPC::Context&);
 Json::Value doLoadDividend          (RPC::Context&);    // load dividend dump
@@ -62,8 +66,10 @@ Json::Value doPathFind              (RPC::Context&);
 Json::Value doPeers                 (RPC::Context&);
 Json::Value doPing                  (RPC::Context&);
 Json::Value doPrint                 (RPC::Context&);
+Json::Value doProfile               (RPC::Context&);
 Json::Value doRandom                (RPC::Context&);
 Json::Value doRipplePathFind        (RPC::Context&);
+Json::Value doRPCStats              (RPC::Context&);
 Json::Value doServerInfo            (RPC::Context&); // for humans
 Json::Value doServerState           (RPC::Context&); // for machines
 Json::Value doSessionClose          (RPC::Context&);
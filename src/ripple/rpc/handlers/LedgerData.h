@@ -0,0 +1,148 @@
+#ifndef RIPPLE_RPC_HANDLERS_LEDGERDATA_H_INCLUDED
+#define RIPPLE_RPC_HANDLERS_LEDGERDATA_H_INCLUDED
+
+#include <ripple/app/ledger/LedgerToJson.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/json/Object.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/LedgerDataCursors.h>
+#include <ripple/rpc/Status.h>
+#include <ripple/rpc/impl/Handler.h>
+#include <ripple/server/Role.h>
+#include <boost/optional.hpp>
+
+namespace ripple {
+namespace RPC {
+
+struct Context;
+
+// Get state nodes from a ledger
+//   Inputs:
+//     limit:        integer, maximum number of entries
+//     marker:       opaque, resume point
+//     binary:       boolean, format
+//     cursor:       true to get a cursor, or the cursor of the last page
+//   Outputs:
+//     ledger_hash:  chosen ledger's hash
+//     ledger_index: chosen ledger's index
+//     state:        array of state nodes
+//     marker:       resume point, if any
+//     cursor:       opaque, resume point kept by the server, if asked for
+//
+// With the cursor of the last page, the next page is read from the same
+// ledger, starting where the last page stopped, and the nodes after it
+// are read ahead. The marker must be given as well, since the server may
+// have dropped the cursor.
+class LedgerDataHandler {
+public:
+    explicit LedgerDataHandler (Context&);
+
+    Status check ();
+
+    template <class Object>
+    void writeResult (Object&);
+
+    static const char* const name()
+    {
+        return "ledger_data";
+    }
+
+    static Role role()
+    {
+        return Role::USER;
+    }
+
+    static Condition condition()
+    {
+        return NO_CONDITION;
+    }
+
+private:
+    Context& context_;
+    std::shared_ptr<ReadView const> ledger_;
+    Json::Value result_;
+    ReadView::key_type key_;
+    bool isBinary_ = false;
+    int limit_ = -1;
+    bool wantCursor_ = false;
+    std::unique_ptr<LedgerDataCursors::Cursor> cursor_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+//
+// Implementation.
+
+template <class Object>
+void LedgerDataHandler::writeResult (Object& value)
+{
+    Json::copyFrom (value, result_);
+
+    // The entries are written one at a time, so a streaming Object never
+    // holds more than one of them.
+    boost::optional<ReadView::key_type> marker;
+    ReadView::sles_type::iterator next;
+    {
+        auto&& nodes = Json::setArray (value, jss::state);
+        auto limit = limit_;
+        auto e = ledger_->sles.end();
+
+        // The cursor is only used for the page after the one it came with
+        auto i = (cursor_ && cursor_->marker == key_) ?
+            std::move (cursor_->next) : ledger_->sles.upper_bound (key_);
+        for (; i != e; ++i)
+        {
+            auto const& sle = *i;
+            if (limit-- <= 0)
+            {
+                // Stop processing before the current key.
+                auto k = sle->key();
+                marker = --k;
+                next = std::move (i);
+                break;
+            }
+
+            if (isBinary_)
+            {
+                auto&& entry = Json::appendObject (nodes);
+                entry[jss::data] = serializeHex (*sle);
+                entry[jss::index] = to_string (sle->key());
+            }
+            else
+            {
+                auto json = sle->getJson (0);
+                json[jss::index] = to_string (sle->key());
+                nodes.append (json);
+            }
+        }
+    }
+
+    if (marker)
+    {
+        value[jss::marker] = to_string (*marker);
+
+        if (wantCursor_)
+        {
+            auto& cursors = context_.app.getLedgerDataCursors ();
+            if (! cursor_)
+                cursor_ = cursors.open (ledger_,
+                    result_[jss::validated].asBool ());
+
+            // Read ahead about a page while the client handles this one
+            next.prefetch (limit_);
+
+            cursor_->next = std::move (next);
+            cursor_->marker = *marker;
+            value[jss::cursor] = cursor_->token;
+            cursors.keep (std::move (cursor_));
+        }
+    }
+}
+
+} // RPC
+} // ripple
+
+#endif
@@ -0,0 +1,58 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerSnapshot.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/LookupLedger.h>
+
+namespace ripple {
+
+// Write the state map of a validated ledger to a snapshot, on a job.
+// {
+//   ledger_hash : <ledger>
+//   ledger_index : <ledger_index>
+// }
+Json::Value doLedgerSnapshot (RPC::Context& context)
+{
+    auto& app = context.app;
+    if (!app.getLedgerSnapshots ().enabled ())
+        return rpcError (rpcNOT_ENABLED);
+
+    std::shared_ptr<ReadView const> view;
+    auto result = RPC::lookupLedger (view, context);
+    if (!view)
+        return result;
+
+    if (!result[jss::validated].asBool ())
+        return RPC::make_param_error ("Ledger is not validated.");
+
+    auto const ledger = context.ledgerMaster.getLedgerByHash (
+        view->info ().hash);
+    if (!ledger)
+        return rpcError (rpcLGR_NOT_FOUND);
+
+    app.getJobQueue ().addJob (jtADMIN, "LedgerSnapshot",
+        [&app, ledger] (Job&)
+        {
+            try
+            {
+                app.getLedgerSnapshots ().add (*ledger);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG (app.journal ("LedgerSnapshots").warning)
+                    << "Snapshot of ledger " << ledger->info ().seq
+                    << " failed: " << e.what ();
+            }
+        });
+
+    result[jss::message] = "Snapshot started";
+    return result;
+}
+
+} // ripple
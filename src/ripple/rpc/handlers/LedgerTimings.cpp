@@ -0,0 +1,32 @@
+#include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerCloseTimings.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/main/Tuning.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+
+// Where the time went while closing the newest ledgers.
+// {
+//   limit: <number of ledgers>
+// }
+Json::Value doLedgerTimings (RPC::Context& context)
+{
+    std::size_t limit = ledgerCloseTimingsSize;
+    if (context.params.isMember (jss::limit))
+    {
+        auto const& value = context.params[jss::limit];
+        if (! value.isIntegral () || value.asInt () < 0)
+            return RPC::expected_field_error (jss::limit, "unsigned integer");
+        limit = value.asUInt ();
+    }
+
+    Json::Value ret (Json::objectValue);
+    ret[jss::ledgers] = context.app.getLedgerCloseTimings ().getJson (limit);
+    return ret;
+}
+
+} // ripple
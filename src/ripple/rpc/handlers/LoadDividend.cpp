@@ -2,6 +2,7 @@
 #include <iostream>
 #include <stdio.h>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <ripple/app/misc/DividendMaster.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/json/json_reader.h>
@@ -32,6 +33,30 @@ Json::Value doLoadDividend (RPC::Context &context)
     }
 
     auto& dm = context.app.getDividendMaster ();
+
+    // Rebuild the dividend and list where it differs from the map of the
+    // hash, nothing is saved or launched.
+    if (context.params.isMember (jss::verify) &&
+        context.params[jss::verify].asBool ())
+    {
+        if (hash.empty ())
+            return RPC::missing_field_error (jss::hash);
+
+        std::size_t limit = 256;
+        if (context.params.isMember (jss::limit))
+            limit = std::max (1u, context.params[jss::limit].asUInt ());
+
+        if (!dm.calcDividend (ledgerIndex))
+            return RPC::make_error (rpcINTERNAL, "Failed to calculate dividend.");
+
+        auto const ret = dm.verifyTransactionMap (ledgerIndex, hash, limit);
+        if (!ret.first)
+            return RPC::make_error (rpcINTERNAL,
+                ret.second[jss::error_message].asString ());
+        jvResult = ret.second;
+        jvResult[jss::ledger_index] = ledgerIndex;
+        return jvResult;
+    }
     
     if (!hash.empty())
     {
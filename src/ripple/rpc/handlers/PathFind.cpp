@@ -53,7 +53,7 @@ Json::Value doPathFind (RPC::Context& context)
         context.loadType = Resource::feeHighBurdenRPC;
         context.infoSub->clearPathRequest ();
         return context.app.getPathRequests().makePathRequest (
-            context.infoSub, lpLedger, context.params);
+            context.infoSub, lpLedger, context.params, context.role);
     }
 
     if (sSubCommand == "close")
@@ -0,0 +1,70 @@
+#include <BeastConfig.h>
+#include <ripple/core/Profiler.h>
+#include <ripple/json/json_value.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/Handler.h>
+
+namespace ripple {
+
+// Start or stop the sampling profiler, or report on it.
+// {
+//   action : "start" | "stop" | "status"  // optional, defaults to status
+//   frequency : <number>  // optional, samples per second, defaults to 99
+// }
+Json::Value doProfile (RPC::Context& context)
+{
+    auto& profiler = Profiler::getInstance ();
+    auto const action = context.params.isMember (jss::action) ?
+        context.params[jss::action].asString () : std::string ("status");
+
+    Json::Value ret (Json::objectValue);
+    if (action == "start")
+    {
+        int frequency = 99;
+        if (context.params.isMember (jss::frequency))
+        {
+            if (! context.params[jss::frequency].isIntegral ())
+                return RPC::expected_field_error (jss::frequency, "integer");
+            frequency = context.params[jss::frequency].asInt ();
+            if (frequency < 1 || frequency > 1000)
+                return RPC::make_param_error (
+                    "frequency must be from 1 to 1000.");
+        }
+
+        if (profiler.status ().running)
+            return RPC::make_param_error ("The profiler is running.");
+        if (! profiler.start (frequency))
+            return rpcError (rpcNOT_SUPPORTED);
+        ret[jss::message] = "Profiler started";
+        return ret;
+    }
+
+    if (action == "stop")
+    {
+        if (! profiler.status ().running)
+            return RPC::make_param_error ("The profiler is not running.");
+        auto const report = profiler.stop ();
+        ret[jss::samples] = std::to_string (report.status.samples);
+        ret[jss::dropped] = std::to_string (report.status.dropped);
+        ret[jss::folded] = report.folded;
+        return ret;
+    }
+
+    if (action != "status")
+        return RPC::invalid_field_error (jss::action);
+
+    auto const status = profiler.status ();
+    ret[jss::running] = status.running;
+    if (status.running)
+    {
+        ret[jss::frequency] = status.frequency;
+        ret[jss::samples] = std::to_string (status.samples);
+        ret[jss::dropped] = std::to_string (status.dropped);
+    }
+    return ret;
+}
+
+} // ripple
@@ -0,0 +1,17 @@
+#include <BeastConfig.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/json/json_value.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/RPCStats.h>
+
+namespace ripple {
+
+// The calls, failures, stage times and reply sizes of every method called.
+// {
+// }
+Json::Value doRPCStats (RPC::Context& context)
+{
+    return context.app.getRPCStats ().getJson ();
+}
+
+} // ripple
@@ -106,7 +106,7 @@ Json::Value doRipplePathFind (RPC::Context& context)
 
         jvResult = context.app.getPathRequests().makeLegacyPathRequest (
             request, std::bind(&JobCoro::post, context.jobCoro),
-                lpLedger, context.params);
+                lpLedger, context.params, context.role);
         if (request)
         {
             context.jobCoro->yield();
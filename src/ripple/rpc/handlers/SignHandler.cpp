@@ -23,11 +23,12 @@
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/impl/TransactionSign.h>
+#include <algorithm>
 
 namespace ripple {
 
 // {
-//   tx_json: <object>,
+//   tx_json: <object> or [<object>, ...],
 //   secret: <secret>
 // }
 Json::Value doSign (RPC::Context& context)
@@ -38,6 +39,25 @@ Json::Value doSign (RPC::Context& context)
             context.params.isMember (jss::fail_hard)
             && context.params[jss::fail_hard].asBool ());
 
+    if (context.params.isMember (jss::tx_json) &&
+        context.params[jss::tx_json].isArray ())
+    {
+        // Each transaction of a batch is charged as a signing
+        context.loadType = Resource::Charge (
+            Resource::feeHighBurdenRPC.cost () *
+                std::max (1u, context.params[jss::tx_json].size ()),
+                    "batch sign");
+
+        return RPC::transactionBatch (
+            context.params,
+            failType,
+            context.role,
+            context.ledgerMaster.getValidatedLedgerAge(),
+            context.app,
+            context.ledgerMaster.getCurrentLedger(),
+            RPC::ProcessTransactionFn ());
+    }
+
     return RPC::transactionSign (
         context.params,
         failType,
@@ -27,6 +27,7 @@
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/impl/TransactionSign.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -38,7 +39,7 @@ static NetworkOPs::FailHard getFailHard (RPC::Context const& context)
 }
 
 // {
-//   tx_json: <object>,
+//   tx_json: <object> or [<object>, ...],
 //   secret: <secret>
 // }
 Json::Value doSubmit (RPC::Context& context)
@@ -49,6 +50,25 @@ Json::Value doSubmit (RPC::Context& context)
     {
         auto const failType = getFailHard (context);
 
+        if (context.params.isMember (jss::tx_json) &&
+            context.params[jss::tx_json].isArray ())
+        {
+            // Each transaction of a batch is charged as a submission
+            context.loadType = Resource::Charge (
+                Resource::feeMediumBurdenRPC.cost () *
+                    std::max (1u, context.params[jss::tx_json].size ()),
+                        "batch submit");
+
+            return RPC::transactionBatch (
+                context.params,
+                failType,
+                context.role,
+                context.ledgerMaster.getValidatedLedgerAge(),
+                context.app,
+                context.ledgerMaster.getCurrentLedger(),
+                RPC::getProcessTxnFn (context.netOps));
+        }
+
         return RPC::transactionSubmit (
         context.params,
         failType,
@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/basics/Log.h>
@@ -74,9 +75,31 @@ Json::Value doSubscribe (RPC::Context& context)
             JLOG (context.j.debug)
                 << "doSubscribe: building: " << strUrl;
 
+            RPCSubOptions options;
+
+            if (context.params.isMember (jss::url_batch))
+            {
+                auto const& batch = context.params[jss::url_batch];
+                if (! batch.isConvertibleTo (Json::uintValue) ||
+                        batch.asUInt () < 1 || batch.asUInt () > 1000)
+                    return rpcError (rpcINVALID_PARAMS);
+                options.batch = batch.asUInt ();
+            }
+
+            if (context.params.isMember (jss::url_connections))
+            {
+                auto const& connections = context.params[jss::url_connections];
+                if (! connections.isConvertibleTo (Json::uintValue) ||
+                        connections.asUInt () < 1 || connections.asUInt () > 64)
+                    return rpcError (rpcINVALID_PARAMS);
+                options.connections = connections.asUInt ();
+            }
+
             auto rspSub = make_RPCSub (context.app.getOPs (),
                 context.app.getIOService (), context.app.getJobQueue (),
-                    strUrl, strUsername, strPassword, context.app.logs ());
+                    strUrl, strUsername, strPassword, options,
+                        context.app.getCollectorManager ().collector (),
+                            context.app.logs ());
             ispSub  = context.netOps.addRpcSub (
                 strUrl, std::dynamic_pointer_cast<InfoSub> (rspSub));
         }
@@ -103,6 +126,15 @@ Json::Value doSubscribe (RPC::Context& context)
         ispSub  = context.infoSub;
     }
 
+    if (context.params.isMember (jss::binary))
+    {
+        // Binary messages can only be sent over a websocket
+        if (! context.params[jss::binary].isBool () || ! context.infoSub)
+            return rpcError (rpcINVALID_PARAMS);
+
+        ispSub->setBinary (context.params[jss::binary].asBool ());
+    }
+
     if (!context.params.isMember (jss::streams))
     {
     }
@@ -132,6 +164,7 @@ Json::Value doSubscribe (RPC::Context& context)
                 }
                 else if (streamName == "transactions")
                 {
+                    ispSub->setTrace (context.role == Role::ADMIN);
                     context.netOps.subTransactions (ispSub);
                 }
                 else if (streamName == "transactions_proposed"
@@ -150,6 +183,14 @@ Json::Value doSubscribe (RPC::Context& context)
                     else
                         context.netOps.subPeerStatus (ispSub);
                 }
+                else if (streamName == "dividend")
+                {
+                    context.netOps.subDividend (ispSub);
+                }
+                else if (streamName == "fee")
+                {
+                    context.netOps.subFee (ispSub, jvResult);
+                }
                 else
                 {
                     jvResult[jss::error]   = "unknownStream";
@@ -27,6 +27,7 @@
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/AwaitIO.h>
 #include <ripple/rpc/impl/Utilities.h>
 
 namespace ripple {
@@ -97,8 +98,14 @@ Json::Value doTx (RPC::Context& context)
     if (!isHexTxID (txid))
         return rpcError (rpcNOT_IMPL);
 
-    auto txn = context.app.getMasterTransaction ().fetch (
-        from_hex_text<uint256>(txid), true);
+    // Only wait on the database if the transaction is not cached
+    auto const hash = from_hex_text<uint256>(txid);
+    auto txn = context.app.getMasterTransaction ().fetch (hash, false);
+    if (!txn)
+        txn = RPC::awaitIO (context, [&]
+            {
+                return context.app.getMasterTransaction ().fetch (hash, true);
+            });
 
     if (!txn)
         return rpcError (rpcTXN_NOT_FOUND);
@@ -108,7 +115,11 @@ Json::Value doTx (RPC::Context& context)
     if (txn->getLedger () == 0)
         return ret;
 
-    if (auto lgr = context.ledgerMaster.getLedgerBySeq (txn->getLedger ()))
+    auto const lgr = RPC::awaitIO (context, [&]
+        {
+            return context.ledgerMaster.getLedgerBySeq (txn->getLedger ());
+        });
+    if (lgr)
     {
         bool okay = false;
 
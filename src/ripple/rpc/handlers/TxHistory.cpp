@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/core/DatabaseCon.h>
@@ -27,79 +28,185 @@
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/TxHistoryIndex.h>
+#include <ripple/rpc/impl/AwaitIO.h>
 #include <ripple/server/Role.h>
 #include <boost/format.hpp>
 
 namespace ripple {
 
+namespace {
+
+// Transactions in each page
+unsigned int const txHistoryPageSize = 20;
+
+std::vector<TxHistoryIndex::Key>
+loadHistoryKeys (soci::session& db, std::size_t count)
+{
+    std::vector<TxHistoryIndex::Key> keys;
+    keys.reserve (count);
+
+    boost::optional<std::uint64_t> ledgerSeq;
+    boost::optional<std::string> txID;
+    soci::statement st = (db.prepare <<
+        boost::str (boost::format (
+            "SELECT LedgerSeq, TransID FROM Transactions "
+            "ORDER BY LedgerSeq DESC, TransID DESC LIMIT %u;") % count),
+        soci::into (ledgerSeq),
+        soci::into (txID));
+
+    st.execute ();
+    while (st.fetch ())
+    {
+        TxHistoryIndex::Key key;
+        if (! ledgerSeq || ! txID || ! key.txID.SetHexExact (*txID))
+            continue;
+        key.ledgerSeq = static_cast<std::uint32_t> (*ledgerSeq);
+        keys.push_back (key);
+    }
+    return keys;
+}
+
+} // namespace
+
 // {
 //   start: <index>
+//   marker: <opaque> // optional, resume after the last page instead
 // }
 Json::Value doTxHistory (RPC::Context& context)
 {
     context.loadType = Resource::feeMediumBurdenRPC;
 
-    if (!context.params.isMember (jss::start))
+    auto const& params = context.params;
+    bool const hasMarker = params.isMember (jss::marker);
+    if (! hasMarker && ! params.isMember (jss::start))
         return rpcError (rpcINVALID_PARAMS);
 
-    unsigned int startIndex = context.params[jss::start].asUInt ();
-
-    if ((startIndex > 10000) &&  (! isUnlimited (context.role)))
-        return rpcError (rpcNO_PERMISSION);
+    // The page starts after the key of a marker, or at the key of the
+    // transaction at start. Either is read through the ledger and ID
+    // index without skipping the transactions before it.
+    boost::optional<TxHistoryIndex::Key> from;
+    bool inclusive = true;
+    unsigned int startIndex = 0;
 
     Json::Value obj;
-    Json::Value txs;
 
-    obj[jss::index] = startIndex;
+    if (hasMarker)
+    {
+        auto const& marker = params[jss::marker];
+        TxHistoryIndex::Key key;
+        if (! marker.isObject () ||
+            ! marker[jss::ledger].isIntegral () ||
+            ! marker[jss::tx_hash].isString () ||
+            ! key.txID.SetHexExact (marker[jss::tx_hash].asString ()))
+        {
+            return RPC::invalid_field_error (jss::marker);
+        }
+        key.ledgerSeq = marker[jss::ledger].asUInt ();
+        from = key;
+        inclusive = false;
+    }
+    else
+    {
+        startIndex = params[jss::start].asUInt ();
+
+        if ((startIndex > 10000) &&  (! isUnlimited (context.role)))
+            return rpcError (rpcNO_PERMISSION);
 
-    std::string sql =
-        boost::str (boost::format (
-            "SELECT LedgerSeq, Status, RawTxn "
-            "FROM Transactions ORDER BY LedgerSeq desc LIMIT %u,20;")
-                    % startIndex);
+        obj[jss::index] = startIndex;
+    }
 
-    {
-        bool isMySQL = context.app.getTxnDB ().getType () == DatabaseCon::Type::MySQL;
-        
-        auto db = context.app.getTxnDB ().checkoutDb ();
-
-        boost::optional<std::uint64_t> ledgerSeq;
-        boost::optional<std::string> status;
-        boost::optional<std::string> sociRawTxnStr;
-        std::unique_ptr<soci::blob> sociRawTxnBlob (isMySQL ? nullptr : new soci::blob (*db));
-        soci::indicator rti;
-        Blob rawTxn;
-
-        soci::statement st = isMySQL ?
-                                 (db->prepare << sql,
-                                  soci::into (ledgerSeq),
-                                  soci::into (status),
-                                  soci::into (sociRawTxnStr, rti)) :
-                                 (db->prepare << sql,
-                                  soci::into (ledgerSeq),
-                                  soci::into (status),
-                                  soci::into (*sociRawTxnBlob, rti));
-
-        st.execute ();
-        while (st.fetch ())
+    auto const validated = context.ledgerMaster.getValidLedgerIndex ();
+
+    Json::Value next;
+    auto txs = RPC::awaitIO (context, [&]
         {
-            if (soci::i_ok == rti)
+            Json::Value result;
+            bool isMySQL = context.app.getTxnDB ().getType () == DatabaseCon::Type::MySQL;
+
+            auto db = context.app.getTxnDB ().checkoutReadDb ();
+
+            if (! hasMarker)
+            {
+                from = context.app.getTxHistoryIndex ().find (
+                    startIndex, validated, [&] (std::size_t count)
+                    {
+                        return loadHistoryKeys (*db, count);
+                    });
+            }
+
+            // Only unlimited clients can start past the indexed keys
+            std::string sql = from ?
+                boost::str (boost::format (
+                    "SELECT LedgerSeq, TransID, Status, RawTxn "
+                    "FROM Transactions WHERE LedgerSeq <= %u AND "
+                    "(LedgerSeq < %u OR TransID %s '%s') "
+                    "ORDER BY LedgerSeq DESC, TransID DESC LIMIT %u;")
+                        % from->ledgerSeq % from->ledgerSeq
+                        % (inclusive ? "<=" : "<") % to_string (from->txID)
+                        % txHistoryPageSize) :
+                boost::str (boost::format (
+                    "SELECT LedgerSeq, TransID, Status, RawTxn "
+                    "FROM Transactions ORDER BY LedgerSeq DESC, TransID DESC "
+                    "LIMIT %u,%u;")
+                        % startIndex % txHistoryPageSize);
+
+            boost::optional<std::uint64_t> ledgerSeq;
+            boost::optional<std::string> txID;
+            boost::optional<std::string> status;
+            boost::optional<std::string> sociRawTxnStr;
+            std::unique_ptr<soci::blob> sociRawTxnBlob (isMySQL ? nullptr : new soci::blob (*db));
+            soci::indicator rti;
+            Blob rawTxn;
+
+            soci::statement st = isMySQL ?
+                                     (db->prepare << sql,
+                                      soci::into (ledgerSeq),
+                                      soci::into (txID),
+                                      soci::into (status),
+                                      soci::into (sociRawTxnStr, rti)) :
+                                     (db->prepare << sql,
+                                      soci::into (ledgerSeq),
+                                      soci::into (txID),
+                                      soci::into (status),
+                                      soci::into (*sociRawTxnBlob, rti));
+
+            unsigned int rows = 0;
+            st.execute ();
+            while (st.fetch ())
             {
-                if (isMySQL)
-                    rawTxn.assign (sociRawTxnStr->begin (), sociRawTxnStr->end ());
+                ++rows;
+                if (ledgerSeq && txID)
+                {
+                    next = Json::objectValue;
+                    next[jss::ledger] = static_cast<Json::UInt> (*ledgerSeq);
+                    next[jss::tx_hash] = *txID;
+                }
+
+                if (soci::i_ok == rti)
+                {
+                    if (isMySQL)
+                        rawTxn.assign (sociRawTxnStr->begin (), sociRawTxnStr->end ());
+                    else
+                        convert (*sociRawTxnBlob, rawTxn);
+                }
                 else
-                    convert (*sociRawTxnBlob, rawTxn);
+                    rawTxn.clear ();
+
+                if (auto trans = Transaction::transactionFromSQL (
+                        ledgerSeq, status, rawTxn, context.app))
+                    result.append (trans->getJson (0));
             }
-            else
-                rawTxn.clear ();
 
-            if (auto trans = Transaction::transactionFromSQL (
-                    ledgerSeq, status, rawTxn, context.app))
-                txs.append (trans->getJson (0));
-        }
-    }
+            // A short page is the last one
+            if (rows < txHistoryPageSize)
+                next = Json::nullValue;
+            return result;
+        });
 
     obj[jss::txs] = txs;
+    if (! next.isNull ())
+        obj[jss::marker] = next;
 
     return obj;
 }
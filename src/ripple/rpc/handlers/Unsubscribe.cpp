@@ -86,6 +86,12 @@ Json::Value doUnsubscribe (RPC::Context& context)
                 else if (streamName == "peer_status")
                     context.netOps.unsubPeerStatus (ispSub->getSeq ());
 
+                else if (streamName == "dividend")
+                    context.netOps.unsubDividend (ispSub->getSeq ());
+
+                else if (streamName == "fee")
+                    context.netOps.unsubFee (ispSub->getSeq ());
+
                 else
                     jvResult[jss::error] = "Unknown stream: " + streamName;
             }
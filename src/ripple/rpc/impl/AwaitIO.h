@@ -0,0 +1,30 @@
+#ifndef RIPPLE_RPC_IMPL_AWAITIO_H_INCLUDED
+#define RIPPLE_RPC_IMPL_AWAITIO_H_INCLUDED
+
+#include <ripple/core/JobQueue.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+namespace RPC {
+
+/** Run a function which waits on the databases.
+
+    A command running in a coroutine is suspended while the function runs
+    as a clientIO job. Its job thread is free for other clients meanwhile,
+    and the number of threads waiting on reads stays bounded however many
+    clients are waiting. Without a coroutine the function is just called.
+*/
+template <class F>
+auto
+awaitIO (Context& context, F&& f) -> decltype (f ())
+{
+    if (! context.jobCoro)
+        return f ();
+    return context.jobCoro->await (jtCLIENT_IO, "clientIO",
+        std::forward<F> (f));
+}
+
+} // RPC
+} // ripple
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <ripple/rpc/impl/GetAccountObjects.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/ledger/View.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/JsonFields.h>
 
@@ -47,6 +48,8 @@ getAccountObjects (ReadView const& ledger, AccountID const& account,
     auto& jvObjects = jvResult[jss::account_objects];
     for (;;)
     {
+        prefetchDirPage (ledger, keylet::page (rootDirIndex), *dir);
+
         auto const& entries = dir->getFieldV256 (sfIndexes);
         auto iter = entries.begin ();
 
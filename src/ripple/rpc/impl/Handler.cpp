@@ -69,6 +69,9 @@ class HandlerTable {
     }
 
         // This is where the new-style handlers are added.
+        addHandler<AccountInfoBatchHandler>();
+        addHandler<AccountLinesBatchHandler>();
+        addHandler<LedgerDataHandler>();
         addHandler<LedgerHandler>();
         addHandler<VersionHandler>();
     }
@@ -107,6 +110,7 @@ Handler handlerArray[] {
     {   "account_lines",        byRef (&doAccountLines),        Role::USER,  NO_CONDITION  },
     {   "account_objects",      byRef (&doAccountObjects),      Role::USER,  NO_CONDITION  },
     {   "account_offers",       byRef (&doAccountOffers),       Role::USER,  NO_CONDITION  },
+    {   "account_referrals",    byRef (&doAccountReferrals),    Role::USER,  NO_CONDITION  },
     {   "account_tx",           byRef (&doAccountTxSwitch),     Role::USER,  NO_CONDITION  },
     {   "ancestors",            byRef (&doAncestors),           Role::USER,  NEEDS_NETWORK_CONNECTION },
     {   "blacklist",            byRef (&doBlackList),           Role::ADMIN,   NO_CONDITION     },
@@ -125,10 +129,11 @@ Handler handlerArray[] {
     {   "ledger_cleaner",       byRef (&doLedgerCleaner),       Role::ADMIN,   NEEDS_NETWORK_CONNECTION  },
     {   "ledger_closed",        byRef (&doLedgerClosed),        Role::USER,  NO_CONDITION   },
     {   "ledger_current",       byRef (&doLedgerCurrent),       Role::USER,  NEEDS_CURRENT_LEDGER  },
-    {   "ledger_data",          byRef (&doLedgerData),          Role::USER,  NO_CONDITION  },
     {   "ledger_entry",         byRef (&doLedgerEntry),         Role::USER,  NO_CONDITION  },
     {   "ledger_header",        byRef (&doLedgerHeader),        Role::USER,  NO_CONDITION  },
     {   "ledger_request",       byRef (&doLedgerRequest),       Role::ADMIN,   NO_CONDITION     },
+    {   "ledger_snapshot",      byRef (&doLedgerSnapshot),      Role::ADMIN,   NO_CONDITION     },
+    {   "ledger_timings",       byRef (&doLedgerTimings),       Role::ADMIN,   NO_CONDITION     },
     {   "load_dividend",        byRef (&doLoadDividend),        Role::ADMIN, NEEDS_CURRENT_LEDGER  },
     {   "log_level",            byRef (&doLogLevel),            Role::ADMIN,   NO_CONDITION     },
     {   "logrotate",            byRef (&doLogRotate),           Role::ADMIN,   NO_CONDITION     },
@@ -138,9 +143,10 @@ Handler handlerArray[] {
     {   "peers",                byRef (&doPeers),               Role::ADMIN,   NO_CONDITION     },
     {   "ping",                 byRef (&doPing),                Role::USER,    NO_CONDITION     },
     {   "print",                byRef (&doPrint),               Role::ADMIN,   NO_CONDITION     },
-//      {   "profile",              byRef (&doProfile),             Role::USER,  NEEDS_CURRENT_LEDGER  },
+    {   "profile",              byRef (&doProfile),             Role::ADMIN,   NO_CONDITION     },
     {   "random",               byRef (&doRandom),              Role::USER,  NO_CONDITION     },
     {   "ripple_path_find",     byRef (&doRipplePathFind),      Role::USER,  NO_CONDITION  },
+    {   "rpc_stats",            byRef (&doRPCStats),            Role::ADMIN,   NO_CONDITION     },
     {   "sign",                 byRef (&doSign),                Role::USER,  NO_CONDITION     },
     {   "sign_for",             byRef (&doSignFor),             Role::USER,  NO_CONDITION     },
     {   "submit",               byRef (&doSubmit),              Role::USER,  NEEDS_CURRENT_LEDGER  },
@@ -0,0 +1,97 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/LedgerDataCursors.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/crypto/RandomNumbers.h>
+#include <algorithm>
+
+namespace ripple {
+
+LedgerDataCursors::LedgerDataCursors (Stopwatch& clock,
+        std::size_t maxCursors, std::chrono::seconds timeout)
+    : clock_ (clock)
+    , maxCursors_ (maxCursors)
+    , timeout_ (timeout)
+{
+}
+
+std::unique_ptr<LedgerDataCursors::Cursor>
+LedgerDataCursors::open (std::shared_ptr<ReadView const> ledger,
+    bool validated)
+{
+    // The token is random, so one client can not take another's cursor
+    uint128 token;
+    random_fill (token.data (), token.size ());
+
+    auto cursor = std::make_unique<Cursor> ();
+    cursor->token = to_string (token);
+    cursor->ledger = std::move (ledger);
+    cursor->validated = validated;
+    return cursor;
+}
+
+std::unique_ptr<LedgerDataCursors::Cursor>
+LedgerDataCursors::take (std::string const& token)
+{
+    std::unique_ptr<Cursor> cursor;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        expire (lock);
+
+        auto const iter = cursors_.find (token);
+        if (iter == cursors_.end ())
+            return nullptr;
+
+        cursor = std::move (iter->second);
+        cursors_.erase (iter);
+    }
+    return cursor;
+}
+
+void
+LedgerDataCursors::keep (std::unique_ptr<Cursor> cursor)
+{
+    // An evicted cursor releases its ledger outside the lock
+    std::unique_ptr<Cursor> dropped;
+
+    cursor->used = clock_.now ();
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    expire (lock);
+
+    if (cursors_.size () >= maxCursors_)
+    {
+        auto const oldest = std::min_element (
+            cursors_.begin (), cursors_.end (),
+            [](auto const& a, auto const& b)
+            {
+                return a.second->used < b.second->used;
+            });
+        dropped = std::move (oldest->second);
+        cursors_.erase (oldest);
+    }
+
+    auto const token = cursor->token;
+    cursors_[token] = std::move (cursor);
+}
+
+std::size_t
+LedgerDataCursors::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return cursors_.size ();
+}
+
+void
+LedgerDataCursors::expire (std::lock_guard<std::mutex> const&)
+{
+    auto const now = clock_.now ();
+    for (auto iter = cursors_.begin (); iter != cursors_.end ();)
+    {
+        if (now - iter->second->used > timeout_)
+            iter = cursors_.erase (iter);
+        else
+            ++iter;
+    }
+}
+
+} // ripple
@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerSnapshot.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
@@ -230,6 +231,13 @@ Status lookupLedger (
     }
 
     result[jss::validated] = isValidated (context.ledgerMaster, *ledger, context.app);
+
+    // The state of a validated ledger with a snapshot is read from it
+    if (result[jss::validated].asBool ())
+    {
+        if (auto view = context.app.getLedgerSnapshots ().view (ledger))
+            ledger = std::move (view);
+    }
     return Status::OK;
 }
 
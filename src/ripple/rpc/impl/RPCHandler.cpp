@@ -20,6 +20,7 @@
 #include <BeastConfig.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/rpc/RPCHandler.h>
+#include <ripple/rpc/RPCStats.h>
 #include <ripple/rpc/impl/Tuning.h>
 #include <ripple/rpc/impl/Handler.h>
 #include <ripple/app/main/Application.h>
@@ -30,6 +31,7 @@
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/json/Object.h>
+#include <ripple/json/Output.h>
 #include <ripple/json/to_string.h>
 #include <ripple/net/InfoSub.h>
 #include <ripple/net/RPCErr.h>
@@ -180,15 +182,30 @@ error_code_i fillHandler (Context& context,
     return rpcSUCCESS;
 }
 
+// Old-style handlers return their errors in the result
+bool isFailure (Status const& status, Json::Value const& result)
+{
+    return status || result.isMember (jss::error);
+}
+
+template <class Object>
+bool isFailure (Status const& status, Object const&)
+{
+    return bool (status);
+}
+
 template <class Object, class Method>
 Status callMethod (
     Context& context, Method method, std::string const& name, Object& result)
 {
+    using clock_type = std::chrono::steady_clock;
+    auto const start = clock_type::now ();
+    Status status;
     try
     {
         auto v = context.app.getJobQueue().getLoadEventAP(
             jtGENERIC, "cmd:" + name);
-        return method (context, result);
+        status = method (context, result);
     }
     catch (std::exception& e)
     {
@@ -198,8 +215,11 @@ Status callMethod (
             context.loadType = Resource::feeExceptionRPC;
 
         inject_error (rpcINTERNAL, result);
-        return rpcINTERNAL;
+        status = rpcINTERNAL;
     }
+    context.app.getRPCStats ().addCall (
+        name, isFailure (status, result), clock_type::now () - start);
+    return status;
 }
 
 template <class Method, class Object>
@@ -260,24 +280,63 @@ Status doCommand (
 /** Execute an RPC command and store the results in a string. */
 void executeRPC (
     RPC::Context& context, std::string& output)
+{
+    executeRPC (context, Json::stringOutput (output));
+}
+
+/** Execute an RPC command and stream the results to an Output. */
+void executeRPC (
+    RPC::Context& context, Json::Output const& output)
 {
     boost::optional <Handler const&> handler;
     if (auto error = fillHandler (context, handler))
     {
-        auto wo = Json::stringWriterObject (output);
+        Json::WriterObject wo (output);
         auto&& sub = Json::addObject (*wo, jss::result);
         inject_error (error, sub);
+        sub[jss::status] = jss::error;
+        sub[jss::request] = context.params;
     }
     else if (auto method = handler->objectMethod_)
     {
-        auto wo = Json::stringWriterObject (output);
+        Json::WriterObject wo (output);
         getResult (context, method, *wo, handler->name_);
     }
     else if (auto method = handler->valueMethod_)
     {
         auto object = Json::Value (Json::objectValue);
         getResult (context, method, object, handler->name_);
-        output = to_string (object);
+
+        // Handlers which write to a Json::Object are serialized while
+        // they run, so only these have a time for serializing.
+        auto const start = std::chrono::steady_clock::now ();
+        Json::outputJson (object, output);
+        context.app.getRPCStats ().add (handler->name_,
+            RPCStats::Stage::serialize,
+                std::chrono::steady_clock::now () - start);
+    }
+    else
+    {
+        // Can't ever get here.
+        assert (false);
+        Throw<std::logic_error> ("RPC handler with no method");
+    }
+}
+
+Json::Value executeRPC (RPC::Context& context)
+{
+    auto object = Json::Value (Json::objectValue);
+    boost::optional <Handler const&> handler;
+    if (auto error = fillHandler (context, handler))
+    {
+        auto& sub = (object[jss::result] = Json::objectValue);
+        inject_error (error, sub);
+        sub[jss::status] = jss::error;
+        sub[jss::request] = context.params;
+    }
+    else if (auto method = handler->valueMethod_)
+    {
+        getResult (context, method, object, handler->name_);
     }
     else
     {
@@ -285,6 +344,7 @@ void executeRPC (
         assert (false);
         Throw<std::logic_error> ("RPC handler with no method");
     }
+    return object;
 }
 
 Role roleRequired (std::string const& method)
@@ -0,0 +1,146 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/RPCResponseCache.h>
+#include <ripple/basics/Log.h>
+#include <ripple/json/to_string.h>
+#include <ripple/protocol/JsonFields.h>
+#include <boost/algorithm/string.hpp>
+#include <vector>
+
+namespace ripple {
+
+// The methods whose replies depend only on the request and the ledger
+static
+std::set<std::string>
+defaultMethods ()
+{
+    return {
+        "account_currencies",
+        "account_info",
+        "account_lines",
+        "account_objects",
+        "account_offers",
+        "book_offers",
+        "ledger",
+        "ledger_entry"
+    };
+}
+
+RPCResponseCache::RPCResponseCache (Section const& section,
+        beast::Journal journal)
+    : bytes_ (get<std::uint64_t> (section, "mb", 0) * 1024 * 1024)
+    , journal_ (journal)
+{
+    std::string methods;
+    if (set (methods, "methods", section))
+    {
+        std::vector<std::string> names;
+        boost::split (names, methods, boost::is_any_of (", "),
+            boost::token_compress_on);
+        for (auto const& name : names)
+            if (! name.empty ())
+                methods_.insert (name);
+    }
+    else
+    {
+        methods_ = defaultMethods ();
+    }
+}
+
+bool
+RPCResponseCache::cacheable (std::string const& method) const
+{
+    return methods_.count (method) != 0;
+}
+
+std::string
+RPCResponseCache::makeKey (std::string const& method,
+    Json::Value const& params, bool admin, uint256 const& ledgerHash)
+{
+    // The ledger hash stands for however the ledger was asked for. The
+    // members of an object are written in order, so equal requests are
+    // written the same way.
+    Json::Value request (params);
+    request.removeMember (jss::ledger_hash);
+    request.removeMember (jss::ledger_index);
+
+    std::string key = method;
+    key += admin ? "\na\n" : "\nu\n";
+    key += to_string (ledgerHash);
+    key += '\n';
+    key += to_string (request);
+    return key;
+}
+
+std::size_t
+RPCResponseCache::bytes (Entry const& entry)
+{
+    // The key is held twice, by the entry and by the index
+    return 2 * entry.first.size () + entry.second->size () + 128;
+}
+
+std::shared_ptr<std::string const>
+RPCResponseCache::find (std::string const& key)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = index_.find (key);
+    if (iter == index_.end ())
+    {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    entries_.splice (entries_.begin (), entries_, iter->second);
+    return iter->second->second;
+}
+
+std::shared_ptr<std::string const>
+RPCResponseCache::insert (std::string const& key, std::string reply)
+{
+    auto result = std::make_shared<std::string const> (std::move (reply));
+    Entry entry (key, result);
+    auto const size = bytes (entry);
+    if (size > bytes_ / 4)
+        return result;
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = index_.find (key);
+    if (iter != index_.end ())
+    {
+        // Another request for the same key was answered first
+        entries_.splice (entries_.begin (), entries_, iter->second);
+        return iter->second->second;
+    }
+
+    entries_.push_front (std::move (entry));
+    index_.emplace (key, entries_.begin ());
+    size_ += size;
+
+    while (size_ > bytes_)
+    {
+        auto const& oldest = entries_.back ();
+        size_ -= bytes (oldest);
+        index_.erase (oldest.first);
+        entries_.pop_back ();
+    }
+
+    JLOG (journal_.trace) << "Kept reply of " << size << " bytes, " <<
+        entries_.size () << " kept";
+    return result;
+}
+
+Json::Value
+RPCResponseCache::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::mb] = static_cast<Json::UInt> (bytes_ / (1024 * 1024));
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    ret[jss::size] = static_cast<Json::UInt> (entries_.size ());
+    ret[jss::bytes] = std::to_string (size_);
+    ret[jss::hits] = std::to_string (hits_);
+    ret[jss::misses] = std::to_string (misses_);
+    return ret;
+}
+
+} // ripple
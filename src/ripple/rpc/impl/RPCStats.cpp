@@ -0,0 +1,166 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/RPCStats.h>
+#include <ripple/protocol/JsonFields.h>
+#include <algorithm>
+
+namespace ripple {
+
+void
+RPCStats::Histogram::add (std::uint64_t value)
+{
+    std::size_t bucket = 0;
+    while (bucket < bucketCount - 1 && (value >> bucket) != 0)
+        ++bucket;
+
+    ++buckets_[bucket];
+    ++count_;
+    total_ += value;
+    max_ = std::max (max_, value);
+}
+
+std::uint64_t
+RPCStats::Histogram::percentile (double p) const
+{
+    if (count_ == 0)
+        return 0;
+
+    // The number of values at or below the percentile, at least one
+    auto const rank = std::max<std::uint64_t> (1,
+        static_cast<std::uint64_t> (p * count_ / 100 + 0.5));
+
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < bucketCount - 1; ++bucket)
+    {
+        seen += buckets_[bucket];
+        if (seen >= rank)
+            return std::min (max_, (std::uint64_t (1) << bucket) - 1);
+    }
+    return max_;
+}
+
+Json::Value
+RPCStats::Histogram::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret[jss::count] = static_cast<Json::UInt> (count_);
+    if (count_ != 0)
+    {
+        ret[jss::mean] = static_cast<Json::UInt> (total_ / count_);
+        ret[jss::p50] = static_cast<Json::UInt> (percentile (50));
+        ret[jss::p90] = static_cast<Json::UInt> (percentile (90));
+        ret[jss::p99] = static_cast<Json::UInt> (percentile (99));
+        ret[jss::max] = static_cast<Json::UInt> (max_);
+    }
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+
+RPCStats::RPCStats (beast::insight::Collector::ptr const& collector)
+    : collector_ (collector)
+{
+}
+
+char const*
+RPCStats::getName (Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::parse:      return "parse";
+    case Stage::execute:    return "execute";
+    case Stage::serialize:  return "serialize";
+    }
+    return "unknown";
+}
+
+static
+std::uint64_t
+toMicroseconds (std::chrono::nanoseconds elapsed)
+{
+    using namespace std::chrono;
+    return static_cast<std::uint64_t> (std::max<std::int64_t> (0,
+        duration_cast<microseconds> (elapsed).count ()));
+}
+
+void
+RPCStats::addCall (std::string const& method, bool failed,
+    std::chrono::nanoseconds elapsed)
+{
+    auto const i = static_cast<std::size_t> (Stage::execute);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto iter = methods_.find (method);
+    if (iter == methods_.end ())
+    {
+        iter = methods_.emplace (method, Method ()).first;
+        auto& m = iter->second;
+        m.callsCounter = collector_->make_counter (method, "calls");
+        m.failedCounter = collector_->make_counter (method, "errors");
+        for (std::size_t s = 0; s < stageCount; ++s)
+            m.events[s] = collector_->make_event (
+                method, getName (static_cast<Stage> (s)));
+        m.bytesEvent = collector_->make_event (method, "bytes");
+    }
+
+    auto& m = iter->second;
+    ++m.calls;
+    ++m.callsCounter;
+    if (failed)
+    {
+        ++m.failed;
+        ++m.failedCounter;
+    }
+    m.stages[i].add (toMicroseconds (elapsed));
+    m.events[i].notify (elapsed);
+}
+
+void
+RPCStats::add (std::string const& method, Stage stage,
+    std::chrono::nanoseconds elapsed)
+{
+    auto const i = static_cast<std::size_t> (stage);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = methods_.find (method);
+    if (iter == methods_.end ())
+        return;
+
+    iter->second.stages[i].add (toMicroseconds (elapsed));
+    iter->second.events[i].notify (elapsed);
+}
+
+void
+RPCStats::addReply (std::string const& method, std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto const iter = methods_.find (method);
+    if (iter == methods_.end ())
+        return;
+
+    iter->second.bytes.add (bytes);
+    iter->second.bytesEvent.notify (
+        static_cast<beast::insight::Event::value_type> (bytes));
+}
+
+Json::Value
+RPCStats::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    Json::Value& methods = (ret[jss::methods] = Json::objectValue);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (auto const& entry : methods_)
+    {
+        auto const& m = entry.second;
+        Json::Value& method = (methods[entry.first] = Json::objectValue);
+        method[jss::calls] = static_cast<Json::UInt> (m.calls);
+        method[jss::errors] = static_cast<Json::UInt> (m.failed);
+        for (std::size_t i = 0; i < stageCount; ++i)
+            method[getName (static_cast<Stage> (i))] =
+                m.stages[i].getJson ();
+        method[jss::bytes] = m.bytes.getJson ();
+    }
+    return ret;
+}
+
+} // ripple
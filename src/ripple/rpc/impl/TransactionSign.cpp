@@ -31,6 +31,7 @@
 #include <ripple/protocol/Sign.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/STAccount.h>
+#include <ripple/protocol/SecretKey.h>
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/rpc/impl/KeypairForSignature.h>
@@ -99,6 +100,39 @@ public:
 
 //------------------------------------------------------------------------------
 
+// Signs single signed transactions. A secp256k1 key pair is converted
+// once, so each signature is made with the shared libsecp256k1 context.
+class TxSigner
+{
+private:
+    RippleAddress const& secretKey_;
+    boost::optional<PublicKey> publicKey_;
+    boost::optional<SecretKey> secp256k1Key_;
+
+public:
+    explicit TxSigner (KeyPair const& keypair)
+    : secretKey_ (keypair.secretKey)
+    {
+        auto const& pk = keypair.publicKey.getAccountPublic ();
+        if (publicKeyType (makeSlice (pk)) == KeyType::secp256k1)
+        {
+            publicKey_.emplace (makeSlice (pk));
+            auto const sk = keypair.secretKey.getAccountPrivate ();
+            secp256k1Key_.emplace (Slice (sk.data (), sk.size ()));
+        }
+    }
+
+    TxSigner (TxSigner const&) = delete;
+
+    void operator() (STTx& tx) const
+    {
+        if (secp256k1Key_)
+            tx.sign (*publicKey_, *secp256k1Key_);
+        else
+            tx.sign (secretKey_);
+    }
+};
+
 static error_code_i acctMatchesPubKey (
     std::shared_ptr<SLE const> accountState,
     AccountID const& accountID,
@@ -331,6 +365,8 @@ static
 transactionPreProcessResult
 transactionPreProcessImpl (
     Json::Value& params,
+    KeyPair const& keypair,
+    TxSigner const& signer,
     Role role,
     SigningForParams& signingArgs,
     int validatedLedgerAge,
@@ -339,14 +375,6 @@ transactionPreProcessImpl (
 {
     auto j = app.journal ("RPCHandler");
 
-    KeyPair keypair;
-    {
-        Json::Value jvResult;
-        keypair = keypairForSignature (params, jvResult);
-        if (contains_error (jvResult))
-            return std::move (jvResult);
-    }
-
     bool const verify = !(params.isMember (jss::offline)
                           && params[jss::offline].asBool());
 
@@ -502,12 +530,35 @@ transactionPreProcessImpl (
     }
     else
     {
-        stpTrans->sign (keypair.secretKey);
+        signer (*stpTrans);
     }
 
     return transactionPreProcessResult {std::move (stpTrans)};
 }
 
+static
+transactionPreProcessResult
+transactionPreProcessImpl (
+    Json::Value& params,
+    Role role,
+    SigningForParams& signingArgs,
+    int validatedLedgerAge,
+    Application& app,
+    std::shared_ptr<ReadView const> ledger)
+{
+    KeyPair keypair;
+    {
+        Json::Value jvResult;
+        keypair = keypairForSignature (params, jvResult);
+        if (contains_error (jvResult))
+            return std::move (jvResult);
+    }
+
+    TxSigner const signer (keypair);
+    return transactionPreProcessImpl (params, keypair, signer, role,
+        signingArgs, validatedLedgerAge, app, ledger);
+}
+
 static
 std::pair <Json::Value, Transaction::pointer>
 transactionConstructImpl (std::shared_ptr<STTx const> const& stpTrans,
@@ -800,6 +851,119 @@ Json::Value transactionSubmit (
     return transactionFormatResultImpl (txn.second);
 }
 
+/** Returns a Json::objectValue. */
+Json::Value transactionBatch (
+    Json::Value jvRequest,
+    NetworkOPs::FailHard failType,
+    Role role,
+    int validatedLedgerAge,
+    Application& app,
+    std::shared_ptr<ReadView const> ledger,
+    ProcessTransactionFn const& processTransaction,
+    ApplyFlags flags)
+{
+    using namespace detail;
+
+    auto j = app.journal ("RPCHandler");
+
+    Json::Value txJsons;
+    txJsons.swap (jvRequest[jss::tx_json]);
+    jvRequest.removeMember (jss::tx_json);
+
+    if (! txJsons.isArray () || txJsons.size () == 0)
+        return RPC::invalid_field_error (jss::tx_json);
+
+    if (txJsons.size () > Tuning::maxBatchTransactions)
+        return RPC::make_param_error ("Too many transactions in tx_json.");
+
+    JLOG (j.debug) << "transactionBatch: " << txJsons.size ()
+        << (processTransaction ? " to submit" : " to sign");
+
+    KeyPair keypair;
+    {
+        Json::Value jvResult;
+        keypair = keypairForSignature (jvRequest, jvResult);
+        if (contains_error (jvResult))
+            return jvResult;
+    }
+    TxSigner const signer (keypair);
+
+    // The sequence after the last transaction of each account in the batch
+    hash_map<AccountID, std::uint32_t> sequences;
+
+    Json::Value jvResult (Json::objectValue);
+    Json::Value& results = (jvResult[jss::transactions] = Json::arrayValue);
+
+    for (auto& txJson : txJsons)
+    {
+        Json::Value request (jvRequest);
+        Json::Value& tx_json = (request[jss::tx_json] = std::move (txJson));
+
+        boost::optional<AccountID> account;
+        if (tx_json.isObject () && tx_json.isMember (jss::Account))
+            account = parseBase58<AccountID> (
+                tx_json[jss::Account].asString ());
+
+        if (account && ! tx_json.isMember (jss::Sequence))
+        {
+            auto const iter = sequences.find (*account);
+            if (iter != sequences.end ())
+                tx_json[jss::Sequence] = iter->second;
+        }
+
+        SigningForParams signForParams;
+        transactionPreProcessResult preprocResult = transactionPreProcessImpl (
+            request, keypair, signer, role, signForParams,
+            validatedLedgerAge, app, ledger);
+
+        if (!preprocResult.second)
+        {
+            results.append (preprocResult.first);
+            continue;
+        }
+
+        std::pair <Json::Value, Transaction::pointer> txn =
+            transactionConstructImpl (
+                preprocResult.second, ledger->rules(), app, flags);
+
+        if (!txn.second)
+        {
+            results.append (txn.first);
+            continue;
+        }
+
+        if (processTransaction)
+        {
+            try
+            {
+                processTransaction (
+                    txn.second, isUnlimited (role), true, failType);
+            }
+            catch (std::exception&)
+            {
+                results.append (RPC::make_error (rpcINTERNAL,
+                    "Exception occurred during transaction submission."));
+                continue;
+            }
+        }
+
+        // A transaction which was rejected without claiming a fee does
+        // not use its sequence, and the next transaction may have it. A
+        // transaction which was only signed has an uncertain result.
+        auto const ter = txn.second->getResult ();
+        if (account && (ter == temUNCERTAIN || (! isTemMalformed (ter) &&
+            ! isTefFailure (ter) && ! isTelLocal (ter))))
+        {
+            sequences[*account] =
+                preprocResult.second->getSequence () + 1;
+        }
+
+        results.append (transactionFormatResultImpl (txn.second));
+    }
+
+    return jvResult;
+}
+
 namespace detail
 {
 // There are a some field checks shared by transactionSignFor
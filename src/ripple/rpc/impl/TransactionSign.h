@@ -97,6 +97,30 @@ Json::Value transactionSubmit (
     ProcessTransactionFn const& processTransaction,
     ApplyFlags flags = tapNONE);
 
+/** Sign, and optionally submit, a batch of transactions with one key.
+
+    The request has the fields of a sign or submit request, except that
+    tx_json is an array of transactions. The key is derived once for the
+    batch. A transaction without a Sequence gets the one after the
+    previous transaction of its account in the batch, or the account's
+    sequence if it is the first.
+
+    @param processTransaction Submits each transaction, or is empty to
+                              only sign them.
+
+    @return A Json::objectValue holding the result of each transaction,
+            in order, in "transactions"; or an error.
+*/
+Json::Value transactionBatch (
+    Json::Value params,  // Passed by value so it can be modified locally.
+    NetworkOPs::FailHard failType,
+    Role role,
+    int validatedLedgerAge,
+    Application& app,
+    std::shared_ptr<ReadView const> ledger,
+    ProcessTransactionFn const& processTransaction,
+    ApplyFlags flags = tapNONE);
+
 /** Returns a Json::objectValue. */
 Json::Value transactionSignFor (
     Json::Value params,  // Passed by value so it can be modified locally.
@@ -32,6 +32,12 @@ struct LimitRange {
     unsigned int rmin, rdefault, rmax;
 };
 
+/** Limits for the asset states of the account_asset command. */
+static LimitRange const accountAsset = {10, 200, 400};
+
+/** Limits for the account_referrals command. */
+static LimitRange const accountReferrals = {10, 100, 200};
+
 /** Limits for the account_lines command. */
 static LimitRange const accountLines = {10, 200, 400};
 
@@ -54,6 +60,12 @@ static int const maxJobQueueClients = 500;
 static int const maxValidatedLedgerAge = 120;
 static int const maxRequestSize = 1000000;
 
+/** The most transactions signed or submitted by one batch request. */
+static int const maxBatchTransactions = 500;
+
+/** The most accounts read by one account_info_batch or account_lines_batch. */
+static unsigned int const maxBatchAccounts = 1000;
+
 /** Maximum number of pages in one response from a binary LedgerData request. */
 static int const binaryPageLength = 2048;
 
@@ -0,0 +1,35 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/TxHistoryIndex.h>
+
+namespace ripple {
+
+TxHistoryIndex::TxHistoryIndex (std::size_t capacity)
+    : capacity_ (capacity)
+{
+}
+
+boost::optional<TxHistoryIndex::Key>
+TxHistoryIndex::find (std::size_t start, std::uint32_t ledgerSeq,
+    Loader const& load)
+{
+    if (start >= capacity_)
+        return boost::none;
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (! loaded_ || ledgerSeq != ledgerSeq_)
+    {
+        // Pages asked for meanwhile wait for the load, rather than
+        // loading the same keys
+        keys_ = load (capacity_);
+        if (keys_.size () > capacity_)
+            keys_.resize (capacity_);
+        loaded_ = true;
+        ledgerSeq_ = ledgerSeq;
+    }
+
+    if (start >= keys_.size ())
+        return boost::none;
+    return keys_[start];
+}
+
+} // ripple
@@ -1751,10 +1751,79 @@ public:
         }
     }
 
+    void testBatchRPC ()
+    {
+        test::jtx::Env env(*this);
+        env.close();
+        auto const ledger = env.open();
+        auto const sequence = (*ledger->read (
+            keylet::account (env.master.id())))[sfSequence];
+
+        ProcessTransactionFn processTxn = fakeProcessTransaction;
+
+        // The transaction without a TransactionType fails, and the
+        // next one gets its sequence.
+        Json::Value req;
+        Json::Reader ().parse (R"({
+            "secret": "masterpassphrase",
+            "tx_json": [
+                { "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                  "TransactionType": "AccountSet" },
+                { "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh" },
+                { "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                  "TransactionType": "AccountSet" },
+                { "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                  "TransactionType": "AccountSet", "Sequence": 100 },
+                { "Account": "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+                  "TransactionType": "AccountSet" }
+            ]
+        })", req);
+
+        for (bool const submit : {false, true})
+        {
+            Json::Value const result = transactionBatch (req,
+                NetworkOPs::FailHard::yes, Role::ADMIN, 1, env.app(),
+                    ledger, submit ? processTxn : ProcessTransactionFn (),
+                        tapENABLE_TESTING);
+
+            expect (! RPC::contains_error (result));
+            auto const& txs = result[jss::transactions];
+            if (! expect (txs.isArray () && txs.size () == 5))
+                continue;
+
+            expect (RPC::contains_error (txs[1u]));
+            std::uint32_t const expected[] = {
+                sequence, 0, sequence + 1, 100, 101 };
+            for (Json::UInt i = 0; i < txs.size (); ++i)
+            {
+                if (i == 1)
+                    continue;
+                expect (! RPC::contains_error (txs[i]));
+                expect (txs[i][jss::tx_json][jss::Sequence].asUInt () ==
+                    expected[i]);
+                expect (! txs[i][jss::tx_blob].asString ().empty ());
+            }
+        }
+
+        // The batch must be a non-empty array
+        req[jss::tx_json] = Json::arrayValue;
+        expect (RPC::contains_error (transactionBatch (req,
+            NetworkOPs::FailHard::yes, Role::ADMIN, 1, env.app(),
+                ledger, processTxn, tapENABLE_TESTING)));
+
+        // A missing secret fails the whole batch
+        req[jss::tx_json].append (Json::objectValue);
+        req.removeMember (jss::secret);
+        expect (RPC::contains_error (transactionBatch (req,
+            NetworkOPs::FailHard::yes, Role::ADMIN, 1, env.app(),
+                ledger, processTxn, tapENABLE_TESTING)));
+    }
+
     void run ()
     {
         testAutoFillFees ();
         testTransactionRPC ();
+        testBatchRPC ();
     }
 };
 
@@ -0,0 +1,97 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/LedgerDataCursors.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class LedgerDataCursors_test : public beast::unit_test::suite
+{
+public:
+    void
+    testTake ()
+    {
+        testcase ("take");
+
+        TestStopwatch clock;
+        LedgerDataCursors cursors (clock);
+
+        auto a = cursors.open (nullptr, true);
+        auto b = cursors.open (nullptr, false);
+        expect (a->token != b->token);
+        expect (a->validated && ! b->validated);
+        expect (cursors.size () == 0);
+
+        auto const token = a->token;
+        expect (! cursors.take (token));
+
+        cursors.keep (std::move (a));
+        expect (cursors.size () == 1);
+
+        // A cursor is only taken once
+        auto c = cursors.take (token);
+        expect (c && c->token == token);
+        expect (! cursors.take (token));
+        expect (! cursors.take ("unknown"));
+    }
+
+    void
+    testExpire ()
+    {
+        testcase ("expire");
+
+        TestStopwatch clock;
+        LedgerDataCursors cursors (clock, 32, std::chrono::seconds (60));
+
+        auto a = cursors.open (nullptr, true);
+        auto const token = a->token;
+        cursors.keep (std::move (a));
+
+        clock.advance (std::chrono::seconds (60));
+        a = cursors.take (token);
+        expect (a != nullptr);
+
+        // Kept again, the cursor lives from then on
+        cursors.keep (std::move (a));
+        clock.advance (std::chrono::seconds (61));
+        expect (! cursors.take (token));
+        expect (cursors.size () == 0);
+    }
+
+    void
+    testEvict ()
+    {
+        testcase ("evict");
+
+        TestStopwatch clock;
+        LedgerDataCursors cursors (clock, 2);
+
+        std::vector<std::string> tokens;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto cursor = cursors.open (nullptr, true);
+            tokens.push_back (cursor->token);
+            cursors.keep (std::move (cursor));
+            clock.advance (std::chrono::seconds (1));
+        }
+
+        // The least recently used cursor is dropped
+        expect (cursors.size () == 2);
+        expect (! cursors.take (tokens[0]));
+        expect (cursors.take (tokens[1]) != nullptr);
+        expect (cursors.take (tokens[2]) != nullptr);
+    }
+
+    void
+    run ()
+    {
+        testTake ();
+        testExpire ();
+        testEvict ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerDataCursors,rpc,ripple);
+
+} // ripple
@@ -0,0 +1,126 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/RPCResponseCache.h>
+#include <ripple/protocol/JsonFields.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class RPCResponseCache_test : public beast::unit_test::suite
+{
+public:
+    static
+    Section
+    makeSection (std::string const& mb, std::string const& methods = {})
+    {
+        Section section ("rpc_cache");
+        section.set ("mb", mb);
+        if (! methods.empty ())
+            section.set ("methods", methods);
+        return section;
+    }
+
+    void
+    testConfig ()
+    {
+        testcase ("config");
+
+        beast::Journal const j;
+        expect (! RPCResponseCache (Section ("rpc_cache"), j).enabled ());
+
+        RPCResponseCache defaults (makeSection ("1"), j);
+        expect (defaults.enabled ());
+        expect (defaults.cacheable ("account_info"));
+        expect (defaults.cacheable ("ledger"));
+        expect (! defaults.cacheable ("submit"));
+        expect (! defaults.cacheable ("ledger_data"));
+
+        RPCResponseCache listed (
+            makeSection ("1", "book_offers, tx"), j);
+        expect (listed.cacheable ("book_offers"));
+        expect (listed.cacheable ("tx"));
+        expect (! listed.cacheable ("account_info"));
+    }
+
+    void
+    testKeys ()
+    {
+        testcase ("keys");
+
+        uint256 const hash (1);
+        Json::Value byIndex (Json::objectValue);
+        byIndex[jss::account] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+        byIndex[jss::ledger_index] = "validated";
+        byIndex[jss::command] = "account_info";
+
+        Json::Value byHash (Json::objectValue);
+        byHash[jss::command] = "account_info";
+        byHash[jss::ledger_hash] = to_string (hash);
+        byHash[jss::account] = "rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh";
+
+        auto const key = RPCResponseCache::makeKey (
+            "account_info", byIndex, false, hash);
+        expect (key == RPCResponseCache::makeKey (
+            "account_info", byHash, false, hash));
+
+        // A different ledger, client or request
+        expect (key != RPCResponseCache::makeKey (
+            "account_info", byIndex, false, uint256 (2)));
+        expect (key != RPCResponseCache::makeKey (
+            "account_info", byIndex, true, hash));
+        byHash[jss::strict] = true;
+        expect (key != RPCResponseCache::makeKey (
+            "account_info", byHash, false, hash));
+    }
+
+    void
+    testBudget ()
+    {
+        testcase ("budget");
+
+        RPCResponseCache cache (makeSection ("1"), beast::Journal ());
+        expect (cache.find ("a") == nullptr);
+
+        // A reply too large to keep is still returned
+        std::string const large (512 * 1024, 'x');
+        auto reply = cache.insert ("large", large);
+        expect (reply && *reply == large);
+        expect (cache.find ("large") == nullptr);
+
+        // The oldest replies are dropped first
+        std::string const body (150 * 1024, 'y');
+        for (int i = 0; i < 6; ++i)
+            cache.insert (std::to_string (i), body);
+        expect (cache.find ("0") != nullptr);
+        cache.insert ("6", body);
+        cache.insert ("7", body);
+        expect (cache.find ("0") != nullptr);
+        expect (cache.find ("1") == nullptr);
+        expect (cache.find ("2") == nullptr);
+        expect (cache.find ("7") != nullptr);
+
+        // The first reply kept for a key is kept
+        auto const first = cache.insert ("same", "first");
+        expect (*cache.insert ("same", "second") == "first");
+        expect (cache.find ("same") == first);
+
+        auto const json = cache.getJson ();
+        expect (json[jss::mb] == 1);
+        expect (json[jss::size] == 7);
+        expect (json[jss::hits] == "4");
+        expect (json[jss::misses] == "4");
+    }
+
+    void
+    run () override
+    {
+        testConfig ();
+        testKeys ();
+        testBudget ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RPCResponseCache,rpc,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,100 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/RPCStats.h>
+#include <ripple/protocol/JsonFields.h>
+#include <beast/insight/NullCollector.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace test {
+
+class RPCStats_test : public beast::unit_test::suite
+{
+public:
+    using Stage = RPCStats::Stage;
+
+    void
+    testHistogram ()
+    {
+        testcase ("histogram");
+
+        RPCStats::Histogram h;
+        expect (h.percentile (50) == 0);
+        expect (! h.getJson ().isMember (jss::mean));
+
+        for (std::uint64_t value = 1; value <= 100; ++value)
+            h.add (value);
+        expect (h.count () == 100);
+
+        // 50 is in the bucket from 32 to 63, 90 and 99 in the one from 64
+        // to 127, which is bounded by the largest value
+        expect (h.percentile (50) == 63);
+        expect (h.percentile (90) == 100);
+        expect (h.percentile (99) == 100);
+
+        auto const json = h.getJson ();
+        expect (json[jss::count] == 100);
+        expect (json[jss::mean] == 50);
+        expect (json[jss::p50] == 63);
+        expect (json[jss::max] == 100);
+
+        RPCStats::Histogram zeros;
+        zeros.add (0);
+        zeros.add (0);
+        zeros.add (std::uint64_t (1) << 40);
+        expect (zeros.percentile (50) == 0);
+        expect (zeros.percentile (100) == std::uint64_t (1) << 40);
+    }
+
+    void
+    testMethods ()
+    {
+        testcase ("methods");
+
+        using namespace std::chrono;
+        RPCStats stats (beast::insight::NullCollector::New ());
+
+        // Not tracked until the handler is called
+        stats.add ("account_info", Stage::parse, microseconds (5));
+        stats.addReply ("account_info", 500);
+        expect (stats.getJson ()[jss::methods].size () == 0);
+
+        stats.addCall ("account_info", false, microseconds (300));
+        stats.addCall ("account_info", true, microseconds (100));
+        stats.add ("account_info", Stage::parse, microseconds (7));
+        stats.add ("account_info", Stage::serialize, nanoseconds (1500));
+        stats.addReply ("account_info", 500);
+        stats.addCall ("ping", false, nanoseconds (10));
+        stats.add ("no_such_method", Stage::parse, microseconds (5));
+
+        auto const json = stats.getJson ()[jss::methods];
+        expect (json.size () == 2);
+
+        auto const& info = json["account_info"];
+        expect (info[jss::calls] == 2);
+        expect (info[jss::errors] == 1);
+        expect (info["execute"][jss::count] == 2);
+        expect (info["execute"][jss::mean] == 200);
+        expect (info["execute"][jss::max] == 300);
+        expect (info["parse"][jss::count] == 1);
+        expect (info["parse"][jss::max] == 7);
+        expect (info["serialize"][jss::max] == 1);
+        expect (info[jss::bytes][jss::count] == 1);
+        expect (info[jss::bytes][jss::max] == 500);
+
+        expect (json["ping"][jss::errors] == 0);
+        expect (json["ping"]["execute"][jss::max] == 0);
+        expect (json["ping"][jss::bytes][jss::count] == 0);
+    }
+
+    void
+    run () override
+    {
+        testHistogram ();
+        testMethods ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RPCStats,rpc,ripple);
+
+} // test
+} // ripple
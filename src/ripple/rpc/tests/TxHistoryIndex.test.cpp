@@ -0,0 +1,80 @@
+#include <BeastConfig.h>
+#include <ripple/rpc/TxHistoryIndex.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class TxHistoryIndex_test : public beast::unit_test::suite
+{
+public:
+    // Ten transactions in each ledger, the newest ledger first
+    static
+    std::vector<TxHistoryIndex::Key>
+    makeKeys (std::uint32_t newest, std::size_t count)
+    {
+        std::vector<TxHistoryIndex::Key> keys;
+        for (std::size_t i = 0; i < count; ++i)
+            keys.push_back ({static_cast<std::uint32_t> (newest - i / 10),
+                uint256 (10 - i % 10)});
+        return keys;
+    }
+
+    void
+    testFind ()
+    {
+        testcase ("find");
+
+        TxHistoryIndex index (100);
+        int loads = 0;
+        std::uint32_t newest = 1000;
+        auto const load = [&] (std::size_t count)
+            {
+                ++loads;
+                expect (count == 100);
+                return makeKeys (newest, count + 5);
+            };
+
+        auto key = index.find (0, 7, load);
+        expect (key && key->ledgerSeq == 1000 && key->txID == uint256 (10));
+        key = index.find (25, 7, load);
+        expect (key && key->ledgerSeq == 998 && key->txID == uint256 (5));
+        key = index.find (99, 7, load);
+        expect (key && key->ledgerSeq == 991);
+        expect (loads == 1);
+
+        // Positions past the capacity are not indexed
+        expect (! index.find (100, 7, load));
+        expect (loads == 1);
+
+        // A new validated ledger loads the keys again
+        newest = 1001;
+        key = index.find (0, 8, load);
+        expect (key && key->ledgerSeq == 1001);
+        expect (loads == 2);
+    }
+
+    void
+    testShortHistory ()
+    {
+        testcase ("short history");
+
+        TxHistoryIndex index (100);
+        auto const load = [&] (std::size_t)
+            {
+                return makeKeys (50, 30);
+            };
+        expect (!! index.find (29, 1, load));
+        expect (! index.find (30, 1, load));
+    }
+
+    void
+    run ()
+    {
+        testFind ();
+        testShortHistory ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxHistoryIndex,rpc,ripple);
+
+} // ripple
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_SERVER_PORT_H_INCLUDED
 #define RIPPLE_SERVER_PORT_H_INCLUDED
 
+#include <ripple/server/SendQueue.h>
 #include <beast/net/IPEndpoint.h>
 #include <beast/utility/ci_char_traits.h>
 #include <boost/asio/ip/address.hpp>
@@ -51,6 +52,18 @@ struct Port
     std::string ssl_chain;
     std::shared_ptr<boost::asio::ssl::context> context;
 
+    // Maximum number of requests from one connection processed at once.
+    // Ignored for the peer protocol, whose handoffs take over the stream.
+    std::size_t pipeline = 1;
+
+    // Bounds on the stream messages queued for one websocket client.
+    SendLimits send_queue;
+
+    // Compress the stream messages of websocket clients which offer
+    // permessage-deflate, keeping the context between messages or not.
+    bool permessage_deflate = false;
+    bool deflate_context_takeover = false;
+
     // Returns `true` if any websocket protocols are specified
     template <class = void>
     bool
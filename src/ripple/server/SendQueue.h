@@ -0,0 +1,216 @@
+#ifndef RIPPLE_SERVER_SENDQUEUE_H_INCLUDED
+#define RIPPLE_SERVER_SENDQUEUE_H_INCLUDED
+
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** What is done when the messages queued for a subscriber reach a limit. */
+enum class SendPolicy
+{
+    disconnect,     // Close the connection
+    dropOldest,     // Discard the oldest messages not yet sent
+    coalesce        // Discard superseded messages, then the oldest
+};
+
+/** Returns the policy with the name used in the config file. */
+inline
+boost::optional<SendPolicy>
+to_SendPolicy (std::string const& name)
+{
+    if (name == "disconnect")
+        return SendPolicy::disconnect;
+    if (name == "drop_oldest")
+        return SendPolicy::dropOldest;
+    if (name == "coalesce")
+        return SendPolicy::coalesce;
+    return boost::none;
+}
+
+/** Bounds on the messages queued for one subscriber. */
+struct SendLimits
+{
+    // Most bytes queued, including those the transport has not sent yet.
+    // Zero means no limit.
+    std::size_t bytes = 16 * 1024 * 1024;
+
+    // Most messages queued. Zero means no limit.
+    std::size_t messages = 0;
+
+    SendPolicy policy = SendPolicy::disconnect;
+};
+
+/** Messages waiting for a subscriber which is behind.
+
+    A message may have a key, such as the type of a stream event which
+    only matters to the subscriber in its latest form. Under the coalesce
+    policy a message with a key replaces the queued ones with the same key
+    before any others are dropped.
+
+    This is not thread safe.
+*/
+template <class Item>
+class SendQueue
+{
+private:
+    struct Entry
+    {
+        Item item;
+        std::size_t bytes;
+        std::string key;
+    };
+
+    SendLimits limits_;
+    std::deque<Entry> entries_;
+    std::size_t bytes_ = 0;
+    std::size_t dropped_ = 0;
+
+public:
+    explicit
+    SendQueue (SendLimits const& limits)
+        : limits_ (limits)
+    {
+    }
+
+    SendQueue (SendQueue const&) = delete;
+    SendQueue& operator= (SendQueue const&) = delete;
+
+    SendLimits const&
+    limits () const
+    {
+        return limits_;
+    }
+
+    bool
+    empty () const
+    {
+        return entries_.empty ();
+    }
+
+    std::size_t
+    size () const
+    {
+        return entries_.size ();
+    }
+
+    /** Returns the bytes of the queued messages. */
+    std::size_t
+    bytes () const
+    {
+        return bytes_;
+    }
+
+    /** Returns the number of messages discarded so far. */
+    std::size_t
+    dropped () const
+    {
+        return dropped_;
+    }
+
+    /** Returns true if a message can go to the transport without queueing.
+
+        @param pending The bytes the transport holds and has not sent.
+    */
+    bool
+    fits (std::size_t bytes, std::size_t pending) const
+    {
+        return entries_.empty () && (limits_.bytes == 0 ||
+            pending + bytes <= limits_.bytes);
+    }
+
+    /** Queue a message, then apply the policy if a limit is exceeded.
+
+        The newest message is never dropped, even if it is larger than the
+        limit on its own.
+
+        @param pending The bytes the transport holds and has not sent.
+        @return `false` if the subscriber must be disconnected. The queue is
+                cleared in that case.
+    */
+    bool
+    push (Item item, std::size_t bytes, std::string key = {},
+        std::size_t pending = 0)
+    {
+        entries_.push_back ({std::move (item), bytes, std::move (key)});
+        bytes_ += bytes;
+
+        if (! over (pending))
+            return true;
+
+        if (limits_.policy == SendPolicy::disconnect)
+        {
+            dropped_ += entries_.size ();
+            clear ();
+            return false;
+        }
+
+        if (limits_.policy == SendPolicy::coalesce)
+            coalesce ();
+
+        while (over (pending) && entries_.size () > 1)
+        {
+            bytes_ -= entries_.front ().bytes;
+            entries_.pop_front ();
+            ++dropped_;
+        }
+        return true;
+    }
+
+    /** Removes and returns the oldest message. */
+    Item
+    pop ()
+    {
+        Item item = std::move (entries_.front ().item);
+        bytes_ -= entries_.front ().bytes;
+        entries_.pop_front ();
+        return item;
+    }
+
+    void
+    clear ()
+    {
+        entries_.clear ();
+        bytes_ = 0;
+    }
+
+private:
+    bool
+    over (std::size_t pending) const
+    {
+        return (limits_.bytes != 0 && pending + bytes_ > limits_.bytes) ||
+            (limits_.messages != 0 && entries_.size () > limits_.messages);
+    }
+
+    // Keeps only the newest message for each key
+    void
+    coalesce ()
+    {
+        std::vector<std::string> seen;
+        std::deque<Entry> kept;
+        for (auto it = entries_.rbegin (); it != entries_.rend (); ++it)
+        {
+            if (! it->key.empty ())
+            {
+                if (std::find (seen.begin (), seen.end (), it->key) !=
+                    seen.end ())
+                {
+                    bytes_ -= it->bytes;
+                    ++dropped_;
+                    continue;
+                }
+                seen.push_back (it->key);
+            }
+            kept.push_front (std::move (*it));
+        }
+        entries_.swap (kept);
+    }
+};
+
+} // ripple
+
+#endif
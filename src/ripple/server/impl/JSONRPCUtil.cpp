@@ -25,6 +25,7 @@
 #include <ripple/protocol/SystemParameters.h>
 #include <ripple/json/to_string.h>
 #include <boost/algorithm/string.hpp>
+#include <sstream>
 
 namespace ripple {
 
@@ -45,8 +46,27 @@ std::string getHTTPHeaderTimestamp ()
     return std::string (buffer);
 }
 
+static
+void writeStatusLine (int nStatus, Json::Output const& output)
+{
+    switch (nStatus)
+    {
+    case 200: output ("HTTP/1.1 200 OK\r\n"); break;
+    case 400: output ("HTTP/1.1 400 Bad Request\r\n"); break;
+    case 403: output ("HTTP/1.1 403 Forbidden\r\n"); break;
+    case 404: output ("HTTP/1.1 404 Not Found\r\n"); break;
+    case 500: output ("HTTP/1.1 500 Internal Server Error\r\n"); break;
+    }
+}
+
 void HTTPReply (
     int nStatus, std::string const& content, Json::Output const& output, beast::Journal j)
+{
+    HTTPReply (nStatus, content, "application/json; charset=UTF-8", output, j);
+}
+
+void HTTPReply (int nStatus, std::string const& content,
+    char const* contentType, Json::Output const& output, beast::Journal j)
 {
     JLOG (j.trace)
         << "HTTP Reply " << nStatus << " " << content;
@@ -84,14 +104,7 @@ void HTTPReply (
         return;
     }
 
-    switch (nStatus)
-    {
-    case 200: output ("HTTP/1.1 200 OK\r\n"); break;
-    case 400: output ("HTTP/1.1 400 Bad Request\r\n"); break;
-    case 403: output ("HTTP/1.1 403 Forbidden\r\n"); break;
-    case 404: output ("HTTP/1.1 404 Not Found\r\n"); break;
-    case 500: output ("HTTP/1.1 500 Internal Server Error\r\n"); break;
-    }
+    writeStatusLine (nStatus, output);
 
     output (getHTTPHeaderTimestamp ());
 
@@ -104,7 +117,9 @@ void HTTPReply (
 
     output (std::to_string(content.size () + 2));
     output ("\r\n"
-            "Content-Type: application/json; charset=UTF-8\r\n");
+            "Content-Type: ");
+    output (contentType);
+    output ("\r\n");
 
     output ("Server: " + systemName () + "-json-rpc/");
     output (BuildInfo::getFullVersionString ());
@@ -114,4 +129,52 @@ void HTTPReply (
     output ("\r\n");
 }
 
+//------------------------------------------------------------------------------
+
+HTTPChunkedReply::HTTPChunkedReply (int nStatus,
+        Json::Output const& output, std::size_t chunkSize)
+    : output_ (output)
+    , chunkSize_ (chunkSize)
+{
+    buffer_.reserve (chunkSize_);
+
+    writeStatusLine (nStatus, output_);
+    output_ (getHTTPHeaderTimestamp ());
+    output_ ("Connection: Keep-Alive\r\n"
+             "Transfer-Encoding: chunked\r\n"
+             "Content-Type: application/json; charset=UTF-8\r\n");
+    output_ ("Server: " + systemName () + "-json-rpc/");
+    output_ (BuildInfo::getFullVersionString ());
+    output_ ("\r\n"
+             "\r\n");
+}
+
+void HTTPChunkedReply::write (boost::string_ref const& b)
+{
+    size_ += b.size ();
+    buffer_.append (b.data (), b.size ());
+    if (buffer_.size () >= chunkSize_)
+        flush ();
+}
+
+void HTTPChunkedReply::finish ()
+{
+    flush ();
+    output_ ("0\r\n"
+             "\r\n");
+}
+
+void HTTPChunkedReply::flush ()
+{
+    if (buffer_.empty ())
+        return;
+
+    std::stringstream ss;
+    ss << std::hex << buffer_.size () << "\r\n";
+    output_ (ss.str ());
+    output_ (buffer_);
+    output_ ("\r\n");
+    buffer_.clear ();
+}
+
 } // ripple
@@ -22,12 +22,54 @@
 
 #include <ripple/json/json_value.h>
 #include <ripple/json/Output.h>
+#include <beast/utility/Journal.h>
+#include <string>
 
 namespace ripple {
 
 void HTTPReply (
     int nStatus, std::string const& strMsg, Json::Output const&, beast::Journal j);
 
+/** An HTTP reply with content of a type other than JSON. */
+void HTTPReply (int nStatus, std::string const& strMsg,
+    char const* contentType, Json::Output const&, beast::Journal j);
+
+/** An HTTP reply whose content is streamed with chunked transfer encoding.
+
+    The status line and headers are written on construction. Content is
+    gathered into chunks of about chunkSize bytes, so a large reply never
+    has to be held in memory as a whole before it is sent.
+*/
+class HTTPChunkedReply
+{
+public:
+    HTTPChunkedReply (int nStatus, Json::Output const& output,
+        std::size_t chunkSize = 65536);
+
+    HTTPChunkedReply (HTTPChunkedReply const&) = delete;
+    HTTPChunkedReply& operator= (HTTPChunkedReply const&) = delete;
+
+    /** Append to the content. */
+    void write (boost::string_ref const& b);
+
+    /** Send the buffered content and the terminating chunk. */
+    void finish ();
+
+    /** Returns the number of content bytes written so far. */
+    std::size_t size () const
+    {
+        return size_;
+    }
+
+private:
+    void flush ();
+
+    Json::Output output_;
+    std::size_t chunkSize_;
+    std::string buffer_;
+    std::size_t size_ = 0;
+};
+
 } // ripple
 
 #endif
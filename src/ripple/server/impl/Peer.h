@@ -33,9 +33,11 @@
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/asio/streambuf.hpp>
 #include <boost/asio/spawn.hpp>
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
@@ -83,9 +85,12 @@ protected:
         std::size_t used;
     };
 
+    class Request;
+
     boost::asio::io_service::work work_;
     boost::asio::io_service::strand strand_;
     waitable_timer timer_;
+    waitable_timer write_timer_;
     endpoint_type remote_address_;
     std::string forwarded_for_;
     std::string user_;
@@ -100,9 +105,15 @@ protected:
     std::list <buffer> write_queue_;
     std::mutex mutex_;
     bool graceful_ = false;
-    bool complete_ = false;
     boost::system::error_code ec_;
 
+    // Requests being processed, in the order their responses are sent.
+    // Only the front request writes to the stream, the output of the
+    // others is held until they reach the front.
+    std::deque <std::shared_ptr <Request>> requests_;
+    std::size_t pipeline_;
+    bool paused_ = false;
+
     clock_type::time_point when_;
     std::string when_str_;
     int request_count_ = 0;
@@ -139,10 +150,10 @@ protected:
     fail (error_code ec, char const* what);
 
     void
-    start_timer();
+    start_timer (waitable_timer& timer);
 
     void
-    cancel_timer();
+    cancel_timer (waitable_timer& timer);
 
     void
     on_timer (error_code ec);
@@ -157,6 +168,15 @@ protected:
     do_writer (std::shared_ptr <Writer> const& writer,
         bool keep_alive, yield_context yield);
 
+    void
+    dispatch();
+
+    void
+    finish (std::shared_ptr <Request> const& request, bool keep_alive);
+
+    void
+    resume();
+
     virtual
     void
     do_request() = 0;
@@ -228,6 +248,132 @@ protected:
 
 //------------------------------------------------------------------------------
 
+/** A request read from the connection, and the session for its response. */
+template <class Impl>
+class Peer<Impl>::Request
+    : public Session
+    , public std::enable_shared_from_this <Request>
+{
+private:
+    friend class Peer;
+
+    std::shared_ptr <Peer> peer_;
+    beast::http::message message_;
+    beast::http::body body_;
+    std::string forwarded_for_;
+    std::string user_;
+
+    // Guarded by the peer's mutex
+    bool head_ = false;
+    std::list <buffer> pending_;
+
+    // Only used on the peer's strand
+    bool complete_ = false;
+    bool keep_alive_ = false;
+
+public:
+    Request (std::shared_ptr <Peer> const& peer,
+            beast::http::message&& message, beast::http::body&& body)
+        : peer_ (peer)
+        , message_ (std::move (message))
+        , body_ (std::move (body))
+        , forwarded_for_ (peer->forwarded_for_)
+        , user_ (peer->user_)
+    {
+    }
+
+    beast::Journal
+    journal() override
+    {
+        return peer_->journal();
+    }
+
+    Port const&
+    port() override
+    {
+        return peer_->port();
+    }
+
+    beast::IP::Endpoint
+    remoteAddress() override
+    {
+        return peer_->remoteAddress();
+    }
+
+    std::string
+    user() override
+    {
+        return user_;
+    }
+
+    std::string
+    forwarded_for() override
+    {
+        return forwarded_for_;
+    }
+
+    beast::http::message&
+    request() override
+    {
+        return message_;
+    }
+
+    beast::http::body const&
+    body() override
+    {
+        return body_;
+    }
+
+    void
+    write (void const* buffer, std::size_t bytes) override
+    {
+        if (bytes == 0)
+            return;
+
+        {
+            std::lock_guard <std::mutex> lock (peer_->mutex_);
+            if (! head_)
+            {
+                pending_.emplace_back (buffer, bytes);
+                return;
+            }
+        }
+
+        peer_->write (buffer, bytes);
+    }
+
+    void
+    write (std::shared_ptr <Writer> const& writer,
+        bool keep_alive) override
+    {
+        peer_->write (writer, keep_alive);
+    }
+
+    std::shared_ptr<Session>
+    detach() override
+    {
+        return this->shared_from_this();
+    }
+
+    void
+    complete() override
+    {
+        peer_->strand_.post (std::bind (&Peer::finish, peer_,
+            this->shared_from_this(), true));
+    }
+
+    void
+    close (bool graceful) override
+    {
+        if (! graceful)
+            return peer_->close();
+        peer_->strand_.post (std::bind (&Peer::finish, peer_,
+            this->shared_from_this(), false));
+    }
+};
+
+//------------------------------------------------------------------------------
+
 template <class Impl>
 template <class ConstBufferSequence>
 Peer<Impl>::Peer (Door& door, boost::asio::io_service& io_service,
@@ -237,9 +383,15 @@ Peer<Impl>::Peer (Door& door, boost::asio::io_service& io_service,
     , work_ (io_service)
     , strand_ (io_service)
     , timer_ (io_service)
+    , write_timer_ (io_service)
     , remote_address_ (remote_address)
     , journal_ (journal)
+    , pipeline_ (1)
 {
+    // Handoffs to the peer protocol take over the stream, so those
+    // connections must be idle between requests.
+    if (port().protocol.count("peer") == 0)
+        pipeline_ = std::max <std::size_t> (port().pipeline, 1);
     read_buf_.commit(boost::asio::buffer_copy(read_buf_.prepare (
         boost::asio::buffer_size (buffers)), buffers));
     static std::atomic <int> sid;
@@ -298,15 +450,16 @@ Peer<Impl>::fail (error_code ec, char const* what)
     }
 }
 
+// Reads and writes can be pending at the same time, so each has its timer
 template <class Impl>
 void
-Peer<Impl>::start_timer()
+Peer<Impl>::start_timer (waitable_timer& timer)
 {
     error_code ec;
-    timer_.expires_from_now (std::chrono::seconds(timeoutSeconds), ec);
+    timer.expires_from_now (std::chrono::seconds(timeoutSeconds), ec);
     if (ec)
         return fail (ec, "start_timer");
-    timer_.async_wait (strand_.wrap (std::bind (
+    timer.async_wait (strand_.wrap (std::bind (
         &Peer<Impl>::on_timer, impl().shared_from_this(),
             beast::asio::placeholders::error)));
 }
@@ -314,10 +467,10 @@ Peer<Impl>::start_timer()
 // Convenience for discarding the error code
 template <class Impl>
 void
-Peer<Impl>::cancel_timer()
+Peer<Impl>::cancel_timer (waitable_timer& timer)
 {
     error_code ec;
-    timer_.cancel(ec);
+    timer.cancel(ec);
 }
 
 // Called when session times out
@@ -339,21 +492,20 @@ template <class Impl>
 void
 Peer<Impl>::do_read (yield_context yield)
 {
-    complete_ = false;
-
     error_code ec;
     bool eof = false;
+    message_ = beast::http::message{};
     body_.clear();
     beast::http::parser parser (message_, body_, true);
     for(;;)
     {
         if (read_buf_.size() == 0)
         {
-            start_timer();
+            start_timer (timer_);
             auto const bytes_transferred = boost::asio::async_read (
                 impl().stream_, read_buf_.prepare (bufferSize),
                     boost::asio::transfer_at_least(1), yield[ec]);
-            cancel_timer();
+            cancel_timer (timer_);
 
             eof = ec == boost::asio::error::eof;
             if (eof)
@@ -444,23 +596,17 @@ Peer<Impl>::do_write (yield_context yield)
             }
         }
 
-        start_timer();
+        start_timer (write_timer_);
         bytes = boost::asio::async_write (impl().stream_,
             boost::asio::buffer (data, bytes),
                 boost::asio::transfer_at_least(1), yield[ec]);
-        cancel_timer();
+        cancel_timer (write_timer_);
         if (ec)
             return fail (ec, "write");
     }
 
-    if (! complete_)
-        return;
-
     if (graceful_)
         return do_close();
-
-    boost::asio::spawn (strand_, std::bind (&Peer<Impl>::do_read,
-        impl().shared_from_this(), std::placeholders::_1));
 }
 
 template <class Impl>
@@ -502,6 +648,92 @@ Peer<Impl>::do_writer (std::shared_ptr <Writer> const& writer,
         impl().shared_from_this(), std::placeholders::_1));
 }
 
+// Hands the request just read to the handler, and reads the next one
+// while it is processed if the port allows it.
+template <class Impl>
+void
+Peer<Impl>::dispatch()
+{
+    bool const keep_alive = message_.keep_alive();
+    auto const request = std::make_shared <Request> (
+        impl().shared_from_this(), std::move (message_), std::move (body_));
+    requests_.push_back (request);
+    if (requests_.size() == 1)
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        request->head_ = true;
+    }
+
+    door_.server().handler().onRequest (*request);
+
+    // Nothing more is read until the handler says so
+    paused_ = true;
+    if (keep_alive)
+        resume();
+}
+
+// Called when the handler is done with a request.
+template <class Impl>
+void
+Peer<Impl>::finish (std::shared_ptr <Request> const& request,
+    bool keep_alive)
+{
+    request->complete_ = true;
+    request->keep_alive_ = keep_alive;
+
+    // Responses are sent in the order of the requests
+    while (! requests_.empty() && requests_.front()->complete_)
+    {
+        auto const front = std::move (requests_.front());
+        requests_.pop_front();
+
+        if (! front->keep_alive_)
+        {
+            // Later responses are never sent
+            requests_.clear();
+            paused_ = false;
+            graceful_ = true;
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                if (! write_queue_.empty())
+                    return;
+            }
+            return do_close();
+        }
+
+        if (requests_.empty())
+            break;
+
+        bool start;
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            auto& next = *requests_.front();
+            next.head_ = true;
+            start = write_queue_.empty() && ! next.pending_.empty();
+            write_queue_.splice (write_queue_.end(), next.pending_);
+        }
+
+        if (start)
+            boost::asio::spawn (strand_, std::bind (&Peer<Impl>::do_write,
+                impl().shared_from_this(), std::placeholders::_1));
+    }
+
+    resume();
+}
+
+// Starts reading the next request if the reader is waiting for room
+template <class Impl>
+void
+Peer<Impl>::resume()
+{
+    if (! paused_ || graceful_ || requests_.size() >= pipeline_)
+        return;
+
+    paused_ = false;
+    boost::asio::spawn (strand_, std::bind (&Peer<Impl>::do_read,
+        impl().shared_from_this(), std::placeholders::_1));
+}
+
 //------------------------------------------------------------------------------
 
 // Send a copy of the data.
@@ -553,18 +785,9 @@ Peer<Impl>::complete()
         return strand_.post(std::bind (&Peer<Impl>::complete,
             impl().shared_from_this()));
 
-    message_ = beast::http::message{};
-    complete_ = true;
-
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (! write_queue_.empty())
-            return;
-    }
-
     // keep-alive
-    boost::asio::spawn (strand_, std::bind (&Peer<Impl>::do_read,
-        impl().shared_from_this(), std::placeholders::_1));
+    paused_ = true;
+    resume();
 }
 
 // DEPRECATED
@@ -578,7 +801,7 @@ Peer<Impl>::close (bool graceful)
             (void(Peer::*)(bool))&Peer<Impl>::close,
                 impl().shared_from_this(), graceful));
 
-    complete_ = true;
+    paused_ = false;
     if (graceful)
     {
         graceful_ = true;
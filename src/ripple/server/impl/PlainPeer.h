@@ -99,7 +99,7 @@ PlainPeer::do_request()
     if (ec)
         return fail (ec, "request");
     // legacy
-    door_.server().handler().onRequest (session());
+    dispatch();
 }
 
 void
@@ -91,10 +91,10 @@ SSLPeer::do_handshake (yield_context yield)
 {
     error_code ec;
     stream_.set_verify_mode (boost::asio::ssl::verify_none);
-    start_timer();
+    start_timer (timer_);
     read_buf_.consume(stream_.async_handshake(
         stream_type::server, read_buf_.data(), yield[ec]));
-    cancel_timer();
+    cancel_timer (timer_);
     if (ec)
         return fail (ec, "handshake");
     bool const http =
@@ -121,13 +121,13 @@ SSLPeer::do_request()
     if (what.response)
         return write(what.response, what.keep_alive);
     // legacy
-    door_.server().handler().onRequest (session());
+    dispatch();
 }
 
 void
 SSLPeer::do_close()
 {
-    start_timer();
+    start_timer (timer_);
     stream_.async_shutdown (strand_.wrap (std::bind (
         &SSLPeer::on_shutdown, shared_from_this(),
             std::placeholders::_1)));
@@ -136,7 +136,7 @@ SSLPeer::do_close()
 void
 SSLPeer::on_shutdown (error_code ec)
 {
-    cancel_timer();
+    cancel_timer (timer_);
     stream_.lowest_layer().close(ec);
 }
 
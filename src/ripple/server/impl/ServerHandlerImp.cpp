@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/server/JsonWriter.h>
 #include <ripple/server/make_ServerHandler.h>
@@ -35,6 +36,8 @@
 #include <ripple/rpc/impl/Tuning.h>
 #include <beast/crypto/base64.h>
 #include <ripple/rpc/RPCHandler.h>
+#include <ripple/rpc/RPCResponseCache.h>
+#include <ripple/rpc/RPCStats.h>
 #include <beast/http/rfc2616.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/type_traits.hpp>
@@ -65,6 +68,7 @@ ServerHandlerImp::ServerHandlerImp (Application& app, Stoppable& parent,
     , m_server (HTTP::make_Server(
         *this, io_service, app_.journal("Server")))
     , m_jobQueue (jobQueue)
+    , scrape_ (cm.scrape ())
 {
     auto const& group (cm.group ("rpc"));
     rpc_requests_ = group->make_counter ("requests");
@@ -177,6 +181,30 @@ ServerHandlerImp::onRequest (HTTP::Session& session)
         return;
     }
 
+    // The metrics are written here rather than from a job, as reading
+    // them takes no lock a job could hold and they are most wanted when
+    // the job queue is backed up.
+    if (isMetricsRequest (session.request()))
+    {
+        if (requestRole (Role::ADMIN, session.port(), Json::objectValue,
+                session.remoteAddress(), session.user()) != Role::ADMIN)
+        {
+            HTTPReply (403, "Forbidden", makeOutput (session),
+                app_.journal ("RPC"));
+            session.close (true);
+            return;
+        }
+
+        HTTPReply (200, scrape_->render(),
+            beast::insight::ScrapeCollector::contentType,
+                makeOutput (session), app_.journal ("RPC"));
+        if (session.request().keep_alive())
+            session.complete();
+        else
+            session.close (true);
+        return;
+    }
+
     m_jobQueue.postCoro(jtCLIENT, "RPC-Client",
         [this, detach = session.detach()](std::shared_ptr<JobCoro> jc)
         {
@@ -198,14 +226,64 @@ ServerHandlerImp::onStopped (HTTP::Server&)
 
 //------------------------------------------------------------------------------
 
+// Returns the hash of the validated ledger a request names, or zero if it
+// names no ledger or one that may not be validated.
+static
+uint256
+pinnedLedger (LedgerMaster& ledgerMaster, Json::Value const& params)
+{
+    if (params.isMember (jss::ledger))
+        return zero;
+
+    uint256 hash;
+    if (params.isMember (jss::ledger_hash))
+    {
+        auto const& value = params[jss::ledger_hash];
+        if (! value.isString () || ! hash.SetHex (value.asString ()))
+            return zero;
+        return hash;
+    }
+
+    auto const& index = params[jss::ledger_index];
+    if (index.isIntegral ())
+    {
+        if (index.asInt () <= 0 ||
+            index.asUInt () > ledgerMaster.getValidLedgerIndex ())
+            return zero;
+        return ledgerMaster.getHashBySeq (index.asUInt ());
+    }
+    if (index.isString () && index.asString () == "validated")
+    {
+        if (auto const ledger = ledgerMaster.getValidatedLedger ())
+            return ledger->info().hash;
+    }
+    return zero;
+}
+
+// Returns true if a reply is from a validated ledger with the hash.
+static
+bool
+isPinnedReply (Json::Value const& reply, uint256 const& hash)
+{
+    auto const& result = reply[jss::result];
+    return result[jss::status] == jss::success &&
+        result[jss::validated] == true &&
+        result[jss::ledger_hash] == to_string (hash);
+}
+
 // Run as a couroutine.
 void
 ServerHandlerImp::processSession (std::shared_ptr<HTTP::Session> const& session,
     std::shared_ptr<JobCoro> jobCoro)
 {
+    // Replies are streamed to HTTP/1.1 clients, which must accept a
+    // chunked body.
+    bool const streaming =
+        session->request().version() >= std::make_pair (1, 1);
+
     processRequest (session->port(), to_string (session->body()),
-        session->remoteAddress().at_port (0), makeOutput (*session), jobCoro,
-        session->forwarded_for(), session->user());
+        session->remoteAddress().at_port (0), makeOutput (*session),
+        streaming, jobCoro, session->forwarded_for(), session->user());
 
     if (session->request().keep_alive())
         session->complete();
@@ -216,7 +294,7 @@ ServerHandlerImp::processSession (std::shared_ptr<HTTP::Session> const& session,
 void
 ServerHandlerImp::processRequest (HTTP::Port const& port,
     std::string const& request, beast::IP::Endpoint const& remoteIPAddress,
-        Output&& output, std::shared_ptr<JobCoro> jobCoro,
+        Output&& output, bool streaming, std::shared_ptr<JobCoro> jobCoro,
         std::string forwardedFor, std::string user)
 {
     auto rpcJ = app_.journal ("RPC");
@@ -224,6 +302,7 @@ ServerHandlerImp::processRequest (HTTP::Port const& port,
     assert (app_.getJobQueue().getJobForThread());
 
     Json::Value jsonRPC;
+    auto const parseStart = std::chrono::steady_clock::now ();
     {
         Json::Reader reader;
         if ((request.size () > RPC::Tuning::maxRequestSize) ||
@@ -235,6 +314,7 @@ ServerHandlerImp::processRequest (HTTP::Port const& port,
             return;
         }
     }
+    auto const parsed = std::chrono::steady_clock::now () - parseStart;
 
     // Parse id now so errors from here on will have the id
     //
@@ -352,47 +432,93 @@ ServerHandlerImp::processRequest (HTTP::Port const& port,
     RPC::Context context {m_journal, params, app_, loadType, m_networkOPs,
         app_.getLedgerMaster(), role, jobCoro, InfoSub::pointer(),
         {user, forwardedFor}};
-    Json::Value result;
-    RPC::doCommand (context, result);
 
-    // Always report "status".  On an error report the request as received.
-    if (result.isMember (jss::error))
+    if (! user.empty() || ! forwardedFor.empty())
+        m_journal.debug << "start command: " << strMethod <<
+            ", X-User: " << user << ", X-Forwarded-For: " << forwardedFor;
+
+    // Only the beginning of the reply is kept for the log.
+    static const std::size_t maxSize = 10000;
+    bool const logReply = m_journal.info.active();
+    std::string logged;
+    auto const capture = [&](boost::string_ref const& b)
+    {
+        if (logReply && logged.size() < maxSize)
+            logged.append (b.data(),
+                std::min (b.size(), maxSize - logged.size()));
+    };
+
+    // Queries against a validated ledger may be answered from the cache
+    auto& cache = app_.getRPCResponseCache ();
+    uint256 pinned;
+    if (cache.enabled () && cache.cacheable (strMethod))
+        pinned = pinnedLedger (app_.getLedgerMaster (), params);
+
+    std::size_t size;
+    if (pinned.isNonZero ())
+    {
+        auto const key = RPCResponseCache::makeKey (
+            strMethod, params, isUnlimited (role), pinned);
+        auto response = cache.find (key);
+        if (! response)
+        {
+            auto const reply = RPC::executeRPC (context);
+            std::string s;
+            Json::outputJson (reply, Json::stringOutput (s));
+            if (isPinnedReply (reply, pinned))
+                response = cache.insert (key, std::move (s));
+            else
+                response = std::make_shared<std::string const> (
+                    std::move (s));
+        }
+        capture (*response);
+        size = response->size ();
+        HTTPReply (200, *response + '\n', output, rpcJ);
+    }
+    else if (streaming)
     {
-        result[jss::status] = jss::error;
-        result[jss::request] = params;
-        JLOG (m_journal.debug)  <<
-            "rpcError: " << result [jss::error] <<
-            ": " << result [jss::error_message];
+        // The reply is serialized straight into the session as the
+        // handler produces it, without building the whole string.
+        HTTPChunkedReply reply (200, output);
+        RPC::executeRPC (context,
+            [&](boost::string_ref const& b)
+            {
+                capture (b);
+                reply.write (b);
+            });
+        size = reply.size ();
+        reply.write ("\n");
+        reply.finish ();
     }
     else
     {
-        result[jss::status]  = jss::success;
+        std::string response;
+        RPC::executeRPC (context, Json::stringOutput (response));
+        capture (response);
+        size = response.size ();
+        response += '\n';
+        HTTPReply (200, response, output, rpcJ);
     }
 
-    Json::Value reply (Json::objectValue);
-    reply[jss::result] = std::move (result);
-    auto response = to_string (reply);
+    if (! user.empty() || ! forwardedFor.empty())
+        m_journal.debug << "finish command: " << strMethod <<
+            ", X-User: " << user << ", X-Forwarded-For: " << forwardedFor;
 
     rpc_time_.notify (static_cast <beast::insight::Event::value_type> (
         std::chrono::duration_cast <std::chrono::milliseconds> (
             std::chrono::high_resolution_clock::now () - start)));
     ++rpc_requests_;
     rpc_size_.notify (static_cast <beast::insight::Event::value_type> (
-        response.size ()));
+        size));
 
-    response += '\n';
-    usage.charge (loadType);
+    auto& stats = app_.getRPCStats ();
+    stats.add (strMethod, RPCStats::Stage::parse, parsed);
+    stats.addReply (strMethod, size);
 
-    if (m_journal.info.active())
-    {
-        static const int maxSize = 10000;
-        if (response.size() <= maxSize)
-            m_journal.info << "Reply: " << response;
-        else
-            m_journal.info << "Reply: " << response.substr (0, maxSize);
-    }
+    usage.charge (loadType);
 
-    HTTPReply (200, response, output, rpcJ);
+    if (logReply)
+        m_journal.info << "Reply: " << logged;
 }
 
 //------------------------------------------------------------------------------
@@ -407,6 +533,16 @@ ServerHandlerImp::isWebsocketUpgrade (beast::http::message const& request)
     return false;
 }
 
+// Returns `true` if the HTTP request is a GET of the metrics, and they
+// are collected for scraping
+bool
+ServerHandlerImp::isMetricsRequest (beast::http::message const& request)
+{
+    return scrape_ &&
+        request.method() == beast::http::method_t::http_get &&
+        request.url() == "/metrics";
+}
+
 // VFALCO TODO Rewrite to use beast::http::headers
 bool
 ServerHandlerImp::authorized (HTTP::Port const& port,
@@ -459,6 +595,10 @@ ServerHandler::Setup::makeContexts()
             else
                 p.context = make_SSLContextAuthed (
                     p.ssl_key, p.ssl_cert, p.ssl_chain);
+
+            // Clients reconnecting to RPC ports skip the full handshake
+            if (p.protocol.count("peer") == 0)
+                enableSessionResumption (*p.context);
         }
         else
         {
@@ -483,6 +623,10 @@ struct ParsedPort
     std::string ssl_key;
     std::string ssl_cert;
     std::string ssl_chain;
+    std::size_t pipeline = 1;
+    SendLimits send_queue;
+    bool permessage_deflate = false;
+    bool deflate_context_takeover = false;
 
     boost::optional<boost::asio::ip::address> ip;
     boost::optional<std::uint16_t> port;
@@ -616,6 +760,28 @@ parse_Port (ParsedPort& port, Section const& section, std::ostream& log)
     set(port.ssl_key, "ssl_key", section);
     set(port.ssl_cert, "ssl_cert", section);
     set(port.ssl_chain, "ssl_chain", section);
+    set(port.pipeline, "pipeline", section);
+    set(port.send_queue.bytes, "send_queue_limit", section);
+    port.permessage_deflate = get<bool>(
+        section, "permessage_deflate", false);
+    port.deflate_context_takeover = get<bool>(
+        section, "deflate_context_takeover", false);
+
+    {
+        auto const result = section.find("send_queue_policy");
+        if (result.second)
+        {
+            auto const policy = to_SendPolicy (result.first);
+            if (! policy)
+            {
+                log << "Invalid value '" << result.first <<
+                    "' for key 'send_queue_policy' in [" <<
+                        section.name() << "]\n";
+                Throw<std::exception> ();
+            }
+            port.send_queue.policy = *policy;
+        }
+    }
 }
 
 HTTP::Port
@@ -669,6 +835,10 @@ to_Port(ParsedPort const& parsed, std::ostream& log)
     p.ssl_key = parsed.ssl_key;
     p.ssl_cert = parsed.ssl_cert;
     p.ssl_chain = parsed.ssl_chain;
+    p.pipeline = parsed.pipeline;
+    p.send_queue = parsed.send_queue;
+    p.permessage_deflate = parsed.permessage_deflate;
+    p.deflate_context_takeover = parsed.deflate_context_takeover;
 
     return p;
 }
@@ -46,6 +46,7 @@ private:
     beast::insight::Counter rpc_requests_;
     beast::insight::Event rpc_size_;
     beast::insight::Event rpc_time_;
+    std::shared_ptr<beast::insight::ScrapeCollector> scrape_;
 
 public:
     ServerHandlerImp (Application& app, Stoppable& parent,
@@ -114,7 +115,7 @@ private:
     void
     processRequest (HTTP::Port const& port, std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress, Output&&,
-        std::shared_ptr<JobCoro> jobCoro,
+        bool streaming, std::shared_ptr<JobCoro> jobCoro,
         std::string forwardedFor, std::string user);
 
     //
@@ -128,6 +129,9 @@ private:
     bool
     isWebsocketUpgrade (beast::http::message const& request);
 
+    bool
+    isMetricsRequest (beast::http::message const& request);
+
     bool
     authorized (HTTP::Port const& port,
         std::map<std::string, std::string> const& h);
@@ -0,0 +1,95 @@
+#include <BeastConfig.h>
+#include <ripple/server/impl/JSONRPCUtil.h>
+#include <beast/unit_test/suite.h>
+#include <cstdlib>
+#include <string>
+
+namespace ripple {
+
+class JSONRPCUtil_test : public beast::unit_test::suite
+{
+public:
+    // Reassembles a chunked body, returns false if it is malformed.
+    static
+    bool
+    unchunk (std::string const& body, std::string& content,
+        std::size_t& chunks)
+    {
+        std::size_t pos = 0;
+        chunks = 0;
+        for (;;)
+        {
+            auto const eol = body.find ("\r\n", pos);
+            if (eol == std::string::npos)
+                return false;
+            auto const size = std::strtoul (
+                body.substr (pos, eol - pos).c_str (), nullptr, 16);
+            pos = eol + 2;
+            if (body.compare (pos + size, 2, "\r\n") != 0)
+                return false;
+            if (size == 0)
+                return pos + 2 == body.size ();
+            content.append (body, pos, size);
+            pos += size + 2;
+            ++chunks;
+        }
+    }
+
+    void
+    testChunked ()
+    {
+        testcase ("chunked");
+
+        std::string out;
+        std::string expected;
+        {
+            HTTPChunkedReply reply (200, Json::stringOutput (out), 100);
+            for (int i = 0; i < 50; ++i)
+            {
+                auto const s = std::to_string (i) + ",";
+                reply.write (s);
+                expected += s;
+            }
+            expect (reply.size () == expected.size ());
+            reply.finish ();
+        }
+
+        expect (out.compare (0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+        expect (out.find ("Transfer-Encoding: chunked\r\n") !=
+            std::string::npos);
+        auto const headerEnd = out.find ("\r\n\r\n");
+        if (! expect (headerEnd != std::string::npos))
+            return;
+
+        std::string content;
+        std::size_t chunks;
+        expect (unchunk (out.substr (headerEnd + 4), content, chunks));
+        expect (content == expected);
+        expect (chunks == 2);
+    }
+
+    void
+    testEmpty ()
+    {
+        testcase ("empty");
+
+        std::string out;
+        HTTPChunkedReply reply (200, Json::stringOutput (out));
+        reply.finish ();
+        auto const headerEnd = out.find ("\r\n\r\n");
+        if (! expect (headerEnd != std::string::npos))
+            return;
+        expect (out.substr (headerEnd + 4) == "0\r\n\r\n");
+    }
+
+    void
+    run ()
+    {
+        testChunked ();
+        testEmpty ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JSONRPCUtil,server,ripple);
+
+}
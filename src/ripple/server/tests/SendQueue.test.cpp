@@ -0,0 +1,129 @@
+#include <BeastConfig.h>
+#include <ripple/server/SendQueue.h>
+#include <beast/unit_test/suite.h>
+#include <string>
+
+namespace ripple {
+
+class SendQueue_test : public beast::unit_test::suite
+{
+public:
+    static
+    SendLimits
+    limits (std::size_t bytes, SendPolicy policy)
+    {
+        SendLimits limits;
+        limits.bytes = bytes;
+        limits.policy = policy;
+        return limits;
+    }
+
+    void
+    testDisconnect ()
+    {
+        testcase ("disconnect");
+
+        SendQueue<int> q (limits (100, SendPolicy::disconnect));
+        expect (q.fits (60, 40));
+        expect (! q.fits (60, 41));
+
+        expect (q.push (1, 30, {}, 40));
+        expect (! q.fits (10, 0));
+        expect (q.push (2, 30, {}, 40));
+        expect (q.bytes () == 60);
+
+        // The transport holds more now
+        expect (! q.push (3, 1, {}, 40));
+        expect (q.empty ());
+        expect (q.bytes () == 0);
+        expect (q.dropped () == 3);
+    }
+
+    void
+    testDropOldest ()
+    {
+        testcase ("drop oldest");
+
+        SendQueue<int> q (limits (100, SendPolicy::dropOldest));
+        for (int i = 0; i < 10; ++i)
+            expect (q.push (i, 20));
+        expect (q.size () == 5);
+        expect (q.bytes () == 100);
+        expect (q.dropped () == 5);
+        expect (q.pop () == 5);
+
+        // The newest message is kept even when it is too large
+        expect (q.push (10, 500));
+        expect (q.size () == 1);
+        expect (q.pop () == 10);
+        expect (q.empty ());
+        expect (q.bytes () == 0);
+
+        SendLimits count;
+        count.messages = 3;
+        count.policy = SendPolicy::dropOldest;
+        SendQueue<int> c (count);
+        for (int i = 0; i < 5; ++i)
+            c.push (i, 1);
+        expect (c.size () == 3);
+        expect (c.pop () == 2);
+    }
+
+    void
+    testCoalesce ()
+    {
+        testcase ("coalesce");
+
+        SendQueue<std::string> q (limits (100, SendPolicy::coalesce));
+        q.push ("ledger 1", 20, "ledgerClosed");
+        q.push ("tx 1", 20);
+        q.push ("ledger 2", 20, "ledgerClosed");
+        q.push ("server 1", 10, "serverStatus");
+        q.push ("tx 2", 20);
+        expect (q.size () == 5);
+        expect (q.dropped () == 0);
+
+        // Superseded events go first
+        q.push ("ledger 3", 20, "ledgerClosed");
+        expect (q.dropped () == 2);
+        expect (q.bytes () == 70);
+        expect (q.pop () == "tx 1");
+        expect (q.pop () == "server 1");
+        expect (q.pop () == "tx 2");
+        expect (q.pop () == "ledger 3");
+        expect (q.empty ());
+
+        // Then the oldest
+        for (int i = 0; i < 6; ++i)
+            q.push ("tx", 20);
+        expect (q.size () == 5);
+        expect (q.dropped () == 3);
+    }
+
+    void
+    testPolicies ()
+    {
+        testcase ("policies");
+
+        expect (to_SendPolicy ("disconnect") == SendPolicy::disconnect);
+        expect (to_SendPolicy ("drop_oldest") == SendPolicy::dropOldest);
+        expect (to_SendPolicy ("coalesce") == SendPolicy::coalesce);
+        expect (! to_SendPolicy ("drop"));
+
+        SendQueue<int> q (limits (0, SendPolicy::disconnect));
+        expect (q.fits (1000000000, 1000000000));
+    }
+
+    void
+    run ()
+    {
+        testDisconnect ();
+        testDropOldest ();
+        testCoalesce ();
+        testPolicies ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SendQueue,server,ripple);
+
+} // ripple
@@ -283,6 +283,40 @@ public:
         }
     }
 
+    void
+    test_pipeline()
+    {
+        boost::asio::io_service ios;
+        using socket = boost::asio::ip::tcp::socket;
+        socket s (ios);
+
+        if (! connect (s, "127.0.0.1", testPort))
+            return;
+
+        // Both requests are sent before either response is read
+        if (! write (s,
+            "GET / HTTP/1.1\r\n"
+            "Connection: Keep-Alive\r\n"
+            "\r\n"
+            "GET / HTTP/1.1\r\n"
+            "Connection: close\r\n"
+            "\r\n"))
+            return;
+
+        try
+        {
+            std::string const match = "Hello, world!\n";
+            std::string got (2 * match.size(), 0);
+            boost::asio::read (s, boost::asio::buffer (&got[0], got.size()));
+            expect (got == match + match);
+            s.shutdown (socket::shutdown_both);
+        }
+        catch (std::exception const& e)
+        {
+            fail (e.what());
+        }
+    }
+
     void
     run()
     {
@@ -299,9 +333,11 @@ public:
         list.back().ip = boost::asio::ip::address::from_string (
             "127.0.0.1");
         list.back().protocol.insert("http");
+        list.back().pipeline = 4;
         s->ports (list);
 
         test_request();
+        test_pipeline();
         //test_keepalive();
         //s->close();
         s = nullptr;
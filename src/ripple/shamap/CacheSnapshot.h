@@ -0,0 +1,74 @@
+#ifndef RIPPLE_SHAMAP_CACHESNAPSHOT_H_INCLUDED
+#define RIPPLE_SHAMAP_CACHESNAPSHOT_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/shamap/Family.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+
+namespace ripple {
+
+/** The keys of the nodes a family holds in its caches, as a memory-mapped
+    file.
+
+    Written when the server stops, and loaded when it starts again, so
+    the tree node cache and the node store cache are filled before
+    clients are served instead of by their first requests. Only the keys
+    are kept: loading fetches the nodes from the node store, on several
+    threads at once.
+*/
+class CacheSnapshot
+{
+public:
+    /** Write the keys of the tree node cache and of the node store cache.
+
+        The file is written under a temporary name and renamed, so an
+        existing snapshot is only replaced by a complete one.
+        Throws on I/O errors.
+    */
+    static
+    void
+    write (boost::filesystem::path const& path, Family& family);
+
+    /** Map an existing snapshot. Throws if it is not a valid snapshot. */
+    explicit
+    CacheSnapshot (boost::filesystem::path const& path);
+
+    CacheSnapshot (CacheSnapshot const&) = delete;
+    CacheSnapshot& operator= (CacheSnapshot const&) = delete;
+
+    /** The number of tree nodes. */
+    std::uint64_t
+    treeNodes () const
+    {
+        return treeNodes_;
+    }
+
+    /** The number of other nodes, only kept in the node store cache. */
+    std::uint64_t
+    nodes () const
+    {
+        return nodes_;
+    }
+
+    /** Fetch the nodes into the caches of a family.
+        @return The number of nodes found in the node store.
+    */
+    std::uint64_t
+    load (Family& family, std::size_t threads) const;
+
+private:
+    uint256
+    key (std::uint64_t i) const;
+
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    std::uint64_t treeNodes_;
+    std::uint64_t nodes_;
+};
+
+} // ripple
+
+#endif
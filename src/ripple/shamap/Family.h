@@ -22,6 +22,7 @@
 
 #include <ripple/basics/Log.h>
 #include <ripple/shamap/FullBelowCache.h>
+#include <ripple/shamap/SerializedNodeCache.h>
 #include <ripple/shamap/TreeNodeCache.h>
 #include <ripple/nodestore/Database.h>
 #include <beast/utility/Journal.h>
@@ -54,6 +55,11 @@ public:
     TreeNodeCache const&
     treecache() const = 0;
 
+    /** Returns the cache of nodes served to peers, nullptr if none. */
+    virtual
+    SerializedNodeCache*
+    serialcache() = 0;
+
     virtual
     NodeStore::Database&
     db() = 0;
@@ -62,6 +68,20 @@ public:
     NodeStore::Database const&
     db() const = 0;
 
+    /** Returns the threads a SHAMap may use to hash and write its
+        changed subtrees.
+    */
+    virtual
+    unsigned
+    walkThreads() const = 0;
+
+    /** Returns the node store reads a SHAMap being acquired keeps
+        outstanding while it fans out below the nodes it has, 0 for none.
+    */
+    virtual
+    int
+    prefetchWindow() const = 0;
+
     virtual
     void
     missing_node (std::uint32_t refNum) = 0;
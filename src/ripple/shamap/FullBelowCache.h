@@ -83,6 +83,18 @@ public:
         return m_cache.size ();
     }
 
+    /** Set the number of elements kept when they are not yet expired. */
+    void setTargetSize (size_type s)
+    {
+        m_cache.setTargetSize (s);
+    }
+
+    /** Return the number of hits, then of misses. */
+    std::pair <std::uint64_t, std::uint64_t> getHitsAndMisses () const
+    {
+        return m_cache.getHitsAndMisses ();
+    }
+
     /** Remove expired cache items.
         Thread safety:
             Safe to call from any thread.
@@ -28,6 +28,7 @@
 #include <ripple/shamap/SHAMapNodeID.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/shamap/SerializedNodeCache.h>
 #include <ripple/shamap/TreeNodeCache.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/nodestore/Database.h>
@@ -37,6 +38,7 @@
 #include <boost/thread/shared_lock_guard.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <cassert>
+#include <functional>
 #include <stack>
 #include <vector>
 
@@ -96,6 +98,14 @@ public:
                                 std::shared_ptr<SHAMapItem const>>;
     using Delta     = std::map<uint256, DeltaItem>;
 
+    /** Called with an item of this map and the item of the other map with
+        the same key, either null where a map has none. Returns false to
+        stop the walk.
+    */
+    using DeltaVisitor = std::function<bool (uint256 const& key,
+        std::shared_ptr<SHAMapItem const> const& ours,
+        std::shared_ptr<SHAMapItem const> const& theirs)>;
+
     ~SHAMap ();
     SHAMap(SHAMap const&) = delete;
     SHAMap& operator=(SHAMap const&) = delete;
@@ -141,7 +151,6 @@ public:
     bool hasItem (uint256 const& id) const;
     bool delItem (uint256 const& id);
     bool addItem (SHAMapItem const& i, bool isTransaction, bool hasMeta);
-    bool addItem (SHAMapItem&& i, bool isTransaction, bool hasMeta);
     SHAMapHash getHash () const;
 
     // save a copy if you have a temporary anyway
@@ -150,6 +159,16 @@ public:
     bool addGiveItem (std::shared_ptr<SHAMapItem const> const&,
                       bool isTransaction, bool hasMeta);
 
+    /** Fill an empty map with items, building the tree bottom-up.
+        The resulting map is the same as adding the items one at a time.
+        @param items Items in strictly ascending key order.
+        @return false if the map is not empty or the keys are not
+                strictly ascending, the map is unchanged then.
+    */
+    bool addSortedItems (
+        std::vector<std::shared_ptr<SHAMapItem const>> const& items,
+            bool isTransaction, bool hasMeta);
+
     /** Fetch an item given its key.
         This retrieves the item whose key matches.
         If the item does not exist, an empty pointer is returned.
@@ -160,6 +179,21 @@ public:
     std::shared_ptr<SHAMapItem const> const&
         fetch (uint256 const& key) const;
 
+    /** Start reading the nodes on the paths to these keys.
+        Returns without waiting. Each call follows the paths as far as the
+        nodes in memory reach, including those read since the last call,
+        and posts reads of the nodes where they stop. Calls made while
+        other work goes on bring the paths in a level at a time.
+    */
+    void prefetch (std::vector<uint256> const& keys) const;
+
+    /** Start reading the nodes which follow an item, in key order.
+        Returns without waiting. Up to count nodes are visited, and reads
+        are posted for those not in memory. The children of nodes read
+        since the last call are visited as well.
+    */
+    void prefetchAfter (const_iterator const& it, std::size_t count) const;
+
     // Save a copy if you need to extend the life
     // of the SHAMapItem beyond this SHAMap
     std::shared_ptr<SHAMapItem const> const& peekItem (uint256 const& id) const;
@@ -172,26 +206,61 @@ public:
     const_iterator upper_bound(uint256 const& id) const;
 
     void visitNodes (std::function<bool (SHAMapAbstractNode&)> const&) const;
+
+    /** Visit every node, the subtrees below the root on several threads.
+        The root is visited first. The function is called on up to
+        `threads` threads at once, and the walk stops soon after it
+        returns true.
+    */
+    void visitNodes (std::function<bool (SHAMapAbstractNode&)> const&,
+        std::size_t threads) const;
     void
         visitLeaves(
             std::function<void(std::shared_ptr<SHAMapItem const> const&)> const&) const;
 
+    /** The leaves of a partition of the map, with its index. */
+    using PartitionVisitor = std::function<void (std::size_t partition,
+        SHAMapItem const& item)>;
+
+    /** Visit the leaves of the map split into partitions, on several threads.
+        The partitions are the subtrees `depth` levels below the root, so
+        there are 16^depth of them, numbered in key order; a leaf above
+        that depth belongs to the partition its key falls in. The leaves of
+        a partition are visited in key order by one thread, and the
+        function is called on up to `threads` threads at once. Each thread
+        posts reads of the nodes of the partitions taken after its own
+        before it walks it. Results kept per partition and merged in index
+        order are the same as those of a serial walk.
+        @param depth From 0, the whole map, to maxPartitionDepth.
+        @return The number of partitions.
+    */
+    std::size_t visitPartitions (int depth, std::size_t threads,
+        PartitionVisitor const& function) const;
+
+    static int const maxPartitionDepth = 4;
+
     // comparison/sync functions
     void getMissingNodes (std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>& hashes, int max,
                           SHAMapSyncFilter * filter);
 
     bool getNodeFat (SHAMapNodeID node,
         std::vector<SHAMapNodeID>& nodeIDs,
-            std::vector<Blob>& rawNode,
+            std::vector<SerializedNode::pointer>& rawNode,
                 bool fatLeaves, std::uint32_t depth) const;
 
     bool getRootNode (Serializer & s, SHANodeFormat format) const;
+
+    /** Returns a node of this map in the format, from the family's cache
+        of served nodes when it has one.
+    */
+    SerializedNode::pointer
+    serialize (SHAMapAbstractNode const& node, SHANodeFormat format) const;
     std::vector<uint256> getNeededHashes (int max, SHAMapSyncFilter * filter);
-    SHAMapAddNode addRootNode (SHAMapHash const& hash, Blob const& rootNode,
+    SHAMapAddNode addRootNode (SHAMapHash const& hash, Slice const& rootNode,
                                SHANodeFormat format, SHAMapSyncFilter * filter);
-    SHAMapAddNode addRootNode (Blob const& rootNode, SHANodeFormat format,
+    SHAMapAddNode addRootNode (Slice const& rootNode, SHANodeFormat format,
                                SHAMapSyncFilter * filter);
-    SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID, Blob const& rawNode,
+    SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID, Slice const& rawNode,
                                 SHAMapSyncFilter * filter);
 
     // status functions
@@ -206,14 +275,72 @@ public:
     bool compare (SHAMap const& otherMap,
                   Delta& differences, int maxCount) const;
 
+    /** Visit the items that differ from another map, in key order.
+
+        Branches with the same hash in both maps are not entered, and
+        nothing is collected: items are handed to the visitor as they
+        are found.
+
+        @return false if the visitor stopped the walk.
+        Throws SHAMapMissingNode on missing nodes.
+        CAUTION: otherMap is not locked and must be immutable.
+    */
+    bool visitDelta (SHAMap const& otherMap,
+                     DeltaVisitor const& visitor) const;
+
     int flushDirty (NodeObjectType t, std::uint32_t seq);
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
+
+    /** Find the nodes missing from the node store, keeping up to window
+        reads outstanding.
+
+        Unlike the walk above, a missing node does not end the walk and
+        the nodes read are not hooked into the map, so a whole state can
+        be checked without keeping it in memory. The walk ends early when
+        stopping returns true.
+    */
+    void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing,
+        int window, std::function<bool ()> const& stopping) const;
     bool deepCompare (SHAMap & other) const;
 
     using fetchPackEntry_t = std::pair <uint256, Blob>;
 
     void visitDifferences(SHAMap* have, std::function<bool(SHAMapAbstractNode&)>) const;
 
+    /** Where a walk over the nodes another map lacks has got to.
+
+        The nodes it points to belong to the map walked, which must be
+        immutable and outlive the cursor.
+    */
+    class DifferenceCursor
+    {
+    public:
+        /** Returns true once every node was visited. */
+        bool done () const
+        {
+            return started_ && ! node_ && stack_.empty ();
+        }
+
+    private:
+        friend class SHAMap;
+
+        bool started_ = false;
+        SHAMapInnerNode* node_ = nullptr;
+        SHAMapNodeID nodeID_;
+        int branch_ = 0;
+        std::vector<std::pair<SHAMapInnerNode*, SHAMapNodeID>> stack_;
+    };
+
+    /** Visit the nodes that have lacks, continuing from a cursor.
+
+        When func returns false the walk stops after that node, and a
+        later call with the same cursor goes on from there.
+
+        @return true if every node was visited.
+    */
+    bool visitDifferences (SHAMap* have, DifferenceCursor& cursor,
+        std::function<bool(SHAMapAbstractNode&)> const& func) const;
+
     void getFetchPack (SHAMap * have, bool includeLeaves, int max,
         std::function<void (uint256 const&, const Blob&)>) const;
 
@@ -248,6 +375,14 @@ private:
     void dirtyUp (SharedPtrNodeStack& stack,
                   uint256 const& target, std::shared_ptr<SHAMapAbstractNode> terminal);
 
+    using SortedItemIter =
+        std::vector<std::shared_ptr<SHAMapItem const>>::const_iterator;
+
+    /** Build the subtree holding at least two sorted items */
+    std::shared_ptr<SHAMapInnerNode>
+        makeInner (SortedItemIter first, SortedItemIter last,
+                   SHAMapNodeID const& nodeID, SHAMapTreeNode::TNType type);
+
     /** Get the path from the root to the specified node */
     SharedPtrNodeStack
         getStack (uint256 const& id, bool include_nonmatching_leaf) const;
@@ -274,14 +409,21 @@ private:
 
     // Simple descent
     // Get a child of the specified node
+    // Visit the nodes below an inner node, true if the function stopped
+    bool visitSubTree (std::shared_ptr<SHAMapInnerNode> node,
+        std::function<bool (SHAMapAbstractNode&)> const& function) const;
+
     SHAMapAbstractNode* descend (SHAMapInnerNode*, int branch) const;
     SHAMapAbstractNode* descendThrow (SHAMapInnerNode*, int branch) const;
     std::shared_ptr<SHAMapAbstractNode> descend (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
     std::shared_ptr<SHAMapAbstractNode> descendThrow (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
     // Descend with filter
+    void prefetchMissing (int window, int max, SHAMapSyncFilter* filter);
     SHAMapAbstractNode* descendAsync (SHAMapInnerNode* parent, int branch,
         SHAMapNodeID const& childID, SHAMapSyncFilter* filter, bool& pending) const;
+    void prefetchBranches (SHAMapInnerNode* inner, SHAMapNodeID const& nodeID,
+        int first, std::size_t& count) const;
 
     std::pair <SHAMapAbstractNode*, SHAMapNodeID>
         descend (SHAMapInnerNode* parent, SHAMapNodeID const& parentID,
@@ -300,10 +442,19 @@ private:
 
     SHAMapItem const* peekFirstItem(NodeStack& stack) const;
     SHAMapItem const* peekNextItem(uint256 const& id, NodeStack& stack) const;
+    bool walkDelta (SHAMapAbstractNode* ourNode, SHAMap const& otherMap,
+                    SHAMapAbstractNode* otherNode,
+                    DeltaVisitor const& visitor) const;
     bool walkBranch (SHAMapAbstractNode* node,
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
-                     bool isFirstMap, Delta & differences, int & maxCount) const;
+                     bool isFirstMap, DeltaVisitor const& visitor) const;
+    // Dirty nodes two levels below the root needed to flush in parallel
+    static int const minParallelWalk = 32;
+
     int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    std::shared_ptr<SHAMapInnerNode> walkSubTree (
+        std::shared_ptr<SHAMapInnerNode> node, bool doWrite,
+            NodeObjectType t, std::uint32_t seq, int& flushed);
 };
 
 inline
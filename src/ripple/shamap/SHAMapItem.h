@@ -22,57 +22,89 @@
 
 #include <ripple/basics/base_uint.h>
 #include <ripple/basics/Blob.h>
+#include <ripple/basics/MemoryTag.h>
 #include <ripple/basics/Slice.h>
 #include <ripple/protocol/Serializer.h>
 #include <beast/utility/Journal.h>
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 
 namespace ripple {
 
 // an item stored in a SHAMap
+//
+// The item, its shared count and its data are a single heap block,
+// made by make_shamapitem.
 class SHAMapItem
 {
 private:
     uint256    tag_;
-    Blob       data_;
+    std::uint8_t const* data_;
+    std::size_t size_;
+
+    // Only make_shamapitem constructs items
+    struct PrivateAccess { };
+
+    friend
+    std::shared_ptr<SHAMapItem const>
+    make_shamapitem (uint256 const& tag, Slice data);
 
 public:
-    SHAMapItem (uint256 const& tag, Blob const & data);
-    SHAMapItem (uint256 const& tag, Serializer const& s);
-    SHAMapItem (uint256 const& tag, Serializer&& s);
+    SHAMapItem (std::uint8_t* const& payload,
+        uint256 const& tag, Slice data, PrivateAccess);
+
+    SHAMapItem (SHAMapItem const&) = delete;
+    SHAMapItem& operator= (SHAMapItem const&) = delete;
 
     Slice slice() const;
 
     uint256 const& key() const;
 
-    Blob const& peekData() const;
-
     std::size_t size() const;
     void const* data() const;
 };
 
+/** Make an item holding a copy of the data. */
+std::shared_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Slice data);
+
+inline
+std::shared_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Blob const& data)
+{
+    return make_shamapitem (tag, makeSlice (data));
+}
+
+inline
+std::shared_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Serializer const& s)
+{
+    return make_shamapitem (tag, s.slice ());
+}
+
 //------------------------------------------------------------------------------
 
 inline
 Slice
 SHAMapItem::slice() const
 {
-    return {data_.data(), data_.size()};
+    return {data_, size_};
 }
 
 inline
 std::size_t
 SHAMapItem::size() const
 {
-    return data_.size();
+    return size_;
 }
 
 inline
 void const*
 SHAMapItem::data() const
 {
-    return data_.data();
+    return data_;
 }
 
 inline
@@ -82,13 +114,6 @@ SHAMapItem::key() const
     return tag_;
 }
 
-inline
-Blob const&
-SHAMapItem::peekData() const
-{
-    return data_;
-}
-
 } // ripple
 
 #endif
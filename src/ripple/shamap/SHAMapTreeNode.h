@@ -22,13 +22,18 @@
 
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapNodeID.h>
+#include <ripple/basics/Slice.h>
 #include <ripple/basics/TaggedCache.h>
 #include <beast/utility/Journal.h>
 
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -122,9 +127,16 @@ public:
     virtual std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const = 0;
 
     static std::shared_ptr<SHAMapAbstractNode>
-        make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat format,
+        make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
              SHAMapHash const& hash, bool hashValid, beast::Journal j);
 
+    /** Updates the hashes of independent nodes, hashing them together.
+
+        Inner nodes first take the hashes of their children, as
+        updateHashDeep does.
+    */
+    static void updateHashes (std::vector<SHAMapAbstractNode*> const& nodes);
+
     // debugging
 #ifdef BEAST_DEBUG
     static void dump (SHAMapNodeID const&, beast::Journal journal);
@@ -134,16 +146,51 @@ public:
 class SHAMapInnerNode
     : public SHAMapAbstractNode
 {
-    SHAMapHash                      mHashes[16];
-    std::shared_ptr<SHAMapAbstractNode> mChildren[16];
-    int                             mIsBranch = 0;
+public:
+    /** Live inner nodes and the branch slots they hold. */
+    struct Counts
+    {
+        std::uint64_t nodes;
+        std::uint64_t slots;
+
+        // Bytes saved against sixteen slots in every node
+        std::uint64_t bytesSaved () const;
+    };
+
+private:
+    struct Branch
+    {
+        SHAMapHash                          hash;
+        std::shared_ptr<SHAMapAbstractNode> child;
+    };
+
+    // Only the populated branches are stored, in branch order: branch m
+    // is at the number of branches below m in mIsBranch. Most inner nodes
+    // near the leaves have a few branches, so the slots grow as needed.
+    std::unique_ptr<Branch[]>       mBranches;
+    std::uint16_t                   mIsBranch = 0;
+    std::uint8_t                    mCapacity = 0;
     std::uint32_t                   mFullBelowGen = 0;
 
-    static std::mutex               childLock;
+    // Children of shared nodes are hooked up under one of a set of locks
+    // picked by node address, so reads of different nodes rarely contend.
+    static std::array<std::mutex, 64> childLocks;
+    static SHAMapHash const         zeroHash;
+    static std::atomic<std::uint64_t> liveNodes;
+    static std::atomic<std::uint64_t> liveSlots;
+
+    std::mutex& childLock () const;
+    int index (int m) const;
+    void reserve (int capacity);
+    void setHashes (SHAMapHash const (&hashes)[16]);
+
 public:
     SHAMapInnerNode(std::uint32_t seq = 0);
+    ~SHAMapInnerNode ();
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
 
+    static Counts getCounts ();
+
     bool isEmpty () const;
     bool isEmptyBranch (int m) const;
     int getBranchCount () const;
@@ -162,11 +209,12 @@ public:
 
     bool updateHash () override;
     void updateHashDeep();
+    void updateChildHashes();
     void addRaw (Serializer&, SHANodeFormat format) const override;
     std::string getString (SHAMapNodeID const&) const override;
 
     friend std::shared_ptr<SHAMapAbstractNode>
-        SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq,
+        SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
              SHANodeFormat format, SHAMapHash const& hash, bool hashValid,
                  beast::Journal j);
 };
@@ -286,6 +334,15 @@ inline
 SHAMapInnerNode::SHAMapInnerNode(std::uint32_t seq)
     : SHAMapAbstractNode(tnINNER, seq)
 {
+    ++liveNodes;
+}
+
+inline
+int
+SHAMapInnerNode::index (int m) const
+{
+    return static_cast<int> (std::bitset<16> (
+        mIsBranch & ((1 << m) - 1)).count ());
 }
 
 inline
@@ -300,7 +357,9 @@ SHAMapHash const&
 SHAMapInnerNode::getChildHash (int m) const
 {
     assert ((m >= 0) && (m < 16) && (getType() == tnINNER));
-    return mHashes[m];
+    if (isEmptyBranch (m))
+        return zeroHash;
+    return mBranches[index (m)].hash;
 }
 
 inline
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef RIPPLE_SHAMAP_SERIALIZEDNODECACHE_H_INCLUDED
+#define RIPPLE_SHAMAP_SERIALIZEDNODECACHE_H_INCLUDED
+
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+#include <memory>
+
+namespace ripple {
+
+/** A tree node in one of its serialized formats. */
+class SerializedNode
+{
+public:
+    using pointer = std::shared_ptr<SerializedNode const>;
+
+    explicit
+    SerializedNode (Blob&& data)
+        : data_ (std::move (data))
+    {
+    }
+
+    /** Share the bytes of a node read from the node store. */
+    explicit
+    SerializedNode (std::shared_ptr<NodeObject> object)
+        : object_ (std::move (object))
+    {
+    }
+
+    Slice
+    slice () const
+    {
+        if (object_)
+            return object_->getData ();
+        return makeSlice (data_);
+    }
+
+private:
+    Blob data_;
+    std::shared_ptr<NodeObject> object_;
+};
+
+/** The serialized forms of recently served tree nodes, by node hash.
+
+    Nodes of the recent ledgers are asked for by every peer acquiring
+    them, so a node is serialized once for the wire and once with its
+    prefix for fetch packs, then copied into each reply. The prefix form
+    of a node read from the node store is that object's data, which is
+    shared rather than serialized again.
+
+    Only shared nodes are cached; their hash covers their contents.
+*/
+class SerializedNodeCache
+{
+public:
+    using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+
+    SerializedNodeCache (std::string const& name, int size,
+        clock_type::rep expiration, clock_type& clock,
+            beast::Journal journal);
+
+    /** Returns the node in the format, serializing it on a miss. */
+    SerializedNode::pointer
+    get (SHAMapAbstractNode const& node, SHANodeFormat format);
+
+    /** Offer a node object which holds a node's prefix form. */
+    void
+    share (std::shared_ptr<NodeObject> const& object);
+
+    void setTargetSize (int size);
+
+    void setTargetAge (clock_type::rep age);
+
+    void sweep ();
+
+    int getCacheSize () const;
+
+    float getHitRate ();
+
+private:
+    using Cache = ShardedTaggedCache <uint256, SerializedNode const>;
+
+    Cache wire_;
+    Cache prefix_;
+};
+
+/** Returns the node in the format, from the cache if there is one. */
+SerializedNode::pointer
+serializeNode (SerializedNodeCache* cache,
+    SHAMapAbstractNode const& node, SHANodeFormat format);
+
+} // ripple
+
+#endif
@@ -0,0 +1,146 @@
+#include <BeastConfig.h>
+#include <ripple/shamap/CacheSnapshot.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <boost/filesystem/operations.hpp>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace {
+
+char const snapshotMagic[8] = {'R', 'D', 'C', 'A', 'C', 'H', 'E', '1'};
+
+/** On-disk layout of the start of a snapshot, in host byte order.
+    The keys of the tree nodes follow, then the keys of the other nodes.
+*/
+struct FileHeader
+{
+    char magic[8];
+    std::uint64_t treeNodes;
+    std::uint64_t nodes;
+};
+
+}
+
+void
+CacheSnapshot::write (boost::filesystem::path const& path, Family& family)
+{
+    auto const treeKeys = family.treecache ().getKeys ();
+    hash_set<uint256> const tree (treeKeys.begin (), treeKeys.end ());
+    std::vector<uint256> nodeKeys;
+    for (auto const& key : family.db ().getCacheKeys ())
+    {
+        if (tree.count (key) == 0)
+            nodeKeys.push_back (key);
+    }
+
+    auto const temp = path.string () + ".tmp";
+    std::ofstream out (temp.c_str (), std::ios::binary | std::ios::trunc);
+    if (!out)
+        Throw<std::runtime_error> ("can not create " + temp);
+
+    FileHeader header {};
+    std::memcpy (header.magic, snapshotMagic, sizeof (header.magic));
+    header.treeNodes = treeKeys.size ();
+    header.nodes = nodeKeys.size ();
+    out.write (reinterpret_cast<char const*> (&header), sizeof (header));
+    for (auto const& key : treeKeys)
+        out.write (reinterpret_cast<char const*> (key.data ()), key.size ());
+    for (auto const& key : nodeKeys)
+        out.write (reinterpret_cast<char const*> (key.data ()), key.size ());
+
+    out.close ();
+    if (out.fail ())
+        Throw<std::runtime_error> ("can not write " + temp);
+
+    boost::filesystem::rename (temp, path);
+}
+
+CacheSnapshot::CacheSnapshot (boost::filesystem::path const& path)
+{
+    using namespace boost::interprocess;
+
+    file_mapping (path.string ().c_str (), read_only).swap (file_);
+    mapped_region (file_, read_only).swap (region_);
+
+    auto const size = region_.get_size ();
+    FileHeader header;
+    if (size < sizeof (header))
+        Throw<std::runtime_error> ("not a cache snapshot: " + path.string ());
+    std::memcpy (&header, region_.get_address (), sizeof (header));
+
+    if (std::memcmp (header.magic, snapshotMagic, sizeof (header.magic)) ||
+        (size - sizeof (header)) / uint256::bytes !=
+            header.treeNodes + header.nodes ||
+        (size - sizeof (header)) % uint256::bytes != 0)
+    {
+        Throw<std::runtime_error> ("not a cache snapshot: " + path.string ());
+    }
+
+    treeNodes_ = header.treeNodes;
+    nodes_ = header.nodes;
+}
+
+uint256
+CacheSnapshot::key (std::uint64_t i) const
+{
+    return uint256::fromVoid (static_cast<char const*> (
+        region_.get_address ()) + sizeof (FileHeader) + i * uint256::bytes);
+}
+
+std::uint64_t
+CacheSnapshot::load (Family& family, std::size_t threads) const
+{
+    auto const count = treeNodes_ + nodes_;
+    std::atomic<std::uint64_t> next (0);
+    std::atomic<std::uint64_t> found (0);
+
+    // Each worker takes keys in turn. Fetching puts a node in the node
+    // store cache, and a tree node is also made and kept in the tree
+    // node cache as a SHAMap would when reading it.
+    auto worker = [&]()
+    {
+        for (std::uint64_t i; (i = next++) < count;)
+        {
+            auto const hash = key (i);
+            auto const obj = family.db ().fetch (hash);
+            if (! obj)
+                continue;
+            ++found;
+            if (i >= treeNodes_)
+                continue;
+
+            try
+            {
+                auto node = SHAMapAbstractNode::make (
+                    obj->getData (), 0, snfPREFIX,
+                        SHAMapHash {hash}, true, family.journal ());
+                if (node)
+                    family.treecache ().canonicalize (hash, node);
+            }
+            catch (std::exception const&)
+            {
+                if (family.journal ().warning) family.journal ().warning <<
+                    "Invalid DB node " << hash;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i)
+        workers.emplace_back (worker);
+    worker ();
+    for (auto& w : workers)
+        w.join ();
+
+    return found;
+}
+
+} // ripple
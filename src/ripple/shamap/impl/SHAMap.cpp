@@ -21,6 +21,11 @@
 #include <ripple/basics/contract.h>
 #include <ripple/shamap/SHAMap.h>
 #include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 
@@ -164,6 +169,71 @@ SHAMapTreeNode* SHAMap::walkToPointer (uint256 const& id) const
     return ret->peekItem()->key() == id ? ret : nullptr;
 }
 
+void
+SHAMap::prefetch (std::vector<uint256> const& keys) const
+{
+    if (!backed_)
+        return;
+
+    for (auto const& key : keys)
+    {
+        auto node = root_.get();
+        SHAMapNodeID nodeID;
+        while (node && node->isInner ())
+        {
+            auto const inner = static_cast<SHAMapInnerNode*>(node);
+            int const branch = nodeID.selectBranch (key);
+            if (inner->isEmptyBranch (branch))
+                break;
+
+            nodeID = nodeID.getChildNodeID (branch);
+            bool pending = false;
+            node = descendAsync (inner, branch, nodeID, nullptr, pending);
+        }
+    }
+}
+
+void
+SHAMap::prefetchAfter (const_iterator const& it, std::size_t count) const
+{
+    if (!backed_ || !it.item_)
+        return;
+
+    // The nearest nodes are below the deepest inner node on the path
+    auto stack = it.stack_;
+    auto const& key = it.item_->key();
+    while (!stack.empty() && count != 0)
+    {
+        auto node = stack.top().first;
+        auto nodeID = stack.top().second;
+        stack.pop();
+        if (!node->isLeaf())
+            prefetchBranches (static_cast<SHAMapInnerNode*>(node), nodeID,
+                nodeID.selectBranch(key) + 1, count);
+    }
+}
+
+// Visit the children of an inner node from a branch on, and below
+// them the nodes which are in memory
+void
+SHAMap::prefetchBranches (SHAMapInnerNode* inner, SHAMapNodeID const& nodeID,
+    int first, std::size_t& count) const
+{
+    for (int branch = first; branch < 16 && count != 0; ++branch)
+    {
+        if (inner->isEmptyBranch (branch))
+            continue;
+
+        --count;
+        auto const childID = nodeID.getChildNodeID (branch);
+        bool pending = false;
+        auto child = descendAsync (inner, branch, childID, nullptr, pending);
+        if (child && child->isInner ())
+            prefetchBranches (static_cast<SHAMapInnerNode*>(child), childID,
+                0, count);
+    }
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMap::fetchNodeFromDB (SHAMapHash const& hash) const
 {
@@ -176,10 +246,14 @@ SHAMap::fetchNodeFromDB (SHAMapHash const& hash) const
         {
             try
             {
-                node = SHAMapAbstractNode::make(obj->getData(),
-                    0, snfPREFIX, hash, true, f_.journal());
+                node = SHAMapAbstractNode::make(
+                    obj->getData(), 0, snfPREFIX, hash, true, f_.journal());
                 if (node)
+                {
                     canonicalize (hash, node);
+                    if (auto cache = f_.serialcache ())
+                        cache->share (obj);
+                }
             }
             catch (std::exception const&)
             {
@@ -208,7 +282,7 @@ SHAMap::checkFilter(SHAMapHash const& hash, SHAMapNodeID const& id,
     if (filter->haveNode (id, hash.as_uint256(), nodeData))
     {
         node = SHAMapAbstractNode::make(
-            nodeData, 0, snfPREFIX, hash, true, f_.journal ());
+            makeSlice(nodeData), 0, snfPREFIX, hash, true, f_.journal ());
         if (node)
         {
             filter->gotNode (true, id, hash.as_uint256(), nodeData, node->getType ());
@@ -797,16 +871,67 @@ SHAMap::addGiveItem (std::shared_ptr<SHAMapItem const> const& item,
     return true;
 }
 
-bool SHAMap::addItem (const SHAMapItem& i, bool isTransaction, bool hasMetaData)
+std::shared_ptr<SHAMapInnerNode>
+SHAMap::makeInner (SortedItemIter first, SortedItemIter last,
+                   SHAMapNodeID const& nodeID, SHAMapTreeNode::TNType type)
 {
-    return addGiveItem(std::make_shared<SHAMapItem const>(i), isTransaction, hasMetaData);
+    auto inner = std::make_shared<SHAMapInnerNode> (seq_);
+
+    while (first != last)
+    {
+        // items sharing this node's branch form one child
+        int const branch = nodeID.selectBranch ((*first)->key ());
+        auto next = first + 1;
+        while (next != last && nodeID.selectBranch ((*next)->key ()) == branch)
+            ++next;
+
+        if (next - first == 1)
+            inner->setChild (branch,
+                std::make_shared<SHAMapTreeNode> (*first, type, seq_));
+        else
+            inner->setChild (branch,
+                makeInner (first, next, nodeID.getChildNodeID (branch), type));
+
+        first = next;
+    }
+
+    return inner;
 }
 
 bool
-SHAMap::addItem(SHAMapItem&& i, bool isTransaction, bool hasMetaData)
+SHAMap::addSortedItems (
+    std::vector<std::shared_ptr<SHAMapItem const>> const& items,
+        bool isTransaction, bool hasMeta)
 {
-    return addGiveItem(std::make_shared<SHAMapItem const>(std::move(i)),
-                                                          isTransaction, hasMetaData);
+    assert (state_ != SHAMapState::Immutable);
+
+    if (!root_->isInner () ||
+        !std::static_pointer_cast<SHAMapInnerNode>(root_)->isEmpty ())
+        return false;
+
+    auto const unsorted = std::adjacent_find (items.begin (), items.end (),
+        [](std::shared_ptr<SHAMapItem const> const& a,
+           std::shared_ptr<SHAMapItem const> const& b)
+        {
+            return a->key () >= b->key ();
+        });
+    if (unsorted != items.end ())
+        return false;
+
+    if (items.empty ())
+        return true;
+
+    SHAMapTreeNode::TNType type = !isTransaction ? SHAMapTreeNode::tnACCOUNT_STATE :
+        (hasMeta ? SHAMapTreeNode::tnTRANSACTION_MD : SHAMapTreeNode::tnTRANSACTION_NM);
+
+    // the root is always an inner node, even holding a single item
+    root_ = makeInner (items.begin (), items.end (), SHAMapNodeID (), type);
+    return true;
+}
+
+bool SHAMap::addItem (const SHAMapItem& i, bool isTransaction, bool hasMetaData)
+{
+    return addGiveItem(make_shamapitem(i.key(), i.slice()), isTransaction, hasMetaData);
 }
 
 SHAMapHash
@@ -958,7 +1083,6 @@ int
 SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 {
     int flushed = 0;
-    Serializer s;
 
     if (!root_ || (root_->getSeq() == 0))
         return flushed;
@@ -974,16 +1098,114 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
     if (node->isEmpty())
         return flushed;
 
-    // Stack of {parent,index,child} pointers representing
-    // inner nodes we are in the process of flushing
+    node = preFlushNode(std::move(node));
+
+    // Dirty inner nodes below the root, each flushed as its own subtree
+    std::vector<int> branches;
+    int grandchildren = 0;
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        auto const child = node->getChildPointer (branch);
+        if (child && child->isInner () && (child->getSeq () != 0))
+        {
+            auto const inner = static_cast<SHAMapInnerNode*> (child);
+            branches.push_back (branch);
+            for (int i = 0; i < 16; ++i)
+            {
+                auto const grandchild = inner->getChildPointer (i);
+                if (grandchild && (grandchild->getSeq () != 0))
+                    ++grandchildren;
+            }
+        }
+    }
+
+    auto const threads = std::min<std::size_t> (
+        f_.walkThreads (), branches.size ());
+    if (threads < 2 || grandchildren < minParallelWalk)
+    {
+        root_ = walkSubTree (std::move (node), doWrite, t, seq, flushed);
+        return flushed;
+    }
+
+    // Each worker takes whole subtrees, the root is combined here once
+    // they are all hooked up.
+    std::vector<std::shared_ptr<SHAMapInnerNode>> subtrees (branches.size ());
+    for (std::size_t i = 0; i < branches.size (); ++i)
+    {
+        subtrees[i] = preFlushNode (std::static_pointer_cast<
+            SHAMapInnerNode> (node->getChild (branches[i])));
+    }
+
+    std::atomic<std::size_t> next (0);
+    std::atomic<int> total (0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for (std::size_t i; (i = next++) < subtrees.size ();)
+            {
+                int count = 0;
+                subtrees[i] = walkSubTree (std::move (subtrees[i]),
+                    doWrite, t, seq, count);
+                total += count;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (!error)
+                error = std::current_exception ();
+            next = subtrees.size ();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve (threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+        workers.emplace_back (worker);
+    worker ();
+    for (auto& w : workers)
+        w.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+
+    for (std::size_t i = 0; i < branches.size (); ++i)
+        node->shareChild (branches[i], subtrees[i]);
+
+    // The remaining dirty children of the root are leaves
+    flushed = total;
+    root_ = walkSubTree (std::move (node), doWrite, t, seq, flushed);
+    return flushed;
+}
+
+std::shared_ptr<SHAMapInnerNode>
+SHAMap::walkSubTree (std::shared_ptr<SHAMapInnerNode> node, bool doWrite,
+    NodeObjectType t, std::uint32_t seq, int& flushed)
+{
+    // A dirty node, and the parent it is hooked up to once flushed
+    struct DirtyNode
+    {
+        std::shared_ptr<SHAMapInnerNode> parent;
+        int branch;
+        std::shared_ptr<SHAMapAbstractNode> node;
+    };
+
+    // The dirty nodes by depth. A node only depends on the nodes below it,
+    // so each depth is hashed together once the walk has found them all.
+    std::vector<std::vector<DirtyNode>> depths (1);
+    depths[0].push_back ({nullptr, 0, node});
+
+    // Stack of {parent,index} pairs representing
+    // inner nodes we are in the process of walking
     using StackEntry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
-
     int pos = 0;
 
-    // We can't flush an inner node until we flush its children
     while (1)
     {
         while (pos < 16)
@@ -1002,12 +1224,16 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
                 if (child && (child->getSeq() != 0))
                 {
                     // This is a node that needs to be flushed
+                    child = preFlushNode(std::move(child));
+
+                    auto const depth = stack.size () + 1;
+                    if (depths.size () <= depth)
+                        depths.resize (depth + 1);
+                    depths[depth].push_back ({node, branch, child});
 
                     if (child->isInner ())
                     {
                         // save our place and work on this node
-                        child = preFlushNode(std::move(child));
-
                         stack.emplace (std::move (node), branch);
 
                         node = std::static_pointer_cast<SHAMapInnerNode>(std::move(child));
@@ -1015,53 +1241,46 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
                     }
                     else
                     {
-                        // flush this leaf
                         ++flushed;
-
-                        child = preFlushNode(std::move(child));
-
-                        assert (node->getSeq() == seq_);
-                        child->updateHash();
-
-                        if (doWrite && backed_)
-                            child = writeNode(t, seq, std::move(child));
-
-                        node->shareChild (branch, child);
                     }
                 }
             }
         }
 
-        // update the hash of this inner node
-        node->updateHashDeep();
-
-        // This inner node can now be shared
-        if (doWrite && backed_)
-            node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
-                                                                       std::move(node)));
-
         ++flushed;
 
         if (stack.empty ())
            break;
 
-        auto parent = std::move (stack.top().first);
-        pos = stack.top().second;
+        // Continue with parent's next child, if any
+        node = std::move (stack.top().first);
+        pos = stack.top().second + 1;
         stack.pop();
+    }
 
-        // Hook this inner node to its parent
-        assert (parent->getSeq() == seq_);
-        parent->shareChild (pos, node);
+    // Hash, write and hook up the nodes, deepest first
+    std::vector<SHAMapAbstractNode*> nodes;
+    for (auto depth = depths.rbegin (); depth != depths.rend (); ++depth)
+    {
+        nodes.clear ();
+        for (auto const& dirty : *depth)
+            nodes.push_back (dirty.node.get ());
+        SHAMapAbstractNode::updateHashes (nodes);
 
-        // Continue with parent's next child, if any
-        node = std::move (parent);
-        ++pos;
+        for (auto& dirty : *depth)
+        {
+            if (doWrite && backed_)
+                dirty.node = writeNode (t, seq, std::move (dirty.node));
+            if (dirty.parent)
+            {
+                assert (dirty.parent->getSeq() == seq_);
+                dirty.parent->shareChild (dirty.branch, dirty.node);
+            }
+        }
     }
 
-    // Last inner node is the new root_
-    root_ = std::move (node);
-
-    return flushed;
+    // The first node is the top of the subtree
+    return std::static_pointer_cast<SHAMapInnerNode> (depths[0][0].node);
 }
 
 void SHAMap::dump (bool hash) const
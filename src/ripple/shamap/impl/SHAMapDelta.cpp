@@ -33,13 +33,23 @@ namespace ripple {
 
 bool SHAMap::walkBranch (SHAMapAbstractNode* node,
                          std::shared_ptr<SHAMapItem const> const& otherMapItem,
-                         bool isFirstMap,Delta& differences, int& maxCount) const
+                         bool isFirstMap, DeltaVisitor const& visitor) const
 {
-    // Walk a branch of a SHAMap that's matched by an empty branch or single item in the other map
+    // Walk a branch of a SHAMap, in key order, that's matched by an empty
+    // branch or single item in the other map. The branch may be empty too.
+    auto const visit = [&](uint256 const& key,
+        std::shared_ptr<SHAMapItem const> const& item,
+        std::shared_ptr<SHAMapItem const> const& otherItem)
+    {
+        return isFirstMap ?
+            visitor (key, item, otherItem) : visitor (key, otherItem, item);
+    };
+
     std::stack <SHAMapAbstractNode*, std::vector<SHAMapAbstractNode*>> nodeStack;
-    nodeStack.push (node);
+    if (node)
+        nodeStack.push (node);
 
-    bool emptyBranch = !otherMapItem;
+    bool unmatched = static_cast<bool> (otherMapItem);
 
     while (!nodeStack.empty ())
     {
@@ -48,77 +58,89 @@ bool SHAMap::walkBranch (SHAMapAbstractNode* node,
 
         if (node->isInner ())
         {
-            // This is an inner node, add all non-empty branches
+            // This is an inner node, add all non-empty branches so that
+            // the lowest is visited first
             auto inner = static_cast<SHAMapInnerNode*>(node);
-            for (int i = 0; i < 16; ++i)
+            for (int i = 15; i >= 0; --i)
                 if (!inner->isEmptyBranch (i))
                     nodeStack.push ({descendThrow (inner, i)});
+            continue;
         }
-        else
+
+        // This is a leaf node, process its item
+        auto const& item = static_cast<SHAMapTreeNode*>(node)->peekItem();
+
+        if (unmatched && (otherMapItem->key() <= item->key()))
         {
-            // This is a leaf node, process its item
-            auto item = static_cast<SHAMapTreeNode*>(node)->peekItem();
+            unmatched = false;
 
-            if (emptyBranch || (item->key() != otherMapItem->key()))
+            if (otherMapItem->key() == item->key())
             {
-                // unmatched
-                if (isFirstMap)
-                    differences.insert (std::make_pair (item->key(),
-                        DeltaRef (item, std::shared_ptr<SHAMapItem const> ())));
-                else
-                    differences.insert (std::make_pair (item->key(),
-                        DeltaRef (std::shared_ptr<SHAMapItem const> (), item)));
-
-                if (--maxCount <= 0)
+                // same tag, a difference only if the data is not the same
+                if ((item->slice () != otherMapItem->slice ()) &&
+                        !visit (item->key(), item, otherMapItem))
                     return false;
+                continue;
             }
-            else if (item->peekData () != otherMapItem->peekData ())
-            {
-                // non-matching items with same tag
-                if (isFirstMap)
-                    differences.insert (std::make_pair (item->key(),
-                                                DeltaRef (item, otherMapItem)));
-                else
-                    differences.insert (std::make_pair (item->key(),
-                                                DeltaRef (otherMapItem, item)));
 
-                if (--maxCount <= 0)
-                    return false;
-
-                emptyBranch = true;
-            }
-            else
-            {
-                // exact match
-                emptyBranch = true;
-            }
+            if (!visit (otherMapItem->key(),
+                    std::shared_ptr<SHAMapItem const> (), otherMapItem))
+                return false;
         }
-    }
 
-    if (!emptyBranch)
-    {
-        // otherMapItem was unmatched, must add
-        if (isFirstMap) // this is first map, so other item is from second
-            differences.insert(std::make_pair(otherMapItem->key(),
-                                              DeltaRef(std::shared_ptr<SHAMapItem const>(),
-                                                       otherMapItem)));
-        else
-            differences.insert(std::make_pair(otherMapItem->key(),
-                DeltaRef(otherMapItem, std::shared_ptr<SHAMapItem const>())));
-
-        if (--maxCount <= 0)
+        if (!visit (item->key(), item, std::shared_ptr<SHAMapItem const> ()))
             return false;
     }
 
+    // otherMapItem comes after every item of the branch
+    if (unmatched && !visit (otherMapItem->key(),
+            std::shared_ptr<SHAMapItem const> (), otherMapItem))
+        return false;
+
     return true;
 }
 
+bool SHAMap::walkDelta (SHAMapAbstractNode* ourNode, SHAMap const& otherMap,
+                        SHAMapAbstractNode* otherNode,
+                        DeltaVisitor const& visitor) const
+{
+    // Either node may be null, for an empty branch
+    if (ourNode && otherNode && ourNode->isInner () && otherNode->isInner ())
+    {
+        auto ours = static_cast<SHAMapInnerNode*>(ourNode);
+        auto other = static_cast<SHAMapInnerNode*>(otherNode);
+        for (int i = 0; i < 16; ++i)
+        {
+            if (ours->getChildHash (i) == other->getChildHash (i))
+                continue;
+
+            if (!walkDelta (
+                    ours->isEmptyBranch (i) ? nullptr : descendThrow (ours, i),
+                    otherMap,
+                    other->isEmptyBranch (i) ?
+                        nullptr : otherMap.descendThrow (other, i),
+                    visitor))
+                return false;
+        }
+        return true;
+    }
+
+    auto const leafItem = [](SHAMapAbstractNode* node)
+    {
+        if (node && node->isLeaf ())
+            return static_cast<SHAMapTreeNode*>(node)->peekItem ();
+        return std::shared_ptr<SHAMapItem const> ();
+    };
+
+    if (ourNode && ourNode->isInner ())
+        return walkBranch (ourNode, leafItem (otherNode), true, visitor);
+
+    return otherMap.walkBranch (otherNode, leafItem (ourNode), false, visitor);
+}
+
 bool
-SHAMap::compare (SHAMap const& otherMap,
-                 Delta& differences, int maxCount) const
+SHAMap::visitDelta (SHAMap const& otherMap, DeltaVisitor const& visitor) const
 {
-    // compare two hash trees, add up to maxCount differences to the difference table
-    // return value: true=complete table of differences given, false=too many differences
     // throws on corrupt tables or missing nodes
     // CAUTION: otherMap is not locked and must be immutable
 
@@ -127,104 +149,26 @@ SHAMap::compare (SHAMap const& otherMap,
     if (getHash () == otherMap.getHash ())
         return true;
 
-    using StackEntry = std::pair <SHAMapAbstractNode*, SHAMapAbstractNode*>;
-    std::stack <StackEntry, std::vector<StackEntry>> nodeStack; // track nodes we've pushed
-
-    nodeStack.push ({root_.get(), otherMap.root_.get()});
-    while (!nodeStack.empty ())
-    {
-        SHAMapAbstractNode* ourNode = nodeStack.top().first;
-        SHAMapAbstractNode* otherNode = nodeStack.top().second;
-        nodeStack.pop ();
+    return walkDelta (root_.get (), otherMap, otherMap.root_.get (), visitor);
+}
 
-        if (!ourNode || !otherNode)
-        {
-            assert (false);
-            Throw<SHAMapMissingNode> (type_, uint256 ());
-        }
+bool
+SHAMap::compare (SHAMap const& otherMap,
+                 Delta& differences, int maxCount) const
+{
+    // compare two hash trees, add up to maxCount differences to the difference table
+    // return value: true=complete table of differences given, false=too many differences
+    // throws on corrupt tables or missing nodes
+    // CAUTION: otherMap is not locked and must be immutable
 
-        if (ourNode->isLeaf () && otherNode->isLeaf ())
+    return visitDelta (otherMap,
+        [&](uint256 const& key,
+            std::shared_ptr<SHAMapItem const> const& ours,
+            std::shared_ptr<SHAMapItem const> const& theirs)
         {
-            // two leaves
-            auto ours = static_cast<SHAMapTreeNode*>(ourNode);
-            auto other = static_cast<SHAMapTreeNode*>(otherNode);
-            if (ours->peekItem()->key() == other->peekItem()->key())
-            {
-                if (ours->peekItem()->peekData () != other->peekItem()->peekData ())
-                {
-                    differences.insert (std::make_pair (ours->peekItem()->key(),
-                                                 DeltaRef (ours->peekItem (),
-                                                 other->peekItem ())));
-                    if (--maxCount <= 0)
-                        return false;
-                }
-            }
-            else
-            {
-                differences.insert (std::make_pair(ours->peekItem()->key(),
-                                                   DeltaRef(ours->peekItem(),
-                                                   std::shared_ptr<SHAMapItem const>())));
-                if (--maxCount <= 0)
-                    return false;
-
-                differences.insert(std::make_pair(other->peekItem()->key(),
-                    DeltaRef(std::shared_ptr<SHAMapItem const>(), other->peekItem ())));
-                if (--maxCount <= 0)
-                    return false;
-            }
-        }
-        else if (ourNode->isInner () && otherNode->isLeaf ())
-        {
-            auto ours = static_cast<SHAMapInnerNode*>(ourNode);
-            auto other = static_cast<SHAMapTreeNode*>(otherNode);
-            if (!walkBranch (ours, other->peekItem (),
-                    true, differences, maxCount))
-                return false;
-        }
-        else if (ourNode->isLeaf () && otherNode->isInner ())
-        {
-            auto ours = static_cast<SHAMapTreeNode*>(ourNode);
-            auto other = static_cast<SHAMapInnerNode*>(otherNode);
-            if (!otherMap.walkBranch (other, ours->peekItem (),
-                                       false, differences, maxCount))
-                return false;
-        }
-        else if (ourNode->isInner () && otherNode->isInner ())
-        {
-            auto ours = static_cast<SHAMapInnerNode*>(ourNode);
-            auto other = static_cast<SHAMapInnerNode*>(otherNode);
-            for (int i = 0; i < 16; ++i)
-                if (ours->getChildHash (i) != other->getChildHash (i))
-                {
-                    if (other->isEmptyBranch (i))
-                    {
-                        // We have a branch, the other tree does not
-                        SHAMapAbstractNode* iNode = descendThrow (ours, i);
-                        if (!walkBranch (iNode,
-                                         std::shared_ptr<SHAMapItem const> (), true,
-                                         differences, maxCount))
-                            return false;
-                    }
-                    else if (ours->isEmptyBranch (i))
-                    {
-                        // The other tree has a branch, we do not
-                        SHAMapAbstractNode* iNode =
-                            otherMap.descendThrow(other, i);
-                        if (!otherMap.walkBranch (iNode,
-                                                   std::shared_ptr<SHAMapItem const>(),
-                                                   false, differences, maxCount))
-                            return false;
-                    }
-                    else // The two trees have different non-empty branches
-                        nodeStack.push ({descendThrow (ours, i),
-                                        otherMap.descendThrow (other, i)});
-                }
-        }
-        else
-            assert (false);
-    }
-
-    return true;
+            differences.insert (std::make_pair (key, DeltaRef (ours, theirs)));
+            return --maxCount > 0;
+        });
 }
 
 void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const
@@ -265,4 +209,122 @@ void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissi
     }
 }
 
+void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes,
+    int maxMissing, int window, std::function<bool ()> const& stopping) const
+{
+    if (!root_->isInner ())
+        return;
+
+    // Children to look up, taken depth first, and those being read. The
+    // nodes found are not hooked into the map: each is only kept until
+    // its children are taken.
+    using Entry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
+    std::vector <Entry> pending;
+    std::vector <Entry> reading;
+    auto const most = static_cast<std::size_t> (std::max (window, 1));
+    reading.reserve (most);
+
+    auto const expand = [&](std::shared_ptr<SHAMapInnerNode> const& node)
+    {
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (!node->isEmptyBranch (branch))
+                pending.emplace_back (node, branch);
+        }
+    };
+
+    auto const make = [&](SHAMapHash const& hash,
+        std::shared_ptr<NodeObject> const& object)
+    {
+        std::shared_ptr<SHAMapAbstractNode> node;
+        if (!object)
+            return node;
+        try
+        {
+            node = SHAMapAbstractNode::make (object->getData (),
+                0, snfPREFIX, hash, true, f_.journal ());
+            if (node)
+                canonicalize (hash, node);
+        }
+        catch (std::exception const&)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Invalid DB node " << hash;
+            node.reset ();
+        }
+        return node;
+    };
+
+    // Returns false once enough nodes are missing
+    auto const found = [&](Entry const& entry,
+        std::shared_ptr<SHAMapAbstractNode> const& node)
+    {
+        if (node)
+        {
+            if (node->isInner ())
+                expand (std::static_pointer_cast<SHAMapInnerNode> (node));
+            return true;
+        }
+        missingNodes.emplace_back (type_,
+            entry.first->getChildHash (entry.second));
+        return --maxMissing > 0;
+    };
+
+    expand (std::static_pointer_cast<SHAMapInnerNode> (root_));
+
+    while (!reading.empty () || !pending.empty ())
+    {
+        if (stopping && stopping ())
+            return;
+
+        while (!pending.empty () && reading.size () < most)
+        {
+            auto entry = std::move (pending.back ());
+            pending.pop_back ();
+
+            auto node = entry.first->getChild (entry.second);
+            if (!node)
+            {
+                auto const hash = entry.first->getChildHash (entry.second);
+                node = getCache (hash);
+                if (!node && backed_)
+                {
+                    std::shared_ptr<NodeObject> object;
+                    if (!f_.db().asyncFetch (hash.as_uint256 (), object))
+                    {
+                        reading.push_back (std::move (entry));
+                        continue;
+                    }
+                    node = make (hash, object);
+                }
+            }
+
+            if (!found (entry, node))
+                return;
+        }
+
+        if (reading.empty ())
+            continue;
+
+        f_.db().waitSomeReads ();
+
+        for (std::size_t i = 0; i < reading.size ();)
+        {
+            auto const hash = reading[i].first->getChildHash (reading[i].second);
+            std::shared_ptr<NodeObject> object;
+            if (!f_.db().asyncFetch (hash.as_uint256 (), object))
+            {
+                ++i;
+                continue;
+            }
+
+            auto const entry = std::move (reading[i]);
+            reading[i] = std::move (reading.back ());
+            reading.pop_back ();
+            if (!found (entry, make (hash, object)))
+                return;
+        }
+    }
+}
+
 } // ripple
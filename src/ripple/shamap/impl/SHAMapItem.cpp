@@ -20,27 +20,35 @@
 #include <BeastConfig.h>
 #include <ripple/protocol/Serializer.h>
 #include <ripple/shamap/SHAMapItem.h>
+#include <cstring>
 
 namespace ripple {
 
 class SHAMap;
 
-SHAMapItem::SHAMapItem (uint256 const& tag, Blob const& data)
-    : tag_(tag)
-    , data_(data)
+static
+MemoryTag&
+shaMapItemMemory ()
 {
+    static MemoryTag tag ("SHAMapItem");
+    return tag;
 }
 
-SHAMapItem::SHAMapItem (uint256 const& tag, const Serializer& data)
+SHAMapItem::SHAMapItem (std::uint8_t* const& payload,
+        uint256 const& tag, Slice data, PrivateAccess)
     : tag_ (tag)
-    , data_(data.peekData())
+    , data_ (payload)
+    , size_ (data.size ())
 {
+    if (size_ != 0)
+        std::memcpy (payload, data.data (), size_);
 }
 
-SHAMapItem::SHAMapItem (uint256 const& tag, Serializer&& data)
-    : tag_ (tag)
-    , data_(std::move(data.modData()))
+std::shared_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Slice data)
 {
+    return make_shared_inline <SHAMapItem, shaMapItemMemory> (
+        data.size (), tag, data, SHAMapItem::PrivateAccess ());
 }
 
 } // ripple
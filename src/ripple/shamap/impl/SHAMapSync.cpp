@@ -21,6 +21,11 @@
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/nodestore/Database.h>
 #include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 
@@ -55,27 +60,221 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
     if (!root_)
         return;
 
-    function (*root_);
+    if (function (*root_))
+        return;
 
     if (!root_->isInner ())
         return;
 
+    visitSubTree (std::static_pointer_cast<SHAMapInnerNode>(root_), function);
+}
+
+void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& function,
+    std::size_t threads) const
+{
+    if (threads < 2 || !root_ || !root_->isInner ())
+    {
+        visitNodes (function);
+        return;
+    }
+
+    if (function (*root_))
+        return;
+
+    auto const node = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    std::vector<int> branches;
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (!node->isEmptyBranch (branch))
+            branches.push_back (branch);
+    }
+
+    // Each worker takes whole subtrees below the root
+    std::atomic<std::size_t> next (0);
+    std::atomic<bool> stopped (false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for (std::size_t i; !stopped && (i = next++) < branches.size ();)
+            {
+                auto const child = descendNoStore (node, branches[i]);
+                if (function (*child) || (child->isInner () && visitSubTree (
+                        std::static_pointer_cast<SHAMapInnerNode>(child),
+                            function)))
+                    stopped = true;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (!error)
+                error = std::current_exception ();
+            stopped = true;
+        }
+    };
+
+    threads = std::min (threads, branches.size ());
+    std::vector<std::thread> workers;
+    workers.reserve (threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+        workers.emplace_back (worker);
+    worker ();
+    for (auto& w : workers)
+        w.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+std::size_t
+SHAMap::visitPartitions (int depth, std::size_t threads,
+    PartitionVisitor const& function) const
+{
+    assert (depth >= 0 && depth <= maxPartitionDepth);
+
+    // The index of the partition a key falls in
+    auto const partitionOf = [depth](uint256 const& key)
+    {
+        std::size_t index = 0;
+        for (int i = 0; i < depth; ++i)
+        {
+            auto const byte = *(key.begin () + (i / 2));
+            index = (index << 4) | ((i % 2) ? (byte & 0x0F) : (byte >> 4));
+        }
+        return index;
+    };
+
+    std::size_t const partitions = std::size_t (1) << (4 * depth);
+    if (!root_)
+        return partitions;
+
+    // The root of each partition which has leaves, in key order
+    struct Partition
+    {
+        std::size_t index;
+        std::shared_ptr<SHAMapAbstractNode> node;
+        SHAMapNodeID nodeID;
+    };
+    std::vector<Partition> work {{0, root_, SHAMapNodeID ()}};
+    for (int d = 0; d < depth; ++d)
+    {
+        std::vector<Partition> below;
+        for (auto const& p : work)
+        {
+            if (p.node->isLeaf ())
+            {
+                below.push_back (p);
+                continue;
+            }
+            auto const inner = std::static_pointer_cast<SHAMapInnerNode>(p.node);
+            for (int branch = 0; branch < 16; ++branch)
+            {
+                if (!inner->isEmptyBranch (branch))
+                {
+                    below.push_back ({(p.index << 4) | branch,
+                        descendNoStore (inner, branch),
+                            p.nodeID.getChildNodeID (branch)});
+                }
+            }
+        }
+        work.swap (below);
+    }
+    for (auto& p : work)
+    {
+        if (p.node->isLeaf ())
+            p.index = partitionOf (static_cast<SHAMapTreeNode&>(
+                *p.node).peekItem ()->key ());
+    }
+
+    threads = std::max<std::size_t> (1,
+        std::min (threads, work.size ()));
+    std::size_t const window = backed_ ?
+        std::max (0, f_.prefetchWindow ()) : 0;
+
+    std::atomic<std::size_t> next (0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for (std::size_t i; (i = next++) < work.size ();)
+            {
+                // Start reading the partition the threads reach next
+                // while this one is walked
+                if (window != 0 && i + threads < work.size ())
+                {
+                    auto const& ahead = work[i + threads];
+                    if (ahead.node->isInner ())
+                    {
+                        std::size_t count = window;
+                        prefetchBranches (static_cast<SHAMapInnerNode*>(
+                            ahead.node.get ()), ahead.nodeID, 0, count);
+                    }
+                }
+
+                auto const& p = work[i];
+                if (p.node->isLeaf ())
+                {
+                    function (p.index, *static_cast<SHAMapTreeNode&>(
+                        *p.node).peekItem ());
+                    continue;
+                }
+                visitSubTree (std::static_pointer_cast<SHAMapInnerNode>(p.node),
+                    [&](SHAMapAbstractNode& node)
+                    {
+                        if (!node.isInner ())
+                            function (p.index, *static_cast<SHAMapTreeNode&>(
+                                node).peekItem ());
+                        return false;
+                    });
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (!error)
+                error = std::current_exception ();
+            next = work.size ();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve (threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+        workers.emplace_back (worker);
+    worker ();
+    for (auto& w : workers)
+        w.join ();
+
+    if (error)
+        std::rethrow_exception (error);
+
+    return partitions;
+}
+
+bool SHAMap::visitSubTree (std::shared_ptr<SHAMapInnerNode> node,
+    std::function<bool (SHAMapAbstractNode&)> const& function) const
+{
     using StackEntry = std::pair <int, std::shared_ptr<SHAMapInnerNode>>;
     std::stack <StackEntry, std::vector <StackEntry>> stack;
 
-    auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
     int pos = 0;
 
     while (1)
     {
         while (pos < 16)
         {
-            uint256 childHash;
             if (!node->isEmptyBranch (pos))
             {
                 std::shared_ptr<SHAMapAbstractNode> child = descendNoStore (node, pos);
                 if (function (*child))
-                    return;
+                    return true;
 
                 if (child->isLeaf ())
                     ++pos;
@@ -108,6 +307,131 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
         std::tie(pos, node) = stack.top ();
         stack.pop ();
     }
+
+    return false;
+}
+
+/** Bring the nodes of this SHAMap the node store has into the tree, keeping
+    up to window reads outstanding.
+
+    As each read completes the reads of its children are posted, so the
+    reads span several levels of the tree at once. Stops once max nodes
+    are known to be missing; getMissingNodes then finds them in the tree.
+*/
+void
+SHAMap::prefetchMissing (int window, int max, SHAMapSyncFilter* filter)
+{
+    std::uint32_t const generation = f_.fullbelow().getGeneration();
+
+    struct Fetch
+    {
+        SHAMapInnerNode* parent;
+        int branch;
+        SHAMapNodeID nodeID;
+    };
+
+    // Children to look up, taken depth first, and those being read
+    std::vector<Fetch> pending;
+    std::vector<Fetch> reading;
+    reading.reserve (window);
+
+    auto const expand = [&](SHAMapInnerNode* node, SHAMapNodeID const& nodeID)
+    {
+        if (node->isFullBelow (generation))
+            return;
+
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (!node->isEmptyBranch (branch) &&
+                !f_.fullbelow().touch_if_exists (
+                    node->getChildHash (branch).as_uint256()))
+            {
+                pending.push_back ({node, branch,
+                    nodeID.getChildNodeID (branch)});
+            }
+        }
+    };
+
+    auto const before = std::chrono::steady_clock::now();
+    int reads = 0;
+    int waits = 0;
+    int missing = 0;
+
+    // Returns false once enough nodes are missing
+    auto const found = [&](Fetch const& fetch, SHAMapAbstractNode* node)
+    {
+        if (node)
+        {
+            if (node->isInner ())
+                expand (static_cast<SHAMapInnerNode*> (node), fetch.nodeID);
+            return true;
+        }
+        return ++missing < max;
+    };
+
+    expand (static_cast<SHAMapInnerNode*> (root_.get ()), SHAMapNodeID ());
+
+    while (!reading.empty () || !pending.empty ())
+    {
+        while (!pending.empty () && reading.size () < static_cast<std::size_t> (window))
+        {
+            auto fetch = std::move (pending.back ());
+            pending.pop_back ();
+
+            bool isPending = false;
+            auto const node = descendAsync (fetch.parent, fetch.branch,
+                fetch.nodeID, filter, isPending);
+            if (isPending)
+            {
+                ++reads;
+                reading.push_back (std::move (fetch));
+            }
+            else if (!found (fetch, node))
+            {
+                return;
+            }
+        }
+
+        if (reading.empty ())
+            continue;
+
+        f_.db().waitSomeReads ();
+        ++waits;
+
+        // Hook up the reads that completed, which posts those below them
+        for (std::size_t i = 0; i < reading.size ();)
+        {
+            auto const& fetch = reading[i];
+            std::shared_ptr<NodeObject> object;
+            if (!f_.db().asyncFetch (fetch.parent->getChildHash (
+                    fetch.branch).as_uint256(), object))
+            {
+                ++i;
+                continue;
+            }
+
+            bool isPending = false;
+            auto const node = descendAsync (fetch.parent, fetch.branch,
+                fetch.nodeID, filter, isPending);
+            if (isPending)
+            {
+                // Gone from the cache already, it was read again
+                ++i;
+                continue;
+            }
+            if (!found (fetch, node))
+                return;
+
+            reading[i] = std::move (reading.back ());
+            reading.pop_back ();
+        }
+    }
+
+    auto const elapsed = std::chrono::duration_cast
+        <std::chrono::milliseconds> (std::chrono::steady_clock::now() - before);
+    if ((reads > 50) || (elapsed.count() > 50))
+        journal_.debug << "prefetchMissing reads " << reads <<
+            " nodes in " << waits << " waits, " << elapsed.count() << " ms";
 }
 
 /** Get a list of node IDs and hashes for nodes that are part of this SHAMap
@@ -138,6 +462,10 @@ SHAMap::getMissingNodes(std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>
         return;
     }
 
+    int const window = f_.prefetchWindow ();
+    if (backed_ && (window > 0))
+        prefetchMissing (window, max, filter);
+
     int const maxDefer = f_.db().getDesiredAsyncReadCount ();
 
     // Track the missing hashes we have found so far
@@ -311,7 +639,7 @@ std::vector<uint256> SHAMap::getNeededHashes (int max, SHAMapSyncFilter* filter)
 
 bool SHAMap::getNodeFat (SHAMapNodeID wanted,
     std::vector<SHAMapNodeID>& nodeIDs,
-        std::vector<Blob>& rawNodes, bool fatLeaves,
+        std::vector<SerializedNode::pointer>& rawNodes, bool fatLeaves,
             std::uint32_t depth) const
 {
     // Gets a node and some of its children
@@ -354,10 +682,8 @@ bool SHAMap::getNodeFat (SHAMapNodeID wanted,
         stack.pop ();
 
         // Add this node to the reply
-        Serializer s;
-        node->addRaw (s, snfWIRE);
         nodeIDs.push_back (nodeID);
-        rawNodes.push_back (std::move (s.peekData()));
+        rawNodes.push_back (serialize (*node, snfWIRE));
 
         if (node->isInner())
         {
@@ -386,10 +712,9 @@ bool SHAMap::getNodeFat (SHAMapNodeID wanted,
                         else if (childNode->isInner() || fatLeaves)
                         {
                             // Just include this node
-                            Serializer s;
-                            childNode->addRaw (s, snfWIRE);
                             nodeIDs.push_back (childID);
-                            rawNodes.push_back (std::move (s.peekData ()));
+                            rawNodes.push_back (
+                                serialize (*childNode, snfWIRE));
                         }
                     }
                 }
@@ -402,11 +727,17 @@ bool SHAMap::getNodeFat (SHAMapNodeID wanted,
 
 bool SHAMap::getRootNode (Serializer& s, SHANodeFormat format) const
 {
-    root_->addRaw (s, format);
+    s.addRaw (serialize (*root_, format)->slice ());
     return true;
 }
 
-SHAMapAddNode SHAMap::addRootNode (Blob const& rootNode,
+SerializedNode::pointer
+SHAMap::serialize (SHAMapAbstractNode const& node, SHANodeFormat format) const
+{
+    return serializeNode (f_.serialcache (), node, format);
+}
+
+SHAMapAddNode SHAMap::addRootNode (Slice const& rootNode,
     SHANodeFormat format, SHAMapSyncFilter* filter)
 {
     // we already have a root_ node
@@ -446,7 +777,7 @@ SHAMapAddNode SHAMap::addRootNode (Blob const& rootNode,
     return SHAMapAddNode::useful ();
 }
 
-SHAMapAddNode SHAMap::addRootNode (SHAMapHash const& hash, Blob const& rootNode, SHANodeFormat format,
+SHAMapAddNode SHAMap::addRootNode (SHAMapHash const& hash, Slice const& rootNode, SHANodeFormat format,
                                    SHAMapSyncFilter* filter)
 {
     // we already have a root_ node
@@ -484,7 +815,7 @@ SHAMapAddNode SHAMap::addRootNode (SHAMapHash const& hash, Blob const& rootNode,
 }
 
 SHAMapAddNode
-SHAMap::addKnownNode (const SHAMapNodeID& node, Blob const& rawNode,
+SHAMap::addKnownNode (const SHAMapNodeID& node, Slice const& rawNode,
                       SHAMapSyncFilter* filter)
 {
     // return value: true=okay, false=error
@@ -611,7 +942,7 @@ bool SHAMap::deepCompare (SHAMap& other) const
             auto& otherNodePeek = static_cast<SHAMapTreeNode*>(otherNode)->peekItem();
             if (nodePeek->key() != otherNodePeek->key())
                 return false;
-            if (nodePeek->peekData() != otherNodePeek->peekData())
+            if (nodePeek->slice() != otherNodePeek->slice())
                 return false;
         }
         else if (node->isInner ())
@@ -732,65 +1063,84 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
 void
 SHAMap::visitDifferences(SHAMap* have,
                          std::function<bool (SHAMapAbstractNode&)> func) const
+{
+    DifferenceCursor cursor;
+    visitDifferences (have, cursor, func);
+}
+
+bool
+SHAMap::visitDifferences (SHAMap* have, DifferenceCursor& cursor,
+    std::function<bool (SHAMapAbstractNode&)> const& func) const
 {
     // Visit every node in this SHAMap that is not present
     // in the specified SHAMap
 
-    if (root_->getNodeHash ().isZero ())
-        return;
+    if (! cursor.started_)
+    {
+        cursor.started_ = true;
 
-    if (have && (root_->getNodeHash () == have->root_->getNodeHash ()))
-        return;
+        if (root_->getNodeHash ().isZero ())
+            return true;
 
-    if (root_->isLeaf ())
-    {
-        auto leaf = std::static_pointer_cast<SHAMapTreeNode>(root_);
-        if (!have || !have->hasLeafNode(leaf->peekItem()->key(), leaf->getNodeHash()))
-            func (*root_);
+        if (have && (root_->getNodeHash () == have->root_->getNodeHash ()))
+            return true;
 
-        return;
-    }
-    // contains unexplored non-matching inner node entries
-    using StackEntry = std::pair <SHAMapInnerNode*, SHAMapNodeID>;
-    std::stack <StackEntry, std::vector<StackEntry>> stack;
+        if (root_->isLeaf ())
+        {
+            auto leaf = std::static_pointer_cast<SHAMapTreeNode>(root_);
+            if (!have || !have->hasLeafNode(leaf->peekItem()->key(), leaf->getNodeHash()))
+                func (*root_);
+
+            return true;
+        }
 
-    stack.push ({static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{}});
+        // contains unexplored non-matching inner node entries
+        cursor.stack_.push_back (
+            {static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{}});
+    }
 
-    while (!stack.empty())
+    while (! cursor.done ())
     {
-        SHAMapInnerNode* node;
-        SHAMapNodeID nodeID;
-        std::tie (node, nodeID) = stack.top ();
-        stack.pop ();
+        if (! cursor.node_)
+        {
+            std::tie (cursor.node_, cursor.nodeID_) = cursor.stack_.back ();
+            cursor.stack_.pop_back ();
+            cursor.branch_ = 0;
 
-        // 1) Add this node to the pack
-        if (!func (*node))
-            return;
+            // 1) Add this node to the pack
+            if (!func (*cursor.node_))
+                return false;
+        }
 
         // 2) push non-matching child inner nodes
-        for (int i = 0; i < 16; ++i)
+        auto const node = cursor.node_;
+        while (cursor.branch_ < 16)
         {
+            int const i = cursor.branch_++;
             if (!node->isEmptyBranch (i))
             {
                 auto const& childHash = node->getChildHash (i);
-                SHAMapNodeID childID = nodeID.getChildNodeID (i);
+                SHAMapNodeID childID = cursor.nodeID_.getChildNodeID (i);
                 auto next = descendThrow(node, i);
 
                 if (next->isInner ())
                 {
                     if (!have || !have->hasInnerNode(childID, childHash))
-                        stack.push ({static_cast<SHAMapInnerNode*>(next), childID});
+                        cursor.stack_.push_back (
+                            {static_cast<SHAMapInnerNode*>(next), childID});
                 }
                 else if (!have || !have->hasLeafNode(
                          static_cast<SHAMapTreeNode*>(next)->peekItem()->key(),
                          childHash))
                 {
                     if (! func (*next))
-                        return;
+                        return false;
                 }
             }
         }
+        cursor.node_ = nullptr;
     }
+    return true;
 }
 
 } // ripple
@@ -26,27 +26,98 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <beast/module/core/text/LexicalCast.h>
+#include <algorithm>
 #include <mutex>
 
 #include <openssl/sha.h>
 
 namespace ripple {
 
-std::mutex SHAMapInnerNode::childLock;
+std::array<std::mutex, 64> SHAMapInnerNode::childLocks;
+SHAMapHash const SHAMapInnerNode::zeroHash;
+std::atomic<std::uint64_t> SHAMapInnerNode::liveNodes (0);
+std::atomic<std::uint64_t> SHAMapInnerNode::liveSlots (0);
 
 SHAMapAbstractNode::~SHAMapAbstractNode() = default;
 
+SHAMapInnerNode::~SHAMapInnerNode ()
+{
+    --liveNodes;
+    liveSlots -= mCapacity;
+}
+
+std::uint64_t
+SHAMapInnerNode::Counts::bytesSaved () const
+{
+    return (16 * nodes - slots) * sizeof (Branch);
+}
+
+SHAMapInnerNode::Counts
+SHAMapInnerNode::getCounts ()
+{
+    return { liveNodes.load (), liveSlots.load () };
+}
+
+std::mutex&
+SHAMapInnerNode::childLock () const
+{
+    // Nodes are at least 16 byte aligned, drop the bits that never vary.
+    auto const address = reinterpret_cast<std::uintptr_t> (this) >> 4;
+    return childLocks[(address ^ (address >> 6)) % childLocks.size ()];
+}
+
+// Move the branches into room for at least capacity of them
+void
+SHAMapInnerNode::reserve (int capacity)
+{
+    assert (capacity <= 16);
+    if (capacity <= mCapacity)
+        return;
+
+    std::unique_ptr<Branch[]> branches (new Branch[capacity]);
+    auto const count = getBranchCount ();
+    for (int i = 0; i < count; ++i)
+        branches[i] = std::move (mBranches[i]);
+
+    mBranches = std::move (branches);
+    liveSlots += capacity - mCapacity;
+    mCapacity = static_cast<std::uint8_t> (capacity);
+}
+
+void
+SHAMapInnerNode::setHashes (SHAMapHash const (&hashes)[16])
+{
+    assert (mIsBranch == 0);
+    std::uint16_t isBranch = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        if (hashes[i].isNonZero ())
+            isBranch |= (1 << i);
+    }
+
+    reserve (static_cast<int> (std::bitset<16> (isBranch).count ()));
+    mIsBranch = isBranch;
+    for (int i = 0, j = 0; i < 16; ++i)
+    {
+        if (!isEmptyBranch (i))
+            mBranches[j++].hash = hashes[i];
+    }
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMapInnerNode::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNode>(seq);
     p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    std::memcpy(p->mHashes, mHashes, sizeof(mHashes));
-    std::unique_lock <std::mutex> lock(childLock);
-    for (int i = 0; i < 16; ++i)
-        p->mChildren[i] = mChildren[i];
+    auto const count = getBranchCount ();
+    p->reserve (count);
+    p->mIsBranch = mIsBranch;
+    for (int i = 0; i < count; ++i)
+        p->mBranches[i].hash = mBranches[i].hash;
+    std::unique_lock <std::mutex> lock (childLock ());
+    for (int i = 0; i < count; ++i)
+        p->mBranches[i].child = mBranches[i].child;
     return std::move(p);
 }
 
@@ -61,7 +132,7 @@ SHAMapTreeNode::SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
     : SHAMapAbstractNode(type, seq)
     , mItem (item)
 {
-    assert (item->peekData ().size () >= 12);
+    assert (item->size () >= 12);
     updateHash();
 }
 
@@ -70,11 +141,11 @@ SHAMapTreeNode::SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
     : SHAMapAbstractNode(type, seq, hash)
     , mItem (item)
 {
-    assert (item->peekData ().size () >= 12);
+    assert (item->size () >= 12);
 }
 
 std::shared_ptr<SHAMapAbstractNode>
-SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat format,
+SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
                          SHAMapHash const& hash, bool hashValid, beast::Journal j)
 {
     if (format == snfWIRE)
@@ -83,7 +154,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             return {};
 
         Serializer s (rawNode.data(), rawNode.size() - 1);
-        int type = rawNode.back ();
+        int type = rawNode[rawNode.size () - 1];
         int len = s.getLength ();
 
         if ((type < 0) || (type > 4))
@@ -92,10 +163,10 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
         if (type == 0)
         {
             // transaction
-            auto item = std::make_shared<SHAMapItem const>(
+            auto item = make_shamapitem (
                 sha512Half(HashPrefix::transactionID,
                     Slice(s.data(), s.size())),
-                        s.peekData());
+                        Slice(rawNode.data(), len));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq);
@@ -112,7 +183,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
 
             if (u.isZero ()) Throw<std::runtime_error> ("invalid AS node");
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u, s.slice ());
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq);
@@ -124,13 +195,10 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
                 Throw<std::runtime_error> ("invalid FI node");
 
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            SHAMapHash hashes[16];
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -141,6 +209,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
         {
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
             // compressed inner
+            SHAMapHash hashes[16];
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -148,10 +217,9 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                 Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -171,7 +239,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             if (u.isZero ())
                 Throw<std::runtime_error> ("invalid TM node");
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u, s.slice ());
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq);
@@ -197,9 +265,9 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
 
         if (prefix == HashPrefix::transactionID)
         {
-            auto item = std::make_shared<SHAMapItem const>(
-                sha512Half(makeSlice(rawNode)),
-                    s.peekData ());
+            auto item = make_shamapitem (
+                sha512Half(rawNode),
+                    Slice(rawNode.data() + 4, rawNode.size() - 4));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq);
@@ -219,7 +287,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
                 Throw<std::runtime_error> ("invalid PLN node");
             }
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u, s.slice ());
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq);
@@ -229,13 +297,10 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             if (s.getLength () != 512)
                 Throw<std::runtime_error> ("invalid PIN node");
             auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            SHAMapHash hashes[16];
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -251,7 +316,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             uint256 txID;
             s.get256 (txID, s.getLength () - 32);
             s.chop (32);
-            auto item = std::make_shared<SHAMapItem const> (txID, s.peekData ());
+            auto item = make_shamapitem (txID, s.slice ());
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq);
@@ -273,10 +338,18 @@ SHAMapInnerNode::updateHash()
     uint256 nh;
     if (mIsBranch != 0)
     {
+        // The hash covers all sixteen branches, empty ones as zero.
+        SHAMapHash hashes[16];
+        for (int i = 0, j = 0; i < 16; ++i)
+        {
+            if (!isEmptyBranch (i))
+                hashes[i] = mBranches[j++].hash;
+        }
+
         // VFALCO This code assumes the layout of a base_uint
         nh = sha512Half(HashPrefix::innerNode,
-            Slice(reinterpret_cast<unsigned char const*>(mHashes),
-                sizeof (mHashes)));
+            Slice(reinterpret_cast<unsigned char const*>(hashes),
+                sizeof (hashes)));
     }
     if (nh == mHash.as_uint256())
         return false;
@@ -287,12 +360,61 @@ SHAMapInnerNode::updateHash()
 void
 SHAMapInnerNode::updateHashDeep()
 {
-    for (auto pos = 0; pos < 16; ++pos)
+    updateChildHashes();
+    updateHash();
+}
+
+void
+SHAMapInnerNode::updateChildHashes()
+{
+    auto const count = getBranchCount ();
+    for (auto i = 0; i < count; ++i)
     {
-        if (mChildren[pos] != nullptr)
-            mHashes[pos] = mChildren[pos]->getNodeHash();
+        if (mBranches[i].child != nullptr)
+            mBranches[i].hash = mBranches[i].child->getNodeHash();
     }
-    updateHash();
+}
+
+void
+SHAMapAbstractNode::updateHashes (
+    std::vector<SHAMapAbstractNode*> const& nodes)
+{
+    // The prefix serializations, which the hashes cover, one after another
+    Serializer s (static_cast<int> (nodes.size ()) * (4 + 16 * 32));
+    std::vector<std::pair<SHAMapAbstractNode*, int>> hashed;
+    hashed.reserve (nodes.size ());
+
+    for (auto const node : nodes)
+    {
+        if (node->isInner ())
+        {
+            auto const inner = static_cast<SHAMapInnerNode*> (node);
+            inner->updateChildHashes ();
+            if (inner->isEmpty ())
+            {
+                node->mHash = SHAMapHash ();
+                continue;
+            }
+        }
+
+        hashed.emplace_back (node, s.getDataLength ());
+        node->addRaw (s, snfPREFIX);
+    }
+
+    std::vector<Slice> messages;
+    messages.reserve (hashed.size ());
+    for (std::size_t i = 0; i < hashed.size (); ++i)
+    {
+        auto const end = (i + 1 < hashed.size ()) ?
+            hashed[i + 1].second : s.getDataLength ();
+        messages.emplace_back (s.peekData ().data () + hashed[i].second,
+            end - hashed[i].second);
+    }
+
+    std::vector<uint256> digests (hashed.size ());
+    sha512HalfBatch (messages.data (), digests.data (), messages.size ());
+    for (std::size_t i = 0; i < hashed.size (); ++i)
+        hashed[i].first->mHash = SHAMapHash {digests[i]};
 }
 
 bool
@@ -302,18 +424,18 @@ SHAMapTreeNode::updateHash()
     if (mType == tnTRANSACTION_NM)
     {
         nh = sha512Half(HashPrefix::transactionID,
-            makeSlice(mItem->peekData()));
+            mItem->slice());
     }
     else if (mType == tnACCOUNT_STATE)
     {
         nh = sha512Half(HashPrefix::leafNode,
-            makeSlice(mItem->peekData()),
+            mItem->slice(),
                 mItem->key());
     }
     else if (mType == tnTRANSACTION_MD)
     {
         nh = sha512Half(HashPrefix::txNode,
-            makeSlice(mItem->peekData()),
+            mItem->slice(),
                 mItem->key());
     }
     else
@@ -347,17 +469,17 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i].as_uint256());
+                s.add256 (getChildHash (i).as_uint256());
         }
         else
         {
             if (getBranchCount () < 12)
             {
                 // compressed node
-                for (int i = 0; i < 16; ++i)
+                for (int i = 0, j = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i].as_uint256());
+                        s.add256 (mBranches[j++].hash.as_uint256());
                         s.add8 (i);
                     }
 
@@ -366,7 +488,7 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             else
             {
                 for (int i = 0; i < 16; ++i)
-                    s.add256 (mHashes[i].as_uint256());
+                    s.add256 (getChildHash (i).as_uint256());
 
                 s.add8 (2);
             }
@@ -393,12 +515,12 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::leafNode);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
             s.add256 (mItem->key());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
             s.add256 (mItem->key());
             s.add8 (1);
         }
@@ -408,11 +530,11 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::transactionID);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
             s.add8 (0);
         }
     }
@@ -421,12 +543,12 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::txNode);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
             s.add256 (mItem->key());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->slice ());
             s.add256 (mItem->key());
             s.add8 (4);
         }
@@ -452,13 +574,7 @@ bool SHAMapInnerNode::isEmpty () const
 int SHAMapInnerNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return static_cast<int> (std::bitset<16> (mIsBranch).count ());
 }
 
 #ifdef BEAST_DEBUG
@@ -494,7 +610,7 @@ SHAMapInnerNode::getString(const SHAMapNodeID & id) const
             ret += "\nb";
             ret += beast::lexicalCastThrow <std::string> (i);
             ret += " = ";
-            ret += to_string (mHashes[i]);
+            ret += to_string (getChildHash (i));
         }
     }
     return ret;
@@ -530,13 +646,36 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapAbstractNode> const& chil
     assert (mType == tnINNER);
     assert (mSeq != 0);
     assert (child.get() != this);
-    mHashes[m].zero();
     mHash.zero();
-    if (child)
-        mIsBranch |= (1 << m);
-    else
+
+    auto const i = index (m);
+    auto const count = getBranchCount ();
+    if (!isEmptyBranch (m))
+    {
+        if (child)
+        {
+            mBranches[i].hash.zero();
+            mBranches[i].child = child;
+            return;
+        }
+
+        // Close the gap, the slot stays for a later branch
+        for (int j = i; j + 1 < count; ++j)
+            mBranches[j] = std::move (mBranches[j + 1]);
+        mBranches[count - 1] = Branch ();
         mIsBranch &= ~ (1 << m);
-    mChildren[m] = child;
+    }
+    else if (child)
+    {
+        if (count == mCapacity)
+            reserve (std::min (16, std::max (2, 2 * count)));
+
+        for (int j = count; j > i; --j)
+            mBranches[j] = std::move (mBranches[j - 1]);
+        mBranches[i].hash.zero();
+        mBranches[i].child = child;
+        mIsBranch |= (1 << m);
+    }
 }
 
 // finished modifying, now make shareable
@@ -547,8 +686,9 @@ void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> con
     assert (mSeq != 0);
     assert (child);
     assert (child.get() != this);
+    assert (!isEmptyBranch (m));
 
-    mChildren[m] = child;
+    mBranches[index (m)].child = child;
 }
 
 SHAMapAbstractNode*
@@ -557,8 +697,11 @@ SHAMapInnerNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::unique_lock <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    if (isEmptyBranch (branch))
+        return nullptr;
+
+    std::unique_lock <std::mutex> lock (childLock ());
+    return mBranches[index (branch)].child.get ();
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -567,8 +710,11 @@ SHAMapInnerNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::unique_lock <std::mutex> lock (childLock);
-    return mChildren[branch];
+    if (isEmptyBranch (branch))
+        return {};
+
+    std::unique_lock <std::mutex> lock (childLock ());
+    return mBranches[index (branch)].child;
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -577,18 +723,20 @@ SHAMapInnerNode::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractNod
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
+    assert (!isEmptyBranch (branch));
 
-    std::unique_lock <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    auto& child = mBranches[index (branch)].child;
+    std::unique_lock <std::mutex> lock (childLock ());
+    if (child)
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         // Hook this node up
-        mChildren[branch] = node;
+        child = node;
     }
     return node;
 }
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/shamap/SerializedNodeCache.h>
+#include <ripple/protocol/Serializer.h>
+
+namespace ripple {
+
+SerializedNodeCache::SerializedNodeCache (std::string const& name,
+        int size, clock_type::rep expiration, clock_type& clock,
+            beast::Journal journal)
+    : wire_ (name + "Wire", size, expiration, clock, journal)
+    , prefix_ (name + "Prefix", size, expiration, clock, journal)
+{
+}
+
+SerializedNode::pointer
+SerializedNodeCache::get (
+    SHAMapAbstractNode const& node, SHANodeFormat format)
+{
+    // An unshared node can still change under its hash
+    if (format == snfHASH || node.getSeq () != 0)
+        return serializeNode (nullptr, node, format);
+
+    auto& cache = (format == snfWIRE) ? wire_ : prefix_;
+    auto const& hash = node.getNodeHash ().as_uint256 ();
+
+    if (auto found = cache.fetch (hash))
+        return found;
+
+    auto made = serializeNode (nullptr, node, format);
+    cache.canonicalize (hash, made);
+    return made;
+}
+
+void
+SerializedNodeCache::share (std::shared_ptr<NodeObject> const& object)
+{
+    auto node = std::make_shared<SerializedNode const> (object);
+    prefix_.canonicalize (object->getHash (), node);
+}
+
+void
+SerializedNodeCache::setTargetSize (int size)
+{
+    wire_.setTargetSize (size);
+    prefix_.setTargetSize (size);
+}
+
+void
+SerializedNodeCache::setTargetAge (clock_type::rep age)
+{
+    wire_.setTargetAge (age);
+    prefix_.setTargetAge (age);
+}
+
+void
+SerializedNodeCache::sweep ()
+{
+    wire_.sweep ();
+    prefix_.sweep ();
+}
+
+int
+SerializedNodeCache::getCacheSize () const
+{
+    return wire_.getCacheSize () + prefix_.getCacheSize ();
+}
+
+float
+SerializedNodeCache::getHitRate ()
+{
+    auto const wire = wire_.getHitsAndMisses ();
+    auto const prefix = prefix_.getHitsAndMisses ();
+    auto const hits = wire.first + prefix.first;
+    auto const total = static_cast<float> (
+        hits + wire.second + prefix.second);
+    return hits * (100.0f / std::max (1.0f, total));
+}
+
+//------------------------------------------------------------------------------
+
+SerializedNode::pointer
+serializeNode (SerializedNodeCache* cache,
+    SHAMapAbstractNode const& node, SHANodeFormat format)
+{
+    if (cache)
+        return cache->get (node, format);
+
+    Serializer s;
+    node.addRaw (s, format);
+    return std::make_shared<SerializedNode const> (
+        std::move (s.modData ()));
+}
+
+} // ripple
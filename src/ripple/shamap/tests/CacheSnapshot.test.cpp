@@ -0,0 +1,102 @@
+#include <BeastConfig.h>
+#include <ripple/shamap/CacheSnapshot.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/protocol/digest.h>
+#include <beast/unit_test/suite.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ripple {
+namespace tests {
+
+class CacheSnapshot_test : public beast::unit_test::suite
+{
+public:
+    static
+    boost::filesystem::path
+    tempPath ()
+    {
+        return boost::filesystem::temp_directory_path () /
+            boost::filesystem::unique_path ();
+    }
+
+    void
+    testLoad ()
+    {
+        testcase ("load");
+
+        beast::Journal const j;
+        auto const backend = TestFamily::memoryBackend ("CacheSnapshot_test");
+        auto const path = tempPath ();
+
+        std::uint64_t treeNodes = 0;
+        {
+            TestFamily f (j, backend, 1);
+            SHAMap map (SHAMapType::FREE, f);
+            for (int i = 0; i < 1000; ++i)
+            {
+                map.addGiveItem (make_shamapitem (sha512Half (i), Blob (40, i)),
+                    false, false);
+            }
+            map.flushDirty (hotACCOUNT_NODE, 1);
+
+            // A node which is not part of any tree
+            f.db ().store (hotLEDGER, Blob (100, 7), sha512Half (-1));
+            f.db ().fetch (sha512Half (-1));
+
+            treeNodes = f.treecache ().getTrackSize ();
+            expect (treeNodes > 1000);
+            CacheSnapshot::write (path, f);
+        }
+
+        // A restarted server with the same node store and empty caches
+        TestFamily f (j, backend, 1);
+        expect (f.treecache ().getTrackSize () == 0);
+
+        CacheSnapshot const snapshot (path);
+        expect (snapshot.treeNodes () == treeNodes);
+        expect (snapshot.nodes () == 1);
+        expect (snapshot.load (f, 4) == treeNodes + 1);
+        expect (f.treecache ().getCacheSize () == treeNodes);
+        expect (f.db ().getCacheSize () == treeNodes + 1);
+
+        boost::filesystem::remove (path);
+    }
+
+    void
+    testInvalid ()
+    {
+        testcase ("invalid");
+
+        auto const path = tempPath ();
+        {
+            std::ofstream out (path.string ().c_str (), std::ios::binary);
+            out << "RDCACHE1 and then not a whole key";
+        }
+
+        try
+        {
+            CacheSnapshot const snapshot (path);
+            fail ("not a snapshot");
+        }
+        catch (std::exception const&)
+        {
+            pass ();
+        }
+
+        boost::filesystem::remove (path);
+    }
+
+    void
+    run () override
+    {
+        testLoad ();
+        testInvalid ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CacheSnapshot,shamap,ripple);
+
+} // tests
+} // ripple
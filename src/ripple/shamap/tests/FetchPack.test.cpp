@@ -29,6 +29,7 @@
 #include <beast/unit_test/suite.h>
 #include <functional>
 #include <stdexcept>
+#include <vector>
 
 namespace ripple {
 namespace tests {
@@ -83,13 +84,13 @@ public:
         beast::Journal mJournal;
     };
 
-    std::shared_ptr <Item>
+    std::shared_ptr <Item const>
     make_random_item (beast::Random& r)
     {
         Serializer s;
         for (int d = 0; d < 3; ++d)
             s.add32 (r.nextInt ());
-        return std::make_shared <Item> (
+        return make_shamapitem (
             s.getSHA512Half(), s.peekData ());
     }
 
@@ -98,7 +99,7 @@ public:
     {
         while (n--)
         {
-            std::shared_ptr <SHAMapItem> item (
+            std::shared_ptr <SHAMapItem const> item (
                 make_random_item (r));
             auto const result (t.addItem (*item, false, false));
             assert (result);
@@ -113,8 +114,62 @@ public:
         map.emplace (hash, blob);
     }
 
+    void testCursor ()
+    {
+        testcase ("difference cursor");
+
+        beast::Journal const j;
+        TestFamily f(j);
+        auto t1 = std::make_shared <Table> (SHAMapType::FREE, f);
+        beast::Random r;
+        add_random_items (tableItems * 10, *t1, r);
+        auto const have = t1->snapShot (false);
+        add_random_items (tableItemsExtra * 10, *t1, r);
+        auto const want = t1->snapShot (false);
+
+        std::vector <uint256> all;
+        want->visitDifferences (have.get (),
+            [&all] (SHAMapAbstractNode& node)
+            {
+                all.push_back (node.getNodeHash ().as_uint256 ());
+                return true;
+            });
+        expect (all.size () > tableItemsExtra * 10, "differences found");
+
+        // Resuming in chunks visits the same nodes in the same order
+        for (std::size_t chunk : {1, 3, 16, 100000})
+        {
+            std::vector <uint256> seen;
+            SHAMap::DifferenceCursor cursor;
+            int calls = 0;
+            while (! cursor.done ())
+            {
+                std::size_t n = 0;
+                want->visitDifferences (have.get (), cursor,
+                    [&] (SHAMapAbstractNode& node)
+                    {
+                        seen.push_back (node.getNodeHash ().as_uint256 ());
+                        return ++n < chunk;
+                    });
+                expect (n <= chunk, "chunk bound");
+                if (++calls > all.size () + 1)
+                    break;
+            }
+            expect (seen == all, "same nodes for chunks of " +
+                std::to_string (chunk));
+        }
+
+        // Nothing differs from itself
+        SHAMap::DifferenceCursor cursor;
+        expect (want->visitDifferences (want.get (), cursor,
+            [] (SHAMapAbstractNode&) { return true; }), "complete");
+        expect (cursor.done (), "done");
+    }
+
     void run ()
     {
+        testCursor ();
+
         beast::Journal const j;                            // debug journal
         TestFamily f(j);
         std::shared_ptr <Table> t1 (std::make_shared <Table> (
@@ -22,8 +22,13 @@
 #include <ripple/shamap/tests/common.h>
 #include <ripple/basics/Blob.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/digest.h>
 #include <beast/unit_test/suite.h>
 #include <beast/utility/Journal.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
 
 namespace ripple {
 namespace tests {
@@ -62,27 +67,27 @@ public:
         h5.SetHex ("a92891fe4ef6cee585fdc6fda0e09eb4d386363158ec3321b8123e5a772c6ca7");
 
         SHAMap sMap (SHAMapType::FREE, f);
-        SHAMapItem i1 (h1, IntToVUC (1)), i2 (h2, IntToVUC (2)), i3 (h3, IntToVUC (3)), i4 (h4, IntToVUC (4)), i5 (h5, IntToVUC (5));
-        unexpected (!sMap.addItem (i2, true, false), "no add");
-        unexpected (!sMap.addItem (i1, true, false), "no add");
+        auto const i1 = make_shamapitem (h1, IntToVUC (1)), i2 = make_shamapitem (h2, IntToVUC (2)), i3 = make_shamapitem (h3, IntToVUC (3)), i4 = make_shamapitem (h4, IntToVUC (4)), i5 = make_shamapitem (h5, IntToVUC (5));
+        unexpected (!sMap.addItem (*i2, true, false), "no add");
+        unexpected (!sMap.addItem (*i1, true, false), "no add");
 
         auto i = sMap.begin();
         auto e = sMap.end();
-        unexpected (i == e || (*i != i1), "bad traverse");
+        unexpected (i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i2), "bad traverse");
+        unexpected (i == e || (*i != *i2), "bad traverse");
         ++i;
         unexpected (i != e, "bad traverse");
-        sMap.addItem (i4, true, false);
-        sMap.delItem (i2.key());
-        sMap.addItem (i3, true, false);
+        sMap.addItem (*i4, true, false);
+        sMap.delItem (i2->key());
+        sMap.addItem (*i3, true, false);
         i = sMap.begin();
         e = sMap.end();
-        unexpected (i == e || (*i != i1), "bad traverse");
+        unexpected (i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i3), "bad traverse");
+        unexpected (i == e || (*i != *i3), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i4), "bad traverse");
+        unexpected (i == e || (*i != *i4), "bad traverse");
         ++i;
         unexpected (i != e, "bad traverse");
 
@@ -122,8 +127,8 @@ public:
             expect (map.getHash() == zero, "bad initial empty map hash");
             for (int i = 0; i < keys.size(); ++i)
             {
-                SHAMapItem item (keys[i], IntToVUC (i));
-                map.addItem (item, true, false);
+                map.addGiveItem (
+                    make_shamapitem (keys[i], IntToVUC (i)), true, false);
                 expect (map.getHash().as_uint256() == hashes[i], "bad buildup map hash");
             }
             for (int i = keys.size() - 1; i >= 0; --i)
@@ -132,6 +137,465 @@ public:
                 map.delItem (keys[i]);
             }
             expect (map.getHash() == zero, "bad final empty map hash");
+
+            testcase ("sorted add");
+            std::vector<std::shared_ptr<SHAMapItem const>> items;
+            for (int i = 0; i < keys.size(); ++i)
+                items.push_back (make_shamapitem (keys[i], IntToVUC (i)));
+            std::sort (items.begin(), items.end(),
+                [](std::shared_ptr<SHAMapItem const> const& a,
+                   std::shared_ptr<SHAMapItem const> const& b)
+                {
+                    return a->key() < b->key();
+                });
+
+            SHAMap sorted (SHAMapType::FREE, f);
+            std::vector<std::shared_ptr<SHAMapItem const>> unsorted (items.rbegin(), items.rend());
+            expect (!sorted.addSortedItems (unsorted, true, false), "unsorted items added");
+            expect (sorted.getHash() == zero, "bad unsorted map hash");
+            expect (sorted.addSortedItems (items, true, false), "no sorted add");
+            expect (sorted.getHash().as_uint256() == hashes[7], "bad sorted map hash");
+            expect (!sorted.addSortedItems (items, true, false), "sorted add to full map");
+
+            auto it = sorted.begin();
+            for (auto const& item : items)
+            {
+                expect (it != sorted.end() && *it == *item, "bad sorted traverse");
+                ++it;
+            }
+            expect (it == sorted.end(), "bad sorted traverse");
+
+            // Keys sharing long prefixes and a single item.
+            std::vector<std::shared_ptr<SHAMapItem const>> many;
+            SHAMap added (SHAMapType::FREE, f);
+            for (int i = 0; i < 1000; ++i)
+            {
+                uint256 key (keys[i % keys.size()]);
+                key.begin()[31] = static_cast<unsigned char> (i);
+                key.begin()[30] = static_cast<unsigned char> (i >> 8);
+                many.push_back (make_shamapitem (key, IntToVUC (i)));
+                added.addGiveItem (many.back(), true, false);
+            }
+            std::sort (many.begin(), many.end(),
+                [](std::shared_ptr<SHAMapItem const> const& a,
+                   std::shared_ptr<SHAMapItem const> const& b)
+                {
+                    return a->key() < b->key();
+                });
+            SHAMap bulk (SHAMapType::FREE, f);
+            expect (bulk.addSortedItems (many, true, false), "no sorted add");
+            expect (bulk.getHash() == added.getHash(), "bad sorted map hash");
+
+            SHAMap single (SHAMapType::FREE, f);
+            SHAMap singleAdded (SHAMapType::FREE, f);
+            expect (single.addSortedItems ({items.front()}, true, false), "no sorted add");
+            singleAdded.addGiveItem (items.front(), true, false);
+            expect (single.getHash() == singleAdded.getHash(), "bad single item hash");
+        }
+
+        {
+            testcase ("sparse inner node");
+
+            auto const before = SHAMapInnerNode::getCounts ();
+            {
+                std::vector<std::shared_ptr<SHAMapAbstractNode>> leaves;
+                for (int i = 0; i < 16; ++i)
+                {
+                    leaves.push_back (std::make_shared<SHAMapTreeNode> (
+                        make_shamapitem (
+                            uint256 (static_cast<std::uint64_t> (i + 1)),
+                                IntToVUC (i)),
+                        SHAMapAbstractNode::tnACCOUNT_STATE, 1));
+                }
+
+                auto const check = [&](SHAMapInnerNode& node, int mask)
+                {
+                    bool ok = true;
+                    int count = 0;
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        bool const set = (mask & (1 << i)) != 0;
+                        count += set ? 1 : 0;
+                        ok = ok && node.isEmptyBranch (i) != set;
+                        ok = ok && node.getChild (i) ==
+                            (set ? leaves[i] : nullptr);
+                        ok = ok && node.getChildHash (i) == (set ?
+                            leaves[i]->getNodeHash () : SHAMapHash ());
+                    }
+                    return ok && node.getBranchCount () == count;
+                };
+
+                auto node = std::make_shared<SHAMapInnerNode> (1);
+                int mask = 0;
+                for (int const i : {9, 2, 15, 0, 7, 3})
+                {
+                    node->setChild (i, leaves[i]);
+                    mask |= 1 << i;
+                }
+                node->updateHashDeep ();
+                expect (check (*node, mask), "sparse insert");
+
+                node->setChild (2, nullptr);
+                node->setChild (15, nullptr);
+                mask &= ~((1 << 2) | (1 << 15));
+                node->updateHashDeep ();
+                expect (check (*node, mask), "sparse remove");
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    node->setChild (i, leaves[i]);
+                    mask |= 1 << i;
+                }
+                node->updateHashDeep ();
+                expect (check (*node, mask), "sparse full");
+
+                node->setChild (0, nullptr);
+                mask &= ~1;
+                node->updateHashDeep ();
+
+                // Every format reads back to the same branches and hash.
+                for (auto const format : {snfPREFIX, snfWIRE})
+                {
+                    Serializer s;
+                    node->addRaw (s, format);
+                    auto const copy = std::static_pointer_cast<
+                        SHAMapInnerNode> (SHAMapAbstractNode::make (
+                            s.slice (), 0, format, SHAMapHash (),
+                                false, j));
+                    expect (copy->getNodeHash () == node->getNodeHash (),
+                        "sparse hash");
+                    expect (copy->getBranchCount () == 15, "sparse count");
+                    for (int i = 0; i < 16; ++i)
+                    {
+                        expect (copy->getChildHash (i) ==
+                            node->getChildHash (i), "sparse child hash");
+                    }
+                }
+
+                auto const clone = std::static_pointer_cast<
+                    SHAMapInnerNode> (node->clone (2));
+                expect (check (*clone, mask), "sparse clone");
+                expect (clone->getNodeHash () == node->getNodeHash (),
+                    "sparse clone hash");
+
+                auto const during = SHAMapInnerNode::getCounts ();
+                expect (during.nodes == before.nodes + 2, "sparse nodes");
+            }
+            auto const after = SHAMapInnerNode::getCounts ();
+            expect (after.nodes == before.nodes, "sparse nodes freed");
+            expect (after.slots == before.slots, "sparse slots freed");
+        }
+
+        {
+            testcase ("parallel flush");
+
+            // The same changes flushed on one thread and on four.
+            tests::TestFamily serialFamily (j);
+            tests::TestFamily parallelFamily (j);
+            parallelFamily.walkThreads (4);
+
+            auto serial = std::make_shared<SHAMap> (
+                SHAMapType::FREE, serialFamily);
+            auto parallel = std::make_shared<SHAMap> (
+                SHAMapType::FREE, parallelFamily);
+
+            for (int round = 0; round < 3; ++round)
+            {
+                for (int i = 0; i < 2000; ++i)
+                {
+                    auto const key = sha512Half (round, i);
+                    auto const data = IntToVUC (round * 2000 + i);
+                    serial->addGiveItem (make_shamapitem (key, data), false, false);
+                    parallel->addGiveItem (make_shamapitem (key, data), false, false);
+                }
+                if (round != 0)
+                {
+                    // Change some of what the previous round wrote
+                    for (int i = 0; i < 500; ++i)
+                    {
+                        auto const key = sha512Half (round - 1, i * 3);
+                        serial->delItem (key);
+                        parallel->delItem (key);
+                    }
+                }
+
+                auto const flushed = serial->flushDirty (
+                    hotACCOUNT_NODE, round + 1);
+                expect (parallel->flushDirty (
+                    hotACCOUNT_NODE, round + 1) == flushed, "flushed nodes");
+                expect (parallel->getHash () == serial->getHash (),
+                    "parallel hash");
+                expect (parallelFamily.db ().fetch (
+                    parallel->getHash ().as_uint256 ()) != nullptr,
+                        "parallel root stored");
+
+                serial = serial->snapShot (true);
+                parallel = parallel->snapShot (true);
+            }
+
+            // Nothing left to flush
+            expect (parallel->flushDirty (hotACCOUNT_NODE, 4) == 0,
+                "parallel clean");
+        }
+
+        {
+            testcase ("parallel visit");
+
+            tests::TestFamily f (j);
+            auto const map = std::make_shared<SHAMap> (SHAMapType::FREE, f);
+            for (int i = 0; i < 2000; ++i)
+                map->addGiveItem (make_shamapitem (sha512Half (i), IntToVUC (i)),
+                    false, false);
+            map->setImmutable ();
+
+            std::vector<uint256> serial;
+            map->visitNodes ([&](SHAMapAbstractNode& node)
+                {
+                    serial.push_back (node.getNodeHash ().as_uint256 ());
+                    return false;
+                });
+
+            std::mutex mutex;
+            std::vector<uint256> parallel;
+            map->visitNodes ([&](SHAMapAbstractNode& node)
+                {
+                    std::lock_guard<std::mutex> lock (mutex);
+                    parallel.push_back (node.getNodeHash ().as_uint256 ());
+                    return false;
+                }, 4);
+
+            expect (serial.size () > 2000, "every node");
+            std::sort (serial.begin (), serial.end ());
+            std::sort (parallel.begin (), parallel.end ());
+            expect (parallel == serial, "same nodes");
+
+            // Stopping ends the walk early
+            std::atomic<int> visited (0);
+            map->visitNodes ([&](SHAMapAbstractNode&)
+                {
+                    return ++visited >= 10;
+                }, 4);
+            expect (visited < static_cast<int> (serial.size ()), "stopped");
+        }
+
+        {
+            testcase ("partitioned visit");
+
+            auto const backend = tests::TestFamily::memoryBackend (
+                "SHAMap_test_partitions");
+            SHAMapHash root;
+            std::vector<uint256> keys;
+            {
+                tests::TestFamily f (j, backend, 1);
+                SHAMap map (SHAMapType::FREE, f);
+                for (int i = 0; i < 2000; ++i)
+                {
+                    keys.push_back (sha512Half (i));
+                    map.addGiveItem (make_shamapitem (keys.back (), IntToVUC (i)),
+                        false, false);
+                }
+                map.flushDirty (hotACCOUNT_NODE, 1);
+                root = map.getHash ();
+            }
+            std::sort (keys.begin (), keys.end ());
+
+            for (int depth = 0; depth <= 3; ++depth)
+            {
+                // Read from the node store, the partitions ahead prefetched
+                tests::TestFamily f (j, backend, 2);
+                f.prefetchWindow (64);
+                SHAMap map (SHAMapType::FREE, f);
+                expect (map.fetchRoot (root, nullptr), "root");
+
+                std::vector<std::vector<uint256>> found (
+                    std::size_t (1) << (4 * depth));
+                auto const partitions = map.visitPartitions (depth, 4,
+                    [&](std::size_t partition, SHAMapItem const& item)
+                    {
+                        found[partition].push_back (item.key ());
+                    });
+                expect (partitions == found.size (), "partitions");
+
+                // In key order, each key in the partition of its nibbles
+                std::vector<uint256> merged;
+                bool placed = true;
+                for (std::size_t i = 0; i < found.size (); ++i)
+                {
+                    for (auto const& key : found[i])
+                    {
+                        SHAMapNodeID id;
+                        std::size_t index = 0;
+                        for (int d = 0; d < depth; ++d)
+                        {
+                            auto const branch = id.selectBranch (key);
+                            index = (index << 4) | branch;
+                            id = id.getChildNodeID (branch);
+                        }
+                        placed = placed && index == i;
+                        merged.push_back (key);
+                    }
+                }
+                expect (placed, "partition of each key");
+                expect (merged == keys, "every item in key order");
+            }
+        }
+
+        {
+            testcase ("async walk");
+
+            auto const backend = tests::TestFamily::memoryBackend (
+                "SHAMap_test_walk");
+            SHAMapHash root;
+            std::shared_ptr<NodeObject> rootObject;
+            {
+                tests::TestFamily f (j, backend, 1);
+                SHAMap map (SHAMapType::FREE, f);
+                for (int i = 0; i < 2000; ++i)
+                    map.addGiveItem (make_shamapitem (sha512Half (i), IntToVUC (i)),
+                        false, false);
+                map.flushDirty (hotACCOUNT_NODE, 1);
+                root = map.getHash ();
+                rootObject = f.db ().fetch (root.as_uint256 ());
+            }
+
+            // Read from the node store, with empty caches
+            {
+                tests::TestFamily f (j, backend, 2);
+                SHAMap map (SHAMapType::FREE, f);
+                expect (map.fetchRoot (root, nullptr), "root");
+
+                std::vector<SHAMapMissingNode> missing;
+                map.walkMap (missing, 32, 8, nullptr);
+                expect (missing.empty (), "nothing missing");
+                expect (f.db ().getFetchTotalCount () > 2000, "every node read");
+
+                // Nothing is read once the walk is stopping
+                tests::TestFamily g (j, backend, 2);
+                SHAMap other (SHAMapType::FREE, g);
+                other.fetchRoot (root, nullptr);
+                auto const reads = g.db ().getFetchTotalCount ();
+                other.walkMap (missing, 32, 8, [] { return true; });
+                expect (g.db ().getFetchTotalCount () == reads, "stopped");
+            }
+
+            // A node store only holding the root
+            {
+                tests::TestFamily f (j, tests::TestFamily::memoryBackend (
+                    "SHAMap_test_walk_root"), 2);
+                auto const slice = rootObject->getData ();
+                f.db ().store (hotACCOUNT_NODE,
+                    Blob (slice.data (), slice.data () + slice.size ()),
+                        root.as_uint256 ());
+                SHAMap map (SHAMapType::FREE, f);
+                expect (map.fetchRoot (root, nullptr), "root only");
+
+                std::vector<SHAMapMissingNode> missing;
+                map.walkMap (missing, 32, 8, nullptr);
+                expect (missing.size () == 16, std::to_string (missing.size ()));
+
+                missing.clear ();
+                map.walkMap (missing, 5, 8, nullptr);
+                expect (missing.size () == 5, "at most 5");
+            }
+        }
+
+        {
+            testcase ("delta");
+
+            tests::TestFamily f (j);
+            auto const before = std::make_shared<SHAMap> (
+                SHAMapType::FREE, f);
+            for (int i = 0; i < 2000; ++i)
+                before->addGiveItem (make_shamapitem (sha512Half (i), IntToVUC (i)),
+                    false, false);
+            before->setImmutable ();
+
+            // Added next to existing items, removed, and changed.
+            auto const after = before->snapShot (true);
+            for (int i = 2000; i < 2500; ++i)
+                after->addGiveItem (make_shamapitem (sha512Half (i), IntToVUC (i)),
+                    false, false);
+            for (int i = 0; i < 2000; i += 7)
+                after->delItem (sha512Half (i));
+            for (int i = 3; i < 2000; i += 11)
+            {
+                if (i % 7 != 0)
+                    after->updateGiveItem (make_shamapitem (
+                        sha512Half (i), IntToVUC (i + 1)), false, false);
+            }
+            after->setImmutable ();
+
+            std::map<uint256, Blob> beforeItems, afterItems;
+            before->visitLeaves (
+                [&](std::shared_ptr<SHAMapItem const> const& item)
+                {
+                    beforeItems[item->key ()] = Blob (item->slice ().data (),
+                        item->slice ().data () + item->size ());
+                });
+            after->visitLeaves (
+                [&](std::shared_ptr<SHAMapItem const> const& item)
+                {
+                    afterItems[item->key ()] = Blob (item->slice ().data (),
+                        item->slice ().data () + item->size ());
+                });
+
+            std::vector<uint256> expected;
+            for (auto const& item : beforeItems)
+            {
+                auto const other = afterItems.find (item.first);
+                if (other == afterItems.end () || other->second != item.second)
+                    expected.push_back (item.first);
+            }
+            for (auto const& item : afterItems)
+                if (beforeItems.find (item.first) == beforeItems.end ())
+                    expected.push_back (item.first);
+            std::sort (expected.begin (), expected.end ());
+
+            std::vector<uint256> found;
+            bool same = true;
+            expect (before->visitDelta (*after,
+                [&](uint256 const& key,
+                    std::shared_ptr<SHAMapItem const> const& ours,
+                    std::shared_ptr<SHAMapItem const> const& theirs)
+                {
+                    found.push_back (key);
+                    auto const b = beforeItems.find (key);
+                    auto const a = afterItems.find (key);
+                    same = same &&
+                        (ours ? (b != beforeItems.end () &&
+                            ours->slice () == makeSlice (b->second)) :
+                                b == beforeItems.end ()) &&
+                        (theirs ? (a != afterItems.end () &&
+                            theirs->slice () == makeSlice (a->second)) :
+                                a == afterItems.end ());
+                    return true;
+                }), "delta complete");
+            expect (found == expected, "delta keys in order");
+            expect (same, "delta items");
+
+            SHAMap::Delta differences;
+            expect (before->compare (*after, differences, 100000),
+                "compare complete");
+            expect (differences.size () == expected.size (), "compare size");
+            expect (!before->compare (*after, differences, 10),
+                "compare stops");
+
+            int visited = 0;
+            expect (!after->visitDelta (*before,
+                [&](uint256 const&,
+                    std::shared_ptr<SHAMapItem const> const&,
+                    std::shared_ptr<SHAMapItem const> const&)
+                {
+                    return ++visited < 5;
+                }), "delta stops");
+            expect (visited == 5, "delta stopped");
+            expect (before->visitDelta (*before,
+                [](uint256 const&,
+                    std::shared_ptr<SHAMapItem const> const&,
+                    std::shared_ptr<SHAMapItem const> const&)
+                {
+                    return false;
+                }), "no delta");
         }
     }
 };
@@ -0,0 +1,158 @@
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/protocol/Serializer.h>
+#include <beast/unit_test/suite.h>
+#include <beast/utility/Journal.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace tests {
+
+class SHAMapInnerNode_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::shared_ptr<SHAMapAbstractNode>
+    makeLeaf (int i)
+    {
+        Blob data (32, static_cast<unsigned char> (i));
+        return std::make_shared<SHAMapTreeNode> (
+            make_shamapitem (
+                uint256 (static_cast<std::uint64_t> (i + 1)), data),
+            SHAMapAbstractNode::tnACCOUNT_STATE, 0);
+    }
+
+    /** An inner node as read from the node store, with no children. */
+    static
+    std::shared_ptr<SHAMapInnerNode>
+    makeInner (int seed, beast::Journal j)
+    {
+        auto node = std::make_shared<SHAMapInnerNode> (1);
+        for (int i = 0; i < 16; ++i)
+            node->setChild (i, makeLeaf (seed * 16 + i));
+        node->updateHashDeep ();
+
+        Serializer s;
+        node->addRaw (s, snfPREFIX);
+        return std::static_pointer_cast<SHAMapInnerNode> (
+            SHAMapAbstractNode::make (s.slice (), 0, snfPREFIX,
+                SHAMapHash (), false, j));
+    }
+
+    void
+    testCanonicalize ()
+    {
+        testcase ("concurrent canonicalize");
+
+        beast::Journal const j;
+        int const nodeCount = 8;
+        int const threadCount = 8;
+        int const rounds = 200;
+
+        for (int round = 0; round < rounds; ++round)
+        {
+            std::vector<std::shared_ptr<SHAMapInnerNode>> nodes;
+            for (int n = 0; n < nodeCount; ++n)
+                nodes.push_back (makeInner (n, j));
+
+            // Every thread makes its own copy of each child and races to
+            // hook it up; all of them must get back the one that won.
+            std::vector<std::vector<std::shared_ptr<SHAMapAbstractNode>>>
+                found (threadCount);
+            std::atomic<int> ready (0);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back ([&, t]()
+                {
+                    std::vector<std::shared_ptr<SHAMapAbstractNode>> mine;
+                    for (int n = 0; n < nodeCount; ++n)
+                        for (int i = 0; i < 16; ++i)
+                            mine.push_back (makeLeaf (n * 16 + i));
+
+                    ++ready;
+                    while (ready < threadCount)
+                        std::this_thread::yield ();
+
+                    for (int k = 0; k < nodeCount * 16; ++k)
+                    {
+                        // Spread the threads over different branches
+                        auto const slot = (k + t * 16) % (nodeCount * 16);
+                        auto const& node = nodes[slot / 16];
+                        auto const branch = slot % 16;
+                        node->getChildPointer (branch);
+                        found[t].push_back (node->canonicalizeChild (
+                            branch, mine[slot]));
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join ();
+
+            bool same = true;
+            for (int t = 0; t < threadCount; ++t)
+            {
+                for (int k = 0; k < nodeCount * 16; ++k)
+                {
+                    auto const slot = (k + t * 16) % (nodeCount * 16);
+                    same = same && found[t][k] ==
+                        nodes[slot / 16]->getChild (slot % 16);
+                }
+            }
+            expect (same, "one child per branch");
+            if (!same)
+                return;
+        }
+    }
+
+    void
+    testConcurrentReads ()
+    {
+        testcase ("concurrent reads");
+
+        beast::Journal const j;
+        auto const node = makeInner (0, j);
+        std::vector<std::shared_ptr<SHAMapAbstractNode>> children;
+        for (int i = 0; i < 16; ++i)
+        {
+            children.push_back (makeLeaf (i));
+            node->canonicalizeChild (i, children[i]);
+        }
+
+        std::atomic<bool> ok (true);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+        {
+            threads.emplace_back ([&]()
+            {
+                for (int k = 0; k < 20000; ++k)
+                {
+                    auto const i = k % 16;
+                    if (node->getChild (i) != children[i] ||
+                        node->getChildPointer (i) != children[i].get ())
+                        ok = false;
+                    if (k % 1000 == 0 && !node->clone (2))
+                        ok = false;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join ();
+        expect (ok.load (), "stable children");
+    }
+
+    void
+    run () override
+    {
+        testCanonicalize ();
+        testConcurrentReads ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapInnerNode,shamap,ripple);
+
+} // tests
+} // ripple
@@ -36,13 +36,13 @@ namespace tests {
 class sync_test : public beast::unit_test::suite
 {
 public:
-    static std::shared_ptr<SHAMapItem> makeRandomAS ()
+    static std::shared_ptr<SHAMapItem const> makeRandomAS ()
     {
         Serializer s;
 
         for (int d = 0; d < 3; ++d) s.add32 (rand ());
 
-        return std::make_shared<SHAMapItem>(
+        return make_shamapitem (
             s.getSHA512Half(), s.peekData ());
     }
 
@@ -56,7 +56,7 @@ public:
 
         for (int i = 0; i < count; ++i)
         {
-            std::shared_ptr<SHAMapItem> item = makeRandomAS ();
+            std::shared_ptr<SHAMapItem const> item = makeRandomAS ();
             items.push_back (item->key());
 
             if (!map.addItem (*item, false, false))
@@ -90,7 +90,7 @@ public:
         return true;
     }
 
-    void run ()
+    void testSync ()
     {
         unsigned int seed;
 
@@ -112,11 +112,11 @@ public:
         source.setImmutable ();
 
         std::vector<SHAMapNodeID> nodeIDs, gotNodeIDs;
-        std::vector< Blob > gotNodes;
+        std::vector<SerializedNode::pointer> gotNodes;
         std::vector<uint256> hashes;
 
         std::vector<SHAMapNodeID>::iterator nodeIDIterator;
-        std::vector< Blob >::iterator rawNodeIterator;
+        std::vector<SerializedNode::pointer>::iterator rawNodeIterator;
 
         int passes = 0;
         int nodes = 0;
@@ -129,7 +129,7 @@ public:
 
         unexpected (gotNodes.size () < 1, "NodeSize");
 
-        unexpected (!destination.addRootNode (*gotNodes.begin (), snfWIRE, nullptr).isGood(), "AddRootNode");
+        unexpected (!destination.addRootNode ((*gotNodes.begin ())->slice (), snfWIRE, nullptr).isGood(), "AddRootNode");
 
         nodeIDs.clear ();
         gotNodes.clear ();
@@ -181,10 +181,10 @@ public:
             {
                 ++nodes;
 #ifdef SMS_DEBUG
-                bytes += rawNodeIterator->size ();
+                bytes += (*rawNodeIterator)->slice ().size ();
 #endif
 
-                if (!destination.addKnownNode (*nodeIDIterator, *rawNodeIterator, nullptr).isGood ())
+                if (!destination.addKnownNode (*nodeIDIterator, (*rawNodeIterator)->slice (), nullptr).isGood ())
                 {
                     fail ("AddKnownNode");
                 }
@@ -220,6 +220,92 @@ public:
             passes << " passes, " << nodes << " nodes";
 #endif
     }
+
+    void testPrefetch ()
+    {
+        testcase ("prefetch");
+
+        beast::Journal const j;
+        TestFamily f (j);
+        SHAMap source (SHAMapType::FREE, f);
+        for (int i = 0; i < 10000; ++i)
+            source.addItem (*makeRandomAS (), false, false);
+        source.flushDirty (hotACCOUNT_NODE, 1);
+        auto const hash = source.getHash ();
+
+        // Fresh families share the memory backend but none of its caches
+        for (int const window : {0, 1, 16, 256})
+        {
+            TestFamily g (j);
+            g.prefetchWindow (window);
+            SHAMap destination (SHAMapType::FREE, hash.as_uint256 (), g);
+            expect (destination.fetchRoot (hash, nullptr), "fetchRoot");
+
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::vector<uint256> hashes;
+            destination.getMissingNodes (nodeIDs, hashes, 2048, nullptr);
+            expect (nodeIDs.empty () && hashes.empty (),
+                "missing with window " + std::to_string (window));
+            expect (source.deepCompare (destination),
+                "deep compare with window " + std::to_string (window));
+        }
+    }
+
+    void testServeCache ()
+    {
+        testcase ("serve cache");
+
+        beast::Journal const j;
+        TestFamily f (j);
+        f.serialcache (4096);
+        SHAMap source (SHAMapType::FREE, f);
+        for (int i = 0; i < 1000; ++i)
+            source.addItem (*makeRandomAS (), false, false);
+        source.flushDirty (hotACCOUNT_NODE, 1);
+        source.setImmutable ();
+        auto const hash = source.getHash ();
+
+        // A second request is served from the cache
+        std::vector<SHAMapNodeID> ids, cachedIDs;
+        std::vector<SerializedNode::pointer> nodes, cached;
+        expect (source.getNodeFat (SHAMapNodeID (), ids, nodes, true, 2));
+        expect (source.getNodeFat (
+            SHAMapNodeID (), cachedIDs, cached, true, 2));
+        expect (nodes.size () == cached.size ());
+        for (std::size_t i = 0; i < nodes.size (); ++i)
+            expect (nodes[i] == cached[i], "cached node");
+
+        // The cached forms are the ones serialized without a cache
+        TestFamily g (j);
+        SHAMap copy (SHAMapType::FREE, hash.as_uint256 (), g);
+        expect (copy.fetchRoot (hash, nullptr), "fetchRoot");
+        std::vector<SHAMapNodeID> copyIDs;
+        std::vector<SerializedNode::pointer> copied;
+        expect (copy.getNodeFat (SHAMapNodeID (), copyIDs, copied, true, 2));
+        expect (copied.size () == nodes.size ());
+        for (std::size_t i = 0; i < copied.size (); ++i)
+            expect (copied[i]->slice () == nodes[i]->slice (), "wire form");
+
+        // A node read from the node store shares its prefix form
+        TestFamily h (j);
+        h.serialcache (4096);
+        SHAMap loaded (SHAMapType::FREE, hash.as_uint256 (), h);
+        expect (loaded.fetchRoot (hash, nullptr), "fetchRoot");
+        expect (h.serialcache ()->getCacheSize () == 1);
+
+        Serializer shared, fresh;
+        loaded.getRootNode (shared, snfPREFIX);
+        copy.getRootNode (fresh, snfPREFIX);
+        expect (shared.peekData () == fresh.peekData (), "prefix form");
+        expect (h.serialcache ()->getCacheSize () == 1);
+    }
+
+    void run ()
+    {
+        testSync ();
+        testPrefetch ();
+        testServeCache ();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(sync,shamap,ripple);
@@ -0,0 +1,463 @@
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/random/rngfill.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace tests {
+
+/** Times the operations on state and transaction maps.
+
+    Each run fills a map with random items, then times iterating it,
+    flushing it to an in-memory node store, taking a snapshot and changing
+    it, comparing the two, updating and deleting items, and reading the
+    whole map back with getMissingNodes through a backend that waits
+    before every read. Last come random reads of items from a cold map
+    through that backend, first one at a time, then with the paths to the
+    items next in line prefetched. Each operation is reported in ns per
+    item or node, and the map's memory in bytes per node.
+
+    Runs are separated by ';', parameters of a run by ',':
+
+        items       Number of items, default 1000000.
+        type        "state" or "transaction", default state.
+        latency_us  Wait before each node store read, default 20.
+        window      Prefetch window of getMissingNodes, default 64.
+        threads     Node store read threads, default 4.
+        ahead       Items prefetched ahead of each random read, default 8.
+        seed        Seed of the key and data generator.
+
+    The in-memory node store keeps every node written until the process
+    exits, so long series of large runs need memory to match.
+*/
+class SHAMapTiming_test : public beast::unit_test::suite
+{
+public:
+    struct Params
+    {
+        std::size_t items;
+        SHAMapType type;
+        std::chrono::microseconds latency;
+        int window;
+        int threads;
+        int ahead;
+        std::uint64_t seed;
+    };
+
+    using clock_type = std::chrono::steady_clock;
+
+    /** A memory backend that waits before every read. */
+    class LatencyBackend : public NodeStore::Backend
+    {
+    private:
+        std::unique_ptr<NodeStore::Backend> backend_;
+        std::chrono::microseconds latency_;
+
+    public:
+        LatencyBackend (std::unique_ptr<NodeStore::Backend> backend,
+                std::chrono::microseconds latency)
+            : backend_ (std::move (backend))
+            , latency_ (latency)
+        {
+        }
+
+        std::string
+        getName () override
+        {
+            return backend_->getName ();
+        }
+
+        void
+        close () override
+        {
+            backend_->close ();
+        }
+
+        NodeStore::Status
+        fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override
+        {
+            std::this_thread::sleep_for (latency_);
+            return backend_->fetch (key, pObject);
+        }
+
+        bool
+        canFetchBatch () override
+        {
+            return false;
+        }
+
+        std::vector<std::shared_ptr<NodeObject>>
+        fetchBatch (std::size_t n, void const* const* keys) override
+        {
+            std::this_thread::sleep_for (latency_);
+            return backend_->fetchBatch (n, keys);
+        }
+
+        void
+        store (std::shared_ptr<NodeObject> const& object) override
+        {
+            backend_->store (object);
+        }
+
+        void
+        storeBatch (NodeStore::Batch const& batch) override
+        {
+            backend_->storeBatch (batch);
+        }
+
+        void
+        for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override
+        {
+            backend_->for_each (f);
+        }
+
+        int
+        getWriteLoad () override
+        {
+            return backend_->getWriteLoad ();
+        }
+
+        void
+        setDeletePath () override
+        {
+            backend_->setDeletePath ();
+        }
+
+        void
+        verify () override
+        {
+            backend_->verify ();
+        }
+    };
+
+    /** Makes LatencyBackends over the memory backend with the same path. */
+    class LatencyFactory : public NodeStore::Factory
+    {
+    public:
+        std::string
+        getName () const override
+        {
+            return "latency";
+        }
+
+        std::unique_ptr <NodeStore::Backend>
+        createInstance (size_t keyBytes, Section const& parameters,
+            NodeStore::Scheduler& scheduler, beast::Journal journal) override
+        {
+            Section memory (parameters);
+            memory.set ("type", "memory");
+            return std::make_unique<LatencyBackend> (
+                NodeStore::Manager::instance ().make_Backend (
+                    memory, scheduler, journal),
+                std::chrono::microseconds (
+                    get<std::uint64_t> (parameters, "latency_us", 0)));
+        }
+    };
+
+    LatencyFactory factory_;
+
+    SHAMapTiming_test ()
+    {
+        NodeStore::Manager::instance ().insert (factory_);
+    }
+
+    ~SHAMapTiming_test ()
+    {
+        NodeStore::Manager::instance ().erase (factory_);
+    }
+
+    /** Resident memory in bytes, where supported. */
+    static
+    std::uint64_t
+    residentMemory ()
+    {
+#if defined (__linux__)
+        std::ifstream status ("/proc/self/status");
+        std::string line;
+        while (std::getline (status, line))
+        {
+            if (boost::starts_with (line, "VmRSS:"))
+                return std::stoull (line.substr (6)) * 1024;
+        }
+#endif
+        return 0;
+    }
+
+    template <class Function>
+    static
+    clock_type::duration
+    measure (Function&& f)
+    {
+        auto const start = clock_type::now ();
+        f ();
+        return clock_type::now () - start;
+    }
+
+    void
+    report (std::string const& what,
+        clock_type::duration elapsed, std::size_t ops)
+    {
+        auto const ns = std::chrono::duration_cast<
+            std::chrono::nanoseconds> (elapsed).count ();
+        std::stringstream ss;
+        ss << "    " << std::left << std::setw (16) << what << std::right
+           << std::setw (12) << ops << " ops"
+           << std::setw (12) << (ops ? ns / ops : 0) << " ns/op"
+           << std::setw (10) << ns / 1000000 << " ms";
+        log << ss.str ();
+    }
+
+    static
+    Params
+    parse (std::string const& args)
+    {
+        std::vector<std::string> lines;
+        boost::split (lines, args, boost::algorithm::is_any_of (","));
+        Section section;
+        section.append (lines);
+
+        Params params;
+        params.items = get<std::size_t> (section, "items", 1000000);
+        params.type = (get<std::string> (section, "type", "state") ==
+            "transaction") ? SHAMapType::TRANSACTION : SHAMapType::STATE;
+        params.latency = std::chrono::microseconds (
+            get<std::uint64_t> (section, "latency_us", 20));
+        params.window = get<int> (section, "window", 64);
+        params.threads = std::max (get<int> (section, "threads", 4), 1);
+        params.ahead = std::max (get<int> (section, "ahead", 8), 1);
+        params.seed = get<std::uint64_t> (section, "seed", 42);
+        return params;
+    }
+
+    void
+    runOne (Params const& params, int run)
+    {
+        beast::Journal const j;
+        std::string const path = "SHAMapTiming" + std::to_string (run);
+        TestFamily f (j, TestFamily::memoryBackend (path), 1);
+
+        bool const isTx = params.type == SHAMapType::TRANSACTION;
+        // Typical sizes of a state entry and of a transaction with metadata
+        std::size_t const itemBytes = isTx ? 320 : 128;
+        beast::xor_shift_engine engine (params.seed);
+
+        std::vector<uint256> keys (params.items);
+        for (auto& key : keys)
+            beast::rngfill (key.begin (), key.size (), engine);
+
+        auto const makeItem = [&] (uint256 const& key)
+        {
+            Blob data (itemBytes);
+            beast::rngfill (data.data (), data.size (), engine);
+            return make_shamapitem (key, std::move (data));
+        };
+
+        // Items are made outside the timed part, a batch at a time. The
+        // k-th item has the key (k * step) % keys.size ().
+        auto const timeItems = [&] (std::size_t count, std::size_t step,
+            std::function<void (std::shared_ptr<SHAMapItem const> const&)> f)
+        {
+            clock_type::duration elapsed {};
+            std::size_t const batchSize = 65536;
+            std::vector<std::shared_ptr<SHAMapItem const>> batch;
+            for (std::size_t i = 0; i < count; i += batchSize)
+            {
+                batch.clear ();
+                for (std::size_t k = i; k < std::min (count, i + batchSize); ++k)
+                    batch.push_back (makeItem (
+                        keys[(k * step) % keys.size ()]));
+                elapsed += measure ([&] ()
+                {
+                    for (auto const& item : batch)
+                        f (item);
+                });
+            }
+            return elapsed;
+        };
+
+        log << "  " << params.items << (isTx ? " transaction" : " state") <<
+            " items, " << params.latency.count () << "us reads, window " <<
+            params.window << ", " << params.threads << " read threads";
+
+        SHAMap map (params.type, f);
+
+        // Insert in random key order
+        auto const innerBefore = SHAMapInnerNode::getCounts ();
+        auto const memoryBefore = residentMemory ();
+        auto elapsed = timeItems (keys.size (), 1,
+            [&] (std::shared_ptr<SHAMapItem const> const& item)
+            {
+                map.addGiveItem (item, isTx, false);
+            });
+        report ("insert", elapsed, keys.size ());
+
+        auto const inner = SHAMapInnerNode::getCounts ();
+        auto const innerNodes = inner.nodes - innerBefore.nodes;
+        auto const nodes = innerNodes + keys.size ();
+        {
+            std::stringstream ss;
+            ss << "    " << innerNodes << " inner nodes with " <<
+                inner.slots - innerBefore.slots << " branches, " <<
+                (residentMemory () - memoryBefore) / std::max<std::uint64_t> (
+                    nodes, 1) << " bytes/node resident";
+            log << ss.str ();
+        }
+
+        std::size_t count = 0;
+        elapsed = measure ([&] ()
+        {
+            for (auto const& item : map)
+            {
+                (void) item;
+                ++count;
+            }
+        });
+        expect (count == keys.size (), "iterated every item");
+        report ("iterate", elapsed, count);
+
+        int flushed = 0;
+        elapsed = measure ([&] ()
+        {
+            flushed = map.flushDirty (
+                isTx ? hotTRANSACTION_NODE : hotACCOUNT_NODE, 1);
+        });
+        report ("flushDirty", elapsed, flushed);
+        auto const flushedHash = map.getHash ();
+
+        std::shared_ptr<SHAMap> copy;
+        elapsed = measure ([&] ()
+        {
+            copy = map.snapShot (true);
+        });
+        report ("snapShot", elapsed, 1);
+
+        // The first change to each node of a snapshot unshares it
+        std::size_t const changes = std::max<std::size_t> (keys.size () / 100, 1);
+        elapsed = timeItems (changes, 7919,
+            [&] (std::shared_ptr<SHAMapItem const> const& item)
+            {
+                copy->updateGiveItem (item, isTx, false);
+            });
+        report ("unshare", elapsed, changes);
+
+        auto const frozen = copy->snapShot (false);
+        SHAMap::Delta delta;
+        elapsed = measure ([&] ()
+        {
+            map.compare (*frozen, delta, INT_MAX);
+        });
+        expect (delta.size () <= changes, "compare");
+        report ("compare", elapsed, delta.size ());
+
+        std::size_t const updates = std::max<std::size_t> (keys.size () / 10, 1);
+        elapsed = timeItems (updates, 7919,
+            [&] (std::shared_ptr<SHAMapItem const> const& item)
+            {
+                map.updateGiveItem (item, isTx, false);
+            });
+        report ("update", elapsed, updates);
+
+        std::size_t deleted = 0;
+        elapsed = measure ([&] ()
+        {
+            for (std::size_t i = 0; i < updates; ++i)
+                if (map.delItem (keys[i]))
+                    ++deleted;
+        });
+        report ("delete", elapsed, deleted);
+
+        // A fresh family reads every node back through the slow backend
+        Section slow (TestFamily::memoryBackend (path));
+        slow.set ("type", "latency");
+        slow.set ("latency_us", std::to_string (params.latency.count ()));
+        TestFamily g (j, slow, params.threads);
+        g.prefetchWindow (params.window);
+
+        SHAMap destination (params.type, flushedHash.as_uint256 (), g);
+        std::vector<SHAMapNodeID> nodeIDs;
+        std::vector<uint256> hashes;
+        elapsed = measure ([&] ()
+        {
+            if (destination.fetchRoot (flushedHash, nullptr))
+                destination.getMissingNodes (nodeIDs, hashes, 2048, nullptr);
+        });
+        expect (destination.getHash () == flushedHash && nodeIDs.empty (),
+            "getMissingNodes");
+        report ("getMissingNodes", elapsed, flushed);
+
+        // Every item is in the flushed map, the deletes came after
+        std::size_t const reads = std::min<std::size_t> (keys.size (), 2000);
+        auto const coldReads = [&] (int ahead)
+        {
+            TestFamily h (j, slow, params.threads);
+            SHAMap cold (params.type, flushedHash.as_uint256 (), h);
+            std::size_t found = 0;
+            auto const key = [&] (std::size_t i)
+            {
+                return keys[(i * 7919) % keys.size ()];
+            };
+            auto const elapsed = measure ([&] ()
+            {
+                if (! cold.fetchRoot (flushedHash, nullptr))
+                    return;
+                for (std::size_t i = 0; i < reads; ++i)
+                {
+                    std::vector<uint256> next;
+                    for (std::size_t k = i + 1;
+                            k < std::min (reads, i + 1 + ahead); ++k)
+                        next.push_back (key (k));
+                    cold.prefetch (next);
+                    if (cold.hasItem (key (i)))
+                        ++found;
+                }
+            });
+            expect (found == reads, "read every item");
+            report (ahead ? "read prefetched" : "read", elapsed, reads);
+        };
+        coldReads (0);
+        coldReads (params.ahead);
+    }
+
+    void
+    run () override
+    {
+        testcase ("Timing", suite::abort_on_fail);
+
+        std::string const default_args =
+            "items=1000000,type=state;"
+            "items=1000000,type=transaction";
+
+        auto const args = arg ().empty () ? default_args : arg ();
+        std::vector<std::string> runs;
+        boost::split (runs, args, boost::algorithm::is_any_of (";"));
+
+        int run = 0;
+        for (auto const& r : runs)
+        {
+            if (!r.empty ())
+                runOne (parse (r), run++);
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapTiming,shamap,ripple);
+
+} // tests
+} // ripple
@@ -43,19 +43,34 @@ private:
     NodeStore::DummyScheduler scheduler_;
     TreeNodeCache treecache_;
     FullBelowCache fullbelow_;
+    std::unique_ptr<SerializedNodeCache> serialcache_;
     std::unique_ptr<NodeStore::Database> db_;
     beast::Journal j_;
+    unsigned walkThreads_ = 1;
+    int prefetchWindow_ = 0;
 
 public:
     TestFamily (beast::Journal j)
+        : TestFamily (j, memoryBackend ("SHAMap_test"), 1)
+    {
+    }
+
+    TestFamily (beast::Journal j, Section const& backend, int readThreads)
         : treecache_ ("TreeNodeCache", 65536, 60, clock_, j)
         , fullbelow_ ("full_below", clock_)
     {
-        Section testSection;
-        testSection.set("type", "memory");
-        testSection.set("Path", "SHAMap_test");
         db_ = NodeStore::Manager::instance ().make_Database (
-            "test", scheduler_, j, 1, testSection);
+            "test", scheduler_, j, readThreads, backend);
+    }
+
+    static
+    Section
+    memoryBackend (std::string const& path)
+    {
+        Section section;
+        section.set("type", "memory");
+        section.set("Path", path);
+        return section;
     }
 
     beast::manual_clock <std::chrono::steady_clock>
@@ -94,6 +109,20 @@ public:
         return treecache_;
     }
 
+    SerializedNodeCache*
+    serialcache() override
+    {
+        return serialcache_.get ();
+    }
+
+    /** Serve nodes from a cache of their serialized forms. */
+    void
+    serialcache (int size)
+    {
+        serialcache_ = std::make_unique<SerializedNodeCache> (
+            "SerializedNodeCache", size, 60, clock_, j_);
+    }
+
     NodeStore::Database&
     db() override
     {
@@ -106,6 +135,30 @@ public:
         return *db_;
     }
 
+    unsigned
+    walkThreads() const override
+    {
+        return walkThreads_;
+    }
+
+    void
+    walkThreads (unsigned threads)
+    {
+        walkThreads_ = threads;
+    }
+
+    int
+    prefetchWindow() const override
+    {
+        return prefetchWindow_;
+    }
+
+    void
+    prefetchWindow (int window)
+    {
+        prefetchWindow_ = window;
+    }
+
     void
     missing_node (std::uint32_t refNum) override
     {
@@ -30,17 +30,24 @@
 #include <ripple/app/ledger/OrderBookDB.cpp>
 #include <ripple/app/ledger/TransactionStateSF.cpp>
 
+#include <ripple/app/ledger/impl/ClosePolicy.cpp>
 #include <ripple/app/ledger/impl/ConsensusImp.cpp>
 #include <ripple/app/ledger/impl/DisputedTx.cpp>
+#include <ripple/app/ledger/impl/FetchPackStreamer.cpp>
 #include <ripple/app/ledger/impl/InboundLedger.cpp>
 #include <ripple/app/ledger/impl/InboundLedgers.cpp>
 #include <ripple/app/ledger/impl/InboundTransactions.cpp>
 #include <ripple/app/ledger/impl/LedgerCleaner.cpp>
+#include <ripple/app/ledger/impl/LedgerCloseTimings.cpp>
+#include <ripple/app/ledger/impl/LedgerReplayer.cpp>
+#include <ripple/app/ledger/impl/LedgerSaver.cpp>
+#include <ripple/app/ledger/impl/LedgerSnapshot.cpp>
 #include <ripple/app/ledger/impl/LedgerConsensusImp.cpp>
 #include <ripple/app/ledger/impl/LedgerMaster.cpp>
 #include <ripple/app/ledger/impl/LedgerTiming.cpp>
 #include <ripple/app/ledger/impl/LocalTxs.cpp>
 #include <ripple/app/ledger/impl/OpenLedger.cpp>
+#include <ripple/app/ledger/impl/SQLHistoryLoader.cpp>
 #include <ripple/app/ledger/impl/LedgerToJson.cpp>
 #include <ripple/app/ledger/impl/TransactionAcquire.cpp>
 #include <ripple/app/ledger/impl/TransactionMaster.cpp>
@@ -29,6 +29,24 @@
 #include <ripple/app/misc/Validations.cpp>
 #include <ripple/app/misc/DividendMasterImpl.cpp>
 
+#include <ripple/app/misc/impl/AccountSubscriptions.cpp>
+#include <ripple/app/misc/impl/AccountTxCache.cpp>
+#include <ripple/app/misc/impl/BinaryStream.cpp>
+#include <ripple/app/misc/impl/BookPageCache.cpp>
+#include <ripple/app/misc/impl/DeadOffers.cpp>
+#include <ripple/app/misc/impl/AccountTxMigrator.cpp>
 #include <ripple/app/misc/impl/AccountTxPaging.cpp>
+#include <ripple/app/misc/impl/DividendBatch.cpp>
+#include <ripple/app/misc/impl/DividendEngine.cpp>
+#include <ripple/app/misc/impl/FeeShareSettlement.cpp>
+#include <ripple/app/misc/impl/DividendHistory.cpp>
+#include <ripple/app/misc/impl/DividendIndex.cpp>
+#include <ripple/app/misc/impl/DividendProgress.cpp>
+#include <ripple/app/misc/impl/DividendResultFile.cpp>
+#include <ripple/app/misc/impl/DividendSigner.cpp>
+#include <ripple/app/misc/impl/DividendSubmitter.cpp>
+#include <ripple/app/misc/impl/GatewayTotals.cpp>
 #include <ripple/app/misc/impl/Transaction.cpp>
 #include <ripple/app/misc/impl/TxQ.cpp>
+#include <ripple/app/misc/impl/TxTrace.cpp>
+#include <ripple/app/misc/impl/TxVerifier.cpp>
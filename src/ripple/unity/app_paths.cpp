@@ -25,7 +25,9 @@
 #include <ripple/app/paths/Pathfinder.cpp>
 #include <ripple/app/paths/Node.cpp>
 #include <ripple/app/paths/PathRequest.cpp>
+#include <ripple/app/paths/PathCorridors.cpp>
 #include <ripple/app/paths/PathRequests.cpp>
+#include <ripple/app/paths/PathfinderCache.cpp>
 #include <ripple/app/paths/PathState.cpp>
 #include <ripple/app/paths/RippleCalc.cpp>
 #include <ripple/app/paths/RippleLineCache.cpp>
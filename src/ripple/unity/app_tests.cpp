@@ -19,15 +19,32 @@
 
 #include <BeastConfig.h>
 
+#include <ripple/app/tests/AccountSubscriptions_test.cpp>
+#include <ripple/app/tests/AccountTxCache_test.cpp>
 #include <ripple/app/tests/AccountTxPaging.test.cpp>
 #include <ripple/app/tests/AmendmentTable.test.cpp>
+#include <ripple/app/tests/BinaryStream.test.cpp>
+#include <ripple/app/tests/BookPageCache_test.cpp>
 #include <ripple/app/tests/Asset.test.cpp>
+#include <ripple/app/tests/ClosePolicy.test.cpp>
 #include <ripple/app/tests/CrossingLimits_test.cpp>
+#include <ripple/app/tests/DividendBatch.test.cpp>
+#include <ripple/app/tests/DividendEngine.test.cpp>
+#include <ripple/app/tests/DividendTiming.test.cpp>
+#include <ripple/app/tests/FeeShareSettle.test.cpp>
 #include <ripple/app/tests/DeliverMin.test.cpp>
+#include <ripple/app/tests/FeePolicy_test.cpp>
+#include <ripple/app/tests/GatewayTotals.test.cpp>
 #include <ripple/app/tests/HashRouter_test.cpp>
+#include <ripple/app/tests/LedgerCloseTimings.test.cpp>
+#include <ripple/app/tests/LedgerReplayer.test.cpp>
+#include <ripple/app/tests/LedgerSnapshot.test.cpp>
 #include <ripple/app/tests/MultiSign.test.cpp>
+#include <ripple/app/tests/NodeLoad.test.cpp>
 #include <ripple/app/tests/OfferStream.test.cpp>
 #include <ripple/app/tests/Offer.test.cpp>
+#include <ripple/app/tests/OfferPurge.test.cpp>
+#include <ripple/app/tests/OpenLedger.test.cpp>
 #include <ripple/app/tests/Path_test.cpp>
 #include <ripple/app/tests/Refer.test.cpp>
 #include <ripple/app/tests/Regression_test.cpp>
@@ -36,3 +53,4 @@
 #include <ripple/app/tests/OversizeMeta_test.cpp>
 #include <ripple/app/tests/Taker.test.cpp>
 #include <ripple/app/tests/TxQ_test.cpp>
+#include <ripple/app/tests/TxTrace.test.cpp>
@@ -27,6 +27,9 @@
 #include <ripple/app/tx/impl/Change.cpp>
 #include <ripple/app/tx/impl/CreateOffer.cpp>
 #include <ripple/app/tx/impl/CreateTicket.cpp>
+#include <ripple/app/tx/impl/FeePolicy.cpp>
+#include <ripple/app/tx/impl/FeeShareSettle.cpp>
+#include <ripple/app/tx/impl/OfferPurge.cpp>
 #include <ripple/app/tx/impl/OfferStream.cpp>
 #include <ripple/app/tx/impl/Payment.cpp>
 #include <ripple/app/tx/impl/SetAccount.cpp>
@@ -41,5 +44,7 @@
 
 #include <ripple/app/tx/impl/AddReferee.cpp>
 #include <ripple/app/tx/impl/ActiveAccount.cpp>
+#include <ripple/app/tx/impl/ActiveAccounts.cpp>
 #include <ripple/app/tx/impl/Dividend.cpp>
 #include <ripple/app/tx/impl/IssueAsset.cpp>
+#include <ripple/app/tx/impl/CompactAsset.cpp>
@@ -25,12 +25,14 @@
 #include <ripple/basics/impl/CountedObject.cpp>
 #include <ripple/basics/impl/Log.cpp>
 #include <ripple/basics/impl/make_SSLContext.cpp>
+#include <ripple/basics/impl/MemoryTag.cpp>
 #include <ripple/basics/impl/RangeSet.cpp>
 #include <ripple/basics/impl/ResolverAsio.cpp>
 #include <ripple/basics/impl/strHex.cpp>
 #include <ripple/basics/impl/StringUtilities.cpp>
 #include <ripple/basics/impl/Sustain.cpp>
 #include <ripple/basics/impl/TestSuite.test.cpp>
+#include <ripple/basics/impl/ThreadAffinity.cpp>
 #include <ripple/basics/impl/ThreadName.cpp>
 #include <ripple/basics/impl/Time.cpp>
 #include <ripple/basics/impl/UptimeTimer.cpp>
@@ -39,9 +41,14 @@
 #include <ripple/basics/tests/contract.test.cpp>
 #include <ripple/basics/tests/hardened_hash_test.cpp>
 #include <ripple/basics/tests/KeyCache.test.cpp>
+#include <ripple/basics/tests/Log.test.cpp>
+#include <ripple/basics/tests/MemoryTag.test.cpp>
 #include <ripple/basics/tests/RangeSet.test.cpp>
+#include <ripple/basics/tests/ShardedTaggedCache.test.cpp>
 #include <ripple/basics/tests/StringUtilities.test.cpp>
+#include <ripple/basics/tests/strHex.test.cpp>
 #include <ripple/basics/tests/TaggedCache.test.cpp>
+#include <ripple/basics/tests/ThreadAffinity.test.cpp>
 
 #if DOXYGEN
 #include <ripple/basics/README.md>
@@ -19,16 +19,24 @@
 
 #include <BeastConfig.h>
 
+#include <ripple/core/impl/CacheBudget.cpp>
 #include <ripple/core/impl/Config.cpp>
 #include <ripple/core/impl/DatabaseCon.cpp>
 #include <ripple/core/impl/LoadFeeTrack.cpp>
 #include <ripple/core/impl/LoadEvent.cpp>
+#include <ripple/core/impl/LatencyWindow.cpp>
 #include <ripple/core/impl/LoadMonitor.cpp>
+#include <ripple/core/impl/Profiler.cpp>
 #include <ripple/core/impl/Job.cpp>
 #include <ripple/core/impl/JobQueue.cpp>
 #include <ripple/core/impl/SNTPClock.cpp>
+#include <ripple/core/impl/ThreadPools.cpp>
 #include <ripple/core/impl/TimeKeeper.cpp>
 
+#include <ripple/core/tests/CacheBudget.test.cpp>
 #include <ripple/core/tests/Config.test.cpp>
 #include <ripple/core/tests/Coroutine.test.cpp>
+#include <ripple/core/tests/JobQueue.test.cpp>
+#include <ripple/core/tests/LatencyWindow.test.cpp>
 #include <ripple/core/tests/LoadFeeTrack.test.cpp>
+#include <ripple/core/tests/Profiler.test.cpp>
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <string>
 
+#include <ripple/json/impl/Arena.cpp>
 #include <ripple/json/impl/json_reader.cpp>
 #include <ripple/json/impl/json_value.cpp>
 #include <ripple/json/impl/json_valueiterator.cpp>
@@ -36,6 +37,8 @@
 #include <ripple/json/impl/Object.cpp>
 #include <ripple/json/impl/Output.cpp>
 
+#include <ripple/json/tests/Arena.test.cpp>
+#include <ripple/json/tests/json_reader.test.cpp>
 #include <ripple/json/tests/json_value.test.cpp>
 #include <ripple/json/tests/Object.test.cpp>
 #include <ripple/json/tests/Output.test.cpp>
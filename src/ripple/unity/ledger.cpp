@@ -30,6 +30,7 @@
 #include <ripple/ledger/impl/PaymentSandbox.cpp>
 #include <ripple/ledger/impl/RawStateTable.cpp>
 #include <ripple/ledger/impl/ReadView.cpp>
+#include <ripple/ledger/impl/ReferralCache.cpp>
 #include <ripple/ledger/impl/TxMeta.cpp>
 #include <ripple/ledger/impl/View.cpp>
 
@@ -27,19 +27,27 @@
 #include <ripple/nodestore/backend/RocksDBFactory.cpp>
 #include <ripple/nodestore/backend/RocksDBQuickFactory.cpp>
 #include <ripple/nodestore/backend/HBaseFactory.cpp>
+#include <ripple/nodestore/backend/TieredFactory.cpp>
 
+#include <ripple/nodestore/impl/AccessTrace.cpp>
 #include <ripple/nodestore/impl/BatchWriter.cpp>
+#include <ripple/nodestore/impl/BloomFilter.cpp>
 #include <ripple/nodestore/impl/DatabaseImp.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.cpp>
 #include <ripple/nodestore/impl/DummyScheduler.cpp>
 #include <ripple/nodestore/impl/DecodedBlob.cpp>
 #include <ripple/nodestore/impl/EncodedBlob.cpp>
+#include <ripple/nodestore/impl/FetchLatency.cpp>
 #include <ripple/nodestore/impl/ManagerImp.cpp>
 #include <ripple/nodestore/impl/NodeObject.cpp>
+#include <ripple/nodestore/impl/ScanRange.cpp>
 
 #include <ripple/nodestore/tests/Backend.test.cpp>
 #include <ripple/nodestore/tests/Basics.test.cpp>
+#include <ripple/nodestore/tests/BloomFilter.test.cpp>
 #include <ripple/nodestore/tests/Database.test.cpp>
+#include <ripple/nodestore/tests/FetchLatency.test.cpp>
 #include <ripple/nodestore/tests/import_test.cpp>
+#include <ripple/nodestore/tests/ScanRange.test.cpp>
 #include <ripple/nodestore/tests/Timing.test.cpp>
 
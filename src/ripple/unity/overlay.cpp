@@ -21,18 +21,28 @@
 
 #include <ripple/overlay/impl/ConnectAttempt.cpp>
 #include <ripple/overlay/impl/Cluster.cpp>
+#include <ripple/overlay/impl/IOPool.cpp>
 #include <ripple/overlay/impl/Manifest.cpp>
 #include <ripple/overlay/impl/Message.cpp>
 #include <ripple/overlay/impl/OverlayImpl.cpp>
 #include <ripple/overlay/impl/PeerImp.cpp>
 #include <ripple/overlay/impl/PeerSet.cpp>
+#include <ripple/overlay/impl/ReplyTimes.cpp>
+#include <ripple/overlay/impl/ServeQueue.cpp>
+#include <ripple/overlay/impl/Squelch.cpp>
 #include <ripple/overlay/impl/TMHello.cpp>
 #include <ripple/overlay/impl/TrafficCount.cpp>
 
 #include <ripple/overlay/tests/cluster_test.cpp>
+#include <ripple/overlay/tests/Compression.test.cpp>
+#include <ripple/overlay/tests/IOPool.test.cpp>
 #include <ripple/overlay/tests/manifest_test.cpp>
+#include <ripple/overlay/tests/ReplyTimes.test.cpp>
+#include <ripple/overlay/tests/ServeQueue.test.cpp>
 #include <ripple/overlay/tests/short_read.test.cpp>
+#include <ripple/overlay/tests/Squelch.test.cpp>
 #include <ripple/overlay/tests/TMHello.test.cpp>
+#include <ripple/overlay/tests/TrafficCount.test.cpp>
 
 #if DOXYGEN
 #include <ripple/overlay/README.md>
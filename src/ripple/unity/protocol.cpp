@@ -53,6 +53,7 @@
 #include <ripple/protocol/impl/STInteger.cpp>
 #include <ripple/protocol/impl/STLedgerEntry.cpp>
 #include <ripple/protocol/impl/STObject.cpp>
+#include <ripple/protocol/impl/STObjectView.cpp>
 #include <ripple/protocol/impl/STParsedJSON.cpp>
 #include <ripple/protocol/impl/InnerObjectFormats.cpp>
 #include <ripple/protocol/impl/STPathSet.cpp>
@@ -68,12 +69,14 @@
 #include <ripple/protocol/tests/InnerObjectFormats.test.cpp>
 #include <ripple/protocol/tests/IOUAmount.test.cpp>
 #include <ripple/protocol/tests/Issue.test.cpp>
+#include <ripple/protocol/tests/ProtocolTiming.test.cpp>
 #include <ripple/protocol/tests/PublicKey_test.cpp>
 #include <ripple/protocol/tests/Quality.test.cpp>
 #include <ripple/protocol/tests/RippleAddress.test.cpp>
 #include <ripple/protocol/tests/STAccount.test.cpp>
 #include <ripple/protocol/tests/STAmount.test.cpp>
 #include <ripple/protocol/tests/STObject.test.cpp>
+#include <ripple/protocol/tests/STObjectView.test.cpp>
 #include <ripple/protocol/tests/STTx.test.cpp>
 #include <ripple/protocol/tests/types_test.cpp>
 #include <ripple/protocol/tests/XRPAmount.test.cpp>
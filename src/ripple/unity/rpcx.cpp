@@ -34,10 +34,12 @@
 #include <ripple/rpc/handlers/AccountAsset.cpp>
 #include <ripple/rpc/handlers/AccountCurrenciesHandler.cpp>
 #include <ripple/rpc/handlers/AccountDividend.cpp>
+#include <ripple/rpc/handlers/AccountBatch.cpp>
 #include <ripple/rpc/handlers/AccountInfo.cpp>
 #include <ripple/rpc/handlers/AccountLines.cpp>
 #include <ripple/rpc/handlers/AccountObjects.cpp>
 #include <ripple/rpc/handlers/AccountOffers.cpp>
+#include <ripple/rpc/handlers/AccountReferrals.cpp>
 #include <ripple/rpc/handlers/AccountTx.cpp>
 #include <ripple/rpc/handlers/AccountTxOld.cpp>
 #include <ripple/rpc/handlers/AccountTxSwitch.cpp>
@@ -63,6 +65,8 @@
 #include <ripple/rpc/handlers/LedgerEntry.cpp>
 #include <ripple/rpc/handlers/LedgerHeader.cpp>
 #include <ripple/rpc/handlers/LedgerRequest.cpp>
+#include <ripple/rpc/handlers/LedgerSnapshot.cpp>
+#include <ripple/rpc/handlers/LedgerTimings.cpp>
 #include <ripple/rpc/handlers/LogLevel.cpp>
 #include <ripple/rpc/handlers/LogRotate.cpp>
 #include <ripple/rpc/handlers/LoadDividend.cpp>
@@ -72,8 +76,10 @@
 #include <ripple/rpc/handlers/Peers.cpp>
 #include <ripple/rpc/handlers/Ping.cpp>
 #include <ripple/rpc/handlers/Print.cpp>
+#include <ripple/rpc/handlers/Profile.cpp>
 #include <ripple/rpc/handlers/Random.cpp>
 #include <ripple/rpc/handlers/RipplePathFind.cpp>
+#include <ripple/rpc/handlers/RPCStatsHandler.cpp>
 #include <ripple/rpc/handlers/ServerInfo.cpp>
 #include <ripple/rpc/handlers/ServerState.cpp>
 #include <ripple/rpc/handlers/SignFor.cpp>
@@ -103,12 +109,20 @@
 #include <ripple/rpc/impl/GetAccountObjects.cpp>
 #include <ripple/rpc/impl/Handler.cpp>
 #include <ripple/rpc/impl/KeypairForSignature.cpp>
+#include <ripple/rpc/impl/LedgerDataCursors.cpp>
 #include <ripple/rpc/impl/LegacyPathFind.cpp>
 #include <ripple/rpc/impl/LookupLedger.cpp>
 #include <ripple/rpc/impl/ParseAccountIds.cpp>
 #include <ripple/rpc/impl/TransactionSign.cpp>
+#include <ripple/rpc/impl/TxHistoryIndex.cpp>
+#include <ripple/rpc/impl/RPCResponseCache.cpp>
+#include <ripple/rpc/impl/RPCStats.cpp>
 #include <ripple/rpc/impl/RPCVersion.cpp>
 
 #include <ripple/rpc/tests/JSONRPC.test.cpp>
 #include <ripple/rpc/tests/KeyGeneration.test.cpp>
+#include <ripple/rpc/tests/LedgerDataCursors.test.cpp>
+#include <ripple/rpc/tests/RPCResponseCache.test.cpp>
+#include <ripple/rpc/tests/RPCStats.test.cpp>
 #include <ripple/rpc/tests/Status.test.cpp>
+#include <ripple/rpc/tests/TxHistoryIndex.test.cpp>
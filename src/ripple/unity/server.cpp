@@ -28,4 +28,6 @@
 #include <ripple/server/impl/Role.cpp>
 #include <ripple/server/impl/ServerImpl.cpp>
 #include <ripple/server/impl/ServerHandlerImp.cpp>
+#include <ripple/server/tests/JSONRPCUtil.test.cpp>
+#include <ripple/server/tests/SendQueue.test.cpp>
 #include <ripple/server/tests/Server.test.cpp>
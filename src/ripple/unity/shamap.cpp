@@ -18,13 +18,18 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/shamap/impl/CacheSnapshot.cpp>
 #include <ripple/shamap/impl/SHAMap.cpp>
 #include <ripple/shamap/impl/SHAMapDelta.cpp>
 #include <ripple/shamap/impl/SHAMapItem.cpp>
 #include <ripple/shamap/impl/SHAMapMissingNode.cpp>
 #include <ripple/shamap/impl/SHAMapNodeID.cpp>
+#include <ripple/shamap/impl/SerializedNodeCache.cpp>
 #include <ripple/shamap/impl/SHAMapSync.cpp>
 #include <ripple/shamap/impl/SHAMapTreeNode.cpp>
+#include <ripple/shamap/tests/CacheSnapshot.test.cpp>
 #include <ripple/shamap/tests/FetchPack.test.cpp>
 #include <ripple/shamap/tests/SHAMap.test.cpp>
+#include <ripple/shamap/tests/SHAMapInnerNode.test.cpp>
 #include <ripple/shamap/tests/SHAMapSync.test.cpp>
+#include <ripple/shamap/tests/SHAMapTiming.test.cpp>
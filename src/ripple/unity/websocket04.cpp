@@ -26,4 +26,7 @@
 #endif
 #define _WEBSOCKETPP_CPP11_STL_
 
+#include <ripple/websocket/Deflate.cpp>
 #include <ripple/websocket/WebSocket04.cpp>
+
+#include <ripple/websocket/tests/Deflate.test.cpp>
@@ -22,6 +22,7 @@
 
 
 #include <ripple/websocket/AutoSocket.h>
+#include <ripple/websocket/Deflate.h>
 #include <ripple/websocket/Logger.h>
 
 #include <websocketpp/config/core.hpp>
@@ -53,6 +54,10 @@ struct Config04 : ConfigBase04 {
 
     using rng_type = base::rng_type;
 
+    using connection_base = DeflateConnection;
+
+    using permessage_deflate_type = InflateExtension <type>;
+
     struct transport_config : public base::transport_config {
         using concurrency_type = type::concurrency_type;
         using alog_type        = type::alog_type;
@@ -38,6 +38,7 @@
 #include <ripple/json/to_string.h>
 #include <ripple/rpc/RPCHandler.h>
 #include <ripple/server/Role.h>
+#include <ripple/server/SendQueue.h>
 #include <ripple/websocket/WebSocket.h>
 
 #include <boost/asio.hpp>
@@ -77,6 +78,8 @@ public:
         boost::asio::io_service& io_service,
         std::pair<std::string, std::string> identity);
 
+    ~ConnectionImpl ();
+
     void preDestroy ();
 
     static void destroy (std::shared_ptr <ConnectionImpl <WebSocket> >)
@@ -85,6 +88,12 @@ public:
     }
 
     void send (Json::Value const& jvObj, bool broadcast);
+    void send (Json::Value const& jvObj, SharedMessage const& message,
+        bool broadcast);
+    void send (SharedMessage const& message, bool broadcast);
+
+    // Sends the stream messages queued while the client was behind
+    void onSendEmpty ();
 
     void disconnect ();
     static void handle_disconnect(weak_connection_ptr c);
@@ -104,6 +113,15 @@ public:
     void setPingTimer ();
 
 private:
+    // A stream message waiting for the client to catch up
+    struct Queued
+    {
+        std::string payload;
+        bool binary;
+    };
+
+    void sendStream (SharedMessage const& message);
+
     Application& app_;
     HTTP::Port const& m_port;
     Resource::Manager& m_resourceManager;
@@ -121,6 +139,9 @@ private:
     bool m_receiveQueueRunning = false;
     bool m_isDead = false;
 
+    std::mutex m_sendMutex;
+    SendQueue <Queued> m_sendQueue;
+
     handler_type& m_handler;
     weak_connection_ptr m_connection;
 
@@ -153,6 +174,7 @@ ConnectionImpl <WebSocket>::ConnectionImpl (
         , m_pingTimer (io_service)
         , m_handler (handler)
         , m_connection (cpConnection)
+        , m_sendQueue (m_port.send_queue)
         , pingFreq_ (app.config ().WEBSOCKET_PING_FREQ)
         , j_ (app.journal ("ConnectionImpl"))
 {
@@ -166,6 +188,13 @@ ConnectionImpl <WebSocket>::ConnectionImpl (
     }
 }
 
+template <class WebSocket>
+ConnectionImpl <WebSocket>::~ConnectionImpl ()
+{
+    m_handler.onQueued (
+        -static_cast<std::int64_t> (m_sendQueue.bytes ()), 0);
+}
+
 template <class WebSocket>
 void ConnectionImpl <WebSocket>::onPong (std::string const&)
 {
@@ -365,6 +394,12 @@ void ConnectionImpl <WebSocket>::preDestroy ()
 template <class WebSocket>
 void ConnectionImpl <WebSocket>::send (Json::Value const& jvObj, bool broadcast)
 {
+    if (broadcast)
+    {
+        send (jvObj, SharedMessage (jvObj), broadcast);
+        return;
+    }
+
     JLOG (j_.debug)
             << "WebSocket: sending '" << to_string (jvObj);
     connection_ptr ptr = m_connection.lock ();
@@ -373,6 +408,107 @@ void ConnectionImpl <WebSocket>::send (Json::Value const& jvObj, bool broadcast)
         m_handler.send (ptr, jvObj, broadcast);
 }
 
+template <class WebSocket>
+void ConnectionImpl <WebSocket>::send (
+    Json::Value const& jvObj, SharedMessage const& message, bool broadcast)
+{
+    // The message is shared by every subscriber to the stream, so it is
+    // not serialized again for this one
+    JLOG (j_.debug)
+            << "WebSocket: sending '" << message.payload ();
+
+    if (broadcast)
+    {
+        sendStream (message);
+        return;
+    }
+
+    connection_ptr ptr = m_connection.lock ();
+
+    if (ptr)
+        m_handler.send (ptr, message, broadcast);
+}
+
+template <class WebSocket>
+void ConnectionImpl <WebSocket>::send (
+    SharedMessage const& message, bool broadcast)
+{
+    JLOG (j_.debug)
+            << "WebSocket: sending " << message.payload ().size () <<
+                " bytes";
+
+    if (broadcast)
+    {
+        sendStream (message);
+        return;
+    }
+
+    connection_ptr ptr = m_connection.lock ();
+
+    if (ptr)
+        m_handler.send (ptr, message, broadcast);
+}
+
+// Stream messages go straight to the websocket while the client keeps up.
+// Once the websocket holds too much, they wait here and the port's policy
+// decides what happens as more arrive.
+template <class WebSocket>
+void ConnectionImpl <WebSocket>::sendStream (SharedMessage const& message)
+{
+    connection_ptr ptr = m_connection.lock ();
+
+    if (!ptr)
+        return;
+
+    auto const size = message.payload ().size ();
+    bool tooSlow;
+    {
+        ScopedLockType sl (m_sendMutex);
+
+        auto const pending = WebSocket::bufferedAmount (*ptr);
+        if (m_sendQueue.fits (size, pending))
+        {
+            m_handler.send (ptr, message, true);
+            return;
+        }
+
+        auto const bytes = m_sendQueue.bytes ();
+        auto const dropped = m_sendQueue.dropped ();
+        tooSlow = ! m_sendQueue.push ({message.payload (), message.binary ()},
+            size, message.key (), pending);
+        m_handler.onQueued (
+            static_cast<std::int64_t> (m_sendQueue.bytes ()) -
+                static_cast<std::int64_t> (bytes),
+            m_sendQueue.dropped () - dropped);
+    }
+
+    if (tooSlow)
+        m_handler.closeTooSlow (ptr);
+}
+
+template <class WebSocket>
+void ConnectionImpl <WebSocket>::onSendEmpty ()
+{
+    if (connection_ptr ptr = m_connection.lock ())
+    {
+        ScopedLockType sl (m_sendMutex);
+
+        if (! m_sendQueue.empty ())
+        {
+            m_handler.onQueued (
+                -static_cast<std::int64_t> (m_sendQueue.bytes ()), 0);
+
+            while (! m_sendQueue.empty ())
+            {
+                auto const queued = m_sendQueue.pop ();
+                m_handler.sendQueued (ptr, queued.payload, queued.binary);
+            }
+        }
+    }
+
+    InfoSub::onSendEmpty ();
+}
+
 template <class WebSocket>
 void ConnectionImpl <WebSocket>::disconnect ()
 {
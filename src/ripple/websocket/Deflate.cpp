@@ -0,0 +1,124 @@
+#include <BeastConfig.h>
+#include <ripple/websocket/Deflate.h>
+#include <ripple/basics/contract.h>
+#include <beast/module/core/text/LexicalCast.h>
+#include <cassert>
+#include <stdexcept>
+
+namespace ripple {
+namespace websocket {
+
+// zlib cannot make raw deflate streams with a window of 256 bytes
+static int const minWindowBits = 9;
+
+std::pair<DeflateParams, std::string>
+negotiateDeflate (websocketpp::http::parameter_list const& offers,
+    bool contextTakeover)
+{
+    for (auto const& offer : offers)
+    {
+        if (offer.first != "permessage-deflate")
+            continue;
+
+        DeflateParams params;
+        params.contextTakeover = contextTakeover;
+        bool windowLimited = false;
+        bool valid = true;
+        for (auto const& attribute : offer.second)
+        {
+            auto const& name = attribute.first;
+            auto const& value = attribute.second;
+            if (name == "server_no_context_takeover" && value.empty ())
+            {
+                params.contextTakeover = false;
+            }
+            else if (name == "client_no_context_takeover" && value.empty ())
+            {
+                // We ask for it anyway
+            }
+            else if (name == "server_max_window_bits")
+            {
+                int bits;
+                if (! beast::lexicalCastChecked (bits, value) ||
+                        bits < minWindowBits || bits > MAX_WBITS)
+                    valid = false;
+                else
+                    params.windowBits = bits;
+                windowLimited = true;
+            }
+            else if (name == "client_max_window_bits")
+            {
+                // We inflate with the largest window, whatever they use
+                int bits;
+                if (! value.empty () && (! beast::lexicalCastChecked (
+                        bits, value) || bits < 8 || bits > MAX_WBITS))
+                    valid = false;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+        if (! valid)
+            continue;
+
+        params.enabled = true;
+        std::string response =
+            "permessage-deflate; client_no_context_takeover";
+        if (! params.contextTakeover)
+            response += "; server_no_context_takeover";
+        if (windowLimited)
+            response += "; server_max_window_bits=" +
+                std::to_string (params.windowBits);
+        return {params, response};
+    }
+    return {};
+}
+
+//------------------------------------------------------------------------------
+
+Deflater::Deflater (int windowBits)
+{
+    stream_.zalloc = Z_NULL;
+    stream_.zfree = Z_NULL;
+    stream_.opaque = Z_NULL;
+    if (deflateInit2 (&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+            -windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        Throw<std::runtime_error> ("deflateInit2 failed");
+}
+
+Deflater::~Deflater ()
+{
+    deflateEnd (&stream_);
+}
+
+std::string
+Deflater::compress (std::string const& payload)
+{
+    std::string out;
+    out.resize (deflateBound (&stream_, payload.size ()) + 16);
+
+    stream_.avail_in = static_cast<uInt> (payload.size ());
+    stream_.next_in = reinterpret_cast<Bytef*> (
+        const_cast<char*> (payload.data ()));
+    std::size_t size = 0;
+    do
+    {
+        if (size == out.size ())
+            out.resize (out.size () * 2);
+        stream_.avail_out = static_cast<uInt> (out.size () - size);
+        stream_.next_out = reinterpret_cast<Bytef*> (&out[size]);
+        deflate (&stream_, Z_SYNC_FLUSH);
+        size = out.size () - stream_.avail_out;
+    }
+    while (stream_.avail_out == 0);
+
+    // The flush ends with an empty stored block, whose last four bytes
+    // are left out of the message and added back by the receiver
+    assert (size >= 4);
+    out.resize (size - 4);
+    return out;
+}
+
+} // websocket
+} // ripple
@@ -0,0 +1,191 @@
+#ifndef RIPPLE_WEBSOCKET_DEFLATE_H_INCLUDED
+#define RIPPLE_WEBSOCKET_DEFLATE_H_INCLUDED
+
+#include <websocketpp/common/system_error.hpp>
+#include <websocketpp/error.hpp>
+#include <websocketpp/http/constants.hpp>
+#include <zlib.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace ripple {
+namespace websocket {
+
+/** The permessage-deflate parameters agreed with a client (RFC 7692).
+
+    Clients are always asked to reset their compression context after
+    each message they send.
+*/
+struct DeflateParams
+{
+    bool enabled = false;
+
+    // We keep our compression context from one message to the next
+    bool contextTakeover = false;
+
+    // The LZ77 window of the messages we compress
+    int windowBits = 15;
+};
+
+/** Choose the parameters from a client's offers of permessage-deflate.
+
+    @param offers The parsed Sec-WebSocket-Extensions request header.
+    @param contextTakeover `true` if we may keep our compression context.
+    @return The parameters, and the Sec-WebSocket-Extensions response
+            header, which is empty when no offer was accepted.
+*/
+std::pair<DeflateParams, std::string>
+negotiateDeflate (websocketpp::http::parameter_list const& offers,
+    bool contextTakeover);
+
+/** Compresses the messages of one permessage-deflate stream. */
+class Deflater
+{
+public:
+    explicit
+    Deflater (int windowBits);
+
+    ~Deflater ();
+
+    Deflater (Deflater const&) = delete;
+    Deflater& operator= (Deflater const&) = delete;
+
+    /** Compress a message, keeping the context for the next one. */
+    std::string
+    compress (std::string const& payload);
+
+private:
+    z_stream stream_;
+};
+
+/** The permessage-deflate state of a websocket connection.
+
+    Config04 makes this a base of every connection.
+*/
+struct DeflateConnection
+{
+    DeflateParams deflate;
+
+    // With context takeover, held while a message is compressed and
+    // queued, so messages are written in the order they are compressed
+    std::mutex deflateMutex;
+    std::unique_ptr<Deflater> deflater;
+};
+
+//------------------------------------------------------------------------------
+
+/** The permessage_deflate extension of Config04.
+
+    websocketpp uses it to accept any offer of the extension and to
+    decompress the messages of clients. What a port allows, and what is
+    sent back to the client, is decided when the connection is validated.
+    Messages we send are compressed by WebSocket04.
+*/
+template <class Config>
+class InflateExtension
+{
+public:
+    using err_str_pair = std::pair<websocketpp::lib::error_code, std::string>;
+
+    InflateExtension ()
+    {
+        stream_.zalloc = Z_NULL;
+        stream_.zfree = Z_NULL;
+        stream_.opaque = Z_NULL;
+        stream_.avail_in = 0;
+        stream_.next_in = Z_NULL;
+    }
+
+    ~InflateExtension ()
+    {
+        if (initialized_)
+            inflateEnd (&stream_);
+    }
+
+    InflateExtension (InflateExtension const&) = delete;
+    InflateExtension& operator= (InflateExtension const&) = delete;
+
+    bool
+    is_implemented () const
+    {
+        return true;
+    }
+
+    bool
+    is_enabled () const
+    {
+        return enabled_;
+    }
+
+    err_str_pair
+    negotiate (websocketpp::http::attribute_list const& offer)
+    {
+        websocketpp::http::parameter_list const offers {
+            {"permessage-deflate", offer}};
+        auto const result = negotiateDeflate (offers, false);
+        if (! result.first.enabled)
+            return {websocketpp::error::make_error_code (
+                websocketpp::error::general), {}};
+
+        // Deflated input is inflated with the largest window, which
+        // reads the output of any smaller one
+        if (! initialized_)
+        {
+            if (inflateInit2 (&stream_, -MAX_WBITS) != Z_OK)
+                return {websocketpp::error::make_error_code (
+                    websocketpp::error::general), {}};
+            initialized_ = true;
+        }
+        enabled_ = true;
+        return {{}, result.second};
+    }
+
+    websocketpp::lib::error_code
+    compress (std::string const&, std::string&)
+    {
+        // Messages are never handed to the processor to compress
+        return websocketpp::error::make_error_code (
+            websocketpp::error::general);
+    }
+
+    websocketpp::lib::error_code
+    decompress (std::uint8_t const* buf, std::size_t len, std::string& out)
+    {
+        // Clients reset their context for every message, so a message is
+        // inflated on its own. Nothing is decompressed at its start.
+        if (out.empty ())
+            inflateReset (&stream_);
+
+        stream_.avail_in = static_cast<uInt> (len);
+        stream_.next_in = const_cast<Bytef*> (buf);
+        do
+        {
+            unsigned char chunk[16384];
+            stream_.avail_out = sizeof (chunk);
+            stream_.next_out = chunk;
+            auto const ret = inflate (&stream_, Z_SYNC_FLUSH);
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+                    ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+                return websocketpp::error::make_error_code (
+                    websocketpp::error::general);
+            out.append (reinterpret_cast<char const*> (chunk),
+                sizeof (chunk) - stream_.avail_out);
+        }
+        while (stream_.avail_out == 0);
+
+        return {};
+    }
+
+private:
+    bool enabled_ = false;
+    bool initialized_ = false;
+    z_stream stream_;
+};
+
+} // websocket
+} // ripple
+
+#endif
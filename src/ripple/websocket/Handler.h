@@ -24,6 +24,7 @@
 #include <ripple/app/main/CollectorManager.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/JsonFields.h>
+#include <ripple/rpc/RPCStats.h>
 #include <ripple/server/Port.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/websocket/Connection.h>
@@ -75,6 +76,9 @@ private:
     beast::insight::Counter rpc_requests_;
     beast::insight::Event rpc_size_;
     beast::insight::Event rpc_time_;
+    beast::insight::Gauge send_queue_bytes_;
+    beast::insight::Counter send_queue_dropped_;
+    beast::insight::Counter send_queue_too_slow_;
     ServerDescription desc_;
     beast::Journal j_;
 
@@ -96,6 +100,14 @@ public:
         rpc_requests_ = group->make_counter ("requests");
         rpc_size_ = group->make_event ("size");
         rpc_time_ = group->make_event ("time");
+
+        auto const& ws (desc_.collectorManager.group ("websocket"));
+        send_queue_bytes_ = ws->make_gauge (
+            desc_.port.name, "send_queue_bytes");
+        send_queue_dropped_ = ws->make_counter (
+            desc_.port.name, "send_queue_dropped");
+        send_queue_too_slow_ = ws->make_counter (
+            desc_.port.name, "send_queue_too_slow");
     }
 
     HandlerImpl(HandlerImpl const&) = delete;
@@ -143,6 +155,61 @@ public:
         send (cpClient, to_string (jvObj), broadcast);
     }
 
+    void send (connection_ptr const& cpClient, SharedMessage const& message,
+               bool broadcast)
+    {
+        try
+        {
+            auto& jm = broadcast ? j_.trace : j_.info;
+            if (message.binary ())
+                JLOG (jm)
+                        << "Ws:: Sending " << message.payload ().size () <<
+                            " bytes";
+            else
+                JLOG (jm)
+                        << "Ws:: Sending '" << message.payload () << "'";
+
+            WebSocket::send (*cpClient, message);
+        }
+        catch (std::exception const&)
+        {
+            WebSocket::closeTooSlowClient (*cpClient, crTooSlow);
+        }
+    }
+
+    /** Send a message which was queued for a slow client. */
+    void sendQueued (connection_ptr const& cpClient,
+        std::string const& payload, bool binary)
+    {
+        try
+        {
+            WebSocket::send (*cpClient, payload, binary);
+        }
+        catch (std::exception const&)
+        {
+            WebSocket::closeTooSlowClient (*cpClient, crTooSlow);
+        }
+    }
+
+    /** Close a client whose queued messages reached the port's limit. */
+    void closeTooSlow (connection_ptr const& cpClient)
+    {
+        ++send_queue_too_slow_;
+        JLOG (j_.info) <<
+            "Ws:: Closing slow client, send queue limit is " <<
+                desc_.port.send_queue.bytes << " bytes";
+        WebSocket::closeTooSlowClient (*cpClient, crTooSlow);
+    }
+
+    /** Called when the messages queued for slow clients change. */
+    void onQueued (std::int64_t bytes, std::size_t dropped)
+    {
+        if (bytes != 0)
+            send_queue_bytes_ += bytes;
+        if (dropped != 0)
+            send_queue_dropped_ += dropped;
+    }
+
     void pingTimer (connection_ptr const& cpClient)
     {
         wsc_ptr ptr;
@@ -394,6 +461,7 @@ public:
         {
         }
 
+        auto const parseStart = std::chrono::steady_clock::now ();
         if (!WebSocket::isTextMessage (*mpMessage))
         {
             Json::Value jvResult (Json::objectValue);
@@ -417,20 +485,31 @@ public:
         }
         else
         {
+            auto const parsed = std::chrono::steady_clock::now () - parseStart;
+
+            std::string command;
             if (jvRequest.isMember (jss::command))
             {
                 Json::Value& jCmd = jvRequest[jss::command];
                 if (jCmd.isString())
-                    job.rename ("WSClient::" + jCmd.asString());
+                {
+                    command = jCmd.asString();
+                    job.rename ("WSClient::" + command);
+                }
             }
 
             app_.getJobQueue().postCoro(jtCLIENT, "WSClient",
-                [this, conn, cpClient, jvRequest = std::move(jvRequest)]
+                [this, conn, cpClient, jvRequest = std::move(jvRequest),
+                    command = std::move(command), parsed]
                 (std::shared_ptr<JobCoro> jc)
                 {
                     using namespace std::chrono;
                     auto const start = high_resolution_clock::now();
-                    auto buffer = to_string(conn->invokeCommand(jvRequest, jc));
+                    auto const reply = conn->invokeCommand(jvRequest, jc);
+                    auto const serializeStart = steady_clock::now();
+                    auto buffer = to_string(reply);
+                    auto const serialized = steady_clock::now() -
+                        serializeStart;
                     rpc_time_.notify (
                         static_cast <beast::insight::Event::value_type> (
                             duration_cast <milliseconds> (
@@ -439,6 +518,13 @@ public:
                     rpc_size_.notify (
                         static_cast <beast::insight::Event::value_type>
                             (buffer.size()));
+
+                    auto& stats = app_.getRPCStats ();
+                    stats.add (command, RPCStats::Stage::parse, parsed);
+                    stats.add (command, RPCStats::Stage::serialize,
+                        serialized);
+                    stats.addReply (command, buffer.size());
+
                     send (cpClient, buffer, false);
                 });
         }
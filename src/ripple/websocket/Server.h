@@ -21,6 +21,7 @@
 #define RIPPLE_WEBSOCKET_SERVER_H_INCLUDED
 
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ThreadAffinity.h>
 #include <ripple/websocket/WebSocket.h>
 #include <beast/threads/Thread.h>
 #include <memory>
@@ -59,6 +60,7 @@ private:
     void run ()
     {
         beast::Thread::setCurrentThreadName ("WebSocket");
+        setCurrentThreadAffinity (desc_.app.config ().THREADS.rpc.cpus);
 
         JLOG (j_.warning)
             << "Websocket: creating endpoint " << desc_.port;
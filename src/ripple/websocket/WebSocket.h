@@ -20,6 +20,7 @@
 #ifndef RIPPLED_RIPPLE_WEBSOCKET_WEBSOCKET_H
 #define RIPPLED_RIPPLE_WEBSOCKET_WEBSOCKET_H
 
+#include <ripple/net/SharedMessage.h>
 #include <ripple/websocket/MakeServer.h>
 #include <beast/asio/IPAddressConversion.h>
 #include <memory>
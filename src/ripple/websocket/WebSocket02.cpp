@@ -53,6 +53,26 @@ bool WebSocket02::isTextMessage (Message const& message)
     return message.get_opcode () == websocketpp_02::frame::opcode::TEXT;
 }
 
+void WebSocket02::send (Connection& connection, SharedMessage const& message)
+{
+    // Messages come from the connection's own pool, so only the payload
+    // is shared
+    send (connection, message.payload (), message.binary ());
+}
+
+void WebSocket02::send (
+    Connection& connection, std::string const& payload, bool binary)
+{
+    connection.send (payload, binary
+        ? websocketpp_02::frame::opcode::BINARY
+        : websocketpp_02::frame::opcode::TEXT);
+}
+
+std::size_t WebSocket02::bufferedAmount (Connection& connection)
+{
+    return connection.buffered_amount ();
+}
+
 using HandlerPtr02 = WebSocket02::HandlerPtr;
 using EndpointPtr02 = WebSocket02::EndpointPtr;
 
@@ -65,6 +65,18 @@ struct WebSocket02
     static
     bool isTextMessage (Message const&);
 
+    /** Send a message which is shared with other connections. */
+    static
+    void send (Connection&, SharedMessage const&);
+
+    /** Send a TEXT or BINARY message. */
+    static
+    void send (Connection&, std::string const& payload, bool binary);
+
+    /** Return the bytes queued on the connection and not yet written. */
+    static
+    std::size_t bufferedAmount (Connection&);
+
     /** Create a new Handler. */
     static
     HandlerPtr makeHandler (ServerDescription const&);
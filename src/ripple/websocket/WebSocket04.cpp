@@ -52,6 +52,177 @@ bool WebSocket04::isTextMessage (Message const& message)
     return message.get_opcode () == websocketpp::frame::opcode::text;
 }
 
+// Messages smaller than this are not worth compressing (bytes)
+static std::size_t const deflateMinBytes = 256;
+
+// Builds the frame of a message from a server, which is not masked
+static
+WebSocket04::MessagePtr
+makeFrame (websocketpp::frame::opcode::value op,
+    std::string const& payload, bool deflated)
+{
+    namespace frame = websocketpp::frame;
+
+    auto message = websocketpp::lib::make_shared <WebSocket04::Message> (
+        nullptr, op, 0);
+    frame::basic_header header (op, payload.size (), true, false, deflated);
+    message->set_header (frame::prepare_header (
+        header, frame::extended_header (payload.size ())));
+    message->set_payload (payload);
+    message->set_prepared (true);
+    return message;
+}
+
+// Connections refuse to send invalid text, so it is not framed
+static
+bool
+isValid (websocketpp::frame::opcode::value op, std::string const& payload)
+{
+    return op != websocketpp::frame::opcode::text ||
+        websocketpp::utf8_validator::validate (payload);
+}
+
+static
+WebSocket04::MessagePtr
+makeSharedFrame (SharedMessage const& shared)
+{
+    auto const op = shared.binary ()
+        ? websocketpp::frame::opcode::binary
+        : websocketpp::frame::opcode::text;
+    if (! isValid (op, shared.payload ()))
+        return {};
+    return makeFrame (op, shared.payload (), false);
+}
+
+// Builds the frame compressed on its own, for clients which take our
+// messages without context takeover and with this window
+static
+WebSocket04::MessagePtr
+makeDeflatedFrame (SharedMessage const& shared, int windowBits)
+{
+    auto const op = shared.binary ()
+        ? websocketpp::frame::opcode::binary
+        : websocketpp::frame::opcode::text;
+    auto const& payload = shared.payload ();
+    if (! isValid (op, payload))
+        return {};
+    auto const deflated = Deflater (windowBits).compress (payload);
+    if (deflated.size () >= payload.size ())
+        return makeFrame (op, payload, false);
+    return makeFrame (op, deflated, true);
+}
+
+// Compresses a message for this connection alone and queues it
+static
+void
+sendDeflated (WebSocket04::Connection& connection,
+    websocketpp::frame::opcode::value op, std::string const& payload)
+{
+    if (! isValid (op, payload))
+        return;
+
+    auto const& params = connection.deflate;
+    if (! params.contextTakeover)
+    {
+        connection.send (makeFrame (op,
+            Deflater (params.windowBits).compress (payload), true));
+        return;
+    }
+
+    // The context is shared by the messages of the connection, which must
+    // be written in the order they are compressed
+    std::lock_guard<std::mutex> lock (connection.deflateMutex);
+    if (! connection.deflater)
+        connection.deflater = std::make_unique<Deflater> (params.windowBits);
+    connection.send (makeFrame (
+        op, connection.deflater->compress (payload), true));
+}
+
+void WebSocket04::send (Connection& connection, SharedMessage const& message)
+{
+    // Hixie-76 clients frame their text differently, and have no binary
+    // messages at all
+    if (websocketpp::processor::get_websocket_version (
+            connection.get_request ()) == 0)
+    {
+        if (! message.binary ())
+            connection.send (message.payload ());
+        return;
+    }
+
+    auto const& params = connection.deflate;
+    if (params.enabled && message.payload ().size () >= deflateMinBytes)
+    {
+        if (params.contextTakeover)
+        {
+            sendDeflated (connection, message.binary ()
+                ? websocketpp::frame::opcode::binary
+                : websocketpp::frame::opcode::text, message.payload ());
+            return;
+        }
+
+        // Connections with the same window share the compressed frame.
+        // Windows of 9 to 15 bits use encodings 1 to 7.
+        auto const bits = params.windowBits;
+        if (auto const& frame = message.encoded <MessagePtr> (bits - 8,
+                [bits] (SharedMessage const& shared)
+                {
+                    return makeDeflatedFrame (shared, bits);
+                }))
+            connection.send (frame);
+        return;
+    }
+
+    // Prepared frames are queued as they are, by every connection
+    if (auto const& frame = message.encoded <MessagePtr> (&makeSharedFrame))
+        connection.send (frame);
+}
+
+void WebSocket04::send (
+    Connection& connection, std::string const& payload, bool binary)
+{
+    auto const op = binary
+        ? websocketpp::frame::opcode::binary
+        : websocketpp::frame::opcode::text;
+    if (connection.deflate.enabled && payload.size () >= deflateMinBytes)
+    {
+        sendDeflated (connection, op, payload);
+        return;
+    }
+    connection.send (payload, op);
+}
+
+// Agrees on permessage-deflate with a client, as the port allows
+static
+void
+chooseDeflate (WebSocket04::Connection& connection, HTTP::Port const& port)
+{
+    connection.deflate = {};
+    websocketpp::http::parameter_list offers;
+    if (port.permessage_deflate &&
+        websocketpp::processor::get_websocket_version (
+            connection.get_request ()) >= 7 &&
+        ! connection.get_request ().get_header_as_plist (
+            "Sec-WebSocket-Extensions", offers))
+    {
+        auto const result = negotiateDeflate (
+            offers, port.deflate_context_takeover);
+        if (result.first.enabled)
+        {
+            connection.deflate = result.first;
+            connection.replace_header (
+                "Sec-WebSocket-Extensions", result.second);
+            return;
+        }
+    }
+    connection.remove_header ("Sec-WebSocket-Extensions");
+}
+
+std::size_t WebSocket04::bufferedAmount (Connection& connection)
+{
+    return connection.get_buffered_amount ();
+}
+
 using HandlerPtr04 = WebSocket04::HandlerPtr;
 using EndpointPtr04 = WebSocket04::EndpointPtr;
 
@@ -64,6 +235,13 @@ EndpointPtr04  WebSocket04::makeEndpoint (HandlerPtr&& handler)
 {
     auto endpoint = std::make_shared <Endpoint> (std::move (handler));
 
+    endpoint->set_validate_handler (
+        [endpoint] (websocketpp::connection_hdl hdl) {
+            if (auto conn = endpoint->get_con_from_hdl(hdl))
+                chooseDeflate (*conn, endpoint->handler()->port());
+            return true;
+        });
+
     endpoint->set_open_handler (
         [endpoint] (websocketpp::connection_hdl hdl) {
             if (auto conn = endpoint->get_con_from_hdl(hdl))
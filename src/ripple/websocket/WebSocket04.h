@@ -22,6 +22,7 @@
 
 #include <ripple/websocket/Config04.h>
 #include <ripple/websocket/WebSocket.h>
+#include <ripple/server/Port.h>
 
 namespace ripple {
 namespace websocket {
@@ -51,6 +52,7 @@ struct WebSocket04
         virtual boost::asio::ssl::context& get_ssl_context() = 0;
         virtual bool plain_only() = 0;
         virtual bool secure_only() = 0;
+        virtual HTTP::Port const& port() const = 0;
     };
 
     using HandlerPtr = std::shared_ptr<Handler>;
@@ -90,6 +92,18 @@ struct WebSocket04
     static
     bool isTextMessage (Message const&);
 
+    /** Send a message which is shared with other connections. */
+    static
+    void send (Connection&, SharedMessage const&);
+
+    /** Send a TEXT or BINARY message. */
+    static
+    void send (Connection&, std::string const& payload, bool binary);
+
+    /** Return the bytes queued on the connection and not yet written. */
+    static
+    std::size_t bufferedAmount (Connection&);
+
     /** Create a new Handler. */
     static
     HandlerPtr makeHandler (ServerDescription const&);
@@ -0,0 +1,113 @@
+#include <BeastConfig.h>
+#include <ripple/websocket/Deflate.h>
+#include <websocketpp/http/request.hpp>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+namespace websocket {
+
+class Deflate_test : public beast::unit_test::suite
+{
+public:
+    static
+    websocketpp::http::parameter_list
+    parse (std::string const& header)
+    {
+        websocketpp::http::parser::request p;
+        p.replace_header ("Sec-WebSocket-Extensions", header);
+        websocketpp::http::parameter_list offers;
+        p.get_header_as_plist ("Sec-WebSocket-Extensions", offers);
+        return offers;
+    }
+
+    void
+    testNegotiate ()
+    {
+        testcase ("negotiate");
+
+        {
+            auto const result = negotiateDeflate (
+                parse ("permessage-deflate; client_max_window_bits"), true);
+            expect (result.first.enabled);
+            expect (result.first.contextTakeover);
+            expect (result.first.windowBits == 15);
+            expect (result.second ==
+                "permessage-deflate; client_no_context_takeover");
+        }
+        {
+            // The port does not keep the context
+            auto const result = negotiateDeflate (
+                parse ("permessage-deflate"), false);
+            expect (result.first.enabled);
+            expect (! result.first.contextTakeover);
+            expect (result.second == "permessage-deflate; "
+                "client_no_context_takeover; server_no_context_takeover");
+        }
+        {
+            // The first offer we can honour is taken
+            auto const result = negotiateDeflate (parse (
+                "permessage-deflate; server_max_window_bits=8, "
+                "permessage-deflate; server_max_window_bits=10; "
+                "server_no_context_takeover"), true);
+            expect (result.first.enabled);
+            expect (! result.first.contextTakeover);
+            expect (result.first.windowBits == 10);
+            expect (result.second == "permessage-deflate; "
+                "client_no_context_takeover; server_no_context_takeover; "
+                "server_max_window_bits=10");
+        }
+        {
+            auto const result = negotiateDeflate (parse (
+                "x-webkit-deflate-frame, permessage-deflate; unknown"), true);
+            expect (! result.first.enabled);
+            expect (result.second.empty ());
+        }
+    }
+
+    void
+    testRoundTrip ()
+    {
+        testcase ("round trip");
+
+        std::string text;
+        for (int i = 0; i < 200; ++i)
+            text += "{\"type\":\"transaction\",\"ledger_index\":" +
+                std::to_string (i) + "}";
+
+        InflateExtension<void> inflater;
+        auto const offer = parse ("permessage-deflate");
+        expect (! inflater.negotiate (offer.front ().second).first);
+        expect (inflater.is_enabled ());
+
+        // Each message is inflated on its own
+        for (int i = 0; i < 3; ++i)
+        {
+            auto const deflated = Deflater (12).compress (text);
+            expect (deflated.size () < text.size () / 5);
+
+            std::string out;
+            expect (! inflater.decompress (
+                reinterpret_cast<std::uint8_t const*> (deflated.data ()),
+                deflated.size (), out));
+            expect (out == text);
+        }
+
+        // A kept context makes the next copy of a message smaller
+        Deflater deflater (15);
+        auto const first = deflater.compress (text);
+        auto const second = deflater.compress (text);
+        expect (second.size () < first.size ());
+    }
+
+    void
+    run ()
+    {
+        testNegotiate ();
+        testRoundTrip ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Deflate,websocket,ripple);
+
+} // websocket
+} // ripple